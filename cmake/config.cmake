@@ -27,18 +27,26 @@ set(HIDE_PRIVATE_SYMBOLS ON)
 # RAF_USE_GTEST. Option: [ON/OFF]
 set(RAF_USE_GTEST ON)
 
+# RAF_USE_BENCHMARK. Option: [ON/OFF]
+# Note: Google Benchmark has to be installed and discoverable by find_package. The collective
+# communication benchmark raf_comm_bench is also built with RAF_USE_NCCL and RAF_USE_MPI.
+set(RAF_USE_BENCHMARK OFF)
+
 # RAF_USE_CUDA. Option: [ON/OFF]
 set(RAF_USE_CUDA OFF)
 
 # CUDA architecture. Option: 70(V100), 75(T4), 80(A100)
 set(RAF_CUDA_ARCH 70)
 
-# RAF_USE_CUBLAS. Option: [ON/OFF]
+# RAF_USE_CUBLAS. Option: [ON/OFF]. It also enables the cuBLASLt dialect.
 set(RAF_USE_CUBLAS OFF)
 
 # RAF_USE_CUDNN. Option: [ON/OFF/Path-To-CUDNN]. You may use environment variables, like $ENV{CUDNN_HOME}
 set(RAF_USE_CUDNN OFF)
 
+# RAF_USE_CUPTI. Option: [ON/OFF]. It enables the GPU activity timeline in the profiler.
+set(RAF_USE_CUPTI OFF)
+
 # RAF_USE_SANITIZER. Option: [OFF/ASAN/MSAN/TSAN/UBSAN]"
 set(RAF_USE_SANITIZER OFF)
 
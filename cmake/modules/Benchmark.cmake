@@ -0,0 +1,11 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+if (${RAF_USE_BENCHMARK} STREQUAL "ON")
+  find_package(benchmark REQUIRED)
+  message(STATUS "Build with Google Benchmark ${benchmark_VERSION}")
+elseif (${RAF_USE_BENCHMARK} STREQUAL "OFF")
+  message(STATUS "Build without Google Benchmark")
+else()
+  message(FATAL_ERROR "Cannot recognize RAF_USE_BENCHMARK = ${RAF_USE_BENCHMARK}")
+endif()
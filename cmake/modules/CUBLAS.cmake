@@ -12,6 +12,13 @@ else()
   if (${RAF_USE_CUDA} STREQUAL "OFF")
     message(FATAL_ERROR "Cannot enable cuBLAS without using CUDA.")
   endif()
-  set(RAF_CUBLAS_LIBRARY ${CUDA_CUBLAS_LIBRARIES})
+  # cuBLASLt (used by the cublaslt dialect) is shipped with cuBLAS since CUDA 10.1.
+  find_library(RAF_CUBLASLT_LIBRARY cublasLt
+    HINTS ${CUDA_TOOLKIT_ROOT_DIR}
+    PATH_SUFFIXES lib lib64 lib/x64)
+  if (NOT RAF_CUBLASLT_LIBRARY)
+    message(FATAL_ERROR "Cannot find cuBLASLt")
+  endif()
+  set(RAF_CUBLAS_LIBRARY ${CUDA_CUBLAS_LIBRARIES} ${RAF_CUBLASLT_LIBRARY})
   message(STATUS "Found RAF_CUBLAS_LIBRARY = ${RAF_CUBLAS_LIBRARY}")
 endif()
@@ -40,5 +40,27 @@ class GemmUniversalOperationExt : public GemmUniversalOperation<Operator_> {
   }
 };
 
+/*! \brief Extention for GemmSparseOperation, with epilogue operators supported */
+template <typename Operator_>
+class GemmSparseOperationExt : public GemmSparseOperation<Operator_> {
+ public:
+  using Operator = Operator_;
+  using EpilogueOutputOp = typename Operator::EpilogueOutputOp;
+
+ protected:
+  /*! \brief Extended operator description, with epilogue operator information */
+  GemmDescriptionExt description_ext_;
+
+ public:
+  GemmSparseOperationExt(char const* name = "unknown_gemm")
+      : GemmSparseOperation<Operator_>(name),
+        description_ext_(this->description_, EpilogueOpMap<EpilogueOutputOp>::kId) {
+  }
+
+  virtual OperationDescription const& description() const {
+    return description_ext_;
+  }
+};
+
 }  // namespace library
 }  // namespace cutlass
@@ -10,6 +10,7 @@
 #pragma once
 #include <string>
 #include "./ir.h"
+#include "./registry.h"
 #include "./value.h"
 
 namespace raf {
@@ -79,5 +80,21 @@ ir::ObjectRef DeTuple(value::Value value);
 ir::ObjectRef DeStruct(value::Value value, value::ClosureValue bp,
                        ir::Array<ir::ObjectRef> prev_tapes);
 
+namespace lazy {
+/*!
+ * \brief Record an imperative op into the pending segment of the lazy mode instead of running it.
+ * \param op_name The name of the op.
+ * \param args The arguments of the imperative API.
+ * \param ret The pending vars of the outputs.
+ * \return Whether the op is recorded. If not, the op has to run eagerly, and the pending segment
+ * has been flushed so that its inputs are bound to values.
+ */
+bool Record(const char* op_name, const registry::TVMArgs& args, registry::TVMRetValue* ret);
+/*! \brief Run the pending segment if the var is computed by it. */
+void Materialize(const ir::VarNode* var);
+/*! \brief Run the pending segment and bind the vars to the results. */
+void Flush();
+}  // namespace lazy
+
 }  // namespace binding
 }  // namespace raf
@@ -9,9 +9,18 @@
  */
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <chrono>
+#include <cstring>
+#include <functional>
 #include <dmlc/memory_io.h>
 #include <sys/stat.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 #include "./op.h"
 #include "./value.h"
 
@@ -23,6 +32,64 @@ using namespace raf::value;
 
 using PackedMetricMap = Map<String, Integer>;
 
+/*!
+ * \brief A fast 128-bit non-cryptographic hash of the bytes, which mixes 16 bytes at a time in
+ * the way of MurmurHash3 (x64, 128-bit).
+ * \param data The bytes.
+ * \param len The number of bytes.
+ * \param out The two 64-bit halves of the hash.
+ */
+inline void Hash128(const uint8_t* data, size_t len, uint64_t out[2]) {
+  constexpr uint64_t c1 = 0x87c37b91114253d5ULL;
+  constexpr uint64_t c2 = 0x4cf5ad432745937fULL;
+  auto rotl = [](uint64_t x, int r) { return (x << r) | (x >> (64 - r)); };
+  auto fmix = [](uint64_t k) {
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ULL;
+    k ^= k >> 33;
+    return k;
+  };
+  uint64_t h1 = 0, h2 = 0;
+  size_t nblocks = len / 16;
+  for (size_t i = 0; i <= nblocks; ++i) {
+    uint64_t k[2] = {0, 0};
+    size_t rest = len - i * 16;
+    if (i == nblocks && rest == 0) {
+      break;
+    }
+    // The tail is padded with zeros, and only mixed into the halves it covers.
+    std::memcpy(k, data + i * 16, rest < 16 ? rest : 16);
+    if (i < nblocks || rest > 8) {
+      k[1] *= c2;
+      k[1] = rotl(k[1], 33);
+      k[1] *= c1;
+      h2 ^= k[1];
+    }
+    k[0] *= c1;
+    k[0] = rotl(k[0], 31);
+    k[0] *= c2;
+    h1 ^= k[0];
+    if (i < nblocks) {
+      h1 = rotl(h1, 27) + h2;
+      h1 = h1 * 5 + 0x52dce729;
+      h2 = rotl(h2, 31) + h1;
+      h2 = h2 * 5 + 0x38495ab5;
+    }
+  }
+  h1 ^= len;
+  h2 ^= len;
+  h1 += h2;
+  h2 += h1;
+  h1 = fmix(h1);
+  h2 = fmix(h2);
+  h1 += h2;
+  h2 += h1;
+  out[0] = h1;
+  out[1] = h2;
+}
+
 #define RAF_APPEND_BYTES(type, nbytes, value)                               \
   {                                                                         \
     constexpr int NUM_BYTES = nbytes;                                       \
@@ -97,8 +164,11 @@ class HashKey {
     RAF_APPEND_BYTES(DLDataType, 4, v->dtype);
     for (int i = 0, n = v->shape.size(); i < n; ++i) {
       int64_t dim_i;
-      if (v->shape.as<ir::AnyNode>()) {
+      if (v->shape[i].as<ir::AnyNode>()) {
         dim_i = -1;
+      } else if (!v->shape[i].as<ir::IntImmNode>()) {
+        // A symbolic dimension, e.g., the int32 batch of the kernels shared by all batch sizes.
+        dim_i = -2;
       } else {
         dim_i = ir::Downcast<ir::Integer>(v->shape[i]);
       }
@@ -108,6 +178,22 @@ class HashKey {
     return *this;
   }
 
+  inline HashKey& operator<<(const ir::Type& v) {
+    if (const auto* tensor = v.as<ir::TensorTypeNode>()) {
+      return operator<<(ir::GetRef<ir::TensorType>(tensor));
+    }
+    if (const auto* tuple = v.as<ir::TupleTypeNode>()) {
+      byte_vector.push_back(17);
+      for (const auto& field : tuple->fields) {
+        operator<<(field);
+      }
+      RAF_APPEND_BYTES(int64_t, 8, 0);
+      return *this;
+    }
+    // The other types, e.g., the function types, are rare in the keys.
+    return operator<<(ir::AsText(v, false));
+  }
+
   inline HashKey& operator<<(const DLTensor& v) {
     // N.B.: stride and ctx are not taken into consideration
     byte_vector.push_back(15);
@@ -142,15 +228,38 @@ class HashKey {
     byte_vector.reserve(1024);
   }
 
+  /*!
+   * \brief Get the 128-bit digest of the key. The caches are keyed by the digests in place of the
+   * long keys, e.g., the texts of the fused functions, so that the keys are short to hash and to
+   * compare on each lookup, and are small to store in the index of the persistent cache.
+   */
+  std::string Digest() const {
+    uint64_t hash[2];
+    Hash128(byte_vector.data(), byte_vector.size(), hash);
+    return std::string(reinterpret_cast<const char*>(hash), sizeof(hash));
+  }
+
   std::vector<uint8_t> byte_vector;
 };
 
 #undef RAF_DEF_PRIMITIVE
 #undef RAF_APPEND_BYTES
 
+/*!
+ * \brief A thread-safe cache mapping from binary keys to values, which is optimized for the
+ * read-mostly workload of dispatching. The entries are spread over a fixed number of shards by the
+ * hash of their keys. Each shard publishes an immutable snapshot of its map, so that lookups only
+ * atomically load the snapshot without taking any lock, while insertions are serialized per shard
+ * and publish a new copy of the map (RCU style). Entries are never removed, and each value is held
+ * by a shared pointer shared by all snapshots, so the pointers returned by Get remain valid for the
+ * lifetime of the cache.
+ */
 template <typename T>
 class MetaCache {
  public:
+  /*! \brief The number of shards. */
+  static constexpr size_t kNumShards = 16;
+
   ~MetaCache() = default;
 
   bool Has(const std::vector<uint8_t>& key) {
@@ -159,8 +268,7 @@ class MetaCache {
   }
 
   bool Has(const std::string& key) {
-    std::lock_guard<std::mutex> lock(mu_);
-    return cached_.count(key);
+    return Find(GetShard(key), key) != nullptr;
   }
 
   const T* Get(const std::vector<uint8_t>& key) {
@@ -169,12 +277,10 @@ class MetaCache {
   }
 
   const T* Get(const std::string& key) {
-    std::lock_guard<std::mutex> lock(mu_);
-    auto iter = cached_.find(key);
-    if (iter == cached_.end()) {
-      return nullptr;
-    }
-    return &iter->second;
+    Shard& shard = GetShard(key);
+    const T* ret = Find(shard, key);
+    (ret != nullptr ? shard.hits : shard.misses).fetch_add(1, std::memory_order_relaxed);
+    return ret;
   }
 
   void Set(const std::vector<uint8_t>& key, T val) {
@@ -183,20 +289,75 @@ class MetaCache {
   }
 
   void Set(const std::string& key, T val) {
-    std::lock_guard<std::mutex> lock(mu_);
-    auto iter = cached_.find(key);
-    if (iter != cached_.end()) {
+    Shard& shard = GetShard(key);
+    std::lock_guard<std::mutex> lock(shard.mu);
+    std::shared_ptr<const Map> snapshot = std::atomic_load(&shard.snapshot);
+    if (snapshot->count(key)) {
       LOG(FATAL) << "KeyError: The key is already cached!";
       throw;
     }
-    cached_.emplace(key, val);
+    auto next = std::make_shared<Map>(*snapshot);
+    next->emplace(key, std::make_shared<const T>(std::move(val)));
+    std::atomic_store(&shard.snapshot, std::shared_ptr<const Map>(std::move(next)));
+  }
+
+  /*! \brief Get the number of (hits, misses) of Get in each shard. */
+  std::unordered_map<std::string, size_t> GetShardMetric() {
+    std::unordered_map<std::string, size_t> ret;
+    for (size_t i = 0; i < kNumShards; ++i) {
+      ret["Shard" + std::to_string(i) + "Hit"] = shards_[i].hits.load(std::memory_order_relaxed);
+      ret["Shard" + std::to_string(i) + "Miss"] =
+          shards_[i].misses.load(std::memory_order_relaxed);
+    }
+    return ret;
+  }
+
+ protected:
+  /*! \brief Apply a function to all entries of the cache. */
+  void ForEach(const std::function<void(const std::string&, const T&)>& f) {
+    for (auto& shard : shards_) {
+      std::shared_ptr<const Map> snapshot = std::atomic_load(&shard.snapshot);
+      for (const auto& kv : *snapshot) {
+        f(kv.first, *kv.second);
+      }
+    }
+  }
+
+  /*! \brief Look up a key without updating the metrics. */
+  const T* Lookup(const std::string& key) {
+    return Find(GetShard(key), key);
   }
 
  private:
-  /*! \brief The cache mapping from string key to value. */
-  std::unordered_map<std::string, T> cached_;
-  /*! \brief The thread-safe lock. */
-  std::mutex mu_;
+  using Map = std::unordered_map<std::string, std::shared_ptr<const T>>;
+
+  /*! \brief A shard of the cache. */
+  struct Shard {
+    /*! \brief The latest snapshot of the map, which is never modified once published. */
+    std::shared_ptr<const Map> snapshot = std::make_shared<const Map>();
+    /*! \brief The number of cache hits of Get. */
+    std::atomic<size_t> hits{0};
+    /*! \brief The number of cache misses of Get. */
+    std::atomic<size_t> misses{0};
+    /*! \brief The lock to serialize the insertions. */
+    std::mutex mu;
+  };
+
+  Shard& GetShard(const std::string& key) {
+    return shards_[std::hash<std::string>{}(key) % kNumShards];
+  }
+
+  static const T* Find(Shard& shard, const std::string& key) {
+    std::shared_ptr<const Map> snapshot = std::atomic_load(&shard.snapshot);
+    auto iter = snapshot->find(key);
+    if (iter == snapshot->end()) {
+      return nullptr;
+    }
+    return iter->second.get();
+  }
+
+  /*! \brief The shards of the cache. */
+  std::array<Shard, kNumShards> shards_;
 };
 
 class MetaCacheMetric {
@@ -204,10 +365,167 @@ class MetaCacheMetric {
   virtual std::unordered_map<std::string, size_t> GetMetric() = 0;
 };
 
+/*!
+ * \brief Pack the files saved by an entry to a buffer along with its key, in the format of the
+ * payload of a persistent record: [key size: u64][key][number of files: u64]
+ * ([name size: u64][name][file size: u64][file])*.
+ * \param key The key of the entry.
+ * \param f_save The function to save the entry to an empty directory.
+ * \param packed The buffer to append the packed entry to.
+ * \return Whether the entry is saved successfully.
+ */
+bool PackEntry(const std::string& key, const std::function<bool(const std::string&)>& f_save,
+               std::string* packed);
+
+/*!
+ * \brief Unpack the files of an entry packed by PackEntry to a staging directory, and load it.
+ * \param packed The buffer of the packed entry.
+ * \param pos The offset of the packed entry in the buffer.
+ * \param expected_key The key that the entry must have, or nullptr to accept any key.
+ * \param f_load The function to load the entry from its key and the staging directory.
+ * \return Whether the entry is loaded, which is false if the key does not match.
+ */
+bool UnpackEntry(const std::string& packed, size_t pos, const std::string* expected_key,
+                 const std::function<void(const std::string&, const std::string&)>& f_load);
+
+/*!
+ * \brief A cache whose entries are bundled into the deployment artifacts, e.g., the built kernels
+ * and the chosen algorithms saved along with an executable, so that loading the artifact on
+ * another host of the same device architecture needs no JIT compilation or tuning.
+ */
+class BundledCache {
+ public:
+  virtual ~BundledCache() = default;
+
+  /*! \brief Pack all entries of the cache by PackEntry. */
+  virtual std::vector<std::string> ExportEntries() = 0;
+
+  /*!
+   * \brief Add an entry packed by ExportEntries to the cache.
+   * \param packed The packed entry.
+   */
+  virtual void ImportEntry(const std::string& packed) = 0;
+
+  /*! \brief The bundled caches by their persistent names. */
+  static std::map<std::string, BundledCache*>& Registry();
+};
+
+/*!
+ * \brief The packed on-disk store of a persistent cache, which consists of an append-only blob
+ * file (data.bin) and an index file (index.bin) under the cache directory. Each record in the blob
+ * file packs the key and all files saved by an entry, and the index maps the hashed keys to the
+ * records along with their last access times. The index is read with a single read when the store
+ * is opened, so that opening a cache of many entries does not touch the file system per entry.
+ * Records are unpacked to a local staging directory to be loaded by the entries.
+ *
+ * Multiple processes may share a store. Appending, indexing and compaction are serialized by an
+ * advisory file lock. Records appended by other processes after the index is written are found by
+ * scanning the tail of the blob file. When the total size of records exceeds the capacity, the
+ * least recently used records are evicted by compacting the blob file.
+ */
+class PersistStore {
+ public:
+  /*!
+   * \brief Open the store under a directory.
+   * \param path The directory of the store, which must exist.
+   * \param capacity The maximum total size of records in bytes. Non-positive means unlimited.
+   */
+  PersistStore(const std::string& path, int64_t capacity);
+
+  ~PersistStore();
+
+  /*!
+   * \brief Load an entry.
+   * \param key The key of the entry.
+   * \param f_load The function to load the entry from the directory of unpacked files.
+   * \return Whether the entry is found.
+   */
+  bool Load(const std::string& key, const std::function<void(const std::string&)>& f_load);
+
+  /*!
+   * \brief Save an entry.
+   * \param key The key of the entry.
+   * \param f_save The function to save the entry to an empty directory.
+   * \return Whether the entry is saved successfully.
+   */
+  bool Save(const std::string& key, const std::function<bool(const std::string&)>& f_save);
+
+  /*! \brief Read the whole blob file into memory with a single read. */
+  void Prefetch();
+
+  /*! \brief Pick up the records appended by other processes since the last scan. */
+  void Refresh();
+
+  /*!
+   * \brief Run a function while holding an advisory lock of a key shared by processes, so that
+   * only one process computes the entry of the key at a time. The lock is per process, so threads
+   * of the same process have to be serialized by the caller.
+   * \param key The key to be locked.
+   * \param f The function to run.
+   */
+  void WithKeyLock(const std::string& key, const std::function<void()>& f);
+
+  /*! \brief Write the index along with the latest access times. */
+  void Flush();
+
+ private:
+  /*! \brief An entry of the index. */
+  struct IndexEntry {
+    /*! \brief The hashed key. */
+    uint64_t hash;
+    /*! \brief The offset of the record in the blob file. */
+    uint64_t offset;
+    /*! \brief The size of the record in bytes. */
+    uint64_t size;
+    /*! \brief The last access time in seconds since epoch. */
+    int64_t timestamp;
+  };
+
+  void OpenData();
+  void LoadIndex(bool merge);
+  void WriteIndex();
+  void Sync();
+  void Scan();
+  void Compact();
+  std::string ReadRecord(const IndexEntry& entry);
+
+  /*! \brief The directory of the store. */
+  std::string path_;
+  /*! \brief The maximum total size of records in bytes. */
+  int64_t capacity_;
+  /*! \brief The file descriptor of the blob file. */
+  int data_fd_ = -1;
+  /*! \brief The file descriptor of the lock file. */
+  int lock_fd_ = -1;
+  /*! \brief The file descriptor of the file whose bytes are locked as the key locks. */
+  int key_lock_fd_ = -1;
+  /*! \brief The generation of the blob file, which changes once the file is compacted. */
+  uint64_t generation_ = 0;
+  /*! \brief The offset of the blob file up to which the records are indexed. */
+  uint64_t scanned_ = 0;
+  /*! \brief The index from hashed keys to records. */
+  std::unordered_map<uint64_t, IndexEntry> entries_;
+  /*! \brief The prefix of the blob file read by Prefetch. */
+  std::string prefetched_;
+  /*! \brief Whether the index has been changed since the last flush. */
+  bool dirty_ = false;
+  /*! \brief The thread-safe lock. */
+  std::mutex mu_;
+};
+
 template <typename T>
-class MetaPersistCache : public MetaCache<T>, public MetaCacheMetric {
+class MetaPersistCache : public MetaCache<T>, public MetaCacheMetric, public BundledCache {
  public:
-  MetaPersistCache(const std::string persist_name) : persist_name_(persist_name) {
+  /*!
+   * \brief Create a cache.
+   * \param persist_name The name of the cache, which is its directory of the persistent cache.
+   * \param bundled Whether the entries are bundled into the deployment artifacts.
+   */
+  MetaPersistCache(const std::string persist_name, bool bundled = false)
+      : persist_name_(persist_name) {
+    if (bundled) {
+      BundledCache::Registry()[persist_name_] = this;
+    }
     // Enable persistent by users.
     const char* enable_persist = getenv("RAF_PERSIST_CACHE");
     if (enable_persist != nullptr && strcmp(enable_persist, "1") == 0) {
@@ -232,6 +550,15 @@ class MetaPersistCache : public MetaCache<T>, public MetaCacheMetric {
 
     // Create the directory for this cache.
     CreateDir(path_);
+
+    // The size cap of this cache in MBs. Zero means unlimited.
+    const char* size_mb = getenv("RAF_PERSIST_CACHE_SIZE_MB");
+    int64_t capacity = size_mb != nullptr ? std::atoll(size_mb) << 20 : 0;
+    store_ = std::make_unique<PersistStore>(path_, capacity);
+    const char* prefetch = getenv("RAF_PERSIST_CACHE_PREFETCH");
+    if (prefetch != nullptr && strcmp(prefetch, "1") == 0) {
+      store_->Prefetch();
+    }
   }
 
   const T* Get(const std::vector<uint8_t>& key) {
@@ -240,14 +567,10 @@ class MetaPersistCache : public MetaCache<T>, public MetaCacheMetric {
   }
 
   const T* Get(const std::string& key) {
-    AddMetric("CacheGet", 1);
-
-    // Cache hit.
+    // Cache hit. The hits and misses are counted by the shards.
     if (auto val = MetaCache<T>::Get(key)) {
-      AddMetric("CacheHit", 1);
       return val;
     }
-    AddMetric("CacheMiss", 1);
     if (!persist_) {
       return nullptr;
     }
@@ -255,18 +578,22 @@ class MetaPersistCache : public MetaCache<T>, public MetaCacheMetric {
     // Cache miss, try to load from the persistent cache.
     std::lock_guard<std::mutex> lock(mu_);
 
-    auto persist_path = GetPersistPath(key);
-
-    // Persistent cache miss.
-    if (!DirExists(persist_path)) {
-      AddMetric("PersistCacheMiss", 1);
-      return nullptr;
+    // The entry may have been loaded by another thread in the meantime.
+    if (auto val = MetaCache<T>::Lookup(key)) {
+      return val;
     }
-    AddMetric("PersistCacheHit", 1);
 
     try {
-      MetaCache<T>::Set(key, T::Load(persist_path));
-      return MetaCache<T>::Get(key);
+      bool found = store_->Load(key, [this, &key](const std::string& dir) {
+        MetaCache<T>::Set(key, T::Load(dir));
+      });
+      // Persistent cache miss.
+      if (!found) {
+        AddMetric("PersistCacheMiss", 1);
+        return nullptr;
+      }
+      AddMetric("PersistCacheHit", 1);
+      return MetaCache<T>::Lookup(key);
     } catch (dmlc::Error& e) {
       AddMetric("PersistCacheLoadFailure", 1);
       LOG(WARNING) << "Failed to load persist entry " << path_ << ": " << e.what();
@@ -289,36 +616,111 @@ class MetaPersistCache : public MetaCache<T>, public MetaCacheMetric {
 
     std::lock_guard<std::mutex> lock(mu_);
 
-    auto persist_path = GetPersistPath(key);
-    CreateDir(persist_path);
-
     // Persist the cache value.
     try {
-      if (!val.Save(persist_path)) {
-        throw;
+      if (!store_->Save(key, [&val](const std::string& dir) { return val.Save(dir); })) {
+        AddMetric("PersistCacheSaveFailure", 1);
+        LOG(WARNING) << "Failed to persist cache entry to " << path_;
       }
     } catch (dmlc::Error& e) {
       AddMetric("PersistCacheSaveFailure", 1);
       LOG(WARNING) << "Failed to persist cache entry to " << path_ << ": " << e.what();
-      return;
     }
+  }
 
-    std::ofstream metadata_file(persist_path + "/timestamp");
-    metadata_file << std::chrono::system_clock::to_time_t(std::chrono::system_clock::now())
-                  << std::endl;
-    metadata_file.close();
+  /*!
+   * \brief Get the value of a key, or compute and cache it on a miss. Concurrent misses of the
+   * same key from threads of this process, or from other processes sharing the persistent cache,
+   * are cooperative: only one of them computes the value and publishes it, and the others wait for
+   * it and load the published value.
+   * \param key The key.
+   * \param f_compute The function to compute the value.
+   * \return The cached value.
+   */
+  const T* GetOrCompute(const std::vector<uint8_t>& key, const std::function<T()>& f_compute) {
+    const std::string key_str(key.begin(), key.end());
+    return GetOrCompute(key_str, f_compute);
   }
 
-  std::unordered_map<std::string, size_t> GetMetric() override {
-    return metrics_;
+  const T* GetOrCompute(const std::string& key, const std::function<T()>& f_compute) {
+    if (auto val = Get(key)) {
+      return val;
+    }
+    const T* ret = nullptr;
+    auto f_publish = [&]() {
+      // The value may have been published by another thread or process while waiting.
+      if (persist_) {
+        store_->Refresh();
+      }
+      if ((ret = Get(key)) != nullptr) {
+        AddMetric("CooperativeCacheHit", 1);
+        return;
+      }
+      T val = f_compute();
+      if ((ret = MetaCache<T>::Lookup(key)) == nullptr) {
+        Set(key, val);
+        ret = MetaCache<T>::Lookup(key);
+      }
+    };
+    std::lock_guard<std::mutex> lock(compute_mu_[std::hash<std::string>{}(key) % kNumComputeLocks]);
+    if (persist_) {
+      store_->WithKeyLock(key, f_publish);
+    } else {
+      f_publish();
+    }
+    return ret;
   }
 
- private:
-  inline std::string GetPersistPath(const std::string& key) {
-    const size_t hashed_key = std::hash<std::string>{}(key);
-    return path_ + "/" + std::to_string(hashed_key);
+  /*! \brief Whether the entries are persisted, i.e., RAF_PERSIST_CACHE is enabled. */
+  bool IsPersistent() const {
+    return persist_;
+  }
+
+  std::vector<std::string> ExportEntries() override {
+    std::vector<std::string> ret;
+    MetaCache<T>::ForEach([this, &ret](const std::string& key, const T& val) {
+      std::string packed;
+      T entry = val;
+      try {
+        if (PackEntry(key, [&entry](const std::string& dir) { return entry.Save(dir); },
+                      &packed)) {
+          ret.push_back(std::move(packed));
+          return;
+        }
+      } catch (dmlc::Error& e) {
+        LOG(WARNING) << e.what();
+      }
+      LOG(WARNING) << "Failed to bundle a cache entry of " << persist_name_;
+    });
+    return ret;
+  }
+
+  void ImportEntry(const std::string& packed) override {
+    UnpackEntry(packed, 0, nullptr, [this](const std::string& key, const std::string& dir) {
+      if (MetaCache<T>::Lookup(key) == nullptr) {
+        MetaCache<T>::Set(key, T::Load(dir));
+      }
+    });
   }
 
+  std::unordered_map<std::string, size_t> GetMetric() override {
+    std::unordered_map<std::string, size_t> ret = MetaCache<T>::GetShardMetric();
+    size_t hits = 0, misses = 0;
+    for (size_t i = 0; i < MetaCache<T>::kNumShards; ++i) {
+      hits += ret["Shard" + std::to_string(i) + "Hit"];
+      misses += ret["Shard" + std::to_string(i) + "Miss"];
+    }
+    ret["CacheGet"] = hits + misses;
+    ret["CacheHit"] = hits;
+    ret["CacheMiss"] = misses;
+    std::lock_guard<std::mutex> lock(metric_mu_);
+    for (const auto& it : metrics_) {
+      ret[it.first] = it.second;
+    }
+    return ret;
+  }
+
+ private:
   inline void CreateDir(const std::string& path) {
     if (mkdir(path.c_str(), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH) == -1) {
       if (errno != EEXIST) {
@@ -328,25 +730,28 @@ class MetaPersistCache : public MetaCache<T>, public MetaCacheMetric {
     }
   }
 
-  inline bool DirExists(const std::string& path) {
-    std::ifstream ifs(path);
-    auto ret = ifs.good();
-    ifs.close();
-    return ret;
-  }
-
   inline void AddMetric(const std::string name, size_t val) {
+    std::lock_guard<std::mutex> lock(metric_mu_);
     metrics_[name] += val;
   }
 
-  /*! \brief The cache metrics for analysis. */
+  /*! \brief The cache metrics for analysis, except for the ones counted by the shards. */
   std::unordered_map<std::string, size_t> metrics_;
+  /*! \brief The lock to protect the metrics. */
+  std::mutex metric_mu_;
   /*! \brief Persist directory name. */
   std::string persist_name_;
   /*! \brief Persist directory path. */
   std::string path_;
   /*! \brief Whether to presist values. */
   bool persist_ = false;
+  /*! \brief The number of locks to serialize the computation of the same key in this process. */
+  static constexpr size_t kNumComputeLocks = 16;
+
+  /*! \brief The packed store of persisted values. */
+  std::unique_ptr<PersistStore> store_;
+  /*! \brief The locks to serialize the computation of the same key, striped by the key hash. */
+  std::array<std::mutex, kNumComputeLocks> compute_mu_;
   /*! \brief The thread-safe lock. */
   std::mutex mu_;
 };
@@ -10,6 +10,7 @@
 #pragma once
 #include <unistd.h>
 #include <stdint.h>
+#include <algorithm>
 #include <string>
 #include <set>
 #include <memory>
@@ -114,6 +115,55 @@ class CommunicatorPool {
   }
 
   Communicator GetCommunicator(const std::string& name, const Value rank_list) {
+    CommunicatorID id = MakeID(name, rank_list);
+    if (comm_.count(id) == 0) {
+      const std::string prefix = "raf.distributed.communicator._make.";
+      auto func_name = prefix + name;
+      Communicator comm = GetPackedFunc(func_name)(rank_list);
+      comm_[id] = std::move(comm);
+    }
+    return comm_[id];
+  }
+
+  /*!
+   * \brief Get the communicators of the rank lists. The missing ones are created together by
+   * _make_group.<name> if registered, which overlaps their initialization, or one by one otherwise.
+   * All ranks are expected to get the same rank lists in the same order.
+   */
+  std::vector<Communicator> GetCommunicators(const std::string& name,
+                                             const std::vector<Value>& rank_lists) {
+    const std::string prefix = "raf.distributed.communicator._make_group.";
+    const auto* make_group = registry::Registry::Get(prefix + name);
+    Array<Value> missing;
+    std::vector<CommunicatorID> missing_ids;
+    for (const auto& rank_list : rank_lists) {
+      CommunicatorID id = MakeID(name, rank_list);
+      if (comm_.count(id) == 0 &&
+          std::find(missing_ids.begin(), missing_ids.end(), id) == missing_ids.end()) {
+        missing.push_back(rank_list);
+        missing_ids.push_back(id);
+      }
+    }
+    if (make_group && !missing.empty()) {
+      Array<Communicator> comms = (*make_group)(missing);
+      CHECK_EQ(comms.size(), missing.size());
+      for (size_t i = 0; i < missing_ids.size(); ++i) {
+        comm_[missing_ids[i]] = comms[i];
+      }
+    }
+    std::vector<Communicator> ret;
+    for (const auto& rank_list : rank_lists) {
+      ret.push_back(GetCommunicator(name, rank_list));
+    }
+    return ret;
+  }
+
+  void Remove() {
+    comm_.clear();
+  }
+
+ private:
+  static CommunicatorID MakeID(const std::string& name, const Value rank_list) {
     std::vector<std::vector<int64_t>> rank_list_;
     std::set<int64_t> rank_set_;
     if (rank_list.defined()) {
@@ -129,22 +179,9 @@ class CommunicatorPool {
       }
     }
 
-    CommunicatorID id(name, rank_list_);
-
-    if (comm_.count(id) == 0) {
-      const std::string prefix = "raf.distributed.communicator._make.";
-      auto func_name = prefix + name;
-      Communicator comm = GetPackedFunc(func_name)(rank_list);
-      comm_[id] = std::move(comm);
-    }
-    return comm_[id];
-  }
-
-  void Remove() {
-    comm_.clear();
+    return CommunicatorID(name, rank_list_);
   }
 
- private:
   std::map<CommunicatorID, Communicator> comm_;
 };
 
@@ -85,6 +85,18 @@ class DeviceAPI {
    */
   virtual void* CreateStream(const Device& dev) = 0;
 
+  /*!
+   * \brief Create a stream with the given priority on given device. Devices without stream
+   * priorities create a stream of the default priority.
+   * \param dev The device to create the stream.
+   * \param priority The priority of the stream. A greater value means a higher priority, and 0 is
+   * the default priority. It is clamped to the priority range of the device.
+   * \return The created stream.
+   */
+  virtual void* CreateStreamWithPriority(const Device& dev, int priority) {
+    return CreateStream(dev);
+  }
+
   /*!
    * \brief Free a stream.
    * \param dev The device to free the stream.
@@ -168,6 +180,18 @@ class DeviceAPI {
    */
   virtual void WaitEvent(void* event) = 0;
 
+  /*!
+   * \brief Launch a host function on the stream, which is called after the pending workloads on
+   * the stream finished. The function must not call the device api. The default implementation is
+   * for the devices that run the workloads synchronously, which calls the function immediately.
+   * \param stream The stream to launch the host function on.
+   * \param func The host function.
+   * \param data The argument of the host function.
+   */
+  virtual void LaunchHostFunc(void* stream, void (*func)(void*), void* data) {
+    func(data);
+  }
+
   /*!
    * \brief The the device api of given device type
    * \param device_type The device type.
@@ -70,6 +70,13 @@ class Dialect {
    * \param device_type The device type.
    * \return Whether the dialect is enabled. */
   bool is_enabled(DevType device_type) const;
+  /*!
+   * \brief Mark the dialect as JIT compiling (and possibly tuning) its kernels when dispatched,
+   * which may take seconds for a new shape.
+   */
+  Dialect& set_jit();
+  /*! \brief Check if the dialect JIT compiles its kernels. */
+  bool is_jit() const;
 
   /*! \brief Get the registry. */
   static TRegistry* Registry();
@@ -86,6 +93,12 @@ class Dialect {
    * \return Whether the dialect is enabled.
    */
   static bool IsEnabled(const std::string& dialect, DevType device_type);
+  /*!
+   * \brief Check if a dialect JIT compiles its kernels.
+   * \param dialect The dialect name.
+   * \return Whether the dialect JIT compiles its kernels.
+   */
+  static bool IsJIT(const std::string& dialect);
   /*!
    * \brief Get all enabled dialects given a device type.
    * \param device_type The device type.
@@ -99,6 +112,8 @@ class Dialect {
  private:
   /*! \brief The list of enabled devices. */
   std::vector<DevType> enable_devices_;
+  /*! \brief Whether the dialect JIT compiles its kernels. */
+  bool jit_ = false;
 };
 
 /*! \brief The dialect op registry for base ops. */
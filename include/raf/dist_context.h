@@ -26,9 +26,42 @@ class DistContextObj : public ir::Object {
   int local_rank = 0;
   int local_size = 0;
   bool enable_data_parallel = false;
+  bool enable_hierarchical_allreduce = false;
+  /*! \brief The gradient compression of allreduce, which is one of none, fp16, bf16, and topk. */
+  std::string allreduce_compression = "none";
+  /*! \brief The ratio of the gradient elements sent by each rank with topk compression. */
+  double allreduce_topk_ratio = 0.01;
+  /*!
+   * \brief Whether the sum and average of float16 and bfloat16 tensors are accumulated in float32,
+   * while the payloads are still communicated in 16 bits.
+   */
+  bool allreduce_fp32_accumulate = false;
   int zero_opt_level = 0;
+  /*!
+   * \brief The number of steps between the parameter averages of local SGD, where each rank
+   * applies its local gradients without allreduce in the other steps. It is 1 if disabled.
+   */
+  int local_sgd_period = 1;
+  /*! \brief Whether local SGD averages the momentum buffers along with the parameters. */
+  bool local_sgd_average_momentum = false;
   int auto_dp_profiling_start_iter = 2;
   int auto_dp_profiling_end_iter = 4;
+  /*!
+   * \brief Whether each allreduce chooses between the flat and the hierarchical algorithms by its
+   * message size and the probed topology, when the hierarchical allreduce is not enforced.
+   */
+  bool auto_select_allreduce = true;
+  /*! \brief The number of nodes, each of which has local_size ranks. */
+  int num_nodes = 1;
+  /*! \brief The link between the GPUs of this node, which is nvlink, pcie, or none. */
+  std::string intra_node_link = "none";
+  /*!
+   * \brief The measured copy bandwidth in GB/s from the GPU of this rank to each GPU of this node,
+   * which is 0 for itself and the GPUs without peer access.
+   */
+  ir::Array<ir::FloatImm> peer_bandwidth;
+  /*! \brief The inter-node bandwidth in GB/s, which is RAF_INTER_NODE_BANDWIDTH_GBPS if set. */
+  double inter_node_bandwidth = 12.5;
 
   void VisitAttrs(tvm::AttrVisitor* v) {
     v->Visit("root_rank", &root_rank);
@@ -37,9 +70,20 @@ class DistContextObj : public ir::Object {
     v->Visit("local_rank", &local_rank);
     v->Visit("local_size", &local_size);
     v->Visit("enable_data_parallel", &enable_data_parallel);
+    v->Visit("enable_hierarchical_allreduce", &enable_hierarchical_allreduce);
+    v->Visit("allreduce_compression", &allreduce_compression);
+    v->Visit("allreduce_topk_ratio", &allreduce_topk_ratio);
+    v->Visit("allreduce_fp32_accumulate", &allreduce_fp32_accumulate);
     v->Visit("zero_opt_level", &zero_opt_level);
+    v->Visit("local_sgd_period", &local_sgd_period);
+    v->Visit("local_sgd_average_momentum", &local_sgd_average_momentum);
     v->Visit("auto_dp_profiling_start_iter", &auto_dp_profiling_start_iter);
     v->Visit("auto_dp_profiling_end_iter", &auto_dp_profiling_end_iter);
+    v->Visit("auto_select_allreduce", &auto_select_allreduce);
+    v->Visit("num_nodes", &num_nodes);
+    v->Visit("intra_node_link", &intra_node_link);
+    v->Visit("peer_bandwidth", &peer_bandwidth);
+    v->Visit("inter_node_bandwidth", &inter_node_bandwidth);
   }
 
  public:
@@ -56,5 +100,15 @@ class DistContext : public ir::ObjectRef {
   RAF_MUTABLE_OBJECT_REF(DistContext, ir::ObjectRef, DistContextObj);
 };
 
+/*!
+ * \brief Whether the hierarchical allreduce, i.e., reduce-scatter within the node, allreduce across
+ * the nodes, and allgather within the node, is expected to be faster than the flat ring for the
+ * given message size. It follows a ring cost model of the probed intra-node and inter-node
+ * bandwidths, where the hierarchical algorithm sends 1/local_size of the data across the nodes at
+ * the cost of two more steps within the node, so it wins for the large messages.
+ * \param bytes The message size in bytes.
+ */
+bool PreferHierarchicalAllReduce(int64_t bytes);
+
 }  // namespace distributed
 }  // namespace raf
@@ -8,8 +8,10 @@
  * \brief Event pool API
  */
 #pragma once
+#include <array>
 #include <memory>
 #include <string>
+#include <vector>
 #include "./device.h"
 #include "device_api.h"
 
@@ -71,7 +73,20 @@ class EventPool {
    */
   std::shared_ptr<Event> GetEvent(uint32_t flags = 0);
 
+  /*!
+   * \brief Get a batch of events with given flags, e.g., to preallocate the events used by a run.
+   * \param num The number of events.
+   * \param flags The flags of the events.
+   * \return The new events with given flags.
+   */
+  std::vector<std::shared_ptr<Event>> GetEvents(size_t num, uint32_t flags = 0);
+
+  /*! \brief The number of supported event flags, which are the combinations of the CUDA flags. */
+  static constexpr uint32_t kNumEventFlags = 8;
+
  private:
+  class FreeList;
+
   /*!
    * \brief Create an event pool for given device.
    * \param dev The device.
@@ -91,10 +106,11 @@ class EventPool {
   Device device_;
   /*! \brief The device api of memory pool's device. */
   std::shared_ptr<DeviceAPI> api_;
-  /*! \brief The freed events. These events would be used for new GetEvent request. */
-  std::unordered_map<uint32_t, std::vector<void*>> freed_events_;
-  /*! \brief Mutex for exclusive access to the memory pool for multi threads. */
-  std::mutex mutex_;
+  /*!
+   * \brief The freed events of each flags, which would be used for new GetEvent request. The free
+   * lists are lock-free, so that the events can be recycled by multiple threads without contention.
+   */
+  std::array<std::unique_ptr<FreeList>, kNumEventFlags> freed_events_;
 
   friend Event;
 };
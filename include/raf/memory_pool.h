@@ -8,8 +8,10 @@
  * \brief Memory pool API
  */
 #pragma once
+#include <functional>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 #include "./device.h"
 
@@ -54,6 +56,46 @@ class Memory {
 
   static MemoryPool* InitPool(const Device& dev, const std::string& name);
 
+  /*!
+   * \brief The function that releases the memory cached out of the pools on the given device, e.g.,
+   * the workspaces held by the cached OpEnvs.
+   */
+  using FRelease = std::function<void(const Device&)>;
+
+  /*!
+   * \brief Register a function that releases the cached memory. When an allocation runs out of
+   * memory, all registered functions are called and the allocation is retried once.
+   * \param name The unique name of the function, which is used to remove it.
+   * \param release The function.
+   */
+  static void RegisterRelease(const std::string& name, FRelease release);
+
+  /*!
+   * \brief Remove a registered function that releases the cached memory.
+   * \param name The name of the function.
+   */
+  static void RemoveRelease(const std::string& name);
+
+  /*!
+   * \brief Call all registered functions to release the cached memory on the given device, and
+   * return the free memory of the pool to the device.
+   * \param dev The device.
+   * \return The memory returned to the device by the pool in bytes.
+   */
+  static int64_t ReleaseCachedMemory(const Device& dev);
+
+  /*!
+   * \brief Mark a step boundary on the given device, e.g., the beginning of a training iteration,
+   * where no intermediate tensor of the last step is alive. The peak usage of the last step is
+   * recorded, and the pool is compacted if its size exceeds threshold times the high-water mark of
+   * the last window steps, which keeps the long runs with varying shapes from fragmenting.
+   * \param dev The device.
+   * \param threshold The ratio of the pool size to the high-water mark that triggers compaction.
+   * \param window The number of steps in the high-water mark.
+   * \return Whether the pool is compacted.
+   */
+  static bool StepBoundary(const Device& dev, double threshold, int window);
+
  public:
   /*! \brief The pointer to the allocated chunk of memory. */
   void* data = nullptr;
@@ -61,6 +103,82 @@ class Memory {
   Device device{};
 };
 
+/*!
+ * \brief The memory quota of a tenant on a device, e.g., one of the models co-located on a GPU and
+ * served by their own VMs. The tenants share the memory pool of the device, while the memory that
+ * each of them can hold is limited to its quota plus what it borrows from the shared reserve of the
+ * device. As a result, a spike of one tenant cannot run the others out of memory.
+ *
+ * \sa Memory
+ */
+class MemoryQuota : public std::enable_shared_from_this<MemoryQuota> {
+ public:
+  /*! \brief The accounting shared by the quotas on the same device. */
+  struct DeviceState;
+
+  MemoryQuota(std::string name, std::shared_ptr<DeviceState> state)
+      : name_(std::move(name)), state_(std::move(state)) {
+  }
+
+  /*!
+   * \brief Get the quota of a tenant on the given device, which is created without limit if it
+   * does not exist.
+   * \param dev The device.
+   * \param name The name of the tenant.
+   * \return The quota.
+   */
+  static std::shared_ptr<MemoryQuota> Get(const Device& dev, const std::string& name);
+
+  /*!
+   * \brief Set the size of the shared reserve of the given device, which the tenants can borrow
+   * when they exceed their own quotas.
+   * \param dev The device.
+   * \param nbytes The size in bytes.
+   */
+  static void SetSharedReserve(const Device& dev, int64_t nbytes);
+
+  /*!
+   * \brief Set the quota of this tenant.
+   * \param nbytes The quota in bytes, or 0 for no limit.
+   */
+  void SetLimit(int64_t nbytes);
+
+  /*!
+   * \brief Run the allocation of nbytes and charge it to this tenant until the memory is released.
+   * It fails as out of memory without running the allocation if the tenant exceeds its quota and
+   * the shared reserve cannot cover the rest.
+   * \param nbytes The size of the allocation in bytes.
+   * \param alloc The function that allocates the memory.
+   * \return The allocated memory.
+   */
+  std::shared_ptr<Memory> Alloc(int64_t nbytes,
+                                const std::function<std::shared_ptr<Memory>()>& alloc);
+
+  /*!
+   * \brief Get the memory usage of this tenant.
+   * \return A pair of the bytes of (used memory, memory borrowed from the shared reserve).
+   */
+  std::pair<int64_t, int64_t> GetUsage();
+
+ private:
+  /*! \brief Charge nbytes to this tenant, or return false if it exceeds the quota. */
+  bool Acquire(int64_t nbytes);
+
+  /*! \brief Return nbytes charged to this tenant. */
+  void Release(int64_t nbytes);
+
+  /*! \brief The name of the tenant. */
+  std::string name_;
+  /*! \brief The accounting of the device. */
+  std::shared_ptr<DeviceState> state_;
+  /*! \brief The quota in bytes, or 0 for no limit. */
+  int64_t limit_ = 0;
+  /*! \brief The size of the memory held by this tenant. */
+  int64_t used_ = 0;
+  /*! \brief The size of the memory borrowed from the shared reserve. */
+  int64_t borrowed_ = 0;
+};
+
 /*!
  * \brief A base class for memory pool.
  * Only interface for implementing new allocation strategy, no static interface is included.
@@ -107,6 +225,17 @@ class MemoryPool {
   virtual std::shared_ptr<Memory> AllocAsync(int64_t nbytes, void* stream,
                                              int64_t alignment = kDefaultMemoryAlignment) = 0;
 
+  /*!
+   * \brief Whether this pool orders the allocations on streams by itself. If so, AllocAsync does
+   * not rely on the asynchronous allocation of the device API, and can be used with any driver
+   * version and during CUDA graph capture.
+   *
+   * \return Whether the pool is stream-ordered.
+   */
+  virtual bool IsStreamOrdered() {
+    return false;
+  }
+
   /*!
    * \brief Allocate a bacth of memory chunks with given sizes and alignments.
    *
@@ -124,6 +253,39 @@ class MemoryPool {
    * \return A pair of the total size of (used chunks, pool).
    */
   virtual std::pair<float, float> GetPoolSize() = 0;
+
+  /*!
+   * \brief Return the memory that is cached but not used by the pool to the device.
+   *
+   * \return The returned memory in bytes.
+   */
+  virtual int64_t FreeUnused() {
+    return 0;
+  }
+
+  /*!
+   * \brief Get the peak size of the used memory since the last call, and reset the peak to the
+   * current usage.
+   *
+   * \return The peak size in bytes, or 0 if the pool does not track it.
+   */
+  virtual int64_t ResetPeakUsed() {
+    return 0;
+  }
+
+  /*!
+   * \brief Return all cached memory to the device, and reserve one contiguous region for the
+   * following allocations. It undoes the fragmentation when called with no intermediate tensor
+   * alive, as the cached chunks can then be released entirely.
+   *
+   * \param reserve_bytes The size of the region to reserve. The pools which only reuse the chunks
+   * of exactly the same sizes ignore it.
+   *
+   * \return The memory returned to the device in bytes.
+   */
+  virtual int64_t Compact(int64_t reserve_bytes) {
+    return FreeUnused();
+  }
 };
 
 }  // namespace memory_pool
@@ -8,10 +8,14 @@
  * \brief memory profiler
  */
 #pragma once
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 #include <unordered_map>
 #include "device.h"
+#include "memory_pool.h"
 
 #define PROFILE_MEMORY(DEVICE, TAG)                                     \
   {                                                                     \
@@ -56,6 +60,49 @@ struct MemoryStat {
   int num_gc = 0;
 };
 
+/*! \brief The allocation-level trace of a chunk of memory. */
+struct AllocationTrace {
+  /*! \brief The number of bytes requested. */
+  int64_t nbytes;
+  /*! \brief The address of the memory. */
+  uintptr_t address;
+  /*! \brief The op that requested the memory, or the VM instruction that allocated it. */
+  std::string tag;
+  /*! \brief The VM function index and pc of the allocation, or -1 if not allocated by the VM. */
+  int64_t func_index;
+  int64_t pc;
+  /*! \brief The stream of an asynchronous allocation. */
+  void* stream;
+  /*! \brief The allocation and free timestamp in microseconds. */
+  uint64_t alloc_time;
+  uint64_t free_time = 0;
+  /*! \brief The order of the allocation and the free among all events of the device. */
+  uint64_t alloc_seq;
+  uint64_t free_seq = 0;
+  /*! \brief Whether the memory is still alive. */
+  bool alive = true;
+};
+
+/*!
+ * \brief The attribution of the memory allocated by this thread in the lifetime of the scope.
+ * Scopes can be nested, and the innermost one takes effect.
+ */
+class AllocationScope {
+ public:
+  AllocationScope(std::string tag, int64_t func_index, int64_t pc, void* stream);
+  ~AllocationScope();
+  /*! \brief The innermost scope of this thread, or nullptr if there is no scope. */
+  static const AllocationScope*& Current();
+
+  std::string tag;
+  int64_t func_index;
+  int64_t pc;
+  void* stream;
+
+ private:
+  const AllocationScope* prev_;
+};
+
 /*! \brief The memory profiler for all devices. */
 class MemoryProfiler {
  public:
@@ -70,6 +117,46 @@ class MemoryProfiler {
     return is_profiling_;
   }
 
+  void SetTraceAllocation(bool trace) {
+    is_tracing_allocation_ = trace;
+  }
+
+  bool IsTracingAllocation() {
+    return is_tracing_allocation_;
+  }
+
+  /*!
+   * \brief Trace an allocation with the attribution of the current AllocationScope. It returns
+   * a memory that shares the ownership of the given one, and traces the free when released.
+   * \param memory The allocated memory.
+   * \param nbytes The number of bytes requested.
+   * \return The traced memory.
+   */
+  std::shared_ptr<memory_pool::Memory> TraceAllocation(std::shared_ptr<memory_pool::Memory> memory,
+                                                       int64_t nbytes);
+
+  /*!
+   * \brief Get the breakdown of the live memory at the peak of the traced allocations.
+   * \param device The device to get the breakdown.
+   * \return The breakdown in the folded stack format of flame graphs, where each line is
+   * "device;tag;func_index:pc bytes".
+   */
+  std::string GetPeakBreakdown(const Device& device);
+
+  /*!
+   * \brief Get the traced allocations that are still alive, e.g. at the end of a step.
+   * \param device The device to get the allocations.
+   * \return The allocation table in a pretty string.
+   */
+  std::string GetLiveAllocations(const Device& device);
+
+  /*!
+   * \brief Get the statistics of the traced allocations.
+   * \param device The device to get the statistics.
+   * \return The peak and the live memory in MBs, and the number of allocations.
+   */
+  Map<String, FloatImm> GetAllocationInfo(const Device& device);
+
   /*!
    * \brief Record the current used and allocated memory for the given device and tag.
    * \param device The device to record.
@@ -100,6 +187,22 @@ class MemoryProfiler {
   std::unordered_map<std::string, MemoryStat> memory_stats_;
   /*! \brief Whether the profiling is enabled. */
   bool is_profiling_ = false;
+
+  /*! \brief Trace the free of an allocation. */
+  void TraceFree(const std::string& device_str, size_t index, uint64_t generation);
+  /*! \brief Get the seq of the peak event, and the live bytes at the peak. */
+  std::pair<uint64_t, int64_t> FindPeak(const std::vector<AllocationTrace>& allocations);
+
+  /*! \brief Mapping from device string to the traced allocations. */
+  std::unordered_map<std::string, std::vector<AllocationTrace>> allocations_;
+  /*! \brief The number of allocation and free events of each device. */
+  std::unordered_map<std::string, uint64_t> num_events_;
+  /*! \brief Incremented by Reset, so the frees of the allocations traced before are ignored. */
+  uint64_t generation_ = 0;
+  /*! \brief Whether the allocation tracing is enabled. */
+  bool is_tracing_allocation_ = false;
+  /*! \brief Mutex for the traced allocations, which may be freed by other threads. */
+  std::mutex mu_;
 };
 }  // namespace memory_profiler
 }  // namespace raf
@@ -30,9 +30,46 @@ class NCCLCommunicatorObj final : public CommunicatorObj {
 class NCCLCommunicator final : public Communicator {
  public:
   static NCCLCommunicator make(Value rank_list);
+  /*!
+   * \brief Make the communicators of the rank lists, whose initialization is overlapped in one NCCL
+   * group, instead of blocking on each of them in turn.
+   */
+  static Array<NCCLCommunicator> MakeGroup(Array<Value> rank_lists);
   RAF_OBJECT_REF(NCCLCommunicator, Communicator, NCCLCommunicatorObj);
 };
 
+/*!
+ * \brief A two-level communicator of all ranks. The local communicator connects the ranks on the
+ * same node (e.g., by NVLink), and the cross communicator connects the ranks of the same local
+ * rank across nodes. An allreduce is performed as a reduce-scatter within the node, an allreduce
+ * across nodes, and an all-gather within the node, so that each rank only sends 1/local_size of the
+ * data across nodes.
+ */
+class HierarchicalCommunicatorObj final : public CommunicatorObj {
+ public:
+  /*! \brief The NCCL communicator of the ranks on the same node. */
+  NCCLCommunicator local_comm;
+  /*! \brief The NCCL communicator of the ranks with the same local rank across nodes. */
+  NCCLCommunicator cross_comm;
+  /*! \brief The flat NCCL communicator of all ranks. */
+  NCCLCommunicator global_comm;
+  /*! \brief The number of nodes. */
+  int num_nodes;
+  static constexpr const char* _type_key = "raf.distributed.HierarchicalCommunicator";
+  RAF_FINAL_OBJECT(HierarchicalCommunicatorObj, CommunicatorObj);
+};
+
+class HierarchicalCommunicator final : public Communicator {
+ public:
+  static HierarchicalCommunicator make(Value rank_list);
+  /*!
+   * \brief Whether the ranks of the communicator span multiple nodes with multiple ranks each,
+   * and every node has the same number of ranks.
+   */
+  static bool IsApplicable(const Communicator& comm);
+  RAF_OBJECT_REF(HierarchicalCommunicator, Communicator, HierarchicalCommunicatorObj);
+};
+
 }  // namespace communicator
 }  // namespace distributed
 }  // namespace raf
@@ -32,7 +32,9 @@ class Requests;
 namespace raf {
 namespace op {
 
-extern std::vector<std::string> dispatch_error_msgs;
+/*! \brief The error messages of the last dispatch, which are per thread as the threads dispatch
+ * in parallel, e.g., in Prewarm and background JIT of the VM. */
+extern thread_local std::vector<std::string> dispatch_error_msgs;
 
 class CallValuesNode : public ir::Object {
  public:
@@ -78,6 +80,23 @@ class OpEnv {
    * \param output The output value.
    */
   virtual void Execute(const std::vector<value::Value>& inputs, value::Value output) = 0;
+  /*!
+   * \brief Whether Execute with the inputs and output only enqueues NCCL calls, with no other work
+   * after them, so that the VM can launch it in one NCCL group with the adjacent groupable OpEnvs.
+   * \param inputs The vector of input values.
+   * \param output The output value.
+   */
+  virtual bool IsGroupable(const std::vector<value::Value>& inputs,
+                           const value::Value& output) const {
+    return false;
+  }
+  /*!
+   * \brief Whether Execute only reads the shapes of the inputs and writes the output on the host,
+   * so that the VM can run it inline on the calling thread, with no kernel launch or device sync.
+   */
+  virtual bool IsShapeOnly() const {
+    return false;
+  }
 
   void RequestWorkspace(void** dest, const Device& device, int64_t nbytes);
   void RequestStream(void** dest, const Device& device, int tag_idx);
@@ -190,6 +209,17 @@ inline T GetOpAttrOrDefault(const ir::Op& op, const std::string attr_name, T def
  */
 std::shared_ptr<OpEnv> Dispatch(const CallValues& call);
 
+/*!
+ * \brief Dispatch a call to an implementation that is ready without JIT compilation, in place of
+ * the one Dispatch would JIT compile, e.g., a library dialect of the op at a lower plevel. A fused
+ * function of a single op falls back to the op as well. The data inputs of the returned OpEnv are
+ * indexed in the arguments of the call, as those of the OpEnv returned by Dispatch.
+ * \param call The call values.
+ * \return The fallback OpEnv, or nullptr if Dispatch does not JIT compile the call or there is no
+ * such fallback.
+ */
+std::shared_ptr<OpEnv> DispatchFallback(const CallValues& call);
+
 /*!
  * \brief Create a dummy call_values from a call expression. The inputs and output of the call
  * values are dummy values created according to the inferred type of the call expression.
@@ -11,6 +11,7 @@
 
 #pragma once
 #include "raf/cache.h"
+#include "raf/memory_pool.h"
 #include "op.h"
 #include "op_utils.h"
 #include <unordered_map>
@@ -27,8 +28,8 @@ namespace op_profiler {
 using namespace raf::op;
 using namespace raf::value;
 
-using LatencyAndWorkspaceMapT =
-    std::unordered_map<std::string, std::pair<std::vector<float>, int64_t>>;
+using LatencyAndWorkspaceT = std::pair<std::vector<float>, int64_t>;
+using LatencyAndWorkspaceMapT = std::unordered_map<std::string, LatencyAndWorkspaceT>;
 using OpEnvMapT = std::unordered_map<std::string, OpEnvPtr>;
 
 /*! \brief A class to JIT op, create dummy input data, and allocate memory buffers for profiling. */
@@ -62,6 +63,7 @@ class OpProfiler {
   static OpProfiler* Get(const Device& device);
 
   virtual ~OpProfiler() {
+    memory_pool::Memory::RemoveRelease(ReleaseName());
   }
 
   /*!
@@ -99,10 +101,22 @@ class OpProfiler {
   /*!
    * \brief Return the OpEnv of the given op if it has been profiled.
    * \param op The op to be queried.
-   * \return The OpEnv pointer of the given op if it has been profiled; otherwise nullptr.
+   * \return The OpEnv pointer of the given op if it has been profiled in this process; otherwise
+   * nullptr. Note that the ops whose latencies are reloaded from the persistent cache are not
+   * built, so their OpEnvs are not available.
    */
   OpEnvPtr GetOpEnv(const Expr& op);
 
+  /*!
+   * \brief Make the key of a call that is stable across processes, which covers the device
+   * fingerprint, the op, and the argument and return types.
+   * \param call The call to be hashed.
+   * \return The key for the persistent caches.
+   */
+  std::string GetPersistKey(const Call& call) {
+    return PersistKey(HashCall(call, true));
+  }
+
   /*!
    * \brief Get the current size of latency cache.
    */
@@ -120,6 +134,27 @@ class OpProfiler {
 
  protected:
   OpProfiler(const Device& device) : device_(device) {
+    // The built OpEnvs hold their workspaces, which are released when an allocation runs out of
+    // memory. They are built again if needed.
+    memory_pool::Memory::RegisterRelease(ReleaseName(), [this](const Device& dev) {
+      if (device_ == dev) {
+        op_env_cache_.clear();
+      }
+    });
+  }
+
+  /*! \brief The name of the function that releases the built OpEnvs. */
+  std::string ReleaseName() const {
+    return std::string("raf.op_profiler.") + device_.c_str();
+  }
+
+  /*!
+   * \brief The fingerprint of the device and its software stack (e.g., the GPU model and the
+   * driver version), which is a part of the persistent cache keys, so the latencies profiled on a
+   * different device or stack are not reused.
+   */
+  virtual std::string DeviceFingerprint() {
+    return device_.c_str();
   }
 
   /*! \brief The target device. */
@@ -136,9 +171,11 @@ class OpProfiler {
    * argument and return types.
    *
    * \param call The call node to be hashed.
+   * \param structural Whether to hash the fused functions by their structures, so that the key
+   * is stable across processes. Otherwise they are hashed by the object addresses.
    * \return The hashed key.
    */
-  HashKey HashCall(const Call& call) {
+  HashKey HashCall(const Call& call, bool structural = false) {
     HashKey key;
 
     // Hash op name. Note that we directly use the object address as the key
@@ -146,7 +183,8 @@ class OpProfiler {
     if (auto op_node = call->op.as<OpNode>()) {
       key << op_node->name;
     } else if (auto fn_node = call->op.as<FunctionNode>()) {
-      key << uint64_t(ObjectPtrHash()(GetRef<Function>(fn_node)));
+      auto func = GetRef<Function>(fn_node);
+      key << uint64_t(structural ? StructuralHashOf(func) : ObjectPtrHash()(func));
     } else {
       LOG(FATAL) << "OpProfiler does not deal with " << call->op->GetTypeKey();
       throw;
@@ -154,21 +192,35 @@ class OpProfiler {
 
     // Hash argument and return types.
     for (auto arg : call->args) {
-      key << raf::ir::AsText(arg->checked_type(), false);
+      key << arg->checked_type();
     }
-    key << raf::ir::AsText(call->checked_type(), false);
+    key << call->checked_type();
     return key;
   }
 
+  /*!
+   * \brief Get the structural hash of a fused function, which is memoized on the function object
+   * since the same function is hashed for each of its calls and each profiling round.
+   */
+  uint64_t StructuralHashOf(const Function& func) {
+    auto it = structural_hashes_.find(func);
+    if (it == structural_hashes_.end()) {
+      it = structural_hashes_.emplace(func, tvm::StructuralHash()(func)).first;
+    }
+    return it->second;
+  }
+
   /*!
    * \brief Generate a byte string hash for the given group node using their op, arguments,
    * return types and stream ids.
    *
    * \param ops The group to be hashed.
    * \param stream_ids The stream IDs.
+   * \param structural Whether to hash the fused functions by their structures.
    * \return The hashed key.
    */
-  HashKey HashGroup(const std::vector<Expr>& ops, const std::vector<int> stream_ids = {}) {
+  HashKey HashGroup(const std::vector<Expr>& ops, const std::vector<int> stream_ids = {},
+                    bool structural = false) {
     HashKey key;
     std::vector<int> processed_stream_ids = stream_ids;
 
@@ -183,10 +235,10 @@ class OpProfiler {
     for (size_t i = 0; i < ops.size(); ++i) {
       auto op = ops[i];
       if (auto call_node = op.as<CallNode>()) {
-        key << HashCall(GetRef<Call>(call_node));
+        key << HashCall(GetRef<Call>(call_node), structural);
       } else {
         // For non-call nodes, we simply hash their type.
-        key << raf::ir::AsText(op->checked_type(), false);
+        key << op->checked_type();
       }
       key << processed_stream_ids[i];
     }
@@ -194,9 +246,36 @@ class OpProfiler {
   }
 
   inline std::string HashKeyToStr(const HashKey& key) {
-    return std::string(key.byte_vector.begin(), key.byte_vector.end());
+    return key.Digest();
   }
 
+  /*!
+   * \brief Make the persistent cache key by prefixing the device fingerprint to the structural
+   * hash key of the op or the group.
+   */
+  std::string PersistKey(const HashKey& key);
+
+  /*!
+   * \brief Load the latency and the workspace size from the persistent cache, which are only
+   * trusted if they were profiled within the staleness window.
+   * \param key The persistent cache key.
+   * \param ret The loaded latency and workspace size.
+   * \return Whether a fresh entry is found.
+   */
+  bool LoadPersisted(const std::string& key, LatencyAndWorkspaceT* ret);
+
+  /*!
+   * \brief Save the latency and the workspace size to the persistent cache.
+   * \param key The persistent cache key.
+   * \param val The latency and workspace size.
+   */
+  void SavePersisted(const std::string& key, const LatencyAndWorkspaceT& val);
+
+  /*! \brief The cached device fingerprint. */
+  std::string fingerprint_;
+  /*! \brief The memoized structural hashes of the fused functions. */
+  std::unordered_map<Function, uint64_t, ObjectPtrHash, ObjectPtrEqual> structural_hashes_;
+
   /*!
    * \brief The function that actually executes the op on the device.
    * \param op_with_data The executable op with data.
@@ -303,6 +382,9 @@ class CUDAOpProfiler : public OpProfiler {
                                         int32_t warmup = 10, int32_t exec_number = 10,
                                         int32_t repeat = 1);
 
+  /*! \brief The GPU model, and the CUDA driver and runtime versions. */
+  std::string DeviceFingerprint() override;
+
   /*! \brief CUDA events to time the execution of ops. */
   cudaEvent_t start_event_;
   cudaEvent_t end_event_;
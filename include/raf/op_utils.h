@@ -121,7 +121,8 @@ inline bool IsInOpSet(const Expr& op, const OpSet& op_set) {
 inline bool IsReshapeOp(const Op& op) {
   static std::unordered_set<Op, ObjectPtrHash, ObjectPtrEqual> reshape_ops{
       Op::Get("raf.op.reshape"), Op::Get("raf.op.expand_dims"), Op::Get("raf.op.squeeze"),
-      Op::Get("raf.op.batch_flatten"), Op::Get("raf.op.reshape_like")};
+      Op::Get("raf.op.batch_flatten"), Op::Get("raf.op.reshape_like"),
+      Op::Get("raf.op.checkpoint")};
   return IsInOpSet(op, reshape_ops);
 }
 
@@ -147,6 +148,29 @@ inline bool IsDefuseTensorOp(const Expr& op) {
   return IsInOpSet(op, defuse_tensor_ops);
 }
 
+inline bool IsDeviceCopyOp(const Expr& op) {
+  static OpSet device_copy_ops = {
+      Op::Get("raf.op.device_copy"),
+  };
+  return IsInOpSet(op, device_copy_ops);
+}
+
+/*!
+ * \brief Whether the op only reads the shapes of its inputs and produces small integer tensors,
+ * which are computed on the host no matter where the inputs are.
+ */
+inline bool IsShapeOp(const Expr& op) {
+  static OpSet shape_ops = {
+      Op::Get("raf.op.shape"),
+      Op::Get("raf.op.shape_as_tensor"),
+      Op::Get("raf.op.ndarray_size"),
+      Op::Get("raf.op.numel"),
+      Op::Get("raf.op.get_reduce_axis"),
+      Op::Get("raf.op.get_kept_dims"),
+  };
+  return IsInOpSet(op, shape_ops);
+}
+
 inline size_t GetSizeInBytes(const DLDataType& dtype) {
   return (dtype.bits + 7) / 8;
 }
@@ -39,11 +39,15 @@ using tvm::transform::PassNode;
  * \param opt_level The optimization level of the function pass.
  * \param name The name of the function pass.
  * \param required The list of the passes that the function pass is dependent on.
+ * \param thread_safe Whether pass_func can transform different functions concurrently, in which
+ * case the functions are transformed by "raf.pass.num_threads" threads. Such a pass_func must not
+ * mutate the nodes shared between functions, and must read configs from its PassContext argument.
  * \return The created function pass.
  */
 TVM_DLL Pass
 CreateRAFFunctionPass(const TypedPackedFunc<Function(Function, IRModule, PassContext)>& pass_func,
-                      int opt_level, String name, tvm::Array<String> required);
+                      int opt_level, String name, tvm::Array<String> required,
+                      bool thread_safe = false);
 
 /*!
  * \brief A special trace pass that prints the header and IR to LOG(INFO).
@@ -65,7 +69,8 @@ Pass AutoDiff(ir::Array<tvm::Bool> requires_grads = {});
  * \brief A pass that performs data parallelism. It mainly modifies the backward
  * closure by adding communication ops after the ops that generate local
  * gradient and stream_sync ops before the end of backward closure to ensure
- * communication is done.
+ * communication is done. The gradients are kept local with local SGD, i.e., local_sgd_period is
+ * larger than 1 in the dist context, whose parameters are averaged every few steps instead.
  * \return The created pass.
  */
 Pass AutoDataParallel();
@@ -88,6 +93,14 @@ Pass LambdaLift();
  */
 Pass GradInputSelect();
 
+/*!
+ * \brief A pass that switches the ops between their training and inference variants. When
+ * switching to inference, the dropouts are removed as well.
+ * \param to_train_op Whether to switch to the training variants.
+ * \return The created pass.
+ */
+Pass SwitchTrainOp(bool to_train_op);
+
 /*!
  * \brief A pass that manifests memory allocation.
  * \return The created pass.
@@ -106,6 +119,62 @@ Pass MemoryPlan();
  */
 Pass CanonicalizeOps();
 
+/*!
+ * \brief A pass that simplifies inference graphs with constant weights, e.g., folds batch norms
+ * into the preceding convolutions and moves the transposes of matmuls into the weights, so that
+ * FoldConstant can fold them.
+ * \return The created pass.
+ */
+Pass SimplifyInference();
+
+/*!
+ * \brief A pass that makes the main function also return max(abs(x)) of each float32 dense input
+ * x, i.e., the ranges of the inputs to be calibrated for the quantization.
+ * \return The created pass.
+ */
+Pass InstrumentQuantize();
+
+/*!
+ * \brief A pass that quantizes the float32 dense layers to int8 by inserting the quantize and
+ * dequantize ops, where the inputs are scaled per tensor by the calibrated ranges and the weights
+ * are scaled per output channel.
+ * \param ranges The calibrated ranges of the dense inputs, in the order of InstrumentQuantize.
+ * \return The created pass.
+ */
+Pass Quantize(ir::Array<ir::FloatImm> ranges);
+
+/*!
+ * \brief A pass that folds the dense layers of the dequantized int8 tensors into the int8 dense
+ * op, which accumulates in int32 and rescales the outputs by the scales.
+ * \return The created pass.
+ */
+Pass FoldQuantize();
+
+/*!
+ * \brief A pass that fuses relu(batch_norm_train(x)[0] + z), where the residual add is optional,
+ * into the fused batch_norm + add + relu training op, whose backward keeps the ReLU mask as bits
+ * instead of the activation. It runs on the ANF forward graph before AutoDiff.
+ * \return The created pass.
+ */
+Pass FuseBatchNormReLU();
+
+/*!
+ * \brief A pass that replaces the dense layers of the given weights by the 2:4 sparse dense op,
+ * whose compressed weights and metadata are constants. The weights that are no longer used are
+ * removed from the parameters of the functions.
+ * \param weights The compressed weight and metadata constants of each weight parameter by name.
+ * \return The created pass.
+ */
+Pass SparsifyDense(ir::Map<ir::String, ir::Array<ir::Expr>> weights);
+
+/*!
+ * \brief A pass that merges the sibling GEMMs sharing an input, e.g., the Q, K and V projections
+ * of attention, into one wide GEMM of the concatenated other inputs followed by a split. The
+ * concatenation of constant weights is folded by FoldConstant.
+ * \return The created pass.
+ */
+Pass MergeSiblingGemm();
+
 /*!
  * \brief Create a type inference pass.
  * \return The created pass.
@@ -150,12 +219,69 @@ Pass PartitionGraph();
  */
 Pass AutoCast();
 
+/*!
+ * \brief A pass that casts the inputs of the float dense layers to FP8 (E4M3), which are
+ * rescaled by the per-tensor scales with the delayed scaling. The amax history and the scale of
+ * each input are appended to the params of the main function, and they are updated in place by
+ * the amaxes of the inputs after each dense for the next steps.
+ * \param history_len The length of the amax history.
+ * \param margin The scales are multiplied by 2^margin to leave the headroom.
+ * \return The created pass.
+ */
+Pass AutoCastFP8(int history_len, int margin);
+
+/*!
+ * \brief A pass that eliminates back-to-back cast ops and moves cast ops across layout ops,
+ * so that the layout ops process the narrower dtype.
+ * \return The created pass.
+ */
+Pass EliminateCast();
+
+/*!
+ * \brief A pass that eliminates the common subexpressions, i.e., the op calls and the tuples whose
+ * ops, attributes and arguments are the same. The ops with side effects, the in-place updates, the
+ * collective ops and the stateful random ops are kept.
+ * \return The created pass.
+ */
+Pass EliminateCommonSubexpr();
+
+/*!
+ * \brief A pass that converts the NCHW convolutions to NHWC for tensor cores, and propagates the
+ * NHWC layout through the following layout-agnostic ops to minimize the transposes. The policy
+ * is set by "raf.layout.policy", which is "auto" (float16 convolutions with aligned channels),
+ * "nhwc" (all NCHW convolutions) or "none". It only applies to CUDA with cuDNN or CUTLASS.
+ * \return The created pass.
+ */
+Pass ConvertLayout();
+
 /*!
  * \brief A pass that rematerializes tensors to reduce memory footprint.
  * \return The created pass.
  */
 Pass Rematerialization();
 
+/*!
+ * \brief A pass that offloads the activations used by the backward to the pinned host memory
+ * when they are cheaper to transfer than to rematerialize.
+ * \return The created pass.
+ */
+Pass OffloadActivation();
+
+/*!
+ * \brief A pass that stores the activations saved for the backward in compressed forms, e.g.,
+ * the ReLU outputs as boolean masks, following raf.compress_activation.policy.
+ * \return The created pass.
+ */
+Pass CompressActivation();
+
+/*!
+ * \brief A pass that inserts the prefetch and eviction hints of the unified memory allocated by
+ * managed_pool, so the large tensors not used for a while leave the device. The hints are issued
+ * raf.managed_memory.prefetch_distance bindings ahead of the uses, and disabled if it is 0.
+ * \return The created pass.
+ */
+Pass ManagedMemoryHint();
+
 /*!
  * \brief A pass that schedules ANF for memory optimization.
  * \return The created pass.
@@ -221,6 +347,14 @@ Pass AssignDevice(std::string device);
  */
 Pass LiftBranchBody();
 
+/*!
+ * \brief A pass that converts the if expressions whose branches are small and free of side effects
+ * to raf.op.where, which evaluates both branches and selects the result on the device. The
+ * maximum number of ops in both branches is set by raf.predicate_if.max_ops.
+ * \return The created pass.
+ */
+Pass PredicateIf();
+
 /*!
  * \brief This pass is applied after Lambda lifting. Lambda lifting pass lifts the closures to
  * global scope, but the lifted global function still has the closure within. This makes AD harder.
@@ -311,6 +445,14 @@ Pass InlineClosure();
  */
 Pass InplaceUpdate();
 
+/*!
+ * \brief This pass moves each optimizer update of the ANF, e.g., sgd and lans, right after the
+ * bindings that define its args and read the tensors it updates in place. As a result, the
+ * gradient of each parameter is consumed, and freed, as soon as it is produced in the backward.
+ * \return The created pass.
+ */
+Pass OptimizerInBackward();
+
 /*!
  * TODO(@hzfan): Update the doc for enforce_memory_share
  * \brief This pass validates and corrects the memory share annotated by the user.
@@ -357,6 +499,26 @@ Pass EnforceSync();
  */
 Pass AnnotateCollectiveOps();
 
+/*!
+ * \brief This pass works in ANF and merges consecutive allreduce ops of single tensors into
+ * allreduce ops of buckets in the backward order. The results of a bucket share the memory with
+ * the local gradients when possible so that the bucket is reduced in place.
+ *
+ * This pass provides the following config parameters:
+ * - raf.bucket_allreduce.bucket_size_mb: The maximum size of a bucket in MBs. Default 0 (disabled).
+ * \return The created pass.
+ */
+Pass BucketAllReduce();
+
+/*!
+ * \brief This pass works after MemoryPlan and lays out the input tensors of each multi-tensor
+ * allreduce contiguously in a single storage, so that the producers directly write to the bucket
+ * and the allreduce does not pack and unpack the tensors. It is enabled along with
+ * BucketAllReduce.
+ * \return The created pass.
+ */
+Pass BucketAllReduceLayout();
+
 /*!
  * \brief This pass implements IOS (Inter-Operator-Scheduler) stream schedule policy. It transforms
  * BBNF into ANF and injects stream-related operators (e.g., raf.op.set_stream, raf.op.add_event,
@@ -439,5 +601,14 @@ ir::Expr InferTypeWithModule(const ir::Expr& expr, const ir::IRModule& module);
  */
 ir::Expr DeadCodeElimination(const ir::Expr& expr);
 
+/*!
+ * \brief Analyze the devices of the expressions in the main function, which are propagated from
+ * the source and destination devices of the device_copy ops.
+ * \param mod The module, whose main function is analyzed.
+ * \param default_device The device of the expressions that are not constrained by device_copy.
+ * \return The device of each expression.
+ */
+ir::Map<ir::Expr, Device> ContextAnalysis(const ir::IRModule& mod, const Device& default_device);
+
 }  // namespace pass
 }  // namespace raf
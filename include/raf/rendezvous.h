@@ -0,0 +1,103 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file rendezvous.h
+ * \brief Key-value stores for the ranks to bootstrap the communicators without MPI.
+ */
+#pragma once
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "raf/communicator.h"
+
+namespace raf {
+namespace distributed {
+namespace communicator {
+
+/*!
+ * \brief A key-value store shared by all ranks. Each key is expected to be set once, and Get waits
+ * until the key is set by any rank, or fails after the timeout.
+ */
+class Store {
+ public:
+  virtual ~Store() = default;
+  virtual void Set(const std::string& key, const std::string& value) = 0;
+  virtual std::string Get(const std::string& key) = 0;
+  /*! \brief Gather the values of all ranks under the key prefix, in the order of the ranks. */
+  std::vector<std::string> AllGather(const std::string& prefix, int rank, int size,
+                                     const std::string& value);
+  /*!
+   * \brief The store of RAF_RENDEZVOUS, which is either tcp://host:port served by rank 0, or
+   * file:///path of an empty directory on a file system shared by all ranks. The timeout in
+   * seconds is RAF_RENDEZVOUS_TIMEOUT, which defaults to 300.
+   * \return The store, or nullptr if RAF_RENDEZVOUS is not set.
+   */
+  static std::shared_ptr<Store> Global();
+};
+
+/*! \brief The store of a directory, where each key is a file written atomically by renaming. */
+class FileStore final : public Store {
+ public:
+  FileStore(std::string path, std::chrono::milliseconds timeout);
+  void Set(const std::string& key, const std::string& value) override;
+  std::string Get(const std::string& key) override;
+
+ private:
+  std::string KeyPath(const std::string& key) const;
+
+  std::string path_;
+  std::chrono::milliseconds timeout_;
+};
+
+/*!
+ * \brief The store served over TCP by one of the ranks, where a background thread accepts the
+ * connections and each connection is handled by its own thread, so the ranks waiting for a key do
+ * not block the others. Every rank, including the server, is a client with one connection.
+ */
+class TCPStore final : public Store {
+ public:
+  TCPStore(const std::string& host, int port, bool is_server, std::chrono::milliseconds timeout);
+  ~TCPStore();
+  void Set(const std::string& key, const std::string& value) override;
+  std::string Get(const std::string& key) override;
+
+ private:
+  class Server;
+  std::unique_ptr<Server> server_;
+  /*! \brief The socket of the client connection. */
+  int socket_ = -1;
+  /*! \brief The lock of the connection, whose requests are served in order. */
+  std::mutex mu_;
+};
+
+/*!
+ * \brief The communicator of all ranks bootstrapped through the global store, whose rank and size
+ * are read from RANK and WORLD_SIZE as set by the common launchers. It performs no communication by
+ * itself, but provides the ranks and the store for the other communicators to bootstrap.
+ */
+class StoreCommunicatorObj final : public CommunicatorObj {
+ public:
+  std::shared_ptr<Store> store;
+  /*!
+   * \brief The number of the communicators bootstrapped through the store, which namespaces their
+   * keys, as all ranks create the communicators in the same order.
+   */
+  int num_bootstraps = 0;
+  static constexpr const char* _type_key = "raf.distributed.StoreCommunicator";
+  RAF_FINAL_OBJECT(StoreCommunicatorObj, CommunicatorObj);
+};
+
+class StoreCommunicator final : public Communicator {
+ public:
+  static StoreCommunicator make(Value rank_list);
+  RAF_MUTABLE_OBJECT_REF(StoreCommunicator, Communicator, StoreCommunicatorObj);
+};
+
+}  // namespace communicator
+}  // namespace distributed
+}  // namespace raf
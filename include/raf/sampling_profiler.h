@@ -0,0 +1,156 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file sampling_profiler.h
+ * \brief A low-overhead sampling profiler that can be left on in production
+ */
+#pragma once
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "device.h"
+#include "device_api.h"
+#include "profiler.h"
+
+namespace raf {
+namespace profiler {
+
+/*! \brief A sampled event. The name is interned, so the event is a fixed-size POD. */
+struct SampledEvent {
+  uint32_t name_id;
+  uint64_t start;
+  uint64_t end;
+};
+
+/*!
+ * \brief A log-linear latency histogram in microseconds. The latencies below 16us have their own
+ * buckets, and every power of two above is split into 8 buckets, so the relative error of a
+ * percentile is at most 12.5%.
+ */
+class LatencyHistogram {
+ public:
+  static constexpr int kNumLinearBuckets = 16;
+  static constexpr int kSubBucketBits = 3;
+  static constexpr int kNumBuckets = kNumLinearBuckets + (64 - 4) * (1 << kSubBucketBits);
+
+  void Add(uint64_t latency);
+  /*! \brief Get the latency at the given percentile in [0, 100]. */
+  uint64_t Percentile(double percentile) const;
+
+  uint64_t count() const {
+    return count_;
+  }
+  uint64_t sum() const {
+    return sum_;
+  }
+  uint64_t max() const {
+    return max_;
+  }
+
+ private:
+  static int BucketIndex(uint64_t latency);
+  static uint64_t BucketLowerBound(int index);
+
+  std::array<uint64_t, kNumBuckets> buckets_{};
+  uint64_t count_ = 0;
+  uint64_t sum_ = 0;
+  uint64_t max_ = 0;
+};
+
+/*!
+ * \brief The sampling profiler profiles 1 in N iterations (i.e., VM runs). The events of the
+ * sampled iterations are written into a fixed-size ring buffer without allocation, and a flush
+ * thread periodically aggregates them into per-op latency histograms, which can be scraped.
+ * When the ring buffer is full, the oldest events are overwritten and counted as dropped.
+ */
+class SamplingProfiler {
+ public:
+  ~SamplingProfiler();
+  static SamplingProfiler* Get();
+
+  /*!
+   * \brief Enable the sampling profiler.
+   * \param sample_every Profile 1 in sample_every iterations.
+   * \param capacity The number of events in the ring buffer, which is rounded up to a power of 2.
+   * \param flush_interval_ms The interval of the flush thread in milliseconds.
+   */
+  void Enable(int64_t sample_every, int64_t capacity, int64_t flush_interval_ms);
+  /*! \brief Disable the sampling profiler, and flush the pending events. */
+  void Disable();
+  /*! \brief Start an iteration, which decides whether the iteration of this thread is sampled. */
+  void NextIteration();
+  /*! \brief Whether the current iteration of this thread is sampled. */
+  static bool IsSampling() {
+    return SampledIteration();
+  }
+
+  /*! \brief Wait for the device and return the start time of the event. */
+  uint64_t Start(const Device& device);
+  /*! \brief Wait for the device and write the event to the ring buffer. */
+  void Stop(const Device& device, const std::string& name, uint64_t start);
+
+  /*! \brief Intern the name, and return its id. */
+  uint32_t Intern(const std::string& name);
+  /*! \brief Aggregate the events in the ring buffer into the histograms. */
+  void Flush();
+  /*! \brief Get the per-op latency statistics in JSON. */
+  std::string GetStats();
+  /*! \brief Clear the histograms. */
+  void Reset();
+
+ private:
+  SamplingProfiler();
+
+  static bool& SampledIteration() {
+    static thread_local bool sampled = false;
+    return sampled;
+  }
+
+  void Push(const SampledEvent& event);
+  void FlushLoop();
+
+  /*! \brief A slot of the ring buffer, whose sequence number guards the concurrent writes. */
+  struct Slot {
+    std::atomic<uint64_t> seq{0};
+    SampledEvent event;
+  };
+
+  std::atomic<bool> enabled_{false};
+  std::atomic<int64_t> sample_every_{1};
+  std::atomic<uint64_t> iteration_{0};
+  /*! \brief The ring buffer. */
+  std::unique_ptr<Slot[]> slots_;
+  uint64_t mask_ = 0;
+  /*! \brief The number of events written to the ring buffer. */
+  std::atomic<uint64_t> head_{0};
+  /*! \brief The number of events read from the ring buffer. */
+  uint64_t tail_ = 0;
+  uint64_t num_dropped_ = 0;
+  /*! \brief The interned names. */
+  std::unordered_map<std::string, uint32_t> name_ids_;
+  std::vector<std::string> names_;
+  std::mutex name_mu_;
+  /*! \brief The histograms indexed by the name id. */
+  std::vector<LatencyHistogram> histograms_;
+  /*! \brief Mutex for the ring buffer reads and the histograms. */
+  std::mutex flush_mu_;
+  /*! \brief The flush thread. */
+  std::thread flush_thread_;
+  int64_t flush_interval_ms_ = 1000;
+  bool stop_flush_ = false;
+  std::mutex stop_mu_;
+  std::condition_variable stop_cv_;
+};
+
+}  // namespace profiler
+}  // namespace raf
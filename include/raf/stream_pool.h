@@ -38,7 +38,7 @@ enum StreamTag {
   kCudaCommunicate = 4,
   kMemCpyCudaToCuda1 = 5,
   kMemCpyCudaToCuda2 = 6,
-  kReserved1 = 7,
+  kCudaComputeHighPriority = 7,
   kReserved2 = 8,
   kReserved3 = 9,
   kReserved4 = 10,
@@ -64,7 +64,8 @@ class StreamTagEnum : public EnumBase<StreamTagEnum, 16, int32_t, StreamTag> {
                            "Memcopy from CUDA to CUDA");
   ENUM_DEF_ENTRY_WITH_NAME(StreamTagEnum, 6, MemCudaToCuda2, kMemCpyCudaToCuda2,
                            "Memcopy from CUDA to CUDA");
-  ENUM_DEF_ENTRY_WITH_NAME(StreamTagEnum, 7, Reserved1, kReserved1, "Reserved for other devices");
+  ENUM_DEF_ENTRY_WITH_NAME(StreamTagEnum, 7, CudaComputeHighPriority, kCudaComputeHighPriority,
+                           "Cuda compute with high priority");
   ENUM_DEF_ENTRY_WITH_NAME(StreamTagEnum, 8, Reserved2, kReserved2, "Reserved for other devices");
   ENUM_DEF_ENTRY_WITH_NAME(StreamTagEnum, 9, Reserved3, kReserved3, "Reserved for other devices");
   ENUM_DEF_ENTRY_WITH_NAME(StreamTagEnum, 10, Reserved4, kReserved4, "Reserved for other devices");
@@ -93,6 +94,22 @@ class Stream final {
 
   static std::shared_ptr<Stream> Get(const Device& dev, int tag_idx, int index);
 
+  /*!
+   * \brief Set the priority of the streams of a tag. A greater value means a higher priority, and
+   * 0 is the default priority of the device. It only applies to the streams created afterwards.
+   * \param tag_idx The tag of the streams.
+   * \param priority The priority.
+   */
+  static void SetPriority(int tag_idx, int priority);
+
+  /*!
+   * \brief Get the priority of the streams of a tag. By default, the communication, the prefetch
+   * and the high priority compute streams have high priority, and the others have the default one.
+   * \param tag_idx The tag of the streams.
+   * \return The priority.
+   */
+  static int GetPriority(int tag_idx);
+
   void Wait() const;
 
  private:
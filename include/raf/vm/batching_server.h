@@ -0,0 +1,145 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file include/raf/vm/batching_server.h
+ * \brief A dynamic batching front-end of the virtual machine for online inference.
+ */
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "raf/vm/vm.h"
+
+namespace raf {
+namespace executor {
+namespace vm {
+
+/*!
+ * \brief The dynamic batching server. The requests are queued and concatenated along their first
+ * axis into a batch, which is flushed when it reaches the largest batch size or when its first
+ * request has waited for the timeout. A batch runs on the VM of the smallest batch size (i.e., the
+ * bucket) that fits it, padded with zeros, and the outputs are split back to the requests along
+ * their first axis. All of it happens on a worker thread, so the callers only wait for futures.
+ *
+ * The first inputs of the VM function are the batched inputs, and the rest are the inputs shared
+ * by all requests (e.g., the parameters). The batched inputs are staged in pinned buffers, which
+ * are allocated once for each bucket and reused by the following batches.
+ */
+class BatchingServer : public tvm::runtime::ModuleNode {
+ public:
+  /*!
+   * \brief Create a batching server and start its worker thread.
+   * \param batch_sizes The batch size of each bucket.
+   * \param vms The VM of each bucket, whose executable is compiled for the batch size.
+   * \param device The device of the VMs.
+   * \param shared_inputs The inputs shared by all requests, which follow the batched inputs.
+   * \param timeout_us The maximum time in microseconds that a request waits for the batch.
+   * \param copy_outputs Whether to copy the outputs of the requests out of the batch outputs, which
+   * is required when the VMs reuse the output buffers, e.g., in the CUDA graph mode.
+   * \param func_name The function to run.
+   */
+  BatchingServer(std::vector<int64_t> batch_sizes, std::vector<tvm::runtime::Module> vms,
+                 Device device, std::vector<Value> shared_inputs, int64_t timeout_us,
+                 bool copy_outputs, std::string func_name);
+
+  ~BatchingServer();
+
+  /*!
+   * \brief Submit a request.
+   * \param inputs The batched inputs of the request on the host, whose first axis is the batch.
+   * \return The future of the outputs of the request.
+   */
+  VMFuture Submit(std::vector<Value> inputs);
+
+  PackedFunc GetFunction(const std::string& name, const ObjectPtr<Object>& sptr_to_self) final;
+
+  const char* type_key() const final {
+    return "BatchingServer";
+  }
+
+ private:
+  /*! \brief A queued request. */
+  struct Request {
+    /*! \brief The batched inputs. */
+    std::vector<Value> inputs;
+    /*! \brief The number of rows of the request in the batch. */
+    int64_t rows;
+    /*! \brief The future of the request. */
+    VMFuture future;
+    /*! \brief The time when the request is submitted. */
+    std::chrono::steady_clock::time_point submitted;
+  };
+
+  /*! \brief The pinned staging buffers of a bucket. */
+  struct Bucket {
+    /*! \brief The batch size. */
+    int64_t batch_size;
+    /*! \brief The VM of the bucket. */
+    tvm::runtime::Module vm;
+    /*! \brief The staging buffer of each batched input. */
+    std::vector<std::shared_ptr<memory_pool::Memory>> staging;
+    /*! \brief The size in bytes of each staging buffer. */
+    std::vector<int64_t> staging_bytes;
+    /*! \brief The event after the last copy from the staging buffers, or nullptr if not used. */
+    std::shared_ptr<Event> copied;
+  };
+
+  /*! \brief The loop of the worker thread. */
+  void Loop();
+  /*!
+   * \brief Run a batch of requests and complete their futures.
+   * \param requests The requests in the batch.
+   * \param rows The total number of rows of the requests.
+   */
+  void RunBatch(std::vector<Request>* requests, int64_t rows);
+  /*!
+   * \brief Concatenate a batched input of the requests into the staging buffer, and copy it to the
+   * device of the VM.
+   */
+  Value StageInput(Bucket* bucket, const std::vector<Request>& requests, size_t index);
+  /*!
+   * \brief Get the rows of a request from an output of the batch.
+   * \param value The output of the batch.
+   * \param offset The first row of the request.
+   * \param rows The number of rows of the request.
+   */
+  Value SliceOutput(const Value& value, int64_t offset, int64_t rows);
+
+  /*! \brief The buckets in the ascending order of the batch sizes. */
+  std::vector<Bucket> buckets_;
+  /*! \brief The inputs shared by all requests. */
+  std::vector<Value> shared_inputs_;
+  /*! \brief The timeout of a request to wait for the batch. */
+  std::chrono::microseconds timeout_;
+  /*! \brief Whether to copy the outputs of the requests out of the batch outputs. */
+  bool copy_outputs_;
+  /*! \brief The function to run. */
+  std::string func_name_;
+  /*! \brief The device of the VMs. */
+  Device device_;
+  /*! \brief The queued requests. */
+  std::deque<Request> queue_;
+  /*! \brief The total number of rows of the queued requests. */
+  int64_t queued_rows_ = 0;
+  /*! \brief Whether the worker thread should stop. */
+  bool stop_ = false;
+  /*! \brief The mutex of the queue. */
+  std::mutex mu_;
+  /*! \brief Notified when a request is queued or the server is stopped. */
+  std::condition_variable cv_;
+  /*! \brief The worker thread. */
+  std::thread worker_;
+};
+
+}  // namespace vm
+}  // namespace executor
+}  // namespace raf
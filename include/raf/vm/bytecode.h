@@ -64,6 +64,7 @@ enum class Opcode {
   // AllocADT = 25U,
   SetShape = 26U,
   Free = 27U,
+  AllocOwnedTensor = 28U,
 
   // Invoke instructions
   InvokeFunc = 30U,
@@ -177,6 +178,22 @@ struct Instruction {
       /*! \brief Whether the tensor should own the storage memory. */
       bool own;
     } alloc_tensor_reg;
+    struct /* AllocOwnedTensor Operands */ {
+      /*! \brief The size of the storage. */
+      Index allocation_size;
+      /*! \brief The alignment of the storage. */
+      Index alignment;
+      DevType device_type;
+      Index device_id;
+      /*! \brief The offset into the storage to allocate from. */
+      Index offset;
+      /*! \brief The number of dimensions. */
+      uint32_t ndim;
+      /*! \brief The shape of tensor. */
+      int64_t* shape;
+      /*! \brief The datatype of tensor to be allocated. */
+      DLDataType dtype;
+    } alloc_owned_tensor;
     struct /* AllocClosure Operands */ {
       /*! \brief The index into the function table. */
       Index func_index;
@@ -196,6 +213,8 @@ struct Instruction {
       RegName data;
       /*! \brief The register containing the shape. */
       RegName shape;
+      /*! \brief The offset in bytes of the view to the data. */
+      Index byte_offset;
     } set_shape;
 
     struct /* InvokeFunc Operands */ {
@@ -247,6 +266,8 @@ struct Instruction {
       Index device_id;
       /*! \brief The id of the target stream */
       Index stream_id;
+      /*! \brief The priority of the target stream, where 0 is the default priority */
+      Index priority;
     } cuda_set_stream;
     struct /* CudaAddEvent and CudaWaitEvent Operands */ {
       /*! \brief The id of the event need to add or wait on current device */
@@ -301,6 +322,23 @@ struct Instruction {
    */
   static Instruction AllocTensorReg(RegName storage, Index offset, RegName shape_register,
                                     DLDataType dtype, RegName dst, bool own = true);
+  /*!
+   * \brief Construct an instruction allocating a storage of constant size and a tensor of constant
+   * shape owning the storage, which fuses AllocStorage and AllocTensor.
+   * \param allocation_size The size of the storage.
+   * \param alignment The alignment of the storage.
+   * \param device_type The device type of the storage.
+   * \param device_id The device id of the storage.
+   * \param offset The offset to allocate at.
+   * \param shape The shape of the tensor.
+   * \param dtype The dtype of the tensor.
+   * \param dst The destination register.
+   * \return The allocate owned tensor instruction.
+   */
+  static Instruction AllocOwnedTensor(Index allocation_size, Index alignment, DevType device_type,
+                                      Index device_id, Index offset,
+                                      const std::vector<int64_t>& shape, DLDataType dtype,
+                                      RegName dst);
   /*!
    * \brief Construct an allocate tuple instruction.
    * \param num_fields The number of fields for the datatype.
@@ -322,10 +360,11 @@ struct Instruction {
    * \brief Construct an set shape instruction.
    * \param data The register containing the data.
    * \param shape The register containing the raw shape.
+   * \param byte_offset The offset in bytes of the view to the data.
    * \param dst The destination register.
    * \return The set shape instruction.
    */
-  static Instruction SetShape(RegName data, RegName shape, RegName dst);
+  static Instruction SetShape(RegName data, RegName shape, Index byte_offset, RegName dst);
   /*!
    * \brief Construct a get field instruction.
    * \param object_reg The register containing the object to project from.
@@ -429,9 +468,10 @@ struct Instruction {
    * \brief Construct a CudaSetStream instruction.
    * \param device_id The id of device we want to set the stream on.
    * \param stream_id The id of target stream.
+   * \param priority The priority of target stream. It takes effect when the stream is created.
    * \return The set stream instruction.
    */
-  static Instruction CudaSetStream(Index device_id, Index stream_id);
+  static Instruction CudaSetStream(Index device_id, Index stream_id, Index priority = 0);
   /*!
    * \brief Construct a CudaAddEvent instruction.
    * \param event_id The id of event we would use to record.
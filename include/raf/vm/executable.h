@@ -9,6 +9,7 @@
  */
 #pragma once
 
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -25,6 +26,7 @@ using namespace raf::ir;
 using raf::registry::PackedFunc;
 
 struct VMFunction;
+struct MappedFile;
 
 /*!
  * \brief The executable emitted by the VM compiler.
@@ -54,9 +56,14 @@ class Executable : public tvm::runtime::ModuleNode {
    * \brief Serialize the executable into global section, constant section, and
    * code section.
    *
+   * \param bundle_kernels Whether to append the kernel section, which bundles the built kernels
+   * and the chosen algorithms in the bundled caches (see BundledCache), so that loading the
+   * executable on a host with the same device architecture needs no JIT compilation. Only the
+   * kernels that have been built are bundled, so the executable should be run once before saved.
+   *
    * \return The binary representation of the VM.
    */
-  TVMByteArray Save();
+  TVMByteArray Save(bool bundle_kernels = false);
 
   /*!
    * \brief Load the saved VM executable.
@@ -68,6 +75,36 @@ class Executable : public tvm::runtime::ModuleNode {
    */
   static tvm::runtime::Module Load(const std::string& code, const tvm::runtime::Module lib);
 
+  /*!
+   * \brief Save the executable to a file in the mappable format. Different from Save, the tensor
+   * constants are stored as raw page-aligned blobs after the other sections, so that they can be
+   * memory-mapped by LoadFromFile without being copied.
+   *
+   * \param path The path of the file.
+   * \param bundle_kernels Whether to append the kernel section as in Save.
+   */
+  void SaveToFile(const std::string& path, bool bundle_kernels = false);
+
+  /*!
+   * \brief Load the VM executable saved by SaveToFile. The tensor constants are backed by a
+   * private memory mapping of the file, and are uploaded to the device on their first use.
+   *
+   * \param path The path of the file.
+   * \param lib The compiled runtime library.
+   *
+   * \return exe The constructed executable.
+   */
+  static tvm::runtime::Module LoadFromFile(const std::string& path,
+                                           const tvm::runtime::Module lib);
+
+  /*!
+   * \brief Check whether a constant is backed by the memory mapping of the executable file.
+   * \param index The index of the constant.
+   */
+  bool IsMappedConstant(Index index) const {
+    return index < mapped_constants_.size() && mapped_constants_[index];
+  }
+
   /*!
    * \brief Get the serialized form of the `functions`. This is
    * essentially bytecode serialization.
@@ -211,8 +248,44 @@ class Executable : public tvm::runtime::ModuleNode {
    */
   void LoadCodeSection(dmlc::Stream* strm);
 
+  /*!
+   * \brief Save the entries of the bundled caches.
+   *
+   * \param strm The output stream.
+   */
+  void SaveKernelSection(dmlc::Stream* strm);
+
+  /*!
+   * \brief Load the entries of the bundled caches, if the kernel section exists.
+   *
+   * \param strm The input stream.
+   */
+  void LoadKernelSection(dmlc::Stream* strm);
+
+  /*!
+   * \brief Save the constant pool in the mappable format. Tensor constants are written as
+   * descriptors in the section, and their data are appended to the blobs.
+   *
+   * \param strm The output stream.
+   * \param blobs The tensors whose data should be written after the sections, in order.
+   */
+  void SaveMappedConstantSection(dmlc::Stream* strm, std::vector<tensor::Tensor>* blobs);
+
+  /*!
+   * \brief Load the constant pool in the mappable format.
+   *
+   * \param strm The input stream.
+   * \param data The beginning of the mapped blobs.
+   * \param data_size The size of the mapped blobs.
+   */
+  void LoadMappedConstantSection(dmlc::Stream* strm, uint8_t* data, size_t data_size);
+
   /*! \brief The serialized bytecode. */
   std::string code_;
+  /*! \brief The memory mapping of the executable file, if loaded by LoadFromFile. */
+  std::shared_ptr<MappedFile> mapped_file_;
+  /*! \brief Whether each constant is backed by the memory mapping. */
+  std::vector<bool> mapped_constants_;
 };
 
 }  // namespace vm
@@ -9,9 +9,20 @@
  */
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <list>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 #include "bytecode.h"
@@ -110,6 +121,66 @@ struct VMFrame {
   }
 };
 
+/*!
+ * \brief The statistics counters of VM executions. A context counts its own execution without
+ * synchronization, and its counters are merged into the VM when the execution finishes.
+ */
+struct VMStats {
+  static constexpr size_t kNumOpcodes = static_cast<size_t>(Opcode::CudaStreamBarrier) + 1;
+  /*! \brief The number of executed instructions indexed by the opcode. */
+  std::array<uint64_t, kNumOpcodes> num_instructions{};
+  /*! \brief The number of finished executions. */
+  uint64_t num_runs = 0;
+  /*! \brief The number of OpEnv cache hits and misses. */
+  uint64_t op_env_cache_hits = 0;
+  uint64_t op_env_cache_misses = 0;
+  /*! \brief The number and the total bytes of allocations, including the workspaces. */
+  uint64_t num_allocs = 0;
+  uint64_t alloc_bytes = 0;
+  /*! \brief The number and the total bytes of workspace allocations. */
+  uint64_t num_workspace_allocs = 0;
+  uint64_t workspace_bytes = 0;
+  /*! \brief The number of waited events and stream barriers. */
+  uint64_t num_event_waits = 0;
+  uint64_t num_stream_barriers = 0;
+  /*! \brief The number of CUDA graph captures and replays. */
+  uint64_t num_cuda_graph_captures = 0;
+  uint64_t num_cuda_graph_replays = 0;
+  /*!
+   * \brief The number of OpEnvs dispatched to their fallbacks on cache misses, and the number of
+   * the fallbacks replaced by the optimized OpEnvs built in the background.
+   */
+  uint64_t num_fallback_op_envs = 0;
+  uint64_t num_background_jits = 0;
+  /*!
+   * \brief The number of times that a low-priority run yielded to the high-priority runs of the
+   * device, and the total yielded time in microseconds.
+   */
+  uint64_t num_priority_yields = 0;
+  uint64_t priority_yield_us = 0;
+
+  /*! \brief Add the counters of another one. */
+  void Merge(const VMStats& other);
+};
+
+/*!
+ * \brief The host objects of the finished calls of a context, which are reused by the following
+ * calls, and by the following contexts once the run is finished, instead of being reallocated.
+ */
+struct VMContextPool {
+  /*! \brief The popped frames, whose register files are released but keep their capacity. */
+  std::vector<VMFrame> frames;
+  /*!
+   * \brief The tuple or closure last allocated by each AllocTuple or AllocClosure instruction,
+   * which is updated in place by the instruction when nothing else refers to it.
+   */
+  std::unordered_map<const Instruction*, ObjectPtr<Object>> values;
+};
+
+class HostEvent;
+class HostStream;
+class ExecutionArbiter;
+
 /*!
  * \brief VMContextObj holds the runtime data for an execution in the VM.
  */
@@ -135,14 +206,36 @@ class VMContextObj : public ValueObj {
   std::vector<std::vector<std::shared_ptr<Event>>> events;
   /*! \brief The events used in stream barrier. */
   std::vector<std::shared_ptr<Event>> barrier_events;
+  /*! \brief The events used in add and wait event on the host streams. */
+  std::vector<std::shared_ptr<HostEvent>> host_events;
   /*! \brief The streams used in runtime. */
   std::vector<std::vector<std::shared_ptr<Stream>>> streams;
+  /*!
+   * \brief The stream used as the default stream (stream 0) of this context. It is only set in the
+   * concurrent mode, otherwise the CUDA default stream is used.
+   */
+  std::shared_ptr<Stream> default_stream;
+  /*!
+   * \brief Whether all stream ids are mapped to the default stream. It is set for the contexts that
+   * capture CUDA graphs, so the work on every stream, e.g., the collective communication, is
+   * recorded on the capturing stream.
+   */
+  bool single_stream{false};
+  /*!
+   * \brief Whether the streams of the context are the high priority compute streams, which is set
+   * for the contexts of the high-priority VMs (see VirtualMachine::SetPriority).
+   */
+  bool high_priority{false};
   /*! \brief The index of the barrier event to use for next stream barrier. */
   Index current_barrier_event_index{0};
   /*! \brief The index of current device id to launch kernels. */
   Index current_device_id{0};
   /*! \brief The index of current working stream into cuda_streams. 0 indicates default stream. */
   Index current_stream_id{0};
+  /*! \brief The statistics of the current execution, which are merged into the VM by Run. */
+  VMStats stats;
+  /*! \brief The reusable host objects of the finished calls. */
+  VMContextPool pool;
 
   void VisitAttrs(tvm::AttrVisitor* v) {
     v->Visit("func_index", &func_index);
@@ -210,28 +303,145 @@ class VMContext : public Value {
   RAF_MUTABLE_OBJECT_REF(VMContext, Value, VMContextObj);
 };
 
-using OpEnvCache = MetaCache<OpEnvPtr>;
+/*! \brief The completion state of an asynchronous run, which is shared with the host callback. */
+struct VMFutureState {
+  /*! \brief Whether the run is completed. */
+  bool done{false};
+  /*! \brief The error message if the run failed. */
+  std::string error;
+  std::mutex mu;
+  std::condition_variable cv;
+};
+
+/*!
+ * \brief The future of an asynchronous run of the VM. It is completed by a host callback on the
+ * stream of the run, so the calling thread is free until it waits for the result. The future
+ * should be kept until the run is completed, as it keeps the context of the run alive.
+ */
+class VMFutureObj : public ValueObj {
+ public:
+  /*! \brief The return value of the run, which can be read once the run is completed. */
+  Value result;
+  /*! \brief The context of the run. */
+  VMContext ctx;
+  /*! \brief The completion state. */
+  std::shared_ptr<VMFutureState> state;
+
+  void VisitAttrs(tvm::AttrVisitor* v) {
+  }
+  static constexpr const uint32_t _type_index = ir::TypeIndex::kDynamic;
+  static constexpr const char* _type_key = "raf.vm.VMFuture";
+  RAF_FINAL_OBJECT(VMFutureObj, ValueObj);
+};
+
+class VMFuture : public Value {
+ public:
+  static VMFuture make(VMContext ctx);
+  /*!
+   * \brief Check whether the run is completed without blocking.
+   * \return Whether the run is completed.
+   */
+  bool IsReady() const;
+  /*!
+   * \brief Block the calling thread until the run is completed. It fails if the run failed.
+   * \return The return value of the run.
+   */
+  Value Get() const;
+  /*!
+   * \brief The host callback that completes a run.
+   * \param data The pointer to a std::shared_ptr<VMFutureState>, which is deleted by the callback.
+   */
+  static void Complete(void* data);
+
+  RAF_MUTABLE_OBJECT_REF(VMFuture, Value, VMFutureObj);
+};
+
+/*!
+ * \brief Copy the tensors of a value on the GPUs to the pinned host memory asynchronously, e.g.,
+ * the loss of a training step. The copies are issued on the device-to-host copy streams after the
+ * pending kernels of the default streams, and the returned future is completed by the device, so
+ * the host does not wait for the step until the result is read. The tensors on the host are not
+ * copied.
+ * \param value The value to copy, which is a tensor or a tuple.
+ * \return The future of the copied value.
+ */
+VMFuture CopyToHostAsync(const Value& value);
+
+/*!
+ * \brief The OpEnv cache for an instruction. The first dispatched OpEnv is kept aside with its key,
+ * so that instructions with static shapes, which always hit the first entry, can be served without
+ * taking the lock and hashing the key of the cache. A cached OpEnv can be replaced, e.g., the
+ * fallback OpEnv by the optimized one built in the background, and the replaced OpEnvs are kept
+ * alive along with the cache, as the pointers returned by Get may still be used.
+ */
+class OpEnvCache {
+ public:
+  /*!
+   * \brief Get the cached OpEnv.
+   * \param key The binary key of the argument types.
+   * \return The cached OpEnv, or nullptr if not found.
+   */
+  const OpEnvPtr* Get(const std::vector<uint8_t>& key);
+
+  /*!
+   * \brief Cache an OpEnv. If another thread has cached an OpEnv with the same key in the meantime,
+   * the existing one is kept.
+   * \param key The binary key of the argument types.
+   * \param op_env The OpEnv to be cached.
+   * \return The cached OpEnv of the key.
+   */
+  OpEnvPtr Set(const std::vector<uint8_t>& key, OpEnvPtr op_env);
+
+  /*!
+   * \brief Replace the cached OpEnv of a key atomically, so that the following Get of the key
+   * returns the new OpEnv.
+   * \param key The binary key of the argument types, which must be cached.
+   * \param op_env The new OpEnv.
+   */
+  void Replace(const std::vector<uint8_t>& key, OpEnvPtr op_env);
+
+ private:
+  /*! \brief Keep an OpEnv alive along with the cache. It must be called with mu_ held. */
+  const OpEnvPtr* Keep(OpEnvPtr op_env);
+
+  /*! \brief The key of the first cached OpEnv, which is immutable once first_op_env_ is set. */
+  std::vector<uint8_t> first_key_;
+  /*! \brief The first cached OpEnv, or nullptr if no OpEnv is cached. */
+  std::atomic<const OpEnvPtr*> first_op_env_{nullptr};
+  /*! \brief The cache of the rest OpEnvs. */
+  MetaCache<std::shared_ptr<std::atomic<const OpEnvPtr*>>> cache_;
+  /*! \brief The cached and replaced OpEnvs, whose addresses are stable. */
+  std::deque<OpEnvPtr> op_envs_;
+  /*! \brief The mutex to set OpEnvs. */
+  std::mutex mu_;
+};
 
 /*! \brief The OpEnv cache for a VM function. */
 class VMFuncOpEnvCache {
  public:
+  /*!
+   * \brief Create the OpEnv cache for a VM function.
+   * \param num_instructions The number of instructions in the function.
+   */
+  explicit VMFuncOpEnvCache(size_t num_instructions);
+
   /*!
    * \brief Get the OpEnv cache for a given instruction.
    * \param pc The program counter
    * \return The OpEnv cache.
    */
-  std::shared_ptr<OpEnvCache> Get(Index pc);
+  OpEnvCache* Get(Index pc) {
+    return cache_list_[pc].get();
+  }
 
   /*!
-   * \brief Clear the OpEnv cache.
+   * \brief Clear the OpEnv cache. This must not be called while the function is running.
    */
   void Clear();
 
  private:
-  /*! \brief Cache map from instruction index to OpEnv cache. */
-  std::unordered_map<Index, std::shared_ptr<OpEnvCache>> cache_map_;
-  /*! \brief The mutex for the cache_map_. */
-  std::mutex mu_;
+  /*! \brief The OpEnv caches indexed by the program counter. */
+  std::vector<std::unique_ptr<OpEnvCache>> cache_list_;
 };
 
 /*!
@@ -257,7 +467,45 @@ class VirtualMachine : public tvm::runtime::ModuleNode {
 #endif
     if (enable_cuda_graph_) {
       LOG(WARNING) << "Concurrent execution is not supported for VM in CUDA graph mode.";
+#ifdef RAF_USE_CUDA
+      const char* cache_size = getenv("RAF_CUDA_GRAPH_CACHE_SIZE");
+      if (cache_size != nullptr) {
+        cuda_graph_cache_size_ = std::max(1, atoi(cache_size));
+      }
+#endif
+    }
+    const char* fast_dispatch = getenv("RAF_VM_FAST_DISPATCH");
+    if (fast_dispatch != nullptr && strcmp(fast_dispatch, "0") == 0) {
+      fast_dispatch_ = false;
+    }
+    const char* pinned_staging = getenv("RAF_VM_PINNED_CONST_STAGING");
+    if (pinned_staging != nullptr && strcmp(pinned_staging, "1") == 0) {
+      pinned_const_staging_ = true;
     }
+    const char* compact_threshold = getenv("RAF_MEMORY_COMPACT_THRESHOLD");
+    if (compact_threshold != nullptr) {
+      compact_threshold_ = atof(compact_threshold);
+    }
+    const char* compact_window = getenv("RAF_MEMORY_COMPACT_WINDOW");
+    if (compact_window != nullptr) {
+      compact_window_ = std::max(1, atoi(compact_window));
+    }
+    const char* background_jit = getenv("RAF_VM_BACKGROUND_JIT");
+    if (background_jit != nullptr && atoi(background_jit) > 0 && !enable_cuda_graph_) {
+      SetBackgroundJit(atoi(background_jit));
+    }
+    // The contexts in the spare pools keep their memory for the next runs, which is released
+    // first when an allocation runs out of memory.
+    release_name_ = "raf.vm." + std::to_string(reinterpret_cast<uintptr_t>(this));
+    memory_pool::Memory::RegisterRelease(release_name_, [this](const Device& dev) {
+      std::lock_guard<std::mutex> lock(spare_pools_mu_);
+      spare_pools_.clear();
+    });
+  }
+
+  virtual ~VirtualMachine() {
+    StopBackgroundJit();
+    memory_pool::Memory::RemoveRelease(release_name_);
   }
 
   const char* type_key() const final {
@@ -292,6 +540,58 @@ class VirtualMachine : public tvm::runtime::ModuleNode {
    * \param devices The set of devices.
    */
   void SetDevices(const std::vector<Device>& devices);
+  /*!
+   * \brief Charge the memory allocated by this VM to the quotas of a tenant (see
+   * memory_pool::MemoryQuota), e.g., when several models share a GPU.
+   * \param name The name of the tenant, or an empty string to not charge the allocations.
+   */
+  void SetMemoryTenant(const std::string& name);
+  /*!
+   * \brief Enable or disable the concurrent mode, in which multiple VM contexts can run on the
+   * same VM from different threads. In this mode the OpEnvs are shared by all contexts, while
+   * workspace and stream requests are bound per launch, and each context runs on its own CUDA
+   * stream. It cannot be used along with CUDA graph.
+   * \param concurrent Whether to enable the concurrent mode.
+   */
+  void SetConcurrent(bool concurrent);
+  /*!
+   * \brief Set the priority class of the runs of this VM against the other VMs on the same device,
+   * e.g., the online requests and the batch jobs sharing a GPU. The contexts of a high-priority VM
+   * run on the high priority compute streams, and a low-priority run stops at the next kernel
+   * launching instruction while any high-priority run is pending on the device (see
+   * ExecutionArbiter). A CUDA VM must be in the concurrent mode to run on its own streams, and
+   * the priority cannot be used along with CUDA graph.
+   * \param priority Positive for high priority, negative for low priority, and 0 for the normal
+   * runs, which are not arbitrated.
+   */
+  void SetPriority(int priority);
+  /*!
+   * \brief Enable or disable the background JIT. When enabled, an OpEnv cache miss that would JIT
+   * compile (and tune) a kernel is served by a fallback that is ready without compilation (see
+   * op::DispatchFallback), while the optimized OpEnv is built on a background thread and replaces
+   * the fallback in the cache once it is ready. The misses without a fallback are dispatched as
+   * usual. It cannot be used along with CUDA graph, and must not be called along with other runs
+   * of the VM. It can also be enabled by setting the environment variable RAF_VM_BACKGROUND_JIT to
+   * the number of threads.
+   * \param num_threads The number of background threads, where 0 disables the background JIT and
+   * drops the pending builds.
+   */
+  void SetBackgroundJit(int num_threads);
+  /*!
+   * \brief Wait for the pending background builds. The built OpEnvs replace their fallbacks at
+   * the next InvokeJit of any context.
+   */
+  void SyncBackgroundJit();
+  /*!
+   * \brief Dispatch and JIT compile all OpEnvs of a function ahead of the first run. The function
+   * is walked through in the dryrun mode to resolve the argument types of every InvokeJit, and
+   * then the OpEnvs are dispatched on a pool of threads and added to the OpEnv cache. It must not
+   * be called along with other runs of the VM.
+   * \param func_name The entry function name.
+   * \param inputs The inputs to the function, of which only the types matter.
+   * \param num_threads The number of threads. Non-positive means the number of hardware threads.
+   */
+  void Prewarm(const std::string& func_name, const std::vector<Value>& inputs, int num_threads);
   /*!
    * \brief Prepare a VM runtime context.
    * \param func_name The entry function name.
@@ -299,12 +599,47 @@ class VirtualMachine : public tvm::runtime::ModuleNode {
    * \return The VM context.
    */
   VMContext PrepareVMContext(const std::string& func_name, const std::vector<Value>& inputs);
+  /*!
+   * \brief Bind the parameters of a function, e.g., the weights of a model, which are copied to
+   * the device once and kept in the VM. The following PrepareVMContext of the function only takes
+   * the unbound parameters in their order, so the bound ones are not passed and copied per run.
+   * Binding again replaces the previous binding, and an empty map unbinds all parameters. It must
+   * not be called along with other runs of the VM.
+   * \param func_name The function name.
+   * \param params The map from the parameter names to their values.
+   */
+  void BindParams(const std::string& func_name, const Map<String, Value>& params);
+  /*!
+   * \brief Evict a function loaded by PrepareVMContext, e.g., a head or a bucket that is not
+   * served anymore. The OpEnvs and the device constants of the function and its callees are
+   * released, unless they are used by another loaded function, and are materialized again at the
+   * next PrepareVMContext of the function. It must not be called while the function is running.
+   * \param func_name The entry function name.
+   */
+  void EvictFunction(const std::string& func_name);
+  /*!
+   * \brief Start copying the inputs of a future run to the device, so that the copy of the next
+   * batch overlaps with the current run. The host tensors are staged in the pinned (CUDA host)
+   * memory pool and copied on the MemCpyCpuToCuda stream. The next PrepareVMContext that takes
+   * the same host tensors uses the device copies, and its stream waits for the copy to finish.
+   * Note that the host tensors are staged at the time of prefetching. It is a no-op if the VM is
+   * not on CUDA.
+   * \param inputs The inputs of the future run.
+   */
+  void Prefetch(const std::vector<Value>& inputs);
   /*!
    * \brief Run the virtual machine.
    * \param ctx The runtime context.
    * \return The return value.
    */
   Value Run(VMContext ctx);
+  /*!
+   * \brief Run the virtual machine without waiting for the device. The instructions are executed
+   * on the calling thread, and the returned future is completed when the device finishes the run.
+   * \param ctx The runtime context.
+   * \return The future of the return value.
+   */
+  VMFuture RunAsync(VMContext ctx);
   /*!
    * \brief Profile the end-to-end execution latency using virtual machine.
 
@@ -334,10 +669,52 @@ class VirtualMachine : public tvm::runtime::ModuleNode {
    * \return A list of latency numbers in milliseconds (length of the list equals 'repeat').
    */
   Array<FloatValue> Profile(VMContext ctx, int warmup, int number, int repeat);
+  /*!
+   * \brief Get the statistics counters accumulated since the VM is created or the last reset.
+   * They are always maintained, so they can be exported to monitoring without the profiler.
+   * \return A map from the counter name to its value, where "instructions" maps the opcode names
+   * to the numbers of executed instructions.
+   */
+  Map<String, ObjectRef> GetStats();
+  /*! \brief Reset the statistics counters. */
+  void ResetStats();
 
  protected:
+  /*!
+   * \brief Run the virtual machine.
+   * \param ctx The runtime context.
+   * \param sync Whether to wait for the stream of the context in the concurrent mode.
+   * \return The return value.
+   */
+  Value Run(VMContext ctx, bool sync);
+  /*!
+   * \brief Release the values held by the pool of a finished context, and keep the pool for the
+   * following contexts.
+   * \param ctx The runtime context.
+   */
+  void RecyclePool(VMContext& ctx);
   /*! \brief Get device for params. */
   Device GetParamsDevice() const;
+  /*!
+   * \brief Whether the CPU ops of the non-default streams run on the host streams. It is the case
+   * on the CPU with a multi-stream schedule, except in the concurrent and the dryrun mode.
+   */
+  bool UseHostStreams() const;
+  /*!
+   * \brief Get the host stream of the id, which is created on the first use.
+   * \param stream_id The stream id, which must be non-zero.
+   * \return The host stream.
+   */
+  std::shared_ptr<HostStream> GetHostStream(Index stream_id);
+  /*!
+   * \brief Get the host event of the id, which is created on the first use.
+   * \param ctx The VM context.
+   * \param event_id The event id.
+   * \return The host event.
+   */
+  std::shared_ptr<HostEvent> GetHostEvent(const VMContext& ctx, Index event_id);
+  /*! \brief Wait for the tasks on all host streams, e.g., before reading tensors on the host. */
+  void SyncHostStreams();
   /*!
    * \brief Allocate memory on given device. For cuda device, it would allocate asynchronously on
    * current stream.
@@ -345,13 +722,42 @@ class VirtualMachine : public tvm::runtime::ModuleNode {
    * \param dev The device to allocate memory from.
    * \param nbytes The number of bytes.
    * \param alignment The alignment requirement.
+   * \param op_env The OpEnv that requests the memory as its workspace, if any.
    * \return The allocated memory.
    */
   inline std::shared_ptr<Memory> Alloc(const VMContext& ctx, Device dev, int64_t nbytes,
-                                       int64_t alignment = kDefaultMemoryAlignment) const;
+                                       int64_t alignment = kDefaultMemoryAlignment,
+                                       const OpEnv* op_env = nullptr) const;
+  /*! \brief Allocate the memory from the pool without charging it to the tenant. */
+  inline std::shared_ptr<Memory> AllocFromPool(const VMContext& ctx, Device dev, int64_t nbytes,
+                                               int64_t alignment, const OpEnv* op_env) const;
+  /*! \brief Bind the distributed and stream requests of a newly dispatched OpEnv. */
+  void InitOpEnvRequests(const VMContext& ctx, const OpEnvPtr& op_env);
+  /*! \brief Block a low-priority run until the high-priority runs of the device are done. */
+  void YieldToHighPriority(VMContext& ctx);
+  /*! \brief Replace the fallbacks with the OpEnvs built in the background, bound to the context. */
+  void InstallBackgroundJits(const VMContext& ctx);
+  /*! \brief Build the optimized OpEnvs of the queued jobs, which runs on a background thread. */
+  void BackgroundJitWorker();
+  /*! \brief Stop the background threads, which drops the pending builds. */
+  void StopBackgroundJit();
+  /*!
+   * \brief Bind the workspace and stream requests of a shared OpEnv to the given context before
+   * launching it in the concurrent mode. The caller must hold launch_mu_.
+   */
+  void BindConcurrentRequests(const VMContext& ctx, const OpEnvPtr& op_env);
   /*! \brief Run VM dispatch loop. */
   virtual void RunLoop(VMContext& ctx);
-  /*! \brief Prepare an OpEnv with its inputs and output */
+  /*!
+   * \brief Run VM dispatch loop with a computed-goto dispatch table and non-virtual handlers.
+   * It is used by RunLoop when fast_dispatch_ is set and instruction-level profiling is disabled.
+   */
+  void RunLoopFast(VMContext& ctx);
+  /*!
+   * \brief Prepare an OpEnv with its inputs and output. The returned string is the readable
+   * representation of the argument types for profiling, which is only generated when the profiler
+   * is enabled.
+   */
   virtual std::tuple<OpEnvPtr, std::vector<Value>, Value, std::string> PrepareOpEnv(
       const VMContext& ctx, const Instruction& instr);
   /*! \brief Handle Move instruction*/
@@ -370,6 +776,8 @@ class VirtualMachine : public tvm::runtime::ModuleNode {
   virtual void HandleAllocTensor(VMContext& ctx, const Instruction& instr);
   /*! \brief Handle AllocTensorReg instruction*/
   virtual void HandleAllocTensorReg(VMContext& ctx, const Instruction& instr);
+  /*! \brief Handle AllocOwnedTensor instruction*/
+  virtual void HandleAllocOwnedTensor(VMContext& ctx, const Instruction& instr);
   /*! \brief Handle AllocTuple instruction*/
   virtual void HandleAllocTuple(VMContext& ctx, const Instruction& instr);
   /*! \brief Handle AllocClosure instruction*/
@@ -382,6 +790,18 @@ class VirtualMachine : public tvm::runtime::ModuleNode {
   virtual void HandleInvokeClosure(VMContext& ctx, const Instruction& instr);
   /*! \brief Handle InvokeJit instruction*/
   virtual void HandleInvokeJit(VMContext& ctx, const Instruction& instr);
+  /*! \brief Launch the OpEnv prepared for the current InvokeJit instruction. */
+  void LaunchOpEnv(VMContext& ctx, const OpEnvPtr& op_env, const std::vector<Value>& inputs,
+                   const Value& output, const std::string& op_env_cache_key);
+  /*! \brief Get the CUDA stream of the current instruction, or nullptr without CUDA. */
+  void* GetCurrentCUDAStream(const VMContext& ctx) const;
+  /*!
+   * \brief Launch the groupable OpEnv of the current InvokeJit instruction and the ones of the
+   * following InvokeJit instructions in one NCCL group, as long as only the instructions which
+   * neither launch nor free anything are in between.
+   */
+  void LaunchCollectiveGroup(VMContext& ctx, OpEnvPtr op_env, std::vector<Value> inputs,
+                             Value output);
   /*! \brief Handle SetShape instruction*/
   virtual void HandleSetShape(VMContext& ctx, const Instruction& instr);
   /*! \brief Handle Ret instruction and return whether it's the final return instruction. */
@@ -398,6 +818,15 @@ class VirtualMachine : public tvm::runtime::ModuleNode {
   virtual void HandleCudaStreamBarrier(VMContext& ctx, const Instruction& instr);
 
  protected:
+  /*!
+   * \brief Load an entry function, which creates the OpEnv caches of the function and the
+   * functions it calls.
+   * \param func_index The index of the entry function.
+   */
+  void LoadFunction(Index func_index);
+  /*! \brief Get the functions reachable from the entry functions, including themselves. */
+  std::vector<bool> GetReachableFunctions(const std::unordered_set<Index>& entries) const;
+
   /*! \brief The virtual machine's packed function table. */
   std::vector<PackedFunc> packed_funcs_;
   /*! \brief The executable the VM will operate on. */
@@ -413,15 +842,139 @@ class VirtualMachine : public tvm::runtime::ModuleNode {
   std::vector<Value> const_pool_;
   /*!
    * \brief OpEnv cache. Each element in the vector stores the cache for the
-   * corresponding VM function. It's a map from pc to the OpEnv cache.
+   * corresponding VM function. It's a map from pc to the OpEnv cache. The cache of a function is
+   * created when an entry function that calls it is loaded, and is null otherwise.
    */
   std::vector<std::shared_ptr<VMFuncOpEnvCache>> op_env_cache_;
+  /*! \brief The functions called by each function, by InvokeFunc or AllocClosure. */
+  std::vector<std::vector<Index>> func_callees_;
+  /*! \brief The constants loaded by each function. */
+  std::vector<std::vector<Index>> func_constants_;
+  /*! \brief The entry functions loaded by PrepareVMContext and not evicted. */
+  std::unordered_set<Index> loaded_entries_;
+  /*! \brief The mutex to load and evict the functions. */
+  std::mutex load_mu_;
+  /*!
+   * \brief The number of events used by CudaAddEvent and CudaWaitEvent on each device, which are
+   * preallocated for each context so that the instructions do not allocate events.
+   */
+  std::vector<Index> num_events_;
+  /*! \brief The device of the stream barrier event, or -1 if there is no stream barrier. */
+  Index barrier_device_id_ = -1;
+  /*! \brief The number of streams used by the executable. */
+  Index num_streams_ = 0;
+  /*! \brief The parameters of a function bound by BindParams. */
+  struct BoundParams {
+    /*! \brief The bound values on the device, which are undefined for the unbound parameters. */
+    std::vector<Value> values;
+    /*! \brief The number of the unbound parameters. */
+    size_t num_unbound;
+  };
+  /*! \brief The map from the function index to its bound parameters. */
+  std::unordered_map<Index, BoundParams> bound_params_;
+  /*!
+   * \brief The host streams, which run the CPU ops of the non-default streams in parallel. The ops
+   * of the default stream run on the calling thread.
+   */
+  std::vector<std::shared_ptr<HostStream>> host_streams_;
   /*! \brief Indicates whether to dryrun (skip op execution). */
   bool dryrun_ = false;
   /*! \brief Indicates whether CUDA is used. */
   bool use_cuda_ = false;
   /*! \brief Indicates whether CUDA Graph is enabled when VM is initialized. */
   bool enable_cuda_graph_ = false;
+  /*!
+   * \brief Indicates whether to use the fast dispatch loop, which bypasses the virtual handlers.
+   * Subclasses that override any handler must unset it. It can also be disabled by setting the
+   * environment variable RAF_VM_FAST_DISPATCH=0.
+   */
+  bool fast_dispatch_ = true;
+  /*!
+   * \brief Indicates whether to pin the pages of memory-mapped constants when uploading them to
+   * the device. It can be enabled by setting the environment variable
+   * RAF_VM_PINNED_CONST_STAGING=1.
+   */
+  bool pinned_const_staging_ = false;
+  /*! \brief An OpEnv whose dispatch is deferred by Prewarm. */
+  struct PrewarmJob {
+    /*! \brief The OpEnv cache of the instruction. */
+    OpEnvCache* cache;
+    /*! \brief The cache key of the OpEnv. */
+    std::vector<uint8_t> key;
+    /*! \brief The call values to dispatch the OpEnv. */
+    CallValues call_values;
+  };
+  /*! \brief The deferred OpEnvs collected during Prewarm, or nullptr if not prewarming. */
+  std::vector<PrewarmJob>* prewarm_jobs_ = nullptr;
+  /*! \brief An optimized OpEnv built in the background, which replaces its fallback. */
+  struct BackgroundJitJob {
+    /*! \brief The OpEnv cache of the function, which is kept alive until the job is done. */
+    std::shared_ptr<VMFuncOpEnvCache> func_cache;
+    /*! \brief The program counter of the instruction. */
+    Index pc;
+    /*! \brief The cache key of the OpEnv. */
+    std::vector<uint8_t> key;
+    /*! \brief The callee to dispatch. */
+    Value callee;
+    /*!
+     * \brief The arguments and the output, whose tensors only carry their types without buffers, so
+     * that the buffers of the running context are neither held nor touched by the build.
+     */
+    Array<Value> args;
+    Value output;
+    /*! \brief The device to dispatch on. */
+    Device device;
+    /*! \brief The dialect preference of the context, if any. */
+    Array<String> preferred_dialects;
+    bool has_dialect_preference;
+    /*! \brief The built OpEnv, or nullptr if the build failed. */
+    OpEnvPtr op_env;
+  };
+  /*! \brief The background threads to build the optimized OpEnvs. */
+  std::vector<std::thread> jit_threads_;
+  /*! \brief The queued and the built background jobs. */
+  std::deque<BackgroundJitJob> jit_queue_;
+  std::vector<BackgroundJitJob> jit_ready_;
+  /*! \brief The number of the queued and running background jobs. */
+  size_t num_pending_jits_ = 0;
+  /*! \brief The number of the built jobs, which is checked by InvokeJit without taking the lock. */
+  std::atomic<size_t> num_ready_jits_{0};
+  /*! \brief Indicates whether the background threads should exit. */
+  bool jit_stop_ = false;
+  /*! \brief The mutex and the condition variables of the background jobs. */
+  std::mutex jit_mu_;
+  std::condition_variable jit_cv_;
+  std::condition_variable jit_done_cv_;
+  /*! \brief Indicates whether multiple VM contexts may run concurrently. */
+  bool concurrent_ = false;
+  /*! \brief Serializes the request binding and launching of shared OpEnvs in concurrent mode. */
+  std::mutex launch_mu_;
+  /*! \brief The number of contexts created in concurrent mode, used to assign their streams. */
+  std::atomic<int> num_concurrent_ctxs_{0};
+  /*! \brief The pools of the finished runs, which are taken by the following contexts. */
+  std::vector<VMContextPool> spare_pools_;
+  /*! \brief The mutex to access spare_pools_. */
+  std::mutex spare_pools_mu_;
+  /*! \brief The name of the function that releases the spare pools when out of memory. */
+  std::string release_name_;
+  /*! \brief The priority class of the runs, and the arbiter of the device if it is not normal. */
+  int priority_ = 0;
+  ExecutionArbiter* arbiter_ = nullptr;
+  /*! \brief The name of the tenant that the allocations are charged to. */
+  std::string memory_tenant_;
+  /*! \brief The quotas of the tenant on the devices. */
+  std::vector<std::pair<Device, std::shared_ptr<memory_pool::MemoryQuota>>> memory_quotas_;
+  /*!
+   * \brief The ratio of the pool size to the recent peak usage, above which the memory pools are
+   * compacted at the beginning of a run (RAF_MEMORY_COMPACT_THRESHOLD). 0 disables compaction.
+   */
+  double compact_threshold_ = 0;
+  /*! \brief The number of runs whose peak usages are considered (RAF_MEMORY_COMPACT_WINDOW). */
+  int compact_window_ = 10;
+  /*! \brief The statistics merged from the finished executions. */
+  VMStats stats_;
+  /*! \brief The mutex to access stats_. */
+  std::mutex stats_mu_;
 
 #ifdef RAF_USE_CUDA
   /*!
@@ -430,14 +983,62 @@ class VirtualMachine : public tvm::runtime::ModuleNode {
    * Cached CUDA Graph is stored in this class, as well as stream for capturing.
    */
   class CudaGraphImpl;
-  /*! \brief A pointer into the CUDA Graph instance. */
-  CudaGraphImpl* cuda_graph_impl_ = nullptr;
-  /*! \brief The context associated with the captured CUDA graph. */
+  /*! \brief A captured CUDA graph along with the context it was captured with. */
+  struct CudaGraphEntry {
+    /*! \brief The context whose inputs and registers are baked into the graph. */
+    VMContext ctx;
+    /*! \brief The captured CUDA graph, or nullptr if it has not been captured yet. */
+    std::shared_ptr<CudaGraphImpl> impl;
+  };
+  /*!
+   * \brief The captured CUDA graphs keyed by the entry function and input shapes, ordered from the
+   * most to the least recently used. The memory of an evicted graph is released with its context.
+   */
+  std::list<std::pair<std::string, CudaGraphEntry>> cuda_graph_lru_;
+  /*! \brief The map from the key of a CUDA graph to its position in cuda_graph_lru_. */
+  std::unordered_map<std::string, std::list<std::pair<std::string, CudaGraphEntry>>::iterator>
+      cuda_graph_map_;
+  /*!
+   * \brief The maximum number of cached CUDA graphs, which can be set by the environment variable
+   * RAF_CUDA_GRAPH_CACHE_SIZE.
+   */
+  size_t cuda_graph_cache_size_ = 8;
+  /*! \brief The CUDA graph entry of the context in use. */
+  CudaGraphEntry* cuda_graph_entry_ = nullptr;
+  /*! \brief The context associated with the CUDA graph in use. */
   VMContext cuda_graph_ctx_;
   /*! \brief Indicate whether the CUDA graph is currently in use by a context. */
   bool cuda_graph_occupied_ = false;
+  /*! \brief Indicate whether a CUDA graph is being captured. */
+  bool capturing_cuda_graph_ = false;
   /*! \brief The mutex to access CUDA graph related fields. */
   std::mutex cuda_graph_mutex_;
+  /*! \brief The inputs of a future run that are being copied to the device. */
+  struct PrefetchedInputs {
+    /*! \brief The host data of the inputs, which identifies the run that takes them. */
+    std::vector<const void*> keys;
+    /*! \brief The inputs on the device. */
+    std::vector<Value> inputs;
+    /*! \brief The pinned staging buffers, which are released after the copy is done. */
+    std::vector<std::shared_ptr<Memory>> staging;
+    /*! \brief The event recorded on the copy stream after the copy. */
+    std::shared_ptr<Event> ready;
+  };
+  /*!
+   * \brief Take the prefetched inputs of a run, and make the CUDA default stream wait for them.
+   * The prefetches issued before them are discarded.
+   * \param inputs The host inputs of the run.
+   * \param device_inputs The prefetched inputs on the device.
+   * \return The event of the copy, or nullptr if the inputs are not prefetched.
+   */
+  std::shared_ptr<Event> TakePrefetched(const std::vector<Value>& inputs,
+                                        std::vector<Value>* device_inputs);
+  /*! \brief The prefetched inputs in the order of prefetching. */
+  std::deque<PrefetchedInputs> prefetched_;
+  /*! \brief The taken prefetches whose staging buffers may still be in use by the copy. */
+  std::vector<PrefetchedInputs> retired_prefetches_;
+  /*! \brief The mutex to access the prefetched inputs. */
+  std::mutex prefetch_mu_;
 #endif
 };
 
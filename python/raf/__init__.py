@@ -6,9 +6,12 @@
 __version__ = "0.0.2.dev"
 
 from ._core.ndarray import array, ndarray
+from ._core.lazy import lazy
 from ._op.imp import *  # pylint: disable=redefined-builtin
 from . import frontend
 from . import amp
+from . import quantize
+from . import sparsity
 from . import random
 from . import build
 from . import ir
@@ -22,5 +22,16 @@ class CUDNNConfig:  # pylint: disable=too-few-public-methods
         """Set the benchmark flag."""
         _ffi.backend.cudnn.ConfigSetBenchmark(benchmark)
 
+    @property
+    def workspace_limit(self):
+        """Get the maximum workspace size in bytes of CUDNN algorithms. A negative value means
+        the limit is derived from the free device memory and the unused memory of the pool."""
+        return _ffi.backend.cudnn.ConfigGetWorkspaceLimit()
+
+    @workspace_limit.setter
+    def workspace_limit(self, workspace_limit):
+        """Set the maximum workspace size in bytes of CUDNN algorithms."""
+        _ffi.backend.cudnn.ConfigSetWorkspaceLimit(workspace_limit)
+
 
 cudnn = CUDNNConfig()
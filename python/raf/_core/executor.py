@@ -93,10 +93,15 @@ class MetaFallbackContext(ApplyHistoryBest):
 
 
 def init_auto_scheduler_dispatch_context():
-    """Initialize auto scheduler dispatch context."""
+    """Initialize auto scheduler dispatch context. If the environment variable RAF_TUNING_LOG
+    is set, the best records in the tuning log are applied to all TVM kernels built in this
+    process, without specifying the schedule file to each executor."""
     verbose = int(os.environ["RAF_SCH_VERBOSE"]) if "RAF_SCH_VERBOSE" in os.environ else 0
     env = MetaFallbackContext(verbose=verbose)
     env.__enter__()
+    log_file = os.environ.get("RAF_TUNING_LOG", "")
+    if log_file and os.path.exists(log_file):
+        auto_scheduler.ApplyHistoryBest(log_file, include_compatible=True).__enter__()
 
 
 init_auto_scheduler_dispatch_context()
@@ -127,11 +132,75 @@ class VMExecutor:
         if "gpu" not in device and "cuda" not in device:
             enable_cuda_graph = False
         self.device = Device(device)
+        self.mod = mod
+        self._enable_cuda_graph = enable_cuda_graph
+        self._dryrun = dryrun
+        self._pass_ctx = tvm.transform.PassContext.current()
         self.executable = vm.compile(mod, self.device)
         self.vm = vm.VirtualMachine(
             self.executable, self.device, enable_cuda_graph=enable_cuda_graph, dryrun=dryrun
         )
 
+    def run_with_memory_fallback(self, *args, budget_ratio=0.8, max_retries=3, **kwargs):
+        """Run the model. If it runs out of memory even after the cached memory is released, the
+        model is recompiled with a tighter rematerialization budget and run again, so that a
+        long-running job degrades gracefully under memory pressure instead of crashing.
+
+        Parameters
+        ----------
+        *args, **kwargs:
+            The arguments of the VM.
+
+        budget_ratio : float
+            The ratio of the new memory budget (i.e., raf.memory_budget) to the previous one. If the
+            model was compiled without a budget, the new budget is the ratio of the memory that the
+            pool had allocated when the model ran out of memory. Default 0.8.
+
+        max_retries : int
+            The maximum number of recompilations. Default 3.
+
+        Returns
+        -------
+        ret : raf.value.Value
+            The result of the VM.
+        """
+        for retry in range(max_retries + 1):
+            try:
+                return self.vm.run(*args, **kwargs)
+            except tvm.TVMError as err:
+                msg = str(err)
+                is_oom = "Out-Of-Memory" in msg or "out of memory" in msg
+                if retry == max_retries or not is_oom:
+                    raise
+            self._recompile_with_budget(budget_ratio)
+        return None
+
+    def _recompile_with_budget(self, budget_ratio):
+        """Recompile the model with a tighter rematerialization budget."""
+        config = dict(self._pass_ctx.config)
+        budget = int(config.get("raf.memory_budget", 0))
+        if budget <= 0:
+            _, allocated = _ffi.memory_pool.GetPoolSize(self.device)
+            budget = int(allocated.value * 2**20)
+        config["raf.memory_budget"] = int(budget * budget_ratio)
+        self._pass_ctx = tvm.transform.PassContext(
+            opt_level=self._pass_ctx.opt_level,
+            required_pass=self._pass_ctx.required_pass,
+            disabled_pass=self._pass_ctx.disabled_pass,
+            config=config,
+        )
+        # Release the memory of the current VM before the recompilation, which profiles the ops.
+        self.vm = None
+        _ffi.memory_pool.ReleaseCachedMemory(self.device)
+        with self._pass_ctx:
+            self.executable = vm.compile(self.mod, self.device)
+        self.vm = vm.VirtualMachine(
+            self.executable,
+            self.device,
+            enable_cuda_graph=self._enable_cuda_graph,
+            dryrun=self._dryrun,
+        )
+
     @staticmethod
     def _make_vm_helper(maker, sch_file=None):
         """
@@ -243,3 +312,263 @@ class VMExecutor:
             return self.vm.run(*args, **kwargs)
 
         return self._make_vm_helper(_maker, sch_file)
+
+
+class BucketedVMExecutor:
+    """A VM executor for the inputs whose lengths vary along an axis, e.g., the sequence length in
+    NLP inference. Each distinct length would trigger the JIT compilation of new kernels on the
+    request path, so the inputs are instead padded up to the smallest of a fixed set of bucket
+    lengths. The model is compiled and warmed up for every bucket ahead of time, so requests of
+    arbitrary lengths hit compiled kernels (and a captured CUDA graph if enabled).
+
+    Parameters
+    ----------
+    model : raf.Model
+        The model to run, which is traced once per bucket.
+
+    device : str
+        The runtime context to run the code on.
+
+    buckets : List[int]
+        The bucket lengths.
+
+    sample_inputs : List[Union[raf.ndarray, np.ndarray]]
+        The sample inputs of any length, of which the dtypes and the other dims are used.
+
+    axis : int
+        The padded axis of the inputs.
+
+    pad_value : Union[int, float]
+        The value to pad the inputs with.
+
+    with_mask : bool
+        Whether to pass a mask of shape (batch, bucket) as the last input of the model, which is 1
+        for the valid positions and 0 for the padding, so the model can mask the padded positions
+        (e.g., in the attention scores).
+
+    mask_dtype : str
+        The dtype of the mask.
+
+    out_axis : Optional[int]
+        The axis to slice the outputs back to the input length. The sliced outputs are returned as
+        numpy arrays. If None, the padded outputs are returned as they are.
+
+    enable_cuda_graph : bool
+        Whether to use CUDA graph.
+
+    opt_level : int
+        The optimization level to compile the model.
+
+    config : Optional[Dict[str, Any]]
+        The pass configs to compile the model.
+    """
+
+    def __init__(
+        self,
+        model,
+        device,
+        buckets,
+        sample_inputs,
+        axis=1,
+        pad_value=0,
+        with_mask=False,
+        mask_dtype="float32",
+        out_axis=None,
+        enable_cuda_graph=False,
+        opt_level=3,
+        config=None,
+    ):
+        # pylint: disable=too-many-arguments,import-outside-toplevel
+        from ..model.trace import _get_func_inputs
+
+        if not buckets:
+            raise ValueError("Must provide at least one bucket.")
+        self.device = device
+        self.buckets = sorted(set(buckets))
+        self.axis = axis
+        self.pad_value = pad_value
+        self.with_mask = with_mask
+        self.mask_dtype = mask_dtype
+        self.out_axis = out_axis
+        self._get_func_inputs = _get_func_inputs
+        # The compiled executor and the traced record of each bucket.
+        self._executors = {}
+        sample_inputs = [self._to_numpy(arg) for arg in sample_inputs]
+        for bucket in self.buckets:
+            args = self._pad(sample_inputs, bucket)
+            record = model._internal(*args)
+            with tvm.transform.PassContext(opt_level=opt_level, config=config or {}):
+                executor = VMExecutor(record.mod, device, enable_cuda_graph=enable_cuda_graph)
+            # The warm-up run JIT compiles all kernels, and captures the CUDA graph if enabled.
+            executor.vm.run(*self._get_func_inputs(record, args, {}, get_handle=False))
+            self._executors[bucket] = (executor, record)
+        tvm.nd.device(device).sync()
+
+    @staticmethod
+    def _to_numpy(arg):
+        import numpy as np  # pylint: disable=import-outside-toplevel
+
+        return arg if isinstance(arg, np.ndarray) else arg.numpy()
+
+    def _pad(self, inputs, bucket):
+        """Pad the numpy inputs to the bucket, and append the mask if needed."""
+        import numpy as np  # pylint: disable=import-outside-toplevel
+        from .ndarray import array  # pylint: disable=import-outside-toplevel
+
+        length = inputs[0].shape[self.axis]
+        args = []
+        for arg in inputs:
+            pad_width = [(0, 0)] * arg.ndim
+            pad_width[self.axis] = (0, bucket - arg.shape[self.axis])
+            padded = np.pad(arg, pad_width, mode="constant", constant_values=self.pad_value)
+            args.append(array(padded, device=self.device))
+        if self.with_mask:
+            mask = np.zeros((inputs[0].shape[0], bucket), dtype=self.mask_dtype)
+            mask[:, :length] = 1
+            args.append(array(mask, device=self.device))
+        return args
+
+    def get_bucket(self, length):
+        """Get the smallest bucket that fits the given length."""
+        for bucket in self.buckets:
+            if bucket >= length:
+                return bucket
+        raise ValueError("Length %d exceeds the largest bucket %d" % (length, self.buckets[-1]))
+
+    def __call__(self, *inputs):
+        """Run the model with the inputs padded to the bucket.
+
+        Parameters
+        ----------
+        inputs : List[Union[raf.ndarray, np.ndarray]]
+            The inputs of the same length along the padded axis, excluding the mask.
+
+        Returns
+        -------
+        result : Object
+            The outputs, which are sliced back to the input length if out_axis is set.
+        """
+        inputs = [self._to_numpy(arg) for arg in inputs]
+        length = inputs[0].shape[self.axis]
+        bucket = self.get_bucket(length)
+        executor, record = self._executors[bucket]
+        args = self._pad(inputs, bucket)
+        out = executor.vm.run(*self._get_func_inputs(record, args, {}, get_handle=False))
+        if self.out_axis is None:
+            return out
+
+        def _unpad(value):
+            if not hasattr(value, "numpy"):
+                return [_unpad(field) for field in value]
+            value = value.numpy()
+            index = [slice(None)] * value.ndim
+            index[self.out_axis] = slice(0, length)
+            return value[tuple(index)]
+
+        return _unpad(out)
+
+
+class BatchingServer:
+    """A dynamic batching server for online inference. The requests are queued in C++ and
+    concatenated along their first axis into a batch, which is flushed when it reaches the largest
+    batch size or when its first request has waited for the timeout. The batch runs on the model
+    compiled for the smallest batch size that fits it, padded with zeros, and the outputs are split
+    back to the requests. The batching runs on a worker thread without the GIL.
+
+    Parameters
+    ----------
+    model : raf.Model
+        The model to run, which is traced once per batch size.
+
+    device : str
+        The runtime context to run the code on.
+
+    batch_sizes : List[int]
+        The batch sizes to compile the model for.
+
+    sample_inputs : List[Union[raf.ndarray, np.ndarray]]
+        The sample inputs of any batch size, of which the dtypes and the other dims are used.
+
+    timeout_us : int
+        The maximum time in microseconds that a request waits for the batch.
+
+    enable_cuda_graph : bool
+        Whether to use CUDA graph. The outputs of the requests are copied out of the batch outputs
+        in this case, as the captured graph reuses the output buffers.
+
+    opt_level : int
+        The optimization level to compile the model.
+
+    config : Optional[Dict[str, Any]]
+        The pass configs to compile the model.
+    """
+
+    def __init__(
+        self,
+        model,
+        device,
+        batch_sizes,
+        sample_inputs,
+        timeout_us=1000,
+        enable_cuda_graph=False,
+        opt_level=3,
+        config=None,
+    ):
+        # pylint: disable=too-many-arguments,too-many-locals,import-outside-toplevel
+        import numpy as np
+        from ..model.trace import _get_func_inputs
+        from .ndarray import array
+
+        if not batch_sizes:
+            raise ValueError("Must provide at least one batch size.")
+        batch_sizes = sorted(set(batch_sizes))
+        sample_inputs = [BucketedVMExecutor._to_numpy(arg) for arg in sample_inputs]
+        # The executors own the executables, which must outlive the server.
+        self._executors = []
+        shared_inputs = []
+        for batch_size in batch_sizes:
+            args = [
+                array(np.zeros((batch_size,) + arg.shape[1:], dtype=arg.dtype), device=device)
+                for arg in sample_inputs
+            ]
+            record = model._internal(*args)
+            with tvm.transform.PassContext(opt_level=opt_level, config=config or {}):
+                executor = VMExecutor(record.mod, device, enable_cuda_graph=enable_cuda_graph)
+            func_inputs = vm._convert_args(_get_func_inputs(record, args, {}, get_handle=False))
+            # The warm-up run JIT compiles all kernels, and captures the CUDA graph if enabled.
+            executor.vm.run(*func_inputs)
+            self._executors.append(executor)
+            shared_inputs = func_inputs[len(sample_inputs) :]
+        self._server = _ffi.vm.BatchingServer(
+            batch_sizes,
+            [executor.vm.module for executor in self._executors],
+            Device(device),
+            shared_inputs,
+            timeout_us,
+            enable_cuda_graph,
+            "main",
+        )
+        self._submit = self._server["submit"]
+
+    def submit(self, *inputs):
+        """Submit a request, which returns without waiting for the batch.
+
+        Parameters
+        ----------
+        inputs : List[Union[raf.ndarray, np.ndarray]]
+            The inputs of the request, of which the first axis is the batch.
+
+        Returns
+        -------
+        future : raf._core.vm.VMFuture
+            The future of the outputs of the request.
+        """
+        import numpy as np  # pylint: disable=import-outside-toplevel
+
+        args = [np.ascontiguousarray(BucketedVMExecutor._to_numpy(arg)) for arg in inputs]
+        return self._submit(*vm._convert_args(args))
+
+    def __del__(self):
+        # The server is stopped before the executors are released, as they own the executables.
+        self._server = None
+        self._submit = None
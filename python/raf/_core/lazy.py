@@ -0,0 +1,43 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+"""The lazy mode of the imperative ops."""
+from .core_utils import set_module
+from .._ffi.binding import SetLazyMode, FlushLazy
+
+
+@set_module("raf")
+class lazy:  # pylint: disable=invalid-name
+    """Record the imperative ops into a pending segment instead of running them one by one. The
+    segment is compiled with the VM, which fuses the ops and plans the memory, and runs once a
+    value of it is observed, e.g., by numpy(), or when the scope exits. The compiled segments are
+    cached by their structural hash, so the same eager code of each iteration is compiled once.
+
+    The ops that require gradients run eagerly as before.
+
+    Examples
+    --------
+
+    .. code-block:: python
+
+        with raf.lazy():
+            y = raf.relu(raf.add(a, b))
+            z = raf.multiply(y, c)
+        # add, relu and multiply run as one compiled segment.
+        print(z.numpy())
+    """
+
+    def __init__(self):
+        self._prev = False
+
+    def __enter__(self):
+        self._prev = SetLazyMode(True)
+        return self
+
+    def __exit__(self, ptype, value, trace):
+        SetLazyMode(self._prev)
+
+    @staticmethod
+    def flush():
+        """Run the pending segment now."""
+        FlushLazy()
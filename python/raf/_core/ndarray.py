@@ -18,6 +18,7 @@ from raf._ffi.binding import (
 )
 from raf._ffi.tensor import MarkNumpy
 from raf._ffi.value import ToTVM
+from raf._ffi.vm import CopyToHostAsync, FutureGet, FutureIsReady
 from raf._lib import _register_func, relay, tvm_ndarray
 from raf._lib import TensorContainer as _DLManagedTensor
 
@@ -87,12 +88,19 @@ class ndarray:  # pylint: disable=invalid-name,too-many-instance-attributes
 
     @__handle.setter
     def __handle(self, handle):
-        value = LookupBoundValue(handle)
+        # The value is looked up on its first use, e.g., by numpy() or shape, so the results that
+        # are only passed to other ops skip the lookup, and the pending results of the lazy mode
+        # are not computed.
         self.__handle_ = handle
-        self.__value = value
+        self.__value_ = None
+
+    def __resolve(self):
+        if self.__value_ is None:
+            self.__value = LookupBoundValue(self.__handle_)
 
     @property
     def __value(self):
+        self.__resolve()
         return self.__value_
 
     @__value.setter
@@ -124,8 +132,26 @@ class ndarray:  # pylint: disable=invalid-name,too-many-instance-attributes
     def numpy(self):
         return ToTVM(self.__value).numpy()  # pylint: disable=protected-access
 
+    def numpy_async(self):
+        """Copy the array to the host without waiting for the device, e.g., to log the loss of
+        each training step without serializing the host and the device.
+
+        Returns
+        -------
+        ret : LazyHostArray
+            The host copy, which is resolved to a numpy array on the first access.
+        """
+        return LazyHostArray(CopyToHostAsync(self.__value))
+
+    def __dlpack__(self, stream=None):
+        return self.__value.__dlpack__(stream)
+
+    def __dlpack_device__(self):
+        return self.__value.__dlpack_device__()
+
     @property
     def device(self):
+        self.__resolve()
         return self.__device
 
     @device.setter
@@ -134,6 +160,7 @@ class ndarray:  # pylint: disable=invalid-name,too-many-instance-attributes
 
     @property
     def ndim(self):
+        self.__resolve()
         return self.__ndim
 
     @ndim.setter
@@ -142,6 +169,7 @@ class ndarray:  # pylint: disable=invalid-name,too-many-instance-attributes
 
     @property
     def dtype(self):
+        self.__resolve()
         return str(self.__dtype)
 
     @dtype.setter
@@ -150,6 +178,7 @@ class ndarray:  # pylint: disable=invalid-name,too-many-instance-attributes
 
     @property
     def shape(self):
+        self.__resolve()
         return self.__shape
 
     @shape.setter
@@ -158,6 +187,7 @@ class ndarray:  # pylint: disable=invalid-name,too-many-instance-attributes
 
     @property
     def strides(self):
+        self.__resolve()
         return self.__strides
 
     @strides.setter
@@ -166,6 +196,7 @@ class ndarray:  # pylint: disable=invalid-name,too-many-instance-attributes
 
     @property
     def byte_offset(self):
+        self.__resolve()
         return self.__byte_offset
 
     @byte_offset.setter
@@ -241,6 +272,34 @@ class ndarray:  # pylint: disable=invalid-name,too-many-instance-attributes
         return ret
 
 
+class LazyHostArray:
+    """The host copy of an ndarray that is copied asynchronously to the pinned host memory. The
+    copy is waited for and converted to a numpy array on the first access."""
+
+    def __init__(self, future):
+        self.__future = future
+        self.__array = None
+
+    def ready(self):
+        """Check whether the copy is done without blocking."""
+        return self.__array is not None or FutureIsReady(self.__future)
+
+    def numpy(self):
+        if self.__array is None:
+            self.__array = ToTVM(FutureGet(self.__future)).numpy()
+            self.__future = None
+        return self.__array
+
+    def item(self):
+        return self.numpy().item()
+
+    def __float__(self):
+        return float(self.numpy())
+
+    def __repr__(self):
+        return repr(self.numpy())
+
+
 class Symbol:
     # pylint: disable=too-few-public-methods, protected-access
     __slots__ = ["__handle"]
@@ -95,8 +95,30 @@ class TensorValue(BaseTensorValue):
     def numpy(self):
         return ToTVM(self).numpy()
 
+    def __dlpack__(self, stream=None):
+        """Export the tensor as a DLPack capsule without copying. Following the DLPack stream
+        semantics, the consumer stream waits for an event recorded after the tensor is produced,
+        so the consumer does not have to synchronize the device.
+
+        Parameters
+        ----------
+        stream : Optional[int]
+            The CUDA stream handle of the consumer. None and 1 are the legacy default stream,
+            2 is the per-thread default stream, and -1 skips the synchronization.
+
+        Returns
+        -------
+        capsule : PyCapsule
+            The DLPack capsule of the tensor.
+        """
+        array = ToTVM(self)
+        ffi.WaitForConsumerStream(self, 1 if stream is None else stream)
+        return array.to_dlpack()
+
+    def __dlpack_device__(self):
+        device = self.dltensor_handle.contents.device
+        return (device.device_type, device.device_id)
 
-@register_node("raf.value.TensorTypeValue")
 class TensorTypeValue(BaseTensorValue):
     # TODO(@hzfan): add constructors
     pass
@@ -22,15 +22,24 @@ class Executable:
         self.mod = mod
         self._function_params = {}
         self._save = self.mod["save"]
+        self._save_to_file = self.mod["save_to_file"]
         self._get_lib = self.mod["get_lib"]
         self._get_bytecode = self.mod["get_bytecode"]
         self._get_stats = self.mod["get_stats"]
         self._get_function_arity = self.mod["get_function_arity"]
         self._get_function_param_name = self.mod["get_function_param_name"]
 
-    def save(self):
+    def save(self, bundle_kernels=False):
         """Save the RAF VM Executable.
 
+        Parameters
+        ----------
+        bundle_kernels : bool
+            Whether to bundle the built kernels and the chosen algorithms, e.g., the TVM modules,
+            the CUTLASS configs and the cuDNN algorithms, into the code, so that loading it on a
+            host with the same device architecture needs no JIT compilation or tuning. Only the
+            kernels that have been built are bundled, so run the executable once before saving.
+
         Returns
         -------
         code : bytearray
@@ -58,6 +67,8 @@ class Executable:
          - Code section. The VM functions, including bytecode, are sitting in
          this section.
 
+         - Kernel section (optional). The bundled kernels and algorithms.
+
         Examples
         --------
 
@@ -91,7 +102,7 @@ class Executable:
             res = des_vm.run(x_data)
             print(res.numpy())
         """
-        return self._save(), self._get_lib()
+        return self._save(bundle_kernels), self._get_lib()
 
     @staticmethod
     def load_exec(bytecode, lib):
@@ -126,6 +137,47 @@ class Executable:
 
         return Executable(_ffi.vm.Load_Executable(bytecode, lib))
 
+    def save_to_file(self, path, bundle_kernels=False):
+        """Save the RAF VM Executable to a file in the mappable format, where the tensor
+        constants are stored as page-aligned blobs. The runtime library is not included and
+        should be exported separately.
+
+        Parameters
+        ----------
+        path : str
+            The path of the file.
+
+        bundle_kernels : bool
+            Whether to bundle the built kernels and the chosen algorithms into the file. See
+            `save` for details.
+        """
+        self._save_to_file(path, bundle_kernels)
+
+    @staticmethod
+    def load_exec_from_file(path, lib):
+        """Load an executable saved by `save_to_file`. The tensor constants are memory-mapped
+        from the file and uploaded to the device on their first use.
+
+        Parameters
+        ----------
+        path : str
+            The path of the file.
+
+        lib : :py:class:`~tvm.runtime.Module`
+            The runtime module that contains the generated code.
+
+        Returns
+        -------
+        exec: Executable
+            An executable constructed using the provided artifacts.
+        """
+        if lib is not None and not isinstance(lib, tvm.runtime.Module):
+            raise TypeError(
+                "lib is expected to be the type of tvm.runtime.Module"
+                + ", but received {}".format(type(lib))
+            )
+        return Executable(_ffi.vm.Load_Executable_From_File(path, lib))
+
     @property
     def lib(self):
         """Get the library that contains hardware dependent code.
@@ -420,6 +472,32 @@ class VMContext(Value):
     """The VMContext holds the runtime data for an execution in the VM."""
 
 
+@register_node("raf.vm.VMFuture")
+class VMFuture(Value):
+    """The future of an asynchronous run of the VM, which is completed when the device finishes
+    the run."""
+
+    def ready(self):
+        """Check whether the run is completed without blocking.
+
+        Returns
+        -------
+        ret : bool
+            Whether the run is completed.
+        """
+        return _ffi.vm.FutureIsReady(self)
+
+    def result(self):
+        """Wait until the run is completed and get the output.
+
+        Returns
+        -------
+        result : Object
+            The output.
+        """
+        return _ffi.vm.FutureGet(self)
+
+
 class VirtualMachine:
     """Relay VM runtime.
 
@@ -436,9 +514,40 @@ class VirtualMachine:
 
     dryrun: bool
         Whether to create a dryrun VM that skips the op execution.
+
+    concurrent: bool
+        Whether to allow running the VM from multiple threads concurrently. Each thread should
+        prepare its own context. Cannot be used along with CUDA graph.
+
+    memory_tenant: Optional[str]
+        The name of the tenant that the memory allocated by the VM is charged to, whose quota is
+        set by raf._ffi.memory_pool.SetQuota. It keeps the models sharing a device from running
+        each other out of memory.
+
+    background_jit: int
+        The number of threads that JIT compile the kernels in the background. When positive, the
+        kernels not in the cache are served by the fallback library kernels (e.g., CuBLAS and
+        CuDNN) until their JIT compiled kernels are ready. Cannot be used along with CUDA graph.
+
+    priority: Optional[str]
+        The priority class of the runs against the other VMs on the same device, either "high"
+        (e.g., online requests) or "low" (e.g., batch jobs). The high-priority runs take the high
+        priority CUDA streams, and the low-priority runs pause launching kernels while any
+        high-priority run is pending. A CUDA VM must be concurrent to run on the prioritized
+        streams. Cannot be used along with CUDA graph.
     """
 
-    def __init__(self, exe, device, enable_cuda_graph=False, dryrun=False):
+    def __init__(
+        self,
+        exe,
+        device,
+        enable_cuda_graph=False,
+        dryrun=False,
+        concurrent=False,
+        memory_tenant=None,
+        background_jit=0,
+        priority=None,
+    ):
         if not isinstance(exe, Executable):
             raise TypeError(
                 "mod is expected to be the type of Executable, but received {}".format(type(exe))
@@ -448,8 +557,57 @@ class VirtualMachine:
         self._set_devices = self.module["set_devices"]
         self._prepare_context = self.module["prepare_context"]
         self._run = self.module["run"]
+        self._run_async = self.module["run_async"]
         self._profile = self.module["profile"]
+        self._bound_params = {}
         self._set_devices(device)
+        if concurrent:
+            self.module["set_concurrent"](True)
+        if memory_tenant is not None:
+            self.set_memory_tenant(memory_tenant)
+        if background_jit > 0:
+            self.set_background_jit(background_jit)
+        if priority is not None:
+            self.set_priority(priority)
+
+    def set_memory_tenant(self, name):
+        """Charge the memory allocated by the VM to the quota of a tenant on each device.
+
+        Parameters
+        ----------
+        name : str
+            The name of the tenant, or an empty string to stop charging the allocations.
+        """
+        self.module["set_memory_tenant"](name)
+
+    def set_background_jit(self, num_threads):
+        """Serve the kernels not in the cache by the fallback library kernels while they are JIT
+        compiled in the background, which are swapped in once they are ready.
+
+        Parameters
+        ----------
+        num_threads : int
+            The number of background JIT threads, or 0 to JIT compile on the critical path.
+        """
+        self.module["set_background_jit"](num_threads)
+
+    def sync_background_jit(self):
+        """Wait for the pending background JIT compilations. The compiled kernels are swapped in
+        by the next run."""
+        self.module["sync_background_jit"]()
+
+    def set_priority(self, priority):
+        """Set the priority class of the runs against the other VMs on the same device.
+
+        Parameters
+        ----------
+        priority : Optional[str]
+            "high", "low", or None for the normal runs that are not arbitrated.
+        """
+        classes = {"high": 1, "low": -1, None: 0}
+        if priority not in classes:
+            raise ValueError("Unknown priority class: {}".format(priority))
+        self.module["set_priority"](classes[priority])
 
     def prepare_context(self, func_name, *args, **kwargs):
         """Create and initiliaze a VM Context given the name of function to invoke and arguments.
@@ -470,8 +628,46 @@ class VirtualMachine:
         result : VMContext
             The initialized VM context.
         """
+        cargs = self._order_args(func_name, args, kwargs)
+        return self._prepare_context(func_name, *cargs)
+
+    def bind_params(self, params, func_name="main"):
+        """Bind the parameters of a function, e.g., the weights of a model. They are copied to
+        the device once and kept in the VM, so the following runs of the function only take the
+        unbound parameters, e.g., the data inputs, in their order. Binding again replaces the
+        previous binding, and an empty dict unbinds all parameters.
+
+        Parameters
+        ----------
+        params : Dict[str, Union[raf.ndarray, np.ndarray]]
+            The map from the parameter names to their values.
+
+        func_name : str
+            The name of the function.
+        """
+        cparams = {name: _convert(param) for name, param in params.items()}
+        self.module["bind_params"](func_name, cparams)
+        self._bound_params[func_name] = set(params.keys())
+
+    def evict_function(self, func_name="main"):
+        """Evict a function, e.g., a head or a bucket that is not served anymore. Its OpEnvs and
+        device constants are released unless another loaded function uses them, and they are
+        materialized again at the next run of the function. It must not be called while the
+        function is running.
+
+        Parameters
+        ----------
+        func_name : str
+            The name of the function.
+        """
+        self.module["evict_function"](func_name)
+
+    def _order_args(self, func_name, args, kwargs):
         if kwargs:
-            func_params = self._exec.get_function_params(func_name)
+            bound = self._bound_params.get(func_name, ())
+            func_params = [
+                name for name in self._exec.get_function_params(func_name) if name not in bound
+            ]
             new_args = [None] * len(func_params)
             assert len(args) + len(kwargs) == len(func_params)
             for k in kwargs:
@@ -483,8 +679,27 @@ class VirtualMachine:
                     new_args[i] = args[idx]
                     idx += 1
             args = new_args
-        cargs = _convert_args(args)
-        return self._prepare_context(func_name, *cargs)
+        return _convert_args(args)
+
+    def prefetch(self, *args, func_name="main", **kwargs):
+        """Start copying the arguments of a future run to the device, so that the copy overlaps
+        with the current run. The next run with the same raf.ndarray arguments takes the device
+        copies instead of copying them again. The arrays are staged in pinned memory at the time
+        of prefetching, so they should not be updated until they are run.
+
+        Parameters
+        ----------
+        args : list[raf.ndarray] or list[np.ndarray]
+            The arguments to the function.
+
+        func_name : str
+            The name of the function to run.
+
+        kwargs: dict of str to raf.ndarray or np.ndarray
+            Named arguments to the function.
+        """
+        cargs = self._order_args(func_name, args, kwargs)
+        self.module["prefetch"](*cargs)
 
     def run(self, *args, func_name="main", **kwargs):
         """Run the virtual machine.
@@ -508,6 +723,48 @@ class VirtualMachine:
         ctx = self.prepare_context(func_name, *args, **kwargs)
         return self._run(ctx)
 
+    def run_async(self, *args, func_name="main", **kwargs):
+        """Run the virtual machine without waiting for the device. The kernels are launched on
+        the calling thread, and the returned future is completed by the device, so a thread can
+        keep several runs in flight.
+
+        Parameters
+        ----------
+        args : list[raf.ndarray] or list[np.ndarray]
+            The arguments to the function.
+
+        func_name : str
+            The name of function to run.
+
+        kwargs: dict of str to raf.ndarray or np.ndarray
+            Named arguments to the function.
+
+        Returns
+        -------
+        future : VMFuture
+            The future of the output.
+        """
+        ctx = self.prepare_context(func_name, *args, **kwargs)
+        return self._run_async(ctx)
+
+    def prewarm(self, *args, func_name="main", num_threads=0):
+        """Dispatch and JIT compile all kernels of a function in parallel ahead of the first run,
+        so that the first run does not pay for the compilation.
+
+        Parameters
+        ----------
+        args : list[raf.ndarray] or list[np.ndarray]
+            The sample arguments to the function, of which only the shapes and dtypes matter.
+
+        func_name : str
+            The name of function to prewarm.
+
+        num_threads : int
+            The number of compilation threads. Non-positive means the number of hardware threads.
+        """
+        cargs = _convert_args(args)
+        self.module["prewarm"](func_name, num_threads, *cargs)
+
     def profile(self, *args, func_name="main", warmup=5, number=10, repeat=10, **kwargs):
         """Profile the virtual machine.
 
@@ -543,3 +800,27 @@ class VirtualMachine:
         ctx = self.prepare_context(func_name, *args, **kwargs)
         result = [v.value for v in self._profile(ctx, warmup, number, repeat)]
         return result
+
+    def get_stats(self):
+        """Get the statistics counters of the executions since the VM is created or the last
+        reset. The counters are always maintained, so they are cheap to export to monitoring
+        without enabling the profiler.
+
+        Returns
+        -------
+        result : Dict[str, Union[int, Dict[str, int]]]
+            The counters, where "instructions" maps the opcode names to the numbers of executed
+            instructions, and the others are "num_runs", "op_env_cache_hits",
+            "op_env_cache_misses", "num_allocs", "alloc_bytes", "num_workspace_allocs",
+            "workspace_bytes", "num_event_waits", "num_stream_barriers",
+            "num_cuda_graph_captures", "num_cuda_graph_replays", "num_fallback_op_envs",
+            "num_background_jits", "num_priority_yields" and "priority_yield_us".
+        """
+        stats = self.module["get_stats"]()
+        result = {str(k): v.value for k, v in stats.items() if str(k) != "instructions"}
+        result["instructions"] = {str(k): v.value for k, v in stats["instructions"].items()}
+        return result
+
+    def reset_stats(self):
+        """Reset the statistics counters."""
+        self.module["reset_stats"]()
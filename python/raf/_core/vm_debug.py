@@ -9,15 +9,30 @@ from . import vm
 
 
 class VMDebugger(vm.VirtualMachine):
-    """VM debugger to debug the intermediate results."""
+    """VM debugger to debug the intermediate results.
 
-    def __init__(self, exe, device):
-        self.module = _ffi.vm.VMDebugger(exe.module)
+    Parameters
+    ----------
+    exe : Executable
+        The executable to debug.
+
+    device : str
+        The runtime device to run the code on.
+
+    lightweight : bool
+        Whether to record the on-device latency and the output summary of each op instead of
+        copying the intermediate tensors to the host, which does not synchronize the devices
+        between the ops. The records are retrieved by `get_op_summaries`.
+    """
+
+    def __init__(self, exe, device, lightweight=False):
+        self.module = _ffi.vm.VMDebugger(exe.module, lightweight)
         self._exec = exe
         self._set_devices = self.module["set_devices"]
         self._prepare_context = self.module["prepare_context"]
         self._run = self.module["run"]
         self._get_interm_tensors = self.module["get_interm_tensors"]
+        self._get_op_summaries = self.module["get_op_summaries"]
         self._reset = self.module["reset"]
         self._set_devices(device)
 
@@ -33,6 +48,23 @@ class VMDebugger(vm.VirtualMachine):
         names, ins, outs = res["names"], res["inputs"], res["outputs"]
         return names, ins, outs
 
+    def get_op_summaries(self):
+        """Get the latency and the output summary of each op in the lightweight mode, which waits
+        for the devices once.
+
+        Returns
+        -------
+        ret : Dict[str, List]
+            A dict from "names", "latency" (in milliseconds), "min", "max", "nan_count" and "l2"
+            to the lists in the order of the op calls. The summaries are NaNs if the output is not
+            summarized, e.g., of an unsupported dtype.
+        """
+        res = self._get_op_summaries()
+        ret = {"names": [str(name) for name in res["names"]]}
+        for key in ["latency", "min", "max", "nan_count", "l2"]:
+            ret[key] = [value.value for value in res[key]]
+        return ret
+
     def reset(self):
         """Reset the states."""
         self._reset()
@@ -49,10 +81,14 @@ class VMDebugExecutor(executor.VMExecutor):
 
     device : str
         The runtime device to run the code on.
+
+    lightweight : bool
+        Whether to use the lightweight mode of the debugger, see `VMDebugger`.
     """
 
-    def __init__(self, mod, device):
+    def __init__(self, mod, device, lightweight=False):
         super(VMDebugExecutor, self).__init__(mod, device)
-        self.vm = VMDebugger(self.executable, self.device)
+        self.vm = VMDebugger(self.executable, self.device, lightweight)
         self.get_interm_tensors = self.vm.get_interm_tensors
+        self.get_op_summaries = self.vm.get_op_summaries
         self.reset = self.vm.reset
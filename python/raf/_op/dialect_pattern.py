@@ -2,9 +2,10 @@
 # SPDX-License-Identifier: Apache-2.0
 
 """Define dialect fusion patterns."""
+from .. import build as _build
 from .dialect import register_pattern
 from ..ir.dataflow_pattern import is_op, wildcard, is_constant, has_dtype, has_shape
-from .._core.value import StringValue, IntValue
+from .._core.value import StringValue, IntValue, BoolValue
 
 MATMUL_OPS = [
     "raf.op.dense",
@@ -69,7 +70,22 @@ def _cutlass_matmul_fusion(matmul_ops, dtype=None):
     with_bias = is_op("raf.op.add")(matmul, bias, *n_null_constant(2))
     # pattern: matmul+(scaled_)bias+act or matmul+act
     with_act = is_ops(act_ops)(with_bias | matmul)
+    # pattern: matmul+act+cast or matmul+cast, where the float16 GEMM directly outputs float32.
+    # The bias is excluded because it has to be in the output dtype.
+    fp16_matmul = call_binary_ops(matmul_ops, "float16")
+    fp16_out = is_ops(act_ops)(fp16_matmul) | fp16_matmul
+    with_cast = has_dtype("float32", is_op("raf.op.cast")(fp16_out, wildcard()))
     # We exclude the single matmul op pattern as ther perf of cutlass is worse than cublas
+    return with_cast | with_act | with_bias
+
+
+def _cublaslt_matmul_fusion(matmul_ops):
+    # cuBLASLt requires the inputs and the bias to be in the output dtype.
+    matmul = call_binary_ops(matmul_ops, "float32") | call_binary_ops(matmul_ops, "float16")
+    # pattern: matmul+bias
+    with_bias = is_op("raf.op.add")(matmul, wildcard(), *n_null_constant(2))
+    # pattern: matmul+bias+act or matmul+act
+    with_act = is_ops(["raf.op.relu", "raf.op.gelu"])(with_bias | matmul)
     return with_act | with_bias
 
 
@@ -92,6 +108,14 @@ def _call_conv2d_dxw(dtype=None):
     return is_ops(ops)(x_or_w, y, dy, *n_wildcards(5))
 
 
+def _cutlass_conv2d_dxw():
+    # The float16 dgrad and wgrad of CUTLASS compete with cuDNN, which they fall back to when no
+    # CUTLASS kernel supports the problem.
+    ops = ["raf.op.conv2d_dx", "raf.op.conv2d_dw"]
+    x_or_w, dy = has_dtype("float16"), has_dtype("float16")
+    return is_ops(ops)(x_or_w, wildcard(), dy, *n_wildcards(4), is_constant(IntValue(1)))
+
+
 def _call_softmax():
     # Only offload softmax with axis=0 to CuDNN because other cases can be handled by TVM well.
     x = wildcard()
@@ -99,35 +123,199 @@ def _call_softmax():
 
 
 def _cutlass_conv2d_fusion():
-    act_ops = ["raf.op.relu"]
-    conv = is_op("raf.op.conv2d")(
-        *n_wildcards(6),
-        is_constant(StringValue("NHWC")),
-        is_constant(StringValue("OHWI")),
-        is_constant(StringValue("NHWC"))
-    )
+    act_ops = ["raf.op.relu", "raf.op.gelu"]
+
+    def _conv(x, w):
+        return is_op("raf.op.conv2d")(
+            x,
+            w,
+            *n_wildcards(4),
+            is_constant(StringValue("NHWC")),
+            is_constant(StringValue("OHWI")),
+            is_constant(StringValue("NHWC"))
+        )
+
+    conv = _conv(wildcard(), wildcard())
     # pattern: conv2d+bias
     with_bias = is_op("raf.op.add")(conv, wildcard(), *n_null_constant(2))
     # pattern: conv2d+bias+act || conv2d+act
     with_act = is_ops(act_ops)(with_bias | conv)
+    # pattern: conv2d+act+cast || conv2d+cast, where the float16 conv directly outputs float32.
+    fp16_conv = _conv(has_dtype("float16"), has_dtype("float16"))
+    fp16_out = is_ops(act_ops)(fp16_conv) | fp16_conv
+    with_cast = has_dtype("float32", is_op("raf.op.cast")(fp16_out, wildcard()))
+    return with_cast | with_act | with_bias
+
+
+def _cudnn_conv2d_fusion():
+    # The cuDNN graph API requires the inputs and the bias to be in the output dtype.
+    def _conv(dtype):
+        return is_op("raf.op.conv2d")(
+            has_dtype(dtype),
+            has_dtype(dtype),
+            *n_wildcards(4),
+            is_constant(StringValue("NCHW")),
+            is_constant(StringValue("OIHW")),
+            is_constant(StringValue("NCHW"))
+        )
+
+    conv = _conv("float32") | _conv("float16")
+    # pattern: conv2d+bias
+    with_bias = is_op("raf.op.add")(conv, wildcard(), *n_null_constant(2))
+    # pattern: conv2d+bias+relu || conv2d+relu
+    with_act = is_op("raf.op.relu")(with_bias | conv)
     return with_act | with_bias
 
 
+def _with_cudnn_graph_api():
+    version = _build.with_cudnn()
+    return version is not None and tuple(int(v) for v in version.split(".")[:2]) >= (8, 2)
+
+
+def _cuda_attention_fusion():
+    # pattern: batch_matmul(softmax(batch_matmul_nt(q, k) * scale), v), where the scalar scale
+    # may be applied with multiply or divide, or omitted. Attention with dropout is not matched.
+    def _attention(dtype):
+        score = call_binary_ops("raf.op.batch_matmul_nt", dtype)
+        scale = has_shape(()) | has_shape((1,))
+        scaled = is_op("raf.op.multiply")(score, scale) | is_op("raf.op.divide")(score, scale)
+        axis = is_constant(IntValue(-1)) | is_constant(IntValue(2))
+        prob = is_op("raf.op.softmax")(scaled | score, axis)
+        return is_op("raf.op.batch_matmul")(prob, has_dtype(dtype))
+
+    return _attention("float32") | _attention("float16")
+
+
+def _cuda_masked_softmax_fusion():
+    # pattern: softmax(x * scale + mask, -1), where the scalar scale may be applied with multiply
+    # or divide, and either the scale or the mask may be omitted. The mask is broadcast to x, e.g.,
+    # a padding mask in [b, 1, 1, s] or a causal mask in [1, 1, s, s].
+    def _masked_softmax(dtype):
+        x = has_dtype(dtype)
+        scale = has_shape(()) | has_shape((1,))
+        scaled = is_op("raf.op.multiply")(x, scale) | is_op("raf.op.divide")(x, scale)
+        masked = is_op("raf.op.add")(scaled | x, has_dtype(dtype), *n_null_constant(2))
+        return is_op("raf.op.softmax")(masked | scaled, is_constant(IntValue(-1)))
+
+    return _masked_softmax("float32") | _masked_softmax("float16")
+
+
+def _cuda_masked_softmax_dx_fusion():
+    # pattern: softmax_dx(y, dy, -1) * scale, which is the gradient of the scores of the masked
+    # softmax, where the scale is applied in the same way as the forward.
+    def _masked_softmax_dx(dtype):
+        y, dy = has_dtype(dtype), has_dtype(dtype)
+        dx = is_op("raf.op.softmax_dx")(y, dy, is_constant(IntValue(-1)))
+        scale = has_shape(()) | has_shape((1,))
+        return is_op("raf.op.multiply")(dx, scale) | is_op("raf.op.divide")(dx, scale)
+
+    return _masked_softmax_dx("float32") | _masked_softmax_dx("float16")
+
+
+def _embedding_sum(dtype):
+    # pattern: embedding(w0, i0) + embedding(w1, i1) [+ embedding(w2, i2)], e.g., the sum of the
+    # token, position and token type embeddings of BERT.
+    def _embedding():
+        return is_op("raf.op.embedding")(has_dtype(dtype), has_dtype("int64"))
+
+    sum2 = is_op("raf.op.add")(_embedding(), _embedding(), *n_null_constant(2))
+    return is_op("raf.op.add")(sum2, _embedding(), *n_null_constant(2)) | sum2
+
+
+def _cuda_embedding_layer_norm_fusion():
+    # pattern: layer_norm(embedding_sum, scale, bias, -1), or layer_norm_train of the same args.
+    def _layer_norm(dtype):
+        ops = ["raf.op.layer_norm", "raf.op.layer_norm_train"]
+        scale, bias, axis = has_dtype(dtype), has_dtype(dtype), is_constant(IntValue(-1))
+        return is_ops(ops)(_embedding_sum(dtype), scale, bias, axis, wildcard())
+
+    return _layer_norm("float32") | _layer_norm("float16")
+
+
+def _cuda_embedding_layer_norm_dx_fusion():
+    # pattern: layer_norm_train_dx(embedding_sum, scale, dy, mean, invvar, -1), where the sum is
+    # gathered again by the backward instead of being kept.
+    def _layer_norm_dx(dtype):
+        scale, axis = has_dtype(dtype), is_constant(IntValue(-1))
+        x = _embedding_sum(dtype)
+        return is_op("raf.op.layer_norm_train_dx")(x, scale, *n_wildcards(3), axis, wildcard())
+
+    return _layer_norm_dx("float32") | _layer_norm_dx("float16")
+
+
+def _log_softmax_last_axis(x):
+    # The log_softmax generated by autodiff omits the axis, which defaults to the last one.
+    axis = is_constant(IntValue(-1)) | is_constant(IntValue(1))
+    return is_op("raf.op.log_softmax")(x) | is_op("raf.op.log_softmax")(x, axis)
+
+
+def _cuda_cross_entropy_fusion():
+    # pattern: nll_loss(y_true, log_softmax(x, -1))
+    return is_op("raf.op.nll_loss")(wildcard(), _log_softmax_last_axis(wildcard()))
+
+
+def _cuda_cross_entropy_dx_fusion():
+    # pattern: d - exp(log_prob) * sum(d, -1, keepdims=1), where d = nll_loss_dpred(dy, y_true,
+    # pred), which is the gradient of both cross_entropy and nll_loss(log_softmax). The log_prob
+    # is either log_softmax(x) or the log-probabilities saved by the forward pass, and d does not
+    # depend on the values of pred.
+    log_prob = _log_softmax_last_axis(wildcard()) | wildcard()
+    dpred = is_op("raf.op.nll_loss_dpred")(*n_wildcards(3))
+    axis = is_constant(IntValue(-1)) | is_constant(IntValue(1))
+    keep_dims, exclude = is_constant(IntValue(1)), is_constant(BoolValue(False))
+    total = is_op("raf.op.sum")(dpred, axis, keep_dims, exclude)
+    scaled = is_op("raf.op.multiply")(is_op("raf.op.exp")(log_prob), total)
+    return is_op("raf.op.subtract")(dpred, scaled, *n_null_constant(2))
+
+
+def _cuda_philox_dropout_fusion():
+    # pattern: dropout(x + bias) + residual, where either add is optional.
+    with_bias = is_op("raf.op.add")(wildcard(), wildcard(), *n_null_constant(2))
+    dropout = is_op("raf.op._contrib_philox_dropout")(with_bias | wildcard(), *n_wildcards(2))
+    residual = wildcard()
+    with_residual = is_op("raf.op.add")(dropout, residual, *n_null_constant(2)) | is_op(
+        "raf.op.add"
+    )(residual, dropout, *n_null_constant(2))
+    return with_residual | is_op("raf.op._contrib_philox_dropout")(with_bias, *n_wildcards(2))
+
+
 def _call_pool2d_dx():
     pool_ops = ["raf.op.max_pool2d_dx", "raf.op.avg_pool2d_dx"]
     return is_ops(pool_ops)(*n_wildcards(9))
 
 
+# attention
+register_pattern(_cuda_attention_fusion(), "cuda", 60, "attention")
+
+# masked softmax
+register_pattern(_cuda_masked_softmax_fusion(), "cuda", 59, "masked_softmax")
+register_pattern(_cuda_masked_softmax_dx_fusion(), "cuda", 54, "masked_softmax_dx")
+
+# cross entropy
+register_pattern(_cuda_cross_entropy_fusion(), "cuda", 58, "cross_entropy")
+register_pattern(_cuda_cross_entropy_dx_fusion(), "cuda", 57, "cross_entropy_dx")
+
+# dropout
+register_pattern(_cuda_philox_dropout_fusion(), "cuda", 56, "philox_dropout")
+
 # softmax
 register_pattern(_call_softmax(), "cudnn", 55, "softmax")
 
+# embedding + layer_norm
+register_pattern(_cuda_embedding_layer_norm_fusion(), "cuda", 53, "embedding_layer_norm")
+register_pattern(_cuda_embedding_layer_norm_dx_fusion(), "cuda", 52, "embedding_layer_norm_dx")
+
 # pool2d_dx
 register_pattern(_call_pool2d_dx(), "cudnn", 50, "pool2d_dx")
 
 # conv2d_dx, conv2d_dw
+register_pattern(_cutlass_conv2d_dxw(), "cutlass", 41, "conv2d_dxw")
 register_pattern(_call_conv2d_dxw(), "cudnn", 40, "conv2d_dxw")
 
 # conv2d
+# The NHWC conv2d is fused by CUTLASS, while the NCHW conv2d is fused by the cuDNN graph API.
+if _with_cudnn_graph_api():
+    register_pattern(_cudnn_conv2d_fusion(), "cudnn", 35, "conv2d_fusion")
 register_pattern(_cutlass_conv2d_fusion(), "cutlass", 30, "conv2d_fusion")
 register_pattern(_call_conv2d(), "cudnn", 29, "conv2d")
 
@@ -136,7 +324,25 @@ register_pattern(_cutlass_matmul_fusion(BATCH_MATMUL_OPS), "cutlass", 20, "batch
 register_pattern(call_binary_ops(BATCH_MATMUL_OPS), "cublas", 19, "batch_matmul")
 register_pattern(call_binary_ops(BATCH_MATMUL_OPS), "cutlass", 18, "batch_matmul")
 
+# grouped_matmul, grouped_matmul_dw
+register_pattern(is_op("raf.op.grouped_matmul")(*n_wildcards(4)), "cutlass", 17, "grouped_matmul")
+register_pattern(
+    is_op("raf.op.grouped_matmul_dw")(*n_wildcards(4)), "cutlass", 16, "grouped_matmul_dw"
+)
+
+# _contrib_sparse_dense, whose 2:4 sparse weight only runs on the sparse tensor cores in float16
+register_pattern(
+    is_op("raf.op._contrib_sparse_dense")(has_dtype("float16"), wildcard(), wildcard()),
+    "cutlass",
+    15,
+    "sparse_dense",
+)
+
+# _contrib_fp8_dense
+register_pattern(is_op("raf.op._contrib_fp8_dense")(*n_wildcards(7)), "cublaslt", 14, "fp8_dense")
+
 # matmul / dense
-register_pattern(_cutlass_matmul_fusion(MATMUL_OPS), "cutlass", 10, "matmul_fusion")
+register_pattern(_cutlass_matmul_fusion(MATMUL_OPS), "cutlass", 11, "matmul_fusion")
+register_pattern(_cublaslt_matmul_fusion(MATMUL_OPS), "cublaslt", 10, "matmul_fusion")
 register_pattern(call_binary_ops(MATMUL_OPS), "cublas", 9, "matmul")
 register_pattern(call_binary_ops(MATMUL_OPS), "cutlass", 8, "matmul")
@@ -4,19 +4,33 @@
 # pylint: disable=unused-argument, invalid-name
 
 """Schedule registries for broadcast operators."""
+from . import cuda
 from .._lib import tvm as _tvm
-from .._lib import _reg, register_compute
+from .._lib import _reg, generic_func, register_compute, strategy
 
 _topi = _tvm.topi  # pylint: disable=no-member
 
-_reg.register_broadcast_schedule("raf.op.tvm.add")
-_reg.register_broadcast_schedule("raf.op.tvm.subtract")
-_reg.register_broadcast_schedule("raf.op.tvm.multiply")
-_reg.register_broadcast_schedule("raf.op.tvm.divide")
-_reg.register_broadcast_schedule("raf.op.tvm.floor_divide")
-_reg.register_broadcast_schedule("raf.op.tvm.maximum")
-_reg.register_broadcast_schedule("raf.op.tvm.minimum")
-_reg.register_broadcast_schedule("raf.op.tvm.bias_add")
+
+@generic_func
+def schedule_arith_broadcast(attrs, outs, target):
+    return strategy.schedule_injective(attrs, outs, target)
+
+
+@schedule_arith_broadcast.register(["cuda", "gpu"])
+def schedule_arith_broadcast_cuda(attrs, outs, target):
+    # The bias and residual adds are bounded by the memory bandwidth, so they load 128 bits at once.
+    with target:
+        return cuda.injective.schedule_broadcast(outs)
+
+
+_reg.register_schedule("raf.op.tvm.add", schedule_arith_broadcast)
+_reg.register_schedule("raf.op.tvm.subtract", schedule_arith_broadcast)
+_reg.register_schedule("raf.op.tvm.multiply", schedule_arith_broadcast)
+_reg.register_schedule("raf.op.tvm.divide", schedule_arith_broadcast)
+_reg.register_schedule("raf.op.tvm.floor_divide", schedule_arith_broadcast)
+_reg.register_schedule("raf.op.tvm.maximum", schedule_arith_broadcast)
+_reg.register_schedule("raf.op.tvm.minimum", schedule_arith_broadcast)
+_reg.register_schedule("raf.op.tvm.bias_add", schedule_arith_broadcast)
 _reg.register_broadcast_schedule("raf.op.tvm.power")
 _reg.register_broadcast_schedule("raf.op.tvm.logical_and")
 _reg.register_broadcast_schedule("raf.op.tvm.right_shift")
@@ -98,5 +98,102 @@ def schedule_injective(outs):
     return s
 
 
+def get_vector_width(out):
+    """The number of elements in 128 bits if the innermost axis of the output is static and
+    divisible by it, and every input is either not broadcast or broadcast along the innermost axis,
+    so that each thread loads and stores 128 bits at once. Otherwise 1.
+
+    Parameters
+    ----------
+    out: Tensor
+         The tensor representing the broadcast op.
+
+    Returns
+    -------
+    vector_width: int
+        The vector width.
+    """
+    bits = tvm.DataType(out.dtype).bits
+    if not out.shape or bits not in (8, 16, 32) or not isinstance(out.shape[-1], tvm.tir.IntImm):
+        return 1
+    vector_width = 128 // bits
+    inner = out.shape[-1].value
+    if inner % vector_width != 0:
+        return 1
+    for inp in out.op.input_tensors:
+        if not inp.shape or not isinstance(inp.shape[-1], tvm.tir.IntImm):
+            return 1
+        if inp.shape[-1].value not in (1, inner):
+            return 1
+    return vector_width
+
+
+def schedule_broadcast_from_existing(sch, out):
+    """Schedule for broadcast op from existing schedule. The innermost axis is split by the vector
+    width instead of the fused axis, so that the vectorized loads have no tails and the broadcast
+    indices of the outer axes are computed once per vector, which also holds for the symbolic
+    leading dimension.
+
+    Parameters
+    ----------
+    sch: Schedule
+         The schedule to update.
+    out: Tensor
+         The tensor representing the broadcast op.
+
+    Returns
+    -------
+    sch: Schedule
+         The updated schedule.
+    """
+    vector_width = get_vector_width(out)
+    if vector_width == 1:
+        return schedule_injective_from_existing(sch, out)
+    num_thread = tvm.target.Target.current(allow_none=False).max_num_threads
+    max_block = 255
+    axes = sch[out].op.axis
+    inner, vec = sch[out].split(axes[-1], factor=vector_width)
+    fused = sch[out].fuse(*axes[:-1], inner)
+    sch[out].vectorize(vec)
+    try:
+        const_size = utils.get_const_int(utils.prod(out.shape)) // vector_width
+    except ValueError:
+        const_size = 0
+    if const_size > max_block * num_thread:
+        xo, xi = sch[out].split(fused, factor=num_thread * max_block)
+        bx, tx = sch[out].split(xi, factor=num_thread)
+        sch[out].reorder(bx, tx, xo)
+    else:
+        if const_size != 0 and const_size < num_thread:
+            num_thread = const_size
+        bx, tx = sch[out].split(fused, factor=num_thread)
+    sch[out].bind(bx, te.thread_axis("blockIdx.x"))
+    sch[out].bind(tx, te.thread_axis("threadIdx.x"))
+    return sch
+
+
+def schedule_broadcast(outs):
+    """Schedule for broadcast op, which vectorizes the innermost axis when possible.
+
+    Parameters
+    ----------
+    outs: Array of Tensor
+          The computation graph description of broadcast in the format
+          of an array of tensors.
+
+    Returns
+    -------
+    sch: Schedule
+        The computation schedule for the op.
+    """
+    outs = [outs] if isinstance(outs, te.tensor.Tensor) else outs
+    s = te.create_schedule([x.op for x in outs])
+
+    tvm.te.schedule.AutoInlineInjective(s)
+    for out in outs:
+        if not utils.is_empty_shape(out.shape):
+            schedule_broadcast_from_existing(s, out)
+    return s
+
+
 schedule_elemwise = schedule_injective
-schedule_broadcast = schedule_injective
@@ -4,6 +4,7 @@
 # pylint: disable=missing-function-docstring, missing-module-docstring
 # pylint: disable=unused-argument, invalid-name, too-many-statements
 from functools import reduce
+import math
 import operator
 
 from . import cuda
@@ -380,6 +381,85 @@ def compute_contrib_dropout_dx(attr, inputs, output_type):
 _reg.register_injective_schedule("raf.op.tvm._contrib_dropout_dx")
 
 
+def _philox4x32(ctr, key):
+    """The Philox4x32-10 counter-based RNG on 4 uint32 counters and 2 uint32 keys, which is the
+    same as the one in the CUDA kernels, so the mask is the same on all backends."""
+    u32, u64 = "uint32", "uint64"
+    w0, w1 = _tvm.tir.const(0x9E3779B9, u32), _tvm.tir.const(0xBB67AE85, u32)
+    m0, m1 = _tvm.tir.const(0xD2511F53, u64), _tvm.tir.const(0xCD9E8D57, u64)
+    for r in range(10):
+        if r > 0:
+            key = [key[0] + w0, key[1] + w1]
+        prod0 = m0 * ctr[0].astype(u64)
+        prod1 = m1 * ctr[2].astype(u64)
+        hi0, lo0 = (prod0 >> 32).astype(u32), prod0.astype(u32)
+        hi1, lo1 = (prod1 >> 32).astype(u32), prod1.astype(u32)
+        ctr = [hi1 ^ ctr[1] ^ key[0], lo1, hi0 ^ ctr[3] ^ key[1], lo0]
+    return ctr
+
+
+def _philox_keep(key, shape, p):
+    """Compute whether each element is kept by the dropout, where element i takes the (i % 4)-th
+    output of the Philox call on the counter (i / 4, offset)."""
+    u32, u64 = "uint32", "uint64"
+    strides = [1] * len(shape)
+    for i in range(len(shape) - 2, -1, -1):
+        strides[i] = strides[i + 1] * _topi.utils.get_const_int(shape[i + 1])
+
+    def _keep(*ix):
+        index = _tvm.tir.const(0, u64)
+        for i, stride in zip(ix, strides):
+            index = index + i.astype(u64) * _tvm.tir.const(stride, u64)
+        seed, offset = key[0], key[1]
+        group = index >> 2
+        ctr = [group.astype(u32), (group >> 32).astype(u32), offset.astype(u32)]
+        ctr.append((offset >> 32).astype(u32))
+        out = _philox4x32(ctr, [seed.astype(u32), (seed >> 32).astype(u32)])
+        lane = (index & _tvm.tir.const(3, u64)).astype("int32")
+        bits = _tvm.tir.Select(
+            lane == 0,
+            out[0],
+            _tvm.tir.Select(lane == 1, out[1], _tvm.tir.Select(lane == 2, out[2], out[3])),
+        )
+        # The top 24 bits are exact in float32, so the uniform is the same as in the kernels.
+        uniform = (bits >> 8).astype("float32") * _tvm.tir.const(1.0 / (1 << 24), "float32")
+        return uniform >= _tvm.tir.const(p, "float32")
+
+    return _keep
+
+
+def compute_philox_dropout_common(x, key, p):
+    keep = _philox_keep(key, x.shape, p)
+    scale = _tvm.tir.const(1.0 / (1.0 - p), "float32")
+    return _tvm.te.compute(
+        x.shape,
+        lambda *ix: _tvm.tir.Select(
+            keep(*ix),
+            (x[ix].astype("float32") * scale).astype(x.dtype),
+            _tvm.tir.const(0, x.dtype),
+        ),
+    )
+
+
+@register_compute("raf.op.tvm._contrib_philox_dropout")
+def compute_contrib_philox_dropout(attr, inputs, output_type):
+    x, key = inputs
+    return [compute_philox_dropout_common(x, key, attr.rate)]
+
+
+_reg.register_injective_schedule("raf.op.tvm._contrib_philox_dropout")
+
+
+@register_compute("raf.op.tvm._contrib_philox_dropout_dx")
+def compute_contrib_philox_dropout_dx(attr, inputs, output_type):
+    # The mask is regenerated from the key instead of being saved by the forward.
+    dy, key = inputs
+    return [compute_philox_dropout_common(dy, key, attr.rate)]
+
+
+_reg.register_injective_schedule("raf.op.tvm._contrib_philox_dropout_dx")
+
+
 @register_compute("raf.op.tvm.relu_dx")
 @_tvm.te.tag_scope(tag=_tvm.topi.tag.ELEMWISE)
 def compute_relu_dx(attr, inputs, output_type):
@@ -519,7 +599,6 @@ def schedule_generic(attrs, outs, target):
 @schedule_generic.register(["cuda", "gpu"])
 def schedule_generic_cuda(attrs, outs, target):
     with target:
-        out = outs[0]
         s = cuda.injective.schedule_injective(outs)
         # fuse axes and split into bx and tx then bind
         scheduled_ops = []
@@ -540,10 +619,303 @@ def schedule_generic_cuda(attrs, outs, target):
             for inp in out.op.input_tensors:
                 bind_axes(s, inp)
 
-        bind_axes(s, out)
+        for out in outs:
+            bind_axes(s, out)
         return s
 
 
+def compute_attention_prob(attr, q, k, valid_len=None):
+    scale = attr.scale
+    if scale <= 0:
+        scale = 1.0 / math.sqrt(_topi.utils.get_const_int(q.shape[2]))
+    score = _topi.multiply(_topi.nn.batch_matmul(q, k), _tvm.tir.const(scale, q.dtype))
+    if attr.causal:
+        min_value = _tvm.tir.min_value(score.dtype)
+        score = _tvm.te.compute(
+            score.shape,
+            lambda b, i, j: _tvm.tir.if_then_else(j > i, min_value, score[b, i, j]),
+            tag="causal_mask",
+        )
+    if valid_len is not None:
+        # Only the keys in the valid prefix are attended, and so is at least the first key.
+        min_value = _tvm.tir.min_value(score.dtype)
+        score = _tvm.te.compute(
+            score.shape,
+            lambda b, i, j: _tvm.tir.if_then_else(
+                _tvm.tir.all(j > 0, j >= valid_len[()].astype(j.dtype)), min_value, score[b, i, j]
+            ),
+            tag="valid_len_mask",
+        )
+    return _topi.nn.softmax(score, axis=-1), scale
+
+
+@register_compute("raf.op.tvm._contrib_attention")
+def compute_attention(attr, inputs, output_type):
+    q, k, v = inputs[:3]
+    prob, _ = compute_attention_prob(attr, q, k, inputs[3] if len(inputs) > 3 else None)
+    return [_topi.nn.batch_matmul(prob, _topi.transpose(v, (0, 2, 1)))]
+
+
+_reg.register_schedule("raf.op.tvm._contrib_attention", schedule_generic)
+
+
+@register_compute("raf.op.tvm._contrib_attention_dx")
+def compute_attention_dx(attr, inputs, output_type):
+    # The attention probabilities are recomputed instead of being saved by the forward.
+    q, k, v, out, dy = inputs
+    prob, scale = compute_attention_prob(attr, q, k)
+    dv = _topi.nn.batch_matmul(_topi.transpose(prob, (0, 2, 1)), _topi.transpose(dy, (0, 2, 1)))
+    dprob = _topi.nn.batch_matmul(dy, v)
+    # sum(dprob * prob, axis=-1) is the same as the row-wise dot product of dy and out.
+    delta = _topi.sum(_topi.multiply(dy, out), axis=-1, keepdims=True)
+    dscore = _topi.multiply(prob, _topi.subtract(dprob, delta))
+    dscore = _topi.multiply(dscore, _tvm.tir.const(scale, q.dtype))
+    dq = _topi.nn.batch_matmul(dscore, _topi.transpose(k, (0, 2, 1)))
+    dk = _topi.nn.batch_matmul(_topi.transpose(dscore, (0, 2, 1)), _topi.transpose(q, (0, 2, 1)))
+    return [dq, dk, dv]
+
+
+_reg.register_schedule("raf.op.tvm._contrib_attention_dx", schedule_generic)
+
+
+@register_compute("raf.op.tvm._contrib_kv_cache_append")
+def compute_kv_cache_append(attr, inputs, output_type):
+    # The output shares the memory with the cache, which is only read at the same position.
+    cache, x, offset = inputs
+    num_new = x.shape[1]
+
+    def _append(b, i, d):
+        pos = i - offset[()].astype(i.dtype)
+        return _tvm.tir.if_then_else(
+            _tvm.tir.all(pos >= 0, pos < num_new), x[b, pos, d], cache[b, i, d]
+        )
+
+    return [_tvm.te.compute(cache.shape, _append, tag="kv_cache_append")]
+
+
+_reg.register_injective_schedule("raf.op.tvm._contrib_kv_cache_append")
+
+
+def expand_quantize_scale(scale, ndim, axis):
+    # A 1-D scale is applied along the axis, so it is reshaped to broadcast to the other axes.
+    if len(scale.shape) == 0:
+        return scale
+    axis = axis + ndim if axis < 0 else axis
+    shape = [1] * ndim
+    shape[axis] = scale.shape[0]
+    return _topi.reshape(scale, shape)
+
+
+@register_compute("raf.op.tvm._contrib_quantize")
+def compute_quantize(attr, inputs, output_type):
+    x, scale = inputs
+    scale = expand_quantize_scale(scale, len(x.shape), attr.axis)
+    y = _topi.round(_topi.divide(_topi.cast(x, "float32"), scale))
+    # The symmetric range keeps the negation of the quantized values in int8.
+    return [_topi.cast(_topi.clip(y, -127.0, 127.0), "int8")]
+
+
+_reg.register_injective_schedule("raf.op.tvm._contrib_quantize")
+
+
+@register_compute("raf.op.tvm._contrib_dequantize")
+def compute_dequantize(attr, inputs, output_type):
+    x, scale = inputs
+    scale = expand_quantize_scale(scale, len(x.shape), attr.axis)
+    return [_topi.multiply(_topi.cast(x, "float32"), scale)]
+
+
+_reg.register_injective_schedule("raf.op.tvm._contrib_dequantize")
+
+
+@register_compute("raf.op.tvm._contrib_quantized_dense")
+def compute_quantized_dense(attr, inputs, output_type):
+    # The products are accumulated in int32, and rescaled once per output element.
+    x, w, x_scale, w_scale = inputs
+    acc = _topi.nn.dense(x, w, out_dtype="int32")
+    return [_topi.multiply(_topi.cast(acc, "float32"), _topi.multiply(x_scale, w_scale))]
+
+
+_reg.register_schedule("raf.op.tvm._contrib_quantized_dense", schedule_generic)
+
+
+def _sparse_meta_index(row, col):
+    # The metadata word (row, col) of the 2:4 sparse weight is stored at [c / 2, r, c % 2] in the
+    # interleaved layout of the sparse tensor cores, where the rows are interleaved in groups of
+    # 16, and then the words of each 2x2 block are transposed.
+    tir = _tvm.tir
+    r = tir.indexdiv(row, 16) * 16 + tir.indexmod(row, 8) * 2
+    r = r + tir.indexdiv(tir.indexmod(row, 16), 8)
+    down = tir.all(tir.indexmod(r, 2) == 0, tir.indexmod(col, 2) == 1)
+    up = tir.all(tir.indexmod(r, 2) == 1, tir.indexmod(col, 2) == 0)
+    r = tir.Select(down, r + 1, tir.Select(up, r - 1, r))
+    c = tir.Select(down, col - 1, tir.Select(up, col + 1, col))
+    return tir.indexdiv(c, 2), r, tir.indexmod(c, 2)
+
+
+@register_compute("raf.op.tvm._contrib_sparse_dense")
+def compute_sparse_dense(attr, inputs, output_type):
+    # The weight is decompressed, where each word of the metadata holds the 2-bit indices of the
+    # 2 kept elements of 8 groups of 4 elements.
+    x, w, meta = inputs
+    tir = _tvm.tir
+    n_dim = w.shape[0]
+    k_dim = x.shape[1]
+
+    def fdecompress(n, k):
+        group = tir.indexdiv(k, 4)
+        word = meta[_sparse_meta_index(n, tir.indexdiv(k, 32))]
+        shift = (tir.indexmod(group, 8) * 4).astype("int32")
+        bits = (word >> shift) & 15
+        pos = tir.indexmod(k, 4).astype("int32")
+        zero = tir.const(0, w.dtype)
+        return tir.Select(
+            pos == (bits & 3),
+            w[n, group * 2],
+            tir.Select(pos == (bits >> 2), w[n, group * 2 + 1], zero),
+        )
+
+    dense_w = _tvm.te.compute((n_dim, k_dim), fdecompress, name="sparse_decompress")
+    return [_topi.nn.dense(x, dense_w)]
+
+
+_reg.register_schedule("raf.op.tvm._contrib_sparse_dense", schedule_generic)
+
+
+def _fp8_format(e5m2):
+    # The exponent bias, the mantissa bits and the largest finite value of the FP8 format.
+    return (15, 2, 57344.0) if e5m2 else (7, 3, 448.0)
+
+
+def _pow2(exponent):
+    # 2^exponent in float32, which is exact for the normal exponents.
+    return _tvm.tir.reinterpret("float32", (exponent + 127) << 23)
+
+
+def _encode_fp8(value, e5m2):
+    # The float32 value is rounded to the nearest even FP8 value, saturated to the largest finite
+    # one, and encoded into the uint8 bits.
+    tir = _tvm.tir
+    bias, mbits, max_value = _fp8_format(e5m2)
+    mag = tir.min(tir.abs(value), tir.const(max_value, "float32"))
+    # The exponent of the magnitude, which is clamped to the one of the subnormals.
+    exponent = tir.max((tir.reinterpret("int32", mag) >> 23) - 127, 1 - bias)
+    mantissa = tir.nearbyint(mag / _pow2(exponent - mbits)).astype("int32")
+    # The code of the normal values adds the implicit leading bit to the biased exponent, and the
+    # rounding up to the next power of two carries into the exponent.
+    code = (exponent - 1 + bias) * (1 << mbits) + mantissa
+    sign = tir.Select(value < 0, tir.const(128, "int32"), tir.const(0, "int32"))
+    return (sign | code).astype("uint8")
+
+
+def _decode_fp8(bits, e5m2):
+    tir = _tvm.tir
+    bias, mbits, _ = _fp8_format(e5m2)
+    bits = bits.astype("int32")
+    field = (bits & 127) >> mbits
+    mantissa = bits & ((1 << mbits) - 1)
+    mantissa = tir.Select(field == 0, mantissa, mantissa + (1 << mbits)).astype("float32")
+    value = mantissa * _pow2(tir.max(field, 1) - bias - mbits)
+    return tir.Select(bits >= 128, -value, value)
+
+
+@register_compute("raf.op.tvm._contrib_quantize_fp8")
+def compute_quantize_fp8(attr, inputs, output_type):
+    x, scale = inputs
+
+    def fquantize(*idx):
+        return _encode_fp8(x[idx].astype("float32") / scale(), attr.e5m2)
+
+    return [_tvm.te.compute(x.shape, fquantize, name="quantize_fp8")]
+
+
+_reg.register_injective_schedule("raf.op.tvm._contrib_quantize_fp8")
+
+
+@register_compute("raf.op.tvm._contrib_dequantize_fp8")
+def compute_dequantize_fp8(attr, inputs, output_type):
+    x, scale = inputs
+
+    def fdequantize(*idx):
+        return _decode_fp8(x[idx], attr.e5m2) * scale()
+
+    return [_tvm.te.compute(x.shape, fdequantize, name="dequantize_fp8")]
+
+
+_reg.register_injective_schedule("raf.op.tvm._contrib_dequantize_fp8")
+
+
+@register_compute("raf.op.tvm._contrib_fp8_dense")
+def compute_fp8_dense(attr, inputs, output_type):
+    # The FP8 inputs are decoded exactly into float32, and the products are rescaled once per
+    # output element.
+    x, w, x_scale, w_scale = inputs
+    te = _tvm.te
+    x_value = te.compute(x.shape, lambda *idx: _decode_fp8(x[idx], attr.x_e5m2), name="decode_x")
+    w_value = te.compute(w.shape, lambda *idx: _decode_fp8(w[idx], attr.w_e5m2), name="decode_w")
+    acc = _topi.nn.dense(x_value, w_value, out_dtype="float32")
+    out = _topi.multiply(acc, _topi.multiply(x_scale, w_scale))
+    return [_topi.cast(out, output_type.dtype)]
+
+
+_reg.register_schedule("raf.op.tvm._contrib_fp8_dense", schedule_generic)
+
+
+def _group_ids(group_sizes, num_rows):
+    # The group of each row is the number of groups that end at or before it, which is the
+    # number of groups for the rows beyond the total group size.
+    num_groups = group_sizes.shape[0]
+    ends = _topi.cumsum(group_sizes)
+    e = _tvm.te.reduce_axis((0, num_groups), name="e")
+    return _tvm.te.compute(
+        (num_rows,),
+        lambda t: _tvm.te.sum((ends[e] <= t).astype("int32"), axis=e),
+        name="group_ids",
+    )
+
+
+@register_compute("raf.op.tvm.grouped_matmul")
+def compute_grouped_matmul(attr, inputs, output_type):
+    x, w, group_sizes = inputs
+    transpose_b = bool(attr.transpose_b)
+    num_rows, k_dim = x.shape
+    num_groups = w.shape[0]
+    n_dim = w.shape[1] if transpose_b else w.shape[2]
+    gid = _group_ids(group_sizes, num_rows)
+    k = _tvm.te.reduce_axis((0, k_dim), name="k")
+    zero = _tvm.tir.const(0, x.dtype)
+
+    def fcompute(t, n):
+        g = _tvm.te.min(gid[t], num_groups - 1)
+        w_val = w[g, n, k] if transpose_b else w[g, k, n]
+        return _tvm.te.sum(_tvm.tir.Select(gid[t] < num_groups, x[t, k] * w_val, zero), axis=k)
+
+    return [_tvm.te.compute((num_rows, n_dim), fcompute, name="grouped_matmul")]
+
+
+@register_compute("raf.op.tvm.grouped_matmul_dw")
+def compute_grouped_matmul_dw(attr, inputs, output_type):
+    x, dy, group_sizes = inputs
+    transpose_b = bool(attr.transpose_b)
+    num_rows, k_dim = x.shape
+    n_dim = dy.shape[1]
+    num_groups = group_sizes.shape[0]
+    gid = _group_ids(group_sizes, num_rows)
+    t = _tvm.te.reduce_axis((0, num_rows), name="t")
+    zero = _tvm.tir.const(0, x.dtype)
+
+    def fcompute(g, i, j):
+        k_idx, n_idx = (j, i) if transpose_b else (i, j)
+        return _tvm.te.sum(_tvm.tir.Select(gid[t] == g, x[t, k_idx] * dy[t, n_idx], zero), axis=t)
+
+    shape = (num_groups, n_dim, k_dim) if transpose_b else (num_groups, k_dim, n_dim)
+    return [_tvm.te.compute(shape, fcompute, name="grouped_matmul_dw")]
+
+
+_reg.register_schedule("raf.op.tvm.grouped_matmul", schedule_generic)
+_reg.register_schedule("raf.op.tvm.grouped_matmul_dw", schedule_generic)
+
+
 @generic_func
 def schedule_layer_norm(attrs, outs, target):
     with target:
@@ -940,3 +1312,58 @@ def batch_norm_train_dxwb_compute(attrs, inputs, output_type):  # pylint: disabl
 
 
 _reg.register_reduce_schedule("raf.op.tvm.batch_norm_train_dxwb")
+
+
+def _flat_index(shape, idx):
+    flat = idx[0]
+    for dim, i in zip(shape[1:], idx[1:]):
+        flat = flat * dim + i
+    return flat
+
+
+@register_compute("raf.op.tvm._contrib_batch_norm_add_relu_train")
+def batch_norm_add_relu_train_compute(attrs, inputs, output_type):
+    y, running_m, running_v = batch_norm_train_compute(attrs, inputs[:5], output_type)
+    if len(inputs) > 5:
+        y = _topi.add(y, inputs[5])
+    y = _topi.nn.relu(y)
+    shape = _topi.utils.get_const_tuple(y.shape)
+    size = reduce(operator.mul, shape, 1)
+    flat_y = _topi.reshape(y, (size,))
+    k = _tvm.te.reduce_axis((0, 32), name="k")
+    # Bit k of the word j is set if the element 32 * j + k of y is positive.
+    mask = _tvm.te.compute(
+        ((size + 31) // 32,),
+        lambda j: _tvm.te.sum(
+            _tvm.te.if_then_else(
+                _tvm.tir.all(j * 32 + k < size, flat_y[j * 32 + k] > 0),
+                _tvm.tir.const(1, "uint32") << k.var.astype("uint32"),
+                _tvm.tir.const(0, "uint32"),
+            ),
+            axis=k,
+        ),
+    )
+    mask = _topi.cast(mask, "int32")
+    return [y, running_m, running_v, mask]
+
+
+_reg.register_reduce_schedule("raf.op.tvm._contrib_batch_norm_add_relu_train")
+
+
+@register_compute("raf.op.tvm._contrib_batch_norm_add_relu_train_dxwb")
+def batch_norm_add_relu_train_dxwb_compute(attrs, inputs, output_type):
+    dy, x, mask, w, b = inputs
+    shape = _topi.utils.get_const_tuple(x.shape)
+
+    def masked_dy(*idx):
+        flat = _flat_index(shape, idx)
+        word = _topi.cast(mask[flat // 32], "uint32")
+        bit = (word >> _topi.cast(flat % 32, "uint32")) & _tvm.tir.const(1, "uint32")
+        return _tvm.te.if_then_else(bit > 0, dy[idx], _tvm.tir.const(0, dy.dtype))
+
+    dz = _tvm.te.compute(dy.shape, masked_dy)
+    dx, dw, db = batch_norm_train_dxwb_compute(attrs, [dz, x, w, b], output_type)
+    return [dx, dw, db, dz]
+
+
+_reg.register_reduce_schedule("raf.op.tvm._contrib_batch_norm_add_relu_train_dxwb")
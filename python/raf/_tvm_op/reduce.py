@@ -214,6 +214,35 @@ def mean_dx_compute(attrs, inputs, output_type):
 _reg.register_injective_schedule("raf.op.tvm.mean_dx")
 
 
+@register_compute("raf.op.tvm.moments")
+def moments_compute(attrs, inputs, output_type):
+    # The reference computes the mean first and the variance from the centered input, which is two
+    # passes. The CUDA dialect computes both in a single Welford pass.
+    x = inputs[0]
+    ndim = len(x.shape)
+    axis = sorted([i % ndim for i in _topi.utils.get_const_tuple(attrs.axis)])
+    if attrs.exclude:
+        axis = axis_exclude(axis, x.shape)
+    dtype = x.dtype
+    if dtype == "float16":
+        x = _topi.cast(x, "float32")
+    count = _tvm.tir.const(mul_shapes(list(_topi.utils.get_const_tuple(x.shape)), axis), x.dtype)
+    mean = _topi.divide(_topi.sum(x, axis=axis, keepdims=True), count)
+    centered = _topi.subtract(x, mean)
+    var = _topi.divide(
+        _topi.sum(_topi.multiply(centered, centered), axis=axis, keepdims=attrs.keepdims), count
+    )
+    if not attrs.keepdims:
+        mean = _topi.squeeze(mean, axis=axis)
+    if dtype == "float16":
+        mean = _topi.cast(mean, dtype)
+        var = _topi.cast(var, dtype)
+    return [mean, var]
+
+
+_reg.register_reduce_schedule("raf.op.tvm.moments")
+
+
 @register_compute("raf.op.tvm.sum_dx")
 def sum_dx_compute(attrs, inputs, output_type):  # pylint: disable=no-member
     x, dy = inputs
@@ -14,17 +14,25 @@ _topi = _tvm.topi  # pylint: disable=invalid-name,no-member
 def sgd_compute(attr, inputs, output_type):
     # pylint: disable=unused-argument, invalid-name
     learning_rate, mu = attr.learning_rate, attr.mu
-    x0, dx, v0 = inputs
+    x0, dx, v0 = inputs[:3]
+    # The optional skip flag is read on the device, which keeps x and v when it is non-zero.
+    skip = inputs[3] if len(inputs) > 3 else None
     learning_rate = _tvm.tir.const(learning_rate, dtype=x0.dtype)
     mu = _tvm.tir.const(mu, dtype=x0.dtype)
 
     def fcomputev(*args):
-        return mu * v0(*args) + dx(*args)
+        v = mu * v0(*args) + dx(*args)
+        if skip is not None:
+            v = _tvm.tir.if_then_else(skip[()] != 0, v0(*args), v)
+        return v
 
     v1 = _tvm.te.compute(v0.shape, fcomputev)
 
     def fcomputex(*args):
-        return x0(*args) - learning_rate * v1(*args)
+        x = x0(*args) - learning_rate * v1(*args)
+        if skip is not None:
+            x = _tvm.tir.if_then_else(skip[()] != 0, x0(*args), x)
+        return x
 
     x1 = _tvm.te.compute(x0.shape, fcomputex)
     return [v1, x1]
@@ -3,4 +3,6 @@
 
 """Automatic mixed precision (AMP) module"""
 from .amp import autocast, CustomTypeHint
+from .fp8 import autocast_fp8
+from .loss_scaler import DynamicLossScaler
 from . import type_hints
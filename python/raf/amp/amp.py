@@ -4,11 +4,11 @@
 """Functions for enabling AMP (automatic mixed precision)."""
 # pylint: disable=protected-access
 from raf._ffi.pass_ import AutoCast, InferType
-from raf._lib import relay
+from raf._lib import relay, PassContext
 from raf.frontend.model import FrameworkModel
 
 
-def autocast(model, args=None):
+def autocast(model, args=None, dtype=None, cast_policy=None):
     """Convert a model running in single precison to half precision.
 
     Parameters
@@ -18,10 +18,33 @@ def autocast(model, args=None):
 
     args: Optional[List[raf.ndarray]]
         The input data of the model.
+
+    dtype: Optional[str]
+        The AMP dtype, which is either "float16" or "bfloat16". If None, use "raf.amp.dtype"
+        in the current pass context, which is float16 by default.
+
+    cast_policy: Optional[Dict[str, str]]
+        The map from op names to their cast policies, which override the registered cast rules.
+        A policy is one of "always" (cast to the AMP dtype), "never" (keep the original dtype)
+        and "infer" (follow the majority of the arguments).
     """
     args = args if args is not None else []
     mod = model._internal(*args).mod
-    mod = AutoCast()(mod)
+    curr = PassContext.current()
+    config = dict(curr.config)
+    if dtype is not None:
+        config["raf.amp.dtype"] = dtype
+    if cast_policy is not None:
+        config["raf.amp.cast_policy"] = ",".join(
+            "%s:%s" % (op_name, policy) for op_name, policy in cast_policy.items()
+        )
+    with PassContext(
+        opt_level=curr.opt_level,
+        required_pass=curr.required_pass,
+        disabled_pass=curr.disabled_pass,
+        config=config,
+    ):
+        mod = AutoCast()(mod)
     mod = InferType()(mod)
     return FrameworkModel(mod, mod, model.state(), dict())
 
@@ -0,0 +1,55 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access
+"""FP8 autocast of the dense layers with the delayed scaling. TVM in RAF has no FP8 types, so
+the FP8 tensors are the uint8 bits of either E4M3 or E5M2, whose format is given by the ops."""
+import numpy as np
+
+from raf._core.ndarray import array
+from raf._ffi.pass_ import AutoCastFP8, InferType
+from raf.frontend.model import FrameworkModel
+
+E4M3_MAX = 448.0
+E5M2_MAX = 57344.0
+
+
+def autocast_fp8(model, args, history_len=16, margin=0, device="cuda"):
+    """Cast the inputs of the float16 and float32 dense layers of a model to E4M3, and run the
+    dense layers on the FP8 tensor cores of Hopper GPUs by cuBLASLt. Each input is scaled per
+    tensor by the maximum of its amaxes, i.e., max(abs(x)), in the last history_len steps. The
+    amax histories and the scales are the auxiliary params of the returned model, which stay on
+    the device and are updated in place after each step, so no host synchronization is required.
+    The scales start from 1, and the dense layers fall back to TVM on other devices.
+
+    Parameters
+    ----------
+    model : raf.model.Model
+        The model to cast.
+
+    args : List[raf.ndarray]
+        The inputs of the model to trace it.
+
+    history_len : int
+        The number of steps in the amax history.
+
+    margin : int
+        The scales are multiplied by 2^margin to leave the headroom for the growing amaxes.
+
+    device : str
+        The device of the amax histories and the scales, which only supports cuda.
+
+    Returns
+    -------
+    ret : raf.frontend.FrameworkModel
+        The model with FP8 dense layers.
+    """
+    record = model._internal(*args)
+    num_params = len(record.mod["main"].params)
+    mod = InferType()(AutoCastFP8(history_len, margin)(InferType()(record.mod)))
+    aux_params = {}
+    for param in mod["main"].params[num_params:]:
+        shape = [int(dim) for dim in param.checked_type.shape]
+        init = np.zeros(shape, dtype="float32") if shape else np.array(1.0, dtype="float32")
+        aux_params[param.name_hint] = array(init, device=device, name=param.name_hint)
+    return FrameworkModel(mod, mod, model.state(), aux_params)
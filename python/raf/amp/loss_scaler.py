@@ -0,0 +1,109 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=too-many-arguments, too-many-instance-attributes
+"""Dynamic loss scaling, whose scale and overflow flag stay on the device."""
+from raf._core.ndarray import array
+from raf._op import imp
+
+
+class DynamicLossScaler:
+    """Scale the loss to keep the float16 gradients from underflowing, and adjust the scale by
+    the overflows of the gradients. The loss scale, the growth tracker and the overflow flag are
+    float32 scalars on the device, and the optimizer skips the update by the flag on the device,
+    so no host synchronization is required in a training step.
+
+    Parameters
+    ----------
+    init_scale: float (optional)
+        the initial loss scale
+
+    growth_factor: float (optional)
+        the factor to multiply the scale by after growth_interval steps without overflow
+
+    backoff_factor: float (optional)
+        the factor to multiply the scale by on overflow
+
+    growth_interval: int (optional)
+        the number of consecutive steps without overflow to grow the scale
+
+    device: str (optional)
+        the device of the scale, which is the device of the gradients
+    """
+
+    def __init__(
+        self,
+        init_scale=2.0**16,
+        growth_factor=2.0,
+        backoff_factor=0.5,
+        growth_interval=2000,
+        device="cuda",
+    ):
+        assert growth_factor > 1.0, "The growth factor must be larger than 1"
+        assert 0.0 < backoff_factor < 1.0, "The backoff factor must be in (0, 1)"
+        self.growth_factor = growth_factor
+        self.backoff_factor = backoff_factor
+        self.growth_interval = growth_interval
+        self.scale = array(init_scale, dtype="float32", device=device, name="loss_scale")
+        self.growth_tracker = array(0, dtype="float32", device=device, name="growth_tracker")
+
+    def scale_loss(self, loss):
+        """Return the loss multiplied by the loss scale, whose gradients are to be unscaled."""
+        scale = self.scale
+        if loss.dtype != "float32":
+            scale = imp.cast(scale, loss.dtype)
+        return imp.multiply(loss, scale)
+
+    def unscale(self, params):
+        """Divide the gradients of the parameters in place by the loss scale. The gradients of
+        each dtype take a single multi-tensor launch.
+
+        Parameters
+        ----------
+        params: dict_values
+            iterable of parameters whose gradients are unscaled
+
+        Returns
+        -------
+        found_inf: Optional[raf.ndarray]
+            the float32 scalar whose value is 1 if any unscaled gradient is not finite, or None
+            without gradients
+        """
+        groups = {}
+        for x in params:
+            if x.grad is not None:
+                groups.setdefault(x.grad.dtype, []).append(x.grad)
+        found_inf = None
+        for grads in groups.values():
+            flag = imp.multi_tensor_unscale(grads, self.scale)[-1]
+            found_inf = flag if found_inf is None else imp.maximum(found_inf, flag)
+        return found_inf
+
+    def update(self, found_inf):
+        """Back off the loss scale on overflow, or grow it after growth_interval finite steps."""
+        imp.update_loss_scale(
+            self.scale,
+            self.growth_tracker,
+            found_inf,
+            self.growth_factor,
+            self.backoff_factor,
+            self.growth_interval,
+        )
+
+    def step(self, optimizer, params):
+        """Unscale the gradients, update the parameters by the optimizer unless the gradients
+        overflowed, and update the loss scale.
+
+        Parameters
+        ----------
+        optimizer: Union[FusedSGD, AdamW, LAMB, SGD, LANS]
+            the optimizer, whose step takes the skip flag
+
+        params: dict_values
+            iterable of parameters of the optimizer
+        """
+        found_inf = self.unscale(params)
+        if found_inf is None:
+            return
+        optimizer.step(skip=found_inf)
+        self.update(found_inf)
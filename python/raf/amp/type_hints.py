@@ -117,6 +117,11 @@ register_op_cast_rule("raf.op.batch_matmul", generic_cast(True, 2))
 register_op_cast_rule("raf.op.batch_matmul_nt", generic_cast(True, 2))
 register_op_cast_rule("raf.op.batch_matmul_tn", generic_cast(True, 2))
 register_op_cast_rule("raf.op.batch_matmul_tt", generic_cast(True, 2))
+register_op_cast_rule("raf.op.grouped_matmul", generic_cast(True, 2))
+register_op_cast_rule("raf.op.grouped_matmul_dw", generic_cast(True, 2))
+# The fused attention kernels accumulate the scores and the softmax in float32.
+register_op_cast_rule("raf.op._contrib_attention", generic_cast(True, 3))
+register_op_cast_rule("raf.op._contrib_attention_dx", generic_cast(True, 5))
 
 # Never cast.
 register_op_cast_rule("raf.op.arange", generic_cast(False, 3))
@@ -125,6 +130,23 @@ register_op_cast_rule("raf.op.power", generic_cast(False, 1))
 register_op_cast_rule("raf.op.softmax", generic_cast(False, 1))
 register_op_cast_rule("raf.op.softmax_dx", generic_cast(False, 2))
 register_op_cast_rule("raf.op.lans", generic_cast(False, 2))
+register_op_cast_rule("raf.op.multi_sgd", generic_cast(False, 1))
+register_op_cast_rule("raf.op.adamw", generic_cast(False, 2))
+register_op_cast_rule("raf.op.lamb", generic_cast(False, 2))
+register_op_cast_rule("raf.op.multi_tensor_l2norm", generic_cast(False, 1))
+register_op_cast_rule("raf.op.multi_tensor_clip", generic_cast(False, 2))
+register_op_cast_rule("raf.op.multi_tensor_unscale", generic_cast(False, 2))
+register_op_cast_rule("raf.op.update_loss_scale", generic_cast(False, 3))
+register_op_cast_rule("raf.op.sparse_sgd", generic_cast(False, 4))
+register_op_cast_rule("raf.op._contrib_kv_cache_append", generic_cast(False, 3))
+register_op_cast_rule("raf.op._contrib_quantize", generic_cast(False, 3))
+register_op_cast_rule("raf.op._contrib_dequantize", generic_cast(False, 3))
+register_op_cast_rule("raf.op._contrib_quantized_dense", generic_cast(False, 4))
+register_op_cast_rule("raf.op._contrib_sparse_dense", generic_cast(True, 2))
+register_op_cast_rule("raf.op._contrib_quantize_fp8", generic_cast(False, 3))
+register_op_cast_rule("raf.op._contrib_dequantize_fp8", generic_cast(False, 3))
+register_op_cast_rule("raf.op._contrib_fp8_dense", generic_cast(False, 7))
+register_op_cast_rule("raf.op._contrib_update_fp8_scale", generic_cast(False, 5))
 register_op_cast_rule("raf.op.log_softmax", generic_cast(False, 1))
 register_op_cast_rule("raf.op.log_softmax_dx", generic_cast(False, 2))
 register_op_cast_rule("raf.op.erf", generic_cast(False, 1))
@@ -145,6 +167,7 @@ register_op_cast_rule("raf.op.cross_entropy_dtrue", generic_cast(False, 2))
 # over float32, so never cast.
 register_op_cast_rule("raf.op.take_dx", generic_cast(3, False))
 register_op_cast_rule("raf.op.embedding_dx", generic_cast(2, False))
+register_op_cast_rule("raf.op.embedding_sparse_dx", generic_cast(False, 2))
 
 # FIXME: These ops should support float16, but the current TVM code results in
 # either runtime error or mismatch outputs.
@@ -270,6 +293,7 @@ register_op_cast_rule("raf.op.max", infer_cast(1))
 register_op_cast_rule("raf.op.min", infer_cast(1))
 register_op_cast_rule("raf.op.mean", infer_cast(1))
 register_op_cast_rule("raf.op.mean_dx", infer_cast(1))
+register_op_cast_rule("raf.op.moments", infer_cast(1))
 register_op_cast_rule("raf.op.get_reduce_axis", infer_cast(2))
 register_op_cast_rule("raf.op.get_kept_dims", infer_cast(2))
 register_op_cast_rule("raf.op.sgd", infer_cast(1))
@@ -297,6 +321,8 @@ register_op_cast_rule("raf.op.get_valid_counts", infer_cast(1))
 register_op_cast_rule("raf.op.bias_add", infer_cast(2))
 register_op_cast_rule("raf.op._contrib_dropout", infer_cast(1))
 register_op_cast_rule("raf.op._contrib_dropout_dx", infer_cast(1))
+register_op_cast_rule("raf.op._contrib_philox_dropout", infer_cast(1))
+register_op_cast_rule("raf.op._contrib_philox_dropout_dx", infer_cast(1))
 register_op_cast_rule("raf.op.non_max_suppression", infer_cast(1))
 register_op_cast_rule("raf.op._allreduce", infer_cast(1))
 register_op_cast_rule("raf.op._allgather", infer_cast(1))
@@ -416,6 +442,21 @@ register_op_cast_rule("raf.op.batch_norm_train", op_cast_norm(1))
 register_op_cast_rule("raf.op.batch_norm_train_dxwb", op_cast_norm(2))
 
 
+def op_cast_batch_norm_add_relu_train(args, ret_type, amp_dtype):
+    """It has args in order (x, running_mean, running_var, w, b, z, momentum, eps), where the
+    residual z follows x."""
+    ret = op_cast_norm(1)(args, ret_type, amp_dtype)
+    if isinstance(args[5].checked_type, tvm.ir.TensorType):
+        ret[5] = PrimType(amp_dtype)
+    return ret
+
+
+register_op_cast_rule(
+    "raf.op._contrib_batch_norm_add_relu_train", op_cast_batch_norm_add_relu_train
+)
+register_op_cast_rule("raf.op._contrib_batch_norm_add_relu_train_dxwb", op_cast_norm(2))
+
+
 register_op_cast_rule("raf.op.layer_norm", infer_cast(1))
 register_op_cast_rule("raf.op.layer_norm_dx", infer_cast(3))
 
@@ -51,6 +51,11 @@ def with_cutlass():
     return build_info.use_cutlass() != "OFF"
 
 
+def with_cupti():
+    """Whether the CUPTI GPU activity profiler is enabled."""
+    return build_info.use_cupti() != "OFF"
+
+
 def cmake_build_type():
     """Return cmake build type"""
     return build_info.cmake_build_type()
@@ -68,14 +73,14 @@ def build_with(backend):  # pylint: disable=too-many-return-statements
     -------
     Whether the backend is built with RAF.
     """
-    assert backend in ["tvm", "cuda", "cudnn", "cutlass", "cublas", "nccl"], (
+    assert backend in ["tvm", "cuda", "cudnn", "cutlass", "cublas", "cublaslt", "nccl"], (
         "Invalid backend: %s" % backend
     )
     if backend == "tvm":
         return True  # it seems like that we always build with TVM
     if backend == "cuda":
         return with_cuda() is not None
-    if backend == "cublas":
+    if backend in ["cublas", "cublaslt"]:
         return with_cublas()
     if backend == "cudnn":
         return with_cudnn() is not None
@@ -5,3 +5,6 @@
 from raf._ffi.distributed import RemoveCommunicator
 from .op import allreduce, allgather, reduce, reduce_scatter, broadcast, send, recv
 from .context import DistContext, get_context
+from . import pipeline
+from . import checkpoint
+from . import sequence_parallel
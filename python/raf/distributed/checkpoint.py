@@ -0,0 +1,228 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+"""Sharded checkpoints. Instead of gathering all states to rank 0, each rank writes its own states
+to a common directory in parallel: the partitioned states (e.g., the ZeRO optimizer states) are
+written by every rank, and the replicated states are spread over the ranks. The states are copied
+to the pinned host memory asynchronously and written by a background thread, so the training only
+stalls for issuing the copies. An index of the states allows loading with a different world size.
+
+The directory contains "index.json" written by rank 0, and "rank<r>.npz" written by each rank r.
+"""
+import json
+import math
+import os
+import threading
+
+import numpy as np
+
+from raf._core.ndarray import ndarray
+from .context import get_context
+
+INDEX_FILE = "index.json"
+
+
+def _rank_file(directory, rank):
+    return os.path.join(directory, "rank%d.npz" % rank)
+
+
+def zero_shards(model):
+    """Get the states partitioned by ZeRO along the first axis, such as the SGD weights and
+    variants of a model wrapped by raf.optim.sgd.with_sgd.
+
+    Parameters
+    ----------
+    model : raf.Model
+        The model wrapped by the optimizer.
+
+    Returns
+    -------
+    ret : Dict[str, int]
+        The map from the state name to the size of its first axis before partitioning.
+    """
+    if not get_context().zero_opt_level or not getattr(model, "has_sgd_w", False):
+        return {}
+    shards = {}
+    for name, param, _, _ in getattr(model, "params", {}).values():
+        shards["%s.sgd_w" % name] = param.shape[0]
+        shards["%s.sgd_v" % name] = param.shape[0]
+    return shards
+
+
+class CheckpointHandle:
+    """The pending save of a checkpoint on the current rank."""
+
+    def __init__(self, thread, errors):
+        self._thread = thread
+        self._errors = errors
+
+    def done(self):
+        """Check whether the files of this rank are written without blocking."""
+        return not self._thread.is_alive()
+
+    def wait(self):
+        """Wait until the files of this rank are written, and raise the error of the writer."""
+        self._thread.join()
+        if self._errors:
+            raise self._errors[0]
+
+
+def save_checkpoint(model, directory, sharded=None, rank=None, size=None):
+    """Save the states of a model to a directory shared by all ranks, without waiting for the
+    files to be written. The states must not be updated out of place before the save is done,
+    while the in-place updates of the following steps are ordered after the copies on the device.
+
+    Parameters
+    ----------
+    model : raf.Model
+        The model to save, whose states are the same on all ranks except for the sharded ones.
+
+    directory : str
+        The directory to save to, which is created if not existed.
+
+    sharded : Optional[Dict[str, int]]
+        The states partitioned along the first axis (padded to be divisible by the number of
+        ranks), mapped to the size of their first axis before partitioning. Default is the
+        ZeRO partitions given by zero_shards.
+
+    rank : Optional[int]
+        The rank of this process. Default is the rank of the distributed context.
+
+    size : Optional[int]
+        The number of ranks. Default is the size of the distributed context.
+
+    Returns
+    -------
+    ret : CheckpointHandle
+        The handle to wait for the save.
+    """
+    dctx = get_context()
+    rank = dctx.rank if rank is None else rank
+    size = dctx.size if size is None else size
+    sharded = zero_shards(model) if sharded is None else sharded
+    os.makedirs(directory, exist_ok=True)
+
+    index = {"num_ranks": size, "states": {}}
+    copies = []
+    for i, (name, param) in enumerate(model.state().items()):
+        entry = {"dtype": param.dtype, "shape": list(param.shape)}
+        if name in sharded:
+            entry["shape"][0] = sharded[name]
+            entry["shard_rows"] = param.shape[0]
+        else:
+            # The replicated states are spread over the ranks to write in parallel.
+            entry["rank"] = i % size
+        index["states"][name] = entry
+        if name in sharded or entry["rank"] == rank:
+            # The host copy of a CPU array would otherwise race with the in-place updates.
+            copy = param.numpy() if param.device.startswith("cpu") else param.numpy_async()
+            copies.append((name, copy))
+
+    errors = []
+
+    def write():
+        try:
+            arrays = {}
+            for name, copy in copies:
+                arrays[name] = copy if isinstance(copy, np.ndarray) else copy.numpy()
+            path = _rank_file(directory, rank)
+            with open(path + ".tmp", "wb") as out_file:
+                np.savez(out_file, **arrays)
+            os.replace(path + ".tmp", path)
+            if rank == 0:
+                with open(os.path.join(directory, INDEX_FILE + ".tmp"), "w") as out_file:
+                    json.dump(index, out_file, indent=1)
+                os.replace(
+                    os.path.join(directory, INDEX_FILE + ".tmp"),
+                    os.path.join(directory, INDEX_FILE),
+                )
+        except Exception as err:  # pylint: disable=broad-except
+            errors.append(err)
+
+    thread = threading.Thread(target=write, daemon=True)
+    thread.start()
+    return CheckpointHandle(thread, errors)
+
+
+class _Reader:
+    """Read the rows of the saved states, opening each rank file at most once."""
+
+    def __init__(self, directory):
+        self.directory = directory
+        with open(os.path.join(directory, INDEX_FILE)) as in_file:
+            self.index = json.load(in_file)
+        self.files = {}
+
+    def file(self, rank):
+        if rank not in self.files:
+            path = _rank_file(self.directory, rank)
+            assert os.path.exists(path), "Missing %s of the checkpoint" % path
+            self.files[rank] = np.load(path)
+        return self.files[rank]
+
+    def rows(self, name, start, stop):
+        """Read rows [start, stop) of the first axis of a state before partitioning."""
+        assert name in self.index["states"], "State %s is not in the checkpoint" % name
+        entry = self.index["states"][name]
+        if "shard_rows" not in entry:
+            return self.file(entry["rank"])[name][start:stop]
+        shard_rows = entry["shard_rows"]
+        parts = [self.file(0)[name][:0]]
+        for shard in range(start // shard_rows, math.ceil(stop / shard_rows)):
+            data = self.file(shard)[name]
+            offset = shard * shard_rows
+            parts.append(data[max(start - offset, 0) : min(stop - offset, shard_rows)])
+        return np.concatenate(parts, axis=0)
+
+
+def load_checkpoint(model, directory, sharded=None, rank=None, size=None):
+    """Load the states of a model from a checkpoint, which may be saved with a different number
+    of ranks. The sharded states are re-partitioned for the current ranks.
+
+    Parameters
+    ----------
+    model : raf.Model
+        The model to load to, whose states are updated in place.
+
+    directory : str
+        The directory of the checkpoint.
+
+    sharded : Optional[Dict[str, int]]
+        The states partitioned along the first axis on the current ranks, mapped to the size of
+        their first axis before partitioning. Default is the ZeRO partitions given by zero_shards.
+
+    rank : Optional[int]
+        The rank of this process. Default is the rank of the distributed context.
+
+    size : Optional[int]
+        The number of ranks. Default is the size of the distributed context.
+    """
+    dctx = get_context()
+    rank = dctx.rank if rank is None else rank
+    size = dctx.size if size is None else size
+    sharded = zero_shards(model) if sharded is None else sharded
+    reader = _Reader(directory)
+
+    for name, param in model.state().items():
+        entry = reader.index["states"].get(name)
+        assert entry is not None, "State %s is not in the checkpoint" % name
+        num_rows = entry["shape"][0] if entry["shape"] else 0
+        if name in sharded:
+            assert sharded[name] == num_rows, "Mismatched shape of %s" % name
+            shard_rows = math.ceil(num_rows / size)
+            start = min(rank * shard_rows, num_rows)
+            data = reader.rows(name, start, min(start + shard_rows, num_rows))
+            if data.shape[0] < shard_rows:
+                pad_width = [(0, 0) for _ in data.shape]
+                pad_width[0] = (0, shard_rows - data.shape[0])
+                data = np.pad(data, pad_width)
+        elif "shard_rows" in entry:
+            data = reader.rows(name, 0, num_rows)
+        else:
+            data = reader.file(entry["rank"])[name]
+        assert tuple(data.shape) == tuple(param.shape), "Mismatched shape of %s: %s vs. %s" % (
+            name,
+            data.shape,
+            param.shape,
+        )
+        param.update(ndarray(data.astype(param.dtype), device=param.device))
@@ -23,6 +23,58 @@ class DistContext(Object):
         self.enable_data_parallel_ = value
         ffi.EnableDataParallel(value)
 
+    @property
+    def enable_hierarchical_allreduce(self):
+        return self.enable_hierarchical_allreduce_
+
+    @enable_hierarchical_allreduce.setter
+    def enable_hierarchical_allreduce(self, value):
+        self.enable_hierarchical_allreduce_ = value
+        ffi.EnableHierarchicalAllReduce(value)
+
+    @property
+    def auto_select_allreduce(self):
+        return self.auto_select_allreduce_
+
+    @auto_select_allreduce.setter
+    def auto_select_allreduce(self, value):
+        """Whether each allreduce chooses between the flat and the hierarchical algorithms by its
+        message size and the topology probed at the start, i.e., num_nodes, intra_node_link,
+        peer_bandwidth and inter_node_bandwidth."""
+        self.auto_select_allreduce_ = value
+        ffi.AutoSelectAllReduce(value)
+
+    @property
+    def allreduce_compression(self):
+        return self.allreduce_compression_
+
+    @allreduce_compression.setter
+    def allreduce_compression(self, value):
+        """The gradient compression of allreduce, which is one of "none", "fp16", "bf16",
+        and "topk"."""
+        self.allreduce_compression_ = value
+        ffi.SetAllReduceCompression(value)
+
+    @property
+    def allreduce_topk_ratio(self):
+        return self.allreduce_topk_ratio_
+
+    @allreduce_topk_ratio.setter
+    def allreduce_topk_ratio(self, value):
+        self.allreduce_topk_ratio_ = value
+        ffi.SetAllReduceTopKRatio(value)
+
+    @property
+    def allreduce_fp32_accumulate(self):
+        return self.allreduce_fp32_accumulate_
+
+    @allreduce_fp32_accumulate.setter
+    def allreduce_fp32_accumulate(self, value):
+        """Whether the sum and average of float16 and bfloat16 tensors are accumulated in float32,
+        which are still communicated in 16 bits by a reduce-scatter and an allgather."""
+        self.allreduce_fp32_accumulate_ = value
+        ffi.SetAllReduceFP32Accumulate(value)
+
     @property
     def size(self):
         return self.size_
@@ -50,6 +102,28 @@ class DistContext(Object):
         self.zero_opt_level_ = value
         ffi.ZeroOpt(value)
 
+    @property
+    def local_sgd_period(self):
+        return self.local_sgd_period_
+
+    @local_sgd_period.setter
+    def local_sgd_period(self, value):
+        """The number of steps between the parameter averages of local SGD. When it is larger than
+        1, the gradients are applied locally without allreduce, and the parameters are averaged
+        across the ranks every local_sgd_period steps by the "averager" model of the optimizer."""
+        self.local_sgd_period_ = value
+        ffi.SetLocalSGDPeriod(value)
+
+    @property
+    def local_sgd_average_momentum(self):
+        return self.local_sgd_average_momentum_
+
+    @local_sgd_average_momentum.setter
+    def local_sgd_average_momentum(self, value):
+        """Whether local SGD averages the momentum buffers along with the parameters."""
+        self.local_sgd_average_momentum_ = value
+        ffi.SetLocalSGDAverageMomentum(value)
+
     @property
     def auto_dp_profiling_start_iter(self):
         return self.auto_dp_profiling_start_iter_
@@ -71,9 +145,16 @@ class DistContext(Object):
     def dumps(self):
         attr_keys = [
             "enable_data_parallel",
+            "enable_hierarchical_allreduce",
+            "auto_select_allreduce",
+            "allreduce_compression",
+            "allreduce_topk_ratio",
+            "allreduce_fp32_accumulate",
             "size",
             "rank",
             "zero_opt_level",
+            "local_sgd_period",
+            "local_sgd_average_momentum",
             "auto_dp_profiling_start_iter",
             "auto_dp_profiling_end_iter",
         ]
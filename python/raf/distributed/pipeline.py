@@ -0,0 +1,99 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+"""Pipeline parallelism. The model is partitioned to stages by the PipelinePartition pass,
+and each rank runs the micro-batches of its stage following a 1F1B (one-forward-one-backward)
+schedule, which bounds the number of in-flight micro-batches by the number of stages."""
+from raf._ffi.profiler import NowInMicrosec, AddProfileStat
+
+
+def schedule_1f1b(num_stages, stage, num_micro_batches):
+    """Generate the 1F1B schedule of the given stage.
+
+    Parameters
+    ----------
+    num_stages : int
+        The number of pipeline stages.
+
+    stage : int
+        The stage of the current rank.
+
+    num_micro_batches : int
+        The number of micro-batches of a mini-batch.
+
+    Returns
+    -------
+    ret : List[Tuple[str, int]]
+        The list of ("forward" | "backward", micro-batch index) in execution order.
+    """
+    assert 0 <= stage < num_stages, "Stage %d is out of range [0, %d)" % (stage, num_stages)
+    # The warm-up forwards to fill the pipeline.
+    num_warmup = min(num_stages - stage - 1, num_micro_batches)
+    schedule = [("forward", i) for i in range(num_warmup)]
+    # The steady phase alternates one forward and one backward.
+    for i in range(num_micro_batches - num_warmup):
+        schedule.append(("forward", num_warmup + i))
+        schedule.append(("backward", i))
+    # The cool-down backwards to drain the pipeline.
+    for i in range(num_micro_batches - num_warmup, num_micro_batches):
+        schedule.append(("backward", i))
+    return schedule
+
+
+def bubble_ratio(num_stages, num_micro_batches):
+    """The ideal bubble ratio of a 1F1B pipeline, assuming all stages take the same time."""
+    return (num_stages - 1) / (num_micro_batches + num_stages - 1)
+
+
+def run_schedule(schedule, forward, backward=None, stage=0, memory_mb=None):
+    """Run the micro-batches following the given schedule, and record each step as well as the
+    stage summary to the profiler under category "Pipeline".
+
+    Parameters
+    ----------
+    schedule : List[Tuple[str, int]]
+        The schedule generated by schedule_1f1b.
+
+    forward : Callable[[int], Any]
+        Run the forward of the given micro-batch, such as a VM executable of this stage.
+        The step should be synchronized, so that its duration is accurate.
+
+    backward : Optional[Callable[[int], Any]]
+        Run the backward of the given micro-batch. The backward steps are skipped if None,
+        which is the case of inference.
+
+    stage : int
+        The stage of the current rank.
+
+    memory_mb : Optional[float]
+        The estimated memory of this stage, such as the one from EstimatePipelineStages.
+
+    Returns
+    -------
+    ret : List[Any]
+        The forward results of each micro-batch.
+    """
+    outs = {}
+    durations = {"forward": [], "backward": []}
+    start = NowInMicrosec()
+    for kind, idx in schedule:
+        if kind == "backward" and backward is None:
+            continue
+        step_start = NowInMicrosec()
+        if kind == "forward":
+            outs[idx] = forward(idx)
+        else:
+            backward(idx)
+        step_end = NowInMicrosec()
+        durations[kind].append(step_end - step_start)
+        AddProfileStat("Pipeline", "%s_%d" % (kind, idx), step_start, step_end, [])
+    end = NowInMicrosec()
+
+    # A step also includes the time waiting for its neighbors, so the compute time of a step is
+    # estimated by the fastest one, and the rest of the stage time is the bubble.
+    busy = sum(len(steps) * min(steps) for steps in durations.values() if steps)
+    args = ["bubble_ms=%.3f" % ((end - start - busy) / 1000.0)]
+    if memory_mb is not None:
+        args.append("memory_mb=%.2f" % memory_mb)
+    AddProfileStat("Pipeline", "stage_%d" % stage, start, end, args)
+    return [outs[i] for i in sorted(outs)]
@@ -0,0 +1,106 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+"""Sequence parallelism for long sequences. The sequence axis of the activations is partitioned
+across the ranks, so each rank keeps 1/n of the activations. The token-wise ops, such as layer norm,
+dropout and the element-wise ops, run on the local chunk as is. The attention gathers the keys and
+values of all ranks with allgather, whose gradient reduce-scatters the gradients of the gathered
+chunks back to their ranks, so the math is the same as the unpartitioned model.
+
+Since the weights are replicated, their gradients are averaged by the data parallel pass with
+enable_data_parallel, given that the loss is averaged over the local tokens of each rank.
+"""
+import numpy as np
+
+from .._op import sym
+from .context import get_context
+from .op import allgather
+
+
+def shard_sequence(data, axis=1, rank=None, size=None):
+    """Get the local chunk of the sequence of an input, such as the token ids of a batch.
+
+    Parameters
+    ----------
+    data : np.ndarray
+        The whole input.
+
+    axis : int
+        The sequence axis, whose length must be divisible by the number of ranks.
+
+    rank : Optional[int]
+        The rank of this process. Default is the rank of the distributed context.
+
+    size : Optional[int]
+        The number of ranks. Default is the size of the distributed context.
+
+    Returns
+    -------
+    ret : np.ndarray
+        The local chunk.
+    """
+    dctx = get_context()
+    rank = dctx.rank if rank is None else rank
+    size = dctx.size if size is None else size
+    assert data.shape[axis] % size == 0, "The sequence length %d is not divisible by %d" % (
+        data.shape[axis],
+        size,
+    )
+    return np.split(data, size, axis=axis)[rank]
+
+
+def gather_sequence(x, axis=1):
+    """Gather the sequence chunks of all ranks, in the order of the ranks.
+
+    Parameters
+    ----------
+    x : Tensor
+        The local chunk.
+
+    axis : int
+        The sequence axis.
+
+    Returns
+    -------
+    ret : Tensor
+        The whole sequence.
+    """
+    if get_context().size == 1:
+        return x
+    return allgather(x, axis=axis)
+
+
+def attention(query, key, value, scale, mask=None):
+    """The scaled dot-product attention of the local queries over the whole sequence.
+
+    Parameters
+    ----------
+    query : Tensor
+        The local queries in shape [batch, local_seq, dim], where the heads are folded into the
+        batch axis.
+
+    key : Tensor
+        The local keys in shape [batch, local_seq, dim].
+
+    value : Tensor
+        The local values in shape [batch, local_seq, dim].
+
+    scale : float
+        The scale of the attention scores, usually dim ** -0.5.
+
+    mask : Optional[Tensor]
+        The additive mask of the attention scores in shape [local_seq, seq], e.g., the causal mask
+        of the local queries, which are at offset rank * local_seq of the sequence.
+
+    Returns
+    -------
+    ret : Tensor
+        The attention output of the local queries in shape [batch, local_seq, dim].
+    """
+    key = gather_sequence(key, axis=1)
+    value = gather_sequence(value, axis=1)
+    score = sym.multiply(sym.batch_matmul_nt(query, key), scale)
+    if mask is not None:
+        score = sym.add(score, mask)
+    prob = sym.softmax(score, axis=-1)
+    return sym.batch_matmul(prob, value)
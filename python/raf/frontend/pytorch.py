@@ -10,6 +10,7 @@ import torch
 
 from raf import distributed as dist
 from .._core.ndarray import ndarray
+from .._core.value import TensorValue
 from .._lib import relay
 from .._ffi.pass_ import FromRelay, SwitchTrainOp, validate_relay_param_name
 from ..frontend.model import FrameworkModel
@@ -105,7 +106,7 @@ def trace_model(model, input_type, input_shape):
     return scripted_model
 
 
-def from_pytorch(model, shape_dict, model_file=None, hash_file=None):
+def from_pytorch(model, shape_dict, model_file=None, hash_file=None, share_params=False):
     """Load PyTorch model and convert into RAF via Relay.
 
     Parameters
@@ -122,6 +123,12 @@ def from_pytorch(model, shape_dict, model_file=None, hash_file=None):
 
     hash_file: str
         The file that stores the scripted model hash
+
+    share_params: bool
+        Whether the parameters share the storage of the Relay parameters instead of copying them,
+        which reduces the peak host memory of converting large models. Note that the shared
+        parameters are no longer independent of the Relay parameters.
+
     Returns
     -------
     model: FrameworkModel
@@ -158,7 +165,12 @@ def from_pytorch(model, shape_dict, model_file=None, hash_file=None):
     for var in relay_mod["main"].params:
         name = var.name_hint
         if name in relay_params:
-            meta_params[validate_relay_param_name(name)] = ndarray(relay_params[name].numpy())
+            param = relay_params[name]
+            if share_params:
+                param = ndarray.from_tensor_value(TensorValue.from_tvm(param))
+            else:
+                param = ndarray(param.numpy())
+            meta_params[validate_relay_param_name(name)] = param
     # relay_params may contain unused parameters, which are not present in meta_params
     assert len(meta_params) <= len(relay_params)
     return FrameworkModel(SwitchTrainOp(True)(meta_mod), meta_mod, meta_params, {})
@@ -5,6 +5,7 @@
 # pylint: disable=protected-access, too-many-locals
 import ast
 import inspect
+from collections import defaultdict
 from typing import Callable, Dict, List
 
 from raf._lib import relay
@@ -91,6 +92,58 @@ class BB2Relay(NodeVisitor):
         return relay.If(test, then_, else_)
 
 
+class _CallCollector(relay.ExprVisitor):
+    def __init__(self):
+        super(_CallCollector, self).__init__()
+        self.callees = []
+
+    def visit_call(self, call):
+        if isinstance(call.op, relay.GlobalVar):
+            self.callees.append(call.op)
+        super(_CallCollector, self).visit_call(call)
+
+
+class _JumpInliner(relay.ExprMutator):
+    def __init__(self, callee: relay.GlobalVar, func: relay.Function):
+        super(_JumpInliner, self).__init__()
+        self.callee = callee
+        self.func = func
+
+    def visit_call(self, call):
+        if not call.op.same_as(self.callee):
+            return super(_JumpInliner, self).visit_call(call)
+        body = self.func.body
+        for param, arg in reversed(list(zip(self.func.params, call.args))):
+            body = relay.Let(param, self.visit(arg), body)
+        return body
+
+
+def inline_jumps(hybrid_module: HybridModule, entry: relay.GlobalVar) -> HybridModule:
+    """Inline each basic block that is jumped to from only one other basic block. The remaining
+    functions are the loop headers, so the back edge of an innermost loop becomes a self call in
+    the tail position, which VMCompiler compiles to a Goto that reuses the frame and the registers.
+    The compile time and the executable size are thus independent of the trip count."""
+    while True:
+        callers = defaultdict(list)
+        for global_var, func in hybrid_module.items():
+            collector = _CallCollector()
+            collector.visit(func.body)
+            for callee in collector.callees:
+                callers[callee].append(global_var)
+        for callee, sites in callers.items():
+            if callee.same_as(entry) or len(sites) != 1 or sites[0].same_as(callee):
+                continue
+            caller = sites[0]
+            inliner = _JumpInliner(callee, hybrid_module[callee])
+            caller_func = hybrid_module[caller]
+            body = inliner.visit(caller_func.body)
+            hybrid_module[caller] = relay.Function(params=caller_func.params, body=body)
+            del hybrid_module[callee]
+            break
+        else:
+            return hybrid_module
+
+
 def cfg2relay(
     cfg: CFG,
     pyfunc: Callable,
@@ -131,4 +184,4 @@ def cfg2relay(
     func = relay.Function(params=params, body=body)
     hybrid_module[entry] = func
 
-    return hybrid_module
+    return inline_jumps(hybrid_module, entry)
@@ -275,28 +275,180 @@ def calc_model_gflops(model, device, args):
     return total_gflops
 
 
-def trace_memory(model, device, args, include_param=True):
-    """A utility function to trace memory footprint of the model."""
+def _optimize(model, device, args, config=None):
+    """Optimize the model with the VM compiler through ManifestAlloc, and infer its type."""
     # pylint: disable=import-outside-toplevel
     import tvm
     from raf._core.vm import VMCompiler
-    from raf._ffi.pass_ import EstimateMemory, InferType
+    from raf._ffi.pass_ import InferType
 
     record = model._internal(*args)
     mod = record.mod
 
     compiler = VMCompiler()
-    with tvm.transform.PassContext(opt_level=3):
+    with tvm.transform.PassContext(opt_level=3, config=config or {}):
         mod, _ = compiler.optimize(mod, device)
-    mod = InferType()(mod)
+    return InferType()(mod)
+
+
+def trace_memory(model, device, args, include_param=True, memory_schedule=None):
+    """A utility function to trace memory footprint of the model. The memory schedule policy
+    ("greedy" or "optimal") can be specified to compare the memory footprint of schedules."""
+    # pylint: disable=import-outside-toplevel
+    from raf._ffi.pass_ import EstimateMemory
+
+    config = {}
+    if memory_schedule is not None:
+        config = {"raf.memory_schedule": True, "raf.memory_schedule.policy": memory_schedule}
+    mod = _optimize(model, device, args, config)
     trace = [(name, mem.value) for name, mem in EstimateMemory(mod, Device(device), include_param)]
     return trace
 
 
-def get_peak_memory(model, device, args, include_param=True):
+def get_peak_memory(model, device, args, include_param=True, memory_schedule=None):
     """A utility function to estimate the peak memory consumption."""
-    trace = trace_memory(model, device, args, include_param)
+    trace = trace_memory(model, device, args, include_param, memory_schedule)
     return max(trace, key=lambda x: x[1])[1]
 
 
+def roofline_report(model, device, args, peak_tflops, peak_gbps):
+    """A utility function to report the roofline position of each kernel of the compiled model.
+    Each entry includes the kernel name, the estimated GFLOPs and bytes moved, the measured
+    latency in microseconds, the achieved TFLOP/s and GB/s, the arithmetic intensity, whether
+    the kernel is "compute" or "memory" bound relative to the given device peaks, and the ratio
+    of the achieved throughput to the attainable one."""
+    mod = _optimize(model, device, args)
+    return _roofline_report(mod, device, peak_tflops, peak_gbps)
+
+
+def _roofline_report(mod, device, peak_tflops, peak_gbps):
+    """Report the roofline position of each kernel of the module after ManifestAlloc."""
+    # pylint: disable=import-outside-toplevel
+    import tvm
+    from raf._ffi.pass_ import RooflineReport
+
+    report = []
+    for entry in RooflineReport(mod, Device(device), peak_tflops, peak_gbps):
+        report.append(
+            {
+                key: val.value if isinstance(val, tvm.tir.FloatImm) else str(val)
+                for key, val in entry.items()
+            }
+        )
+    return report
+
+
+def _estimate_step(mod, device, include_param):
+    """Estimate the peak memory in MBs, the GFLOPs and the step time in ms of the module after
+    ManifestAlloc. The step time is the sum of the kernel latencies from the op profiler."""
+    # pylint: disable=import-outside-toplevel
+    from raf._ffi.pass_ import EstimateMemory
+
+    trace = EstimateMemory(mod, Device(device), include_param)
+    peak_memory = max(mem.value for _, mem in trace)
+    # The device peaks only classify the bound of each kernel, which is not used here.
+    report = _roofline_report(mod, device, 1.0, 1.0)
+    gflops = sum(max(entry["gflops"], 0.0) for entry in report)
+    step_time = sum(entry["latency_us"] for entry in report) / 1e3
+    return peak_memory, gflops, step_time
+
+
+def plan_batch_size(
+    get_model_and_args,
+    device,
+    batch_sizes=None,
+    max_batch_size=None,
+    memory_budget=None,
+    include_param=True,
+):
+    """A utility function to plan the batch size of the model before launching it. Each candidate
+    batch size is compiled through ManifestAlloc, and its peak memory is estimated along with the
+    pool rounding of each allocation. When a memory budget is given, the candidates are compiled
+    again with Rematerialization under the budget.
+
+    Parameters
+    ----------
+    get_model_and_args: Callable[[int], Tuple[raf.Model, List[raf.ndarray]]]
+        The function to build the model (e.g., with the AMP and the optimizer applied) and its
+        inputs of the given batch size.
+
+    device: str
+        The target device.
+
+    batch_sizes: Optional[List[int]]
+        The candidate batch sizes to evaluate.
+
+    max_batch_size: Optional[int]
+        If batch_sizes is not given, binary-search the largest batch size up to this one that
+        fits in the memory budget, and evaluate the batch sizes visited by the search.
+
+    memory_budget: Optional[float]
+        The memory budget in MBs, which is required by the binary search.
+
+    include_param: bool
+        Whether to count the parameters in the peak memory.
+
+    Returns
+    -------
+    ret: List[Dict[str, Any]]
+        The plan of each evaluated batch size in the ascending order. Each entry includes the
+        batch size, the estimated "peak_memory_mb", "gflops" and "step_time_ms" without
+        rematerialization, the same estimations with the "remat_" prefix if the memory budget is
+        given, whether the batch "fits" in the memory budget with or without rematerialization,
+        and the estimated "samples_per_sec" of the configuration that fits (None if neither).
+    """
+    if batch_sizes is None:
+        if max_batch_size is None or memory_budget is None:
+            raise ValueError("Either batch_sizes or max_batch_size with memory_budget is required")
+        if max_batch_size < 1:
+            raise ValueError("Invalid max batch size: %d" % max_batch_size)
+
+    plans = {}
+
+    def evaluate(batch_size):
+        if batch_size in plans:
+            return plans[batch_size]
+        model, args = get_model_and_args(batch_size)
+        mod = _optimize(model, device, args)
+        peak_memory, gflops, step_time = _estimate_step(mod, device, include_param)
+        plan = {
+            "batch_size": batch_size,
+            "peak_memory_mb": peak_memory,
+            "gflops": gflops,
+            "step_time_ms": step_time,
+        }
+        step_times = []
+        if memory_budget is None or peak_memory <= memory_budget:
+            step_times.append(step_time)
+        if memory_budget is not None:
+            config = {"raf.memory_budget": int(memory_budget * 1048576)}
+            mod = _optimize(model, device, args, config)
+            peak_memory, gflops, step_time = _estimate_step(mod, device, include_param)
+            plan["remat_peak_memory_mb"] = peak_memory
+            plan["remat_gflops"] = gflops
+            plan["remat_step_time_ms"] = step_time
+            if peak_memory <= memory_budget:
+                step_times.append(step_time)
+        plan["fits"] = bool(step_times)
+        plan["samples_per_sec"] = None
+        if step_times and min(step_times) > 0:
+            plan["samples_per_sec"] = batch_size * 1e3 / min(step_times)
+        plans[batch_size] = plan
+        return plan
+
+    if batch_sizes is not None:
+        for batch_size in batch_sizes:
+            evaluate(batch_size)
+    else:
+        # The peak memory grows with the batch size, so the largest fitting one is binary-searched.
+        low, high = 1, max_batch_size
+        while low <= high:
+            mid = (low + high) // 2
+            if evaluate(mid)["fits"]:
+                low = mid + 1
+            else:
+                high = mid - 1
+    return [plans[batch_size] for batch_size in sorted(plans)]
+
+
 # pylint: enable=protected-access
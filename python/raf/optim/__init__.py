@@ -2,7 +2,8 @@
 # SPDX-License-Identifier: Apache-2.0
 
 """Optimizers, e.g., SGD."""
-from . import sgd, lans
+from . import sgd, lans, fused, offload
 from .sgd import SGD
 from .lans import LANS
+from .fused import FusedSGD, AdamW, LAMB, clip_grad_norm
 from .optim import inline
@@ -12,11 +12,16 @@ The methodologies includes:
                  optimizer can have a partitioned optimizer status. Note that optimizers must
                  consider gradient partitioning if applied; otherwise the result will be incorrect.
    2.2 (ZeRO-2): Use reduce instead of all-reduce in (1) to obtain only a partition of gradients.
+   2.3 (ZeRO-3): Partition the parameters as well, and all-gather each of them right before its
+                 first use in the forward and the backward. The all-gathers are prefetched one
+                 layer ahead to be overlapped with the computation.
 """
 from raf.ir import RAFSequential
 from .optim import inline
+from .utils import split_ndarray_with_padding
 from .. import distributed as dist
-from .._ffi.pass_ import PartitionGradient, InferType
+from .._core.ndarray import ndarray
+from .._ffi.pass_ import PartitionGradient, PartitionParameter, InferType
 from ..model import Model, trace
 from ..model.trace import _get_func_inputs
 
@@ -37,6 +42,20 @@ def with_data_parallel(model):
             # pylint: disable=attribute-defined-outside-init, missing-function-docstring
             self.model = model
 
+            # ZeRO-3: Keep only a partition of each training weight. The mapping is from the
+            # handle of a model parameter to the attribute name of its partition.
+            self.zero3_params = {}
+            dctx = dist.get_context()
+            if dctx.zero_opt_level > 2:
+                for name, param in self.model.state().items():
+                    if param.requires_grad and "float" in param.dtype:
+                        param_nd = param.to(device="cpu")
+                        part = split_ndarray_with_padding(param_nd, dctx.size)[dctx.rank]
+                        attr_name = f"{name}.zero3_w"
+                        part = ndarray(part, device=param.device, name=attr_name, dtype=param.dtype)
+                        setattr(self, attr_name, part)
+                        self.zero3_params[param._ndarray__handle] = attr_name
+
         @trace
         def forward(self, *args, **kwargs):
             # pylint: disable=protected-access, missing-function-docstring
@@ -52,12 +71,71 @@ def with_data_parallel(model):
 
             record = self.model._internal(*args, **kwargs)
             mod = record.mod
+            inputs = _get_func_inputs(record, args, kwargs)
+
+            # ZeRO-3: Feed the parameter partitions instead of the complete parameters.
+            if self.zero3_params:
+                indices = []
+                for i, inp in enumerate(inputs):
+                    if inp in self.zero3_params:
+                        indices.append(i)
+                        inputs[i] = getattr(self, self.zero3_params[inp])._ndarray__handle
+                passes.append(PartitionParameter(dctx.size, indices))
+
             seq = RAFSequential(passes)
             mod = seq(mod)
-            inputs = _get_func_inputs(record, args, kwargs)
             out = inline(mod["main"], inputs)
             y = out[0]
             dxs = out[1]
             return y, dxs
 
     return DataParallelWrapper(model)
+
+
+def with_sharded_inference(model):
+    """Serve a model larger than one device by partitioning its parameters across the ranks in the
+    dist context. The forward all-gathers the parameters layer by layer, where the all-gather of
+    the next layer is prefetched to overlap with the computation of the current layer (see
+    raf.dp_schedule.param_prefetch_depth), so only two gathered parameters are alive at a time.
+    Since the all-gathers run on the communication stream, enable_data_parallel of the dist context
+    should be set before compiling the model with the VM.
+    """
+
+    class ShardedInferenceWrapper(Model):
+        """Sharded inference model
+
+        Parameters
+        ----------
+        model: Model
+            The model whose forward is to be evaluated.
+        """
+
+        def build(self, model):
+            # pylint: disable=attribute-defined-outside-init, missing-function-docstring
+            self.model = model
+            self.shard_params = {}
+            dctx = dist.get_context()
+            for name, param in self.model.state().items():
+                if "float" in param.dtype:
+                    param_nd = param.to(device="cpu")
+                    part = split_ndarray_with_padding(param_nd, dctx.size)[dctx.rank]
+                    attr_name = f"{name}.shard"
+                    part = ndarray(part, device=param.device, name=attr_name, dtype=param.dtype)
+                    setattr(self, attr_name, part)
+                    self.shard_params[param._ndarray__handle] = attr_name
+
+        @trace
+        def forward(self, *args, **kwargs):
+            # pylint: disable=protected-access, missing-function-docstring
+            dctx = dist.get_context()
+            record = self.model._internal(*args, **kwargs)
+            inputs = _get_func_inputs(record, args, kwargs)
+            indices = []
+            for i, inp in enumerate(inputs):
+                if inp in self.shard_params:
+                    indices.append(i)
+                    inputs[i] = getattr(self, self.shard_params[inp])._ndarray__handle
+            mod = RAFSequential([InferType(), PartitionParameter(dctx.size, indices)])(record.mod)
+            return inline(mod["main"], inputs)
+
+    return ShardedInferenceWrapper(model)
@@ -0,0 +1,206 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=too-many-arguments, too-few-public-methods, protected-access
+"""Optimizers with fused multi-tensor CUDA kernels, which update all parameters of the same dtype
+in a handful of launches."""
+import numpy as np
+
+from raf._core.ndarray import array, ndarray
+from raf._op import imp
+
+
+class _MultiTensorOptimizer:
+    """The base of the fused optimizers. The float16 parameters are updated through float32
+    master weights, and the step counter stays on the device."""
+
+    def __init__(self, params, num_states, name):
+        self.params = []
+        self._step = None
+        for i, x in enumerate(params):
+            assert isinstance(x, ndarray), "Only `raf.ndarray' can be optimized!"
+            assert "float" in x.dtype, "Non-float parameter is not learnable"
+            master = None
+            if x.dtype == "float16":
+                master = ndarray(
+                    x.to(dtype="float32"), device=x.device, name=f"{name}.{i}.w", dtype="float32"
+                )
+            weight = master if master is not None else x
+            states = [
+                ndarray(
+                    np.zeros(x.shape, dtype=weight.dtype), device=x.device, name=f"{name}.{i}.{j}"
+                )
+                for j in range(num_states)
+            ]
+            self.params.append((x, master, states))
+            if self._step is None:
+                self._step = array(0, dtype="float32", device=x.device, name=f"{name}.step")
+                self._one = array(1, dtype="float32", device=x.device)
+
+    def _groups(self):
+        """Yield the tensor lists of the parameters of the same dtype that have gradients."""
+        groups = {}
+        for x, master, states in self.params:
+            if x.grad is None:
+                continue
+            groups.setdefault(x.dtype, []).append((x, master, states))
+        for params in groups.values():
+            master_weights = params[0][1] is not None
+            tensor_list = [x.grad for x, _, _ in params]
+            tensor_list += [master if master is not None else x for x, master, _ in params]
+            for i in range(len(params[0][2])):
+                tensor_list += [states[i] for _, _, states in params]
+            if master_weights:
+                tensor_list += [x for x, _, _ in params]
+            yield tensor_list, master_weights
+
+
+def clip_grad_norm(params, max_norm, eps=1e-6):
+    """Scale the gradients of the parameters in place, so that their global L2 norm is at most
+    max_norm. The gradients of each dtype take one multi-tensor norm and one multi-tensor scaling,
+    and the norm stays on the device, so no host synchronization is required.
+
+    Parameters
+    ----------
+    params: dict_values
+        iterable of parameters whose gradients are clipped
+
+    max_norm: float
+        the maximal global L2 norm of the gradients
+
+    eps: float (optional)
+        term added to the norm to improve numerical stability
+
+    Returns
+    -------
+    norm: Optional[raf.ndarray]
+        the float32 global L2 norm of the gradients before clipping, or None without gradients
+    """
+    groups = {}
+    for x in params:
+        if x.grad is not None:
+            groups.setdefault(x.grad.dtype, []).append(x.grad)
+    if not groups:
+        return None
+    norms = [imp.multi_tensor_l2norm(grads)[1] for grads in groups.values()]
+    norm = norms[0]
+    if len(norms) > 1:
+        sq_sum = imp.multiply(norm, norm)
+        for other in norms[1:]:
+            sq_sum = imp.add(sq_sum, imp.multiply(other, other))
+        norm = imp.sqrt(sq_sum)
+    for grads in groups.values():
+        imp.multi_tensor_clip(grads, norm, max_norm, eps)
+    return norm
+
+
+class FusedSGD(_MultiTensorOptimizer):
+    """Optimizer : stochastic gradient descent with momentum
+
+    Parameters
+    ----------
+    params: dict_values
+        iterable of parameters to optimize
+
+    learning_rate: float
+        learning rate
+
+    momentum: float (optional)
+        momentum factor
+    """
+
+    def __init__(self, params, learning_rate, momentum=0):
+        if learning_rate < 0.0:
+            raise ValueError("Invalid learning rate: {}".format(learning_rate))
+        if momentum < 0.0:
+            raise ValueError("Invalid momentum value: {}".format(momentum))
+        super().__init__(params, 1, "fused_sgd")
+        self._lr = learning_rate
+        self._momentum = momentum
+
+    def step(self, skip=None):
+        """Update the parameters with gradients.
+
+        Parameters
+        ----------
+        skip: Optional[raf.ndarray]
+            the float32 scalar on the device, whose non-zero value skips the update, e.g., the
+            overflow flag of the dynamic loss scaler
+        """
+        for tensor_list, master_weights in self._groups():
+            imp.multi_sgd(tensor_list, self._lr, self._momentum, master_weights, skip)
+
+
+class AdamW(_MultiTensorOptimizer):
+    """Optimizer : AdamW
+    # References
+    - Decoupled Weight Decay Regularization. https://arxiv.org/abs/1711.05101
+
+    Parameters
+    ----------
+    lr: Optional[Float]
+        Learning rate. Default: 1e-3
+
+    betas: Optional[Tuple[Float, Float]]
+        Coefficients used for computing running averages of gradient and its square.
+        Default: (0.9, 0.999)
+
+    eps: Optional[Float]
+        Term added to the denominator to improve numerical stability. Default: 1e-6
+
+    weight_decay: Optional[Float]
+        Decoupled weight decay. Default: 0.01
+    """
+
+    _op = staticmethod(imp.adamw)
+
+    def __init__(
+        self, params, lr=1e-3, betas=(0.9, 0.999), eps=1e-6, weight_decay=0.01, bias_correction=True
+    ):
+        super().__init__(params, 2, type(self).__name__.lower())
+        self.lr = lr
+        self.beta1 = betas[0]
+        self.beta2 = betas[1]
+        self.eps = eps
+        self.weight_decay = weight_decay
+        self.bias_correction = bias_correction
+
+    def step(self, skip=None):
+        """Update the parameters with gradients.
+
+        Parameters
+        ----------
+        skip: Optional[raf.ndarray]
+            the float32 scalar on the device, whose non-zero value skips the update and the step
+            counter, e.g., the overflow flag of the dynamic loss scaler
+        """
+        if skip is None:
+            imp.add(self._step, self._one, out=self._step)
+        else:
+            imp.add(self._step, imp.subtract(self._one, skip), out=self._step)
+        for tensor_list, master_weights in self._groups():
+            self._op(
+                tensor_list,
+                self._step,
+                self.lr,
+                self.beta1,
+                self.beta2,
+                self.eps,
+                self.weight_decay,
+                self.bias_correction,
+                master_weights,
+                skip,
+            )
+
+
+class LAMB(AdamW):
+    """Optimizer : LAMB
+    # References
+    - Large Batch Optimization for Deep Learning: Training BERT in 76 minutes.
+      https://arxiv.org/abs/1904.00962
+
+    The parameters are the same as AdamW. The AdamW update of each tensor is scaled by the trust
+    ratio, which is the ratio of the L2 norm of the weight to the L2 norm of the update.
+    """
+
+    _op = staticmethod(imp.lamb)
@@ -13,6 +13,7 @@ from raf._op import sym as _op
 from raf._op import imp
 from .. import distributed as dist
 from .data_parallel import with_data_parallel
+from .offload import StateOffloader
 from ..distributed.op import allgather
 from .optim import with_autodiff
 from .utils import has_grad, split_ndarray_with_padding
@@ -39,6 +40,10 @@ class LANS:
 
     weight_decay: Optional[Float]
         Weight decay (L2 penalty). Default: 0.01
+
+    offload_dir: Optional[str]
+        The directory on the NVMe/SSD storage to offload the moments to, which are streamed to
+        the device a parameter at a time during the step (see raf.optim.offload). Default: None
     """
 
     def __init__(
@@ -52,6 +57,7 @@ class LANS:
         grad_averaging=True,
         mode=True,
         normalize_grad=True,
+        offload_dir=None,
     ):
         self.lr = lr
         self.beta1 = betas[0]
@@ -63,16 +69,35 @@ class LANS:
         self.mode = mode
         self.normalize_grad = normalize_grad
         self.params = []
-        self._step = 1
+        self._step = None
+        self._offloader = None
+        params = list(params)
+        if offload_dir is not None:
+            specs = [[(x.shape, x.dtype), (x.shape, x.dtype)] for x in params]
+            self._offloader = StateOffloader(offload_dir, specs)
         for i, x in enumerate(params):
             assert isinstance(x, ndarray), "Only `raf.ndarray' can be optimized!"
-            npa = np.zeros(x.shape, dtype=x.dtype)
-            m_i = ndarray(npa, device=x.device, name=f"lans.{i}.m")
-            v_i = ndarray(npa, device=x.device, name=f"lans.{i}.v")
-            self.params.append((x, m_i, v_i))
+            if self._offloader is not None:
+                self.params.append((x, None, None))
+            else:
+                npa = np.zeros(x.shape, dtype=x.dtype)
+                m_i = ndarray(npa, device=x.device, name=f"lans.{i}.m")
+                v_i = ndarray(npa, device=x.device, name=f"lans.{i}.v")
+                self.params.append((x, m_i, v_i))
+            if self._step is None:
+                # The step counter stays on the device, which is read by the kernel.
+                self._step = array(0, dtype="float32", device=x.device, name="lans.step")
+                self._one = array(1, dtype="float32", device=x.device)
+
+    def step(self, skip=None):
+        """Update the parameters with gradients.
 
-    def step(self):
-        """Update the parameters with gradients."""
+        Parameters
+        ----------
+        skip: Optional[raf.ndarray]
+            the float32 scalar on the device, whose non-zero value skips the update and the step
+            counter, e.g., the overflow flag of the dynamic loss scaler
+        """
         tensor_list = []
         g_list = []
         x_list = []
@@ -85,11 +110,17 @@ class LANS:
             x_list.append(x)
             m_list.append(m)
             v_list.append(v)
-        step = array(self._step, dtype="float32", device="cuda", name="step")
+        if skip is None:
+            imp.add(self._step, self._one, out=self._step)
+        else:
+            imp.add(self._step, imp.subtract(self._one, skip), out=self._step)
+        if self._offloader is not None:
+            self._offloaded_step(skip)
+            return
         tensor_list = g_list + x_list + m_list + v_list
         imp.lans(
             tensor_list,
-            step,
+            self._step,
             self.lr,
             self.beta1,
             self.beta2,
@@ -99,8 +130,36 @@ class LANS:
             self.grad_averaging,
             self.mode,
             self.normalize_grad,
+            skip,
         )
-        self._step += 1
+
+    def _offloaded_step(self, skip):
+        """Update the parameters one by one with their moments streamed from the storage. The
+        trust ratio of LANS is computed per tensor, so it is the same as updating them together."""
+        indices = [i for i, (x, _, _) in enumerate(self.params) if x.grad is not None]
+        if not indices:
+            return
+
+        def fupdate(index, states):
+            x = self.params[index][0]
+            m, v = states
+            imp.lans(
+                [x.grad, x, m, v],
+                self._step,
+                self.lr,
+                self.beta1,
+                self.beta2,
+                self.eps,
+                self.bias_correction,
+                self.weight_decay,
+                self.grad_averaging,
+                self.mode,
+                self.normalize_grad,
+                skip,
+            )
+            return [m, v]
+
+        self._offloader.update(indices, self.params[indices[0]][0].device, fupdate)
 
 
 def with_lans(
@@ -233,6 +292,12 @@ def with_lans(
                 record = self.ad_model._internal(dy, *args, **kwargs)
                 inputs = _get_func_inputs(record, [dy, *args], kwargs)
                 inputs = inputs[1:]  # remove dy
+                # Skip the ZeRO-3 parameter partitions, which have no gradients.
+                zero3_params = self.ad_model.zero3_params
+                zero3_parts = [
+                    getattr(self.ad_model, n)._ndarray__handle for n in zero3_params.values()
+                ]
+                inputs = [x for x in inputs if x not in zero3_parts]
                 # update step
                 next_step = _op.add(self.step, self.one, out=self.step)
                 trace_mutate_attr(self, "step", next_step)
@@ -287,7 +352,13 @@ def with_lans(
                             next_m = output_list[out_idx + 2 * ntensor]
                             next_v = output_list[out_idx + 3 * ntensor]
                             param_model = get_chained_attr(self.model, name.split(".")[:-1])
-                            if dctx.zero_opt_level > 0:
+                            if param in zero3_params:
+                                # ZeRO-3: Only update the parameter partition.
+                                part = getattr(self.ad_model, zero3_params[param])
+                                new_part = _op.add(new_w, self.zero, out=part)
+                                trace_mutate_attr(self.ad_model, zero3_params[param], new_part)
+                                next_w = None
+                            elif dctx.zero_opt_level > 0:
                                 new_weight = allgather(new_w, axis=0)
                                 # Slice to remove the zero-padding if needed.
                                 if w.shape[0] * dctx.size > p.shape[0]:
@@ -300,7 +371,8 @@ def with_lans(
                                 # So the new  weight is just the input weight
                                 next_w = new_w
 
-                            trace_mutate_attr(param_model, name.split(".")[-1], next_w)
+                            if next_w is not None:
+                                trace_mutate_attr(param_model, name.split(".")[-1], next_w)
                             trace_mutate_attr(self, f"{name}.m", next_m)
                             trace_mutate_attr(self, f"{name}.v", next_v)
                             out_idx += 1
@@ -0,0 +1,191 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+"""Offloading the optimizer states to the NVMe/SSD storage, which is the tier below the host
+memory. The states live in a file opened with direct I/O, so the reads and the writes bypass the
+page cache and do not take the host memory. A step streams the states of a parameter at a time
+through two page-aligned staging buffers: the states of the next parameter are read while the
+current one is updated on the device, and the updated states are written back in the background.
+"""
+# pylint: disable=too-many-arguments, too-few-public-methods
+import mmap
+import os
+from concurrent.futures import ThreadPoolExecutor
+
+import numpy as np
+
+from raf._core.ndarray import array
+from .. import distributed as dist
+
+# The alignment of the offsets, the sizes and the buffers of direct I/O.
+_ALIGN = 4096
+
+
+def _align(nbytes):
+    return (nbytes + _ALIGN - 1) // _ALIGN * _ALIGN
+
+
+class _StagingBuffer:
+    """A page-aligned host buffer, which holds the states of a parameter."""
+
+    def __init__(self, nbytes):
+        self.nbytes = _align(max(nbytes, 1))
+        self.buffer = mmap.mmap(-1, self.nbytes)
+        # The pending write that reads the buffer, which must finish before it is refilled.
+        self.pending_write = None
+
+    def views(self, specs):
+        """Get the numpy views of the states of the given shapes and dtypes."""
+        views, offset = [], 0
+        for shape, dtype in specs:
+            count = int(np.prod(shape))
+            views.append(np.frombuffer(self.buffer, dtype=dtype, count=count, offset=offset))
+            views[-1] = views[-1].reshape(shape)
+            offset += _align(count * np.dtype(dtype).itemsize)
+        return views
+
+
+class NVMeStore:
+    """A file of the optimizer states on the NVMe/SSD storage.
+
+    Parameters
+    ----------
+    directory: str
+        The directory on the storage. Each process creates its own file in it.
+
+    num_workers: int
+        The number of threads that issue the reads and the writes, which are the queue depth of
+        the storage.
+    """
+
+    def __init__(self, directory, num_workers=4):
+        os.makedirs(directory, exist_ok=True)
+        dctx = dist.get_context()
+        self.path = os.path.join(directory, "raf_offload.rank%d.%d.bin" % (dctx.rank, os.getpid()))
+        flags = os.O_RDWR | os.O_CREAT | os.O_TRUNC
+        self.direct = hasattr(os, "O_DIRECT")
+        try:
+            self._fd = os.open(self.path, flags | (os.O_DIRECT if self.direct else 0), 0o600)
+        except OSError:
+            # Some file systems, e.g., tmpfs, do not support direct I/O.
+            self.direct = False
+            self._fd = os.open(self.path, flags, 0o600)
+        self._extents = {}
+        self._end = 0
+        self._pool = ThreadPoolExecutor(max_workers=num_workers)
+
+    def allocate(self, key, nbytes):
+        """Allocate a zero-filled extent of the key."""
+        self._extents[key] = (self._end, _align(nbytes))
+        self._end += _align(nbytes)
+        os.ftruncate(self._fd, self._end)
+
+    def _transfer(self, key, buffer, offset, write):
+        file_offset, nbytes = self._extents[key]
+        view = memoryview(buffer)[offset : offset + nbytes]
+        done = 0
+        while done < nbytes:
+            if write:
+                ret = os.pwritev(self._fd, [view[done:]], file_offset + done)
+            else:
+                ret = os.preadv(self._fd, [view[done:]], file_offset + done)
+            if ret <= 0:
+                raise IOError("Failed to %s %s" % ("write" if write else "read", self.path))
+            done += ret
+
+    def read(self, key, buffer, offset=0):
+        """Read the extent of the key into the buffer at the offset asynchronously."""
+        return self._pool.submit(self._transfer, key, buffer, offset, False)
+
+    def write(self, key, buffer, offset=0):
+        """Write the buffer at the offset to the extent of the key asynchronously."""
+        return self._pool.submit(self._transfer, key, buffer, offset, True)
+
+    def close(self):
+        """Wait for the pending transfers, and remove the file."""
+        if getattr(self, "_fd", None) is None:
+            return
+        self._pool.shutdown(wait=True)
+        os.close(self._fd)
+        os.remove(self.path)
+        self._fd = None
+
+    def __del__(self):
+        self.close()
+
+
+class StateOffloader:
+    """The optimizer states of the parameters offloaded to an NVMeStore.
+
+    Parameters
+    ----------
+    directory: str
+        The directory on the storage.
+
+    specs: List[List[Tuple[Tuple[int], str]]]
+        The (shape, dtype) of each state of each parameter. The states start from zeros.
+    """
+
+    def __init__(self, directory, specs, num_workers=4):
+        self.store = NVMeStore(directory, num_workers)
+        self.specs = specs
+        capacity = 0
+        for i, states in enumerate(specs):
+            nbytes = 0
+            for shape, dtype in states:
+                nbytes += _align(int(np.prod(shape)) * np.dtype(dtype).itemsize)
+            self.store.allocate(i, nbytes)
+            capacity = max(capacity, nbytes)
+        # Double buffering: one buffer is read from the storage while the other is updated.
+        self._buffers = [_StagingBuffer(capacity), _StagingBuffer(capacity)]
+
+    def _prefetch(self, index, buffer):
+        if buffer.pending_write is not None:
+            buffer.pending_write.result()
+            buffer.pending_write = None
+        return self.store.read(index, buffer.buffer)
+
+    def update(self, indices, device, fupdate):
+        """Stream the states of the parameters through the device and update them.
+
+        Parameters
+        ----------
+        indices: List[int]
+            The indices of the parameters to update in order.
+
+        device: str
+            The device of the update.
+
+        fupdate: Callable[[int, List[raf.ndarray]], List[raf.ndarray]]
+            Update the parameter of the index with its states on the device, and return the
+            updated states.
+        """
+        if not indices:
+            return
+        pending_read = self._prefetch(indices[0], self._buffers[0])
+        for step, index in enumerate(indices):
+            buffer = self._buffers[step % 2]
+            pending_read.result()
+            views = buffer.views(self.specs[index])
+            states = [array(view, device=device, copy=False) for view in views]
+            if step + 1 < len(indices):
+                pending_read = self._prefetch(indices[step + 1], self._buffers[(step + 1) % 2])
+            states = fupdate(index, states)
+            for view, state in zip(views, states):
+                np.copyto(view, state.numpy())
+            buffer.pending_write = self.store.write(index, buffer.buffer)
+        # The step finishes after all states are written back.
+        for buffer in self._buffers:
+            if buffer.pending_write is not None:
+                buffer.pending_write.result()
+                buffer.pending_write = None
+
+    def read(self, index):
+        """Read the states of the parameter of the index to numpy arrays, e.g., for checkpoints."""
+        buffer = self._buffers[0]
+        self._prefetch(index, buffer).result()
+        return [view.copy() for view in buffer.views(self.specs[index])]
+
+    def close(self):
+        """Remove the file of the states."""
+        self.store.close()
@@ -2,18 +2,22 @@
 # SPDX-License-Identifier: Apache-2.0
 
 """Traced Optimizers"""
+import numpy as np
+
 from raf.frontend.model import _get_func_output_var
 from raf.ir import RAFSequential
 from .. import distributed as dist
-from .._core.ndarray import Symbol, get_symbol_handle
+from .._core.ndarray import Symbol, ndarray, get_symbol_handle
 from .._core.value import NoGradValue, Value
 from .._core.ir_ext import ExtendedVar
 from ..model.trace import _get_func_inputs
-from ..model import Model, trace
+from ..model import Model, trace, trace_mutate_attr
 from .._ffi.pass_ import AutoDiff, InlineBackward, Substitute, InferType, FoldConstant
-from .._ffi.pass_ import DeadCodeElimination, AutoDataParallel
+from .._ffi.pass_ import DeadCodeElimination, AutoDataParallel, FuseBatchNormReLU
 from .._ffi.binding import BindSymbol
-from .._lib import tvm
+from .._lib import tvm, PassContext
+from .._op.sym import add, cast
+from .utils import has_grad
 
 
 def calc_dy(dy, record):
@@ -54,8 +58,19 @@ def inline(func, inputs):
     return Symbol.from_expr(evaluate(func.body))
 
 
-def with_autodiff(model):
-    """create a new model by apply autodiff to the input"""
+def with_autodiff(model, data_parallel=True):
+    """create a new model by apply autodiff to the input
+
+    Parameters
+    ----------
+    model: Model
+        The forward model.
+
+    data_parallel: bool
+        Whether to all-reduce the gradients when data parallel is enabled in the dist context.
+        The callers that aggregate the gradients by themselves (e.g., gradient accumulation)
+        disable it to avoid communicating every gradient.
+    """
 
     class AutoDiffWrapper(Model):
         """AutoDiff model
@@ -75,8 +90,11 @@ def with_autodiff(model):
             record = self.model._internal(*args, **kwargs)
             dy = calc_dy(dy, record)
             mod = record.mod
-            passes = [InferType(), AutoDiff(record.requires_grads)]
-            if dist.get_context().enable_data_parallel:
+            passes = [InferType()]
+            if PassContext.current().config.get("raf.optimize.fuse_batch_norm_relu", False):
+                passes += [FuseBatchNormReLU(), InferType()]
+            passes += [AutoDiff(record.requires_grads)]
+            if data_parallel and dist.get_context().enable_data_parallel:
                 # TODO: Refactor AutoDataParallel to let it work on the IR after InlineBackward.
                 passes += [AutoDataParallel()]
             passes += [InferType(), FoldConstant(), DeadCodeElimination(), InlineBackward()]
@@ -90,3 +108,70 @@ def with_autodiff(model):
             return y, dxs
 
     return AutoDiffWrapper(model)
+
+
+def with_grad_accumulation(ad_model, params):
+    """Create a model that runs a micro-batch of gradient accumulation. It computes the gradients
+    with the given autodiff model and adds them to persistent gradient buffers in place, without
+    any communication or optimizer update, which are left to the last micro-batch of a step.
+
+    Parameters
+    ----------
+    ad_model: Model
+        The autodiff model without data parallel, which outputs the forward result and the
+        gradients.
+
+    params: Dict[str, ndarray]
+        The training weights to accumulate the gradients for, keyed by their names.
+
+    Returns
+    -------
+    ret: Model
+        The accumulation model. Its buffers are attributes named "{param_name}.grad_acc", and its
+        "buffers" attribute maps the handles of the weights to the buffer names and their dtypes.
+    """
+
+    class GradAccumulator(Model):
+        """Gradient accumulation model
+
+        Parameters
+        ----------
+        ad_model: Model
+            The autodiff model.
+
+        params: Dict[str, ndarray]
+            The training weights.
+        """
+
+        def build(self, ad_model, params):
+            # pylint: disable=attribute-defined-outside-init, missing-function-docstring
+            self.ad_model = ad_model
+            self.buffers = {}
+            for name, param in params.items():
+                # Accumulate in float32 for accuracy.
+                attr_name = f"{name}.grad_acc"
+                buf = ndarray(
+                    np.zeros(param.shape, dtype="float32"), device=param.device, name=attr_name
+                )
+                setattr(self, attr_name, buf)
+                self.buffers[param._ndarray__handle] = (attr_name, param.dtype)
+
+        @trace
+        def forward(self, dy, *args, **kwargs):
+            # pylint: disable=protected-access, missing-function-docstring
+            y, dxs = self.ad_model(dy, *args, **kwargs)
+            record = self.ad_model._internal(dy, *args, **kwargs)
+            inputs = _get_func_inputs(record, [dy, *args], kwargs)
+            inputs = inputs[1:]  # remove dy
+            for i, param in enumerate(inputs):
+                dxi = dxs[i] if len(inputs) > 1 else dxs
+                if param in self.buffers and has_grad(dxi):
+                    attr_name, dtype = self.buffers[param]
+                    if dtype != "float32":
+                        dxi = cast(dxi, "float32")
+                    buf = getattr(self, attr_name)
+                    new_buf = add(buf, dxi, out=buf)
+                    trace_mutate_attr(self, attr_name, new_buf)
+            return y
+
+    return GradAccumulator(ad_model, params)
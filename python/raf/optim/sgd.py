@@ -10,11 +10,12 @@ from raf._core.ndarray import ndarray, array
 from raf.model import trace, Model, trace_mutate_attr
 from raf.model.trace import _get_func_inputs
 from raf._op import imp
-from raf._op.sym import multiply, add, subtract, strided_slice, cast
+from raf._op.sym import multiply, add, subtract, strided_slice, cast, zeros_like
 from .. import distributed as dist
 from .data_parallel import with_data_parallel
-from ..distributed.op import allgather
-from .optim import with_autodiff
+from ..distributed.op import allgather, allreduce
+from .offload import StateOffloader
+from .optim import with_autodiff, with_grad_accumulation
 from .utils import has_grad, split_ndarray_with_padding
 
 
@@ -32,9 +33,13 @@ class SGD:
 
     momentum: float (optional)
         momentum factor
+
+    offload_dir: Optional[str]
+        the directory on the NVMe/SSD storage to offload the momentum to, which is streamed to
+        the device a parameter at a time during the step (see raf.optim.offload)
     """
 
-    def __init__(self, params, learning_rate, momentum=0):
+    def __init__(self, params, learning_rate, momentum=0, offload_dir=None):
         if learning_rate < 0.0:
             raise ValueError("Invalid learning rate: {}".format(learning_rate))
         if momentum < 0.0:
@@ -42,23 +47,125 @@ class SGD:
         self.params = []
         self._lr = learning_rate
         self._momentum = momentum
-        for i, x in enumerate(params):
+        self._offloader = None
+        params = list(params)
+        for x in params:
             assert isinstance(x, ndarray), "Only `raf.ndarray' can be optimized!"
+        if offload_dir is not None:
+            specs = [[(x.shape, x.dtype)] for x in params]
+            self._offloader = StateOffloader(offload_dir, specs)
+            self.params = [(x, None) for x in params]
+            return
+        for i, x in enumerate(params):
             npa = np.zeros(x.shape, dtype=x.dtype)
             v_i = ndarray(npa, device=x.device, name=f"sgd.{i}.v")
             self.params.append((x, v_i))
 
-    def step(self):
-        """Update the parameters with gradients."""
+    def step(self, skip=None):
+        """Update the parameters with gradients.
+
+        Parameters
+        ----------
+        skip: Optional[raf.ndarray]
+            the float32 scalar on the device, whose non-zero value skips the update, e.g., the
+            overflow flag of the dynamic loss scaler
+        """
+        if self._offloader is not None:
+            indices = [i for i, (x, _) in enumerate(self.params) if x.grad is not None]
+            if not indices:
+                return
+
+            def fupdate(index, states):
+                x0 = self.params[index][0]
+                v1, x1 = imp.sgd(x0, x0.grad, states[0], self._lr, self._momentum, skip)
+                x0.update(x1)
+                return [v1]
+
+            self._offloader.update(indices, self.params[indices[0]][0].device, fupdate)
+            return
         for x0, v0 in self.params:
             if x0.grad is None:
                 continue
-            v1, x1 = imp.sgd(x0, x0.grad, v0, self._lr, self._momentum)
+            v1, x1 = imp.sgd(x0, x0.grad, v0, self._lr, self._momentum, skip)
             x0.update(x1)
             v0.update(v1)
 
 
-def with_sgd(learning_rate=0.1, momentum=0.01):
+def with_param_averaging(params, dtype):
+    """Create a model that averages the weights of SGD across the ranks for local SGD. The float32
+    SGD weights, and the momentum buffers if local_sgd_average_momentum is set in the dist context,
+    are all-reduced by a single fused allreduce and updated in place. The model parameters are then
+    updated from the SGD weights if they are different tensors.
+
+    Parameters
+    ----------
+    params: List[Tuple[str, ndarray, ndarray, ndarray]]
+        The name, the model parameter, the SGD weight and the SGD variant of each training weight.
+
+    dtype: str
+        The dtype of the model parameters.
+
+    Returns
+    -------
+    ret: Model
+        The averaging model, which takes no inputs. It shares the tensors with the SGD wrapper.
+    """
+
+    class ParamAverager(Model):
+        """Parameter averaging model
+
+        Parameters
+        ----------
+        params: List[Tuple[str, ndarray, ndarray, ndarray]]
+            The training weights and their SGD states.
+
+        dtype: str
+            The dtype of the model parameters.
+        """
+
+        def build(self, params, dtype):
+            # pylint: disable=attribute-defined-outside-init, missing-function-docstring
+            self.dtype = dtype
+            self.names = []
+            for name, param, sgd_w, sgd_v in params:
+                if param is not sgd_w:
+                    setattr(self, f"{name}.param", param)
+                setattr(self, f"{name}.sgd_w", sgd_w)
+                setattr(self, f"{name}.sgd_v", sgd_v)
+                self.names.append((name, param is not sgd_w))
+            self.zero = array(0, dtype="float32")
+            self.inv_size = array(1.0 / dist.get_context().size, dtype="float32")
+
+        @trace
+        def forward(self):
+            # pylint: disable=missing-function-docstring
+            attr_names = []
+            for name, _ in self.names:
+                attr_names.append(f"{name}.sgd_w")
+                if dist.get_context().local_sgd_average_momentum:
+                    attr_names.append(f"{name}.sgd_v")
+            sums = allreduce([getattr(self, attr_name) for attr_name in attr_names])
+            new_states = {}
+            for i, attr_name in enumerate(attr_names):
+                avg = multiply(sums[i] if len(attr_names) > 1 else sums, self.inv_size)
+                new_state = add(avg, self.zero, out=getattr(self, attr_name))
+                trace_mutate_attr(self, attr_name, new_state)
+                new_states[attr_name] = new_state
+            for name, has_sgd_w in self.names:
+                if has_sgd_w:
+                    # Update the model parameter from the averaged SGD weight.
+                    new_sgd_w = new_states[f"{name}.sgd_w"]
+                    if self.dtype != "float32":
+                        new_sgd_w = cast(new_sgd_w, self.dtype)
+                    param = getattr(self, f"{name}.param")
+                    new_param = add(new_sgd_w, zeros_like(param), out=param)
+                    trace_mutate_attr(self, f"{name}.param", new_param)
+            return sums
+
+    return ParamAverager(params, dtype)
+
+
+def with_sgd(learning_rate=0.1, momentum=0.01, accum_steps=1):
     """Optimizer : stochastic gradient descent
 
     Parameters:
@@ -69,6 +176,18 @@ def with_sgd(learning_rate=0.1, momentum=0.01):
     momentum: float (optional)
         momentum factor
 
+    accum_steps: int (optional)
+        The number of micro-batches to accumulate the gradients for in a step. When it is larger
+        than 1, the gradients of the first accum_steps - 1 micro-batches are accumulated in place
+        by the "accumulator" model of the wrapper, which has no communication and optimizer update.
+        The wrapper itself runs the last micro-batch: it all-reduces the accumulated gradients
+        (summed over the micro-batches) once, updates the weights, and clears the buffers. Use
+        get_step_model to pick the model of a micro-batch. ZeRO is not supported with it yet.
+
+    When local SGD is enabled by local_sgd_period of the dist context along with data parallel,
+    the wrapper applies the local gradients without allreduce, and its "averager" model averages
+    the weights across the ranks. Use get_sync_model to pick the averager after a step.
+
     Returns
     ret : function
         The wrapper which wraps a model with sgd
@@ -102,7 +221,25 @@ def with_sgd(learning_rate=0.1, momentum=0.01):
             # pylint: disable=missing-function-docstring
             def build(self, model):
                 self.model = model
-                self.ad_model = with_data_parallel(with_autodiff(model))
+                self.accum_steps = accum_steps
+                dctx = dist.get_context()
+                self.local_sgd_period = 1
+                if dctx.enable_data_parallel and dctx.local_sgd_period > 1:
+                    # Local SGD: the gradients stay local, and the averager synchronizes the
+                    # weights every local_sgd_period steps.
+                    assert (
+                        accum_steps == 1 and dctx.zero_opt_level == 0
+                    ), "Gradient accumulation and ZeRO are not supported with local SGD"
+                    self.local_sgd_period = dctx.local_sgd_period
+                    self.ad_model = with_autodiff(model, data_parallel=False)
+                elif accum_steps > 1:
+                    # The gradients are all-reduced once after being accumulated.
+                    assert (
+                        dist.get_context().zero_opt_level == 0
+                    ), "ZeRO is not supported with gradient accumulation"
+                    self.ad_model = with_autodiff(model, data_parallel=False)
+                else:
+                    self.ad_model = with_data_parallel(with_autodiff(model))
                 self.learning_rate = array(learning_rate, dtype="float32")
                 self.momentum = array(momentum, dtype="float32")
 
@@ -115,7 +252,6 @@ def with_sgd(learning_rate=0.1, momentum=0.01):
                 # additional buffers in SGD status.
                 self.has_sgd_w = False
 
-                dctx = dist.get_context()
                 self.params = {}
                 for name, param in self.model.state().items():
                     # For each tensor "param" that requires gradient (i.e., training weights),
@@ -177,12 +313,40 @@ def with_sgd(learning_rate=0.1, momentum=0.01):
                     # TODO(issue 758): Remove this and in-place update parameters.
                     self.zero = array(0, dtype=self.dtype)
 
+                if accum_steps > 1:
+                    weights = {name: param for name, param, _, _ in self.params.values()}
+                    self.accumulator = with_grad_accumulation(self.ad_model, weights)
+                    self.acc_zero = array(0, dtype="float32")
+                    self.inv_size = array(1.0 / dctx.size, dtype="float32")
+
+                if self.local_sgd_period > 1:
+                    self.averager = with_param_averaging(list(self.params.values()), self.dtype)
+
+            def get_sync_model(self, step):
+                """Get the model to average the weights after the given step (counted from 0) of
+                local SGD, or None if the weights stay local after the step."""
+                if self.local_sgd_period > 1 and (step + 1) % self.local_sgd_period == 0:
+                    return self.averager
+                return None
+
+            def get_step_model(self, micro_step):
+                """Get the model to run the given micro-batch (counted from 0) of a step."""
+                if self.accum_steps > 1 and (micro_step + 1) % self.accum_steps != 0:
+                    return self.accumulator
+                return self
+
             @trace
             def forward(self, dy, *args, **kwargs):
                 y, dxs = self.ad_model(dy, *args, **kwargs)
                 record = self.ad_model._internal(dy, *args, **kwargs)
                 inputs = _get_func_inputs(record, [dy, *args], kwargs)
                 inputs = inputs[1:]  # remove dy
+                # Skip the ZeRO-3 parameter partitions, which have no gradients.
+                zero3_params = getattr(self.ad_model, "zero3_params", {})
+                zero3_parts = [
+                    getattr(self.ad_model, n)._ndarray__handle for n in zero3_params.values()
+                ]
+                inputs = [x for x in inputs if x not in zero3_parts]
                 dctx = dist.get_context()
                 for i, param in enumerate(inputs):
                     dxi = dxs[i] if len(inputs) > 1 else dxs
@@ -194,6 +358,17 @@ def with_sgd(learning_rate=0.1, momentum=0.01):
                         if self.dtype != "float32":
                             dxi = cast(dxi, "float32")
 
+                        # Add the gradients accumulated by the previous micro-batches, which
+                        # are all-reduced together, and clear the buffer for the next step.
+                        if self.accum_steps > 1:
+                            attr_name, _ = self.accumulator.buffers[param]
+                            buf = getattr(self.accumulator, attr_name)
+                            dxi = add(buf, dxi)
+                            if dctx.enable_data_parallel:
+                                dxi = multiply(allreduce(dxi), self.inv_size)
+                            new_buf = add(zeros_like(buf), self.acc_zero, out=buf)
+                            trace_mutate_attr(self.accumulator, attr_name, new_buf)
+
                         # Inplace update the local SGD variant and weight (float32).
                         new_sgd_v = add(multiply(self.momentum, sgd_v), dxi, out=sgd_v)
                         new_sgd_w = subtract(
@@ -204,6 +379,14 @@ def with_sgd(learning_rate=0.1, momentum=0.01):
                         if self.dtype != "float32":
                             new_sgd_w = cast(new_sgd_w, self.dtype)
 
+                        # ZeRO-3: Only update the parameter partition, which will be
+                        # all-gathered right before its use in the next iteration.
+                        if param in zero3_params:
+                            part = getattr(self.ad_model, zero3_params[param])
+                            new_part = add(new_sgd_w, self.zero, out=part)
+                            trace_mutate_attr(self.ad_model, zero3_params[param], new_part)
+                            continue
+
                         # If the SGD status is partitioned, use all-gather to sync
                         # the updated weights.
                         if dctx.zero_opt_level > 0:
@@ -0,0 +1,76 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+"""Functions for the int8 post-training quantization of the dense layers."""
+# pylint: disable=protected-access
+from raf._core.executor import VMExecutor
+from raf._ffi.pass_ import FoldQuantize, InferType, InstrumentQuantize, Quantize
+from raf.frontend.model import FrameworkModel
+from raf.model.trace import _get_func_inputs
+
+
+def calibrate(model, calib_data, device="cpu"):
+    """Collect the ranges, i.e., max(abs(x)), of the inputs x of the float32 dense layers over the
+    calibration data.
+
+    Parameters
+    ----------
+    model : raf.model.Model
+        The model in the inference mode.
+
+    calib_data : Iterable[List[raf.ndarray]]
+        The input batches of the model, which are in the same shapes.
+
+    device : str
+        The device to run the calibration.
+
+    Returns
+    -------
+    ret : List[float]
+        The range of each dense input, in the order of the dense layers in the model.
+    """
+    ranges = None
+    executor = None
+    for args in calib_data:
+        record = model._internal(*args)
+        if executor is None:
+            mod = InstrumentQuantize()(InferType()(record.mod))
+            executor = VMExecutor(mod, device).make_executor()
+        out = executor(*_get_func_inputs(record, args, {}, get_handle=False))
+        batch = [float(field.numpy()) for field in out[1:]]
+        ranges = batch if ranges is None else [max(a, b) for a, b in zip(ranges, batch)]
+    assert ranges is not None, "The calibration data is empty"
+    return ranges
+
+
+def quantize(model, calib_data, device="cpu", fold=True):
+    """Quantize the float32 dense layers of a model to int8. The inputs are scaled per tensor by
+    their ranges calibrated on the data, and the weights are scaled per output channel.
+
+    Parameters
+    ----------
+    model : raf.model.Model
+        The model in the inference mode.
+
+    calib_data : List[List[raf.ndarray]]
+        The input batches of the model, which are in the same shapes.
+
+    device : str
+        The device to run the calibration.
+
+    fold : bool
+        Whether to fold the dequantized dense layers into the int8 dense op. Otherwise, the dense
+        layers run in float32 on the dequantized tensors, which simulates the quantization error.
+
+    Returns
+    -------
+    ret : raf.frontend.FrameworkModel
+        The quantized model, whose constant scales are moved to the device with model.to.
+    """
+    calib_data = list(calib_data)
+    ranges = calibrate(model, calib_data, device)
+    mod = InferType()(model._internal(*calib_data[0]).mod)
+    mod = InferType()(Quantize(ranges)(mod))
+    if fold:
+        mod = InferType()(FoldQuantize()(mod))
+    return FrameworkModel(mod, mod, model.state(), dict())
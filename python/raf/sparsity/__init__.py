@@ -0,0 +1,5 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+"""2:4 structured sparsity module"""
+from .sparsity import prune_2_4, compress_2_4, sparsify
@@ -0,0 +1,130 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+"""Functions for the 2:4 structured sparsity of the dense layers, which keeps 2 of every 4
+consecutive weights along the reduction dimension to run on the sparse tensor cores."""
+# pylint: disable=protected-access
+import numpy as np
+from tvm import relay
+
+from raf._ffi.pass_ import InferType, SparsifyDense
+from raf.frontend.model import FrameworkModel
+from raf.ir.constant import const
+
+
+def prune_2_4(weight):
+    """Zero out the 2 smallest magnitudes of every 4 consecutive elements of each row.
+
+    Parameters
+    ----------
+    weight : numpy.ndarray
+        The weight of [n, k], where k is a multiple of 4.
+
+    Returns
+    -------
+    ret : numpy.ndarray
+        The pruned weight in the same shape and dtype.
+    """
+    n, k = weight.shape
+    assert k % 4 == 0, "The reduction dimension must be a multiple of 4"
+    groups = weight.reshape(n, k // 4, 4)
+    keep = np.argsort(-np.abs(groups), axis=-1, kind="stable")[..., :2]
+    mask = np.zeros(groups.shape, dtype="bool")
+    np.put_along_axis(mask, keep, True, axis=-1)
+    return np.where(mask, groups, 0).astype(weight.dtype).reshape(n, k)
+
+
+def _reorder_meta(words):
+    # The metadata words of [n, k / 32] are laid out as [k / 64, n, 2] for the sparse tensor
+    # cores, where the rows are interleaved in groups of 16, and each 2x2 block is transposed.
+    n, cols = words.shape
+    rows = np.arange(n).reshape(-1, 1)
+    cols_idx = np.arange(cols).reshape(1, -1)
+    r = rows // 16 * 16 + rows % 8 * 2 + rows % 16 // 8
+    r, c = np.broadcast_arrays(r, cols_idx)
+    down = (r % 2 == 0) & (c % 2 == 1)
+    up = (r % 2 == 1) & (c % 2 == 0)
+    r = np.where(down, r + 1, np.where(up, r - 1, r))
+    c = np.where(down, c - 1, np.where(up, c + 1, c))
+    out = np.zeros((cols // 2, n, 2), dtype="uint32")
+    out[c // 2, r, c % 2] = words
+    return out.view("int32")
+
+
+def compress_2_4(weight):
+    """Compress the 2:4 sparse weight into the kept elements and their indices.
+
+    Parameters
+    ----------
+    weight : numpy.ndarray
+        The weight of [n, k] with at most 2 non-zeros in every 4 consecutive elements of each row,
+        where n is a multiple of 16, and k is a multiple of 64.
+
+    Returns
+    -------
+    values : numpy.ndarray
+        The kept elements of [n, k / 2].
+
+    meta : numpy.ndarray
+        The int32 metadata of [k / 64, n, 2], where each word holds the 2-bit indices of the 2 kept
+        elements of 8 groups of 4 elements, in the layout of the sparse tensor cores.
+    """
+    n, k = weight.shape
+    assert n % 16 == 0 and k % 64 == 0, "Expected n and k to be multiples of 16 and 64"
+    groups = weight.reshape(n, k // 4, 4)
+    assert np.all(np.count_nonzero(groups, axis=-1) <= 2), "The weight is not 2:4 sparse"
+    # The non-zeros are kept first, and the positions of the kept elements are in order.
+    keep = np.sort(np.argsort(groups == 0, axis=-1, kind="stable")[..., :2], axis=-1)
+    values = np.take_along_axis(groups, keep, axis=-1).reshape(n, k // 2)
+    nibbles = (keep[..., 0] | (keep[..., 1] << 2)).astype("uint32").reshape(n, k // 32, 8)
+    words = np.zeros((n, k // 32), dtype="uint32")
+    for i in range(8):
+        words |= nibbles[..., i] << np.uint32(4 * i)
+    return values, _reorder_meta(words)
+
+
+def _is_sparsifiable(weight):
+    return weight.ndim == 2 and weight.shape[0] % 16 == 0 and weight.shape[1] % 64 == 0
+
+
+def sparsify(model, args):
+    """Prune the weights of the dense layers of a model to 2:4 sparsity, and replace the dense
+    layers by the sparse dense op with the compressed constant weights, so that they run on the
+    sparse tensor cores of Ampere GPUs. The layers whose weights are not in the shape of
+    [16 * i, 64 * j] are kept dense. The sparse tensor cores take float16 inputs, e.g., under
+    AMP, and the other dtypes or devices run on the decompressed weights.
+
+    Parameters
+    ----------
+    model : raf.model.Model
+        The model in the inference mode.
+
+    args : List[raf.ndarray]
+        The inputs of the model to trace it.
+
+    Returns
+    -------
+    ret : raf.frontend.FrameworkModel
+        The sparse model, whose constant weights are moved to the device with model.to.
+    """
+    record = model._internal(*args)
+    mod = InferType()(record.mod)
+    func = mod["main"]
+    params = dict(zip(func.params[len(args) :], record.named_params.values()))
+    dense_ops = [relay.op.get("raf.op.dense"), relay.op.get("raf.op.matmul_nt")]
+    weights = {}
+
+    def visit(expr):
+        if not isinstance(expr, relay.Call) or expr.op not in dense_ops or len(expr.args) != 2:
+            return
+        w_var = expr.args[1]
+        if w_var not in params or w_var.name_hint in weights:
+            return
+        weight = params[w_var].numpy()
+        if _is_sparsifiable(weight):
+            values, meta = compress_2_4(prune_2_4(weight))
+            weights[w_var.name_hint] = [const(values), const(meta)]
+
+    relay.analysis.post_order_visit(func, visit)
+    mod = InferType()(SparsifyDense(weights)(mod))
+    return FrameworkModel(mod, mod, model.state(), dict())
@@ -0,0 +1,358 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+"""End-to-end model benchmark harness.
+
+Each benchmark compiles a model through the VM with the given pass options, and reports the
+compile time, the peak memory from the memory profiler, and the throughput in samples/s for
+training or the p50/p99 latency for inference. The results are written in a versioned JSON
+schema, and can be compared with a baseline to gate upgrades on regressions:
+
+    python3 -m raf.testing.benchmark --model mlp --batch-sizes 1,8 --mode infer \\
+        --output current.json --baseline baseline.json
+"""
+# pylint: disable=protected-access,too-many-arguments,too-many-locals
+import argparse
+import json
+import sys
+import time
+
+import numpy as np
+
+import raf
+from raf._core.device import Device
+from raf._core.executor import VMExecutor
+from raf.model.trace import _get_func_inputs
+from raf.utils import memory_profiler
+from .common import randn_torch, randint
+from .._lib import tvm
+
+SCHEMA_VERSION = 1
+
+MLP_CONFIG = (784, 10, 256, 256)
+
+
+def get_model_and_input(name, batch_size, device, train):
+    """Get a RAF model and its inputs by name.
+
+    Parameters
+    ----------
+    name: str
+        The model name, which is "mlp", "resnet50", "inception_v3", a torchvision model name
+        prefixed by "tv:", or a transformer model name prefixed by "hf:".
+
+    batch_size: int
+        The batch size.
+
+    device: str
+        The device of the inputs.
+
+    train: bool
+        Whether the model is in the training mode.
+
+    Returns
+    -------
+    ret: Tuple[raf.Model, List[raf.ndarray], bool]
+        The model, its inputs, and whether the optimizer has been appended to the model.
+    """
+    # pylint: disable=import-outside-toplevel
+    from . import mlp, resnet, inception, pt_models
+
+    if name == "mlp":
+        model, _ = mlp.get_model(MLP_CONFIG, train=train)
+        args, _ = mlp.get_input(MLP_CONFIG, batch_size=batch_size, device=device, train=train)
+    elif name == "resnet50":
+        model, _ = resnet.get_model([3, 4, 6, 3], train=train)
+        args, _ = resnet.get_input(batch_size=batch_size, device=device, train=train)
+    elif name == "inception_v3":
+        model, _ = inception.get_model()
+        args, _ = inception.get_input(batch_size=batch_size, device=device)
+        if not train:
+            model.infer_mode()
+            args = args[:1]
+    elif name.startswith("tv:") or name.startswith("hf:"):
+        if name.startswith("tv:"):
+            model, out_shape = pt_models.get_torchvision_model(name[3:], batch_size=batch_size)
+            m_x, _ = randn_torch((batch_size, 3, 224, 224), device=device)
+        else:
+            model, out_shape = pt_models.get_transformer_model(name[3:], batch_size=batch_size)
+            m_x, _ = randint((batch_size, 128), low=0, high=1000, device=device)
+        model.to(device=device)
+        if not train:
+            model.infer_mode()
+            return model, [m_x], False
+        num_classes = out_shape[-1]
+        m_y, _ = randint((int(np.prod(out_shape[:-1])),), low=0, high=num_classes, device=device)
+        model = pt_models.append_loss_n_optimizer(model, [m_x], out_shape, m_y)
+        m_dy, _ = randn_torch((), device=device, requires_grad=False)
+        return model, [m_dy, m_x, m_y], True
+    else:
+        raise ValueError("Unknown model: %s" % name)
+    model.to(device=device)
+    return model, list(args), False
+
+
+def benchmark_model(
+    model,
+    args,
+    device,
+    train,
+    batch_size,
+    amp=False,
+    memory_budget=0,
+    stream_schedule_policy="sequential",
+    cuda_graph=False,
+    warmup=5,
+    repeat=20,
+    with_optimizer=False,
+):
+    """Benchmark a model through the VM.
+
+    Parameters
+    ----------
+    model: raf.Model
+        The model to benchmark.
+
+    args: List[raf.ndarray]
+        The inputs of the model. For training, the gradient of the output is prepended.
+
+    device: str
+        The target device.
+
+    train: bool
+        Whether to benchmark a training step with the SGD optimizer.
+
+    batch_size: int
+        The batch size of the inputs, which is used to calculate the throughput.
+
+    amp: bool
+        Whether to enable AMP.
+
+    memory_budget: int
+        The memory budget in bytes for rematerialization, or 0 to disable it.
+
+    stream_schedule_policy: str
+        The stream schedule policy.
+
+    cuda_graph: bool
+        Whether to run with CUDA graph.
+
+    warmup: int
+        The number of warmup runs.
+
+    repeat: int
+        The number of measured runs.
+
+    with_optimizer: bool
+        Whether the optimizer has already been appended to the model.
+
+    Returns
+    -------
+    ret: Dict[str, Any]
+        The benchmark result.
+    """
+    if train and not with_optimizer:
+        model = raf.optim.sgd.with_sgd(learning_rate=0.1, momentum=0.01)(model)
+        m_dy, _ = randn_torch((), device=device, requires_grad=False)
+        args = [m_dy] + list(args)
+    if amp:
+        model = raf.amp.autocast(model, args)
+
+    config = {"raf.stream_schedule.policy": stream_schedule_policy}
+    if memory_budget > 0:
+        config["raf.memory_budget"] = memory_budget
+
+    start = time.time()
+    record = model._internal(*args)
+    with tvm.transform.PassContext(opt_level=3, config=config):
+        executor = VMExecutor(record.mod, device, enable_cuda_graph=cuda_graph)
+        inputs = _get_func_inputs(record, args, {}, get_handle=False)
+        compile_time = time.time() - start
+
+        # The first run JIT compiles the ops, and its peak memory is recorded.
+        memory_profiler.reset()
+        memory_profiler.start()
+        start = time.time()
+        executor.vm.run(*inputs)
+        tvm.nd.device(device).sync()
+        first_run_time = time.time() - start
+        memory_profiler.stop()
+        peak_memory = memory_profiler.get_max_memory_info(Device(device))["max_allocated"].value
+
+        latencies = executor.vm.profile(*inputs, warmup=warmup, number=1, repeat=repeat)
+    memory_profiler.reset()
+
+    latencies = np.array(latencies)
+    result = {
+        "compile_time_s": compile_time,
+        "first_run_time_s": first_run_time,
+        "peak_memory_mb": peak_memory,
+        "latency_mean_ms": float(np.mean(latencies)),
+        "latency_p50_ms": float(np.percentile(latencies, 50)),
+        "latency_p99_ms": float(np.percentile(latencies, 99)),
+    }
+    result["samples_per_sec"] = batch_size * 1000.0 / result["latency_mean_ms"]
+    return result
+
+
+def run_benchmarks(
+    models,
+    batch_sizes,
+    device,
+    train,
+    amp=False,
+    memory_budget=0,
+    stream_schedule_policy="sequential",
+    cuda_graph=False,
+    warmup=5,
+    repeat=20,
+):
+    """Benchmark the models across the batch sizes with the same options.
+
+    Returns
+    -------
+    ret: Dict[str, Any]
+        The benchmark report in the JSON schema.
+    """
+    options = {
+        "mode": "train" if train else "infer",
+        "amp": amp,
+        "memory_budget": memory_budget,
+        "stream_schedule_policy": stream_schedule_policy,
+        "cuda_graph": cuda_graph,
+        "warmup": warmup,
+        "repeat": repeat,
+    }
+    results = []
+    for name in models:
+        for batch_size in batch_sizes:
+            model, args, with_optimizer = get_model_and_input(name, batch_size, device, train)
+            result = benchmark_model(
+                model,
+                args,
+                device,
+                train,
+                batch_size,
+                amp=amp,
+                memory_budget=memory_budget,
+                stream_schedule_policy=stream_schedule_policy,
+                cuda_graph=cuda_graph,
+                warmup=warmup,
+                repeat=repeat,
+                with_optimizer=with_optimizer,
+            )
+            result.update({"model": name, "batch_size": batch_size})
+            results.append(result)
+    return {
+        "schema_version": SCHEMA_VERSION,
+        "raf_version": raf.__version__,
+        "git_version": raf.build.git_version(),
+        "device": device,
+        "options": options,
+        "timestamp": time.strftime("%Y-%m-%dT%H:%M:%S"),
+        "results": results,
+    }
+
+
+def compare_results(baseline, current, tolerance=0.05):
+    """Compare a benchmark report with a baseline, and return the regressions. For training, the
+    throughput is compared, and for inference the p50 and p99 latency are compared. The peak
+    memory and the compile time are compared in both cases.
+
+    Parameters
+    ----------
+    baseline: Dict[str, Any]
+        The baseline report.
+
+    current: Dict[str, Any]
+        The current report.
+
+    tolerance: float
+        The allowed relative regression.
+
+    Returns
+    -------
+    ret: List[str]
+        The regressions, or an empty list if there is no regression.
+    """
+    if baseline["schema_version"] != current["schema_version"]:
+        raise ValueError(
+            "Mismatched schema version: %s vs. %s"
+            % (baseline["schema_version"], current["schema_version"])
+        )
+    # (metric, whether higher is better)
+    metrics = [("peak_memory_mb", False), ("compile_time_s", False)]
+    if current["options"]["mode"] == "train":
+        metrics.append(("samples_per_sec", True))
+    else:
+        metrics += [("latency_p50_ms", False), ("latency_p99_ms", False)]
+
+    base_results = {(r["model"], r["batch_size"]): r for r in baseline["results"]}
+    regressions = []
+    for result in current["results"]:
+        key = (result["model"], result["batch_size"])
+        if key not in base_results:
+            continue
+        for metric, higher_is_better in metrics:
+            base, curr = base_results[key][metric], result[metric]
+            if base <= 0:
+                continue
+            change = (curr - base) / base
+            if (higher_is_better and change < -tolerance) or (
+                not higher_is_better and change > tolerance
+            ):
+                regressions.append(
+                    "%s (batch %d): %s %.4g -> %.4g (%+.1f%%)"
+                    % (key[0], key[1], metric, base, curr, change * 100)
+                )
+    return regressions
+
+
+def main(argv=None):
+    """The command line entry."""
+    parser = argparse.ArgumentParser(description="RAF end-to-end model benchmarks")
+    parser.add_argument("--model", action="append", required=True, help="The model names")
+    parser.add_argument("--batch-sizes", default="1", help="Comma separated batch sizes")
+    parser.add_argument("--device", default="cuda")
+    parser.add_argument("--mode", choices=["train", "infer"], default="infer")
+    parser.add_argument("--amp", action="store_true")
+    parser.add_argument("--memory-budget", type=int, default=0, help="Remat budget in bytes")
+    parser.add_argument("--stream-schedule-policy", default="sequential")
+    parser.add_argument("--cuda-graph", action="store_true")
+    parser.add_argument("--warmup", type=int, default=5)
+    parser.add_argument("--repeat", type=int, default=20)
+    parser.add_argument("--output", help="The path to write the JSON report")
+    parser.add_argument("--baseline", help="The baseline JSON report to compare with")
+    parser.add_argument("--tolerance", type=float, default=0.05)
+    args = parser.parse_args(argv)
+
+    report = run_benchmarks(
+        args.model,
+        [int(bs) for bs in args.batch_sizes.split(",")],
+        args.device,
+        args.mode == "train",
+        amp=args.amp,
+        memory_budget=args.memory_budget,
+        stream_schedule_policy=args.stream_schedule_policy,
+        cuda_graph=args.cuda_graph,
+        warmup=args.warmup,
+        repeat=args.repeat,
+    )
+    if args.output:
+        with open(args.output, "w") as filep:
+            json.dump(report, filep, indent=2)
+    else:
+        print(json.dumps(report, indent=2))
+
+    if args.baseline:
+        with open(args.baseline, "r") as filep:
+            baseline = json.load(filep)
+        regressions = compare_results(baseline, report, args.tolerance)
+        for regression in regressions:
+            print("REGRESSION: " + regression)
+        return 1 if regressions else 0
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -72,12 +72,21 @@ def _get_vm_executor(mod, device, opt_level=2, disable_fusion=False, **options):
     # pylint: disable=protected-access
     options.setdefault("stream_schedule_policy", "sequential")
     options.setdefault("anf_only", False)
+    options.setdefault("deduplicate", False)
+    options.setdefault("layout_policy", "auto")
+    options.setdefault("inference", False)
+    options.setdefault("multi_device", False)
     options.setdefault("sch_file", None)
     options.setdefault("pass_seq", None)
+    options.setdefault("enable_cuda_graph", False)
 
     config = {
         "raf.stream_schedule.policy": options["stream_schedule_policy"],
         "raf.vm.optimize.anf_only": options["anf_only"],
+        "raf.vm.optimize.deduplicate": options["deduplicate"],
+        "raf.layout.policy": options["layout_policy"],
+        "raf.vm.optimize.inference": options["inference"],
+        "raf.vm.multi_device": options["multi_device"],
     }
     pass_seq = options["pass_seq"]
     disabled_pass = []
@@ -87,7 +96,7 @@ def _get_vm_executor(mod, device, opt_level=2, disable_fusion=False, **options):
         mod = raf._ffi.pass_.InferType()(mod)
         if pass_seq is not None:
             mod = pass_seq(mod)
-        executor = VMExecutor(mod, device)
+        executor = VMExecutor(mod, device, enable_cuda_graph=options["enable_cuda_graph"])
     return executor
 
 
@@ -114,12 +123,25 @@ def get_vm_profiler(
     return executor.make_profiler(warmup, number, repeat, sch_file=options.get("sch_file", None))
 
 
+def freeze_params(record, inputs):
+    """Bind the model parameters to the main function as constants, so that the inference
+    compilation can fold the computation on them. Return the module and the remaining inputs."""
+    func = record.mod["main"]
+    num_args = len(func.params) - len(record.named_params)
+    params = zip(func.params[num_args:], inputs[num_args:])
+    binds = {param: raf.ir.const(value) for param, value in params}
+    return IRModule.from_expr(tvm.relay.bind(func, binds)), inputs[:num_args]
+
+
 def run_vm_model(model, device, args, opt_level=2, disable_fusion=False, **options):
-    """Helper function to execute model with VM"""
+    """Helper function to execute model with VM. With inference=True, the parameters are frozen
+    and the model is compiled to a forward-only executable."""
     args, kwargs = ([], args) if isinstance(args, dict) else (args, {})
     record = model._internal(*args, **kwargs)
     mod = record.mod
     inputs = _get_func_inputs(record, args, kwargs, get_handle=False)
+    if options.get("inference", False):
+        mod, inputs = freeze_params(record, inputs)
     vm = get_vm_executor(mod, device, opt_level, disable_fusion, **options)
     out = vm(*inputs)
     return out
@@ -5,6 +5,8 @@
 
 from raf._ffi.memory_profiler import EnableMemoryProfiler, DisableMemoryeProfiler
 from raf._ffi.memory_profiler import ResetMemoryProfiler, GetMaxMemoryInfo, GetMemoryTrace
+from raf._ffi.memory_profiler import EnableAllocationTrace, DisableAllocationTrace
+from raf._ffi.memory_profiler import GetPeakBreakdown, GetLiveAllocations, GetAllocationInfo
 
 
 def start():
@@ -53,3 +55,85 @@ def get_memory_trace(device):
         The complete trace in a string.
     """
     return GetMemoryTrace(device)
+
+
+def start_allocation_trace():
+    """Enable the allocation-level tracing, which records the size, the address, the requesting
+    op or VM instruction, the stream, and the allocation and free time of every memory chunk."""
+    EnableAllocationTrace()
+
+
+def stop_allocation_trace():
+    """Disable the allocation-level tracing. The traced allocations are kept until reset."""
+    DisableAllocationTrace()
+
+
+def get_peak_breakdown(device):
+    """Get the breakdown of the live memory at the peak of the traced allocations.
+
+    Parameters
+    ----------
+    device: Device
+        The device to fetch.
+
+    Returns
+    -------
+    ret: str
+        The breakdown in the folded stack format, which can be rendered by flame graph tools.
+        Each line is "device;tag;func_index:pc bytes".
+    """
+    return GetPeakBreakdown(device)
+
+
+def get_live_allocations(device):
+    """Get the traced allocations that are still alive, e.g. at the end of a step, which are
+    the candidates of memory leaks.
+
+    Parameters
+    ----------
+    device: Device
+        The device to fetch.
+
+    Returns
+    -------
+    ret: str
+        The allocation table in a string.
+    """
+    return GetLiveAllocations(device)
+
+
+def get_allocation_info(device):
+    """Get the statistics of the traced allocations.
+
+    Parameters
+    ----------
+    device: Device
+        The device to fetch.
+
+    Returns
+    -------
+    ret: Dict[str, float]
+        A map of the peak and the live memory in MBs, and the number of allocations.
+    """
+    return GetAllocationInfo(device)
+
+
+def cross_check_estimate(device, estimated_trace):
+    """Compare the traced peak memory with the one estimated by the compiler.
+
+    Parameters
+    ----------
+    device: Device
+        The device to fetch.
+
+    estimated_trace: List[Tuple[str, float]]
+        The estimated memory trace in MBs, such as the output of raf.model.model.trace_memory.
+
+    Returns
+    -------
+    ret: Tuple[float, float]
+        The traced and the estimated peak memory in MBs.
+    """
+    traced_peak = GetAllocationInfo(device)["peak"].value
+    estimated_peak = max(mem for _, mem in estimated_trace) if estimated_trace else 0.0
+    return traced_peak, estimated_peak
@@ -5,7 +5,14 @@
 import json
 from raf import build
 from raf._ffi.profiler import EnableProfiler, DisableProfiler
-from raf._ffi.profiler import CollectBaseProfile, CollectCudaProfile, GetProfile
+from raf._ffi.profiler import CollectBaseProfile, CollectCudaProfile, CollectCuptiProfile
+from raf._ffi.profiler import GetProfile
+from raf._ffi.profiler import EnableSamplingProfiler, DisableSamplingProfiler
+from raf._ffi.profiler import GetSampledStats, ResetSampledStats
+from raf._ffi.profiler import EnableCommProfiler, DisableCommProfiler, ResetCommProfiler
+from raf._ffi.profiler import GetCommProfile, GetCommStragglerReport
+from raf._ffi.pass_ import EnablePassProfiler, DisablePassProfiler, ResetPassProfiler
+from raf._ffi.pass_ import GetPassProfile, GetPassProfileEntries
 
 
 def start(prof_level=1):
@@ -47,6 +54,8 @@ def get():
     CollectBaseProfile()
     if build.with_cuda():
         CollectCudaProfile()
+    if build.with_cupti():
+        CollectCuptiProfile()
     return json.loads(GetProfile())
 
 
@@ -71,6 +80,8 @@ def get_duration(data, event, category=None):
         - 'Default Stream': The kernel executed on the default stream.
         - 'Stream 1': The kernels executed on the first computation stream. There are also
           categories such as 'Stream 2', 'Stream 3' and so on.
+        - 'GPU 0 Stream 7': The kernels, memory copies and memory sets that CUPTI recorded on
+          the CUDA stream 7 of GPU 0, when RAF is built with CUPTI.
 
     Returns
     -------
@@ -89,3 +100,142 @@ def get_duration(data, event, category=None):
     if start_time_stamp is None or end_time_stamp is None:
         raise ValueError(f"The start or end time stamp of event {event} does not exist")
     return float((end_time_stamp - start_time_stamp) / 1000.0)
+
+
+def start_sampling(sample_every=100, capacity=1 << 16, flush_interval_ms=1000):
+    """Enable the low-overhead sampling profiler, which can be left on in production. It profiles
+    the ops of 1 in `sample_every` VM runs, and aggregates their latencies into per-op histograms
+    in a background thread.
+
+    Parameters
+    ----------
+    sample_every : int
+        Profile 1 in `sample_every` VM runs. The ops of a sampled run are synchronized with the
+        device, so the overhead is roughly the synchronization cost divided by `sample_every`.
+
+    capacity : int
+        The number of events in the ring buffer. The oldest events are dropped when the flush
+        thread falls behind.
+
+    flush_interval_ms : int
+        The interval of the flush thread in milliseconds.
+    """
+    EnableSamplingProfiler(sample_every, capacity, flush_interval_ms)
+
+
+def stop_sampling():
+    """Disable the sampling profiler. The aggregated statistics are kept."""
+    DisableSamplingProfiler()
+
+
+def get_sampled_stats():
+    """Get the per-op latency statistics of the sampling profiler.
+
+    Return
+    ----------
+    ret : Dict[str, ...]
+        The number of dropped events in "num_dropped", and a dict from the op name to its
+        "count", "mean_us", "p50_us", "p99_us" and "max_us" in "ops".
+    """
+    return json.loads(GetSampledStats())
+
+
+def reset_sampled_stats():
+    """Clear the statistics of the sampling profiler."""
+    ResetSampledStats()
+
+
+def start_pass_profiler():
+    """Enable the compile-time profiler of the pass pipeline, which records the wall time, the
+    peak RSS delta, the RSS after the pass and the IR node counts before and after each pass.
+    The passes are also reported as the "Pass" events of the runtime profiler when it is
+    enabled."""
+    EnablePassProfiler()
+
+
+def stop_pass_profiler():
+    """Disable the pass profiler. The recorded passes are kept."""
+    DisablePassProfiler()
+
+
+def reset_pass_profiler():
+    """Clear the passes recorded by the pass profiler."""
+    ResetPassProfiler()
+
+
+def get_pass_profile(as_table=False):
+    """Get the passes recorded by the pass profiler in the execution order.
+
+    Parameters
+    ----------
+    as_table : bool
+        Whether to return a formatted table, where the nested passes are indented.
+
+    Return
+    ----------
+    ret : Union[str, List[Dict[str, ...]]]
+        The table, or a list of passes with "name", "depth", "time_ms", "peak_rss_delta_mb",
+        "nodes_before", "nodes_after" and "rss_mb". The RSS after a pass is lower than the peak
+        when the pass releases memory, which the allocator only returns to the OS when the
+        "raf.pass.release_memory" config of the PassContext is set.
+    """
+    if as_table:
+        return GetPassProfile()
+    keys = [
+        "name",
+        "depth",
+        "time_ms",
+        "peak_rss_delta_mb",
+        "nodes_before",
+        "nodes_after",
+        "rss_mb",
+    ]
+    ret = []
+    for entry in GetPassProfileEntries():
+        values = [str(entry[0])] + [field.value for field in entry[1:]]
+        ret.append(dict(zip(keys, values)))
+    return ret
+
+
+def start_comm_profiler():
+    """Enable the communication profiler, which records the device time, the bytes, and the
+    algorithm and bus bandwidth of each NCCL collective, as well as the time its stream waited on
+    CudaWaitEvent before the collective. The collectives are grouped by the VM runs."""
+    EnableCommProfiler()
+
+
+def stop_comm_profiler():
+    """Disable the communication profiler. The recorded collectives are kept."""
+    DisableCommProfiler()
+
+
+def reset_comm_profiler():
+    """Clear the collectives recorded by the communication profiler."""
+    ResetCommProfiler()
+
+
+def get_comm_profile():
+    """Get the per-iteration communication profile of this rank.
+
+    Return
+    ----------
+    ret : Dict[str, ...]
+        The "rank", and a list of "iterations" with the total "bytes", "time_us", "wait_us",
+        "algbw_gbps" and "busbw_gbps", and the same metrics of each collective in "collectives".
+    """
+    return json.loads(GetCommProfile())
+
+
+def get_comm_straggler_report():
+    """Gather the communication profiles of all ranks, and find the rank that the others wait for
+    in each iteration. This is a collective call, so it must be called by all ranks.
+
+    Return
+    ----------
+    ret : Dict[str, ...]
+        The per-iteration "time_us" and "wait_us" of all ranks with the "straggler", the
+        "skew_us" between the ranks and the "transfer_us" of the straggler; the "straggler_counts"
+        of all ranks; and the "diagnosis", which is "slow_rank" if the skew dominates the transfer
+        time and "slow_link" otherwise, with the "suspect_rank".
+    """
+    return json.loads(GetCommStragglerReport())
@@ -155,6 +155,22 @@ def tune_tasks(tasks, weights, log_file, n_trials):
     print("Done tuning. Records saved in %s" % log_file)
 
 
+def apply_tuning_log(log_file):
+    """Apply the best records in the given tuning log to all TVM kernels built afterwards in this
+    process, including the fused ones. This is equivalent to launching the process with
+    RAF_TUNING_LOG=log_file. The log is also a part of the keys of the kernel caches, so the
+    kernels built without it are not reused from the persistent cache.
+
+    Parameters
+    ----------
+    log_file: str
+        The tuning log generated by run_tuning or tune_tasks.
+    """
+    assert os.path.exists(log_file), "Tuning log %s does not exist" % log_file
+    os.environ["RAF_TUNING_LOG"] = os.path.abspath(log_file)
+    auto_scheduler.ApplyHistoryBest(log_file, include_compatible=True).__enter__()
+
+
 def run_tuning(
     model_or_executor,
     device,
@@ -201,6 +217,9 @@ def run_tuning(
 
     only_extract_tasks: bool
         Whether to extract and print tasks only without actual tuning them.
+
+    Note that the tasks are unique workloads, so the fused functions with the same computation
+    are tuned only once. Use apply_tuning_log or RAF_TUNING_LOG to apply the tuned records.
     """
     print("Extracting tasks...")
     tasks, weights = extract_tuning_tasks(
@@ -231,6 +250,95 @@ def run_tuning(
     tune_tasks(tasks, weights, log_file, n_trials)
 
 
+def tune_kernels(
+    model, device, args, *, devices=None, rank=None, num_ranks=None, warmup=10, number=10, repeat=1
+):
+    """Tune the kernels of the model across the local GPUs and the ranks before running it.
+    The unique kernels of the compiled model are partitioned across the ranks, and the kernels of
+    this rank are queued to one worker per local GPU. Each worker builds the kernels (e.g., tunes
+    CUTLASS and searches the cuDNN algorithms) and profiles them on its own GPU, and the results
+    are merged into the caches shared by the GPUs of the same model. The results of the other ranks
+    are shared through the persistent cache (RAF_PERSIST_CACHE), so they should share its path.
+
+    Parameters
+    ----------
+    model: raf.Model
+        The model to be tuned.
+
+    device: str
+        The target device.
+
+    args: List[raf.ndarray]
+        A list of input arguments.
+
+    devices: Optional[List[int]]
+        The IDs of the local GPUs to tune on. Default is all local GPUs in a single process, or
+        the local GPU of this rank in the distributed context.
+
+    rank: Optional[int]
+        The rank of this process. Default is the rank of the distributed context.
+
+    num_ranks: Optional[int]
+        The number of ranks sharing the kernels. Default is the size of the distributed context.
+
+    warmup: int
+        The number of warmup iterations of profiling each kernel.
+
+    number: int
+        The number of execution iterations of profiling each kernel.
+
+    repeat: int
+        The number of repeat iterations of profiling each kernel.
+
+    Returns
+    -------
+    ret: List[Dict[str, Any]]
+        The "name", the "device_id", the "latency_us" and the "error" of each tuned kernel of this
+        rank, where the device ID is -1 if the kernel failed to be tuned.
+    """
+    # pylint: disable=import-outside-toplevel
+    from raf._core.vm import VMCompiler
+    from raf._ffi.op_profiler import TuneKernels
+    from raf import distributed as dist
+
+    dctx = dist.get_context()
+    rank = dctx.rank if rank is None else rank
+    num_ranks = dctx.size if num_ranks is None else num_ranks
+    device_type = device.split("(")[0]
+    if devices is None:
+        if device_type != "cuda":
+            devices = [0]
+        elif num_ranks > 1:
+            devices = [dctx.local_rank]
+        else:
+            devices = []
+            while tvm.cuda(len(devices)).exist:
+                devices.append(len(devices))
+
+    record = model._internal(*args)
+    with tvm.transform.PassContext(opt_level=3):
+        mod, _ = VMCompiler().optimize(record.mod, device)
+    mod = raf._ffi.pass_.InferType()(mod)
+    jobs = TuneKernels(
+        mod,
+        [raf.Device("%s(%d)" % (device_type, idx)) for idx in devices],
+        rank,
+        num_ranks,
+        warmup,
+        number,
+        repeat,
+    )
+    return [
+        {
+            "name": str(name),
+            "device_id": device_id.value,
+            "latency_us": latency.value,
+            "error": str(error),
+        }
+        for name, device_id, latency, error in jobs
+    ]
+
+
 def tune_op(
     sch_file,
     model_cls,
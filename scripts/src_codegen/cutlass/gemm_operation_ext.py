@@ -52,7 +52,7 @@ class EmitGemmConfigurationLibraryExt(gemm_operation.EmitGemmConfigurationLibrar
 
         self.gemm_kind_wrappers = {
             GemmKind.Gemm: "GemmOperation",
-            GemmKind.Sparse: "GemmSparseOperation",
+            GemmKind.Sparse: "GemmSparseOperationExt",
             GemmKind.Universal: "GemmUniversalOperationExt",
             GemmKind.PlanarComplex: "GemmPlanarComplexOperation",
             GemmKind.PlanarComplexArray: "GemmPlanarComplexArrayOperation",
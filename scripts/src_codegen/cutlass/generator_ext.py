@@ -12,6 +12,13 @@ from manifest import *
 import manifest_ext
 from library_ext import *
 
+# The epilogues of the generated conv2d kernels, which only fuse into fprop. The dgrad and wgrad
+# kernels of the plain linear combination come from the original generator.
+conv_epilogue_functors = [
+    EpilogueFunctorExt.LinearCombinationRelu,
+    EpilogueFunctorExt.LinearCombinationGELU,
+]
+
 
 def GenerateSM50_Simt_Epilogue(manifest, args):
     """Extention to raf/3rdparty/cutlass/tools/library/scripts/generator.py::GenerateSM50_Simt"""
@@ -86,14 +93,16 @@ def GenerateSM50_Simt_Epilogue(manifest, args):
 
         if math_inst.element_a == DataType.f32:
             conv_layout = (LayoutType.TensorNHWC, LayoutType.TensorNHWC, LayoutType.TensorNHWC)
-            CreateConv2dOperator(
-                manifest,
-                conv_layout,
-                tile_descriptions,
-                data_type,
-                1,
-                epilogue_functor=EpilogueFunctorExt.LinearCombinationRelu,
-            )
+            for epilogue_functor in conv_epilogue_functors:
+                CreateConv2dOperator(
+                    manifest,
+                    conv_layout,
+                    tile_descriptions,
+                    data_type,
+                    1,
+                    conv_kinds=[ConvKind.Fprop],
+                    epilogue_functor=epilogue_functor,
+                )
 
 
 def GenerateSM50(manifest, args):
@@ -276,14 +285,16 @@ def GenerateSM80_Simt_f32_Epilogue(manifest, args):
         )
 
         conv_layout = (LayoutType.TensorNHWC, LayoutType.TensorNHWC, LayoutType.TensorNHWC)
-        CreateConv2dOperator(
-            manifest,
-            conv_layout,
-            tile_descriptions,
-            data_type,
-            1,
-            epilogue_functor=EpilogueFunctorExt.LinearCombinationRelu,
-        )
+        for epilogue_functor in conv_epilogue_functors:
+            CreateConv2dOperator(
+                manifest,
+                conv_layout,
+                tile_descriptions,
+                data_type,
+                1,
+                conv_kinds=[ConvKind.Fprop],
+                epilogue_functor=epilogue_functor,
+            )
 
 
 def GenerateSM80(manifest, args):
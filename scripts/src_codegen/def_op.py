@@ -86,6 +86,8 @@ OPS = [
     Op(name="batch_matmul_nt", schema_name="binary"),
     Op(name="batch_matmul_tn", schema_name="binary"),
     Op(name="batch_matmul_tt", schema_name="binary"),
+    Op(name="grouped_matmul", schema_name="grouped_matmul"),
+    Op(name="grouped_matmul_dw", schema_name="grouped_matmul"),
     Op(name="smooth_l1_loss", schema_name="loss"),
     Op(name="smooth_l1_loss_dpred", schema_name="loss"),
     Op(name="smooth_l1_loss_dtrue", schema_name="loss"),
@@ -113,17 +115,27 @@ OPS = [
     Op(name="min", schema_name="reduce"),
     Op(name="mean", schema_name="reduce"),
     Op(name="mean_dx", schema_name="mean_dx"),
+    Op(name="moments", schema_name="reduce"),
     Op(name="l2norm", schema_name="l2norm"),
     Op(name="get_reduce_axis", schema_name="binary"),
     Op(name="get_kept_dims", schema_name="binary"),
     Op(name="sgd", schema_name="sgd"),
+    Op(name="sparse_sgd", schema_name="sparse_sgd"),
     Op(name="lans", schema_name="lans"),
+    Op(name="multi_sgd", schema_name="multi_sgd"),
+    Op(name="multi_tensor_l2norm", schema_name="multi_tensor_l2norm"),
+    Op(name="multi_tensor_clip", schema_name="multi_tensor_clip"),
+    Op(name="multi_tensor_unscale", schema_name="multi_tensor_unscale"),
+    Op(name="update_loss_scale", schema_name="update_loss_scale"),
+    Op(name="adamw", schema_name="adamw"),
+    Op(name="lamb", schema_name="lamb"),
     Op(name="shape", schema_name="unary"),
     Op(name="swap_axis", schema_name="swap_axis"),
     Op(name="take", schema_name="take"),
     Op(name="take_dx", schema_name="take_dx"),
     Op(name="embedding", schema_name="embedding"),
     Op(name="embedding_dx", schema_name="embedding_dx"),
+    Op(name="embedding_sparse_dx", schema_name="embedding_dx"),
     Op(name="dense", schema_name="binary"),
     Op(name="repeat", schema_name="repeat"),
     Op(name="repeat_dx", schema_name="repeat_dx"),
@@ -157,6 +169,21 @@ OPS = [
     Op(name="bias_add", schema_name="bias_add"),
     Op(name="_contrib_dropout", schema_name="dropout"),
     Op(name="_contrib_dropout_dx", schema_name="dropout_dx"),
+    Op(name="_contrib_philox_dropout", schema_name="philox_dropout"),
+    Op(name="_contrib_philox_dropout_dx", schema_name="philox_dropout_dx"),
+    Op(name="_contrib_batch_norm_add_relu_train", schema_name="batch_norm_add_relu"),
+    Op(name="_contrib_batch_norm_add_relu_train_dxwb", schema_name="batch_norm_add_relu_dxwb"),
+    Op(name="_contrib_attention", schema_name="attention"),
+    Op(name="_contrib_attention_dx", schema_name="attention_dx"),
+    Op(name="_contrib_kv_cache_append", schema_name="kv_cache_append"),
+    Op(name="_contrib_quantize", schema_name="quantize"),
+    Op(name="_contrib_dequantize", schema_name="quantize"),
+    Op(name="_contrib_quantized_dense", schema_name="quantized_dense"),
+    Op(name="_contrib_quantize_fp8", schema_name="quantize_fp8"),
+    Op(name="_contrib_dequantize_fp8", schema_name="quantize_fp8"),
+    Op(name="_contrib_fp8_dense", schema_name="fp8_dense"),
+    Op(name="_contrib_update_fp8_scale", schema_name="update_fp8_scale"),
+    Op(name="_contrib_sparse_dense", schema_name="sparse_dense"),
     Op(name="non_max_suppression", schema_name="non_max_suppression"),
     Op(name="stream_sync", schema_name="stream"),
     Op(name="fuse_tensor", schema_name="fuse_tensor"),
@@ -171,11 +198,14 @@ OPS = [
     Op(name="sort", schema_name="sort"),
     Op(name="compiler_begin", schema_name="unary"),
     Op(name="compiler_end", schema_name="unary"),
+    Op(name="checkpoint", schema_name="unary"),
     Op(name="full", schema_name="full"),
     Op(name="full_like", schema_name="full_like"),
     Op(name="where", schema_name="where"),
     Op(name="logical_and", schema_name="binary"),
     Op(name="device_copy", schema_name="device_copy"),
+    Op(name="memory_prefetch", schema_name="unary"),
+    Op(name="memory_evict", schema_name="unary"),
     Op(name="topk", schema_name="topk"),
     Op(name="zeros", schema_name="init_op"),
     Op(name="zeros_like", schema_name="unary"),
@@ -137,6 +137,24 @@ SCHEMAS = {
         Arg(name="b", cxx_type="value::BaseTensorValue"),
         Arg(name="eps", cxx_type="double"),
     ],
+    "nn.h::batch_norm_add_relu": [
+        Arg(name="x", cxx_type="value::BaseTensorValue"),
+        Arg(name="running_mean", cxx_type="value::BaseTensorValue"),
+        Arg(name="running_var", cxx_type="value::BaseTensorValue"),
+        Arg(name="w", cxx_type="value::BaseTensorValue"),
+        Arg(name="b", cxx_type="value::BaseTensorValue"),
+        Arg(name="z", cxx_type=OptionalTensor, cxx_default="nullptr"),
+        Arg(name="momentum", cxx_type="double", cxx_default=0.1),
+        Arg(name="eps", cxx_type="double", cxx_default=1e-5),
+    ],
+    "nn.h::batch_norm_add_relu_dxwb": [
+        Arg(name="dy", cxx_type="value::BaseTensorValue"),
+        Arg(name="x", cxx_type="value::BaseTensorValue"),
+        Arg(name="mask", cxx_type="value::BaseTensorValue"),
+        Arg(name="w", cxx_type="value::BaseTensorValue"),
+        Arg(name="b", cxx_type="value::BaseTensorValue"),
+        Arg(name="eps", cxx_type="double"),
+    ],
     "nn.h::bias_add": [
         Arg(name="x", cxx_type="value::BaseTensorValue"),
         Arg(name="bias", cxx_type="value::BaseTensorValue"),
@@ -153,6 +171,86 @@ SCHEMAS = {
         Arg(name="reserve_space", cxx_type="value::BaseTensorValue"),
         Arg(name="p", cxx_type="double", cxx_default=0.5),
     ],
+    "nn.h::philox_dropout": [
+        Arg(name="x", cxx_type="value::BaseTensorValue"),
+        Arg(name="key", cxx_type="value::BaseTensorValue"),
+        Arg(name="p", cxx_type="double", cxx_default=0.5),
+    ],
+    "nn.h::philox_dropout_dx": [
+        Arg(name="dy", cxx_type="value::BaseTensorValue"),
+        Arg(name="key", cxx_type="value::BaseTensorValue"),
+        Arg(name="p", cxx_type="double", cxx_default=0.5),
+    ],
+    "nn.h::attention": [
+        Arg(name="q", cxx_type="value::BaseTensorValue"),
+        Arg(name="k", cxx_type="value::BaseTensorValue"),
+        Arg(name="v", cxx_type="value::BaseTensorValue"),
+        Arg(name="scale", cxx_type="double", cxx_default=-1.0),
+        Arg(name="causal", cxx_type="bool", cxx_default=False),
+        Arg(name="valid_len", cxx_type=OptionalTensor, cxx_default="nullptr", py_default="None"),
+    ],
+    "nn.h::kv_cache_append": [
+        Arg(name="cache", cxx_type="value::BaseTensorValue"),
+        Arg(name="x", cxx_type="value::BaseTensorValue"),
+        Arg(name="offset", cxx_type="value::BaseTensorValue"),
+    ],
+    "nn.h::quantize": [
+        Arg(name="x", cxx_type="value::BaseTensorValue"),
+        Arg(name="scale", cxx_type="value::BaseTensorValue"),
+        Arg(name="axis", cxx_type="int", cxx_default=-1),
+    ],
+    "nn.h::quantized_dense": [
+        Arg(name="x", cxx_type="value::BaseTensorValue"),
+        Arg(name="w", cxx_type="value::BaseTensorValue"),
+        Arg(name="x_scale", cxx_type="value::BaseTensorValue"),
+        Arg(name="w_scale", cxx_type="value::BaseTensorValue"),
+    ],
+    "nn.h::quantize_fp8": [
+        Arg(name="x", cxx_type="value::BaseTensorValue"),
+        Arg(name="scale", cxx_type="value::BaseTensorValue"),
+        Arg(name="e5m2", cxx_type="bool", cxx_default=False),
+    ],
+    "nn.h::fp8_dense": [
+        Arg(name="x", cxx_type="value::BaseTensorValue"),
+        Arg(name="w", cxx_type="value::BaseTensorValue"),
+        Arg(name="x_scale", cxx_type="value::BaseTensorValue"),
+        Arg(name="w_scale", cxx_type="value::BaseTensorValue"),
+        Arg(
+            name="out_dtype",
+            cxx_type="std::string",
+            cxx_default='"float32"',
+            py_default='"float32"',
+        ),
+        Arg(name="x_e5m2", cxx_type="bool", cxx_default=False),
+        Arg(name="w_e5m2", cxx_type="bool", cxx_default=False),
+    ],
+    "nn.h::update_fp8_scale": [
+        Arg(name="amax_history", cxx_type="value::BaseTensorValue"),
+        Arg(name="scale", cxx_type="value::BaseTensorValue"),
+        Arg(name="amax", cxx_type="value::BaseTensorValue"),
+        Arg(name="e5m2", cxx_type="bool", cxx_default=False),
+        Arg(name="margin", cxx_type="int", cxx_default=0),
+    ],
+    "nn.h::sparse_dense": [
+        Arg(name="x", cxx_type="value::BaseTensorValue"),
+        Arg(name="w", cxx_type="value::BaseTensorValue"),
+        Arg(name="meta", cxx_type="value::BaseTensorValue"),
+    ],
+    "nn.h::grouped_matmul": [
+        Arg(name="x", cxx_type="value::BaseTensorValue"),
+        Arg(name="w", cxx_type="value::BaseTensorValue"),
+        Arg(name="group_sizes", cxx_type="value::BaseTensorValue"),
+        Arg(name="transpose_b", cxx_type="bool", cxx_default=False),
+    ],
+    "nn.h::attention_dx": [
+        Arg(name="q", cxx_type="value::BaseTensorValue"),
+        Arg(name="k", cxx_type="value::BaseTensorValue"),
+        Arg(name="v", cxx_type="value::BaseTensorValue"),
+        Arg(name="out", cxx_type="value::BaseTensorValue"),
+        Arg(name="dy", cxx_type="value::BaseTensorValue"),
+        Arg(name="scale", cxx_type="double", cxx_default=-1.0),
+        Arg(name="causal", cxx_type="bool", cxx_default=False),
+    ],
     "nn.h::local_response_norm": [
         Arg(name="x", cxx_type="value::BaseTensorValue"),
         Arg(name="size", cxx_type="int64_t"),
@@ -653,6 +751,15 @@ SCHEMAS = {
         Arg(name="v", cxx_type="value::BaseTensorValue"),
         Arg(name="learning_rate", cxx_type="double"),
         Arg(name="mu", cxx_type="double"),
+        Arg(name="skip", cxx_type=OptionalTensor, cxx_default="nullptr", py_default="None"),
+    ],
+    "optimizer.h::sparse_sgd": [
+        Arg(name="x", cxx_type="value::BaseTensorValue"),
+        Arg(name="rows", cxx_type="value::BaseTensorValue"),
+        Arg(name="values", cxx_type="value::BaseTensorValue"),
+        Arg(name="v", cxx_type="value::BaseTensorValue"),
+        Arg(name="learning_rate", cxx_type="double"),
+        Arg(name="mu", cxx_type="double"),
     ],
     "optimizer.h::lans": [
         Arg(
@@ -670,6 +777,83 @@ SCHEMAS = {
         Arg(name="grad_averaging", cxx_type="int"),
         Arg(name="mode", cxx_type="int"),
         Arg(name="normalize_grad", cxx_type="bool"),
+        Arg(name="skip", cxx_type=OptionalTensor, cxx_default="nullptr", py_default="None"),
+    ],
+    "optimizer.h::multi_sgd": [
+        Arg(
+            name="tensor_list",
+            cxx_type="std::vector<value::BaseTensorValue>",
+            cxx_normalizer="TensorTuple",
+        ),
+        Arg(name="learning_rate", cxx_type="float"),
+        Arg(name="mu", cxx_type="float"),
+        Arg(name="master_weights", cxx_type="bool", cxx_default=False),
+        Arg(name="skip", cxx_type=OptionalTensor, cxx_default="nullptr", py_default="None"),
+    ],
+    "optimizer.h::adamw": [
+        Arg(
+            name="tensor_list",
+            cxx_type="std::vector<value::BaseTensorValue>",
+            cxx_normalizer="TensorTuple",
+        ),
+        Arg(name="step", cxx_type="value::BaseTensorValue"),
+        Arg(name="learning_rate", cxx_type="float"),
+        Arg(name="beta1", cxx_type="float", cxx_default="0.9", py_default="0.9"),
+        Arg(name="beta2", cxx_type="float", cxx_default="0.999", py_default="0.999"),
+        Arg(name="eps", cxx_type="float", cxx_default="1e-6", py_default="1e-6"),
+        Arg(name="weight_decay", cxx_type="float", cxx_default="0.01", py_default="0.01"),
+        Arg(name="bias_correction", cxx_type="bool", cxx_default=True),
+        Arg(name="master_weights", cxx_type="bool", cxx_default=False),
+        Arg(name="skip", cxx_type=OptionalTensor, cxx_default="nullptr", py_default="None"),
+    ],
+    "optimizer.h::lamb": [
+        Arg(
+            name="tensor_list",
+            cxx_type="std::vector<value::BaseTensorValue>",
+            cxx_normalizer="TensorTuple",
+        ),
+        Arg(name="step", cxx_type="value::BaseTensorValue"),
+        Arg(name="learning_rate", cxx_type="float"),
+        Arg(name="beta1", cxx_type="float", cxx_default="0.9", py_default="0.9"),
+        Arg(name="beta2", cxx_type="float", cxx_default="0.999", py_default="0.999"),
+        Arg(name="eps", cxx_type="float", cxx_default="1e-6", py_default="1e-6"),
+        Arg(name="weight_decay", cxx_type="float", cxx_default="0.01", py_default="0.01"),
+        Arg(name="bias_correction", cxx_type="bool", cxx_default=True),
+        Arg(name="master_weights", cxx_type="bool", cxx_default=False),
+        Arg(name="skip", cxx_type=OptionalTensor, cxx_default="nullptr", py_default="None"),
+    ],
+    "optimizer.h::multi_tensor_l2norm": [
+        Arg(
+            name="tensor_list",
+            cxx_type="std::vector<value::BaseTensorValue>",
+            cxx_normalizer="TensorTuple",
+        ),
+    ],
+    "optimizer.h::multi_tensor_clip": [
+        Arg(
+            name="tensor_list",
+            cxx_type="std::vector<value::BaseTensorValue>",
+            cxx_normalizer="TensorTuple",
+        ),
+        Arg(name="norm", cxx_type="value::BaseTensorValue"),
+        Arg(name="max_norm", cxx_type="float"),
+        Arg(name="eps", cxx_type="float", cxx_default="1e-6", py_default="1e-6"),
+    ],
+    "optimizer.h::multi_tensor_unscale": [
+        Arg(
+            name="tensor_list",
+            cxx_type="std::vector<value::BaseTensorValue>",
+            cxx_normalizer="TensorTuple",
+        ),
+        Arg(name="loss_scale", cxx_type="value::BaseTensorValue"),
+    ],
+    "optimizer.h::update_loss_scale": [
+        Arg(name="loss_scale", cxx_type="value::BaseTensorValue"),
+        Arg(name="growth_tracker", cxx_type="value::BaseTensorValue"),
+        Arg(name="found_inf", cxx_type="value::BaseTensorValue"),
+        Arg(name="growth_factor", cxx_type="float", cxx_default="2.0", py_default="2.0"),
+        Arg(name="backoff_factor", cxx_type="float", cxx_default="0.5", py_default="0.5"),
+        Arg(name="growth_interval", cxx_type="int", cxx_default=2000),
     ],
     "stream.h::stream": [
         Arg(name="x", cxx_type="value::BaseTensorValue"),
@@ -839,6 +1023,7 @@ SCHEMAS = {
             py_default="None",
         ),
         Arg(name="own", cxx_type="bool", cxx_default=True),
+        Arg(name="offset", cxx_type="int64_t", cxx_default=0),
     ],
     "vm.h::free": [
         Arg(name="memory", cxx_type="value::BaseTensorValue"),
@@ -855,6 +1040,7 @@ SCHEMAS = {
     "vm.h::set_shape": [
         Arg(name="data", cxx_type="value::BaseTensorValue"),
         Arg(name="shape", cxx_type="value::Value"),
+        Arg(name="byte_offset", cxx_type="int64_t", cxx_default=0),
     ],
     "transform.h::argwhere": [
         Arg(name="condition", cxx_type="value::BaseTensorValue"),
@@ -862,6 +1048,7 @@ SCHEMAS = {
     "stream.h::set_stream": [
         Arg(name="device_id", cxx_type="int64_t"),
         Arg(name="stream_id", cxx_type="int64_t"),
+        Arg(name="priority", cxx_type="int64_t", cxx_default=0, py_default=0),
     ],
     "stream.h::event": [
         Arg(name="event_id", cxx_type="int64_t"),
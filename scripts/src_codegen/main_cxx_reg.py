@@ -275,10 +275,12 @@ namespace regs {
 namespace imperative {
 
 #define RAF_PRELUDE(op, n_args, func, obj)                                                     \\
+  if (binding::lazy::Record(names::op, args, ret)) {                                           \\
+    return;                                                                                    \\
+  }                                                                                            \\
   const auto* opack = OpPack<names::op, n_args>::Get();                                        \\
   const auto* vpack = VarPack::Get();                                                          \\
   std::array<GradTape, n_args> prev_tapes;                                                     \\
-  std::vector<Expr> grads(opack->grads.begin(), opack->grads.end());                           \\
   Attrs _schema;                                                                               \\
   try {                                                                                        \\
     _schema = func(args, prev_tapes.data());                                                   \\
@@ -286,7 +288,14 @@ namespace imperative {
     FillError(e, "{op}", names::op);                                                           \\
   }                                                                                            \\
   Value value = InvokePrimitive(CallValues::make(opack->opv, _schema));                        \\
-  int n_tapes = grads.size();                                                                  \\
+  int n_tapes = opack->grads.size();                                                           \\
+  /* case 0: no input requires grad, which skips collecting the grads */                       \\
+  if (std::none_of(prev_tapes.begin(), prev_tapes.begin() + n_tapes,                           \\
+                   [](const GradTape& tape) { return tape.defined(); })) {                     \\
+    *ret = DeTuple(value);                                                                     \\
+    return;                                                                                    \\
+  }                                                                                            \\
+  std::vector<Expr> grads(opack->grads.begin(), opack->grads.end());                           \\
   bool full_grads = RemoveNoGrad(prev_tapes.data(), grads.data(), &n_tapes);                   \\
   /* case 1: no grad required */                                                               \\
   if (n_tapes == 0) {                                                                          \\
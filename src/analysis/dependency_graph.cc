@@ -9,6 +9,8 @@
  * Tuple, and TupleGetItem as nodes and the dependency among them as edges. It is a directed acyclic
  * graph (DAG) and can be used to analyze the expr.
  */
+#include <algorithm>
+#include <functional>
 #include "support/arena.h"
 #include "raf/analysis.h"
 #include "raf/registry.h"
@@ -63,6 +65,70 @@ size_t GetListSize(const tvm::relay::LinkedList<Node*>& list) {
   return size;
 }
 
+CompactGraph::CompactGraph(const std::vector<Node*>& post_dfs_order) : nodes_(post_dfs_order) {
+  int n = NumNodes();
+  node_ids_.reserve(n);
+  for (int i = 0; i < n; ++i) {
+    node_ids_[nodes_[i]] = i;
+  }
+  // The edges keep the orders in the linked lists, so that the walks are in the same order.
+  child_offsets_.assign(n + 1, 0);
+  parent_offsets_.assign(n + 1, 0);
+  for (int i = 0; i < n; ++i) {
+    for (auto iit = nodes_[i]->children.head; iit; iit = iit->next) {
+      int j = GetId(iit->value);
+      if (j != -1) {
+        child_ids_.push_back(j);
+      }
+    }
+    child_offsets_[i + 1] = static_cast<int>(child_ids_.size());
+    for (auto iit = nodes_[i]->parents.head; iit; iit = iit->next) {
+      int j = GetId(iit->value);
+      if (j != -1) {
+        parent_ids_.push_back(j);
+      }
+    }
+    parent_offsets_[i + 1] = static_cast<int>(parent_ids_.size());
+  }
+}
+
+int CompactGraph::GetId(const Node* node) const {
+  auto it = node_ids_.find(node);
+  return it == node_ids_.end() ? -1 : it->second;
+}
+
+std::vector<double> CompactGraph::GetCriticalPathLengths(const std::vector<double>& weights) const {
+  int n = NumNodes();
+  CHECK(weights.empty() || weights.size() == static_cast<size_t>(n))
+      << "Expected " << n << " weights, but got " << weights.size();
+  std::vector<double> lengths(n, 0.0);
+  for (int i = 0; i < n; ++i) {
+    double length = 0.0;
+    for (int j : Children(i)) {
+      CHECK_LT(j, i) << "The nodes are not in a topological order";
+      length = std::max(length, lengths[j]);
+    }
+    lengths[i] = length + (weights.empty() ? 1.0 : weights[i]);
+  }
+  return lengths;
+}
+
+std::vector<std::vector<uint64_t>> CompactGraph::GetReachability() const {
+  int n = NumNodes();
+  size_t num_words = (n + 63) / 64;
+  std::vector<std::vector<uint64_t>> reach(n, std::vector<uint64_t>(num_words, 0));
+  for (int i = 0; i < n; ++i) {
+    for (int j : Children(i)) {
+      CHECK_LT(j, i) << "The nodes are not in a topological order";
+      reach[i][j / 64] |= uint64_t(1) << (j % 64);
+      for (size_t w = 0; w < num_words; ++w) {
+        reach[i][w] |= reach[j][w];
+      }
+    }
+  }
+  return reach;
+}
+
 /*! A predicate function indicates whether a Node should be pruned. */
 using FNodePredicate = std::function<bool(const Node*)>;
 
@@ -187,45 +253,48 @@ void DependencyGraphPruneAtomicNodes(DependencyGraph* dg) {
  * only if there exists a path from u to v that does not go through the edge (u, v) directly. We
  * call the edge "redundant" because the dependency relation has been indicated by the path.
  *
- * The time complexity is O(NE), where N is the number of nodes and E is the number of edges in
- * the dependency graph, which may be slow for large complete graph. But it is efficient enough for
- * almost all neural networks.
+ * The graph is walked in the compact format. For each node, the paths from its children are
+ * searched from the latest (in topological order) child and are bounded by the earliest child.
+ * The time complexity is O(NE) in the worst case, where N is the number of nodes and E is the
+ * number of edges in the dependency graph, which may be slow for large complete graph. But the
+ * searched region is small for almost all neural networks.
  *
  * \param dg The dependency graph.
  */
 void DependencyGraphPruneRedundantEdges(DependencyGraph* dg) {
-  std::unordered_map<const Node*, std::unordered_set<const Node*>> indirect_children_map;
+  CompactGraph graph(dg->post_dfs_order);
+  int n = graph.NumNodes();
   std::vector<std::pair<Node*, Node*>> edges2remove;
 
-  std::unordered_map<const Node*, int> node_index;
-  for (const Node* node : dg->post_dfs_order) {
-    node_index[node] = int(node_index.size());
-  }
-
-  for (const Node* node : dg->post_dfs_order) {
-    for (auto iit = node->parents.head; iit; iit = iit->next) {
-      Node* parent = iit->value;
+  // The node whose children are being checked when each node was last visited.
+  std::vector<int> visited(n, -1);
+  std::vector<int> children, stack;
+  for (int v = 0; v < n; ++v) {
+    auto range = graph.Children(v);
+    if (range.size() < 2) {
+      continue;
     }
-  }
-
-  for (Node* node : dg->post_dfs_order) {
-    auto& indirect_children = indirect_children_map[node];
-    for (auto iit = node->children.head; iit; iit = iit->next) {
-      Node* child = iit->value;
-      if (indirect_children.count(child)) {
-        // There is a path from child to node that does not go through edge (child, node) directly.
-        edges2remove.emplace_back(child, node);
+    children.assign(range.begin(), range.end());
+    std::sort(children.begin(), children.end(), std::greater<int>());
+    children.erase(std::unique(children.begin(), children.end()), children.end());
+    int lower = children.back();
+    // Visit the children from the latest one. A child visited from a later one is reachable
+    // through another path. All nodes on such paths have IDs no less than the earliest child.
+    for (int c : children) {
+      if (visited[c] == v) {
+        edges2remove.emplace_back(graph.GetNode(c), graph.GetNode(v));
+        continue;
       }
-    }
-    for (auto iit = node->children.head; iit; iit = iit->next) {
-      Node* child = iit->value;
-      indirect_children.insert(child);
-    }
-    for (auto iit = node->parents.head; iit; iit = iit->next) {
-      Node* parent = iit->value;
-      auto& parent_indirect_children = indirect_children_map[parent];
-      for (const Node* indirect_child : indirect_children) {
-        parent_indirect_children.insert(indirect_child);
+      stack.push_back(c);
+      while (!stack.empty()) {
+        int u = stack.back();
+        stack.pop_back();
+        for (int w : graph.Children(u)) {
+          if (w >= lower && visited[w] != v) {
+            visited[w] = v;
+            stack.push_back(w);
+          }
+        }
       }
     }
   }
@@ -8,6 +8,9 @@
  * \brief Utilities to manipulate and analyze dependency graph
  */
 #pragma once
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
 
 namespace raf {
 namespace analysis {
@@ -54,6 +57,96 @@ size_t GetListSize(const tvm::relay::LinkedList<Node*>& node_list);
  */
 Node* CreateNewNode(Arena* arena);
 
+/*! \brief A contiguous range of node IDs. */
+class NodeIdRange {
+ public:
+  NodeIdRange(const int* begin, const int* end) : begin_(begin), end_(end) {
+  }
+  const int* begin() const {
+    return begin_;
+  }
+  const int* end() const {
+    return end_;
+  }
+  size_t size() const {
+    return end_ - begin_;
+  }
+
+ private:
+  const int* begin_;
+  const int* end_;
+};
+
+/*!
+ * \brief A compact dependency graph in the compressed sparse row (CSR) format. It is built once
+ * from the nodes of a DependencyGraph, and walking its integer arrays is much more cache friendly
+ * than walking the linked lists of the nodes, which matters for graphs with 100k+ nodes.
+ *
+ * The nodes are identified by their indices in the given post DFS order, which is a topological
+ * order: the children of a node (the nodes it depends on) always have smaller IDs than it. The
+ * compact graph is a snapshot, so it does not reflect the edges added or removed later.
+ */
+class CompactGraph {
+ public:
+  /*!
+   * \brief Create the compact graph.
+   * \param post_dfs_order The nodes in post DFS order. The edges to the nodes not in it are
+   * ignored.
+   */
+  explicit CompactGraph(const std::vector<Node*>& post_dfs_order);
+
+  /*! \brief The number of nodes. */
+  int NumNodes() const {
+    return static_cast<int>(nodes_.size());
+  }
+
+  /*! \brief Get the node of an ID. */
+  Node* GetNode(int id) const {
+    return nodes_[id];
+  }
+
+  /*! \brief Get the ID of a node, or -1 if the node is not in the graph. */
+  int GetId(const Node* node) const;
+
+  /*! \brief Get the IDs of the children of a node, i.e., the nodes it depends on. */
+  NodeIdRange Children(int id) const {
+    return NodeIdRange(child_ids_.data() + child_offsets_[id],
+                       child_ids_.data() + child_offsets_[id + 1]);
+  }
+
+  /*! \brief Get the IDs of the parents of a node, i.e., the nodes depending on it. */
+  NodeIdRange Parents(int id) const {
+    return NodeIdRange(parent_ids_.data() + parent_offsets_[id],
+                       parent_ids_.data() + parent_offsets_[id + 1]);
+  }
+
+  /*!
+   * \brief Get the length of the critical path ending at each node, i.e., the maximum total weight
+   * of the nodes on a path from a node without children to the node, inclusively.
+   * \param weights The weight of each node. All nodes weigh 1 if empty.
+   * \return The critical path length of each node.
+   */
+  std::vector<double> GetCriticalPathLengths(const std::vector<double>& weights = {}) const;
+
+  /*!
+   * \brief Get the transitive closure of the children as bitsets, where bit j of the i-th bitset
+   * is set if node i depends on node j directly or indirectly. It takes N * N / 8 bytes for N
+   * nodes, so it should only be used for subgraphs, such as the blocks of a scheduler.
+   * \return The reachability bitsets, each of which has (N + 63) / 64 words.
+   */
+  std::vector<std::vector<uint64_t>> GetReachability() const;
+
+ private:
+  /*! \brief The node of each ID. */
+  std::vector<Node*> nodes_;
+  /*! \brief The ID of each node. */
+  std::unordered_map<const Node*, int> node_ids_;
+  /*! \brief The children of node i are child_ids_[child_offsets_[i]:child_offsets_[i + 1]]. */
+  std::vector<int> child_offsets_, child_ids_;
+  /*! \brief The parents of node i are parent_ids_[parent_offsets_[i]:parent_offsets_[i + 1]]. */
+  std::vector<int> parent_offsets_, parent_ids_;
+};
+
 }  // namespace dependency_graph
 }  // namespace analysis
 }  // namespace raf
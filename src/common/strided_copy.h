@@ -0,0 +1,132 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/common/strided_copy.h
+ * \brief Utilities to copy between tensors of arbitrary strides.
+ */
+#pragma once
+#include <dlpack/dlpack.h>
+#include <dmlc/logging.h>
+#include <cstring>
+#include <vector>
+
+namespace raf {
+namespace common {
+namespace strided_copy {
+
+/*! \brief The layout of a copy between two tensors of the same shape, with strides in elements. */
+struct CopyLayout {
+  std::vector<int64_t> shape;
+  std::vector<int64_t> src_strides;
+  std::vector<int64_t> dst_strides;
+};
+
+/*! \brief Get the strides of a tensor in elements, where null strides mean a compact tensor. */
+inline std::vector<int64_t> GetStrides(const DLTensor* tensor) {
+  std::vector<int64_t> strides(tensor->ndim);
+  int64_t stride = 1;
+  for (int i = tensor->ndim - 1; i >= 0; --i) {
+    strides[i] = tensor->strides != nullptr ? tensor->strides[i] : stride;
+    stride *= tensor->shape[i];
+  }
+  return strides;
+}
+
+/*! \brief Get the compact strides of a shape. */
+inline std::vector<int64_t> GetCompactStrides(const std::vector<int64_t>& shape) {
+  std::vector<int64_t> strides(shape.size());
+  int64_t stride = 1;
+  for (int i = static_cast<int>(shape.size()) - 1; i >= 0; --i) {
+    strides[i] = stride;
+    stride *= shape[i];
+  }
+  return strides;
+}
+
+/*!
+ * \brief Get the layout of the copy from a tensor to another. The dims of size 1 are dropped, and
+ * the adjacent dims that are contiguous in both tensors are merged, so a contiguous copy has at
+ * most one dim, and a copy of a sliced matrix has two.
+ */
+inline CopyLayout GetCopyLayout(const DLTensor* from, const DLTensor* to) {
+  CHECK_EQ(from->ndim, to->ndim) << "Cannot copy between tensors of different ranks";
+  auto src_strides = GetStrides(from);
+  auto dst_strides = GetStrides(to);
+  CopyLayout layout;
+  for (int i = 0; i < from->ndim; ++i) {
+    CHECK_EQ(from->shape[i], to->shape[i]) << "Cannot copy between tensors of different shapes";
+    int64_t dim = from->shape[i];
+    if (dim == 1) {
+      continue;
+    }
+    if (!layout.shape.empty() && layout.src_strides.back() == src_strides[i] * dim &&
+        layout.dst_strides.back() == dst_strides[i] * dim) {
+      layout.shape.back() *= dim;
+      layout.src_strides.back() = src_strides[i];
+      layout.dst_strides.back() = dst_strides[i];
+    } else {
+      layout.shape.push_back(dim);
+      layout.src_strides.push_back(src_strides[i]);
+      layout.dst_strides.push_back(dst_strides[i]);
+    }
+  }
+  return layout;
+}
+
+/*! \brief Whether the copy of the layout is a contiguous copy in both tensors. */
+inline bool IsContiguousCopy(const CopyLayout& layout) {
+  return layout.shape.empty() ||
+         (layout.shape.size() == 1 && layout.src_strides[0] == 1 && layout.dst_strides[0] == 1);
+}
+
+/*! \brief Copy the elements of elem_bytes between the host buffers in the layout. */
+inline void HostStridedCopy(const char* src, char* dst, const CopyLayout& layout,
+                            int64_t elem_bytes) {
+  int ndim = layout.shape.size();
+  if (ndim == 0) {
+    std::memcpy(dst, src, elem_bytes);
+    return;
+  }
+  for (int64_t dim : layout.shape) {
+    if (dim == 0) {
+      return;
+    }
+  }
+  int64_t inner = layout.shape[ndim - 1];
+  int64_t src_inner = layout.src_strides[ndim - 1] * elem_bytes;
+  int64_t dst_inner = layout.dst_strides[ndim - 1] * elem_bytes;
+  std::vector<int64_t> index(ndim - 1, 0);
+  while (true) {
+    int64_t src_offset = 0, dst_offset = 0;
+    for (int i = 0; i < ndim - 1; ++i) {
+      src_offset += index[i] * layout.src_strides[i];
+      dst_offset += index[i] * layout.dst_strides[i];
+    }
+    const char* s = src + src_offset * elem_bytes;
+    char* d = dst + dst_offset * elem_bytes;
+    if (src_inner == elem_bytes && dst_inner == elem_bytes) {
+      std::memcpy(d, s, inner * elem_bytes);
+    } else {
+      for (int64_t j = 0; j < inner; ++j) {
+        std::memcpy(d + j * dst_inner, s + j * src_inner, elem_bytes);
+      }
+    }
+    int i = ndim - 2;
+    for (; i >= 0; --i) {
+      if (++index[i] < layout.shape[i]) {
+        break;
+      }
+      index[i] = 0;
+    }
+    if (i < 0) {
+      break;
+    }
+  }
+}
+
+}  // namespace strided_copy
+}  // namespace common
+}  // namespace raf
@@ -10,11 +10,14 @@
 #include <thread>
 #include "raf/device_api.h"
 #include "raf/registry.h"
+#include "../../common/strided_copy.h"
 
 namespace raf {
 namespace device_api {
 namespace cpu {
 
+namespace strided_copy = raf::common::strided_copy;
+
 class CPUDeviceAPI final : public DeviceAPI {
  public:
   CPUDeviceAPI() = default;
@@ -63,11 +66,18 @@ class CPUDeviceAPI final : public DeviceAPI {
   void CopyDataFromTo(DLTensor* from, DLTensor* to, void* stream) {
     size_t nbytes = tvm::runtime::GetDataSize(*from);
     ICHECK_EQ(nbytes, tvm::runtime::GetDataSize(*to));
-    ICHECK(tvm::runtime::IsContiguous(*from) && tvm::runtime::IsContiguous(*to))
-        << "CopyDataFromTo only support contiguous array for now";
-
     auto from_data_ptr = static_cast<const char*>(from->data) + from->byte_offset;
     auto to_data_ptr = static_cast<char*>(to->data) + to->byte_offset;
+    if (!tvm::runtime::IsContiguous(*from) || !tvm::runtime::IsContiguous(*to)) {
+      auto layout = strided_copy::GetCopyLayout(from, to);
+      if (!strided_copy::IsContiguousCopy(layout)) {
+        if (nbytes > 0) {
+          int64_t elem_bytes = (from->dtype.bits * from->dtype.lanes + 7) / 8;
+          strided_copy::HostStridedCopy(from_data_ptr, to_data_ptr, layout, elem_bytes);
+        }
+        return;
+      }
+    }
     memcpy(to_data_ptr, from_data_ptr, nbytes);
   }
 
@@ -7,21 +7,29 @@
  * \file src/device_api/cuda/cuda.cc
  * \brief CUDA device API
  */
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
 #include <tvm/runtime/device_api.h>
 #include "raf/op.h"
 #include "raf/device_api.h"
 #include "raf/registry.h"
 #include "raf/profiler.h"
+#include "raf/memory_pool.h"
 #include "../../common/cuda_utils.h"
+#include "../../common/strided_copy.h"
 
 #include "../../op/dialect/cudnn/cudnn_utils.h"
 #include "../../op/dialect/cublas/cublas_utils.h"
 #include "../../op/dialect/cutlass/cutlass_utils.h"
+#include "../../op/dialect/cuda/kernels/kernel_util.cuh"
 
 namespace raf {
 namespace device_api {
 namespace cuda {
 
+namespace strided_copy = raf::common::strided_copy;
+
 class CUDADeviceAPI final : public DeviceAPI {
  public:
   CUDADeviceAPI() = default;
@@ -73,7 +81,19 @@ class CUDADeviceAPI final : public DeviceAPI {
 
   void* AllocMemoryAsync(int64_t nbytes, void* stream,
                          int64_t alignment = kDefaultMemoryAlignment) {
-    static auto cuda_pool = GetCUDAMemoryPool(device_id_);
+    // The allocation is on the current device, which is not always the last one set by a pool
+    // when there are multiple GPUs in the process.
+    int dev_id = 0;
+    CUDA_CALL(cudaGetDevice(&dev_id));
+    cudaMemPool_t cuda_pool = nullptr;
+    {
+      std::lock_guard<std::mutex> lock(mem_pools_mu_);
+      auto it = mem_pools_.find(dev_id);
+      if (it == mem_pools_.end()) {
+        it = mem_pools_.emplace(dev_id, GetCUDAMemoryPool(dev_id)).first;
+      }
+      cuda_pool = it->second;
+    }
     void* ptr = nullptr;
 
     // TODO(@junrushao1994): make sure it is correct
@@ -112,46 +132,25 @@ class CUDADeviceAPI final : public DeviceAPI {
   void CopyDataFromTo(DLTensor* from, DLTensor* to, void* stream) final {
     size_t nbytes = tvm::runtime::GetDataSize(*from);
     ICHECK_EQ(nbytes, tvm::runtime::GetDataSize(*to));
-    ICHECK(tvm::runtime::IsContiguous(*from) && tvm::runtime::IsContiguous(*to))
-        << "CopyDataFromTo only support contiguous array for now";
 
     cudaStream_t cu_stream = static_cast<cudaStream_t>(stream);
     auto from_data_ptr = static_cast<const char*>(from->data) + from->byte_offset;
     auto to_data_ptr = static_cast<char*>(to->data) + to->byte_offset;
 
-    auto from_dev_type =
-        (from->device.device_type == kDLCUDAHost) ? kDLCPU : from->device.device_type;
-    auto to_dev_type = (to->device.device_type == kDLCUDAHost) ? kDLCPU : to->device.device_type;
-
-    // In case there is a copy from host memory to host memory.
-    if (to_dev_type == kDLCPU && from_dev_type == kDLCPU) {
-      memcpy(to_data_ptr, from_data_ptr, nbytes);
-      return;
-    }
-
-    auto curr_device_id = device_id_;
-    if (from_dev_type == kDLCUDA && to_dev_type == kDLCUDA) {
-      // GPU to another GPU.
-      SetDevice(from->device.device_id);
-      if (from->device.device_id == to->device.device_id) {
-        HandleCopy(from_data_ptr, to_data_ptr, nbytes, cudaMemcpyDeviceToDevice, cu_stream);
-      } else {
-        cudaMemcpyPeerAsync(to_data_ptr, to->device.device_id, from_data_ptr,
-                            from->device.device_id, nbytes, cu_stream);
+    if (!tvm::runtime::IsContiguous(*from) || !tvm::runtime::IsContiguous(*to)) {
+      // Strided views (e.g., the slices of framework tensors) are copied directly, rather than
+      // being materialized by the caller first.
+      auto layout = strided_copy::GetCopyLayout(from, to);
+      if (!strided_copy::IsContiguousCopy(layout)) {
+        if (nbytes > 0) {
+          int64_t elem_bytes = (from->dtype.bits * from->dtype.lanes + 7) / 8;
+          CopyStrided(from_data_ptr, from->device, to_data_ptr, to->device, layout, elem_bytes,
+                      cu_stream);
+        }
+        return;
       }
-    } else if (from_dev_type == kDLCUDA && to_dev_type == kDLCPU) {
-      // GPU to CPU.
-      SetDevice(from->device.device_id);
-      HandleCopy(from_data_ptr, to_data_ptr, nbytes, cudaMemcpyDeviceToHost, cu_stream);
-    } else if (from_dev_type == kDLCPU && to_dev_type == kDLCUDA) {
-      // CPU to GPU.
-      SetDevice(to->device.device_id);
-      HandleCopy(from_data_ptr, to_data_ptr, nbytes, cudaMemcpyHostToDevice, cu_stream);
-    } else {
-      LOG(FATAL) << "expect copy from/to GPU or between GPU";
     }
-
-    SetDevice(curr_device_id);
+    CopyBytes(from_data_ptr, from->device, to_data_ptr, to->device, nbytes, cu_stream);
   }
 
   void* CreateStream(const Device& dev) override {
@@ -162,6 +161,19 @@ class CUDADeviceAPI final : public DeviceAPI {
     return ret;
   }
 
+  void* CreateStreamWithPriority(const Device& dev, int priority) override {
+    CHECK_EQ(dev.device_type(), DevType::kCUDA());
+    CUDA_CALL(cudaSetDevice(dev.device_id()));
+    // CUDA stream priorities are in [greatest, least], where lower numbers mean higher priorities
+    // and the least priority is the default one.
+    int least = 0, greatest = 0;
+    CUDA_CALL(cudaDeviceGetStreamPriorityRange(&least, &greatest));
+    int cuda_priority = std::max(greatest, std::min(least, least - priority));
+    cudaStream_t ret = nullptr;
+    CUDA_CALL(cudaStreamCreateWithPriority(&ret, cudaStreamDefault, cuda_priority));
+    return ret;
+  }
+
   void FreeStream(const Device& dev, void* stream) override {
     CHECK_EQ(dev.device_type(), DevType::kCUDA());
     CUDA_CALL(cudaSetDevice(dev.device_id()));
@@ -227,11 +239,194 @@ class CUDADeviceAPI final : public DeviceAPI {
     CUDA_CALL(cudaEventSynchronize(static_cast<cudaEvent_t>(event)));
   }
 
+  void LaunchHostFunc(void* stream, void (*func)(void*), void* data) override {
+    CUDA_CALL(cudaLaunchHostFunc(static_cast<cudaStream_t>(stream), func, data));
+  }
+
   static void* make() {
     return new CUDADeviceAPI();
   }
 
  private:
+  static DLDeviceType GetCopyDeviceType(const DLDevice& dev) {
+    return dev.device_type == kDLCUDAHost ? kDLCPU : dev.device_type;
+  }
+
+  /*! \brief Copy the contiguous bytes between the devices. */
+  void CopyBytes(const char* from_data_ptr, const DLDevice& from, char* to_data_ptr,
+                 const DLDevice& to, size_t nbytes, cudaStream_t cu_stream) {
+    auto from_dev_type = GetCopyDeviceType(from);
+    auto to_dev_type = GetCopyDeviceType(to);
+
+    // In case there is a copy from host memory to host memory.
+    if (to_dev_type == kDLCPU && from_dev_type == kDLCPU) {
+      memcpy(to_data_ptr, from_data_ptr, nbytes);
+      return;
+    }
+
+    auto curr_device_id = device_id_;
+    if (from_dev_type == kDLCUDA && to_dev_type == kDLCUDA) {
+      // GPU to another GPU.
+      SetDevice(from.device_id);
+      if (from.device_id == to.device_id) {
+        HandleCopy(from_data_ptr, to_data_ptr, nbytes, cudaMemcpyDeviceToDevice, cu_stream);
+      } else {
+        cudaMemcpyPeerAsync(to_data_ptr, to.device_id, from_data_ptr, from.device_id, nbytes,
+                            cu_stream);
+      }
+    } else if (from_dev_type == kDLCUDA && to_dev_type == kDLCPU) {
+      // GPU to CPU.
+      SetDevice(from.device_id);
+      HandleCopy(from_data_ptr, to_data_ptr, nbytes, cudaMemcpyDeviceToHost, cu_stream);
+    } else if (from_dev_type == kDLCPU && to_dev_type == kDLCUDA) {
+      // CPU to GPU.
+      SetDevice(to.device_id);
+      HandleCopy(from_data_ptr, to_data_ptr, nbytes, cudaMemcpyHostToDevice, cu_stream);
+    } else {
+      LOG(FATAL) << "expect copy from/to GPU or between GPU";
+    }
+
+    SetDevice(curr_device_id);
+  }
+
+  /*!
+   * \brief Copy between strided tensors. The copies of up to 3 dims whose innermost dim is
+   * contiguous in both tensors (e.g., sliced matrices) are done by cudaMemcpy2D/3D. Otherwise,
+   * the strided sides are gathered to or scattered from compact staging buffers, by a kernel on
+   * the device or by the CPU on the host.
+   */
+  void CopyStrided(const char* from_data_ptr, const DLDevice& from, char* to_data_ptr,
+                   const DLDevice& to, const strided_copy::CopyLayout& layout, int64_t elem_bytes,
+                   cudaStream_t cu_stream) {
+    auto from_dev_type = GetCopyDeviceType(from);
+    auto to_dev_type = GetCopyDeviceType(to);
+    if (from_dev_type == kDLCPU && to_dev_type == kDLCPU) {
+      strided_copy::HostStridedCopy(from_data_ptr, to_data_ptr, layout, elem_bytes);
+      return;
+    }
+    auto curr_device_id = device_id_;
+    bool same_device = from_dev_type != kDLCUDA || to_dev_type != kDLCUDA ||
+                       from.device_id == to.device_id;
+    if (same_device) {
+      SetDevice(from_dev_type == kDLCUDA ? from.device_id : to.device_id);
+      cudaMemcpyKind kind = from_dev_type == kDLCPU   ? cudaMemcpyHostToDevice
+                            : to_dev_type == kDLCPU ? cudaMemcpyDeviceToHost
+                                                    : cudaMemcpyDeviceToDevice;
+      bool copied = CopyPitched(from_data_ptr, to_data_ptr, layout, elem_bytes, kind, cu_stream);
+      if (!copied && kind == cudaMemcpyDeviceToDevice) {
+        op::cuda::strided_copy_cuda(from_data_ptr, to_data_ptr, layout.shape, layout.src_strides,
+                                    layout.dst_strides, elem_bytes, cu_stream);
+        copied = true;
+      }
+      if (copied) {
+        SetDevice(curr_device_id);
+        return;
+      }
+    }
+
+    int64_t nbytes = elem_bytes;
+    for (int64_t dim : layout.shape) {
+      nbytes *= dim;
+    }
+    auto compact = strided_copy::GetCompactStrides(layout.shape);
+    // Gather the source to a compact buffer on its own device.
+    std::shared_ptr<memory_pool::Memory> src_buf, dst_buf;
+    std::vector<char> host_src, host_dst;
+    const char* src = from_data_ptr;
+    if (layout.src_strides != compact) {
+      strided_copy::CopyLayout pack{layout.shape, layout.src_strides, compact};
+      if (from_dev_type == kDLCUDA) {
+        SetDevice(from.device_id);
+        src_buf = memory_pool::Memory::Alloc(Device(DevType::kCUDA(), from.device_id), nbytes);
+        op::cuda::strided_copy_cuda(from_data_ptr, src_buf->data, pack.shape, pack.src_strides,
+                                    pack.dst_strides, elem_bytes, cu_stream);
+        src = static_cast<const char*>(src_buf->data);
+      } else {
+        host_src.resize(nbytes);
+        strided_copy::HostStridedCopy(from_data_ptr, host_src.data(), pack, elem_bytes);
+        src = host_src.data();
+      }
+    }
+    char* dst = to_data_ptr;
+    if (layout.dst_strides != compact) {
+      if (to_dev_type == kDLCUDA) {
+        dst_buf = memory_pool::Memory::Alloc(Device(DevType::kCUDA(), to.device_id), nbytes);
+        dst = static_cast<char*>(dst_buf->data);
+      } else {
+        host_dst.resize(nbytes);
+        dst = host_dst.data();
+      }
+    }
+    CopyBytes(src, from, dst, to, nbytes, cu_stream);
+    // Scatter the compact buffer to the destination.
+    if (layout.dst_strides != compact) {
+      strided_copy::CopyLayout unpack{layout.shape, compact, layout.dst_strides};
+      if (to_dev_type == kDLCUDA) {
+        SetDevice(to.device_id);
+        op::cuda::strided_copy_cuda(dst, to_data_ptr, unpack.shape, unpack.src_strides,
+                                    unpack.dst_strides, elem_bytes, cu_stream);
+      } else {
+        CUDA_CALL(cudaStreamSynchronize(cu_stream));
+        strided_copy::HostStridedCopy(dst, to_data_ptr, unpack, elem_bytes);
+      }
+    }
+    // The staging buffers are released on return, so the copy has to be finished by then.
+    CUDA_CALL(cudaStreamSynchronize(cu_stream));
+    SetDevice(curr_device_id);
+  }
+
+  /*!
+   * \brief Copy the layout of up to 3 dims whose innermost dim is contiguous in both tensors by
+   * cudaMemcpy2DAsync/3DAsync, which also work on the pageable host memory.
+   * \return Whether the layout is copied.
+   */
+  static bool CopyPitched(const char* src, char* dst, const strided_copy::CopyLayout& layout,
+                          int64_t elem_bytes, cudaMemcpyKind kind, cudaStream_t cu_stream) {
+    int ndim = layout.shape.size();
+    if (ndim < 2 || ndim > 3 || layout.src_strides[ndim - 1] != 1 ||
+        layout.dst_strides[ndim - 1] != 1) {
+      return false;
+    }
+    int64_t width = layout.shape[ndim - 1];
+    int64_t height = layout.shape[ndim - 2];
+    int64_t src_pitch = layout.src_strides[ndim - 2];
+    int64_t dst_pitch = layout.dst_strides[ndim - 2];
+    // The rows must not overlap.
+    if (src_pitch < width || dst_pitch < width) {
+      return false;
+    }
+    if (ndim == 2) {
+      CUDA_CALL(cudaMemcpy2DAsync(dst, dst_pitch * elem_bytes, src, src_pitch * elem_bytes,
+                                  width * elem_bytes, height, kind, cu_stream));
+      return true;
+    }
+    // A 3D copy requires the slices to be whole multiples of the rows; otherwise the slices are
+    // copied one by one.
+    int64_t src_slice = layout.src_strides[0];
+    int64_t dst_slice = layout.dst_strides[0];
+    if (src_slice % src_pitch == 0 && dst_slice % dst_pitch == 0 &&
+        src_slice / src_pitch >= height && dst_slice / dst_pitch >= height) {
+      cudaMemcpy3DParms params = {0};
+      params.srcPtr = make_cudaPitchedPtr(const_cast<char*>(src), src_pitch * elem_bytes,
+                                          width * elem_bytes, src_slice / src_pitch);
+      params.dstPtr = make_cudaPitchedPtr(dst, dst_pitch * elem_bytes, width * elem_bytes,
+                                          dst_slice / dst_pitch);
+      params.extent = make_cudaExtent(width * elem_bytes, height, layout.shape[0]);
+      params.kind = kind;
+      CUDA_CALL(cudaMemcpy3DAsync(&params, cu_stream));
+      return true;
+    }
+    if (src_slice < src_pitch * height || dst_slice < dst_pitch * height) {
+      return false;
+    }
+    for (int64_t i = 0; i < layout.shape[0]; ++i) {
+      CUDA_CALL(cudaMemcpy2DAsync(dst + i * dst_slice * elem_bytes, dst_pitch * elem_bytes,
+                                  src + i * src_slice * elem_bytes, src_pitch * elem_bytes,
+                                  width * elem_bytes, height, kind, cu_stream));
+    }
+    return true;
+  }
+
   static void HandleCopy(const void* from, void* to, size_t size, cudaMemcpyKind kind,
                          cudaStream_t cu_stream) {
     if (cu_stream != nullptr) {
@@ -246,6 +441,11 @@ class CUDADeviceAPI final : public DeviceAPI {
   int device_id_;
   // using cuda default stream if stream is not set explicitly
   void* stream_ = nullptr;
+#if CUDA_VERSION >= 11030
+  // The default memory pools of the devices for the asynchronous allocations
+  std::unordered_map<int, cudaMemPool_t> mem_pools_;
+  std::mutex mem_pools_mu_;
+#endif
 };
 
 RAF_REGISTER_GLOBAL("raf.device_api._make.cuda").set_body_typed(CUDADeviceAPI::make);
@@ -7,6 +7,7 @@
  * \file src/distributed/context.cc
  * \brief Context of Distributed Settings.
  */
+#include <algorithm>
 #include "raf/registry.h"
 #include "raf/communicator.h"
 #include "raf/dist_context.h"
@@ -26,8 +27,13 @@ DistContext DistContext::make() {
   n->size = comm->size;
   n->local_rank = comm->local_rank;
   n->local_size = comm->local_size;
-
-  return DistContext(n);
+  DistContext ctx(n);
+  // The topology is probed by the communication backend if any.
+  static const auto* probe = registry::Registry::Get("raf.distributed.ProbeTopology");
+  if (probe != nullptr && n->size > 1) {
+    (*probe)(ctx);
+  }
+  return ctx;
 }
 
 DistContext DistContext::Global() {
@@ -35,14 +41,73 @@ DistContext DistContext::Global() {
   return inst;
 }
 
+bool PreferHierarchicalAllReduce(int64_t bytes) {
+  // bytes / (GB/s) = 1e-3 us
+  constexpr double kStepLatencyUs = 5.0;
+  auto dctx = DistContext::Global();
+  double nodes = dctx->num_nodes, local = dctx->local_size;
+  double intra_bandwidth = 0;
+  for (const auto& bandwidth : dctx->peer_bandwidth) {
+    if (bandwidth->value > 0) {
+      intra_bandwidth = intra_bandwidth > 0 ? std::min(intra_bandwidth, bandwidth->value)
+                                            : bandwidth->value;
+    }
+  }
+  if (nodes < 2 || local < 2 || intra_bandwidth <= 0 || dctx->inter_node_bandwidth <= 0) {
+    return false;
+  }
+  double size = nodes * local;
+  double flat = 2 * (size - 1) * kStepLatencyUs +
+                2 * (size - 1) / size * bytes / dctx->inter_node_bandwidth * 1e-3;
+  double hier = 2 * (local - 1) * kStepLatencyUs +
+                2 * (local - 1) / local * bytes / intra_bandwidth * 1e-3 +
+                2 * (nodes - 1) * kStepLatencyUs +
+                2 * (nodes - 1) / nodes * bytes / local / dctx->inter_node_bandwidth * 1e-3;
+  return hier < flat;
+}
+
 void EnableDataParallel(bool enable) {
   DistContext::Global()->enable_data_parallel = enable;
 }
 
+void EnableHierarchicalAllReduce(bool enable) {
+  DistContext::Global()->enable_hierarchical_allreduce = enable;
+}
+
+void SetAllReduceCompression(std::string compression) {
+  CHECK(compression == "none" || compression == "fp16" || compression == "bf16" ||
+        compression == "topk")
+      << "Unknown allreduce compression " << compression
+      << ", candidates are none, fp16, bf16, and topk";
+  DistContext::Global()->allreduce_compression = compression;
+}
+
+void SetAllReduceTopKRatio(double topk_ratio) {
+  CHECK(topk_ratio > 0 && topk_ratio <= 1) << "Invalid top-k ratio " << topk_ratio;
+  DistContext::Global()->allreduce_topk_ratio = topk_ratio;
+}
+
+void SetAllReduceFP32Accumulate(bool enable) {
+  DistContext::Global()->allreduce_fp32_accumulate = enable;
+}
+
+void AutoSelectAllReduce(bool enable) {
+  DistContext::Global()->auto_select_allreduce = enable;
+}
+
 void ZeroOpt(int opt_level) {
   DistContext::Global()->zero_opt_level = opt_level;
 }
 
+void SetLocalSGDPeriod(int period) {
+  CHECK_GE(period, 1) << "Invalid local SGD period " << period;
+  DistContext::Global()->local_sgd_period = period;
+}
+
+void SetLocalSGDAverageMomentum(bool enable) {
+  DistContext::Global()->local_sgd_average_momentum = enable;
+}
+
 void SetGlobalRank(int rank) {
   CHECK(Communicator::Get()->IsInstance<communicator::VoidCommunicatorObj>())
       << "Only VoidCommunicator is mutable";
@@ -68,7 +133,20 @@ void AutoDPProfilingEndIter(int auto_dp_profiling_end_iter) {
 RAF_REGISTER_GLOBAL("raf.distributed._make.DistContext").set_body_typed(DistContext::make);
 RAF_REGISTER_GLOBAL("raf.distributed.Global").set_body_typed(DistContext::Global);
 RAF_REGISTER_GLOBAL("raf.distributed.EnableDataParallel").set_body_typed(EnableDataParallel);
+RAF_REGISTER_GLOBAL("raf.distributed.EnableHierarchicalAllReduce")
+    .set_body_typed(EnableHierarchicalAllReduce);
+RAF_REGISTER_GLOBAL("raf.distributed.SetAllReduceCompression")
+    .set_body_typed(SetAllReduceCompression);
+RAF_REGISTER_GLOBAL("raf.distributed.SetAllReduceTopKRatio").set_body_typed(SetAllReduceTopKRatio);
+RAF_REGISTER_GLOBAL("raf.distributed.SetAllReduceFP32Accumulate")
+    .set_body_typed(SetAllReduceFP32Accumulate);
+RAF_REGISTER_GLOBAL("raf.distributed.AutoSelectAllReduce").set_body_typed(AutoSelectAllReduce);
+RAF_REGISTER_GLOBAL("raf.distributed.PreferHierarchicalAllReduce")
+    .set_body_typed(PreferHierarchicalAllReduce);
 RAF_REGISTER_GLOBAL("raf.distributed.ZeroOpt").set_body_typed(ZeroOpt);
+RAF_REGISTER_GLOBAL("raf.distributed.SetLocalSGDPeriod").set_body_typed(SetLocalSGDPeriod);
+RAF_REGISTER_GLOBAL("raf.distributed.SetLocalSGDAverageMomentum")
+    .set_body_typed(SetLocalSGDAverageMomentum);
 RAF_REGISTER_GLOBAL("raf.distributed.SetGlobalRank").set_body_typed(SetGlobalRank);
 RAF_REGISTER_GLOBAL("raf.distributed.SetGlobalSize").set_body_typed(SetGlobalSize);
 RAF_REGISTER_GLOBAL("raf.distributed.AutoDPProfilingStartIter")
@@ -0,0 +1,352 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/distributed/common/rendezvous.cc
+ * \brief Implementation of the rendezvous stores and StoreCommunicator.
+ */
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+#include "raf/rendezvous.h"
+
+namespace raf {
+namespace distributed {
+namespace communicator {
+
+namespace {
+
+/*! \brief The interval to poll a file or to retry a connection. */
+constexpr std::chrono::milliseconds kPollInterval(10);
+
+int GetEnvInt(const char* name) {
+  const char* value = getenv(name);
+  CHECK(value != nullptr) << name << " is not set, which is required by RAF_RENDEZVOUS";
+  return atoi(value);
+}
+
+/*! \brief Send size bytes, or return false if the connection is closed. */
+bool SendAll(int fd, const void* data, size_t size) {
+  const char* ptr = static_cast<const char*>(data);
+  while (size > 0) {
+    ssize_t n = send(fd, ptr, size, MSG_NOSIGNAL);
+    if (n <= 0) {
+      return false;
+    }
+    ptr += n;
+    size -= n;
+  }
+  return true;
+}
+
+/*! \brief Receive size bytes, or return false if the connection is closed or timed out. */
+bool RecvAll(int fd, void* data, size_t size) {
+  char* ptr = static_cast<char*>(data);
+  while (size > 0) {
+    ssize_t n = recv(fd, ptr, size, 0);
+    if (n <= 0) {
+      return false;
+    }
+    ptr += n;
+    size -= n;
+  }
+  return true;
+}
+
+bool SendString(int fd, const std::string& str) {
+  uint32_t size = str.size();
+  return SendAll(fd, &size, sizeof(size)) && SendAll(fd, str.data(), size);
+}
+
+bool RecvString(int fd, std::string* str) {
+  uint32_t size;
+  if (!RecvAll(fd, &size, sizeof(size))) {
+    return false;
+  }
+  str->resize(size);
+  return RecvAll(fd, &(*str)[0], size);
+}
+
+/*! \brief The requests of TCPStore, each followed by the key, and the value for kSet. */
+enum TCPStoreCommand : uint8_t { kSet = 0, kGet = 1 };
+
+}  // namespace
+
+std::vector<std::string> Store::AllGather(const std::string& prefix, int rank, int size,
+                                          const std::string& value) {
+  Set(prefix + "/" + std::to_string(rank), value);
+  std::vector<std::string> values(size);
+  for (int i = 0; i < size; ++i) {
+    values[i] = i == rank ? value : Get(prefix + "/" + std::to_string(i));
+  }
+  return values;
+}
+
+std::shared_ptr<Store> Store::Global() {
+  static std::shared_ptr<Store> store = []() -> std::shared_ptr<Store> {
+    const char* url = getenv("RAF_RENDEZVOUS");
+    if (url == nullptr) {
+      return nullptr;
+    }
+    const char* timeout_env = getenv("RAF_RENDEZVOUS_TIMEOUT");
+    std::chrono::milliseconds timeout(std::chrono::seconds(timeout_env ? atoi(timeout_env) : 300));
+    std::string addr(url);
+    if (addr.compare(0, 7, "file://") == 0) {
+      return std::make_shared<FileStore>(addr.substr(7), timeout);
+    }
+    CHECK_EQ(addr.compare(0, 6, "tcp://"), 0)
+        << "Expected RAF_RENDEZVOUS to be tcp://host:port or file:///path, but got " << addr;
+    addr = addr.substr(6);
+    auto pos = addr.rfind(':');
+    CHECK(pos != std::string::npos) << "The port of RAF_RENDEZVOUS is missing: " << url;
+    return std::make_shared<TCPStore>(addr.substr(0, pos), std::stoi(addr.substr(pos + 1)),
+                                      GetEnvInt("RANK") == 0, timeout);
+  }();
+  return store;
+}
+
+FileStore::FileStore(std::string path, std::chrono::milliseconds timeout)
+    : path_(std::move(path)), timeout_(timeout) {
+  mkdir(path_.c_str(), 0755);
+  struct stat st;
+  CHECK(stat(path_.c_str(), &st) == 0 && S_ISDIR(st.st_mode))
+      << "Cannot create the rendezvous directory " << path_;
+}
+
+std::string FileStore::KeyPath(const std::string& key) const {
+  std::string name = key;
+  std::replace(name.begin(), name.end(), '/', '.');
+  return path_ + "/" + name;
+}
+
+void FileStore::Set(const std::string& key, const std::string& value) {
+  std::string path = KeyPath(key);
+  // The file is renamed after it is written, so the readers never see a partial value.
+  std::string tmp_path = path + ".tmp" + std::to_string(getpid());
+  {
+    std::ofstream ofs(tmp_path, std::ios::binary);
+    ofs.write(value.data(), value.size());
+    CHECK(ofs.good()) << "Failed to write " << tmp_path;
+  }
+  CHECK_EQ(rename(tmp_path.c_str(), path.c_str()), 0)
+      << "Failed to rename " << tmp_path << ": " << strerror(errno);
+}
+
+std::string FileStore::Get(const std::string& key) {
+  std::string path = KeyPath(key);
+  auto deadline = std::chrono::steady_clock::now() + timeout_;
+  while (true) {
+    std::ifstream ifs(path, std::ios::binary);
+    if (ifs.good()) {
+      std::stringstream ss;
+      ss << ifs.rdbuf();
+      return ss.str();
+    }
+    CHECK(std::chrono::steady_clock::now() < deadline)
+        << "Timed out waiting for " << key << " in the rendezvous directory " << path_;
+    std::this_thread::sleep_for(kPollInterval);
+  }
+}
+
+class TCPStore::Server {
+ public:
+  explicit Server(int port) : state_(std::make_shared<State>()) {
+    listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    CHECK_GE(listen_fd_, 0) << "Failed to create the socket: " << strerror(errno);
+    int on = 1;
+    setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    CHECK_EQ(bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)), 0)
+        << "Failed to bind the rendezvous port " << port << ": " << strerror(errno);
+    CHECK_EQ(listen(listen_fd_, SOMAXCONN), 0) << "Failed to listen: " << strerror(errno);
+    std::thread(&Server::Accept, listen_fd_, state_).detach();
+  }
+
+  ~Server() {
+    {
+      std::lock_guard<std::mutex> lock(state_->mu);
+      state_->stopped = true;
+    }
+    state_->cv.notify_all();
+    shutdown(listen_fd_, SHUT_RDWR);
+    close(listen_fd_);
+  }
+
+ private:
+  /*! \brief The state shared with the threads, which may outlive the server. */
+  struct State {
+    std::mutex mu;
+    std::condition_variable cv;
+    std::unordered_map<std::string, std::string> kv;
+    bool stopped = false;
+  };
+
+  static void Accept(int listen_fd, std::shared_ptr<State> state) {
+    while (true) {
+      int fd = accept(listen_fd, nullptr, nullptr);
+      if (fd < 0) {
+        // The listening socket is closed.
+        return;
+      }
+      std::thread(&Server::Serve, fd, state).detach();
+    }
+  }
+
+  static void Serve(int fd, std::shared_ptr<State> state) {
+    uint8_t cmd;
+    std::string key, value;
+    while (RecvAll(fd, &cmd, sizeof(cmd)) && RecvString(fd, &key)) {
+      if (cmd == kSet) {
+        if (!RecvString(fd, &value)) {
+          break;
+        }
+        {
+          std::lock_guard<std::mutex> lock(state->mu);
+          state->kv[key] = value;
+        }
+        state->cv.notify_all();
+        if (!SendAll(fd, &cmd, sizeof(cmd))) {
+          break;
+        }
+      } else {
+        std::unique_lock<std::mutex> lock(state->mu);
+        state->cv.wait(lock, [&]() { return state->stopped || state->kv.count(key); });
+        if (state->stopped) {
+          break;
+        }
+        value = state->kv.at(key);
+        lock.unlock();
+        if (!SendString(fd, value)) {
+          break;
+        }
+      }
+    }
+    close(fd);
+  }
+
+  int listen_fd_;
+  std::shared_ptr<State> state_;
+};
+
+TCPStore::TCPStore(const std::string& host, int port, bool is_server,
+                   std::chrono::milliseconds timeout) {
+  if (is_server) {
+    server_ = std::make_unique<Server>(port);
+  }
+  addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  auto deadline = std::chrono::steady_clock::now() + timeout;
+  // The server may not be listening yet, so the connection is retried until the timeout.
+  while (socket_ < 0) {
+    addrinfo* addrs = nullptr;
+    if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &addrs) == 0) {
+      for (addrinfo* addr = addrs; addr != nullptr && socket_ < 0; addr = addr->ai_next) {
+        int fd = socket(addr->ai_family, addr->ai_socktype, addr->ai_protocol);
+        if (fd >= 0 && connect(fd, addr->ai_addr, addr->ai_addrlen) == 0) {
+          socket_ = fd;
+        } else if (fd >= 0) {
+          close(fd);
+        }
+      }
+      freeaddrinfo(addrs);
+    }
+    if (socket_ < 0) {
+      CHECK(std::chrono::steady_clock::now() < deadline)
+          << "Timed out connecting to the rendezvous store " << host << ":" << port;
+      std::this_thread::sleep_for(kPollInterval);
+    }
+  }
+  int on = 1;
+  setsockopt(socket_, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+  // A Get waits for the key on the server, so the timeout is enforced by the receive.
+  timeval tv;
+  tv.tv_sec = timeout.count() / 1000;
+  tv.tv_usec = timeout.count() % 1000 * 1000;
+  setsockopt(socket_, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+}
+
+TCPStore::~TCPStore() {
+  if (socket_ >= 0) {
+    close(socket_);
+  }
+}
+
+void TCPStore::Set(const std::string& key, const std::string& value) {
+  std::lock_guard<std::mutex> lock(mu_);
+  uint8_t cmd = kSet;
+  bool sent = SendAll(socket_, &cmd, sizeof(cmd)) && SendString(socket_, key) &&
+              SendString(socket_, value);
+  CHECK(sent && RecvAll(socket_, &cmd, sizeof(cmd))) << "Failed to set " << key << " in the store";
+}
+
+std::string TCPStore::Get(const std::string& key) {
+  std::lock_guard<std::mutex> lock(mu_);
+  uint8_t cmd = kGet;
+  CHECK(SendAll(socket_, &cmd, sizeof(cmd)) && SendString(socket_, key))
+      << "Failed to get " << key << " from the store";
+  std::string value;
+  CHECK(RecvString(socket_, &value)) << "Timed out waiting for " << key << " in the store";
+  return value;
+}
+
+StoreCommunicator StoreCommunicator::make(Value rank_list) {
+  CHECK(!rank_list.defined()) << "StoreCommunicator doesn't support creating sub-communicators.";
+  auto obj = make_object<StoreCommunicatorObj>();
+  obj->store = Store::Global();
+  CHECK(obj->store) << "RAF_RENDEZVOUS is not set";
+  int rank = GetEnvInt("RANK");
+  int size = GetEnvInt("WORLD_SIZE");
+  CHECK(rank >= 0 && rank < size) << "Invalid RANK " << rank << " of WORLD_SIZE " << size;
+
+  // Allgather the hostIDs of nodes.
+  auto host_ids = obj->store->AllGather("host_id", rank, size, std::to_string(GetHostID()));
+  for (const auto& host_id : host_ids) {
+    obj->host_ids.push_back(std::stoull(host_id));
+  }
+  int local_rank = 0, local_size = 0;
+  for (int p = 0; p < size; ++p) {
+    if (obj->host_ids[p] == obj->host_ids[rank]) {
+      local_rank += p < rank;
+      local_size++;
+    }
+  }
+  obj->local_size = local_size;
+  obj->local_rank = local_rank;
+  obj->size = size;
+  obj->rank = rank;
+  obj->world_size = size;
+  obj->world_rank = rank;
+  obj->root_rank = 0;
+  obj->group_id = -1;
+  obj->group_size = 0;
+  return StoreCommunicator(obj);
+}
+
+RAF_REGISTER_GLOBAL("raf.distributed.communicator._make.store")
+    .set_body_typed(StoreCommunicator::make);
+
+RAF_REGISTER_OBJECT_REFLECT(StoreCommunicatorObj);
+
+}  // namespace communicator
+}  // namespace distributed
+}  // namespace raf
@@ -8,6 +8,7 @@
  * \brief MPI Communicator.
  */
 
+#ifdef RAF_USE_MPI
 #include "raf/mpi_communicator.h"
 
 namespace raf {
@@ -67,3 +68,4 @@ RAF_REGISTER_OBJECT_REFLECT(MPICommunicatorObj);
 }  // namespace communicator
 }  // namespace distributed
 }  // namespace raf
+#endif
@@ -8,7 +8,10 @@
  * \brief NCCL Communicator.
  */
 
+#include <cstring>
+#include <unordered_map>
 #include "raf/nccl_communicator.h"
+#include "raf/rendezvous.h"
 
 namespace raf {
 namespace distributed {
@@ -18,68 +21,266 @@ NCCLCommunicatorObj::~NCCLCommunicatorObj() {
   NCCL_CALL(ncclCommDestroy(nccl_comm));
 }
 
-NCCLCommunicator NCCLCommunicator::make(Value rank_list) {
-  auto mpi = Communicator::Get("mpi");  // Must init MPI first
-  auto obj = make_object<NCCLCommunicatorObj>();
+/*!
+ * \brief The key of the NCCL unique ID in the store, namespaced by the number of the communicators
+ * bootstrapped before, as all ranks create the communicators in the same order.
+ */
+std::string NCCLIdKey(int seq, const std::string& name) {
+  return "nccl/" + std::to_string(seq) + "/" + name;
+}
 
+/*! \brief A NCCL communicator whose unique ID is exchanged, but is not initialized yet. */
+struct NCCLBootstrap {
+  ObjectPtr<NCCLCommunicatorObj> obj;
   ncclUniqueId nccl_id;
+  /*! \brief The communicator to split from, or nullptr to initialize from nccl_id. */
+  ncclComm_t parent = nullptr;
+  int color = 0;
+
+  void Init() {
+#if defined(NCCL_VERSION_CODE) && NCCL_VERSION_CODE >= NCCL_VERSION(2, 18, 0)
+    if (parent != nullptr) {
+      NCCL_CALL(ncclCommSplit(parent, color, obj->rank, &obj->nccl_comm, nullptr));
+      return;
+    }
+#endif
+    NCCL_CALL(ncclCommInitRank(&obj->nccl_comm, obj->size, nccl_id, obj->rank));
+  }
+};
+
+NCCLBootstrap Bootstrap(Value rank_list) {
+  // Bootstrap through the rendezvous store if set, or MPI otherwise. Either must init first.
+  StoreCommunicator store_comm;
+  if (Store::Global()) {
+    store_comm = Downcast<StoreCommunicator>(Communicator::Get("store"));
+  }
+#ifndef RAF_USE_MPI
+  CHECK(store_comm.defined())
+      << "RAF is built without MPI, so RAF_RENDEZVOUS must be set to bootstrap NCCL";
+#endif
+  Communicator bootstrap = store_comm.defined() ? store_comm : Communicator::Get("mpi");
+  int seq = store_comm.defined() ? store_comm->num_bootstraps++ : 0;
+  NCCLBootstrap ret;
+  ret.obj = make_object<NCCLCommunicatorObj>();
+  auto* obj = ret.obj.get();
+  auto& nccl_id = ret.nccl_id;
+
   NCCL_CALL(ncclGetUniqueId(&nccl_id));
+  auto nccl_id_str = [&nccl_id]() {
+    return std::string(reinterpret_cast<const char*>(&nccl_id), sizeof(nccl_id));
+  };
 
   if (!rank_list.defined()) {
     // Create Global Communicator
-    obj->local_size = mpi->local_size;
-    obj->local_rank = mpi->local_rank;
-    obj->size = mpi->size;
-    obj->rank = mpi->rank;
-    obj->world_size = mpi->world_size;
-    obj->world_rank = mpi->world_rank;
-    obj->root_rank = mpi->root_rank;
+    obj->local_size = bootstrap->local_size;
+    obj->local_rank = bootstrap->local_rank;
+    obj->size = bootstrap->size;
+    obj->rank = bootstrap->rank;
+    obj->world_size = bootstrap->world_size;
+    obj->world_rank = bootstrap->world_rank;
+    obj->root_rank = bootstrap->root_rank;
     obj->group_id = -1;
     obj->group_size = 0;
-    obj->host_ids = mpi->host_ids;
-    obj->parent_comm = mpi;
+    obj->host_ids = bootstrap->host_ids;
+    obj->parent_comm = bootstrap;
     cudaSetDevice(obj->local_rank);
-    MPI_CALL(MPI_Bcast(reinterpret_cast<void*>(&nccl_id), sizeof(nccl_id), MPI_BYTE, obj->root_rank,
-                       MPI_COMM_WORLD));
-    NCCL_CALL(ncclCommInitRank(&obj->nccl_comm, obj->size, nccl_id, obj->rank));
-  } else {
-    // Create Sub-communicator
-    InitSubCommunicator(obj.get(), rank_list, mpi);
-    obj->parent_comm = mpi;
+    if (store_comm.defined()) {
+      auto key = NCCLIdKey(seq, "root");
+      if (obj->rank == obj->root_rank) {
+        store_comm->store->Set(key, nccl_id_str());
+      } else {
+        auto value = store_comm->store->Get(key);
+        CHECK_EQ(value.size(), sizeof(nccl_id));
+        memcpy(&nccl_id, value.data(), sizeof(nccl_id));
+      }
+    } else {
+#ifdef RAF_USE_MPI
+      MPI_CALL(MPI_Bcast(reinterpret_cast<void*>(&nccl_id), sizeof(nccl_id), MPI_BYTE,
+                         obj->root_rank, MPI_COMM_WORLD));
+#endif
+    }
+    return ret;
+  }
+
+  // Create Sub-communicator
+  InitSubCommunicator(obj, rank_list, bootstrap);
+  obj->parent_comm = bootstrap;
+#if defined(NCCL_VERSION_CODE) && NCCL_VERSION_CODE >= NCCL_VERSION(2, 18, 0)
+  // Split the global communicator, which reuses its connections without any bootstrap. The ranks
+  // not in rank_list are split into the communicators of their own.
+  auto global_comm = Downcast<NCCLCommunicator>(Communicator::Get("nccl"));
+  obj->parent_comm = global_comm;
+  ret.parent = global_comm->nccl_comm;
+  ret.color = obj->group_id >= 0 ? obj->group_id : obj->group_size + obj->world_rank;
+#else
+  if (store_comm.defined()) {
+    if (obj->group_id >= 0) {
+      auto key = NCCLIdKey(seq, std::to_string(obj->group_id));
+      if (obj->rank == 0) {
+        store_comm->store->Set(key, nccl_id_str());
+      } else {
+        auto value = store_comm->store->Get(key);
+        CHECK_EQ(value.size(), sizeof(nccl_id));
+        memcpy(&nccl_id, value.data(), sizeof(nccl_id));
+      }
+    }
+    return ret;
+  }
+#ifdef RAF_USE_MPI
+  std::vector<ncclUniqueId> nccl_ids(obj->group_size);
+  std::vector<int> counts(obj->world_size, 0);
+  std::vector<int> displacements(obj->world_size);
+
+  int offset = 0;
 
-    std::vector<ncclUniqueId> nccl_ids(obj->group_size);
-    std::vector<int> counts(obj->world_size, 0);
-    std::vector<int> displacements(obj->world_size);
+  for (auto group : Downcast<TupleValue>(rank_list)->fields) {
+    auto root_rank = Downcast<TupleValue>(group)->fields[0];
+    auto root_rank_ = Downcast<IntValue>(root_rank)->value;
+    counts[root_rank_] = sizeof(nccl_id);
+  }
+
+  for (int i = 0; i < obj->world_size; ++i) {
+    displacements[i] = offset;
+    if (counts[i] > 0) offset += sizeof(nccl_id);
+  }
 
-    int offset = 0;
+  MPI_CALL(MPI_Allgatherv(reinterpret_cast<void*>(&nccl_id), counts[obj->world_rank], MPI_BYTE,
+                          reinterpret_cast<void*>(&nccl_ids[0]),
+                          reinterpret_cast<int*>(&counts[0]),
+                          reinterpret_cast<int*>(&displacements[0]), MPI_BYTE, MPI_COMM_WORLD));
+
+  if (obj->group_id != -1) {
+    nccl_id = nccl_ids[obj->group_id];
+  }
+#endif
+#endif
+  return ret;
+}
 
-    for (auto group : Downcast<TupleValue>(rank_list)->fields) {
-      auto root_rank = Downcast<TupleValue>(group)->fields[0];
-      auto root_rank_ = Downcast<IntValue>(root_rank)->value;
-      counts[root_rank_] = sizeof(nccl_id);
+NCCLCommunicator NCCLCommunicator::make(Value rank_list) {
+  auto bootstrap = Bootstrap(rank_list);
+  bootstrap.Init();
+  return NCCLCommunicator(bootstrap.obj);
+}
+
+Array<NCCLCommunicator> NCCLCommunicator::MakeGroup(Array<Value> rank_lists) {
+  // Exchange all unique IDs first, so no rank blocks in a group init waiting for the others.
+  std::vector<NCCLBootstrap> bootstraps;
+  for (const auto& rank_list : rank_lists) {
+    if (rank_list.defined()) {
+      bootstraps.push_back(Bootstrap(rank_list));
     }
+  }
+  NCCL_CALL(ncclGroupStart());
+  for (auto& bootstrap : bootstraps) {
+    bootstrap.Init();
+  }
+  NCCL_CALL(ncclGroupEnd());
 
-    for (int i = 0; i < obj->world_size; ++i) {
-      displacements[i] = offset;
-      if (counts[i] > 0) offset += sizeof(nccl_id);
+  Array<NCCLCommunicator> comms;
+  auto it = bootstraps.begin();
+  for (const auto& rank_list : rank_lists) {
+    if (rank_list.defined()) {
+      comms.push_back(NCCLCommunicator((it++)->obj));
+    } else {
+      // The sub-communicators may split from the global one, which is thus created beforehand.
+      comms.push_back(Downcast<NCCLCommunicator>(Communicator::Get("nccl")));
     }
+  }
+  return comms;
+}
 
-    MPI_CALL(MPI_Allgatherv(reinterpret_cast<void*>(&nccl_id), counts[obj->world_rank], MPI_BYTE,
-                            reinterpret_cast<void*>(&nccl_ids[0]),
-                            reinterpret_cast<int*>(&counts[0]),
-                            reinterpret_cast<int*>(&displacements[0]), MPI_BYTE, MPI_COMM_WORLD));
+/*! \brief Group the ranks by their hosts, in the order of the first rank of each host. */
+std::vector<std::vector<int64_t>> GroupRanksByHost(const std::vector<uint64_t>& host_ids) {
+  std::vector<std::vector<int64_t>> groups;
+  std::unordered_map<uint64_t, size_t> host_to_group;
+  for (size_t rank = 0; rank < host_ids.size(); ++rank) {
+    auto it = host_to_group.find(host_ids[rank]);
+    if (it == host_to_group.end()) {
+      it = host_to_group.emplace(host_ids[rank], groups.size()).first;
+      groups.emplace_back();
+    }
+    groups[it->second].push_back(rank);
+  }
+  return groups;
+}
 
-    auto& root_nccl_id = (obj->group_id == -1) ? nccl_id : nccl_ids[obj->group_id];
-    NCCL_CALL(ncclCommInitRank(&obj->nccl_comm, obj->size, root_nccl_id, obj->rank));
+/*! \brief Make a rank list value from the groups of ranks. */
+Value MakeRankList(const std::vector<std::vector<int64_t>>& groups) {
+  Array<Value> fields;
+  for (const auto& group : groups) {
+    Array<Value> ranks;
+    for (auto rank : group) {
+      ranks.push_back(ScalarValue::make(rank));
+    }
+    fields.push_back(TupleValue::make(ranks));
   }
+  return TupleValue::make(fields);
+}
 
-  return NCCLCommunicator(obj);
+bool HierarchicalCommunicator::IsApplicable(const Communicator& comm) {
+  if (comm->group_id != -1 || comm->host_ids.size() != comm->size) {
+    // Only the communicator of all ranks is supported.
+    return false;
+  }
+  auto groups = GroupRanksByHost(comm->host_ids);
+  if (groups.size() < 2 || groups[0].size() < 2) {
+    return false;
+  }
+  for (const auto& group : groups) {
+    if (group.size() != groups[0].size()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+HierarchicalCommunicator HierarchicalCommunicator::make(Value rank_list) {
+  CHECK(!rank_list.defined()) << "HierarchicalCommunicator only supports all ranks";
+  auto global_comm = Downcast<NCCLCommunicator>(Communicator::Get("nccl"));
+  CHECK(IsApplicable(global_comm))
+      << "HierarchicalCommunicator requires multiple nodes with the same number of ranks";
+  auto obj = make_object<HierarchicalCommunicatorObj>();
+  obj->local_size = global_comm->local_size;
+  obj->local_rank = global_comm->local_rank;
+  obj->size = global_comm->size;
+  obj->rank = global_comm->rank;
+  obj->world_size = global_comm->world_size;
+  obj->world_rank = global_comm->world_rank;
+  obj->root_rank = global_comm->root_rank;
+  obj->group_id = -1;
+  obj->group_size = 0;
+  obj->host_ids = global_comm->host_ids;
+  obj->global_comm = global_comm;
+
+  auto local_groups = GroupRanksByHost(global_comm->host_ids);
+  std::vector<std::vector<int64_t>> cross_groups(local_groups[0].size());
+  for (const auto& group : local_groups) {
+    for (size_t i = 0; i < group.size(); ++i) {
+      cross_groups[i].push_back(group[i]);
+    }
+  }
+  obj->num_nodes = local_groups.size();
+  obj->local_comm =
+      Downcast<NCCLCommunicator>(Communicator::Get("nccl", MakeRankList(local_groups)));
+  obj->cross_comm =
+      Downcast<NCCLCommunicator>(Communicator::Get("nccl", MakeRankList(cross_groups)));
+  CHECK_EQ(obj->local_comm->size, obj->local_size);
+  CHECK_EQ(obj->cross_comm->size, obj->num_nodes);
+  return HierarchicalCommunicator(obj);
 }
 
 RAF_REGISTER_GLOBAL("raf.distributed.communicator._make.nccl")
     .set_body_typed(NCCLCommunicator::make);
 
+RAF_REGISTER_GLOBAL("raf.distributed.communicator._make_group.nccl")
+    .set_body_typed(NCCLCommunicator::MakeGroup);
+
+RAF_REGISTER_GLOBAL("raf.distributed.communicator._make.hierarchical")
+    .set_body_typed(HierarchicalCommunicator::make);
+
 RAF_REGISTER_OBJECT_REFLECT(NCCLCommunicatorObj);
+RAF_REGISTER_OBJECT_REFLECT(HierarchicalCommunicatorObj);
 
 }  // namespace communicator
 }  // namespace distributed
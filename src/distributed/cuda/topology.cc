@@ -0,0 +1,108 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/distributed/cuda/topology.cc
+ * \brief Probe the communication topology of the GPUs.
+ */
+#include <cuda_runtime.h>
+#include <cstdlib>
+#include <string>
+#include "raf/registry.h"
+#include "raf/dist_context.h"
+#include "../../common/cuda_utils.h"
+
+namespace raf {
+namespace distributed {
+
+/*! \brief Measure the copy bandwidth in GB/s from the current device to the peer device. */
+double MeasurePeerBandwidth(int device, int peer) {
+  constexpr size_t kBytes = 32 << 20;
+  constexpr int kRepeat = 3;
+  cudaError_t err = cudaDeviceEnablePeerAccess(peer, 0);
+  if (err == cudaErrorPeerAccessAlreadyEnabled) {
+    cudaGetLastError();
+  } else {
+    CUDA_CALL(err);
+  }
+  void* src = nullptr;
+  void* dst = nullptr;
+  cudaEvent_t start, stop;
+  CUDA_CALL(cudaMalloc(&src, kBytes));
+  CUDA_CALL(cudaSetDevice(peer));
+  CUDA_CALL(cudaMalloc(&dst, kBytes));
+  CUDA_CALL(cudaSetDevice(device));
+  CUDA_CALL(cudaEventCreate(&start));
+  CUDA_CALL(cudaEventCreate(&stop));
+  // Warm up the link.
+  CUDA_CALL(cudaMemcpyPeerAsync(dst, peer, src, device, kBytes, nullptr));
+  CUDA_CALL(cudaEventRecord(start, nullptr));
+  for (int i = 0; i < kRepeat; ++i) {
+    CUDA_CALL(cudaMemcpyPeerAsync(dst, peer, src, device, kBytes, nullptr));
+  }
+  CUDA_CALL(cudaEventRecord(stop, nullptr));
+  CUDA_CALL(cudaEventSynchronize(stop));
+  float ms = 0;
+  CUDA_CALL(cudaEventElapsedTime(&ms, start, stop));
+  CUDA_CALL(cudaEventDestroy(start));
+  CUDA_CALL(cudaEventDestroy(stop));
+  CUDA_CALL(cudaFree(src));
+  CUDA_CALL(cudaSetDevice(peer));
+  CUDA_CALL(cudaFree(dst));
+  CUDA_CALL(cudaSetDevice(device));
+  return ms > 0 ? static_cast<double>(kBytes) * kRepeat / ms / 1e6 : 0;
+}
+
+/*!
+ * \brief Probe the topology of the ranks: the number of nodes, the link and the measured copy
+ * bandwidth between the GPUs of this node, and the inter-node bandwidth from the environment. Each
+ * rank uses the GPU of its local rank, and all GPUs of the node are to be visible.
+ */
+void ProbeTopology(DistContext dctx) {
+  dctx->num_nodes = dctx->local_size > 0 ? dctx->size / dctx->local_size : 1;
+  if (const char* bandwidth = getenv("RAF_INTER_NODE_BANDWIDTH_GBPS")) {
+    dctx->inter_node_bandwidth = std::atof(bandwidth);
+  }
+  int num_devices = 0;
+  if (cudaGetDeviceCount(&num_devices) != cudaSuccess || dctx->local_rank >= num_devices ||
+      dctx->local_size > num_devices) {
+    cudaGetLastError();
+    LOG(WARNING) << "Cannot probe the GPUs of this node, which are not all visible";
+    return;
+  }
+  int device = dctx->local_rank;
+  int prev_device = 0;
+  CUDA_CALL(cudaGetDevice(&prev_device));
+  CUDA_CALL(cudaSetDevice(device));
+  ir::Array<ir::FloatImm> peer_bandwidth;
+  bool all_peers = dctx->local_size > 1, all_nvlink = true;
+  for (int peer = 0; peer < dctx->local_size; ++peer) {
+    int can_access = 0, atomics = 0;
+    if (peer != device) {
+      CUDA_CALL(cudaDeviceCanAccessPeer(&can_access, device, peer));
+    }
+    if (!can_access) {
+      all_peers &= peer == device;
+      peer_bandwidth.push_back(ir::FloatImm(DataType::Float(64), 0));
+      continue;
+    }
+    // The native atomics between the GPUs are only supported over NVLink.
+    CUDA_CALL(
+        cudaDeviceGetP2PAttribute(&atomics, cudaDevP2PAttrNativeAtomicSupported, device, peer));
+    all_nvlink &= atomics != 0;
+    double bandwidth = MeasurePeerBandwidth(device, peer);
+    peer_bandwidth.push_back(ir::FloatImm(DataType::Float(64), bandwidth));
+  }
+  CUDA_CALL(cudaSetDevice(prev_device));
+  dctx->peer_bandwidth = peer_bandwidth;
+  dctx->intra_node_link = !all_peers ? "none" : (all_nvlink ? "nvlink" : "pcie");
+  DLOG(INFO) << "Probed " << dctx->num_nodes << " nodes with " << dctx->local_size
+             << " GPUs linked by " << dctx->intra_node_link;
+}
+
+RAF_REGISTER_GLOBAL("raf.distributed.ProbeTopology").set_body_typed(ProbeTopology);
+
+}  // namespace distributed
+}  // namespace raf
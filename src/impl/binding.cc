@@ -132,6 +132,7 @@ BindingEntry LookupBinding(const VarNode* var) {
 }
 
 Value LookupBoundValue(Var var) {
+  lazy::Materialize(var.get());
   return Downcast<NDArrayBinding>(LookupBinding(var.operator->()))->value;
 }
 
@@ -247,6 +248,7 @@ ObjectRef DeStruct(Value value, ClosureValue bp, Array<ObjectRef> prev_tapes) {
 }
 
 void SetRequiresGrad(Var var, bool value) {
+  lazy::Materialize(var.get());
   GradTape& tape = Downcast<NDArrayBinding>(LookupBinding(var.operator->()))->tape;
   if (tape.defined() == value) {
     return;
@@ -280,6 +282,9 @@ TensorValue MakeOnes(Device to_dev, DType dtype) {
 }
 
 void Backward(Var var, Var dy_var) {
+  if (dy_var.defined()) {
+    lazy::Materialize(dy_var.get());
+  }
   auto y_tensor = Downcast<TensorValue>(LookupBoundValue(var))->tensor;
   Device y_dev = y_tensor->device;
   DType y_dtype = y_tensor->dtype;
@@ -0,0 +1,549 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/impl/cache.cc
+ * \brief The packed on-disk store of the persistent cache.
+ */
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include "raf/cache.h"
+
+namespace raf {
+namespace op {
+
+namespace {
+
+constexpr uint64_t kDataMagic = 0x52414644415441ULL;    // "RAFDATA"
+constexpr uint64_t kIndexMagic = 0x524146494E4458ULL;   // "RAFINDX"
+constexpr uint64_t kRecordMagic = 0x5241465245434BULL;  // "RAFRECK"
+constexpr uint64_t kStoreVersion = 1;
+/*! \brief The number of bytes in the key lock file that keys are locked on. */
+constexpr uint64_t kKeyLockRange = 1ULL << 30;
+
+/*! \brief The header of the blob file. */
+struct DataHeader {
+  uint64_t magic;
+  uint64_t version;
+  uint64_t generation;
+};
+
+/*! \brief The header of the index file, which is followed by the index entries. */
+struct IndexHeader {
+  uint64_t magic;
+  uint64_t version;
+  uint64_t generation;
+  uint64_t scanned;
+  uint64_t num_entries;
+};
+
+/*!
+ * \brief The header of a record in the blob file, which is followed by the payload:
+ * [key size: u64][key][number of files: u64]([name size: u64][name][file size: u64][file])*
+ */
+struct RecordHeader {
+  uint64_t magic;
+  uint64_t size;
+};
+
+inline int64_t Now() {
+  return std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+}
+
+inline uint64_t HashStoreKey(const std::string& key) {
+  return std::hash<std::string>{}(key);
+}
+
+bool ReadAt(int fd, void* buf, size_t nbytes, uint64_t offset) {
+  char* ptr = static_cast<char*>(buf);
+  while (nbytes > 0) {
+    ssize_t n = pread(fd, ptr, nbytes, offset);
+    if (n <= 0) {
+      return false;
+    }
+    ptr += n;
+    nbytes -= n;
+    offset += n;
+  }
+  return true;
+}
+
+bool WriteAll(int fd, const void* buf, size_t nbytes) {
+  const char* ptr = static_cast<const char*>(buf);
+  while (nbytes > 0) {
+    ssize_t n = write(fd, ptr, nbytes);
+    if (n < 0) {
+      return false;
+    }
+    ptr += n;
+    nbytes -= n;
+  }
+  return true;
+}
+
+bool ReadFile(const std::string& path, std::string* content) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat st;
+  bool ok = fstat(fd, &st) == 0;
+  if (ok) {
+    content->resize(st.st_size);
+    ok = ReadAt(fd, &(*content)[0], st.st_size, 0);
+  }
+  close(fd);
+  return ok;
+}
+
+int64_t FileSize(int fd) {
+  struct stat st;
+  CHECK_EQ(fstat(fd, &st), 0) << "Failed to stat the persistent cache: " << strerror(errno);
+  return st.st_size;
+}
+
+/*! \brief Write a file to a temporary path and rename it, so readers never see partial files. */
+bool WriteFileAtomic(const std::string& path, const std::string& content) {
+  std::string tmp_path = path + ".tmp." + std::to_string(getpid());
+  int fd = open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    return false;
+  }
+  bool ok = WriteAll(fd, content.data(), content.size());
+  close(fd);
+  if (!ok || rename(tmp_path.c_str(), path.c_str()) != 0) {
+    unlink(tmp_path.c_str());
+    return false;
+  }
+  return true;
+}
+
+void RemoveDir(const std::string& path) {
+  if (DIR* dir = opendir(path.c_str())) {
+    while (struct dirent* ent = readdir(dir)) {
+      std::string name = ent->d_name;
+      if (name != "." && name != "..") {
+        unlink((path + "/" + name).c_str());
+      }
+    }
+    closedir(dir);
+  }
+  rmdir(path.c_str());
+}
+
+/*! \brief Create a staging directory on the local file system. */
+std::string MakeStagingDir() {
+  const char* tmp = getenv("TMPDIR");
+  std::string path = std::string(tmp != nullptr ? tmp : "/tmp") + "/raf_cache.XXXXXX";
+  CHECK(mkdtemp(&path[0]) != nullptr) << "Failed to create directory " << path << ": "
+                                      << strerror(errno);
+  return path;
+}
+
+template <typename T>
+inline void AppendPOD(std::string* buf, const T& value) {
+  buf->append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+inline bool ReadPOD(const std::string& buf, size_t* pos, T* value) {
+  if (*pos + sizeof(T) > buf.size()) {
+    return false;
+  }
+  memcpy(value, buf.data() + *pos, sizeof(T));
+  *pos += sizeof(T);
+  return true;
+}
+
+inline bool ReadBytes(const std::string& buf, size_t* pos, std::string* value) {
+  uint64_t size;
+  if (!ReadPOD(buf, pos, &size) || *pos + size > buf.size()) {
+    return false;
+  }
+  value->assign(buf.data() + *pos, size);
+  *pos += size;
+  return true;
+}
+
+inline void AppendBytes(std::string* buf, const std::string& value) {
+  AppendPOD<uint64_t>(buf, value.size());
+  buf->append(value);
+}
+
+/*! \brief The RAII guard of the advisory file lock shared by processes. */
+class FileLock {
+ public:
+  explicit FileLock(int fd) : fd_(fd) {
+    CHECK_EQ(flock(fd_, LOCK_EX), 0) << "Failed to lock the persistent cache: " << strerror(errno);
+  }
+  ~FileLock() {
+    flock(fd_, LOCK_UN);
+  }
+
+ private:
+  int fd_;
+};
+
+}  // namespace
+
+bool PackEntry(const std::string& key, const std::function<bool(const std::string&)>& f_save,
+               std::string* packed) {
+  std::string dir = MakeStagingDir();
+  try {
+    if (!f_save(dir)) {
+      RemoveDir(dir);
+      return false;
+    }
+    // Pack all files saved by the entry.
+    std::vector<std::string> names;
+    if (DIR* d = opendir(dir.c_str())) {
+      while (struct dirent* ent = readdir(d)) {
+        std::string name = ent->d_name;
+        if (name != "." && name != "..") {
+          names.push_back(name);
+        }
+      }
+      closedir(d);
+    }
+    std::sort(names.begin(), names.end());
+    AppendBytes(packed, key);
+    AppendPOD<uint64_t>(packed, names.size());
+    for (const auto& name : names) {
+      std::string content;
+      CHECK(ReadFile(dir + "/" + name, &content)) << "Failed to read " << dir << "/" << name;
+      AppendBytes(packed, name);
+      AppendBytes(packed, content);
+    }
+  } catch (...) {
+    RemoveDir(dir);
+    throw;
+  }
+  RemoveDir(dir);
+  return true;
+}
+
+bool UnpackEntry(const std::string& packed, size_t pos, const std::string* expected_key,
+                 const std::function<void(const std::string&, const std::string&)>& f_load) {
+  std::string key;
+  uint64_t num_files;
+  if (!ReadBytes(packed, &pos, &key) || (expected_key != nullptr && key != *expected_key) ||
+      !ReadPOD(packed, &pos, &num_files)) {
+    return false;
+  }
+  std::string dir = MakeStagingDir();
+  try {
+    for (uint64_t i = 0; i < num_files; ++i) {
+      std::string name, content;
+      CHECK(ReadBytes(packed, &pos, &name) && ReadBytes(packed, &pos, &content))
+          << "Corrupted cache entry";
+      CHECK(WriteFileAtomic(dir + "/" + name, content)) << "Failed to unpack " << name;
+    }
+    f_load(key, dir);
+  } catch (...) {
+    RemoveDir(dir);
+    throw;
+  }
+  RemoveDir(dir);
+  return true;
+}
+
+std::map<std::string, BundledCache*>& BundledCache::Registry() {
+  static std::map<std::string, BundledCache*> registry;
+  return registry;
+}
+
+PersistStore::PersistStore(const std::string& path, int64_t capacity)
+    : path_(path), capacity_(capacity) {
+  std::string lock_path = path_ + "/lock";
+  lock_fd_ = open(lock_path.c_str(), O_RDWR | O_CREAT, 0644);
+  CHECK_GE(lock_fd_, 0) << "Failed to open " << lock_path << ": " << strerror(errno);
+  std::string key_lock_path = path_ + "/keys.lock";
+  key_lock_fd_ = open(key_lock_path.c_str(), O_RDWR | O_CREAT, 0644);
+  CHECK_GE(key_lock_fd_, 0) << "Failed to open " << key_lock_path << ": " << strerror(errno);
+  FileLock lock(lock_fd_);
+  OpenData();
+  LoadIndex(false);
+  Scan();
+  if (capacity_ > 0) {
+    Compact();
+  }
+}
+
+PersistStore::~PersistStore() {
+  try {
+    Flush();
+  } catch (const dmlc::Error& e) {
+    LOG(WARNING) << "Failed to write the index of " << path_ << ": " << e.what();
+  }
+  close(data_fd_);
+  close(lock_fd_);
+  close(key_lock_fd_);
+}
+
+void PersistStore::OpenData() {
+  std::string data_path = path_ + "/data.bin";
+  data_fd_ = open(data_path.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+  CHECK_GE(data_fd_, 0) << "Failed to open " << data_path << ": " << strerror(errno);
+  DataHeader header;
+  if (FileSize(data_fd_) < static_cast<int64_t>(sizeof(DataHeader)) ||
+      !ReadAt(data_fd_, &header, sizeof(header), 0) || header.magic != kDataMagic ||
+      header.version != kStoreVersion) {
+    // A new or an incompatible store, start over.
+    CHECK_EQ(ftruncate(data_fd_, 0), 0) << "Failed to truncate " << data_path;
+    header = {kDataMagic, kStoreVersion, std::random_device{}()};
+    CHECK(WriteAll(data_fd_, &header, sizeof(header))) << "Failed to write " << data_path;
+  }
+  generation_ = header.generation;
+  scanned_ = sizeof(DataHeader);
+  entries_.clear();
+  prefetched_.clear();
+}
+
+void PersistStore::LoadIndex(bool merge) {
+  std::string content;
+  if (!ReadFile(path_ + "/index.bin", &content)) {
+    return;
+  }
+  size_t pos = 0;
+  IndexHeader header;
+  if (!ReadPOD(content, &pos, &header) || header.magic != kIndexMagic ||
+      header.version != kStoreVersion || header.generation != generation_) {
+    // The index is stale, the records will be found by scanning the blob file.
+    return;
+  }
+  for (uint64_t i = 0; i < header.num_entries; ++i) {
+    IndexEntry entry;
+    if (!ReadPOD(content, &pos, &entry)) {
+      return;
+    }
+    auto it = entries_.find(entry.hash);
+    if (!merge) {
+      entries_[entry.hash] = entry;
+    } else if (it != entries_.end() && it->second.offset == entry.offset) {
+      // Keep the latest access time of the record from all processes.
+      it->second.timestamp = std::max(it->second.timestamp, entry.timestamp);
+    }
+  }
+  if (!merge) {
+    scanned_ = std::max<uint64_t>(scanned_, header.scanned);
+  }
+}
+
+void PersistStore::WriteIndex() {
+  std::string content;
+  AppendPOD(&content,
+            IndexHeader{kIndexMagic, kStoreVersion, generation_, scanned_, entries_.size()});
+  for (const auto& kv : entries_) {
+    AppendPOD(&content, kv.second);
+  }
+  if (!WriteFileAtomic(path_ + "/index.bin", content)) {
+    LOG(WARNING) << "Failed to write the index of " << path_ << ": " << strerror(errno);
+    return;
+  }
+  dirty_ = false;
+}
+
+void PersistStore::Sync() {
+  // Reopen the blob file if it has been compacted by another process.
+  struct stat path_st, fd_st;
+  if (stat((path_ + "/data.bin").c_str(), &path_st) != 0 || fstat(data_fd_, &fd_st) != 0 ||
+      path_st.st_ino != fd_st.st_ino) {
+    close(data_fd_);
+    OpenData();
+    LoadIndex(false);
+  }
+  Scan();
+}
+
+void PersistStore::Scan() {
+  uint64_t file_size = FileSize(data_fd_);
+  while (scanned_ + sizeof(RecordHeader) <= file_size) {
+    RecordHeader header;
+    uint64_t key_size;
+    if (!ReadAt(data_fd_, &header, sizeof(header), scanned_) || header.magic != kRecordMagic ||
+        scanned_ + sizeof(header) + header.size > file_size ||
+        !ReadAt(data_fd_, &key_size, sizeof(key_size), scanned_ + sizeof(header))) {
+      break;
+    }
+    std::string key(key_size, '\0');
+    if (!ReadAt(data_fd_, &key[0], key_size, scanned_ + sizeof(header) + sizeof(key_size))) {
+      break;
+    }
+    uint64_t hash = HashStoreKey(key);
+    entries_[hash] = IndexEntry{hash, scanned_, sizeof(header) + header.size, Now()};
+    scanned_ += sizeof(header) + header.size;
+    dirty_ = true;
+  }
+  if (scanned_ < file_size) {
+    // A partial record left by a crashed writer. Since all appends are done with the file lock
+    // held, it is safe to drop it.
+    LOG(WARNING) << "Dropping a corrupted record of " << path_ << " at offset " << scanned_;
+    CHECK_EQ(ftruncate(data_fd_, scanned_), 0) << "Failed to truncate " << path_ << "/data.bin";
+  }
+}
+
+void PersistStore::Compact() {
+  int64_t total_size = 0;
+  for (const auto& kv : entries_) {
+    total_size += kv.second.size;
+  }
+  if (total_size <= capacity_) {
+    return;
+  }
+  // Keep the most recently used records that fit in the capacity.
+  std::vector<IndexEntry> entries;
+  for (const auto& kv : entries_) {
+    entries.push_back(kv.second);
+  }
+  // Ties are broken by the offsets, as the records appended later are used more recently.
+  std::sort(entries.begin(), entries.end(), [](const IndexEntry& a, const IndexEntry& b) {
+    return a.timestamp != b.timestamp ? a.timestamp > b.timestamp : a.offset > b.offset;
+  });
+  uint64_t generation = std::random_device{}();
+  std::string content;
+  AppendPOD(&content, DataHeader{kDataMagic, kStoreVersion, generation});
+  std::unordered_map<uint64_t, IndexEntry> kept;
+  for (const auto& entry : entries) {
+    if (static_cast<int64_t>(content.size() + entry.size) > capacity_) {
+      continue;
+    }
+    std::string record = ReadRecord(entry);
+    if (record.empty()) {
+      continue;
+    }
+    kept[entry.hash] = IndexEntry{entry.hash, content.size(), entry.size, entry.timestamp};
+    content.append(record);
+  }
+  std::string data_path = path_ + "/data.bin";
+  if (!WriteFileAtomic(data_path, content)) {
+    LOG(WARNING) << "Failed to compact " << data_path << ": " << strerror(errno);
+    return;
+  }
+  LOG(INFO) << "Evicted " << entries_.size() - kept.size() << " entries from " << path_;
+  close(data_fd_);
+  OpenData();
+  entries_ = std::move(kept);
+  scanned_ = content.size();
+  WriteIndex();
+}
+
+std::string PersistStore::ReadRecord(const IndexEntry& entry) {
+  if (entry.offset + entry.size <= prefetched_.size()) {
+    return prefetched_.substr(entry.offset, entry.size);
+  }
+  std::string record(entry.size, '\0');
+  if (!ReadAt(data_fd_, &record[0], entry.size, entry.offset)) {
+    return "";
+  }
+  return record;
+}
+
+bool PersistStore::Load(const std::string& key,
+                        const std::function<void(const std::string&)>& f_load) {
+  std::string record;
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto it = entries_.find(HashStoreKey(key));
+    if (it == entries_.end()) {
+      return false;
+    }
+    record = ReadRecord(it->second);
+    it->second.timestamp = Now();
+    dirty_ = true;
+  }
+
+  // A missing record or a hash collision.
+  return UnpackEntry(record, sizeof(RecordHeader), &key,
+                     [&f_load](const std::string&, const std::string& dir) { f_load(dir); });
+}
+
+bool PersistStore::Save(const std::string& key,
+                        const std::function<bool(const std::string&)>& f_save) {
+  std::string payload;
+  if (!PackEntry(key, f_save, &payload)) {
+    return false;
+  }
+
+  std::string record;
+  AppendPOD(&record, RecordHeader{kRecordMagic, payload.size()});
+  record.append(payload);
+
+  std::lock_guard<std::mutex> lock(mu_);
+  FileLock file_lock(lock_fd_);
+  Sync();
+  if (!WriteAll(data_fd_, record.data(), record.size())) {
+    // Drop the partial record.
+    CHECK_EQ(ftruncate(data_fd_, scanned_), 0) << "Failed to truncate " << path_ << "/data.bin";
+    return false;
+  }
+  uint64_t hash = HashStoreKey(key);
+  entries_[hash] = IndexEntry{hash, scanned_, record.size(), Now()};
+  scanned_ += record.size();
+  dirty_ = true;
+  if (capacity_ > 0) {
+    Compact();
+  }
+  return true;
+}
+
+void PersistStore::Prefetch() {
+  std::lock_guard<std::mutex> lock(mu_);
+  std::string content(scanned_, '\0');
+  if (ReadAt(data_fd_, &content[0], content.size(), 0)) {
+    prefetched_ = std::move(content);
+  }
+}
+
+void PersistStore::Refresh() {
+  std::lock_guard<std::mutex> lock(mu_);
+  FileLock file_lock(lock_fd_);
+  Sync();
+}
+
+void PersistStore::WithKeyLock(const std::string& key, const std::function<void()>& f) {
+  // Lock a byte of the key lock file indexed by the key hash. Unlike flock, byte-range locks do not
+  // need a file per key, which saves the metadata operations on network file systems.
+  struct flock fl;
+  memset(&fl, 0, sizeof(fl));
+  fl.l_whence = SEEK_SET;
+  fl.l_start = HashStoreKey(key) % kKeyLockRange;
+  fl.l_len = 1;
+  auto set_lock = [this, &fl](short type) {
+    fl.l_type = type;
+    while (fcntl(key_lock_fd_, F_SETLKW, &fl) != 0) {
+      CHECK_EQ(errno, EINTR) << "Failed to lock the key of " << path_ << ": " << strerror(errno);
+    }
+  };
+  set_lock(F_WRLCK);
+  try {
+    f();
+  } catch (...) {
+    set_lock(F_UNLCK);
+    throw;
+  }
+  set_lock(F_UNLCK);
+}
+
+void PersistStore::Flush() {
+  std::lock_guard<std::mutex> lock(mu_);
+  if (!dirty_) {
+    return;
+  }
+  FileLock file_lock(lock_fd_);
+  Sync();
+  LoadIndex(true);
+  WriteIndex();
+}
+
+}  // namespace op
+}  // namespace raf
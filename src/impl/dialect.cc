@@ -89,6 +89,15 @@ bool Dialect::is_enabled(DevType device_type) const {
   return false;
 }
 
+Dialect& Dialect::set_jit() {
+  jit_ = true;
+  return *this;
+}
+
+bool Dialect::is_jit() const {
+  return jit_;
+}
+
 Dialect::TRegistry* Dialect::Registry() {
   return TRegistry::Get();
 }
@@ -103,6 +112,12 @@ bool Dialect::IsEnabled(const std::string& dialect, DevType device_type) {
   return d->is_enabled(device_type);
 }
 
+bool Dialect::IsJIT(const std::string& dialect) {
+  const Dialect* d = TRegistry::Get()->Find(dialect);
+  ICHECK(d) << "Dialect " << dialect << " is not registered.";
+  return d->is_jit();
+}
+
 std::vector<std::string> Dialect::GetEnabledDialects(DevType device_type) {
   std::vector<std::string> ret;
   for (auto dialect : TRegistry::List()) {
@@ -7,6 +7,7 @@
  * \file src/impl/event_pool.cc
  * \brief RAF event pool underlying implementation
  */
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -21,20 +22,98 @@ namespace event_pool {
 using device_api::DeviceAPI;
 using registry::PerDeviceStore;
 
+constexpr uint32_t EventPool::kNumEventFlags;
+
+/*! \brief The capacity of the free list of each flags. The events beyond it are freed directly. */
+constexpr size_t kFreeListCapacity = 4096;
+
+/*!
+ * \brief A bounded lock-free multi-producer multi-consumer queue of the freed events. Each cell has
+ * a sequence number that tells whether it is ready to be pushed or popped at a position, so the
+ * positions are claimed by a single CAS and there is no ABA problem.
+ */
+class EventPool::FreeList {
+ public:
+  explicit FreeList(size_t capacity) : cells_(new Cell[capacity]), mask_(capacity - 1) {
+    CHECK_EQ(capacity & mask_, 0U) << "The capacity must be a power of 2";
+    for (size_t i = 0; i < capacity; ++i) {
+      cells_[i].seq.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  /*! \brief Push an event, or return false if the list is full. */
+  bool Push(void* event) {
+    Cell* cell;
+    size_t pos = tail_.load(std::memory_order_relaxed);
+    while (true) {
+      cell = &cells_[pos & mask_];
+      size_t seq = cell->seq.load(std::memory_order_acquire);
+      intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+      if (diff == 0) {
+        if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = tail_.load(std::memory_order_relaxed);
+      }
+    }
+    cell->event = event;
+    cell->seq.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  /*! \brief Pop an event, or return nullptr if the list is empty. */
+  void* Pop() {
+    Cell* cell;
+    size_t pos = head_.load(std::memory_order_relaxed);
+    while (true) {
+      cell = &cells_[pos & mask_];
+      size_t seq = cell->seq.load(std::memory_order_acquire);
+      intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+      if (diff == 0) {
+        if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return nullptr;
+      } else {
+        pos = head_.load(std::memory_order_relaxed);
+      }
+    }
+    void* event = cell->event;
+    cell->seq.store(pos + mask_ + 1, std::memory_order_release);
+    return event;
+  }
+
+ private:
+  struct Cell {
+    std::atomic<size_t> seq;
+    void* event;
+  };
+
+  std::unique_ptr<Cell[]> cells_;
+  size_t mask_;
+  alignas(64) std::atomic<size_t> head_{0};
+  alignas(64) std::atomic<size_t> tail_{0};
+};
+
 class Event::Impl {
  public:
-  explicit Impl(Device dev, uint32_t flags, void* event)
-      : device_(std::move(dev)), flags_(flags), event_(event) {
+  explicit Impl(EventPool* pool, uint32_t flags, void* event)
+      : pool_(pool), flags_(flags), event_(event) {
   }
 
   ~Impl() {
     if (event_ != nullptr) {
-      EventPool::Get(device_)->RecycleEvent(flags_, event_);
+      pool_->RecycleEvent(flags_, event_);
     }
   }
 
  public:
-  Device device_;
+  /*! \brief The pool of the event, which is never destroyed before the process exits. */
+  EventPool* pool_;
   uint32_t flags_;
   void* event_;
 };
@@ -47,32 +126,41 @@ void* Event::data() const {
 }
 
 EventPool::~EventPool() {
-  for (auto& pr : freed_events_) {
-    for (void* event : pr.second) {
+  for (auto& list : freed_events_) {
+    while (void* event = list->Pop()) {
       api_->FreeEvent(device_, event);
     }
   }
 }
 
 std::shared_ptr<Event> EventPool::GetEvent(uint32_t flags) {
-  std::lock_guard<std::mutex> lock(mutex_);
-  auto& pool = freed_events_[flags];
-  void* event;
-  if (!pool.empty()) {
-    event = pool.back();
-    pool.pop_back();
-  } else {
+  CHECK_LT(flags, kNumEventFlags) << "Unsupported event flags " << flags;
+  void* event = freed_events_[flags]->Pop();
+  if (event == nullptr) {
     event = api_->CreateEvent(device_, flags);
   }
-  return std::shared_ptr<Event>(new Event(std::make_unique<Event::Impl>(device_, flags, event)));
+  return std::shared_ptr<Event>(new Event(std::make_unique<Event::Impl>(this, flags, event)));
+}
+
+std::vector<std::shared_ptr<Event>> EventPool::GetEvents(size_t num, uint32_t flags) {
+  std::vector<std::shared_ptr<Event>> events;
+  events.reserve(num);
+  for (size_t i = 0; i < num; ++i) {
+    events.push_back(GetEvent(flags));
+  }
+  return events;
 }
 
 EventPool::EventPool(const Device& dev) : device_(dev), api_(DeviceAPI::Get(dev.device_type())) {
+  for (auto& list : freed_events_) {
+    list = std::make_unique<FreeList>(kFreeListCapacity);
+  }
 }
 
 void EventPool::RecycleEvent(uint32_t flags, void* event) {
-  std::lock_guard<std::mutex> lock(mutex_);
-  freed_events_[flags].push_back(event);
+  if (!freed_events_[flags]->Push(event)) {
+    api_->FreeEvent(device_, event);
+  }
 }
 
 std::shared_ptr<EventPool> EventPool::Get(const Device& dev) {
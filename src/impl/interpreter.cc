@@ -7,6 +7,7 @@
  * \file src/impl/interpreter.cc
  * \brief RAF interpreter, a naive implementation of executor
  */
+#include "raf/cache.h"
 #include "raf/executor.h"
 #include "raf/ir.h"
 #include "raf/memory_pool.h"
@@ -23,6 +24,8 @@
 #include "../requests.h"
 #include "../op/schema/reduce.h"
 
+#include <algorithm>
+#include <cstdlib>
 #include <list>
 
 namespace raf {
@@ -41,6 +44,7 @@ using binding::NDArrayBinding;
 using binding::SymbolBindingObj;
 using common::shape_utils::BytesCompactTensor;
 using memory_pool::Memory;
+using op::HashKey;
 using requests::Requests;
 using stream_pool::Stream;
 using tensor::Tensor;
@@ -174,9 +178,18 @@ class Interpreter final : public ExprFunctor<Value(const Expr& n)>, public Execu
       return InvokeClosure(call_values);
     } else if (const auto* opv = call_values->callee.as<OpValueObj>()) {
       call_values->args = fschema[opv->op](args);
+      HashKey key;
+      bool cacheable = !Synchronous();
+      if (cacheable) {
+        key << opv->op->name;
+        for (const Value& arg : args) {
+          cacheable = cacheable && HashValue(arg, &key);
+        }
+      }
       Value output_value;
-      WITH_BASE_PROFILER(call_values->device, opv->op->name, "SchedulingCommunication", {},
-                         { output_value = InvokePrimitive(call_values); });
+      WITH_BASE_PROFILER(call_values->device, opv->op->name, "SchedulingCommunication", {}, {
+        output_value = InvokePrimitive(call_values, cacheable ? &key : nullptr);
+      });
       return output_value;
     }
     LOG(FATAL) << "ValueError: type " << call_values->callee->GetTypeKey() << " is not callable";
@@ -244,7 +257,51 @@ class Interpreter final : public ExprFunctor<Value(const Expr& n)>, public Execu
   }
 
  public:
-  Value InvokePrimitive(const CallValues& call) {
+  /*!
+   * \brief Whether the ops are executed synchronously without reusing the OpEnvs, which is
+   * enabled by RAF_INTERPRETER_SYNC=1 to debug the errors of the asynchronous kernels.
+   */
+  static bool Synchronous() {
+    static const bool sync = [] {
+      const char* env = getenv("RAF_INTERPRETER_SYNC");
+      return env != nullptr && std::atoi(env) != 0;
+    }();
+    return sync;
+  }
+
+  /*!
+   * \brief Append the signature of an argument to the OpEnv cache key, which is the shape, dtype
+   * and device of a tensor, and the value of the others.
+   * \return Whether the argument can be a part of the key.
+   */
+  static bool HashValue(const Value& value, HashKey* key) {
+    if (!value.defined()) {
+      *key << static_cast<int8_t>(0);
+    } else if (const auto* tensor = value.as<TensorValueObj>()) {
+      const DLTensor* dlt = tensor->tensor.operator->();
+      *key << static_cast<int8_t>(1) << *dlt << dlt->device;
+    } else if (const auto* tuple = value.as<TupleValueObj>()) {
+      *key << static_cast<int8_t>(2) << static_cast<int64_t>(tuple->fields.size());
+      for (const Value& field : tuple->fields) {
+        if (!HashValue(field, key)) {
+          return false;
+        }
+      }
+    } else if (const auto* int_value = value.as<IntValueObj>()) {
+      *key << static_cast<int8_t>(3) << DLDataType(int_value->dtype) << int_value->value;
+    } else if (const auto* float_value = value.as<FloatValueObj>()) {
+      *key << static_cast<int8_t>(4) << DLDataType(float_value->dtype) << float_value->value;
+    } else if (const auto* bool_value = value.as<BoolValueObj>()) {
+      *key << static_cast<int8_t>(5) << bool_value->value;
+    } else if (const auto* str_value = value.as<StringValueObj>()) {
+      *key << static_cast<int8_t>(6) << str_value->value;
+    } else {
+      return false;
+    }
+    return true;
+  }
+
+  Value InvokePrimitive(const CallValues& call, HashKey* key = nullptr) {
     const Op& op = Downcast<OpValue>(call->callee)->op;
     bool use_upper_bound = false;
     static auto upper_bound_map = Op::GetAttrMap<Op>("TRAFUpperBoundOp");
@@ -259,9 +316,30 @@ class Interpreter final : public ExprFunctor<Value(const Expr& n)>, public Execu
     ICHECK(call->out.defined()) << "ValueError: Tensor compute of " << op->name
                                 << " is not implemented.";
     AllocOutputBuffer(call->out);
-    std::shared_ptr<OpEnv> op_env = Dispatch(call);
+    std::shared_ptr<OpEnv> op_env;
+    std::string cache_key;
+    if (key != nullptr) {
+      // The output depends on the inputs, except for the ops whose outputs are declared by the
+      // data of the inputs, e.g., the upper bound ops.
+      *key << static_cast<int8_t>(use_upper_bound);
+      HashValue(call->out, key);
+      cache_key.assign(key->byte_vector.begin(), key->byte_vector.end());
+      auto it = op_env_cache_.find(cache_key);
+      if (it != op_env_cache_.end()) {
+        op_env = it->second;
+      }
+    }
+    if (op_env == nullptr) {
+      op_env = Dispatch(call);
+      if (op_env != nullptr && key != nullptr) {
+        if (op_env_cache_.size() >= kMaxCachedOpEnvs) {
+          op_env_cache_.clear();
+        }
+        op_env_cache_[cache_key] = op_env;
+      }
+    }
     if (op_env != nullptr) {
-      InvokePrimitiveOpEnv(std::move(op_env), call, use_upper_bound);
+      InvokePrimitiveOpEnv(std::move(op_env), call, use_upper_bound, key != nullptr);
     } else {
       LOG(FATAL) << "ValueError: Cannot dispatch " << op->name << "@" << call->device.c_str();
       throw;
@@ -276,11 +354,62 @@ class Interpreter final : public ExprFunctor<Value(const Expr& n)>, public Execu
     f(call);
   }
 
+  /*!
+   * \brief Launch a cached OpEnv asynchronously. Its streams and distributed resources are
+   * requested once and kept with the OpEnv, and its workspace is requested for each launch.
+   * The ops without streams run on the default stream, which is ordered with all other streams,
+   * while an op on a stream waits for the earlier ops on the other streams. Therefore, every later
+   * use of a memory is ordered after the launched op, and the workspace is returned to the memory
+   * pool right after the launch, i.e., the frees are stream-ordered.
+   */
+  void LaunchCachedOpEnv(const std::shared_ptr<OpEnv>& op_env, Requests* req,
+                         const CallValues& call) {
+    const Op& op = Downcast<OpValue>(call->callee)->op;
+    for (int i = 0, n = req->stream.size(); i < n; ++i) {
+      if (req->stream[i].stream == nullptr) {
+        RequestStream(req, i);
+      }
+    }
+    for (int i = 0, n = req->distributed.size(); i < n; ++i) {
+      RequestDistributed(req, i);
+    }
+    WITH_BASE_PROFILER(call->device, op->name, "WorkspaceRequest",
+                       {"Count: " + std::to_string(req->workspace.size())}, {
+                         for (int i = 0, n = req->workspace.size(); i < n; ++i) {
+                           RequestWorkspace(req, i);
+                         }
+                       });
+    // Wait for the earlier ops on the streams other than the ones of this op.
+    if (!req->stream.empty()) {
+      std::vector<std::shared_ptr<Stream>> streams;
+      std::vector<void*> handles;
+      for (const auto& entry : req->stream) {
+        streams.push_back(entry.stream);
+        handles.push_back(entry.stream->data());
+      }
+      for (const auto& stream : inflight_streams_) {
+        if (std::find(handles.begin(), handles.end(), stream->data()) == handles.end()) {
+          stream->Wait();
+        }
+      }
+      inflight_streams_ = std::move(streams);
+    }
+
+    WITH_BASE_PROFILER(call->device, op->name, "CUDA_CALL", {}, { op_env->Execute(call); });
+
+    for (auto& entry : req->workspace) {
+      *entry.dest = nullptr;
+      entry.memory.reset();
+    }
+  }
+
   void InvokePrimitiveOpEnv(std::shared_ptr<OpEnv> op_env, const CallValues& call,
-                            bool use_upper_bound) {
+                            bool use_upper_bound, bool cached = false) {
     const Op& op = Downcast<OpValue>(call->callee)->op;
     std::shared_ptr<Requests> req = op_env->GetRequests();
-    {
+    if (cached) {
+      LaunchCachedOpEnv(op_env, req.get(), call);
+    } else {
       // note: Request workspace, workspace is kind of special memory which will be freed once
       // this op is done.
       WITH_BASE_PROFILER(call->device, op->name, "WorkspaceRequest",
@@ -308,12 +437,10 @@ class Interpreter final : public ExprFunctor<Value(const Expr& n)>, public Execu
                              RequestDistributed(req.get(), i);
                            }
                          });
-    }
 
-    // note: Execute the Operator.
-    WITH_BASE_PROFILER(call->device, op->name, "CUDA_CALL", {}, { op_env->Execute(call); });
+      // note: Execute the Operator.
+      WITH_BASE_PROFILER(call->device, op->name, "CUDA_CALL", {}, { op_env->Execute(call); });
 
-    {
       // note: Force op to run synchronously.
       for (int i = 0, n = req->stream.size(); i < n; ++i) {
         req->stream[i].stream->Wait();
@@ -396,6 +523,13 @@ class Interpreter final : public ExprFunctor<Value(const Expr& n)>, public Execu
   }
 
  private:
+  /*! \brief The maximum number of cached OpEnvs, beyond which the cache is reset. */
+  static constexpr size_t kMaxCachedOpEnvs = 4096;
+  /*! \brief The OpEnvs keyed by the op and the signatures of its arguments and output. */
+  std::unordered_map<std::string, std::shared_ptr<OpEnv>> op_env_cache_;
+  /*! \brief The streams of the last launched op on non-default streams. */
+  std::vector<std::shared_ptr<Stream>> inflight_streams_;
+
   void AllocOutputBuffer(Value& out) {
     std::vector<DLTensor*> out_tensors;
     std::vector<TensorValue> out_tvs;
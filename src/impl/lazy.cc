@@ -0,0 +1,296 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/impl/lazy.cc
+ * \brief The lazy mode of the imperative ops, which records the ops into a pending segment and
+ * runs the segment with the VM once a value of it is observed.
+ */
+#include <atomic>
+#include <string>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "raf/binding.h"
+#include "raf/device.h"
+#include "raf/ir.h"
+#include "raf/pass.h"
+#include "raf/registry.h"
+#include "raf/value.h"
+#include "raf/vm/vm.h"
+
+namespace raf {
+namespace binding {
+namespace lazy {
+
+using namespace raf::ir;
+using namespace raf::value;
+using registry::GetPackedFunc;
+using registry::PackedFunc;
+using registry::TVMArgs;
+using registry::TVMRetValue;
+
+/*! \brief A compiled segment, which is reused by the structurally equal segments. */
+struct CompiledSegment {
+  Function func;
+  Device device;
+  tvm::runtime::Module vm;
+};
+
+class LazyMgr {
+ public:
+  /*! \brief The maximal number of pending ops, beyond which the segment is flushed. */
+  static constexpr size_t kMaxPendingOps = 1024;
+
+  std::mutex mu;
+  std::atomic<bool> enabled{false};
+  /*! \brief The pending vars in the order of recording, which are computed by the segment. */
+  std::vector<Var> pending;
+  std::unordered_set<const VarNode*> pending_set;
+  /*! \brief The compiled segments indexed by their structural hash. */
+  std::unordered_map<size_t, std::vector<CompiledSegment>> cache;
+
+  static LazyMgr* Get() {
+    static LazyMgr* instance = new LazyMgr();
+    return instance;
+  }
+
+  /*!
+   * \brief Whether an argument of an op can be recorded, i.e., it is a constant, a tensor without
+   * gradient, a pending var, or an array of them.
+   */
+  bool IsRecordable(const ObjectRef& arg) {
+    if (const auto* var = arg.as<VarNode>()) {
+      BindingEntry entry = LookupBinding(var);
+      if (const auto* bound = entry.as<NDArrayBindingObj>()) {
+        return !bound->tape.defined();
+      }
+      return pending_set.count(var) > 0;
+    }
+    if (const auto* array = arg.as<ArrayNode>()) {
+      for (const ObjectRef& field : *array) {
+        if (!IsRecordable(field)) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  void Push(const Var& var) {
+    pending.push_back(var);
+    pending_set.insert(var.get());
+  }
+
+  /*! \brief Count the references of the pending vars from the bound exprs of the segment. */
+  static void CountRefs(const Expr& expr, std::unordered_map<const VarNode*, int>* refs) {
+    if (const auto* var = expr.as<VarNode>()) {
+      ++(*refs)[var];
+    } else if (const auto* call = expr.as<CallNode>()) {
+      for (const Expr& arg : call->args) {
+        CountRefs(arg, refs);
+      }
+    } else if (const auto* tuple = expr.as<TupleNode>()) {
+      for (const Expr& field : tuple->fields) {
+        CountRefs(field, refs);
+      }
+    } else if (const auto* item = expr.as<TupleGetItemNode>()) {
+      CountRefs(item->tuple, refs);
+    }
+  }
+
+  /*! \brief Compile the function with the VM pipeline, or reuse the compiled equal function. */
+  tvm::runtime::Module Compile(const Function& func, const Device& device) {
+    size_t hash = tvm::StructuralHash()(func);
+    hash = dmlc::HashCombine(hash, static_cast<int>(device.device_type()));
+    hash = dmlc::HashCombine(hash, device.device_id());
+    auto& entries = cache[hash];
+    for (const auto& entry : entries) {
+      if (entry.device.device_type() == device.device_type() &&
+          entry.device.device_id() == device.device_id() &&
+          tvm::StructuralEqual()(entry.func, func)) {
+        return entry.vm;
+      }
+    }
+    static const PackedFunc& make_compiler = GetPackedFunc("raf.vm.VMCompiler");
+    static const PackedFunc& make_vm = GetPackedFunc("raf.vm.VirtualMachine");
+    tvm::runtime::Module compiler = make_compiler();
+    Map<Integer, Device> device_map{{Integer(static_cast<int>(device.device_type())), device}};
+    compiler.GetFunction("lower")(IRModule::FromExpr(func), device_map);
+    tvm::runtime::Module exec = compiler.GetFunction("get_executable")();
+    tvm::runtime::Module vm = make_vm(exec, false, false);
+    vm.GetFunction("set_devices")(device);
+    entries.push_back(CompiledSegment{func, device, vm});
+    return vm;
+  }
+
+  /*!
+   * \brief Run the pending segment and bind its results. Only the pending vars that are still
+   * referenced out of the segment are the outputs, so the intermediate results can be fused.
+   */
+  void Flush() {
+    if (pending.empty()) {
+      return;
+    }
+    std::vector<Var> vars;
+    vars.swap(pending);
+    pending_set.clear();
+    std::unordered_map<const VarNode*, int> refs;
+    std::unordered_set<const VarNode*> tuples;
+    for (const Var& var : vars) {
+      Expr expr = Downcast<SymbolBinding>(LookupBinding(var.get()))->expr;
+      // The fields of a tuple output share the call of the tuple, which is counted once.
+      if (const auto* item = expr.as<TupleGetItemNode>()) {
+        const VarNode* tuple = item->tuple.as<VarNode>();
+        if (tuples.insert(tuple).second) {
+          CountRefs(Downcast<SymbolBinding>(LookupBinding(tuple))->expr, &refs);
+        }
+      } else {
+        CountRefs(expr, &refs);
+      }
+    }
+    Array<Expr> fields;
+    std::vector<Var> outputs;
+    for (const Var& var : vars) {
+      // One reference is held by the vars above, the others by the user or the segment itself.
+      if (var.use_count() - 1 > refs[var.get()]) {
+        fields.push_back(var);
+        outputs.push_back(var);
+      }
+    }
+    if (outputs.empty()) {
+      return;
+    }
+    static const PackedFunc& extract = GetPackedFunc("raf.pass_.ExtractBinding");
+    Var root = BindSymbol(Tuple(fields));
+    Expr body = extract(root, Array<Var>{});
+    Array<Var> params = FreeVars(body);
+    std::vector<Value> inputs;
+    Device device;
+    for (const Var& param : params) {
+      const auto* bound = LookupBinding(param.get()).as<NDArrayBindingObj>();
+      CHECK(bound != nullptr) << "The lazy segment uses an unbound var " << param->name_hint();
+      inputs.push_back(bound->value);
+      const auto* tensor = bound->value.as<TensorValueObj>();
+      if (device.device_type() == DevType::kUnknown() && tensor != nullptr) {
+        device = Device(tensor->tensor->device);
+      }
+    }
+    if (device.device_type() == DevType::kUnknown()) {
+      device = Device::Current(true);
+    }
+    tvm::runtime::Module vm = Compile(Function(params, body, {}, {}), device);
+    auto* vm_ptr = static_cast<executor::vm::VirtualMachine*>(vm.operator->());
+    Value result = vm_ptr->Run(vm_ptr->PrepareVMContext("main", inputs));
+    const auto* tuple = result.as<TupleValueObj>();
+    CHECK(tuple != nullptr && tuple->fields.size() == outputs.size());
+    for (size_t i = 0; i < outputs.size(); ++i) {
+      RebindNDArray(outputs[i], tuple->fields[i]);
+    }
+  }
+};
+
+bool Record(const char* op_name, const TVMArgs& args, TVMRetValue* ret) {
+  LazyMgr* mgr = LazyMgr::Get();
+  if (!mgr->enabled.load()) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(mgr->mu);
+  bool recordable = true;
+  for (int i = 0; i < args.size() && recordable; ++i) {
+    if (args[i].type_code() == kTVMObjectHandle) {
+      recordable = mgr->IsRecordable(args[i].AsObjectRef<ObjectRef>());
+    }
+  }
+  Var out;
+  Type type;
+  if (recordable) {
+    // The symbolic API builds the call, whose type is inferred from the annotated input vars.
+    static constexpr size_t kPrefix = sizeof("raf.op.") - 1;
+    const PackedFunc& sym = GetPackedFunc(std::string("raf.op.sym.") + (op_name + kPrefix));
+    try {
+      TVMRetValue rv;
+      sym.CallPacked(args, &rv);
+      out = rv;
+      Expr call = Downcast<SymbolBinding>(LookupBinding(out.get()))->expr;
+      type = pass::InferType(call)->checked_type();
+    } catch (const dmlc::Error&) {
+      recordable = false;
+    }
+  }
+  const auto* tuple_type = type.as<TupleTypeNode>();
+  if (recordable && tuple_type != nullptr) {
+    for (const Type& field : tuple_type->fields) {
+      recordable &= field->IsInstance<TensorTypeNode>();
+    }
+  } else if (recordable) {
+    recordable = type->IsInstance<TensorTypeNode>();
+  }
+  if (!recordable) {
+    // The op runs eagerly, so the pending inputs are to be materialized.
+    mgr->Flush();
+    return false;
+  }
+  Expr call = Downcast<SymbolBinding>(LookupBinding(out.get()))->expr;
+  out = BindSymbol(call, "", type);
+  if (tuple_type != nullptr) {
+    Array<ObjectRef> fields;
+    for (size_t i = 0; i < tuple_type->fields.size(); ++i) {
+      Var field = BindSymbol(TupleGetItem(out, i), "", tuple_type->fields[i]);
+      mgr->Push(field);
+      fields.push_back(field);
+    }
+    *ret = fields;
+  } else {
+    mgr->Push(out);
+    *ret = out;
+  }
+  if (mgr->pending.size() >= LazyMgr::kMaxPendingOps) {
+    mgr->Flush();
+  }
+  return true;
+}
+
+void Materialize(const VarNode* var) {
+  LazyMgr* mgr = LazyMgr::Get();
+  // Nothing is pending out of the lazy mode, which flushes the segment on exit.
+  if (!mgr->enabled.load()) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mgr->mu);
+  if (mgr->pending_set.count(var)) {
+    mgr->Flush();
+  }
+}
+
+void Flush() {
+  LazyMgr* mgr = LazyMgr::Get();
+  std::lock_guard<std::mutex> lock(mgr->mu);
+  mgr->Flush();
+}
+
+bool SetLazyMode(bool enabled) {
+  LazyMgr* mgr = LazyMgr::Get();
+  bool prev = mgr->enabled.exchange(enabled);
+  if (!enabled) {
+    Flush();
+  }
+  return prev;
+}
+
+bool IsPending(Var var) {
+  LazyMgr* mgr = LazyMgr::Get();
+  std::lock_guard<std::mutex> lock(mgr->mu);
+  return mgr->pending_set.count(var.get()) > 0;
+}
+
+RAF_REGISTER_GLOBAL("raf.binding.SetLazyMode").set_body_typed(SetLazyMode);
+RAF_REGISTER_GLOBAL("raf.binding.FlushLazy").set_body_typed(Flush);
+RAF_REGISTER_GLOBAL("raf.binding.IsLazyPending").set_body_typed(IsPending);
+
+}  // namespace lazy
+}  // namespace binding
+}  // namespace raf
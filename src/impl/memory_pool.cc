@@ -7,9 +7,16 @@
  * \file src/impl/memory_pool.cc
  * \brief RAF memory pool manager
  */
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <tuple>
 #include <unordered_map>
 #include "raf/device.h"
+#include "raf/ir.h"
 #include "raf/memory_pool.h"
+#include "raf/memory_profiler.h"
 #include "raf/registry.h"
 
 #ifdef RAF_USE_CUDA
@@ -80,22 +87,85 @@ int64_t Memory::GetAllocBytes(const Device& dev, int64_t nbytes) {
   return mgr->GetPool(dev, "")->GetAllocBytes(nbytes);
 }
 
+/*! \brief The registered functions that release the cached memory. */
+struct ReleaseRegistry {
+  static ReleaseRegistry* Get() {
+    static ReleaseRegistry* instance = new ReleaseRegistry();
+    return instance;
+  }
+
+  /*! \brief The functions keyed by their names. */
+  std::map<std::string, Memory::FRelease> funcs;
+  /*!
+   * \brief The mutex to access funcs, which is also held while calling them, so a function is not
+   * removed (e.g., when its VM is destroyed) while it is running.
+   */
+  std::mutex mu;
+};
+
+/*!
+ * \brief Run the allocation, and retry it once after releasing the cached memory if it fails (e.g.,
+ * out of memory). The allocations made while releasing the cached memory are not retried.
+ */
+template <typename F>
+auto AllocWithRetry(const Device& dev, F alloc) -> decltype(alloc()) {
+  thread_local bool releasing = false;
+  try {
+    return alloc();
+  } catch (const dmlc::Error& e) {
+    if (releasing) {
+      throw;
+    }
+    LOG(WARNING) << "Failed to allocate memory on " << dev.c_str()
+                 << ". Release the cached memory and retry.";
+    releasing = true;
+    try {
+      Memory::ReleaseCachedMemory(dev);
+    } catch (...) {
+      releasing = false;
+      throw;
+    }
+    releasing = false;
+  }
+  return alloc();
+}
+
 std::shared_ptr<Memory> Memory::Alloc(const Device& dev, int64_t nbytes, int64_t alignment) {
   MemoryPoolManager* mgr = MemoryPoolManager::Get();
-  return mgr->GetPool(dev, "")->Alloc(nbytes, alignment);
+  auto memory =
+      AllocWithRetry(dev, [&]() { return mgr->GetPool(dev, "")->Alloc(nbytes, alignment); });
+  auto profiler = memory_profiler::MemoryProfiler::Get();
+  if (profiler->IsTracingAllocation()) {
+    return profiler->TraceAllocation(memory, nbytes);
+  }
+  return memory;
 }
 
 std::shared_ptr<Memory> Memory::AllocAsync(const Device& dev, int64_t nbytes, void* stream,
                                            int64_t alignment) {
   MemoryPoolManager* mgr = MemoryPoolManager::Get();
-  return mgr->GetPool(dev, "")->AllocAsync(nbytes, stream, alignment);
+  auto memory = AllocWithRetry(
+      dev, [&]() { return mgr->GetPool(dev, "")->AllocAsync(nbytes, stream, alignment); });
+  auto profiler = memory_profiler::MemoryProfiler::Get();
+  if (profiler->IsTracingAllocation()) {
+    return profiler->TraceAllocation(memory, nbytes);
+  }
+  return memory;
 }
 
 std::vector<std::shared_ptr<Memory> > Memory::AllocBatch(const Device& dev,
                                                          const std::vector<int64_t>& nbytes,
                                                          int64_t alignment) {
   MemoryPoolManager* mgr = MemoryPoolManager::Get();
-  return mgr->GetPool(dev, "")->AllocBatch(nbytes, alignment);
+  auto memories =
+      AllocWithRetry(dev, [&]() { return mgr->GetPool(dev, "")->AllocBatch(nbytes, alignment); });
+  auto profiler = memory_profiler::MemoryProfiler::Get();
+  if (profiler->IsTracingAllocation()) {
+    for (size_t i = 0; i < memories.size(); ++i) {
+      memories[i] = profiler->TraceAllocation(memories[i], nbytes[i]);
+    }
+  }
+  return memories;
 }
 
 std::pair<float, float> Memory::GetPoolSize(const Device& dev) {
@@ -125,6 +195,159 @@ MemoryPool* Memory::InitPool(const Device& dev, const std::string& name) {
   return mgr->GetPool(dev, name);
 }
 
+void Memory::RegisterRelease(const std::string& name, FRelease release) {
+  ReleaseRegistry* registry = ReleaseRegistry::Get();
+  std::lock_guard<std::mutex> lock(registry->mu);
+  CHECK_EQ(registry->funcs.count(name), 0) << "Memory release function " << name
+                                           << " has been registered";
+  registry->funcs[name] = std::move(release);
+}
+
+void Memory::RemoveRelease(const std::string& name) {
+  ReleaseRegistry* registry = ReleaseRegistry::Get();
+  std::lock_guard<std::mutex> lock(registry->mu);
+  registry->funcs.erase(name);
+}
+
+int64_t Memory::ReleaseCachedMemory(const Device& dev) {
+  ReleaseRegistry* registry = ReleaseRegistry::Get();
+  {
+    std::lock_guard<std::mutex> lock(registry->mu);
+    for (const auto& kv : registry->funcs) {
+      kv.second(dev);
+    }
+  }
+  // The released memory goes back to the pool, so return it to the device as well.
+  return MemoryPoolManager::Get()->GetPool(dev, "")->FreeUnused();
+}
+
+/*! \brief The peak usages of the recent steps on a device. */
+struct StepHistory {
+  /*! \brief The peak used bytes of the recent steps. */
+  std::deque<int64_t> peaks;
+  /*! \brief The mutex to access peaks. */
+  std::mutex mu;
+};
+
+bool Memory::StepBoundary(const Device& dev, double threshold, int window) {
+  static PerDeviceStore<StepHistory, true> histories;
+  MemoryPool* pool = MemoryPoolManager::Get()->GetPool(dev, "");
+  int64_t peak = pool->ResetPeakUsed();
+  if (peak <= 0) {
+    // The pool does not track its usage, or nothing is allocated in the last step.
+    return false;
+  }
+  std::shared_ptr<StepHistory> history = histories.Get(dev);
+  std::lock_guard<std::mutex> lock(history->mu);
+  history->peaks.push_back(peak);
+  while (static_cast<int>(history->peaks.size()) > std::max(window, 1)) {
+    history->peaks.pop_front();
+  }
+  int64_t high_water_mark = *std::max_element(history->peaks.begin(), history->peaks.end());
+  float used, allocated;
+  std::tie(used, allocated) = pool->GetPoolSize();
+  if (allocated * 1048576.0 <= threshold * high_water_mark) {
+    return false;
+  }
+  // The memory in use (e.g., the parameters and the inputs) stays alive across steps, so only the
+  // rest of the high-water mark is reserved.
+  int64_t reserve_bytes = high_water_mark - static_cast<int64_t>(used * 1048576.0);
+  int64_t free_bytes = pool->Compact(reserve_bytes);
+  DLOG(INFO) << "Compacted the memory pool of " << dev.c_str() << ": released " << free_bytes
+             << " bytes and reserved " << reserve_bytes << " bytes";
+  return true;
+}
+
+struct MemoryQuota::DeviceState {
+  /*! \brief The size of the shared reserve in bytes. */
+  int64_t reserve = 0;
+  /*! \brief The total size borrowed from the shared reserve. */
+  int64_t borrowed = 0;
+  /*! \brief The quotas of the tenants keyed by their names. */
+  std::unordered_map<std::string, std::shared_ptr<MemoryQuota>> quotas;
+  /*! \brief The mutex to access this state and all quotas of the device. */
+  std::mutex mu;
+};
+
+/*! \brief Get the accounting of the given device. */
+static std::shared_ptr<MemoryQuota::DeviceState> GetQuotaState(const Device& dev) {
+  static PerDeviceStore<MemoryQuota::DeviceState, true> states;
+  return states.Get(dev);
+}
+
+std::shared_ptr<MemoryQuota> MemoryQuota::Get(const Device& dev, const std::string& name) {
+  auto state = GetQuotaState(dev);
+  std::lock_guard<std::mutex> lock(state->mu);
+  auto& quota = state->quotas[name];
+  if (quota == nullptr) {
+    quota = std::make_shared<MemoryQuota>(name, state);
+  }
+  return quota;
+}
+
+void MemoryQuota::SetSharedReserve(const Device& dev, int64_t nbytes) {
+  CHECK_GE(nbytes, 0);
+  auto state = GetQuotaState(dev);
+  std::lock_guard<std::mutex> lock(state->mu);
+  state->reserve = nbytes;
+}
+
+void MemoryQuota::SetLimit(int64_t nbytes) {
+  CHECK_GE(nbytes, 0);
+  std::lock_guard<std::mutex> lock(state_->mu);
+  limit_ = nbytes;
+}
+
+bool MemoryQuota::Acquire(int64_t nbytes) {
+  std::lock_guard<std::mutex> lock(state_->mu);
+  int64_t borrowed = limit_ > 0 ? std::max<int64_t>(used_ + nbytes - limit_, 0) : 0;
+  if (state_->borrowed + borrowed - borrowed_ > state_->reserve) {
+    return false;
+  }
+  state_->borrowed += borrowed - borrowed_;
+  borrowed_ = borrowed;
+  used_ += nbytes;
+  return true;
+}
+
+void MemoryQuota::Release(int64_t nbytes) {
+  std::lock_guard<std::mutex> lock(state_->mu);
+  used_ -= nbytes;
+  // The borrowed memory is returned first, so the reserve is available to the others soon.
+  int64_t borrowed = limit_ > 0 ? std::max<int64_t>(used_ - limit_, 0) : 0;
+  borrowed = std::min(borrowed, borrowed_);
+  state_->borrowed -= borrowed_ - borrowed;
+  borrowed_ = borrowed;
+}
+
+std::shared_ptr<Memory> MemoryQuota::Alloc(int64_t nbytes,
+                                           const std::function<std::shared_ptr<Memory>()>& alloc) {
+  if (!Acquire(nbytes)) {
+    int64_t used, borrowed;
+    std::tie(used, borrowed) = GetUsage();
+    LOG(FATAL) << "Out-Of-Memory. Tried to allocate " << nbytes << " bytes for " << name_
+               << "; Already used " << used << " bytes, including " << borrowed
+               << " bytes borrowed from the shared reserve";
+    throw;
+  }
+  std::shared_ptr<Memory> memory;
+  try {
+    memory = alloc();
+  } catch (...) {
+    Release(nbytes);
+    throw;
+  }
+  // The returned memory aliases the allocated one, and the charge is returned along with it.
+  Memory* ptr = memory.get();
+  std::shared_ptr<MemoryQuota> self = shared_from_this();
+  return std::shared_ptr<Memory>(ptr, [memory, self, nbytes](Memory*) { self->Release(nbytes); });
+}
+
+std::pair<int64_t, int64_t> MemoryQuota::GetUsage() {
+  std::lock_guard<std::mutex> lock(state_->mu);
+  return {used_, borrowed_};
+}
+
 /*!
  * \brief RemovePool Disable the current memory pool, the memory chuncks in this pool will not
  * be freed unitl there is nobody using to it.
@@ -169,5 +392,37 @@ RAF_REGISTER_GLOBAL("raf.memory_pool.ResetPool").set_body_typed([](const Device&
   return ResetPool(dev);
 });
 
+RAF_REGISTER_GLOBAL("raf.memory_pool.ReleaseCachedMemory").set_body_typed([](const Device& dev) {
+  return Memory::ReleaseCachedMemory(dev);
+});
+
+RAF_REGISTER_GLOBAL("raf.memory_pool.StepBoundary")
+    .set_body_typed([](const Device& dev, double threshold, int window) {
+      return Memory::StepBoundary(dev, threshold, window);
+    });
+
+RAF_REGISTER_GLOBAL("raf.memory_pool.SetQuota")
+    .set_body_typed([](const Device& dev, const std::string& tenant, int64_t nbytes) {
+      MemoryQuota::Get(dev, tenant)->SetLimit(nbytes);
+    });
+
+RAF_REGISTER_GLOBAL("raf.memory_pool.SetSharedReserve")
+    .set_body_typed([](const Device& dev, int64_t nbytes) {
+      MemoryQuota::SetSharedReserve(dev, nbytes);
+    });
+
+RAF_REGISTER_GLOBAL("raf.memory_pool.GetQuotaUsage")
+    .set_body_typed([](const Device& dev, const std::string& tenant) {
+      auto usage = MemoryQuota::Get(dev, tenant)->GetUsage();
+      return ir::Array<ir::IntImm>{ir::IntImm(ir::DataType::Int(64), usage.first),
+                                   ir::IntImm(ir::DataType::Int(64), usage.second)};
+    });
+
+RAF_REGISTER_GLOBAL("raf.memory_pool.GetPoolSize").set_body_typed([](const Device& dev) {
+  auto size = Memory::GetPoolSize(dev);
+  return ir::Array<ir::FloatImm>{ir::FloatImm(ir::DataType::Float(32), size.first),
+                                 ir::FloatImm(ir::DataType::Float(32), size.second)};
+});
+
 }  // namespace memory_pool
 }  // namespace raf
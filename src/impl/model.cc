@@ -29,7 +29,9 @@ using pass::AutoDataParallel;
 using pass::AutoDiff;
 using pass::BindParam;
 using pass::CanonicalizeOps;
+using pass::DeadCodeElimination;
 using pass::FoldConstant;
+using pass::SimplifyInference;
 
 ObjectRef RunModel(ir::IRModule mod, Array<Expr> args) {
   ir::IRModule updated_mod = ir::IRModule(mod->functions);
@@ -56,9 +58,9 @@ ObjectRef RunModel(ir::IRModule mod, Array<Expr> args) {
   updated_mod->Add(gvar, func);
 
   if (!requires_grad) {
-    // TODO(haibin): add simplify inference pass - simplify the compute of
-    // BN, LN, Dropout, GN, etc.
-    raf::pass::RAFSequential seq({CanonicalizeOps(), FoldConstant()});
+    // TODO(haibin): simplify the compute of LN, Dropout, GN, etc.
+    raf::pass::RAFSequential seq(
+        {CanonicalizeOps(), SimplifyInference(), FoldConstant(), DeadCodeElimination()});
     updated_mod = seq(updated_mod);
     func = Downcast<Function>(updated_mod->Lookup("main"));
     auto call_node = Call(func, args);
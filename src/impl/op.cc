@@ -32,7 +32,7 @@ using namespace raf::value;
 using executor::Executor;
 using requests::Requests;
 
-std::vector<std::string> dispatch_error_msgs;
+thread_local std::vector<std::string> dispatch_error_msgs;
 
 CallValues CallValues::make(value::Value callee, ir::Attrs args) {
   ObjectPtr<CallValuesNode> n = make_object<CallValuesNode>();
@@ -204,6 +204,118 @@ std::shared_ptr<OpEnv> Dispatch(const CallValues& call) {
   return nullptr;
 }
 
+/*!
+ * \brief Get the call values of the op called by a primitive function, if the function only calls
+ * one op with its parameters and constants.
+ * \param call The call values of the function.
+ * \param param_indices The index of the function parameter of each argument of the op, or -1 if
+ * the argument is a constant.
+ * \return The call values of the op, or undefined if the function calls more than one op.
+ */
+CallValues GetSingleOpCallValues(const CallValues& call, std::vector<int>* param_indices) {
+  auto func = Downcast<ClosureValue>(call->callee)->func;
+  const auto* body = func->body.as<CallNode>();
+  if (body == nullptr || body->op.as<OpNode>() == nullptr) {
+    return CallValues();
+  }
+  Array<Value> func_args = GetListArgs(call->args);
+  Array<Value> args;
+  for (const auto& arg : body->args) {
+    if (const auto* relay_const_node = arg.as<RelayConstantNode>()) {
+      const auto* node = static_cast<const ConstantNode*>(relay_const_node);
+      args.push_back(Downcast<Value>(node->value));
+      param_indices->push_back(-1);
+      continue;
+    }
+    int index = -1;
+    for (size_t i = 0; i < func->params.size(); ++i) {
+      if (func->params[i].same_as(arg)) {
+        index = i;
+        break;
+      }
+    }
+    if (index < 0) {
+      return CallValues();
+    }
+    args.push_back(func_args[index]);
+    param_indices->push_back(index);
+  }
+  Op op = Downcast<Op>(body->op);
+  auto ret = CallValues::make(OpValue::make(op), GetOpAttr<FRAFSchema>(op, "FRAFSchema")(args));
+  ret->device = call->device;
+  ret->out = call->out;
+  return ret;
+}
+
+std::shared_ptr<OpEnv> DispatchFallback(const CallValues& call) {
+  CallValues op_call = call;
+  // The dialect that Dispatch uses, which is known unless the call is a base op.
+  std::string jit_dialect;
+  std::vector<int> param_indices;
+  bool fused = call->callee.as<ClosureValueObj>() != nullptr;
+  if (fused) {
+    auto dialect = call->callee.as<ClosureValueObj>()->func->GetAttr<String>(attr::kDialect);
+    if (!dialect.defined() || !Dialect::IsJIT(dialect.value())) {
+      return nullptr;
+    }
+    jit_dialect = dialect.value();
+    op_call = GetSingleOpCallValues(call, &param_indices);
+    if (!op_call.defined()) {
+      return nullptr;
+    }
+  }
+  Op op = Downcast<OpValue>(op_call->callee)->op;
+  if (IsDialectOp(op)) {
+    if (!fused && !Dialect::IsJIT(GetDialect(op))) {
+      return nullptr;
+    }
+    jit_dialect = GetDialect(op);
+    auto base_op = GetBaseOp(op);
+    base_op->op_type = op->op_type;
+    op = base_op;
+  } else if (!fused && OpEnvMaker::Get(op->name) != nullptr) {
+    // The op is implemented without dialects, e.g., the shape ops.
+    return nullptr;
+  }
+  auto dialect_list = OpDialect::GetDispatchList(op, op_call->device.device_type());
+  if (jit_dialect.empty()) {
+    // Dispatch takes the first dialect in the list, unless it fails to make the OpEnv.
+    if (dialect_list.empty() || !Dialect::IsJIT(dialect_list.front().dialect)) {
+      return nullptr;
+    }
+    jit_dialect = dialect_list.front().dialect;
+  }
+  std::shared_ptr<OpEnv> env;
+  for (const auto& entry : dialect_list) {
+    if (entry.dialect == jit_dialect || Dialect::IsJIT(entry.dialect)) {
+      continue;
+    }
+    auto dialect_op = Op::Get(entry.dialect_op);
+    dialect_op->op_type = op->op_type;
+    try {
+      env = OpEnvMaker::Make(dialect_op->name, op_call);
+    } catch (const dmlc::Error& e) {
+      env = nullptr;
+    }
+    if (env != nullptr) {
+      DLOG(INFO) << "Fall back to " << dialect_op->name << " from " << jit_dialect;
+      break;
+    }
+  }
+  dispatch_error_msgs.clear();
+  if (env == nullptr || !fused) {
+    return env;
+  }
+  // The data inputs of the op are the inputs of the function, which are indexed in its parameters.
+  for (auto& index : env->arg_indices) {
+    if (index < 0 || index >= static_cast<int>(param_indices.size()) || param_indices[index] < 0) {
+      return nullptr;
+    }
+    index = param_indices[index];
+  }
+  return env;
+}
+
 CallValues CreateDummyCallValues(Call call, Device device) {
   auto call_node = call.as<CallNode>();
   CHECK(call_node != nullptr);
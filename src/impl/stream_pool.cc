@@ -32,10 +32,46 @@ int Tag::GetTagIndex_(const std::string& tag) {
   return value;
 }
 
+/*! \brief The priorities of the streams of each tag. */
+class StreamPriorities {
+ public:
+  StreamPriorities() {
+    // Communication and prefetch are usually on the critical path when the compute saturates the
+    // device, so their streams are not starved by the compute streams.
+    priorities[kCudaCommunicate] = kHighPriority;
+    priorities[kMemCpyCpuToCuda] = kHighPriority;
+    priorities[kCudaComputeHighPriority] = kHighPriority;
+  }
+
+  static StreamPriorities* Get() {
+    static StreamPriorities* inst = new StreamPriorities();
+    return inst;
+  }
+
+  void Set(int tag_index, int priority) {
+    std::lock_guard<std::mutex> lock(mutex);
+    priorities[tag_index] = priority;
+  }
+
+  int Get(int tag_index) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = priorities.find(tag_index);
+    return it != priorities.end() ? it->second : 0;
+  }
+
+ public:
+  /*! \brief The priority of high priority streams, which is clamped to the highest one. */
+  static constexpr int kHighPriority = 1 << 16;
+  std::unordered_map<int, int> priorities;
+  std::mutex mutex;
+};
+
 class Stream::Impl {
  public:
-  explicit Impl(const Device& dev) : device(dev), api(DeviceAPI::Get(dev.device_type())) {
-    this->stream = api->CreateStream(dev);
+  explicit Impl(const Device& dev, int priority = 0)
+      : device(dev), api(DeviceAPI::Get(dev.device_type())) {
+    this->stream =
+        priority != 0 ? api->CreateStreamWithPriority(dev, priority) : api->CreateStream(dev);
   }
 
   ~Impl() {
@@ -72,7 +108,8 @@ class StreamPool {
       pool[tag_index].resize(index + 1);
     }
     if (pool[tag_index][index] == nullptr) {
-      pool[tag_index][index] = std::make_shared<Stream>(new Stream::Impl(device));
+      pool[tag_index][index] = std::make_shared<Stream>(
+          new Stream::Impl(device, StreamPriorities::Get()->Get(tag_index)));
     }
     return pool[tag_index][index];
   }
@@ -114,5 +151,19 @@ std::shared_ptr<Stream> Stream::Get(const Device& dev, int tag_index, int index)
   return StreamPool::Get(dev)->GetStream(tag_index, index);
 }
 
+void Stream::SetPriority(int tag_index, int priority) {
+  StreamPriorities::Get()->Set(tag_index, priority);
+}
+
+int Stream::GetPriority(int tag_index) {
+  return StreamPriorities::Get()->Get(tag_index);
+}
+
+RAF_REGISTER_GLOBAL("raf.stream_pool.SetPriority").set_body_typed([](int tag_index, int priority) {
+  Stream::SetPriority(tag_index, priority);
+});
+
+RAF_REGISTER_GLOBAL("raf.stream_pool.GetPriority").set_body_typed(Stream::GetPriority);
+
 }  // namespace stream_pool
 }  // namespace raf
@@ -108,7 +108,13 @@ class Tensor::Impl {
     container->dl_tensor = tensor->dl_tensor;
     std::vector<int64_t> shape(tensor->dl_tensor.shape,
                                tensor->dl_tensor.shape + tensor->dl_tensor.ndim);
-    container->strides_ = Shape2Strides<int64_t>(shape);
+    // Keep the strides of the views (e.g., the slices of framework tensors), which are either
+    // copied as is or materialized when they are copied to the device.
+    container->strides_ =
+        tensor->dl_tensor.strides != nullptr
+            ? std::vector<int64_t>(tensor->dl_tensor.strides,
+                                   tensor->dl_tensor.strides + tensor->dl_tensor.ndim)
+            : Shape2Strides<int64_t>(shape);
     container->shape_ = std::move(shape);
     container->dl_tensor.shape = const_cast<int64_t*>(container->shape_.data());
     container->dl_tensor.strides = dmlc::BeginPtr(container->strides_);
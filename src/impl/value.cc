@@ -11,6 +11,8 @@
 #include <tvm/runtime/ndarray.h>
 #include <tvm/node/functor.h>
 #include <tvm/ir/module.h>
+#include "raf/device_api.h"
+#include "raf/event_pool.h"
 #include "raf/executor.h"
 #include "raf/ir.h"
 #include "raf/registry.h"
@@ -28,6 +30,7 @@ namespace raf {
 namespace value {
 
 using common::shape_utils::GetShape;
+using common::shape_utils::IsCompact;
 using common::shape_utils::MakeShape;
 using executor::Executor;
 using tensor::Tensor;
@@ -316,6 +319,31 @@ tvm::runtime::NDArray ToTVM(TensorValue value) {
   return tvm::runtime::NDArray::FromDLPack(tensor);
 }
 
+/*!
+ * \brief Make the stream of the consumer of a DLPack export wait for the tensor, following the
+ * stream semantics of __dlpack__. The tensors are produced on the default stream of their device,
+ * so an event is recorded there and the consumer stream waits for it on the device, instead of
+ * synchronizing the device on the host.
+ * \param value The exported tensor.
+ * \param stream The consumer stream, where -1 skips the synchronization, 1 is the legacy default
+ * stream and 2 is the per-thread default stream.
+ */
+void WaitForConsumerStream(TensorValue value, int64_t stream) {
+  const DLTensor* tensor = value->tensor.operator->();
+  if (tensor->device.device_type != kDLCUDA || stream == -1) {
+    return;
+  }
+  // The legacy default stream is the producer stream, so it is already ordered.
+  if (stream == 0 || stream == 1) {
+    return;
+  }
+  Device device(tensor->device);
+  auto api = device_api::DeviceAPI::Get(device.device_type());
+  auto event = event_pool::EventPool::Get(device)->GetEvent(0x02 /*cudaEventDisableTiming*/);
+  api->EventRecordOnStream(event->data(), nullptr);
+  api->StreamWaitEvent(reinterpret_cast<void*>(stream), event->data());
+}
+
 ObjectRef DeTuple(Value value) {
   if (value->IsInstance<TensorValueObj>() || value->IsInstance<NoGradValueObj>()) {
     return std::move(value);
@@ -343,7 +371,8 @@ Value CopyTo(Value src, const Device& dev) {
   }
   if (src.as<TensorValueObj>()) {
     auto tensor = Downcast<TensorValue>(src)->tensor;
-    if (tensor->device.device_type != dev.device_type()) {
+    // The strided tensors are materialized as well, as the kernels expect compact tensors.
+    if (tensor->device.device_type != dev.device_type() || !IsCompact(*tensor.operator->())) {
       return TensorValue::make(tensor::Tensor(tensor.CopyTo(dev)));
     }
     return src;
@@ -428,6 +457,7 @@ RAF_REGISTER_GLOBAL("raf.value.AssembleTensorValue")
 RAF_REGISTER_GLOBAL("raf.value.DeTuple").set_body_typed(DeTuple);
 RAF_REGISTER_GLOBAL("raf.value.FromTVM").set_body_typed(FromTVM);
 RAF_REGISTER_GLOBAL("raf.value.ToTVM").set_body_typed(ToTVM);
+RAF_REGISTER_GLOBAL("raf.value.WaitForConsumerStream").set_body_typed(WaitForConsumerStream);
 RAF_REGISTER_GLOBAL("raf.value._make.TupleValue").set_body_typed(TupleValue::make);
 RAF_REGISTER_GLOBAL("raf.value._make.IntValue").set_body_typed(IntValue::make);
 RAF_REGISTER_GLOBAL("raf.value._make.FloatValue").set_body_typed(FloatValue::make);
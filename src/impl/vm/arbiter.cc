@@ -0,0 +1,63 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/impl/vm/arbiter.cc
+ * \brief The implementation of the execution arbiter.
+ */
+#include <chrono>
+#include <map>
+#include <memory>
+#include <utility>
+#include "./arbiter.h"
+
+namespace raf {
+namespace executor {
+namespace vm {
+
+ExecutionArbiter* ExecutionArbiter::Get(const Device& device) {
+  static std::mutex mu;
+  static std::map<std::pair<int, int>, std::unique_ptr<ExecutionArbiter>> arbiters;
+  std::lock_guard<std::mutex> lock(mu);
+  auto& arbiter = arbiters[{static_cast<int>(device.device_type()), device.device_id()}];
+  if (arbiter == nullptr) {
+    arbiter = std::make_unique<ExecutionArbiter>();
+  }
+  return arbiter.get();
+}
+
+void ExecutionArbiter::Enter(PriorityClass priority) {
+  if (priority == PriorityClass::kHigh) {
+    num_high_.fetch_add(1);
+  }
+}
+
+void ExecutionArbiter::Exit(PriorityClass priority) {
+  if (priority != PriorityClass::kHigh) {
+    return;
+  }
+  bool last;
+  {
+    // The count is decreased under the lock, so a yielded run does not miss the notification.
+    std::lock_guard<std::mutex> lock(mu_);
+    last = num_high_.fetch_sub(1) == 1;
+  }
+  if (last) {
+    cv_.notify_all();
+  }
+}
+
+int64_t ExecutionArbiter::Yield() {
+  auto start = std::chrono::steady_clock::now();
+  std::unique_lock<std::mutex> lock(mu_);
+  cv_.wait(lock, [this]() { return num_high_.load() == 0; });
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() -
+                                                               start)
+      .count();
+}
+
+}  // namespace vm
+}  // namespace executor
+}  // namespace raf
@@ -0,0 +1,98 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/impl/vm/arbiter.h
+ * \brief The execution arbiter that schedules the runs of the VMs sharing a device by their
+ * priority classes.
+ */
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include "raf/device.h"
+
+namespace raf {
+namespace executor {
+namespace vm {
+
+/*!
+ * \brief The priority class of the runs of a VM. The high-priority runs (e.g., online requests)
+ * run on the high priority compute streams, and the low-priority runs (e.g., batch jobs) yield to
+ * them at the instruction boundaries. The normal runs are not arbitrated.
+ */
+enum class PriorityClass : int {
+  kLow = -1,
+  kNormal = 0,
+  kHigh = 1,
+};
+
+/*!
+ * \brief The per-device arbiter of the VM runs. It counts the pending high-priority runs on the
+ * device, while which the low-priority runs stop launching kernels, so the GPU is left to the
+ * high-priority ones except for the kernels already queued.
+ */
+class ExecutionArbiter {
+ public:
+  /*!
+   * \brief Get the arbiter of a device, which is shared by all VMs running on it.
+   * \param device The device.
+   * \return The arbiter, which lives until the process exits.
+   */
+  static ExecutionArbiter* Get(const Device& device);
+  /*!
+   * \brief Mark the beginning of a run of the priority class.
+   * \param priority The priority class.
+   */
+  void Enter(PriorityClass priority);
+  /*!
+   * \brief Mark the end of a run of the priority class, which wakes up the yielded low-priority
+   * runs if it is the last pending high-priority one.
+   * \param priority The priority class.
+   */
+  void Exit(PriorityClass priority);
+  /*! \brief Whether any high-priority run is pending, which is checked without the lock. */
+  bool HighPending() const {
+    return num_high_.load(std::memory_order_relaxed) > 0;
+  }
+  /*!
+   * \brief Block the calling low-priority run until no high-priority run is pending.
+   * \return The waited time in microseconds.
+   */
+  int64_t Yield();
+
+ private:
+  /*! \brief The number of pending high-priority runs. */
+  std::atomic<int> num_high_{0};
+  /*! \brief The mutex and the condition variable of the yielded runs. */
+  std::mutex mu_;
+  std::condition_variable cv_;
+};
+
+/*! \brief Enter the arbiter on construction and exit it on destruction, e.g., on exceptions. */
+class ArbiterScope {
+ public:
+  ArbiterScope(ExecutionArbiter* arbiter, PriorityClass priority)
+      : arbiter_(arbiter), priority_(priority) {
+    if (arbiter_ != nullptr) {
+      arbiter_->Enter(priority_);
+    }
+  }
+
+  ~ArbiterScope() {
+    if (arbiter_ != nullptr) {
+      arbiter_->Exit(priority_);
+    }
+  }
+
+ private:
+  ExecutionArbiter* arbiter_;
+  PriorityClass priority_;
+};
+
+}  // namespace vm
+}  // namespace executor
+}  // namespace raf
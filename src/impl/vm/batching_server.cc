@@ -0,0 +1,282 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/impl/vm/batching_server.cc
+ * \brief The implementation of the dynamic batching server.
+ */
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "raf/device_api.h"
+#include "raf/memory_pool.h"
+#include "raf/registry.h"
+#include "raf/vm/batching_server.h"
+#include "../../common/shape_utils.h"
+
+namespace raf {
+namespace executor {
+namespace vm {
+
+using namespace raf::ir;
+using namespace raf::value;
+using common::shape_utils::IsCompact;
+using device_api::DeviceAPI;
+using memory_pool::Memory;
+
+BatchingServer::BatchingServer(std::vector<int64_t> batch_sizes,
+                               std::vector<tvm::runtime::Module> vms, Device device,
+                               std::vector<Value> shared_inputs, int64_t timeout_us,
+                               bool copy_outputs, std::string func_name)
+    : shared_inputs_(std::move(shared_inputs)),
+      timeout_(timeout_us),
+      copy_outputs_(copy_outputs),
+      func_name_(std::move(func_name)),
+      device_(device) {
+  CHECK(!batch_sizes.empty()) << "Must provide at least one bucket";
+  CHECK_EQ(batch_sizes.size(), vms.size()) << "Each bucket must have a VM";
+  for (size_t i = 0; i < batch_sizes.size(); ++i) {
+    CHECK_GT(batch_sizes[i], 0) << "The batch sizes must be positive";
+    Bucket bucket;
+    bucket.batch_size = batch_sizes[i];
+    bucket.vm = vms[i];
+    buckets_.push_back(std::move(bucket));
+  }
+  std::sort(buckets_.begin(), buckets_.end(),
+            [](const Bucket& a, const Bucket& b) { return a.batch_size < b.batch_size; });
+  worker_ = std::thread(&BatchingServer::Loop, this);
+}
+
+BatchingServer::~BatchingServer() {
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  worker_.join();
+}
+
+VMFuture BatchingServer::Submit(std::vector<Value> inputs) {
+  CHECK(!inputs.empty()) << "A request must have at least one batched input";
+  int64_t rows = -1;
+  for (const auto& input : inputs) {
+    const auto* tensor = input.as<TensorValueObj>();
+    CHECK(tensor != nullptr) << "The batched inputs must be tensors";
+    const DLTensor* dl_tensor = tensor->tensor.operator->();
+    CHECK(dl_tensor->device.device_type == kDLCPU && IsCompact(*dl_tensor))
+        << "The batched inputs must be compact tensors on the host";
+    CHECK_GT(dl_tensor->ndim, 0) << "The batched inputs must have the batch axis";
+    CHECK(rows == -1 || rows == dl_tensor->shape[0])
+        << "The batched inputs of a request must have the same batch size";
+    rows = dl_tensor->shape[0];
+  }
+  CHECK_GT(rows, 0) << "A request must have at least one row";
+  CHECK_LE(rows, buckets_.back().batch_size)
+      << "The request of " << rows << " rows exceeds the largest batch size "
+      << buckets_.back().batch_size;
+  Request request;
+  request.inputs = std::move(inputs);
+  request.rows = rows;
+  request.future = VMFuture::make(VMContext());
+  request.submitted = std::chrono::steady_clock::now();
+  VMFuture future = request.future;
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    CHECK(!stop_) << "The batching server is stopped";
+    queue_.push_back(std::move(request));
+    queued_rows_ += rows;
+  }
+  cv_.notify_all();
+  return future;
+}
+
+void BatchingServer::Loop() {
+  int64_t max_rows = buckets_.back().batch_size;
+  while (true) {
+    std::vector<Request> requests;
+    int64_t rows = 0;
+    {
+      std::unique_lock<std::mutex> lock(mu_);
+      cv_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+      if (queue_.empty()) {
+        return;
+      }
+      // Wait for more requests until the batch is full or its first request times out. The queued
+      // requests are flushed without waiting when the server is stopped.
+      auto deadline = queue_.front().submitted + timeout_;
+      cv_.wait_until(lock, deadline,
+                     [this, max_rows]() { return stop_ || queued_rows_ >= max_rows; });
+      while (!queue_.empty() && rows + queue_.front().rows <= max_rows) {
+        rows += queue_.front().rows;
+        requests.push_back(std::move(queue_.front()));
+        queue_.pop_front();
+      }
+      queued_rows_ -= rows;
+    }
+    RunBatch(&requests, rows);
+  }
+}
+
+void BatchingServer::RunBatch(std::vector<Request>* requests, int64_t rows) {
+  auto bucket = std::find_if(buckets_.begin(), buckets_.end(),
+                             [rows](const Bucket& b) { return b.batch_size >= rows; });
+  CHECK(bucket != buckets_.end());
+  auto api = DeviceAPI::Get(device_.device_type());
+  bool use_cuda = device_.device_type() == DevType::kCUDA();
+  std::string error;
+  try {
+    // The staging buffers are reused once the copies of the last batch from them are done.
+    if (bucket->copied != nullptr) {
+      api->WaitEvent(bucket->copied->data());
+    }
+    std::vector<Value> inputs;
+    for (size_t i = 0; i < requests->front().inputs.size(); ++i) {
+      inputs.push_back(StageInput(&*bucket, *requests, i));
+    }
+    if (use_cuda) {
+      if (bucket->copied == nullptr) {
+        bucket->copied = EventPool::Get(device_)->GetEvent(0x02 /*cudaEventDisableTiming*/);
+      }
+      api->EventRecordOnStream(bucket->copied->data(), nullptr);
+    }
+    inputs.insert(inputs.end(), shared_inputs_.begin(), shared_inputs_.end());
+    auto* vm = static_cast<VirtualMachine*>(bucket->vm.operator->());
+    Value output = vm->Run(vm->PrepareVMContext(func_name_, inputs));
+    int64_t offset = 0;
+    for (auto& request : *requests) {
+      request.future->result = SliceOutput(output, offset, request.rows);
+      offset += request.rows;
+    }
+  } catch (const dmlc::Error& e) {
+    error = e.what();
+  }
+  for (auto& request : *requests) {
+    auto* state = new std::shared_ptr<VMFutureState>(request.future->state);
+    if (!error.empty() || !use_cuda) {
+      (*state)->error = error;
+      VMFuture::Complete(state);
+    } else {
+      // The outputs are computed on the default stream, so the requests are completed after it.
+      api->LaunchHostFunc(nullptr, VMFuture::Complete, state);
+    }
+  }
+}
+
+Value BatchingServer::StageInput(Bucket* bucket, const std::vector<Request>& requests,
+                                 size_t index) {
+  const DLTensor* first = requests.front().inputs[index].as<TensorValueObj>()->tensor.operator->();
+  int64_t row_bytes = tvm::runtime::GetDataSize(*first) / first->shape[0];
+  int64_t nbytes = row_bytes * bucket->batch_size;
+  Device host(device_.device_type() == DevType::kCUDA() ? DevType::kCUDAHost() : DevType::kCPU(),
+              0);
+  if (bucket->staging.size() <= index) {
+    bucket->staging.resize(index + 1);
+    bucket->staging_bytes.resize(index + 1, 0);
+  }
+  auto& staging = bucket->staging[index];
+  if (staging == nullptr || bucket->staging_bytes[index] != nbytes) {
+    staging = Memory::Alloc(host, nbytes);
+    bucket->staging_bytes[index] = nbytes;
+  }
+  char* dst = static_cast<char*>(staging->data);
+  int64_t offset = 0;
+  for (const auto& request : requests) {
+    const DLTensor* from = request.inputs[index].as<TensorValueObj>()->tensor.operator->();
+    CHECK(from->ndim == first->ndim && from->dtype == first->dtype &&
+          std::equal(from->shape + 1, from->shape + from->ndim, first->shape + 1))
+        << "The batched input " << index << " of the requests must have the same shape and dtype "
+        << "except the batch axis";
+    int64_t bytes = request.rows * row_bytes;
+    std::memcpy(dst + offset, static_cast<const char*>(from->data) + from->byte_offset, bytes);
+    offset += bytes;
+  }
+  // The padded rows are zeros.
+  std::memset(dst + offset, 0, nbytes - offset);
+
+  std::vector<int64_t> shape(first->shape, first->shape + first->ndim);
+  shape[0] = bucket->batch_size;
+  DLTensor staged = *first;
+  staged.data = staging->data;
+  staged.byte_offset = 0;
+  staged.shape = shape.data();
+  staged.strides = nullptr;
+  staged.device = host;
+  auto mem = Memory::Alloc(device_, nbytes);
+  TensorValue to = TensorValue::Assemble(device_, first->dtype, shape, {}, mem->data, mem);
+  DeviceAPI::Get(device_.device_type())->CopyDataFromTo(&staged, to, nullptr);
+  return to;
+}
+
+Value BatchingServer::SliceOutput(const Value& value, int64_t offset, int64_t rows) {
+  if (const auto* tuple = value.as<TupleValueObj>()) {
+    Array<Value> fields;
+    for (const auto& field : tuple->fields) {
+      fields.push_back(SliceOutput(field, offset, rows));
+    }
+    return TupleValue::make(fields);
+  }
+  const auto* tensor = value.as<TensorValueObj>();
+  CHECK(tensor != nullptr) << "The outputs must be tensors or tuples of tensors";
+  const DLTensor* from = tensor->tensor.operator->();
+  CHECK(from->ndim > 0 && IsCompact(*from))
+      << "The outputs must be compact tensors with the batch axis";
+  int64_t row_bytes = tvm::runtime::GetDataSize(*from) / from->shape[0];
+  std::vector<int64_t> shape(from->shape, from->shape + from->ndim);
+  shape[0] = rows;
+  void* data = static_cast<char*>(from->data) + from->byte_offset + offset * row_bytes;
+  TensorValue view = TensorValue::make(tensor->tensor.CreateView(shape, {}, data), tensor->mem);
+  if (!copy_outputs_) {
+    return view;
+  }
+  Device device(from->device);
+  auto mem = Memory::Alloc(device, rows * row_bytes);
+  TensorValue out = TensorValue::Assemble(device, from->dtype, shape, {}, mem->data, mem);
+  view->tensor.CopyTo(out->tensor);
+  return out;
+}
+
+PackedFunc BatchingServer::GetFunction(const std::string& name,
+                                       const ObjectPtr<Object>& sptr_to_self) {
+  if (name == "submit") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      std::vector<Value> inputs(args.size());
+      for (size_t i = 0; i < args.size(); ++i) {
+        inputs[i] = args[i];
+      }
+      *rv = Submit(std::move(inputs));
+    });
+  }
+  LOG(FATAL) << "Unknown packed function: " << name;
+  return PackedFunc([sptr_to_self, name](registry::TVMArgs args, registry::TVMRetValue* rv) {});
+}
+
+RAF_REGISTER_GLOBAL("raf.vm.BatchingServer")
+    .set_body([](tvm::TVMArgs args, tvm::TVMRetValue* rv) {
+      Array<Integer> batch_sizes = args[0];
+      Array<tvm::runtime::Module> vms = args[1];
+      Device device = args[2];
+      Array<Value> shared_inputs = args[3];
+      int64_t timeout_us = args[4];
+      bool copy_outputs = args[5];
+      std::string func_name = args[6];
+      std::vector<int64_t> sizes;
+      for (const auto& size : batch_sizes) {
+        sizes.push_back(size->value);
+      }
+      auto server = make_object<BatchingServer>(
+          sizes, std::vector<tvm::runtime::Module>(vms.begin(), vms.end()), device,
+          std::vector<Value>(shared_inputs.begin(), shared_inputs.end()), timeout_us,
+          copy_outputs, func_name);
+      *rv = tvm::runtime::Module(server);
+    });
+
+}  // namespace vm
+}  // namespace executor
+}  // namespace raf
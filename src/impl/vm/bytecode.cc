@@ -59,6 +59,11 @@ Instruction::Instruction(const Instruction& instr) {
     case Opcode::AllocTensorReg:
       this->alloc_tensor_reg = instr.alloc_tensor_reg;
       return;
+    case Opcode::AllocOwnedTensor:
+      this->alloc_owned_tensor = instr.alloc_owned_tensor;
+      this->alloc_owned_tensor.shape =
+          Duplicate<int64_t>(instr.alloc_owned_tensor.shape, instr.alloc_owned_tensor.ndim);
+      return;
     case Opcode::AllocTuple:
       this->alloc_tuple.num_fields = instr.alloc_tuple.num_fields;
       this->alloc_tuple.fields =
@@ -73,6 +78,7 @@ Instruction::Instruction(const Instruction& instr) {
     case Opcode::SetShape:
       this->set_shape.data = instr.set_shape.data;
       this->set_shape.shape = instr.set_shape.shape;
+      this->set_shape.byte_offset = instr.set_shape.byte_offset;
       return;
     case Opcode::InvokePacked:
       this->invoke_packed.packed_index = instr.invoke_packed.packed_index;
@@ -128,6 +134,7 @@ Instruction::Instruction(const Instruction& instr) {
     case Opcode::CudaSetStream:
       this->cuda_set_stream.device_id = instr.cuda_set_stream.device_id;
       this->cuda_set_stream.stream_id = instr.cuda_set_stream.stream_id;
+      this->cuda_set_stream.priority = instr.cuda_set_stream.priority;
       return;
     case Opcode::CudaAddEvent:
     case Opcode::CudaWaitEvent:
@@ -168,6 +175,7 @@ Instruction& Instruction::operator=(const Instruction& instr) {
       return *this;
     case Opcode::AllocTensor:
       this->alloc_tensor.storage = instr.alloc_tensor.storage;
+      this->alloc_tensor.offset = instr.alloc_tensor.offset;
       this->alloc_tensor.ndim = instr.alloc_tensor.ndim;
       this->alloc_tensor.shape =
           Duplicate<int64_t>(instr.alloc_tensor.shape, instr.alloc_tensor.ndim);
@@ -180,6 +188,11 @@ Instruction& Instruction::operator=(const Instruction& instr) {
       this->alloc_tensor_reg.dtype = instr.alloc_tensor_reg.dtype;
       this->alloc_tensor_reg.own = instr.alloc_tensor_reg.own;
       return *this;
+    case Opcode::AllocOwnedTensor:
+      this->alloc_owned_tensor = instr.alloc_owned_tensor;
+      this->alloc_owned_tensor.shape =
+          Duplicate<int64_t>(instr.alloc_owned_tensor.shape, instr.alloc_owned_tensor.ndim);
+      return *this;
     case Opcode::AllocTuple:
       this->alloc_tuple.num_fields = instr.alloc_tuple.num_fields;
       FreeIf(this->alloc_tuple.fields);
@@ -196,6 +209,7 @@ Instruction& Instruction::operator=(const Instruction& instr) {
     case Opcode::SetShape:
       this->set_shape.data = instr.set_shape.data;
       this->set_shape.shape = instr.set_shape.shape;
+      this->set_shape.byte_offset = instr.set_shape.byte_offset;
       return *this;
     case Opcode::InvokePacked:
       this->invoke_packed.packed_index = instr.invoke_packed.packed_index;
@@ -253,6 +267,7 @@ Instruction& Instruction::operator=(const Instruction& instr) {
     case Opcode::CudaSetStream:
       this->cuda_set_stream.device_id = instr.cuda_set_stream.device_id;
       this->cuda_set_stream.stream_id = instr.cuda_set_stream.stream_id;
+      this->cuda_set_stream.priority = instr.cuda_set_stream.priority;
       return *this;
     case Opcode::CudaAddEvent:
     case Opcode::CudaWaitEvent:
@@ -290,6 +305,9 @@ Instruction::~Instruction() {
     case Opcode::AllocTensor:
       delete[] this->alloc_tensor.shape;
       return;
+    case Opcode::AllocOwnedTensor:
+      delete[] this->alloc_owned_tensor.shape;
+      return;
     case Opcode::AllocTuple:
       delete[] this->alloc_tuple.fields;
       return;
@@ -362,6 +380,25 @@ Instruction Instruction::AllocTensor(RegName storage, Index offset,
   return instr;
 }
 
+Instruction Instruction::AllocOwnedTensor(Index allocation_size, Index alignment,
+                                          DevType device_type, Index device_id, Index offset,
+                                          const std::vector<int64_t>& shape, DLDataType dtype,
+                                          RegName dst) {
+  Instruction instr;
+  instr.op = Opcode::AllocOwnedTensor;
+  instr.dst = dst;
+  instr.alloc_owned_tensor.allocation_size = allocation_size;
+  instr.alloc_owned_tensor.alignment = alignment;
+  instr.alloc_owned_tensor.device_type = device_type;
+  instr.alloc_owned_tensor.device_id = device_id;
+  instr.alloc_owned_tensor.offset = offset;
+  instr.alloc_owned_tensor.ndim = shape.size();
+  instr.alloc_owned_tensor.shape = new int64_t[shape.size()];
+  std::copy(shape.begin(), shape.end(), instr.alloc_owned_tensor.shape);
+  instr.alloc_owned_tensor.dtype = dtype;
+  return instr;
+}
+
 Instruction Instruction::AllocTensorReg(RegName storage, Index offset, RegName shape_register,
                                         DLDataType dtype, Index dst, bool own) {
   Instruction instr;
@@ -421,12 +458,13 @@ Instruction Instruction::AllocClosure(Index func_index, const std::vector<RegNam
   return instr;
 }
 
-Instruction Instruction::SetShape(RegName data, RegName shape, RegName dst) {
+Instruction Instruction::SetShape(RegName data, RegName shape, Index byte_offset, RegName dst) {
   Instruction instr;
   instr.op = Opcode::SetShape;
   instr.dst = dst;
   instr.set_shape.data = data;
   instr.set_shape.shape = shape;
+  instr.set_shape.byte_offset = byte_offset;
   return instr;
 }
 
@@ -535,11 +573,12 @@ Instruction Instruction::InferType(RegName op_reg, const std::vector<RegName>& a
   return instr;
 }
 
-Instruction Instruction::CudaSetStream(Index device_id, Index stream_id) {
+Instruction Instruction::CudaSetStream(Index device_id, Index stream_id, Index priority) {
   Instruction instr;
   instr.op = Opcode::CudaSetStream;
   instr.cuda_set_stream.device_id = device_id;
   instr.cuda_set_stream.stream_id = stream_id;
+  instr.cuda_set_stream.priority = priority;
   return instr;
 }
 
@@ -630,6 +669,14 @@ void InstructionPrint(std::ostream& os, const Instruction& instr) {
       }
       break;
     }
+    case Opcode::AllocOwnedTensor: {
+      const auto& alloc = instr.alloc_owned_tensor;
+      os << "alloc_owned_tensor $" << instr.dst << " " << alloc.allocation_size << " "
+         << alloc.alignment << " " << alloc.device_type.c_str() << "(" << alloc.device_id << ") "
+         << alloc.offset << " [" << StrJoin<int64_t>(alloc.shape, 0, alloc.ndim) << "] ";
+      DLDatatypePrint(os, alloc.dtype);
+      break;
+    }
     case Opcode::AllocTensorReg: {
       os << "alloc_tensor_reg $" << instr.dst << " $" << instr.alloc_tensor_reg.storage << " $"
          << instr.alloc_tensor_reg.offset << " $" << instr.alloc_tensor_reg.shape_register << " ";
@@ -655,6 +702,9 @@ void InstructionPrint(std::ostream& os, const Instruction& instr) {
     case Opcode::SetShape: {
       os << "set_shape $" << instr.dst << " $" << instr.set_shape.data << " $"
          << instr.set_shape.shape;
+      if (instr.set_shape.byte_offset != 0) {
+        os << " " << instr.set_shape.byte_offset;
+      }
       break;
     }
     case Opcode::If: {
@@ -717,6 +767,9 @@ void InstructionPrint(std::ostream& os, const Instruction& instr) {
     case Opcode::CudaSetStream: {
       os << "cuda_set_stream " << instr.cuda_set_stream.device_id << " "
          << instr.cuda_set_stream.stream_id;
+      if (instr.cuda_set_stream.priority != 0) {
+        os << " " << instr.cuda_set_stream.priority;
+      }
       break;
     }
     case Opcode::CudaAddEvent: {
@@ -7,6 +7,11 @@
  * \file src/impl/vm/compiler.cc
  * \brief The RAF virtual machine compiler.
  */
+#include <algorithm>
+#include <iterator>
+#include <mutex>
+#include <queue>
+#include <set>
 #include <tvm/ir/module.h>
 #include <tvm/ir/type_functor.h>
 #include <tvm/target/target.h>
@@ -17,10 +22,13 @@
 #include "raf/op.h"
 #include "raf/ir.h"
 #include "raf/binding.h"
+#include "raf/cache.h"
 #include "raf/type.h"
 #include "raf/pass.h"
 #include "raf/dist_context.h"
+#include "raf/serialization.h"
 #include "./compiler.h"
+#include "../../../3rdparty/tvm/src/runtime/file_utils.h"
 
 namespace tvm {
 namespace relay {
@@ -39,6 +47,8 @@ using namespace raf::op;
 using namespace raf::value;
 using binding::LookupBinding;
 using binding::NDArrayBinding;
+using op::HashKey;
+using op::MetaPersistCache;
 using raf::distributed::DistContext;
 using tvm::relay::Shape;
 
@@ -249,6 +259,7 @@ class VMFunctionCompiler : ExprFunctor<void(const Expr& expr)> {
       case Opcode::AllocTuple:
       case Opcode::AllocTensor:
       case Opcode::AllocTensorReg:
+      case Opcode::AllocOwnedTensor:
       case Opcode::GetField:
       case Opcode::LoadConst:
       case Opcode::LoadConsti:
@@ -410,8 +421,9 @@ class VMFunctionCompiler : ExprFunctor<void(const Expr& expr)> {
           .Match("raf.op.vm.alloc_tensor",
                  [this](const Array<Expr>& args, const Attrs& attrs, const Array<Type>& type_arg) {
                    bool own = true;
-                   if (args.size() == 5) {
-                     // The last "own" argument is usually specified by the MemoryPlan pass
+                   Index offset = 0;
+                   if (args.size() >= 5) {
+                     // The "own" argument is usually specified by the MemoryPlan pass
                      // to indicate that this tensor is not the final output so it should not
                      // own the memory pointer.
                      CHECK(args[4].as<ConstantNode>());
@@ -421,6 +433,16 @@ class VMFunctionCompiler : ExprFunctor<void(const Expr& expr)> {
                    } else {
                      CHECK_EQ(args.size(), 4);
                    }
+                   if (args.size() == 6) {
+                     // The last "offset" argument is specified by the MemoryPlan pass in the
+                     // static arena mode to place the tensor in a shared storage.
+                     CHECK(args[5].as<ConstantNode>());
+                     auto offset_val = args[5].as<ConstantNode>()->value;
+                     CHECK(offset_val->IsInstance<IntValueObj>());
+                     offset = offset_val.as<IntValueObj>()->value;
+                   } else {
+                     CHECK_LE(args.size(), 5);
+                   }
 
                    // The storage will be passed dynamically.
                    this->VisitExpr(args[0]);
@@ -446,11 +468,11 @@ class VMFunctionCompiler : ExprFunctor<void(const Expr& expr)> {
                        raw_shape.push_back(imm->value);
                      }
                      // Add context field.
-                     Emit(Instruction::AllocTensor(storage_register, 0, raw_shape, dtype,
+                     Emit(Instruction::AllocTensor(storage_register, offset, raw_shape, dtype,
                                                    NewRegister(), own));
                    } else {
                      this->VisitExpr(args[1]);
-                     Emit(Instruction::AllocTensorReg(storage_register, 0, last_register_, dtype,
+                     Emit(Instruction::AllocTensorReg(storage_register, offset, last_register_, dtype,
                                                       NewRegister(), own));
                    }
                  })
@@ -499,18 +521,25 @@ class VMFunctionCompiler : ExprFunctor<void(const Expr& expr)> {
                  })
           .Match("raf.op.vm.set_shape",
                  [this](const Array<Expr>& args, const Attrs& attrs, const Array<Type>& type_arg) {
-                   CHECK_EQ(args.size(), 2);
+                   CHECK(args.size() == 2 || args.size() == 3);
                    this->VisitExpr(args[0]);
                    auto data_reg = last_register_;
                    // The shape argument may be a constant or a tensor
                    this->VisitExpr(args[1]);
                    auto shape_reg = last_register_;
-                   Emit(Instruction::SetShape(data_reg, shape_reg, NewRegister()));
+                   // The optional byte offset of a view, such as an output of split, is a constant
+                   Index byte_offset = 0;
+                   if (args.size() == 3) {
+                     auto offset_val = args[2].as<ConstantNode>()->value;
+                     CHECK(offset_val->IsInstance<IntValueObj>());
+                     byte_offset = offset_val.as<IntValueObj>()->value;
+                   }
+                   Emit(Instruction::SetShape(data_reg, shape_reg, byte_offset, NewRegister()));
                  })
           .Match(
               "raf.op.set_stream",
               [this](const Array<Expr>& args, const Attrs& attrs, const Array<Type>& type_arg) {
-                CHECK_EQ(args.size(), 2);
+                CHECK(args.size() == 2 || args.size() == 3);
                 this->VisitExpr(args[0]);
                 Expr device_id_expr;
                 if (args[0].as<VarNode>()) {
@@ -527,7 +556,18 @@ class VMFunctionCompiler : ExprFunctor<void(const Expr& expr)> {
                   stream_id_expr = args[1];
                 }
                 Index stream_id = stream_id_expr.as<ConstantNode>()->value.as<IntValueObj>()->value;
-                Emit(Instruction::CudaSetStream(device_id, stream_id));
+                Index priority = 0;
+                if (args.size() == 3) {
+                  this->VisitExpr(args[2]);
+                  Expr priority_expr;
+                  if (args[2].as<VarNode>()) {
+                    priority_expr = expr_map_[GetRef<Var>(args[2].as<VarNode>())];
+                  } else {
+                    priority_expr = args[2];
+                  }
+                  priority = priority_expr.as<ConstantNode>()->value.as<IntValueObj>()->value;
+                }
+                Emit(Instruction::CudaSetStream(device_id, stream_id, priority));
               })
           .Match("raf.op.add_event",
                  [this](const Array<Expr>& args, const Attrs& attrs, const Array<Type>& type_arg) {
@@ -764,6 +804,767 @@ class VMFunctionCompiler : ExprFunctor<void(const Expr& expr)> {
   DeviceMap device_map_;
 };
 
+/*! \brief Apply the function to each register operand of the instruction, including the dst. */
+template <typename T, typename F>
+void ForEachRegister(T* instr, F f) {
+  auto each = [&f](auto* regs, Index num) {
+    for (Index i = 0; i < num; ++i) {
+      f(&regs[i]);
+    }
+  };
+  switch (instr->op) {
+    case Opcode::Move:
+      f(&instr->from);
+      f(&instr->dst);
+      break;
+    case Opcode::Ret:
+      f(&instr->result);
+      break;
+    case Opcode::LoadConst:
+    case Opcode::LoadConsti:
+    case Opcode::AllocOwnedTensor:
+      f(&instr->dst);
+      break;
+    case Opcode::GetField:
+      f(&instr->get_field.object);
+      f(&instr->dst);
+      break;
+    case Opcode::If:
+      f(&instr->if_op.test);
+      f(&instr->if_op.target);
+      break;
+    case Opcode::AllocStorage:
+      f(&instr->alloc_storage.allocation_size);
+      f(&instr->dst);
+      break;
+    case Opcode::AllocTensor:
+      f(&instr->alloc_tensor.storage);
+      f(&instr->dst);
+      break;
+    case Opcode::AllocTensorReg:
+      f(&instr->alloc_tensor_reg.storage);
+      f(&instr->alloc_tensor_reg.shape_register);
+      f(&instr->dst);
+      break;
+    case Opcode::AllocTuple:
+      each(instr->alloc_tuple.fields, instr->alloc_tuple.num_fields);
+      f(&instr->dst);
+      break;
+    case Opcode::AllocClosure:
+      each(instr->alloc_closure.free_vars, instr->alloc_closure.num_free_vars);
+      f(&instr->dst);
+      break;
+    case Opcode::SetShape:
+      f(&instr->set_shape.data);
+      f(&instr->set_shape.shape);
+      f(&instr->dst);
+      break;
+    case Opcode::Free:
+      f(&instr->free.memory);
+      break;
+    case Opcode::InvokeFunc:
+      each(instr->invoke_func.args, instr->invoke_func.num_args);
+      f(&instr->dst);
+      break;
+    case Opcode::InvokeClosure:
+      f(&instr->invoke_closure.closure);
+      each(instr->invoke_closure.args, instr->invoke_closure.num_args);
+      f(&instr->dst);
+      break;
+    case Opcode::InvokePacked:
+      each(instr->invoke_packed.args, instr->invoke_packed.arity);
+      break;
+    case Opcode::InvokeJit:
+      f(&instr->invoke_jit.op_reg);
+      each(instr->invoke_jit.args, instr->invoke_jit.arity);
+      break;
+    case Opcode::InferType:
+      f(&instr->infer_type.op_reg);
+      each(instr->infer_type.args, instr->infer_type.num_args);
+      f(&instr->dst);
+      break;
+    case Opcode::Fatal:
+    case Opcode::Goto:
+    case Opcode::CudaSetStream:
+    case Opcode::CudaAddEvent:
+    case Opcode::CudaWaitEvent:
+    case Opcode::CudaStreamBarrier:
+      break;
+  }
+}
+
+/*! \brief Whether the instruction writes its dst register. */
+inline bool HasDst(Opcode op) {
+  switch (op) {
+    case Opcode::Move:
+    case Opcode::LoadConst:
+    case Opcode::LoadConsti:
+    case Opcode::GetField:
+    case Opcode::AllocStorage:
+    case Opcode::AllocTensor:
+    case Opcode::AllocTensorReg:
+    case Opcode::AllocOwnedTensor:
+    case Opcode::AllocTuple:
+    case Opcode::AllocClosure:
+    case Opcode::SetShape:
+    case Opcode::InvokeFunc:
+    case Opcode::InvokeClosure:
+    case Opcode::InferType:
+      return true;
+    default:
+      return false;
+  }
+}
+
+/*! \brief Whether the instruction runs on or synchronizes the CUDA streams. */
+inline bool IsStreamInstruction(Opcode op) {
+  return op == Opcode::CudaSetStream || op == Opcode::CudaAddEvent ||
+         op == Opcode::CudaWaitEvent || op == Opcode::CudaStreamBarrier;
+}
+
+/*! \brief Find the leaders of the basic blocks, i.e., the entry and the targets of the jumps. */
+std::vector<bool> FindLeaders(const std::vector<Instruction>& instrs) {
+  std::vector<bool> leader(instrs.size() + 1, false);
+  leader[0] = true;
+  for (size_t pc = 0; pc < instrs.size(); ++pc) {
+    const Instruction& instr = instrs[pc];
+    if (instr.op == Opcode::If) {
+      leader[pc + instr.if_op.true_offset] = leader[pc + instr.if_op.false_offset] = true;
+      leader[pc + 1] = true;
+    } else if (instr.op == Opcode::Goto) {
+      leader[pc + instr.pc_offset] = leader[pc + 1] = true;
+    } else if (instr.op == Opcode::Ret || instr.op == Opcode::Fatal) {
+      leader[pc + 1] = true;
+    }
+  }
+  return leader;
+}
+
+/*!
+ * \brief Optimize the calls between the compiled functions on the bytecode. The calls of the small
+ * leaf functions are inlined into their callers, and the self-recursive tail calls, e.g., of the
+ * lifted loops, jump back to the entry of the function, so neither pushes a frame nor returns.
+ */
+class BytecodeOptimizer {
+ public:
+  /*! \brief The maximal number of instructions of an inlined function. */
+  static constexpr size_t kMaxInlineInstructions = 16;
+
+  /*!
+   * \param functions The compiled functions.
+   * \param constants The constants loaded by the functions.
+   * \param inline_jit Whether the inlined functions may launch ops. The ops of an inlined function
+   * are cached per call site, so the shared closures of Deduplicate are not inlined.
+   */
+  BytecodeOptimizer(std::vector<VMFunction>* functions, const std::vector<Value>* constants,
+                    bool inline_jit)
+      : functions_(functions), constants_(constants), inline_jit_(inline_jit) {
+  }
+
+  void FuseInstructions() {
+    for (auto& func : *functions_) {
+      FuseAllocations(&func);
+    }
+  }
+
+  void OptimizeCalls() {
+    // The inlined functions have no calls, so they are the same before and after the inlining.
+    std::vector<bool> inlinable;
+    for (const auto& func : *functions_) {
+      inlinable.push_back(IsInlinable(func));
+    }
+    for (size_t i = 0; i < functions_->size(); ++i) {
+      InlineCalls(i, inlinable);
+      EliminateTailCalls(i);
+    }
+  }
+
+  void AllocateRegisters() {
+    for (auto& func : *functions_) {
+      AllocateRegisters(&func);
+    }
+  }
+
+ private:
+  bool IsInlinable(const VMFunction& func) {
+    const auto& instrs = func.instructions;
+    if (instrs.empty() || instrs.size() > kMaxInlineInstructions ||
+        instrs.back().op != Opcode::Ret) {
+      return false;
+    }
+    for (size_t i = 0; i + 1 < instrs.size(); ++i) {
+      switch (instrs[i].op) {
+        case Opcode::Ret:
+        case Opcode::InvokeFunc:
+        case Opcode::InvokeClosure:
+        case Opcode::InvokePacked:
+        case Opcode::AllocClosure:
+          return false;
+        case Opcode::InvokeJit:
+        case Opcode::InferType:
+          if (!inline_jit_) {
+            return false;
+          }
+          break;
+        default:
+          break;
+      }
+    }
+    return true;
+  }
+
+  /*!
+   * \brief Rebuild the instructions of a function, where the expand function replaces an
+   * instruction by the instructions it returns true with. The offsets of the original jumps are
+   * fixed to target the first instruction of the expansion of their targets, while the jumps
+   * within an expansion are relative to the expansion itself.
+   */
+  template <typename F>
+  void Rewrite(VMFunction* func, F expand) {
+    const auto& instrs = func->instructions;
+    std::vector<Instruction> rewritten;
+    std::vector<size_t> new_pc(instrs.size() + 1);
+    std::vector<std::pair<size_t, size_t>> jumps;
+    for (size_t i = 0; i < instrs.size(); ++i) {
+      new_pc[i] = rewritten.size();
+      std::vector<Instruction> expansion;
+      if (expand(i, rewritten.size(), &expansion)) {
+        rewritten.insert(rewritten.end(), expansion.begin(), expansion.end());
+        continue;
+      }
+      if (instrs[i].op == Opcode::If || instrs[i].op == Opcode::Goto) {
+        jumps.emplace_back(i, rewritten.size());
+      }
+      rewritten.push_back(instrs[i]);
+    }
+    new_pc[instrs.size()] = rewritten.size();
+    for (const auto& jump : jumps) {
+      Instruction& instr = rewritten[jump.second];
+      Index old_pc = jump.first, pc = jump.second;
+      if (instr.op == Opcode::If) {
+        instr.if_op.true_offset = new_pc[old_pc + instr.if_op.true_offset] - pc;
+        instr.if_op.false_offset = new_pc[old_pc + instr.if_op.false_offset] - pc;
+      } else {
+        instr.pc_offset = new_pc[old_pc + instr.pc_offset] - pc;
+      }
+    }
+    func->instructions = std::move(rewritten);
+  }
+
+  /*! \brief Inline the calls of the inlinable functions, which take fresh registers. */
+  void InlineCalls(size_t func_index, const std::vector<bool>& inlinable) {
+    VMFunction* func = &(*functions_)[func_index];
+    Rewrite(func, [&](size_t pc, size_t new_pc, std::vector<Instruction>* expansion) {
+      const Instruction& call = func->instructions[pc];
+      if (call.op != Opcode::InvokeFunc ||
+          call.invoke_func.func_index == static_cast<Index>(func_index) ||
+          !inlinable[call.invoke_func.func_index]) {
+        return false;
+      }
+      const VMFunction& callee = (*functions_)[call.invoke_func.func_index];
+      Index base = func->register_file_size;
+      func->register_file_size += callee.register_file_size;
+      for (Index i = 0; i < call.invoke_func.num_args; ++i) {
+        expansion->push_back(Instruction::Move(call.invoke_func.args[i], base + i));
+      }
+      for (const auto& instr : callee.instructions) {
+        Instruction inlined = instr;
+        ForEachRegister(&inlined, [base](RegName* reg) { *reg += base; });
+        if (inlined.op == Opcode::Ret) {
+          inlined = Instruction::Move(inlined.result, call.dst);
+        }
+        expansion->push_back(inlined);
+      }
+      return true;
+    });
+  }
+
+  /*! \brief Whether the value of the register at the pc is returned without being used. */
+  bool IsReturned(const VMFunction& func, size_t pc, RegName reg) {
+    const auto& instrs = func.instructions;
+    for (size_t step = 0; step < instrs.size() && pc < instrs.size(); ++step) {
+      const Instruction& instr = instrs[pc];
+      if (instr.op == Opcode::Ret) {
+        return instr.result == reg;
+      } else if (instr.op == Opcode::Move && instr.from == reg) {
+        reg = instr.dst;
+        ++pc;
+      } else if (instr.op == Opcode::Goto) {
+        pc += instr.pc_offset;
+      } else {
+        return false;
+      }
+    }
+    return false;
+  }
+
+  /*!
+   * \brief Replace the self-recursive tail calls by moving the arguments to the parameters and
+   * jumping to the entry. The closure calls are included if the closure is allocated by the
+   * function itself from its own function index.
+   */
+  void EliminateTailCalls(size_t func_index) {
+    VMFunction* func = &(*functions_)[func_index];
+    std::unordered_map<RegName, const Instruction*> self_closures;
+    for (const auto& instr : func->instructions) {
+      if (instr.op == Opcode::AllocClosure &&
+          instr.alloc_closure.func_index == static_cast<Index>(func_index)) {
+        self_closures[instr.dst] = &instr;
+      }
+    }
+    // The original instructions are kept until the rewrite is done.
+    const auto& instrs = func->instructions;
+    Rewrite(func, [&](size_t pc, size_t new_pc, std::vector<Instruction>* expansion) {
+      const Instruction& call = instrs[pc];
+      std::vector<RegName> args;
+      Index self = func_index;
+      if (call.op == Opcode::InvokeFunc && call.invoke_func.func_index == self) {
+        args.assign(call.invoke_func.args, call.invoke_func.args + call.invoke_func.num_args);
+      } else if (call.op == Opcode::InvokeClosure &&
+                 self_closures.count(call.invoke_closure.closure)) {
+        const Instruction* clo = self_closures.at(call.invoke_closure.closure);
+        args.assign(clo->alloc_closure.free_vars,
+                    clo->alloc_closure.free_vars + clo->alloc_closure.num_free_vars);
+        args.insert(args.end(), call.invoke_closure.args,
+                    call.invoke_closure.args + call.invoke_closure.num_args);
+      } else {
+        return false;
+      }
+      if (args.size() != func->params.size() || !IsReturned(*func, pc + 1, call.dst)) {
+        return false;
+      }
+      // The arguments are staged in fresh registers if any of them is a parameter to be updated.
+      bool staged = false;
+      for (size_t i = 0; i < args.size(); ++i) {
+        staged |= args[i] != static_cast<RegName>(i) && args[i] < static_cast<RegName>(args.size());
+      }
+      std::vector<RegName> srcs = args;
+      if (staged) {
+        for (size_t i = 0; i < args.size(); ++i) {
+          srcs[i] = func->register_file_size++;
+          expansion->push_back(Instruction::Move(args[i], srcs[i]));
+        }
+      }
+      for (size_t i = 0; i < args.size(); ++i) {
+        if (srcs[i] != static_cast<RegName>(i)) {
+          expansion->push_back(Instruction::Move(srcs[i], i));
+        }
+      }
+      expansion->push_back(Instruction::Goto(-static_cast<Index>(new_pc + expansion->size())));
+      return true;
+    });
+  }
+
+  /*!
+   * \brief Allocate the registers of a function by their live ranges, so the register of a dead
+   * value is reused by a later value, which also drops the reference of the dead value, and the
+   * register file shrinks. The live range of a register is the hull of the points where it is
+   * live, where the point 2 * pc is before the instruction at pc and 2 * pc + 1 is after it, so
+   * the dst of an instruction may take the register of its last use. The parameters keep their
+   * registers, and the registers of the constants are only shared with the constants, since they
+   * are flagged as constants by LoadConst. The functions running on multiple streams are skipped,
+   * where a dropped tensor may be still in use by the kernels of the other streams.
+   */
+  void AllocateRegisters(VMFunction* func) {
+    auto& instrs = func->instructions;
+    size_t num_instrs = instrs.size();
+    Index num_regs = func->register_file_size;
+    Index num_params = func->params.size();
+    for (const auto& instr : instrs) {
+      if (IsStreamInstruction(instr.op)) {
+        return;
+      }
+    }
+    // Split the function into the basic blocks.
+    std::vector<bool> leader = FindLeaders(instrs);
+    std::vector<size_t> block_begin, block_of(num_instrs + 1);
+    for (size_t pc = 0; pc < num_instrs; ++pc) {
+      if (leader[pc]) {
+        block_begin.push_back(pc);
+      }
+      block_of[pc] = block_begin.size() - 1;
+    }
+    size_t num_blocks = block_begin.size();
+    block_begin.push_back(num_instrs);
+
+    // Collect the uses and the defs of the instructions, and the gen and kill sets of the blocks.
+    std::vector<std::vector<RegName>> uses(num_instrs);
+    std::vector<std::vector<RegName>> gen(num_blocks), kill(num_blocks);
+    std::vector<size_t> def_stamp(num_regs, 0), gen_stamp(num_regs, 0);
+    std::vector<bool> is_const(num_regs, false);
+    std::unordered_map<RegName, RegName> move_from;
+    for (size_t b = 0; b < num_blocks; ++b) {
+      for (size_t pc = block_begin[b]; pc < block_begin[b + 1]; ++pc) {
+        const Instruction& instr = instrs[pc];
+        bool has_dst = HasDst(instr.op);
+        ForEachRegister(&instr, [&](const RegName* reg) {
+          if (has_dst && reg == &instr.dst) {
+            return;
+          }
+          uses[pc].push_back(*reg);
+          if (def_stamp[*reg] != b + 1 && gen_stamp[*reg] != b + 1) {
+            gen_stamp[*reg] = b + 1;
+            gen[b].push_back(*reg);
+          }
+        });
+        if (has_dst && def_stamp[instr.dst] != b + 1) {
+          def_stamp[instr.dst] = b + 1;
+          kill[b].push_back(instr.dst);
+        }
+        if (instr.op == Opcode::LoadConst) {
+          is_const[instr.dst] = true;
+        } else if (instr.op == Opcode::Move) {
+          move_from.emplace(instr.dst, instr.from);
+        }
+      }
+      std::sort(gen[b].begin(), gen[b].end());
+      std::sort(kill[b].begin(), kill[b].end());
+    }
+
+    // Solve the live-in and live-out sets of the blocks.
+    auto successors = [&](size_t b) {
+      std::vector<size_t> succs;
+      size_t last = block_begin[b + 1] - 1;
+      const Instruction& instr = instrs[last];
+      if (instr.op == Opcode::If) {
+        succs.push_back(block_of[last + instr.if_op.true_offset]);
+        succs.push_back(block_of[last + instr.if_op.false_offset]);
+      } else if (instr.op == Opcode::Goto) {
+        succs.push_back(block_of[last + instr.pc_offset]);
+      } else if (instr.op != Opcode::Ret && instr.op != Opcode::Fatal && last + 1 < num_instrs) {
+        succs.push_back(block_of[last + 1]);
+      }
+      return succs;
+    };
+    std::vector<std::vector<RegName>> live_in(num_blocks), live_out(num_blocks);
+    for (bool changed = true; changed;) {
+      changed = false;
+      for (size_t b = num_blocks; b-- > 0;) {
+        std::vector<RegName> out;
+        for (size_t succ : successors(b)) {
+          std::vector<RegName> merged;
+          std::set_union(out.begin(), out.end(), live_in[succ].begin(), live_in[succ].end(),
+                         std::back_inserter(merged));
+          out.swap(merged);
+        }
+        std::vector<RegName> in, alive;
+        std::set_difference(out.begin(), out.end(), kill[b].begin(), kill[b].end(),
+                            std::back_inserter(alive));
+        std::set_union(gen[b].begin(), gen[b].end(), alive.begin(), alive.end(),
+                       std::back_inserter(in));
+        // The sets only grow during the iterations.
+        changed |= in.size() != live_in[b].size() || out.size() != live_out[b].size();
+        live_in[b].swap(in);
+        live_out[b].swap(out);
+      }
+    }
+
+    // Get the live ranges, which are extended by the boundaries of the blocks and the operands.
+    constexpr Index kNone = -1;
+    std::vector<Index> range_begin(num_regs, kNone), range_end(num_regs, kNone);
+    auto extend = [&](RegName reg, Index point) {
+      if (range_begin[reg] == kNone || point < range_begin[reg]) {
+        range_begin[reg] = point;
+      }
+      range_end[reg] = std::max(range_end[reg], point);
+    };
+    for (size_t b = 0; b < num_blocks; ++b) {
+      for (RegName reg : live_in[b]) {
+        extend(reg, 2 * block_begin[b]);
+      }
+      for (RegName reg : live_out[b]) {
+        extend(reg, 2 * block_begin[b + 1] - 1);
+      }
+    }
+    for (size_t pc = 0; pc < num_instrs; ++pc) {
+      for (RegName reg : uses[pc]) {
+        extend(reg, 2 * pc);
+      }
+      if (HasDst(instrs[pc].op)) {
+        extend(instrs[pc].dst, 2 * pc + 1);
+      }
+    }
+
+    // Assign the registers in the order of the live ranges, preferring the register of the source
+    // of a move, so the move is removed.
+    std::vector<RegName> order;
+    for (RegName reg = num_params; reg < num_regs; ++reg) {
+      if (range_begin[reg] != kNone) {
+        order.push_back(reg);
+      }
+    }
+    std::sort(order.begin(), order.end(), [&](RegName lhs, RegName rhs) {
+      return range_begin[lhs] < range_begin[rhs] ||
+             (range_begin[lhs] == range_begin[rhs] && lhs < rhs);
+    });
+    std::vector<RegName> assigned(num_regs);
+    std::vector<bool> done(num_regs, false);
+    for (RegName reg = 0; reg < num_params; ++reg) {
+      assigned[reg] = reg;
+    }
+    using Active = std::pair<Index, RegName>;
+    std::priority_queue<Active, std::vector<Active>, std::greater<Active>> active;
+    std::set<RegName> spare[2];
+    RegName next_reg = num_params;
+    for (RegName reg : order) {
+      while (!active.empty() && active.top().first < range_begin[reg]) {
+        RegName expired = active.top().second;
+        spare[is_const[expired]].insert(assigned[expired]);
+        active.pop();
+      }
+      auto& pool = spare[is_const[reg]];
+      auto it = move_from.find(reg);
+      auto hint = it != move_from.end() && done[it->second] ? pool.find(assigned[it->second])
+                                                             : pool.end();
+      if (hint == pool.end()) {
+        hint = pool.begin();
+      }
+      if (hint != pool.end()) {
+        assigned[reg] = *hint;
+        pool.erase(hint);
+      } else {
+        assigned[reg] = next_reg++;
+      }
+      done[reg] = true;
+      active.emplace(range_end[reg], reg);
+    }
+
+    for (auto& instr : instrs) {
+      ForEachRegister(&instr, [&assigned](RegName* reg) { *reg = assigned[*reg]; });
+    }
+    Rewrite(func, [&](size_t pc, size_t new_pc, std::vector<Instruction>* expansion) {
+      const Instruction& instr = func->instructions[pc];
+      return instr.op == Opcode::Move && instr.from == instr.dst;
+    });
+    func->register_file_size = next_reg;
+  }
+
+  /*!
+   * \brief Fuse the allocations of the tensors owning their storages, i.e., LoadConst of the size,
+   * AllocStorage and AllocTensor with own, into AllocOwnedTensor, if the size and the storage are
+   * only used by the allocations, which are in the same block.
+   */
+  void FuseAllocations(VMFunction* func) {
+    const auto& instrs = func->instructions;
+    size_t num_instrs = instrs.size();
+    std::vector<size_t> num_uses(func->register_file_size, 0);
+    std::vector<size_t> num_defs(func->register_file_size, 0);
+    std::vector<size_t> def_pc(func->register_file_size, 0);
+    // The number of the block of each pc, where the stream instructions are separate blocks, since
+    // the allocations are not moved across them.
+    std::vector<bool> leader = FindLeaders(instrs);
+    std::vector<size_t> block_of(num_instrs);
+    for (size_t pc = 0, block = 0; pc < num_instrs; ++pc) {
+      const Instruction& instr = instrs[pc];
+      block += leader[pc] || IsStreamInstruction(instr.op);
+      block_of[pc] = block;
+      block += IsStreamInstruction(instr.op);
+      bool has_dst = HasDst(instr.op);
+      ForEachRegister(&instr, [&](const RegName* reg) {
+        if (has_dst && reg == &instr.dst) {
+          ++num_defs[*reg];
+          def_pc[*reg] = pc;
+        } else {
+          ++num_uses[*reg];
+        }
+      });
+    }
+    // Get the single-use register defined once at the pc in the same block, or -1.
+    auto single_def = [&](RegName reg, size_t pc) -> int64_t {
+      if (num_defs[reg] != 1 || num_uses[reg] != 1 || def_pc[reg] > pc ||
+          block_of[def_pc[reg]] != block_of[pc]) {
+        return -1;
+      }
+      return def_pc[reg];
+    };
+    std::unordered_map<size_t, Instruction> fused;
+    std::unordered_set<size_t> removed;
+    for (size_t pc = 0; pc < num_instrs; ++pc) {
+      const Instruction& tensor = instrs[pc];
+      if (tensor.op != Opcode::AllocTensor || !tensor.alloc_tensor.own) {
+        continue;
+      }
+      int64_t storage_pc = single_def(tensor.alloc_tensor.storage, pc);
+      if (storage_pc < 0 || instrs[storage_pc].op != Opcode::AllocStorage) {
+        continue;
+      }
+      const Instruction& storage = instrs[storage_pc];
+      int64_t size_pc = single_def(storage.alloc_storage.allocation_size, storage_pc);
+      if (size_pc < 0) {
+        continue;
+      }
+      const Instruction& size = instrs[size_pc];
+      Index allocation_size;
+      if (size.op == Opcode::LoadConsti) {
+        allocation_size = size.load_consti.val;
+      } else if (size.op == Opcode::LoadConst &&
+                 (*constants_)[size.const_index]->IsInstance<IntValueObj>()) {
+        allocation_size = Downcast<IntValue>((*constants_)[size.const_index])->value;
+      } else {
+        continue;
+      }
+      std::vector<int64_t> shape(tensor.alloc_tensor.shape,
+                                 tensor.alloc_tensor.shape + tensor.alloc_tensor.ndim);
+      fused.emplace(pc, Instruction::AllocOwnedTensor(
+                            allocation_size, storage.alloc_storage.alignment,
+                            storage.alloc_storage.device_type, storage.alloc_storage.device_id,
+                            tensor.alloc_tensor.offset, shape, tensor.alloc_tensor.dtype,
+                            tensor.dst));
+      removed.insert(storage_pc);
+      removed.insert(size_pc);
+    }
+    if (fused.empty()) {
+      return;
+    }
+    Rewrite(func, [&](size_t pc, size_t new_pc, std::vector<Instruction>* expansion) {
+      auto it = fused.find(pc);
+      if (it != fused.end()) {
+        expansion->push_back(it->second);
+      }
+      return it != fused.end() || removed.count(pc) > 0;
+    });
+  }
+
+  std::vector<VMFunction>* functions_;
+  const std::vector<Value>* constants_;
+  bool inline_jit_;
+};
+
+/*! \brief The persistent cache entry of a compiled VM executable. */
+class VMExecutableCacheEntry {
+ public:
+  VMExecutableCacheEntry() {
+  }
+
+  explicit VMExecutableCacheEntry(ObjectPtr<Executable> exec) : exec_(exec) {
+  }
+
+  ObjectPtr<Executable> Exec() const {
+    return exec_;
+  }
+
+  static VMExecutableCacheEntry Load(const std::string& path) {
+    std::string code;
+    tvm::runtime::LoadBinaryFromFile(path + "/executable.ro", &code);
+    tvm::runtime::Module mod = Executable::Load(code, tvm::runtime::Module());
+    auto* exec = static_cast<Executable*>(mod.operator->());
+    return VMExecutableCacheEntry(tvm::runtime::GetObjectPtr<Executable>(exec));
+  }
+
+  bool Save(const std::string& path) {
+    TVMByteArray code = exec_->Save();
+    tvm::runtime::SaveBinaryToFile(path + "/executable.ro", std::string(code.data, code.size));
+    return true;
+  }
+
+ private:
+  ObjectPtr<Executable> exec_;
+};
+
+MetaPersistCache<VMExecutableCacheEntry> CacheVMExecutable("vm_executable");
+
+/*!
+ * \brief The key of a compiled executable, which covers the module with its input types and bound
+ * constants, the devices, the pass and distributed configurations, and the build.
+ */
+HashKey ExecutableCacheKey(const IRModule& mod, const DeviceMap& device_map) {
+  HashKey key;
+  // The text form keys the structure. The serialized module also covers the constant tensors,
+  // which are only hashed to keep the key small.
+  std::string json = serialization::SaveJSON(mod);
+  key << ir::AsText(mod, false) << static_cast<uint64_t>(std::hash<std::string>()(json))
+      << static_cast<uint64_t>(json.size());
+  for (const auto& it : device_map) {
+    key << static_cast<int64_t>(it.first->value) << static_cast<DLDevice>(it.second);
+  }
+  auto pass_ctx = pass::PassContext::Current();
+  key << static_cast<int64_t>(pass_ctx->opt_level) << tvm::SaveJSON(pass_ctx->config)
+      << tvm::SaveJSON(pass_ctx->required_pass) << tvm::SaveJSON(pass_ctx->disabled_pass);
+  auto dctx = DistContext::Global();
+  key << dctx->rank << dctx->size << dctx->enable_data_parallel << dctx->zero_opt_level;
+  static const auto& git_version = registry::GetPackedFunc("raf.build_info.git_version");
+  key << git_version().operator std::string();
+  return key;
+}
+
+/*!
+ * \brief The cache of the shape-independent passes at the beginning of OptimizeModule. The input
+ * modules are keyed with the parameters of main untyped, so that the recompilations of a model
+ * with new input shapes reuse the outputs.
+ */
+class ShapeFreePrefixCache {
+ public:
+  static ShapeFreePrefixCache* Get() {
+    static ShapeFreePrefixCache cache;
+    return &cache;
+  }
+
+  /*!
+   * \brief Run the passes on the module, or reuse the output of an equal module, and then type the
+   * parameters of main in the output as the parameters of the module.
+   */
+  IRModule Run(const IRModule& mod, const Array<pass::Pass>& passes, bool inference) {
+    auto gvar = mod->GetGlobalVar("main");
+    Function main = Downcast<Function>(mod->Lookup(gvar));
+    Array<Var> untyped_params;
+    Map<Var, Expr> untype_map;
+    for (const auto& param : main->params) {
+      Var untyped = MakeVar(param->name_hint(), Type());
+      untyped_params.push_back(untyped);
+      untype_map.Set(param, untyped);
+    }
+    IRModule input = IRModule(mod->functions);
+    input->Add(gvar,
+               Function(untyped_params, tvm::relay::Bind(main->body, untype_map), Type(),
+                        main->type_params, main->attrs),
+               true);
+
+    size_t hash = dmlc::HashCombine(tvm::StructuralHash()(input), inference);
+    IRModule output;
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      for (const auto& entry : cache_[hash]) {
+        if (entry.inference == inference && tvm::StructuralEqual()(entry.input, input)) {
+          output = entry.output;
+          break;
+        }
+      }
+    }
+    if (!output.defined()) {
+      output = pass::RAFSequential(passes, "ShapeFreePrefix")(input);
+      std::lock_guard<std::mutex> lock(mu_);
+      cache_[hash].push_back(Entry{input, output, inference});
+    }
+
+    Function out_main = Downcast<Function>(output->Lookup("main"));
+    CHECK_EQ(out_main->params.size(), main->params.size());
+    Map<Var, Expr> type_map;
+    for (size_t i = 0; i < main->params.size(); ++i) {
+      type_map.Set(out_main->params[i], main->params[i]);
+    }
+    IRModule ret = IRModule(output->functions);
+    ret->Add(ret->GetGlobalVar("main"),
+             Function(main->params, tvm::relay::Bind(out_main->body, type_map), main->ret_type,
+                      out_main->type_params, out_main->attrs),
+             true);
+    return ret;
+  }
+
+ private:
+  struct Entry {
+    /*! \brief The input module, where the parameters of main are untyped. */
+    IRModule input;
+    /*! \brief The output module of the passes. */
+    IRModule output;
+    /*! \brief Whether the passes compile for inference. */
+    bool inference;
+  };
+
+  /*! \brief The entries by the structural hash of their inputs. */
+  std::unordered_map<size_t, std::vector<Entry>> cache_;
+  std::mutex mu_;
+};
+
 void VMCompiler::SetParam(const std::string& name, Value data_in) {
   params_[name] = data_in;
 }
@@ -780,8 +1581,23 @@ void VMCompiler::Lower(IRModule mod, const DeviceMap& device_map) {
     mod->Add(gvar, f, true);
   }
 
-  exec_ = make_object<Executable>();
   device_map_ = device_map;
+  if (!CacheVMExecutable.IsPersistent()) {
+    Compile(mod);
+    return;
+  }
+  // The executables are persisted with the kernels JIT'ed from the persistent op caches, so a
+  // restarted process skips the optimizations and the compilation of a module seen before.
+  const auto* entry = CacheVMExecutable.GetOrCompute(
+      ExecutableCacheKey(mod, device_map).Digest(), [this, &mod]() {
+        Compile(mod);
+        return VMExecutableCacheEntry(exec_);
+      });
+  exec_ = entry->Exec();
+}
+
+void VMCompiler::Compile(IRModule mod) {
+  exec_ = make_object<Executable>();
 
   // Run the optimizations necessary to target the VM.
   context_.module = OptimizeModule(mod, device_map_);
@@ -809,6 +1625,19 @@ void VMCompiler::Lower(IRModule mod, const DeviceMap& device_map) {
     }
   }
 
+  auto pass_ctx = pass::PassContext::Current();
+  bool deduplicate = pass_ctx->GetConfig("raf.vm.optimize.deduplicate", Bool(false)).value();
+  BytecodeOptimizer optimizer(&exec_->functions, &context_.constants, !deduplicate);
+  if (pass_ctx->GetConfig("raf.vm.optimize.fuse_instructions", Bool(true)).value()) {
+    optimizer.FuseInstructions();
+  }
+  if (pass_ctx->GetConfig("raf.vm.optimize.inline_calls", Bool(true)).value()) {
+    optimizer.OptimizeCalls();
+  }
+  if (pass_ctx->GetConfig("raf.vm.optimize.allocate_registers", Bool(true)).value()) {
+    optimizer.AllocateRegisters();
+  }
+
 #if USE_RELAY_DEBUG
   for (auto vm_func : exec_->functions) {
     DLOG(INFO) << vm_func << "-------------";
@@ -837,14 +1666,79 @@ IRModule VMCompiler::OptimizeModule(const IRModule& mod, const DeviceMap& device
   Array<pass::Pass> pass_seqs;
 
   // optimization passes that work on ANF
-  pass_seqs.push_back(pass::GradInputSelect());
+  bool inference = pass_ctx->GetConfig("raf.vm.optimize.inference", Bool(false)).value();
+  if (inference) {
+    // Compile a forward-only executable: switch the training ops (e.g., batch_norm_train) to
+    // their inference variants and remove the dropouts. There is no backward closure to select
+    // the gradients from.
+    pass_seqs.push_back(pass::SwitchTrainOp(false));
+  } else {
+    pass_seqs.push_back(pass::GradInputSelect());
+  }
   pass_seqs.push_back(pass::InlineLet());
   pass_seqs.push_back(pass::DeadCodeElimination());
+  if (pass_ctx->GetConfig("raf.vm.optimize.eliminate_common_subexpr", Bool(true)).value()) {
+    // Remove the redundant ops, e.g., the ones computed again by the backward.
+    pass_seqs.push_back(pass::EliminateCommonSubexpr());
+  }
+  // The passes above do not depend on the types. When the prefix cache is enabled, they are
+  // skipped for the modules that only differ from a module compiled before in input shapes, and
+  // only the following shape-dependent passes run again. The kernels of the unchanged shapes are
+  // reused from the op caches.
+  IRModule updated_mod = mod;
+  if (pass_ctx->GetConfig("raf.vm.optimize.cache_shape_free_prefix", Bool(false)).value() &&
+      mod->ContainGlobalVar("main")) {
+    updated_mod = ShapeFreePrefixCache::Get()->Run(mod, pass_seqs, inference);
+    pass_seqs = {pass::InferType()};
+  }
+  if (!inference) {
+    // Store the activations saved for the backward in compressed forms, following
+    // raf.compress_activation.policy. It is a no-op if no policy is given.
+    pass_seqs.push_back(pass::CompressActivation());
+  }
+  bool fold_constant =
+      inference || pass_ctx->GetConfig("raf.vm.optimize.fold_constant", Bool(false)).value();
+  if (fold_constant) {
+    // Fold the computation on the bound parameters for inference. The constants are evaluated on
+    // the target device of this scope, and the outputs larger than raf.fold_const.max_bytes are
+    // kept as calls.
+    pass_seqs.push_back(pass::SimplifyInference());
+    pass_seqs.push_back(pass::FoldConstant());
+    pass_seqs.push_back(pass::DeadCodeElimination());
+  }
+  if (pass_ctx->GetConfig("raf.vm.optimize.merge_sibling_gemm", Bool(false)).value()) {
+    // Merge the GEMMs sharing an input into one wide GEMM. The weights are concatenated after
+    // SimplifyInference, so that the concatenations are folded along with the transposes below.
+    pass_seqs.push_back(pass::MergeSiblingGemm());
+  }
+  // Convert the convolutions to NHWC before the dialects are dispatched. It is a no-op unless the
+  // target is CUDA.
+  pass_seqs.push_back(pass::ConvertLayout());
+  if (fold_constant) {
+    // Fold the transposes and the concatenations of the constant weights.
+    pass_seqs.push_back(pass::FoldConstant());
+  }
 
   bool enable_stream_schedule = true;
+  bool deduplicate = pass_ctx->GetConfig("raf.vm.optimize.deduplicate", Bool(false)).value();
   if (!pass_ctx->GetConfig("raf.vm.optimize.anf_only", Bool(false)).value()) {
+    if (pass_ctx->GetConfig("raf.vm.optimize.predicate_if", Bool(false)).value()) {
+      // Select the results of the small branches on the device, so the VM does not read the
+      // conditions back to the host. ToGraphNormalForm flattens the selects.
+      pass_seqs.push_back(pass::InferType());
+      pass_seqs.push_back(pass::PredicateIf());
+    }
     // optimization passes that work on BBNF
     pass_seqs.push_back(pass::ToGraphNormalForm());
+    if (deduplicate) {
+      // Extract the repeated subgraphs (e.g., identical layers) into shared closures. The rest of
+      // the pipeline treats a closure call as a single node, fuses and dispatches each closure
+      // body once, and LambdaLift lifts the identical closures to the same global function. As a
+      // result, the kernels of a layer are compiled once, and the VM caches one set of OpEnvs per
+      // unique layer that is reused by all of its call sites.
+      pass_seqs.push_back(pass::InferType());
+      pass_seqs.push_back(pass::Deduplicate(0, true, true, tvm::NullOpt));
+    }
     pass_seqs.push_back(pass::ToBasicBlockNormalForm());
     pass_seqs.push_back(pass::SimplifyExpr());
     pass_seqs.push_back(pass::InferType());
@@ -868,7 +1762,9 @@ IRModule VMCompiler::OptimizeModule(const IRModule& mod, const DeviceMap& device
         // https://github.com/NVIDIA/nccl/issues/522, https://github.com/NVIDIA/nccl/issues/195).
         // Thus currently distributed learning and the multi-stream passes are mutually exclusive.
         pass_seqs.push_back(pass::DataParallelSchedule());
+        pass_seqs.push_back(pass::BucketAllReduce());
         pass_seqs.push_back(pass::AnnotateCollectiveOps());
+        pass_seqs.push_back(pass::OffloadActivation());
         pass_seqs.push_back(pass::EnforceSync());
       } else {
         auto policy_name =
@@ -876,6 +1772,11 @@ IRModule VMCompiler::OptimizeModule(const IRModule& mod, const DeviceMap& device
         if (policy_name == "sequential") {
           enable_stream_schedule = false;
           pass_seqs.push_back(pass::ToANormalForm());
+          if (pass_ctx->GetConfig("raf.offload.pcie_bandwidth", Integer(0)).value()->value > 0) {
+            // Offloaded activations are copied on the memory copy streams.
+            pass_seqs.push_back(pass::OffloadActivation());
+            pass_seqs.push_back(pass::EnforceSync());
+          }
         } else if (policy_name == "wavefront") {
           pass_seqs.push_back(pass::WavefrontStreamSchedule());
         } else if (policy_name == "asap") {
@@ -889,24 +1790,48 @@ IRModule VMCompiler::OptimizeModule(const IRModule& mod, const DeviceMap& device
         }
       }
     } else {
-      enable_stream_schedule = false;
-      pass_seqs.push_back(pass::ToANormalForm());
+      // On the CPU, the ops of the non-default streams run in parallel on the host streams of the
+      // VM. Only the schedulers without a cost model of the device are supported.
+      auto policy_name =
+          pass_ctx->GetConfig<tvm::String>("raf.stream_schedule.policy", "sequential");
+      if (policy_name == "wavefront") {
+        pass_seqs.push_back(pass::WavefrontStreamSchedule());
+      } else if (policy_name == "asap") {
+        pass_seqs.push_back(pass::ASAPStreamSchedule());
+      } else {
+        enable_stream_schedule = false;
+        pass_seqs.push_back(pass::ToANormalForm());
+      }
     }
   } else {
     enable_stream_schedule = false;
   }
+  if (deduplicate && enable_stream_schedule) {
+    // The stream schedulers only convert the main function to ANF, so the bodies of the shared
+    // closures are converted here.
+    pass_seqs.push_back(pass::ToANormalForm());
+  }
 
   // optimization passes that work on ANF
   pass_seqs.push_back(pass::InlinePrimitives());
   pass_seqs.push_back(pass::InferType());
   pass_seqs.push_back(pass::InplaceUpdate());
-  if (!enable_stream_schedule) {
+  if (!enable_stream_schedule && !inference) {
+    if (pass_ctx->GetConfig("raf.vm.optimize.optimizer_in_backward", Bool(false)).value()) {
+      // Update each parameter right after its gradient is produced, so the gradients are not
+      // live all together. The data parallel schedule keeps the order of the allreduces instead.
+      pass_seqs.push_back(pass::OptimizerInBackward());
+    }
     // TODO(@comaniac): Support rematerialization with multi-streaming.
     pass_seqs.push_back(pass::InferType());
     pass_seqs.push_back(pass::MemorySchedule());
     pass_seqs.push_back(pass::InferType());
     pass_seqs.push_back(pass::Rematerialization());
   }
+  if (pass_ctx->GetConfig("raf.managed_memory.prefetch_distance", Integer(0)).value()->value > 0) {
+    // Hint the unified memory in the final order of the bindings.
+    pass_seqs.push_back(pass::ManagedMemoryHint());
+  }
   // TODO(@hzfan): Currently disable the ValidateInplaceUpdate pass because it removes the may_share
   // attr in some cases without any error messages.
   // pass_seqs.push_back(pass::ValidateInplaceUpdate(true));
@@ -915,9 +1840,12 @@ IRModule VMCompiler::OptimizeModule(const IRModule& mod, const DeviceMap& device
   pass_seqs.push_back(pass::InferType());
   pass_seqs.push_back(pass::ManifestAlloc());
   pass_seqs.push_back(pass::MemoryPlan());
+  if (DistContext::Global()->enable_data_parallel) {
+    pass_seqs.push_back(pass::BucketAllReduceLayout());
+  }
 
   pass::RAFSequential seq(pass_seqs);
-  return seq(mod);
+  return seq(updated_mod);
 }
 
 void VMCompiler::PopulateGlobalMap() {
@@ -977,6 +1905,18 @@ PackedFunc VMCompiler::GetFunction(const std::string& name, const ObjectPtr<Obje
 }
 
 TVM_REGISTER_PASS_CONFIG_OPTION("raf.vm.optimize.anf_only", Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.vm.optimize.deduplicate", Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.vm.optimize.eliminate_common_subexpr", Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.vm.optimize.fold_constant", Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.vm.optimize.cache_shape_free_prefix", Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.vm.optimize.inference", Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.vm.optimize.merge_sibling_gemm", Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.vm.optimize.predicate_if", Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.vm.optimize.fuse_instructions", Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.vm.optimize.inline_calls", Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.vm.optimize.allocate_registers", Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.vm.optimize.optimizer_in_backward", Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.vm.multi_device", Bool);
 
 RAF_REGISTER_GLOBAL("raf.vm.VMCompiler").set_body_typed(CreateVMCompiler);
 
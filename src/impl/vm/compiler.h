@@ -90,6 +90,9 @@ class VMCompiler : public tvm::runtime::ModuleNode {
  protected:
   IRModule OptimizeModule(const IRModule& mod, const DeviceMap& device_map);
 
+  /*! \brief Optimize and compile the module into a new executable. */
+  void Compile(IRModule mod);
+
   void PopulateGlobalMap();
 
  protected:
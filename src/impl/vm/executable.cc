@@ -9,15 +9,25 @@
  */
 
 #include <dmlc/memory_io.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <tvm/runtime/memory.h>
 #include <tvm/runtime/object.h>
+#include <unistd.h>
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cstring>
+#include <fstream>
 #include <iostream>
 #include <sstream>
+#include <thread>
 #include <vector>
 
+#include "raf/cache.h"
+#include "raf/memory_pool.h"
 #include "raf/serialization.h"
 #include "raf/vm/vm.h"
 #include "./serialize_util.h"
@@ -33,6 +43,43 @@ using namespace raf::registry;
   CHECK(val) << "Invalid VM file format in the " << section << " section." \
              << "\n";
 
+/*! \brief A private memory mapping of an executable file. */
+struct MappedFile {
+  MappedFile(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    CHECK_NE(fd, -1) << "Cannot open " << path;
+    struct stat st;
+    CHECK_EQ(fstat(fd, &st), 0) << "Cannot stat " << path;
+    size = static_cast<size_t>(st.st_size);
+    // Tensors are mapped copy-on-write in case that the constants are modified in-place.
+    void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    CHECK(ptr != MAP_FAILED) << "Cannot map " << path;
+    data = static_cast<uint8_t*>(ptr);
+  }
+
+  ~MappedFile() {
+    munmap(data, size);
+  }
+
+  /*! \brief The beginning of the mapping. */
+  uint8_t* data;
+  /*! \brief The size of the mapping. */
+  size_t size;
+};
+
+/*! \brief The memory of a constant that keeps the mapping alive. */
+class MappedMemory final : public memory_pool::Memory {
+ public:
+  MappedMemory(void* data, std::shared_ptr<MappedFile> file) : file(std::move(file)) {
+    this->data = data;
+    this->device = Device(DevType::kCPU(), 0);
+  }
+
+  /*! \brief The mapped file. */
+  std::shared_ptr<MappedFile> file;
+};
+
 // Helper to serialize a vm instruction.
 VMInstructionSerializer SerializeInstruction(const Instruction& instr);
 // Helper to deserialize a serialized vm instruction.
@@ -48,7 +95,16 @@ PackedFunc Executable::GetFunction(const std::string& name, const ObjectPtr<Obje
   } else if (name == "get_stats") {
     return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { *rv = this->Stats(); });
   } else if (name == "save") {
-    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { *rv = this->Save(); });
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      bool bundle_kernels = args.size() > 0 && static_cast<bool>(args[0]);
+      *rv = this->Save(bundle_kernels);
+    });
+  } else if (name == "save_to_file") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      std::string path = args[0];
+      bool bundle_kernels = args.size() > 1 && static_cast<bool>(args[1]);
+      this->SaveToFile(path, bundle_kernels);
+    });
   } else if (name == "get_function_arity") {
     return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
       std::string func_name = args[0];
@@ -171,7 +227,7 @@ void SaveHeader(dmlc::Stream* strm) {
   strm->Write(version);
 }
 
-TVMByteArray Executable::Save() {
+TVMByteArray Executable::Save(bool bundle_kernels) {
   // Initialize the stream object.
   code_.clear();
   dmlc::MemoryStringStream strm(&code_);
@@ -191,6 +247,11 @@ TVMByteArray Executable::Save() {
   // Code section.
   SaveCodeSection(&strm);
 
+  // Kernel section.
+  if (bundle_kernels) {
+    SaveKernelSection(&strm);
+  }
+
   TVMByteArray arr;
   arr.data = code_.c_str();
   arr.size = code_.length();
@@ -214,11 +275,112 @@ void Executable::SaveGlobalSection(dmlc::Stream* strm) {
 
 void Executable::SaveConstantSection(dmlc::Stream* strm) {
   strm->Write(static_cast<uint64_t>(constants.size()));
+  // The constants are encoded in parallel by chunks, and written in order, so the section is the
+  // same as encoding them one by one. The chunks bound the memory of the encoded copies.
+  size_t num_threads = std::max(1U, std::thread::hardware_concurrency());
+  num_threads = std::min(num_threads, constants.size());
+  if (num_threads <= 1) {
+    for (const auto& value : this->constants) {
+      serialization::SerializeValue(strm, value);
+    }
+    return;
+  }
+  size_t chunk_size = num_threads * 4;
+  std::vector<std::string> encoded(chunk_size);
+  for (size_t begin = 0; begin < constants.size(); begin += chunk_size) {
+    size_t end = std::min(begin + chunk_size, constants.size());
+    std::atomic<size_t> next{begin};
+    auto worker = [&]() {
+      for (size_t i = next++; i < end; i = next++) {
+        dmlc::MemoryStringStream value_strm(&encoded[i - begin]);
+        serialization::SerializeValue(&value_strm, constants[i]);
+      }
+    };
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < std::min(num_threads, end - begin); ++i) {
+      threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    for (size_t i = begin; i < end; ++i) {
+      std::string& bytes = encoded[i - begin];
+      strm->Write(bytes.data(), bytes.size());
+      std::string().swap(bytes);
+    }
+  }
+}
+
+void Executable::SaveMappedConstantSection(dmlc::Stream* strm,
+                                           std::vector<tensor::Tensor>* blobs) {
+  strm->Write(static_cast<uint64_t>(constants.size()));
+  uint64_t offset = 0;
   for (const auto& value : this->constants) {
-    serialization::SerializeValue(strm, value);
+    const auto* tensor = value.as<TensorValueObj>();
+    if (tensor == nullptr || !tvm::runtime::IsContiguous(*tensor->tensor.operator->())) {
+      // Other constants are small, so they are serialized inline.
+      strm->Write(static_cast<uint8_t>(0));
+      serialization::SerializeValue(strm, value);
+      continue;
+    }
+    tensor::Tensor data = tensor->tensor;
+    if (data->device.device_type != kDLCPU) {
+      data = data.CopyTo(Device(DevType::kCPU(), 0));
+    }
+    const DLTensor* t = data.operator->();
+    uint64_t nbytes = tvm::runtime::GetDataSize(*t);
+    strm->Write(static_cast<uint8_t>(1));
+    strm->Write(t->dtype.code);
+    strm->Write(t->dtype.bits);
+    strm->Write(t->dtype.lanes);
+    strm->Write(std::vector<int64_t>(t->shape, t->shape + t->ndim));
+    strm->Write(offset);
+    strm->Write(nbytes);
+    offset += (nbytes + kMetaVMMappedAlignment - 1) / kMetaVMMappedAlignment *
+              kMetaVMMappedAlignment;
+    blobs->push_back(data);
   }
 }
 
+void Executable::SaveToFile(const std::string& path, bool bundle_kernels) {
+  std::string meta;
+  std::vector<tensor::Tensor> blobs;
+  {
+    dmlc::MemoryStringStream strm(&meta);
+    SaveHeader(&strm);
+    SaveGlobalSection(&strm);
+    SaveMappedConstantSection(&strm, &blobs);
+    SavePrimitiveOpNames(&strm);
+    SaveCodeSection(&strm);
+    if (bundle_kernels) {
+      SaveKernelSection(&strm);
+    }
+  }
+
+  // File layout: magic, version, meta size, data offset, meta, and page-aligned tensor blobs.
+  std::ofstream fout(path, std::ios::binary);
+  CHECK(fout) << "Cannot open " << path;
+  uint64_t meta_size = meta.size();
+  uint64_t head_size = 4 * sizeof(uint64_t) + meta_size;
+  uint64_t data_offset = (head_size + kMetaVMMappedAlignment - 1) / kMetaVMMappedAlignment *
+                         kMetaVMMappedAlignment;
+  uint64_t fields[] = {kMetaVMMappedMagic, kMetaVMMappedVersion, meta_size, data_offset};
+  fout.write(reinterpret_cast<const char*>(fields), sizeof(fields));
+  fout.write(meta.data(), meta.size());
+  std::vector<char> padding(kMetaVMMappedAlignment, 0);
+  fout.write(padding.data(), data_offset - head_size);
+  for (const auto& blob : blobs) {
+    const DLTensor* t = blob.operator->();
+    uint64_t nbytes = tvm::runtime::GetDataSize(*t);
+    fout.write(static_cast<const char*>(t->data) + t->byte_offset, nbytes);
+    uint64_t aligned = (nbytes + kMetaVMMappedAlignment - 1) / kMetaVMMappedAlignment *
+                       kMetaVMMappedAlignment;
+    fout.write(padding.data(), aligned - nbytes);
+  }
+  CHECK(fout) << "Failed to write " << path;
+}
+
 void Executable::SavePrimitiveOpNames(dmlc::Stream* strm) {
   std::vector<std::string> primitive_names;
   for (const auto& it : this->primitive_map) {
@@ -316,6 +478,15 @@ VMInstructionSerializer SerializeInstruction(const Instruction& instr) {
       fields.push_back(instr.alloc_tensor_reg.own);
       break;
     }
+    case Opcode::AllocOwnedTensor: {
+      // Number of fields = 10 + instr.alloc_owned_tensor.ndim
+      const auto& alloc = instr.alloc_owned_tensor;
+      fields.assign({alloc.allocation_size, alloc.alignment, alloc.device_type, alloc.device_id,
+                     alloc.offset, alloc.dtype.code, alloc.dtype.bits, alloc.dtype.lanes,
+                     alloc.ndim, instr.dst});
+      fields.insert(fields.end(), alloc.shape, alloc.shape + alloc.ndim);
+      break;
+    }
     case Opcode::AllocStorage: {
       fields.push_back(instr.alloc_storage.allocation_size);
       fields.push_back(instr.alloc_storage.alignment);
@@ -352,10 +523,11 @@ VMInstructionSerializer SerializeInstruction(const Instruction& instr) {
       break;
     }
     case Opcode::SetShape: {
-      // Number of fields = 3
+      // Number of fields = 4
       fields.push_back(instr.set_shape.data);
       fields.push_back(instr.set_shape.shape);
       fields.push_back(instr.dst);
+      fields.push_back(instr.set_shape.byte_offset);
       break;
     }
     case Opcode::If: {
@@ -423,9 +595,10 @@ VMInstructionSerializer SerializeInstruction(const Instruction& instr) {
       break;
     }
     case Opcode::CudaSetStream: {
-      // Number of fields = 2
+      // Number of fields = 3
       fields.push_back(instr.cuda_set_stream.device_id);
       fields.push_back(instr.cuda_set_stream.stream_id);
+      fields.push_back(instr.cuda_set_stream.priority);
       break;
     }
     case Opcode::CudaAddEvent:
@@ -456,14 +629,24 @@ void Executable::SaveCodeSection(dmlc::Stream* strm) {
                                      func.params);
     func_format.Save(strm);
 
-    // Serialize each instruction.
+    // Serialize each instruction, reusing the buffer of the serialized fields.
+    std::vector<Index> buffer;
     for (const auto& instr : func.instructions) {
-      const auto& serialized_instr = SerializeInstruction(instr);
-      serialized_instr.Save(strm);
+      SerializeInstruction(instr).Save(strm, &buffer);
     }
   }
 }
 
+void Executable::SaveKernelSection(dmlc::Stream* strm) {
+  // Save the number of caches, and the name and the packed entries of each cache.
+  const auto& registry = op::BundledCache::Registry();
+  strm->Write(static_cast<uint64_t>(registry.size()));
+  for (const auto& kv : registry) {
+    strm->Write(kv.first);
+    strm->Write(kv.second->ExportEntries());
+  }
+}
+
 void LoadHeader(dmlc::Stream* strm) {
   // Check header.
   uint64_t header;
@@ -497,9 +680,97 @@ tvm::runtime::Module Executable::Load(const std::string& code, const tvm::runtim
   // Code section.
   exec->LoadCodeSection(&strm);
 
+  // Kernel section.
+  exec->LoadKernelSection(&strm);
+
+  return tvm::runtime::Module(exec);
+}
+
+tvm::runtime::Module Executable::LoadFromFile(const std::string& path,
+                                              const tvm::runtime::Module lib) {
+  auto exec = make_object<Executable>();
+  exec->lib = lib;
+  exec->mapped_file_ = std::make_shared<MappedFile>(path);
+  uint8_t* base = exec->mapped_file_->data;
+  size_t size = exec->mapped_file_->size;
+
+  // Check the file header.
+  uint64_t fields[4];
+  STREAM_CHECK(size >= sizeof(fields), "header");
+  std::memcpy(fields, base, sizeof(fields));
+  STREAM_CHECK(fields[0] == kMetaVMMappedMagic, "header");
+  CHECK_EQ(fields[1], kMetaVMMappedVersion) << "Unsupported VM file version " << fields[1];
+  uint64_t meta_size = fields[2];
+  uint64_t data_offset = fields[3];
+  STREAM_CHECK(sizeof(fields) + meta_size <= data_offset && data_offset <= size, "header");
+
+  dmlc::MemoryFixedSizeStream strm(base + sizeof(fields), meta_size);
+  LoadHeader(&strm);
+  exec->LoadGlobalSection(&strm);
+  exec->LoadMappedConstantSection(&strm, base + data_offset, size - data_offset);
+  exec->LoadPrimitiveOpNames(&strm);
+  exec->LoadCodeSection(&strm);
+  exec->LoadKernelSection(&strm);
+
   return tvm::runtime::Module(exec);
 }
 
+void Executable::LoadMappedConstantSection(dmlc::Stream* strm, uint8_t* data, size_t data_size) {
+  uint64_t sz;
+  STREAM_CHECK(strm->Read(&sz, sizeof(sz)), "constant");
+  size_t size = static_cast<size_t>(sz);
+  mapped_constants_.resize(size, false);
+  for (size_t i = 0; i < size; i++) {
+    uint8_t kind;
+    STREAM_CHECK(strm->Read(&kind), "constant");
+    if (kind == 0) {
+      constants.push_back(serialization::DeserializeValue(strm));
+      continue;
+    }
+    DLDataType dtype;
+    std::vector<int64_t> shape;
+    uint64_t offset, nbytes;
+    STREAM_CHECK(strm->Read(&dtype.code), "constant");
+    STREAM_CHECK(strm->Read(&dtype.bits), "constant");
+    STREAM_CHECK(strm->Read(&dtype.lanes), "constant");
+    STREAM_CHECK(strm->Read(&shape), "constant");
+    STREAM_CHECK(strm->Read(&offset), "constant");
+    STREAM_CHECK(strm->Read(&nbytes), "constant");
+    STREAM_CHECK(offset + nbytes <= data_size, "constant");
+    void* ptr = data + offset;
+    auto mem = std::make_shared<MappedMemory>(ptr, mapped_file_);
+    constants.push_back(
+        TensorValue::Assemble(Device(DevType::kCPU(), 0), dtype, shape, {}, ptr, mem));
+    mapped_constants_[i] = true;
+  }
+}
+
+void Executable::LoadKernelSection(dmlc::Stream* strm) {
+  uint64_t num_caches;
+  // The section is optional.
+  if (!strm->Read(&num_caches)) {
+    return;
+  }
+  const auto& registry = op::BundledCache::Registry();
+  size_t num_entries = 0;
+  for (uint64_t i = 0; i < num_caches; ++i) {
+    std::string name;
+    std::vector<std::string> entries;
+    STREAM_CHECK(strm->Read(&name), "kernel");
+    STREAM_CHECK(strm->Read(&entries), "kernel");
+    auto it = registry.find(name);
+    if (it == registry.end()) {
+      LOG(WARNING) << "Skip the bundled entries of the unknown cache " << name;
+      continue;
+    }
+    for (const auto& entry : entries) {
+      it->second->ImportEntry(entry);
+    }
+    num_entries += entries.size();
+  }
+  DLOG(INFO) << "Loaded " << num_entries << " bundled kernels and algorithms";
+}
+
 void Executable::LoadGlobalSection(dmlc::Stream* strm) {
   std::vector<std::string> globals;
   STREAM_CHECK(strm->Read(&globals), "global");
@@ -633,6 +904,29 @@ Instruction DeserializeInstruction(const VMInstructionSerializer& instr) {
 
       return Instruction::AllocClosure(func_index, free_vars, dst);
     }
+    case Opcode::AllocOwnedTensor: {
+      // Number of fields = 10 + instr.alloc_owned_tensor.ndim
+      DCHECK_GE(instr.fields.size(), 10U);
+      DCHECK_EQ(instr.fields.size(), 10U + static_cast<size_t>(instr.fields[8]));
+
+      Index allocation_size = instr.fields[0];
+      Index alignment = instr.fields[1];
+      DevType device_type = instr.fields[2];
+      Index device_id = instr.fields[3];
+      Index offset = instr.fields[4];
+
+      DLDataType dtype;
+      dtype.code = instr.fields[5];
+      dtype.bits = instr.fields[6];
+      dtype.lanes = instr.fields[7];
+
+      Index ndim = instr.fields[8];
+      RegName dst = instr.fields[9];
+      std::vector<Index> shape = ExtractFields(instr.fields, 10, ndim);
+
+      return Instruction::AllocOwnedTensor(allocation_size, alignment, device_type, device_id,
+                                           offset, shape, dtype, dst);
+    }
     case Opcode::AllocStorage: {
       DCHECK_GE(instr.fields.size(), 6U);
       Index allocation_size = instr.fields[0];
@@ -660,8 +954,10 @@ Instruction DeserializeInstruction(const VMInstructionSerializer& instr) {
       RegName data = instr.fields[0];
       RegName shape = instr.fields[1];
       RegName dst = instr.fields[2];
+      // The executables serialized before the views with offsets have 3 fields.
+      Index byte_offset = instr.fields.size() > 3U ? instr.fields[3] : 0;
 
-      return Instruction::SetShape(data, shape, dst);
+      return Instruction::SetShape(data, shape, byte_offset, dst);
     }
     case Opcode::If: {
       // Number of fields = 4
@@ -740,9 +1036,10 @@ Instruction DeserializeInstruction(const VMInstructionSerializer& instr) {
       return Instruction::InferType(op_reg, args, dst);
     }
     case Opcode::CudaSetStream: {
-      // Number of fields = 2
-      DCHECK_EQ(instr.fields.size(), 2U);
-      return Instruction::CudaSetStream(instr.fields[0], instr.fields[1]);
+      // Number of fields = 3, or 2 for the executables saved without the stream priority
+      DCHECK(instr.fields.size() == 2U || instr.fields.size() == 3U);
+      Index priority = instr.fields.size() == 3U ? instr.fields[2] : 0;
+      return Instruction::CudaSetStream(instr.fields[0], instr.fields[1], priority);
     }
     case Opcode::CudaAddEvent: {
       // Number of fields = 2
@@ -777,12 +1074,13 @@ void Executable::LoadCodeSection(dmlc::Stream* strm) {
     VMFunctionSerializer loaded_func;
     STREAM_CHECK(loaded_func.Load(strm), "code/function");
 
-    // Load the instructions.
+    // Load the instructions, reusing the buffers of the serialized fields.
     std::vector<Instruction> instructions;
+    instructions.reserve(loaded_func.num_instructions);
+    VMInstructionSerializer instr;
+    std::vector<Index> buffer;
     for (size_t j = 0; j < loaded_func.num_instructions; j++) {
-      VMInstructionSerializer instr;
-      std::vector<Index> instr_fields;
-      STREAM_CHECK(instr.Load(strm), "code/instruction");
+      STREAM_CHECK(instr.Load(strm, &buffer), "code/instruction");
       instructions.push_back(DeserializeInstruction(instr));
     }
 
@@ -846,6 +1144,11 @@ RAF_REGISTER_GLOBAL("raf.vm.Load_Executable")
       return Executable::Load(code, lib);
     });
 
+RAF_REGISTER_GLOBAL("raf.vm.Load_Executable_From_File")
+    .set_body_typed([](std::string path, tvm::runtime::Module lib) {
+      return Executable::LoadFromFile(path, lib);
+    });
+
 }  // namespace vm
 }  // namespace executor
 }  // namespace raf
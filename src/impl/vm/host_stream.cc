@@ -0,0 +1,219 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/impl/vm/host_stream.cc
+ * \brief The implementation of the host streams.
+ */
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <dmlc/logging.h>
+#include <tvm/runtime/container/array.h>
+#include <tvm/runtime/container/string.h>
+#include <tvm/runtime/registry.h>
+#include "./host_stream.h"
+
+namespace raf {
+namespace executor {
+namespace vm {
+
+uint64_t HostEvent::NewRecord() {
+  std::lock_guard<std::mutex> lock(mu_);
+  return ++recorded_;
+}
+
+uint64_t HostEvent::LastRecord() {
+  std::lock_guard<std::mutex> lock(mu_);
+  return recorded_;
+}
+
+void HostEvent::Complete(uint64_t generation) {
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    completed_ = std::max(completed_, generation);
+  }
+  cv_.notify_all();
+}
+
+void HostEvent::Wait(uint64_t generation) {
+  std::unique_lock<std::mutex> lock(mu_);
+  cv_.wait(lock, [this, generation]() { return completed_ >= generation; });
+}
+
+HostStream::HostStream(std::vector<unsigned> cpus) : cpus_(std::move(cpus)) {
+  worker_ = std::thread(&HostStream::Loop, this);
+}
+
+HostStream::~HostStream() {
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    stop_ = true;
+  }
+  push_cv_.notify_all();
+  worker_.join();
+}
+
+void HostStream::Push(std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    tasks_.push_back(std::move(task));
+    num_pending_++;
+  }
+  push_cv_.notify_one();
+}
+
+void HostStream::Record(const std::shared_ptr<HostEvent>& event) {
+  uint64_t generation = event->NewRecord();
+  Push([event, generation]() { event->Complete(generation); });
+}
+
+void HostStream::Wait(const std::shared_ptr<HostEvent>& event) {
+  uint64_t generation = event->LastRecord();
+  if (generation == 0) {
+    return;
+  }
+  Push([event, generation]() { event->Wait(generation); });
+}
+
+void HostStream::Sync() {
+  std::unique_lock<std::mutex> lock(mu_);
+  done_cv_.wait(lock, [this]() { return num_pending_ == 0; });
+  if (!error_.empty()) {
+    std::string error = std::move(error_);
+    error_.clear();
+    LOG(FATAL) << error;
+  }
+}
+
+void HostStream::Loop() {
+  if (!cpus_.empty()) {
+#if defined(__linux__)
+    // The threads created by the worker, e.g., the intra-op threads, inherit its affinity.
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    for (unsigned cpu : cpus_) {
+      CPU_SET(cpu, &cpu_set);
+    }
+    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+#endif
+    // The thread pool of TVM is thread local, so the kernels launched by this worker get one
+    // intra-op thread on each CPU of the stream.
+    if (const auto* config = tvm::runtime::Registry::Get("runtime.config_threadpool")) {
+      tvm::runtime::Array<tvm::runtime::String> cpu_array;
+      for (unsigned cpu : cpus_) {
+        cpu_array.push_back(std::to_string(cpu));
+      }
+      (*config)(-2 /* kSpecifyOneCorePerThread */, static_cast<int>(cpus_.size()), cpu_array);
+    }
+  }
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(mu_);
+      push_cv_.wait(lock, [this]() { return stop_ || !tasks_.empty(); });
+      if (tasks_.empty()) {
+        return;
+      }
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    std::string error;
+    try {
+      task();
+    } catch (const std::exception& e) {
+      error = e.what();
+    }
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      if (!error.empty() && error_.empty()) {
+        error_ = std::move(error);
+      }
+      num_pending_--;
+    }
+    done_cv_.notify_all();
+  }
+}
+
+/*! \brief Parse a CPU list of the sysfs, e.g., "0-3,8-11". */
+std::vector<unsigned> ParseCPUList(const std::string& list) {
+  std::vector<unsigned> cpus;
+  std::stringstream ss(list);
+  std::string range;
+  while (std::getline(ss, range, ',')) {
+    if (range.empty() || !std::isdigit(range[0])) {
+      continue;
+    }
+    size_t dash = range.find('-');
+    unsigned begin = std::stoul(range.substr(0, dash));
+    unsigned end = dash == std::string::npos ? begin : std::stoul(range.substr(dash + 1));
+    for (unsigned cpu = begin; cpu <= end; ++cpu) {
+      cpus.push_back(cpu);
+    }
+  }
+  return cpus;
+}
+
+/*! \brief Get the CPUs of each NUMA node, or all CPUs as a single node if it is unknown. */
+std::vector<std::vector<unsigned>> GetNUMANodeCPUs() {
+  std::vector<std::vector<unsigned>> nodes;
+  for (int node = 0;; ++node) {
+    std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+    if (!file.good()) {
+      break;
+    }
+    std::string list;
+    std::getline(file, list);
+    auto cpus = ParseCPUList(list);
+    if (!cpus.empty()) {
+      nodes.push_back(std::move(cpus));
+    }
+  }
+  if (nodes.empty()) {
+    unsigned num_cpus = std::max(std::thread::hardware_concurrency(), 1U);
+    nodes.emplace_back();
+    for (unsigned cpu = 0; cpu < num_cpus; ++cpu) {
+      nodes.back().push_back(cpu);
+    }
+  }
+  return nodes;
+}
+
+std::vector<std::vector<unsigned>> SplitCPUs(int num_streams) {
+  auto nodes = GetNUMANodeCPUs();
+  std::vector<std::vector<unsigned>> ret(num_streams);
+  // The streams of each node.
+  std::vector<std::vector<int>> node_streams(nodes.size());
+  for (int i = 0; i < num_streams; ++i) {
+    node_streams[i % nodes.size()].push_back(i);
+  }
+  for (size_t n = 0; n < nodes.size(); ++n) {
+    const auto& streams = node_streams[n];
+    if (streams.empty()) {
+      continue;
+    }
+    // The streams share the CPUs when there are more streams than the CPUs of the node.
+    size_t share = std::max<size_t>(nodes[n].size() / streams.size(), 1);
+    for (size_t s = 0; s < streams.size(); ++s) {
+      size_t begin = (s * share) % nodes[n].size();
+      size_t end = std::min(begin + share, nodes[n].size());
+      ret[streams[s]].assign(nodes[n].begin() + begin, nodes[n].begin() + end);
+    }
+  }
+  return ret;
+}
+
+}  // namespace vm
+}  // namespace executor
+}  // namespace raf
@@ -0,0 +1,124 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/impl/vm/host_stream.h
+ * \brief The host streams that run the CPU ops of the scheduled streams in parallel.
+ */
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace raf {
+namespace executor {
+namespace vm {
+
+/*!
+ * \brief An event of the host streams, which follows the semantics of a CUDA event: a wait waits
+ * for the tasks pushed before the latest record of the event at the time of the wait.
+ */
+class HostEvent {
+ public:
+  /*!
+   * \brief Start a new record of the event.
+   * \return The generation of the record.
+   */
+  uint64_t NewRecord();
+  /*!
+   * \brief Get the generation of the latest record.
+   * \return The generation, where 0 means the event is never recorded.
+   */
+  uint64_t LastRecord();
+  /*!
+   * \brief Mark a record as completed.
+   * \param generation The generation of the record.
+   */
+  void Complete(uint64_t generation);
+  /*!
+   * \brief Block the calling thread until a record is completed.
+   * \param generation The generation of the record.
+   */
+  void Wait(uint64_t generation);
+
+ private:
+  uint64_t recorded_ = 0;
+  uint64_t completed_ = 0;
+  std::mutex mu_;
+  std::condition_variable cv_;
+};
+
+/*!
+ * \brief A host stream, which runs its tasks in order on a worker thread. The worker thread and the
+ * intra-op threads of the TVM kernels that it launches are pinned to a set of CPUs, so the streams
+ * do not oversubscribe the cores.
+ */
+class HostStream {
+ public:
+  /*!
+   * \brief Create a host stream and start its worker thread.
+   * \param cpus The CPUs to pin the stream to. Empty means no pinning.
+   */
+  explicit HostStream(std::vector<unsigned> cpus);
+
+  ~HostStream();
+
+  /*!
+   * \brief Push a task to the stream.
+   * \param task The task.
+   */
+  void Push(std::function<void()> task);
+  /*!
+   * \brief Record an event after the tasks pushed so far.
+   * \param event The event.
+   */
+  void Record(const std::shared_ptr<HostEvent>& event);
+  /*!
+   * \brief Make the tasks pushed after this call wait for the latest record of an event.
+   * \param event The event.
+   */
+  void Wait(const std::shared_ptr<HostEvent>& event);
+  /*! \brief Block the calling thread until the pushed tasks are done. It fails if a task failed. */
+  void Sync();
+
+ private:
+  /*! \brief The loop of the worker thread. */
+  void Loop();
+
+  /*! \brief The CPUs to pin the stream to. */
+  std::vector<unsigned> cpus_;
+  /*! \brief The pending tasks. */
+  std::deque<std::function<void()>> tasks_;
+  /*! \brief The number of the pushed tasks that are not done. */
+  size_t num_pending_ = 0;
+  /*! \brief The error message of the first failed task. */
+  std::string error_;
+  /*! \brief Whether the worker thread should stop. */
+  bool stop_ = false;
+  std::mutex mu_;
+  /*! \brief Notified when a task is pushed or the stream is stopped. */
+  std::condition_variable push_cv_;
+  /*! \brief Notified when all pushed tasks are done. */
+  std::condition_variable done_cv_;
+  std::thread worker_;
+};
+
+/*!
+ * \brief Split the CPUs for the host streams. The streams are spread over the NUMA nodes in a
+ * round-robin way, and the CPUs of a node are split evenly among its streams.
+ * \param num_streams The number of the streams.
+ * \return The CPUs of each stream.
+ */
+std::vector<std::vector<unsigned>> SplitCPUs(int num_streams);
+
+}  // namespace vm
+}  // namespace executor
+}  // namespace raf
@@ -24,6 +24,12 @@ namespace vm {
 
 /*! \brief The magic number for the serialized VM bytecode file  */
 constexpr uint64_t kMetaVMBytecodeMagic = 0xD225DE2F4214151D;
+/*! \brief The magic number for the mappable VM executable file */
+constexpr uint64_t kMetaVMMappedMagic = 0xD225DE2F4214151E;
+/*! \brief The version of the mappable VM executable file format */
+constexpr uint64_t kMetaVMMappedVersion = 1;
+/*! \brief The alignment of the tensor blobs in the mappable VM executable file */
+constexpr uint64_t kMetaVMMappedAlignment = 4096;
 
 template <typename T>
 static inline size_t VectorHash(size_t key, const std::vector<T>& values) {
@@ -111,33 +117,40 @@ struct VMInstructionSerializer {
   /*!
    * \brief Load the serialized instruction.
    * \param strm The stream used to load data.
+   * \param buffer The buffer of the serialized form, which is reused across the instructions.
    * \return True if successful. Otherwise, false.
    */
-  bool Load(dmlc::Stream* strm) {
-    std::vector<Index> instr;
-    if (!strm->Read(&instr)) return false;
-    CHECK_GE(instr.size(), 2U);
-    Index loaded_hash = instr[0];
-    opcode = instr[1];
-
-    for (size_t i = 2; i < instr.size(); i++) {
-      fields.push_back(instr[i]);
-    }
+  bool Load(dmlc::Stream* strm, std::vector<Index>* buffer) {
+    if (!strm->Read(buffer)) return false;
+    CHECK_GE(buffer->size(), 2U);
+    Index loaded_hash = (*buffer)[0];
+    opcode = (*buffer)[1];
+    fields.assign(buffer->begin() + 2, buffer->end());
 
     Index hash = Hash();
     CHECK_EQ(loaded_hash, hash) << "Found mismatch in hash for opcode: " << opcode << "\n";
     return true;
   }
 
+  bool Load(dmlc::Stream* strm) {
+    std::vector<Index> buffer;
+    return Load(strm, &buffer);
+  }
+
   /*!
    * \brief Save the instruction into the serialized form.
    * \param strm The stream used to save data.
+   * \param buffer The buffer of the serialized form, which is reused across the instructions.
    */
+  void Save(dmlc::Stream* strm, std::vector<Index>* buffer) const {
+    buffer->assign({Hash(), opcode});
+    buffer->insert(buffer->end(), fields.begin(), fields.end());
+    strm->Write(*buffer);
+  }
+
   void Save(dmlc::Stream* strm) const {
-    Index hash = Hash();
-    std::vector<Index> serialized({hash, opcode});
-    serialized.insert(serialized.end(), fields.begin(), fields.end());
-    strm->Write(serialized);
+    std::vector<Index> buffer;
+    Save(strm, &buffer);
   }
 };
 
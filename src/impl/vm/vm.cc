@@ -12,6 +12,7 @@
 #include <tvm/runtime/memory.h>
 #include <tvm/runtime/object.h>
 #include <tvm/runtime/device_api.h>
+#include <tvm/support/with.h>
 
 #include <algorithm>
 #include <chrono>
@@ -19,6 +20,8 @@
 #include <memory>
 #include <mutex>
 #include <stdexcept>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 #include "raf/communicator.h"
@@ -33,21 +36,34 @@
 #include "raf/vm/vm.h"
 #include "raf/device_api.h"
 #include "raf/profiler.h"
+#include "raf/sampling_profiler.h"
 #include "raf/memory_profiler.h"
 #include "raf/stream_pool.h"
 #include "../../requests.h"
 #include "../../op/ty/utils.h"
 #include "../../common/shape_utils.h"
+#include "./arbiter.h"
+#include "./host_stream.h"
 
 #include "raf/device_api.h"
 #include "raf/registry.h"
 
 #include "../../profiler/cuda/cuda_profiler.h"
+#include "../../profiler/cupti/cupti_profiler.h"
 #ifdef RAF_USE_CUDA
 #include "../../common/cuda_utils.h"
+#include "../../profiler/cuda/comm_profiler.h"
 #include "../../op/dialect/cudnn/cudnn_utils.h"
 #include "../../op/dialect/cublas/cublas_utils.h"
 #endif
+#ifdef RAF_USE_NCCL
+#include <nccl.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+// Labels as values are used by the fast dispatch loop.
+#define RAF_VM_COMPUTED_GOTO
+#endif
 
 namespace raf {
 namespace executor {
@@ -62,6 +78,13 @@ using namespace raf::device_api;
 using namespace raf::stream_pool;
 using namespace raf::distributed::communicator;
 
+/*! \brief The maximum number of streams used by the contexts in the concurrent mode. */
+constexpr int kMaxConcurrentStreams = 16;
+/*! \brief The first stream index used by the contexts in the concurrent mode. */
+constexpr int kConcurrentStreamBase = 1024;
+/*! \brief The index of the compute stream that captures the CUDA graphs. */
+constexpr int kCudaGraphStreamIndex = kConcurrentStreamBase + kMaxConcurrentStreams;
+
 namespace utils {
 inline std::shared_ptr<Event> GetEventById(const VMContext& ctx, Index device_id, Index event_id) {
   if (device_id >= ctx->events.size()) {
@@ -78,8 +101,15 @@ inline std::shared_ptr<Event> GetEventById(const VMContext& ctx, Index device_id
   return ctx->events[device_id][event_id];
 }
 
+/*!
+ * \brief Get the stream of the id, which is created on the first use. A stream of non-zero priority
+ * is a high priority compute stream, so the priority of a stream id is decided by its first use.
+ */
 inline std::shared_ptr<Stream> GetStreamById(const VMContext& ctx, Index device_id,
-                                             Index stream_id) {
+                                             Index stream_id, Index priority = 0) {
+  if (ctx->single_stream) {
+    return ctx->default_stream;
+  }
   if (device_id >= ctx->streams.size()) {
     ctx->streams.resize(device_id + 1);
   }
@@ -88,16 +118,108 @@ inline std::shared_ptr<Stream> GetStreamById(const VMContext& ctx, Index device_
   }
   if (ctx->streams[device_id][stream_id] == nullptr) {
     if (stream_id == 0) {
-      ctx->streams[device_id][stream_id] = std::make_shared<Stream>(nullptr);
+      ctx->streams[device_id][stream_id] = ctx->default_stream != nullptr
+                                               ? ctx->default_stream
+                                               : std::make_shared<Stream>(nullptr);
     } else {
       Device device(DevType::kCUDA(), static_cast<int>(device_id));
-      ctx->streams[device_id][stream_id] =
-          Stream::Get(device, kCudaCompute, static_cast<int>(stream_id));
+      int tag = priority != 0 || ctx->high_priority ? kCudaComputeHighPriority : kCudaCompute;
+      ctx->streams[device_id][stream_id] = Stream::Get(device, tag, static_cast<int>(stream_id));
     }
   }
   return ctx->streams[device_id][stream_id];
 }
 
+/*! \brief Get the host data of the tensor inputs, which identify the prefetched inputs. */
+inline std::vector<const void*> GetPrefetchKeys(const std::vector<Value>& inputs) {
+  std::vector<const void*> keys;
+  for (const auto& input : inputs) {
+    const auto* tensor = input.as<TensorValueObj>();
+    keys.push_back(tensor != nullptr ? tensor->tensor->data : nullptr);
+  }
+  return keys;
+}
+
+/*!
+ * \brief Collect the memories of the tensors in the value, which keep the buffers alive for an op
+ * on a host stream after the registers are freed.
+ */
+inline void CollectMemories(const Value& value, std::vector<std::shared_ptr<Memory>>* memories) {
+  if (const auto* tensor = value.as<TensorValueObj>()) {
+    if (tensor->mem != nullptr) {
+      memories->push_back(tensor->mem);
+    }
+  } else if (const auto* tuple = value.as<TupleValueObj>()) {
+    for (const auto& field : tuple->fields) {
+      CollectMemories(field, memories);
+    }
+  }
+}
+
+/*! \brief Get the CUDA device of the first tensor in the value, or -1 if there is none. */
+inline int GetCUDADeviceId(const Value& value) {
+  if (const auto* tensor = value.as<TensorValueObj>()) {
+    const DLTensor* t = tensor->tensor.operator->();
+    return t->device.device_type == kDLCUDA ? t->device.device_id : -1;
+  }
+  if (const auto* tuple = value.as<TupleValueObj>()) {
+    for (const auto& field : tuple->fields) {
+      int device_id = GetCUDADeviceId(field);
+      if (device_id >= 0) {
+        return device_id;
+      }
+    }
+  }
+  return -1;
+}
+
+#ifdef RAF_USE_CUDA
+/*! \brief Switch the current CUDA device of the thread, which is a no-op on the same device. */
+inline void SetCUDADevice(int device_id) {
+  int current = 0;
+  CUDA_CALL(cudaGetDevice(&current));
+  if (current != device_id) {
+    CUDA_CALL(cudaSetDevice(device_id));
+  }
+}
+
+/*!
+ * \brief Copy a tensor to another GPU on the peer copy stream of the destination. The copy waits
+ * for the default stream of the source, and the default streams of both GPUs wait for the copy, so
+ * the consumers see the data and the source buffer is not reused before the copy is done.
+ */
+inline void CopyPeer(const Value& from, const Value& to) {
+  const DLTensor* src = from;
+  DLTensor* dst = to;
+  size_t nbytes = tvm::runtime::GetDataSize(*src);
+  CHECK_EQ(nbytes, tvm::runtime::GetDataSize(*dst));
+  CHECK(tvm::runtime::IsContiguous(*src) && tvm::runtime::IsContiguous(*dst))
+      << "The copies between GPUs expect compact tensors";
+  Device src_dev(DevType::kCUDA(), src->device.device_id);
+  Device dst_dev(DevType::kCUDA(), dst->device.device_id);
+  // The copies to the GPUs of higher and lower ids are on different streams, so the copies of both
+  // directions overlap.
+  int tag = src_dev.device_id() < dst_dev.device_id() ? kMemCpyCudaToCuda1 : kMemCpyCudaToCuda2;
+  auto stream = static_cast<cudaStream_t>(Stream::Get(dst_dev, tag, src_dev.device_id())->data());
+
+  SetCUDADevice(src_dev.device_id());
+  auto produced = EventPool::Get(src_dev)->GetEvent(0x02 /*cudaEventDisableTiming*/);
+  CUDA_CALL(cudaEventRecord(static_cast<cudaEvent_t>(produced->data()), nullptr));
+  SetCUDADevice(dst_dev.device_id());
+  auto copied = EventPool::Get(dst_dev)->GetEvent(0x02 /*cudaEventDisableTiming*/);
+  CUDA_CALL(cudaStreamWaitEvent(stream, static_cast<cudaEvent_t>(produced->data()), 0));
+  CUDA_CALL(cudaMemcpyPeerAsync(static_cast<char*>(dst->data) + dst->byte_offset,
+                                dst_dev.device_id(),
+                                static_cast<const char*>(src->data) + src->byte_offset,
+                                src_dev.device_id(), nbytes, stream));
+  CUDA_CALL(cudaEventRecord(static_cast<cudaEvent_t>(copied->data()), stream));
+  CUDA_CALL(cudaStreamWaitEvent(nullptr, static_cast<cudaEvent_t>(copied->data()), 0));
+  SetCUDADevice(src_dev.device_id());
+  CUDA_CALL(cudaStreamWaitEvent(nullptr, static_cast<cudaEvent_t>(copied->data()), 0));
+  SetCUDADevice(dst_dev.device_id());
+}
+#endif
+
 const char* GetStreamName(Index stream_id) {
   static std::vector<std::string> names = {"Default Stream"};
   while (stream_id >= names.size()) {
@@ -142,6 +264,28 @@ void TensorRepr(std::ostringstream& os, const TensorValueObj* tensor) {
 }  // namespace utils
 
 RAF_REGISTER_OBJECT_REFLECT(VMContextObj);
+RAF_REGISTER_OBJECT_REFLECT(VMFutureObj);
+
+void VMStats::Merge(const VMStats& other) {
+  for (size_t i = 0; i < kNumOpcodes; ++i) {
+    num_instructions[i] += other.num_instructions[i];
+  }
+  num_runs += other.num_runs;
+  op_env_cache_hits += other.op_env_cache_hits;
+  op_env_cache_misses += other.op_env_cache_misses;
+  num_allocs += other.num_allocs;
+  alloc_bytes += other.alloc_bytes;
+  num_workspace_allocs += other.num_workspace_allocs;
+  workspace_bytes += other.workspace_bytes;
+  num_event_waits += other.num_event_waits;
+  num_stream_barriers += other.num_stream_barriers;
+  num_cuda_graph_captures += other.num_cuda_graph_captures;
+  num_cuda_graph_replays += other.num_cuda_graph_replays;
+  num_fallback_op_envs += other.num_fallback_op_envs;
+  num_background_jits += other.num_background_jits;
+  num_priority_yields += other.num_priority_yields;
+  priority_yield_us += other.priority_yield_us;
+}
 
 VMContext VMContext::make(const Executable* exec) {
   auto ptr = make_object<VMContextObj>();
@@ -149,6 +293,118 @@ VMContext VMContext::make(const Executable* exec) {
   return VMContext(ptr);
 }
 
+VMFuture VMFuture::make(VMContext ctx) {
+  auto ptr = make_object<VMFutureObj>();
+  ptr->ctx = std::move(ctx);
+  ptr->state = std::make_shared<VMFutureState>();
+  return VMFuture(ptr);
+}
+
+bool VMFuture::IsReady() const {
+  auto& state = (*this)->state;
+  std::lock_guard<std::mutex> lock(state->mu);
+  return state->done;
+}
+
+Value VMFuture::Get() const {
+  auto& state = (*this)->state;
+  std::unique_lock<std::mutex> lock(state->mu);
+  state->cv.wait(lock, [&state]() { return state->done; });
+  CHECK(state->error.empty()) << state->error;
+  return (*this)->result;
+}
+
+void VMFuture::Complete(void* data) {
+  // Only the completion state is released here, as the callback must not free device memory.
+  std::unique_ptr<std::shared_ptr<VMFutureState>> state(
+      static_cast<std::shared_ptr<VMFutureState>*>(data));
+  {
+    std::lock_guard<std::mutex> lock((*state)->mu);
+    (*state)->done = true;
+  }
+  (*state)->cv.notify_all();
+}
+
+#ifdef RAF_USE_CUDA
+/*!
+ * \brief Issue the copies of the tensors in the value on the GPUs to the pinned host memory.
+ * \param value The value to copy.
+ * \param streams The copy stream of each GPU used so far, which is indexed by the device id.
+ * \return The copied value.
+ */
+Value IssueCopyToHost(const Value& value, std::vector<void*>* streams) {
+  if (const auto* tuple = value.as<TupleValueObj>()) {
+    Array<Value> fields;
+    for (const auto& field : tuple->fields) {
+      fields.push_back(IssueCopyToHost(field, streams));
+    }
+    return TupleValue::make(fields);
+  }
+  const auto* tensor = value.as<TensorValueObj>();
+  if (tensor == nullptr || tensor->tensor->device.device_type != kDLCUDA) {
+    return value;
+  }
+  const DLTensor* from = tensor->tensor.operator->();
+  Device dev(DevType::kCUDA(), from->device.device_id);
+  auto api = DeviceAPI::Get(DevType::kCUDA());
+  api->SetDevice(dev.device_id());
+  if (streams->size() <= dev.device_id()) {
+    streams->resize(dev.device_id() + 1, nullptr);
+  }
+  void* stream = Stream::Get(dev, kMemCpyCudaToCpu, 0)->data();
+  if ((*streams)[dev.device_id()] == nullptr) {
+    // The tensors are computed on the default stream.
+    auto computed = EventPool::Get(dev)->GetEvent(0x02 /*cudaEventDisableTiming*/);
+    api->EventRecordOnStream(computed->data(), nullptr);
+    api->StreamWaitEvent(stream, computed->data());
+    (*streams)[dev.device_id()] = stream;
+  }
+  Device host(DevType::kCUDAHost(), 0);
+  std::vector<int64_t> shape(from->shape, from->shape + from->ndim);
+  auto mem = memory_pool::Memory::Alloc(host, tvm::runtime::GetDataSize(*from));
+  TensorValue to = TensorValue::Assemble(host, from->dtype, shape, {}, mem->data, mem);
+  api->CopyDataFromTo(const_cast<DLTensor*>(from), to, stream);
+  return to;
+}
+#endif
+
+VMFuture CopyToHostAsync(const Value& value) {
+  VMFuture future = VMFuture::make(VMContext());
+  auto* state = new std::shared_ptr<VMFutureState>(future->state);
+#ifdef RAF_USE_CUDA
+  std::vector<void*> streams;
+  future->result = IssueCopyToHost(value, &streams);
+  auto api = DeviceAPI::Get(DevType::kCUDA());
+  std::shared_ptr<Event> last;
+  void* last_stream = nullptr;
+  for (size_t i = 0; i < streams.size(); ++i) {
+    if (streams[i] == nullptr) {
+      continue;
+    }
+    Device dev(DevType::kCUDA(), static_cast<int>(i));
+    api->SetDevice(dev.device_id());
+    if (last != nullptr) {
+      // The future is completed on the last copy stream, after the copies of the other GPUs.
+      api->StreamWaitEvent(streams[i], last->data());
+    }
+    // The default stream waits for the copies, so the source buffers are not reused by the
+    // following kernels before they are copied. The copies are small, so the wait is short.
+    last = EventPool::Get(dev)->GetEvent(0x02 /*cudaEventDisableTiming*/);
+    api->EventRecordOnStream(last->data(), streams[i]);
+    api->StreamWaitEvent(nullptr, last->data());
+    last_stream = streams[i];
+  }
+  if (last_stream != nullptr) {
+    api->LaunchHostFunc(last_stream, VMFuture::Complete, state);
+    return future;
+  }
+#else
+  future->result = value;
+#endif
+  VMFuture::Complete(state);
+  return future;
+}
+
 inline Value VMContext::ReadRegister(Index reg) const {
   auto self = this->operator->();
   return self->frames.back().register_file[reg];
@@ -209,8 +465,22 @@ inline void VMContext::PushFrame(Index func_index, const std::vector<Value>& arg
   CHECK_EQ(func.params.size(), args.size())
       << "Number of arguments mismatches: " << func.params.size() << " vs " << args.size();
   auto ret_pc = self->pc + 1;
-  auto frame = VMFrame(self->func_index, ret_pc, ret_reg, args.size(), func.register_file_size);
-  self->frames.push_back(frame);
+  auto& pooled_frames = self->pool.frames;
+  if (pooled_frames.empty()) {
+    self->frames.emplace_back(self->func_index, ret_pc, ret_reg, args.size(),
+                              func.register_file_size);
+  } else {
+    // Reuse the register file of a popped frame, whose registers have been released.
+    VMFrame frame = std::move(pooled_frames.back());
+    pooled_frames.pop_back();
+    frame.caller_func_index = self->func_index;
+    frame.caller_return_pc = ret_pc;
+    frame.caller_return_register = ret_reg;
+    frame.num_args = args.size();
+    frame.register_file.resize(func.register_file_size);
+    frame.is_const.assign(func.register_file_size, false);
+    self->frames.push_back(std::move(frame));
+  }
   for (size_t i = 0; i < args.size(); ++i) {
     WriteRegister(i, args[i]);
   }
@@ -222,41 +492,92 @@ inline void VMContext::PushFrame(Index func_index, const std::vector<Value>& arg
 inline Index VMContext::PopFrame() {
   auto self = this->operator->();
   CHECK_GT(self->frames.size(), 0);
-  const VMFrame& fr = self->frames.back();
+  VMFrame& fr = self->frames.back();
   self->func_index = fr.caller_func_index;
   self->pc = fr.caller_return_pc;
   self->code = self->exec->functions[self->func_index].instructions.data();
+  Index caller_return_register = fr.caller_return_register;
+  // Release the registers, and keep the register file for the following calls.
+  std::fill(fr.register_file.begin(), fr.register_file.end(), Value());
+  self->pool.frames.push_back(std::move(fr));
   self->frames.pop_back();
-  return fr.caller_return_register;
+  return caller_return_register;
+}
+
+const OpEnvPtr* OpEnvCache::Get(const std::vector<uint8_t>& key) {
+  const OpEnvPtr* first = first_op_env_.load(std::memory_order_acquire);
+  if (first != nullptr) {
+    if (first_key_ == key) {
+      return first;
+    }
+    if (auto p = cache_.Get(key)) {
+      return (*p)->load(std::memory_order_acquire);
+    }
+  }
+  return nullptr;
 }
 
-std::shared_ptr<OpEnvCache> VMFuncOpEnvCache::Get(Index pc) {
+OpEnvPtr OpEnvCache::Set(const std::vector<uint8_t>& key, OpEnvPtr op_env) {
   std::lock_guard<std::mutex> lock(mu_);
-  auto it = cache_map_.find(pc);
-  if (it != cache_map_.end()) {
-    return it->second;
+  const OpEnvPtr* first = first_op_env_.load(std::memory_order_relaxed);
+  if (first == nullptr) {
+    first_key_ = key;
+    first_op_env_.store(Keep(op_env), std::memory_order_release);
+    return op_env;
+  }
+  if (first_key_ == key) {
+    return *first;
   }
-  auto cache = std::make_shared<OpEnvCache>();
-  cache_map_.emplace(pc, cache);
-  return cache;
+  if (auto p = cache_.Get(key)) {
+    return *(*p)->load(std::memory_order_relaxed);
+  }
+  cache_.Set(key, std::make_shared<std::atomic<const OpEnvPtr*>>(Keep(op_env)));
+  return op_env;
 }
 
-void VMFuncOpEnvCache::Clear() {
+void OpEnvCache::Replace(const std::vector<uint8_t>& key, OpEnvPtr op_env) {
   std::lock_guard<std::mutex> lock(mu_);
-  cache_map_.clear();
+  const OpEnvPtr* first = first_op_env_.load(std::memory_order_relaxed);
+  CHECK(first != nullptr) << "The OpEnv to replace is not cached";
+  if (first_key_ == key) {
+    first_op_env_.store(Keep(op_env), std::memory_order_release);
+    return;
+  }
+  auto p = cache_.Get(key);
+  CHECK(p != nullptr) << "The OpEnv to replace is not cached";
+  (*p)->store(Keep(op_env), std::memory_order_release);
+}
+
+const OpEnvPtr* OpEnvCache::Keep(OpEnvPtr op_env) {
+  op_envs_.push_back(std::move(op_env));
+  return &op_envs_.back();
+}
+
+VMFuncOpEnvCache::VMFuncOpEnvCache(size_t num_instructions) {
+  cache_list_.reserve(num_instructions);
+  for (size_t i = 0; i < num_instructions; ++i) {
+    cache_list_.emplace_back(std::make_unique<OpEnvCache>());
+  }
+}
+
+void VMFuncOpEnvCache::Clear() {
+  for (auto& cache : cache_list_) {
+    cache = std::make_unique<OpEnvCache>();
+  }
 }
 
 #ifdef RAF_USE_CUDA
 class VirtualMachine::CudaGraphImpl {
  public:
-  CudaGraphImpl(Device dev) : device_(dev) {
+  CudaGraphImpl(Device dev, std::shared_ptr<Stream> stream)
+      : device_(dev), stream_(std::move(stream)) {
     DLOG(INFO) << "Use Cuda Graph";
+    stream_for_graph_ = static_cast<cudaStream_t>(stream_->data());
   }
 
   ~CudaGraphImpl() {
     CUDA_CALL(cudaGraphDestroy(graph_));
     CUDA_CALL(cudaGraphExecDestroy(exec_));
-    CUDA_CALL(cudaStreamDestroy(stream_for_graph_));
   }
 
   void GetKernelInfo() {
@@ -269,9 +590,6 @@ class VirtualMachine::CudaGraphImpl {
   }
 
   void BeginCapture() {
-    stream_for_graph_ = static_cast<cudaStream_t>(
-        raf::device_api::DeviceAPI::Get(device_.device_type())->CreateStream(device_));
-
     OpEnv::SetStreamForAllBackends(device_, stream_for_graph_);
     CUDA_CALL(cudaStreamBeginCapture(stream_for_graph_, cudaStreamCaptureModeRelaxed));
   }
@@ -284,13 +602,26 @@ class VirtualMachine::CudaGraphImpl {
   }
 
   void Invoke() {
-    CUDA_CALL(cudaGraphLaunch(exec_, NULL));
+    CUDA_CALL(cudaGraphLaunch(exec_, stream_for_graph_));
     CUDA_CALL(cudaStreamSynchronize(stream_for_graph_));
   }
 
+  /*!
+   * \brief Keep the memory allocated during capture alive with the graph. The graph replays the
+   * kernels with the captured addresses, so the memory freed during capture, e.g., the
+   * intermediates of the backward pass, must not be handed out to anything else.
+   */
+  void KeepAlive(std::shared_ptr<Memory> memory) {
+    arena_.push_back(std::move(memory));
+  }
+
  private:
   bool is_captured_ = false;
+  /*! \brief The stream that captures and replays the graph. */
+  std::shared_ptr<Stream> stream_;
   cudaStream_t stream_for_graph_;
+  /*! \brief The memory allocated during capture, which the graph owns. */
+  std::vector<std::shared_ptr<Memory>> arena_;
   cudaGraph_t graph_;
   cudaGraphExec_t exec_;
   Device device_;
@@ -304,6 +635,11 @@ PackedFunc VirtualMachine::GetFunction(const std::string& name,
       VMContext ctx = args[0];
       *rv = Run(ctx);
     });
+  } else if (name == "run_async") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      VMContext ctx = args[0];
+      *rv = RunAsync(ctx);
+    });
   } else if (name == "profile") {
     return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
       VMContext ctx = args[0];
@@ -321,6 +657,68 @@ PackedFunc VirtualMachine::GetFunction(const std::string& name,
       }
       this->SetDevices(devices);
     });
+  } else if (name == "set_memory_tenant") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      std::string tenant = args[0];
+      this->SetMemoryTenant(tenant);
+    });
+  } else if (name == "prewarm") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      CHECK(exec_) << "The executable is not loaded yet.";
+      std::string func_name = args[0];
+      int num_threads = args[1];
+      std::vector<Value> inputs(args.size() - 2);
+      for (size_t i = 2; i < args.size(); ++i) {
+        inputs[i - 2] = args[i];
+      }
+      this->Prewarm(func_name, inputs, num_threads);
+    });
+  } else if (name == "get_stats") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      *rv = this->GetStats();
+    });
+  } else if (name == "reset_stats") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      this->ResetStats();
+    });
+  } else if (name == "set_concurrent") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      bool concurrent = args[0];
+      this->SetConcurrent(concurrent);
+    });
+  } else if (name == "set_priority") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      int priority = args[0];
+      this->SetPriority(priority);
+    });
+  } else if (name == "set_background_jit") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      int num_threads = args[0];
+      this->SetBackgroundJit(num_threads);
+    });
+  } else if (name == "sync_background_jit") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      this->SyncBackgroundJit();
+    });
+  } else if (name == "prefetch") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      std::vector<Value> inputs(args.size());
+      for (size_t i = 0; i < args.size(); ++i) {
+        inputs[i] = args[i];
+      }
+      this->Prefetch(inputs);
+    });
+  } else if (name == "bind_params") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      std::string func_name = args[0];
+      Map<String, Value> params = args[1];
+      this->BindParams(func_name, params);
+    });
+  } else if (name == "evict_function") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      CHECK(exec_) << "The executable is not loaded yet.";
+      this->EvictFunction(args[0]);
+    });
   } else if (name == "prepare_context") {
     return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
       CHECK(exec_) << "The executable is not loaded yet.";
@@ -340,8 +738,29 @@ PackedFunc VirtualMachine::GetFunction(const std::string& name,
 void VirtualMachine::LoadExecutable(const Executable* exec) {
   CHECK(exec) << "The executable is not created yet.";
   exec_ = exec;
-  for (int i = 0; i < exec_->functions.size(); ++i) {
-    op_env_cache_.push_back(std::make_shared<VMFuncOpEnvCache>());
+  {
+    // The pooled objects are indexed by the instructions of the previous executable.
+    std::lock_guard<std::mutex> lock(spare_pools_mu_);
+    spare_pools_.clear();
+  }
+  // The OpEnv caches and the device constants of a function are materialized when it is first
+  // prepared, so the functions that are never run do not take the memory.
+  size_t num_funcs = exec_->functions.size();
+  op_env_cache_.assign(num_funcs, nullptr);
+  const_pool_.assign(exec_->constants.size(), Value());
+  func_callees_.assign(num_funcs, {});
+  func_constants_.assign(num_funcs, {});
+  loaded_entries_.clear();
+  for (size_t i = 0; i < num_funcs; ++i) {
+    for (const auto& instr : exec_->functions[i].instructions) {
+      if (instr.op == Opcode::InvokeFunc) {
+        func_callees_[i].push_back(instr.invoke_func.func_index);
+      } else if (instr.op == Opcode::AllocClosure) {
+        func_callees_[i].push_back(instr.alloc_closure.func_index);
+      } else if (instr.op == Opcode::LoadConst) {
+        func_constants_[i].push_back(instr.const_index);
+      }
+    }
   }
 
   tvm::runtime::Module lib = exec_->lib;
@@ -359,26 +778,269 @@ void VirtualMachine::LoadExecutable(const Executable* exec) {
     CHECK(pf != nullptr) << "Cannot find function in module: " << packed_name;
     packed_funcs_[packed_index] = pf;
   }
+
+  // Find the events used on each device, where the device is the one of the last CudaSetStream
+  // in the code order. An event missed by the scan is still created lazily at its first use.
+  num_events_.clear();
+  barrier_device_id_ = -1;
+  num_streams_ = 0;
+  for (const auto& func : exec_->functions) {
+    Index device_id = 0;
+    for (const auto& instr : func.instructions) {
+      if (instr.op == Opcode::CudaSetStream) {
+        device_id = instr.cuda_set_stream.device_id;
+        num_streams_ = std::max(num_streams_, instr.cuda_set_stream.stream_id + 1);
+      } else if (instr.op == Opcode::CudaAddEvent || instr.op == Opcode::CudaWaitEvent) {
+        if (device_id >= num_events_.size()) {
+          num_events_.resize(device_id + 1, 0);
+        }
+        num_events_[device_id] = std::max(num_events_[device_id], instr.cuda_event.event_id + 1);
+      } else if (instr.op == Opcode::CudaStreamBarrier && barrier_device_id_ == -1) {
+        barrier_device_id_ = device_id;
+      }
+    }
+  }
+
+#ifdef RAF_USE_NCCL
+  // Create the communicators of the collectives together, instead of at their first dispatch in
+  // the first iteration, where each creation blocks the ranks in turn. The index of each op is the
+  // one of its rank_list argument.
+  static const std::unordered_map<std::string, Index> rank_list_index = {
+      {"raf.op._allreduce", 2}, {"raf.op._allgather", 2}};
+  std::vector<Value> rank_lists;
+  for (const auto& func : exec_->functions) {
+    std::unordered_map<RegName, Index> const_regs;
+    for (const auto& instr : func.instructions) {
+      if (instr.op == Opcode::LoadConst) {
+        const_regs[instr.dst] = instr.const_index;
+        continue;
+      }
+      if (instr.op != Opcode::InvokeJit || !const_regs.count(instr.invoke_jit.op_reg)) {
+        continue;
+      }
+      auto op_value = exec_->constants[const_regs[instr.invoke_jit.op_reg]].as<OpValueObj>();
+      if (op_value == nullptr) {
+        continue;
+      }
+      auto op = IsDialectOp(op_value->op) ? GetBaseOp(op_value->op) : op_value->op;
+      auto it = rank_list_index.find(op->name);
+      if (it == rank_list_index.end() ||
+          it->second >= instr.invoke_jit.arity - instr.invoke_jit.output_size ||
+          !const_regs.count(instr.invoke_jit.args[it->second])) {
+        continue;
+      }
+      rank_lists.push_back(exec_->constants[const_regs[instr.invoke_jit.args[it->second]]]);
+    }
+  }
+  if (!rank_lists.empty()) {
+    CommunicatorPool::Get()->GetCommunicators("nccl", rank_lists);
+  }
+#endif
+}
+
+void VirtualMachine::Prefetch(const std::vector<Value>& inputs) {
+#ifdef RAF_USE_CUDA
+  if (!use_cuda_) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(prefetch_mu_);
+  auto api = DeviceAPI::Get(DevType::kCUDA());
+  // The copies of the taken prefetches were issued before this one, so they are done by now.
+  for (const auto& retired : retired_prefetches_) {
+    api->WaitEvent(retired.ready->data());
+  }
+  retired_prefetches_.clear();
+
+  Device dev = devices_[0];
+  Device host(DevType::kCUDAHost(), 0);
+  auto stream = Stream::Get(dev, kMemCpyCpuToCuda, 0);
+  PrefetchedInputs prefetched;
+  prefetched.keys = utils::GetPrefetchKeys(inputs);
+  for (const auto& input : inputs) {
+    const auto* tensor = input.as<TensorValueObj>();
+    if (tensor == nullptr || tensor->tensor->device.device_type != kDLCPU ||
+        !tvm::runtime::IsContiguous(*tensor->tensor.operator->())) {
+      prefetched.inputs.push_back(CopyTo(input, dev));
+      continue;
+    }
+    // Copying from the pageable memory is synchronous, so the tensor is staged in the pinned
+    // memory first, and then copied to the device asynchronously.
+    const DLTensor* from = tensor->tensor.operator->();
+    int64_t nbytes = tvm::runtime::GetDataSize(*from);
+    auto staging = memory_pool::Memory::Alloc(host, nbytes);
+    std::memcpy(staging->data, static_cast<const char*>(from->data) + from->byte_offset, nbytes);
+    DLTensor staged = *from;
+    staged.data = staging->data;
+    staged.byte_offset = 0;
+    staged.device = host;
+    std::vector<int64_t> shape(from->shape, from->shape + from->ndim);
+    TensorValue to = TensorValue::Assemble(dev, from->dtype, shape);
+    api->CopyDataFromTo(&staged, to, stream->data());
+    prefetched.inputs.push_back(to);
+    prefetched.staging.push_back(staging);
+  }
+  prefetched.ready = EventPool::Get(dev)->GetEvent(0x02 /*cudaEventDisableTiming*/);
+  api->EventRecordOnStream(prefetched.ready->data(), stream->data());
+  prefetched_.push_back(std::move(prefetched));
+#endif
+}
+
+#ifdef RAF_USE_CUDA
+std::shared_ptr<Event> VirtualMachine::TakePrefetched(const std::vector<Value>& inputs,
+                                                      std::vector<Value>* device_inputs) {
+  std::lock_guard<std::mutex> lock(prefetch_mu_);
+  if (prefetched_.empty()) {
+    return nullptr;
+  }
+  auto keys = utils::GetPrefetchKeys(inputs);
+  auto it = std::find_if(prefetched_.begin(), prefetched_.end(),
+                         [&](const PrefetchedInputs& p) { return p.keys == keys; });
+  if (it == prefetched_.end()) {
+    return nullptr;
+  }
+  // The prefetches before the taken one are skipped by the caller, so they are discarded.
+  for (auto iter = prefetched_.begin(); iter != it; ++iter) {
+    retired_prefetches_.push_back(std::move(*iter));
+  }
+  *device_inputs = std::move(it->inputs);
+  auto ready = it->ready;
+  retired_prefetches_.push_back(std::move(*it));
+  prefetched_.erase(prefetched_.begin(), it + 1);
+  DeviceAPI::Get(DevType::kCUDA())->StreamWaitEvent(nullptr, ready->data());
+  return ready;
+}
+#endif
+
+std::vector<bool> VirtualMachine::GetReachableFunctions(
+    const std::unordered_set<Index>& entries) const {
+  std::vector<bool> reachable(exec_->functions.size(), false);
+  std::vector<Index> stack(entries.begin(), entries.end());
+  while (!stack.empty()) {
+    Index func_index = stack.back();
+    stack.pop_back();
+    if (reachable[func_index]) {
+      continue;
+    }
+    reachable[func_index] = true;
+    for (Index callee : func_callees_[func_index]) {
+      stack.push_back(callee);
+    }
+  }
+  return reachable;
+}
+
+void VirtualMachine::LoadFunction(Index func_index) {
+  std::lock_guard<std::mutex> lock(load_mu_);
+  if (!loaded_entries_.insert(func_index).second) {
+    return;
+  }
+  auto reachable = GetReachableFunctions({func_index});
+  for (size_t i = 0; i < reachable.size(); ++i) {
+    if (reachable[i] && op_env_cache_[i] == nullptr) {
+      op_env_cache_[i] =
+          std::make_shared<VMFuncOpEnvCache>(exec_->functions[i].instructions.size());
+    }
+  }
+}
+
+void VirtualMachine::EvictFunction(const std::string& func_name) {
+  auto gvit = exec_->global_map.find(func_name);
+  CHECK(gvit != exec_->global_map.end()) << "Cannot find function " << func_name;
+  std::lock_guard<std::mutex> lock(load_mu_);
+  if (loaded_entries_.erase(gvit->second) == 0) {
+    return;
+  }
+  // Only release what the remaining entry functions do not reach.
+  auto reachable = GetReachableFunctions(loaded_entries_);
+  std::vector<bool> used_constants(const_pool_.size(), false);
+  for (size_t i = 0; i < reachable.size(); ++i) {
+    if (reachable[i]) {
+      for (Index const_index : func_constants_[i]) {
+        used_constants[const_index] = true;
+      }
+    }
+  }
+  for (size_t i = 0; i < reachable.size(); ++i) {
+    if (reachable[i] || op_env_cache_[i] == nullptr) {
+      continue;
+    }
+    op_env_cache_[i] = nullptr;
+    for (Index const_index : func_constants_[i]) {
+      if (!used_constants[const_index]) {
+        const_pool_[const_index] = Value();
+      }
+    }
+  }
+  {
+    // The pooled tuples and closures may hold the values of the evicted functions.
+    std::lock_guard<std::mutex> pool_lock(spare_pools_mu_);
+    spare_pools_.clear();
+  }
 }
 
 VMContext VirtualMachine::PrepareVMContext(const std::string& func_name,
-                                           const std::vector<Value>& inputs) {
+                                           const std::vector<Value>& host_inputs) {
   auto gvit = exec_->global_map.find(func_name);
   CHECK(gvit != exec_->global_map.end()) << "Cannot find function " << func_name;
   auto func_index = gvit->second;
+  LoadFunction(func_index);
   const auto& vm_func = exec_->functions[func_index];
-  CHECK_EQ(inputs.size(), vm_func.params.size())
+  auto bound_it = bound_params_.find(func_index);
+  const BoundParams* bound = bound_it != bound_params_.end() ? &bound_it->second : nullptr;
+  CHECK_EQ(host_inputs.size(), bound ? bound->num_unbound : vm_func.params.size())
       << "The number of inputs doesn't match the number of parameters for function " << func_name;
+  const std::vector<Value>* input_ptr = &host_inputs;
+#ifdef RAF_USE_CUDA
+  std::vector<Value> prefetched_inputs;
+  auto prefetched = TakePrefetched(host_inputs, &prefetched_inputs);
+  if (prefetched != nullptr) {
+    input_ptr = &prefetched_inputs;
+  }
+#endif
+  // The unbound parameters take the inputs in order, and the bound ones are already on the device.
+  std::vector<Value> bound_inputs;
+  if (bound != nullptr) {
+    bound_inputs = bound->values;
+    auto input_it = input_ptr->begin();
+    for (auto& value : bound_inputs) {
+      if (!value.defined()) {
+        value = *input_it++;
+      }
+    }
+    input_ptr = &bound_inputs;
+  }
+  const std::vector<Value>& inputs = *input_ptr;
 
   auto fcreate_ctx = [&]() {
     auto ctx = VMContext::make(exec_);
     ctx->entry_func_index = func_index;
+    {
+      std::lock_guard<std::mutex> lock(spare_pools_mu_);
+      if (!spare_pools_.empty()) {
+        ctx->pool = std::move(spare_pools_.back());
+        spare_pools_.pop_back();
+      }
+    }
     ctx->inputs.resize(inputs.size());
     // TODO(@zhiics, @icemelon9): For heterogeneous execution, get input device information
     Device dev = devices_[0];
     for (size_t i = 0; i < inputs.size(); ++i) {
       ctx->inputs[i] = CopyTo(inputs[i], dev);
     }
+    if (use_cuda_) {
+      // Preallocate the events, so the event instructions take neither locks nor allocations.
+      ctx->events.resize(num_events_.size());
+      for (size_t i = 0; i < num_events_.size(); ++i) {
+        Device device(DevType::kCUDA(), static_cast<int>(i));
+        ctx->events[i] =
+            EventPool::Get(device)->GetEvents(num_events_[i], 0x02 /*cudaEventDisableTiming*/);
+      }
+      if (barrier_device_id_ >= 0) {
+        Device device(DevType::kCUDA(), static_cast<int>(barrier_device_id_));
+        ctx->barrier_events =
+            EventPool::Get(device)->GetEvents(1, 0x02 /*cudaEventDisableTiming*/);
+      }
+    }
     return ctx;
   };
 #ifdef RAF_USE_CUDA
@@ -386,50 +1048,152 @@ VMContext VirtualMachine::PrepareVMContext(const std::string& func_name,
     std::lock_guard<std::mutex> lock(cuda_graph_mutex_);
     // Check if there is another context using the CUDA graph
     CHECK(!cuda_graph_occupied_) << "VM in CUDA graph mode doesn't support concurrent execution";
-    if (!cuda_graph_ctx_.defined() || cuda_graph_ctx_->entry_func_index != func_index) {
-      // Initialize the cuda graph context for the first time, or reset the cuda graph context
-      // because this time invokes a different function
-      cuda_graph_impl_ = nullptr;
-      cuda_graph_ctx_ = fcreate_ctx();
+    // A captured graph can only be replayed with the same function and input shapes.
+    HashKey key;
+    key << static_cast<int64_t>(func_index);
+    for (const auto& input : inputs) {
+      const auto* tensor = input.as<TensorValueObj>();
+      CHECK(tensor) << "Unsupported Value Type for reusing CUDA Graph";
+      key << *tensor->tensor.operator->();
+    }
+    std::string key_str(key.byte_vector.begin(), key.byte_vector.end());
+    auto it = cuda_graph_map_.find(key_str);
+    if (it == cuda_graph_map_.end()) {
+      // Create a context for the new shapes. The graph is captured at the first run.
+      if (cuda_graph_lru_.size() >= cuda_graph_cache_size_) {
+        DLOG(INFO) << "Evict the least recently used CUDA graph.";
+        cuda_graph_map_.erase(cuda_graph_lru_.back().first);
+        cuda_graph_lru_.pop_back();
+      }
+      auto graph_ctx = fcreate_ctx();
+      // Every stream is mapped to the capturing stream, so the multi-stream schedule and the
+      // collective communication are captured in order.
+      graph_ctx->default_stream = Stream::Get(devices_[0], kCudaCompute, kCudaGraphStreamIndex);
+      graph_ctx->single_stream = true;
+      cuda_graph_lru_.emplace_front(key_str, CudaGraphEntry{graph_ctx, nullptr});
+      cuda_graph_map_[key_str] = cuda_graph_lru_.begin();
     } else {
+      cuda_graph_lru_.splice(cuda_graph_lru_.begin(), cuda_graph_lru_, it->second);
+      const VMContext& graph_ctx = cuda_graph_lru_.front().second.ctx;
       for (int i = 0; i < inputs.size(); i++) {
-        Value new_arg = inputs[i];
-        Value graph_arg = cuda_graph_ctx_->inputs[i];
-        if (new_arg.as<TensorValueObj>()) {
-          CHECK(graph_arg.as<TensorValueObj>()) << "Value type mismatch, cannot copy";
-          Downcast<TensorValue>(new_arg)->tensor.CopyTo(Downcast<TensorValue>(graph_arg)->tensor);
-        } else {
-          LOG(FATAL) << "Unsupported Value Type for reusing CUDA Graph";
+        Value graph_arg = graph_ctx->inputs[i];
+        // The device inputs, e.g., the bound parameters, may be the ones baked into the graph.
+        if (graph_arg.same_as(inputs[i])) {
+          continue;
         }
+        Downcast<TensorValue>(inputs[i])->tensor.CopyTo(Downcast<TensorValue>(graph_arg)->tensor);
       }
       DLOG(INFO) << "Updated the inputs to the cached CUDA Graph.";
     }
+    cuda_graph_entry_ = &cuda_graph_lru_.front().second;
+    cuda_graph_ctx_ = cuda_graph_entry_->ctx;
     cuda_graph_occupied_ = true;
     return cuda_graph_ctx_;
   }
 #endif
   auto ctx = fcreate_ctx();
+#ifdef RAF_USE_CUDA
+  if (concurrent_ && use_cuda_) {
+    // Contexts take the streams in a round-robin way. The stream indices start from
+    // kConcurrentStreamBase to be away from the ones used by multi-stream schedules.
+    int index = num_concurrent_ctxs_.fetch_add(1) % kMaxConcurrentStreams;
+    // The contexts of a high-priority VM take the high priority compute streams.
+    ctx->high_priority = priority_ > 0;
+    int tag = ctx->high_priority ? kCudaComputeHighPriority : kCudaCompute;
+    ctx->default_stream = Stream::Get(devices_[0], tag, kConcurrentStreamBase + index);
+    if (prefetched != nullptr) {
+      DeviceAPI::Get(DevType::kCUDA())
+          ->StreamWaitEvent(ctx->default_stream->data(), prefetched->data());
+    }
+  }
+#endif
   return ctx;
 }
 
+void VirtualMachine::BindParams(const std::string& func_name, const Map<String, Value>& params) {
+  CHECK(exec_) << "The executable is not loaded yet.";
+  auto gvit = exec_->global_map.find(func_name);
+  CHECK(gvit != exec_->global_map.end()) << "Cannot find function " << func_name;
+  auto func_index = gvit->second;
+  if (params.empty()) {
+    bound_params_.erase(func_index);
+    return;
+  }
+  CHECK(!devices_.empty()) << "The devices are not set yet.";
+  const auto& vm_func = exec_->functions[func_index];
+  BoundParams bound;
+  bound.values.resize(vm_func.params.size());
+  bound.num_unbound = vm_func.params.size();
+  for (size_t i = 0; i < vm_func.params.size(); ++i) {
+    auto it = params.find(vm_func.params[i]);
+    if (it != params.end()) {
+      bound.values[i] = CopyTo((*it).second, devices_[0]);
+      --bound.num_unbound;
+    }
+  }
+  CHECK_EQ(vm_func.params.size() - bound.num_unbound, params.size())
+      << "One or more bound parameters are not the parameters of function " << func_name;
+  bound_params_[func_index] = std::move(bound);
+}
+
 Value VirtualMachine::Run(VMContext ctx) {
+  return Run(ctx, true);
+}
+
+VMFuture VirtualMachine::RunAsync(VMContext ctx) {
+  VMFuture future = VMFuture::make(ctx);
+  future->result = Run(ctx, false);
+  if (!use_cuda_) {
+    // The kernels on the host are finished when the instructions are executed.
+    VMFuture::Complete(new std::shared_ptr<VMFutureState>(future->state));
+    return future;
+  }
+  // The outputs are ready on the default stream, or on the stream of the context in the concurrent
+  // mode, so the run is completed by a host callback after the pending kernels on it.
+  void* stream = ctx->default_stream != nullptr ? ctx->default_stream->data() : nullptr;
+  auto* state = new std::shared_ptr<VMFutureState>(future->state);
+  DeviceAPI::Get(DevType::kCUDA())->LaunchHostFunc(stream, VMFuture::Complete, state);
+  return future;
+}
+
+Value VirtualMachine::Run(VMContext ctx, bool sync) {
   auto frun = [&]() {
     // ctx->pc will be reset to 0 in the PushFrame
     ctx.PushFrame(ctx->entry_func_index, ctx->inputs, -1);
     RunLoop(ctx);
   };
+  auto fmerge_stats = [&]() {
+    // The walk-through of Prewarm is not a real execution.
+    if (prewarm_jobs_ == nullptr) {
+      ctx->stats.num_runs++;
+      std::lock_guard<std::mutex> lock(stats_mu_);
+      stats_.Merge(ctx->stats);
+    }
+    ctx->stats = VMStats();
+  };
 #ifdef RAF_USE_CUDA
   if (enable_cuda_graph_) {
     CHECK(ctx.get() == cuda_graph_ctx_.get()) << "Wrong VMContext provided for CUDA graph.";
-    if (!cuda_graph_impl_) {
-      cuda_graph_impl_ = new CudaGraphImpl(devices_[0]);
+    auto& impl = cuda_graph_entry_->impl;
+    if (!impl) {
+      impl = std::make_shared<CudaGraphImpl>(devices_[0], ctx->default_stream);
       DLOG(INFO) << "Begin capturing CUDA graph.";
-      cuda_graph_impl_->BeginCapture();
-      frun();
-      cuda_graph_impl_->EndCapture();
+      impl->BeginCapture();
+      capturing_cuda_graph_ = true;
+      try {
+        frun();
+      } catch (...) {
+        capturing_cuda_graph_ = false;
+        throw;
+      }
+      capturing_cuda_graph_ = false;
+      impl->EndCapture();
       DLOG(INFO) << "CUDA graph captured.";
+      ctx->stats.num_cuda_graph_captures++;
     }
-    cuda_graph_impl_->Invoke();
+    impl->Invoke();
+    ctx->stats.num_cuda_graph_replays++;
+    fmerge_stats();
     std::lock_guard<std::mutex> lock(cuda_graph_mutex_);
     cuda_graph_occupied_ = false;
     // TODO(@icemelon9, @zhiics): May need to copy the return register to the host device to
@@ -437,14 +1201,130 @@ Value VirtualMachine::Run(VMContext ctx) {
     return ctx->return_register;
   }
 #endif
+  // The walk-through of Prewarm launches no kernel, so it is not arbitrated.
+  PriorityClass priority = static_cast<PriorityClass>(priority_);
+  ArbiterScope arbiter_scope(prewarm_jobs_ == nullptr ? arbiter_ : nullptr, priority);
+  if (compact_threshold_ > 0 && !concurrent_ && !dryrun_ && prewarm_jobs_ == nullptr) {
+    // The intermediates of the previous runs are released with their contexts, so this is a step
+    // boundary unless the contexts may run concurrently.
+    for (const auto& dev : devices_) {
+      memory_pool::Memory::StepBoundary(dev, compact_threshold_, compact_window_);
+    }
+  }
   frun();
-  if (ctx->current_stream_id != 0) {
+  // Make the outputs ready for the caller, as they may be computed on the host streams.
+  SyncHostStreams();
+  if (concurrent_) {
+    // Make the outputs ready for the caller, as they are computed on the stream of the context.
+    if (sync && ctx->default_stream != nullptr) {
+      ctx->default_stream->Wait();
+    }
+  } else if (ctx->current_stream_id != 0) {
     // reset the working stream to default stream.
     OpEnv::SetStreamForAllBackends(devices_[0], nullptr);
   }
+  RecyclePool(ctx);
+  fmerge_stats();
   return ctx->return_register;
 }
 
+void VirtualMachine::RecyclePool(VMContext& ctx) {
+  constexpr size_t kMaxSparePools = kMaxConcurrentStreams;
+  VMContextPool& pool = ctx->pool;
+  // The pooled objects in use, e.g., the returned tuple, are dropped, and the others release their
+  // fields so the values are not held across runs.
+  for (auto it = pool.values.begin(); it != pool.values.end();) {
+    if (it->second.use_count() > 1) {
+      it = pool.values.erase(it);
+      continue;
+    }
+    Object* obj = it->second.get();
+    if (obj->IsInstance<TupleValueObj>()) {
+      auto* tuple = static_cast<TupleValueObj*>(obj);
+      for (size_t i = 0; i < tuple->fields.size(); ++i) {
+        tuple->fields.Set(i, Value());
+      }
+    } else if (obj->IsInstance<VMClosureValueObj>()) {
+      auto* clo = static_cast<VMClosureValueObj*>(obj);
+      for (size_t i = 0; i < clo->free_vars.size(); ++i) {
+        clo->free_vars.Set(i, Value());
+      }
+    }
+    ++it;
+  }
+  std::lock_guard<std::mutex> lock(spare_pools_mu_);
+  if (spare_pools_.size() < kMaxSparePools) {
+    spare_pools_.push_back(std::move(pool));
+    pool = VMContextPool();
+  }
+}
+
+Map<String, ObjectRef> VirtualMachine::GetStats() {
+  static const std::unordered_map<Opcode, const char*> opcode_names = {
+      {Opcode::Move, "Move"},
+      {Opcode::Ret, "Ret"},
+      {Opcode::Fatal, "Fatal"},
+      {Opcode::LoadConst, "LoadConst"},
+      {Opcode::LoadConsti, "LoadConsti"},
+      {Opcode::GetField, "GetField"},
+      {Opcode::If, "If"},
+      {Opcode::Goto, "Goto"},
+      {Opcode::AllocStorage, "AllocStorage"},
+      {Opcode::AllocTensor, "AllocTensor"},
+      {Opcode::AllocTensorReg, "AllocTensorReg"},
+      {Opcode::AllocOwnedTensor, "AllocOwnedTensor"},
+      {Opcode::AllocTuple, "AllocTuple"},
+      {Opcode::AllocClosure, "AllocClosure"},
+      {Opcode::SetShape, "SetShape"},
+      {Opcode::Free, "Free"},
+      {Opcode::InvokeFunc, "InvokeFunc"},
+      {Opcode::InvokeClosure, "InvokeClosure"},
+      {Opcode::InvokePacked, "InvokePacked"},
+      {Opcode::InvokeJit, "InvokeJit"},
+      {Opcode::InferType, "InferType"},
+      {Opcode::CudaSetStream, "CudaSetStream"},
+      {Opcode::CudaAddEvent, "CudaAddEvent"},
+      {Opcode::CudaWaitEvent, "CudaWaitEvent"},
+      {Opcode::CudaStreamBarrier, "CudaStreamBarrier"},
+  };
+  VMStats stats;
+  {
+    std::lock_guard<std::mutex> lock(stats_mu_);
+    stats = stats_;
+  }
+  auto make_int = [](uint64_t value) { return Integer(static_cast<int64_t>(value)); };
+  Map<String, ObjectRef> instructions;
+  for (const auto& it : opcode_names) {
+    uint64_t count = stats.num_instructions[static_cast<size_t>(it.first)];
+    if (count > 0) {
+      instructions.Set(it.second, make_int(count));
+    }
+  }
+  Map<String, ObjectRef> ret;
+  ret.Set("instructions", instructions);
+  ret.Set("num_runs", make_int(stats.num_runs));
+  ret.Set("op_env_cache_hits", make_int(stats.op_env_cache_hits));
+  ret.Set("op_env_cache_misses", make_int(stats.op_env_cache_misses));
+  ret.Set("num_allocs", make_int(stats.num_allocs));
+  ret.Set("alloc_bytes", make_int(stats.alloc_bytes));
+  ret.Set("num_workspace_allocs", make_int(stats.num_workspace_allocs));
+  ret.Set("workspace_bytes", make_int(stats.workspace_bytes));
+  ret.Set("num_event_waits", make_int(stats.num_event_waits));
+  ret.Set("num_stream_barriers", make_int(stats.num_stream_barriers));
+  ret.Set("num_cuda_graph_captures", make_int(stats.num_cuda_graph_captures));
+  ret.Set("num_cuda_graph_replays", make_int(stats.num_cuda_graph_replays));
+  ret.Set("num_fallback_op_envs", make_int(stats.num_fallback_op_envs));
+  ret.Set("num_background_jits", make_int(stats.num_background_jits));
+  ret.Set("num_priority_yields", make_int(stats.num_priority_yields));
+  ret.Set("priority_yield_us", make_int(stats.priority_yield_us));
+  return ret;
+}
+
+void VirtualMachine::ResetStats() {
+  std::lock_guard<std::mutex> lock(stats_mu_);
+  stats_ = VMStats();
+}
+
 Array<FloatValue> VirtualMachine::Profile(VMContext ctx, int warmup, int number, int repeat) {
   Array<FloatValue> results;
   Device device = devices_[0];
@@ -468,6 +1348,43 @@ Array<FloatValue> VirtualMachine::Profile(VMContext ctx, int warmup, int number,
   return results;
 }
 
+bool VirtualMachine::UseHostStreams() const {
+  return !use_cuda_ && !concurrent_ && !dryrun_ && num_streams_ > 1;
+}
+
+std::shared_ptr<HostStream> VirtualMachine::GetHostStream(Index stream_id) {
+  CHECK_GT(stream_id, 0) << "The default stream runs on the calling thread";
+  if (host_streams_.empty()) {
+    // Stream 0 is the calling thread, which is not pinned, so its CPUs are left to the caller.
+    host_streams_.resize(num_streams_);
+  }
+  CHECK_LT(stream_id, host_streams_.size()) << "Unknown stream " << stream_id;
+  auto& stream = host_streams_[stream_id];
+  if (stream == nullptr) {
+    stream = std::make_shared<HostStream>(SplitCPUs(num_streams_)[stream_id]);
+  }
+  return stream;
+}
+
+std::shared_ptr<HostEvent> VirtualMachine::GetHostEvent(const VMContext& ctx, Index event_id) {
+  if (event_id >= ctx->host_events.size()) {
+    ctx->host_events.resize(event_id + 1);
+  }
+  auto& event = ctx->host_events[event_id];
+  if (event == nullptr) {
+    event = std::make_shared<HostEvent>();
+  }
+  return event;
+}
+
+void VirtualMachine::SyncHostStreams() {
+  for (const auto& stream : host_streams_) {
+    if (stream != nullptr) {
+      stream->Sync();
+    }
+  }
+}
+
 Device VirtualMachine::GetParamsDevice() const {
   CHECK(!devices_.empty()) << "Devices have not been initialized yet.";
 
@@ -494,18 +1411,87 @@ void VirtualMachine::SetDevices(const std::vector<Device>& devices) {
   if (!use_cuda_) {
     enable_cuda_graph_ = false;
   }
+  // The quotas follow the new devices.
+  SetMemoryTenant(memory_tenant_);
+  if (priority_ != 0) {
+    arbiter_ = ExecutionArbiter::Get(devices_[0]);
+  }
+}
+
+void VirtualMachine::SetMemoryTenant(const std::string& name) {
+  memory_tenant_ = name;
+  memory_quotas_.clear();
+  if (name.empty()) {
+    return;
+  }
+  std::vector<Device> devices = devices_;
+  devices.push_back(host_device_);
+  for (const Device& dev : devices) {
+    memory_quotas_.emplace_back(dev, memory_pool::MemoryQuota::Get(dev, name));
+  }
 }
 
 inline std::shared_ptr<Memory> VirtualMachine::Alloc(const VMContext& ctx, Device dev,
-                                                     int64_t nbytes, int64_t alignment) const {
+                                                     int64_t nbytes, int64_t alignment,
+                                                     const OpEnv* op_env) const {
+  std::shared_ptr<Memory> memory;
+  for (const auto& kv : memory_quotas_) {
+    if (kv.first.device_type() == dev.device_type() && kv.first.device_id() == dev.device_id()) {
+      memory = kv.second->Alloc(memory_pool::Memory::GetAllocBytes(dev, nbytes), [&]() {
+        return AllocFromPool(ctx, dev, nbytes, alignment, op_env);
+      });
+      break;
+    }
+  }
+  if (memory == nullptr) {
+    memory = AllocFromPool(ctx, dev, nbytes, alignment, op_env);
+  }
+#ifdef RAF_USE_CUDA
+  if (capturing_cuda_graph_) {
+    cuda_graph_entry_->impl->KeepAlive(memory);
+  }
+#endif
+  return memory;
+}
+
+inline std::shared_ptr<Memory> VirtualMachine::AllocFromPool(const VMContext& ctx, Device dev,
+                                                             int64_t nbytes, int64_t alignment,
+                                                             const OpEnv* op_env) const {
+  ctx->stats.num_allocs++;
+  ctx->stats.alloc_bytes += nbytes;
+  auto mem_profiler = memory_profiler::MemoryProfiler::Get();
+  std::unique_ptr<memory_profiler::AllocationScope> scope;
+  if (mem_profiler->IsTracingAllocation()) {
+    // Attribute the allocation to the requesting op, or to the instruction itself.
+    void* stream = nullptr;
+    if (dev.device_type() == DevType::kCUDA()) {
+      stream = utils::GetStreamById(ctx, ctx->current_device_id, ctx->current_stream_id)->data();
+    }
+    scope.reset(new memory_profiler::AllocationScope(op_env ? op_env->name() : "AllocStorage",
+                                                     ctx->func_index, ctx->pc, stream));
+  }
   if (dev.device_type() == DevType::kCUDA()) {
+#ifdef RAF_USE_CUDA
+    utils::SetCUDADevice(dev.device_id());
+#endif
+    // The buffers on the other GPUs (see ManifestAlloc) are allocated on their default streams.
+    auto alloc_stream = [&]() -> void* {
+      if (dev.device_id() != ctx->current_device_id) {
+        return nullptr;
+      }
+      return utils::GetStreamById(ctx, ctx->current_device_id, ctx->current_stream_id)->data();
+    };
+    auto pool = memory_pool::Memory::GetPool(dev);
+    if (pool->IsStreamOrdered()) {
+      // The pool handles the stream ordering by itself, so it works in all cases.
+      return memory_pool::Memory::AllocAsync(dev, nbytes, alloc_stream(), alignment);
+    }
 #if CUDA_VERSION >= 11030
     if (enable_cuda_graph_) {
       // We can not use async memory allocation in cuda graph tracing mode
       return memory_pool::Memory::Alloc(dev, nbytes, alignment);
     } else {
-      auto stream = utils::GetStreamById(ctx, ctx->current_device_id, ctx->current_stream_id);
-      return memory_pool::Memory::AllocAsync(dev, nbytes, stream->data(), alignment);
+      return memory_pool::Memory::AllocAsync(dev, nbytes, alloc_stream(), alignment);
     }
 #else
     return memory_pool::Memory::Alloc(dev, nbytes, alignment);
@@ -522,14 +1508,30 @@ void VirtualMachine::RunLoop(VMContext& ctx) {
 #ifdef RAF_USE_CUDA
   if (use_cuda_ && profiler::Profiler::Get()->IsProfiling(1)) {
     profiler::CudaProfiler::Get()->start();
+#ifdef RAF_USE_CUPTI
+    profiler::CuptiProfiler::Get()->start();
+#endif
+  }
+#endif
+  profiler::SamplingProfiler::Get()->NextIteration();
+#ifdef RAF_USE_CUDA
+  if (profiler::CommProfiler::Get()->IsEnabled()) {
+    profiler::CommProfiler::Get()->NextIteration();
   }
 #endif
   ctx->current_device_id = 0;
   ctx->current_stream_id = 0;
   ctx->current_barrier_event_index = 0;
+#ifdef RAF_VM_COMPUTED_GOTO
+  if (fast_dispatch_ && !profiler::Profiler::Get()->IsProfiling(2)) {
+    RunLoopFast(ctx);
+    return;
+  }
+#endif
   while (true) {
   main_loop:
     auto const& instr = ctx->code[ctx->pc];
+    ctx->stats.num_instructions[static_cast<size_t>(instr.op)]++;
     switch (instr.op) {
       case Opcode::Move: {
         WITH_BASE_PROFILER_LEVEL(2, host_device_, "Move", "VMInstruction", {},
@@ -573,6 +1575,11 @@ void VirtualMachine::RunLoop(VMContext& ctx) {
                                  { HandleAllocTensor(ctx, instr); });
         goto main_loop;
       }
+      case Opcode::AllocOwnedTensor: {
+        WITH_BASE_PROFILER_LEVEL(2, host_device_, "AllocOwnedTensor", "VMInstruction", {},
+                                 { HandleAllocOwnedTensor(ctx, instr); });
+        goto main_loop;
+      }
       case Opcode::AllocTensorReg: {
         WITH_BASE_PROFILER_LEVEL(2, host_device_, "AllocTensorReg", "VMInstruction", {},
                                  { HandleAllocTensorReg(ctx, instr); });
@@ -612,6 +1619,9 @@ void VirtualMachine::RunLoop(VMContext& ctx) {
         goto main_loop;
       }
       case Opcode::InvokeJit: {
+        if (priority_ < 0 && arbiter_->HighPending()) {
+          YieldToHighPriority(ctx);
+        }
         WITH_BASE_PROFILER_LEVEL(2, host_device_, "InvokeJit", "VMInstruction", {},
                                  { HandleInvokeJit(ctx, instr); });
         goto main_loop;
@@ -654,6 +1664,100 @@ void VirtualMachine::RunLoop(VMContext& ctx) {
   }
 }
 
+#ifdef RAF_VM_COMPUTED_GOTO
+void VirtualMachine::RunLoopFast(VMContext& ctx) {
+  // The dispatch table indexed by opcodes. Opcodes are sparse, so unused slots jump to the
+  // fatal handler.
+  constexpr size_t kNumOpcodes = static_cast<size_t>(Opcode::CudaStreamBarrier) + 1;
+  void* dispatch_table[kNumOpcodes];
+  std::fill_n(dispatch_table, kNumOpcodes, &&op_unknown);
+#define RAF_VM_SET_LABEL(OP) dispatch_table[static_cast<size_t>(Opcode::OP)] = &&op_##OP
+  RAF_VM_SET_LABEL(Move);
+  RAF_VM_SET_LABEL(Ret);
+  RAF_VM_SET_LABEL(Fatal);
+  RAF_VM_SET_LABEL(LoadConst);
+  RAF_VM_SET_LABEL(LoadConsti);
+  RAF_VM_SET_LABEL(GetField);
+  RAF_VM_SET_LABEL(If);
+  RAF_VM_SET_LABEL(Goto);
+  RAF_VM_SET_LABEL(AllocStorage);
+  RAF_VM_SET_LABEL(AllocTensor);
+  RAF_VM_SET_LABEL(AllocTensorReg);
+  RAF_VM_SET_LABEL(AllocOwnedTensor);
+  RAF_VM_SET_LABEL(AllocTuple);
+  RAF_VM_SET_LABEL(AllocClosure);
+  RAF_VM_SET_LABEL(SetShape);
+  RAF_VM_SET_LABEL(Free);
+  RAF_VM_SET_LABEL(InvokeFunc);
+  RAF_VM_SET_LABEL(InvokeClosure);
+  RAF_VM_SET_LABEL(InvokePacked);
+  RAF_VM_SET_LABEL(InvokeJit);
+  RAF_VM_SET_LABEL(InferType);
+  RAF_VM_SET_LABEL(CudaSetStream);
+  RAF_VM_SET_LABEL(CudaAddEvent);
+  RAF_VM_SET_LABEL(CudaWaitEvent);
+  RAF_VM_SET_LABEL(CudaStreamBarrier);
+#undef RAF_VM_SET_LABEL
+
+  // The code pointer is re-read on every dispatch, because it changes on function calls/returns.
+  const Instruction* instr;
+#define RAF_VM_DISPATCH()                                          \
+  {                                                                \
+    instr = &ctx->code[ctx->pc];                                   \
+    ctx->stats.num_instructions[static_cast<size_t>(instr->op)]++; \
+    goto* dispatch_table[static_cast<size_t>(instr->op)];          \
+  }
+#define RAF_VM_HANDLE(OP)                            \
+  op_##OP : VirtualMachine::Handle##OP(ctx, *instr); \
+  RAF_VM_DISPATCH()
+
+  RAF_VM_DISPATCH();
+  RAF_VM_HANDLE(Move);
+  RAF_VM_HANDLE(LoadConst);
+  RAF_VM_HANDLE(LoadConsti);
+  RAF_VM_HANDLE(GetField);
+  RAF_VM_HANDLE(If);
+  RAF_VM_HANDLE(AllocStorage);
+  RAF_VM_HANDLE(AllocTensor);
+  RAF_VM_HANDLE(AllocTensorReg);
+  RAF_VM_HANDLE(AllocOwnedTensor);
+  RAF_VM_HANDLE(AllocTuple);
+  RAF_VM_HANDLE(AllocClosure);
+  RAF_VM_HANDLE(Free);
+  RAF_VM_HANDLE(SetShape);
+  RAF_VM_HANDLE(InvokeFunc);
+  RAF_VM_HANDLE(InvokeClosure);
+op_InvokeJit:
+  if (priority_ < 0 && arbiter_->HighPending()) {
+    YieldToHighPriority(ctx);
+  }
+  VirtualMachine::HandleInvokeJit(ctx, *instr);
+  RAF_VM_DISPATCH();
+  RAF_VM_HANDLE(InferType);
+  RAF_VM_HANDLE(CudaSetStream);
+  RAF_VM_HANDLE(CudaAddEvent);
+  RAF_VM_HANDLE(CudaWaitEvent);
+  RAF_VM_HANDLE(CudaStreamBarrier);
+op_Goto:
+  ctx->pc += instr->pc_offset;
+  RAF_VM_DISPATCH();
+op_Ret:
+  if (VirtualMachine::HandleRet(ctx, *instr)) {
+    return;
+  }
+  RAF_VM_DISPATCH();
+op_InvokePacked:
+  LOG(FATAL) << "Not supported.";
+op_Fatal:
+  throw std::runtime_error("VM encountered fatal error");
+op_unknown:
+  LOG(FATAL) << "Unknown opcode " << static_cast<int>(instr->op);
+  throw;
+#undef RAF_VM_HANDLE
+#undef RAF_VM_DISPATCH
+}
+#endif
+
 void VirtualMachine::HandleMove(VMContext& ctx, const Instruction& instr) {
   Value from_obj = ctx.ReadRegister(instr.from);
   ctx.WriteRegister(instr.dst, from_obj);
@@ -671,7 +1775,21 @@ void VirtualMachine::HandleLoadConst(VMContext& ctx, const Instruction& instr) {
 
   if (!const_pool_[instr.const_index].defined()) {
     // TODO(@zhiics): device could be obtained from the device list.
-    const_pool_[instr.const_index] = CopyTo(constant_obj, devices_[0]);
+#if defined(RAF_USE_CUDA) && CUDA_VERSION >= 11010
+    if (pinned_const_staging_ && use_cuda_ && exec_->IsMappedConstant(instr.const_index)) {
+      // Pin the mapped pages of the constant so that it is uploaded by DMA directly from the
+      // mapping without a pageable staging copy.
+      const DLTensor* t = Downcast<TensorValue>(constant_obj)->tensor.operator->();
+      size_t nbytes = tvm::runtime::GetDataSize(*t);
+      CUDA_CALL(cudaHostRegister(t->data, nbytes, cudaHostRegisterReadOnly));
+      const_pool_[instr.const_index] = CopyTo(constant_obj, devices_[0]);
+      DeviceAPI::Get(devices_[0].device_type())->WaitDevice(devices_[0]);
+      CUDA_CALL(cudaHostUnregister(t->data));
+    } else
+#endif
+    {
+      const_pool_[instr.const_index] = CopyTo(constant_obj, devices_[0]);
+    }
   }
   ctx.WriteRegister(instr.dst, const_pool_[instr.const_index]);
   ctx->frames.back().is_const[instr.dst] = true;
@@ -692,6 +1810,16 @@ void VirtualMachine::HandleGetField(VMContext& ctx, const Instruction& instr) {
 }
 
 void VirtualMachine::HandleIf(VMContext& ctx, const Instruction& instr) {
+  // The condition may be computed on a host stream.
+  SyncHostStreams();
+#ifdef RAF_USE_CUDA
+  if (capturing_cuda_graph_) {
+    const DLTensor* test = Downcast<TensorValue>(ctx.ReadRegister(instr.if_op.test));
+    CHECK_NE(test->device.device_type, kDLCUDA)
+        << "A condition on the device cannot be captured into a CUDA graph. Compile with "
+           "raf.vm.optimize.predicate_if to turn the small branches into selects.";
+  }
+#endif
   int32_t test_val = ctx.LoadTensorInt(instr.if_op.test);
   int32_t target_val = ctx.LoadScalarInt(instr.if_op.target);
 
@@ -730,13 +1858,26 @@ void VirtualMachine::HandleAllocTensor(VMContext& ctx, const Instruction& instr)
   if (instr.alloc_tensor.own) {
     mem = storage->buffer;
   }
+  void* data = static_cast<char*>(storage->buffer->data) + instr.alloc_tensor.offset;
   auto tensor = TensorValue::Assemble(storage->buffer->device, instr.alloc_tensor.dtype, shape, {},
-                                      storage->buffer->data, mem);
+                                      data, mem);
   ctx.WriteRegister(instr.dst, tensor);
   ctx->pc++;
 }
 
+void VirtualMachine::HandleAllocOwnedTensor(VMContext& ctx, const Instruction& instr) {
+  const auto& alloc = instr.alloc_owned_tensor;
+  auto buffer = Alloc(ctx, Device(alloc.device_type, alloc.device_id), alloc.allocation_size,
+                      alloc.alignment);
+  std::vector<int64_t> shape(alloc.shape, alloc.shape + alloc.ndim);
+  void* data = static_cast<char*>(buffer->data) + alloc.offset;
+  ctx.WriteRegister(instr.dst,
+                    TensorValue::Assemble(buffer->device, alloc.dtype, shape, {}, data, buffer));
+  ctx->pc++;
+}
+
 void VirtualMachine::HandleAllocTensorReg(VMContext& ctx, const Instruction& instr) {
+  SyncHostStreams();
   Value value = ctx.ReadRegister(instr.alloc_tensor_reg.shape_register);
   const auto* tuple = value.as<TupleValueObj>();
   auto shape = std::vector<int64_t>(tuple->fields.size());
@@ -750,28 +1891,50 @@ void VirtualMachine::HandleAllocTensorReg(VMContext& ctx, const Instruction& ins
   if (instr.alloc_tensor_reg.own) {
     mem = storage->buffer;
   }
+  void* data = static_cast<char*>(storage->buffer->data) + instr.alloc_tensor_reg.offset;
   auto tensor = TensorValue::Assemble(storage->buffer->device, instr.alloc_tensor_reg.dtype, shape,
-                                      {}, storage->buffer->data, mem);
+                                      {}, data, mem);
   ctx.WriteRegister(instr.dst, tensor);
   ctx->pc++;
 }
 
 void VirtualMachine::HandleAllocTuple(VMContext& ctx, const Instruction& instr) {
-  Array<Value> fields;
-  for (Index i = 0; i < instr.alloc_tuple.num_fields; ++i) {
-    fields.push_back(ctx.ReadRegister(instr.alloc_tuple.fields[i]));
+  // The tuple of the last execution of the instruction is updated in place if it is only referred
+  // by the pool, which has the same number of fields.
+  ObjectPtr<Object>& pooled = ctx->pool.values[&instr];
+  if (pooled != nullptr && pooled.use_count() == 1) {
+    auto* tuple = static_cast<TupleValueObj*>(pooled.get());
+    for (Index i = 0; i < instr.alloc_tuple.num_fields; ++i) {
+      tuple->fields.Set(i, ctx.ReadRegister(instr.alloc_tuple.fields[i]));
+    }
+  } else {
+    ObjectPtr<TupleValueObj> tuple = make_object<TupleValueObj>();
+    for (Index i = 0; i < instr.alloc_tuple.num_fields; ++i) {
+      tuple->fields.push_back(ctx.ReadRegister(instr.alloc_tuple.fields[i]));
+    }
+    pooled = std::move(tuple);
   }
-  ctx.WriteRegister(instr.dst, TupleValue::make(fields));
+  ctx.WriteRegister(instr.dst, TupleValue(pooled));
   ctx->pc++;
 }
 
 void VirtualMachine::HandleAllocClosure(VMContext& ctx, const Instruction& instr) {
-  std::vector<Value> free_vars;
-  for (Index i = 0; i < instr.alloc_closure.num_free_vars; i++) {
-    free_vars.push_back(ctx.ReadRegister(instr.alloc_closure.free_vars[i]));
+  // The closure is reused in the same way as the tuples of AllocTuple.
+  ObjectPtr<Object>& pooled = ctx->pool.values[&instr];
+  if (pooled != nullptr && pooled.use_count() == 1) {
+    auto* clo = static_cast<VMClosureValueObj*>(pooled.get());
+    for (Index i = 0; i < instr.alloc_closure.num_free_vars; i++) {
+      clo->free_vars.Set(i, ctx.ReadRegister(instr.alloc_closure.free_vars[i]));
+    }
+  } else {
+    ObjectPtr<VMClosureValueObj> clo = make_object<VMClosureValueObj>();
+    clo->func_index = instr.alloc_closure.func_index;
+    for (Index i = 0; i < instr.alloc_closure.num_free_vars; i++) {
+      clo->free_vars.push_back(ctx.ReadRegister(instr.alloc_closure.free_vars[i]));
+    }
+    pooled = std::move(clo);
   }
-  auto clo = VMClosureValue::make(instr.alloc_closure.func_index, free_vars);
-  ctx.WriteRegister(instr.dst, clo);
+  ctx.WriteRegister(instr.dst, VMClosureValue(pooled));
   ctx->pc++;
 }
 
@@ -817,20 +1980,97 @@ void VirtualMachine::HandleInvokeJit(VMContext& ctx, const Instruction& instr) {
   std::string op_env_cache_key;
 
   std::tie(op_env, inputs, output, op_env_cache_key) = PrepareOpEnv(ctx, instr);
-  if (!dryrun_) {  // Skip the execution in dryrun mode
+  if (op_env == nullptr) {
+    // The dispatch is deferred by Prewarm.
+    ctx->pc++;
+    return;
+  }
+#ifdef RAF_USE_NCCL
+  // The collectives are grouped only without profiling, which times each of them on its own.
+  if (use_cuda_ && !concurrent_ && !dryrun_ && !profiler::Profiler::Get()->IsProfiling(1) &&
+      !profiler::SamplingProfiler::IsSampling() && !profiler::CommProfiler::Get()->IsEnabled() &&
+      op_env->IsGroupable(inputs, output)) {
+    LaunchCollectiveGroup(ctx, op_env, inputs, output);
+    return;
+  }
+#endif
+  LaunchOpEnv(ctx, op_env, inputs, output, op_env_cache_key);
+}
+
+void VirtualMachine::LaunchOpEnv(VMContext& ctx, const OpEnvPtr& op_env,
+                                 const std::vector<Value>& inputs, const Value& output,
+                                 const std::string& op_env_cache_key) {
+  // The OpEnv is shared by all contexts, so its requests are bound and launched exclusively.
+  std::unique_lock<std::mutex> launch_lock;
+  if (concurrent_) {
+    launch_lock = std::unique_lock<std::mutex>(launch_mu_);
+    BindConcurrentRequests(ctx, op_env);
+  }
+  if (!dryrun_ && op_env->IsShapeOnly()) {
+    // The shapes are known when the op is issued, so it neither waits for the device nor the host
+    // streams, and its host output is ready for the following shape queries.
+    WITH_BASE_PROFILER(devices_[0], op_env->name(), "ComputationOperator", {op_env_cache_key},
+                       { op_env->Execute(inputs, output); });
+  } else if (!dryrun_) {  // Skip the execution in dryrun mode
+    bool sampled = profiler::SamplingProfiler::IsSampling();
+    uint64_t sample_start = sampled ? profiler::SamplingProfiler::Get()->Start(devices_[0]) : 0;
 #ifdef RAF_USE_CUDA
     if (use_cuda_) {
-      WITH_CUDA_PROFILER(
-          devices_[0],
-          utils::GetStreamById(ctx, ctx->current_device_id, ctx->current_stream_id)->data(),
-          op_env->name(), utils::GetStreamName(ctx->current_stream_id), {op_env_cache_key},
-          { op_env->Execute(inputs, output); });
+      // The ops run on the GPUs of their outputs, and the device_copy ops between GPUs (the only
+      // ops whose input and output are on different GPUs) are the peer copies.
+      int device_id = utils::GetCUDADeviceId(output);
+      bool peer_copy = device_id >= 0 && inputs.size() == 1U &&
+                       utils::GetCUDADeviceId(inputs[0]) >= 0 &&
+                       utils::GetCUDADeviceId(inputs[0]) != device_id;
+      if (device_id >= 0) {
+        utils::SetCUDADevice(device_id);
+      }
+      WITH_CUPTI_CORRELATION(ctx->func_index, ctx->pc, op_env->name(), {
+        WITH_CUDA_PROFILER(
+            devices_[0],
+            utils::GetStreamById(ctx, ctx->current_device_id, ctx->current_stream_id)->data(),
+            op_env->name(), utils::GetStreamName(ctx->current_stream_id), {op_env_cache_key}, {
+              if (peer_copy) {
+                utils::CopyPeer(inputs[0], output);
+              } else {
+                op_env->Execute(inputs, output);
+              }
+            });
+      });
     } else
 #endif
+    if (UseHostStreams() && ctx->current_stream_id != 0) {
+      // The op runs on its host stream, which holds the buffers of the op until it is done.
+      std::vector<std::shared_ptr<Memory>> memories;
+      for (const auto& input : inputs) {
+        utils::CollectMemories(input, &memories);
+      }
+      utils::CollectMemories(output, &memories);
+      for (auto& entry : op_env->GetRequests()->workspace) {
+        if (entry.nbytes > 0 && entry.memory != nullptr) {
+          memories.push_back(std::move(entry.memory));
+        }
+      }
+      Device device = devices_[0];
+      GetHostStream(ctx->current_stream_id)
+          ->Push([op_env, inputs, output, memories, device, op_env_cache_key]() {
+            WITH_BASE_PROFILER(device, op_env->name(), "ComputationOperator", {op_env_cache_key},
+                               { op_env->Execute(inputs, output); });
+          });
+      if (sampled) {
+        profiler::SamplingProfiler::Get()->Stop(devices_[0], op_env->name(), sample_start);
+      }
+      PROFILE_MEMORY(devices_[0], op_env->name());
+      ctx->pc++;
+      return;
+    }
     {  // cpu
       WITH_BASE_PROFILER(devices_[0], op_env->name(), "ComputationOperator", {op_env_cache_key},
                          { op_env->Execute(inputs, output); });
     }
+    if (sampled) {
+      profiler::SamplingProfiler::Get()->Stop(devices_[0], op_env->name(), sample_start);
+    }
   }
   PROFILE_MEMORY(devices_[0], op_env->name());
 
@@ -849,7 +2089,101 @@ void VirtualMachine::HandleInvokeJit(VMContext& ctx, const Instruction& instr) {
   ctx->pc++;
 }
 
+void* VirtualMachine::GetCurrentCUDAStream(const VMContext& ctx) const {
+#ifdef RAF_USE_CUDA
+  if (use_cuda_) {
+    return utils::GetStreamById(ctx, ctx->current_device_id, ctx->current_stream_id)->data();
+  }
+#endif
+  return nullptr;
+}
+
+#ifdef RAF_USE_NCCL
+void VirtualMachine::LaunchCollectiveGroup(VMContext& ctx, OpEnvPtr op_env,
+                                           std::vector<Value> inputs, Value output) {
+  int device_id = utils::GetCUDADeviceId(output);
+  if (device_id >= 0) {
+    utils::SetCUDADevice(device_id);
+  }
+  std::vector<OpEnvPtr> group;
+  OpEnvPtr next;
+  std::string next_cache_key;
+  NCCL_CALL(ncclGroupStart());
+  while (op_env != nullptr) {
+    op_env->Execute(inputs, output);
+    group.push_back(std::move(op_env));
+    ctx->pc++;
+    // The group stays open across the instructions which only update the registers or allocate.
+    bool bookkeeping = true;
+    while (bookkeeping) {
+      const auto& instr = ctx->code[ctx->pc];
+      switch (instr.op) {
+        case Opcode::Move:
+          HandleMove(ctx, instr);
+          break;
+        case Opcode::LoadConst:
+          HandleLoadConst(ctx, instr);
+          break;
+        case Opcode::LoadConsti:
+          HandleLoadConsti(ctx, instr);
+          break;
+        case Opcode::GetField:
+          HandleGetField(ctx, instr);
+          break;
+        case Opcode::AllocStorage:
+          HandleAllocStorage(ctx, instr);
+          break;
+        case Opcode::AllocTensor:
+          HandleAllocTensor(ctx, instr);
+          break;
+        case Opcode::AllocOwnedTensor:
+          HandleAllocOwnedTensor(ctx, instr);
+          break;
+        case Opcode::AllocTuple:
+          HandleAllocTuple(ctx, instr);
+          break;
+        default:
+          bookkeeping = false;
+          continue;
+      }
+      ctx->stats.num_instructions[static_cast<size_t>(instr.op)]++;
+    }
+    const auto& instr = ctx->code[ctx->pc];
+    if (instr.op != Opcode::InvokeJit) {
+      break;
+    }
+    ctx->stats.num_instructions[static_cast<size_t>(instr.op)]++;
+    std::tie(next, inputs, output, next_cache_key) = PrepareOpEnv(ctx, instr);
+    if (next == nullptr) {
+      // The dispatch is deferred by Prewarm.
+      ctx->pc++;
+      break;
+    }
+    if (next->IsGroupable(inputs, output) && utils::GetCUDADeviceId(output) == device_id) {
+      op_env = std::move(next);
+    }
+  }
+  NCCL_CALL(ncclGroupEnd());
+
+  // The workspace is held until the group is launched, as the later ops in the group may reuse it.
+  for (const auto& member : group) {
+    PROFILE_MEMORY(devices_[0], member->name());
+    for (auto& entry : member->GetRequests()->workspace) {
+      if (entry.nbytes > 0 && entry.memory != nullptr) {
+        *entry.dest = nullptr;
+        entry.memory.reset();
+      }
+    }
+  }
+  if (next != nullptr) {
+    // The InvokeJit instruction which ends the group is already counted and prepared.
+    LaunchOpEnv(ctx, next, inputs, output, next_cache_key);
+  }
+}
+#endif
+
 void VirtualMachine::HandleSetShape(VMContext& ctx, const Instruction& instr) {
+  SyncHostStreams();
   auto data = Downcast<TensorValue>(ctx.ReadRegister(instr.set_shape.data));
   auto raw_shape = ctx.ReadRegister(instr.set_shape.shape);
   std::vector<int64_t> shape;
@@ -861,7 +2195,16 @@ void VirtualMachine::HandleSetShape(VMContext& ctx, const Instruction& instr) {
     raw_shape = CopyTo(raw_shape, Device(DevType::kCPU(), 0));
     shape = common::shape_utils::GetShapeVecFromData(raw_shape);
   }
-  ctx.WriteRegister(instr.dst, data.CreateView(shape));
+  if (instr.set_shape.byte_offset == 0) {
+    ctx.WriteRegister(instr.dst, data.CreateView(shape));
+  } else {
+    // The view shares the memory of the data, so it keeps the memory alive as the data does.
+    const DLTensor* tensor = data;
+    void* ptr =
+        static_cast<char*>(tensor->data) + tensor->byte_offset + instr.set_shape.byte_offset;
+    ctx.WriteRegister(instr.dst, TensorValue::make(data->tensor.CreateView(shape, {}, ptr),
+                                                   data->mem));
+  }
   ctx->pc++;
 }
 
@@ -880,6 +2223,8 @@ bool VirtualMachine::HandleRet(VMContext& ctx, const Instruction& instr) {
 }
 
 void VirtualMachine::HandleInferType(VMContext& ctx, const Instruction& instr) {
+  // The shapes of the dynamic ops depend on the values, which may be computed on a host stream.
+  SyncHostStreams();
   Array<Value> args;
   for (Index i = 0; i < instr.infer_type.num_args; i++) {
     args.push_back(ctx.ReadRegister(instr.infer_type.args[i]));
@@ -932,9 +2277,19 @@ void VirtualMachine::HandleInferType(VMContext& ctx, const Instruction& instr) {
 void VirtualMachine::HandleCudaSetStream(VMContext& ctx, const Instruction& instr) {
   Index device_id = instr.cuda_set_stream.device_id;
   Index stream_id = instr.cuda_set_stream.stream_id;
+  if (!use_cuda_) {
+    // On the host, the ops of the streams other than the default one run on the host streams.
+    ctx->current_device_id = device_id;
+    ctx->current_stream_id = stream_id;
+    ctx->pc++;
+    return;
+  }
   Device device(DevType::kCUDA(), static_cast<int>(device_id));
-  auto stream = utils::GetStreamById(ctx, device_id, stream_id);
-  OpEnv::SetStreamForAllBackends(device, stream->data());
+  auto stream = utils::GetStreamById(ctx, device_id, stream_id, instr.cuda_set_stream.priority);
+  if (!concurrent_) {
+    // In the concurrent mode, the stream of backends is set when launching an OpEnv.
+    OpEnv::SetStreamForAllBackends(device, stream->data());
+  }
   ctx->current_device_id = device_id;
   ctx->current_stream_id = stream_id;
   ctx->pc++;
@@ -947,6 +2302,17 @@ void VirtualMachine::HandleCudaAddEvent(VMContext& ctx, const Instruction& instr
     stream_id = ctx->current_stream_id;
   }
   Index event_id = instr.cuda_event.event_id;
+  if (!use_cuda_) {
+    auto event = GetHostEvent(ctx, event_id);
+    if (!UseHostStreams() || stream_id == 0) {
+      // The ops of the default stream are done when their instructions are executed.
+      event->Complete(event->NewRecord());
+    } else {
+      GetHostStream(stream_id)->Record(event);
+    }
+    ctx->pc++;
+    return;
+  }
   auto event = utils::GetEventById(ctx, device_id, event_id);
   auto stream = utils::GetStreamById(ctx, device_id, stream_id);
   auto api = DeviceAPI::Get(DevType::kCUDA());
@@ -962,14 +2328,41 @@ void VirtualMachine::HandleCudaWaitEvent(VMContext& ctx, const Instruction& inst
     stream_id = ctx->current_stream_id;
   }
   Index event_id = instr.cuda_event.event_id;
+  if (!use_cuda_) {
+    auto event = GetHostEvent(ctx, event_id);
+    if (!UseHostStreams() || stream_id == 0) {
+      event->Wait(event->LastRecord());
+    } else {
+      GetHostStream(stream_id)->Wait(event);
+    }
+    ctx->stats.num_event_waits++;
+    ctx->pc++;
+    return;
+  }
   auto event = utils::GetEventById(ctx, device_id, event_id);
   auto stream = utils::GetStreamById(ctx, device_id, stream_id);
   auto api = DeviceAPI::Get(DevType::kCUDA());
+#ifdef RAF_USE_CUDA
+  // The wait is marked before it is issued, so the time that the collectives on this stream
+  // wait for the computation is reported by the communication profiler.
+  if (profiler::CommProfiler::Get()->IsEnabled()) {
+    profiler::CommProfiler::Get()->MarkWait(Device(DevType::kCUDA(), device_id), stream->data());
+  }
+#endif
   api->StreamWaitEvent(stream->data(), event->data());
+  ctx->stats.num_event_waits++;
   ctx->pc++;
 }
 
 void VirtualMachine::HandleCudaStreamBarrier(VMContext& ctx, const Instruction& instr) {
+  if (!use_cuda_ || ctx->single_stream) {
+    // All work is ordered on one stream, and recording on the legacy default stream would break
+    // the capture of a CUDA graph.
+    SyncHostStreams();
+    ctx->stats.num_stream_barriers++;
+    ctx->pc++;
+    return;
+  }
   if (ctx->current_barrier_event_index >= ctx->barrier_events.size()) {
     Device device(DevType::kCUDA(), static_cast<int>(ctx->current_device_id));
     ctx->barrier_events.resize(ctx->current_barrier_event_index + 1);
@@ -989,17 +2382,169 @@ void VirtualMachine::HandleCudaStreamBarrier(VMContext& ctx, const Instruction&
    */
   api->EventRecordOnStream(ctx->barrier_events[ctx->current_barrier_event_index]->data(),
                            nullptr /* default stream */);
+  ctx->stats.num_stream_barriers++;
   ctx->pc++;
 }
 
+void VirtualMachine::InitOpEnvRequests(const VMContext& ctx, const OpEnvPtr& op_env) {
+  std::shared_ptr<Requests> requests = op_env->GetRequests();
+  // prepare distributed requests
+  for (size_t i = 0; i < requests->distributed.size(); i++) {
+    Requests::DistributedRequest& entry = requests->distributed[i];
+    *entry.dest = (void*)(Communicator::Get().as<CommunicatorObj>());
+    // TODO(@Tonny-Gu): force removing const attribute here is dirty. Can we return a ObjectRef or
+    // ncclComm_t handler instead?
+  }
+#ifdef RAF_USE_CUDA
+  // prepare cuda stream requests
+  for (size_t i = 0; i < requests->stream.size(); i++) {
+    Requests::StreamRequest& entry = requests->stream[i];
+    // currently ignores the stream_idx field in requests, all requests with the same tag_idx will
+    // get the same cuda stream in vm
+    std::shared_ptr<Stream> stream =
+        utils::GetStreamById(ctx, entry.device.device_id(), entry.tag_idx);
+    *entry.dest = stream->data();
+    entry.stream = stream;
+  }
+#endif
+}
+
+void VirtualMachine::Prewarm(const std::string& func_name, const std::vector<Value>& inputs,
+                             int num_threads) {
+  CHECK(!enable_cuda_graph_) << "Prewarm is not supported for VM in CUDA graph mode.";
+  // Walk through the function in the dryrun mode to collect the OpEnvs to be dispatched, along
+  // with the argument types resolved from the given inputs.
+  std::vector<PrewarmJob> jobs;
+  bool dryrun = dryrun_;
+  dryrun_ = true;
+  prewarm_jobs_ = &jobs;
+  VMContext ctx = PrepareVMContext(func_name, inputs);
+  try {
+    Run(ctx);
+  } catch (...) {
+    dryrun_ = dryrun;
+    prewarm_jobs_ = nullptr;
+    throw;
+  }
+  dryrun_ = dryrun;
+  prewarm_jobs_ = nullptr;
+
+  // Dispatch (and JIT compile) all OpEnvs in parallel.
+  if (num_threads <= 0) {
+    num_threads = std::max(1U, std::thread::hardware_concurrency());
+  }
+  num_threads = std::min<int>(num_threads, jobs.size());
+  std::vector<OpEnvPtr> op_envs(jobs.size());
+  std::vector<std::string> errors(jobs.size());
+  std::atomic<size_t> next_job{0};
+  auto worker = [&]() {
+    for (size_t i = next_job++; i < jobs.size(); i = next_job++) {
+      try {
+        op_envs[i] = Dispatch(jobs[i].call_values);
+      } catch (const dmlc::Error& e) {
+        errors[i] = e.what();
+      }
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads; ++i) {
+    threads.emplace_back(worker);
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (size_t i = 0; i < jobs.size(); ++i) {
+    CHECK(errors[i].empty()) << "Failed to dispatch OpEnv during prewarm: " << errors[i];
+    CHECK(op_envs[i] != nullptr) << "ValueError: Cannot dispatch "
+                                 << PrettyPrint(jobs[i].call_values->callee) << " @"
+                                 << jobs[i].call_values->device.c_str();
+    InitOpEnvRequests(ctx, op_envs[i]);
+    jobs[i].cache->Set(jobs[i].key, op_envs[i]);
+  }
+  DLOG(INFO) << "Prewarmed " << jobs.size() << " OpEnvs with " << num_threads << " threads";
+}
+
+/*! \brief Make a value whose tensors have the same types without buffers. */
+Value MakeMetaValue(const Value& value) {
+  if (const auto* tensor = value.as<TensorValueObj>()) {
+    const DLTensor* dlt = tensor->tensor.operator->();
+    return TensorValue::Assemble(Device(dlt->device), DType(dlt->dtype),
+                                 std::vector<int64_t>(dlt->shape, dlt->shape + dlt->ndim));
+  } else if (const auto* tuple = value.as<TupleValueObj>()) {
+    Array<Value> fields;
+    for (const auto& field : tuple->fields) {
+      fields.push_back(MakeMetaValue(field));
+    }
+    return TupleValue::make(fields);
+  }
+  return value;
+}
+
+/*! \brief Make a value whose tensors have new buffers of the same types. */
+Value MakeDummyValue(const Value& value) {
+  if (const auto* tensor = value.as<TensorValueObj>()) {
+    const DLTensor* dlt = tensor->tensor.operator->();
+    return CreateDummyValueFromType(GetType(value), Device(dlt->device));
+  } else if (const auto* tuple = value.as<TupleValueObj>()) {
+    Array<Value> fields;
+    for (const auto& field : tuple->fields) {
+      fields.push_back(MakeDummyValue(field));
+    }
+    return TupleValue::make(fields);
+  }
+  return value;
+}
+
+/*! \brief Get the readable representation of the argument types of an InvokeJit instruction. */
+std::string OpEnvKeyRepr(const VMContext& ctx, const Instruction& instr) {
+  Index num_inputs = instr.invoke_jit.arity - instr.invoke_jit.output_size;
+  std::ostringstream os;
+  for (Index i = 0; i < num_inputs; i++) {
+    Index reg_idx = instr.invoke_jit.args[i];
+    if (ctx.IsConst(reg_idx)) {
+      continue;
+    }
+    auto reg = ctx.ReadRegister(reg_idx);
+    if (auto tensor = reg.as<TensorValueObj>()) {
+      utils::TensorRepr(os, tensor);
+    } else if (auto tup = reg.as<TupleValueObj>()) {
+      os << "(";
+      for (auto field : tup->fields) {
+        auto t = field.as<TensorValueObj>();
+        if (t != nullptr) {
+          utils::TensorRepr(os, t);
+        }
+        os << ",";
+      }
+      os << ")";
+    }
+    os << ",";
+  }
+  os << "|";
+  if (instr.invoke_jit.output_size == 1) {
+    utils::TensorRepr(os, ctx.ReadRegister(instr.invoke_jit.args[num_inputs]).as<TensorValueObj>());
+  } else {
+    os << "(";
+    for (Index i = num_inputs; i < instr.invoke_jit.arity; i++) {
+      utils::TensorRepr(os, ctx.ReadRegister(instr.invoke_jit.args[i]).as<TensorValueObj>());
+      os << ",";
+    }
+    os << ")";
+  }
+  return os.str();
+}
+
 std::tuple<std::shared_ptr<OpEnv>, std::vector<Value>, Value, std::string>
 VirtualMachine::PrepareOpEnv(const VMContext& ctx, const Instruction& instr) {
   Index num_inputs = instr.invoke_jit.arity - instr.invoke_jit.output_size;
   Array<Value> args;
   Value output;
 
-  // extract the input args and prepare the hash key to query op env
-  std::ostringstream os;
+  // Extract the input args and prepare the binary key to query op env. The key buffer is reused
+  // across invocations to avoid allocations in the hot path.
+  static thread_local HashKey key;
+  key.byte_vector.clear();
   for (Index i = 0; i < num_inputs; i++) {
     Index reg_idx = instr.invoke_jit.args[i];
     auto reg = ctx.ReadRegister(reg_idx);
@@ -1009,49 +2554,49 @@ VirtualMachine::PrepareOpEnv(const VMContext& ctx, const Instruction& instr) {
       continue;
     }
     if (auto tensor = reg.as<TensorValueObj>()) {
-      utils::TensorRepr(os, tensor);
+      key << *tensor->tensor.operator->();
     } else if (auto tup = reg.as<TupleValueObj>()) {
-      os << "(";
+      key << static_cast<int64_t>(tup->fields.size());
       for (auto field : tup->fields) {
         auto t = field.as<TensorValueObj>();
         if (t != nullptr) {
-          utils::TensorRepr(os, t);
+          key << *t->tensor.operator->();
+        } else {
+          key << static_cast<int64_t>(-1);
         }
-        os << ",";
       }
-      os << ")";
     } else {
       LOG(FATAL) << "Unsupported non-const register type: " << reg->GetTypeKey();
     }
-    os << ",";
   }
 
   // extract the output
-  os << "|";
   if (instr.invoke_jit.output_size == 1) {
     output = ctx.ReadRegister(instr.invoke_jit.args[num_inputs]);
-    utils::TensorRepr(os, output.as<TensorValueObj>());
+    key << *output.as<TensorValueObj>()->tensor.operator->();
   } else {
-    os << "(";
     Array<Value> outs;
     for (Index i = num_inputs; i < instr.invoke_jit.arity; i++) {
       Value val = ctx.ReadRegister(instr.invoke_jit.args[i]);
       outs.push_back(val);
-      utils::TensorRepr(os, val.as<TensorValueObj>());
-      os << ",";
+      key << *val.as<TensorValueObj>()->tensor.operator->();
     }
-    os << ")";
     output = TupleValue::make(outs);
   }
-  std::string op_env_cache_key = os.str();
+  const std::vector<uint8_t>& op_env_cache_key = key.byte_vector;
 
+  if (num_ready_jits_.load(std::memory_order_relaxed) > 0) {
+    InstallBackgroundJits(ctx);
+  }
   // check the OpEnv cache
   std::shared_ptr<OpEnv> op_env;
   auto op_env_cache = op_env_cache_[ctx->func_index]->Get(ctx->pc);
   if (auto p = op_env_cache->Get(op_env_cache_key)) {
     // Cache hit. Reuse the OpEnv from the cache.
     op_env = *p;
+    ctx->stats.op_env_cache_hits++;
   } else {
+    ctx->stats.op_env_cache_misses++;
     // Create a new OpEnv.
     auto call_values = CallValues::make();
     Value callee = ctx.ReadRegister(instr.invoke_jit.op_reg);
@@ -1064,49 +2609,231 @@ VirtualMachine::PrepareOpEnv(const VMContext& ctx, const Instruction& instr) {
       call_values->args = MakeListArgs(args);
     }
     call_values->device = devices_[0];
+    int device_id = utils::GetCUDADeviceId(output);
+    if (device_id >= 0 && devices_[0].device_type() == DevType::kCUDA() &&
+        device_id != devices_[0].device_id()) {
+      // The ops placed on other GPUs (see ManifestAlloc) are dispatched to their GPUs.
+      call_values->device = Device(DevType::kCUDA(), device_id);
+    }
     call_values->out = output;
-    op_env = Dispatch(call_values);
-    CHECK(op_env != nullptr) << "ValueError: Cannot dispatch "
-                             << (op ? op->op->name : PrettyPrint(closure->func)) << " @"
-                             << call_values->device.c_str();
+    if (prewarm_jobs_ != nullptr) {
+      // Defer the dispatch to the worker threads of Prewarm.
+      prewarm_jobs_->push_back({op_env_cache, op_env_cache_key, call_values});
+      return std::make_tuple(nullptr, std::vector<Value>(), std::move(output), std::string());
+    }
+    if (!jit_threads_.empty() && !dryrun_) {
+      // Serve the miss by a fallback that is ready, and build the optimized one in the background.
+      auto fallback = DispatchFallback(call_values);
+      if (fallback != nullptr) {
+        InitOpEnvRequests(ctx, fallback);
+        op_env = op_env_cache->Set(op_env_cache_key, fallback);
+        if (op_env == fallback) {
+          // The fallback is cached by this context, so the optimized one is built only once.
+          BackgroundJitJob job;
+          job.func_cache = op_env_cache_[ctx->func_index];
+          job.pc = ctx->pc;
+          job.key = op_env_cache_key;
+          job.callee = callee;
+          for (const auto& arg : args) {
+            job.args.push_back(MakeMetaValue(arg));
+          }
+          job.output = MakeMetaValue(output);
+          job.device = call_values->device;
+          const auto* pref = DialectPreference::Current();
+          job.has_dialect_preference = pref != nullptr;
+          if (pref != nullptr) {
+            job.preferred_dialects = (*pref)->preferred_dialects;
+          }
+          std::lock_guard<std::mutex> lock(jit_mu_);
+          jit_queue_.push_back(std::move(job));
+          num_pending_jits_++;
+          jit_cv_.notify_one();
+          ctx->stats.num_fallback_op_envs++;
+        }
+      }
+    }
+    if (op_env == nullptr) {
+      op_env = Dispatch(call_values);
+      CHECK(op_env != nullptr) << "ValueError: Cannot dispatch "
+                               << (op ? op->op->name : PrettyPrint(closure->func)) << " @"
+                               << call_values->device.c_str();
+      InitOpEnvRequests(ctx, op_env);
+      // add to cache, or use the one cached by another thread
+      op_env = op_env_cache->Set(op_env_cache_key, op_env);
+    }
+  }
+
+  if (!concurrent_) {
+    // In the concurrent mode, the workspace is allocated by BindConcurrentRequests when the
+    // OpEnv is launched.
     std::shared_ptr<Requests> requests = op_env->GetRequests();
-    // prepare distributed requests
-    for (size_t i = 0; i < requests->distributed.size(); i++) {
-      Requests::DistributedRequest& entry = requests->distributed[i];
-      *entry.dest = (void*)(Communicator::Get().as<CommunicatorObj>());
-      // TODO(@Tonny-Gu): force removing const attribute here is dirty. Can we return a ObjectRef or
-      // ncclComm_t handler instead?
+    for (size_t i = 0; i < requests->workspace.size(); i++) {
+      Requests::WorkspaceRequest& entry = requests->workspace[i];
+      auto buf = Alloc(ctx, entry.device, entry.nbytes, kDefaultMemoryAlignment, op_env.get());
+      entry.memory = buf;
+      *entry.dest = buf->data;
+      ctx->stats.num_workspace_allocs++;
+      ctx->stats.workspace_bytes += entry.nbytes;
     }
+  }
+
+  std::vector<Value> inputs;
+  for (int i : op_env->arg_indices) {
+    CHECK_GE(i, 0) << "Invalid input index: " << i;
+    inputs.push_back(args[i]);
+  }
+  std::string op_env_repr;
+  if (profiler::Profiler::Get()->IsProfiling(1)) {
+    op_env_repr = OpEnvKeyRepr(ctx, instr);
+  }
+  return std::make_tuple(op_env, std::move(inputs), std::move(output), std::move(op_env_repr));
+}
+
+void VirtualMachine::BindConcurrentRequests(const VMContext& ctx, const OpEnvPtr& op_env) {
+  std::shared_ptr<Requests> requests = op_env->GetRequests();
+  for (size_t i = 0; i < requests->workspace.size(); i++) {
+    Requests::WorkspaceRequest& entry = requests->workspace[i];
+    auto buf = Alloc(ctx, entry.device, entry.nbytes, kDefaultMemoryAlignment, op_env.get());
+    entry.memory = buf;
+    *entry.dest = buf->data;
+    ctx->stats.num_workspace_allocs++;
+    ctx->stats.workspace_bytes += entry.nbytes;
+  }
 #ifdef RAF_USE_CUDA
-    // prepare cuda stream requests
+  if (use_cuda_) {
     for (size_t i = 0; i < requests->stream.size(); i++) {
       Requests::StreamRequest& entry = requests->stream[i];
-      // currently ignores the stream_idx field in requests, all requests with the same tag_idx will
-      // get the same cuda stream in vm
       std::shared_ptr<Stream> stream =
           utils::GetStreamById(ctx, entry.device.device_id(), entry.tag_idx);
       *entry.dest = stream->data();
       entry.stream = stream;
     }
+    // The library handles (e.g., cuBLAS and cuDNN) are shared by all contexts.
+    auto stream = utils::GetStreamById(ctx, ctx->current_device_id, ctx->current_stream_id);
+    OpEnv::SetStreamForAllBackends(Device(DevType::kCUDA(), ctx->current_device_id),
+                                   stream->data());
+  }
 #endif
-    // add to cache
-    op_env_cache->Set(op_env_cache_key, op_env);
+}
+
+void VirtualMachine::SetConcurrent(bool concurrent) {
+  CHECK(!concurrent || !enable_cuda_graph_)
+      << "Concurrent execution is not supported for VM in CUDA graph mode.";
+  CHECK(concurrent || priority_ == 0 || !use_cuda_)
+      << "The concurrent mode cannot be disabled for a CUDA VM with a priority class.";
+  concurrent_ = concurrent;
+}
+
+void VirtualMachine::SetPriority(int priority) {
+  CHECK(priority == 0 || !enable_cuda_graph_)
+      << "Priority classes are not supported for VM in CUDA graph mode.";
+  CHECK(!devices_.empty()) << "The devices are not set yet.";
+  CHECK(priority == 0 || concurrent_ || !use_cuda_)
+      << "A CUDA VM must be in the concurrent mode to run on the prioritized streams.";
+  priority_ = std::max(-1, std::min(priority, 1));
+  arbiter_ = priority_ != 0 ? ExecutionArbiter::Get(devices_[0]) : nullptr;
+}
+
+void VirtualMachine::YieldToHighPriority(VMContext& ctx) {
+  // The kernels launched so far keep running, but no more are launched until the high-priority
+  // runs of the device are done.
+  ctx->stats.num_priority_yields++;
+  ctx->stats.priority_yield_us += arbiter_->Yield();
+}
+
+void VirtualMachine::SetBackgroundJit(int num_threads) {
+  CHECK(num_threads == 0 || !enable_cuda_graph_)
+      << "Background JIT is not supported for VM in CUDA graph mode.";
+  StopBackgroundJit();
+  jit_stop_ = false;
+  for (int i = 0; i < num_threads; ++i) {
+    jit_threads_.emplace_back([this]() { BackgroundJitWorker(); });
   }
+}
 
-  std::shared_ptr<Requests> requests = op_env->GetRequests();
-  for (size_t i = 0; i < requests->workspace.size(); i++) {
-    Requests::WorkspaceRequest& entry = requests->workspace[i];
-    auto buf = Alloc(ctx, entry.device, entry.nbytes);
-    entry.memory = buf;
-    *entry.dest = buf->data;
+void VirtualMachine::SyncBackgroundJit() {
+  std::unique_lock<std::mutex> lock(jit_mu_);
+  jit_done_cv_.wait(lock, [this]() { return num_pending_jits_ == 0; });
+}
+
+void VirtualMachine::StopBackgroundJit() {
+  {
+    std::lock_guard<std::mutex> lock(jit_mu_);
+    jit_stop_ = true;
+    num_pending_jits_ -= jit_queue_.size();
+    jit_queue_.clear();
+  }
+  jit_cv_.notify_all();
+  for (auto& thread : jit_threads_) {
+    thread.join();
   }
+  jit_threads_.clear();
+  jit_done_cv_.notify_all();
+}
 
-  std::vector<Value> inputs;
-  for (int i : op_env->arg_indices) {
-    CHECK_GE(i, 0) << "Invalid input index: " << i;
-    inputs.push_back(args[i]);
+void VirtualMachine::BackgroundJitWorker() {
+  while (true) {
+    BackgroundJitJob job;
+    {
+      std::unique_lock<std::mutex> lock(jit_mu_);
+      jit_cv_.wait(lock, [this]() { return jit_stop_ || !jit_queue_.empty(); });
+      if (jit_stop_) {
+        return;
+      }
+      job = std::move(jit_queue_.front());
+      jit_queue_.pop_front();
+    }
+    try {
+#ifdef RAF_USE_CUDA
+      if (job.device.device_type() == DevType::kCUDA()) {
+        utils::SetCUDADevice(job.device.device_id());
+      }
+#endif
+      std::unique_ptr<tvm::With<DialectPreference>> pref;
+      if (job.has_dialect_preference) {
+        pref = std::make_unique<tvm::With<DialectPreference>>(job.preferred_dialects);
+      }
+      // The build may run (e.g., profile) the kernels, so it has its own buffers.
+      Array<Value> args;
+      for (const auto& arg : job.args) {
+        args.push_back(MakeDummyValue(arg));
+      }
+      auto call_values = CallValues::make();
+      call_values->callee = job.callee;
+      if (const auto* op = job.callee.as<OpValueObj>()) {
+        call_values->args = GetOpAttr<FRAFSchema>(op->op, "FRAFSchema")(args);
+      } else {
+        call_values->args = MakeListArgs(args);
+      }
+      call_values->device = job.device;
+      call_values->out = MakeDummyValue(job.output);
+      job.op_env = Dispatch(call_values);
+    } catch (const dmlc::Error& e) {
+      LOG(WARNING) << "Failed to build the OpEnv in the background, which keeps the fallback: "
+                   << e.what();
+    }
+    std::lock_guard<std::mutex> lock(jit_mu_);
+    if (job.op_env != nullptr && !jit_stop_) {
+      jit_ready_.push_back(std::move(job));
+      num_ready_jits_.store(jit_ready_.size(), std::memory_order_relaxed);
+    }
+    num_pending_jits_--;
+    jit_done_cv_.notify_all();
+  }
+}
+
+void VirtualMachine::InstallBackgroundJits(const VMContext& ctx) {
+  std::vector<BackgroundJitJob> ready;
+  {
+    std::lock_guard<std::mutex> lock(jit_mu_);
+    ready.swap(jit_ready_);
+    num_ready_jits_.store(0, std::memory_order_relaxed);
+  }
+  for (auto& job : ready) {
+    InitOpEnvRequests(ctx, job.op_env);
+    job.func_cache->Get(job.pc)->Replace(job.key, job.op_env);
+    ctx->stats.num_background_jits++;
   }
-  return std::make_tuple(op_env, std::move(inputs), std::move(output), op_env_cache_key);
 }
 
 tvm::runtime::Module CreateVirtualMachine(const Executable* exec, bool enable_cuda_graph,
@@ -1116,6 +2843,16 @@ tvm::runtime::Module CreateVirtualMachine(const Executable* exec, bool enable_cu
   return tvm::runtime::Module(vm);
 }
 
+RAF_REGISTER_GLOBAL("raf.vm.FutureIsReady").set_body_typed([](VMFuture future) {
+  return future.IsReady();
+});
+
+RAF_REGISTER_GLOBAL("raf.vm.FutureGet").set_body_typed([](VMFuture future) {
+  return future.Get();
+});
+
+RAF_REGISTER_GLOBAL("raf.vm.CopyToHostAsync").set_body_typed(CopyToHostAsync);
+
 RAF_REGISTER_GLOBAL("raf.vm.VirtualMachine").set_body([](tvm::TVMArgs args, tvm::TVMRetValue* rv) {
   tvm::runtime::Module mod = args[0];
   bool enable_cuda_graph = args[1];
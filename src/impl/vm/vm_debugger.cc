@@ -7,6 +7,11 @@
  * \file src/impl/vm/vm_debugger.cc
  * \brief The implementation for RAF virtual machine debugger.
  */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
 #include <memory>
 #include <numeric>
 #include <string>
@@ -17,6 +22,9 @@
 #include "raf/device_api.h"
 #include "raf/memory_pool.h"
 #include "./vm_debugger.h"
+#ifdef RAF_USE_CUDA
+#include "../../op/dialect/cuda/kernels/kernel_util.cuh"
+#endif
 
 namespace raf {
 namespace executor {
@@ -49,6 +57,51 @@ std::string GetShapeStr(const Value& value) {
   return ss.str();
 }
 
+/*! \brief Collect the tensors of a value. */
+void CollectTensors(const Value& value, std::vector<const DLTensor*>* tensors) {
+  if (const auto* tvo = value.as<TensorValueObj>()) {
+    tensors->push_back(tvo->tensor.operator->());
+  } else if (const auto* tuple = value.as<TupleValueObj>()) {
+    for (const auto& field : tuple->fields) {
+      CollectTensors(field, tensors);
+    }
+  }
+}
+
+template <typename T>
+void AccumulateHostStats(const void* data, int64_t n, float* stats) {
+  const T* ptr = static_cast<const T*>(data);
+  for (int64_t i = 0; i < n; ++i) {
+    float val = static_cast<float>(ptr[i]);
+    if (std::isnan(val)) {
+      stats[2] += 1.0f;
+    } else {
+      stats[0] = std::min(stats[0], val);
+      stats[1] = std::max(stats[1], val);
+      stats[3] += val * val;
+    }
+  }
+}
+
+/*! \brief Accumulate the summary of a tensor on the host in the same way as tensor_stats_cuda. */
+bool HostTensorStats(const void* data, int64_t n, DLDataType dtype, float* stats) {
+  if (dtype.lanes != 1) {
+    return false;
+  }
+  if (dtype.code == kDLFloat && dtype.bits == 32) {
+    AccumulateHostStats<float>(data, n, stats);
+  } else if (dtype.code == kDLFloat && dtype.bits == 64) {
+    AccumulateHostStats<double>(data, n, stats);
+  } else if (dtype.code == kDLInt && dtype.bits == 32) {
+    AccumulateHostStats<int32_t>(data, n, stats);
+  } else if (dtype.code == kDLInt && dtype.bits == 64) {
+    AccumulateHostStats<int64_t>(data, n, stats);
+  } else {
+    return false;
+  }
+  return true;
+}
+
 PackedFunc VMDebugger::GetFunction(const std::string& name, const ObjectPtr<Object>& sptr_to_self) {
   if (name == "get_interm_tensors") {
     return PackedFunc([sptr_to_self, this](tvm::TVMArgs args, tvm::TVMRetValue* rv) {
@@ -59,6 +112,11 @@ PackedFunc VMDebugger::GetFunction(const std::string& name, const ObjectPtr<Obje
           {"names", op_names_}, {"inputs", op_inputs_}, {"outputs", op_outputs_}};
       *rv = res;
     });
+  } else if (name == "get_op_summaries") {
+    return PackedFunc([sptr_to_self, this](tvm::TVMArgs args, tvm::TVMRetValue* rv) {
+      ICHECK_EQ(args.size(), 0U);
+      *rv = GetOpSummaries();
+    });
   } else if (name == "run") {
     return PackedFunc([sptr_to_self, this](tvm::TVMArgs args, tvm::TVMRetValue* rv) {
       ICHECK_EQ(args.size(), 1U);
@@ -72,8 +130,14 @@ PackedFunc VMDebugger::GetFunction(const std::string& name, const ObjectPtr<Obje
       op_names_.clear();
       op_inputs_.clear();
       op_outputs_.clear();
+      op_records_.clear();
+      for (auto& buffer : summary_buffers_) {
+        buffer.used = 0;
+      }
       for (auto op_env_cache : op_env_cache_) {
-        op_env_cache->Clear();
+        if (op_env_cache != nullptr) {
+          op_env_cache->Clear();
+        }
       }
     });
   } else {
@@ -88,6 +152,16 @@ void VMDebugger::HandleInvokeJit(VMContext& ctx, const Instruction& instr) {
   std::string op_env_cache_key;
 
   std::tie(op_env, inputs, output, op_env_cache_key) = PrepareOpEnv(ctx, instr);
+  if (op_env == nullptr) {
+    // The dispatch is deferred by Prewarm.
+    ctx->pc++;
+    return;
+  }
+  if (lightweight_) {
+    RecordOp(ctx, op_env, inputs, output, op_env_cache_key);
+    op_names_.push_back(op_env->name());
+    return;
+  }
   op_env->Execute(inputs, output);
   ctx->pc++;
 
@@ -118,8 +192,146 @@ void VMDebugger::HandleInvokeJit(VMContext& ctx, const Instruction& instr) {
   op_names_.push_back(op_env->name());
 }
 
-tvm::runtime::Module CreateVMDebugger(const Executable* exec) {
-  auto vm = make_object<VMDebugger>();
+void VMDebugger::RecordOp(VMContext& ctx, const OpEnvPtr& op_env, const std::vector<Value>& inputs,
+                          const Value& output, const std::string& op_env_cache_key) {
+  std::vector<const DLTensor*> tensors;
+  CollectTensors(output, &tensors);
+  // The output is summarized on its device. Only the outputs on the current GPU are summarized on
+  // the GPU, where the op runs on the current stream of the context.
+  void* stream = GetCurrentCUDAStream(ctx);
+  Device device = host_device_;
+  if (stream != nullptr && !tensors.empty() && tensors[0]->device.device_type == kDLCUDA) {
+    device = Device(DevType::kCUDA(), ctx->current_device_id);
+  }
+  bool on_gpu = device.device_type() == DevType::kCUDA();
+  auto api = on_gpu ? device_api::DeviceAPI::Get(DevType::kCUDA()) : nullptr;
+
+  OpRecord record;
+  if (on_gpu) {
+    auto pool = event_pool::EventPool::Get(device);
+    record.start = pool->GetEvent();
+    record.end = pool->GetEvent();
+    api->EventRecordOnStream(record.start->data(), stream);
+  }
+  auto begin = std::chrono::steady_clock::now();
+  LaunchOpEnv(ctx, op_env, inputs, output, op_env_cache_key);
+  if (on_gpu) {
+    api->EventRecordOnStream(record.end->data(), stream);
+  } else {
+    auto elapsed = std::chrono::steady_clock::now() - begin;
+    record.host_ms = std::chrono::duration<double, std::milli>(elapsed).count();
+  }
+
+  if (!tensors.empty()) {
+    float* stats = ReserveSummary(device, &record);
+    bool supported = true;
+#ifdef RAF_USE_CUDA
+    if (on_gpu) {
+      op::cuda::init_tensor_stats_cuda(stats, stream);
+    }
+#endif
+    if (!on_gpu) {
+      stats[0] = std::numeric_limits<float>::infinity();
+      stats[1] = -std::numeric_limits<float>::infinity();
+      stats[2] = stats[3] = 0.0f;
+    }
+    for (const auto* t : tensors) {
+      if (t->device.device_type != static_cast<DLDeviceType>(device.device_type()) ||
+          (on_gpu && t->device.device_id != device.device_id())) {
+        supported = false;
+        break;
+      }
+      int64_t n = std::accumulate(t->shape, t->shape + t->ndim, int64_t{1},
+                                  std::multiplies<int64_t>());
+      const void* data = static_cast<const char*>(t->data) + t->byte_offset;
+#ifdef RAF_USE_CUDA
+      if (on_gpu) {
+        supported = op::cuda::tensor_stats_cuda(data, n, t->dtype, stats, stream);
+      }
+#endif
+      if (!on_gpu) {
+        supported = HostTensorStats(data, n, t->dtype, stats);
+      }
+      if (!supported) {
+        break;
+      }
+    }
+    if (!supported) {
+      record.buffer = -1;
+    }
+  }
+  op_records_.push_back(std::move(record));
+}
+
+float* VMDebugger::ReserveSummary(const Device& device, OpRecord* record) {
+  // The buffers are filled in order, so the first one of the device with free summaries is used.
+  int buffer = -1;
+  for (int i = 0; i < static_cast<int>(summary_buffers_.size()); ++i) {
+    auto& b = summary_buffers_[i];
+    if (b.device == device && b.used < kSummariesPerBuffer) {
+      buffer = i;
+      break;
+    }
+  }
+  if (buffer == -1) {
+    auto memory = memory_pool::Memory::Alloc(device, kSummariesPerBuffer * 4 * sizeof(float));
+    summary_buffers_.push_back(SummaryBuffer{device, memory, 0});
+    buffer = summary_buffers_.size() - 1;
+  }
+  auto& b = summary_buffers_[buffer];
+  record->buffer = buffer;
+  record->index = b.used++;
+  return static_cast<float*>(b.memory->data) + record->index * 4;
+}
+
+Map<String, ObjectRef> VMDebugger::GetOpSummaries() {
+  CHECK(lightweight_) << "The op summaries are only recorded in the lightweight mode";
+  CHECK_EQ(op_records_.size(), op_names_.size());
+  // Read back all used summaries at once.
+  std::vector<std::vector<float>> host_buffers(summary_buffers_.size());
+  for (size_t i = 0; i < summary_buffers_.size(); ++i) {
+    const auto& b = summary_buffers_[i];
+    host_buffers[i].resize(b.used * 4);
+    if (b.used == 0) {
+      continue;
+    }
+    if (b.device.device_type() == DevType::kCUDA()) {
+      auto api = device_api::DeviceAPI::Get(DevType::kCUDA());
+      api->WaitDevice(b.device);
+      int64_t shape = b.used * 4;
+      DLTensor from{b.memory->data, b.device, 1, DataType::Float(32), &shape, nullptr, 0};
+      DLTensor to{host_buffers[i].data(), host_device_, 1, DataType::Float(32), &shape, nullptr,
+                  0};
+      api->CopyDataFromTo(&from, &to);
+      api->WaitDevice(b.device);
+    } else {
+      std::memcpy(host_buffers[i].data(), b.memory->data, b.used * 4 * sizeof(float));
+    }
+  }
+
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  Array<FloatValue> latency, min_vals, max_vals, nan_counts, l2_norms;
+  for (const auto& record : op_records_) {
+    double ms = record.host_ms;
+    if (record.start != nullptr) {
+      ms = device_api::DeviceAPI::Get(DevType::kCUDA())
+               ->EventElapsedTimeInMilliSeconds(record.start->data(), record.end->data());
+    }
+    latency.push_back(FloatValue::make(DataType::Float(64), ms));
+    const float* stats =
+        record.buffer >= 0 ? host_buffers[record.buffer].data() + record.index * 4 : nullptr;
+    min_vals.push_back(FloatValue::make(DataType::Float(64), stats ? stats[0] : nan));
+    max_vals.push_back(FloatValue::make(DataType::Float(64), stats ? stats[1] : nan));
+    nan_counts.push_back(FloatValue::make(DataType::Float(64), stats ? stats[2] : nan));
+    l2_norms.push_back(FloatValue::make(DataType::Float(64), stats ? std::sqrt(stats[3]) : nan));
+  }
+  Map<String, ObjectRef> res{{"names", op_names_}, {"latency", latency}, {"min", min_vals},
+                             {"max", max_vals},      {"nan_count", nan_counts}, {"l2", l2_norms}};
+  return res;
+}
+
+tvm::runtime::Module CreateVMDebugger(const Executable* exec, bool lightweight) {
+  auto vm = make_object<VMDebugger>(lightweight);
   vm->LoadExecutable(exec);
   return tvm::runtime::Module(vm);
 }
@@ -128,7 +340,8 @@ RAF_REGISTER_GLOBAL("raf.vm.VMDebugger").set_body([](tvm::TVMArgs args, tvm::TVM
   tvm::runtime::Module mod = args[0];
   const auto* exec = dynamic_cast<Executable*>(mod.operator->());
   CHECK(exec) << "The virtual machine executable has not been defined yet.";
-  *rv = CreateVMDebugger(exec);
+  bool lightweight = args.size() > 1 && static_cast<bool>(args[1]);
+  *rv = CreateVMDebugger(exec, lightweight);
 });
 
 }  // namespace vm
@@ -14,15 +14,26 @@
 #include <unordered_map>
 #include <vector>
 
+#include "raf/event_pool.h"
+#include "raf/memory_pool.h"
 #include "raf/vm/vm.h"
 
 namespace raf {
 namespace executor {
 namespace vm {
 
+/*!
+ * \brief The VM debugger, which copies the inputs and the output of each op to the host. In the
+ * lightweight mode, it instead records the events around each op for the on-device timing, and
+ * summarizes the output of each op (min, max, number of NaNs and L2 norm) into the preallocated
+ * buffers on its device, which are read back once by get_op_summaries. So it does not synchronize
+ * the devices between the ops, and works on production-size models.
+ */
 class VMDebugger : public VirtualMachine {
  public:
-  VMDebugger() : VirtualMachine(false, false) {
+  VMDebugger(bool lightweight = false) : VirtualMachine(false, false), lightweight_(lightweight) {
+    // The debugger overrides HandleInvokeJit, so the fast dispatch loop cannot be used.
+    fast_dispatch_ = false;
   }
 
   PackedFunc GetFunction(const std::string& name, const ObjectPtr<Object>& sptr_to_self) final;
@@ -31,6 +42,46 @@ class VMDebugger : public VirtualMachine {
   void HandleInvokeJit(VMContext& ctx, const Instruction& instr) final;
 
  private:
+  /*! \brief The number of the summaries in a buffer. */
+  static constexpr int kSummariesPerBuffer = 4096;
+
+  /*! \brief A buffer of the summaries, each of which has 4 floats (see tensor_stats_cuda). */
+  struct SummaryBuffer {
+    Device device;
+    std::shared_ptr<memory_pool::Memory> memory;
+    int used;
+  };
+
+  /*! \brief The timing and the output summary of an op call in the lightweight mode. */
+  struct OpRecord {
+    /*! \brief The events around the op on its stream, or nullptr on the CPU. */
+    std::shared_ptr<event_pool::Event> start, end;
+    /*! \brief The latency in milliseconds measured on the host, if on the CPU. */
+    double host_ms = 0;
+    /*! \brief The index of the summary buffer, or -1 if the output is not summarized. */
+    int buffer = -1;
+    /*! \brief The index of the summary in the buffer. */
+    int index = 0;
+  };
+
+  /*! \brief Launch the op, and record its timing and the summary of its output. */
+  void RecordOp(VMContext& ctx, const OpEnvPtr& op_env, const std::vector<Value>& inputs,
+                const Value& output, const std::string& op_env_cache_key);
+  /*! \brief Reserve a summary on the device, and return its address. */
+  float* ReserveSummary(const Device& device, OpRecord* record);
+  /*!
+   * \brief Read back the summaries of the recorded ops, which waits for the devices.
+   * \return A map from "names", "latency" (in milliseconds), "min", "max", "nan_count" and "l2"
+   * to the arrays in the order of the op calls. The summaries are NaNs if not available.
+   */
+  Map<String, ObjectRef> GetOpSummaries();
+
+  /*! \brief Whether to record the timings and the summaries instead of the tensors. */
+  bool lightweight_;
+  /*! \brief The summary buffers, which are kept across the runs. */
+  std::vector<SummaryBuffer> summary_buffers_;
+  /*! \brief The records of the op calls in the lightweight mode. */
+  std::vector<OpRecord> op_records_;
   /*! \brief the number of times of op call */
   std::unordered_map<OpEnv*, int> op_invokes_;
   /*! \brief the input and output shape string of op call */
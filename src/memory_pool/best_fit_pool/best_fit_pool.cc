@@ -0,0 +1,402 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/memory_pool/best_fit_pool/best_fit_pool.cc
+ * \brief A memory pool that carves best-fit blocks from large device segments.
+ */
+#include <algorithm>
+#include <mutex>
+#include <set>
+#include "raf/device_api.h"
+#include "raf/memory_pool.h"
+#include "raf/registry.h"
+
+namespace raf {
+namespace memory_pool {
+namespace best_fit_pool {
+
+using device_api::DeviceAPI;
+
+/*! \brief The granularity (and the alignment) of every block in bytes. */
+constexpr int64_t kBlockSize = 512;
+/*! \brief Requests up to this size are served from small segments. */
+constexpr int64_t kSmallRequestSize = 1 << 20;
+/*! \brief The size of a small segment. */
+constexpr int64_t kSmallSegmentSize = 2 << 20;
+/*! \brief Large segments are rounded up to a multiple of this size. */
+constexpr int64_t kLargeSegmentUnit = 2 << 20;
+
+/*!
+ * \brief A contiguous piece of a segment. Blocks in the same segment form a doubly linked list
+ * ordered by address, so that a freed block can be merged with its free neighbours.
+ */
+struct Block {
+  Block(char* ptr, int64_t size, bool is_small) : ptr(ptr), size(size), is_small(is_small) {
+  }
+
+  /*! \brief The start address of this block. */
+  char* ptr;
+  /*! \brief The size of this block in bytes. */
+  int64_t size;
+  /*! \brief Whether this block belongs to a small segment. */
+  bool is_small;
+  /*! \brief Whether this block is handed out to the user. */
+  bool allocated = false;
+  /*! \brief The previous block in the same segment. */
+  Block* prev = nullptr;
+  /*! \brief The next block in the same segment. */
+  Block* next = nullptr;
+};
+
+/*! \brief Order free blocks by size first and then by address, so lower_bound gives best fit. */
+struct BlockComparator {
+  bool operator()(const Block* lhs, const Block* rhs) const {
+    if (lhs->size != rhs->size) {
+      return lhs->size < rhs->size;
+    }
+    return reinterpret_cast<uintptr_t>(lhs->ptr) < reinterpret_cast<uintptr_t>(rhs->ptr);
+  }
+};
+
+/*!
+ * \brief The allocator that owns all segments of a device. It is shared by the pool and all
+ * memory chunks handed out, so that chunks can still be returned after the pool is removed.
+ */
+class BestFitAllocator {
+ public:
+  BestFitAllocator(const Device& dev, std::shared_ptr<DeviceAPI> api, int64_t max_pool_size)
+      : device_(dev), api_(std::move(api)), max_pool_size_(max_pool_size) {
+  }
+
+  ~BestFitAllocator() {
+    // All chunks hold a reference to the allocator, so every block is free at this point.
+    ReleaseFreeSegments();
+  }
+
+  /*!
+   * \brief Get a block with at least nbytes bytes. Returns nullptr if the device is out of memory.
+   * \param nbytes The requested size, which must be a multiple of kBlockSize.
+   */
+  Block* Malloc(int64_t nbytes) {
+    std::lock_guard<std::mutex> lock(mu_);
+    bool is_small = nbytes <= kSmallRequestSize;
+    auto& free_blocks = free_blocks_[is_small];
+
+    Block* block = nullptr;
+    Block key(nullptr, nbytes, is_small);
+    auto it = free_blocks.lower_bound(&key);
+    if (it != free_blocks.end()) {
+      block = *it;
+      free_blocks.erase(it);
+    } else {
+      block = AllocSegment(nbytes, is_small);
+      if (block == nullptr) {
+        return nullptr;
+      }
+    }
+
+    // Split the block if the remaining part is large enough to serve other requests.
+    if (block->size - nbytes >= kBlockSize) {
+      Block* remaining = new Block(block->ptr + nbytes, block->size - nbytes, is_small);
+      remaining->prev = block;
+      remaining->next = block->next;
+      if (block->next != nullptr) {
+        block->next->prev = remaining;
+      }
+      block->next = remaining;
+      block->size = nbytes;
+      free_blocks.insert(remaining);
+    }
+    block->allocated = true;
+    allocated_bytes_ += block->size;
+    peak_bytes_ = std::max(peak_bytes_, allocated_bytes_);
+    return block;
+  }
+
+  /*! \brief Return the free segments to the device and return the released memory in bytes. */
+  int64_t Trim() {
+    std::lock_guard<std::mutex> lock(mu_);
+    return ReleaseFreeSegments();
+  }
+
+  /*!
+   * \brief Return the free segments to the device, and reserve a large segment of reserve_bytes
+   * whose blocks serve the following large requests.
+   * \return The released memory in bytes.
+   */
+  int64_t Compact(int64_t reserve_bytes) {
+    std::lock_guard<std::mutex> lock(mu_);
+    int64_t total_free = ReleaseFreeSegments();
+    if (reserve_bytes > kSmallRequestSize) {
+      // Failing to reserve is fine, as the requests allocate their own segments as usual.
+      Block* segment = AllocSegment(reserve_bytes, false);
+      if (segment != nullptr) {
+        free_blocks_[false].insert(segment);
+      }
+    }
+    return total_free;
+  }
+
+  /*! \brief Get the peak allocated bytes since the last call and reset it. */
+  int64_t ResetPeak() {
+    std::lock_guard<std::mutex> lock(mu_);
+    int64_t peak = peak_bytes_;
+    peak_bytes_ = allocated_bytes_;
+    return peak;
+  }
+
+  /*! \brief Return a block to the free list and coalesce it with its free neighbours. */
+  void Free(Block* block) {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto& free_blocks = free_blocks_[block->is_small];
+    block->allocated = false;
+    allocated_bytes_ -= block->size;
+    if (block->prev != nullptr && !block->prev->allocated) {
+      Block* prev = block->prev;
+      free_blocks.erase(prev);
+      prev->size += block->size;
+      prev->next = block->next;
+      if (block->next != nullptr) {
+        block->next->prev = prev;
+      }
+      delete block;
+      block = prev;
+    }
+    if (block->next != nullptr && !block->next->allocated) {
+      Block* next = block->next;
+      free_blocks.erase(next);
+      block->size += next->size;
+      block->next = next->next;
+      if (next->next != nullptr) {
+        next->next->prev = block;
+      }
+      delete next;
+    }
+    free_blocks.insert(block);
+  }
+
+  /*!
+   * \brief Return the segments that are completely free back to the device.
+   * \return The released memory in bytes.
+   */
+  int64_t ReleaseFreeSegments() {
+    int64_t total_free = 0;
+    for (auto& free_blocks : free_blocks_) {
+      for (auto it = free_blocks.begin(); it != free_blocks.end();) {
+        Block* block = *it;
+        if (block->prev == nullptr && block->next == nullptr) {
+          api_->FreeMemory(block->ptr);
+          total_free += block->size;
+          delete block;
+          it = free_blocks.erase(it);
+        } else {
+          ++it;
+        }
+      }
+    }
+    reserved_bytes_ -= total_free;
+    return total_free;
+  }
+
+  /*! \brief Get the number of (allocated, reserved) bytes. */
+  std::pair<int64_t, int64_t> GetUsage() {
+    std::lock_guard<std::mutex> lock(mu_);
+    return {allocated_bytes_, reserved_bytes_};
+  }
+
+ private:
+  inline void* AllocDeviceMemory(int64_t nbytes) {
+    try {
+      return api_->AllocMemory(nbytes, kBlockSize);
+    } catch (const dmlc::Error& e) {
+      return nullptr;
+    } catch (const std::bad_alloc& e) {
+      return nullptr;
+    }
+  }
+
+  /*! \brief Allocate a new segment from the device to serve a request of nbytes. */
+  Block* AllocSegment(int64_t nbytes, bool is_small) {
+    int64_t segment_size = is_small ? kSmallSegmentSize
+                                    : (nbytes + kLargeSegmentUnit - 1) / kLargeSegmentUnit *
+                                          kLargeSegmentUnit;
+    // Exceed the user-specified limitation, return the free segments first.
+    if (max_pool_size_ > 0 && reserved_bytes_ + segment_size > max_pool_size_) {
+      ReleaseFreeSegments();
+    }
+    void* data = AllocDeviceMemory(segment_size);
+    if (data == nullptr) {
+      int64_t free_nbytes = ReleaseFreeSegments();
+      DLOG(WARNING) << "Failed to allocate a segment of " << segment_size
+                    << " bytes. Released " << free_nbytes << " bytes of free segments";
+      if (free_nbytes > 0) {
+        data = AllocDeviceMemory(segment_size);
+      }
+    }
+    if (data == nullptr) {
+      return nullptr;
+    }
+    reserved_bytes_ += segment_size;
+    return new Block(static_cast<char*>(data), segment_size, is_small);
+  }
+
+  /*! \brief The device of this allocator. */
+  Device device_;
+  /*! \brief The pointer to the DeviceAPI which determines the context of memory. */
+  std::shared_ptr<DeviceAPI> api_;
+  /*! \brief The maximum allowed size (bytes) of all segments. 0 means no limit. */
+  int64_t max_pool_size_;
+  /*! \brief The free blocks of large (index 0) and small (index 1) segments. */
+  std::set<Block*, BlockComparator> free_blocks_[2];
+  /*! \brief The total size of the blocks handed out to users. */
+  int64_t allocated_bytes_ = 0;
+  /*! \brief The peak of allocated_bytes_ since the last ResetPeak. */
+  int64_t peak_bytes_ = 0;
+  /*! \brief The total size of the segments allocated from the device. */
+  int64_t reserved_bytes_ = 0;
+  /*! \brief The mutex to protect blocks and free lists. */
+  std::mutex mu_;
+};
+
+/*!
+ * \brief A wrapper which holds a block carved from a segment. The block is returned to the
+ * allocator when the wrapper is destructed.
+ */
+class BlockMemory final : public Memory {
+ public:
+  explicit BlockMemory(void* data, const Device& dev, Block* block,
+                       std::shared_ptr<BestFitAllocator> allocator)
+      : block(block), allocator(std::move(allocator)) {
+    this->data = data;
+    this->device = dev;
+  }
+
+  ~BlockMemory() {
+    if (block != nullptr) {
+      allocator->Free(block);
+    }
+  }
+
+ public:
+  /*! \brief The block that holds the memory. */
+  Block* block;
+  /*! \brief The allocator that the block belongs to. */
+  std::shared_ptr<BestFitAllocator> allocator;
+};
+
+/*!
+ * \brief A Memory Pool that allocates large segments from the device and carves them into blocks.
+ *
+ * Unlike PageUnitPool that only reuses a chunk with exactly the same size, this pool keeps the
+ * free blocks in an ordered set and serves a request with the smallest free block that is large
+ * enough. The block is split if the remaining part is still usable, and freed blocks are merged
+ * with their free neighbours in the same segment. This keeps the reserved memory close to the
+ * peak usage when the requested sizes vary a lot (e.g., dynamic sequence lengths).
+ *
+ * Requests no larger than 1MB are served from 2MB segments, and larger requests are served from
+ * segments rounded up to 2MB, so that small blocks do not fragment the large segments.
+ *
+ * \sa BestFitPool
+ */
+class BestFitPool final : public MemoryPool {
+ public:
+  explicit BestFitPool(Device dev, int64_t pool_limit = 0) {
+    this->device = dev;
+    this->api = DeviceAPI::Get(dev.device_type());
+
+    if (dev.device_type() == DevType::kCUDA()) {
+      this->api->SetDevice(dev.device_id());
+    }
+    allocator = std::make_shared<BestFitAllocator>(dev, api, pool_limit);
+  }
+
+  std::string GetName() {
+    return "best_fit_pool";
+  }
+
+  int64_t GetAllocBytes(int64_t nbytes) override {
+    return (nbytes + kBlockSize - 1) / kBlockSize * kBlockSize;
+  }
+
+  std::shared_ptr<Memory> Alloc(int64_t nbytes, int64_t alignment) override {
+    CHECK_GE(nbytes, 0);
+    if (nbytes == 0) {
+      return std::make_shared<BlockMemory>(nullptr, device, nullptr, allocator);
+    }
+    // Blocks are aligned to kBlockSize, so larger alignments are served by padding.
+    int64_t padding = alignment > kBlockSize ? alignment - kBlockSize : 0;
+    Block* block = allocator->Malloc(GetAllocBytes(nbytes + padding));
+    if (block == nullptr) {
+      int64_t used, allocated;
+      std::tie(used, allocated) = allocator->GetUsage();
+      LOG(FATAL) << "Out-Of-Memory. Tried to allocate " << BytesToMegaBytes(nbytes)
+                 << " MBs; Already allocated " << BytesToMegaBytes(allocated) << " MBs and used "
+                 << BytesToMegaBytes(used) << " MBs";
+      throw;
+    }
+    uintptr_t address = reinterpret_cast<uintptr_t>(block->ptr);
+    address = (address + alignment - 1) / alignment * alignment;
+    return std::make_shared<BlockMemory>(reinterpret_cast<void*>(address), device, block,
+                                         allocator);
+  }
+
+  std::shared_ptr<Memory> AllocAsync(int64_t nbytes, void* stream,
+                                     int64_t alignment = kDefaultMemoryAlignment) override {
+    LOG(FATAL) << "Please use NoPool to use AllocAsync.";
+    throw;
+  }
+
+  std::vector<std::shared_ptr<Memory>> AllocBatch(const std::vector<int64_t>& nbytes,
+                                                  int64_t alignment) override {
+    std::vector<std::shared_ptr<Memory>> ret;
+    ret.reserve(nbytes.size());
+    for (int64_t bytes : nbytes) {
+      ret.emplace_back(Alloc(bytes, alignment));
+    }
+    return ret;
+  }
+
+  std::pair<float, float> GetPoolSize() override {
+    auto ret = allocator->GetUsage();
+    return std::make_pair(BytesToMegaBytes(ret.first), BytesToMegaBytes(ret.second));
+  }
+
+  int64_t FreeUnused() override {
+    return allocator->Trim();
+  }
+
+  int64_t ResetPeakUsed() override {
+    return allocator->ResetPeak();
+  }
+
+  int64_t Compact(int64_t reserve_bytes) override {
+    return allocator->Compact(reserve_bytes);
+  }
+
+ public:
+  static void* make(const Device& dev) {
+    int64_t max_pool_limit = 0;
+    if (const char* val = getenv("RAF_MEMORY_POOL_SIZE_LIMIT")) {
+      max_pool_limit = atol(val);
+    }
+    return new BestFitPool(dev, max_pool_limit);
+  }
+
+ protected:
+  Device device;
+  /*! \brief The pointer to the DeviceAPI which determines the context of memory. */
+  std::shared_ptr<DeviceAPI> api;
+  /*! \brief The allocator that manages segments and blocks. */
+  std::shared_ptr<BestFitAllocator> allocator;
+};
+
+RAF_REGISTER_GLOBAL("raf.memory_pool._make.best_fit_pool").set_body_typed([](const Device& dev) {
+  return BestFitPool::make(dev);
+});
+
+}  // namespace best_fit_pool
+}  // namespace memory_pool
+}  // namespace raf
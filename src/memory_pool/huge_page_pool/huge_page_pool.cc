@@ -0,0 +1,320 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/memory_pool/huge_page_pool/huge_page_pool.cc
+ * \brief A CPU memory pool that serves the large allocations from huge pages on the NUMA node of
+ * the allocating thread.
+ */
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <utility>
+#include <vector>
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#include "raf/device_api.h"
+#include "raf/memory_pool.h"
+#include "raf/registry.h"
+
+namespace raf {
+namespace memory_pool {
+namespace huge_page_pool {
+
+using device_api::DeviceAPI;
+using registry::GetPackedFunc;
+
+/*! \brief The size of a huge page. */
+constexpr int64_t kHugePageSize = 2 << 20;
+
+/*! \brief The memory policy that prefers to allocate the pages on the given nodes (see mbind). */
+constexpr int kMPolPreferred = 1;
+
+/*! \brief Get the NUMA node of the CPU that the calling thread runs on, or -1 if unknown. */
+inline int CurrentNumaNode() {
+#if defined(__linux__) && defined(SYS_getcpu)
+  unsigned cpu = 0, node = 0;
+  if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0) {
+    return static_cast<int>(node);
+  }
+#endif
+  return -1;
+}
+
+/*!
+ * \brief The huge page regions owned by a huge page pool. The regions are cached by their sizes
+ * and NUMA nodes after they are released, and are unmapped together with the last reference of
+ * this object, so the regions in use are still returned correctly after the pool is removed.
+ */
+class HugePageCache {
+ public:
+  explicit HugePageCache(bool explicit_huge_pages) : explicit_huge_pages_(explicit_huge_pages) {
+  }
+
+  ~HugePageCache() {
+    FreeAll();
+  }
+
+  /*!
+   * \brief Get a region of nbytes on the given node, where nbytes must be a multiple of the huge
+   * page size. Returns nullptr if out of memory.
+   */
+  void* Pop(int64_t nbytes, int node) {
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      auto it = free_lists_.find({nbytes, node});
+      if (it != free_lists_.end() && !it->second.empty()) {
+        void* ptr = it->second.back();
+        it->second.pop_back();
+        used_bytes_ += nbytes;
+        return ptr;
+      }
+    }
+    void* ptr = Map(nbytes, node);
+    if (ptr == nullptr && FreeAll() > 0) {
+      ptr = Map(nbytes, node);
+    }
+    if (ptr != nullptr) {
+      std::lock_guard<std::mutex> lock(mu_);
+      used_bytes_ += nbytes;
+      pool_bytes_ += nbytes;
+    }
+    return ptr;
+  }
+
+  /*! \brief Put a region released by the user back to the free list of its size and node. */
+  void Push(void* ptr, int64_t nbytes, int node) {
+    std::lock_guard<std::mutex> lock(mu_);
+    used_bytes_ -= nbytes;
+    free_lists_[{nbytes, node}].push_back(ptr);
+  }
+
+  /*! \brief Unmap all cached regions and return the freed memory in bytes. */
+  int64_t FreeAll() {
+    std::lock_guard<std::mutex> lock(mu_);
+    int64_t total_free = 0;
+    for (auto& kv : free_lists_) {
+      for (void* ptr : kv.second) {
+        Unmap(ptr, kv.first.first);
+      }
+      total_free += kv.first.first * kv.second.size();
+    }
+    free_lists_.clear();
+    pool_bytes_ -= total_free;
+    return total_free;
+  }
+
+  /*! \brief Get the total size of (used regions, pool) in bytes. */
+  std::pair<int64_t, int64_t> GetSize() {
+    std::lock_guard<std::mutex> lock(mu_);
+    return {used_bytes_, pool_bytes_};
+  }
+
+ private:
+  /*!
+   * \brief Map a region aligned to the huge page size. The explicit huge pages (hugetlbfs) are
+   * used if requested and reserved, and otherwise the region is backed by the transparent huge
+   * pages. The region prefers, rather than binds to, the given node, so the pages can still come
+   * from the other nodes when the node is full.
+   */
+  void* Map(int64_t nbytes, int node) {
+#ifdef __linux__
+    void* ptr = MAP_FAILED;
+#ifdef MAP_HUGETLB
+    if (explicit_huge_pages_) {
+      ptr = mmap(nullptr, nbytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+                 -1, 0);
+    }
+#endif
+    if (ptr == MAP_FAILED) {
+      // Over-map by a huge page and trim both ends, because mmap only aligns to the base pages.
+      int64_t mapped_bytes = nbytes + kHugePageSize;
+      char* base = static_cast<char*>(
+          mmap(nullptr, mapped_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+      if (base == MAP_FAILED) {
+        return nullptr;
+      }
+      uintptr_t address = reinterpret_cast<uintptr_t>(base);
+      char* aligned = reinterpret_cast<char*>((address + kHugePageSize - 1) / kHugePageSize *
+                                              kHugePageSize);
+      if (aligned > base) {
+        munmap(base, aligned - base);
+      }
+      size_t tail = base + mapped_bytes - (aligned + nbytes);
+      if (tail > 0) {
+        munmap(aligned + nbytes, tail);
+      }
+      ptr = aligned;
+#ifdef MADV_HUGEPAGE
+      madvise(ptr, nbytes, MADV_HUGEPAGE);
+#endif
+    }
+#ifdef SYS_mbind
+    if (node >= 0 && node < 64) {
+      unsigned long nodemask = 1UL << node;
+      syscall(SYS_mbind, ptr, nbytes, kMPolPreferred, &nodemask, sizeof(nodemask) * 8, 0);
+    }
+#endif
+    return ptr;
+#else
+    void* ptr = nullptr;
+    return posix_memalign(&ptr, kHugePageSize, nbytes) == 0 ? ptr : nullptr;
+#endif
+  }
+
+  void Unmap(void* ptr, int64_t nbytes) {
+#ifdef __linux__
+    munmap(ptr, nbytes);
+#else
+    free(ptr);
+#endif
+  }
+
+  /*! \brief Whether to use the explicit huge pages. */
+  bool explicit_huge_pages_;
+  /*! \brief The cached regions keyed by their sizes and nodes. */
+  std::map<std::pair<int64_t, int>, std::vector<void*>> free_lists_;
+  /*! \brief The total size of the regions in use. */
+  int64_t used_bytes_ = 0;
+  /*! \brief The total size of the regions mapped by this cache. */
+  int64_t pool_bytes_ = 0;
+  /*! \brief The mutex to access the free lists and the sizes. */
+  std::mutex mu_;
+};
+
+/*! \brief A region of huge pages, which goes back to the cache when released. */
+class HugePageMemory final : public Memory {
+ public:
+  HugePageMemory(void* data, int64_t nbytes, int node, const Device& dev,
+                 std::shared_ptr<HugePageCache> cache)
+      : nbytes_(nbytes), node_(node), cache_(std::move(cache)) {
+    this->data = data;
+    this->device = dev;
+  }
+
+  ~HugePageMemory() {
+    cache_->Push(data, nbytes_, node_);
+  }
+
+ private:
+  /*! \brief The size of the region in bytes. */
+  int64_t nbytes_;
+  /*! \brief The NUMA node that the region prefers. */
+  int node_;
+  /*! \brief The cache that owns the region. */
+  std::shared_ptr<HugePageCache> cache_;
+};
+
+/*!
+ * \brief A CPU memory pool for the large tensors, e.g., on multi-socket inference hosts. The
+ * allocations no smaller than the threshold are rounded up to 2MB huge pages, which reduces the
+ * TLB misses, and are preferably placed on the NUMA node of the allocating thread. Pairing it with
+ * worker threads pinned to the same node (e.g., TVM_BIND_THREADS and TVM_NUM_THREADS for the TVM
+ * CPU kernels) avoids the remote memory accesses. The smaller allocations are served by a page
+ * unit pool.
+ *
+ * The threshold is set by RAF_HUGE_PAGE_THRESHOLD in bytes (2MB by default), and the explicit
+ * huge pages reserved in hugetlbfs are used if RAF_HUGE_PAGE_EXPLICIT=1.
+ */
+class HugePagePool final : public MemoryPool {
+ public:
+  HugePagePool(Device dev, int64_t threshold, bool explicit_huge_pages)
+      : device_(dev), threshold_(threshold) {
+    CHECK(dev.device_type() == DevType::kCPU()) << "huge_page_pool only supports the CPU";
+    cache_ = std::make_shared<HugePageCache>(explicit_huge_pages);
+    void* small_pool = GetPackedFunc("raf.memory_pool._make.page_unit_pool")(dev);
+    small_pool_.reset(static_cast<MemoryPool*>(small_pool));
+  }
+
+  std::string GetName() {
+    return "huge_page_pool";
+  }
+
+  int64_t GetAllocBytes(int64_t nbytes) override {
+    if (nbytes < threshold_) {
+      return small_pool_->GetAllocBytes(nbytes);
+    }
+    return (nbytes + kHugePageSize - 1) / kHugePageSize * kHugePageSize;
+  }
+
+  std::shared_ptr<Memory> Alloc(int64_t nbytes, int64_t alignment) override {
+    CHECK_GE(nbytes, 0);
+    if (nbytes < threshold_) {
+      return small_pool_->Alloc(nbytes, alignment);
+    }
+    CHECK_EQ(kHugePageSize % alignment, 0) << "Alignment " << alignment << " is not supported";
+    nbytes = GetAllocBytes(nbytes);
+    int node = CurrentNumaNode();
+    void* data = cache_->Pop(nbytes, node);
+    if (data == nullptr) {
+      float used, allocated;
+      std::tie(used, allocated) = GetPoolSize();
+      LOG(FATAL) << "Out-Of-Memory. Tried to allocate " << BytesToMegaBytes(nbytes)
+                 << " MBs; Already allocated " << allocated << " MBs and used " << used << " MBs";
+      throw;
+    }
+    return std::make_shared<HugePageMemory>(data, nbytes, node, device_, cache_);
+  }
+
+  std::shared_ptr<Memory> AllocAsync(int64_t nbytes, void* stream,
+                                     int64_t alignment = kDefaultMemoryAlignment) override {
+    LOG(FATAL) << "Please use NoPool to use AllocAsync.";
+    throw;
+  }
+
+  std::vector<std::shared_ptr<Memory>> AllocBatch(const std::vector<int64_t>& nbytes,
+                                                  int64_t alignment) override {
+    std::vector<std::shared_ptr<Memory>> ret;
+    ret.reserve(nbytes.size());
+    for (int64_t bytes : nbytes) {
+      ret.emplace_back(Alloc(bytes, alignment));
+    }
+    return ret;
+  }
+
+  std::pair<float, float> GetPoolSize() override {
+    auto small = small_pool_->GetPoolSize();
+    auto huge = cache_->GetSize();
+    return std::make_pair(small.first + BytesToMegaBytes(huge.first),
+                          small.second + BytesToMegaBytes(huge.second));
+  }
+
+  int64_t FreeUnused() override {
+    return small_pool_->FreeUnused() + cache_->FreeAll();
+  }
+
+ public:
+  static void* make(const Device& dev) {
+    int64_t threshold = kHugePageSize;
+    if (const char* val = getenv("RAF_HUGE_PAGE_THRESHOLD")) {
+      threshold = atol(val);
+    }
+    const char* explicit_val = getenv("RAF_HUGE_PAGE_EXPLICIT");
+    bool explicit_huge_pages = explicit_val != nullptr && strcmp(explicit_val, "1") == 0;
+    return new HugePagePool(dev, threshold, explicit_huge_pages);
+  }
+
+ private:
+  Device device_;
+  /*! \brief The minimum size in bytes of the allocations served by the huge pages. */
+  int64_t threshold_;
+  /*! \brief The cache of the huge page regions. */
+  std::shared_ptr<HugePageCache> cache_;
+  /*! \brief The pool of the small allocations. */
+  std::unique_ptr<MemoryPool> small_pool_;
+};
+
+RAF_REGISTER_GLOBAL("raf.memory_pool._make.huge_page_pool").set_body_typed([](const Device& dev) {
+  return HugePagePool::make(dev);
+});
+
+}  // namespace huge_page_pool
+}  // namespace memory_pool
+}  // namespace raf
@@ -0,0 +1,224 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/memory_pool/managed_pool/managed_pool.cc
+ * \brief A CUDA memory pool backed by the unified memory, which can oversubscribe the device.
+ */
+#ifdef RAF_USE_CUDA
+#include <cuda_runtime.h>
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "raf/device.h"
+#include "raf/memory_pool.h"
+#include "raf/registry.h"
+
+namespace raf {
+namespace memory_pool {
+namespace managed_pool {
+
+/*! \brief The allocation granularity of the small regions. */
+constexpr int64_t kSmallPageSize = 4096;
+
+/*! \brief The allocation granularity of the large regions, which is the migration unit. */
+constexpr int64_t kLargePageSize = 2 << 20;
+
+/*!
+ * \brief The managed regions owned by a managed pool. The regions are cached by their sizes after
+ * they are released, because cudaFree synchronizes the device, and are freed together with the
+ * last reference of this object.
+ */
+class ManagedCache {
+ public:
+  explicit ManagedCache(int device_id) : device_id_(device_id) {
+  }
+
+  ~ManagedCache() {
+    FreeAll();
+  }
+
+  /*! \brief Get a region of nbytes. Returns nullptr if out of memory. */
+  void* Pop(int64_t nbytes) {
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      auto it = free_lists_.find(nbytes);
+      if (it != free_lists_.end() && !it->second.empty()) {
+        void* ptr = it->second.back();
+        it->second.pop_back();
+        used_bytes_ += nbytes;
+        return ptr;
+      }
+    }
+    void* ptr = Malloc(nbytes);
+    if (ptr == nullptr && FreeAll() > 0) {
+      ptr = Malloc(nbytes);
+    }
+    if (ptr != nullptr) {
+      std::lock_guard<std::mutex> lock(mu_);
+      used_bytes_ += nbytes;
+      pool_bytes_ += nbytes;
+    }
+    return ptr;
+  }
+
+  /*! \brief Put a region released by the user back to the free list of its size. */
+  void Push(void* ptr, int64_t nbytes) {
+    std::lock_guard<std::mutex> lock(mu_);
+    used_bytes_ -= nbytes;
+    free_lists_[nbytes].push_back(ptr);
+  }
+
+  /*! \brief Free all cached regions and return the freed memory in bytes. */
+  int64_t FreeAll() {
+    std::lock_guard<std::mutex> lock(mu_);
+    int64_t total_free = 0;
+    for (auto& kv : free_lists_) {
+      for (void* ptr : kv.second) {
+        cudaFree(ptr);
+      }
+      total_free += kv.first * kv.second.size();
+    }
+    free_lists_.clear();
+    pool_bytes_ -= total_free;
+    return total_free;
+  }
+
+  /*! \brief Get the total size of (used regions, pool) in bytes. */
+  std::pair<int64_t, int64_t> GetSize() {
+    std::lock_guard<std::mutex> lock(mu_);
+    return {used_bytes_, pool_bytes_};
+  }
+
+ private:
+  void* Malloc(int64_t nbytes) {
+    void* ptr = nullptr;
+    cudaSetDevice(device_id_);
+    if (cudaMallocManaged(&ptr, nbytes, cudaMemAttachGlobal) != cudaSuccess) {
+      // Clear the sticky error of the failed allocation.
+      cudaGetLastError();
+      return nullptr;
+    }
+    return ptr;
+  }
+
+  /*! \brief The device that the regions are allocated for. */
+  int device_id_;
+  /*! \brief The cached regions keyed by their sizes. */
+  std::map<int64_t, std::vector<void*>> free_lists_;
+  /*! \brief The total size of the regions in use. */
+  int64_t used_bytes_ = 0;
+  /*! \brief The total size of the regions allocated by this cache. */
+  int64_t pool_bytes_ = 0;
+  /*! \brief The mutex to access the free lists and the sizes. */
+  std::mutex mu_;
+};
+
+/*! \brief A managed region, which goes back to the cache when released. */
+class ManagedMemory final : public Memory {
+ public:
+  ManagedMemory(void* data, int64_t nbytes, const Device& dev, std::shared_ptr<ManagedCache> cache)
+      : nbytes_(nbytes), cache_(std::move(cache)) {
+    this->data = data;
+    this->device = dev;
+  }
+
+  ~ManagedMemory() {
+    cache_->Push(data, nbytes_);
+  }
+
+ private:
+  /*! \brief The size of the region in bytes. */
+  int64_t nbytes_;
+  /*! \brief The cache that owns the region. */
+  std::shared_ptr<ManagedCache> cache_;
+};
+
+/*!
+ * \brief A CUDA memory pool that allocates the tensors with cudaMallocManaged, so the models
+ * slightly larger than the device memory still run: the driver migrates the pages between the
+ * device and the host on demand, instead of failing with out-of-memory. The page faults are
+ * mostly avoided by the prefetch and eviction hints inserted by the ManagedMemoryHint pass (see
+ * raf.managed_memory.prefetch_distance), which are no-ops for the tensors of the other pools.
+ */
+class ManagedPool final : public MemoryPool {
+ public:
+  explicit ManagedPool(Device dev) : device_(dev) {
+    CHECK(dev.device_type() == DevType::kCUDA()) << "managed_pool only supports CUDA";
+    cache_ = std::make_shared<ManagedCache>(dev.device_id());
+  }
+
+  std::string GetName() {
+    return "managed_pool";
+  }
+
+  int64_t GetAllocBytes(int64_t nbytes) override {
+    int64_t page = nbytes < kLargePageSize ? kSmallPageSize : kLargePageSize;
+    return (std::max<int64_t>(nbytes, 1) + page - 1) / page * page;
+  }
+
+  std::shared_ptr<Memory> Alloc(int64_t nbytes, int64_t alignment) override {
+    CHECK_GE(nbytes, 0);
+    CHECK_EQ(kSmallPageSize % alignment, 0) << "Alignment " << alignment << " is not supported";
+    nbytes = GetAllocBytes(nbytes);
+    void* data = cache_->Pop(nbytes);
+    if (data == nullptr) {
+      float used, allocated;
+      std::tie(used, allocated) = GetPoolSize();
+      LOG(FATAL) << "Out-Of-Memory. Tried to allocate " << BytesToMegaBytes(nbytes)
+                 << " MBs of managed memory; Already allocated " << allocated << " MBs and used "
+                 << used << " MBs";
+      throw;
+    }
+    return std::make_shared<ManagedMemory>(data, nbytes, device_, cache_);
+  }
+
+  std::shared_ptr<Memory> AllocAsync(int64_t nbytes, void* stream,
+                                     int64_t alignment = kDefaultMemoryAlignment) override {
+    LOG(FATAL) << "Please use NoPool to use AllocAsync.";
+    throw;
+  }
+
+  std::vector<std::shared_ptr<Memory>> AllocBatch(const std::vector<int64_t>& nbytes,
+                                                  int64_t alignment) override {
+    std::vector<std::shared_ptr<Memory>> ret;
+    ret.reserve(nbytes.size());
+    for (int64_t bytes : nbytes) {
+      ret.emplace_back(Alloc(bytes, alignment));
+    }
+    return ret;
+  }
+
+  std::pair<float, float> GetPoolSize() override {
+    auto size = cache_->GetSize();
+    return std::make_pair(BytesToMegaBytes(size.first), BytesToMegaBytes(size.second));
+  }
+
+  int64_t FreeUnused() override {
+    return cache_->FreeAll();
+  }
+
+ public:
+  static void* make(const Device& dev) {
+    return new ManagedPool(dev);
+  }
+
+ private:
+  Device device_;
+  /*! \brief The cache of the managed regions. */
+  std::shared_ptr<ManagedCache> cache_;
+};
+
+RAF_REGISTER_GLOBAL("raf.memory_pool._make.managed_pool").set_body_typed([](const Device& dev) {
+  return ManagedPool::make(dev);
+});
+
+}  // namespace managed_pool
+}  // namespace memory_pool
+}  // namespace raf
+#endif
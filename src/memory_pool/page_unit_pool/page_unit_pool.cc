@@ -7,7 +7,10 @@
  * \file src/memory_pool/page_unit_pool/page_unit_pool.cc
  * \brief A memory pool that use page as memory unit
  */
+#include <algorithm>
 #include <atomic>
+#include <mutex>
+#include <unordered_map>
 #include <tvm/relay/transform.h>
 #include "raf/device_api.h"
 #include "raf/memory_pool.h"
@@ -29,10 +32,12 @@ using device_api::DeviceAPI;
  */
 class NonOwnedMemory final : public Memory {
  public:
-  explicit NonOwnedMemory(void* data, const Device& dev, std::shared_ptr<DeviceAPI> api) {
+  explicit NonOwnedMemory(void* data, const Device& dev, std::shared_ptr<DeviceAPI> api,
+                          int64_t nbytes = 0) {
     this->data = data;
     this->device = dev;
     this->api = std::move(api);
+    this->nbytes = nbytes;
   }
 
   ~NonOwnedMemory() {
@@ -44,6 +49,104 @@ class NonOwnedMemory final : public Memory {
  public:
   /*! \brief The pointer to the DeviceAPI which determines the context of memory. */
   std::shared_ptr<DeviceAPI> api;
+  /*! \brief The size of the memory chunk in bytes. */
+  int64_t nbytes;
+};
+
+/*!
+ * \brief The free lists of the chunks owned by a page unit pool. A chunk handed out to the user
+ * holds a reference to this object through its deleter, and will be pushed back to the free list
+ * of its size when the user releases it. As a result, the chunks in use are still returned
+ * correctly after the pool is removed, and the free chunks are deconstructed together with the
+ * last reference of this object.
+ */
+class FreeChunkLists {
+ public:
+  ~FreeChunkLists() {
+    FreeAll();
+  }
+
+  /*!
+   * \brief Take a free chunk with the given size and alignment.
+   * \return The chunk, or nullptr if there is no such a chunk.
+   */
+  NonOwnedMemory* Pop(int64_t nbytes, int64_t alignment) {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto it = free_lists_.find(nbytes);
+    if (it == free_lists_.end()) {
+      return nullptr;
+    }
+    auto& chunks = it->second;
+    // Chunks are allocated with the default alignment in most cases, so the last chunk is taken
+    // immediately and the loop is only for a chunk allocated with a smaller alignment.
+    for (auto rit = chunks.rbegin(); rit != chunks.rend(); ++rit) {
+      NonOwnedMemory* chunk = *rit;
+      if (reinterpret_cast<int64_t>(chunk->data) % alignment == 0) {
+        *rit = chunks.back();
+        chunks.pop_back();
+        used_bytes_ += nbytes;
+        peak_bytes_ = std::max(peak_bytes_, used_bytes_);
+        return chunk;
+      }
+    }
+    return nullptr;
+  }
+
+  /*! \brief Add a chunk newly allocated from the device, which is in use. */
+  void Add(int64_t nbytes) {
+    std::lock_guard<std::mutex> lock(mu_);
+    used_bytes_ += nbytes;
+    pool_bytes_ += nbytes;
+    peak_bytes_ = std::max(peak_bytes_, used_bytes_);
+  }
+
+  /*! \brief Put a chunk released by the user back to the free list. */
+  void Push(NonOwnedMemory* chunk) {
+    std::lock_guard<std::mutex> lock(mu_);
+    used_bytes_ -= chunk->nbytes;
+    free_lists_[chunk->nbytes].push_back(chunk);
+  }
+
+  /*! \brief Free all chunks that are not in use and return the freed memory in bytes. */
+  int64_t FreeAll() {
+    std::lock_guard<std::mutex> lock(mu_);
+    int64_t total_free = 0;
+    for (auto& kv : free_lists_) {
+      for (NonOwnedMemory* chunk : kv.second) {
+        delete chunk;
+      }
+      total_free += kv.first * kv.second.size();
+    }
+    free_lists_.clear();
+    pool_bytes_ -= total_free;
+    return total_free;
+  }
+
+  /*! \brief Get the peak size of the used chunks since the last call and reset it. */
+  int64_t ResetPeak() {
+    std::lock_guard<std::mutex> lock(mu_);
+    int64_t peak = peak_bytes_;
+    peak_bytes_ = used_bytes_;
+    return peak;
+  }
+
+  /*! \brief Get the total size of (used chunks, pool) in bytes. */
+  std::pair<int64_t, int64_t> GetSize() {
+    std::lock_guard<std::mutex> lock(mu_);
+    return {used_bytes_, pool_bytes_};
+  }
+
+ private:
+  /*! \brief The free chunks grouped by their sizes. */
+  std::unordered_map<int64_t, std::vector<NonOwnedMemory*>> free_lists_;
+  /*! \brief The total size of the chunks in use. */
+  int64_t used_bytes_ = 0;
+  /*! \brief The peak of used_bytes_ since the last ResetPeak. */
+  int64_t peak_bytes_ = 0;
+  /*! \brief The total size of all chunks allocated from the device. */
+  int64_t pool_bytes_ = 0;
+  /*! \brief The mutex to protect the free lists, as chunks can be released by any thread. */
+  std::mutex mu_;
 };
 
 /*!
@@ -52,10 +155,12 @@ class NonOwnedMemory final : public Memory {
  *
  * In this pool, all memory chunck are divide into multiple groups by the number of memory pages.
  * When user request a chunck of memory with size N, the pool will first find whether there is
- * available memory chunck with the same size in this pool. If so, return this available chunck. If
- * not, allocate a new memory chunck with size N, and return it.
+ * available memory chunck with the same size in the free list of this size. If so, return this
+ * available chunck. If not, allocate a new memory chunck with size N, and return it. When the
+ * user releases the chunck, its deleter puts the chunck back to the free list, so both allocation
+ * and release take constant time.
  *
- * As the pool hold a reference to each memory chunck allocate, thus the memory chunck won't be
+ * As the pool keeps each released memory chunck in its free list, the memory chunck won't be
  * freed once it is allocated, until user's application finishes or fails.
  *
  * \example Assume the Page Size is 4KB. When user requests a chunck of memory with size 2KB, the
@@ -69,6 +174,7 @@ class PageUnitPool : public MemoryPool {
     this->device = dev;
     this->api = DeviceAPI::Get(dev.device_type());
     this->max_pool_size = pool_limit;
+    this->free_chunks = std::make_shared<FreeChunkLists>();
 
     if (dev.device_type() == DevType::kCUDA()) {
       this->api->SetDevice(dev.device_id());
@@ -93,74 +199,57 @@ class PageUnitPool : public MemoryPool {
   }
 
   int64_t FreeUnusedChunks() {
-    // Remove the memory from the pool and return the freed memory in bytes.
-    // Since this is the last share_ptr, the removed memory will be deconstructed and freed.
-    int64_t total_free = 0;
-    curr_pool_size = 0;
+    // Remove the free chunks from the pool and return the freed memory in bytes.
+    return free_chunks->FreeAll();
+  }
 
-    std::vector<int64_t> page_nbytes;
-    for (auto kv : _pool) {
-      page_nbytes.push_back(kv.first);
-    }
+  int64_t FreeUnused() override {
+    return FreeUnusedChunks();
+  }
 
-    for (auto nbytes : page_nbytes) {
-      auto nchunk = _pool[nbytes].size();
-      _pool[nbytes].remove_if([](std::shared_ptr<Memory>& mem) { return mem.use_count() == 1; });
-      total_free += nbytes * (nchunk - _pool[nbytes].size());
-      curr_pool_size += nbytes * _pool[nbytes].size();
-    }
-    return total_free;
+  int64_t ResetPeakUsed() override {
+    return free_chunks->ResetPeak();
   }
 
   std::shared_ptr<Memory> Alloc(int64_t nbytes, int64_t alignment) override {
     nbytes = GetAllocBytes(nbytes);
     CHECK_GE(nbytes, 0);
+    if (nbytes == 0) {
+      return std::make_shared<NonOwnedMemory>(nullptr, device, api);
+    }
 
     // Find whether there are available memory chuncks in the pool.
     // If so, return the available memory chunck.
-    if (_pool.find(nbytes) == _pool.end()) {
-      _pool.insert({nbytes, std::list<std::shared_ptr<Memory>>()});
-    }
-    for (const auto& it : _pool[nbytes]) {
-      if (it.use_count() == 1) {
-        int64_t address = (int64_t)it->data;
-        if (address % alignment == 0) return it;
-      }
+    if (NonOwnedMemory* chunk = free_chunks->Pop(nbytes, alignment)) {
+      return WrapChunk(chunk);
     }
 
     // If not, allocate a new memory chunck from device.
-    void* data = nullptr;
-    if (nbytes > 0) {
-      data = AllocDeviceMemory(nbytes, alignment);
+    void* data = AllocDeviceMemory(nbytes, alignment);
 
-      // Out of memory or exceed the user-specified limitation, free unused chunks on other pages.
-      size_t free_nbytes = SIZE_MAX;
-      if ((max_pool_size > 0 && curr_pool_size >= max_pool_size) ||
-          (data == nullptr && free_nbytes > 0)) {
-        free_nbytes = FreeUnusedChunks();
-        DLOG(WARNING) << "Failed to allocate " << BytesToMegaBytes(nbytes)
-                      << " MBs). Ran GC and got " << BytesToMegaBytes(free_nbytes) << " more MBs";
-      }
+    // Out of memory or exceed the user-specified limitation, free unused chunks on other pages.
+    size_t free_nbytes = SIZE_MAX;
+    if ((max_pool_size > 0 && free_chunks->GetSize().second >= max_pool_size) ||
+        (data == nullptr && free_nbytes > 0)) {
+      free_nbytes = FreeUnusedChunks();
+      DLOG(WARNING) << "Failed to allocate " << BytesToMegaBytes(nbytes)
+                    << " MBs). Ran GC and got " << BytesToMegaBytes(free_nbytes) << " more MBs";
+    }
 
-      // Re-allocate the desired chunk if needed.
-      if (data == nullptr && free_nbytes > 0) {
-        data = AllocDeviceMemory(nbytes, alignment);
-      }
-      if (data == nullptr) {
-        // If the freed memory is insufficient, then we can do nothing in memory pool.
-        size_t used, allocated;
-        std::tie(used, allocated) = GetPoolSize();
-        LOG(FATAL) << "Out-Of-Memory. Tried to allocate " << BytesToMegaBytes(nbytes)
-                   << " MBs; Already allocated " << allocated << " MBs and used " << used << " MBs";
-        throw;
-      }
-      curr_pool_size += nbytes;
-      std::shared_ptr<Memory> new_mem = std::make_shared<NonOwnedMemory>(data, device, api);
-      _pool[nbytes].push_back(new_mem);
-      return new_mem;
-    } else {
-      return std::make_shared<NonOwnedMemory>(data, device, api);
+    // Re-allocate the desired chunk if needed.
+    if (data == nullptr && free_nbytes > 0) {
+      data = AllocDeviceMemory(nbytes, alignment);
     }
+    if (data == nullptr) {
+      // If the freed memory is insufficient, then we can do nothing in memory pool.
+      size_t used, allocated;
+      std::tie(used, allocated) = GetPoolSize();
+      LOG(FATAL) << "Out-Of-Memory. Tried to allocate " << BytesToMegaBytes(nbytes)
+                 << " MBs; Already allocated " << allocated << " MBs and used " << used << " MBs";
+      throw;
+    }
+    free_chunks->Add(nbytes);
+    return WrapChunk(new NonOwnedMemory(data, device, api, nbytes));
   }
 
   std::shared_ptr<Memory> AllocAsync(int64_t nbytes, void* stream,
@@ -186,22 +275,9 @@ class PageUnitPool : public MemoryPool {
     float pool_total = BytesToMegaBytes(ret.second);
 
     if (used_total == 0 && pool_total == 0) {
-      // First get all chunk sizes. Note that we do not count the number of used chunks
-      // with use_count > 1 here becuase the kv itself also holds a share_ptr.
-      std::vector<int64_t> page_nbytes;
-      for (auto kv : _pool) {
-        page_nbytes.push_back(kv.first);
-      }
-
-      // Then directly access each page to get the precise use_count.
-      for (auto nbytes : page_nbytes) {
-        size_t used_chunks = 0;
-        for (const auto& it : _pool[nbytes]) {
-          used_chunks += (it.use_count() > 1) ? 1 : 0;
-        }
-        used_total += BytesToMegaBytes(nbytes * used_chunks);
-        pool_total += BytesToMegaBytes(nbytes * _pool[nbytes].size());
-      }
+      auto size = free_chunks->GetSize();
+      used_total = BytesToMegaBytes(size.first);
+      pool_total = BytesToMegaBytes(size.second);
     }
     return std::make_pair(used_total, pool_total);
   }
@@ -216,17 +292,22 @@ class PageUnitPool : public MemoryPool {
   }
 
  protected:
+  /*! \brief Hand out a chunk whose deleter puts it back to the free list. */
+  std::shared_ptr<Memory> WrapChunk(NonOwnedMemory* chunk) {
+    std::shared_ptr<FreeChunkLists> lists = free_chunks;
+    return std::shared_ptr<Memory>(
+        chunk, [lists](Memory* mem) { lists->Push(static_cast<NonOwnedMemory*>(mem)); });
+  }
+
   Device device;
   /*! \brief The size of each memory page (exponent). */
   static const int64_t page_size_exp = 12;
-  /*! \brief The current pool size in bytes. */
-  int64_t curr_pool_size = 0;
   /*! \brief The maximum allowed size (bytes) in the pool. 0 means no limit. */
   int64_t max_pool_size = 0;
   /*! \brief The pointer to the DeviceAPI which determines the context of memory. */
   std::shared_ptr<DeviceAPI> api;
-  /*! \brief The pool that hold the references to NonOwnedMemory. */
-  std::unordered_map<int64_t, std::list<std::shared_ptr<Memory>>> _pool;
+  /*! \brief The free lists of the chunks allocated by this pool. */
+  std::shared_ptr<FreeChunkLists> free_chunks;
 };
 
 RAF_REGISTER_GLOBAL("raf.memory_pool._make.page_unit_pool").set_body_typed([](const Device& dev) {
@@ -0,0 +1,292 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/memory_pool/stream_caching_pool/stream_caching_pool.cc
+ * \brief A memory pool that caches freed memory per stream.
+ */
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include "raf/device_api.h"
+#include "raf/event_pool.h"
+#include "raf/memory_pool.h"
+#include "raf/registry.h"
+
+namespace raf {
+namespace memory_pool {
+namespace stream_caching_pool {
+
+using device_api::DeviceAPI;
+using event_pool::Event;
+using event_pool::EventPool;
+
+/*! \brief The granularity of every cached block in bytes. */
+constexpr int64_t kBlockSize = 512;
+
+/*!
+ * \brief The cache of freed blocks. Each freed block is kept in the free list of the stream it was
+ * last used on. The cache is shared by the pool and all memory chunks handed out, so that chunks
+ * can still be returned after the pool is removed.
+ */
+class StreamCache {
+ public:
+  StreamCache(const Device& dev, std::shared_ptr<DeviceAPI> api)
+      : device_(dev), api_(std::move(api)) {
+  }
+
+  ~StreamCache() {
+    FreeAll();
+  }
+
+  /*!
+   * \brief Take a cached block for the given stream.
+   * \param nbytes The requested size, which must be a multiple of kBlockSize.
+   * \param stream The stream that is going to use the block.
+   * \param size The size of the taken block.
+   * \return The block, or nullptr if there is no proper cached block.
+   */
+  void* Pop(int64_t nbytes, void* stream, int64_t* size) {
+    std::lock_guard<std::mutex> lock(mu_);
+    // Blocks on the same stream can be reused directly, because all kernels that used the block
+    // have been issued to the stream before the new ones.
+    auto it = free_blocks_.find(stream);
+    if (it != free_blocks_.end()) {
+      if (void* ptr = PopFrom(&it->second, nbytes, size)) {
+        return ptr;
+      }
+    }
+    // Otherwise steal a block from another stream. An event recorded on the previous stream makes
+    // the new stream wait for all workloads on it without blocking the host.
+    for (auto& kv : free_blocks_) {
+      if (kv.first == stream) {
+        continue;
+      }
+      if (void* ptr = PopFrom(&kv.second, nbytes, size)) {
+        std::shared_ptr<Event> event =
+            EventPool::Get(device_)->GetEvent(0x02 /*cudaEventDisableTiming*/);
+        api_->EventRecordOnStream(event->data(), kv.first);
+        api_->StreamWaitEvent(stream, event->data());
+        return ptr;
+      }
+    }
+    return nullptr;
+  }
+
+  /*! \brief Record a block newly allocated from the device, which is in use. */
+  void Add(int64_t nbytes) {
+    std::lock_guard<std::mutex> lock(mu_);
+    used_bytes_ += nbytes;
+    pool_bytes_ += nbytes;
+  }
+
+  /*! \brief Put a block released by the user to the free list of the stream it was used on. */
+  void Push(void* ptr, int64_t nbytes, void* stream) {
+    std::lock_guard<std::mutex> lock(mu_);
+    used_bytes_ -= nbytes;
+    free_blocks_[stream].emplace(nbytes, ptr);
+  }
+
+  /*! \brief Return all cached blocks to the device and return the freed memory in bytes. */
+  int64_t FreeAll() {
+    std::lock_guard<std::mutex> lock(mu_);
+    int64_t total_free = 0;
+    for (auto& kv : free_blocks_) {
+      for (auto& block : kv.second) {
+        api_->FreeMemory(block.second);
+        total_free += block.first;
+      }
+    }
+    free_blocks_.clear();
+    pool_bytes_ -= total_free;
+    return total_free;
+  }
+
+  /*! \brief Get the total size of (used blocks, pool) in bytes. */
+  std::pair<int64_t, int64_t> GetSize() {
+    std::lock_guard<std::mutex> lock(mu_);
+    return {used_bytes_, pool_bytes_};
+  }
+
+ private:
+  /*!
+   * \brief Take the smallest block that is large enough. A block more than twice as large as the
+   * request is not taken, so that small requests do not pin large blocks.
+   */
+  void* PopFrom(std::multimap<int64_t, void*>* blocks, int64_t nbytes, int64_t* size) {
+    auto it = blocks->lower_bound(nbytes);
+    if (it == blocks->end() || it->first > 2 * nbytes) {
+      return nullptr;
+    }
+    void* ptr = it->second;
+    *size = it->first;
+    used_bytes_ += it->first;
+    blocks->erase(it);
+    return ptr;
+  }
+
+  /*! \brief The device of the cache. */
+  Device device_;
+  /*! \brief The pointer to the DeviceAPI which determines the context of memory. */
+  std::shared_ptr<DeviceAPI> api_;
+  /*! \brief The freed blocks (size -> pointer) grouped by the streams they were last used on. */
+  std::unordered_map<void*, std::multimap<int64_t, void*>> free_blocks_;
+  /*! \brief The total size of the blocks in use. */
+  int64_t used_bytes_ = 0;
+  /*! \brief The total size of all blocks allocated from the device. */
+  int64_t pool_bytes_ = 0;
+  /*! \brief The mutex to protect the free lists, as blocks can be released by any thread. */
+  std::mutex mu_;
+};
+
+/*!
+ * \brief A wrapper which holds a cached block. The block is returned to the free list of its stream
+ * when the wrapper is destructed.
+ */
+class StreamBlockMemory final : public Memory {
+ public:
+  explicit StreamBlockMemory(void* data, int64_t nbytes, void* stream, const Device& dev,
+                             std::shared_ptr<StreamCache> cache)
+      : nbytes(nbytes), stream(stream), cache(std::move(cache)) {
+    this->data = data;
+    this->device = dev;
+  }
+
+  ~StreamBlockMemory() {
+    if (data != nullptr) {
+      cache->Push(data, nbytes, stream);
+    }
+  }
+
+ public:
+  /*! \brief The size of the block in bytes. */
+  int64_t nbytes;
+  /*! \brief The stream the block is used on. */
+  void* stream;
+  /*! \brief The cache that the block belongs to. */
+  std::shared_ptr<StreamCache> cache;
+};
+
+/*!
+ * \brief A Memory Pool that caches freed memory by the stream it was used on. Unlike NoPool, which
+ * relies on the stream-ordered allocator of CUDA 11.3+ for AllocAsync, this pool implements the
+ * stream ordering by itself, so that it works on older drivers and during CUDA graph capture.
+ *
+ * A block freed on a stream is reused by the following requests on the same stream without any
+ * synchronization. When a request on another stream takes the block, the pool records an event
+ * on the previous stream and lets the new stream wait for it. Similar to cudaFreeAsync, a block is
+ * considered free on its stream once the user releases it, so the workloads that use the block on
+ * other streams have to be synchronized with the stream before the block is released.
+ *
+ * Alloc (without a stream) is treated as an allocation on the default stream.
+ *
+ * \sa StreamCachingPool
+ */
+class StreamCachingPool final : public MemoryPool {
+ public:
+  explicit StreamCachingPool(Device dev) {
+    this->device = dev;
+    this->api = DeviceAPI::Get(dev.device_type());
+
+    if (dev.device_type() == DevType::kCUDA()) {
+      this->api->SetDevice(dev.device_id());
+    }
+    cache = std::make_shared<StreamCache>(dev, api);
+  }
+
+  std::string GetName() {
+    return "stream_caching_pool";
+  }
+
+  int64_t GetAllocBytes(int64_t nbytes) override {
+    return (nbytes + kBlockSize - 1) / kBlockSize * kBlockSize;
+  }
+
+  bool IsStreamOrdered() override {
+    return true;
+  }
+
+  std::shared_ptr<Memory> Alloc(int64_t nbytes, int64_t alignment) override {
+    return AllocAsync(nbytes, nullptr, alignment);
+  }
+
+  std::shared_ptr<Memory> AllocAsync(int64_t nbytes, void* stream,
+                                     int64_t alignment = kDefaultMemoryAlignment) override {
+    CHECK_GE(nbytes, 0);
+    CHECK_EQ(kBlockSize % alignment, 0) << "Alignment " << alignment << " is not supported";
+    nbytes = GetAllocBytes(nbytes);
+    if (nbytes == 0) {
+      return std::make_shared<StreamBlockMemory>(nullptr, 0, stream, device, cache);
+    }
+    int64_t size = nbytes;
+    void* data = cache->Pop(nbytes, stream, &size);
+    if (data == nullptr) {
+      data = AllocDeviceMemory(nbytes);
+      if (data == nullptr) {
+        // Out of memory, return all cached blocks to the device and try again.
+        int64_t free_nbytes = cache->FreeAll();
+        DLOG(WARNING) << "Failed to allocate " << BytesToMegaBytes(nbytes)
+                      << " MBs). Ran GC and got " << BytesToMegaBytes(free_nbytes) << " more MBs";
+        data = AllocDeviceMemory(nbytes);
+      }
+      if (data == nullptr) {
+        float used, allocated;
+        std::tie(used, allocated) = GetPoolSize();
+        LOG(FATAL) << "Out-Of-Memory. Tried to allocate " << BytesToMegaBytes(nbytes)
+                   << " MBs; Already allocated " << allocated << " MBs and used " << used
+                   << " MBs";
+        throw;
+      }
+      cache->Add(nbytes);
+    }
+    return std::make_shared<StreamBlockMemory>(data, size, stream, device, cache);
+  }
+
+  std::vector<std::shared_ptr<Memory>> AllocBatch(const std::vector<int64_t>& nbytes,
+                                                  int64_t alignment) override {
+    std::vector<std::shared_ptr<Memory>> ret;
+    ret.reserve(nbytes.size());
+    for (int64_t bytes : nbytes) {
+      ret.emplace_back(Alloc(bytes, alignment));
+    }
+    return ret;
+  }
+
+  std::pair<float, float> GetPoolSize() override {
+    auto ret = cache->GetSize();
+    return std::make_pair(BytesToMegaBytes(ret.first), BytesToMegaBytes(ret.second));
+  }
+
+  int64_t FreeUnused() override {
+    return cache->FreeAll();
+  }
+
+ public:
+  static void* make(const Device& dev) {
+    return new StreamCachingPool(dev);
+  }
+
+ private:
+  inline void* AllocDeviceMemory(int64_t nbytes) {
+    try {
+      return api->AllocMemory(nbytes, kBlockSize);
+    } catch (const dmlc::Error& e) {
+      return nullptr;
+    }
+  }
+
+  Device device;
+  /*! \brief The pointer to the DeviceAPI which determines the context of memory. */
+  std::shared_ptr<DeviceAPI> api;
+  /*! \brief The cache of freed blocks. */
+  std::shared_ptr<StreamCache> cache;
+};
+
+RAF_REGISTER_GLOBAL("raf.memory_pool._make.stream_caching_pool")
+    .set_body_typed([](const Device& dev) { return StreamCachingPool::make(dev); });
+
+}  // namespace stream_caching_pool
+}  // namespace memory_pool
+}  // namespace raf
@@ -115,6 +115,10 @@ class NumelOpEnv : public raf::op::OpEnv {
     NumelImpl(inputs[0], output);
   }
 
+  bool IsShapeOnly() const override {
+    return true;
+  }
+
   static OpEnv* make(const CallValues& cv) {
     return new NumelOpEnv(cv);
   }
@@ -157,6 +161,10 @@ class ShapeAsTensorOpEnv : public raf::op::OpEnv {
     ShapeAsTensorImpl(inputs[0], output);
   }
 
+  bool IsShapeOnly() const override {
+    return true;
+  }
+
   static OpEnv* make(const CallValues& cv) {
     return new ShapeAsTensorOpEnv(cv);
   }
@@ -10,6 +10,7 @@
 #include "raf/op.h"
 #include "raf/tensor.h"
 #include "../schema/ufunc.h"
+#include "../../common/shape_utils.h"
 
 namespace raf {
 namespace op {
@@ -17,6 +18,7 @@ namespace declare {
 
 using namespace raf::op::schema;
 using namespace raf::value;
+using common::shape_utils::IsCompact;
 
 RAF_OP_DECLARE("raf.op.compiler_begin", [](const CallValues& call) {
   const auto* args = call->args.as<UnaryArgs>();
@@ -38,6 +40,18 @@ RAF_OP_DECLARE("raf.op.compiler_end", [](const CallValues& call) {
   call->device = x->device;
 });
 
+RAF_OP_DECLARE("raf.op.checkpoint", [](const CallValues& call) {
+  const auto* args = call->args.as<UnaryArgs>();
+  CHECK(args != nullptr);
+  DLTensor* x = args->x;
+  // The annotation is a view of its input, which marks the end of a checkpoint segment.
+  CHECK(IsCompact(*x)) << "NotImplementedError: checkpoint on non-contiguous tensors";
+  call->device = x->device;
+  call->callee = ir::NullValue<OpValue>();
+  call->out = Downcast<TensorValue>(args->x).CreateView(
+      std::vector<int64_t>(x->shape, x->shape + x->ndim));
+}).set_attr<TOpPattern>("TOpPattern", kOpaque);
+
 }  // namespace declare
 }  // namespace op
 }  // namespace raf
@@ -9,6 +9,7 @@
  */
 #include "raf/op.h"
 #include "raf/tensor.h"
+#include "../schema/nn.h"
 #include "../schema/ufunc.h"
 
 namespace raf {
@@ -128,6 +129,58 @@ RAF_OP_DECLARE("raf.op.dense", [](const CallValues& call) {
   }
 });
 
+void GroupedMatmulDecl(const CallValues& call) {
+  const auto* args = call->args.as<schema::GroupedMatmulArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* x = args->x;
+  const DLTensor* w = args->w;
+  const DLTensor* group_sizes = args->group_sizes;
+  // x is of shape [t, k], whose rows are grouped by the experts in order
+  // w is of shape [e, k, n], or [e, n, k] if transpose_b
+  CHECK_EQ(x->ndim, 2);
+  CHECK_EQ(w->ndim, 3);
+  CHECK(group_sizes->ndim == 1 && group_sizes->shape[0] == w->shape[0])
+      << "Expected the group sizes in the shape of [" << w->shape[0] << "]";
+  CHECK(group_sizes->dtype.code == kDLInt && group_sizes->dtype.bits == 64)
+      << "Expected the group sizes to be int64";
+  int64_t k = args->transpose_b ? w->shape[2] : w->shape[1];
+  int64_t n = args->transpose_b ? w->shape[1] : w->shape[2];
+  CHECK_EQ(x->shape[1], k);
+  CHECK(x->dtype.code == kDLFloat) << "Only float types are supported!";
+  call->out = TensorValue::Assemble(/*dev=*/x->device, /*dtype=*/x->dtype,
+                                    /*shape=*/std::vector<int64_t>{x->shape[0], n});
+  call->device = x->device;
+  if (!x->shape[0] || !n || !k || !w->shape[0]) {
+    call->callee = ir::NullValue<OpValue>();
+  }
+}
+
+void GroupedMatmulDwDecl(const CallValues& call) {
+  const auto* args = call->args.as<schema::GroupedMatmulArgs>();
+  CHECK(args != nullptr);
+  // x is of shape [t, k], and w is the output gradient dy of shape [t, n]
+  const DLTensor* x = args->x;
+  const DLTensor* dy = args->w;
+  const DLTensor* group_sizes = args->group_sizes;
+  CHECK_EQ(x->ndim, 2);
+  CHECK_EQ(dy->ndim, 2);
+  CHECK_EQ(x->shape[0], dy->shape[0]);
+  CHECK_EQ(group_sizes->ndim, 1);
+  int64_t e = group_sizes->shape[0];
+  int64_t k = x->shape[1];
+  int64_t n = dy->shape[1];
+  std::vector<int64_t> shape = args->transpose_b ? std::vector<int64_t>{e, n, k}
+                                                 : std::vector<int64_t>{e, k, n};
+  call->out = TensorValue::Assemble(/*dev=*/x->device, /*dtype=*/x->dtype, /*shape=*/shape);
+  call->device = x->device;
+  if (!e || !k || !n) {
+    call->callee = ir::NullValue<OpValue>();
+  }
+}
+
+RAF_OP_DECLARE("raf.op.grouped_matmul", GroupedMatmulDecl);
+RAF_OP_DECLARE("raf.op.grouped_matmul_dw", GroupedMatmulDwDecl);
+
 }  // namespace declare
 }  // namespace op
 }  // namespace raf
@@ -12,6 +12,7 @@
 #include "raf/tensor.h"
 #include "raf/op_utils.h"
 #include "../schema/memory.h"
+#include "../schema/ufunc.h"
 #include "../../common/shape_utils.h"
 
 namespace raf {
@@ -93,6 +94,31 @@ RAF_OP_DECLARE("raf.op.defuse_tensor", [](const CallValues& call) {
   }
 }).set_attr<TOpPattern>("TOpPattern", kOpaque);
 
+/*!
+ * \brief The hints of the unified memory, which migrate the pages of x to the device before its
+ * uses, or to the host after them. The output is x itself. The hints are no-ops off CUDA.
+ */
+void MemoryHint(const CallValues& call) {
+  const auto* args = call->args.as<UnaryArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* x = args->x;
+  call->device = x->device;
+  call->out = args->x;
+  if (Device(x->device).device_type() != DevType::kCUDA()) {
+    call->callee = ir::NullValue<OpValue>();
+  }
+}
+
+RAF_OP_DECLARE("raf.op.memory_prefetch", MemoryHint)
+    .set_attr<TOpPattern>("TOpPattern", kOpaque)
+    .set_attr<TRAFSideEffect>("TRAFSideEffect", true)
+    .set_attr<TRAFInplaceUpdate>("TRAFInplaceUpdate", {{0, 0}});
+
+RAF_OP_DECLARE("raf.op.memory_evict", MemoryHint)
+    .set_attr<TOpPattern>("TOpPattern", kOpaque)
+    .set_attr<TRAFSideEffect>("TRAFSideEffect", true)
+    .set_attr<TRAFInplaceUpdate>("TRAFInplaceUpdate", {{0, 0}});
+
 }  // namespace declare
 }  // namespace op
 }  // namespace raf
@@ -375,6 +375,62 @@ RAF_OP_DECLARE("raf.op.batch_norm_train_dxwb", [](const CallValues& call) {
   call->device = x->device;
 });
 
+RAF_OP_DECLARE("raf.op._contrib_batch_norm_add_relu_train", [](const CallValues& call) {
+  const auto* args = call->args.as<BatchNormAddReluArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* x = args->x;
+  std::vector<int64_t> shape(x->shape, x->shape + x->ndim);
+  if (args->z.defined()) {
+    const DLTensor* z = args->z.value();
+    CHECK(std::vector<int64_t>(z->shape, z->shape + z->ndim) == shape)
+        << "ValueError: the residual of batch_norm_add_relu must have the shape of x";
+  }
+  TensorValue y = TensorValue::Assemble(/*dev=*/x->device,
+                                        /*dtype=*/x->dtype,
+                                        /*shape=*/shape);
+  TensorValue running_mean = Downcast<TensorValue>(args->running_mean);
+  std::vector<int64_t> running_mean_shape(running_mean->tensor.Shape().begin(),
+                                          running_mean->tensor.Shape().end());
+  running_mean = running_mean.CreateView(running_mean_shape);
+  TensorValue running_var = Downcast<TensorValue>(args->running_var);
+  std::vector<int64_t> running_var_shape(running_var->tensor.Shape().begin(),
+                                         running_var->tensor.Shape().end());
+  running_var = running_var.CreateView(running_var_shape);
+  // One bit per element of y, which is set if the element is positive.
+  int64_t size = 1;
+  for (int64_t dim : shape) {
+    size *= dim;
+  }
+  TensorValue mask = TensorValue::Assemble(/*dev=*/x->device,
+                                           /*dtype=*/DType(DTypeCode::kInt(), 32),
+                                           /*shape=*/std::vector<int64_t>{(size + 31) / 32});
+  call->out = TupleValue::make(tvm::Array<Value>({y, running_mean, running_var, mask}));
+  call->device = x->device;
+}).set_attr<TRAFInplaceUpdate>("TRAFInplaceUpdate", {{1, 1}, {2, 2}});
+
+RAF_OP_DECLARE("raf.op._contrib_batch_norm_add_relu_train_dxwb", [](const CallValues& call) {
+  const auto* args = call->args.as<BatchNormAddReluDxwbArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* x = args->x;
+  std::vector<int64_t> xshape(x->shape, x->shape + x->ndim);
+  TensorValue dx = TensorValue::Assemble(/*dev=*/x->device,
+                                         /*dtype=*/x->dtype,
+                                         /*shape=*/xshape);
+  const DLTensor* w = args->w;
+  std::vector<int64_t> wshape(w->shape, w->shape + w->ndim);
+  TensorValue dw = TensorValue::Assemble(/*dev=*/w->device,
+                                         /*dtype=*/w->dtype,
+                                         /*shape=*/wshape);
+  TensorValue db = TensorValue::Assemble(/*dev=*/w->device,
+                                         /*dtype=*/w->dtype,
+                                         /*shape=*/wshape);
+  TensorValue dz = TensorValue::Assemble(/*dev=*/x->device,
+                                         /*dtype=*/x->dtype,
+                                         /*shape=*/xshape);
+  call->out = TupleValue::make(tvm::Array<Value>({dx, dw, db, dz}));
+  call->device = x->device;
+});
+
 void BiasAdd(const CallValues& call) {
   const auto* args = call->args.as<BiasAddArgs>();
   CHECK(args != nullptr);
@@ -456,6 +512,277 @@ void DropoutDx(const CallValues& call) {
 
 RAF_OP_DECLARE("raf.op._contrib_dropout_dx", DropoutDx);
 
+void PhiloxDropout(const CallValues& call) {
+  const auto* args = call->args.as<PhiloxDropoutArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* x = args->x;
+  const DLTensor* key = args->key;
+  CHECK(tvm::runtime::DLDataType2String(key->dtype) == "uint64" && key->ndim == 1 &&
+        key->shape[0] == 2)
+      << "The key of philox dropout must be a uint64 tensor of (seed, offset)";
+  CHECK(args->p >= 0 && args->p < 1) << "The dropout rate must be in [0, 1), but got " << args->p;
+  std::vector<int64_t> shape(x->shape, x->shape + x->ndim);
+  call->out = TensorValue::Assemble(/*dev=*/x->device,
+                                    /*dtype=*/x->dtype,
+                                    /*shape=*/shape);
+  call->device = x->device;
+}
+
+RAF_OP_DECLARE("raf.op._contrib_philox_dropout", PhiloxDropout);
+
+void PhiloxDropoutDx(const CallValues& call) {
+  const auto* args = call->args.as<PhiloxDropoutDxArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* dy = args->dy;
+  std::vector<int64_t> shape(dy->shape, dy->shape + dy->ndim);
+  call->out = TensorValue::Assemble(/*dev=*/dy->device,
+                                    /*dtype=*/dy->dtype,
+                                    /*shape=*/shape);
+  call->device = dy->device;
+}
+
+RAF_OP_DECLARE("raf.op._contrib_philox_dropout_dx", PhiloxDropoutDx);
+
+void Attention(const CallValues& call) {
+  const auto* args = call->args.as<AttentionArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* q = args->q;
+  const DLTensor* k = args->k;
+  const DLTensor* v = args->v;
+  CHECK(q->ndim == 3 && k->ndim == 3 && v->ndim == 3)
+      << "Expected q, k and v in the shape of [batch, seq, dim], but got " << q->ndim << "-D, "
+      << k->ndim << "-D and " << v->ndim << "-D";
+  CHECK(q->shape[0] == k->shape[0] && k->shape[0] == v->shape[0]) << "Batch sizes mismatch";
+  CHECK_EQ(q->shape[2], k->shape[2]) << "The head dimensions of q and k mismatch";
+  CHECK_EQ(k->shape[1], v->shape[1]) << "The sequence lengths of k and v mismatch";
+  if (args->valid_len.defined()) {
+    const DLTensor* valid_len = args->valid_len.value();
+    CHECK(valid_len->ndim == 0 && valid_len->dtype.code == kDLInt && valid_len->dtype.bits == 64)
+        << "Expected valid_len to be an int64 scalar";
+  }
+  call->out = TensorValue::Assemble(/*dev=*/q->device,
+                                    /*dtype=*/q->dtype,
+                                    /*shape=*/{q->shape[0], q->shape[1], v->shape[2]});
+  call->device = q->device;
+}
+
+RAF_OP_DECLARE("raf.op._contrib_attention", Attention);
+
+void AttentionDx(const CallValues& call) {
+  const auto* args = call->args.as<AttentionDxArgs>();
+  CHECK(args != nullptr);
+  Array<Value> grads;
+  for (const DLTensor* x : std::vector<const DLTensor*>{args->q, args->k, args->v}) {
+    std::vector<int64_t> shape(x->shape, x->shape + x->ndim);
+    grads.push_back(TensorValue::Assemble(/*dev=*/x->device,
+                                          /*dtype=*/x->dtype,
+                                          /*shape=*/shape));
+  }
+  const DLTensor* q = args->q;
+  call->out = TupleValue::make(grads);
+  call->device = q->device;
+}
+
+RAF_OP_DECLARE("raf.op._contrib_attention_dx", AttentionDx);
+
+void KvCacheAppend(const CallValues& call) {
+  const auto* args = call->args.as<KvCacheAppendArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* cache = args->cache;
+  const DLTensor* x = args->x;
+  const DLTensor* offset = args->offset;
+  CHECK(cache->ndim == 3 && x->ndim == 3)
+      << "Expected cache and x in the shape of [batch, seq, dim], but got " << cache->ndim
+      << "-D and " << x->ndim << "-D";
+  CHECK(cache->shape[0] == x->shape[0] && cache->shape[2] == x->shape[2])
+      << "The batch sizes or the dimensions of cache and x mismatch";
+  CHECK_LE(x->shape[1], cache->shape[1]) << "The new entries exceed the cache";
+  CHECK(DType(cache->dtype) == DType(x->dtype)) << "The dtypes of cache and x mismatch";
+  CHECK(offset->ndim == 0 && offset->dtype.code == kDLInt && offset->dtype.bits == 64)
+      << "Expected offset to be an int64 scalar";
+  // The offset is read on the device, so the cache is updated in place without syncing the host.
+  call->out = args->cache;
+  call->device = cache->device;
+}
+
+RAF_OP_DECLARE("raf.op._contrib_kv_cache_append", KvCacheAppend)
+    .set_attr<TOpPattern>("TOpPattern", kOpaque)
+    .set_attr<TRAFInplaceUpdate>("TRAFInplaceUpdate", {{0, 0}});
+
+/*! \brief Check that the scale is a scalar, or a 1-D tensor along the axis of the input. */
+void CheckQuantizeScale(const DLTensor* x, const DLTensor* scale, int axis) {
+  CHECK(scale->dtype.code == kDLFloat && scale->dtype.bits == 32)
+      << "Expected the scale to be float32";
+  if (scale->ndim == 0) {
+    return;
+  }
+  CHECK_EQ(scale->ndim, 1) << "Expected the scale to be a scalar or a 1-D tensor";
+  int ndim = x->ndim;
+  CHECK(-ndim <= axis && axis < ndim) << "Invalid axis " << axis << " of " << ndim << "-D input";
+  axis = axis < 0 ? axis + ndim : axis;
+  CHECK_EQ(scale->shape[0], x->shape[axis]) << "The scale mismatches the channels of the input";
+}
+
+void Quantize(const CallValues& call) {
+  const auto* args = call->args.as<QuantizeArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* x = args->x;
+  CHECK(x->dtype.code == kDLFloat) << "Only float inputs can be quantized";
+  CheckQuantizeScale(x, args->scale, args->axis);
+  std::vector<int64_t> shape(x->shape, x->shape + x->ndim);
+  call->out = TensorValue::Assemble(/*dev=*/x->device,
+                                    /*dtype=*/DType(DTypeCode::kInt(), 8),
+                                    /*shape=*/shape);
+  call->device = x->device;
+}
+
+RAF_OP_DECLARE("raf.op._contrib_quantize", Quantize);
+
+void Dequantize(const CallValues& call) {
+  const auto* args = call->args.as<QuantizeArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* x = args->x;
+  CHECK(x->dtype.code == kDLInt && x->dtype.bits == 8) << "Only int8 inputs can be dequantized";
+  CheckQuantizeScale(x, args->scale, args->axis);
+  std::vector<int64_t> shape(x->shape, x->shape + x->ndim);
+  call->out = TensorValue::Assemble(/*dev=*/x->device,
+                                    /*dtype=*/DType(DTypeCode::kFloat(), 32),
+                                    /*shape=*/shape);
+  call->device = x->device;
+}
+
+RAF_OP_DECLARE("raf.op._contrib_dequantize", Dequantize);
+
+void QuantizedDense(const CallValues& call) {
+  const auto* args = call->args.as<QuantizedDenseArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* x = args->x;
+  const DLTensor* w = args->w;
+  CHECK(x->ndim == 2 && w->ndim == 2)
+      << "Expected x and w in the shape of [m, k] and [n, k], but got " << x->ndim << "-D and "
+      << w->ndim << "-D";
+  CHECK_EQ(x->shape[1], w->shape[1]) << "The reduction dimensions of x and w mismatch";
+  CHECK(x->dtype.code == kDLInt && x->dtype.bits == 8 && w->dtype.code == kDLInt &&
+        w->dtype.bits == 8)
+      << "Expected x and w to be int8";
+  // The input is scaled per tensor, and the weight is scaled per tensor or per output channel.
+  const DLTensor* x_scale = args->x_scale;
+  CHECK_EQ(x_scale->ndim, 0) << "Expected the scale of x to be a scalar";
+  CheckQuantizeScale(w, args->w_scale, 0);
+  call->out = TensorValue::Assemble(/*dev=*/x->device,
+                                    /*dtype=*/DType(DTypeCode::kFloat(), 32),
+                                    /*shape=*/{x->shape[0], w->shape[0]});
+  call->device = x->device;
+}
+
+RAF_OP_DECLARE("raf.op._contrib_quantized_dense", QuantizedDense);
+
+/*!
+ * \brief Check the per-tensor scale of the FP8 tensor, which is a float32 scalar. The FP8 tensors
+ * are the uint8 bit patterns of either E4M3 or E5M2, as the formats are not in the TVM types.
+ */
+void CheckFp8Scale(const DLTensor* x, const DLTensor* scale) {
+  CHECK(scale->ndim == 0 && scale->dtype.code == kDLFloat && scale->dtype.bits == 32)
+      << "Expected the scale to be a float32 scalar";
+  CHECK(scale->device.device_type == x->device.device_type &&
+        scale->device.device_id == x->device.device_id)
+      << "Expected the scale to be on the device of the input";
+}
+
+inline bool IsFp8(const DLTensor* x) {
+  return x->dtype.code == kDLUInt && x->dtype.bits == 8;
+}
+
+template <bool dequantize>
+void QuantizeFp8(const CallValues& call) {
+  const auto* args = call->args.as<QuantizeFp8Args>();
+  CHECK(args != nullptr);
+  const DLTensor* x = args->x;
+  if (dequantize) {
+    CHECK(IsFp8(x)) << "Only the uint8 bits of FP8 inputs can be dequantized";
+  } else {
+    CHECK(x->dtype.code == kDLFloat) << "Only float inputs can be quantized";
+  }
+  CheckFp8Scale(x, args->scale);
+  std::vector<int64_t> shape(x->shape, x->shape + x->ndim);
+  call->out = TensorValue::Assemble(
+      /*dev=*/x->device,
+      /*dtype=*/dequantize ? DType(DTypeCode::kFloat(), 32) : DType(DTypeCode::kUInt(), 8),
+      /*shape=*/shape);
+  call->device = x->device;
+}
+
+RAF_OP_DECLARE("raf.op._contrib_quantize_fp8", QuantizeFp8<false>);
+RAF_OP_DECLARE("raf.op._contrib_dequantize_fp8", QuantizeFp8<true>);
+
+void Fp8Dense(const CallValues& call) {
+  const auto* args = call->args.as<Fp8DenseArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* x = args->x;
+  const DLTensor* w = args->w;
+  CHECK(x->ndim == 2 && w->ndim == 2)
+      << "Expected x and w in the shape of [m, k] and [n, k], but got " << x->ndim << "-D and "
+      << w->ndim << "-D";
+  CHECK_EQ(x->shape[1], w->shape[1]) << "The reduction dimensions of x and w mismatch";
+  CHECK(IsFp8(x) && IsFp8(w)) << "Expected x and w to be the uint8 bits of FP8";
+  CheckFp8Scale(x, args->x_scale);
+  CheckFp8Scale(w, args->w_scale);
+  DType out_dtype(String2DLDataType(args->out_dtype));
+  CHECK(out_dtype == DType(DTypeCode::kFloat(), 16) || out_dtype == DType(DTypeCode::kFloat(), 32))
+      << "Expected the output to be float16 or float32, but got " << args->out_dtype;
+  call->out = TensorValue::Assemble(/*dev=*/x->device,
+                                    /*dtype=*/out_dtype,
+                                    /*shape=*/{x->shape[0], w->shape[0]});
+  call->device = x->device;
+}
+
+RAF_OP_DECLARE("raf.op._contrib_fp8_dense", Fp8Dense);
+
+RAF_OP_DECLARE("raf.op._contrib_update_fp8_scale", [](const CallValues& call) {
+  const auto* args = call->args.as<UpdateFp8ScaleArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* history = args->amax_history;
+  CHECK(history->ndim == 1 && history->shape[0] > 0 && history->dtype.code == kDLFloat &&
+        history->dtype.bits == 32)
+      << "Expected the amax history to be a non-empty float32 vector";
+  CheckFp8Scale(history, args->scale);
+  CheckFp8Scale(history, args->amax);
+  call->device = history->device;
+  call->out = TupleValue::make({args->amax_history, args->scale});
+})
+    .set_attr<TOpPattern>("TOpPattern", kOpaque)
+    .set_attr<TRAFInplaceUpdate>("TRAFInplaceUpdate", {{0, 0}, {1, 1}})
+    // The history and the scale are only updated in place for the next steps.
+    .set_attr<TRAFSideEffect>("TRAFSideEffect", true);
+
+void SparseDense(const CallValues& call) {
+  const auto* args = call->args.as<SparseDenseArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* x = args->x;
+  const DLTensor* w = args->w;
+  const DLTensor* meta = args->meta;
+  // The 2:4 sparse weight of [n, k] keeps 2 of every 4 elements along k in w of [n, k / 2], and
+  // their indices in meta of [k / 64, n, 2], which is in the interleaved layout of the sparse
+  // tensor cores.
+  CHECK(x->ndim == 2 && w->ndim == 2 && meta->ndim == 3)
+      << "Expected x, w and meta in the shape of [m, k], [n, k / 2] and [k / 64, n, 2]";
+  int64_t k = x->shape[1];
+  int64_t n = w->shape[0];
+  CHECK(k % 64 == 0 && w->shape[1] * 2 == k)
+      << "Expected the reduction dimension to be a multiple of 64 and twice the one of w";
+  CHECK(meta->shape[0] * 64 == k && meta->shape[1] == n && meta->shape[2] == 2)
+      << "Expected meta in the shape of [" << k / 64 << ", " << n << ", 2]";
+  CHECK(meta->dtype.code == kDLInt && meta->dtype.bits == 32) << "Expected meta to be int32";
+  CHECK(x->dtype.code == kDLFloat && DType(x->dtype) == DType(w->dtype))
+      << "Expected x and w to be in the same float dtype";
+  call->out = TensorValue::Assemble(/*dev=*/x->device,
+                                    /*dtype=*/x->dtype,
+                                    /*shape=*/{x->shape[0], n});
+  call->device = x->device;
+}
+
+RAF_OP_DECLARE("raf.op._contrib_sparse_dense", SparseDense);
+
 void LayerNorm(const CallValues& call) {
   const auto* args = call->args.as<LayerNormArgs>();
   CHECK(args != nullptr);
@@ -19,9 +19,19 @@ namespace declare {
 using namespace raf::op::schema;
 using namespace raf::value;
 
+/*! \brief Check that the skip flag is a float32 scalar, whose non-zero value skips the update. */
+void CheckSkip(const ir::Optional<BaseTensorValue>& skip) {
+  if (skip.defined()) {
+    const DLTensor* flag = skip.value();
+    CHECK(flag->ndim == 0 && flag->dtype.code == kDLFloat && flag->dtype.bits == 32)
+        << "The skip flag is expected to be a float32 scalar";
+  }
+}
+
 RAF_OP_DECLARE("raf.op.sgd", [](const CallValues& call) {
   const auto* args = call->args.as<SgdArgs>();
   CHECK(args != nullptr);
+  CheckSkip(args->skip);
   const DLTensor* x0 = args->x;
   const DLTensor* dx = args->dx;
   const DLTensor* v0 = args->v;
@@ -31,22 +41,40 @@ RAF_OP_DECLARE("raf.op.sgd", [](const CallValues& call) {
     CHECK_EQ(x0->shape[i], dx->shape[i]);
     CHECK_EQ(v0->shape[i], dx->shape[i]);
   }
-  auto v1 = TensorValue::Assemble(
-      /*dev=*/dx->device,
-      /*dtype=*/dx->dtype,
-      /*shape=*/std::vector<int64_t>(dx->shape, dx->shape + dx->ndim));
-  auto x1 = TensorValue::Assemble(
-      /*dev=*/dx->device,
-      /*dtype=*/dx->dtype,
-      /*shape=*/std::vector<int64_t>(dx->shape, dx->shape + dx->ndim));
-  call->out = TupleValue::make(tvm::Array<Value>({v1, x1}));
+  // Each element of x and v only depends on the same element of the inputs, so they are updated
+  // in place instead of allocating a copy of the model states in every step.
+  call->out = TupleValue::make(tvm::Array<Value>({args->v, args->x}));
   call->device = dx->device;
-});
+})
+    .set_attr<TRAFInplaceUpdate>("TRAFInplaceUpdate", {{0, 1}, {2, 0}});
+
+RAF_OP_DECLARE("raf.op.sparse_sgd", [](const CallValues& call) {
+  const auto* args = call->args.as<SparseSgdArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* x = args->x;
+  const DLTensor* rows = args->rows;
+  const DLTensor* values = args->values;
+  const DLTensor* v = args->v;
+  CHECK_EQ(x->ndim, 2);
+  CHECK_EQ(v->ndim, 2);
+  CHECK_EQ(rows->ndim, 1);
+  CHECK_EQ(values->ndim, 2);
+  CHECK_EQ(v->shape[0], x->shape[0]);
+  CHECK_EQ(v->shape[1], x->shape[1]);
+  CHECK_EQ(values->shape[0], rows->shape[0]);
+  CHECK_EQ(values->shape[1], x->shape[1]);
+  // Only the rows in the gradient are updated, so x and v are updated in place.
+  call->out = TupleValue::make(tvm::Array<Value>({args->v, args->x}));
+  call->device = x->device;
+})
+    .set_attr<TOpPattern>("TOpPattern", kOpaque)
+    .set_attr<TRAFInplaceUpdate>("TRAFInplaceUpdate", {{0, 1}, {3, 0}});
 
 void LansDecl(const CallValues& call) {
   const auto* args = call->args.as<LansArgs>();
   CHECK(args != nullptr);
   CHECK(args->tensor_list.size() % 4 == 0);
+  CheckSkip(args->skip);
   const DLTensor* x = args->tensor_list[0];
   call->device = x->device;
   int ntensors = args->tensor_list.size() / 4;
@@ -60,6 +88,126 @@ void LansDecl(const CallValues& call) {
 RAF_OP_DECLARE("raf.op.lans", LansDecl)
     .set_attr<TOpPattern>("TOpPattern", kOpaque)
     .set_attr<TRAFInplaceUpdate>("TRAFInplaceUpdate", {{0, 0}});
+/*!
+ * \brief The fused optimizers update the groups of tensor_list in place, where each group holds
+ * one tensor per parameter. A trailing group of weight copies is added with master weights.
+ */
+template <typename TArgs, int kNumGroups>
+void MultiTensorOptimDecl(const CallValues& call) {
+  const auto* args = call->args.as<TArgs>();
+  CHECK(args != nullptr);
+  int num_groups = kNumGroups + args->master_weights;
+  CheckSkip(args->skip);
+  CHECK(!args->tensor_list.empty() && args->tensor_list.size() % num_groups == 0)
+      << "The tensor list is expected to hold " << num_groups << " groups, but got "
+      << args->tensor_list.size() << " tensors";
+  int ntensors = args->tensor_list.size() / num_groups;
+  for (int i = 0; i < ntensors; ++i) {
+    const DLTensor* w = args->tensor_list[ntensors + i];
+    for (int g = 0; g < num_groups; ++g) {
+      const DLTensor* t = args->tensor_list[g * ntensors + i];
+      CHECK_EQ(t->ndim, w->ndim);
+      for (int j = 0; j < w->ndim; ++j) {
+        CHECK_EQ(t->shape[j], w->shape[j]);
+      }
+    }
+  }
+  const DLTensor* x = args->tensor_list[0];
+  call->device = x->device;
+  Array<Value> output(args->tensor_list.begin(), args->tensor_list.end());
+  call->out = TupleValue::make(output);
+}
+
+RAF_OP_DECLARE("raf.op.multi_sgd", (MultiTensorOptimDecl<MultiSgdArgs, 3>))
+    .set_attr<TOpPattern>("TOpPattern", kOpaque)
+    .set_attr<TRAFInplaceUpdate>("TRAFInplaceUpdate", {{0, 0}});
+
+RAF_OP_DECLARE("raf.op.adamw", (MultiTensorOptimDecl<AdamwArgs, 4>))
+    .set_attr<TOpPattern>("TOpPattern", kOpaque)
+    .set_attr<TRAFInplaceUpdate>("TRAFInplaceUpdate", {{0, 0}});
+
+RAF_OP_DECLARE("raf.op.lamb", (MultiTensorOptimDecl<LambArgs, 4>))
+    .set_attr<TOpPattern>("TOpPattern", kOpaque)
+    .set_attr<TRAFInplaceUpdate>("TRAFInplaceUpdate", {{0, 0}});
+
+/*! \brief Check that the tensors are float32 or float16 of the same dtype on the same device. */
+void CheckTensorList(const std::vector<BaseTensorValue>& tensor_list) {
+  CHECK(!tensor_list.empty()) << "The tensor list is empty";
+  const DLTensor* t0 = tensor_list[0];
+  CHECK(t0->dtype.code == kDLFloat && (t0->dtype.bits == 32 || t0->dtype.bits == 16))
+      << "Unsupported dtype: " << DType(t0->dtype).c_str();
+  for (const DLTensor* t : tensor_list) {
+    CHECK(t->dtype == t0->dtype) << "The tensors must have the same dtype";
+    CHECK(t->device == t0->device) << "The tensors must be on the same device";
+  }
+}
+
+RAF_OP_DECLARE("raf.op.multi_tensor_l2norm", [](const CallValues& call) {
+  const auto* args = call->args.as<MultiTensorL2normArgs>();
+  CHECK(args != nullptr);
+  CheckTensorList(args->tensor_list);
+  const DLTensor* x = args->tensor_list[0];
+  int64_t ntensors = args->tensor_list.size();
+  // The norms of the tensors and the global norm of all tensors, which are float32.
+  DType dtype(DTypeCode::kFloat(), 32);
+  call->device = x->device;
+  call->out = TupleValue::make({TensorValue::Assemble(x->device, dtype, {ntensors}),
+                                TensorValue::Assemble(x->device, dtype, {})});
+}).set_attr<TOpPattern>("TOpPattern", kOpaque);
+
+RAF_OP_DECLARE("raf.op.multi_tensor_clip", [](const CallValues& call) {
+  const auto* args = call->args.as<MultiTensorClipArgs>();
+  CHECK(args != nullptr);
+  CheckTensorList(args->tensor_list);
+  const DLTensor* norm = args->norm;
+  CHECK(norm->ndim == 0 && norm->dtype.code == kDLFloat && norm->dtype.bits == 32)
+      << "The norm is expected to be a float32 scalar";
+  const DLTensor* x = args->tensor_list[0];
+  call->device = x->device;
+  Array<Value> output(args->tensor_list.begin(), args->tensor_list.end());
+  call->out = TupleValue::make(output);
+})
+    .set_attr<TOpPattern>("TOpPattern", kOpaque)
+    .set_attr<TRAFInplaceUpdate>("TRAFInplaceUpdate", {{0, 0}});
+
+/*! \brief Check that the tensor is a float32 scalar on the device of the tensor list. */
+void CheckScalar(const DLTensor* t, const DLTensor* x, const std::string& name) {
+  CHECK(t->ndim == 0 && t->dtype.code == kDLFloat && t->dtype.bits == 32)
+      << "The " << name << " is expected to be a float32 scalar";
+  CHECK(t->device.device_type == x->device.device_type &&
+        t->device.device_id == x->device.device_id)
+      << "The " << name << " is expected to be on the same device";
+}
+
+RAF_OP_DECLARE("raf.op.multi_tensor_unscale", [](const CallValues& call) {
+  const auto* args = call->args.as<MultiTensorUnscaleArgs>();
+  CHECK(args != nullptr);
+  CheckTensorList(args->tensor_list);
+  const DLTensor* x = args->tensor_list[0];
+  CheckScalar(args->loss_scale, x, "loss scale");
+  // The tensors are unscaled in place, followed by the flag of whether any of them is not finite.
+  Array<Value> output(args->tensor_list.begin(), args->tensor_list.end());
+  output.push_back(TensorValue::Assemble(x->device, DType(DTypeCode::kFloat(), 32), {}));
+  call->device = x->device;
+  call->out = TupleValue::make(output);
+})
+    .set_attr<TOpPattern>("TOpPattern", kOpaque)
+    .set_attr<TRAFInplaceUpdate>("TRAFInplaceUpdate", {{0, 0}});
+
+RAF_OP_DECLARE("raf.op.update_loss_scale", [](const CallValues& call) {
+  const auto* args = call->args.as<UpdateLossScaleArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* scale = args->loss_scale;
+  CheckScalar(scale, scale, "loss scale");
+  CheckScalar(args->growth_tracker, scale, "growth tracker");
+  CheckScalar(args->found_inf, scale, "found_inf flag");
+  CHECK_GT(args->growth_interval, 0) << "The growth interval must be positive";
+  call->device = scale->device;
+  call->out = TupleValue::make({args->loss_scale, args->growth_tracker});
+})
+    .set_attr<TOpPattern>("TOpPattern", kOpaque)
+    .set_attr<TRAFInplaceUpdate>("TRAFInplaceUpdate", {{0, 0}, {1, 1}});
+
 }  // namespace declare
 }  // namespace op
 }  // namespace raf
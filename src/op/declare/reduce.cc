@@ -104,6 +104,17 @@ void MeanDxDecl(const CallValues& call) {
                                     /*shape=*/shape);
 }
 
+void MomentsDecl(const CallValues& call) {
+  // the mean and the (biased) variance over the reduced axes, which have the same shape
+  const auto* args = call->args.as<ReduceArgs>();
+  DLTensor* x = args->x;
+  std::vector<int64_t> shape;
+  GenerateReduceShape(args, x, &shape);
+  call->device = x->device;
+  call->out = TupleValue::make({TensorValue::Assemble(x->device, x->dtype, shape),
+                                TensorValue::Assemble(x->device, x->dtype, shape)});
+}
+
 RAF_OP_DECLARE("raf.op.argmax", ReduceOutInt);
 RAF_OP_DECLARE("raf.op.argmin", ReduceOutInt);
 RAF_OP_DECLARE("raf.op.max", ReduceOutSame);
@@ -114,6 +125,7 @@ RAF_OP_DECLARE("raf.op.mean", ReduceOutSame);
 RAF_OP_DECLARE("raf.op.prod", ReduceOutSame);
 RAF_OP_DECLARE("raf.op.mean_dx", MeanDxDecl);
 RAF_OP_DECLARE("raf.op.prod_dx", ProdDxOutSame);
+RAF_OP_DECLARE("raf.op.moments", MomentsDecl);
 
 void L2Norm(const CallValues& call) {
   const auto* args = call->args.as<L2NormArgs>();
@@ -290,6 +290,26 @@ RAF_OP_DECLARE("raf.op.embedding_dx", [](const CallValues& call) {
   call->device = dy->device;
 });
 
+RAF_OP_DECLARE("raf.op.embedding_sparse_dx", [](const CallValues& call) {
+  const auto* args = call->args.as<EmbeddingDxArgs>();
+  CHECK(args != nullptr);
+  DLTensor* dy = args->dy;
+  DLTensor* indices = args->indices;
+  int64_t n = 1;
+  for (int i = 0; i < indices->ndim; ++i) {
+    n *= indices->shape[i];
+  }
+  int64_t stride = dy->shape[dy->ndim - 1];
+  auto rows = TensorValue::Assemble(/*dev=*/dy->device,
+                                    /*dtype=*/DType(DTypeCode::kInt(), 64),
+                                    /*shape=*/{n});
+  auto values = TensorValue::Assemble(/*dev=*/dy->device,
+                                      /*dtype=*/dy->dtype,
+                                      /*shape=*/{n, stride});
+  call->out = TupleValue::make(tvm::Array<Value>({rows, values}));
+  call->device = dy->device;
+});
+
 RAF_OP_DECLARE("raf.op.expand_dims", [](const CallValues& call) {
   const auto* args = call->args.as<ExpandDimsArgs>();
   CHECK(args != nullptr);
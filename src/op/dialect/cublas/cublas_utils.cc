@@ -19,12 +19,29 @@ namespace cublas {
 using CUBlasThreadStore = dmlc::ThreadLocalStore<CUBlasThreadEntry>;
 
 CUBlasThreadEntry::CUBlasThreadEntry() {
+  CUDA_CALL(cudaGetDevice(&device_id));
   CUBLAS_CALL(cublasCreate(&handle));
   CUBLASTryEnableTensorCore(handle);
+  handles[device_id] = handle;
 }
 
 CUBlasThreadEntry* CUBlasThreadEntry::ThreadLocal() {
-  return CUBlasThreadStore::Get();
+  CUBlasThreadEntry* entry = CUBlasThreadStore::Get();
+  int device_id = 0;
+  CUDA_CALL(cudaGetDevice(&device_id));
+  if (device_id != entry->device_id) {
+    // Switch to the handle of the current device, e.g., when the ops are placed on multiple GPUs.
+    auto it = entry->handles.find(device_id);
+    if (it == entry->handles.end()) {
+      cublasHandle_t handle = nullptr;
+      CUBLAS_CALL(cublasCreate(&handle));
+      CUBLASTryEnableTensorCore(handle);
+      it = entry->handles.emplace(device_id, handle).first;
+    }
+    entry->handle = it->second;
+    entry->device_id = device_id;
+  }
+  return entry;
 }
 
 RAF_REGISTER_DIALECT("cublas").set_enable(DevType::kCUDA());
@@ -9,6 +9,7 @@
  */
 #pragma once
 #include <cublas_v2.h>
+#include <unordered_map>
 #include "raf/device.h"
 #include "raf/enum_base.h"
 #include "raf/ir.h"
@@ -68,7 +69,12 @@ class CUBlasThreadEntry {
   static CUBlasThreadEntry* ThreadLocal();
 
  public:
+  /*! \brief The handle of the current device. */
   cublasHandle_t handle{nullptr};
+  /*! \brief The device of the handle. */
+  int device_id{-1};
+  /*! \brief The handles of the devices, as a handle is bound to the device it is created on. */
+  std::unordered_map<int, cublasHandle_t> handles;
 };
 
 inline void SetStream(cudaStream_t stream) {
@@ -0,0 +1,44 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cublaslt/cublaslt_utils.cc
+ * \brief Helper functions for cuBLASLt
+ */
+#include "dmlc/thread_local.h"
+#include "raf/dialect.h"
+#include "./cublaslt_utils.h"
+
+namespace raf {
+namespace op {
+namespace cublaslt {
+
+using CUBlasLtThreadStore = dmlc::ThreadLocalStore<CUBlasLtThreadEntry>;
+
+CUBlasLtThreadEntry::CUBlasLtThreadEntry() {
+  CUBLASLT_CALL(cublasLtCreate(&handle));
+}
+
+CUBlasLtThreadEntry* CUBlasLtThreadEntry::ThreadLocal() {
+  return CUBlasLtThreadStore::Get();
+}
+
+RAF_REGISTER_DIALECT("cublaslt").set_enable(DevType::kCUDA());
+
+// The ops are only dispatched to cuBLASLt as a part of the fused functions, so they are
+// registered with a non-positive plevel. Note that plevel 0 is already taken by CUTLASS.
+RAF_REGISTER_DIALECT_OP(cublaslt, matmul, -1);
+RAF_REGISTER_DIALECT_OP(cublaslt, matmul_nt, -1);
+RAF_REGISTER_DIALECT_OP(cublaslt, matmul_tn, -1);
+RAF_REGISTER_DIALECT_OP(cublaslt, matmul_tt, -1);
+RAF_REGISTER_DIALECT_OP(cublaslt, dense, -1);
+RAF_REGISTER_DIALECT_OP(cublaslt, add, -1);
+RAF_REGISTER_DIALECT_OP(cublaslt, relu, -1);
+RAF_REGISTER_DIALECT_OP(cublaslt, gelu, -1);
+RAF_REGISTER_DIALECT_OP(cublaslt, _contrib_fp8_dense, -1);
+
+}  // namespace cublaslt
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,45 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cublaslt/cublaslt_utils.h
+ * \brief Helper functions for cuBLASLt
+ */
+#pragma once
+#include <cublasLt.h>
+#include "raf/device.h"
+#include "raf/device_api.h"
+#include "raf/ir.h"
+#include "../cublas/cublas_utils.h"
+
+#define CUBLASLT_CALL(func)                                            \
+  do {                                                                 \
+    cublasStatus_t e = (func);                                         \
+    CHECK_EQ(e, CUBLAS_STATUS_SUCCESS)                                 \
+        << "cublasLt: " << ::raf::op::cublas::cublasGetErrorString(e); \
+  } while (false)
+
+namespace raf {
+namespace op {
+namespace cublaslt {
+
+class CUBlasLtThreadEntry {
+ public:
+  CUBlasLtThreadEntry();
+  static CUBlasLtThreadEntry* ThreadLocal();
+
+ public:
+  cublasLtHandle_t handle{nullptr};
+};
+
+/*! \brief cuBLASLt takes the stream per call, so the current stream of the device is used. */
+inline cudaStream_t GetStream() {
+  static auto cuda_device_api = device_api::DeviceAPI::Get(DevType::kCUDA());
+  return static_cast<cudaStream_t>(cuda_device_api->GetStream());
+}
+
+}  // namespace cublaslt
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,445 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cublaslt/matmul.cc
+ * \brief Dispatch fused matmul functions to cuBLASLt, whose epilogues apply the bias and the
+ * activation in the GEMM kernel, and the FP8 dense layers, which are rescaled by the per-tensor
+ * scales of the inputs.
+ */
+#include <algorithm>
+#include <cstring>
+#include "raf/cache.h"
+#include "raf/op.h"
+#include "raf/op_utils.h"
+#include "raf/pass.h"
+#include "raf/value.h"
+#include "../3rdparty/tvm/src/runtime/file_utils.h"
+#include "./cublaslt_utils.h"
+
+namespace raf {
+namespace op {
+namespace cublaslt {
+
+using namespace raf::ir;
+using namespace raf::value;
+
+/*! \brief The maximum workspace size that the heuristic may use, which is 32 MiB. */
+constexpr uint64_t kMaxWorkspaceBytes = 32 << 20;
+
+/*! \brief The cache entry of the algorithm selected for a problem. */
+class CublasLtAlgoCacheEntry {
+ public:
+  explicit CublasLtAlgoCacheEntry(cublasLtMatmulHeuristicResult_t result) : result_(result) {
+  }
+
+  const cublasLtMatmulHeuristicResult_t& Value() const {
+    return result_;
+  }
+
+  static CublasLtAlgoCacheEntry Load(const std::string& path) {
+    std::string data;
+    tvm::runtime::LoadBinaryFromFile(path + "/value.bin", &data);
+    CHECK_EQ(data.size(), sizeof(cublasLtMatmulHeuristicResult_t));
+    cublasLtMatmulHeuristicResult_t result;
+    std::memcpy(&result, data.data(), sizeof(result));
+    return CublasLtAlgoCacheEntry(result);
+  }
+
+  bool Save(const std::string& path) {
+    std::string data(reinterpret_cast<const char*>(&result_), sizeof(result_));
+    tvm::runtime::SaveBinaryToFile(path + "/value.bin", data);
+    return true;
+  }
+
+ private:
+  /*! \brief The algorithm and its workspace size, which are opaque to RAF. */
+  cublasLtMatmulHeuristicResult_t result_;
+};
+
+MetaPersistCache<CublasLtAlgoCacheEntry> CacheCublasLtAlgo("cublaslt_matmul_algo", true);
+
+/*! \brief Get the param of the fused function, or an undefined var if it is not a param. */
+inline Var GetParam(const Expr& expr) {
+  return expr->IsInstance<VarNode>() ? Downcast<Var>(expr) : Var();
+}
+
+/*! \brief The cuBLASLt data type of the uint8 bits of the FP8 format. */
+inline cudaDataType_t GetFp8DataType(bool e5m2) {
+#if CUDA_VERSION >= 11080
+  return e5m2 ? CUDA_R_8F_E5M2 : CUDA_R_8F_E4M3;
+#else
+  LOG(FATAL) << "FP8 matmul requires CUDA 11.8 or later";
+  throw;
+#endif
+}
+
+/*!
+ * \brief The fused matmul function dispatched to cuBLASLt. Patterns supported:
+ *   - matmul_op(a, b) + bias
+ *   - epilogue_op(matmul_op(a, b) + bias)
+ *   - epilogue_op(matmul_op(a, b))
+ * where matmul_op = matmul | matmul_nt | matmul_tn | matmul_tt | dense, and
+ * epilogue_op = relu | gelu. A bias broadcast along the rows is applied by the BIAS epilogue,
+ * and a bias in the full output shape (e.g., a residual) is accumulated as the C matrix. Note
+ * that the GELU epilogue of cuBLASLt uses the tanh approximation. The FP8 dense, i.e.,
+ * _contrib_fp8_dense(x, w, x_scale, w_scale), takes the scales as the device pointers of the
+ * scales of cuBLASLt, which only supports the inputs in the TN layout, i.e., the dense.
+ */
+class CublasLtMatmulOpEnv : public OpEnv {
+ public:
+  explicit CublasLtMatmulOpEnv(const CallValues& cv) : device_(cv->device) {
+  }
+
+  ~CublasLtMatmulOpEnv() {
+    if (matmul_desc_) {
+      CUBLASLT_CALL(cublasLtMatmulDescDestroy(matmul_desc_));
+    }
+    for (auto desc : {a_desc_, b_desc_, c_desc_}) {
+      if (desc) {
+        CUBLASLT_CALL(cublasLtMatrixLayoutDestroy(desc));
+      }
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cublaslt.matmul"));
+  }
+
+  /*! \brief Match the body of the fused function, and return whether it is supported. */
+  bool Pattern(const CallValues& cv) {
+    static const std::vector<Op> matmul_ops = {
+        Op::Get("raf.op.cublaslt.matmul"), Op::Get("raf.op.cublaslt.matmul_nt"),
+        Op::Get("raf.op.cublaslt.matmul_tn"), Op::Get("raf.op.cublaslt.matmul_tt"),
+        Op::Get("raf.op.cublaslt.dense")};
+    static const Op& add_op = Op::Get("raf.op.cublaslt.add");
+    static const Op& relu_op = Op::Get("raf.op.cublaslt.relu");
+    static const Op& gelu_op = Op::Get("raf.op.cublaslt.gelu");
+    static const Op& fp8_dense_op = Op::Get("raf.op.cublaslt._contrib_fp8_dense");
+    Function func = Downcast<ClosureValue>(cv->callee)->func;
+    auto call = func->body.as<CallNode>();
+    if (call && call->op == fp8_dense_op && call->args.size() == 7U) {
+      fp8_ = true;
+      transpose_b_ = true;
+      a_ = GetParam(call->args[0]);
+      b_ = GetParam(call->args[1]);
+      a_scale_ = GetParam(call->args[2]);
+      b_scale_ = GetParam(call->args[3]);
+      return a_.defined() && b_.defined() && a_scale_.defined() && b_scale_.defined() &&
+             GetBoolArg(cv, call->args[5], &a_e5m2_) && GetBoolArg(cv, call->args[6], &b_e5m2_);
+    }
+    if (call && (call->op == relu_op || call->op == gelu_op)) {
+      epilogue_op_ = Downcast<Op>(call->op);
+      call = call->args[0].as<CallNode>();
+    }
+    if (call && call->op == add_op) {
+      // The add is commutative, so the matmul may be either of its arguments.
+      auto lhs = call->args[0].as<CallNode>();
+      bias_ = GetParam(call->args[lhs ? 1 : 0]);
+      call = lhs ? lhs : call->args[1].as<CallNode>();
+      if (!bias_.defined()) {
+        return false;
+      }
+    }
+    if (!call || std::find(matmul_ops.begin(), matmul_ops.end(), call->op) == matmul_ops.end()) {
+      return false;
+    }
+    auto op = Downcast<Op>(call->op);
+    transpose_a_ = op == matmul_ops[2] || op == matmul_ops[3];
+    transpose_b_ = op == matmul_ops[1] || op == matmul_ops[3] || op == matmul_ops[4];
+    a_ = GetParam(call->args[0]);
+    b_ = GetParam(call->args[1]);
+    return a_.defined() && b_.defined();
+  }
+
+  /*! \brief Check whether the dtypes and the bias shape are supported by cuBLASLt. */
+  bool IsValid(const CallValues& cv) {
+    DLTensor* a = GetArg(cv, a_);
+    DLTensor* b = GetArg(cv, b_);
+    DLTensor* out = cv->out;
+    DType dtype(out->dtype);
+    if (dtype.code != DTypeCode::kFloat() || (dtype.bits != 16 && dtype.bits != 32) ||
+        dtype.lanes != 1 || a->ndim != 2 || b->ndim != 2) {
+      return false;
+    }
+    if (fp8_) {
+      return IsValidFp8(a, b);
+    }
+    if (DType(a->dtype) != dtype || DType(b->dtype) != dtype) {
+      return false;
+    }
+#if CUDA_VERSION < 11030
+    if (epilogue_op_.defined() && epilogue_op_->name == "raf.op.cublaslt.gelu") {
+      return false;
+    }
+#endif
+    if (bias_.defined()) {
+      DLTensor* bias = GetArg(cv, bias_);
+      if (DType(bias->dtype) != dtype) {
+        return false;
+      }
+      // The bias is either a vector with the length of the last dimension, or a full matrix.
+      int64_t n = out->shape[1];
+      bool is_vector = (bias->ndim == 1 && bias->shape[0] == n) ||
+                       (bias->ndim == 2 && bias->shape[0] == 1 && bias->shape[1] == n);
+      bool is_matrix = bias->ndim == 2 && bias->shape[0] == out->shape[0] && bias->shape[1] == n;
+      if (!is_vector && !is_matrix) {
+        return false;
+      }
+      full_bias_ = is_matrix && !is_vector;
+    }
+    return true;
+  }
+
+  void Init(const CallValues& cv) {
+    DLTensor* a = GetArg(cv, a_);
+    DLTensor* b = GetArg(cv, b_);
+    DLTensor* out = cv->out;
+    // RAF tensors are row-major, while cuBLASLt matrices are column-major, so we compute
+    // out^T = op(b)^T * op(a)^T, where b is the matrix A of cuBLASLt and a is the matrix B.
+    int64_t m = out->shape[1];
+    int64_t n = out->shape[0];
+    int64_t k = b->shape[transpose_b_];
+    cudaDataType_t data_type = cudaDataType_t(DType(out->dtype));
+    cudaDataType_t a_type = fp8_ ? GetFp8DataType(b_e5m2_) : data_type;
+    cudaDataType_t b_type = fp8_ ? GetFp8DataType(a_e5m2_) : data_type;
+    cublasComputeType_t compute_type = CUBLAS_COMPUTE_32F;
+    bool allow_tf32 = pass::PassContext::Current()
+                          ->GetConfig<tvm::Bool>("raf.cublas.allow_tf32", tvm::Bool(true))
+                          .value();
+    if (data_type == CUDA_R_32F && allow_tf32 && !fp8_) {
+      compute_type = CUBLAS_COMPUTE_32F_FAST_TF32;
+    }
+
+    CUBLASLT_CALL(cublasLtMatmulDescCreate(&matmul_desc_, compute_type, CUDA_R_32F));
+    cublasOperation_t transa = transpose_b_ ? CUBLAS_OP_T : CUBLAS_OP_N;
+    cublasOperation_t transb = transpose_a_ ? CUBLAS_OP_T : CUBLAS_OP_N;
+    CUBLASLT_CALL(cublasLtMatmulDescSetAttribute(matmul_desc_, CUBLASLT_MATMUL_DESC_TRANSA,
+                                                 &transa, sizeof(transa)));
+    CUBLASLT_CALL(cublasLtMatmulDescSetAttribute(matmul_desc_, CUBLASLT_MATMUL_DESC_TRANSB,
+                                                 &transb, sizeof(transb)));
+    cublasLtEpilogue_t epilogue = GetEpilogue();
+    CUBLASLT_CALL(cublasLtMatmulDescSetAttribute(matmul_desc_, CUBLASLT_MATMUL_DESC_EPILOGUE,
+                                                 &epilogue, sizeof(epilogue)));
+
+    CUBLASLT_CALL(cublasLtMatrixLayoutCreate(&a_desc_, a_type, transpose_b_ ? k : m,
+                                             transpose_b_ ? m : k, transpose_b_ ? k : m));
+    CUBLASLT_CALL(cublasLtMatrixLayoutCreate(&b_desc_, b_type, transpose_a_ ? n : k,
+                                             transpose_a_ ? k : n, transpose_a_ ? n : k));
+    CUBLASLT_CALL(cublasLtMatrixLayoutCreate(&c_desc_, data_type, m, n, m));
+    beta_ = full_bias_ ? 1.0f : 0.0f;
+
+    algo_ = FindAlgo(cv, m, n, k);
+    if (algo_.workspaceSize > 0) {
+      RequestWorkspace(&workspace_, cv->device, algo_.workspaceSize);
+    }
+    std::vector<Var> params = {a_, b_};
+    if (bias_.defined()) {
+      params.push_back(bias_);
+    }
+    if (fp8_) {
+      params.push_back(a_scale_);
+      params.push_back(b_scale_);
+    }
+    for (const auto& param : params) {
+      arg_indices.push_back(GetParamIndex(cv, param));
+    }
+  }
+
+  void Execute(const CallValues& cv) override {
+    Array<Value> args = GetListArgs(cv->args);
+    std::vector<Value> inputs;
+    for (const auto& i : arg_indices) {
+      inputs.push_back(args[i]);
+    }
+    Execute(inputs, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    DLTensor* a = Downcast<TensorValue>(inputs[0]);
+    DLTensor* b = Downcast<TensorValue>(inputs[1]);
+    DLTensor* out = Downcast<TensorValue>(output);
+    void* c = out->data;
+    if (fp8_) {
+#if CUDA_VERSION >= 11080
+      // The matrix A of cuBLASLt is b, and the matrix B is a.
+      DLTensor* a_scale = Downcast<TensorValue>(inputs[2]);
+      DLTensor* b_scale = Downcast<TensorValue>(inputs[3]);
+      CUBLASLT_CALL(cublasLtMatmulDescSetAttribute(matmul_desc_,
+                                                   CUBLASLT_MATMUL_DESC_A_SCALE_POINTER,
+                                                   &b_scale->data, sizeof(b_scale->data)));
+      CUBLASLT_CALL(cublasLtMatmulDescSetAttribute(matmul_desc_,
+                                                   CUBLASLT_MATMUL_DESC_B_SCALE_POINTER,
+                                                   &a_scale->data, sizeof(a_scale->data)));
+#endif
+    }
+    if (bias_.defined()) {
+      DLTensor* bias = Downcast<TensorValue>(inputs[2]);
+      if (full_bias_) {
+        c = bias->data;
+      } else {
+        CUBLASLT_CALL(cublasLtMatmulDescSetAttribute(
+            matmul_desc_, CUBLASLT_MATMUL_DESC_BIAS_POINTER, &bias->data, sizeof(bias->data)));
+      }
+    }
+    CUBLASLT_CALL(cublasLtMatmul(CUBlasLtThreadEntry::ThreadLocal()->handle, matmul_desc_, &alpha_,
+                                 b->data, a_desc_, a->data, b_desc_, &beta_, c, c_desc_, out->data,
+                                 c_desc_, &algo_.algo, workspace_, algo_.workspaceSize,
+                                 GetStream()));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    auto op_env = std::make_unique<CublasLtMatmulOpEnv>(cv);
+    bool matched = op_env->Pattern(cv);
+    bool valid = matched && op_env->IsValid(cv);
+    if (!valid) {
+      std::stringstream ss;
+      ss << "[cuBLASLt] Cannot JIT: matched pattern? " << matched << ", valid? " << valid;
+      dispatch_error_msgs.push_back(ss.str());
+      return nullptr;
+    }
+    try {
+      op_env->Init(cv);
+    } catch (const dmlc::Error& e) {
+      std::stringstream ss;
+      ss << "[cuBLASLt] Failed to JIT: " << e.what();
+      dispatch_error_msgs.push_back(ss.str());
+      return nullptr;
+    }
+    return op_env.release();
+  }
+
+ private:
+  /*! \brief Get the index of the param in the fused function. */
+  int GetParamIndex(const CallValues& cv, const Var& var) {
+    Function func = Downcast<ClosureValue>(cv->callee)->func;
+    for (size_t i = 0; i < func->params.size(); ++i) {
+      if (func->params[i] == var) {
+        return i;
+      }
+    }
+    LOG(FATAL) << "Cannot find the param " << var->name_hint();
+    throw;
+  }
+
+  /*! \brief Get the bool arg of the call, which is either a constant or a param. */
+  bool GetBoolArg(const CallValues& cv, const Expr& arg, bool* value) {
+    Value bool_value;
+    if (const auto* constant = arg.as<ConstantNode>()) {
+      bool_value = Downcast<Value>(constant->value);
+    } else if (arg->IsInstance<VarNode>()) {
+      bool_value = GetListArgs(cv->args)[GetParamIndex(cv, Downcast<Var>(arg))];
+    }
+    if (!bool_value.defined()) {
+      return false;
+    }
+    *value = GetScalarValueData<bool>(bool_value);
+    return true;
+  }
+
+  /*!
+   * \brief Check whether cuBLASLt supports the FP8 dense. FP8 requires CUDA 11.8 and Ada or later
+   * GPUs, the E5M2 inputs cannot be multiplied by each other, and the rows of the inputs are
+   * aligned to 16 bytes.
+   */
+  bool IsValidFp8(const DLTensor* a, const DLTensor* b) {
+#if CUDA_VERSION >= 11080
+    cudaDeviceProp prop;
+    CUDA_CALL(cudaGetDeviceProperties(&prop, device_.device_id()));
+    auto is_fp8 = [](const DLTensor* x) {
+      return x->dtype.code == kDLUInt && x->dtype.bits == 8 && x->dtype.lanes == 1;
+    };
+    int64_t k = a->shape[1];
+    return prop.major * 10 + prop.minor >= 89 && is_fp8(a) && is_fp8(b) &&
+           !(a_e5m2_ && b_e5m2_) && k % 16 == 0 && b->shape[0] % 16 == 0;
+#else
+    return false;
+#endif
+  }
+
+  DLTensor* GetArg(const CallValues& cv, const Var& var) {
+    Array<Value> args = GetListArgs(cv->args);
+    return Downcast<TensorValue>(args[GetParamIndex(cv, var)]);
+  }
+
+  cublasLtEpilogue_t GetEpilogue() const {
+    bool with_bias = bias_.defined() && !full_bias_;
+    if (!epilogue_op_.defined()) {
+      return with_bias ? CUBLASLT_EPILOGUE_BIAS : CUBLASLT_EPILOGUE_DEFAULT;
+    }
+    if (epilogue_op_->name == "raf.op.cublaslt.relu") {
+      return with_bias ? CUBLASLT_EPILOGUE_RELU_BIAS : CUBLASLT_EPILOGUE_RELU;
+    }
+#if CUDA_VERSION >= 11030
+    if (epilogue_op_->name == "raf.op.cublaslt.gelu") {
+      return with_bias ? CUBLASLT_EPILOGUE_GELU_BIAS : CUBLASLT_EPILOGUE_GELU;
+    }
+#endif
+    LOG(FATAL) << "Unsupported epilogue op: " << epilogue_op_->name;
+    throw;
+  }
+
+  /*!
+   * \brief Find the algorithm with cublasLtMatmulAlgoGetHeuristic. The heuristic only depends on
+   * the problem and the GPU, so the result is cached persistently.
+   */
+  cublasLtMatmulHeuristicResult_t FindAlgo(const CallValues& cv, int64_t m, int64_t n,
+                                           int64_t k) {
+    cudaDeviceProp prop;
+    CUDA_CALL(cudaGetDeviceProperties(&prop, device_.device_id()));
+    HashKey key;
+    key << prop.major * 10 + prop.minor << std::string(DType(cv->out->dtype).c_str()) << m << n
+        << k << transpose_a_ << transpose_b_ << static_cast<int>(GetEpilogue()) << full_bias_
+        << fp8_ << a_e5m2_ << b_e5m2_;
+    if (auto cached = CacheCublasLtAlgo.Get(key.byte_vector)) {
+      return cached->Value();
+    }
+
+    cublasLtMatmulPreference_t preference;
+    CUBLASLT_CALL(cublasLtMatmulPreferenceCreate(&preference));
+    CUBLASLT_CALL(cublasLtMatmulPreferenceSetAttribute(preference,
+                                                       CUBLASLT_MATMUL_PREF_MAX_WORKSPACE_BYTES,
+                                                       &kMaxWorkspaceBytes, sizeof(uint64_t)));
+    cublasLtMatmulHeuristicResult_t result;
+    int num_results = 0;
+    CUBLASLT_CALL(cublasLtMatmulAlgoGetHeuristic(CUBlasLtThreadEntry::ThreadLocal()->handle,
+                                                 matmul_desc_, a_desc_, b_desc_, c_desc_,
+                                                 c_desc_, preference, 1, &result, &num_results));
+    CUBLASLT_CALL(cublasLtMatmulPreferenceDestroy(preference));
+    CHECK_GT(num_results, 0) << "No cuBLASLt algorithm for the problem (" << m << ", " << n
+                             << ", " << k << ")";
+    CacheCublasLtAlgo.Set(key.byte_vector, CublasLtAlgoCacheEntry(result));
+    return result;
+  }
+
+  /*! \brief The device to run the matmul. */
+  Device device_;
+  /*! \brief The params of the fused function for the inputs and the bias. */
+  Var a_, b_, bias_;
+  /*! \brief The params of the per-tensor scales of the FP8 inputs. */
+  Var a_scale_, b_scale_;
+  /*! \brief Whether the inputs are FP8, and whether each of them is in E5M2 or E4M3. */
+  bool fp8_{false}, a_e5m2_{false}, b_e5m2_{false};
+  /*! \brief Whether the inputs are transposed. */
+  bool transpose_a_{false}, transpose_b_{false};
+  /*! \brief Whether the bias is in the full output shape, and accumulated as the C matrix. */
+  bool full_bias_{false};
+  /*! \brief The activation applied by the epilogue, undefined if there is no activation. */
+  Op epilogue_op_;
+  /*! \brief The cuBLASLt descriptors. */
+  cublasLtMatmulDesc_t matmul_desc_{nullptr};
+  cublasLtMatrixLayout_t a_desc_{nullptr}, b_desc_{nullptr}, c_desc_{nullptr};
+  /*! \brief The scaling factors of the float32 compute type. */
+  float alpha_{1.0f}, beta_{0.0f};
+  /*! \brief The selected algorithm and its workspace. */
+  cublasLtMatmulHeuristicResult_t algo_;
+  void* workspace_{nullptr};
+};
+
+RAF_OP_ENV_MAKER("raf.op.cublaslt._fused_op", CublasLtMatmulOpEnv::make);
+
+}  // namespace cublaslt
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,339 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/algorithm.cc
+ * \brief argsort, sort and topk cuda backend
+ */
+#include <limits>
+#include "raf/op.h"
+#include "raf/op_utils.h"
+#include "raf/device_api.h"
+#include "../../schema/algorithm.h"
+#include "./kernels/sort.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+using namespace raf::ir;
+using namespace raf::value;
+using device_api::DeviceAPI;
+
+using namespace c10;
+
+/*!
+ * \brief Check whether the kernels support sorting data along the axis, and push the reason to
+ * the dispatch errors if not, so the op falls back to the other dialects.
+ */
+bool IsSortSupported(const DLTensor* data, int axis, const DLDataType& index_dtype) {
+  std::string reason;
+  const DLDataType& dtype = data->dtype;
+  bool float_key = dtype.code == kDLFloat && (dtype.bits == 16 || dtype.bits == 32);
+  bool int_key = dtype.code == kDLInt && (dtype.bits == 32 || dtype.bits == 64);
+  int64_t n = 1;
+  for (int i = 0; i < data->ndim; ++i) {
+    n *= data->shape[i];
+  }
+  // The segments are the trailing axis, so the other axes need a transpose, which is left to TVM.
+  if (axis < 0) {
+    axis += data->ndim;
+  }
+  if (!float_key && !int_key) {
+    reason = "unsupported dtype " + std::string(DType(dtype).c_str());
+  } else if (index_dtype.code != kDLInt || (index_dtype.bits != 32 && index_dtype.bits != 64)) {
+    reason = "unsupported index dtype " + std::string(DType(index_dtype).c_str());
+  } else if (data->ndim == 0 || axis != data->ndim - 1) {
+    reason = "only the last axis is supported";
+  } else if (n > std::numeric_limits<int>::max()) {
+    reason = "too many elements";
+  }
+  if (!reason.empty()) {
+    dispatch_error_msgs.push_back("[CUDA] Cannot sort: " + reason);
+    return false;
+  }
+  return true;
+}
+
+/*! \brief The segmented radix sort of argsort and sort. */
+class SortImpl : public raf::op::OpEnv {
+ public:
+  /*!
+   * \brief Initialize the problem.
+   * \param data The data to sort.
+   * \param is_ascend Whether to sort in the ascending order.
+   * \param return_keys Whether the sorted data is returned.
+   * \param return_indices Whether the indices of the sorted data are returned.
+   * \param index_bits The bits of the returned indices.
+   * \param device The device to request the workspace.
+   */
+  void InitProblem(const DLTensor* data, bool is_ascend, bool return_keys, bool return_indices,
+                   int index_bits, const Device& device) {
+    segment_size_ = data->shape[data->ndim - 1];
+    num_segments_ = 1;
+    for (int i = 0; i < data->ndim - 1; ++i) {
+      num_segments_ *= data->shape[i];
+    }
+    is_ascend_ = is_ascend;
+    return_keys_ = return_keys;
+    return_indices_ = return_indices;
+    RequestWorkspace(&workspace_, device, DispatchWorkspaceBytes(data->dtype, index_bits));
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    compute_stream_ = cuda_device_api->GetStream();
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    DLTensor* data = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* out = ir::Downcast<TensorValue>(output);
+    DLTensor* keys = return_keys_ ? out : nullptr;
+    DLTensor* indices = return_indices_ ? out : nullptr;
+    int index_bits = indices ? indices->dtype.bits : 32;
+    switch (data->dtype.bits) {
+      case 16:
+        Launch<Half>(data, keys, indices, index_bits);
+        break;
+      case 32:
+        if (data->dtype.code == kDLFloat) {
+          Launch<float>(data, keys, indices, index_bits);
+        } else {
+          Launch<int32_t>(data, keys, indices, index_bits);
+        }
+        break;
+      case 64:
+        Launch<int64_t>(data, keys, indices, index_bits);
+        break;
+      default:
+        LOG(FATAL) << "Unsupported dtype: " << DType(data->dtype).c_str();
+        throw;
+    }
+  }
+
+ private:
+  template <typename T>
+  void Launch(const DLTensor* data, DLTensor* keys, DLTensor* indices, int index_bits) {
+    const T* in = static_cast<const T*>(data->data);
+    T* sorted = keys ? static_cast<T*>(keys->data) : nullptr;
+    if (index_bits == 32) {
+      HostSegmentedSort<T, int32_t>(in, sorted,
+                                    indices ? static_cast<int32_t*>(indices->data) : nullptr,
+                                    num_segments_, segment_size_, is_ascend_, workspace_,
+                                    compute_stream_);
+    } else {
+      HostSegmentedSort<T, int64_t>(in, sorted,
+                                    indices ? static_cast<int64_t*>(indices->data) : nullptr,
+                                    num_segments_, segment_size_, is_ascend_, workspace_,
+                                    compute_stream_);
+    }
+  }
+
+  template <typename T>
+  size_t WorkspaceBytes(int index_bits) {
+    if (index_bits == 32) {
+      return SegmentedSortWorkspaceBytes<T, int32_t>(num_segments_, segment_size_, return_keys_,
+                                                     return_indices_);
+    }
+    return SegmentedSortWorkspaceBytes<T, int64_t>(num_segments_, segment_size_, return_keys_,
+                                                   return_indices_);
+  }
+
+  size_t DispatchWorkspaceBytes(const DLDataType& dtype, int index_bits) {
+    switch (dtype.bits) {
+      case 16:
+        return WorkspaceBytes<Half>(index_bits);
+      case 32:
+        return dtype.code == kDLFloat ? WorkspaceBytes<float>(index_bits)
+                                      : WorkspaceBytes<int32_t>(index_bits);
+      default:
+        return WorkspaceBytes<int64_t>(index_bits);
+    }
+  }
+
+  int64_t num_segments_;
+  int64_t segment_size_;
+  bool is_ascend_;
+  bool return_keys_;
+  bool return_indices_;
+  void* workspace_;
+  void* compute_stream_;
+};
+
+class ArgsortImpl : public SortImpl {
+ public:
+  explicit ArgsortImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.argsort");
+    auto args = cv->args.as<op::schema::ArgsortArgs>();
+    this->arg_indices = {fschema_index[op]("data")};
+    const DLTensor* out = ir::Downcast<TensorValue>(cv->out);
+    InitProblem(args->data, args->is_ascend, false, true, out->dtype.bits, cv->device);
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::ArgsortArgs>();
+    SortImpl::Execute(std::vector<Value>{args->data}, cv->out);
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.argsort"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    auto args = cv->args.as<op::schema::ArgsortArgs>();
+    const DLTensor* out = ir::Downcast<TensorValue>(cv->out);
+    if (!IsSortSupported(args->data, args->axis, out->dtype)) {
+      return nullptr;
+    }
+    return new ArgsortImpl(cv);
+  }
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, argsort, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.argsort", ArgsortImpl::make);
+
+class SortOpImpl : public SortImpl {
+ public:
+  explicit SortOpImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.sort");
+    auto args = cv->args.as<op::schema::SortArgs>();
+    this->arg_indices = {fschema_index[op]("data")};
+    InitProblem(args->data, args->is_ascend, true, false, 32, cv->device);
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::SortArgs>();
+    SortImpl::Execute(std::vector<Value>{args->data}, cv->out);
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.sort"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    auto args = cv->args.as<op::schema::SortArgs>();
+    if (!IsSortSupported(args->data, args->axis, DLDataType{kDLInt, 32, 1})) {
+      return nullptr;
+    }
+    return new SortOpImpl(cv);
+  }
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, sort, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.sort", SortOpImpl::make);
+
+/*! \brief The shared-memory bitonic top-k for k up to kMaxTopK. */
+class TopkImpl : public raf::op::OpEnv {
+ public:
+  explicit TopkImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.topk");
+    auto args = cv->args.as<op::schema::TopkArgs>();
+    this->arg_indices = {fschema_index[op]("data")};
+    const DLTensor* data = args->data;
+    k_ = GetK(args);
+    is_ascend_ = args->is_ascend;
+    ret_type_ = args->ret_type;
+    segment_size_ = data->shape[data->ndim - 1];
+    num_segments_ = 1;
+    for (int i = 0; i < data->ndim - 1; ++i) {
+      num_segments_ *= data->shape[i];
+    }
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    compute_stream_ = cuda_device_api->GetStream();
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::TopkArgs>();
+    Execute(std::vector<Value>{args->data}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    DLTensor* data = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* values = nullptr;
+    DLTensor* indices = nullptr;
+    if (ret_type_ == "both") {
+      TupleValue out = ir::Downcast<TupleValue>(output);
+      values = ir::Downcast<TensorValue>(out->fields[0]);
+      indices = ir::Downcast<TensorValue>(out->fields[1]);
+    } else if (ret_type_ == "values") {
+      values = ir::Downcast<TensorValue>(output);
+    } else {
+      indices = ir::Downcast<TensorValue>(output);
+    }
+    int index_bits = indices ? indices->dtype.bits : 32;
+    switch (data->dtype.bits) {
+      case 16:
+        Launch<Half>(data, values, indices, index_bits);
+        break;
+      case 32:
+        if (data->dtype.code == kDLFloat) {
+          Launch<float>(data, values, indices, index_bits);
+        } else {
+          Launch<int32_t>(data, values, indices, index_bits);
+        }
+        break;
+      case 64:
+        Launch<int64_t>(data, values, indices, index_bits);
+        break;
+      default:
+        LOG(FATAL) << "Unsupported dtype: " << DType(data->dtype).c_str();
+        throw;
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.topk"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    auto args = cv->args.as<op::schema::TopkArgs>();
+    if (!IsSortSupported(args->data, args->axis, ir::String2DLDataType(args->dtype))) {
+      return nullptr;
+    }
+    int64_t k = GetK(args);
+    if (k < 1 || k > kMaxTopK) {
+      // A large k is as expensive as a full sort, which is left to TVM.
+      dispatch_error_msgs.push_back("[CUDA] Cannot select the top-k: k must be in [1, " +
+                                    std::to_string(kMaxTopK) + "], but got " + std::to_string(k));
+      return nullptr;
+    }
+    return new TopkImpl(cv);
+  }
+
+ private:
+  static int64_t GetK(const op::schema::TopkArgs* args) {
+    return args->k.defined() ? GetScalarValueData<int64_t>(args->k) : 1;
+  }
+
+  template <typename T>
+  void Launch(const DLTensor* data, DLTensor* values, DLTensor* indices, int index_bits) {
+    const T* x = static_cast<const T*>(data->data);
+    T* y = values ? static_cast<T*>(values->data) : nullptr;
+    if (index_bits == 32) {
+      HostTopK<T, int32_t>(x, y, indices ? static_cast<int32_t*>(indices->data) : nullptr,
+                           num_segments_, segment_size_, k_, is_ascend_, compute_stream_);
+    } else {
+      HostTopK<T, int64_t>(x, y, indices ? static_cast<int64_t*>(indices->data) : nullptr,
+                           num_segments_, segment_size_, k_, is_ascend_, compute_stream_);
+    }
+  }
+
+  int k_;
+  int64_t num_segments_;
+  int64_t segment_size_;
+  bool is_ascend_;
+  std::string ret_type_;
+  void* compute_stream_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, topk, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.topk", TopkImpl::make);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
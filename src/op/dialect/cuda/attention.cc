@@ -0,0 +1,388 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/attention.cc
+ * \brief Fused attention and KV cache cuda backends
+ */
+#include <cmath>
+#include "raf/op.h"
+#include "raf/op_utils.h"
+#include "raf/device_api.h"
+#include "../../schema/nn.h"
+#include "../../../common/shape_utils.h"
+#include "./kernels/attention.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+using namespace raf::ir;
+using namespace raf::value;
+using device_api::DeviceAPI;
+
+using namespace c10;
+
+/*! \brief The common part of the fused attention forward and backward. */
+class AttentionImplBase : public raf::op::OpEnv {
+ public:
+  /*! \brief Resolve the scale and the problem sizes from q in [B, S, D] and v in [B, T, Dv]. */
+  void InitProblem(const DLTensor* q, const DLTensor* v, double scale) {
+    CHECK(q->dtype.code == kDLFloat && (q->dtype.bits == 32 || q->dtype.bits == 16))
+        << "Unsupported dtype: " << DType(q->dtype).c_str();
+    batch_ = q->shape[0];
+    seq_q_ = q->shape[1];
+    seq_k_ = v->shape[1];
+    dim_ = q->shape[2];
+    vdim_ = v->shape[2];
+    CHECK(dim_ <= kAttentionMaxHeadDim && vdim_ <= kAttentionMaxHeadDim)
+        << "The fused attention supports head dimensions up to " << kAttentionMaxHeadDim
+        << ", but got " << dim_ << " and " << vdim_;
+    scale_ = scale > 0 ? scale : 1.0 / std::sqrt(static_cast<double>(dim_));
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    compute_stream_ = cuda_device_api->GetStream();
+  }
+
+ protected:
+  int batch_, seq_q_, seq_k_, dim_, vdim_;
+  double scale_;
+  bool causal_ = false;
+  void* compute_stream_;
+};
+
+class AttentionImpl : public AttentionImplBase {
+ public:
+  explicit AttentionImpl(const CallValues& cv) {
+  }
+
+  /*! \brief Initialize with a call to the base op. */
+  void InitFromOp(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op._contrib_attention");
+    auto args = cv->args.as<op::schema::AttentionArgs>();
+    this->arg_indices = {
+        fschema_index[op]("q"),
+        fschema_index[op]("k"),
+        fschema_index[op]("v"),
+    };
+    if (args->valid_len.defined()) {
+      this->arg_indices.push_back(fschema_index[op]("valid_len"));
+    }
+    causal_ = args->causal;
+    InitProblem(args->q, args->v, args->scale);
+  }
+
+  /*!
+   * \brief Initialize with a fused function of batch_matmul(softmax(score), v), where score is
+   * one of batch_matmul_nt(q, k), batch_matmul_nt(q, k) * scale, scale * batch_matmul_nt(q, k)
+   * and batch_matmul_nt(q, k) / scale. Return false if the body does not match.
+   */
+  bool InitFromFusedFunc(const CallValues& cv) {
+    static const Op& batch_matmul_op = Op::Get("raf.op.cuda.batch_matmul");
+    static const Op& batch_matmul_nt_op = Op::Get("raf.op.cuda.batch_matmul_nt");
+    static const Op& softmax_op = Op::Get("raf.op.cuda.softmax");
+    static const Op& multiply_op = Op::Get("raf.op.cuda.multiply");
+    static const Op& divide_op = Op::Get("raf.op.cuda.divide");
+    Function func = Downcast<ClosureValue>(cv->callee)->func;
+    Array<Value> args = GetListArgs(cv->args);
+    auto get_param_index = [&func](const Expr& expr) {
+      for (size_t i = 0; i < func->params.size(); ++i) {
+        if (func->params[i] == expr) {
+          return static_cast<int>(i);
+        }
+      }
+      return -1;
+    };
+
+    auto out = func->body.as<CallNode>();
+    if (!out || out->op != batch_matmul_op) {
+      return false;
+    }
+    auto softmax = out->args[0].as<CallNode>();
+    int v_index = get_param_index(out->args[1]);
+    if (!softmax || softmax->op != softmax_op || v_index < 0) {
+      return false;
+    }
+    int axis_index = get_param_index(softmax->args[1]);
+    if (axis_index < 0) {
+      return false;
+    }
+    int64_t axis = GetScalarValueData<int64_t>(args[axis_index]);
+    if (axis != -1 && axis != 2) {
+      return false;
+    }
+
+    auto score = softmax->args[0].as<CallNode>();
+    double scale = 1.0;
+    if (score && (score->op == multiply_op || score->op == divide_op)) {
+      // The multiply is commutative, so the score may be either of its arguments.
+      bool lhs = score->args[0].as<CallNode>() != nullptr;
+      if (!lhs && score->op == divide_op) {
+        return false;
+      }
+      int scale_index = get_param_index(score->args[lhs ? 1 : 0]);
+      if (scale_index < 0) {
+        return false;
+      }
+      // The scale is read once when the OpEnv is created, so it is expected to be unchanged.
+      scale = GetScalarValueData<double>(args[scale_index]);
+      scale = score->op == divide_op ? 1.0 / scale : scale;
+      score = score->args[lhs ? 0 : 1].as<CallNode>();
+    }
+    if (!score || score->op != batch_matmul_nt_op) {
+      return false;
+    }
+    int q_index = get_param_index(score->args[0]);
+    int k_index = get_param_index(score->args[1]);
+    if (q_index < 0 || k_index < 0) {
+      return false;
+    }
+    this->arg_indices = {q_index, k_index, v_index};
+    InitProblem(Downcast<TensorValue>(args[q_index]), Downcast<TensorValue>(args[v_index]), scale);
+    // A non-positive scale would be replaced by the default, so it cannot be supported.
+    return scale > 0;
+  }
+
+  void Execute(const CallValues& cv) override {
+    if (auto args = cv->args.as<op::schema::AttentionArgs>()) {
+      std::vector<Value> inputs = {args->q, args->k, args->v};
+      if (args->valid_len.defined()) {
+        inputs.push_back(args->valid_len.value());
+      }
+      Execute(inputs, cv->out);
+      return;
+    }
+    Array<Value> args = GetListArgs(cv->args);
+    Execute(std::vector<Value>{args[arg_indices[0]], args[arg_indices[1]], args[arg_indices[2]]},
+            cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    DLTensor* q = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* k = ir::Downcast<TensorValue>(inputs[1]);
+    DLTensor* v = ir::Downcast<TensorValue>(inputs[2]);
+    DLTensor* out = ir::Downcast<TensorValue>(output);
+    const int64_t* valid_len = nullptr;
+    if (inputs.size() > 3) {
+      valid_len = static_cast<const int64_t*>(ir::Downcast<TensorValue>(inputs[3])->tensor->data);
+    }
+    switch (q->dtype.bits) {
+      case 16: {
+        HostAttentionForward<Half>(static_cast<Half*>(out->data), static_cast<Half*>(q->data),
+                                   static_cast<Half*>(k->data), static_cast<Half*>(v->data),
+                                   batch_, seq_q_, seq_k_, dim_, vdim_, scale_, causal_,
+                                   valid_len, compute_stream_);
+        break;
+      }
+      case 32: {
+        HostAttentionForward<float>(static_cast<float*>(out->data), static_cast<float*>(q->data),
+                                    static_cast<float*>(k->data), static_cast<float*>(v->data),
+                                    batch_, seq_q_, seq_k_, dim_, vdim_, scale_, causal_,
+                                    valid_len, compute_stream_);
+        break;
+      }
+      default: {
+        LOG(FATAL) << "Unsupported dtype: " << DType(q->dtype).c_str();
+        throw;
+      }
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda._contrib_attention"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    auto op_env = std::make_unique<AttentionImpl>(cv);
+    op_env->InitFromOp(cv);
+    return op_env.release();
+  }
+
+  static OpEnv* MakeFused(const CallValues& cv) {
+    auto op_env = std::make_unique<AttentionImpl>(cv);
+    try {
+      if (!op_env->InitFromFusedFunc(cv)) {
+        dispatch_error_msgs.push_back("[CUDA] Cannot JIT: the fused attention does not match");
+        return nullptr;
+      }
+    } catch (const dmlc::Error& e) {
+      std::stringstream ss;
+      ss << "[CUDA] Failed to JIT: " << e.what();
+      dispatch_error_msgs.push_back(ss.str());
+      return nullptr;
+    }
+    return op_env.release();
+  }
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, _contrib_attention, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda._contrib_attention", AttentionImpl::make);
+RAF_OP_ENV_MAKER("raf.op.cuda._fused_attention", AttentionImpl::MakeFused);
+
+class AttentionDxImpl : public AttentionImplBase {
+ public:
+  explicit AttentionDxImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op._contrib_attention_dx");
+    auto args = cv->args.as<op::schema::AttentionDxArgs>();
+    this->arg_indices = {
+        fschema_index[op]("q"),   fschema_index[op]("k"),  fschema_index[op]("v"),
+        fschema_index[op]("out"), fschema_index[op]("dy"),
+    };
+    causal_ = args->causal;
+    InitProblem(args->q, args->v, args->scale);
+    // The log-sum-exp of the scores and the row-wise dot product of dy and out.
+    DLTensor* q = args->q;
+    RequestWorkspace(&lse_, q->device, sizeof(float) * batch_ * seq_q_);
+    RequestWorkspace(&delta_, q->device, sizeof(float) * batch_ * seq_q_);
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::AttentionDxArgs>();
+    Execute(std::vector<Value>{args->q, args->k, args->v, args->out, args->dy}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    DLTensor* q = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* k = ir::Downcast<TensorValue>(inputs[1]);
+    DLTensor* v = ir::Downcast<TensorValue>(inputs[2]);
+    DLTensor* out = ir::Downcast<TensorValue>(inputs[3]);
+    DLTensor* dy = ir::Downcast<TensorValue>(inputs[4]);
+    TupleValue out_tuple = ir::Downcast<TupleValue>(output);
+    DLTensor* dq = ir::Downcast<TensorValue>(out_tuple->fields[0]);
+    DLTensor* dk = ir::Downcast<TensorValue>(out_tuple->fields[1]);
+    DLTensor* dv = ir::Downcast<TensorValue>(out_tuple->fields[2]);
+    float* lse = static_cast<float*>(lse_);
+    float* delta = static_cast<float*>(delta_);
+    switch (q->dtype.bits) {
+      case 16: {
+        HostAttentionBackward<Half>(
+            static_cast<Half*>(dq->data), static_cast<Half*>(dk->data),
+            static_cast<Half*>(dv->data), lse, delta, static_cast<Half*>(q->data),
+            static_cast<Half*>(k->data), static_cast<Half*>(v->data), static_cast<Half*>(out->data),
+            static_cast<Half*>(dy->data), batch_, seq_q_, seq_k_, dim_, vdim_, scale_, causal_,
+            compute_stream_);
+        break;
+      }
+      case 32: {
+        HostAttentionBackward<float>(
+            static_cast<float*>(dq->data), static_cast<float*>(dk->data),
+            static_cast<float*>(dv->data), lse, delta, static_cast<float*>(q->data),
+            static_cast<float*>(k->data), static_cast<float*>(v->data),
+            static_cast<float*>(out->data), static_cast<float*>(dy->data), batch_, seq_q_, seq_k_,
+            dim_, vdim_, scale_, causal_, compute_stream_);
+        break;
+      }
+      default: {
+        LOG(FATAL) << "Unsupported dtype: " << DType(q->dtype).c_str();
+        throw;
+      }
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda._contrib_attention_dx"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new AttentionDxImpl(cv);
+  }
+
+ private:
+  void* lse_ = nullptr;
+  void* delta_ = nullptr;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, _contrib_attention_dx, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda._contrib_attention_dx", AttentionDxImpl::make);
+
+/*!
+ * \brief Write the new keys or values to the cache at the offset read on the device, so each
+ * decoding step only touches its new rows instead of the whole cache.
+ */
+class KvCacheAppendImpl : public raf::op::OpEnv {
+ public:
+  explicit KvCacheAppendImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op._contrib_kv_cache_append");
+    auto args = cv->args.as<op::schema::KvCacheAppendArgs>();
+    this->arg_indices = {
+        fschema_index[op]("cache"),
+        fschema_index[op]("x"),
+        fschema_index[op]("offset"),
+    };
+    DLTensor* cache = args->cache;
+    DLTensor* x = args->x;
+    batch_ = cache->shape[0];
+    max_seq_ = cache->shape[1];
+    seq_ = x->shape[1];
+    dim_ = cache->shape[2];
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    compute_stream_ = cuda_device_api->GetStream();
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::KvCacheAppendArgs>();
+    Execute(std::vector<Value>{args->cache, args->x, args->offset}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    DLTensor* cache = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* x = ir::Downcast<TensorValue>(inputs[1]);
+    DLTensor* offset = ir::Downcast<TensorValue>(inputs[2]);
+    DLTensor* out = ir::Downcast<TensorValue>(output);
+    if (out->data != cache->data) {
+      // The output does not share the memory with the cache, so the old entries are copied.
+      int64_t nbytes = common::shape_utils::BytesCompactTensor(*cache);
+      CUDA_CALL(cudaMemcpyAsync(out->data, cache->data, nbytes, cudaMemcpyDeviceToDevice,
+                                static_cast<cudaStream_t>(compute_stream_)));
+    }
+    const int64_t* offset_data = static_cast<const int64_t*>(offset->data);
+    switch (cache->dtype.bits) {
+      case 16: {
+        HostKvCacheAppend<Half>(static_cast<Half*>(out->data), static_cast<Half*>(x->data),
+                                offset_data, batch_, max_seq_, seq_, dim_, compute_stream_);
+        break;
+      }
+      case 32: {
+        HostKvCacheAppend<float>(static_cast<float*>(out->data), static_cast<float*>(x->data),
+                                 offset_data, batch_, max_seq_, seq_, dim_, compute_stream_);
+        break;
+      }
+      default: {
+        LOG(FATAL) << "Unsupported dtype: " << DType(cache->dtype).c_str();
+        throw;
+      }
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda._contrib_kv_cache_append"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    auto args = cv->args.as<op::schema::KvCacheAppendArgs>();
+    const DLTensor* cache = args->cache;
+    if (cache->dtype.code != kDLFloat || (cache->dtype.bits != 32 && cache->dtype.bits != 16)) {
+      dispatch_error_msgs.push_back("[CUDA] Cannot JIT: the cache is not float32 or float16");
+      return nullptr;
+    }
+    return new KvCacheAppendImpl(cv);
+  }
+
+ private:
+  int batch_, max_seq_, seq_, dim_;
+  void* compute_stream_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, _contrib_kv_cache_append, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda._contrib_kv_cache_append", KvCacheAppendImpl::make);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,229 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/batch_norm.cc
+ * \brief Fused batch_norm + add + relu training cuda backends
+ */
+#include "raf/op.h"
+#include "raf/device_api.h"
+#include "../../schema/nn.h"
+#include "./kernels/batch_norm.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+using namespace raf::value;
+using device_api::DeviceAPI;
+
+using namespace c10;
+
+/*! \brief The common part of the fused batch norm forward and backward. */
+class BatchNormAddReluImplBase : public raf::op::OpEnv {
+ public:
+  /*!
+   * \brief Whether the kernels support x and w, where x is float32 or float16 in NCHW (or any
+   * rank of at least 2 with the channel axis 1), and the affine parameters are float32.
+   */
+  static bool IsSupported(const DLTensor* x, const DLTensor* w) {
+    bool x_ok = x->dtype.code == kDLFloat && (x->dtype.bits == 32 || x->dtype.bits == 16);
+    bool w_ok = w->dtype.code == kDLFloat && w->dtype.bits == 32;
+    return x_ok && w_ok && x->ndim >= 2;
+  }
+
+  /*! \brief Resolve the problem sizes from x viewed as [n, c, hw], and request the workspace. */
+  void InitProblem(const DLTensor* x) {
+    n_ = x->shape[0];
+    c_ = x->shape[1];
+    hw_ = 1;
+    for (int i = 2; i < x->ndim; ++i) {
+      hw_ *= x->shape[i];
+    }
+    RequestWorkspace(&workspace_, x->device, batch_norm_add_relu_workspace_bytes(n_, c_, hw_));
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    compute_stream_ = cuda_device_api->GetStream();
+  }
+
+ protected:
+  int n_, c_, hw_;
+  void* workspace_;
+  void* compute_stream_;
+};
+
+class BatchNormAddReluTrainImpl : public BatchNormAddReluImplBase {
+ public:
+  explicit BatchNormAddReluTrainImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op._contrib_batch_norm_add_relu_train");
+    auto args = cv->args.as<op::schema::BatchNormAddReluArgs>();
+    this->arg_indices = {
+        fschema_index[op]("x"), fschema_index[op]("running_mean"),
+        fschema_index[op]("running_var"), fschema_index[op]("w"),
+        fschema_index[op]("b"),
+    };
+    if (args->z.defined()) {
+      this->arg_indices.push_back(fschema_index[op]("z"));
+    }
+    momentum_ = args->momentum;
+    eps_ = args->eps;
+    InitProblem(args->x);
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::BatchNormAddReluArgs>();
+    std::vector<Value> inputs = {args->x, args->running_mean, args->running_var, args->w,
+                                 args->b};
+    if (args->z.defined()) {
+      inputs.push_back(args->z.value());
+    }
+    Execute(inputs, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    DLTensor* x = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* running_mean_t = ir::Downcast<TensorValue>(inputs[1]);
+    DLTensor* running_var_t = ir::Downcast<TensorValue>(inputs[2]);
+    DLTensor* w_t = ir::Downcast<TensorValue>(inputs[3]);
+    DLTensor* b_t = ir::Downcast<TensorValue>(inputs[4]);
+    void* z = nullptr;
+    if (inputs.size() > 5) {
+      DLTensor* z_t = ir::Downcast<TensorValue>(inputs[5]);
+      z = z_t->data;
+    }
+    TupleValue out_tuple = ir::Downcast<TupleValue>(output);
+    DLTensor* y = ir::Downcast<TensorValue>(out_tuple->fields[0]);
+    DLTensor* mask_t = ir::Downcast<TensorValue>(out_tuple->fields[3]);
+    float* running_mean = static_cast<float*>(running_mean_t->data);
+    float* running_var = static_cast<float*>(running_var_t->data);
+    float* w = static_cast<float*>(w_t->data);
+    float* b = static_cast<float*>(b_t->data);
+    int32_t* mask = static_cast<int32_t*>(mask_t->data);
+    switch (x->dtype.bits) {
+      case 16: {
+        HostBatchNormAddReluForward<Half>(
+            static_cast<Half*>(x->data), static_cast<Half*>(z), w, b, running_mean, running_var,
+            static_cast<Half*>(y->data), mask, n_, c_, hw_, momentum_, eps_, workspace_,
+            compute_stream_);
+        break;
+      }
+      case 32: {
+        HostBatchNormAddReluForward<float>(
+            static_cast<float*>(x->data), static_cast<float*>(z), w, b, running_mean,
+            running_var, static_cast<float*>(y->data), mask, n_, c_, hw_, momentum_, eps_,
+            workspace_, compute_stream_);
+        break;
+      }
+      default: {
+        LOG(FATAL) << "Unsupported dtype: " << DType(x->dtype).c_str();
+        throw;
+      }
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda._contrib_batch_norm_add_relu_train"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    auto args = cv->args.as<op::schema::BatchNormAddReluArgs>();
+    if (!IsSupported(args->x, args->w)) {
+      dispatch_error_msgs.push_back("[CUDA] Unsupported dtypes of the fused batch norm");
+      return nullptr;
+    }
+    return new BatchNormAddReluTrainImpl(cv);
+  }
+
+ private:
+  double momentum_, eps_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, _contrib_batch_norm_add_relu_train, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda._contrib_batch_norm_add_relu_train",
+                 BatchNormAddReluTrainImpl::make);
+
+class BatchNormAddReluTrainDxwbImpl : public BatchNormAddReluImplBase {
+ public:
+  explicit BatchNormAddReluTrainDxwbImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op._contrib_batch_norm_add_relu_train_dxwb");
+    auto args = cv->args.as<op::schema::BatchNormAddReluDxwbArgs>();
+    this->arg_indices = {
+        fschema_index[op]("dy"),
+        fschema_index[op]("x"),
+        fschema_index[op]("mask"),
+        fschema_index[op]("w"),
+    };
+    eps_ = args->eps;
+    InitProblem(args->x);
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::BatchNormAddReluDxwbArgs>();
+    Execute(std::vector<Value>{args->dy, args->x, args->mask, args->w}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    DLTensor* dy = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* x = ir::Downcast<TensorValue>(inputs[1]);
+    DLTensor* mask_t = ir::Downcast<TensorValue>(inputs[2]);
+    DLTensor* w_t = ir::Downcast<TensorValue>(inputs[3]);
+    TupleValue out_tuple = ir::Downcast<TupleValue>(output);
+    DLTensor* dx = ir::Downcast<TensorValue>(out_tuple->fields[0]);
+    DLTensor* dw_t = ir::Downcast<TensorValue>(out_tuple->fields[1]);
+    DLTensor* db_t = ir::Downcast<TensorValue>(out_tuple->fields[2]);
+    DLTensor* dz = ir::Downcast<TensorValue>(out_tuple->fields[3]);
+    const int32_t* mask = static_cast<const int32_t*>(mask_t->data);
+    const float* w = static_cast<const float*>(w_t->data);
+    float* dw = static_cast<float*>(dw_t->data);
+    float* db = static_cast<float*>(db_t->data);
+    switch (x->dtype.bits) {
+      case 16: {
+        HostBatchNormAddReluBackward<Half>(
+            static_cast<Half*>(dy->data), static_cast<Half*>(x->data), mask, w,
+            static_cast<Half*>(dx->data), dw, db, static_cast<Half*>(dz->data), n_, c_, hw_, eps_,
+            workspace_, compute_stream_);
+        break;
+      }
+      case 32: {
+        HostBatchNormAddReluBackward<float>(
+            static_cast<float*>(dy->data), static_cast<float*>(x->data), mask, w,
+            static_cast<float*>(dx->data), dw, db, static_cast<float*>(dz->data), n_, c_, hw_,
+            eps_, workspace_, compute_stream_);
+        break;
+      }
+      default: {
+        LOG(FATAL) << "Unsupported dtype: " << DType(x->dtype).c_str();
+        throw;
+      }
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda._contrib_batch_norm_add_relu_train_dxwb"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    auto args = cv->args.as<op::schema::BatchNormAddReluDxwbArgs>();
+    if (!IsSupported(args->x, args->w)) {
+      dispatch_error_msgs.push_back("[CUDA] Unsupported dtypes of the fused batch norm");
+      return nullptr;
+    }
+    return new BatchNormAddReluTrainDxwbImpl(cv);
+  }
+
+ private:
+  double eps_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, _contrib_batch_norm_add_relu_train_dxwb, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda._contrib_batch_norm_add_relu_train_dxwb",
+                 BatchNormAddReluTrainDxwbImpl::make);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
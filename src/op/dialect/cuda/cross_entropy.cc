@@ -0,0 +1,345 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/cross_entropy.cc
+ * \brief Fused softmax cross-entropy cuda backend
+ */
+#include "raf/op.h"
+#include "raf/op_utils.h"
+#include "raf/device_api.h"
+#include "../../schema/loss.h"
+#include "./kernels/cross_entropy.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+using namespace raf::ir;
+using namespace raf::value;
+using device_api::DeviceAPI;
+
+using namespace c10;
+
+/*! \brief The common part of the fused cross-entropy forward and backward. */
+class CrossEntropyImplBase : public raf::op::OpEnv {
+ public:
+  /*! \brief Resolve the problem sizes from x in [n, c] and the target in [n]. */
+  void InitProblem(const DLTensor* x, const DLTensor* target) {
+    CHECK(x->dtype.code == kDLFloat && (x->dtype.bits == 32 || x->dtype.bits == 16))
+        << "Unsupported dtype: " << DType(x->dtype).c_str();
+    CHECK(target->dtype.code == kDLInt && (target->dtype.bits == 32 || target->dtype.bits == 64))
+        << "Unsupported target dtype: " << DType(target->dtype).c_str();
+    CHECK_EQ(x->ndim, 2);
+    CHECK_EQ(target->ndim, 1);
+    n_ = x->shape[0];
+    c_ = x->shape[1];
+    target_int64_ = target->dtype.bits == 64;
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    compute_stream_ = cuda_device_api->GetStream();
+  }
+
+  /*! \brief Get the index of the fused function parameter, or -1 if expr is not a parameter. */
+  static int GetParamIndex(const Function& func, const Expr& expr) {
+    for (size_t i = 0; i < func->params.size(); ++i) {
+      if (func->params[i] == expr) {
+        return static_cast<int>(i);
+      }
+    }
+    return -1;
+  }
+
+  /*! \brief Whether the param of the fused function is the last axis of a 2-D tensor. */
+  static bool IsLastAxis(const Function& func, const Array<Value>& args, const Expr& expr) {
+    int index = GetParamIndex(func, expr);
+    if (index < 0) {
+      return false;
+    }
+    std::vector<int64_t> axes = GetShapeVecFromValue(args[index]);
+    return axes.size() == 1 && (axes[0] == -1 || axes[0] == 1);
+  }
+
+  /*! \brief Whether the log_softmax normalizes the last axis, which it does by default. */
+  static bool IsLastAxisLogSoftmax(const Function& func, const Array<Value>& args,
+                                   const CallNode* log_softmax) {
+    return log_softmax->args.size() < 2 || IsLastAxis(func, args, log_softmax->args[1]);
+  }
+
+ protected:
+  int n_, c_;
+  bool target_int64_;
+  void* compute_stream_;
+};
+
+class CrossEntropyImpl : public CrossEntropyImplBase {
+ public:
+  explicit CrossEntropyImpl(const CallValues& cv) {
+  }
+
+  /*! \brief Initialize with a call to the base op. */
+  void InitFromOp(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.cross_entropy");
+    auto args = cv->args.as<op::schema::LossArgs>();
+    this->arg_indices = {
+        fschema_index[op]("y_true"),
+        fschema_index[op]("y_pred"),
+    };
+    InitProblem(args->y_pred, args->y_true);
+    RequestWorkspace(&row_loss_, cv->device, sizeof(float) * n_);
+  }
+
+  /*!
+   * \brief Initialize with a fused function of nll_loss(y_true, log_softmax(x, axis)). Return
+   * false if the body does not match.
+   */
+  bool InitFromFusedFunc(const CallValues& cv) {
+    static const Op& nll_loss_op = Op::Get("raf.op.cuda.nll_loss");
+    static const Op& log_softmax_op = Op::Get("raf.op.cuda.log_softmax");
+    Function func = Downcast<ClosureValue>(cv->callee)->func;
+    Array<Value> args = GetListArgs(cv->args);
+
+    auto loss = func->body.as<CallNode>();
+    if (!loss || loss->op != nll_loss_op) {
+      return false;
+    }
+    auto log_softmax = loss->args[1].as<CallNode>();
+    if (!log_softmax || log_softmax->op != log_softmax_op ||
+        !IsLastAxisLogSoftmax(func, args, log_softmax)) {
+      return false;
+    }
+    int target_index = GetParamIndex(func, loss->args[0]);
+    int x_index = GetParamIndex(func, log_softmax->args[0]);
+    if (target_index < 0 || x_index < 0) {
+      return false;
+    }
+    this->arg_indices = {target_index, x_index};
+    InitProblem(Downcast<TensorValue>(args[x_index]), Downcast<TensorValue>(args[target_index]));
+    RequestWorkspace(&row_loss_, cv->device, sizeof(float) * n_);
+    return true;
+  }
+
+  void Execute(const CallValues& cv) override {
+    if (auto args = cv->args.as<op::schema::LossArgs>()) {
+      Execute(std::vector<Value>{args->y_true, args->y_pred}, cv->out);
+      return;
+    }
+    Array<Value> args = GetListArgs(cv->args);
+    Execute(std::vector<Value>{args[arg_indices[0]], args[arg_indices[1]]}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    DLTensor* target = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* x = ir::Downcast<TensorValue>(inputs[1]);
+    DLTensor* out = ir::Downcast<TensorValue>(output);
+    switch (x->dtype.bits) {
+      case 16: {
+        HostCrossEntropyForward<Half>(static_cast<Half*>(out->data),
+                                      static_cast<float*>(row_loss_),
+                                      static_cast<const Half*>(x->data), target->data,
+                                      target_int64_, n_, c_, compute_stream_);
+        break;
+      }
+      case 32: {
+        HostCrossEntropyForward<float>(static_cast<float*>(out->data),
+                                       static_cast<float*>(row_loss_),
+                                       static_cast<const float*>(x->data), target->data,
+                                       target_int64_, n_, c_, compute_stream_);
+        break;
+      }
+      default: {
+        LOG(FATAL) << "Unsupported dtype: " << DType(x->dtype).c_str();
+        throw;
+      }
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.cross_entropy"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    auto op_env = std::make_unique<CrossEntropyImpl>(cv);
+    op_env->InitFromOp(cv);
+    return op_env.release();
+  }
+
+  static OpEnv* MakeFused(const CallValues& cv) {
+    auto op_env = std::make_unique<CrossEntropyImpl>(cv);
+    try {
+      if (!op_env->InitFromFusedFunc(cv)) {
+        dispatch_error_msgs.push_back("[CUDA] Cannot JIT: the fused cross entropy does not match");
+        return nullptr;
+      }
+    } catch (const dmlc::Error& e) {
+      std::stringstream ss;
+      ss << "[CUDA] Failed to JIT: " << e.what();
+      dispatch_error_msgs.push_back(ss.str());
+      return nullptr;
+    }
+    return op_env.release();
+  }
+
+ private:
+  void* row_loss_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, cross_entropy, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.cross_entropy", CrossEntropyImpl::make);
+RAF_OP_ENV_MAKER("raf.op.cuda._fused_cross_entropy", CrossEntropyImpl::MakeFused);
+
+class CrossEntropyDxImpl : public CrossEntropyImplBase {
+ public:
+  explicit CrossEntropyDxImpl(const CallValues& cv) {
+  }
+
+  /*! \brief Initialize with a call to the base op. */
+  void InitFromOp(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.cross_entropy_dpred");
+    auto args = cv->args.as<op::schema::LossDtpArgs>();
+    this->arg_indices = {
+        fschema_index[op]("dy"),
+        fschema_index[op]("y_true"),
+        fschema_index[op]("y_pred"),
+    };
+    from_logits_ = true;
+    InitProblem(args->y_pred, args->y_true);
+  }
+
+  /*!
+   * \brief Initialize with a fused function of the gradient that autodiff generates for both
+   * cross_entropy(y_true, x) and nll_loss(y_true, log_softmax(x)):
+   *   d = nll_loss_dpred(dy, y_true, pred)
+   *   subtract(d, multiply(exp(log_prob), sum(d, axis, 1, false)))
+   * where log_prob is either log_softmax(x, axis), which is recomputed from the logits, or the
+   * log-probabilities. Return false if the body does not match.
+   */
+  bool InitFromFusedFunc(const CallValues& cv) {
+    static const Op& subtract_op = Op::Get("raf.op.cuda.subtract");
+    static const Op& multiply_op = Op::Get("raf.op.cuda.multiply");
+    static const Op& exp_op = Op::Get("raf.op.cuda.exp");
+    static const Op& sum_op = Op::Get("raf.op.cuda.sum");
+    static const Op& nll_loss_dpred_op = Op::Get("raf.op.cuda.nll_loss_dpred");
+    static const Op& log_softmax_op = Op::Get("raf.op.cuda.log_softmax");
+    Function func = Downcast<ClosureValue>(cv->callee)->func;
+    Array<Value> args = GetListArgs(cv->args);
+
+    auto out = func->body.as<CallNode>();
+    if (!out || out->op != subtract_op) {
+      return false;
+    }
+    auto dpred = out->args[0].as<CallNode>();
+    auto multiply = out->args[1].as<CallNode>();
+    if (!dpred || dpred->op != nll_loss_dpred_op || !multiply || multiply->op != multiply_op) {
+      return false;
+    }
+    auto exp = multiply->args[0].as<CallNode>();
+    auto sum = multiply->args[1].as<CallNode>();
+    if (!exp || exp->op != exp_op || !sum || sum->op != sum_op || sum->args[0] != out->args[0] ||
+        !IsLastAxis(func, args, sum->args[1])) {
+      return false;
+    }
+    int keep_index = GetParamIndex(func, sum->args[2]);
+    int exclude_index = GetParamIndex(func, sum->args[3]);
+    if (keep_index < 0 || exclude_index < 0 ||
+        GetShapeVecFromValue(args[keep_index]) != std::vector<int64_t>{1} ||
+        GetScalarValueData<bool>(args[exclude_index])) {
+      return false;
+    }
+    auto log_softmax = exp->args[0].as<CallNode>();
+    from_logits_ = log_softmax && log_softmax->op == log_softmax_op;
+    if (from_logits_ && !IsLastAxisLogSoftmax(func, args, log_softmax)) {
+      return false;
+    }
+    int dy_index = GetParamIndex(func, dpred->args[0]);
+    int target_index = GetParamIndex(func, dpred->args[1]);
+    int x_index = GetParamIndex(func, from_logits_ ? log_softmax->args[0] : exp->args[0]);
+    if (dy_index < 0 || target_index < 0 || x_index < 0) {
+      return false;
+    }
+    this->arg_indices = {dy_index, target_index, x_index};
+    InitProblem(Downcast<TensorValue>(args[x_index]), Downcast<TensorValue>(args[target_index]));
+    return true;
+  }
+
+  void Execute(const CallValues& cv) override {
+    if (auto args = cv->args.as<op::schema::LossDtpArgs>()) {
+      Execute(std::vector<Value>{args->dy, args->y_true, args->y_pred}, cv->out);
+      return;
+    }
+    Array<Value> args = GetListArgs(cv->args);
+    Execute(std::vector<Value>{args[arg_indices[0]], args[arg_indices[1]], args[arg_indices[2]]},
+            cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    DLTensor* dy = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* target = ir::Downcast<TensorValue>(inputs[1]);
+    DLTensor* x = ir::Downcast<TensorValue>(inputs[2]);
+    DLTensor* out = ir::Downcast<TensorValue>(output);
+    CHECK(dy->dtype == x->dtype) << "The gradient of the loss must have the dtype of the logits";
+    switch (x->dtype.bits) {
+      case 16: {
+        HostCrossEntropyBackward<Half>(
+            static_cast<Half*>(out->data), static_cast<const Half*>(dy->data),
+            static_cast<const Half*>(x->data), target->data, target_int64_, n_, c_, from_logits_,
+            compute_stream_);
+        break;
+      }
+      case 32: {
+        HostCrossEntropyBackward<float>(
+            static_cast<float*>(out->data), static_cast<const float*>(dy->data),
+            static_cast<const float*>(x->data), target->data, target_int64_, n_, c_, from_logits_,
+            compute_stream_);
+        break;
+      }
+      default: {
+        LOG(FATAL) << "Unsupported dtype: " << DType(x->dtype).c_str();
+        throw;
+      }
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.cross_entropy_dpred"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    auto op_env = std::make_unique<CrossEntropyDxImpl>(cv);
+    op_env->InitFromOp(cv);
+    return op_env.release();
+  }
+
+  static OpEnv* MakeFused(const CallValues& cv) {
+    auto op_env = std::make_unique<CrossEntropyDxImpl>(cv);
+    try {
+      if (!op_env->InitFromFusedFunc(cv)) {
+        dispatch_error_msgs.push_back(
+            "[CUDA] Cannot JIT: the fused cross entropy gradient does not match");
+        return nullptr;
+      }
+    } catch (const dmlc::Error& e) {
+      std::stringstream ss;
+      ss << "[CUDA] Failed to JIT: " << e.what();
+      dispatch_error_msgs.push_back(ss.str());
+      return nullptr;
+    }
+    return op_env.release();
+  }
+
+ private:
+  bool from_logits_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, cross_entropy_dpred, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.cross_entropy_dpred", CrossEntropyDxImpl::make);
+RAF_OP_ENV_MAKER("raf.op.cuda._fused_cross_entropy_dx", CrossEntropyDxImpl::MakeFused);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
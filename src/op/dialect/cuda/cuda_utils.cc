@@ -8,14 +8,54 @@
  * \brief CUDA dialect utils
  */
 #include "raf/op.h"
+#include "raf/value.h"
 #include "../../../common/shape_utils.h"
 
 namespace raf {
 namespace op {
 namespace cuda {
 
+using namespace raf::ir;
+using namespace raf::value;
+
 RAF_REGISTER_DIALECT("cuda").set_enable(DevType::kCUDA());
 
+/*!
+ * \brief Build the OpEnv of a fused function, which is registered as
+ * raf.op.cuda._fused_<pattern name> by the CUDA backend of the pattern.
+ * \param call the call value to be dispatched
+ * \return the OpEnv. nullptr if the fused function is not supported
+ */
+OpEnv* FusedFuncBuild(const CallValues& call) {
+  Function func = Downcast<ClosureValue>(call->callee)->func;
+  auto attr = func->GetAttr<String>(attr::kPatternName);
+  ICHECK(attr.defined()) << "No pattern name marked for the function";
+  std::string pattern_name = attr.value();
+  const OpEnvMaker* maker = OpEnvMaker::Get("raf.op.cuda._fused_" + pattern_name);
+  CHECK(maker != nullptr) << "Unknown cuda fusion pattern: " << pattern_name;
+  return (*maker)(call);
+}
+
+RAF_OP_ENV_MAKER("raf.op.cuda._fused_op", FusedFuncBuild);
+
+// The ops are only dispatched to CUDA as parts of the fused functions, so they are registered
+// with a non-positive plevel that is not taken by CUTLASS or cuBLASLt.
+RAF_REGISTER_DIALECT_OP(cuda, batch_matmul, -2);
+RAF_REGISTER_DIALECT_OP(cuda, batch_matmul_nt, -2);
+RAF_REGISTER_DIALECT_OP(cuda, multiply, -2);
+RAF_REGISTER_DIALECT_OP(cuda, divide, -2);
+RAF_REGISTER_DIALECT_OP(cuda, softmax, -2);
+RAF_REGISTER_DIALECT_OP(cuda, softmax_dx, -2);
+RAF_REGISTER_DIALECT_OP(cuda, log_softmax, -2);
+RAF_REGISTER_DIALECT_OP(cuda, nll_loss, -2);
+RAF_REGISTER_DIALECT_OP(cuda, nll_loss_dpred, -2);
+RAF_REGISTER_DIALECT_OP(cuda, sum, -2);
+RAF_REGISTER_DIALECT_OP(cuda, exp, -2);
+RAF_REGISTER_DIALECT_OP(cuda, subtract, -2);
+RAF_REGISTER_DIALECT_OP(cuda, add, -2);
+RAF_REGISTER_DIALECT_OP(cuda, embedding, -2);
+RAF_REGISTER_DIALECT_OP(cuda, layer_norm, -2);
+
 }  // namespace cuda
 }  // namespace op
 }  // namespace raf
@@ -0,0 +1,148 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/cumsum.cc
+ * \brief cumsum cuda backend
+ */
+#include <limits>
+#include "raf/op.h"
+#include "raf/device_api.h"
+#include "../../schema/transform.h"
+#include "./kernels/scan.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+using namespace raf::value;
+using device_api::DeviceAPI;
+
+using namespace c10;
+
+class CumsumImpl : public raf::op::OpEnv {
+ public:
+  explicit CumsumImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.cumsum");
+    auto args = cv->args.as<op::schema::CumsumArgs>();
+    this->arg_indices = {fschema_index[op]("x")};
+    const DLTensor* x = args->x;
+    int axis = args->axis >= 0 ? args->axis : args->axis + x->ndim;
+    outer_ = length_ = inner_ = 1;
+    for (int i = 0; i < x->ndim; ++i) {
+      if (i < axis) {
+        outer_ *= x->shape[i];
+      } else if (i == axis) {
+        length_ = x->shape[i];
+      } else {
+        inner_ *= x->shape[i];
+      }
+    }
+    exclusive_ = args->exclusive;
+    int64_t nbytes = DispatchWorkspaceBytes(x->dtype);
+    workspace_ = nullptr;
+    if (nbytes > 0) {
+      RequestWorkspace(&workspace_, cv->device, nbytes);
+    }
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::CumsumArgs>();
+    Execute(std::vector<Value>{args->x}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    DLTensor* x = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* out = ir::Downcast<TensorValue>(output);
+    void* stream = cuda_device_api->GetStream();
+    switch (x->dtype.code) {
+      case kDLFloat:
+        if (x->dtype.bits == 16) {
+          return Launch<Half>(x, out, stream);
+        } else if (x->dtype.bits == 32) {
+          return Launch<float>(x, out, stream);
+        }
+        return Launch<double>(x, out, stream);
+      default:
+        if (x->dtype.bits == 32) {
+          return Launch<int32_t>(x, out, stream);
+        }
+        return Launch<int64_t>(x, out, stream);
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.cumsum"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    auto args = cv->args.as<op::schema::CumsumArgs>();
+    const DLTensor* x = args->x;
+    const DLDataType& dtype = x->dtype;
+    bool float_type = dtype.code == kDLFloat && (dtype.bits == 16 || dtype.bits == 32 ||
+                                                 dtype.bits == 64);
+    bool int_type = dtype.code == kDLInt && (dtype.bits == 32 || dtype.bits == 64);
+    int64_t n = 1;
+    for (int i = 0; i < x->ndim; ++i) {
+      n *= x->shape[i];
+    }
+    std::string reason;
+    if (!float_type && !int_type) {
+      reason = "unsupported dtype " + std::string(DType(dtype).c_str());
+    } else if (dtype.lanes != 1) {
+      reason = "vector dtypes are not supported";
+    } else if (x->ndim == 0) {
+      reason = "scalars are not supported";
+    } else if (n > std::numeric_limits<int>::max()) {
+      reason = "too many elements";
+    }
+    if (!reason.empty()) {
+      dispatch_error_msgs.push_back("[CUDA] Cannot cumsum: " + reason);
+      return nullptr;
+    }
+    return new CumsumImpl(cv);
+  }
+
+ private:
+  template <typename T>
+  void Launch(const DLTensor* x, DLTensor* out, void* stream) {
+    HostCumsum<T>(static_cast<const T*>(x->data), static_cast<T*>(out->data), outer_, length_,
+                  inner_, exclusive_, workspace_, stream);
+  }
+
+  int64_t DispatchWorkspaceBytes(const DLDataType& dtype) {
+    if (dtype.code == kDLFloat) {
+      switch (dtype.bits) {
+        case 16:
+          return CumsumWorkspaceBytes<Half>(outer_, length_, inner_);
+        case 32:
+          return CumsumWorkspaceBytes<float>(outer_, length_, inner_);
+        default:
+          return CumsumWorkspaceBytes<double>(outer_, length_, inner_);
+      }
+    }
+    return dtype.bits == 32 ? CumsumWorkspaceBytes<int32_t>(outer_, length_, inner_)
+                            : CumsumWorkspaceBytes<int64_t>(outer_, length_, inner_);
+  }
+
+  /*! \brief The product of the dims before the axis. */
+  int64_t outer_;
+  /*! \brief The length of the axis. */
+  int64_t length_;
+  /*! \brief The product of the dims after the axis. */
+  int64_t inner_;
+  bool exclusive_;
+  void* workspace_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, cumsum, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.cumsum", CumsumImpl::make);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,339 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/depthwise_conv.cc
+ * \brief Depthwise conv2d cuda backends, which are profiled against cuDNN per problem.
+ */
+#include <chrono>
+#include <memory>
+#include "raf/cache.h"
+#include "raf/device_api.h"
+#include "raf/dialect.h"
+#include "raf/memory_pool.h"
+#include "raf/op.h"
+#include "raf/op_utils.h"
+#include "../../schema/nn.h"
+#include "../../../requests.h"
+#include "../3rdparty/tvm/src/runtime/file_utils.h"
+#include "./kernels/depthwise_conv.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+using namespace raf::value;
+using namespace raf::memory_pool;
+using device_api::DeviceAPI;
+using requests::Requests;
+
+using namespace c10;
+
+/*! \brief Whether the depthwise kernels are faster than cuDNN for a problem. */
+class DepthwiseConvChoiceCacheEntry {
+ public:
+  explicit DepthwiseConvChoiceCacheEntry(bool use_cuda) : use_cuda_(use_cuda) {
+  }
+
+  bool Value() const {
+    return use_cuda_;
+  }
+
+  static DepthwiseConvChoiceCacheEntry Load(const std::string& path) {
+    std::string data;
+    tvm::runtime::LoadBinaryFromFile(path + "/value.bin", &data);
+    dmlc::MemoryStringStream reader(&data);
+    bool use_cuda;
+    reader.Read(&use_cuda);
+    return DepthwiseConvChoiceCacheEntry(use_cuda);
+  }
+
+  bool Save(const std::string& path) {
+    std::string data;
+    dmlc::MemoryStringStream writer(&data);
+    writer.Write(use_cuda_);
+    tvm::runtime::SaveBinaryToFile(path + "/value.bin", data);
+    return true;
+  }
+
+ private:
+  bool use_cuda_;
+};
+
+MetaPersistCache<DepthwiseConvChoiceCacheEntry> CacheDepthwiseConvChoice(
+    "cuda_depthwise_conv_choice", true);
+
+/*!
+ * \brief The average time in milliseconds of an OpEnv over the given number of runs after a warm
+ * up run. The workspace requested by the OpEnv is allocated for the runs and released after.
+ */
+double TimeOpEnv(OpEnv* env, const CallValues& cv, int number) {
+  std::shared_ptr<Requests> requests = env->GetRequests();
+  for (Requests::WorkspaceRequest& entry : requests->workspace) {
+    if (entry.nbytes > 0) {
+      entry.memory = Memory::Alloc(entry.device, entry.nbytes);
+      *entry.dest = entry.memory->data;
+    }
+  }
+  env->Execute(cv);
+  CUDA_CALL(cudaDeviceSynchronize());
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < number; ++i) {
+    env->Execute(cv);
+  }
+  CUDA_CALL(cudaDeviceSynchronize());
+  std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+  for (Requests::WorkspaceRequest& entry : requests->workspace) {
+    if (entry.memory != nullptr) {
+      *entry.dest = nullptr;
+      entry.memory.reset();
+    }
+  }
+  return elapsed.count() / number;
+}
+
+/*!
+ * \brief Whether to run the depthwise kernels of env rather than cuDNN for the problem of key.
+ * The first call of a problem profiles both and caches the choice, which persists across runs
+ * with RAF_PERSIST_CACHE=1 like the cuDNN algorithms. The kernels are always chosen when cuDNN
+ * is not built, not enabled, or does not support the problem.
+ */
+bool ChooseDepthwiseKernels(const HashKey& key, const std::string& cudnn_op, OpEnv* env,
+                            const CallValues& cv) {
+  if (const auto* cached = CacheDepthwiseConvChoice.Get(key.byte_vector)) {
+    return cached->Value();
+  }
+  const OpEnvMaker* cudnn_maker = OpEnvMaker::Get(cudnn_op);
+  if (cudnn_maker == nullptr || !Dialect::IsEnabled("cudnn", DevType::kCUDA())) {
+    return true;
+  }
+  std::unique_ptr<OpEnv> cudnn_env;
+  try {
+    cudnn_env.reset((*cudnn_maker)(cv));
+  } catch (const dmlc::Error& e) {
+    DLOG(WARNING) << "Failed to make " << cudnn_op << ": " << e.what();
+  }
+  bool use_cuda = true;
+  if (cudnn_env != nullptr) {
+    const int number = 10;
+    double cuda_ms = TimeOpEnv(env, cv, number);
+    double cudnn_ms = TimeOpEnv(cudnn_env.get(), cv, number);
+    DLOG(INFO) << "Depthwise " << cudnn_op << ": " << cuda_ms << " ms, cuDNN: " << cudnn_ms
+               << " ms";
+    use_cuda = cuda_ms < cudnn_ms;
+  }
+  CacheDepthwiseConvChoice.Set(key.byte_vector, DepthwiseConvChoiceCacheEntry(use_cuda));
+  return use_cuda;
+}
+
+/*! \brief The common part of the depthwise conv2d and its gradients. */
+class DepthwiseConvImplBase : public raf::op::OpEnv {
+ public:
+  /*!
+   * \brief Resolve the problem of a depthwise conv2d in NCHW and OIHW, i.e., the groups is the
+   * number of input channels, and the weight has a single input channel per group.
+   * \return Whether the problem is depthwise and supported by the kernels.
+   */
+  static bool GetParams(const DLTensor* x, const DLTensor* w, const DLTensor* y,
+                        const std::vector<int64_t>& stride, const std::vector<int64_t>& padding,
+                        const std::vector<int64_t>& dilation, int64_t groups,
+                        DepthwiseConvParams* params) {
+    auto is_2d = [](const std::vector<int64_t>& v) { return v.size() == 1U || v.size() == 2U; };
+    bool dtype_ok = y->dtype.code == kDLFloat && (y->dtype.bits == 32 || y->dtype.bits == 16);
+    if (!dtype_ok || x->ndim != 4 || w->ndim != 4 || y->ndim != 4 || !is_2d(stride) ||
+        !is_2d(padding) || !is_2d(dilation)) {
+      return false;
+    }
+    int64_t c = x->shape[1];
+    int64_t out_c = w->shape[0];
+    if (groups <= 1 || groups != c || w->shape[1] != 1 || out_c % c != 0 || y->shape[1] != out_c) {
+      return false;
+    }
+    std::vector<int64_t> s = Pad<2>(stride), p = Pad<2>(padding), d = Pad<2>(dilation);
+    params->n = x->shape[0];
+    params->c = c;
+    params->h = x->shape[2];
+    params->w = x->shape[3];
+    params->multiplier = out_c / c;
+    params->out_h = y->shape[2];
+    params->out_w = y->shape[3];
+    params->kernel_h = w->shape[2];
+    params->kernel_w = w->shape[3];
+    params->stride_h = s[0];
+    params->stride_w = s[1];
+    params->pad_h = p[0];
+    params->pad_w = p[1];
+    params->dilation_h = d[0];
+    params->dilation_w = d[1];
+    return true;
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda." + op_name_));
+  }
+
+ protected:
+  DepthwiseConvImplBase(const std::string& op_name, const DepthwiseConvParams& params)
+      : op_name_(op_name), params_(params) {
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    compute_stream_ = cuda_device_api->GetStream();
+  }
+
+  std::string op_name_;
+  DepthwiseConvParams params_;
+  void* compute_stream_;
+};
+
+class DepthwiseConv2dImpl : public DepthwiseConvImplBase {
+ public:
+  explicit DepthwiseConv2dImpl(const DepthwiseConvParams& params)
+      : DepthwiseConvImplBase("conv2d", params) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.conv2d");
+    this->arg_indices = {fschema_index[op]("x"), fschema_index[op]("w")};
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::ConvArgs>();
+    Execute(std::vector<Value>{args->x, args->w}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    CHECK_EQ(inputs.size(), 2);
+    DLTensor* x = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* w = ir::Downcast<TensorValue>(inputs[1]);
+    DLTensor* y = ir::Downcast<TensorValue>(output);
+    switch (y->dtype.bits) {
+      case 16: {
+        HostDepthwiseConv2d<Half>(static_cast<Half*>(x->data), static_cast<Half*>(w->data),
+                                  static_cast<Half*>(y->data), params_, compute_stream_);
+        break;
+      }
+      case 32: {
+        HostDepthwiseConv2d<float>(static_cast<float*>(x->data), static_cast<float*>(w->data),
+                                   static_cast<float*>(y->data), params_, compute_stream_);
+        break;
+      }
+      default: {
+        LOG(FATAL) << "Unsupported dtype: " << DType(y->dtype).c_str();
+        throw;
+      }
+    }
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    auto args = cv->args.as<op::schema::ConvArgs>();
+    DLTensor* x = args->x;
+    DLTensor* w = args->w;
+    DLTensor* y = cv->out;
+    DepthwiseConvParams params;
+    bool nchw =
+        args->layout == "NCHW" && args->kernel_layout == "OIHW" && args->out_layout == "NCHW";
+    if (!nchw || !GetParams(x, w, y, args->stride, args->padding, args->dilation, args->groups,
+                            &params)) {
+      dispatch_error_msgs.push_back("[CUDA] Only the depthwise conv2d in NCHW is supported");
+      return nullptr;
+    }
+    std::unique_ptr<DepthwiseConv2dImpl> env = std::make_unique<DepthwiseConv2dImpl>(params);
+    HashKey key;
+    key << "conv2d" << args->stride << args->padding << args->dilation << *x << *w << *y;
+    if (!ChooseDepthwiseKernels(key, "raf.op.cudnn.conv2d", env.get(), cv)) {
+      dispatch_error_msgs.push_back("[CUDA] cuDNN is faster for the depthwise conv2d");
+      return nullptr;
+    }
+    return env.release();
+  }
+};
+
+/*! \brief The depthwise conv2d_dx and conv2d_dw, which share the args. */
+template <bool IS_DX>
+class DepthwiseConv2dDxwImpl : public DepthwiseConvImplBase {
+ public:
+  explicit DepthwiseConv2dDxwImpl(const DepthwiseConvParams& params)
+      : DepthwiseConvImplBase(IS_DX ? "conv2d_dx" : "conv2d_dw", params) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    auto op = ir::Op::Get(IS_DX ? "raf.op.conv2d_dx" : "raf.op.conv2d_dw");
+    this->arg_indices = {fschema_index[op]("x_or_w"), fschema_index[op]("dy")};
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::ConvDxwArgs>();
+    Execute(std::vector<Value>{args->x_or_w, args->dy}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    CHECK_EQ(inputs.size(), 2);
+    DLTensor* x_or_w = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* dy = ir::Downcast<TensorValue>(inputs[1]);
+    DLTensor* out = ir::Downcast<TensorValue>(output);
+    switch (out->dtype.bits) {
+      case 16: {
+        Run<Half>(static_cast<Half*>(x_or_w->data), static_cast<Half*>(dy->data),
+                  static_cast<Half*>(out->data));
+        break;
+      }
+      case 32: {
+        Run<float>(static_cast<float*>(x_or_w->data), static_cast<float*>(dy->data),
+                   static_cast<float*>(out->data));
+        break;
+      }
+      default: {
+        LOG(FATAL) << "Unsupported dtype: " << DType(out->dtype).c_str();
+        throw;
+      }
+    }
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    auto args = cv->args.as<op::schema::ConvDxwArgs>();
+    DLTensor* x_or_w = args->x_or_w;
+    DLTensor* dy = args->dy;
+    DLTensor* out = cv->out;
+    // The problem is resolved from (x, w, y) of the forward conv2d.
+    const DLTensor* x = IS_DX ? out : x_or_w;
+    const DLTensor* w = IS_DX ? x_or_w : out;
+    DepthwiseConvParams params;
+    if (!GetParams(x, w, dy, args->stride, args->padding, args->dilation, args->groups,
+                   &params)) {
+      dispatch_error_msgs.push_back("[CUDA] Only the depthwise conv2d in NCHW is supported");
+      return nullptr;
+    }
+    std::unique_ptr<DepthwiseConv2dDxwImpl> env = std::make_unique<DepthwiseConv2dDxwImpl>(params);
+    const char* op_name = IS_DX ? "conv2d_dx" : "conv2d_dw";
+    HashKey key;
+    key << op_name << args->stride << args->padding << args->dilation << *x_or_w << *dy << *out;
+    if (!ChooseDepthwiseKernels(key, std::string("raf.op.cudnn.") + op_name, env.get(), cv)) {
+      dispatch_error_msgs.push_back(std::string("[CUDA] cuDNN is faster for the depthwise ") +
+                                    op_name);
+      return nullptr;
+    }
+    return env.release();
+  }
+
+ private:
+  template <typename T>
+  void Run(const T* x_or_w, const T* dy, T* out) {
+    if (IS_DX) {
+      HostDepthwiseConv2dDx<T>(x_or_w, dy, out, params_, compute_stream_);
+    } else {
+      HostDepthwiseConv2dDw<T>(x_or_w, dy, out, params_, compute_stream_);
+    }
+  }
+};
+
+// The plevels are above cuDNN, to which the non-depthwise convs or the shapes where cuDNN is
+// profiled to be faster fall back.
+RAF_REGISTER_DIALECT_OP(cuda, conv2d, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.conv2d", DepthwiseConv2dImpl::make);
+RAF_REGISTER_DIALECT_OP(cuda, conv2d_dx, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.conv2d_dx", DepthwiseConv2dDxwImpl<true>::make);
+RAF_REGISTER_DIALECT_OP(cuda, conv2d_dw, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.conv2d_dw", DepthwiseConv2dDxwImpl<false>::make);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
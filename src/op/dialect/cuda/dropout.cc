@@ -0,0 +1,279 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/dropout.cc
+ * \brief Philox dropout cuda backend
+ */
+#include <algorithm>
+#include "raf/op.h"
+#include "raf/op_utils.h"
+#include "raf/device_api.h"
+#include "../../schema/nn.h"
+#include "./kernels/philox_dropout.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+using namespace raf::ir;
+using namespace raf::value;
+using device_api::DeviceAPI;
+
+using namespace c10;
+
+/*! \brief The common part of the Philox dropout forward and backward. */
+class PhiloxDropoutImplBase : public raf::op::OpEnv {
+ public:
+  /*! \brief Resolve the problem sizes from x and the dropout rate. */
+  void InitProblem(const DLTensor* x, double p) {
+    CHECK(x->dtype.code == kDLFloat && (x->dtype.bits == 32 || x->dtype.bits == 16))
+        << "Unsupported dtype: " << DType(x->dtype).c_str();
+    CHECK(p >= 0 && p < 1) << "The dropout rate must be in [0, 1), but got " << p;
+    n_ = 1;
+    for (int i = 0; i < x->ndim; ++i) {
+      n_ *= x->shape[i];
+    }
+    p_ = p;
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    compute_stream_ = cuda_device_api->GetStream();
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    DLTensor* x = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* key = ir::Downcast<TensorValue>(inputs[1]);
+    DLTensor* bias = has_bias_ ? ir::Downcast<TensorValue>(inputs[2]).operator->() : nullptr;
+    DLTensor* residual =
+        has_residual_ ? ir::Downcast<TensorValue>(inputs.back()).operator->() : nullptr;
+    DLTensor* out = ir::Downcast<TensorValue>(output);
+    switch (x->dtype.bits) {
+      case 16: {
+        HostPhiloxDropout<Half>(static_cast<Half*>(out->data), static_cast<const Half*>(x->data),
+                                bias ? static_cast<const Half*>(bias->data) : nullptr,
+                                residual ? static_cast<const Half*>(residual->data) : nullptr,
+                                static_cast<const uint64_t*>(key->data), p_, n_, bias_size_,
+                                compute_stream_);
+        break;
+      }
+      case 32: {
+        HostPhiloxDropout<float>(static_cast<float*>(out->data),
+                                 static_cast<const float*>(x->data),
+                                 bias ? static_cast<const float*>(bias->data) : nullptr,
+                                 residual ? static_cast<const float*>(residual->data) : nullptr,
+                                 static_cast<const uint64_t*>(key->data), p_, n_, bias_size_,
+                                 compute_stream_);
+        break;
+      }
+      default: {
+        LOG(FATAL) << "Unsupported dtype: " << DType(x->dtype).c_str();
+        throw;
+      }
+    }
+  }
+
+ protected:
+  int64_t n_;
+  double p_;
+  bool has_bias_ = false;
+  bool has_residual_ = false;
+  int64_t bias_size_ = 1;
+  void* compute_stream_;
+};
+
+class PhiloxDropoutImpl : public PhiloxDropoutImplBase {
+ public:
+  explicit PhiloxDropoutImpl(const CallValues& cv) {
+  }
+
+  /*! \brief Initialize with a call to the base op. */
+  void InitFromOp(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op._contrib_philox_dropout");
+    auto args = cv->args.as<op::schema::PhiloxDropoutArgs>();
+    this->arg_indices = {
+        fschema_index[op]("x"),
+        fschema_index[op]("key"),
+    };
+    InitProblem(args->x, args->p);
+  }
+
+  /*!
+   * \brief Initialize with a fused function of dropout(x + bias) + residual, where either add is
+   * optional. Return false if the body does not match.
+   */
+  bool InitFromFusedFunc(const CallValues& cv) {
+    static const Op& add_op = Op::Get("raf.op.cuda.add");
+    static const Op& dropout_op = Op::Get("raf.op.cuda._contrib_philox_dropout");
+    Function func = Downcast<ClosureValue>(cv->callee)->func;
+    Array<Value> args = GetListArgs(cv->args);
+    auto get_param_index = [&func](const Expr& expr) {
+      for (size_t i = 0; i < func->params.size(); ++i) {
+        if (func->params[i] == expr) {
+          return static_cast<int>(i);
+        }
+      }
+      return -1;
+    };
+
+    auto dropout = func->body.as<CallNode>();
+    int residual_index = -1;
+    if (dropout && dropout->op == add_op) {
+      // The add is commutative, so the dropout may be either of its arguments.
+      bool lhs = dropout->args[0].as<CallNode>() != nullptr;
+      residual_index = get_param_index(dropout->args[lhs ? 1 : 0]);
+      dropout = dropout->args[lhs ? 0 : 1].as<CallNode>();
+      if (residual_index < 0) {
+        return false;
+      }
+    }
+    if (!dropout || dropout->op != dropout_op) {
+      return false;
+    }
+    int key_index = get_param_index(dropout->args[1]);
+    int p_index = get_param_index(dropout->args[2]);
+    if (key_index < 0 || p_index < 0) {
+      return false;
+    }
+    int x_index = get_param_index(dropout->args[0]);
+    int bias_index = -1;
+    if (auto bias_add = dropout->args[0].as<CallNode>()) {
+      if (bias_add->op != add_op) {
+        return false;
+      }
+      x_index = get_param_index(bias_add->args[0]);
+      bias_index = get_param_index(bias_add->args[1]);
+      if (bias_index < 0) {
+        return false;
+      }
+    }
+    if (x_index < 0) {
+      return false;
+    }
+    // The dropout rate is read once when the OpEnv is created, so it is expected to be unchanged.
+    double p = GetScalarValueData<double>(args[p_index]);
+    const DLTensor* x = Downcast<TensorValue>(args[x_index]);
+    const DLTensor* out = Downcast<TensorValue>(cv->out);
+    if (x->ndim != out->ndim || !std::equal(x->shape, x->shape + x->ndim, out->shape)) {
+      // x is broadcast by the bias.
+      return false;
+    }
+    this->arg_indices = {x_index, key_index};
+    if (bias_index >= 0) {
+      // The bias is broadcast along the trailing dims of x, so its dims are a suffix of the dims
+      // of x after dropping its leading dims of 1.
+      const DLTensor* bias = Downcast<TensorValue>(args[bias_index]);
+      int lead = 0;
+      while (lead < bias->ndim && bias->shape[lead] == 1) {
+        ++lead;
+      }
+      int ndim = bias->ndim - lead;
+      if (ndim > x->ndim ||
+          !std::equal(bias->shape + lead, bias->shape + bias->ndim, x->shape + x->ndim - ndim)) {
+        return false;
+      }
+      if (bias->dtype != x->dtype) {
+        return false;
+      }
+      bias_size_ = 1;
+      for (int i = lead; i < bias->ndim; ++i) {
+        bias_size_ *= bias->shape[i];
+      }
+      has_bias_ = true;
+      this->arg_indices.push_back(bias_index);
+    }
+    if (residual_index >= 0) {
+      const DLTensor* residual = Downcast<TensorValue>(args[residual_index]);
+      if (residual->ndim != x->ndim || residual->dtype != x->dtype ||
+          !std::equal(x->shape, x->shape + x->ndim, residual->shape)) {
+        return false;
+      }
+      has_residual_ = true;
+      this->arg_indices.push_back(residual_index);
+    }
+    InitProblem(x, p);
+    return true;
+  }
+
+  void Execute(const CallValues& cv) override {
+    if (auto args = cv->args.as<op::schema::PhiloxDropoutArgs>()) {
+      PhiloxDropoutImplBase::Execute(std::vector<Value>{args->x, args->key}, cv->out);
+      return;
+    }
+    Array<Value> args = GetListArgs(cv->args);
+    std::vector<Value> inputs;
+    for (int index : arg_indices) {
+      inputs.push_back(args[index]);
+    }
+    PhiloxDropoutImplBase::Execute(inputs, cv->out);
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda._contrib_philox_dropout"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    auto op_env = std::make_unique<PhiloxDropoutImpl>(cv);
+    op_env->InitFromOp(cv);
+    return op_env.release();
+  }
+
+  static OpEnv* MakeFused(const CallValues& cv) {
+    auto op_env = std::make_unique<PhiloxDropoutImpl>(cv);
+    try {
+      if (!op_env->InitFromFusedFunc(cv)) {
+        dispatch_error_msgs.push_back("[CUDA] Cannot JIT: the fused dropout does not match");
+        return nullptr;
+      }
+    } catch (const dmlc::Error& e) {
+      std::stringstream ss;
+      ss << "[CUDA] Failed to JIT: " << e.what();
+      dispatch_error_msgs.push_back(ss.str());
+      return nullptr;
+    }
+    return op_env.release();
+  }
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, _contrib_philox_dropout, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda._contrib_philox_dropout", PhiloxDropoutImpl::make);
+RAF_OP_ENV_MAKER("raf.op.cuda._fused_philox_dropout", PhiloxDropoutImpl::MakeFused);
+
+class PhiloxDropoutDxImpl : public PhiloxDropoutImplBase {
+ public:
+  explicit PhiloxDropoutDxImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op._contrib_philox_dropout_dx");
+    auto args = cv->args.as<op::schema::PhiloxDropoutDxArgs>();
+    this->arg_indices = {
+        fschema_index[op]("dy"),
+        fschema_index[op]("key"),
+    };
+    InitProblem(args->dy, args->p);
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::PhiloxDropoutDxArgs>();
+    CHECK(args != nullptr);
+    // The mask is regenerated from the key, which is the same kernel as the forward on dy.
+    PhiloxDropoutImplBase::Execute(std::vector<Value>{args->dy, args->key}, cv->out);
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda._contrib_philox_dropout_dx"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new PhiloxDropoutDxImpl(cv);
+  }
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, _contrib_philox_dropout_dx, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda._contrib_philox_dropout_dx", PhiloxDropoutDxImpl::make);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
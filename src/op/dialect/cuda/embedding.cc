@@ -5,7 +5,7 @@
 
 /*!
  * \file src/op/dialect/cuda/embedding.cc
- * \brief embedding_dx cuda backend
+ * \brief embedding_dx and embedding_sparse_dx cuda backend
  */
 #include "raf/op.h"
 #include "raf/op_utils.h"
@@ -20,6 +20,14 @@ namespace cuda {
 using namespace raf::value;
 using device_api::DeviceAPI;
 
+inline int64_t NumIndices(const DLTensor* indices) {
+  int64_t n = 1;
+  for (int i = 0; i < indices->ndim; ++i) {
+    n *= indices->shape[i];
+  }
+  return n;
+}
+
 class EmbeddingDxImpl : public raf::op::OpEnv {
  public:
   explicit EmbeddingDxImpl(const CallValues& cv) {
@@ -27,15 +35,15 @@ class EmbeddingDxImpl : public raf::op::OpEnv {
         ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
     static auto op = ir::Op::Get("raf.op.embedding_dx");
     auto args = cv->args.as<op::schema::EmbeddingDxArgs>();
-    n_out_elements_ = 1;
     std::vector<int64_t> num_weight = GetShapeVecFromValue(args->num_weight);
-    for (int i = 0; i < num_weight.size(); ++i) {
-      n_out_elements_ *= num_weight[i];
-    }
+    index_range_ = num_weight[0];
+    n_indices_ = NumIndices(args->indices);
     this->arg_indices = {
         fschema_index[op]("dy"),
         fschema_index[op]("indices"),
     };
+    RequestWorkspace(&workspace_, cv->device,
+                     embedding_backward_workspace_bytes(n_indices_, index_range_));
   }
 
   void Execute(const CallValues& cv) override {
@@ -49,26 +57,21 @@ class EmbeddingDxImpl : public raf::op::OpEnv {
     DLTensor* indices = ir::Downcast<TensorValue>(inputs[1]);
     DLTensor* out = ir::Downcast<TensorValue>(output);
     int stride = dy->shape[dy->ndim - 1];
-    int index_range = out->shape[0];
-    int n_indices = 1;
-    for (int i = 0; i < indices->ndim; ++i) {
-      n_indices *= indices->shape[i];
-    }
 
     CHECK(out->dtype.code == kDLFloat);
     CHECK((out->dtype.bits == 32) || (out->dtype.bits == 16));
     switch (out->dtype.bits) {
       case 32:
-        embedding_dense_backward_cuda<float, float>(
+        embedding_dense_backward_cuda<float>(
             static_cast<const float*>(dy->data), static_cast<float*>(out->data),
-            static_cast<const int64_t*>(indices->data), n_indices, index_range, stride,
-            cuda_device_api->GetStream(), n_out_elements_);
+            static_cast<const int64_t*>(indices->data), n_indices_, index_range_, stride,
+            workspace_, cuda_device_api->GetStream());
         return;
       case 16:
-        embedding_dense_backward_cuda<__half, __half>(
+        embedding_dense_backward_cuda<__half>(
             static_cast<const __half*>(dy->data), static_cast<__half*>(out->data),
-            static_cast<const int64_t*>(indices->data), n_indices, index_range, stride,
-            cuda_device_api->GetStream(), n_out_elements_);
+            static_cast<const int64_t*>(indices->data), n_indices_, index_range_, stride,
+            workspace_, cuda_device_api->GetStream());
         return;
     }
   }
@@ -82,12 +85,81 @@ class EmbeddingDxImpl : public raf::op::OpEnv {
   }
 
  private:
-  int64_t n_out_elements_;
+  int n_indices_;
+  int index_range_;
+  void* workspace_;
 };
 
 RAF_REGISTER_DIALECT_OP(cuda, embedding_dx, 20);
 RAF_OP_ENV_MAKER("raf.op.cuda.embedding_dx", EmbeddingDxImpl::make);
 
+class EmbeddingSparseDxImpl : public raf::op::OpEnv {
+ public:
+  explicit EmbeddingSparseDxImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.embedding_sparse_dx");
+    auto args = cv->args.as<op::schema::EmbeddingDxArgs>();
+    std::vector<int64_t> num_weight = GetShapeVecFromValue(args->num_weight);
+    index_range_ = num_weight[0];
+    n_indices_ = NumIndices(args->indices);
+    this->arg_indices = {
+        fschema_index[op]("dy"),
+        fschema_index[op]("indices"),
+    };
+    RequestWorkspace(&workspace_, cv->device,
+                     embedding_backward_workspace_bytes(n_indices_, index_range_));
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::EmbeddingDxArgs>();
+    Execute(std::vector<value::Value>{args->dy, args->indices}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    DLTensor* dy = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* indices = ir::Downcast<TensorValue>(inputs[1]);
+    TupleValue out = ir::Downcast<TupleValue>(output);
+    DLTensor* rows = ir::Downcast<TensorValue>(out->fields[0]);
+    DLTensor* values = ir::Downcast<TensorValue>(out->fields[1]);
+    int stride = dy->shape[dy->ndim - 1];
+
+    CHECK(values->dtype.code == kDLFloat);
+    CHECK((values->dtype.bits == 32) || (values->dtype.bits == 16));
+    switch (values->dtype.bits) {
+      case 32:
+        embedding_sparse_backward_cuda<float>(
+            static_cast<const float*>(dy->data), static_cast<int64_t*>(rows->data),
+            static_cast<float*>(values->data), static_cast<const int64_t*>(indices->data),
+            n_indices_, index_range_, stride, workspace_, cuda_device_api->GetStream());
+        return;
+      case 16:
+        embedding_sparse_backward_cuda<__half>(
+            static_cast<const __half*>(dy->data), static_cast<int64_t*>(rows->data),
+            static_cast<__half*>(values->data), static_cast<const int64_t*>(indices->data),
+            n_indices_, index_range_, stride, workspace_, cuda_device_api->GetStream());
+        return;
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.embedding_sparse_dx"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new EmbeddingSparseDxImpl(cv);
+  }
+
+ private:
+  int n_indices_;
+  int index_range_;
+  void* workspace_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, embedding_sparse_dx, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.embedding_sparse_dx", EmbeddingSparseDxImpl::make);
+
 }  // namespace cuda
 }  // namespace op
 }  // namespace raf
@@ -0,0 +1,409 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/embedding_layer_norm.cc
+ * \brief Fused embedding gathers + add + layer_norm cuda backend
+ */
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include "raf/op.h"
+#include "raf/op_utils.h"
+#include "raf/device_api.h"
+#include "./kernels/layer_norm.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+using namespace raf::ir;
+using namespace raf::value;
+using device_api::DeviceAPI;
+
+using namespace c10;
+
+/*! \brief The common part of the fused embedding layer norm forward and backward. */
+class EmbeddingLayerNormImplBase : public raf::op::OpEnv {
+ public:
+  /*! \brief Get the index of the fused function parameter, or -1 if expr is not a parameter. */
+  static int GetParamIndex(const Function& func, const Expr& expr) {
+    for (size_t i = 0; i < func->params.size(); ++i) {
+      if (func->params[i] == expr) {
+        return static_cast<int>(i);
+      }
+    }
+    return -1;
+  }
+
+  /*!
+   * \brief Collect the (table, indices) parameter indices of the embeddings summed by the adds.
+   * Return false if expr is not such a sum.
+   */
+  static bool CollectEmbeddings(const Function& func, const Expr& expr,
+                                std::vector<std::pair<int, int>>* embeddings) {
+    static const Op& add_op = Op::Get("raf.op.cuda.add");
+    static const Op& embedding_op = Op::Get("raf.op.cuda.embedding");
+    auto call = expr.as<CallNode>();
+    if (!call) {
+      return false;
+    }
+    if (call->op == add_op) {
+      return CollectEmbeddings(func, call->args[0], embeddings) &&
+             CollectEmbeddings(func, call->args[1], embeddings);
+    }
+    if (call->op != embedding_op) {
+      return false;
+    }
+    int table_index = GetParamIndex(func, call->args[0]);
+    int indices_index = GetParamIndex(func, call->args[1]);
+    if (table_index < 0 || indices_index < 0) {
+      return false;
+    }
+    embeddings->emplace_back(table_index, indices_index);
+    return true;
+  }
+
+  /*!
+   * \brief Resolve the problem from the layer norm of the summed embeddings, whose args are
+   * (x, scale, ..., axis, eps), where x is in the shape of out. Return false if they do not
+   * match.
+   */
+  bool InitProblem(const Function& func, const Array<Value>& args, const CallNode* layer_norm,
+                   const DLTensor* out) {
+    std::vector<std::pair<int, int>> embeddings;
+    if (!CollectEmbeddings(func, layer_norm->args[0], &embeddings) || embeddings.size() < 2 ||
+        embeddings.size() > kMaxEmbeddingTables) {
+      return false;
+    }
+    int scale_index = GetParamIndex(func, layer_norm->args[1]);
+    int axis_index = GetParamIndex(func, layer_norm->args[layer_norm->args.size() - 2]);
+    int eps_index = GetParamIndex(func, layer_norm->args.back());
+    if (scale_index < 0 || axis_index < 0 || eps_index < 0) {
+      return false;
+    }
+    int64_t axis = GetScalarValueData<int64_t>(args[axis_index]);
+    if (out->ndim < 2 || (axis != -1 && axis != out->ndim - 1)) {
+      return false;
+    }
+    eps_ = GetScalarValueData<double>(args[eps_index]);
+    dtype_ = out->dtype;
+    CHECK(dtype_.code == kDLFloat && (dtype_.bits == 32 || dtype_.bits == 16))
+        << "Unsupported dtype: " << DType(dtype_).c_str();
+    n2_ = out->shape[out->ndim - 1];
+    n1_ = 1;
+    for (int i = 0; i < out->ndim - 1; ++i) {
+      n1_ *= out->shape[i];
+    }
+    const DLTensor* scale = Downcast<TensorValue>(args[scale_index]);
+    if (scale->ndim != 1 || scale->shape[0] != n2_ || scale->dtype != dtype_) {
+      return false;
+    }
+
+    for (const auto& embedding : embeddings) {
+      const DLTensor* table = Downcast<TensorValue>(args[embedding.first]);
+      const DLTensor* indices = Downcast<TensorValue>(args[embedding.second]);
+      if (table->ndim != 2 || table->shape[1] != n2_ || table->dtype != dtype_ ||
+          indices->dtype.code != kDLInt || indices->dtype.bits != 64) {
+        return false;
+      }
+      // The indices are broadcast along the leading dims of out, so their dims after dropping
+      // the leading dims of 1 are a suffix of the dims of the rows of out.
+      int lead = 0;
+      while (lead < indices->ndim && indices->shape[lead] == 1) {
+        ++lead;
+      }
+      int ndim = indices->ndim - lead;
+      if (ndim > out->ndim - 1 ||
+          !std::equal(indices->shape + lead, indices->shape + indices->ndim,
+                      out->shape + out->ndim - 1 - ndim)) {
+        return false;
+      }
+      int64_t num_indices = 1;
+      for (int i = lead; i < indices->ndim; ++i) {
+        num_indices *= indices->shape[i];
+      }
+      table_rows_.push_back(table->shape[0]);
+      num_indices_.push_back(num_indices);
+      this->arg_indices.push_back(embedding.first);
+      this->arg_indices.push_back(embedding.second);
+    }
+    num_tables_ = embeddings.size();
+    this->arg_indices.push_back(scale_index);
+
+    cudaDeviceProp deviceProp;
+    CUDA_CALL(cudaGetDeviceProperties(&deviceProp, out->device.device_id));
+    maxGridY_ = deviceProp.maxGridSize[1];
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    compute_stream_ = cuda_device_api->GetStream();
+    return true;
+  }
+
+  void Execute(const CallValues& cv) override {
+    Array<Value> args = GetListArgs(cv->args);
+    std::vector<Value> inputs;
+    for (int index : arg_indices) {
+      inputs.push_back(args[index]);
+    }
+    Execute(inputs, cv->out);
+  }
+
+ protected:
+  /*! \brief Make the gather from the leading inputs, which are the (table, indices) pairs. */
+  template <typename T>
+  EmbeddingGather<T> MakeGather(const std::vector<Value>& inputs) const {
+    EmbeddingGather<T> gather;
+    gather.num_tables = num_tables_;
+    for (int t = 0; t < num_tables_; ++t) {
+      gather.tables[t] = static_cast<const T*>(Downcast<TensorValue>(inputs[2 * t])->data);
+      gather.indices[t] =
+          static_cast<const int64_t*>(Downcast<TensorValue>(inputs[2 * t + 1])->data);
+      gather.num_indices[t] = num_indices_[t];
+      gather.table_rows[t] = table_rows_[t];
+    }
+    return gather;
+  }
+
+  int num_tables_;
+  std::vector<int64_t> table_rows_;
+  std::vector<int64_t> num_indices_;
+  DLDataType dtype_;
+  double eps_;
+  int n1_, n2_;
+  uint64_t maxGridY_;
+  void* compute_stream_;
+};
+
+class EmbeddingLayerNormImpl : public EmbeddingLayerNormImplBase {
+ public:
+  explicit EmbeddingLayerNormImpl(const CallValues& cv) {
+  }
+
+  /*!
+   * \brief Initialize with a fused function of layer_norm(embedding(w0, i0) + embedding(w1, i1)
+   * [+ embedding(w2, i2)], scale, bias, -1, eps), or layer_norm_train of the same args. Return
+   * false if the body does not match.
+   */
+  bool InitFromFusedFunc(const CallValues& cv) {
+    static const Op& layer_norm_op = Op::Get("raf.op.cuda.layer_norm");
+    static const Op& layer_norm_train_op = Op::Get("raf.op.cuda.layer_norm_train");
+    Function func = Downcast<ClosureValue>(cv->callee)->func;
+    Array<Value> args = GetListArgs(cv->args);
+
+    auto layer_norm = func->body.as<CallNode>();
+    if (!layer_norm || (layer_norm->op != layer_norm_op && layer_norm->op != layer_norm_train_op)) {
+      return false;
+    }
+    train_ = layer_norm->op == layer_norm_train_op;
+    const DLTensor* out = train_ ? Downcast<TensorValue>(Downcast<TupleValue>(cv->out)->fields[0])
+                                 : Downcast<TensorValue>(cv->out);
+    int bias_index = GetParamIndex(func, layer_norm->args[2]);
+    if (bias_index < 0 || !InitProblem(func, args, layer_norm, out)) {
+      return false;
+    }
+    const DLTensor* bias = Downcast<TensorValue>(args[bias_index]);
+    if (bias->ndim != 1 || bias->shape[0] != n2_ || bias->dtype != dtype_) {
+      return false;
+    }
+    this->arg_indices.push_back(bias_index);
+    if (!train_) {
+      // The statistics are only kept by layer_norm_train for the backward.
+      RequestWorkspace(&stats_, cv->device, sizeof(float) * 2 * n1_);
+    }
+    // The warp-per-row kernel gathers the rows into the registers, and the others normalize the
+    // sum gathered into the workspace.
+    use_warp_ =
+        dtype_.bits == 16 ? UseLayerNormWarp<Half>(n2_, {}) : UseLayerNormWarp<float>(n2_, {});
+    if (!use_warp_) {
+      RequestWorkspace(&sum_, cv->device, static_cast<int64_t>(n1_) * n2_ * dtype_.bits / 8);
+    }
+    return true;
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    switch (dtype_.bits) {
+      case 16: {
+        Run<Half>(inputs, output);
+        break;
+      }
+      case 32: {
+        Run<float>(inputs, output);
+        break;
+      }
+      default: {
+        LOG(FATAL) << "Unsupported dtype: " << DType(dtype_).c_str();
+        throw;
+      }
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.embedding_layer_norm"));
+  }
+
+  static OpEnv* MakeFused(const CallValues& cv) {
+    auto op_env = std::make_unique<EmbeddingLayerNormImpl>(cv);
+    try {
+      if (!op_env->InitFromFusedFunc(cv)) {
+        dispatch_error_msgs.push_back(
+            "[CUDA] Cannot JIT: the fused embedding layer norm does not match");
+        return nullptr;
+      }
+    } catch (const dmlc::Error& e) {
+      std::stringstream ss;
+      ss << "[CUDA] Failed to JIT: " << e.what();
+      dispatch_error_msgs.push_back(ss.str());
+      return nullptr;
+    }
+    return op_env.release();
+  }
+
+ private:
+  template <typename T>
+  void Run(const std::vector<Value>& inputs, Value output) {
+    EmbeddingGather<T> gather = MakeGather<T>(inputs);
+    const T* scale = static_cast<const T*>(Downcast<TensorValue>(inputs[2 * num_tables_])->data);
+    const T* bias =
+        static_cast<const T*>(Downcast<TensorValue>(inputs[2 * num_tables_ + 1])->data);
+    T* out;
+    float *mean, *invvar;
+    if (train_) {
+      TupleValue out_tuple = Downcast<TupleValue>(output);
+      out = static_cast<T*>(Downcast<TensorValue>(out_tuple->fields[0])->data);
+      mean = static_cast<float*>(Downcast<TensorValue>(out_tuple->fields[1])->data);
+      invvar = static_cast<float*>(Downcast<TensorValue>(out_tuple->fields[2])->data);
+    } else {
+      out = static_cast<T*>(Downcast<TensorValue>(output)->data);
+      mean = static_cast<float*>(stats_);
+      invvar = mean + n1_;
+    }
+    if (use_warp_) {
+      LayerNormPrologue<T> prologue;
+      prologue.gather = gather;
+      HostApplyLayerNormWarp<T>(out, mean, invvar, nullptr, n1_, n2_, scale, bias, eps_, prologue,
+                                compute_stream_);
+      return;
+    }
+    T* sum = static_cast<T*>(sum_);
+    HostEmbeddingSum<T>(sum, gather, n1_, n2_, compute_stream_);
+    HostApplyLayerNorm<T, float, T>(out, mean, invvar, sum, n1_, n2_, scale, bias, eps_,
+                                    compute_stream_, maxGridY_);
+  }
+
+  bool train_;
+  bool use_warp_;
+  void* stats_ = nullptr;
+  void* sum_ = nullptr;
+};
+
+RAF_OP_ENV_MAKER("raf.op.cuda._fused_embedding_layer_norm", EmbeddingLayerNormImpl::MakeFused);
+
+class EmbeddingLayerNormDxImpl : public EmbeddingLayerNormImplBase {
+ public:
+  explicit EmbeddingLayerNormDxImpl(const CallValues& cv) {
+  }
+
+  /*!
+   * \brief Initialize with a fused function of layer_norm_train_dx(x, scale, dy, mean, invvar,
+   * -1, eps), where x is the sum of the embeddings as the forward, which is gathered again
+   * instead of being kept for the backward. The gradient of x is accumulated to the tables by
+   * the sort-based embedding_dx. Return false if the body does not match.
+   */
+  bool InitFromFusedFunc(const CallValues& cv) {
+    static const Op& layer_norm_dx_op = Op::Get("raf.op.cuda.layer_norm_train_dx");
+    Function func = Downcast<ClosureValue>(cv->callee)->func;
+    Array<Value> args = GetListArgs(cv->args);
+
+    auto layer_norm_dx = func->body.as<CallNode>();
+    if (!layer_norm_dx || layer_norm_dx->op != layer_norm_dx_op) {
+      return false;
+    }
+    const DLTensor* dx = Downcast<TensorValue>(Downcast<TupleValue>(cv->out)->fields[0]);
+    int dy_index = GetParamIndex(func, layer_norm_dx->args[2]);
+    int mean_index = GetParamIndex(func, layer_norm_dx->args[3]);
+    int invvar_index = GetParamIndex(func, layer_norm_dx->args[4]);
+    if (dy_index < 0 || mean_index < 0 || invvar_index < 0 ||
+        !InitProblem(func, args, layer_norm_dx, dx)) {
+      return false;
+    }
+    this->arg_indices.push_back(dy_index);
+    this->arg_indices.push_back(mean_index);
+    this->arg_indices.push_back(invvar_index);
+    RequestWorkspace(&sum_, cv->device, static_cast<int64_t>(n1_) * n2_ * dtype_.bits / 8);
+    const int part_size = 16;
+    RequestWorkspace(&part_grad_gamma_, cv->device, 4 * part_size * n2_);
+    RequestWorkspace(&part_grad_beta_, cv->device, 4 * part_size * n2_);
+    return true;
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    switch (dtype_.bits) {
+      case 16: {
+        Run<Half>(inputs, output);
+        break;
+      }
+      case 32: {
+        Run<float>(inputs, output);
+        break;
+      }
+      default: {
+        LOG(FATAL) << "Unsupported dtype: " << DType(dtype_).c_str();
+        throw;
+      }
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.embedding_layer_norm_dx"));
+  }
+
+  static OpEnv* MakeFused(const CallValues& cv) {
+    auto op_env = std::make_unique<EmbeddingLayerNormDxImpl>(cv);
+    try {
+      if (!op_env->InitFromFusedFunc(cv)) {
+        dispatch_error_msgs.push_back(
+            "[CUDA] Cannot JIT: the fused embedding layer norm gradient does not match");
+        return nullptr;
+      }
+    } catch (const dmlc::Error& e) {
+      std::stringstream ss;
+      ss << "[CUDA] Failed to JIT: " << e.what();
+      dispatch_error_msgs.push_back(ss.str());
+      return nullptr;
+    }
+    return op_env.release();
+  }
+
+ private:
+  template <typename T>
+  void Run(const std::vector<Value>& inputs, Value output) {
+    EmbeddingGather<T> gather = MakeGather<T>(inputs);
+    int base = 2 * num_tables_;
+    T* scale = static_cast<T*>(Downcast<TensorValue>(inputs[base])->data);
+    T* dy = static_cast<T*>(Downcast<TensorValue>(inputs[base + 1])->data);
+    float* mean = static_cast<float*>(Downcast<TensorValue>(inputs[base + 2])->data);
+    float* invvar = static_cast<float*>(Downcast<TensorValue>(inputs[base + 3])->data);
+    TupleValue out_tuple = Downcast<TupleValue>(output);
+    T* dx = static_cast<T*>(Downcast<TensorValue>(out_tuple->fields[0])->data);
+    T* dw = static_cast<T*>(Downcast<TensorValue>(out_tuple->fields[1])->data);
+    T* db = static_cast<T*>(Downcast<TensorValue>(out_tuple->fields[2])->data);
+    T* sum = static_cast<T*>(sum_);
+    HostEmbeddingSum<T>(sum, gather, n1_, n2_, compute_stream_);
+    HostLayerNormGradient<T, T>(dy, mean, invvar, sum, n1_, n2_, scale, eps_, dx, dw, db,
+                                static_cast<float*>(part_grad_gamma_),
+                                static_cast<float*>(part_grad_beta_), compute_stream_, maxGridY_);
+  }
+
+  void* sum_ = nullptr;
+  void* part_grad_gamma_ = nullptr;
+  void* part_grad_beta_ = nullptr;
+};
+
+RAF_OP_ENV_MAKER("raf.op.cuda._fused_embedding_layer_norm_dx",
+                 EmbeddingLayerNormDxImpl::MakeFused);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,76 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/fp8.cc
+ * \brief The delayed scaling of the FP8 tensors cuda backend
+ */
+#include "raf/op.h"
+#include "raf/device_api.h"
+#include "../../schema/nn.h"
+#include "./kernels/kernel_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+using namespace raf::value;
+using device_api::DeviceAPI;
+
+/*! \brief The largest finite values of E4M3 and E5M2. */
+constexpr float kFloat8E4M3Max = 448.0f;
+constexpr float kFloat8E5M2Max = 57344.0f;
+
+/*! \brief Update the amax history and the scale of the FP8 tensor in place by its amax. */
+class UpdateFp8ScaleImpl : public raf::op::OpEnv {
+ public:
+  explicit UpdateFp8ScaleImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op._contrib_update_fp8_scale");
+    auto args = cv->args.as<op::schema::UpdateFp8ScaleArgs>();
+    this->arg_indices = {
+        fschema_index[op]("amax_history"),
+        fschema_index[op]("scale"),
+        fschema_index[op]("amax"),
+    };
+    fp8_max_ = args->e5m2 ? kFloat8E5M2Max : kFloat8E4M3Max;
+    margin_ = args->margin;
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::UpdateFp8ScaleArgs>();
+    Execute(std::vector<Value>{args->amax_history, args->scale, args->amax}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    DLTensor* amax_history = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* scale = ir::Downcast<TensorValue>(inputs[1]);
+    DLTensor* amax = ir::Downcast<TensorValue>(inputs[2]);
+    update_fp8_scale_cuda(static_cast<float*>(amax_history->data), amax_history->shape[0],
+                          static_cast<float*>(scale->data), static_cast<const float*>(amax->data),
+                          fp8_max_, margin_, cuda_device_api->GetStream());
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda._contrib_update_fp8_scale"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new UpdateFp8ScaleImpl(cv);
+  }
+
+ private:
+  float fp8_max_;
+  int margin_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, _contrib_update_fp8_scale, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda._contrib_update_fp8_scale", UpdateFp8ScaleImpl::make);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
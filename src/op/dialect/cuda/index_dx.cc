@@ -0,0 +1,462 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/index_dx.cc
+ * \brief take_dx, gather_dx, gather_nd_dx and adv_index_dx cuda backend
+ */
+#include <limits>
+#include "raf/op.h"
+#include "raf/op_utils.h"
+#include "raf/device_api.h"
+#include "../../schema/nn.h"
+#include "../../schema/transform.h"
+#include "./kernels/scatter_add.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+using namespace raf::ir;
+using namespace raf::value;
+using device_api::DeviceAPI;
+
+using namespace c10;
+
+inline int64_t NumElements(const DLTensor* t, int begin = 0, int end = -1) {
+  end = end < 0 ? t->ndim : end;
+  int64_t n = 1;
+  for (int i = begin; i < end; ++i) {
+    n *= t->shape[i];
+  }
+  return n;
+}
+
+inline ScatterShape MakeScatterShape(const DLTensor* t) {
+  ScatterShape shape;
+  shape.ndim = t->ndim;
+  std::copy(t->shape, t->shape + t->ndim, shape.dims);
+  return shape;
+}
+
+/*!
+ * \brief Check whether the kernels support the scatter-add of num rows into range rows, and push
+ * the reason to the dispatch errors if not, so the op falls back to the other dialects.
+ */
+bool IsScatterAddSupported(const DLTensor* dx, const std::vector<const DLTensor*>& indices,
+                           int64_t num, int64_t range) {
+  std::string reason;
+  bool int_index = true;
+  for (const DLTensor* index : indices) {
+    int_index &= index->dtype.code == kDLInt &&
+                 (index->dtype.bits == 32 || index->dtype.bits == 64) &&
+                 index->dtype.bits == indices[0]->dtype.bits && index->ndim <= kMaxScatterDims;
+  }
+  if (dx->dtype.code != kDLFloat || (dx->dtype.bits != 16 && dx->dtype.bits != 32)) {
+    reason = "unsupported dtype " + std::string(DType(dx->dtype).c_str());
+  } else if (!int_index) {
+    reason = "the indices must be int32 or int64 of the same dtype";
+  } else if (dx->ndim > kMaxScatterDims) {
+    reason = "too many dims";
+  } else if (num > std::numeric_limits<int>::max() || range > std::numeric_limits<int>::max()) {
+    reason = "too many elements";
+  }
+  if (!reason.empty()) {
+    dispatch_error_msgs.push_back("[CUDA] Cannot scatter-add: " + reason);
+    return false;
+  }
+  return true;
+}
+
+/*!
+ * \brief The common part of the scatter-add backward of the indexing ops. The derived class
+ * implements LaunchImpl<T, I>(dy, inputs, dx), where inputs[0] is dy and the rest are the indices.
+ */
+template <typename Derived>
+class ScatterAddImplBase : public raf::op::OpEnv {
+ public:
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    DLTensor* dy = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* dx = static_cast<Derived*>(this)->GetOutput(output);
+    CHECK(dx->dtype.code == kDLFloat);
+    switch (dx->dtype.bits) {
+      case 16:
+        Dispatch<Half>(dy, inputs, dx);
+        return;
+      case 32:
+        Dispatch<float>(dy, inputs, dx);
+        return;
+      default:
+        LOG(FATAL) << "Unsupported dtype: " << DType(dx->dtype).c_str();
+        throw;
+    }
+  }
+
+  DLTensor* GetOutput(const Value& output) {
+    return ir::Downcast<TensorValue>(output);
+  }
+
+ protected:
+  /*! \brief Request the workspace and the stream of the scatter-add of num rows into range rows. */
+  void InitScatterAdd(const Device& device, int64_t num, int64_t range, int index_bits) {
+    index_bits_ = index_bits;
+    RequestWorkspace(&workspace_, device, ScatterAddWorkspaceBytes(num, range));
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    compute_stream_ = cuda_device_api->GetStream();
+  }
+
+  template <typename T>
+  void Dispatch(const DLTensor* dy, const std::vector<Value>& inputs, DLTensor* dx) {
+    auto* self = static_cast<Derived*>(this);
+    if (index_bits_ == 32) {
+      self->template LaunchImpl<T, int32_t>(static_cast<const T*>(dy->data), inputs,
+                                            static_cast<T*>(dx->data));
+    } else {
+      self->template LaunchImpl<T, int64_t>(static_cast<const T*>(dy->data), inputs,
+                                            static_cast<T*>(dx->data));
+    }
+  }
+
+  int index_bits_;
+  void* workspace_;
+  void* compute_stream_;
+};
+
+class TakeDxImpl : public ScatterAddImplBase<TakeDxImpl> {
+ public:
+  explicit TakeDxImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.take_dx");
+    auto args = cv->args.as<op::schema::TakeDxArgs>();
+    this->arg_indices = {
+        fschema_index[op]("dy"),
+        fschema_index[op]("indices"),
+    };
+    const DLTensor* x = args->x;
+    const DLTensor* indices = args->indices;
+    int axis = GetAxis(args);
+    // Without the axis, x is taken as flattened.
+    outer_ = axis < 0 ? 1 : NumElements(x, 0, axis);
+    axis_size_ = axis < 0 ? NumElements(x) : x->shape[axis];
+    inner_ = axis < 0 ? 1 : NumElements(x, axis + 1);
+    num_ = NumElements(indices);
+    wrap_ = args->mode == "wrap";
+    InitScatterAdd(cv->device, outer_ * num_, outer_ * axis_size_, indices->dtype.bits);
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::TakeDxArgs>();
+    ScatterAddImplBase::Execute(std::vector<Value>{args->dy, args->indices}, cv->out);
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.take_dx"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    auto args = cv->args.as<op::schema::TakeDxArgs>();
+    const DLTensor* x = args->x;
+    if (args->mode != "clip" && args->mode != "wrap") {
+      dispatch_error_msgs.push_back("[CUDA] Cannot scatter-add: unsupported mode " + args->mode);
+      return nullptr;
+    }
+    int axis = GetAxis(args);
+    int64_t rows = NumElements(args->indices) * (axis < 0 ? 1 : NumElements(x, 0, axis));
+    if (!IsScatterAddSupported(x, {args->indices}, rows, NumElements(x))) {
+      return nullptr;
+    }
+    return new TakeDxImpl(cv);
+  }
+
+ private:
+  friend class ScatterAddImplBase<TakeDxImpl>;
+
+  /*! \brief Get the normalized axis, or -1 if x is flattened. */
+  static int GetAxis(const op::schema::TakeDxArgs* args) {
+    if (!args->axis.defined()) {
+      return -1;
+    }
+    const auto* v = args->axis.as<IntValueObj>();
+    CHECK(v != nullptr);
+    int ndim = args->x->ndim;
+    return v->value < 0 ? v->value + ndim : v->value;
+  }
+
+  template <typename T, typename I>
+  void LaunchImpl(const T* dy, const std::vector<Value>& inputs, T* dx) {
+    const DLTensor* indices = ir::Downcast<TensorValue>(inputs[1]);
+    HostTakeDx<T, I>(dy, static_cast<const I*>(indices->data), dx, outer_, num_, axis_size_,
+                     inner_, wrap_, workspace_, compute_stream_);
+  }
+
+  int64_t outer_;
+  int64_t axis_size_;
+  int64_t inner_;
+  int64_t num_;
+  bool wrap_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, take_dx, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.take_dx", TakeDxImpl::make);
+
+class GatherDxImpl : public ScatterAddImplBase<GatherDxImpl> {
+ public:
+  explicit GatherDxImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.gather_dx");
+    auto args = cv->args.as<op::schema::GatherDxArgs>();
+    this->arg_indices = {
+        fschema_index[op]("dy"),
+        fschema_index[op]("indices"),
+    };
+    const DLTensor* data = args->data;
+    const DLTensor* indices = args->indices;
+    data_shape_ = MakeScatterShape(data);
+    indices_shape_ = MakeScatterShape(indices);
+    axis_ = args->axis < 0 ? args->axis + data->ndim : args->axis;
+    InitScatterAdd(cv->device, NumElements(indices), NumElements(data), indices->dtype.bits);
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::GatherDxArgs>();
+    ScatterAddImplBase::Execute(std::vector<Value>{args->dy, args->indices}, cv->out);
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.gather_dx"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    auto args = cv->args.as<op::schema::GatherDxArgs>();
+    const DLTensor* data = args->data;
+    const DLTensor* indices = args->indices;
+    if (indices->ndim != data->ndim) {
+      dispatch_error_msgs.push_back("[CUDA] Cannot scatter-add: the indices must have the dims "
+                                    "of the data");
+      return nullptr;
+    }
+    if (!IsScatterAddSupported(data, {indices}, NumElements(indices), NumElements(data))) {
+      return nullptr;
+    }
+    return new GatherDxImpl(cv);
+  }
+
+ private:
+  friend class ScatterAddImplBase<GatherDxImpl>;
+
+  template <typename T, typename I>
+  void LaunchImpl(const T* dy, const std::vector<Value>& inputs, T* dx) {
+    const DLTensor* indices = ir::Downcast<TensorValue>(inputs[1]);
+    HostGatherDx<T, I>(dy, static_cast<const I*>(indices->data), dx, data_shape_, indices_shape_,
+                       axis_, workspace_, compute_stream_);
+  }
+
+  ScatterShape data_shape_;
+  ScatterShape indices_shape_;
+  int axis_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, gather_dx, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.gather_dx", GatherDxImpl::make);
+
+class GatherNdDxImpl : public ScatterAddImplBase<GatherNdDxImpl> {
+ public:
+  explicit GatherNdDxImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.gather_nd_dx");
+    auto args = cv->args.as<op::schema::GatherNdDxArgs>();
+    this->arg_indices = {
+        fschema_index[op]("dy"),
+        fschema_index[op]("indices"),
+    };
+    const DLTensor* data = args->data;
+    const DLTensor* indices = args->indices;
+    data_shape_ = MakeScatterShape(data);
+    m_ = indices->shape[0];
+    num_ = NumElements(indices, 1);
+    inner_ = NumElements(data, m_);
+    InitScatterAdd(cv->device, num_, NumElements(data, 0, m_), indices->dtype.bits);
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::GatherNdDxArgs>();
+    ScatterAddImplBase::Execute(std::vector<Value>{args->dy, args->indices}, cv->out);
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.gather_nd_dx"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    auto args = cv->args.as<op::schema::GatherNdDxArgs>();
+    const DLTensor* data = args->data;
+    const DLTensor* indices = args->indices;
+    if (indices->ndim == 0 || indices->shape[0] > data->ndim) {
+      dispatch_error_msgs.push_back("[CUDA] Cannot scatter-add: invalid indices of gather_nd");
+      return nullptr;
+    }
+    int m = indices->shape[0];
+    if (!IsScatterAddSupported(data, {indices}, NumElements(indices, 1),
+                               NumElements(data, 0, m))) {
+      return nullptr;
+    }
+    return new GatherNdDxImpl(cv);
+  }
+
+ private:
+  friend class ScatterAddImplBase<GatherNdDxImpl>;
+
+  template <typename T, typename I>
+  void LaunchImpl(const T* dy, const std::vector<Value>& inputs, T* dx) {
+    const DLTensor* indices = ir::Downcast<TensorValue>(inputs[1]);
+    HostGatherNdDx<T, I>(dy, static_cast<const I*>(indices->data), dx, data_shape_, m_, num_,
+                         inner_, workspace_, compute_stream_);
+  }
+
+  ScatterShape data_shape_;
+  int m_;
+  int64_t num_;
+  int64_t inner_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, gather_nd_dx, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.gather_nd_dx", GatherNdDxImpl::make);
+
+class AdvIndexDxImpl : public ScatterAddImplBase<AdvIndexDxImpl> {
+ public:
+  explicit AdvIndexDxImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.adv_index_dx");
+    auto args = cv->args.as<op::schema::AdvIndexDxArgs>();
+    this->arg_indices = {
+        fschema_index[op]("dy"),
+        fschema_index[op]("inputs"),
+    };
+    const DLTensor* data = args->inputs[0];
+    std::vector<const DLTensor*> indices = GetIndices(args);
+    index_shape_ = BroadcastShape(indices);
+    data_shape_ = MakeScatterShape(data);
+    num_indices_ = indices.size();
+    // The broadcast strides of each index tensor, which are aligned to the trailing dims.
+    for (int k = 0; k < num_indices_; ++k) {
+      const DLTensor* index = indices[k];
+      int64_t stride = 1;
+      for (int d = index_shape_.ndim - 1; d >= 0; --d) {
+        int i = d - (index_shape_.ndim - index->ndim);
+        bool broadcast = i < 0 || index->shape[i] == 1;
+        strides_[k][d] = broadcast ? 0 : stride;
+        stride *= i < 0 ? 1 : index->shape[i];
+      }
+    }
+    int64_t num = 1;
+    for (int d = 0; d < index_shape_.ndim; ++d) {
+      num *= index_shape_.dims[d];
+    }
+    inner_ = NumElements(data, num_indices_);
+    InitScatterAdd(cv->device, num, NumElements(data, 0, num_indices_), indices[0]->dtype.bits);
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::AdvIndexDxArgs>();
+    Array<Value> inputs(args->inputs.begin(), args->inputs.end());
+    ScatterAddImplBase::Execute(std::vector<Value>{args->dy, TupleValue::make(inputs)}, cv->out);
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.adv_index_dx"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    auto args = cv->args.as<op::schema::AdvIndexDxArgs>();
+    const DLTensor* data = args->inputs[0];
+    std::vector<const DLTensor*> indices = GetIndices(args);
+    if (indices.empty() || static_cast<int>(indices.size()) > data->ndim) {
+      dispatch_error_msgs.push_back("[CUDA] Cannot scatter-add: invalid indices of adv_index");
+      return nullptr;
+    }
+    ScatterShape index_shape = BroadcastShape(indices);
+    int64_t num = 1;
+    for (int d = 0; d < index_shape.ndim; ++d) {
+      num *= index_shape.dims[d];
+    }
+    if (index_shape.ndim < 0 ||
+        !IsScatterAddSupported(data, indices, num, NumElements(data, 0, indices.size()))) {
+      return nullptr;
+    }
+    return new AdvIndexDxImpl(cv);
+  }
+
+  /*! \brief The output is a tuple of dx. */
+  DLTensor* GetOutput(const Value& output) {
+    return ir::Downcast<TensorValue>(ir::Downcast<TupleValue>(output)->fields[0]);
+  }
+
+ private:
+  friend class ScatterAddImplBase<AdvIndexDxImpl>;
+
+  static std::vector<const DLTensor*> GetIndices(const op::schema::AdvIndexDxArgs* args) {
+    std::vector<const DLTensor*> indices;
+    for (size_t i = 1; i < args->inputs.size(); ++i) {
+      indices.push_back(args->inputs[i]);
+    }
+    return indices;
+  }
+
+  /*! \brief Broadcast the shapes of the indices, where ndim is -1 if they are not broadcastable. */
+  static ScatterShape BroadcastShape(const std::vector<const DLTensor*>& indices) {
+    ScatterShape shape;
+    shape.ndim = 0;
+    for (const DLTensor* index : indices) {
+      shape.ndim = std::max(shape.ndim, index->ndim);
+    }
+    if (shape.ndim > kMaxScatterDims) {
+      shape.ndim = -1;
+      return shape;
+    }
+    std::fill(shape.dims, shape.dims + shape.ndim, 1);
+    for (const DLTensor* index : indices) {
+      for (int i = 0; i < index->ndim; ++i) {
+        int64_t& dim = shape.dims[shape.ndim - index->ndim + i];
+        if (index->shape[i] != 1 && dim != 1 && index->shape[i] != dim) {
+          shape.ndim = -1;
+          return shape;
+        }
+        dim = index->shape[i] == 1 ? dim : index->shape[i];
+      }
+    }
+    return shape;
+  }
+
+  template <typename T, typename I>
+  void LaunchImpl(const T* dy, const std::vector<Value>& inputs, T* dx) {
+    TupleValue tuple = ir::Downcast<TupleValue>(inputs[1]);
+    AdvIndices<I> indices;
+    indices.num = num_indices_;
+    for (int k = 0; k < num_indices_; ++k) {
+      const DLTensor* index = ir::Downcast<TensorValue>(tuple->fields[k + 1]);
+      indices.data[k] = static_cast<const I*>(index->data);
+      std::copy(strides_[k], strides_[k] + index_shape_.ndim, indices.strides[k]);
+    }
+    HostAdvIndexDx<T, I>(dy, indices, dx, data_shape_, index_shape_, inner_, workspace_,
+                         compute_stream_);
+  }
+
+  ScatterShape data_shape_;
+  ScatterShape index_shape_;
+  int num_indices_;
+  int64_t strides_[kMaxScatterDims][kMaxScatterDims];
+  int64_t inner_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, adv_index_dx, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.adv_index_dx", AdvIndexDxImpl::make);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
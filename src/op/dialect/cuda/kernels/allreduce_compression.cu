@@ -0,0 +1,128 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dispatch/cuda/kernels/allreduce_compression.cu
+ * \brief Top-k sparsification kernels with error feedback for compressed allreduce, and the
+ * float32 accumulation of 16-bit allreduce
+ */
+#include <algorithm>
+#if CUDA_VERSION >= 11000
+#include <cuda_bf16.h>
+#endif
+#include <thrust/execution_policy.h>
+#include <thrust/functional.h>
+#include <thrust/sort.h>
+#include "./kernel_util.cuh"
+#define BLOCK_SIZE 512
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+inline int num_blocks(int64_t n) {
+  return static_cast<int>(std::min<int64_t>((n + BLOCK_SIZE - 1) / BLOCK_SIZE, 65535));
+}
+
+// Accumulate the gradient to the error feedback, and keep the magnitudes for the selection.
+__global__ void accumulate_error_kernel(const float* grad, float* error, float* magnitude,
+                                        int64_t n) {
+  for (int64_t i = blockIdx.x * blockDim.x + threadIdx.x; i < n; i += blockDim.x * gridDim.x) {
+    float acc = error[i] + grad[i];
+    error[i] = acc;
+    magnitude[i] = fabsf(acc);
+  }
+}
+
+// Select k elements whose magnitudes are not less than the k-th largest one. The selected elements
+// are moved from the error feedback to the sparse values.
+__global__ void select_topk_kernel(float* error, int64_t n, int k, const float* threshold,
+                                   int* counter, int* indices, float* values) {
+  float thr = *threshold;
+  for (int64_t i = blockIdx.x * blockDim.x + threadIdx.x; i < n; i += blockDim.x * gridDim.x) {
+    float val = error[i];
+    if (fabsf(val) >= thr) {
+      int pos = atomicAdd(counter, 1);
+      if (pos < k) {
+        indices[pos] = static_cast<int>(i);
+        values[pos] = val;
+        error[i] = 0.0f;
+      }
+    }
+  }
+}
+
+// Scatter-add the sparse values gathered from all ranks to the dense output.
+__global__ void scatter_topk_kernel(const int* indices, const float* values, int64_t total,
+                                    float scale, float* out) {
+  for (int64_t i = blockIdx.x * blockDim.x + threadIdx.x; i < total;
+       i += blockDim.x * gridDim.x) {
+    atomicAdd(out + indices[i], values[i] * scale);
+  }
+}
+
+void topk_compress_cuda(const float* grad, float* error, int64_t n, int k, float* magnitude,
+                        int* counter, int* indices, float* values, void* stream) {
+  CHECK(k > 0 && k <= n) << "Invalid k " << k << " for " << n << " elements";
+  cudaStream_t cuda_stream = static_cast<cudaStream_t>(stream);
+  accumulate_error_kernel<<<num_blocks(n), BLOCK_SIZE, 0, cuda_stream>>>(grad, error, magnitude,
+                                                                         n);
+  // The k-th largest magnitude is the threshold of the selection.
+  thrust::sort(thrust::cuda::par.on(cuda_stream), magnitude, magnitude + n,
+               thrust::greater<float>());
+  CUDA_CALL(cudaMemsetAsync(counter, 0, sizeof(int), cuda_stream));
+  select_topk_kernel<<<num_blocks(n), BLOCK_SIZE, 0, cuda_stream>>>(
+      error, n, k, magnitude + k - 1, counter, indices, values);
+  CUDA_CALL(cudaGetLastError());
+}
+
+void topk_decompress_cuda(const int* indices, const float* values, int64_t total, float scale,
+                          float* out, int64_t n, void* stream) {
+  cudaStream_t cuda_stream = static_cast<cudaStream_t>(stream);
+  CUDA_CALL(cudaMemsetAsync(out, 0, n * sizeof(float), cuda_stream));
+  scatter_topk_kernel<<<num_blocks(total), BLOCK_SIZE, 0, cuda_stream>>>(indices, values, total,
+                                                                         scale, out);
+  CUDA_CALL(cudaGetLastError());
+}
+
+// Sum up the chunks in float32, which are reduce-scattered to this rank in 16 bits.
+template <typename T>
+__global__ void chunk_accumulate_kernel(const T* chunks, int num_chunks, int64_t n, float scale,
+                                        T* out) {
+  for (int64_t i = blockIdx.x * blockDim.x + threadIdx.x; i < n; i += blockDim.x * gridDim.x) {
+    float acc = 0.0f;
+    for (int j = 0; j < num_chunks; ++j) {
+      acc += static_cast<float>(chunks[j * n + i]);
+    }
+    out[i] = static_cast<T>(acc * scale);
+  }
+}
+
+void chunk_accumulate_cuda(const void* chunks, int num_chunks, int64_t n, DLDataType dtype,
+                           float scale, void* out, void* stream) {
+  if (n == 0) {
+    return;
+  }
+  cudaStream_t cuda_stream = static_cast<cudaStream_t>(stream);
+  CHECK(dtype.bits == 16 && dtype.lanes == 1) << "Only float16 and bfloat16 are accumulated";
+  if (dtype.code == kDLFloat) {
+    chunk_accumulate_kernel<<<num_blocks(n), BLOCK_SIZE, 0, cuda_stream>>>(
+        static_cast<const __half*>(chunks), num_chunks, n, scale, static_cast<__half*>(out));
+  } else {
+#if CUDA_VERSION >= 11000
+    CHECK_EQ(dtype.code, kDLBfloat) << "Only float16 and bfloat16 are accumulated";
+    chunk_accumulate_kernel<<<num_blocks(n), BLOCK_SIZE, 0, cuda_stream>>>(
+        static_cast<const __nv_bfloat16*>(chunks), num_chunks, n, scale,
+        static_cast<__nv_bfloat16*>(out));
+#else
+    LOG(FATAL) << "The accumulation of bfloat16 requires CUDA 11";
+#endif
+  }
+  CUDA_CALL(cudaGetLastError());
+}
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,54 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/attention.cuh
+ * \brief Headers of CUDA fused attention forward and backward kernels, and the KV cache update
+ */
+#pragma once
+#include <cuda_fp16.h>
+#include <stdint.h>
+#include "./Half.h"
+#include "../../../../common/cuda_utils.h"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+/*! \brief The maximum head dimension supported by the fused attention kernels. */
+constexpr int kAttentionMaxHeadDim = 128;
+
+/*!
+ * \brief out = softmax(scale * q * k^T) * v, where q is in [batch, seq_q, dim], k is in
+ * [batch, seq_k, dim] and v is in [batch, seq_k, vdim]. The keys are processed tile by tile
+ * with an online softmax, so the [seq_q, seq_k] scores are never materialized. If valid_len is
+ * not null, only the first *valid_len keys, read on the device, are attended.
+ */
+template <typename T>
+void HostAttentionForward(T* out, const T* q, const T* k, const T* v, int batch, int seq_q,
+                          int seq_k, int dim, int vdim, float scale, bool causal,
+                          const int64_t* valid_len, void* stream);
+
+/*!
+ * \brief The gradients of the fused attention. The scores are recomputed from q and k, and
+ * lse and delta are workspaces in [batch, seq_q] for the log-sum-exp of the scores and the
+ * row-wise dot product of dy and out.
+ */
+template <typename T>
+void HostAttentionBackward(T* dq, T* dk, T* dv, float* lse, float* delta, const T* q, const T* k,
+                           const T* v, const T* out, const T* dy, int batch, int seq_q, int seq_k,
+                           int dim, int vdim, float scale, bool causal, void* stream);
+
+/*!
+ * \brief Write x in [batch, seq, dim] to the rows [*offset, *offset + seq) of the cache in
+ * [batch, max_seq, dim] in place, where the offset is read on the device.
+ */
+template <typename T>
+void HostKvCacheAppend(T* cache, const T* x, const int64_t* offset, int batch, int max_seq,
+                       int seq, int dim, void* stream);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,421 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/attention_cuda_kernel.cu
+ * \brief Fused attention forward and backward cuda kernels in the style of FlashAttention.
+ *
+ * Each warp processes one row (a query in the forward and the dq pass, or a key in the dk/dv
+ * pass), and all warps of a block share the tiles of the other operand staged in shared memory.
+ * Within a tile, each lane computes the score of one column, and the accumulators of a row are
+ * distributed over the lanes along the head dimension. All the math is done in float32.
+ */
+#include <math.h>
+#include <algorithm>
+#include "./attention.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+using namespace c10;
+
+template void HostAttentionForward<float>(float* out, const float* q, const float* k,
+                                          const float* v, int batch, int seq_q, int seq_k,
+                                          int dim, int vdim, float scale, bool causal,
+                                          const int64_t* valid_len, void* stream);
+template void HostAttentionForward<Half>(Half* out, const Half* q, const Half* k, const Half* v,
+                                         int batch, int seq_q, int seq_k, int dim, int vdim,
+                                         float scale, bool causal, const int64_t* valid_len,
+                                         void* stream);
+template void HostAttentionBackward<float>(float* dq, float* dk, float* dv, float* lse,
+                                           float* delta, const float* q, const float* k,
+                                           const float* v, const float* out, const float* dy,
+                                           int batch, int seq_q, int seq_k, int dim, int vdim,
+                                           float scale, bool causal, void* stream);
+template void HostAttentionBackward<Half>(Half* dq, Half* dk, Half* dv, float* lse, float* delta,
+                                          const Half* q, const Half* k, const Half* v,
+                                          const Half* out, const Half* dy, int batch, int seq_q,
+                                          int seq_k, int dim, int vdim, float scale, bool causal,
+                                          void* stream);
+template void HostKvCacheAppend<float>(float* cache, const float* x, const int64_t* offset,
+                                       int batch, int max_seq, int seq, int dim, void* stream);
+template void HostKvCacheAppend<Half>(Half* cache, const Half* x, const int64_t* offset, int batch,
+                                      int max_seq, int seq, int dim, void* stream);
+
+static const int WARP_SIZE = 32;
+/*! \brief The number of rows of a tile, one per lane. */
+static const int TILE_SIZE = WARP_SIZE;
+/*! \brief The number of warps (i.e., rows) per block. */
+static const int NUM_WARPS = 8;
+
+__host__ __device__ __forceinline__ int CeilDiv(int a, int b) {
+  return (a + b - 1) / b;
+}
+
+__device__ __forceinline__ float WarpReduceMax(float val) {
+  for (int offset = WARP_SIZE / 2; offset > 0; offset /= 2) {
+    val = fmaxf(val, __shfl_xor_sync(0xffffffff, val, offset));
+  }
+  return val;
+}
+
+__device__ __forceinline__ float WarpReduceSum(float val) {
+  for (int offset = WARP_SIZE / 2; offset > 0; offset /= 2) {
+    val += __shfl_xor_sync(0xffffffff, val, offset);
+  }
+  return val;
+}
+
+/*!
+ * \brief Load rows [start, start + TILE_SIZE) of a [n, dim] matrix to shared memory. The row
+ * stride is padded to dim + 1 to avoid bank conflicts when each lane reads its own row, and
+ * the rows out of range are filled with zeros.
+ */
+template <typename scalar_t>
+__device__ __forceinline__ void LoadTile(float* tile, const scalar_t* src, int start, int n,
+                                         int dim) {
+  for (int idx = threadIdx.x; idx < TILE_SIZE * dim; idx += blockDim.x) {
+    int row = idx / dim, col = idx % dim;
+    tile[row * (dim + 1) + col] =
+        start + row < n ? static_cast<float>(src[static_cast<int64_t>(start + row) * dim + col])
+                        : 0.f;
+  }
+}
+
+/*! \brief Load a row of a [n, dim] matrix to shared memory by a warp. */
+template <typename scalar_t>
+__device__ __forceinline__ void LoadRow(float* dst, const scalar_t* src, int row, int n, int dim) {
+  for (int col = threadIdx.x % WARP_SIZE; col < dim; col += WARP_SIZE) {
+    dst[col] = row < n ? static_cast<float>(src[static_cast<int64_t>(row) * dim + col]) : 0.f;
+  }
+}
+
+__device__ __forceinline__ float Dot(const float* a, const float* b, int dim) {
+  float ret = 0.f;
+  for (int i = 0; i < dim; ++i) {
+    ret += a[i] * b[i];
+  }
+  return ret;
+}
+
+/*! \brief acc[i] += sum_j coef_j * tile[j][lane + i * WARP_SIZE], where lane j holds coef_j. */
+template <int CHUNKS>
+__device__ __forceinline__ void AccumulateTile(float* acc, float coef, const float* tile,
+                                               int dim) {
+  const int lane = threadIdx.x % WARP_SIZE;
+  for (int j = 0; j < TILE_SIZE; ++j) {
+    float coef_j = __shfl_sync(0xffffffff, coef, j);
+    const float* row = tile + j * (dim + 1);
+#pragma unroll
+    for (int i = 0; i < CHUNKS; ++i) {
+      int col = lane + i * WARP_SIZE;
+      if (col < dim) {
+        acc[i] += coef_j * row[col];
+      }
+    }
+  }
+}
+
+template <typename scalar_t, int CHUNKS>
+__device__ __forceinline__ void StoreRow(scalar_t* dst, const float* acc, float factor, int row,
+                                         int n, int dim) {
+  const int lane = threadIdx.x % WARP_SIZE;
+  if (row >= n) {
+    return;
+  }
+#pragma unroll
+  for (int i = 0; i < CHUNKS; ++i) {
+    int col = lane + i * WARP_SIZE;
+    if (col < dim) {
+      dst[static_cast<int64_t>(row) * dim + col] = static_cast<scalar_t>(acc[i] * factor);
+    }
+  }
+}
+
+/*! \brief The forward kernel with the online softmax. The grid is (seq_q / NUM_WARPS, batch). */
+template <typename scalar_t, int CHUNKS>
+__global__ void AttentionForwardKernel(scalar_t* __restrict__ out, const scalar_t* __restrict__ q,
+                                       const scalar_t* __restrict__ k,
+                                       const scalar_t* __restrict__ v, int seq_q, int seq_k,
+                                       int dim, int vdim, float scale, bool causal,
+                                       const int64_t* __restrict__ valid_len) {
+  extern __shared__ float smem[];
+  float* k_tile = smem;                              // [TILE_SIZE, dim + 1]
+  float* v_tile = k_tile + TILE_SIZE * (dim + 1);    // [TILE_SIZE, vdim + 1]
+  float* q_rows = v_tile + TILE_SIZE * (vdim + 1);   // [NUM_WARPS, dim]
+  const int warp = threadIdx.x / WARP_SIZE, lane = threadIdx.x % WARP_SIZE;
+  const int row_start = blockIdx.x * NUM_WARPS;
+  const int row = row_start + warp;
+  const int64_t batch = blockIdx.y;
+  q += batch * seq_q * dim;
+  k += batch * seq_k * dim;
+  v += batch * seq_k * vdim;
+  out += batch * seq_q * vdim;
+
+  float* q_row = q_rows + warp * dim;
+  LoadRow(q_row, q, row, seq_q, dim);
+  float row_max = -INFINITY, row_sum = 0.f;
+  float acc[CHUNKS] = {0.f};
+  // Only the keys in the valid prefix are attended, so the cost follows the valid length instead
+  // of the capacity of a cache. At least the first key is attended.
+  const int len =
+      valid_len ? static_cast<int>(max(int64_t(1), min(int64_t(seq_k), *valid_len))) : seq_k;
+  // With the causal mask, the keys after the last query of this block are never attended.
+  const int num_keys = causal ? min(len, row_start + NUM_WARPS) : len;
+  for (int start = 0; start < num_keys; start += TILE_SIZE) {
+    // Make sure the previous tiles have been consumed before overwriting them.
+    __syncthreads();
+    LoadTile(k_tile, k, start, len, dim);
+    LoadTile(v_tile, v, start, len, vdim);
+    __syncthreads();
+    const int key = start + lane;
+    float score = -INFINITY;
+    if (key < len && (!causal || key <= row)) {
+      score = Dot(q_row, k_tile + lane * (dim + 1), dim) * scale;
+    }
+    // The first key is never masked, so new_max is always finite.
+    float new_max = fmaxf(row_max, WarpReduceMax(score));
+    float p = __expf(score - new_max);
+    float correction = __expf(row_max - new_max);
+    row_sum = row_sum * correction + WarpReduceSum(p);
+#pragma unroll
+    for (int i = 0; i < CHUNKS; ++i) {
+      acc[i] *= correction;
+    }
+    AccumulateTile<CHUNKS>(acc, p, v_tile, vdim);
+    row_max = new_max;
+  }
+  StoreRow<scalar_t, CHUNKS>(out, acc, 1.f / row_sum, row, seq_q, vdim);
+}
+
+/*!
+ * \brief The backward kernel of dq, which also computes lse and delta for each query row. The
+ * grid is (seq_q / NUM_WARPS, batch).
+ */
+template <typename scalar_t, int CHUNKS>
+__global__ void AttentionBackwardDqKernel(scalar_t* __restrict__ dq, float* __restrict__ lse,
+                                          float* __restrict__ delta,
+                                          const scalar_t* __restrict__ q,
+                                          const scalar_t* __restrict__ k,
+                                          const scalar_t* __restrict__ v,
+                                          const scalar_t* __restrict__ out,
+                                          const scalar_t* __restrict__ dy, int seq_q, int seq_k,
+                                          int dim, int vdim, float scale, bool causal) {
+  extern __shared__ float smem[];
+  float* k_tile = smem;                               // [TILE_SIZE, dim + 1]
+  float* v_tile = k_tile + TILE_SIZE * (dim + 1);     // [TILE_SIZE, vdim + 1]
+  float* q_rows = v_tile + TILE_SIZE * (vdim + 1);    // [NUM_WARPS, dim]
+  float* dy_rows = q_rows + NUM_WARPS * dim;          // [NUM_WARPS, vdim]
+  const int warp = threadIdx.x / WARP_SIZE, lane = threadIdx.x % WARP_SIZE;
+  const int row_start = blockIdx.x * NUM_WARPS;
+  const int row = row_start + warp;
+  const int64_t batch = blockIdx.y;
+  q += batch * seq_q * dim;
+  k += batch * seq_k * dim;
+  v += batch * seq_k * vdim;
+  out += batch * seq_q * vdim;
+  dy += batch * seq_q * vdim;
+  dq += batch * seq_q * dim;
+  lse += batch * seq_q;
+  delta += batch * seq_q;
+
+  float* q_row = q_rows + warp * dim;
+  float* dy_row = dy_rows + warp * vdim;
+  LoadRow(q_row, q, row, seq_q, dim);
+  LoadRow(dy_row, dy, row, seq_q, vdim);
+  // delta = sum(dy * out), which equals to sum(dp * p) of the row.
+  float row_delta = 0.f;
+  for (int col = lane; col < vdim; col += WARP_SIZE) {
+    if (row < seq_q) {
+      row_delta += dy_row[col] * static_cast<float>(out[static_cast<int64_t>(row) * vdim + col]);
+    }
+  }
+  row_delta = WarpReduceSum(row_delta);
+
+  // The first pass recomputes the log-sum-exp of the scores.
+  const int num_keys = causal ? min(seq_k, row_start + NUM_WARPS) : seq_k;
+  float row_max = -INFINITY, row_sum = 0.f;
+  for (int start = 0; start < num_keys; start += TILE_SIZE) {
+    __syncthreads();
+    LoadTile(k_tile, k, start, seq_k, dim);
+    __syncthreads();
+    const int key = start + lane;
+    float score = -INFINITY;
+    if (key < seq_k && (!causal || key <= row)) {
+      score = Dot(q_row, k_tile + lane * (dim + 1), dim) * scale;
+    }
+    float new_max = fmaxf(row_max, WarpReduceMax(score));
+    row_sum = row_sum * __expf(row_max - new_max) + WarpReduceSum(__expf(score - new_max));
+    row_max = new_max;
+  }
+  const float row_lse = row_max + __logf(row_sum);
+
+  // The second pass computes dq = scale * sum_j p_j * (dp_j - delta) * k_j.
+  float acc[CHUNKS] = {0.f};
+  for (int start = 0; start < num_keys; start += TILE_SIZE) {
+    __syncthreads();
+    LoadTile(k_tile, k, start, seq_k, dim);
+    LoadTile(v_tile, v, start, seq_k, vdim);
+    __syncthreads();
+    const int key = start + lane;
+    float ds = 0.f;
+    if (key < seq_k && (!causal || key <= row)) {
+      float p = __expf(Dot(q_row, k_tile + lane * (dim + 1), dim) * scale - row_lse);
+      float dp = Dot(dy_row, v_tile + lane * (vdim + 1), vdim);
+      ds = p * (dp - row_delta);
+    }
+    AccumulateTile<CHUNKS>(acc, ds, k_tile, dim);
+  }
+  StoreRow<scalar_t, CHUNKS>(dq, acc, scale, row, seq_q, dim);
+  if (lane == 0 && row < seq_q) {
+    lse[row] = row_lse;
+    delta[row] = row_delta;
+  }
+}
+
+/*!
+ * \brief The backward kernel of dk and dv, which reads lse and delta computed by the dq kernel.
+ * The grid is (seq_k / NUM_WARPS, batch).
+ */
+template <typename scalar_t, int CHUNKS>
+__global__ void AttentionBackwardDkvKernel(scalar_t* __restrict__ dk, scalar_t* __restrict__ dv,
+                                           const float* __restrict__ lse,
+                                           const float* __restrict__ delta,
+                                           const scalar_t* __restrict__ q,
+                                           const scalar_t* __restrict__ k,
+                                           const scalar_t* __restrict__ v,
+                                           const scalar_t* __restrict__ dy, int seq_q, int seq_k,
+                                           int dim, int vdim, float scale, bool causal) {
+  extern __shared__ float smem[];
+  float* q_tile = smem;                               // [TILE_SIZE, dim + 1]
+  float* dy_tile = q_tile + TILE_SIZE * (dim + 1);    // [TILE_SIZE, vdim + 1]
+  float* k_rows = dy_tile + TILE_SIZE * (vdim + 1);   // [NUM_WARPS, dim]
+  float* v_rows = k_rows + NUM_WARPS * dim;           // [NUM_WARPS, vdim]
+  const int warp = threadIdx.x / WARP_SIZE, lane = threadIdx.x % WARP_SIZE;
+  const int col_start = blockIdx.x * NUM_WARPS;
+  const int col = col_start + warp;
+  const int64_t batch = blockIdx.y;
+  q += batch * seq_q * dim;
+  k += batch * seq_k * dim;
+  v += batch * seq_k * vdim;
+  dy += batch * seq_q * vdim;
+  dk += batch * seq_k * dim;
+  dv += batch * seq_k * vdim;
+  lse += batch * seq_q;
+  delta += batch * seq_q;
+
+  float* k_row = k_rows + warp * dim;
+  float* v_row = v_rows + warp * vdim;
+  LoadRow(k_row, k, col, seq_k, dim);
+  LoadRow(v_row, v, col, seq_k, vdim);
+  float dk_acc[CHUNKS] = {0.f}, dv_acc[CHUNKS] = {0.f};
+  // With the causal mask, the queries before the first key of this block never attend to it.
+  const int first_query = causal ? col_start : 0;
+  for (int start = first_query; start < seq_q; start += TILE_SIZE) {
+    __syncthreads();
+    LoadTile(q_tile, q, start, seq_q, dim);
+    LoadTile(dy_tile, dy, start, seq_q, vdim);
+    __syncthreads();
+    const int query = start + lane;
+    float p = 0.f, ds = 0.f;
+    if (query < seq_q && col < seq_k && (!causal || col <= query)) {
+      p = __expf(Dot(q_tile + lane * (dim + 1), k_row, dim) * scale - lse[query]);
+      float dp = Dot(dy_tile + lane * (vdim + 1), v_row, vdim);
+      ds = p * (dp - delta[query]);
+    }
+    AccumulateTile<CHUNKS>(dv_acc, p, dy_tile, vdim);
+    AccumulateTile<CHUNKS>(dk_acc, ds, q_tile, dim);
+  }
+  StoreRow<scalar_t, CHUNKS>(dk, dk_acc, scale, col, seq_k, dim);
+  StoreRow<scalar_t, CHUNKS>(dv, dv_acc, 1.f, col, seq_k, vdim);
+}
+
+/*! \brief Dispatch the number of accumulator chunks per lane by the head dimensions. */
+#define DISPATCH_CHUNKS(MAX_DIM, ...)                                                            \
+  [&] {                                                                                          \
+    CHECK_LE(MAX_DIM, kAttentionMaxHeadDim) << "Unsupported head dimension " << MAX_DIM;         \
+    if (MAX_DIM <= WARP_SIZE) {                                                                  \
+      constexpr int CHUNKS = 1;                                                                  \
+      __VA_ARGS__();                                                                             \
+    } else if (MAX_DIM <= 2 * WARP_SIZE) {                                                       \
+      constexpr int CHUNKS = 2;                                                                  \
+      __VA_ARGS__();                                                                             \
+    } else {                                                                                     \
+      constexpr int CHUNKS = 4;                                                                  \
+      __VA_ARGS__();                                                                             \
+    }                                                                                            \
+  }()
+
+template <typename T>
+void HostAttentionForward(T* out, const T* q, const T* k, const T* v, int batch, int seq_q,
+                          int seq_k, int dim, int vdim, float scale, bool causal,
+                          const int64_t* valid_len, void* stream) {
+  const dim3 threads(NUM_WARPS * WARP_SIZE);
+  const dim3 blocks(CeilDiv(seq_q, NUM_WARPS), batch);
+  const int nshared =
+      (TILE_SIZE * (dim + 1) + TILE_SIZE * (vdim + 1) + NUM_WARPS * dim) * sizeof(float);
+  DISPATCH_CHUNKS(std::max(dim, vdim), [&] {
+    AttentionForwardKernel<T, CHUNKS>
+        <<<blocks, threads, nshared, static_cast<cudaStream_t>(stream)>>>(
+            out, q, k, v, seq_q, seq_k, dim, vdim, scale, causal, valid_len);
+  });
+  CUDA_CALL(cudaGetLastError());
+}
+
+template <typename T>
+void HostAttentionBackward(T* dq, T* dk, T* dv, float* lse, float* delta, const T* q, const T* k,
+                           const T* v, const T* out, const T* dy, int batch, int seq_q, int seq_k,
+                           int dim, int vdim, float scale, bool causal, void* stream) {
+  const dim3 threads(NUM_WARPS * WARP_SIZE);
+  const int nshared = (TILE_SIZE * (dim + 1) + TILE_SIZE * (vdim + 1) + NUM_WARPS * (dim + vdim)) *
+                      sizeof(float);
+  cudaStream_t cu_stream = static_cast<cudaStream_t>(stream);
+  DISPATCH_CHUNKS(std::max(dim, vdim), [&] {
+    AttentionBackwardDqKernel<T, CHUNKS>
+        <<<dim3(CeilDiv(seq_q, NUM_WARPS), batch), threads, nshared, cu_stream>>>(
+            dq, lse, delta, q, k, v, out, dy, seq_q, seq_k, dim, vdim, scale, causal);
+    AttentionBackwardDkvKernel<T, CHUNKS>
+        <<<dim3(CeilDiv(seq_k, NUM_WARPS), batch), threads, nshared, cu_stream>>>(
+            dk, dv, lse, delta, q, k, v, dy, seq_q, seq_k, dim, vdim, scale, causal);
+  });
+  CUDA_CALL(cudaGetLastError());
+}
+
+/*!
+ * \brief Write x in [batch, seq, dim] to the rows [offset, offset + seq) of the cache in
+ * [batch, max_seq, dim]. The rows beyond the cache are dropped.
+ */
+template <typename scalar_t>
+__global__ void KvCacheAppendKernel(scalar_t* __restrict__ cache, const scalar_t* __restrict__ x,
+                                    const int64_t* __restrict__ offset, int64_t n, int max_seq,
+                                    int seq, int dim) {
+  const int64_t start = *offset;
+  for (int64_t idx = blockIdx.x * static_cast<int64_t>(blockDim.x) + threadIdx.x; idx < n;
+       idx += static_cast<int64_t>(gridDim.x) * blockDim.x) {
+    const int64_t col = idx % dim, row = idx / dim % seq, batch = idx / dim / seq;
+    const int64_t pos = start + row;
+    if (pos >= 0 && pos < max_seq) {
+      cache[(batch * max_seq + pos) * dim + col] = x[idx];
+    }
+  }
+}
+
+template <typename T>
+void HostKvCacheAppend(T* cache, const T* x, const int64_t* offset, int batch, int max_seq,
+                       int seq, int dim, void* stream) {
+  const int64_t n = static_cast<int64_t>(batch) * seq * dim;
+  if (n == 0) {
+    return;
+  }
+  const int threads = 256;
+  const int blocks = static_cast<int>(std::min<int64_t>(CeilDiv(n, threads), 65535));
+  KvCacheAppendKernel<T><<<blocks, threads, 0, static_cast<cudaStream_t>(stream)>>>(
+      cache, x, offset, n, max_seq, seq, dim);
+  CUDA_CALL(cudaGetLastError());
+}
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,46 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/batch_norm.cuh
+ * \brief Headers of the fused batch_norm + add + relu training CUDA kernels
+ */
+#pragma once
+#include <cuda_fp16.h>
+#include <stdint.h>
+#include "./Half.h"
+#include "../../../../common/cuda_utils.h"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+/*! \brief The workspace bytes of the fused batch norm kernels of x in [n, c, hw]. */
+int64_t batch_norm_add_relu_workspace_bytes(int n, int c, int hw);
+
+/*!
+ * \brief y = relu(batch_norm(x) + z) of x in [n, c, hw] over the channel axis c, where z is
+ * optional. The running statistics are updated in place. Instead of the activation, the backward
+ * keeps the mask of (numel + 31) / 32 words, whose bit k of the word j is set if the element
+ * 32 * j + k of y is positive. The statistics and the affine parameters are float32.
+ */
+template <typename T>
+void HostBatchNormAddReluForward(const T* x, const T* z, const float* w, const float* b,
+                                 float* running_mean, float* running_var, T* y, int32_t* mask,
+                                 int n, int c, int hw, double momentum, double eps,
+                                 void* workspace, void* stream);
+
+/*!
+ * \brief The gradients of HostBatchNormAddReluForward, where dz = dy * mask is the gradient of the
+ * residual, and the statistics of x are recomputed in the same pass as the reduction of dz.
+ */
+template <typename T>
+void HostBatchNormAddReluBackward(const T* dy, const T* x, const int32_t* mask, const float* w,
+                                  T* dx, float* dw, float* db, T* dz, int n, int c, int hw,
+                                  double eps, void* workspace, void* stream);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
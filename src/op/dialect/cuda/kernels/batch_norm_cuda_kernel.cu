@@ -0,0 +1,312 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/batch_norm_cuda_kernel.cu
+ * \brief Fused batch_norm + add + relu training cuda kernels
+ */
+#include <algorithm>
+#include "./batch_norm.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+using namespace c10;
+
+namespace {
+
+constexpr int kWarpSize = 32;
+constexpr int kThreads = 256;
+constexpr int kElemsPerThread = 16;
+constexpr int kMaxSplits = 64;
+constexpr int kMaxBlocks = 4096;
+
+/*! \brief The running statistics of Welford's algorithm. */
+struct Welford {
+  float mean;
+  float m2;
+  int count;
+};
+
+/*! \brief The partial statistics of x and the partial sums of the masked dy of a split. */
+struct GradPartial {
+  Welford x;
+  float sum_dy;
+  float sum_dy_x;
+};
+
+__device__ __forceinline__ void WelfordUpdate(Welford* w, float v) {
+  w->count += 1;
+  float delta = v - w->mean;
+  w->mean += delta / w->count;
+  w->m2 += delta * (v - w->mean);
+}
+
+/*! \brief Merge the statistics of two disjoint sets, by Chan et al. */
+__device__ __forceinline__ Welford WelfordCombine(const Welford& a, const Welford& b) {
+  int count = a.count + b.count;
+  if (count == 0) {
+    return a;
+  }
+  float delta = b.mean - a.mean;
+  float ratio = static_cast<float>(b.count) / count;
+  return {a.mean + delta * ratio, a.m2 + b.m2 + delta * delta * a.count * ratio, count};
+}
+
+__device__ __forceinline__ GradPartial Combine(const GradPartial& a, const GradPartial& b) {
+  return {WelfordCombine(a.x, b.x), a.sum_dy + b.sum_dy, a.sum_dy_x + b.sum_dy_x};
+}
+
+__device__ __forceinline__ GradPartial ShflDown(const GradPartial& p, int offset) {
+  GradPartial other;
+  other.x.mean = __shfl_down_sync(0xffffffff, p.x.mean, offset);
+  other.x.m2 = __shfl_down_sync(0xffffffff, p.x.m2, offset);
+  other.x.count = __shfl_down_sync(0xffffffff, p.x.count, offset);
+  other.sum_dy = __shfl_down_sync(0xffffffff, p.sum_dy, offset);
+  other.sum_dy_x = __shfl_down_sync(0xffffffff, p.sum_dy_x, offset);
+  return other;
+}
+
+/*! \brief Reduce the partials of a block of kThreads threads, whose result is in the thread 0. */
+__device__ __forceinline__ GradPartial BlockReduce(GradPartial p) {
+  __shared__ GradPartial partial[kThreads / kWarpSize];
+  for (int offset = kWarpSize / 2; offset > 0; offset /= 2) {
+    p = Combine(p, ShflDown(p, offset));
+  }
+  int warp = threadIdx.x / kWarpSize;
+  int lane = threadIdx.x % kWarpSize;
+  if (lane == 0) {
+    partial[warp] = p;
+  }
+  __syncthreads();
+  if (warp == 0) {
+    p = lane < kThreads / kWarpSize ? partial[lane] : GradPartial{{0.f, 0.f, 0}, 0.f, 0.f};
+    for (int offset = kWarpSize / 2; offset > 0; offset /= 2) {
+      p = Combine(p, ShflDown(p, offset));
+    }
+  }
+  return p;
+}
+
+/*! \brief The number of blocks that split the n * hw elements of each channel. */
+inline int NumSplits(int n, int hw) {
+  int64_t per_channel = static_cast<int64_t>(n) * hw;
+  int64_t splits = (per_channel + kThreads * kElemsPerThread - 1) / (kThreads * kElemsPerThread);
+  return static_cast<int>(std::max<int64_t>(1, std::min<int64_t>(splits, kMaxSplits)));
+}
+
+__device__ __forceinline__ bool MaskBit(const int32_t* mask, int64_t i) {
+  return (static_cast<uint32_t>(mask[i / kWarpSize]) >> (i % kWarpSize)) & 1U;
+}
+
+/*!
+ * \brief The block (ch, split) reduces the split of the channel ch. The statistics of x are
+ * always reduced, and the sums of the masked dy are reduced when dy is given.
+ */
+template <typename T>
+__global__ void PartialStatsKernel(const T* x, const T* dy, const int32_t* mask,
+                                   GradPartial* partials, int n, int c, int hw) {
+  int ch = blockIdx.x;
+  int64_t per_channel = static_cast<int64_t>(n) * hw;
+  int64_t chunk = (per_channel + gridDim.y - 1) / gridDim.y;
+  int64_t begin = blockIdx.y * chunk;
+  int64_t end = min(per_channel, begin + chunk);
+  GradPartial p{{0.f, 0.f, 0}, 0.f, 0.f};
+  for (int64_t i = begin + threadIdx.x; i < end; i += blockDim.x) {
+    int64_t ni = i / hw;
+    int64_t index = (ni * c + ch) * hw + (i - ni * hw);
+    float v = static_cast<float>(x[index]);
+    WelfordUpdate(&p.x, v);
+    if (dy != nullptr && MaskBit(mask, index)) {
+      float g = static_cast<float>(dy[index]);
+      p.sum_dy += g;
+      p.sum_dy_x += g * v;
+    }
+  }
+  p = BlockReduce(p);
+  if (threadIdx.x == 0) {
+    partials[ch * gridDim.y + blockIdx.y] = p;
+  }
+}
+
+__device__ __forceinline__ GradPartial CombineSplits(const GradPartial* partials, int ch,
+                                                    int splits) {
+  GradPartial p = partials[ch * splits];
+  for (int s = 1; s < splits; ++s) {
+    p = Combine(p, partials[ch * splits + s]);
+  }
+  return p;
+}
+
+/*!
+ * \brief Update the running statistics, and fold the normalization and the affine transform into
+ * y = x * scale + shift per channel.
+ */
+__global__ void ForwardFinalizeKernel(const GradPartial* partials, const float* w, const float* b,
+                                      float* running_mean, float* running_var, float* scale,
+                                      float* shift, int c, int splits, float momentum, float eps) {
+  int ch = blockIdx.x * blockDim.x + threadIdx.x;
+  if (ch >= c) {
+    return;
+  }
+  Welford stats = CombineSplits(partials, ch, splits).x;
+  float var = stats.m2 / stats.count;
+  float unbiased = stats.count > 1 ? stats.m2 / (stats.count - 1) : var;
+  running_mean[ch] = running_mean[ch] * (1.f - momentum) + stats.mean * momentum;
+  running_var[ch] = running_var[ch] * (1.f - momentum) + unbiased * momentum;
+  float k = w[ch] * rsqrtf(var + eps);
+  scale[ch] = k;
+  shift[ch] = b[ch] - stats.mean * k;
+}
+
+/*!
+ * \brief Each warp handles 32 adjacent elements in an iteration, whose positive flags are packed
+ * into one word of the mask by a ballot. The block size must be a multiple of the warp size.
+ */
+template <typename T>
+__global__ void ForwardApplyKernel(const T* x, const T* z, const float* scale, const float* shift,
+                                   T* y, int32_t* mask, int64_t size, int c, int hw) {
+  int lane = threadIdx.x % kWarpSize;
+  int64_t stride = static_cast<int64_t>(gridDim.x) * blockDim.x;
+  for (int64_t base = static_cast<int64_t>(blockIdx.x) * blockDim.x + threadIdx.x - lane;
+       base < size; base += stride) {
+    int64_t i = base + lane;
+    bool positive = false;
+    if (i < size) {
+      int ch = (i / hw) % c;
+      float v = static_cast<float>(x[i]) * scale[ch] + shift[ch];
+      if (z != nullptr) {
+        v += static_cast<float>(z[i]);
+      }
+      v = fmaxf(v, 0.f);
+      y[i] = static_cast<T>(v);
+      positive = v > 0.f;
+    }
+    uint32_t bits = __ballot_sync(0xffffffff, positive);
+    if (lane == 0) {
+      mask[base / kWarpSize] = static_cast<int32_t>(bits);
+    }
+  }
+}
+
+/*!
+ * \brief Compute dw and db, and fold the input gradient into
+ * dx = scale * (dy - shift - (x - mean) * coef) per channel.
+ */
+__global__ void BackwardFinalizeKernel(const GradPartial* partials, const float* w, float* dw,
+                                       float* db, float* mean, float* scale, float* shift,
+                                       float* coef, int c, int splits, float eps) {
+  int ch = blockIdx.x * blockDim.x + threadIdx.x;
+  if (ch >= c) {
+    return;
+  }
+  GradPartial p = CombineSplits(partials, ch, splits);
+  float count = static_cast<float>(p.x.count);
+  float invstd = rsqrtf(p.x.m2 / count + eps);
+  float grad_w = (p.sum_dy_x - p.x.mean * p.sum_dy) * invstd;
+  dw[ch] = grad_w;
+  db[ch] = p.sum_dy;
+  mean[ch] = p.x.mean;
+  scale[ch] = w[ch] * invstd;
+  shift[ch] = p.sum_dy / count;
+  coef[ch] = grad_w * invstd / count;
+}
+
+template <typename T>
+__global__ void BackwardApplyKernel(const T* dy, const T* x, const int32_t* mask,
+                                    const float* mean, const float* scale, const float* shift,
+                                    const float* coef, T* dx, T* dz, int64_t size, int c, int hw) {
+  int64_t stride = static_cast<int64_t>(gridDim.x) * blockDim.x;
+  for (int64_t i = static_cast<int64_t>(blockIdx.x) * blockDim.x + threadIdx.x; i < size;
+       i += stride) {
+    int ch = (i / hw) % c;
+    float g = MaskBit(mask, i) ? static_cast<float>(dy[i]) : 0.f;
+    float v = static_cast<float>(x[i]);
+    dz[i] = static_cast<T>(g);
+    dx[i] = static_cast<T>(scale[ch] * (g - shift[ch] - (v - mean[ch]) * coef[ch]));
+  }
+}
+
+inline int NumApplyBlocks(int64_t size) {
+  return static_cast<int>(std::min<int64_t>((size + kThreads - 1) / kThreads, kMaxBlocks));
+}
+
+inline int NumChannelBlocks(int c) {
+  return (c + kThreads - 1) / kThreads;
+}
+
+}  // namespace
+
+int64_t batch_norm_add_relu_workspace_bytes(int n, int c, int hw) {
+  return static_cast<int64_t>(c) * NumSplits(n, hw) * sizeof(GradPartial) +
+         4LL * c * sizeof(float);
+}
+
+template <typename T>
+void HostBatchNormAddReluForward(const T* x, const T* z, const float* w, const float* b,
+                                 float* running_mean, float* running_var, T* y, int32_t* mask,
+                                 int n, int c, int hw, double momentum, double eps,
+                                 void* workspace, void* stream) {
+  cudaStream_t cu_stream = static_cast<cudaStream_t>(stream);
+  int splits = NumSplits(n, hw);
+  GradPartial* partials = static_cast<GradPartial*>(workspace);
+  float* scale = reinterpret_cast<float*>(partials + static_cast<int64_t>(c) * splits);
+  float* shift = scale + c;
+  int64_t size = static_cast<int64_t>(n) * c * hw;
+  PartialStatsKernel<T><<<dim3(c, splits), kThreads, 0, cu_stream>>>(x, nullptr, nullptr,
+                                                                     partials, n, c, hw);
+  ForwardFinalizeKernel<<<NumChannelBlocks(c), kThreads, 0, cu_stream>>>(
+      partials, w, b, running_mean, running_var, scale, shift, c, splits,
+      static_cast<float>(momentum), static_cast<float>(eps));
+  ForwardApplyKernel<T><<<NumApplyBlocks(size), kThreads, 0, cu_stream>>>(x, z, scale, shift, y,
+                                                                          mask, size, c, hw);
+  CUDA_CALL(cudaGetLastError());
+}
+
+template <typename T>
+void HostBatchNormAddReluBackward(const T* dy, const T* x, const int32_t* mask, const float* w,
+                                  T* dx, float* dw, float* db, T* dz, int n, int c, int hw,
+                                  double eps, void* workspace, void* stream) {
+  cudaStream_t cu_stream = static_cast<cudaStream_t>(stream);
+  int splits = NumSplits(n, hw);
+  GradPartial* partials = static_cast<GradPartial*>(workspace);
+  float* mean = reinterpret_cast<float*>(partials + static_cast<int64_t>(c) * splits);
+  float* scale = mean + c;
+  float* shift = scale + c;
+  float* coef = shift + c;
+  int64_t size = static_cast<int64_t>(n) * c * hw;
+  PartialStatsKernel<T><<<dim3(c, splits), kThreads, 0, cu_stream>>>(x, dy, mask, partials, n, c,
+                                                                     hw);
+  BackwardFinalizeKernel<<<NumChannelBlocks(c), kThreads, 0, cu_stream>>>(
+      partials, w, dw, db, mean, scale, shift, coef, c, splits, static_cast<float>(eps));
+  BackwardApplyKernel<T><<<NumApplyBlocks(size), kThreads, 0, cu_stream>>>(
+      dy, x, mask, mean, scale, shift, coef, dx, dz, size, c, hw);
+  CUDA_CALL(cudaGetLastError());
+}
+
+template void HostBatchNormAddReluForward<Half>(const Half* x, const Half* z, const float* w,
+                                                const float* b, float* running_mean,
+                                                float* running_var, Half* y, int32_t* mask, int n,
+                                                int c, int hw, double momentum, double eps,
+                                                void* workspace, void* stream);
+template void HostBatchNormAddReluForward<float>(const float* x, const float* z, const float* w,
+                                                 const float* b, float* running_mean,
+                                                 float* running_var, float* y, int32_t* mask,
+                                                 int n, int c, int hw, double momentum, double eps,
+                                                 void* workspace, void* stream);
+template void HostBatchNormAddReluBackward<Half>(const Half* dy, const Half* x,
+                                                 const int32_t* mask, const float* w, Half* dx,
+                                                 float* dw, float* db, Half* dz, int n, int c,
+                                                 int hw, double eps, void* workspace,
+                                                 void* stream);
+template void HostBatchNormAddReluBackward<float>(const float* dy, const float* x,
+                                                  const int32_t* mask, const float* w, float* dx,
+                                                  float* dw, float* db, float* dz, int n, int c,
+                                                  int hw, double eps, void* workspace,
+                                                  void* stream);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
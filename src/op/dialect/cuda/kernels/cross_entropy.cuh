@@ -0,0 +1,40 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/cross_entropy.cuh
+ * \brief Headers of CUDA fused softmax cross-entropy kernels
+ */
+#pragma once
+#include <cuda_fp16.h>
+#include <stdint.h>
+#include "./Half.h"
+#include "../../../../common/cuda_utils.h"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+/*!
+ * \brief loss = mean_i(logsumexp(x[i, :]) - x[i, target[i]]), where x is in [n, c] and target
+ * is int32 or int64 in [n]. Each row is reduced in a single pass with an online softmax, so the
+ * probabilities are never materialized. row_loss is a workspace of n floats.
+ */
+template <typename T>
+void HostCrossEntropyForward(T* loss, float* row_loss, const T* x, const void* target,
+                             bool target_int64, int n, int c, void* stream);
+
+/*!
+ * \brief dx = dy / n * (softmax(x) - one_hot(target)), where dy holds the scalar gradient of the
+ * loss on the device. When from_logits is false, x holds the log-probabilities, i.e. the output
+ * of log_softmax, instead of the logits.
+ */
+template <typename T>
+void HostCrossEntropyBackward(T* dx, const T* dy, const T* x, const void* target,
+                              bool target_int64, int n, int c, bool from_logits, void* stream);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
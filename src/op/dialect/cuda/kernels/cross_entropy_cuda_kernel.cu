@@ -0,0 +1,179 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/cross_entropy_cuda_kernel.cu
+ * \brief Fused softmax cross-entropy forward and backward cuda kernels
+ */
+#include <cfloat>
+#include "./cross_entropy.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+using namespace c10;
+
+namespace {
+
+constexpr int kWarpSize = 32;
+constexpr int kBlockSize = 512;
+
+/*! \brief The running max and the sum of exp(x - max) of an online softmax. */
+struct MaxSum {
+  float max;
+  float sum;
+};
+
+__device__ __forceinline__ MaxSum Combine(MaxSum a, MaxSum b) {
+  if (a.max == -FLT_MAX) {
+    return b;
+  }
+  if (b.max == -FLT_MAX) {
+    return a;
+  }
+  float max = fmaxf(a.max, b.max);
+  return {max, a.sum * __expf(a.max - max) + b.sum * __expf(b.max - max)};
+}
+
+/*! \brief Reduce the pairs of the block, and broadcast the result to all threads. */
+__device__ MaxSum BlockReduce(MaxSum val) {
+  __shared__ MaxSum shared[kBlockSize / kWarpSize];
+  const int lane = threadIdx.x % kWarpSize;
+  const int warp = threadIdx.x / kWarpSize;
+#pragma unroll
+  for (int mask = kWarpSize / 2; mask > 0; mask /= 2) {
+    MaxSum other{__shfl_xor_sync(0xffffffff, val.max, mask),
+                 __shfl_xor_sync(0xffffffff, val.sum, mask)};
+    val = Combine(val, other);
+  }
+  if (lane == 0) {
+    shared[warp] = val;
+  }
+  __syncthreads();
+  if (warp == 0) {
+    val = lane < blockDim.x / kWarpSize ? shared[lane] : MaxSum{-FLT_MAX, 0.0f};
+#pragma unroll
+    for (int mask = kWarpSize / 2; mask > 0; mask /= 2) {
+      MaxSum other{__shfl_xor_sync(0xffffffff, val.max, mask),
+                   __shfl_xor_sync(0xffffffff, val.sum, mask)};
+      val = Combine(val, other);
+    }
+    if (lane == 0) {
+      shared[0] = val;
+    }
+  }
+  __syncthreads();
+  return shared[0];
+}
+
+__device__ __forceinline__ int64_t LoadTarget(const void* target, bool target_int64, int row) {
+  return target_int64 ? static_cast<const int64_t*>(target)[row]
+                      : static_cast<const int32_t*>(target)[row];
+}
+
+/*! \brief The log-sum-exp of a row, which is read once. */
+template <typename T>
+__device__ __forceinline__ float RowLogSumExp(const T* x, int c) {
+  MaxSum val{-FLT_MAX, 0.0f};
+  for (int j = threadIdx.x; j < c; j += blockDim.x) {
+    val = Combine(val, MaxSum{static_cast<float>(x[j]), 1.0f});
+  }
+  val = BlockReduce(val);
+  return val.max + __logf(val.sum);
+}
+
+/*! \brief Each block computes the loss of a row. Out-of-range targets contribute zero. */
+template <typename T>
+__global__ void CrossEntropyForwardKernel(float* row_loss, const T* x, const void* target,
+                                          bool target_int64, int c) {
+  const int row = blockIdx.x;
+  const T* x_row = x + static_cast<int64_t>(row) * c;
+  float lse = RowLogSumExp(x_row, c);
+  if (threadIdx.x == 0) {
+    int64_t t = LoadTarget(target, target_int64, row);
+    row_loss[row] = (t >= 0 && t < c) ? lse - static_cast<float>(x_row[t]) : 0.0f;
+  }
+}
+
+/*! \brief A single block sums the row losses in a fixed order, so the loss is deterministic. */
+template <typename T>
+__global__ void MeanKernel(T* loss, const float* row_loss, int n) {
+  __shared__ float shared[kBlockSize];
+  float sum = 0.0f;
+  for (int i = threadIdx.x; i < n; i += blockDim.x) {
+    sum += row_loss[i];
+  }
+  shared[threadIdx.x] = sum;
+  __syncthreads();
+  for (int s = blockDim.x / 2; s > 0; s /= 2) {
+    if (threadIdx.x < s) {
+      shared[threadIdx.x] += shared[threadIdx.x + s];
+    }
+    __syncthreads();
+  }
+  if (threadIdx.x == 0) {
+    loss[0] = static_cast<T>(shared[0] / n);
+  }
+}
+
+/*!
+ * \brief Each block computes the gradient of a row. The logits are read twice, once for the
+ * log-sum-exp and once for the gradient, and the log-probabilities are read once.
+ */
+template <typename T>
+__global__ void CrossEntropyBackwardKernel(T* dx, const T* dy, const T* x, const void* target,
+                                           bool target_int64, int n, int c, bool from_logits) {
+  const int row = blockIdx.x;
+  const int64_t offset = static_cast<int64_t>(row) * c;
+  const float lse = from_logits ? RowLogSumExp(x + offset, c) : 0.0f;
+  const float scale = static_cast<float>(dy[0]) / n;
+  const int64_t t = LoadTarget(target, target_int64, row);
+  for (int j = threadIdx.x; j < c; j += blockDim.x) {
+    float prob = __expf(static_cast<float>(x[offset + j]) - lse);
+    dx[offset + j] = static_cast<T>(scale * (j == t ? prob - 1.0f : prob));
+  }
+}
+
+}  // namespace
+
+template <typename T>
+void HostCrossEntropyForward(T* loss, float* row_loss, const T* x, const void* target,
+                             bool target_int64, int n, int c, void* stream) {
+  cudaStream_t cu_stream = static_cast<cudaStream_t>(stream);
+  if (n == 0) {
+    CUDA_CALL(cudaMemsetAsync(loss, 0, sizeof(T), cu_stream));
+    return;
+  }
+  CrossEntropyForwardKernel<T><<<n, kBlockSize, 0, cu_stream>>>(row_loss, x, target,
+                                                                target_int64, c);
+  MeanKernel<T><<<1, kBlockSize, 0, cu_stream>>>(loss, row_loss, n);
+}
+
+template <typename T>
+void HostCrossEntropyBackward(T* dx, const T* dy, const T* x, const void* target,
+                              bool target_int64, int n, int c, bool from_logits, void* stream) {
+  if (n == 0) {
+    return;
+  }
+  CrossEntropyBackwardKernel<T><<<n, kBlockSize, 0, static_cast<cudaStream_t>(stream)>>>(
+      dx, dy, x, target, target_int64, n, c, from_logits);
+}
+
+template void HostCrossEntropyForward<Half>(Half* loss, float* row_loss, const Half* x,
+                                            const void* target, bool target_int64, int n, int c,
+                                            void* stream);
+template void HostCrossEntropyForward<float>(float* loss, float* row_loss, const float* x,
+                                             const void* target, bool target_int64, int n, int c,
+                                             void* stream);
+template void HostCrossEntropyBackward<Half>(Half* dx, const Half* dy, const Half* x,
+                                             const void* target, bool target_int64, int n, int c,
+                                             bool from_logits, void* stream);
+template void HostCrossEntropyBackward<float>(float* dx, const float* dy, const float* x,
+                                              const void* target, bool target_int64, int n,
+                                              int c, bool from_logits, void* stream);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
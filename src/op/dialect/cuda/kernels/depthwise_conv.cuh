@@ -0,0 +1,52 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/depthwise_conv.cuh
+ * \brief Headers of the depthwise conv2d CUDA kernels
+ */
+#pragma once
+#include <cuda_fp16.h>
+#include <stdint.h>
+#include "./Half.h"
+#include "../../../../common/cuda_utils.h"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+/*!
+ * \brief The problem of a depthwise conv2d in NCHW, whose input x is [n, c, h, w], weight is
+ * [c * multiplier, 1, kernel_h, kernel_w], and output is [n, c * multiplier, out_h, out_w].
+ * The output channel oc is computed from the input channel oc / multiplier.
+ */
+struct DepthwiseConvParams {
+  int n, c, h, w;
+  int multiplier;
+  int out_h, out_w;
+  int kernel_h, kernel_w;
+  int stride_h, stride_w;
+  int pad_h, pad_w;
+  int dilation_h, dilation_w;
+};
+
+/*! \brief y = conv2d(x, w), where each thread computes an output element. */
+template <typename T>
+void HostDepthwiseConv2d(const T* x, const T* w, T* y, const DepthwiseConvParams& params,
+                         void* stream);
+
+/*! \brief dx = conv2d_dx(w, dy), where each thread gathers the gradient of an input element. */
+template <typename T>
+void HostDepthwiseConv2dDx(const T* w, const T* dy, T* dx, const DepthwiseConvParams& params,
+                           void* stream);
+
+/*! \brief dw = conv2d_dw(x, dy), where each block reduces the gradient of a weight element. */
+template <typename T>
+void HostDepthwiseConv2dDw(const T* x, const T* dy, T* dw, const DepthwiseConvParams& params,
+                           void* stream);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
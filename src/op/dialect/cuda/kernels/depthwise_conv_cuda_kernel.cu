@@ -0,0 +1,217 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/depthwise_conv_cuda_kernel.cu
+ * \brief Depthwise conv2d cuda kernels
+ */
+#include <algorithm>
+#include "./depthwise_conv.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+using namespace c10;
+
+namespace {
+
+constexpr int kWarpSize = 32;
+constexpr int kThreads = 256;
+constexpr int kMaxBlocks = 65535;
+
+inline int GetNumBlocks(int64_t total) {
+  return static_cast<int>(std::min<int64_t>((total + kThreads - 1) / kThreads, kMaxBlocks));
+}
+
+/*!
+ * \brief The forward kernel. KH and KW are the kernel sizes known at the compile time, so that
+ * the window loops are unrolled, or 0 to read them from the params.
+ */
+template <typename T, int KH, int KW>
+__global__ void DepthwiseConv2dKernel(const T* __restrict__ x, const T* __restrict__ w,
+                                      T* __restrict__ y, DepthwiseConvParams p) {
+  const int kernel_h = KH > 0 ? KH : p.kernel_h;
+  const int kernel_w = KW > 0 ? KW : p.kernel_w;
+  const int out_c = p.c * p.multiplier;
+  int64_t total = static_cast<int64_t>(p.n) * out_c * p.out_h * p.out_w;
+  int64_t stride = static_cast<int64_t>(gridDim.x) * blockDim.x;
+  for (int64_t idx = static_cast<int64_t>(blockIdx.x) * blockDim.x + threadIdx.x; idx < total;
+       idx += stride) {
+    int ow = idx % p.out_w;
+    int oh = (idx / p.out_w) % p.out_h;
+    int64_t noc = idx / (static_cast<int64_t>(p.out_w) * p.out_h);
+    int oc = noc % out_c;
+    int64_t ni = noc / out_c;
+    const T* x_c = x + (ni * p.c + oc / p.multiplier) * p.h * p.w;
+    const T* w_c = w + static_cast<int64_t>(oc) * kernel_h * kernel_w;
+    float acc = 0.f;
+#pragma unroll
+    for (int r = 0; r < kernel_h; ++r) {
+      int ih = oh * p.stride_h - p.pad_h + r * p.dilation_h;
+      if (ih < 0 || ih >= p.h) {
+        continue;
+      }
+#pragma unroll
+      for (int s = 0; s < kernel_w; ++s) {
+        int iw = ow * p.stride_w - p.pad_w + s * p.dilation_w;
+        if (iw >= 0 && iw < p.w) {
+          acc += static_cast<float>(__ldg(&x_c[ih * p.w + iw])) *
+                 static_cast<float>(__ldg(&w_c[r * kernel_w + s]));
+        }
+      }
+    }
+    y[idx] = static_cast<T>(acc);
+  }
+}
+
+/*! \brief The backward data kernel, which gathers dy of the windows covering each input. */
+template <typename T, int KH, int KW>
+__global__ void DepthwiseConv2dDxKernel(const T* __restrict__ w, const T* __restrict__ dy,
+                                        T* __restrict__ dx, DepthwiseConvParams p) {
+  const int kernel_h = KH > 0 ? KH : p.kernel_h;
+  const int kernel_w = KW > 0 ? KW : p.kernel_w;
+  const int out_c = p.c * p.multiplier;
+  int64_t total = static_cast<int64_t>(p.n) * p.c * p.h * p.w;
+  int64_t stride = static_cast<int64_t>(gridDim.x) * blockDim.x;
+  for (int64_t idx = static_cast<int64_t>(blockIdx.x) * blockDim.x + threadIdx.x; idx < total;
+       idx += stride) {
+    int iw = idx % p.w;
+    int ih = (idx / p.w) % p.h;
+    int64_t nic = idx / (static_cast<int64_t>(p.w) * p.h);
+    int ic = nic % p.c;
+    int64_t ni = nic / p.c;
+    float acc = 0.f;
+    for (int j = 0; j < p.multiplier; ++j) {
+      int oc = ic * p.multiplier + j;
+      const T* dy_c = dy + (ni * out_c + oc) * p.out_h * p.out_w;
+      const T* w_c = w + static_cast<int64_t>(oc) * kernel_h * kernel_w;
+#pragma unroll
+      for (int r = 0; r < kernel_h; ++r) {
+        int oh = ih + p.pad_h - r * p.dilation_h;
+        if (oh < 0 || oh % p.stride_h != 0 || oh / p.stride_h >= p.out_h) {
+          continue;
+        }
+        oh /= p.stride_h;
+#pragma unroll
+        for (int s = 0; s < kernel_w; ++s) {
+          int ow = iw + p.pad_w - s * p.dilation_w;
+          if (ow >= 0 && ow % p.stride_w == 0 && ow / p.stride_w < p.out_w) {
+            acc += static_cast<float>(__ldg(&dy_c[oh * p.out_w + ow / p.stride_w])) *
+                   static_cast<float>(__ldg(&w_c[r * kernel_w + s]));
+          }
+        }
+      }
+    }
+    dx[idx] = static_cast<T>(acc);
+  }
+}
+
+/*!
+ * \brief The backward filter kernel, where each block reduces x * dy over the batch and the
+ * output pixels for a weight element (oc, r, s).
+ */
+template <typename T>
+__global__ void DepthwiseConv2dDwKernel(const T* __restrict__ x, const T* __restrict__ dy,
+                                        T* __restrict__ dw, DepthwiseConvParams p) {
+  __shared__ float partial[kThreads / kWarpSize];
+  const int out_c = p.c * p.multiplier;
+  int s = blockIdx.x % p.kernel_w;
+  int r = (blockIdx.x / p.kernel_w) % p.kernel_h;
+  int oc = blockIdx.x / (p.kernel_w * p.kernel_h);
+  int ic = oc / p.multiplier;
+  int out_hw = p.out_h * p.out_w;
+  int64_t total = static_cast<int64_t>(p.n) * out_hw;
+  float acc = 0.f;
+  for (int64_t idx = threadIdx.x; idx < total; idx += blockDim.x) {
+    int ow = idx % p.out_w;
+    int oh = (idx / p.out_w) % p.out_h;
+    int64_t ni = idx / out_hw;
+    int ih = oh * p.stride_h - p.pad_h + r * p.dilation_h;
+    int iw = ow * p.stride_w - p.pad_w + s * p.dilation_w;
+    if (ih >= 0 && ih < p.h && iw >= 0 && iw < p.w) {
+      acc += static_cast<float>(__ldg(&x[((ni * p.c + ic) * p.h + ih) * p.w + iw])) *
+             static_cast<float>(__ldg(&dy[(ni * out_c + oc) * out_hw + oh * p.out_w + ow]));
+    }
+  }
+  for (int offset = kWarpSize / 2; offset > 0; offset /= 2) {
+    acc += __shfl_down_sync(0xffffffff, acc, offset);
+  }
+  int lane = threadIdx.x % kWarpSize;
+  int warp = threadIdx.x / kWarpSize;
+  if (lane == 0) {
+    partial[warp] = acc;
+  }
+  __syncthreads();
+  if (warp == 0) {
+    acc = lane < blockDim.x / kWarpSize ? partial[lane] : 0.f;
+    for (int offset = kWarpSize / 2; offset > 0; offset /= 2) {
+      acc += __shfl_down_sync(0xffffffff, acc, offset);
+    }
+    if (lane == 0) {
+      dw[blockIdx.x] = static_cast<T>(acc);
+    }
+  }
+}
+
+/*! \brief Launch the kernel specialized for 3x3 and 5x5 windows, or the generic one otherwise. */
+#define RAF_DEPTHWISE_DISPATCH_KERNEL(KERNEL, PARAMS, ...)                    \
+  if (PARAMS.kernel_h == 3 && PARAMS.kernel_w == 3) {                         \
+    KERNEL<T, 3, 3><<<blocks, kThreads, 0, cu_stream>>>(__VA_ARGS__, PARAMS); \
+  } else if (PARAMS.kernel_h == 5 && PARAMS.kernel_w == 5) {                  \
+    KERNEL<T, 5, 5><<<blocks, kThreads, 0, cu_stream>>>(__VA_ARGS__, PARAMS); \
+  } else {                                                                    \
+    KERNEL<T, 0, 0><<<blocks, kThreads, 0, cu_stream>>>(__VA_ARGS__, PARAMS); \
+  }
+
+}  // namespace
+
+template <typename T>
+void HostDepthwiseConv2d(const T* x, const T* w, T* y, const DepthwiseConvParams& params,
+                         void* stream) {
+  cudaStream_t cu_stream = static_cast<cudaStream_t>(stream);
+  int64_t total = static_cast<int64_t>(params.n) * params.c * params.multiplier * params.out_h *
+                  params.out_w;
+  int blocks = GetNumBlocks(total);
+  RAF_DEPTHWISE_DISPATCH_KERNEL(DepthwiseConv2dKernel, params, x, w, y);
+  CUDA_CALL(cudaGetLastError());
+}
+
+template <typename T>
+void HostDepthwiseConv2dDx(const T* w, const T* dy, T* dx, const DepthwiseConvParams& params,
+                           void* stream) {
+  cudaStream_t cu_stream = static_cast<cudaStream_t>(stream);
+  int64_t total = static_cast<int64_t>(params.n) * params.c * params.h * params.w;
+  int blocks = GetNumBlocks(total);
+  RAF_DEPTHWISE_DISPATCH_KERNEL(DepthwiseConv2dDxKernel, params, w, dy, dx);
+  CUDA_CALL(cudaGetLastError());
+}
+
+template <typename T>
+void HostDepthwiseConv2dDw(const T* x, const T* dy, T* dw, const DepthwiseConvParams& params,
+                           void* stream) {
+  cudaStream_t cu_stream = static_cast<cudaStream_t>(stream);
+  int blocks = params.c * params.multiplier * params.kernel_h * params.kernel_w;
+  DepthwiseConv2dDwKernel<T><<<blocks, kThreads, 0, cu_stream>>>(x, dy, dw, params);
+  CUDA_CALL(cudaGetLastError());
+}
+
+#undef RAF_DEPTHWISE_DISPATCH_KERNEL
+
+template void HostDepthwiseConv2d<Half>(const Half* x, const Half* w, Half* y,
+                                        const DepthwiseConvParams& params, void* stream);
+template void HostDepthwiseConv2d<float>(const float* x, const float* w, float* y,
+                                         const DepthwiseConvParams& params, void* stream);
+template void HostDepthwiseConv2dDx<Half>(const Half* w, const Half* dy, Half* dx,
+                                          const DepthwiseConvParams& params, void* stream);
+template void HostDepthwiseConv2dDx<float>(const float* w, const float* dy, float* dx,
+                                           const DepthwiseConvParams& params, void* stream);
+template void HostDepthwiseConv2dDw<Half>(const Half* x, const Half* dy, Half* dw,
+                                          const DepthwiseConvParams& params, void* stream);
+template void HostDepthwiseConv2dDw<float>(const float* x, const float* dy, float* dw,
+                                           const DepthwiseConvParams& params, void* stream);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -1,152 +1,203 @@
 /*
  * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
  * SPDX-License-Identifier: Apache-2.0
- * Modifications Copyright (c) Facebook, Inc.
- * See: https://github.com/pytorch/pytorch/blob/master/aten/src/ATen/native/cuda/Embedding.cu
  */
 
 /*!
  * \file src/op/dispatch/cuda/kernels/embedding_dx_cuda.cu
  * \brief embedding backward cuda kernel
+ *
+ * The indices are sorted with their positions, and each run of equal indices is reduced by a
+ * single block in the sorted order. Every output row is written once by plain stores, so the
+ * result is deterministic and no atomics are involved.
  */
 #include <stdio.h>
+#include <algorithm>
+#include <cub/cub.cuh>
 #include "./kernel_util.cuh"
+
 namespace raf {
 namespace op {
 namespace cuda {
 
-template void embedding_dense_backward_cuda<float, float>(const float*, float*, const int64_t*, int,
-                                                          int, int, void*, int64_t);
-template void embedding_dense_backward_cuda<__half, __half>(const __half*, __half*, const int64_t*,
-                                                            int, int, int, void*, int64_t);
-template void embedding_dense_backward_cuda<__half2, __half2>(const __half2*, __half2*,
-                                                              const int64_t*, int, int, int, void*,
-                                                              int64_t);
-
-__device__ __forceinline__ unsigned int WARP_BALLOT(int predicate, unsigned int mask = 0xffffffff) {
-  return __ballot_sync(mask, predicate);
-}
+namespace {
 
-__host__ __device__ __forceinline__ int CeilDiv(int a, int b) {
-  return (a + b - 1) / b;
-}
+constexpr int kMaxThreadsPerSegment = 256;
+constexpr size_t kWorkspaceAlign = 256;
 
-__device__ __forceinline__ float add(float a, float b) {
-  return a + b;
+int EndBit(int range) {
+  int end_bit = 1;
+  while ((1LL << end_bit) < range) {
+    ++end_bit;
+  }
+  return end_bit;
 }
 
-__device__ __forceinline__ __half add(__half a, __half b) {
-  return __hadd(a, b);
+inline size_t AlignUp(size_t bytes) {
+  return (bytes + kWorkspaceAlign - 1) / kWorkspaceAlign * kWorkspaceAlign;
 }
 
-__device__ __forceinline__ __half2 add(__half2 a, __half2 b) {
-  return __hadd2(a, b);
+/*! \brief Fill the positions of the indices, and trap on the indices out of [0, range). */
+__global__ void InitPositionsKernel(const int64_t* indices, int n, int range, int* positions) {
+  int i = blockIdx.x * blockDim.x + threadIdx.x;
+  if (i >= n) {
+    return;
+  }
+  int64_t value = indices[i];
+  if (value < 0 || value >= range) {
+    printf("indices[%d] = %lld is out of range (%d)\n", i, static_cast<long long>(value), range);
+    asm("trap;");
+  }
+  positions[i] = i;
 }
 
-static const int WARP_SIZE = 32;
-static const int BLOCKDIMY = 32;
-
-/*! \brief The kernel to perform embedding backward.
- * \param indices The input IDs.
- * \param grad The gradient from forward output (dy).
- * \param output The computed gradient by this kernel (dx).
- * \param n The size of indices.
- * \param range The maximum allowed value in indices.
- * \param stride The stride. It is usually the size of hidden stauts.
+/*!
+ * \brief Each block reduces the gradients of one run of equal indices. The stable sort keeps
+ * the positions of a run in ascending order, so the sum is accumulated in a fixed order.
+ * When sparse_rows is set, the block writes the row id and the reduced values to the slot of
+ * the run, and the slots beyond the number of runs are padded with -1 and zeros. Otherwise the
+ * reduced values are written to the row of the dense output.
  */
-template <typename scalar_t, typename accscalar_t>
-__global__ void embedding_backward_feature_kernel(const int64_t* indices,
-                                                  const scalar_t* __restrict__ grad,
-                                                  accscalar_t* __restrict__ output, int n,
-                                                  int range, int stride) {
-  extern __shared__ char buf[];
-  accscalar_t* smem = (accscalar_t*)buf;
-  accscalar_t* my_s = smem + WARP_SIZE * threadIdx.y;
-  int* indices_batch = (int*)(buf + sizeof(accscalar_t) * WARP_SIZE * blockDim.y);
-
-  const int f = threadIdx.x + blockIdx.x * blockDim.x;  // feature_dim
-
-  for (int batch_start = 0; batch_start < n; batch_start += blockDim.x * blockDim.y) {
-    // Entire block cooperates to load a batch of 1024 indices to process
-    int tid = threadIdx.x + threadIdx.y * blockDim.x;
-    if (batch_start + tid < n) {
-      int value = (int)indices[batch_start + tid];
-      if (value >= range) {
-        printf("indices[%d] = %d is out of range (%d)\n", batch_start + tid, value, range);
-        asm("trap;");
+template <typename T>
+__global__ void SegmentReduceKernel(const T* __restrict__ grad, SortedIndices buf, int stride,
+                                    T* __restrict__ dense_out, int64_t* __restrict__ sparse_rows,
+                                    T* __restrict__ sparse_values) {
+  const int segment = blockIdx.x;
+  const int num_runs = *buf.num_runs;
+  if (segment >= num_runs) {
+    if (sparse_rows != nullptr) {
+      if (threadIdx.x == 0) {
+        sparse_rows[segment] = -1;
+      }
+      for (int f = threadIdx.x; f < stride; f += blockDim.x) {
+        sparse_values[static_cast<int64_t>(segment) * stride + f] = static_cast<T>(0.0f);
       }
-      indices_batch[tid] = value;
     }
+    return;
+  }
+  const int begin = buf.offsets[segment];
+  const int end = begin + buf.counts[segment];
+  const int64_t row = buf.unique_rows[segment];
+  T* out = sparse_rows != nullptr ? sparse_values + static_cast<int64_t>(segment) * stride
+                                  : dense_out + row * stride;
+  if (sparse_rows != nullptr && threadIdx.x == 0) {
+    sparse_rows[segment] = row;
+  }
+  for (int f = threadIdx.x; f < stride; f += blockDim.x) {
+    float acc = 0.0f;
+    for (int j = begin; j < end; ++j) {
+      acc += static_cast<float>(grad[static_cast<int64_t>(buf.sorted_positions[j]) * stride + f]);
+    }
+    out[f] = static_cast<T>(acc);
+  }
+}
 
-    int batch_end =
-        batch_start + blockDim.x * blockDim.y < n ? batch_start + blockDim.x * blockDim.y : n;
-
-    // Loop over the batch of <= 1024 loaded indices in chunks of blockDim.y = 32
-    for (int chunk_start = batch_start; chunk_start < batch_end; chunk_start += blockDim.y) {
-      // This does double duty:  it makes sure indices_batch is ready, and it makes sure
-      // match-group leaders are done with their accumulates before other warps start loading
-      // again.
-      __syncthreads();
+template <typename T>
+void LaunchSegmentReduce(const T* grad, const int64_t* indices, int n, int range, int stride,
+                         void* workspace, T* dense_out, int64_t* sparse_rows, T* sparse_values,
+                         cudaStream_t stream) {
+  SortedIndices buf;
+  LayoutSortedIndices(n, range, workspace, &buf);
+  SortIndices(indices, n, range, buf, stream);
+  int threads = std::min(kMaxThreadsPerSegment, (stride + 31) / 32 * 32);
+  SegmentReduceKernel<T><<<n, threads, 0, stream>>>(grad, buf, stride, dense_out, sparse_rows,
+                                                    sparse_values);
+}
 
-      int n_this_chunk =
-          (batch_end - chunk_start) < blockDim.y ? (batch_end - chunk_start) : blockDim.y;
+}  // namespace
+
+size_t LayoutSortedIndices(int n, int range, void* workspace, SortedIndices* buf) {
+  size_t sort_bytes = 0, encode_bytes = 0, scan_bytes = 0;
+  CUDA_CALL(cub::DeviceRadixSort::SortPairs(nullptr, sort_bytes, static_cast<int64_t*>(nullptr),
+                                            static_cast<int64_t*>(nullptr),
+                                            static_cast<int*>(nullptr), static_cast<int*>(nullptr),
+                                            n, 0, EndBit(range)));
+  CUDA_CALL(cub::DeviceRunLengthEncode::Encode(
+      nullptr, encode_bytes, static_cast<int64_t*>(nullptr), static_cast<int64_t*>(nullptr),
+      static_cast<int*>(nullptr), static_cast<int*>(nullptr), n));
+  CUDA_CALL(cub::DeviceScan::ExclusiveSum(nullptr, scan_bytes, static_cast<int*>(nullptr),
+                                          static_cast<int*>(nullptr), n));
+  size_t temp_bytes = std::max(sort_bytes, std::max(encode_bytes, scan_bytes));
+
+  // The 64-bit buffers go first, so all buffers are aligned.
+  size_t sizes[] = {AlignUp(sizeof(int64_t) * n), AlignUp(sizeof(int64_t) * n),
+                    AlignUp(sizeof(int) * n),     AlignUp(sizeof(int) * n),
+                    AlignUp(sizeof(int) * n),     AlignUp(sizeof(int) * n),
+                    AlignUp(sizeof(int)),         AlignUp(temp_bytes)};
+  size_t total = 0;
+  for (size_t size : sizes) {
+    total += size;
+  }
+  if (workspace != nullptr) {
+    char* ptr = static_cast<char*>(workspace);
+    buf->sorted_rows = reinterpret_cast<int64_t*>(ptr);
+    buf->unique_rows = reinterpret_cast<int64_t*>(ptr += sizes[0]);
+    buf->positions = reinterpret_cast<int*>(ptr += sizes[1]);
+    buf->sorted_positions = reinterpret_cast<int*>(ptr += sizes[2]);
+    buf->counts = reinterpret_cast<int*>(ptr += sizes[3]);
+    buf->offsets = reinterpret_cast<int*>(ptr += sizes[4]);
+    buf->num_runs = reinterpret_cast<int*>(ptr += sizes[5]);
+    buf->temp = ptr + sizes[6];
+    buf->temp_bytes = temp_bytes;
+  }
+  return total;
+}
 
-      int src_row = chunk_start + threadIdx.y;
-      int dst_row = indices_batch[src_row - batch_start];  // This warp's target row in grad_weight
+void SortIndices(const int64_t* indices, int n, int range, const SortedIndices& buf,
+                 void* stream) {
+  cudaStream_t cu_stream = static_cast<cudaStream_t>(stream);
+  const int threads = 256;
+  InitPositionsKernel<<<(n + threads - 1) / threads, threads, 0, cu_stream>>>(indices, n, range,
+                                                                             buf.positions);
+  size_t temp_bytes = buf.temp_bytes;
+  CUDA_CALL(cub::DeviceRadixSort::SortPairs(buf.temp, temp_bytes, indices, buf.sorted_rows,
+                                            buf.positions, buf.sorted_positions, n, 0,
+                                            EndBit(range), cu_stream));
+  temp_bytes = buf.temp_bytes;
+  CUDA_CALL(cub::DeviceRunLengthEncode::Encode(buf.temp, temp_bytes, buf.sorted_rows,
+                                               buf.unique_rows, buf.counts, buf.num_runs, n,
+                                               cu_stream));
+  temp_bytes = buf.temp_bytes;
+  CUDA_CALL(cub::DeviceScan::ExclusiveSum(buf.temp, temp_bytes, buf.counts, buf.offsets, n,
+                                          cu_stream));
+}
 
-      // All warps load their smem segments with incoming grad data
-      if (src_row < n && f < stride) {
-        my_s[threadIdx.x] = static_cast<accscalar_t>(grad[src_row * stride + f]);
-      }
+size_t embedding_backward_workspace_bytes(int num, int range) {
+  return LayoutSortedIndices(num, range, nullptr, nullptr);
+}
 
-      __syncthreads();
-
-      // To ensure determinism, we can't just have each warp add its grad data to its dst_row.
-      // We need to check if any other warps pulled grad data targeting dst_row.
-      // If so, we elect the first warp in each matching group as the leader.
-      // Each leader warp serializes the accumulates targeting dst_row in shared memory,
-      // then finishes by adding the accumulated buffer to dst_row in grad_weight.
-      if (src_row < n)  // Per-warp exit condition, safe with ballot_sync
-      {
-        int match_found_this_thread =
-            (dst_row == indices_batch[chunk_start - batch_start + threadIdx.x]);
-        if (threadIdx.x >= n_this_chunk) match_found_this_thread = 0;
-        unsigned int matchmask = WARP_BALLOT(match_found_this_thread);
-        int first_remaining_peer = __ffs(matchmask) - 1;
-
-        if (threadIdx.y == first_remaining_peer)  // Nominate lowest-indexed warp as the leader
-        {
-          matchmask ^= (1 << first_remaining_peer);
-          while (matchmask) {
-            first_remaining_peer = __ffs(matchmask) - 1;
-            my_s[threadIdx.x] =
-                add(my_s[threadIdx.x], smem[threadIdx.x + WARP_SIZE * first_remaining_peer]);
-            matchmask ^= (1 << first_remaining_peer);
-          }
-          if (f < stride) {
-            output[dst_row * stride + f] =
-                add(output[dst_row * stride + f], static_cast<scalar_t>(my_s[threadIdx.x]));
-          }
-        }
-      }
-    }
+template <typename T>
+void embedding_dense_backward_cuda(const T* grad, T* output, const int64_t* indices, int num,
+                                   int range, int stride, void* workspace, void* stream) {
+  cudaStream_t cu_stream = static_cast<cudaStream_t>(stream);
+  CUDA_CALL(cudaMemsetAsync(output, 0, sizeof(T) * static_cast<size_t>(range) * stride, cu_stream));
+  if (num == 0) {
+    return;
   }
+  LaunchSegmentReduce<T>(grad, indices, num, range, stride, workspace, output, nullptr, nullptr,
+                         cu_stream);
 }
 
-template <typename scalar_t, typename accscalar_t>
-void embedding_dense_backward_cuda(const scalar_t* grad, accscalar_t* output,
-                                   const int64_t* indices, int num, int range, int stride,
-                                   void* stream, int64_t element) {
-  dim3 grid(CeilDiv(stride, (int64_t)WARP_SIZE));
-  dim3 block(WARP_SIZE, BLOCKDIMY);
-  CUDA_CALL(cudaMemsetAsync(output, 0, element * sizeof(accscalar_t), static_cast<cudaStream_t>(stream)));
-  embedding_backward_feature_kernel<scalar_t, accscalar_t>
-      <<<grid, block,
-         sizeof(accscalar_t) * WARP_SIZE * BLOCKDIMY + sizeof(int) * WARP_SIZE * BLOCKDIMY,
-         static_cast<cudaStream_t>(stream)>>>(
-          indices, grad, output, num, range, stride);
+template <typename T>
+void embedding_sparse_backward_cuda(const T* grad, int64_t* rows, T* values,
+                                    const int64_t* indices, int num, int range, int stride,
+                                    void* workspace, void* stream) {
+  if (num == 0) {
+    return;
+  }
+  LaunchSegmentReduce<T>(grad, indices, num, range, stride, workspace, nullptr, rows, values,
+                         static_cast<cudaStream_t>(stream));
 }
 
+template void embedding_dense_backward_cuda<float>(const float*, float*, const int64_t*, int, int,
+                                                   int, void*, void*);
+template void embedding_dense_backward_cuda<__half>(const __half*, __half*, const int64_t*, int,
+                                                    int, int, void*, void*);
+template void embedding_sparse_backward_cuda<float>(const float*, int64_t*, float*,
+                                                    const int64_t*, int, int, int, void*, void*);
+template void embedding_sparse_backward_cuda<__half>(const __half*, int64_t*, __half*,
+                                                     const int64_t*, int, int, int, void*, void*);
+
 }  // namespace cuda
 }  // namespace op
 }  // namespace raf
@@ -0,0 +1,58 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/embedding_sum_cuda_kernel.cu
+ * \brief The sum of the rows gathered from embedding tables, which is the input of layer norms
+ */
+#include <algorithm>
+#include "./layer_norm.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+using namespace c10;
+
+namespace {
+
+constexpr int kBlockSize = 512;
+
+template <typename T>
+__global__ void EmbeddingSumKernel(T* out, EmbeddingGather<T> gather, int64_t n, int n2) {
+  for (int64_t i = blockIdx.x * blockDim.x + threadIdx.x; i < n; i += blockDim.x * gridDim.x) {
+    const int64_t row = i / n2;
+    const int col = i % n2;
+    float sum = 0.0f;
+    for (int t = 0; t < gather.num_tables; ++t) {
+      int64_t index = gather.indices[t][row % gather.num_indices[t]];
+      index = min(max(index, static_cast<int64_t>(0)), gather.table_rows[t] - 1);
+      sum += static_cast<float>(gather.tables[t][index * n2 + col]);
+    }
+    out[i] = static_cast<T>(sum);
+  }
+}
+
+}  // namespace
+
+template <typename T>
+void HostEmbeddingSum(T* out, const EmbeddingGather<T>& gather, int n1, int n2, void* stream) {
+  const int64_t n = static_cast<int64_t>(n1) * n2;
+  if (n == 0) {
+    return;
+  }
+  const int blocks = static_cast<int>(std::min<int64_t>((n + kBlockSize - 1) / kBlockSize, 4096));
+  EmbeddingSumKernel<T><<<blocks, kBlockSize, 0, static_cast<cudaStream_t>(stream)>>>(out, gather,
+                                                                                      n, n2);
+  CUDA_CALL(cudaGetLastError());
+}
+
+template void HostEmbeddingSum<Half>(Half* out, const EmbeddingGather<Half>& gather, int n1,
+                                     int n2, void* stream);
+template void HostEmbeddingSum<float>(float* out, const EmbeddingGather<float>& gather, int n1,
+                                      int n2, void* stream);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,47 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/fp8_scale.cu
+ * \brief The delayed scaling of the FP8 tensors, whose amax history stays on the device
+ */
+#include "./kernel_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+namespace {
+
+/*!
+ * \brief A single thread shifts the history, which is as short as tens of steps, so that the
+ * shift is done in place without hazards.
+ */
+__global__ void UpdateFp8ScaleKernel(float* amax_history, int history_len, float* scale,
+                                     const float* amax, float fp8_max, int margin) {
+  float max_amax = *amax;
+  for (int i = history_len - 1; i > 0; --i) {
+    float value = amax_history[i - 1];
+    amax_history[i] = value;
+    max_amax = fmaxf(max_amax, value);
+  }
+  amax_history[0] = *amax;
+  if (isfinite(max_amax) && max_amax > 0.0f) {
+    *scale = ldexpf(max_amax / fp8_max, margin);
+  }
+}
+
+}  // namespace
+
+void update_fp8_scale_cuda(float* amax_history, int history_len, float* scale, const float* amax,
+                           float fp8_max, int margin, void* stream) {
+  UpdateFp8ScaleKernel<<<1, 1, 0, static_cast<cudaStream_t>(stream)>>>(
+      amax_history, history_len, scale, amax, fp8_max, margin);
+  CUDA_CALL(cudaGetLastError());
+}
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,72 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/grouped_gemm_args.cu
+ * \brief Fill the arguments of the grouped GEMM from the group sizes on the device
+ */
+#include "./kernel_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+namespace {
+
+__device__ __forceinline__ void* GroupedPtr(const GroupedGemmOperand& x, int64_t group,
+                                            int64_t offset, int elem_bytes) {
+  const char* base = static_cast<const char*>(x.base);
+  return const_cast<char*>(base + (group * x.group_stride + offset * x.row_stride) * elem_bytes);
+}
+
+/*!
+ * \brief Each thread fills the arguments of a group. The offset of a group sums up the sizes of
+ * the groups before it, which is cheap for the number of experts in practice.
+ */
+__global__ void GroupedGemmArgsKernel(const int64_t* __restrict__ group_sizes, int num_groups,
+                                      int m, int n, int k, int var_dim, int elem_bytes,
+                                      GroupedGemmOperand a, GroupedGemmOperand b,
+                                      GroupedGemmOperand d, int* problem_sizes, void** ptrs,
+                                      int64_t* lds) {
+  int e = blockIdx.x * blockDim.x + threadIdx.x;
+  if (e >= num_groups) {
+    return;
+  }
+  int64_t offset = 0;
+  for (int i = 0; i < e; ++i) {
+    offset += group_sizes[i];
+  }
+  int dims[3] = {m, n, k};
+  dims[var_dim] = static_cast<int>(group_sizes[e]);
+  problem_sizes[3 * e + 0] = dims[0];
+  problem_sizes[3 * e + 1] = dims[1];
+  problem_sizes[3 * e + 2] = dims[2];
+  ptrs[e] = GroupedPtr(a, e, offset, elem_bytes);
+  ptrs[num_groups + e] = GroupedPtr(b, e, offset, elem_bytes);
+  ptrs[2 * num_groups + e] = GroupedPtr(d, e, offset, elem_bytes);
+  lds[e] = a.ld;
+  lds[num_groups + e] = b.ld;
+  lds[2 * num_groups + e] = d.ld;
+}
+
+}  // namespace
+
+void grouped_gemm_args_cuda(const int64_t* group_sizes, int num_groups, int m, int n, int k,
+                            int var_dim, int elem_bytes, GroupedGemmOperand a,
+                            GroupedGemmOperand b, GroupedGemmOperand d, int* problem_sizes,
+                            void** ptrs, int64_t* lds, void* stream) {
+  CHECK(var_dim >= 0 && var_dim < 3) << "The variable dim must be one of m, n and k";
+  if (num_groups == 0) {
+    return;
+  }
+  const int threads = 128;
+  const int blocks = (num_groups + threads - 1) / threads;
+  GroupedGemmArgsKernel<<<blocks, threads, 0, static_cast<cudaStream_t>(stream)>>>(
+      group_sizes, num_groups, m, n, k, var_dim, elem_bytes, a, b, d, problem_sizes, ptrs, lds);
+}
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -17,21 +17,235 @@ namespace raf {
 namespace op {
 namespace cuda {
 
-template <typename scalar_t, typename accscalar_t>
-void embedding_dense_backward_cuda(const scalar_t* grad, accscalar_t* output,
-                                   const int64_t* indices, int num, int range,
-                                   int stride, void* stream, int64_t element);
+/*! \brief The buffers to sort the indices and to encode the runs of equal indices. */
+struct SortedIndices {
+  int* positions;
+  int64_t* sorted_rows;
+  int* sorted_positions;
+  int64_t* unique_rows;
+  int* counts;
+  int* offsets;
+  int* num_runs;
+  void* temp;
+  size_t temp_bytes;
+};
+
+/*!
+ * \brief Carve the buffers to sort num indices in [0, range) out of the workspace, and return the
+ * total bytes. Only the size is computed when the workspace is nullptr.
+ */
+size_t LayoutSortedIndices(int num, int range, void* workspace, SortedIndices* buf);
+
+/*!
+ * \brief Sort the indices with their positions, and encode the runs of equal indices. The run r
+ * has counts[r] indices equal to unique_rows[r], whose positions are sorted_positions[offsets[r]:]
+ * in ascending order. It traps on the indices out of [0, range).
+ */
+void SortIndices(const int64_t* indices, int num, int range, const SortedIndices& buf,
+                 void* stream);
+
+/*! \brief The workspace bytes of the embedding backward with num indices in [0, range). */
+size_t embedding_backward_workspace_bytes(int num, int range);
+
+/*!
+ * \brief Reduce the gradients of the equal indices to the rows of the dense output of
+ * [range, stride]. The indices are sorted instead of scattered with atomics, so the result is
+ * deterministic.
+ */
+template <typename T>
+void embedding_dense_backward_cuda(const T* grad, T* output, const int64_t* indices, int num,
+                                   int range, int stride, void* workspace, void* stream);
+
+/*!
+ * \brief Reduce the gradients of the equal indices to the row-sparse output. The unique indices
+ * are written to rows of num elements in ascending order, and their reduced gradients to values
+ * of [num, stride]. The remaining rows are padded with -1 and their values with zeros.
+ */
+template <typename T>
+void embedding_sparse_backward_cuda(const T* grad, int64_t* rows, T* values,
+                                    const int64_t* indices, int num, int range, int stride,
+                                    void* workspace, void* stream);
+
+/*!
+ * \brief Apply the momentum SGD to the rows of x and v in the row-sparse gradient. The rows
+ * padded with -1 are skipped, and the rows absent from the gradient are left untouched.
+ */
+template <typename T>
+void sparse_sgd_cuda(T* x, T* v, const int64_t* rows, const T* values, int num, int stride,
+                     float learning_rate, float mu, void* stream);
 
 template <typename T>
 void multi_tensor_lans_cuda(int chunk_size, std::vector<T*> tensor_lists, const float lr,
                             const float beta1, const float beta2, const float epsilon,
-                            const int bias_correction, const float bias_correction1,
-                            const float bias_correction2, const float beta3,
+                            const int bias_correction, const float* step, const float beta3,
                             const float weight_decay, const int grad_averaging, const int mode,
                             const bool normalize_grad, const std::vector<int> numels, void* stream,
                             float* output_per_tensor, float* grad_norm_tensor,
                             float* param_norm_tensor, float* update_m_norm, float* q_norm_tensor,
-                            int max_chunks_per_tensor);
+                            int max_chunks_per_tensor, const float* skip);
+
+/*! \brief The number of elements of a tensor processed by a block of the multi-tensor kernels. */
+constexpr int kMultiTensorChunkSize = 65536;
+
+/*! \brief Compute the L2 norm of each tensor in the list into ret_per_tensor. */
+template <typename T>
+void multi_tensor_l2norm_cuda(int chunk_size, std::vector<T*> tensor_lists,
+                              std::vector<int> numels, float* output_per_tensor,
+                              float* ret_per_tensor, void* stream, int max_chunks_per_tensor);
+
+/*!
+ * \brief Fused momentum SGD over the groups of grads, weights and momentums. When with_copy is
+ * set, a trailing group of weight copies receives the updated weights, which is used to hold
+ * float32 master weights for float16 models. is_half marks the float16 groups. Nothing is
+ * updated when the optional skip flag on the device is non-zero.
+ */
+void multi_tensor_sgd_cuda(const std::vector<void*>& tensor_lists, const std::vector<int>& numels,
+                           const std::vector<bool>& is_half, bool with_copy, float lr, float mu,
+                           const float* skip, void* stream);
+
+/*!
+ * \brief Fused AdamW over the groups of grads, weights, first and second moments, and the
+ * optional weight copies. The step counter and the optional skip flag are read from the device.
+ */
+void multi_tensor_adamw_cuda(const std::vector<void*>& tensor_lists,
+                             const std::vector<int>& numels, const std::vector<bool>& is_half,
+                             bool with_copy, const float* step, float lr, float beta1, float beta2,
+                             float eps, float weight_decay, bool bias_correction,
+                             const float* skip, void* stream);
+
+/*!
+ * \brief Fused LAMB over the same groups as AdamW. The float32 update buffer holds as many
+ * elements as all weights, and the norm buffers hold one float per tensor.
+ */
+void multi_tensor_lamb_cuda(const std::vector<void*>& tensor_lists,
+                            const std::vector<int>& numels, const std::vector<bool>& is_half,
+                            bool with_copy, const float* step, float lr, float beta1, float beta2,
+                            float eps, float weight_decay, bool bias_correction, float* update,
+                            float* output_per_tensor, float* weight_norm, float* update_norm,
+                            int max_chunks_per_tensor, const float* skip, void* stream);
+
+/*!
+ * \brief The L2 norm of each tensor of the list into norms, and the L2 norm of all tensors into
+ * global_norm. The tensors have the same dtype, and output_per_tensor holds the partial sums of
+ * max_chunks_per_tensor chunks of each tensor.
+ */
+void multi_tensor_norms_cuda(const std::vector<void*>& tensor_list, const std::vector<int>& numels,
+                             bool is_half, float* output_per_tensor, float* norms,
+                             float* global_norm, int max_chunks_per_tensor, void* stream);
+
+/*!
+ * \brief Scale the tensors of the same dtype in place by min(1, max_norm / (norm + eps)), where
+ * the norm is read from the device.
+ */
+void multi_tensor_clip_cuda(const std::vector<void*>& tensor_list, const std::vector<int>& numels,
+                            bool is_half, const float* norm, float max_norm, float eps,
+                            void* stream);
+
+/*!
+ * \brief Divide the tensors of the same dtype in place by the loss scale on the device, and set
+ * found_inf to 1 if any result is not finite, or 0 otherwise.
+ */
+void multi_tensor_unscale_cuda(const std::vector<void*>& tensor_list,
+                               const std::vector<int>& numels, bool is_half, const float* scale,
+                               float* found_inf, void* stream);
+
+/*!
+ * \brief Update the loss scale and its growth tracker on the device by the overflow flag, i.e.,
+ * multiply the scale by backoff_factor on overflow, or by growth_factor after growth_interval
+ * finite steps.
+ */
+void update_loss_scale_cuda(float* scale, float* growth_tracker, const float* found_inf,
+                            float growth_factor, float backoff_factor, int growth_interval,
+                            void* stream);
+
+/*!
+ * \brief Push the amax into the front of the amax history on the device, and update the scale of
+ * the FP8 tensor to the maximum of the history divided by fp8_max and multiplied by 2^margin. The
+ * scale is kept if the history is all zeros or not finite.
+ */
+void update_fp8_scale_cuda(float* amax_history, int history_len, float* scale, const float* amax,
+                           float fp8_max, int margin, void* stream);
+
+/*!
+ * \brief Copy a list of tensors to another list of tensors in a single launch. The first half of
+ * tensor_lists are the sources and the second half are the destinations. Each element is casted
+ * from src_dtype to dst_dtype and multiplied by scale. Casting and scaling are only supported for
+ * float32, float16 and bfloat16 (from/to float32); otherwise the copy is bitwise.
+ */
+void multi_tensor_copy_cuda(const std::vector<void*>& tensor_lists, const std::vector<int>& numels,
+                            DLDataType src_dtype, DLDataType dst_dtype, float scale, void* stream);
+
+/*! \brief Gather the tensors of the same dtype into the buffer back-to-back in a single launch. */
+void multi_tensor_pack_cuda(const std::vector<DLTensor*>& tensors, void* buffer, void* stream);
+
+/*! \brief Scatter the buffer to the tensors of the same dtype in a single launch. */
+void multi_tensor_unpack_cuda(const void* buffer, const std::vector<DLTensor*>& tensors,
+                              void* stream);
+
+/*!
+ * \brief Copy between device tensors of the shape with arbitrary strides in elements. The copy is
+ * bitwise, so any dtype of elem_bytes is supported.
+ */
+void strided_copy_cuda(const void* src, void* dst, const std::vector<int64_t>& shape,
+                       const std::vector<int64_t>& src_strides,
+                       const std::vector<int64_t>& dst_strides, int elem_bytes, void* stream);
+
+/*!
+ * \brief Accumulate the gradient to the error feedback and select its top-k elements by magnitude.
+ * The selected elements are moved from the error feedback to indices and values.
+ * \param magnitude The workspace of n floats.
+ * \param counter The workspace of an integer.
+ */
+void topk_compress_cuda(const float* grad, float* error, int64_t n, int k, float* magnitude,
+                        int* counter, int* indices, float* values, void* stream);
+
+/*! \brief Scatter-add the scaled sparse values to the dense output of n elements. */
+void topk_decompress_cuda(const int* indices, const float* values, int64_t total, float scale,
+                          float* out, int64_t n, void* stream);
+
+/*!
+ * \brief Sum up the chunks of float16 or bfloat16 elements laid out back-to-back, where each
+ * element is upcasted and accumulated in float32, scaled, and casted back to the dtype.
+ * \param chunks The num_chunks chunks of n elements.
+ * \param out The output of n elements.
+ */
+void chunk_accumulate_cuda(const void* chunks, int num_chunks, int64_t n, DLDataType dtype,
+                           float scale, void* out, void* stream);
+
+/*! \brief Reset the summary of 4 floats to accumulate the tensors by tensor_stats_cuda. */
+void init_tensor_stats_cuda(float* stats, void* stream);
+
+/*!
+ * \brief Accumulate the summary of n elements to stats: the min and the max of the non-NaN
+ * elements, the number of NaNs, and the sum of squares.
+ * \return Whether the dtype is supported.
+ */
+bool tensor_stats_cuda(const void* data, int64_t n, DLDataType dtype, float* stats, void* stream);
+
+/*!
+ * \brief An operand of the grouped GEMM, whose matrix of the group e starts at the element
+ * e * group_stride + offset_e * row_stride, where offset_e is the total size of the groups
+ * before e. Its leading dimension is the same for all the groups.
+ */
+struct GroupedGemmOperand {
+  const void* base;
+  int64_t group_stride;
+  int64_t row_stride;
+  int64_t ld;
+};
+
+/*!
+ * \brief Fill the arguments of the grouped GEMM from the group sizes on the device, so that the
+ * host does not wait for the sizes. The problem of the group e is {m, n, k}, whose dim var_dim is
+ * replaced by the size of the group.
+ * \param problem_sizes The num_groups problems, each of 3 integers in the order of m, n and k.
+ * \param ptrs The num_groups pointers of a, b and d in turn.
+ * \param lds The num_groups leading dimensions of a, b and d in turn.
+ */
+void grouped_gemm_args_cuda(const int64_t* group_sizes, int num_groups, int m, int n, int k,
+                            int var_dim, int elem_bytes, GroupedGemmOperand a,
+                            GroupedGemmOperand b, GroupedGemmOperand d, int* problem_sizes,
+                            void** ptrs, int64_t* lds, void* stream);
 
 }  // namespace cuda
 }  // namespace op
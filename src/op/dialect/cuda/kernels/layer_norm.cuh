@@ -10,6 +10,7 @@
 #pragma once
 #include <cuda_fp16.h>
 #include <stdint.h>
+#include <initializer_list>
 #include <vector>
 #include "./Half.h"
 #include "../../../../common/cuda_utils.h"
@@ -29,6 +30,82 @@ void HostLayerNormGradient(const V* dout, const float* mean, const float* invvar
                            V* grad_beta, float* part_gard_gamma, float* part_grad_beta,
                            void* stream, const uint64_t maxGridY);
 
+/*! \brief The width in bytes of the vectorized loads and stores of the warp-per-row kernel. */
+constexpr int kLayerNormVecBytes = 16;
+
+/*! \brief The maximum hidden size supported by the warp-per-row layer norm kernel. */
+constexpr int kLayerNormWarpMaxCols = 1024;
+
+/*! \brief The maximum number of the embedding tables gathered by EmbeddingGather. */
+constexpr int kMaxEmbeddingTables = 3;
+
+/*!
+ * \brief The rows gathered from a few embedding tables and summed, e.g. the token, position and
+ * token type embeddings of BERT. The tables are in [table_rows[t], n2]. Row i of the sum takes
+ * the row indices[t][i % num_indices[t]] of table t, so the indices are broadcast along the
+ * leading dims, and the out-of-range indices are clipped.
+ */
+template <typename T>
+struct EmbeddingGather {
+  int num_tables = 0;
+  const T* tables[kMaxEmbeddingTables] = {};
+  const int64_t* indices[kMaxEmbeddingTables] = {};
+  int64_t num_indices[kMaxEmbeddingTables] = {};
+  int64_t table_rows[kMaxEmbeddingTables] = {};
+};
+
+/*!
+ * \brief The optional prologue of the warp-per-row layer norm kernel, which normalizes
+ * sum = dropout(input, dropout_p) + residual instead of the input. The sum is written to sum_out
+ * for the backward, and the dropout mask (1 for kept) is written to mask when dropout_p > 0.
+ * The residual, sum_out and mask have the same shape as the input, and are aligned to the vector
+ * width as the input. When the gather has tables, the input is the sum of the gathered rows
+ * instead, which is only written to sum_out if it is given.
+ */
+template <typename T>
+struct LayerNormPrologue {
+  const T* residual = nullptr;
+  T* sum_out = nullptr;
+  float dropout_p = 0.0f;
+  uint8_t* mask = nullptr;
+  uint64_t seed = 0;
+  uint64_t offset = 0;
+  EmbeddingGather<T> gather;
+};
+
+/*!
+ * \brief Whether the warp-per-row layer norm kernel supports the problem. Each row is kept in the
+ * registers of a warp, so the hidden size must be at most kLayerNormWarpMaxCols, and a multiple
+ * of the vector width, with all the pointers aligned to the vector width.
+ */
+template <typename T>
+inline bool UseLayerNormWarp(int n2, std::initializer_list<const void*> ptrs) {
+  constexpr int vec_size = kLayerNormVecBytes / sizeof(T);
+  if (n2 > kLayerNormWarpMaxCols || n2 % vec_size != 0) {
+    return false;
+  }
+  for (const void* ptr : ptrs) {
+    if (ptr && reinterpret_cast<uintptr_t>(ptr) % kLayerNormVecBytes != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/*!
+ * \brief The layer norm of n1 rows with hidden size n2, where each row is normalized by one warp
+ * with 128-bit vectorized accesses, and kept in the registers between the reduction and the
+ * normalization. The gamma and beta are optional. See UseLayerNormWarp for the requirements.
+ */
+template <typename T>
+void HostApplyLayerNormWarp(T* output, float* mean, float* invvar, const T* input, int n1, int n2,
+                            const T* gamma, const T* beta, double epsilon,
+                            const LayerNormPrologue<T>& prologue, void* stream);
+
+/*! \brief out = the sum of the rows gathered by the gather, where out is in [n1, n2]. */
+template <typename T>
+void HostEmbeddingSum(T* out, const EmbeddingGather<T>& gather, int n1, int n2, void* stream);
+
 }  // namespace cuda
 }  // namespace op
 }  // namespace raf
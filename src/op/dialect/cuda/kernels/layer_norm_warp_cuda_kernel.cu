@@ -0,0 +1,273 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/layer_norm_warp_cuda_kernel.cu
+ * \brief Warp-per-row layer_norm forward cuda kernel for small hidden sizes
+ */
+#include <curand_kernel.h>
+#include "./layer_norm.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+using namespace c10;
+
+namespace {
+
+constexpr int kWarpSize = 32;
+constexpr int kWarpsPerBlock = 4;
+
+template <typename T, int N>
+struct alignas(sizeof(T) * N) AlignedVector {
+  T val[N];
+};
+
+template <typename T>
+struct WarpLayerNormParams {
+  T* output;
+  float* mean;
+  float* invvar;
+  const T* input;
+  const T* gamma;
+  const T* beta;
+  int n1;
+  int n2;
+  float epsilon;
+  LayerNormPrologue<T> prologue;
+};
+
+__device__ __forceinline__ float WarpAllReduceSum(float val) {
+#pragma unroll
+  for (int mask = kWarpSize / 2; mask > 0; mask /= 2) {
+    val += __shfl_xor_sync(0xffffffff, val, mask);
+  }
+  return val;
+}
+
+/*!
+ * \brief Each warp normalizes one row, where a lane holds kVecsPerLane vectors of the row in the
+ * registers. The vectors are interleaved across the lanes, so the accesses of a warp coalesce.
+ */
+template <typename T, int kVecsPerLane, bool kResidual, bool kDropout>
+__global__ void WarpLayerNormKernel(WarpLayerNormParams<T> params) {
+  constexpr int kVecSize = kLayerNormVecBytes / sizeof(T);
+  using Vec = AlignedVector<T, kVecSize>;
+  using MaskVec = AlignedVector<uint8_t, kVecSize>;
+  const int lane = threadIdx.x;
+  const int row = blockIdx.x * kWarpsPerBlock + threadIdx.y;
+  if (row >= params.n1) {
+    return;
+  }
+  const int num_vecs = params.n2 / kVecSize;
+  const int64_t row_offset = static_cast<int64_t>(row) * params.n2;
+  const Vec* input = reinterpret_cast<const Vec*>(params.input + row_offset);
+  // The rows of the embedding tables to be summed as the input.
+  const auto& gather = params.prologue.gather;
+  const Vec* table_rows[kMaxEmbeddingTables];
+  for (int t = 0; t < gather.num_tables; ++t) {
+    int64_t index = gather.indices[t][row % gather.num_indices[t]];
+    index = min(max(index, static_cast<int64_t>(0)), gather.table_rows[t] - 1);
+    table_rows[t] = reinterpret_cast<const Vec*>(gather.tables[t] + index * params.n2);
+  }
+
+  curandStatePhilox4_32_10_t state;
+  float dropout_scale = 0.0f;
+  if (kDropout) {
+    curand_init(params.prologue.seed, static_cast<uint64_t>(row) * kWarpSize + lane,
+                params.prologue.offset, &state);
+    dropout_scale = 1.0f / (1.0f - params.prologue.dropout_p);
+  }
+
+  float vals[kVecsPerLane][kVecSize];
+  float sum = 0.0f;
+#pragma unroll
+  for (int i = 0; i < kVecsPerLane; ++i) {
+    const int v = i * kWarpSize + lane;
+    if (v >= num_vecs) {
+#pragma unroll
+      for (int j = 0; j < kVecSize; ++j) {
+        vals[i][j] = 0.0f;
+      }
+      continue;
+    }
+    if (gather.num_tables > 0) {
+#pragma unroll
+      for (int j = 0; j < kVecSize; ++j) {
+        vals[i][j] = 0.0f;
+      }
+      for (int t = 0; t < gather.num_tables; ++t) {
+        Vec in = table_rows[t][v];
+#pragma unroll
+        for (int j = 0; j < kVecSize; ++j) {
+          vals[i][j] += static_cast<float>(in.val[j]);
+        }
+      }
+    } else {
+      Vec in = input[v];
+#pragma unroll
+      for (int j = 0; j < kVecSize; ++j) {
+        vals[i][j] = static_cast<float>(in.val[j]);
+      }
+    }
+    if (kDropout) {
+      MaskVec mask;
+      float4 rand;
+#pragma unroll
+      for (int j = 0; j < kVecSize; ++j) {
+        if (j % 4 == 0) {
+          rand = curand_uniform4(&state);
+        }
+        float r = j % 4 == 0 ? rand.x : j % 4 == 1 ? rand.y : j % 4 == 2 ? rand.z : rand.w;
+        mask.val[j] = r > params.prologue.dropout_p;
+        vals[i][j] = mask.val[j] ? vals[i][j] * dropout_scale : 0.0f;
+      }
+      reinterpret_cast<MaskVec*>(params.prologue.mask + row_offset)[v] = mask;
+    }
+    if (kResidual) {
+      Vec residual = reinterpret_cast<const Vec*>(params.prologue.residual + row_offset)[v];
+#pragma unroll
+      for (int j = 0; j < kVecSize; ++j) {
+        vals[i][j] += static_cast<float>(residual.val[j]);
+      }
+    }
+    if (kResidual || kDropout || params.prologue.sum_out) {
+      // The statistics are computed from the rounded sum, which is the input of the backward.
+      Vec sum_out;
+#pragma unroll
+      for (int j = 0; j < kVecSize; ++j) {
+        sum_out.val[j] = static_cast<T>(vals[i][j]);
+        vals[i][j] = static_cast<float>(sum_out.val[j]);
+      }
+      reinterpret_cast<Vec*>(params.prologue.sum_out + row_offset)[v] = sum_out;
+    }
+#pragma unroll
+    for (int j = 0; j < kVecSize; ++j) {
+      sum += vals[i][j];
+    }
+  }
+  const float mean = WarpAllReduceSum(sum) / params.n2;
+
+  float sq_sum = 0.0f;
+#pragma unroll
+  for (int i = 0; i < kVecsPerLane; ++i) {
+    if (i * kWarpSize + lane < num_vecs) {
+#pragma unroll
+      for (int j = 0; j < kVecSize; ++j) {
+        float diff = vals[i][j] - mean;
+        sq_sum += diff * diff;
+      }
+    }
+  }
+  const float invvar = rsqrtf(WarpAllReduceSum(sq_sum) / params.n2 + params.epsilon);
+  if (lane == 0) {
+    params.mean[row] = mean;
+    params.invvar[row] = invvar;
+  }
+
+  Vec* output = reinterpret_cast<Vec*>(params.output + row_offset);
+#pragma unroll
+  for (int i = 0; i < kVecsPerLane; ++i) {
+    const int v = i * kWarpSize + lane;
+    if (v >= num_vecs) {
+      continue;
+    }
+    Vec gamma, beta, out;
+    if (params.gamma) {
+      gamma = reinterpret_cast<const Vec*>(params.gamma)[v];
+    }
+    if (params.beta) {
+      beta = reinterpret_cast<const Vec*>(params.beta)[v];
+    }
+#pragma unroll
+    for (int j = 0; j < kVecSize; ++j) {
+      float y = (vals[i][j] - mean) * invvar;
+      y = params.gamma ? y * static_cast<float>(gamma.val[j]) : y;
+      y = params.beta ? y + static_cast<float>(beta.val[j]) : y;
+      out.val[j] = static_cast<T>(y);
+    }
+    output[v] = out;
+  }
+}
+
+template <typename T, int kVecsPerLane>
+void LaunchWarpLayerNorm(const WarpLayerNormParams<T>& params, cudaStream_t stream) {
+  dim3 threads(kWarpSize, kWarpsPerBlock);
+  dim3 blocks((params.n1 + kWarpsPerBlock - 1) / kWarpsPerBlock);
+  bool residual = params.prologue.residual != nullptr;
+  if (params.prologue.dropout_p > 0.0f) {
+    if (residual) {
+      WarpLayerNormKernel<T, kVecsPerLane, true, true><<<blocks, threads, 0, stream>>>(params);
+    } else {
+      WarpLayerNormKernel<T, kVecsPerLane, false, true><<<blocks, threads, 0, stream>>>(params);
+    }
+  } else {
+    if (residual) {
+      WarpLayerNormKernel<T, kVecsPerLane, true, false><<<blocks, threads, 0, stream>>>(params);
+    } else {
+      WarpLayerNormKernel<T, kVecsPerLane, false, false><<<blocks, threads, 0, stream>>>(params);
+    }
+  }
+}
+
+/*! \brief Dispatch the number of vectors per lane, from kVecsPerLane down to 1. */
+template <typename T, int kVecsPerLane>
+struct WarpLayerNormDispatcher {
+  static void Run(int vecs_per_lane, const WarpLayerNormParams<T>& params, cudaStream_t stream) {
+    if (vecs_per_lane == kVecsPerLane) {
+      LaunchWarpLayerNorm<T, kVecsPerLane>(params, stream);
+    } else {
+      WarpLayerNormDispatcher<T, kVecsPerLane - 1>::Run(vecs_per_lane, params, stream);
+    }
+  }
+};
+
+template <typename T>
+struct WarpLayerNormDispatcher<T, 0> {
+  static void Run(int vecs_per_lane, const WarpLayerNormParams<T>& params, cudaStream_t stream) {
+    LOG(FATAL) << "Unsupported hidden size of the warp-per-row layer norm: " << params.n2;
+  }
+};
+
+}  // namespace
+
+template <typename T>
+void HostApplyLayerNormWarp(T* output, float* mean, float* invvar, const T* input, int n1, int n2,
+                            const T* gamma, const T* beta, double epsilon,
+                            const LayerNormPrologue<T>& prologue, void* stream) {
+  constexpr int kVecSize = kLayerNormVecBytes / sizeof(T);
+  constexpr int kMaxVecsPerLane = kLayerNormWarpMaxCols / (kWarpSize * kVecSize);
+  const auto& tables = prologue.gather.tables;
+  CHECK(UseLayerNormWarp<T>(n2, {output, input, gamma, beta, prologue.residual, prologue.sum_out,
+                                 prologue.mask, tables[0], tables[1], tables[2]}));
+  CHECK(prologue.dropout_p <= 0.0f || prologue.mask)
+      << "The dropout mask is required by the warp-per-row layer norm";
+  CHECK((!prologue.residual && prologue.dropout_p <= 0.0f) || prologue.sum_out)
+      << "The sum is required by the warp-per-row layer norm";
+  if (n1 == 0) {
+    return;
+  }
+  WarpLayerNormParams<T> params{output, mean, invvar, input,
+                                gamma,  beta, n1,     n2,
+                                static_cast<float>(epsilon), prologue};
+  int vecs_per_lane = (n2 / kVecSize + kWarpSize - 1) / kWarpSize;
+  WarpLayerNormDispatcher<T, kMaxVecsPerLane>::Run(vecs_per_lane, params,
+                                                   static_cast<cudaStream_t>(stream));
+}
+
+template void HostApplyLayerNormWarp<Half>(Half* output, float* mean, float* invvar,
+                                           const Half* input, int n1, int n2, const Half* gamma,
+                                           const Half* beta, double epsilon,
+                                           const LayerNormPrologue<Half>& prologue, void* stream);
+
+template void HostApplyLayerNormWarp<float>(float* output, float* mean, float* invvar,
+                                            const float* input, int n1, int n2,
+                                            const float* gamma, const float* beta, double epsilon,
+                                            const LayerNormPrologue<float>& prologue,
+                                            void* stream);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,64 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/masked_softmax.cuh
+ * \brief Headers of CUDA fused scale + mask + softmax kernels
+ */
+#pragma once
+#include <cuda_fp16.h>
+#include <stdint.h>
+#include "./Half.h"
+#include "../../../../common/cuda_utils.h"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+constexpr int kMaxMaskedSoftmaxDims = 8;
+
+/*!
+ * \brief Map a row of the output, i.e. an index over its leading dims, to the offsets of the
+ * corresponding rows of x and the mask, which are broadcast to the output. A broadcast dim has
+ * the stride of 0, which is how a padding mask in [b, 1, 1, s] and a causal mask in [1, 1, s, s]
+ * are both read from the scores in [b, h, s, s].
+ */
+struct MaskedSoftmaxIndexer {
+  /*! \brief The number of the leading dims of the output. */
+  int ndim;
+  /*! \brief The leading dims of the output. */
+  int64_t shape[kMaxMaskedSoftmaxDims];
+  /*! \brief The strides of x and the mask along the leading dims of the output. */
+  int64_t x_strides[kMaxMaskedSoftmaxDims];
+  int64_t mask_strides[kMaxMaskedSoftmaxDims];
+  /*! \brief The strides of x and the mask along the softmax axis, which is 0 or 1. */
+  int64_t x_col_stride;
+  int64_t mask_col_stride;
+};
+
+/*!
+ * \brief y = softmax(x * scale + mask, axis=-1), where y is in [rows, cols] after collapsing the
+ * leading dims. The scale is a scalar on the device, which is the divisor instead when
+ * scale_divide is set, and both the scale and the mask are optional. A row of up to 4096 elements
+ * is kept in the registers of a warp, so x and the mask are read once and y is written once;
+ * longer rows are processed by a block each. Rows that are fully masked by -inf are zeros.
+ */
+template <typename T>
+void HostMaskedSoftmaxForward(T* y, const T* x, const T* scale, const T* mask, bool scale_divide,
+                              const MaskedSoftmaxIndexer& indexer, int64_t rows, int cols,
+                              void* stream);
+
+/*!
+ * \brief dx = y * (dy - sum(dy * y, axis=-1)) * scale, which is the gradient of x when the
+ * forward is softmax(x * scale + mask), and y, dy and dx are in [rows, cols]. The scale is the
+ * same as the forward, and is optional.
+ */
+template <typename T>
+void HostMaskedSoftmaxBackward(T* dx, const T* y, const T* dy, const T* scale, bool scale_divide,
+                               int64_t rows, int cols, void* stream);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,300 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/masked_softmax_cuda_kernel.cu
+ * \brief Fused scale + mask + softmax forward and backward cuda kernels
+ */
+#include <cfloat>
+#include "./masked_softmax.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+using namespace c10;
+
+namespace {
+
+constexpr int kWarpSize = 32;
+constexpr int kWarpsPerBlock = 4;
+constexpr int kBlockSize = 512;
+// The longest row kept in the registers of a warp.
+constexpr int kMaxWarpCols = 4096;
+
+__device__ __forceinline__ float WarpMax(float val) {
+#pragma unroll
+  for (int mask = kWarpSize / 2; mask > 0; mask /= 2) {
+    val = fmaxf(val, __shfl_xor_sync(0xffffffff, val, mask));
+  }
+  return val;
+}
+
+__device__ __forceinline__ float WarpSum(float val) {
+#pragma unroll
+  for (int mask = kWarpSize / 2; mask > 0; mask /= 2) {
+    val += __shfl_xor_sync(0xffffffff, val, mask);
+  }
+  return val;
+}
+
+/*! \brief Reduce the values of the block, and broadcast the result to all threads. */
+template <bool kMax>
+__device__ float BlockReduce(float val) {
+  __shared__ float shared[kBlockSize / kWarpSize];
+  const int lane = threadIdx.x % kWarpSize;
+  const int warp = threadIdx.x / kWarpSize;
+  const float init = kMax ? -INFINITY : 0.0f;
+  val = kMax ? WarpMax(val) : WarpSum(val);
+  if (lane == 0) {
+    shared[warp] = val;
+  }
+  __syncthreads();
+  if (warp == 0) {
+    val = lane < blockDim.x / kWarpSize ? shared[lane] : init;
+    val = kMax ? WarpMax(val) : WarpSum(val);
+    if (lane == 0) {
+      shared[0] = val;
+    }
+  }
+  __syncthreads();
+  val = shared[0];
+  // The shared memory is reused by the next reduction.
+  __syncthreads();
+  return val;
+}
+
+template <typename T>
+__device__ __forceinline__ float LoadScale(const T* scale, bool scale_divide) {
+  if (scale == nullptr) {
+    return 1.0f;
+  }
+  float s = static_cast<float>(scale[0]);
+  return scale_divide ? 1.0f / s : s;
+}
+
+__device__ __forceinline__ void RowOffsets(const MaskedSoftmaxIndexer& indexer, int64_t row,
+                                           int64_t* x_offset, int64_t* mask_offset) {
+  *x_offset = 0;
+  *mask_offset = 0;
+  for (int i = indexer.ndim - 1; i >= 0; --i) {
+    int64_t index = row % indexer.shape[i];
+    row /= indexer.shape[i];
+    *x_offset += index * indexer.x_strides[i];
+    *mask_offset += index * indexer.mask_strides[i];
+  }
+}
+
+/*!
+ * \brief Each warp computes a row of at most kIters * 32 elements, which are kept in the
+ * registers between the passes.
+ */
+template <typename T, int kIters>
+__global__ void MaskedSoftmaxWarpKernel(T* y, const T* x, const T* scale, const T* mask,
+                                        bool scale_divide, MaskedSoftmaxIndexer indexer,
+                                        int64_t rows, int cols) {
+  const int64_t row = static_cast<int64_t>(blockIdx.x) * kWarpsPerBlock + threadIdx.x / kWarpSize;
+  if (row >= rows) {
+    return;
+  }
+  const int lane = threadIdx.x % kWarpSize;
+  const float s = LoadScale(scale, scale_divide);
+  int64_t x_offset, mask_offset;
+  RowOffsets(indexer, row, &x_offset, &mask_offset);
+  float vals[kIters];
+  float max = -INFINITY;
+#pragma unroll
+  for (int i = 0; i < kIters; ++i) {
+    const int col = lane + i * kWarpSize;
+    vals[i] = -INFINITY;
+    if (col < cols) {
+      vals[i] = static_cast<float>(x[x_offset + col * indexer.x_col_stride]) * s;
+      if (mask != nullptr) {
+        vals[i] += static_cast<float>(mask[mask_offset + col * indexer.mask_col_stride]);
+      }
+    }
+    max = fmaxf(max, vals[i]);
+  }
+  max = WarpMax(max);
+  // A fully masked row has no valid max, and its probabilities are zeros.
+  max = max == -INFINITY ? 0.0f : max;
+  float sum = 0.0f;
+#pragma unroll
+  for (int i = 0; i < kIters; ++i) {
+    vals[i] = __expf(vals[i] - max);
+    sum += vals[i];
+  }
+  sum = WarpSum(sum);
+  const float inv_sum = sum > 0.0f ? 1.0f / sum : 0.0f;
+  T* y_row = y + row * cols;
+#pragma unroll
+  for (int i = 0; i < kIters; ++i) {
+    const int col = lane + i * kWarpSize;
+    if (col < cols) {
+      y_row[col] = static_cast<T>(vals[i] * inv_sum);
+    }
+  }
+}
+
+/*! \brief Each block computes a long row, which reads x and the mask three times. */
+template <typename T>
+__global__ void MaskedSoftmaxBlockKernel(T* y, const T* x, const T* scale, const T* mask,
+                                         bool scale_divide, MaskedSoftmaxIndexer indexer,
+                                         int cols) {
+  const int64_t row = blockIdx.x;
+  const float s = LoadScale(scale, scale_divide);
+  int64_t x_offset, mask_offset;
+  RowOffsets(indexer, row, &x_offset, &mask_offset);
+  auto load = [&](int col) {
+    float val = static_cast<float>(x[x_offset + col * indexer.x_col_stride]) * s;
+    if (mask != nullptr) {
+      val += static_cast<float>(mask[mask_offset + col * indexer.mask_col_stride]);
+    }
+    return val;
+  };
+  float max = -INFINITY;
+  for (int col = threadIdx.x; col < cols; col += blockDim.x) {
+    max = fmaxf(max, load(col));
+  }
+  max = BlockReduce<true>(max);
+  max = max == -INFINITY ? 0.0f : max;
+  float sum = 0.0f;
+  for (int col = threadIdx.x; col < cols; col += blockDim.x) {
+    sum += __expf(load(col) - max);
+  }
+  sum = BlockReduce<false>(sum);
+  const float inv_sum = sum > 0.0f ? 1.0f / sum : 0.0f;
+  T* y_row = y + row * cols;
+  for (int col = threadIdx.x; col < cols; col += blockDim.x) {
+    y_row[col] = static_cast<T>(__expf(load(col) - max) * inv_sum);
+  }
+}
+
+template <typename T, int kIters>
+__global__ void MaskedSoftmaxBackwardWarpKernel(T* dx, const T* y, const T* dy, const T* scale,
+                                                bool scale_divide, int64_t rows, int cols) {
+  const int64_t row = static_cast<int64_t>(blockIdx.x) * kWarpsPerBlock + threadIdx.x / kWarpSize;
+  if (row >= rows) {
+    return;
+  }
+  const int lane = threadIdx.x % kWarpSize;
+  const float s = LoadScale(scale, scale_divide);
+  const int64_t offset = row * cols;
+  float y_vals[kIters], dy_vals[kIters];
+  float dot = 0.0f;
+#pragma unroll
+  for (int i = 0; i < kIters; ++i) {
+    const int col = lane + i * kWarpSize;
+    y_vals[i] = col < cols ? static_cast<float>(y[offset + col]) : 0.0f;
+    dy_vals[i] = col < cols ? static_cast<float>(dy[offset + col]) : 0.0f;
+    dot += y_vals[i] * dy_vals[i];
+  }
+  dot = WarpSum(dot);
+#pragma unroll
+  for (int i = 0; i < kIters; ++i) {
+    const int col = lane + i * kWarpSize;
+    if (col < cols) {
+      dx[offset + col] = static_cast<T>(y_vals[i] * (dy_vals[i] - dot) * s);
+    }
+  }
+}
+
+template <typename T>
+__global__ void MaskedSoftmaxBackwardBlockKernel(T* dx, const T* y, const T* dy, const T* scale,
+                                                 bool scale_divide, int cols) {
+  const int64_t offset = static_cast<int64_t>(blockIdx.x) * cols;
+  const float s = LoadScale(scale, scale_divide);
+  float dot = 0.0f;
+  for (int col = threadIdx.x; col < cols; col += blockDim.x) {
+    dot += static_cast<float>(y[offset + col]) * static_cast<float>(dy[offset + col]);
+  }
+  dot = BlockReduce<false>(dot);
+  for (int col = threadIdx.x; col < cols; col += blockDim.x) {
+    float y_val = static_cast<float>(y[offset + col]);
+    dx[offset + col] = static_cast<T>(y_val * (static_cast<float>(dy[offset + col]) - dot) * s);
+  }
+}
+
+/*! \brief Launch the warp kernel with the fewest 32-element chunks per lane that cover a row. */
+template <typename T, int kIters>
+void LaunchMaskedSoftmaxWarp(T* y, const T* x, const T* scale, const T* mask, bool scale_divide,
+                             const MaskedSoftmaxIndexer& indexer, int64_t rows, int cols,
+                             cudaStream_t stream) {
+  if (kIters * kWarpSize >= cols) {
+    const int64_t blocks = (rows + kWarpsPerBlock - 1) / kWarpsPerBlock;
+    MaskedSoftmaxWarpKernel<T, kIters><<<blocks, kWarpsPerBlock * kWarpSize, 0, stream>>>(
+        y, x, scale, mask, scale_divide, indexer, rows, cols);
+    return;
+  }
+  constexpr int kNext = kIters * kWarpSize < kMaxWarpCols ? kIters * 2 : kIters;
+  LaunchMaskedSoftmaxWarp<T, kNext>(y, x, scale, mask, scale_divide, indexer, rows, cols, stream);
+}
+
+template <typename T, int kIters>
+void LaunchMaskedSoftmaxBackwardWarp(T* dx, const T* y, const T* dy, const T* scale,
+                                     bool scale_divide, int64_t rows, int cols,
+                                     cudaStream_t stream) {
+  if (kIters * kWarpSize >= cols) {
+    const int64_t blocks = (rows + kWarpsPerBlock - 1) / kWarpsPerBlock;
+    MaskedSoftmaxBackwardWarpKernel<T, kIters><<<blocks, kWarpsPerBlock * kWarpSize, 0, stream>>>(
+        dx, y, dy, scale, scale_divide, rows, cols);
+    return;
+  }
+  constexpr int kNext = kIters * kWarpSize < kMaxWarpCols ? kIters * 2 : kIters;
+  LaunchMaskedSoftmaxBackwardWarp<T, kNext>(dx, y, dy, scale, scale_divide, rows, cols, stream);
+}
+
+}  // namespace
+
+template <typename T>
+void HostMaskedSoftmaxForward(T* y, const T* x, const T* scale, const T* mask, bool scale_divide,
+                              const MaskedSoftmaxIndexer& indexer, int64_t rows, int cols,
+                              void* stream) {
+  if (rows == 0 || cols == 0) {
+    return;
+  }
+  cudaStream_t cu_stream = static_cast<cudaStream_t>(stream);
+  if (cols <= kMaxWarpCols) {
+    LaunchMaskedSoftmaxWarp<T, 1>(y, x, scale, mask, scale_divide, indexer, rows, cols, cu_stream);
+  } else {
+    MaskedSoftmaxBlockKernel<T><<<rows, kBlockSize, 0, cu_stream>>>(y, x, scale, mask,
+                                                                    scale_divide, indexer, cols);
+  }
+  CUDA_CALL(cudaGetLastError());
+}
+
+template <typename T>
+void HostMaskedSoftmaxBackward(T* dx, const T* y, const T* dy, const T* scale, bool scale_divide,
+                               int64_t rows, int cols, void* stream) {
+  if (rows == 0 || cols == 0) {
+    return;
+  }
+  cudaStream_t cu_stream = static_cast<cudaStream_t>(stream);
+  if (cols <= kMaxWarpCols) {
+    LaunchMaskedSoftmaxBackwardWarp<T, 1>(dx, y, dy, scale, scale_divide, rows, cols, cu_stream);
+  } else {
+    MaskedSoftmaxBackwardBlockKernel<T><<<rows, kBlockSize, 0, cu_stream>>>(dx, y, dy, scale,
+                                                                            scale_divide, cols);
+  }
+  CUDA_CALL(cudaGetLastError());
+}
+
+template void HostMaskedSoftmaxForward<Half>(Half* y, const Half* x, const Half* scale,
+                                             const Half* mask, bool scale_divide,
+                                             const MaskedSoftmaxIndexer& indexer, int64_t rows,
+                                             int cols, void* stream);
+template void HostMaskedSoftmaxForward<float>(float* y, const float* x, const float* scale,
+                                              const float* mask, bool scale_divide,
+                                              const MaskedSoftmaxIndexer& indexer, int64_t rows,
+                                              int cols, void* stream);
+template void HostMaskedSoftmaxBackward<Half>(Half* dx, const Half* y, const Half* dy,
+                                              const Half* scale, bool scale_divide, int64_t rows,
+                                              int cols, void* stream);
+template void HostMaskedSoftmaxBackward<float>(float* dx, const float* y, const float* dy,
+                                               const float* scale, bool scale_divide,
+                                               int64_t rows, int cols, void* stream);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,32 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/moments.cuh
+ * \brief Headers of the single-pass CUDA moments kernels
+ */
+#pragma once
+#include <cuda_fp16.h>
+#include <stdint.h>
+#include "./Half.h"
+#include "../../../../common/cuda_utils.h"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+/*!
+ * \brief Compute the mean and the biased variance of x, which is viewed as [outer, reduce, inner],
+ * over the reduce axis in a single Welford pass. The statistics are accumulated in float.
+ * \param x The input of outer * reduce * inner elements.
+ * \param mean The output mean of outer * inner elements.
+ * \param var The output variance of outer * inner elements.
+ */
+template <typename T>
+void HostMoments(const T* x, T* mean, T* var, int outer, int reduce, int inner, void* stream);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,153 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/moments_cuda_kernel.cu
+ * \brief Single-pass moments cuda kernels
+ */
+#include <algorithm>
+#include "./moments.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+using namespace c10;
+
+namespace {
+
+constexpr int kWarpSize = 32;
+constexpr int kRowThreads = 256;
+constexpr int kColumnThreadsX = 32;
+constexpr int kColumnThreadsY = 16;
+constexpr int kMaxGridY = 65535;
+
+/*! \brief The running statistics of Welford's algorithm. */
+struct Welford {
+  float mean;
+  float m2;
+  int count;
+};
+
+__device__ __forceinline__ void WelfordUpdate(Welford* w, float v) {
+  w->count += 1;
+  float delta = v - w->mean;
+  w->mean += delta / w->count;
+  w->m2 += delta * (v - w->mean);
+}
+
+/*! \brief Merge the statistics of two disjoint sets, by Chan et al. */
+__device__ __forceinline__ Welford WelfordCombine(const Welford& a, const Welford& b) {
+  int count = a.count + b.count;
+  if (count == 0) {
+    return a;
+  }
+  float delta = b.mean - a.mean;
+  float ratio = static_cast<float>(b.count) / count;
+  return {a.mean + delta * ratio, a.m2 + b.m2 + delta * delta * a.count * ratio, count};
+}
+
+__device__ __forceinline__ Welford WarpReduce(Welford w) {
+  for (int offset = kWarpSize / 2; offset > 0; offset /= 2) {
+    Welford other;
+    other.mean = __shfl_down_sync(0xffffffff, w.mean, offset);
+    other.m2 = __shfl_down_sync(0xffffffff, w.m2, offset);
+    other.count = __shfl_down_sync(0xffffffff, w.count, offset);
+    w = WelfordCombine(w, other);
+  }
+  return w;
+}
+
+template <typename T>
+__device__ __forceinline__ void StoreMoments(const Welford& w, T* mean, T* var, int64_t i) {
+  mean[i] = static_cast<T>(w.mean);
+  var[i] = static_cast<T>(w.m2 / w.count);
+}
+
+/*!
+ * \brief One block per row when the reduce axis is the innermost, where blockDim.x is a multiple
+ * of the warp size.
+ */
+template <typename T>
+__global__ void RowMomentsKernel(const T* x, T* mean, T* var, int reduce) {
+  __shared__ Welford partial[kRowThreads / kWarpSize];
+  const T* row = x + static_cast<int64_t>(blockIdx.x) * reduce;
+  Welford w{0.f, 0.f, 0};
+  for (int i = threadIdx.x; i < reduce; i += blockDim.x) {
+    WelfordUpdate(&w, static_cast<float>(row[i]));
+  }
+  w = WarpReduce(w);
+  int warp = threadIdx.x / kWarpSize;
+  int lane = threadIdx.x % kWarpSize;
+  if (lane == 0) {
+    partial[warp] = w;
+  }
+  __syncthreads();
+  if (warp == 0) {
+    w = lane < blockDim.x / kWarpSize ? partial[lane] : Welford{0.f, 0.f, 0};
+    w = WarpReduce(w);
+    if (lane == 0) {
+      StoreMoments(w, mean, var, blockIdx.x);
+    }
+  }
+}
+
+/*!
+ * \brief The threads along x read the adjacent columns of the inner axis, so the loads coalesce,
+ * and the threads along y split the reduce axis and are merged in the shared memory.
+ */
+template <typename T>
+__global__ void ColumnMomentsKernel(const T* x, T* mean, T* var, int outer, int reduce,
+                                    int inner) {
+  __shared__ Welford partial[kColumnThreadsY][kColumnThreadsX + 1];
+  int tx = threadIdx.x;
+  int ty = threadIdx.y;
+  int col = blockIdx.x * kColumnThreadsX + tx;
+  for (int o = blockIdx.y; o < outer; o += gridDim.y) {
+    Welford w{0.f, 0.f, 0};
+    if (col < inner) {
+      const T* base = x + static_cast<int64_t>(o) * reduce * inner + col;
+      for (int r = ty; r < reduce; r += kColumnThreadsY) {
+        WelfordUpdate(&w, static_cast<float>(base[static_cast<int64_t>(r) * inner]));
+      }
+    }
+    partial[ty][tx] = w;
+    __syncthreads();
+    for (int stride = kColumnThreadsY / 2; stride > 0; stride /= 2) {
+      if (ty < stride) {
+        partial[ty][tx] = WelfordCombine(partial[ty][tx], partial[ty + stride][tx]);
+      }
+      __syncthreads();
+    }
+    if (ty == 0 && col < inner) {
+      StoreMoments(partial[0][tx], mean, var, static_cast<int64_t>(o) * inner + col);
+    }
+    __syncthreads();
+  }
+}
+
+}  // namespace
+
+template <typename T>
+void HostMoments(const T* x, T* mean, T* var, int outer, int reduce, int inner, void* stream) {
+  cudaStream_t cu_stream = static_cast<cudaStream_t>(stream);
+  if (inner == 1) {
+    int threads = std::min(kRowThreads, (reduce + kWarpSize - 1) / kWarpSize * kWarpSize);
+    RowMomentsKernel<T><<<outer, threads, 0, cu_stream>>>(x, mean, var, reduce);
+  } else {
+    dim3 threads(kColumnThreadsX, kColumnThreadsY);
+    dim3 blocks((inner + kColumnThreadsX - 1) / kColumnThreadsX, std::min(outer, kMaxGridY));
+    ColumnMomentsKernel<T><<<blocks, threads, 0, cu_stream>>>(x, mean, var, outer, reduce, inner);
+  }
+  CUDA_CALL(cudaGetLastError());
+}
+
+template void HostMoments<Half>(const Half* x, Half* mean, Half* var, int outer, int reduce,
+                                int inner, void* stream);
+template void HostMoments<float>(const float* x, float* mean, float* var, int outer, int reduce,
+                                 int inner, void* stream);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
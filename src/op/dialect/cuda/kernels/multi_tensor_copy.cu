@@ -0,0 +1,204 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dispatch/cuda/kernels/multi_tensor_copy.cu
+ * \brief Gather and scatter a list of tensors in a single launch
+ */
+#include <limits>
+#if CUDA_VERSION >= 11000
+#include <cuda_bf16.h>
+#endif
+#include "./kernel_util.cuh"
+#include "./multi_tensor_apply.cuh"
+#define BLOCK_SIZE 512
+#define ILP 4
+#define CHUNK_SIZE 65536
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+template <typename SrcT, typename DstT>
+__device__ __forceinline__ DstT convert(SrcT val, const float scale) {
+  return static_cast<DstT>(static_cast<float>(val) * scale);
+}
+
+// A copy without casting nor scaling is a bitwise copy, so it works for any dtype of the same size.
+template <>
+__device__ __forceinline__ uint8_t convert(uint8_t val, const float scale) {
+  return val;
+}
+
+template <>
+__device__ __forceinline__ uint16_t convert(uint16_t val, const float scale) {
+  return val;
+}
+
+template <>
+__device__ __forceinline__ uint32_t convert(uint32_t val, const float scale) {
+  return val;
+}
+
+template <>
+__device__ __forceinline__ uint64_t convert(uint64_t val, const float scale) {
+  return val;
+}
+
+// Copy the first list of tensors to the second list of tensors, with optional casting and scaling.
+template <typename SrcT, typename DstT>
+struct CopyFunctor {
+  __device__ __forceinline__ void operator()(int chunk_size, TensorListMetadata<2>& tl,
+                                             const float scale) {
+    int tensor_loc = tl.block_to_tensor[blockIdx.x];
+    int chunk_idx = tl.block_to_chunk[blockIdx.x];
+    int n = tl.sizes[tensor_loc];
+
+    const SrcT* src = (const SrcT*)tl.addresses[0][tensor_loc];
+    src += chunk_idx * chunk_size;
+    DstT* dst = (DstT*)tl.addresses[1][tensor_loc];
+    dst += chunk_idx * chunk_size;
+    n -= chunk_idx * chunk_size;
+
+    for (int i_start = 0; i_start < n && i_start < chunk_size; i_start += blockDim.x * ILP) {
+      SrcT r_src[ILP];
+#pragma unroll
+      for (int ii = 0; ii < ILP; ii++) {
+        int i = i_start + threadIdx.x + ii * blockDim.x;
+        if (i < n && i < chunk_size) {
+          r_src[ii] = src[i];
+        }
+      }
+#pragma unroll
+      for (int ii = 0; ii < ILP; ii++) {
+        int i = i_start + threadIdx.x + ii * blockDim.x;
+        if (i < n && i < chunk_size) {
+          dst[i] = convert<SrcT, DstT>(r_src[ii], scale);
+        }
+      }
+    }
+  }
+};
+
+template <typename SrcT, typename DstT>
+void launch_multi_tensor_copy(const std::vector<void*>& tensor_lists,
+                              const std::vector<int>& numels, const float scale, void* stream) {
+  multi_tensor_apply<2>(BLOCK_SIZE, CHUNK_SIZE, tensor_lists, numels, stream,
+                        CopyFunctor<SrcT, DstT>(), scale);
+  CUDA_CALL(cudaGetLastError());
+}
+
+void multi_tensor_copy_nonempty(const std::vector<void*>& tensor_lists,
+                                const std::vector<int>& numels, DLDataType src_dtype,
+                                DLDataType dst_dtype, float scale, void* stream);
+
+void multi_tensor_copy_cuda(const std::vector<void*>& tensor_lists, const std::vector<int>& numels,
+                            DLDataType src_dtype, DLDataType dst_dtype, float scale,
+                            void* stream) {
+  // Skip the empty tensors, which have no chunk to be launched.
+  size_t ntensors = numels.size();
+  std::vector<void*> nonempty_lists[2];
+  std::vector<int> nonempty_numels;
+  for (size_t i = 0; i < ntensors; ++i) {
+    if (numels[i] > 0) {
+      nonempty_lists[0].push_back(tensor_lists[i]);
+      nonempty_lists[1].push_back(tensor_lists[ntensors + i]);
+      nonempty_numels.push_back(numels[i]);
+    }
+  }
+  if (nonempty_numels.empty()) {
+    return;
+  }
+  std::vector<void*> lists = nonempty_lists[0];
+  lists.insert(lists.end(), nonempty_lists[1].begin(), nonempty_lists[1].end());
+  multi_tensor_copy_nonempty(lists, nonempty_numels, src_dtype, dst_dtype, scale, stream);
+}
+
+void multi_tensor_copy_nonempty(const std::vector<void*>& tensor_lists,
+                                const std::vector<int>& numels, DLDataType src_dtype,
+                                DLDataType dst_dtype, float scale, void* stream) {
+  bool same_dtype = src_dtype.code == dst_dtype.code && src_dtype.bits == dst_dtype.bits &&
+                    src_dtype.lanes == dst_dtype.lanes;
+  if (same_dtype && scale == 1.0f) {
+    switch (src_dtype.bits * src_dtype.lanes) {
+      case 8:
+        return launch_multi_tensor_copy<uint8_t, uint8_t>(tensor_lists, numels, scale, stream);
+      case 16:
+        return launch_multi_tensor_copy<uint16_t, uint16_t>(tensor_lists, numels, scale, stream);
+      case 32:
+        return launch_multi_tensor_copy<uint32_t, uint32_t>(tensor_lists, numels, scale, stream);
+      case 64:
+        return launch_multi_tensor_copy<uint64_t, uint64_t>(tensor_lists, numels, scale, stream);
+      default:
+        LOG(FATAL) << "Unsupported dtype with " << src_dtype.bits * src_dtype.lanes << " bits";
+        throw;
+    }
+  }
+#if CUDA_VERSION >= 11000
+  if (src_dtype.code == kDLFloat && src_dtype.bits == 32 && dst_dtype.code == kDLBfloat) {
+    return launch_multi_tensor_copy<float, __nv_bfloat16>(tensor_lists, numels, scale, stream);
+  } else if (src_dtype.code == kDLBfloat && dst_dtype.code == kDLFloat && dst_dtype.bits == 32) {
+    return launch_multi_tensor_copy<__nv_bfloat16, float>(tensor_lists, numels, scale, stream);
+  }
+#endif
+  CHECK(src_dtype.code == kDLFloat && dst_dtype.code == kDLFloat && src_dtype.lanes == 1 &&
+        dst_dtype.lanes == 1)
+      << "Casting and scaling are only supported for float32, float16 and bfloat16";
+  if (src_dtype.bits == 32 && dst_dtype.bits == 32) {
+    launch_multi_tensor_copy<float, float>(tensor_lists, numels, scale, stream);
+  } else if (src_dtype.bits == 32 && dst_dtype.bits == 16) {
+    launch_multi_tensor_copy<float, __half>(tensor_lists, numels, scale, stream);
+  } else if (src_dtype.bits == 16 && dst_dtype.bits == 32) {
+    launch_multi_tensor_copy<__half, float>(tensor_lists, numels, scale, stream);
+  } else if (src_dtype.bits == 16 && dst_dtype.bits == 16) {
+    launch_multi_tensor_copy<__half, __half>(tensor_lists, numels, scale, stream);
+  } else {
+    LOG(FATAL) << "Unsupported casting from float" << static_cast<int>(src_dtype.bits)
+               << " to float" << static_cast<int>(dst_dtype.bits);
+  }
+}
+
+/*! \brief Get the number of elements of a tensor. */
+inline int NumElements(const DLTensor* x) {
+  int64_t numel = 1;
+  for (int i = 0; i < x->ndim; ++i) {
+    numel *= x->shape[i];
+  }
+  CHECK_LE(numel, std::numeric_limits<int>::max()) << "Tensor is too large to be copied";
+  return static_cast<int>(numel);
+}
+
+void multi_tensor_pack_cuda(const std::vector<DLTensor*>& tensors, void* buffer, void* stream) {
+  std::vector<void*> tensor_lists(tensors.size() * 2);
+  std::vector<int> numels(tensors.size());
+  uint8_t* dst = static_cast<uint8_t*>(buffer);
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    numels[i] = NumElements(tensors[i]);
+    tensor_lists[i] = tensors[i]->data;
+    tensor_lists[tensors.size() + i] = dst;
+    dst += static_cast<int64_t>(numels[i]) * ((tensors[i]->dtype.bits + 7) / 8);
+  }
+  DLDataType dtype = tensors[0]->dtype;
+  multi_tensor_copy_cuda(tensor_lists, numels, dtype, dtype, 1.0f, stream);
+}
+
+void multi_tensor_unpack_cuda(const void* buffer, const std::vector<DLTensor*>& tensors,
+                              void* stream) {
+  std::vector<void*> tensor_lists(tensors.size() * 2);
+  std::vector<int> numels(tensors.size());
+  const uint8_t* src = static_cast<const uint8_t*>(buffer);
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    numels[i] = NumElements(tensors[i]);
+    tensor_lists[i] = const_cast<uint8_t*>(src);
+    tensor_lists[tensors.size() + i] = tensors[i]->data;
+    src += static_cast<int64_t>(numels[i]) * ((tensors[i]->dtype.bits + 7) / 8);
+  }
+  DLDataType dtype = tensors[0]->dtype;
+  multi_tensor_copy_cuda(tensor_lists, numels, dtype, dtype, 1.0f, stream);
+}
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -20,12 +20,11 @@ namespace cuda {
 
 template void multi_tensor_lans_cuda<float>(
     int chunk_size, std::vector<float*> tensor_lists, const float lr, const float beta1,
-    const float beta2, const float epsilon, const int bias_correction, const float bias_correction1,
-    const float bias_correction2, const float beta3, const float weight_decay,
-    const int grad_averaging, const int mode, const bool normalize_grad,
-    const std::vector<int> numels, void* stream, float* output_per_tensor, float* grad_norm_tensor,
-    float* param_norm_tensor, float* update_m_norm, float* q_norm_tensor,
-    int max_chunks_per_tensor);
+    const float beta2, const float epsilon, const int bias_correction, const float* step,
+    const float beta3, const float weight_decay, const int grad_averaging, const int mode,
+    const bool normalize_grad, const std::vector<int> numels, void* stream,
+    float* output_per_tensor, float* grad_norm_tensor, float* param_norm_tensor,
+    float* update_m_norm, float* q_norm_tensor, int max_chunks_per_tensor, const float* skip);
 
 typedef enum {
   MOMENT_MODE_0 = 0,  // L2 regularization mode
@@ -204,6 +203,11 @@ void multi_tensor_l2norm_cuda(int chunk_size, std::vector<T*> tensor_lists,
       output_per_tensor, ret_per_tensor, max_chunks_per_tensor);
 }
 
+template void multi_tensor_l2norm_cuda<float>(int, std::vector<float*>, std::vector<int>, float*,
+                                               float*, void*, int);
+template void multi_tensor_l2norm_cuda<__half>(int, std::vector<__half*>, std::vector<int>,
+                                                float*, float*, void*, int);
+
 template<typename T>
 struct LANSStage1Functor
 {
@@ -213,14 +217,22 @@ struct LANSStage1Functor
     const float beta1,
     const float beta2,
     const float beta3,
-    const float beta1_correction,
-    const float beta2_correction,
+    const int bias_correction,
+    const float* step,
     const float epsilon,
     adamMode_t mode,
     const float decay,
     float* per_tensor_grad_norm,
-    bool normalize_grad)
+    bool normalize_grad,
+    const float* skip)
   {
+    // The update is skipped on the device, e.g., the gradients overflowed.
+    if (skip != nullptr && *skip != 0.0f) {
+      return;
+    }
+    // The bias corrections are computed from the step on the device to avoid the host sync.
+    const float beta1_correction = bias_correction == 1 ? 1.0f - powf(beta1, *step) : 1.0f;
+    const float beta2_correction = bias_correction == 1 ? 1.0f - powf(beta2, *step) : 1.0f;
     // I'd like this kernel to propagate infs/nans.
     int tensor_loc = tl.block_to_tensor[blockIdx.x];
     int tensor_num = tl.start_tensor_this_launch + tensor_loc;
@@ -334,8 +346,12 @@ struct LANSStage2Functor
     const float* per_tensor_param_norm,
     const float* per_tensor_update_m_norm,
     const float* per_tensor_update_g_norm,
-    const float learning_rate)
+    const float learning_rate,
+    const float* skip)
   {
+    if (skip != nullptr && *skip != 0.0f) {
+      return;
+    }
     // I'd like this kernel to propagate infs/nans.
 
     int tensor_loc = tl.block_to_tensor[blockIdx.x];
@@ -401,13 +417,12 @@ struct LANSStage2Functor
 template <typename T>
 void multi_tensor_lans_cuda(int chunk_size, std::vector<T*> tensor_lists, const float lr,
                             const float beta1, const float beta2, const float epsilon,
-                            const int bias_correction, const float bias_correction1,
-                            const float bias_correction2, const float beta3,
+                            const int bias_correction, const float* step, const float beta3,
                             const float weight_decay, const int grad_averaging, const int mode,
                             const bool normalize_grad, const std::vector<int> numels, void* stream,
                             float* output_per_tensor, float* grad_norm_tensor,
                             float* param_norm_tensor, float* update_m_norm, float* q_norm_tensor,
-                            int max_chunks_per_tensor) {
+                            int max_chunks_per_tensor, const float* skip) {
   // Master weight and 32bit momentum(potentially changing) is not handled by this
   // So we assume every tensor are all in the same type
 
@@ -427,8 +442,8 @@ void multi_tensor_lans_cuda(int chunk_size, std::vector<T*> tensor_lists, const
   multi_tensor_apply<5>(BLOCK_SIZE, chunk_size, tensor_lists, numels, stream,
                         LANSStage1Functor<float>(), beta1, beta2,
                         beta3,  // 1-beta1 or 1 depends on averaging mode
-                        bias_correction1, bias_correction2, epsilon, (adamMode_t)mode, weight_decay,
-                        grad_norm_tensor, normalize_grad);
+                        bias_correction, step, epsilon, (adamMode_t)mode, weight_decay,
+                        grad_norm_tensor, normalize_grad, skip);
 
   // Compute update norms
   multi_tensor_l2norm_cuda(chunk_size, grad_list, numels, output_per_tensor, update_m_norm, stream,
@@ -444,7 +459,7 @@ void multi_tensor_lans_cuda(int chunk_size, std::vector<T*> tensor_lists, const
 
   multi_tensor_apply<3>(BLOCK_SIZE, chunk_size, grad_q_param_list, numels, stream,
                         LANSStage2Functor<float>(), beta1, beta3, param_norm_tensor, update_m_norm,
-                        q_norm_tensor, lr);
+                        q_norm_tensor, lr, skip);
 
   return;
 }
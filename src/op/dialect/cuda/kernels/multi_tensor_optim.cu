@@ -0,0 +1,419 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/multi_tensor_optim.cu
+ * \brief Fused multi-tensor SGD, AdamW, LAMB, gradient clipping and loss scaling cuda kernels
+ *
+ * Each group of the tensor lists may be float32 or float16, and all math is carried out in
+ * float32. The step counter, the loss scale and the skip flag are read from the device, so no
+ * host synchronization is required.
+ */
+#include <cmath>
+#include "./kernel_util.cuh"
+#include "./multi_tensor_apply.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+namespace {
+
+constexpr int kBlockSize = 512;
+constexpr int kILP = 4;
+constexpr int kMaxDepth = 5;
+
+/*! \brief Whether each list of this launch is float16. */
+struct ListTypes {
+  bool is_half[kMaxDepth];
+};
+
+__device__ __forceinline__ float LoadElem(const void* ptr, int64_t i, bool is_half) {
+  return is_half ? __half2float(static_cast<const __half*>(ptr)[i])
+                 : static_cast<const float*>(ptr)[i];
+}
+
+__device__ __forceinline__ void StoreElem(void* ptr, int64_t i, float val, bool is_half) {
+  if (is_half) {
+    static_cast<__half*>(ptr)[i] = __float2half(val);
+  } else {
+    static_cast<float*>(ptr)[i] = val;
+  }
+}
+
+__device__ __forceinline__ float BiasCorrection(float beta, const float* step, bool enabled) {
+  return enabled ? 1.0f - powf(beta, *step) : 1.0f;
+}
+
+/*!
+ * \brief Load kILP elements of every list of the chunk into the registers, apply the element-wise
+ * update of Op, and store the lists in the store mask of Op back. Nothing is updated when the
+ * optional skip flag on the device is non-zero, e.g., the gradients overflowed.
+ */
+template <int kDepth, typename Op>
+struct ElementwiseFunctor {
+  __device__ __forceinline__ void operator()(int chunk_size, TensorListMetadata<kDepth>& tl,
+                                             ListTypes types, Op op, const float* skip) {
+    if (skip != nullptr && *skip != 0.0f) {
+      return;
+    }
+    const int tensor_loc = tl.block_to_tensor[blockIdx.x];
+    const int chunk_idx = tl.block_to_chunk[blockIdx.x];
+    const int64_t base = static_cast<int64_t>(chunk_idx) * chunk_size;
+    const int n = tl.sizes[tensor_loc] - chunk_idx * chunk_size;
+    op.Setup(tl.start_tensor_this_launch + tensor_loc);
+
+    for (int i_start = 0; i_start < n && i_start < chunk_size; i_start += blockDim.x * kILP) {
+      float r[kILP][kMaxDepth];
+#pragma unroll
+      for (int ii = 0; ii < kILP; ++ii) {
+        const int i = i_start + threadIdx.x + ii * blockDim.x;
+#pragma unroll
+        for (int d = 0; d < kDepth; ++d) {
+          r[ii][d] = (i < n && i < chunk_size)
+                         ? LoadElem(tl.addresses[d][tensor_loc], base + i, types.is_half[d])
+                         : 0.0f;
+        }
+      }
+#pragma unroll
+      for (int ii = 0; ii < kILP; ++ii) {
+        op(r[ii]);
+      }
+#pragma unroll
+      for (int ii = 0; ii < kILP; ++ii) {
+        const int i = i_start + threadIdx.x + ii * blockDim.x;
+        if (i < n && i < chunk_size) {
+#pragma unroll
+          for (int d = 0; d < kDepth; ++d) {
+            if (Op::kStoreMask & (1 << d)) {
+              StoreElem(tl.addresses[d][tensor_loc], base + i, r[ii][d], types.is_half[d]);
+            }
+          }
+        }
+      }
+    }
+  }
+};
+
+/*! \brief The lists are (grad, weight, momentum, [weight copy]). */
+template <bool kCopy>
+struct SgdOp {
+  static constexpr unsigned kStoreMask = kCopy ? 0b1110 : 0b0110;
+  float lr;
+  float mu;
+
+  __device__ __forceinline__ void Setup(int tensor_num) {
+  }
+
+  __device__ __forceinline__ void operator()(float* val) const {
+    val[2] = mu * val[2] + val[0];
+    val[1] -= lr * val[2];
+    if (kCopy) {
+      val[3] = val[1];
+    }
+  }
+};
+
+/*! \brief The lists are (grad, weight, exp_avg, exp_avg_sq, [weight copy]). */
+template <bool kCopy>
+struct AdamWOp {
+  static constexpr unsigned kStoreMask = kCopy ? 0b11110 : 0b01110;
+  const float* step;
+  float lr;
+  float beta1;
+  float beta2;
+  float eps;
+  float weight_decay;
+  bool bias_correction;
+  float bias_correction1;
+  float bias_correction2;
+
+  __device__ __forceinline__ void Setup(int tensor_num) {
+    bias_correction1 = BiasCorrection(beta1, step, bias_correction);
+    bias_correction2 = BiasCorrection(beta2, step, bias_correction);
+  }
+
+  __device__ __forceinline__ void operator()(float* val) const {
+    val[2] = beta1 * val[2] + (1.0f - beta1) * val[0];
+    val[3] = beta2 * val[3] + (1.0f - beta2) * val[0] * val[0];
+    float denom = sqrtf(val[3] / bias_correction2) + eps;
+    val[1] -= lr * (val[2] / bias_correction1 / denom + weight_decay * val[1]);
+    if (kCopy) {
+      val[4] = val[1];
+    }
+  }
+};
+
+/*! \brief The lists are (grad, weight, exp_avg, exp_avg_sq, update). */
+struct LambStage1Op {
+  static constexpr unsigned kStoreMask = 0b11100;
+  const float* step;
+  float beta1;
+  float beta2;
+  float eps;
+  float weight_decay;
+  bool bias_correction;
+  float bias_correction1;
+  float bias_correction2;
+
+  __device__ __forceinline__ void Setup(int tensor_num) {
+    bias_correction1 = BiasCorrection(beta1, step, bias_correction);
+    bias_correction2 = BiasCorrection(beta2, step, bias_correction);
+  }
+
+  __device__ __forceinline__ void operator()(float* val) const {
+    val[2] = beta1 * val[2] + (1.0f - beta1) * val[0];
+    val[3] = beta2 * val[3] + (1.0f - beta2) * val[0] * val[0];
+    float denom = sqrtf(val[3] / bias_correction2) + eps;
+    val[4] = val[2] / bias_correction1 / denom + weight_decay * val[1];
+  }
+};
+
+/*! \brief The lists are (update, weight, [weight copy]). */
+template <bool kCopy>
+struct LambStage2Op {
+  static constexpr unsigned kStoreMask = kCopy ? 0b110 : 0b010;
+  const float* weight_norm;
+  const float* update_norm;
+  float lr;
+  float ratio;
+
+  __device__ __forceinline__ void Setup(int tensor_num) {
+    float w_norm = weight_norm[tensor_num];
+    float u_norm = update_norm[tensor_num];
+    ratio = (w_norm != 0.0f && u_norm != 0.0f) ? lr * (w_norm / u_norm) : lr;
+  }
+
+  __device__ __forceinline__ void operator()(float* val) const {
+    val[1] -= ratio * val[0];
+    if (kCopy) {
+      val[2] = val[1];
+    }
+  }
+};
+
+/*! \brief The list is (tensor), which is scaled by the clip coefficient of the norm. */
+struct ClipOp {
+  static constexpr unsigned kStoreMask = 0b1;
+  const float* norm;
+  float max_norm;
+  float eps;
+  float coef;
+
+  __device__ __forceinline__ void Setup(int tensor_num) {
+    coef = fminf(1.0f, max_norm / (*norm + eps));
+  }
+
+  __device__ __forceinline__ void operator()(float* val) const {
+    val[0] *= coef;
+  }
+};
+
+/*!
+ * \brief The list is (tensor), which is multiplied by the inverse of the loss scale. found_inf is
+ * set once any unscaled element is not finite.
+ */
+struct UnscaleOp {
+  static constexpr unsigned kStoreMask = 0b1;
+  const float* scale;
+  float* found_inf;
+  float inv_scale;
+
+  __device__ __forceinline__ void Setup(int tensor_num) {
+    inv_scale = 1.0f / *scale;
+  }
+
+  __device__ __forceinline__ void operator()(float* val) const {
+    val[0] *= inv_scale;
+    if (!isfinite(val[0])) {
+      *found_inf = 1.0f;
+    }
+  }
+};
+
+/*!
+ * \brief Back off the loss scale and reset the growth tracker on overflow, or grow the scale once
+ * growth_interval steps in a row are finite.
+ */
+__global__ void UpdateLossScaleKernel(float* scale, float* growth_tracker, const float* found_inf,
+                                      float growth_factor, float backoff_factor,
+                                      int growth_interval) {
+  if (*found_inf != 0.0f) {
+    *scale *= backoff_factor;
+    *growth_tracker = 0.0f;
+    return;
+  }
+  float tracker = *growth_tracker + 1.0f;
+  if (tracker >= growth_interval) {
+    float grown = *scale * growth_factor;
+    if (isfinite(grown)) {
+      *scale = grown;
+    }
+    tracker = 0.0f;
+  }
+  *growth_tracker = tracker;
+}
+
+/*! \brief Reduce the norms of the tensors into the global norm by a single block. */
+__global__ void GlobalNormKernel(const float* norms, int ntensors, float* global_norm) {
+  __shared__ float partial[kBlockSize / 32];
+  float val = 0.0f;
+  for (int i = threadIdx.x; i < ntensors; i += blockDim.x) {
+    val += norms[i] * norms[i];
+  }
+  for (int offset = 16; offset > 0; offset /= 2) {
+    val += __shfl_down_sync(0xffffffff, val, offset);
+  }
+  if (threadIdx.x % 32 == 0) {
+    partial[threadIdx.x / 32] = val;
+  }
+  __syncthreads();
+  if (threadIdx.x < 32) {
+    val = threadIdx.x < blockDim.x / 32 ? partial[threadIdx.x] : 0.0f;
+    for (int offset = 16; offset > 0; offset /= 2) {
+      val += __shfl_down_sync(0xffffffff, val, offset);
+    }
+    if (threadIdx.x == 0) {
+      *global_norm = sqrtf(val);
+    }
+  }
+}
+
+template <int kDepth, typename Op>
+void ApplyElementwise(const std::vector<void*>& tensor_lists, const std::vector<int>& numels,
+                      const std::vector<bool>& is_half, Op op, void* stream,
+                      const float* skip = nullptr) {
+  CHECK_EQ(tensor_lists.size(), kDepth * numels.size());
+  CHECK_EQ(is_half.size(), kDepth);
+  ListTypes types;
+  for (int d = 0; d < kMaxDepth; ++d) {
+    types.is_half[d] = d < kDepth && is_half[d];
+  }
+  multi_tensor_apply<kDepth>(kBlockSize, kMultiTensorChunkSize, tensor_lists, numels, stream,
+                             ElementwiseFunctor<kDepth, Op>(), types, op, skip);
+}
+
+template <typename T>
+void L2Norm(const std::vector<void*>& tensor_lists, const std::vector<int>& numels,
+            float* output_per_tensor, float* norm, int max_chunks_per_tensor, void* stream) {
+  std::vector<T*> lists;
+  for (void* ptr : tensor_lists) {
+    lists.push_back(static_cast<T*>(ptr));
+  }
+  multi_tensor_l2norm_cuda<T>(kMultiTensorChunkSize, lists, numels, output_per_tensor, norm,
+                              stream, max_chunks_per_tensor);
+}
+
+}  // namespace
+
+void multi_tensor_sgd_cuda(const std::vector<void*>& tensor_lists, const std::vector<int>& numels,
+                           const std::vector<bool>& is_half, bool with_copy, float lr, float mu,
+                           const float* skip, void* stream) {
+  if (with_copy) {
+    ApplyElementwise<4>(tensor_lists, numels, is_half, SgdOp<true>{lr, mu}, stream, skip);
+  } else {
+    ApplyElementwise<3>(tensor_lists, numels, is_half, SgdOp<false>{lr, mu}, stream, skip);
+  }
+}
+
+void multi_tensor_adamw_cuda(const std::vector<void*>& tensor_lists,
+                             const std::vector<int>& numels, const std::vector<bool>& is_half,
+                             bool with_copy, const float* step, float lr, float beta1, float beta2,
+                             float eps, float weight_decay, bool bias_correction,
+                             const float* skip, void* stream) {
+  if (with_copy) {
+    AdamWOp<true> op{step, lr, beta1, beta2, eps, weight_decay, bias_correction, 1.0f, 1.0f};
+    ApplyElementwise<5>(tensor_lists, numels, is_half, op, stream, skip);
+  } else {
+    AdamWOp<false> op{step, lr, beta1, beta2, eps, weight_decay, bias_correction, 1.0f, 1.0f};
+    ApplyElementwise<4>(tensor_lists, numels, is_half, op, stream, skip);
+  }
+}
+
+void multi_tensor_lamb_cuda(const std::vector<void*>& tensor_lists,
+                            const std::vector<int>& numels, const std::vector<bool>& is_half,
+                            bool with_copy, const float* step, float lr, float beta1, float beta2,
+                            float eps, float weight_decay, bool bias_correction, float* update,
+                            float* output_per_tensor, float* weight_norm, float* update_norm,
+                            int max_chunks_per_tensor, const float* skip, void* stream) {
+  const int n = numels.size();
+  auto group = [&](int g) {
+    return std::vector<void*>(tensor_lists.begin() + g * n, tensor_lists.begin() + (g + 1) * n);
+  };
+  std::vector<void*> updates;
+  int64_t offset = 0;
+  for (int numel : numels) {
+    updates.push_back(update + offset);
+    offset += numel;
+  }
+
+  // Stage 1: update the moments and compute the Adam update with the decoupled weight decay.
+  std::vector<void*> stage1(tensor_lists.begin(), tensor_lists.begin() + 4 * n);
+  stage1.insert(stage1.end(), updates.begin(), updates.end());
+  LambStage1Op op1{step, beta1, beta2, eps, weight_decay, bias_correction, 1.0f, 1.0f};
+  ApplyElementwise<5>(stage1, numels, {is_half[0], is_half[1], is_half[2], is_half[3], false}, op1,
+                      stream, skip);
+
+  // Per-tensor norms of the weights and the updates for the trust ratios.
+  if (is_half[1]) {
+    L2Norm<__half>(group(1), numels, output_per_tensor, weight_norm, max_chunks_per_tensor,
+                   stream);
+  } else {
+    L2Norm<float>(group(1), numels, output_per_tensor, weight_norm, max_chunks_per_tensor, stream);
+  }
+  L2Norm<float>(updates, numels, output_per_tensor, update_norm, max_chunks_per_tensor, stream);
+
+  // Stage 2: scale the update by the trust ratio and apply it.
+  std::vector<void*> stage2(updates);
+  std::vector<void*> weights = group(1);
+  stage2.insert(stage2.end(), weights.begin(), weights.end());
+  if (with_copy) {
+    std::vector<void*> copies = group(4);
+    stage2.insert(stage2.end(), copies.begin(), copies.end());
+    LambStage2Op<true> op2{weight_norm, update_norm, lr, lr};
+    ApplyElementwise<3>(stage2, numels, {false, is_half[1], is_half[4]}, op2, stream, skip);
+  } else {
+    LambStage2Op<false> op2{weight_norm, update_norm, lr, lr};
+    ApplyElementwise<2>(stage2, numels, {false, is_half[1]}, op2, stream, skip);
+  }
+}
+
+void multi_tensor_norms_cuda(const std::vector<void*>& tensor_list, const std::vector<int>& numels,
+                             bool is_half, float* output_per_tensor, float* norms,
+                             float* global_norm, int max_chunks_per_tensor, void* stream) {
+  if (is_half) {
+    L2Norm<__half>(tensor_list, numels, output_per_tensor, norms, max_chunks_per_tensor, stream);
+  } else {
+    L2Norm<float>(tensor_list, numels, output_per_tensor, norms, max_chunks_per_tensor, stream);
+  }
+  GlobalNormKernel<<<1, kBlockSize, 0, static_cast<cudaStream_t>(stream)>>>(
+      norms, numels.size(), global_norm);
+  CUDA_CALL(cudaGetLastError());
+}
+
+void multi_tensor_clip_cuda(const std::vector<void*>& tensor_list, const std::vector<int>& numels,
+                            bool is_half, const float* norm, float max_norm, float eps,
+                            void* stream) {
+  ApplyElementwise<1>(tensor_list, numels, {is_half}, ClipOp{norm, max_norm, eps, 1.0f}, stream);
+}
+
+void multi_tensor_unscale_cuda(const std::vector<void*>& tensor_list,
+                               const std::vector<int>& numels, bool is_half, const float* scale,
+                               float* found_inf, void* stream) {
+  CUDA_CALL(cudaMemsetAsync(found_inf, 0, sizeof(float), static_cast<cudaStream_t>(stream)));
+  ApplyElementwise<1>(tensor_list, numels, {is_half}, UnscaleOp{scale, found_inf, 1.0f}, stream);
+}
+
+void update_loss_scale_cuda(float* scale, float* growth_tracker, const float* found_inf,
+                            float growth_factor, float backoff_factor, int growth_interval,
+                            void* stream) {
+  UpdateLossScaleKernel<<<1, 1, 0, static_cast<cudaStream_t>(stream)>>>(
+      scale, growth_tracker, found_inf, growth_factor, backoff_factor, growth_interval);
+  CUDA_CALL(cudaGetLastError());
+}
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
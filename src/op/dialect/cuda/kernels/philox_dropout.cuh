@@ -0,0 +1,33 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/philox_dropout.cuh
+ * \brief Headers of CUDA Philox dropout kernels
+ */
+#pragma once
+#include <cuda_fp16.h>
+#include <stdint.h>
+#include "./Half.h"
+#include "../../../../common/cuda_utils.h"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+/*!
+ * \brief y = dropout(x + bias) + residual, where the mask is generated by Philox4x32-10 from the
+ * key of (seed, offset) on the device. Element i takes the (i % 4)-th output of the Philox call on
+ * the counter (i / 4, offset), so the backward regenerates the same mask from the key. The bias is
+ * broadcast along the trailing dims of x and has bias_size elements. The bias and the residual are
+ * optional, and the backward is the same kernel on dy without them.
+ */
+template <typename T>
+void HostPhiloxDropout(T* y, const T* x, const T* bias, const T* residual, const uint64_t* key,
+                       double p, int64_t n, int64_t bias_size, void* stream);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
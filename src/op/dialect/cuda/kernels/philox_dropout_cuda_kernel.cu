@@ -0,0 +1,100 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/philox_dropout_cuda_kernel.cu
+ * \brief Philox dropout cuda kernels
+ */
+#include <algorithm>
+#include "./philox_dropout.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+using namespace c10;
+
+namespace {
+
+constexpr int kBlockSize = 256;
+constexpr int kMaxBlocks = 4096;
+
+/*! \brief The Philox4x32-10 counter-based RNG, which is the same as the TVM compute. */
+__device__ __forceinline__ uint4 Philox(uint4 ctr, uint2 key) {
+#pragma unroll
+  for (int r = 0; r < 10; ++r) {
+    if (r > 0) {
+      key.x += 0x9E3779B9U;
+      key.y += 0xBB67AE85U;
+    }
+    uint32_t hi0 = __umulhi(0xD2511F53U, ctr.x);
+    uint32_t lo0 = 0xD2511F53U * ctr.x;
+    uint32_t hi1 = __umulhi(0xCD9E8D57U, ctr.z);
+    uint32_t lo1 = 0xCD9E8D57U * ctr.z;
+    ctr = make_uint4(hi1 ^ ctr.y ^ key.x, lo1, hi0 ^ ctr.w ^ key.y, lo0);
+  }
+  return ctr;
+}
+
+template <typename T>
+__global__ void PhiloxDropoutKernel(T* y, const T* x, const T* bias, const T* residual,
+                                    const uint64_t* key, float p, float scale, int64_t n,
+                                    int64_t bias_size) {
+  const uint64_t seed = key[0];
+  const uint64_t offset = key[1];
+  const uint2 philox_key =
+      make_uint2(static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32));
+  const int64_t num_groups = (n + 3) / 4;
+  for (int64_t g = blockIdx.x * static_cast<int64_t>(blockDim.x) + threadIdx.x; g < num_groups;
+       g += static_cast<int64_t>(gridDim.x) * blockDim.x) {
+    uint4 ctr = make_uint4(static_cast<uint32_t>(g), static_cast<uint32_t>(g >> 32),
+                           static_cast<uint32_t>(offset), static_cast<uint32_t>(offset >> 32));
+    uint4 out = Philox(ctr, philox_key);
+    uint32_t bits[4] = {out.x, out.y, out.z, out.w};
+#pragma unroll
+    for (int j = 0; j < 4; ++j) {
+      int64_t i = g * 4 + j;
+      if (i < n) {
+        float v = static_cast<float>(x[i]);
+        if (bias != nullptr) {
+          v += static_cast<float>(bias[i % bias_size]);
+        }
+        // The top 24 bits are exact in float32.
+        float uniform = static_cast<float>(bits[j] >> 8) * (1.0f / 16777216.0f);
+        v = uniform >= p ? v * scale : 0.0f;
+        if (residual != nullptr) {
+          v += static_cast<float>(residual[i]);
+        }
+        y[i] = static_cast<T>(v);
+      }
+    }
+  }
+}
+
+}  // namespace
+
+template <typename T>
+void HostPhiloxDropout(T* y, const T* x, const T* bias, const T* residual, const uint64_t* key,
+                       double p, int64_t n, int64_t bias_size, void* stream) {
+  if (n == 0) {
+    return;
+  }
+  int64_t num_groups = (n + 3) / 4;
+  int blocks = static_cast<int>(
+      std::min<int64_t>((num_groups + kBlockSize - 1) / kBlockSize, kMaxBlocks));
+  PhiloxDropoutKernel<T><<<blocks, kBlockSize, 0, static_cast<cudaStream_t>(stream)>>>(
+      y, x, bias, residual, key, static_cast<float>(p), static_cast<float>(1.0 / (1.0 - p)), n,
+      bias_size);
+}
+
+template void HostPhiloxDropout<Half>(Half* y, const Half* x, const Half* bias,
+                                      const Half* residual, const uint64_t* key, double p,
+                                      int64_t n, int64_t bias_size, void* stream);
+template void HostPhiloxDropout<float>(float* y, const float* x, const float* bias,
+                                       const float* residual, const uint64_t* key, double p,
+                                       int64_t n, int64_t bias_size, void* stream);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
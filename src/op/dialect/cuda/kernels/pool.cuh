@@ -0,0 +1,52 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/pool.cuh
+ * \brief Headers of the global and NHWC pooling CUDA kernels
+ */
+#pragma once
+#include <cuda_fp16.h>
+#include <stdint.h>
+#include "./Half.h"
+#include "../../../../common/cuda_utils.h"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+/*!
+ * \brief The pooling windows of the output (oh, ow), where the window of the adaptive pooling
+ * is [floor(oh * h / out_h), ceil((oh + 1) * h / out_h)), and the window of the others starts
+ * at oh * stride_h - pad_top with kernel_h rows, clipped to [0, h + pad_bottom) for the divisor
+ * that includes the padding and to [0, h) for the rows to read. The same holds for the columns.
+ */
+struct PoolWindow {
+  int kernel_h, kernel_w;
+  int stride_h, stride_w;
+  int pad_top, pad_left, pad_bottom, pad_right;
+  bool adaptive;
+  bool include_pad;
+};
+
+/*!
+ * \brief The global max or average pooling of x, which reduces the hw elements of each of the
+ * n * c channels. If nhwc, x is [n, hw, c] and each thread reduces the adjacent channels with
+ * vectorized loads; otherwise x is [n * c, hw] and each row is reduced by a warp.
+ */
+template <typename T>
+void HostGlobalPool(const T* x, T* y, int n, int c, int hw, bool nhwc, bool is_max, void* stream);
+
+/*!
+ * \brief The max or average pooling of x in NHWC to y of [n, out_h, out_w, c], where each thread
+ * computes the adjacent channels of an output pixel with vectorized loads.
+ */
+template <typename T>
+void HostPool2dNHWC(const T* x, T* y, int n, int h, int w, int c, int out_h, int out_w,
+                    const PoolWindow& window, bool is_max, void* stream);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
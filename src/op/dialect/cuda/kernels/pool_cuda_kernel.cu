@@ -0,0 +1,240 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/pool_cuda_kernel.cu
+ * \brief Global and NHWC pooling cuda kernels
+ */
+#include <algorithm>
+#include <cfloat>
+#include "./pool.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+using namespace c10;
+
+namespace {
+
+constexpr int kWarpSize = 32;
+constexpr int kThreads = 256;
+constexpr int kVecBytes = 16;
+constexpr int kMaxBlocks = 65535;
+
+/*! \brief The vector of VEC elements, which is loaded by a single instruction. */
+template <typename T, int VEC>
+struct alignas(sizeof(T) * VEC) Vec {
+  T val[VEC];
+};
+
+template <bool IS_MAX>
+__device__ __forceinline__ float Init() {
+  return IS_MAX ? -FLT_MAX : 0.f;
+}
+
+template <bool IS_MAX>
+__device__ __forceinline__ float Reduce(float a, float b) {
+  return IS_MAX ? fmaxf(a, b) : a + b;
+}
+
+/*! \brief Each warp reduces a row of hw elements, whose loads are vectorized by VEC. */
+template <typename T, int VEC, bool IS_MAX>
+__global__ void GlobalPoolRowKernel(const T* x, T* y, int64_t rows, int hw) {
+  int lane = threadIdx.x % kWarpSize;
+  int64_t row = static_cast<int64_t>(blockIdx.x) * (blockDim.x / kWarpSize) +
+                threadIdx.x / kWarpSize;
+  if (row >= rows) {
+    return;
+  }
+  const Vec<T, VEC>* src = reinterpret_cast<const Vec<T, VEC>*>(x + row * hw);
+  float acc = Init<IS_MAX>();
+  for (int i = lane; i < hw / VEC; i += kWarpSize) {
+    Vec<T, VEC> v = src[i];
+#pragma unroll
+    for (int k = 0; k < VEC; ++k) {
+      acc = Reduce<IS_MAX>(acc, static_cast<float>(v.val[k]));
+    }
+  }
+  for (int offset = kWarpSize / 2; offset > 0; offset /= 2) {
+    acc = Reduce<IS_MAX>(acc, __shfl_down_sync(0xffffffff, acc, offset));
+  }
+  if (lane == 0) {
+    y[row] = static_cast<T>(IS_MAX ? acc : acc / hw);
+  }
+}
+
+/*! \brief Each thread reduces VEC adjacent channels of an image over its hw pixels. */
+template <typename T, int VEC, bool IS_MAX>
+__global__ void GlobalPoolChannelKernel(const T* x, T* y, int n, int c, int hw) {
+  int groups = c / VEC;
+  int64_t idx = static_cast<int64_t>(blockIdx.x) * blockDim.x + threadIdx.x;
+  if (idx >= static_cast<int64_t>(n) * groups) {
+    return;
+  }
+  int64_t ni = idx / groups;
+  int g = idx % groups;
+  const T* base = x + ni * hw * c + g * VEC;
+  float acc[VEC];
+#pragma unroll
+  for (int k = 0; k < VEC; ++k) {
+    acc[k] = Init<IS_MAX>();
+  }
+  for (int p = 0; p < hw; ++p) {
+    Vec<T, VEC> v = *reinterpret_cast<const Vec<T, VEC>*>(base + static_cast<int64_t>(p) * c);
+#pragma unroll
+    for (int k = 0; k < VEC; ++k) {
+      acc[k] = Reduce<IS_MAX>(acc[k], static_cast<float>(v.val[k]));
+    }
+  }
+  Vec<T, VEC> out;
+#pragma unroll
+  for (int k = 0; k < VEC; ++k) {
+    out.val[k] = static_cast<T>(IS_MAX ? acc[k] : acc[k] / hw);
+  }
+  *reinterpret_cast<Vec<T, VEC>*>(y + ni * c + g * VEC) = out;
+}
+
+/*! \brief Resolve the window [begin, end) of the output index o along an axis. */
+__device__ __forceinline__ void GetWindow(int o, int size, int out_size, int kernel, int stride,
+                                          int pad_begin, int pad_end, bool adaptive, int* begin,
+                                          int* end, int* padded) {
+  if (adaptive) {
+    *begin = o * size / out_size;
+    *end = ((o + 1) * size + out_size - 1) / out_size;
+    *padded = *end - *begin;
+    return;
+  }
+  int b = o * stride - pad_begin;
+  int e = min(b + kernel, size + pad_end);
+  *padded = e - b;
+  *begin = max(b, 0);
+  *end = min(e, size);
+}
+
+/*! \brief Each thread computes VEC adjacent channels of an output pixel. */
+template <typename T, int VEC, bool IS_MAX>
+__global__ void Pool2dNHWCKernel(const T* x, T* y, int n, int h, int w, int c, int out_h,
+                                 int out_w, PoolWindow window) {
+  int groups = c / VEC;
+  int64_t total = static_cast<int64_t>(n) * out_h * out_w * groups;
+  int64_t stride = static_cast<int64_t>(gridDim.x) * blockDim.x;
+  for (int64_t idx = static_cast<int64_t>(blockIdx.x) * blockDim.x + threadIdx.x; idx < total;
+       idx += stride) {
+    int g = idx % groups;
+    int64_t pixel = idx / groups;
+    int ow = pixel % out_w;
+    int oh = (pixel / out_w) % out_h;
+    int64_t ni = pixel / (static_cast<int64_t>(out_w) * out_h);
+    int hs, he, hp, ws, we, wp;
+    GetWindow(oh, h, out_h, window.kernel_h, window.stride_h, window.pad_top, window.pad_bottom,
+              window.adaptive, &hs, &he, &hp);
+    GetWindow(ow, w, out_w, window.kernel_w, window.stride_w, window.pad_left, window.pad_right,
+              window.adaptive, &ws, &we, &wp);
+    float acc[VEC];
+#pragma unroll
+    for (int k = 0; k < VEC; ++k) {
+      acc[k] = Init<IS_MAX>();
+    }
+    const T* base = x + ni * h * w * c + g * VEC;
+    for (int ih = hs; ih < he; ++ih) {
+      for (int iw = ws; iw < we; ++iw) {
+        Vec<T, VEC> v = *reinterpret_cast<const Vec<T, VEC>*>(
+            base + (static_cast<int64_t>(ih) * w + iw) * c);
+#pragma unroll
+        for (int k = 0; k < VEC; ++k) {
+          acc[k] = Reduce<IS_MAX>(acc[k], static_cast<float>(v.val[k]));
+        }
+      }
+    }
+    float divisor = window.include_pad ? hp * wp : (he - hs) * (we - ws);
+    Vec<T, VEC> out;
+#pragma unroll
+    for (int k = 0; k < VEC; ++k) {
+      out.val[k] = static_cast<T>(IS_MAX ? acc[k] : acc[k] / divisor);
+    }
+    *reinterpret_cast<Vec<T, VEC>*>(y + pixel * c + g * VEC) = out;
+  }
+}
+
+/*! \brief The widest vector of T that divides the units and keeps the pointers aligned. */
+template <typename T>
+int GetVecSize(int units, const void* x, const void* y) {
+  constexpr int max_vec = kVecBytes / sizeof(T);
+  bool aligned = reinterpret_cast<uintptr_t>(x) % kVecBytes == 0 &&
+                 reinterpret_cast<uintptr_t>(y) % kVecBytes == 0;
+  return aligned && units % max_vec == 0 ? max_vec : 1;
+}
+
+template <typename T, int VEC, bool IS_MAX>
+void LaunchGlobalPool(const T* x, T* y, int n, int c, int hw, bool nhwc, cudaStream_t stream) {
+  if (nhwc) {
+    int64_t threads = static_cast<int64_t>(n) * (c / VEC);
+    int blocks = static_cast<int>((threads + kThreads - 1) / kThreads);
+    GlobalPoolChannelKernel<T, VEC, IS_MAX><<<blocks, kThreads, 0, stream>>>(x, y, n, c, hw);
+  } else {
+    int64_t rows = static_cast<int64_t>(n) * c;
+    int rows_per_block = kThreads / kWarpSize;
+    int blocks = static_cast<int>((rows + rows_per_block - 1) / rows_per_block);
+    GlobalPoolRowKernel<T, VEC, IS_MAX><<<blocks, kThreads, 0, stream>>>(x, y, rows, hw);
+  }
+}
+
+template <typename T, int VEC, bool IS_MAX>
+void LaunchPool2dNHWC(const T* x, T* y, int n, int h, int w, int c, int out_h, int out_w,
+                      const PoolWindow& window, cudaStream_t stream) {
+  int64_t total = static_cast<int64_t>(n) * out_h * out_w * (c / VEC);
+  int blocks = static_cast<int>(std::min<int64_t>((total + kThreads - 1) / kThreads, kMaxBlocks));
+  Pool2dNHWCKernel<T, VEC, IS_MAX>
+      <<<blocks, kThreads, 0, stream>>>(x, y, n, h, w, c, out_h, out_w, window);
+}
+
+}  // namespace
+
+template <typename T>
+void HostGlobalPool(const T* x, T* y, int n, int c, int hw, bool nhwc, bool is_max, void* stream) {
+  constexpr int max_vec = kVecBytes / sizeof(T);
+  cudaStream_t cu_stream = static_cast<cudaStream_t>(stream);
+  // The channels are vectorized in NHWC, and the pixels of a channel in NCHW.
+  bool vec = GetVecSize<T>(nhwc ? c : hw, x, nhwc ? y : x) == max_vec;
+  if (is_max) {
+    vec ? LaunchGlobalPool<T, max_vec, true>(x, y, n, c, hw, nhwc, cu_stream)
+        : LaunchGlobalPool<T, 1, true>(x, y, n, c, hw, nhwc, cu_stream);
+  } else {
+    vec ? LaunchGlobalPool<T, max_vec, false>(x, y, n, c, hw, nhwc, cu_stream)
+        : LaunchGlobalPool<T, 1, false>(x, y, n, c, hw, nhwc, cu_stream);
+  }
+  CUDA_CALL(cudaGetLastError());
+}
+
+template <typename T>
+void HostPool2dNHWC(const T* x, T* y, int n, int h, int w, int c, int out_h, int out_w,
+                    const PoolWindow& window, bool is_max, void* stream) {
+  constexpr int max_vec = kVecBytes / sizeof(T);
+  cudaStream_t cu_stream = static_cast<cudaStream_t>(stream);
+  bool vec = GetVecSize<T>(c, x, y) == max_vec;
+  if (is_max) {
+    vec ? LaunchPool2dNHWC<T, max_vec, true>(x, y, n, h, w, c, out_h, out_w, window, cu_stream)
+        : LaunchPool2dNHWC<T, 1, true>(x, y, n, h, w, c, out_h, out_w, window, cu_stream);
+  } else {
+    vec ? LaunchPool2dNHWC<T, max_vec, false>(x, y, n, h, w, c, out_h, out_w, window, cu_stream)
+        : LaunchPool2dNHWC<T, 1, false>(x, y, n, h, w, c, out_h, out_w, window, cu_stream);
+  }
+  CUDA_CALL(cudaGetLastError());
+}
+
+template void HostGlobalPool<Half>(const Half* x, Half* y, int n, int c, int hw, bool nhwc,
+                                   bool is_max, void* stream);
+template void HostGlobalPool<float>(const float* x, float* y, int n, int c, int hw, bool nhwc,
+                                    bool is_max, void* stream);
+template void HostPool2dNHWC<Half>(const Half* x, Half* y, int n, int h, int w, int c, int out_h,
+                                   int out_w, const PoolWindow& window, bool is_max,
+                                   void* stream);
+template void HostPool2dNHWC<float>(const float* x, float* y, int n, int h, int w, int c,
+                                    int out_h, int out_w, const PoolWindow& window, bool is_max,
+                                    void* stream);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,42 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/scan.cuh
+ * \brief Headers of CUDA prefix sum kernels
+ */
+#pragma once
+#include <cuda_fp16.h>
+#include <stdint.h>
+#include "./Half.h"
+#include "../../../../common/cuda_utils.h"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+/*!
+ * \brief The workspace bytes of HostCumsum.
+ * \param outer The product of the dims before the scanned axis.
+ * \param length The length of the scanned axis.
+ * \param inner The product of the dims after the scanned axis.
+ */
+template <typename T>
+size_t CumsumWorkspaceBytes(int64_t outer, int64_t length, int64_t inner);
+
+/*!
+ * \brief The prefix sum of x along an axis, where x is viewed as [outer, length, inner]. A single
+ * scan is done by the decoupled look-back scan of CUB. Multiple scans along the innermost axis
+ * are done by a block per row, which carries the prefix from tile to tile. Otherwise each thread
+ * scans a column, so the threads of a warp read the adjacent elements. The half precision is
+ * accumulated in float.
+ */
+template <typename T>
+void HostCumsum(const T* x, T* y, int64_t outer, int64_t length, int64_t inner, bool exclusive,
+                void* workspace, void* stream);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
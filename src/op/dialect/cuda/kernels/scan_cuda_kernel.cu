@@ -0,0 +1,206 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/scan_cuda_kernel.cu
+ * \brief Prefix sum cuda kernels
+ */
+#include <algorithm>
+#include <type_traits>
+#include <cub/cub.cuh>
+#include "./scan.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+using namespace c10;
+
+namespace {
+
+constexpr int kBlockSize = 256;
+constexpr int kMaxBlocks = 4096;
+constexpr int kItemsPerThread = 4;
+constexpr int kTileSize = kBlockSize * kItemsPerThread;
+constexpr size_t kWorkspaceAlign = 256;
+
+inline size_t AlignUp(size_t bytes) {
+  return (bytes + kWorkspaceAlign - 1) / kWorkspaceAlign * kWorkspaceAlign;
+}
+
+/*! \brief The accumulator type of the prefix sum. */
+template <typename T>
+struct ScanAcc {
+  using type = T;
+};
+
+template <>
+struct ScanAcc<Half> {
+  using type = float;
+};
+
+template <typename AccT>
+struct CastOp {
+  template <typename T>
+  __host__ __device__ __forceinline__ AccT operator()(const T& value) const {
+    return static_cast<AccT>(value);
+  }
+};
+
+/*! \brief Carry the sum of the previous tiles of a row, which is called by the first warp. */
+template <typename AccT>
+struct RunningPrefix {
+  AccT total;
+  __device__ __forceinline__ AccT operator()(AccT tile_sum) {
+    AccT prefix = total;
+    total += tile_sum;
+    return prefix;
+  }
+};
+
+template <typename T, typename AccT>
+cudaError_t CubScan(void* temp, size_t& temp_bytes, const T* x, AccT* y, int n, bool exclusive,
+                    cudaStream_t stream) {
+  cub::TransformInputIterator<AccT, CastOp<AccT>, const T*> in(x, CastOp<AccT>());
+  return exclusive ? cub::DeviceScan::ExclusiveSum(temp, temp_bytes, in, y, n, stream)
+                   : cub::DeviceScan::InclusiveSum(temp, temp_bytes, in, y, n, stream);
+}
+
+template <typename T, typename AccT>
+__global__ void CastKernel(const AccT* x, T* y, int64_t n) {
+  for (int64_t i = blockIdx.x * static_cast<int64_t>(blockDim.x) + threadIdx.x; i < n;
+       i += static_cast<int64_t>(gridDim.x) * blockDim.x) {
+    y[i] = static_cast<T>(x[i]);
+  }
+}
+
+/*! \brief Each block scans a contiguous row at a time by tiles of kTileSize. */
+template <typename T, typename AccT>
+__global__ void RowScanKernel(const T* __restrict__ x, T* __restrict__ y, int64_t num_rows,
+                              int64_t length, bool exclusive) {
+  using BlockScan = cub::BlockScan<AccT, kBlockSize>;
+  __shared__ typename BlockScan::TempStorage temp;
+  for (int64_t row = blockIdx.x; row < num_rows; row += gridDim.x) {
+    const T* in = x + row * length;
+    T* out = y + row * length;
+    RunningPrefix<AccT> prefix{AccT(0)};
+    for (int64_t base = 0; base < length; base += kTileSize) {
+      AccT items[kItemsPerThread];
+#pragma unroll
+      for (int i = 0; i < kItemsPerThread; ++i) {
+        int64_t index = base + threadIdx.x * kItemsPerThread + i;
+        items[i] = index < length ? static_cast<AccT>(in[index]) : AccT(0);
+      }
+      if (exclusive) {
+        BlockScan(temp).ExclusiveSum(items, items, prefix);
+      } else {
+        BlockScan(temp).InclusiveSum(items, items, prefix);
+      }
+      // The temp storage is reused by the next tile.
+      __syncthreads();
+#pragma unroll
+      for (int i = 0; i < kItemsPerThread; ++i) {
+        int64_t index = base + threadIdx.x * kItemsPerThread + i;
+        if (index < length) {
+          out[index] = static_cast<T>(items[i]);
+        }
+      }
+    }
+  }
+}
+
+/*! \brief Each thread scans a column of stride inner, and a warp reads the adjacent columns. */
+template <typename T, typename AccT>
+__global__ void ColumnScanKernel(const T* __restrict__ x, T* __restrict__ y, int64_t outer,
+                                 int64_t length, int64_t inner, bool exclusive) {
+  for (int64_t i = blockIdx.x * static_cast<int64_t>(blockDim.x) + threadIdx.x; i < outer * inner;
+       i += static_cast<int64_t>(gridDim.x) * blockDim.x) {
+    int64_t offset = i / inner * length * inner + i % inner;
+    AccT total = AccT(0);
+    for (int64_t k = 0; k < length; ++k, offset += inner) {
+      AccT value = static_cast<AccT>(x[offset]);
+      if (exclusive) {
+        y[offset] = static_cast<T>(total);
+        total += value;
+      } else {
+        total += value;
+        y[offset] = static_cast<T>(total);
+      }
+    }
+  }
+}
+
+inline int NumBlocks(int64_t n) {
+  return static_cast<int>(std::max<int64_t>(
+      1, std::min<int64_t>((n + kBlockSize - 1) / kBlockSize, kMaxBlocks)));
+}
+
+}  // namespace
+
+template <typename T>
+size_t CumsumWorkspaceBytes(int64_t outer, int64_t length, int64_t inner) {
+  using AccT = typename ScanAcc<T>::type;
+  if (outer != 1 || inner != 1) {
+    return 0;
+  }
+  size_t temp_bytes = 0;
+  CUDA_CALL(CubScan<T, AccT>(nullptr, temp_bytes, static_cast<const T*>(nullptr),
+                             static_cast<AccT*>(nullptr), static_cast<int>(length), false,
+                             nullptr));
+  size_t exclusive_bytes = 0;
+  CUDA_CALL(CubScan<T, AccT>(nullptr, exclusive_bytes, static_cast<const T*>(nullptr),
+                             static_cast<AccT*>(nullptr), static_cast<int>(length), true,
+                             nullptr));
+  size_t bytes = AlignUp(std::max(temp_bytes, exclusive_bytes));
+  if (!std::is_same<T, AccT>::value) {
+    bytes += AlignUp(length * sizeof(AccT));
+  }
+  return bytes;
+}
+
+template <typename T>
+void HostCumsum(const T* x, T* y, int64_t outer, int64_t length, int64_t inner, bool exclusive,
+                void* workspace, void* stream) {
+  using AccT = typename ScanAcc<T>::type;
+  cudaStream_t cuda_stream = static_cast<cudaStream_t>(stream);
+  if (outer * length * inner == 0) {
+    return;
+  }
+  if (outer == 1 && inner == 1) {
+    size_t temp_bytes = AlignUp(CumsumWorkspaceBytes<T>(1, length, 1));
+    AccT* out = reinterpret_cast<AccT*>(y);
+    if (!std::is_same<T, AccT>::value) {
+      temp_bytes -= AlignUp(length * sizeof(AccT));
+      out = reinterpret_cast<AccT*>(static_cast<char*>(workspace) + temp_bytes);
+    }
+    CUDA_CALL(CubScan<T, AccT>(workspace, temp_bytes, x, out, static_cast<int>(length), exclusive,
+                               cuda_stream));
+    if (!std::is_same<T, AccT>::value) {
+      CastKernel<T, AccT><<<NumBlocks(length), kBlockSize, 0, cuda_stream>>>(out, y, length);
+    }
+  } else if (inner == 1) {
+    int blocks = static_cast<int>(std::min<int64_t>(outer, kMaxBlocks));
+    RowScanKernel<T, AccT><<<blocks, kBlockSize, 0, cuda_stream>>>(x, y, outer, length, exclusive);
+  } else {
+    ColumnScanKernel<T, AccT><<<NumBlocks(outer * inner), kBlockSize, 0, cuda_stream>>>(
+        x, y, outer, length, inner, exclusive);
+  }
+}
+
+#define RAF_INSTANTIATE_CUMSUM(T)                                                              \
+  template size_t CumsumWorkspaceBytes<T>(int64_t outer, int64_t length, int64_t inner);       \
+  template void HostCumsum<T>(const T* x, T* y, int64_t outer, int64_t length, int64_t inner, \
+                              bool exclusive, void* workspace, void* stream);
+
+RAF_INSTANTIATE_CUMSUM(Half);
+RAF_INSTANTIATE_CUMSUM(float);
+RAF_INSTANTIATE_CUMSUM(double);
+RAF_INSTANTIATE_CUMSUM(int32_t);
+RAF_INSTANTIATE_CUMSUM(int64_t);
+
+#undef RAF_INSTANTIATE_CUMSUM
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,81 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/scatter_add.cuh
+ * \brief Headers of the CUDA kernels of the scatter-add backward of the indexing ops
+ *
+ * The backward of take, gather, gather_nd and adv_index adds the rows of dy to the rows of dx
+ * selected by the indices. The row keys are computed from the indices, and sorted with the
+ * positions of the rows as the embedding backward does, so every row of dx is reduced by one
+ * thread in a fixed order without atomics. When the keys turn out to be unique on the device,
+ * the rows are copied by vectors instead.
+ */
+#pragma once
+#include <cuda_fp16.h>
+#include <stdint.h>
+#include "./Half.h"
+#include "./kernel_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+/*! \brief The maximum number of dims of the tensors of the scatter-add. */
+constexpr int kMaxScatterDims = 8;
+
+/*! \brief The shape of a tensor, which is passed to the kernels by value. */
+struct ScatterShape {
+  int ndim;
+  int64_t dims[kMaxScatterDims];
+};
+
+/*!
+ * \brief The index tensors of adv_index, which are broadcast to a shape. The broadcast strides of
+ * an index tensor are 0 along its broadcast dims.
+ */
+template <typename I>
+struct AdvIndices {
+  int num;
+  const I* data[kMaxScatterDims];
+  int64_t strides[kMaxScatterDims][kMaxScatterDims];
+};
+
+/*! \brief The workspace bytes of the scatter-add of num rows into range rows. */
+size_t ScatterAddWorkspaceBytes(int num, int range);
+
+/*!
+ * \brief Backward of take, where dy is [outer, num, inner], dx is [outer, axis_size, inner], and
+ * the indices of num elements are clipped or wrapped to [0, axis_size).
+ */
+template <typename T, typename I>
+void HostTakeDx(const T* dy, const I* indices, T* dx, int outer, int num, int axis_size, int inner,
+                bool wrap, void* workspace, void* stream);
+
+/*! \brief Backward of gather along the axis, where dy has the shape of the indices. */
+template <typename T, typename I>
+void HostGatherDx(const T* dy, const I* indices, T* dx, const ScatterShape& data_shape,
+                  const ScatterShape& indices_shape, int axis, void* workspace, void* stream);
+
+/*!
+ * \brief Backward of gather_nd, where the indices are [m, num] into the leading m dims of the
+ * data, dy is [num, inner] and inner is the size of the trailing dims of the data.
+ */
+template <typename T, typename I>
+void HostGatherNdDx(const T* dy, const I* indices, T* dx, const ScatterShape& data_shape, int m,
+                    int num, int inner, void* workspace, void* stream);
+
+/*!
+ * \brief Backward of adv_index, where the indices are broadcast to index_shape of num elements and
+ * index the leading dims of the data, and dy is [num, inner].
+ */
+template <typename T, typename I>
+void HostAdvIndexDx(const T* dy, const AdvIndices<I>& indices, T* dx,
+                    const ScatterShape& data_shape, const ScatterShape& index_shape, int inner,
+                    void* workspace, void* stream);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,313 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/scatter_add_cuda_kernel.cu
+ * \brief Scatter-add cuda kernels of the backward of the indexing ops
+ */
+#include <stdio.h>
+#include <algorithm>
+#include "./scatter_add.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+using namespace c10;
+
+namespace {
+
+constexpr int kBlockSize = 256;
+constexpr int kMaxBlocks = 4096;
+constexpr size_t kWorkspaceAlign = 256;
+constexpr int kVecBytes = 16;
+
+inline size_t AlignUp(size_t bytes) {
+  return (bytes + kWorkspaceAlign - 1) / kWorkspaceAlign * kWorkspaceAlign;
+}
+
+inline int NumBlocks(int64_t n) {
+  return static_cast<int>(std::min<int64_t>((n + kBlockSize - 1) / kBlockSize, kMaxBlocks));
+}
+
+template <typename T, int N>
+struct alignas(sizeof(T) * N) AlignedVector {
+  T val[N];
+};
+
+/*! \brief Trap on the index out of [0, size). */
+__device__ __forceinline__ void CheckIndex(int64_t index, int64_t size, int64_t pos) {
+  if (index < 0 || index >= size) {
+    printf("indices[%lld] = %lld is out of range (%lld)\n", static_cast<long long>(pos),
+           static_cast<long long>(index), static_cast<long long>(size));
+    asm("trap;");
+  }
+}
+
+/*! \brief The row keys of take, whose rows are the inner dims of each index in each outer row. */
+template <typename I>
+struct TakeKeys {
+  const I* indices;
+  int num;
+  int axis_size;
+  bool wrap;
+
+  __device__ __forceinline__ int64_t operator()(int64_t r) const {
+    int64_t outer = r / num;
+    int64_t index = indices[r % num];
+    if (wrap) {
+      index = (index % axis_size + axis_size) % axis_size;
+    } else if (index < 0) {
+      index = 0;
+    } else if (index >= axis_size) {
+      index = axis_size - 1;
+    }
+    return outer * axis_size + index;
+  }
+};
+
+/*! \brief The element keys of gather, where the coordinate along the axis is the index. */
+template <typename I>
+struct GatherKeys {
+  const I* indices;
+  ScatterShape data_shape;
+  ScatterShape indices_shape;
+  int axis;
+
+  __device__ __forceinline__ int64_t operator()(int64_t e) const {
+    int64_t key = 0;
+    int64_t data_stride = 1;
+    int64_t rest = e;
+    for (int d = indices_shape.ndim - 1; d >= 0; --d) {
+      int64_t coord = rest % indices_shape.dims[d];
+      rest /= indices_shape.dims[d];
+      if (d == axis) {
+        coord = indices[e];
+        CheckIndex(coord, data_shape.dims[d], e);
+      }
+      key += coord * data_stride;
+      data_stride *= data_shape.dims[d];
+    }
+    return key;
+  }
+};
+
+/*! \brief The row keys of gather_nd, whose indices are [m, num] into the leading m dims. */
+template <typename I>
+struct GatherNdKeys {
+  const I* indices;
+  ScatterShape data_shape;
+  int m;
+  int num;
+
+  __device__ __forceinline__ int64_t operator()(int64_t r) const {
+    int64_t key = 0;
+    for (int k = 0; k < m; ++k) {
+      int64_t pos = k * static_cast<int64_t>(num) + r;
+      int64_t index = indices[pos];
+      CheckIndex(index, data_shape.dims[k], pos);
+      key = key * data_shape.dims[k] + index;
+    }
+    return key;
+  }
+};
+
+/*! \brief The row keys of adv_index, whose broadcast indices index the leading dims. */
+template <typename I>
+struct AdvIndexKeys {
+  AdvIndices<I> indices;
+  ScatterShape data_shape;
+  ScatterShape index_shape;
+
+  __device__ __forceinline__ int64_t operator()(int64_t r) const {
+    int64_t coords[kMaxScatterDims];
+    int64_t rest = r;
+    for (int d = index_shape.ndim - 1; d >= 0; --d) {
+      coords[d] = rest % index_shape.dims[d];
+      rest /= index_shape.dims[d];
+    }
+    int64_t key = 0;
+    for (int k = 0; k < indices.num; ++k) {
+      int64_t pos = 0;
+      for (int d = 0; d < index_shape.ndim; ++d) {
+        pos += coords[d] * indices.strides[k][d];
+      }
+      int64_t index = indices.data[k][pos];
+      CheckIndex(index, data_shape.dims[k], pos);
+      key = key * data_shape.dims[k] + index;
+    }
+    return key;
+  }
+};
+
+template <typename KeyFn>
+__global__ void ComputeKeysKernel(KeyFn key_fn, int num, int64_t* keys) {
+  for (int r = blockIdx.x * blockDim.x + threadIdx.x; r < num; r += gridDim.x * blockDim.x) {
+    keys[r] = key_fn(r);
+  }
+}
+
+/*!
+ * \brief Add the rows of src to the rows of out by their keys, with N elements per thread. When
+ * the keys are unique, i.e., every run has one row, each row of src is copied to its row of out.
+ * Otherwise, each thread sums its elements of the rows of a run in the ascending order of the
+ * positions, so the result is deterministic.
+ */
+template <typename T, int N>
+__global__ void ScatterAddKernel(const T* __restrict__ src, const int64_t* __restrict__ keys,
+                                 SortedIndices buf, int num, int stride, T* __restrict__ out) {
+  using Vec = AlignedVector<T, N>;
+  const int num_vecs = stride / N;
+  const int num_runs = *buf.num_runs;
+  const bool unique = num_runs == num;
+  const Vec* src_vecs = reinterpret_cast<const Vec*>(src);
+  Vec* out_vecs = reinterpret_cast<Vec*>(out);
+  const int64_t total = static_cast<int64_t>(num) * num_vecs;
+  for (int64_t e = blockIdx.x * static_cast<int64_t>(blockDim.x) + threadIdx.x; e < total;
+       e += static_cast<int64_t>(gridDim.x) * blockDim.x) {
+    const int r = e / num_vecs;
+    const int v = e % num_vecs;
+    if (unique) {
+      out_vecs[keys[r] * num_vecs + v] = src_vecs[e];
+      continue;
+    }
+    if (r >= num_runs) {
+      break;
+    }
+    float acc[N];
+#pragma unroll
+    for (int i = 0; i < N; ++i) {
+      acc[i] = 0.0f;
+    }
+    const int begin = buf.offsets[r];
+    const int end = begin + buf.counts[r];
+    for (int j = begin; j < end; ++j) {
+      Vec x = src_vecs[static_cast<int64_t>(buf.sorted_positions[j]) * num_vecs + v];
+#pragma unroll
+      for (int i = 0; i < N; ++i) {
+        acc[i] += static_cast<float>(x.val[i]);
+      }
+    }
+    Vec y;
+#pragma unroll
+    for (int i = 0; i < N; ++i) {
+      y.val[i] = static_cast<T>(acc[i]);
+    }
+    out_vecs[buf.unique_rows[r] * num_vecs + v] = y;
+  }
+}
+
+/*!
+ * \brief Add num rows of src of stride elements to the rows of out in [0, range) by the keys
+ * computed by key_fn. The rows absent from the keys are zeros.
+ */
+template <typename T, typename KeyFn>
+void LaunchScatterAdd(const T* src, T* out, KeyFn key_fn, int num, int range, int stride,
+                      void* workspace, cudaStream_t stream) {
+  CUDA_CALL(cudaMemsetAsync(out, 0, sizeof(T) * static_cast<size_t>(range) * stride, stream));
+  if (num == 0 || stride == 0) {
+    return;
+  }
+  int64_t* keys = static_cast<int64_t*>(workspace);
+  SortedIndices buf;
+  LayoutSortedIndices(num, range, static_cast<char*>(workspace) + AlignUp(sizeof(int64_t) * num),
+                      &buf);
+  ComputeKeysKernel<<<NumBlocks(num), kBlockSize, 0, stream>>>(key_fn, num, keys);
+  SortIndices(keys, num, range, buf, stream);
+
+  constexpr int kVecSize = kVecBytes / sizeof(T);
+  bool aligned = stride % kVecSize == 0 && reinterpret_cast<uintptr_t>(src) % kVecBytes == 0 &&
+                 reinterpret_cast<uintptr_t>(out) % kVecBytes == 0;
+  if (aligned) {
+    int64_t total = static_cast<int64_t>(num) * (stride / kVecSize);
+    ScatterAddKernel<T, kVecSize>
+        <<<NumBlocks(total), kBlockSize, 0, stream>>>(src, keys, buf, num, stride, out);
+  } else {
+    int64_t total = static_cast<int64_t>(num) * stride;
+    ScatterAddKernel<T, 1>
+        <<<NumBlocks(total), kBlockSize, 0, stream>>>(src, keys, buf, num, stride, out);
+  }
+}
+
+}  // namespace
+
+size_t ScatterAddWorkspaceBytes(int num, int range) {
+  return AlignUp(sizeof(int64_t) * num) + LayoutSortedIndices(num, range, nullptr, nullptr);
+}
+
+template <typename T, typename I>
+void HostTakeDx(const T* dy, const I* indices, T* dx, int outer, int num, int axis_size, int inner,
+                bool wrap, void* workspace, void* stream) {
+  TakeKeys<I> key_fn{indices, num, axis_size, wrap};
+  LaunchScatterAdd<T>(dy, dx, key_fn, outer * num, outer * axis_size, inner, workspace,
+                      static_cast<cudaStream_t>(stream));
+}
+
+template <typename T, typename I>
+void HostGatherDx(const T* dy, const I* indices, T* dx, const ScatterShape& data_shape,
+                  const ScatterShape& indices_shape, int axis, void* workspace, void* stream) {
+  int64_t num = 1, range = 1;
+  for (int d = 0; d < data_shape.ndim; ++d) {
+    num *= indices_shape.dims[d];
+    range *= data_shape.dims[d];
+  }
+  GatherKeys<I> key_fn{indices, data_shape, indices_shape, axis};
+  LaunchScatterAdd<T>(dy, dx, key_fn, static_cast<int>(num), static_cast<int>(range), 1, workspace,
+                      static_cast<cudaStream_t>(stream));
+}
+
+template <typename T, typename I>
+void HostGatherNdDx(const T* dy, const I* indices, T* dx, const ScatterShape& data_shape, int m,
+                    int num, int inner, void* workspace, void* stream) {
+  int64_t range = 1;
+  for (int k = 0; k < m; ++k) {
+    range *= data_shape.dims[k];
+  }
+  GatherNdKeys<I> key_fn{indices, data_shape, m, num};
+  LaunchScatterAdd<T>(dy, dx, key_fn, num, static_cast<int>(range), inner, workspace,
+                      static_cast<cudaStream_t>(stream));
+}
+
+template <typename T, typename I>
+void HostAdvIndexDx(const T* dy, const AdvIndices<I>& indices, T* dx,
+                    const ScatterShape& data_shape, const ScatterShape& index_shape, int inner,
+                    void* workspace, void* stream) {
+  int64_t num = 1, range = 1;
+  for (int d = 0; d < index_shape.ndim; ++d) {
+    num *= index_shape.dims[d];
+  }
+  for (int k = 0; k < indices.num; ++k) {
+    range *= data_shape.dims[k];
+  }
+  AdvIndexKeys<I> key_fn{indices, data_shape, index_shape};
+  LaunchScatterAdd<T>(dy, dx, key_fn, static_cast<int>(num), static_cast<int>(range), inner,
+                      workspace, static_cast<cudaStream_t>(stream));
+}
+
+#define RAF_INSTANTIATE_SCATTER_ADD(T, I)                                                        \
+  template void HostTakeDx<T, I>(const T* dy, const I* indices, T* dx, int outer, int num,       \
+                                 int axis_size, int inner, bool wrap, void* workspace,           \
+                                 void* stream);                                                  \
+  template void HostGatherDx<T, I>(const T* dy, const I* indices, T* dx,                         \
+                                   const ScatterShape& data_shape,                               \
+                                   const ScatterShape& indices_shape, int axis, void* workspace, \
+                                   void* stream);                                                \
+  template void HostGatherNdDx<T, I>(const T* dy, const I* indices, T* dx,                       \
+                                     const ScatterShape& data_shape, int m, int num, int inner,  \
+                                     void* workspace, void* stream);                             \
+  template void HostAdvIndexDx<T, I>(const T* dy, const AdvIndices<I>& indices, T* dx,           \
+                                     const ScatterShape& data_shape,                             \
+                                     const ScatterShape& index_shape, int inner,                 \
+                                     void* workspace, void* stream);
+
+RAF_INSTANTIATE_SCATTER_ADD(Half, int32_t);
+RAF_INSTANTIATE_SCATTER_ADD(Half, int64_t);
+RAF_INSTANTIATE_SCATTER_ADD(float, int32_t);
+RAF_INSTANTIATE_SCATTER_ADD(float, int64_t);
+
+#undef RAF_INSTANTIATE_SCATTER_ADD
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
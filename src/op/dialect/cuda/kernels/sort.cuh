@@ -0,0 +1,55 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/sort.cuh
+ * \brief Headers of CUDA segmented sort and top-k kernels
+ */
+#pragma once
+#include <cuda_fp16.h>
+#include <stdint.h>
+#include "./Half.h"
+#include "../../../../common/cuda_utils.h"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+/*! \brief The largest k of the top-k kernel. */
+constexpr int kMaxTopK = 1024;
+
+/*!
+ * \brief The workspace bytes of HostSegmentedSort.
+ * \param num_segments The number of the segments.
+ * \param segment_size The number of the elements of each segment.
+ * \param return_keys Whether the sorted keys are returned.
+ * \param return_indices Whether the indices of the sorted keys are returned.
+ */
+template <typename T, typename I>
+size_t SegmentedSortWorkspaceBytes(int64_t num_segments, int64_t segment_size, bool return_keys,
+                                   bool return_indices);
+
+/*!
+ * \brief Sort each of the contiguous segments of keys by the radix sort of CUB, which is stable.
+ * The sorted keys and their indices in the segment are written to sorted_keys and indices, either
+ * of which can be nullptr if it is not returned.
+ */
+template <typename T, typename I>
+void HostSegmentedSort(const T* keys, T* sorted_keys, I* indices, int64_t num_segments,
+                       int64_t segment_size, bool is_ascend, void* workspace, void* stream);
+
+/*!
+ * \brief Select the top-k of each of the contiguous segments of x. Each segment is scanned by a
+ * block in tiles, and each tile is bitonic-sorted in the shared memory and merged into the running
+ * top-k. The ties are broken by the smaller index. The values and their indices in the segment are
+ * written in order to values and indices, either of which can be nullptr if it is not returned.
+ */
+template <typename T, typename I>
+void HostTopK(const T* x, T* values, I* indices, int64_t num_segments, int64_t segment_size,
+              int k, bool is_ascend, void* stream);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
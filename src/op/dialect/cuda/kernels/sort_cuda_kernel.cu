@@ -0,0 +1,359 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/sort_cuda_kernel.cu
+ * \brief Segmented sort and top-k cuda kernels
+ */
+#include <limits.h>
+#include <algorithm>
+#include <cub/cub.cuh>
+#include "./sort.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+using namespace c10;
+
+namespace {
+
+constexpr int kBlockSize = 256;
+constexpr size_t kWorkspaceAlign = 256;
+/*! \brief The smallest tile of the top-k, where a larger tile means fewer merges. */
+constexpr int kMinTopKTile = 512;
+
+inline size_t AlignUp(size_t bytes) {
+  return (bytes + kWorkspaceAlign - 1) / kWorkspaceAlign * kWorkspaceAlign;
+}
+
+/*! \brief The key type of CUB, which has the radix traits for __half but not for Half. */
+template <typename T>
+struct CubKey {
+  using type = T;
+};
+
+template <>
+struct CubKey<Half> {
+  using type = __half;
+};
+
+/*! \brief The begin offset of a segment. */
+struct SegmentOffset {
+  int segment_size;
+  __host__ __device__ __forceinline__ int operator()(int segment) const {
+    return segment * segment_size;
+  }
+};
+
+using OffsetIterator =
+    cub::TransformInputIterator<int, SegmentOffset, cub::CountingInputIterator<int>>;
+
+/*!
+ * \brief Dispatch to the radix sort of CUB. The keys are sorted without values unless sort_pairs,
+ * and a single segment is sorted by the unsegmented sort, which is faster.
+ */
+template <typename K, typename I>
+cudaError_t CubSort(void* temp, size_t& temp_bytes, const K* keys_in, K* keys_out,
+                    const I* values_in, I* values_out, bool sort_pairs, int num_segments,
+                    int segment_size, bool is_ascend, cudaStream_t stream) {
+  int n = num_segments * segment_size;
+  int end_bit = sizeof(K) * 8;
+  OffsetIterator begin(cub::CountingInputIterator<int>(0), SegmentOffset{segment_size});
+  OffsetIterator end = begin + 1;
+  if (num_segments == 1) {
+    if (!sort_pairs) {
+      return is_ascend ? cub::DeviceRadixSort::SortKeys(temp, temp_bytes, keys_in, keys_out, n, 0,
+                                                        end_bit, stream)
+                       : cub::DeviceRadixSort::SortKeysDescending(temp, temp_bytes, keys_in,
+                                                                  keys_out, n, 0, end_bit, stream);
+    }
+    return is_ascend ? cub::DeviceRadixSort::SortPairs(temp, temp_bytes, keys_in, keys_out,
+                                                       values_in, values_out, n, 0, end_bit,
+                                                       stream)
+                     : cub::DeviceRadixSort::SortPairsDescending(temp, temp_bytes, keys_in,
+                                                                 keys_out, values_in, values_out,
+                                                                 n, 0, end_bit, stream);
+  }
+  if (!sort_pairs) {
+    return is_ascend
+               ? cub::DeviceSegmentedRadixSort::SortKeys(temp, temp_bytes, keys_in, keys_out, n,
+                                                         num_segments, begin, end, 0, end_bit,
+                                                         stream)
+               : cub::DeviceSegmentedRadixSort::SortKeysDescending(temp, temp_bytes, keys_in,
+                                                                   keys_out, n, num_segments,
+                                                                   begin, end, 0, end_bit, stream);
+  }
+  return is_ascend ? cub::DeviceSegmentedRadixSort::SortPairs(
+                         temp, temp_bytes, keys_in, keys_out, values_in, values_out, n,
+                         num_segments, begin, end, 0, end_bit, stream)
+                   : cub::DeviceSegmentedRadixSort::SortPairsDescending(
+                         temp, temp_bytes, keys_in, keys_out, values_in, values_out, n,
+                         num_segments, begin, end, 0, end_bit, stream);
+}
+
+/*! \brief The buffers of the segmented sort. */
+template <typename T, typename I>
+struct SortBuffers {
+  T* keys_out;
+  I* positions;
+  void* temp;
+  size_t temp_bytes;
+};
+
+/*!
+ * \brief Carve the buffers out of the workspace, and return the total bytes. Only the size is
+ * computed when the workspace is nullptr.
+ */
+template <typename T, typename I>
+size_t LayoutSort(int num_segments, int segment_size, bool return_keys, bool return_indices,
+                  void* workspace, SortBuffers<T, I>* buf) {
+  using K = typename CubKey<T>::type;
+  size_t n = static_cast<size_t>(num_segments) * segment_size;
+  size_t temp_bytes = 0;
+  CUDA_CALL(CubSort<K, I>(nullptr, temp_bytes, nullptr, nullptr, nullptr, nullptr, return_indices,
+                          num_segments, segment_size, true, nullptr));
+  // The keys are sorted to the workspace when only the indices are returned.
+  size_t keys_bytes = return_keys ? 0 : AlignUp(sizeof(T) * n);
+  size_t positions_bytes = return_indices ? AlignUp(sizeof(I) * n) : 0;
+  if (workspace != nullptr) {
+    char* ptr = static_cast<char*>(workspace);
+    buf->keys_out = return_keys ? nullptr : reinterpret_cast<T*>(ptr);
+    buf->positions = return_indices ? reinterpret_cast<I*>(ptr + keys_bytes) : nullptr;
+    buf->temp = ptr + keys_bytes + positions_bytes;
+    buf->temp_bytes = temp_bytes;
+  }
+  return keys_bytes + positions_bytes + AlignUp(temp_bytes);
+}
+
+template <typename I>
+__global__ void InitPositionsKernel(I* positions, int64_t n, int segment_size) {
+  for (int64_t i = blockIdx.x * static_cast<int64_t>(blockDim.x) + threadIdx.x; i < n;
+       i += static_cast<int64_t>(gridDim.x) * blockDim.x) {
+    positions[i] = static_cast<I>(i % segment_size);
+  }
+}
+
+/*! \brief The key type of the top-k in the shared memory. */
+template <typename T>
+struct TopKKey {
+  using type = T;
+};
+
+template <>
+struct TopKKey<Half> {
+  using type = float;
+};
+
+/*! \brief The padding keys, which are never selected over the real elements. */
+template <typename K>
+struct KeyLimits;
+
+template <>
+struct KeyLimits<float> {
+  __device__ static float Max() {
+    return __int_as_float(0x7f800000);
+  }
+  __device__ static float Lowest() {
+    return __int_as_float(0xff800000);
+  }
+};
+
+template <>
+struct KeyLimits<int32_t> {
+  __device__ static int32_t Max() {
+    return INT_MAX;
+  }
+  __device__ static int32_t Lowest() {
+    return INT_MIN;
+  }
+};
+
+template <>
+struct KeyLimits<int64_t> {
+  __device__ static int64_t Max() {
+    return LLONG_MAX;
+  }
+  __device__ static int64_t Lowest() {
+    return LLONG_MIN;
+  }
+};
+
+/*! \brief Whether the element a precedes the element b in the top-k. */
+template <typename K>
+__device__ __forceinline__ bool Precedes(K a, int pos_a, K b, int pos_b, bool is_ascend) {
+  if (a == b) {
+    return pos_a < pos_b;
+  }
+  return is_ascend ? a < b : a > b;
+}
+
+/*!
+ * \brief A compare-exchange step of the bitonic network on n elements, which moves the preceding
+ * element of each pair to the front in the bitonic subsequences of the given size with the even
+ * ranks, and to the back in the others.
+ */
+template <typename K>
+__device__ __forceinline__ void BitonicStep(K* keys, int* pos, int n, int size, int stride,
+                                            bool is_ascend) {
+  for (int t = threadIdx.x; t < n / 2; t += blockDim.x) {
+    int i = 2 * t - (t & (stride - 1));
+    int j = i + stride;
+    bool front = (i & size) == 0;
+    if (Precedes(keys[j], pos[j], keys[i], pos[i], is_ascend) == front) {
+      K key = keys[i];
+      keys[i] = keys[j];
+      keys[j] = key;
+      int p = pos[i];
+      pos[i] = pos[j];
+      pos[j] = p;
+    }
+  }
+  __syncthreads();
+}
+
+/*! \brief Sort n elements in the precedence order, where n is a power of 2. */
+template <typename K>
+__device__ void BitonicSort(K* keys, int* pos, int n, bool is_ascend) {
+  for (int size = 2; size <= n; size <<= 1) {
+    for (int stride = size >> 1; stride > 0; stride >>= 1) {
+      BitonicStep(keys, pos, n, size, stride, is_ascend);
+    }
+  }
+}
+
+/*! \brief Sort a bitonic sequence of n elements in the precedence order. */
+template <typename K>
+__device__ void BitonicMerge(K* keys, int* pos, int n, bool is_ascend) {
+  for (int stride = n >> 1; stride > 0; stride >>= 1) {
+    BitonicStep(keys, pos, n, n, stride, is_ascend);
+  }
+}
+
+/*!
+ * \brief Each block selects the top-k of a segment. The shared memory holds the running top-k of
+ * tile elements in the first half, and the next tile in the second half. The sorted tile is merged
+ * by taking the preceding one of the i-th running element and the i-th last tile element, which is
+ * a bitonic sequence that holds the top-k of both.
+ */
+template <typename T, typename I, typename K>
+__global__ void TopKKernel(const T* x, T* values, I* indices, int segment_size, int k, int tile,
+                           bool is_ascend) {
+  extern __shared__ __align__(8) char smem[];
+  K* keys = reinterpret_cast<K*>(smem);
+  int* pos = reinterpret_cast<int*>(keys + 2 * tile);
+  const T* row = x + static_cast<int64_t>(blockIdx.x) * segment_size;
+  const K pad = is_ascend ? KeyLimits<K>::Max() : KeyLimits<K>::Lowest();
+  for (int start = 0; start < segment_size; start += tile) {
+    K* tile_keys = start == 0 ? keys : keys + tile;
+    int* tile_pos = start == 0 ? pos : pos + tile;
+    for (int i = threadIdx.x; i < tile; i += blockDim.x) {
+      bool valid = i < segment_size - start;
+      tile_keys[i] = valid ? static_cast<K>(row[start + i]) : pad;
+      tile_pos[i] = valid ? start + i : INT_MAX;
+    }
+    __syncthreads();
+    BitonicSort(tile_keys, tile_pos, tile, is_ascend);
+    if (start == 0) {
+      continue;
+    }
+    for (int i = threadIdx.x; i < tile; i += blockDim.x) {
+      int j = tile - 1 - i;
+      if (Precedes(tile_keys[j], tile_pos[j], keys[i], pos[i], is_ascend)) {
+        keys[i] = tile_keys[j];
+        pos[i] = tile_pos[j];
+      }
+    }
+    __syncthreads();
+    BitonicMerge(keys, pos, tile, is_ascend);
+  }
+  int64_t offset = static_cast<int64_t>(blockIdx.x) * k;
+  for (int i = threadIdx.x; i < k; i += blockDim.x) {
+    if (values != nullptr) {
+      values[offset + i] = static_cast<T>(keys[i]);
+    }
+    if (indices != nullptr) {
+      indices[offset + i] = static_cast<I>(pos[i]);
+    }
+  }
+}
+
+inline int NextPowerOf2(int n) {
+  int ret = 1;
+  while (ret < n) {
+    ret <<= 1;
+  }
+  return ret;
+}
+
+}  // namespace
+
+template <typename T, typename I>
+size_t SegmentedSortWorkspaceBytes(int64_t num_segments, int64_t segment_size, bool return_keys,
+                                   bool return_indices) {
+  return LayoutSort<T, I>(num_segments, segment_size, return_keys, return_indices, nullptr,
+                          nullptr);
+}
+
+template <typename T, typename I>
+void HostSegmentedSort(const T* keys, T* sorted_keys, I* indices, int64_t num_segments,
+                       int64_t segment_size, bool is_ascend, void* workspace, void* stream) {
+  using K = typename CubKey<T>::type;
+  int64_t n = num_segments * segment_size;
+  if (n == 0) {
+    return;
+  }
+  cudaStream_t cu_stream = static_cast<cudaStream_t>(stream);
+  SortBuffers<T, I> buf;
+  LayoutSort<T, I>(num_segments, segment_size, sorted_keys != nullptr, indices != nullptr,
+                   workspace, &buf);
+  if (indices != nullptr) {
+    int blocks = static_cast<int>(std::min<int64_t>((n + kBlockSize - 1) / kBlockSize, 4096));
+    InitPositionsKernel<I><<<blocks, kBlockSize, 0, cu_stream>>>(buf.positions, n, segment_size);
+  }
+  T* keys_out = sorted_keys != nullptr ? sorted_keys : buf.keys_out;
+  CUDA_CALL(CubSort<K, I>(buf.temp, buf.temp_bytes, reinterpret_cast<const K*>(keys),
+                          reinterpret_cast<K*>(keys_out), buf.positions, indices,
+                          indices != nullptr, num_segments, segment_size, is_ascend, cu_stream));
+}
+
+template <typename T, typename I>
+void HostTopK(const T* x, T* values, I* indices, int64_t num_segments, int64_t segment_size,
+              int k, bool is_ascend, void* stream) {
+  using K = typename TopKKey<T>::type;
+  if (num_segments == 0 || k == 0) {
+    return;
+  }
+  int tile = NextPowerOf2(
+      std::max(k, std::min(kMinTopKTile, static_cast<int>(std::max<int64_t>(segment_size, 2)))));
+  int threads = std::min(tile / 2, kMaxTopK / 2);
+  size_t smem_bytes = 2 * tile * (sizeof(K) + sizeof(int));
+  TopKKernel<T, I, K><<<static_cast<int>(num_segments), threads, smem_bytes,
+                        static_cast<cudaStream_t>(stream)>>>(x, values, indices, segment_size, k,
+                                                             tile, is_ascend);
+}
+
+#define RAF_INSTANTIATE_SORT(T, I)                                                              \
+  template size_t SegmentedSortWorkspaceBytes<T, I>(int64_t num_segments, int64_t segment_size, \
+                                                    bool return_keys, bool return_indices);     \
+  template void HostSegmentedSort<T, I>(const T* keys, T* sorted_keys, I* indices,              \
+                                        int64_t num_segments, int64_t segment_size,             \
+                                        bool is_ascend, void* workspace, void* stream);         \
+  template void HostTopK<T, I>(const T* x, T* values, I* indices, int64_t num_segments,         \
+                               int64_t segment_size, int k, bool is_ascend, void* stream);
+
+RAF_INSTANTIATE_SORT(Half, int32_t);
+RAF_INSTANTIATE_SORT(Half, int64_t);
+RAF_INSTANTIATE_SORT(float, int32_t);
+RAF_INSTANTIATE_SORT(float, int64_t);
+RAF_INSTANTIATE_SORT(int32_t, int32_t);
+RAF_INSTANTIATE_SORT(int32_t, int64_t);
+RAF_INSTANTIATE_SORT(int64_t, int32_t);
+RAF_INSTANTIATE_SORT(int64_t, int64_t);
+
+#undef RAF_INSTANTIATE_SORT
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,62 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/sparse_sgd_cuda.cu
+ * \brief Row-sparse SGD cuda kernel
+ */
+#include <algorithm>
+#include "./kernel_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+namespace {
+
+/*!
+ * \brief Each element of the row-sparse gradient updates its own element of x and v. The rows
+ * of the gradient are unique, so the updates never conflict.
+ */
+template <typename T>
+__global__ void SparseSgdKernel(T* __restrict__ x, T* __restrict__ v,
+                                const int64_t* __restrict__ rows, const T* __restrict__ values,
+                                int64_t total, int stride, float learning_rate, float mu) {
+  for (int64_t i = blockIdx.x * static_cast<int64_t>(blockDim.x) + threadIdx.x; i < total;
+       i += static_cast<int64_t>(gridDim.x) * blockDim.x) {
+    const int64_t row = rows[i / stride];
+    if (row < 0) {
+      continue;
+    }
+    const int64_t idx = row * stride + i % stride;
+    float v1 = mu * static_cast<float>(v[idx]) + static_cast<float>(values[i]);
+    v[idx] = static_cast<T>(v1);
+    x[idx] = static_cast<T>(static_cast<float>(x[idx]) - learning_rate * v1);
+  }
+}
+
+}  // namespace
+
+template <typename T>
+void sparse_sgd_cuda(T* x, T* v, const int64_t* rows, const T* values, int num, int stride,
+                     float learning_rate, float mu, void* stream) {
+  const int64_t total = static_cast<int64_t>(num) * stride;
+  if (total == 0) {
+    return;
+  }
+  const int threads = 256;
+  const int blocks = static_cast<int>(std::min<int64_t>((total + threads - 1) / threads, 65535));
+  SparseSgdKernel<T><<<blocks, threads, 0, static_cast<cudaStream_t>(stream)>>>(
+      x, v, rows, values, total, stride, learning_rate, mu);
+}
+
+template void sparse_sgd_cuda<float>(float*, float*, const int64_t*, const float*, int, int, float,
+                                     float, void*);
+template void sparse_sgd_cuda<__half>(__half*, __half*, const int64_t*, const __half*, int, int,
+                                      float, float, void*);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,92 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/strided_copy.cu
+ * \brief Copy between device tensors of arbitrary strides
+ */
+#include <algorithm>
+#include "./kernel_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+namespace {
+
+/*! \brief The maximum number of dims of a strided copy after merging the contiguous dims. */
+constexpr int kMaxStridedCopyDims = 8;
+
+/*! \brief The layout of a strided copy, which is passed to the kernel by value. */
+struct StridedCopyParams {
+  int ndim;
+  int64_t shape[kMaxStridedCopyDims];
+  int64_t src_strides[kMaxStridedCopyDims];
+  int64_t dst_strides[kMaxStridedCopyDims];
+};
+
+/*! \brief Each thread copies an element, whose offsets are computed from its linear index. */
+template <typename T>
+__global__ void StridedCopyKernel(const T* __restrict__ src, T* __restrict__ dst, int64_t total,
+                                  StridedCopyParams params) {
+  for (int64_t i = blockIdx.x * static_cast<int64_t>(blockDim.x) + threadIdx.x; i < total;
+       i += static_cast<int64_t>(gridDim.x) * blockDim.x) {
+    int64_t rem = i, src_offset = 0, dst_offset = 0;
+    for (int k = params.ndim - 1; k >= 0; --k) {
+      int64_t index = rem % params.shape[k];
+      rem /= params.shape[k];
+      src_offset += index * params.src_strides[k];
+      dst_offset += index * params.dst_strides[k];
+    }
+    dst[dst_offset] = src[src_offset];
+  }
+}
+
+template <typename T>
+void LaunchStridedCopy(const void* src, void* dst, int64_t total, const StridedCopyParams& params,
+                       void* stream) {
+  const int threads = 256;
+  const int blocks = static_cast<int>(std::min<int64_t>((total + threads - 1) / threads, 65535));
+  StridedCopyKernel<T><<<blocks, threads, 0, static_cast<cudaStream_t>(stream)>>>(
+      static_cast<const T*>(src), static_cast<T*>(dst), total, params);
+}
+
+}  // namespace
+
+void strided_copy_cuda(const void* src, void* dst, const std::vector<int64_t>& shape,
+                       const std::vector<int64_t>& src_strides,
+                       const std::vector<int64_t>& dst_strides, int elem_bytes, void* stream) {
+  CHECK_LE(shape.size(), kMaxStridedCopyDims)
+      << "Strided copies are supported up to " << kMaxStridedCopyDims << " non-contiguous dims";
+  StridedCopyParams params;
+  params.ndim = shape.size();
+  int64_t total = 1;
+  for (size_t i = 0; i < shape.size(); ++i) {
+    params.shape[i] = shape[i];
+    params.src_strides[i] = src_strides[i];
+    params.dst_strides[i] = dst_strides[i];
+    total *= shape[i];
+  }
+  if (total == 0) {
+    return;
+  }
+  // The copy is bitwise, so the elements are copied as unsigned integers of the same size.
+  switch (elem_bytes) {
+    case 1:
+      return LaunchStridedCopy<uint8_t>(src, dst, total, params, stream);
+    case 2:
+      return LaunchStridedCopy<uint16_t>(src, dst, total, params, stream);
+    case 4:
+      return LaunchStridedCopy<uint32_t>(src, dst, total, params, stream);
+    case 8:
+      return LaunchStridedCopy<uint64_t>(src, dst, total, params, stream);
+    default:
+      LOG(FATAL) << "Unsupported element size of strided copy: " << elem_bytes;
+  }
+}
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
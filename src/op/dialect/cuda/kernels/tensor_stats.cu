@@ -0,0 +1,143 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/tensor_stats.cu
+ * \brief The on-device numeric summaries of the tensors used by the lightweight VM debugger
+ */
+#include <algorithm>
+#if CUDA_VERSION >= 11000
+#include <cuda_bf16.h>
+#endif
+#include "./kernel_util.cuh"
+#define BLOCK_SIZE 512
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+namespace {
+
+inline int num_blocks(int64_t n) {
+  return static_cast<int>(std::min<int64_t>((n + BLOCK_SIZE - 1) / BLOCK_SIZE, 1024));
+}
+
+__device__ inline void atomic_min_float(float* addr, float val) {
+  int* ptr = reinterpret_cast<int*>(addr);
+  int old = *ptr, assumed;
+  while (__int_as_float(old) > val) {
+    assumed = old;
+    old = atomicCAS(ptr, assumed, __float_as_int(val));
+    if (old == assumed) {
+      break;
+    }
+  }
+}
+
+__device__ inline void atomic_max_float(float* addr, float val) {
+  int* ptr = reinterpret_cast<int*>(addr);
+  int old = *ptr, assumed;
+  while (__int_as_float(old) < val) {
+    assumed = old;
+    old = atomicCAS(ptr, assumed, __float_as_int(val));
+    if (old == assumed) {
+      break;
+    }
+  }
+}
+
+__global__ void init_tensor_stats_kernel(float* stats) {
+  stats[0] = INFINITY;
+  stats[1] = -INFINITY;
+  stats[2] = 0.0f;
+  stats[3] = 0.0f;
+}
+
+// Each block reduces its elements in the shared memory, and merges them to the stats by atomics.
+template <typename T>
+__global__ void tensor_stats_kernel(const T* data, int64_t n, float* stats) {
+  __shared__ float s_min[BLOCK_SIZE];
+  __shared__ float s_max[BLOCK_SIZE];
+  __shared__ float s_nan[BLOCK_SIZE];
+  __shared__ float s_sq[BLOCK_SIZE];
+  float min_val = INFINITY, max_val = -INFINITY, num_nan = 0.0f, sum_sq = 0.0f;
+  for (int64_t i = blockIdx.x * blockDim.x + threadIdx.x; i < n; i += blockDim.x * gridDim.x) {
+    float val = static_cast<float>(data[i]);
+    if (isnan(val)) {
+      num_nan += 1.0f;
+    } else {
+      min_val = fminf(min_val, val);
+      max_val = fmaxf(max_val, val);
+      sum_sq += val * val;
+    }
+  }
+  int tid = threadIdx.x;
+  s_min[tid] = min_val;
+  s_max[tid] = max_val;
+  s_nan[tid] = num_nan;
+  s_sq[tid] = sum_sq;
+  __syncthreads();
+  for (int stride = blockDim.x / 2; stride > 0; stride >>= 1) {
+    if (tid < stride) {
+      s_min[tid] = fminf(s_min[tid], s_min[tid + stride]);
+      s_max[tid] = fmaxf(s_max[tid], s_max[tid + stride]);
+      s_nan[tid] += s_nan[tid + stride];
+      s_sq[tid] += s_sq[tid + stride];
+    }
+    __syncthreads();
+  }
+  if (tid == 0) {
+    atomic_min_float(stats, s_min[0]);
+    atomic_max_float(stats + 1, s_max[0]);
+    atomicAdd(stats + 2, s_nan[0]);
+    atomicAdd(stats + 3, s_sq[0]);
+  }
+}
+
+template <typename T>
+void launch_tensor_stats(const void* data, int64_t n, float* stats, cudaStream_t stream) {
+  tensor_stats_kernel<<<num_blocks(n), BLOCK_SIZE, 0, stream>>>(static_cast<const T*>(data), n,
+                                                                stats);
+}
+
+}  // namespace
+
+void init_tensor_stats_cuda(float* stats, void* stream) {
+  init_tensor_stats_kernel<<<1, 1, 0, static_cast<cudaStream_t>(stream)>>>(stats);
+  CUDA_CALL(cudaGetLastError());
+}
+
+bool tensor_stats_cuda(const void* data, int64_t n, DLDataType dtype, float* stats, void* stream) {
+  if (n == 0) {
+    return true;
+  }
+  cudaStream_t cuda_stream = static_cast<cudaStream_t>(stream);
+  if (dtype.lanes != 1) {
+    return false;
+  }
+  if (dtype.code == kDLFloat && dtype.bits == 32) {
+    launch_tensor_stats<float>(data, n, stats, cuda_stream);
+  } else if (dtype.code == kDLFloat && dtype.bits == 16) {
+    launch_tensor_stats<__half>(data, n, stats, cuda_stream);
+  } else if (dtype.code == kDLFloat && dtype.bits == 64) {
+    launch_tensor_stats<double>(data, n, stats, cuda_stream);
+#if CUDA_VERSION >= 11000
+  } else if (dtype.code == kDLBfloat && dtype.bits == 16) {
+    launch_tensor_stats<__nv_bfloat16>(data, n, stats, cuda_stream);
+#endif
+  } else if (dtype.code == kDLInt && dtype.bits == 32) {
+    launch_tensor_stats<int32_t>(data, n, stats, cuda_stream);
+  } else if (dtype.code == kDLInt && dtype.bits == 64) {
+    launch_tensor_stats<int64_t>(data, n, stats, cuda_stream);
+  } else {
+    return false;
+  }
+  CUDA_CALL(cudaGetLastError());
+  return true;
+}
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
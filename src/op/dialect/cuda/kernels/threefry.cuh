@@ -0,0 +1,36 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/threefry.cuh
+ * \brief Headers of CUDA Threefry kernels
+ */
+#pragma once
+#include <stdint.h>
+#include "../../../../common/cuda_utils.h"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+/*!
+ * \brief Generate n random uint64 values from the Threefry generator state key (10 words), and
+ * write the next state to new_key. It is bit-compatible with threefry_generate of TVM: words 0-3
+ * of the state are the key of Threefry4x64-20, words 4-7 are the counter, and words 8-9 mark the
+ * next position of the split path. Each thread hashes several counters and stores the outputs with
+ * vectorized stores.
+ */
+void HostThreefryGenerate(uint64_t* new_key, uint64_t* out, const uint64_t* key, int64_t n,
+                          void* stream);
+
+/*!
+ * \brief Split the Threefry generator state key into the left and the right states, which is
+ * bit-compatible with threefry_split of TVM.
+ */
+void HostThreefrySplit(uint64_t* left, uint64_t* right, const uint64_t* key, void* stream);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,208 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/threefry_cuda_kernel.cu
+ * \brief Threefry cuda kernels
+ */
+#include <algorithm>
+#include "./threefry.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+namespace {
+
+constexpr int kBlockSize = 256;
+constexpr int kMaxBlocks = 4096;
+/*! \brief The number of Threefry blocks (of 4 outputs each) that a thread hashes at least. */
+constexpr int kBlocksPerThread = 4;
+
+__device__ __forceinline__ uint64_t RotL(uint64_t x, int r) {
+  return (x << r) | (x >> (64 - r));
+}
+
+/*! \brief Extend the 4-word key with the parity word of the key schedule. */
+__device__ __forceinline__ void MakeKeySchedule(const uint64_t* key, uint64_t ks[5]) {
+  ks[4] = 0x1BD11BDAA9FC1A22ULL;
+#pragma unroll
+  for (int i = 0; i < 4; ++i) {
+    ks[i] = key[i];
+    ks[4] ^= key[i];
+  }
+}
+
+/*!
+ * \brief Threefry4x64 with 20 rounds in place, following the TVM compute: the key is injected
+ * before each group of 4 rounds, and there is no injection after the last group.
+ */
+__device__ __forceinline__ void Threefry(const uint64_t ks[5], uint64_t x[4]) {
+  constexpr int kRotations[8][2] = {{14, 16}, {52, 57}, {23, 40}, {5, 37},
+                                    {25, 33}, {46, 12}, {58, 22}, {32, 32}};
+#pragma unroll
+  for (int i = 0; i < 5; ++i) {
+#pragma unroll
+    for (int j = 0; j < 4; ++j) {
+      x[j] += ks[(i + j) % 5];
+    }
+    x[3] += i;
+#pragma unroll
+    for (int k = 0; k < 4; ++k) {
+      const int* rotation = kRotations[(i * 4 + k) % 8];
+      x[0] += x[1];
+      x[1] = RotL(x[1], rotation[0]) ^ x[0];
+      x[2] += x[3];
+      x[3] = RotL(x[3], rotation[1]) ^ x[2];
+      // The permutation of Threefry4x64 is [0, 3, 2, 1].
+      uint64_t t = x[1];
+      x[1] = x[3];
+      x[3] = t;
+    }
+  }
+}
+
+/*! \brief Shift the one-hot 128-bit path position (a, b) right by one bit. */
+__device__ __forceinline__ void ShiftRight(uint64_t a, uint64_t b, uint64_t* out_a,
+                                           uint64_t* out_b) {
+  if (a == 1) {
+    *out_a = 0;
+    *out_b = 0x8000000000000000ULL;
+  } else if (a == 0) {
+    *out_a = 0;
+    *out_b = b >> 1;
+  } else {
+    *out_a = a >> 1;
+    *out_b = 0;
+  }
+}
+
+/*! \brief Hash the key (words 0-3) of a state with its counter (words 4-7) into a new key. */
+__device__ __forceinline__ void RehashKey(const uint64_t* state, uint64_t new_key[4]) {
+  uint64_t ks[5];
+  MakeKeySchedule(state, ks);
+#pragma unroll
+  for (int j = 0; j < 4; ++j) {
+    new_key[j] = state[4 + j];
+  }
+  Threefry(ks, new_key);
+}
+
+/*!
+ * \brief Get the state that generates n values from the given one. When the counter has no room
+ * for n values, the path is extended, or the key is rehashed if the path is full as well.
+ */
+__device__ __forceinline__ void PrepareState(const uint64_t* key, uint64_t n, uint64_t state[10]) {
+  if (key[7] < 0xFFFFFFFFFFFFFFFFULL - n) {
+#pragma unroll
+    for (int i = 0; i < 10; ++i) {
+      state[i] = key[i];
+    }
+  } else if (key[8] == 0 && key[9] == 0) {
+    RehashKey(key, state);
+    state[4] = state[5] = state[6] = state[7] = 0;
+    state[8] = 0x8000000000000000ULL;
+    state[9] = 0;
+  } else {
+#pragma unroll
+    for (int i = 0; i < 4; ++i) {
+      state[i] = key[i];
+    }
+    state[4] = key[4] | key[8];
+    state[5] = key[5] | key[9];
+    state[6] = state[7] = 0;
+    ShiftRight(key[8], key[9], &state[8], &state[9]);
+  }
+}
+
+__global__ void ThreefryGenerateKernel(uint64_t* new_key, uint64_t* out, const uint64_t* key,
+                                       int64_t n) {
+  // Every thread resolves the state by itself, which is cheap and saves a launch.
+  uint64_t state[10];
+  PrepareState(key, static_cast<uint64_t>(n), state);
+  uint64_t ks[5];
+  MakeKeySchedule(state, ks);
+  const int64_t num_blocks = n / 4;
+  const int64_t tid = blockIdx.x * static_cast<int64_t>(blockDim.x) + threadIdx.x;
+  for (int64_t b = tid; b < num_blocks; b += static_cast<int64_t>(gridDim.x) * blockDim.x) {
+    // Every word of the counter is offset by the block index, which is the same as TVM.
+    uint64_t x[4] = {state[4] + b, state[5] + b, state[6] + b, state[7] + b};
+    Threefry(ks, x);
+    ulonglong2* dst = reinterpret_cast<ulonglong2*>(out + b * 4);
+    dst[0] = make_ulonglong2(x[0], x[1]);
+    dst[1] = make_ulonglong2(x[2], x[3]);
+  }
+  if (tid != 0) {
+    return;
+  }
+  int64_t remaining = n % 4;
+  uint64_t counter = state[7] + static_cast<uint64_t>(n);
+  if (remaining != 0) {
+    // The tail takes a whole block after the counter of the full blocks.
+    uint64_t x[4] = {state[4], state[5], state[6], state[7] + num_blocks * 4};
+    Threefry(ks, x);
+    for (int64_t i = 0; i < remaining; ++i) {
+      out[num_blocks * 4 + i] = x[i];
+    }
+    counter = state[7] + num_blocks * 4 + 4;
+  }
+#pragma unroll
+  for (int i = 0; i < 6; ++i) {
+    new_key[i] = state[i];
+  }
+  new_key[6] = 0;
+  new_key[7] = counter;
+  new_key[8] = state[8];
+  new_key[9] = state[9];
+}
+
+__global__ void ThreefrySplitKernel(uint64_t* left, uint64_t* right, const uint64_t* key) {
+  if (key[8] == 0 && key[9] == 0) {
+    // The path is full, so both halves start from a new key with a path of one bit.
+    RehashKey(key, left);
+    left[4] = left[5] = left[6] = left[7] = 0;
+    left[8] = 0x4000000000000000ULL;
+    left[9] = 0;
+#pragma unroll
+    for (int i = 0; i < 4; ++i) {
+      right[i] = left[i];
+    }
+    right[4] = 0x8000000000000000ULL;
+    right[5] = right[6] = right[7] = 0;
+    right[8] = 0x4000000000000000ULL;
+    right[9] = 0;
+    return;
+  }
+#pragma unroll
+  for (int i = 0; i < 8; ++i) {
+    left[i] = key[i];
+    right[i] = key[i];
+  }
+  // The left half appends a 0 to the path, and the right half appends a 1.
+  right[4] |= key[8];
+  right[5] |= key[9];
+  ShiftRight(key[8], key[9], &left[8], &left[9]);
+  ShiftRight(key[8], key[9], &right[8], &right[9]);
+}
+
+}  // namespace
+
+void HostThreefryGenerate(uint64_t* new_key, uint64_t* out, const uint64_t* key, int64_t n,
+                          void* stream) {
+  int64_t num_blocks = n / 4;
+  int64_t num_threads = (num_blocks + kBlocksPerThread - 1) / kBlocksPerThread;
+  int blocks = static_cast<int>(std::max<int64_t>(
+      1, std::min<int64_t>((num_threads + kBlockSize - 1) / kBlockSize, kMaxBlocks)));
+  ThreefryGenerateKernel<<<blocks, kBlockSize, 0, static_cast<cudaStream_t>(stream)>>>(
+      new_key, out, key, n);
+}
+
+void HostThreefrySplit(uint64_t* left, uint64_t* right, const uint64_t* key, void* stream) {
+  ThreefrySplitKernel<<<1, 1, 0, static_cast<cudaStream_t>(stream)>>>(left, right, key);
+}
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
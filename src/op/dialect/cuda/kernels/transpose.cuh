@@ -0,0 +1,31 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/transpose.cuh
+ * \brief Headers of CUDA transpose kernels
+ */
+#pragma once
+#include <stdint.h>
+#include <vector>
+#include "../../../../common/cuda_utils.h"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+/*!
+ * \brief Permute the dims of a contiguous tensor, where dim i of dst is dim axes[i] of src. The
+ * unit dims are dropped and the dims that stay adjacent are merged first. If the innermost dim is
+ * kept, the rows are copied with the widest loads that the alignment allows, and otherwise the
+ * innermost dims of src and dst are transposed by 32x32 tiles in the shared memory, so both the
+ * loads and the stores are coalesced.
+ */
+void HostTranspose(const void* src, void* dst, const std::vector<int64_t>& shape,
+                   const std::vector<int64_t>& axes, int elem_bytes, void* stream);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
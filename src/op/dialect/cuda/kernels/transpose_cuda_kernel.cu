@@ -0,0 +1,236 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/transpose_cuda_kernel.cu
+ * \brief Transpose cuda kernels
+ */
+#include <algorithm>
+#include <numeric>
+#include "./kernel_util.cuh"
+#include "./transpose.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+namespace {
+
+constexpr int kTileSize = 32;
+constexpr int kTileRows = 8;
+constexpr int kMaxBlocks = 65535;
+/*! \brief The maximum number of dims of a transpose after merging the adjacent dims. */
+constexpr int kMaxTransposeDims = 8;
+
+/*!
+ * \brief The layout of a tiled transpose, which is passed to the kernel by value. The tiles span
+ * the rows, which is the dim contiguous in dst, and the cols, which is the dim contiguous in src.
+ * The other dims are the batch dims.
+ */
+struct TransposeParams {
+  int batch_ndim;
+  int64_t batch_shape[kMaxTransposeDims];
+  int64_t batch_src_strides[kMaxTransposeDims];
+  int64_t batch_dst_strides[kMaxTransposeDims];
+  int64_t rows;
+  int64_t cols;
+  int64_t src_row_stride;
+  int64_t dst_col_stride;
+  int64_t row_tiles;
+  int64_t col_tiles;
+  int64_t num_tiles;
+};
+
+/*!
+ * \brief Each thread block transposes a tile at a time. A tile is read along the cols and written
+ * along the rows, and the shared memory is padded by a column to avoid the bank conflicts.
+ */
+template <typename T>
+__global__ void TransposeTileKernel(const T* __restrict__ src, T* __restrict__ dst,
+                                    TransposeParams params) {
+  __shared__ T tile[kTileSize][kTileSize + 1];
+  const int64_t tiles_per_batch = params.row_tiles * params.col_tiles;
+  for (int64_t t = blockIdx.x; t < params.num_tiles; t += gridDim.x) {
+    int64_t batch = t / tiles_per_batch;
+    int64_t row0 = (t % tiles_per_batch) / params.col_tiles * kTileSize;
+    int64_t col0 = (t % tiles_per_batch) % params.col_tiles * kTileSize;
+    int64_t src_base = 0, dst_base = 0;
+    for (int k = params.batch_ndim - 1; k >= 0; --k) {
+      int64_t index = batch % params.batch_shape[k];
+      batch /= params.batch_shape[k];
+      src_base += index * params.batch_src_strides[k];
+      dst_base += index * params.batch_dst_strides[k];
+    }
+    int64_t col = col0 + threadIdx.x;
+    for (int y = threadIdx.y; y < kTileSize; y += kTileRows) {
+      int64_t row = row0 + y;
+      if (row < params.rows && col < params.cols) {
+        tile[y][threadIdx.x] = src[src_base + row * params.src_row_stride + col];
+      }
+    }
+    __syncthreads();
+    int64_t row = row0 + threadIdx.x;
+    for (int y = threadIdx.y; y < kTileSize; y += kTileRows) {
+      int64_t out_col = col0 + y;
+      if (row < params.rows && out_col < params.cols) {
+        dst[dst_base + out_col * params.dst_col_stride + row] = tile[threadIdx.x][y];
+      }
+    }
+    __syncthreads();
+  }
+}
+
+template <typename T>
+void LaunchTransposeTile(const void* src, void* dst, const TransposeParams& params, void* stream) {
+  const int blocks = static_cast<int>(std::min<int64_t>(params.num_tiles, kMaxBlocks));
+  TransposeTileKernel<T><<<blocks, dim3(kTileSize, kTileRows), 0,
+                           static_cast<cudaStream_t>(stream)>>>(
+      static_cast<const T*>(src), static_cast<T*>(dst), params);
+}
+
+/*! \brief Get the row-major strides of the shape. */
+std::vector<int64_t> GetStrides(const std::vector<int64_t>& shape) {
+  std::vector<int64_t> strides(shape.size(), 1);
+  for (int i = static_cast<int>(shape.size()) - 2; i >= 0; --i) {
+    strides[i] = strides[i + 1] * shape[i + 1];
+  }
+  return strides;
+}
+
+/*!
+ * \brief Drop the unit dims, and merge the dims that are adjacent in both src and dst. The shape
+ * of src and the axes are updated in place.
+ */
+void CollapseDims(std::vector<int64_t>* shape, std::vector<int64_t>* axes) {
+  int ndim = shape->size();
+  // The new index of each kept dim of src, or -1 for the unit dims.
+  std::vector<int> kept(ndim, -1);
+  std::vector<int64_t> kept_shape;
+  for (int i = 0; i < ndim; ++i) {
+    if ((*shape)[i] != 1) {
+      kept[i] = kept_shape.size();
+      kept_shape.push_back((*shape)[i]);
+    }
+  }
+  // Group the kept dims of dst whose src dims are consecutive.
+  std::vector<std::vector<int64_t>> groups;
+  for (int64_t axis : *axes) {
+    if (kept[axis] < 0) {
+      continue;
+    }
+    if (!groups.empty() && groups.back().back() + 1 == kept[axis]) {
+      groups.back().push_back(kept[axis]);
+    } else {
+      groups.push_back({kept[axis]});
+    }
+  }
+  // Order the groups as in src, and take the products of the dims of the groups.
+  std::vector<int> order(groups.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(),
+            [&groups](int lhs, int rhs) { return groups[lhs][0] < groups[rhs][0]; });
+  std::vector<int64_t> new_axes(groups.size());
+  shape->assign(groups.size(), 1);
+  for (size_t i = 0; i < order.size(); ++i) {
+    for (int64_t dim : groups[order[i]]) {
+      (*shape)[i] *= kept_shape[dim];
+    }
+    new_axes[order[i]] = i;
+  }
+  *axes = new_axes;
+}
+
+}  // namespace
+
+void HostTranspose(const void* src, void* dst, const std::vector<int64_t>& shape,
+                   const std::vector<int64_t>& axes, int elem_bytes, void* stream) {
+  int64_t total = 1;
+  for (int64_t dim : shape) {
+    total *= dim;
+  }
+  if (total == 0) {
+    return;
+  }
+  std::vector<int64_t> in_shape = shape;
+  std::vector<int64_t> perm = axes;
+  CollapseDims(&in_shape, &perm);
+  int ndim = in_shape.size();
+  if (ndim <= 1) {
+    CUDA_CALL(cudaMemcpyAsync(dst, src, total * elem_bytes, cudaMemcpyDeviceToDevice,
+                              static_cast<cudaStream_t>(stream)));
+    return;
+  }
+  CHECK_LE(ndim, kMaxTransposeDims)
+      << "Transposes are supported up to " << kMaxTransposeDims << " non-adjacent dims";
+  std::vector<int64_t> in_strides = GetStrides(in_shape);
+  std::vector<int64_t> out_shape(ndim);
+  for (int i = 0; i < ndim; ++i) {
+    out_shape[i] = in_shape[perm[i]];
+  }
+  std::vector<int64_t> out_strides = GetStrides(out_shape);
+  // The stride in dst of each dim of src.
+  std::vector<int64_t> dst_strides(ndim);
+  for (int i = 0; i < ndim; ++i) {
+    dst_strides[perm[i]] = out_strides[i];
+  }
+
+  if (perm.back() == ndim - 1) {
+    // The rows are contiguous in both src and dst, so they are copied by the widest unit that
+    // divides the row and the addresses.
+    int64_t row_bytes = in_shape.back() * elem_bytes;
+    uintptr_t address = reinterpret_cast<uintptr_t>(src) | reinterpret_cast<uintptr_t>(dst);
+    int unit = 8;
+    while (row_bytes % unit != 0 || address % unit != 0) {
+      unit /= 2;
+    }
+    int64_t scale = row_bytes / unit;
+    std::vector<int64_t> copy_shape(ndim), copy_src_strides(ndim), copy_dst_strides(ndim);
+    for (int i = 0; i < ndim; ++i) {
+      copy_shape[i] = out_shape[i];
+      copy_src_strides[i] = in_strides[perm[i]] / in_shape.back() * scale;
+      copy_dst_strides[i] = out_strides[i] / in_shape.back() * scale;
+    }
+    copy_shape.back() = scale;
+    copy_src_strides.back() = copy_dst_strides.back() = 1;
+    strided_copy_cuda(src, dst, copy_shape, copy_src_strides, copy_dst_strides, unit, stream);
+    return;
+  }
+
+  TransposeParams params;
+  int row_dim = perm.back(), col_dim = ndim - 1;
+  params.batch_ndim = 0;
+  for (int i = 0; i < ndim; ++i) {
+    if (i != row_dim && i != col_dim) {
+      params.batch_shape[params.batch_ndim] = in_shape[i];
+      params.batch_src_strides[params.batch_ndim] = in_strides[i];
+      params.batch_dst_strides[params.batch_ndim] = dst_strides[i];
+      ++params.batch_ndim;
+    }
+  }
+  params.rows = in_shape[row_dim];
+  params.cols = in_shape[col_dim];
+  params.src_row_stride = in_strides[row_dim];
+  params.dst_col_stride = dst_strides[col_dim];
+  params.row_tiles = (params.rows + kTileSize - 1) / kTileSize;
+  params.col_tiles = (params.cols + kTileSize - 1) / kTileSize;
+  params.num_tiles = total / (params.rows * params.cols) * params.row_tiles * params.col_tiles;
+  // The transpose is bitwise, so the elements are moved as unsigned integers of the same size.
+  switch (elem_bytes) {
+    case 1:
+      return LaunchTransposeTile<uint8_t>(src, dst, params, stream);
+    case 2:
+      return LaunchTransposeTile<uint16_t>(src, dst, params, stream);
+    case 4:
+      return LaunchTransposeTile<uint32_t>(src, dst, params, stream);
+    case 8:
+      return LaunchTransposeTile<uint64_t>(src, dst, params, stream);
+    default:
+      LOG(FATAL) << "Unsupported element size of transpose: " << elem_bytes;
+  }
+}
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
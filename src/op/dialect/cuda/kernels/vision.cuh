@@ -0,0 +1,93 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/vision.cuh
+ * \brief Headers of the CUDA kernels of get_valid_counts, non_max_suppression and roi_align
+ *
+ * The boxes of the detection ops follow the layout of TVM, where each of the num_anchors boxes of
+ * a batch has elem_length floats holding the class id, the score and the 4 corners. The scalar
+ * thresholds and limits are read from the device, so none of the kernels synchronizes the host.
+ */
+#pragma once
+#include <stdint.h>
+#include "../../../../common/cuda_utils.h"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+/*!
+ * \brief The largest number of anchors of the bitmask NMS, whose IoU mask holds num_anchors bits
+ * for each anchor of a batch.
+ */
+constexpr int kMaxNmsAnchors = 16384;
+
+/*! \brief The attributes of non_max_suppression. */
+struct NmsParams {
+  int batch;
+  int num_anchors;
+  int elem_length;
+  int top_k;
+  int coord_start;
+  int score_index;
+  int id_index;
+  bool force_suppress;
+  bool return_indices;
+  bool invalid_to_bottom;
+};
+
+/*! \brief The attributes of roi_align, where the data is NCHW or NHWC. */
+struct RoiAlignParams {
+  int num_rois;
+  int batch;
+  int channels;
+  int height;
+  int width;
+  int pooled_h;
+  int pooled_w;
+  float spatial_scale;
+  int sample_ratio;
+  bool nhwc;
+  bool avg;
+};
+
+/*!
+ * \brief Move the boxes whose score is above the threshold, and whose class id is not negative if
+ * id_index >= 0, to the front of each batch in order. The rest boxes and indices are set to -1.
+ */
+void HostGetValidCounts(const float* data, const float* score_threshold, int* valid_count,
+                        float* out, int* out_indices, int batch, int num_anchors, int elem_length,
+                        int id_index, int score_index, void* stream);
+
+/*! \brief The workspace bytes of HostNonMaxSuppression. */
+size_t NmsWorkspaceBytes(int batch, int num_anchors);
+
+/*!
+ * \brief The greedy NMS over the valid boxes of each batch in the descending order of the scores.
+ * The IoU of every pair of the top-k boxes is computed in parallel into a bitmask, and a block per
+ * batch scans the bitmask to select the boxes. With return_indices, the original indices of the
+ * selected boxes are written to box_indices and their number to valid_box_count; otherwise the
+ * selected boxes are written to out.
+ */
+void HostNonMaxSuppression(const float* data, const int* valid_count, const int* indices,
+                           const int* max_output_size, const float* iou_threshold,
+                           const NmsParams& params, float* out, int* box_indices,
+                           int* valid_box_count, void* workspace, void* stream);
+
+/*!
+ * \brief ROIAlign of float32 data. A block handles the channels of a ROI, whose bilinear sampling
+ * positions and weights are shared by all channels and cached in the shared memory.
+ */
+void HostRoiAlign(const float* data, const float* rois, float* out, const RoiAlignParams& params,
+                  void* stream);
+
+/*! \brief The backward of the average ROIAlign, which scatters dy to dx with the same weights. */
+void HostRoiAlignDx(const float* rois, const float* dy, float* dx, const RoiAlignParams& params,
+                    void* stream);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
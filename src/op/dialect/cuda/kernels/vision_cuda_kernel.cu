@@ -0,0 +1,534 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/vision_cuda_kernel.cu
+ * \brief get_valid_counts, bitmask NMS and ROIAlign cuda kernels
+ */
+#include <float.h>
+#include <algorithm>
+#include <cub/cub.cuh>
+#include "./sort.cuh"
+#include "./vision.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+namespace {
+
+constexpr int kValidCountThreads = 256;
+constexpr int kNmsBoxes = 64;
+constexpr int kNmsScanThreads = 256;
+constexpr int kRoiThreads = 256;
+constexpr int kRoiChannels = 64;
+constexpr int kMaxRoiSamples = 512;
+constexpr size_t kAlignment = 256;
+
+size_t AlignUp(size_t nbytes) {
+  return (nbytes + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+__device__ __forceinline__ void CopyBox(const float* src, float* dst, int elem_length) {
+  for (int k = 0; k < elem_length; ++k) {
+    dst[k] = src[k];
+  }
+}
+
+__device__ __forceinline__ void FillBox(float* dst, int elem_length) {
+  for (int k = 0; k < elem_length; ++k) {
+    dst[k] = -1.f;
+  }
+}
+
+/*!
+ * \brief One block per batch, which compacts the valid boxes in tiles by a block-wide exclusive
+ * scan of the valid flags.
+ */
+__global__ void GetValidCountsKernel(const float* data, const float* score_threshold,
+                                     int* valid_count, float* out, int* out_indices,
+                                     int num_anchors, int elem_length, int id_index,
+                                     int score_index) {
+  using BlockScan = cub::BlockScan<int, kValidCountThreads>;
+  __shared__ typename BlockScan::TempStorage temp;
+  __shared__ int base;
+  int64_t b = blockIdx.x;
+  const float* batch_data = data + b * num_anchors * elem_length;
+  float* batch_out = out + b * num_anchors * elem_length;
+  int* batch_indices = out_indices + b * num_anchors;
+  float threshold = *score_threshold;
+  if (threadIdx.x == 0) {
+    base = 0;
+  }
+  __syncthreads();
+  for (int start = 0; start < num_anchors; start += kValidCountThreads) {
+    int j = start + threadIdx.x;
+    const float* box = batch_data + static_cast<int64_t>(j) * elem_length;
+    int valid = j < num_anchors && box[score_index] > threshold &&
+                (id_index < 0 || box[id_index] >= 0.f);
+    int pos, total;
+    BlockScan(temp).ExclusiveSum(valid, pos, total);
+    if (valid) {
+      CopyBox(box, batch_out + static_cast<int64_t>(base + pos) * elem_length, elem_length);
+      batch_indices[base + pos] = j;
+    }
+    __syncthreads();
+    if (threadIdx.x == 0) {
+      base += total;
+    }
+    __syncthreads();
+  }
+  for (int j = base + threadIdx.x; j < num_anchors; j += kValidCountThreads) {
+    FillBox(batch_out + static_cast<int64_t>(j) * elem_length, elem_length);
+    batch_indices[j] = -1;
+  }
+  if (threadIdx.x == 0) {
+    valid_count[b] = base;
+  }
+}
+
+/*! \brief The number of the boxes taking part in NMS, which are the top-k of the valid boxes. */
+__device__ __forceinline__ int NumKeep(const int* valid_count, int b, int top_k) {
+  int nkeep = valid_count[b];
+  return top_k > 0 && top_k < nkeep ? top_k : nkeep;
+}
+
+/*! \brief The keys to sort, where the invalid boxes are put to the end. */
+__global__ void NmsScoreKernel(const float* data, const int* valid_count, float* keys,
+                               int num_anchors, int elem_length, int score_index, int64_t size) {
+  for (int64_t i = blockIdx.x * static_cast<int64_t>(blockDim.x) + threadIdx.x; i < size;
+       i += static_cast<int64_t>(blockDim.x) * gridDim.x) {
+    int b = i / num_anchors;
+    int j = i % num_anchors;
+    keys[i] = j < valid_count[b] ? data[i * elem_length + score_index] : -FLT_MAX;
+  }
+}
+
+/*! \brief The IoU of two boxes, whose corners can be in either order. */
+__device__ __forceinline__ float IoU(const float* a, const float* b) {
+  float a_left = fminf(a[0], a[2]), a_right = fmaxf(a[0], a[2]);
+  float a_top = fminf(a[1], a[3]), a_bottom = fmaxf(a[1], a[3]);
+  float b_left = fminf(b[0], b[2]), b_right = fmaxf(b[0], b[2]);
+  float b_top = fminf(b[1], b[3]), b_bottom = fmaxf(b[1], b[3]);
+  float w = fmaxf(0.f, fminf(a_right, b_right) - fmaxf(a_left, b_left));
+  float h = fmaxf(0.f, fminf(a_bottom, b_bottom) - fmaxf(a_top, b_top));
+  float inter = w * h;
+  float area = (a_right - a_left) * (a_bottom - a_top) + (b_right - b_left) * (b_bottom - b_top);
+  float u = area - inter;
+  return u <= 0.f ? 0.f : inter / u;
+}
+
+/*!
+ * \brief Bit j of the word j / kNmsBoxes of row i is set if the sorted box i suppresses the sorted
+ * box j > i. The grid is (column tiles, row tiles, batch), and a block of kNmsBoxes threads loads
+ * a column tile of boxes to the shared memory and computes a word for each row of its row tile.
+ */
+__global__ void NmsMaskKernel(const float* data, const int* valid_count, const int* sorted,
+                              const float* iou_threshold, uint64_t* mask, NmsParams params,
+                              int words) {
+  __shared__ float boxes[kNmsBoxes][4];
+  __shared__ float ids[kNmsBoxes];
+  int b = blockIdx.z;
+  int row_tile = blockIdx.y;
+  int col_tile = blockIdx.x;
+  int nkeep = NumKeep(valid_count, b, params.top_k);
+  if (col_tile < row_tile || row_tile * kNmsBoxes >= nkeep || col_tile * kNmsBoxes >= nkeep) {
+    return;
+  }
+  int64_t offset = static_cast<int64_t>(b) * params.num_anchors;
+  const float* batch_data = data + offset * params.elem_length;
+  const int* batch_sorted = sorted + offset;
+  int col = col_tile * kNmsBoxes + threadIdx.x;
+  if (col < nkeep) {
+    const float* box = batch_data + static_cast<int64_t>(batch_sorted[col]) * params.elem_length;
+    for (int k = 0; k < 4; ++k) {
+      boxes[threadIdx.x][k] = box[params.coord_start + k];
+    }
+    ids[threadIdx.x] = params.id_index < 0 ? 0.f : box[params.id_index];
+  }
+  __syncthreads();
+  int row = row_tile * kNmsBoxes + threadIdx.x;
+  if (row >= nkeep) {
+    return;
+  }
+  const float* box = batch_data + static_cast<int64_t>(batch_sorted[row]) * params.elem_length;
+  float row_box[4];
+  for (int k = 0; k < 4; ++k) {
+    row_box[k] = box[params.coord_start + k];
+  }
+  float row_id = params.id_index < 0 ? 0.f : box[params.id_index];
+  float threshold = *iou_threshold;
+  uint64_t bits = 0;
+  // A non-positive threshold disables the suppression, following TVM.
+  if (threshold > 0.f && row_id >= 0.f) {
+    int cols = min(kNmsBoxes, nkeep - col_tile * kNmsBoxes);
+    for (int c = 0; c < cols; ++c) {
+      bool same_class = params.force_suppress || params.id_index < 0 || ids[c] == row_id;
+      if (col_tile * kNmsBoxes + c > row && same_class && IoU(row_box, boxes[c]) >= threshold) {
+        bits |= 1ULL << c;
+      }
+    }
+  }
+  mask[(offset + row) * words + col_tile] = bits;
+}
+
+/*!
+ * \brief One block per batch, which greedily selects the boxes in the sorted order. The removed
+ * bits of the selected boxes are merged by all threads, while thread 0 decides each box and
+ * writes the compacted outputs.
+ */
+__global__ void NmsScanKernel(const float* data, const int* valid_count, const int* indices,
+                              const int* sorted, const uint64_t* mask, const int* max_output_size,
+                              float* out, int* box_indices, int* valid_box_count,
+                              NmsParams params, int words) {
+  extern __shared__ uint64_t bitmask[];
+  uint64_t* removed = bitmask;
+  uint64_t* kept = bitmask + words;
+  __shared__ int decision;
+  __shared__ int count;
+  int b = blockIdx.x;
+  int nkeep = NumKeep(valid_count, b, params.top_k);
+  int64_t offset = static_cast<int64_t>(b) * params.num_anchors;
+  const float* batch_data = data + offset * params.elem_length;
+  const int* batch_sorted = sorted + offset;
+  const uint64_t* batch_mask = mask + offset * words;
+  int nwords = (nkeep + kNmsBoxes - 1) / kNmsBoxes;
+  int limit = *max_output_size;
+  bool compact = params.return_indices || params.invalid_to_bottom;
+  for (int w = threadIdx.x; w < words; w += blockDim.x) {
+    removed[w] = 0;
+    kept[w] = 0;
+  }
+  if (threadIdx.x == 0) {
+    count = 0;
+  }
+  __syncthreads();
+  for (int i = 0; i < nkeep; ++i) {
+    int w = i / kNmsBoxes;
+    uint64_t bit = 1ULL << (i % kNmsBoxes);
+    if (threadIdx.x == 0) {
+      const float* box = batch_data + static_cast<int64_t>(batch_sorted[i]) * params.elem_length;
+      if (limit > 0 && count >= limit) {
+        decision = -1;
+      } else if ((removed[w] & bit) || box[params.score_index] <= 0.f ||
+                 (params.id_index >= 0 && box[params.id_index] < 0.f)) {
+        decision = 0;
+      } else {
+        decision = 1;
+        kept[w] |= bit;
+        if (params.return_indices) {
+          box_indices[offset + count] = indices[offset + batch_sorted[i]];
+        } else if (params.invalid_to_bottom) {
+          CopyBox(box, out + (offset + count) * params.elem_length, params.elem_length);
+        }
+        ++count;
+      }
+    }
+    __syncthreads();
+    if (decision < 0) {
+      break;
+    }
+    if (decision > 0) {
+      const uint64_t* row = batch_mask + static_cast<int64_t>(i) * words;
+      for (int j = w + threadIdx.x; j < nwords; j += blockDim.x) {
+        removed[j] |= row[j];
+      }
+    }
+    __syncthreads();
+  }
+  int start = compact ? count : 0;
+  for (int j = start + threadIdx.x; j < params.num_anchors; j += blockDim.x) {
+    if (params.return_indices) {
+      box_indices[offset + j] = -1;
+    } else {
+      float* dst = out + (offset + j) * params.elem_length;
+      // Without the compaction, the selected boxes are kept at their sorted positions.
+      if (!compact && j < nkeep && (kept[j / kNmsBoxes] >> (j % kNmsBoxes) & 1)) {
+        CopyBox(batch_data + static_cast<int64_t>(batch_sorted[j]) * params.elem_length, dst,
+                params.elem_length);
+      } else {
+        FillBox(dst, params.elem_length);
+      }
+    }
+  }
+  if (params.return_indices && threadIdx.x == 0) {
+    valid_box_count[b] = count;
+  }
+}
+
+/*! \brief A bilinear sampling coordinate, whose weights are zero if it is out of the data. */
+struct Sample {
+  int low;
+  int high;
+  float w_low;
+  float w_high;
+};
+
+__device__ __forceinline__ Sample MakeSample(float v, int size) {
+  if (v < -1.f || v > size) {
+    return {0, 0, 0.f, 0.f};
+  }
+  v = fminf(fmaxf(v, 0.f), size - 1);
+  int low = static_cast<int>(v);
+  float l = v - low;
+  return {low, min(low + 1, size - 1), 1.f - l, l};
+}
+
+/*!
+ * \brief The sample idx of a ROI along an axis, which is idx % grid of the bin idx / grid. The
+ * samples are read from the table if it is cached, or computed on the fly otherwise.
+ */
+__device__ __forceinline__ Sample GetSample(const Sample* table, bool cached, int idx,
+                                            float start, float bin, int grid, int size) {
+  if (cached) {
+    return table[idx];
+  }
+  return MakeSample(start + (idx / grid) * bin + (idx % grid + 0.5f) * bin / grid, size);
+}
+
+/*! \brief The geometry of a ROI, computed by every thread of its block. */
+struct RoiGeometry {
+  int n;
+  float start_h;
+  float start_w;
+  float bin_h;
+  float bin_w;
+  int grid_h;
+  int grid_w;
+};
+
+__device__ __forceinline__ RoiGeometry GetRoiGeometry(const float* roi, const RoiAlignParams& p) {
+  RoiGeometry g;
+  g.n = static_cast<int>(roi[0]);
+  g.start_w = roi[1] * p.spatial_scale;
+  g.start_h = roi[2] * p.spatial_scale;
+  float roi_w = fmaxf(roi[3] * p.spatial_scale - g.start_w, 1.f);
+  float roi_h = fmaxf(roi[4] * p.spatial_scale - g.start_h, 1.f);
+  g.bin_h = roi_h / p.pooled_h;
+  g.bin_w = roi_w / p.pooled_w;
+  g.grid_h = p.sample_ratio > 0 ? p.sample_ratio : static_cast<int>(ceilf(roi_h / p.pooled_h));
+  g.grid_w = p.sample_ratio > 0 ? p.sample_ratio : static_cast<int>(ceilf(roi_w / p.pooled_w));
+  return g;
+}
+
+/*! \brief Fill the sample tables of a ROI, and return false if they do not fit in shared memory. */
+__device__ __forceinline__ bool LoadSampleTables(const RoiGeometry& g, const RoiAlignParams& p,
+                                                 Sample* ys, Sample* xs) {
+  int ny = p.pooled_h * g.grid_h;
+  int nx = p.pooled_w * g.grid_w;
+  bool cached = ny <= kMaxRoiSamples && nx <= kMaxRoiSamples;
+  if (cached) {
+    for (int t = threadIdx.x; t < ny; t += blockDim.x) {
+      ys[t] = GetSample(nullptr, false, t, g.start_h, g.bin_h, g.grid_h, p.height);
+    }
+    for (int t = threadIdx.x; t < nx; t += blockDim.x) {
+      xs[t] = GetSample(nullptr, false, t, g.start_w, g.bin_w, g.grid_w, p.width);
+    }
+  }
+  __syncthreads();
+  return cached;
+}
+
+/*! \brief Decompose the output index of a block into channel, ph and pw. */
+__device__ __forceinline__ void GetBin(int idx, int channels, const RoiAlignParams& p, int* c,
+                                       int* ph, int* pw) {
+  if (p.nhwc) {
+    *c = idx % channels;
+    *pw = idx / channels % p.pooled_w;
+    *ph = idx / channels / p.pooled_w;
+  } else {
+    *pw = idx % p.pooled_w;
+    *ph = idx / p.pooled_w % p.pooled_h;
+    *c = idx / p.pooled_w / p.pooled_h;
+  }
+}
+
+__device__ __forceinline__ int64_t DataIndex(int n, int c, int y, int x, const RoiAlignParams& p) {
+  return p.nhwc ? ((static_cast<int64_t>(n) * p.height + y) * p.width + x) * p.channels + c
+                : ((static_cast<int64_t>(n) * p.channels + c) * p.height + y) * p.width + x;
+}
+
+__device__ __forceinline__ int64_t OutIndex(int r, int c, int ph, int pw,
+                                            const RoiAlignParams& p) {
+  return p.nhwc ? ((static_cast<int64_t>(r) * p.pooled_h + ph) * p.pooled_w + pw) * p.channels + c
+                : ((static_cast<int64_t>(r) * p.channels + c) * p.pooled_h + ph) * p.pooled_w + pw;
+}
+
+/*!
+ * \brief The grid is (num_rois, channel tiles). The threads of a block share the sample tables of
+ * the ROI and loop over the outputs of kRoiChannels channels, in the order of the data layout.
+ */
+__global__ void RoiAlignKernel(const float* data, const float* rois, float* out,
+                               RoiAlignParams p) {
+  __shared__ Sample ys[kMaxRoiSamples];
+  __shared__ Sample xs[kMaxRoiSamples];
+  int r = blockIdx.x;
+  RoiGeometry g = GetRoiGeometry(rois + static_cast<int64_t>(r) * 5, p);
+  bool cached = LoadSampleTables(g, p, ys, xs);
+  int c_begin = blockIdx.y * kRoiChannels;
+  int channels = min(kRoiChannels, p.channels - c_begin);
+  int size = channels * p.pooled_h * p.pooled_w;
+  float count = static_cast<float>(max(g.grid_h * g.grid_w, 1));
+  bool valid_n = g.n >= 0 && g.n < p.batch;
+  for (int idx = threadIdx.x; idx < size; idx += blockDim.x) {
+    int c, ph, pw;
+    GetBin(idx, channels, p, &c, &ph, &pw);
+    c += c_begin;
+    float val = p.avg ? 0.f : -FLT_MAX;
+    for (int iy = 0; valid_n && iy < g.grid_h; ++iy) {
+      Sample sy =
+          GetSample(ys, cached, ph * g.grid_h + iy, g.start_h, g.bin_h, g.grid_h, p.height);
+      for (int ix = 0; ix < g.grid_w; ++ix) {
+        Sample sx =
+            GetSample(xs, cached, pw * g.grid_w + ix, g.start_w, g.bin_w, g.grid_w, p.width);
+        float v = 0.f;
+        if (sy.w_low + sy.w_high > 0.f && sx.w_low + sx.w_high > 0.f) {
+          v = sy.w_low * (sx.w_low * data[DataIndex(g.n, c, sy.low, sx.low, p)] +
+                          sx.w_high * data[DataIndex(g.n, c, sy.low, sx.high, p)]) +
+              sy.w_high * (sx.w_low * data[DataIndex(g.n, c, sy.high, sx.low, p)] +
+                           sx.w_high * data[DataIndex(g.n, c, sy.high, sx.high, p)]);
+        }
+        val = p.avg ? val + v : fmaxf(val, v);
+      }
+    }
+    if (!valid_n || g.grid_h * g.grid_w == 0) {
+      val = 0.f;
+    }
+    out[OutIndex(r, c, ph, pw, p)] = p.avg ? val / count : val;
+  }
+}
+
+__device__ __forceinline__ void ScatterSample(float* dx, float g, const Sample& sy,
+                                              const Sample& sx, int n, int c,
+                                              const RoiAlignParams& p) {
+  float w[4] = {sy.w_low * sx.w_low, sy.w_low * sx.w_high, sy.w_high * sx.w_low,
+                sy.w_high * sx.w_high};
+  int y[4] = {sy.low, sy.low, sy.high, sy.high};
+  int x[4] = {sx.low, sx.high, sx.low, sx.high};
+  for (int k = 0; k < 4; ++k) {
+    if (w[k] != 0.f) {
+      atomicAdd(dx + DataIndex(n, c, y[k], x[k], p), g * w[k]);
+    }
+  }
+}
+
+/*! \brief The same traversal as RoiAlignKernel, which scatters dy / count by the weights. */
+__global__ void RoiAlignDxKernel(const float* rois, const float* dy, float* dx,
+                                 RoiAlignParams p) {
+  __shared__ Sample ys[kMaxRoiSamples];
+  __shared__ Sample xs[kMaxRoiSamples];
+  int r = blockIdx.x;
+  RoiGeometry g = GetRoiGeometry(rois + static_cast<int64_t>(r) * 5, p);
+  if (g.n < 0 || g.n >= p.batch || g.grid_h * g.grid_w == 0) {
+    return;
+  }
+  bool cached = LoadSampleTables(g, p, ys, xs);
+  int c_begin = blockIdx.y * kRoiChannels;
+  int channels = min(kRoiChannels, p.channels - c_begin);
+  int size = channels * p.pooled_h * p.pooled_w;
+  float count = static_cast<float>(g.grid_h * g.grid_w);
+  for (int idx = threadIdx.x; idx < size; idx += blockDim.x) {
+    int c, ph, pw;
+    GetBin(idx, channels, p, &c, &ph, &pw);
+    c += c_begin;
+    float grad = dy[OutIndex(r, c, ph, pw, p)] / count;
+    for (int iy = 0; iy < g.grid_h; ++iy) {
+      Sample sy =
+          GetSample(ys, cached, ph * g.grid_h + iy, g.start_h, g.bin_h, g.grid_h, p.height);
+      for (int ix = 0; ix < g.grid_w; ++ix) {
+        Sample sx =
+            GetSample(xs, cached, pw * g.grid_w + ix, g.start_w, g.bin_w, g.grid_w, p.width);
+        ScatterSample(dx, grad, sy, sx, g.n, c, p);
+      }
+    }
+  }
+}
+
+}  // namespace
+
+void HostGetValidCounts(const float* data, const float* score_threshold, int* valid_count,
+                        float* out, int* out_indices, int batch, int num_anchors, int elem_length,
+                        int id_index, int score_index, void* stream) {
+  if (batch == 0) {
+    return;
+  }
+  GetValidCountsKernel<<<batch, kValidCountThreads, 0, static_cast<cudaStream_t>(stream)>>>(
+      data, score_threshold, valid_count, out, out_indices, num_anchors, elem_length, id_index,
+      score_index);
+  CUDA_CALL(cudaGetLastError());
+}
+
+size_t NmsWorkspaceBytes(int batch, int num_anchors) {
+  int64_t size = static_cast<int64_t>(batch) * num_anchors;
+  int words = (num_anchors + kNmsBoxes - 1) / kNmsBoxes;
+  return AlignUp(size * words * sizeof(uint64_t)) + AlignUp(size * sizeof(float)) +
+         AlignUp(size * sizeof(int)) +
+         SegmentedSortWorkspaceBytes<float, int32_t>(batch, num_anchors, false, true);
+}
+
+void HostNonMaxSuppression(const float* data, const int* valid_count, const int* indices,
+                           const int* max_output_size, const float* iou_threshold,
+                           const NmsParams& params, float* out, int* box_indices,
+                           int* valid_box_count, void* workspace, void* stream) {
+  if (params.batch == 0 || params.num_anchors == 0) {
+    return;
+  }
+  cudaStream_t cu_stream = static_cast<cudaStream_t>(stream);
+  int64_t size = static_cast<int64_t>(params.batch) * params.num_anchors;
+  int words = (params.num_anchors + kNmsBoxes - 1) / kNmsBoxes;
+  char* ptr = static_cast<char*>(workspace);
+  uint64_t* mask = reinterpret_cast<uint64_t*>(ptr);
+  ptr += AlignUp(size * words * sizeof(uint64_t));
+  float* keys = reinterpret_cast<float*>(ptr);
+  ptr += AlignUp(size * sizeof(float));
+  int* sorted = reinterpret_cast<int*>(ptr);
+  ptr += AlignUp(size * sizeof(int));
+
+  int threads = 256;
+  int blocks = static_cast<int>(std::min<int64_t>((size + threads - 1) / threads, 4096));
+  NmsScoreKernel<<<blocks, threads, 0, cu_stream>>>(data, valid_count, keys, params.num_anchors,
+                                                    params.elem_length, params.score_index, size);
+  CUDA_CALL(cudaGetLastError());
+  HostSegmentedSort<float, int32_t>(keys, nullptr, sorted, params.batch, params.num_anchors,
+                                    false, ptr, stream);
+  dim3 mask_blocks(words, words, params.batch);
+  NmsMaskKernel<<<mask_blocks, kNmsBoxes, 0, cu_stream>>>(data, valid_count, sorted,
+                                                           iou_threshold, mask, params, words);
+  CUDA_CALL(cudaGetLastError());
+  size_t smem_bytes = 2 * words * sizeof(uint64_t);
+  NmsScanKernel<<<params.batch, kNmsScanThreads, smem_bytes, cu_stream>>>(
+      data, valid_count, indices, sorted, mask, max_output_size, out, box_indices,
+      valid_box_count, params, words);
+  CUDA_CALL(cudaGetLastError());
+}
+
+void HostRoiAlign(const float* data, const float* rois, float* out, const RoiAlignParams& params,
+                  void* stream) {
+  if (params.num_rois == 0 || params.channels == 0) {
+    return;
+  }
+  dim3 blocks(params.num_rois, (params.channels + kRoiChannels - 1) / kRoiChannels);
+  RoiAlignKernel<<<blocks, kRoiThreads, 0, static_cast<cudaStream_t>(stream)>>>(data, rois, out,
+                                                                               params);
+  CUDA_CALL(cudaGetLastError());
+}
+
+void HostRoiAlignDx(const float* rois, const float* dy, float* dx, const RoiAlignParams& params,
+                    void* stream) {
+  cudaStream_t cu_stream = static_cast<cudaStream_t>(stream);
+  int64_t dx_size = static_cast<int64_t>(params.batch) * params.channels * params.height *
+                    params.width;
+  CUDA_CALL(cudaMemsetAsync(dx, 0, dx_size * sizeof(float), cu_stream));
+  if (params.num_rois == 0 || params.channels == 0) {
+    return;
+  }
+  dim3 blocks(params.num_rois, (params.channels + kRoiChannels - 1) / kRoiChannels);
+  RoiAlignDxKernel<<<blocks, kRoiThreads, 0, cu_stream>>>(rois, dy, dx, params);
+  CUDA_CALL(cudaGetLastError());
+}
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -34,6 +34,10 @@ class LansImpl : public raf::op::OpEnv {
         fschema_index[lans_op]("tensor_list"),
         fschema_index[lans_op]("step"),
     };
+    has_skip_ = args->skip.defined();
+    if (has_skip_) {
+      this->arg_indices.push_back(fschema_index[lans_op]("skip"));
+    }
     learning_rate_ = args->learning_rate;
     DLTensor* t0 = ir::Downcast<TensorValue>(args->tensor_list[0]);
     auto datatype = t0->dtype;
@@ -86,7 +90,11 @@ class LansImpl : public raf::op::OpEnv {
     auto args = cv->args.as<op::schema::LansArgs>();
     Array<Value> tvalue = {args->tensor_list.begin(), args->tensor_list.end()};
     Value tuple = TupleValue::make(tvalue);
-    Execute(std::vector<Value>{tuple, args->step}, cv->out);
+    std::vector<Value> inputs{tuple, args->step};
+    if (has_skip_) {
+      inputs.push_back(args->skip.value());
+    }
+    Execute(inputs, cv->out);
   }
 
   void Execute(const std::vector<Value>& inputs, Value output) override {
@@ -96,20 +104,13 @@ class LansImpl : public raf::op::OpEnv {
     DLTensor* t0 = ir::Downcast<TensorValue>(tuple->fields[0]);
     CHECK(t0->dtype.code == kDLFloat);
     CHECK((t0->dtype.bits == 32) || (t0->dtype.bits == 16));
-    DLDevice cpu_ctx;
-    cpu_ctx.device_type = kDLCPU;
-    cpu_ctx.device_id = 0;
-    auto* tstep = inputs[1].as<value::TensorValueObj>();
-    tensor::Tensor step_tensor = tstep->tensor;
-    CHECK(step_tensor->ndim == 0);
-    tvm::runtime::NDArray step_array = step_tensor.CopyTo(cpu_ctx);
-    float fstep = reinterpret_cast<float*>(step_array->data)[0];
-    int step = (int)fstep;
-    float bias_correction1 = 1.0f;
-    float bias_correction2 = 1.0f;
-    if (bias_correction_ == 1) {
-      bias_correction1 = 1 - std::pow(beta1_, step);
-      bias_correction2 = 1 - std::pow(beta2_, step);
+    // The step and the skip flag are read by the kernels, so the host is not synchronized.
+    DLTensor* step = ir::Downcast<TensorValue>(inputs[1]);
+    CHECK(step->ndim == 0 && step->dtype.code == kDLFloat && step->dtype.bits == 32);
+    const float* skip = nullptr;
+    if (has_skip_) {
+      DLTensor* skip_tensor = ir::Downcast<TensorValue>(inputs[2]);
+      skip = static_cast<const float*>(skip_tensor->data);
     }
     float beta3 = 1.0f;
     if (grad_averaging_ == 1) {
@@ -133,11 +134,11 @@ class LansImpl : public raf::op::OpEnv {
         }
         multi_tensor_lans_cuda<float>(
             CHUNK_SIZE, tlist, learning_rate_, beta1_, beta2_, eps_, bias_correction_,
-            bias_correction1, bias_correction2, beta3, weight_decay_, grad_averaging_, mode_,
+            static_cast<const float*>(step->data), beta3, weight_decay_, grad_averaging_, mode_,
             normalize_grad_, numels_, compute_stream, static_cast<float*>(output_per_tensor_),
             static_cast<float*>(grad_norm_tensor_), static_cast<float*>(param_norm_tensor_),
             static_cast<float*>(update_m_norm_), static_cast<float*>(q_norm_tensor_),
-            max_chunks_per_tensor_);
+            max_chunks_per_tensor_, skip);
         break;
       }
       default: {
@@ -174,6 +175,7 @@ class LansImpl : public raf::op::OpEnv {
   void* q_norm_tensor_;
   int max_chunks_per_tensor_;
   void* q_tensor_buf_;
+  bool has_skip_;
 };
 
 RAF_REGISTER_DIALECT_OP(cuda, lans, 20);
@@ -95,8 +95,16 @@ class LayerNormTrainImpl : public raf::op::OpEnv {
     float* mean_p = static_cast<float*>(mean->data);
     DLTensor* invvar = ir::Downcast<TensorValue>(out_tuple->fields[2]);
     float* invvar_p = static_cast<float*>(invvar->data);
+    // The warp-per-row kernel is more bandwidth efficient for small hidden sizes.
     switch (x->dtype.bits) {
       case 16: {
+        if (UseLayerNormWarp<Half>(n2_, {x->data, out->data, scale->data, bias->data})) {
+          HostApplyLayerNormWarp<Half>(static_cast<Half*>(out->data), mean_p, invvar_p,
+                                       static_cast<Half*>(x->data), n1_, n2_,
+                                       static_cast<Half*>(scale->data),
+                                       static_cast<Half*>(bias->data), eps_, {}, compute_stream_);
+          break;
+        }
         HostApplyLayerNorm<Half, float, Half>(
             static_cast<Half*>(out->data), mean_p, invvar_p, static_cast<Half*>(x->data), n1_, n2_,
             static_cast<Half*>(scale->data), static_cast<Half*>(bias->data), eps_, compute_stream_,
@@ -105,6 +113,14 @@ class LayerNormTrainImpl : public raf::op::OpEnv {
         break;
       }
       case 32: {
+        if (UseLayerNormWarp<float>(n2_, {x->data, out->data, scale->data, bias->data})) {
+          HostApplyLayerNormWarp<float>(static_cast<float*>(out->data), mean_p, invvar_p,
+                                        static_cast<float*>(x->data), n1_, n2_,
+                                        static_cast<float*>(scale->data),
+                                        static_cast<float*>(bias->data), eps_, {},
+                                        compute_stream_);
+          break;
+        }
         HostApplyLayerNorm<float, float, float>(
             static_cast<float*>(out->data), mean_p, invvar_p, static_cast<float*>(x->data), n1_,
             n2_, static_cast<float*>(scale->data), static_cast<float*>(bias->data), eps_,
@@ -0,0 +1,350 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/masked_softmax.cc
+ * \brief Fused scale + mask + softmax cuda backend
+ */
+#include <algorithm>
+#include "raf/op.h"
+#include "raf/op_utils.h"
+#include "raf/device_api.h"
+#include "./kernels/masked_softmax.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+using namespace raf::ir;
+using namespace raf::value;
+using device_api::DeviceAPI;
+
+using namespace c10;
+
+/*! \brief The common part of the fused masked softmax forward and backward. */
+class MaskedSoftmaxImplBase : public raf::op::OpEnv {
+ public:
+  /*! \brief Get the index of the fused function parameter, or -1 if expr is not a parameter. */
+  static int GetParamIndex(const Function& func, const Expr& expr) {
+    for (size_t i = 0; i < func->params.size(); ++i) {
+      if (func->params[i] == expr) {
+        return static_cast<int>(i);
+      }
+    }
+    return -1;
+  }
+
+  /*! \brief Whether the param of the fused function is the last axis. */
+  static bool IsLastAxis(const Function& func, const Array<Value>& args, const Expr& expr,
+                         int ndim) {
+    int index = GetParamIndex(func, expr);
+    if (index < 0) {
+      return false;
+    }
+    int64_t axis = GetScalarValueData<int64_t>(args[index]);
+    return axis == -1 || axis == ndim - 1;
+  }
+
+  /*!
+   * \brief Match the scale of multiply(x, scale) or divide(x, scale), which is a scalar in the
+   * dtype of x. Return the call argument of x, or an undefined expr if the call does not match.
+   */
+  Expr MatchScale(const Function& func, const Array<Value>& args, const CallNode* call,
+                  DLDataType dtype) {
+    static const Op& multiply_op = Op::Get("raf.op.cuda.multiply");
+    static const Op& divide_op = Op::Get("raf.op.cuda.divide");
+    if (!call || (call->op != multiply_op && call->op != divide_op)) {
+      return Expr();
+    }
+    int scale_index = GetParamIndex(func, call->args[1]);
+    if (scale_index < 0) {
+      return Expr();
+    }
+    const DLTensor* scale = Downcast<TensorValue>(args[scale_index]);
+    int64_t size = 1;
+    for (int i = 0; i < scale->ndim; ++i) {
+      size *= scale->shape[i];
+    }
+    if (size != 1 || scale->dtype != dtype) {
+      return Expr();
+    }
+    scale_index_ = scale_index;
+    scale_divide_ = call->op == divide_op;
+    return call->args[0];
+  }
+
+  /*! \brief Resolve the problem sizes from the output. */
+  void InitProblem(const DLTensor* out) {
+    CHECK(out->dtype.code == kDLFloat && (out->dtype.bits == 32 || out->dtype.bits == 16))
+        << "Unsupported dtype: " << DType(out->dtype).c_str();
+    CHECK_GE(out->ndim, 1);
+    cols_ = out->shape[out->ndim - 1];
+    rows_ = 1;
+    for (int i = 0; i < out->ndim - 1; ++i) {
+      rows_ *= out->shape[i];
+    }
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    compute_stream_ = cuda_device_api->GetStream();
+  }
+
+ protected:
+  int64_t rows_;
+  int cols_;
+  int scale_index_ = -1;
+  bool scale_divide_ = false;
+  void* compute_stream_;
+};
+
+class MaskedSoftmaxImpl : public MaskedSoftmaxImplBase {
+ public:
+  explicit MaskedSoftmaxImpl(const CallValues& cv) {
+  }
+
+  /*!
+   * \brief Initialize with a fused function of softmax(add(x * scale, mask), -1), where either
+   * the scale or the mask is optional, and the scale may be applied with divide. Return false if
+   * the body does not match.
+   */
+  bool InitFromFusedFunc(const CallValues& cv) {
+    static const Op& softmax_op = Op::Get("raf.op.cuda.softmax");
+    static const Op& add_op = Op::Get("raf.op.cuda.add");
+    Function func = Downcast<ClosureValue>(cv->callee)->func;
+    Array<Value> args = GetListArgs(cv->args);
+    const DLTensor* out = Downcast<TensorValue>(cv->out);
+
+    auto softmax = func->body.as<CallNode>();
+    if (!softmax || softmax->op != softmax_op ||
+        !IsLastAxis(func, args, softmax->args[1], out->ndim)) {
+      return false;
+    }
+    Expr x = softmax->args[0];
+    int mask_index = -1;
+    if (auto add = x.as<CallNode>()) {
+      if (add->op == add_op) {
+        mask_index = GetParamIndex(func, add->args[1]);
+        if (mask_index < 0) {
+          return false;
+        }
+        x = add->args[0];
+      }
+    }
+    if (auto scaled = x.as<CallNode>()) {
+      x = MatchScale(func, args, scaled, out->dtype);
+    }
+    int x_index = x.defined() ? GetParamIndex(func, x) : -1;
+    if (x_index < 0 || out->ndim - 1 > kMaxMaskedSoftmaxDims) {
+      return false;
+    }
+    this->arg_indices = {x_index};
+    const DLTensor* x_tensor = Downcast<TensorValue>(args[x_index]);
+    if (x_tensor->dtype != out->dtype) {
+      return false;
+    }
+    indexer_.ndim = out->ndim - 1;
+    SetBroadcastStrides(x_tensor, out, indexer_.x_strides, &indexer_.x_col_stride);
+    if (scale_index_ >= 0) {
+      this->arg_indices.push_back(scale_index_);
+    }
+    if (mask_index >= 0) {
+      const DLTensor* mask = Downcast<TensorValue>(args[mask_index]);
+      if (mask->dtype != out->dtype) {
+        return false;
+      }
+      SetBroadcastStrides(mask, out, indexer_.mask_strides, &indexer_.mask_col_stride);
+      has_mask_ = true;
+      this->arg_indices.push_back(mask_index);
+    }
+    for (int i = 0; i < indexer_.ndim; ++i) {
+      indexer_.shape[i] = out->shape[i];
+    }
+    InitProblem(out);
+    return true;
+  }
+
+  void Execute(const CallValues& cv) override {
+    Array<Value> args = GetListArgs(cv->args);
+    std::vector<Value> inputs;
+    for (int index : arg_indices) {
+      inputs.push_back(args[index]);
+    }
+    Execute(inputs, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    bool has_scale = scale_index_ >= 0;
+    DLTensor* x = ir::Downcast<TensorValue>(inputs[0]);
+    const void* scale = has_scale ? ir::Downcast<TensorValue>(inputs[1])->data : nullptr;
+    const void* mask = has_mask_ ? ir::Downcast<TensorValue>(inputs.back())->data : nullptr;
+    DLTensor* out = ir::Downcast<TensorValue>(output);
+    switch (out->dtype.bits) {
+      case 16: {
+        HostMaskedSoftmaxForward<Half>(
+            static_cast<Half*>(out->data), static_cast<const Half*>(x->data),
+            static_cast<const Half*>(scale), static_cast<const Half*>(mask), scale_divide_,
+            indexer_, rows_, cols_, compute_stream_);
+        break;
+      }
+      case 32: {
+        HostMaskedSoftmaxForward<float>(
+            static_cast<float*>(out->data), static_cast<const float*>(x->data),
+            static_cast<const float*>(scale), static_cast<const float*>(mask), scale_divide_,
+            indexer_, rows_, cols_, compute_stream_);
+        break;
+      }
+      default: {
+        LOG(FATAL) << "Unsupported dtype: " << DType(out->dtype).c_str();
+        throw;
+      }
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.masked_softmax"));
+  }
+
+  static OpEnv* MakeFused(const CallValues& cv) {
+    auto op_env = std::make_unique<MaskedSoftmaxImpl>(cv);
+    try {
+      if (!op_env->InitFromFusedFunc(cv)) {
+        dispatch_error_msgs.push_back("[CUDA] Cannot JIT: the fused masked softmax does not match");
+        return nullptr;
+      }
+    } catch (const dmlc::Error& e) {
+      std::stringstream ss;
+      ss << "[CUDA] Failed to JIT: " << e.what();
+      dispatch_error_msgs.push_back(ss.str());
+      return nullptr;
+    }
+    return op_env.release();
+  }
+
+ private:
+  /*!
+   * \brief Set the strides of t broadcast to the leading dims of out, and its stride along the
+   * last axis. The dims of t are aligned to the trailing dims of out.
+   */
+  static void SetBroadcastStrides(const DLTensor* t, const DLTensor* out, int64_t* strides,
+                                  int64_t* col_stride) {
+    CHECK_LE(t->ndim, out->ndim);
+    int offset = out->ndim - t->ndim;
+    int64_t stride = 1;
+    for (int i = out->ndim - 1; i >= 0; --i) {
+      int64_t dim = i >= offset ? t->shape[i - offset] : 1;
+      CHECK(dim == out->shape[i] || dim == 1) << "Cannot broadcast along axis " << i;
+      int64_t s = (dim == 1 && out->shape[i] != 1) ? 0 : stride;
+      if (i == out->ndim - 1) {
+        *col_stride = s;
+      } else {
+        strides[i] = s;
+      }
+      stride *= dim;
+    }
+  }
+
+  MaskedSoftmaxIndexer indexer_;
+  bool has_mask_ = false;
+};
+
+RAF_OP_ENV_MAKER("raf.op.cuda._fused_masked_softmax", MaskedSoftmaxImpl::MakeFused);
+
+class MaskedSoftmaxDxImpl : public MaskedSoftmaxImplBase {
+ public:
+  explicit MaskedSoftmaxDxImpl(const CallValues& cv) {
+  }
+
+  /*!
+   * \brief Initialize with a fused function of multiply(softmax_dx(y, dy, -1), scale), which is
+   * the gradient of the scores of the forward, where the scale may be applied with divide.
+   * Return false if the body does not match.
+   */
+  bool InitFromFusedFunc(const CallValues& cv) {
+    static const Op& softmax_dx_op = Op::Get("raf.op.cuda.softmax_dx");
+    Function func = Downcast<ClosureValue>(cv->callee)->func;
+    Array<Value> args = GetListArgs(cv->args);
+    const DLTensor* out = Downcast<TensorValue>(cv->out);
+
+    Expr dx = MatchScale(func, args, func->body.as<CallNode>(), out->dtype);
+    auto softmax_dx = dx.defined() ? dx.as<CallNode>() : nullptr;
+    if (!softmax_dx || softmax_dx->op != softmax_dx_op ||
+        !IsLastAxis(func, args, softmax_dx->args[2], out->ndim)) {
+      return false;
+    }
+    int y_index = GetParamIndex(func, softmax_dx->args[0]);
+    int dy_index = GetParamIndex(func, softmax_dx->args[1]);
+    if (y_index < 0 || dy_index < 0) {
+      return false;
+    }
+    for (int index : {y_index, dy_index}) {
+      const DLTensor* t = Downcast<TensorValue>(args[index]);
+      if (t->dtype != out->dtype || t->ndim != out->ndim ||
+          !std::equal(t->shape, t->shape + t->ndim, out->shape)) {
+        return false;
+      }
+    }
+    this->arg_indices = {y_index, dy_index, scale_index_};
+    InitProblem(out);
+    return true;
+  }
+
+  void Execute(const CallValues& cv) override {
+    Array<Value> args = GetListArgs(cv->args);
+    Execute(std::vector<Value>{args[arg_indices[0]], args[arg_indices[1]], args[arg_indices[2]]},
+            cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    DLTensor* y = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* dy = ir::Downcast<TensorValue>(inputs[1]);
+    DLTensor* scale = ir::Downcast<TensorValue>(inputs[2]);
+    DLTensor* out = ir::Downcast<TensorValue>(output);
+    switch (out->dtype.bits) {
+      case 16: {
+        HostMaskedSoftmaxBackward<Half>(
+            static_cast<Half*>(out->data), static_cast<const Half*>(y->data),
+            static_cast<const Half*>(dy->data), static_cast<const Half*>(scale->data),
+            scale_divide_, rows_, cols_, compute_stream_);
+        break;
+      }
+      case 32: {
+        HostMaskedSoftmaxBackward<float>(
+            static_cast<float*>(out->data), static_cast<const float*>(y->data),
+            static_cast<const float*>(dy->data), static_cast<const float*>(scale->data),
+            scale_divide_, rows_, cols_, compute_stream_);
+        break;
+      }
+      default: {
+        LOG(FATAL) << "Unsupported dtype: " << DType(out->dtype).c_str();
+        throw;
+      }
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.masked_softmax_dx"));
+  }
+
+  static OpEnv* MakeFused(const CallValues& cv) {
+    auto op_env = std::make_unique<MaskedSoftmaxDxImpl>(cv);
+    try {
+      if (!op_env->InitFromFusedFunc(cv)) {
+        dispatch_error_msgs.push_back(
+            "[CUDA] Cannot JIT: the fused masked softmax gradient does not match");
+        return nullptr;
+      }
+    } catch (const dmlc::Error& e) {
+      std::stringstream ss;
+      ss << "[CUDA] Failed to JIT: " << e.what();
+      dispatch_error_msgs.push_back(ss.str());
+      return nullptr;
+    }
+    return op_env.release();
+  }
+};
+
+RAF_OP_ENV_MAKER("raf.op.cuda._fused_masked_softmax_dx", MaskedSoftmaxDxImpl::MakeFused);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -5,21 +5,26 @@
 
 /*!
  * \file src/op/dialect/cuda/memory.cc
- * \brief Tensor fusion and defusion operators with asynchronous CUDA memory copy.
+ * \brief Tensor fusion and defusion operators with batched CUDA memory copy kernels, and the hints
+ * of the unified memory.
  */
 #include <cuda_runtime.h>
 #include <vector>
+#include "raf/device_api.h"
 #include "raf/op_utils.h"
 #include "raf/stream_pool.h"
 #include "../../schema/memory.h"
+#include "../../schema/ufunc.h"
 #include "../../../common/shape_utils.h"
 #include "../../../common/cuda_utils.h"
+#include "./kernels/kernel_util.cuh"
 
 namespace raf {
 namespace op {
 namespace cuda {
 
 using namespace raf::op::schema;
+using device_api::DeviceAPI;
 using raf::common::shape_utils::BytesCompactTensor;
 using raf::stream_pool::StreamTagEnum;
 
@@ -60,14 +65,12 @@ class CudaFuseTensor : public raf::op::OpEnv {
     // Fuse Tensor
     DLTensor* out = output;
     auto tv = Downcast<value::TupleValue>(inputs[0]);
-    size_t offset = 0;
+    std::vector<DLTensor*> tensors;
     for (int i = 0; i < tv->fields.size(); ++i) {
       DLTensor* x = tv->fields[i];
-      void* buffer_data_at_offset = reinterpret_cast<uint8_t*>(out->data) + offset;
-      CUDA_CALL(cudaMemcpyAsync(buffer_data_at_offset, x->data, tuple_sizes[i],
-                                cudaMemcpyDeviceToDevice, (cudaStream_t)stream));
-      offset += tuple_sizes[i];
+      tensors.push_back(x);
     }
+    multi_tensor_pack_cuda(tensors, out->data, stream);
   }
 
   static OpEnv* make(const CallValues& cv) {
@@ -113,16 +116,13 @@ class CudaDefuseTensor : public raf::op::OpEnv {
   void Execute(const std::vector<value::Value>& inputs, value::Value output) {
     // Defuse Tensor
     DLTensor* in = inputs[0];
-    int64_t nbytes = (in->dtype.bits + 7) / 8;
     auto& of = Downcast<value::TupleValue>(output)->fields;
-    size_t offset = 0;
+    std::vector<DLTensor*> tensors;
     for (int i = 0; i < tuple_sizes.size(); ++i) {
       DLTensor* x = of[i];
-      void* buffer_data_at_offset = reinterpret_cast<uint8_t*>(in->data) + offset;
-      CUDA_CALL(cudaMemcpyAsync(x->data, buffer_data_at_offset, tuple_sizes[i],
-                                cudaMemcpyDeviceToDevice, (cudaStream_t)stream));
-      offset += tuple_sizes[i];
+      tensors.push_back(x);
     }
+    multi_tensor_unpack_cuda(in->data, tensors, stream);
   }
 
   static OpEnv* make(const CallValues& cv) {
@@ -133,6 +133,80 @@ class CudaDefuseTensor : public raf::op::OpEnv {
 RAF_REGISTER_DIALECT_OP(cuda, defuse_tensor, 10);
 RAF_OP_ENV_MAKER("raf.op.cuda.defuse_tensor", CudaDefuseTensor::make);
 
+/*!
+ * \brief Migrate the pages of a managed tensor to the device (prefetch) or to the host (evict).
+ * The migrations run on a copy stream in order, so a prefetch never overtakes the eviction before
+ * it, and an eviction waits for the kernels issued before it on the compute stream. The tensors
+ * that are not allocated by cudaMallocManaged are skipped.
+ */
+class CudaMemoryHint : public raf::op::OpEnv {
+  void* stream;
+  cudaEvent_t event;
+  bool prefetch;
+
+  explicit CudaMemoryHint(const CallValues& cv, bool prefetch) : prefetch(prefetch) {
+    auto op = ir::Op::Get(prefetch ? "raf.op.memory_prefetch" : "raf.op.memory_evict");
+    auto fschema_index = ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    this->arg_indices = {fschema_index[op]("x")};
+    RequestStream(&stream, cv->device, StreamTagEnum::MemCpyCpuToCuda());
+    CUDA_CALL(cudaEventCreateWithFlags(&event, cudaEventDisableTiming));
+  }
+
+ public:
+  ~CudaMemoryHint() {
+    cudaEventDestroy(event);
+  }
+
+  std::string name() const override {
+    return TruncateName(
+        GetUniqueName(prefetch ? "raf.op.cuda.memory_prefetch" : "raf.op.cuda.memory_evict"));
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<UnaryArgs>();
+    Execute({args->x}, cv->out);
+  }
+
+  void Execute(const std::vector<value::Value>& inputs, value::Value output) override {
+    DLTensor* x = inputs[0];
+    cudaPointerAttributes attr;
+    if (cudaPointerGetAttributes(&attr, x->data) != cudaSuccess ||
+        attr.type != cudaMemoryTypeManaged) {
+      cudaGetLastError();
+      return;
+    }
+    size_t nbytes = BytesCompactTensor(*x);
+    auto cuda_stream = static_cast<cudaStream_t>(stream);
+    if (prefetch) {
+      CUDA_CALL(cudaMemAdvise(x->data, nbytes, cudaMemAdviseUnsetPreferredLocation,
+                              x->device.device_id));
+      CUDA_CALL(cudaMemPrefetchAsync(x->data, nbytes, x->device.device_id, cuda_stream));
+    } else {
+      static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+      auto compute_stream = static_cast<cudaStream_t>(cuda_device_api->GetStream());
+      CUDA_CALL(cudaEventRecord(event, compute_stream));
+      CUDA_CALL(cudaStreamWaitEvent(cuda_stream, event, 0));
+      // Prefer the host until the next prefetch, so a stray access from the device maps the pages
+      // remotely instead of migrating them back and evicting the pages in use.
+      CUDA_CALL(cudaMemAdvise(x->data, nbytes, cudaMemAdviseSetPreferredLocation, cudaCpuDeviceId));
+      CUDA_CALL(cudaMemPrefetchAsync(x->data, nbytes, cudaCpuDeviceId, cuda_stream));
+    }
+  }
+
+  static OpEnv* make_prefetch(const CallValues& cv) {
+    return new CudaMemoryHint(cv, true);
+  }
+
+  static OpEnv* make_evict(const CallValues& cv) {
+    return new CudaMemoryHint(cv, false);
+  }
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, memory_prefetch, 10);
+RAF_OP_ENV_MAKER("raf.op.cuda.memory_prefetch", CudaMemoryHint::make_prefetch);
+RAF_REGISTER_DIALECT_OP(cuda, memory_evict, 10);
+RAF_OP_ENV_MAKER("raf.op.cuda.memory_evict", CudaMemoryHint::make_evict);
+
 }  // namespace cuda
 }  // namespace op
 }  // namespace raf
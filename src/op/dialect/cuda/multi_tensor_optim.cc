@@ -0,0 +1,427 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/multi_tensor_optim.cc
+ * \brief Fused multi-tensor SGD, AdamW, LAMB, gradient clipping and loss scaling cuda backend
+ */
+#include <algorithm>
+#include "raf/op.h"
+#include "raf/device_api.h"
+#include "../../schema/optimizer.h"
+#include "./kernels/kernel_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+using namespace raf::value;
+using device_api::DeviceAPI;
+
+/*!
+ * \brief The common part of the fused optimizers, whose tensor list holds num_groups groups of
+ * ntensors tensors. Every group has a single dtype, which is either float32 or float16.
+ */
+class MultiTensorOptimImpl : public raf::op::OpEnv {
+ protected:
+  void InitTensorList(const std::vector<BaseTensorValue>& tensor_list, int num_groups) {
+    CHECK_EQ(tensor_list.size() % num_groups, 0);
+    ntensors_ = tensor_list.size() / num_groups;
+    for (int i = 0; i < ntensors_; ++i) {
+      const DLTensor* t = tensor_list[i];
+      int64_t numel = 1;
+      for (int j = 0; j < t->ndim; ++j) {
+        numel *= t->shape[j];
+      }
+      numels_.push_back(numel);
+      total_numel_ += numel;
+      max_chunks_per_tensor_ = std::max<int>(
+          max_chunks_per_tensor_, (numel + kMultiTensorChunkSize - 1) / kMultiTensorChunkSize);
+    }
+    for (int g = 0; g < num_groups; ++g) {
+      const DLTensor* t0 = tensor_list[g * ntensors_];
+      CHECK(t0->dtype.code == kDLFloat && (t0->dtype.bits == 32 || t0->dtype.bits == 16))
+          << "Unsupported dtype: " << DType(t0->dtype).c_str();
+      for (int i = 1; i < ntensors_; ++i) {
+        const DLTensor* t = tensor_list[g * ntensors_ + i];
+        CHECK(t->dtype == t0->dtype) << "The tensors of a group must have the same dtype";
+      }
+      is_half_.push_back(t0->dtype.bits == 16);
+    }
+  }
+
+  std::vector<void*> GetTensorLists(const Value& tuple) {
+    std::vector<void*> tensor_lists;
+    for (const auto& field : ir::Downcast<TupleValue>(tuple)->fields) {
+      DLTensor* t = ir::Downcast<TensorValue>(field);
+      tensor_lists.push_back(t->data);
+    }
+    return tensor_lists;
+  }
+
+  static Value MakeTuple(const std::vector<BaseTensorValue>& tensor_list) {
+    Array<Value> fields(tensor_list.begin(), tensor_list.end());
+    return TupleValue::make(fields);
+  }
+
+  /*! \brief Append the optional skip flag, which is always the last input, to the inputs. */
+  void InitSkip(const ir::Op& op, const ir::Optional<BaseTensorValue>& skip) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    has_skip_ = skip.defined();
+    if (has_skip_) {
+      this->arg_indices.push_back(fschema_index[op]("skip"));
+    }
+  }
+
+  static void PushSkip(const ir::Optional<BaseTensorValue>& skip, std::vector<Value>* inputs) {
+    if (skip.defined()) {
+      inputs->push_back(skip.value());
+    }
+  }
+
+  const float* GetSkip(const std::vector<Value>& inputs) {
+    if (!has_skip_) {
+      return nullptr;
+    }
+    DLTensor* skip = ir::Downcast<TensorValue>(inputs.back());
+    return static_cast<const float*>(skip->data);
+  }
+
+  int ntensors_;
+  std::vector<int> numels_;
+  std::vector<bool> is_half_;
+  int64_t total_numel_ = 0;
+  int max_chunks_per_tensor_ = 0;
+  bool has_skip_ = false;
+};
+
+class MultiSgdImpl : public MultiTensorOptimImpl {
+ public:
+  explicit MultiSgdImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.multi_sgd");
+    auto args = cv->args.as<op::schema::MultiSgdArgs>();
+    this->arg_indices = {
+        fschema_index[op]("tensor_list"),
+    };
+    learning_rate_ = args->learning_rate;
+    mu_ = args->mu;
+    master_weights_ = args->master_weights;
+    InitTensorList(args->tensor_list, 3 + master_weights_);
+    InitSkip(op, args->skip);
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::MultiSgdArgs>();
+    std::vector<Value> inputs{MakeTuple(args->tensor_list)};
+    PushSkip(args->skip, &inputs);
+    Execute(inputs, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    multi_tensor_sgd_cuda(GetTensorLists(inputs[0]), numels_, is_half_, master_weights_,
+                          learning_rate_, mu_, GetSkip(inputs), cuda_device_api->GetStream());
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.multi_sgd"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new MultiSgdImpl(cv);
+  }
+
+ private:
+  float learning_rate_;
+  float mu_;
+  bool master_weights_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, multi_sgd, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.multi_sgd", MultiSgdImpl::make);
+
+/*! \brief AdamW and LAMB share the arguments, and LAMB additionally requests the buffers. */
+template <typename TArgs, bool kLamb>
+class AdamImpl : public MultiTensorOptimImpl {
+ public:
+  explicit AdamImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get(kLamb ? "raf.op.lamb" : "raf.op.adamw");
+    auto args = cv->args.as<TArgs>();
+    this->arg_indices = {
+        fschema_index[op]("tensor_list"),
+        fschema_index[op]("step"),
+    };
+    learning_rate_ = args->learning_rate;
+    beta1_ = args->beta1;
+    beta2_ = args->beta2;
+    eps_ = args->eps;
+    weight_decay_ = args->weight_decay;
+    bias_correction_ = args->bias_correction;
+    master_weights_ = args->master_weights;
+    InitTensorList(args->tensor_list, 4 + master_weights_);
+    const DLTensor* step = args->step;
+    CHECK(step->device.device_type == kDLCUDA && step->dtype.code == kDLFloat &&
+          step->dtype.bits == 32 && step->ndim == 0)
+        << "The step is expected to be a float32 scalar on the device";
+    InitSkip(op, args->skip);
+    if (kLamb) {
+      RequestWorkspace(&update_, cv->device, sizeof(float) * total_numel_);
+      RequestWorkspace(&output_per_tensor_, cv->device,
+                       sizeof(float) * ntensors_ * max_chunks_per_tensor_);
+      RequestWorkspace(&weight_norm_, cv->device, sizeof(float) * ntensors_);
+      RequestWorkspace(&update_norm_, cv->device, sizeof(float) * ntensors_);
+    }
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<TArgs>();
+    std::vector<Value> inputs{MakeTuple(args->tensor_list), args->step};
+    PushSkip(args->skip, &inputs);
+    Execute(inputs, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    void* stream = cuda_device_api->GetStream();
+    DLTensor* step = ir::Downcast<TensorValue>(inputs[1]);
+    const float* step_ptr = static_cast<const float*>(step->data);
+    if (kLamb) {
+      multi_tensor_lamb_cuda(GetTensorLists(inputs[0]), numels_, is_half_, master_weights_,
+                             step_ptr, learning_rate_, beta1_, beta2_, eps_, weight_decay_,
+                             bias_correction_, static_cast<float*>(update_),
+                             static_cast<float*>(output_per_tensor_),
+                             static_cast<float*>(weight_norm_), static_cast<float*>(update_norm_),
+                             max_chunks_per_tensor_, GetSkip(inputs), stream);
+    } else {
+      multi_tensor_adamw_cuda(GetTensorLists(inputs[0]), numels_, is_half_, master_weights_,
+                              step_ptr, learning_rate_, beta1_, beta2_, eps_, weight_decay_,
+                              bias_correction_, GetSkip(inputs), stream);
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName(kLamb ? "raf.op.cuda.lamb" : "raf.op.cuda.adamw"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new AdamImpl<TArgs, kLamb>(cv);
+  }
+
+ private:
+  float learning_rate_;
+  float beta1_;
+  float beta2_;
+  float eps_;
+  float weight_decay_;
+  bool bias_correction_;
+  bool master_weights_;
+  void* update_ = nullptr;
+  void* output_per_tensor_ = nullptr;
+  void* weight_norm_ = nullptr;
+  void* update_norm_ = nullptr;
+};
+
+using AdamWImpl = AdamImpl<op::schema::AdamwArgs, false>;
+using LambImpl = AdamImpl<op::schema::LambArgs, true>;
+
+RAF_REGISTER_DIALECT_OP(cuda, adamw, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.adamw", AdamWImpl::make);
+RAF_REGISTER_DIALECT_OP(cuda, lamb, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.lamb", LambImpl::make);
+
+/*! \brief The norms of the tensors and the global norm, without the per-tensor l2norm calls. */
+class MultiTensorL2normImpl : public MultiTensorOptimImpl {
+ public:
+  explicit MultiTensorL2normImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.multi_tensor_l2norm");
+    auto args = cv->args.as<op::schema::MultiTensorL2normArgs>();
+    this->arg_indices = {
+        fschema_index[op]("tensor_list"),
+    };
+    InitTensorList(args->tensor_list, 1);
+    RequestWorkspace(&output_per_tensor_, cv->device,
+                     sizeof(float) * ntensors_ * max_chunks_per_tensor_);
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::MultiTensorL2normArgs>();
+    Execute(std::vector<Value>{MakeTuple(args->tensor_list)}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    TupleValue out_tuple = ir::Downcast<TupleValue>(output);
+    DLTensor* norms = ir::Downcast<TensorValue>(out_tuple->fields[0]);
+    DLTensor* global_norm = ir::Downcast<TensorValue>(out_tuple->fields[1]);
+    multi_tensor_norms_cuda(GetTensorLists(inputs[0]), numels_, is_half_[0],
+                            static_cast<float*>(output_per_tensor_),
+                            static_cast<float*>(norms->data),
+                            static_cast<float*>(global_norm->data), max_chunks_per_tensor_,
+                            cuda_device_api->GetStream());
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.multi_tensor_l2norm"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new MultiTensorL2normImpl(cv);
+  }
+
+ private:
+  void* output_per_tensor_ = nullptr;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, multi_tensor_l2norm, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.multi_tensor_l2norm", MultiTensorL2normImpl::make);
+
+class MultiTensorClipImpl : public MultiTensorOptimImpl {
+ public:
+  explicit MultiTensorClipImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.multi_tensor_clip");
+    auto args = cv->args.as<op::schema::MultiTensorClipArgs>();
+    this->arg_indices = {
+        fschema_index[op]("tensor_list"),
+        fschema_index[op]("norm"),
+    };
+    max_norm_ = args->max_norm;
+    eps_ = args->eps;
+    InitTensorList(args->tensor_list, 1);
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::MultiTensorClipArgs>();
+    Execute(std::vector<Value>{MakeTuple(args->tensor_list), args->norm}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    DLTensor* norm = ir::Downcast<TensorValue>(inputs[1]);
+    multi_tensor_clip_cuda(GetTensorLists(inputs[0]), numels_, is_half_[0],
+                           static_cast<const float*>(norm->data), max_norm_, eps_,
+                           cuda_device_api->GetStream());
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.multi_tensor_clip"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new MultiTensorClipImpl(cv);
+  }
+
+ private:
+  float max_norm_;
+  float eps_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, multi_tensor_clip, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.multi_tensor_clip", MultiTensorClipImpl::make);
+
+/*! \brief Unscale the grads in place, whose overflow flag is a new output. */
+class MultiTensorUnscaleImpl : public MultiTensorOptimImpl {
+ public:
+  explicit MultiTensorUnscaleImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.multi_tensor_unscale");
+    auto args = cv->args.as<op::schema::MultiTensorUnscaleArgs>();
+    this->arg_indices = {
+        fschema_index[op]("tensor_list"),
+        fschema_index[op]("loss_scale"),
+    };
+    InitTensorList(args->tensor_list, 1);
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::MultiTensorUnscaleArgs>();
+    Execute(std::vector<Value>{MakeTuple(args->tensor_list), args->loss_scale}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    DLTensor* scale = ir::Downcast<TensorValue>(inputs[1]);
+    TupleValue out_tuple = ir::Downcast<TupleValue>(output);
+    DLTensor* found_inf = ir::Downcast<TensorValue>(out_tuple->fields[ntensors_]);
+    multi_tensor_unscale_cuda(GetTensorLists(inputs[0]), numels_, is_half_[0],
+                              static_cast<const float*>(scale->data),
+                              static_cast<float*>(found_inf->data), cuda_device_api->GetStream());
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.multi_tensor_unscale"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new MultiTensorUnscaleImpl(cv);
+  }
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, multi_tensor_unscale, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.multi_tensor_unscale", MultiTensorUnscaleImpl::make);
+
+/*! \brief Update the loss scale and the growth tracker in place by the overflow flag. */
+class UpdateLossScaleImpl : public raf::op::OpEnv {
+ public:
+  explicit UpdateLossScaleImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.update_loss_scale");
+    auto args = cv->args.as<op::schema::UpdateLossScaleArgs>();
+    this->arg_indices = {
+        fschema_index[op]("loss_scale"),
+        fschema_index[op]("growth_tracker"),
+        fschema_index[op]("found_inf"),
+    };
+    growth_factor_ = args->growth_factor;
+    backoff_factor_ = args->backoff_factor;
+    growth_interval_ = args->growth_interval;
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::UpdateLossScaleArgs>();
+    Execute(std::vector<Value>{args->loss_scale, args->growth_tracker, args->found_inf}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    DLTensor* scale = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* growth_tracker = ir::Downcast<TensorValue>(inputs[1]);
+    DLTensor* found_inf = ir::Downcast<TensorValue>(inputs[2]);
+    update_loss_scale_cuda(static_cast<float*>(scale->data),
+                           static_cast<float*>(growth_tracker->data),
+                           static_cast<const float*>(found_inf->data), growth_factor_,
+                           backoff_factor_, growth_interval_, cuda_device_api->GetStream());
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.update_loss_scale"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new UpdateLossScaleImpl(cv);
+  }
+
+ private:
+  float growth_factor_;
+  float backoff_factor_;
+  int growth_interval_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, update_loss_scale, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.update_loss_scale", UpdateLossScaleImpl::make);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
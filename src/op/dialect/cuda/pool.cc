@@ -0,0 +1,207 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/pool.cc
+ * \brief Global and NHWC pooling cuda backends. The other pooling falls back to cuDNN or TVM.
+ */
+#include <algorithm>
+#include <tuple>
+#include "raf/op.h"
+#include "raf/op_utils.h"
+#include "raf/device_api.h"
+#include "../../schema/nn.h"
+#include "./kernels/pool.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+using namespace raf::value;
+using device_api::DeviceAPI;
+
+using namespace c10;
+
+/*! \brief The common part of the pooling, which runs either the global or the NHWC kernels. */
+class PoolImplBase : public raf::op::OpEnv {
+ public:
+  /*! \brief Whether x is float32 or float16 in a 4D layout that the kernels support. */
+  static bool IsSupported(const DLTensor* x, const std::string& layout) {
+    bool dtype_ok = x->dtype.code == kDLFloat && (x->dtype.bits == 32 || x->dtype.bits == 16);
+    return dtype_ok && x->ndim == 4 && (layout == "NCHW" || layout == "NHWC");
+  }
+
+  /*! \brief Get the (h, w) of a 4D tensor in NCHW or NHWC. */
+  static std::pair<int64_t, int64_t> GetHW(const DLTensor* x, bool nhwc) {
+    return nhwc ? std::make_pair(x->shape[1], x->shape[2])
+                : std::make_pair(x->shape[2], x->shape[3]);
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda." + op_name_));
+  }
+
+  void Execute(const CallValues& cv) override {
+    Execute(std::vector<Value>{GetX(cv)}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    CHECK_EQ(inputs.size(), 1);
+    DLTensor* x = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* y = ir::Downcast<TensorValue>(output);
+    switch (x->dtype.bits) {
+      case 16: {
+        Run<Half>(static_cast<Half*>(x->data), static_cast<Half*>(y->data));
+        break;
+      }
+      case 32: {
+        Run<float>(static_cast<float*>(x->data), static_cast<float*>(y->data));
+        break;
+      }
+      default: {
+        LOG(FATAL) << "Unsupported dtype: " << DType(x->dtype).c_str();
+        throw;
+      }
+    }
+  }
+
+ protected:
+  PoolImplBase(const std::string& op_name, bool is_max, bool global, bool nhwc,
+               const PoolWindow& window, const DLTensor* x, const DLTensor* y)
+      : op_name_(op_name), is_max_(is_max), global_(global), nhwc_(nhwc), window_(window) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    auto op = ir::Op::Get("raf.op." + op_name);
+    this->arg_indices = {fschema_index[op]("x")};
+    n_ = x->shape[0];
+    c_ = x->shape[nhwc ? 3 : 1];
+    std::tie(h_, w_) = GetHW(x, nhwc);
+    std::tie(out_h_, out_w_) = GetHW(y, nhwc);
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    compute_stream_ = cuda_device_api->GetStream();
+  }
+
+  virtual Value GetX(const CallValues& cv) = 0;
+
+  template <typename T>
+  void Run(const T* x, T* y) {
+    if (global_) {
+      HostGlobalPool<T>(x, y, n_, c_, h_ * w_, nhwc_, is_max_, compute_stream_);
+    } else {
+      HostPool2dNHWC<T>(x, y, n_, h_, w_, c_, out_h_, out_w_, window_, is_max_, compute_stream_);
+    }
+  }
+
+  std::string op_name_;
+  bool is_max_, global_, nhwc_;
+  PoolWindow window_;
+  int n_, c_, h_, w_, out_h_, out_w_;
+  void* compute_stream_;
+};
+
+template <bool IS_MAX>
+class Pool2DImpl : public PoolImplBase {
+ public:
+  static OpEnv* make(const CallValues& cv) {
+    auto args = cv->args.as<op::schema::PoolArgs>();
+    const DLTensor* x = args->x;
+    const DLTensor* y = cv->out;
+    if (!IsSupported(x, args->layout)) {
+      dispatch_error_msgs.push_back("[CUDA] Unsupported dtype or layout of the pooling");
+      return nullptr;
+    }
+    std::vector<int64_t> kernel = Pad<2>(args->kernel);
+    std::vector<int64_t> stride = args->stride.empty() ? kernel : Pad<2>(args->stride);
+    std::vector<int64_t> dilation = Pad<2>(args->dilation);
+    std::vector<int64_t> padding = args->padding.size() == 4U ? args->padding
+                                                              : Pad<2>(args->padding);
+    if (padding.size() == 2U) {
+      padding = {padding[0], padding[1], padding[0], padding[1]};
+    }
+    bool nhwc = args->layout == "NHWC";
+    auto hw = GetHW(x, nhwc);
+    auto out_hw = GetHW(y, nhwc);
+    bool no_pad = std::all_of(padding.begin(), padding.end(), [](int64_t p) { return p == 0; });
+    bool global = out_hw.first == 1 && out_hw.second == 1 && no_pad && kernel[0] == hw.first &&
+                  kernel[1] == hw.second;
+    if (dilation[0] != 1 || dilation[1] != 1 || (!global && !nhwc)) {
+      dispatch_error_msgs.push_back(
+          "[CUDA] Only the global pooling and the undilated NHWC pooling are supported");
+      return nullptr;
+    }
+    PoolWindow window;
+    window.kernel_h = kernel[0];
+    window.kernel_w = kernel[1];
+    window.stride_h = stride[0];
+    window.stride_w = stride[1];
+    window.pad_top = padding[0];
+    window.pad_left = padding[1];
+    window.pad_bottom = padding[2];
+    window.pad_right = padding[3];
+    window.adaptive = false;
+    window.include_pad = args->include_pad;
+    return new Pool2DImpl(global, nhwc, window, x, y);
+  }
+
+ protected:
+  Pool2DImpl(bool global, bool nhwc, const PoolWindow& window, const DLTensor* x,
+             const DLTensor* y)
+      : PoolImplBase(IS_MAX ? "max_pool2d" : "avg_pool2d", IS_MAX, global, nhwc, window, x, y) {
+  }
+
+  Value GetX(const CallValues& cv) override {
+    return cv->args.as<op::schema::PoolArgs>()->x;
+  }
+};
+
+template <bool IS_MAX>
+class AdaptivePool2DImpl : public PoolImplBase {
+ public:
+  static OpEnv* make(const CallValues& cv) {
+    auto args = cv->args.as<op::schema::AdaptivePoolArgs>();
+    const DLTensor* x = args->x;
+    const DLTensor* y = cv->out;
+    if (!IsSupported(x, args->layout)) {
+      dispatch_error_msgs.push_back("[CUDA] Unsupported dtype or layout of the pooling");
+      return nullptr;
+    }
+    bool nhwc = args->layout == "NHWC";
+    auto out_hw = GetHW(y, nhwc);
+    bool global = out_hw.first == 1 && out_hw.second == 1;
+    if (!global && !nhwc) {
+      dispatch_error_msgs.push_back(
+          "[CUDA] Only the adaptive pooling to 1x1 and the NHWC adaptive pooling are supported");
+      return nullptr;
+    }
+    PoolWindow window = {};
+    window.adaptive = true;
+    return new AdaptivePool2DImpl(global, nhwc, window, x, y);
+  }
+
+ protected:
+  AdaptivePool2DImpl(bool global, bool nhwc, const PoolWindow& window, const DLTensor* x,
+                     const DLTensor* y)
+      : PoolImplBase(IS_MAX ? "adaptive_max_pool2d" : "adaptive_avg_pool2d", IS_MAX, global,
+                     nhwc, window, x, y) {
+  }
+
+  Value GetX(const CallValues& cv) override {
+    return cv->args.as<op::schema::AdaptivePoolArgs>()->x;
+  }
+};
+
+// The plevels are above cuDNN, whose kernels serve the shapes that these kernels reject.
+RAF_REGISTER_DIALECT_OP(cuda, max_pool2d, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.max_pool2d", Pool2DImpl<true>::make);
+RAF_REGISTER_DIALECT_OP(cuda, avg_pool2d, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.avg_pool2d", Pool2DImpl<false>::make);
+RAF_REGISTER_DIALECT_OP(cuda, adaptive_max_pool2d, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.adaptive_max_pool2d", AdaptivePool2DImpl<true>::make);
+RAF_REGISTER_DIALECT_OP(cuda, adaptive_avg_pool2d, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.adaptive_avg_pool2d", AdaptivePool2DImpl<false>::make);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
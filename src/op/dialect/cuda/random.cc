@@ -0,0 +1,112 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/random.cc
+ * \brief Threefry random number generator cuda backend, which produces the same bits as the TVM
+ * dialect.
+ */
+#include "raf/op.h"
+#include "raf/device_api.h"
+#include "../../schema/random.h"
+#include "./kernels/threefry.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+using namespace raf::value;
+using device_api::DeviceAPI;
+
+class ThreefryGenerateImpl : public raf::op::OpEnv {
+ public:
+  explicit ThreefryGenerateImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.threefry_generate");
+    auto args = cv->args.as<op::schema::ThreefryGenerateArgs>();
+    this->arg_indices = {fschema_index[op]("key")};
+    DLTensor* key = args->key;
+    CHECK(key->ndim == 1 && key->shape[0] == 10) << "The key must be a threefry key of 10 words";
+    n_ = 1;
+    for (int64_t dim : args->shape) {
+      n_ *= dim;
+    }
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::ThreefryGenerateArgs>();
+    Execute(std::vector<Value>{args->key}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    DLTensor* key = ir::Downcast<TensorValue>(inputs[0]);
+    auto tv = ir::Downcast<TupleValue>(output);
+    DLTensor* new_key = ir::Downcast<TensorValue>(tv->fields[0]);
+    DLTensor* out = ir::Downcast<TensorValue>(tv->fields[1]);
+    HostThreefryGenerate(static_cast<uint64_t*>(new_key->data), static_cast<uint64_t*>(out->data),
+                         static_cast<const uint64_t*>(key->data), n_,
+                         cuda_device_api->GetStream());
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.threefry_generate"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new ThreefryGenerateImpl(cv);
+  }
+
+ private:
+  /*! \brief The number of random values to generate. */
+  int64_t n_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, threefry_generate, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.threefry_generate", ThreefryGenerateImpl::make);
+
+class ThreefrySplitImpl : public raf::op::OpEnv {
+ public:
+  explicit ThreefrySplitImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.threefry_split");
+    auto args = cv->args.as<op::schema::ThreefrySplitArgs>();
+    this->arg_indices = {fschema_index[op]("key")};
+    DLTensor* key = args->key;
+    CHECK(key->ndim == 1 && key->shape[0] == 10) << "The key must be a threefry key of 10 words";
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::ThreefrySplitArgs>();
+    Execute(std::vector<Value>{args->key}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    DLTensor* key = ir::Downcast<TensorValue>(inputs[0]);
+    auto tv = ir::Downcast<TupleValue>(output);
+    DLTensor* left = ir::Downcast<TensorValue>(tv->fields[0]);
+    DLTensor* right = ir::Downcast<TensorValue>(tv->fields[1]);
+    HostThreefrySplit(static_cast<uint64_t*>(left->data), static_cast<uint64_t*>(right->data),
+                      static_cast<const uint64_t*>(key->data), cuda_device_api->GetStream());
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.threefry_split"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new ThreefrySplitImpl(cv);
+  }
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, threefry_split, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.threefry_split", ThreefrySplitImpl::make);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,133 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/reduce.cc
+ * \brief moments cuda backend
+ */
+#include <algorithm>
+#include <limits>
+#include "raf/op.h"
+#include "raf/device_api.h"
+#include "../../schema/reduce.h"
+#include "./kernels/moments.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+using namespace raf::value;
+using device_api::DeviceAPI;
+
+using namespace c10;
+
+/*!
+ * \brief View x as [outer, reduce, inner] by the reduced axes. Returns false if the reduced axes
+ * are not consecutive, so they cannot be merged into one axis without a transpose.
+ */
+bool GetReduceView(const DLTensor* x, const schema::ReduceArgs* args, int64_t* outer,
+                   int64_t* reduce, int64_t* inner) {
+  int ndim = x->ndim;
+  std::vector<bool> reduced(ndim, args->axis.empty());
+  for (int64_t i : args->axis) {
+    reduced[i < 0 ? i + ndim : i] = true;
+  }
+  if (args->exclude) {
+    reduced.flip();
+  }
+  auto first = std::find(reduced.begin(), reduced.end(), true);
+  auto last = std::find(first, reduced.end(), false);
+  if (std::find(last, reduced.end(), true) != reduced.end()) {
+    return false;
+  }
+  *outer = *reduce = *inner = 1;
+  for (int i = 0; i < ndim; ++i) {
+    int64_t* dim = reduced[i] ? reduce : (i < first - reduced.begin() ? outer : inner);
+    *dim *= x->shape[i];
+  }
+  return true;
+}
+
+/*! \brief The single-pass Welford moments, which computes the mean and the variance together. */
+class MomentsImpl : public raf::op::OpEnv {
+ public:
+  explicit MomentsImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.moments");
+    auto args = cv->args.as<op::schema::ReduceArgs>();
+    this->arg_indices = {fschema_index[op]("x")};
+    GetReduceView(args->x, args, &outer_, &reduce_, &inner_);
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    compute_stream_ = cuda_device_api->GetStream();
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::ReduceArgs>();
+    Execute(std::vector<Value>{args->x}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    DLTensor* x = ir::Downcast<TensorValue>(inputs[0]);
+    TupleValue out_tuple = ir::Downcast<TupleValue>(output);
+    DLTensor* mean = ir::Downcast<TensorValue>(out_tuple->fields[0]);
+    DLTensor* var = ir::Downcast<TensorValue>(out_tuple->fields[1]);
+    switch (x->dtype.bits) {
+      case 16: {
+        HostMoments<Half>(static_cast<Half*>(x->data), static_cast<Half*>(mean->data),
+                          static_cast<Half*>(var->data), outer_, reduce_, inner_, compute_stream_);
+        break;
+      }
+      case 32: {
+        HostMoments<float>(static_cast<float*>(x->data), static_cast<float*>(mean->data),
+                           static_cast<float*>(var->data), outer_, reduce_, inner_,
+                           compute_stream_);
+        break;
+      }
+      default: {
+        LOG(FATAL) << "Unsupported dtype: " << DType(x->dtype).c_str();
+        throw;
+      }
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.moments"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    auto args = cv->args.as<op::schema::ReduceArgs>();
+    const DLTensor* x = args->x;
+    int64_t outer, reduce, inner;
+    std::string reason;
+    if (x->dtype.code != kDLFloat || (x->dtype.bits != 16 && x->dtype.bits != 32)) {
+      reason = "unsupported dtype " + std::string(DType(x->dtype).c_str());
+    } else if (!GetReduceView(x, args, &outer, &reduce, &inner)) {
+      reason = "the reduced axes are not consecutive";
+    } else if (outer * reduce * inner == 0) {
+      reason = "empty input";
+    } else if (outer * reduce * inner > std::numeric_limits<int>::max()) {
+      reason = "too many elements";
+    }
+    if (!reason.empty()) {
+      dispatch_error_msgs.push_back("[CUDA] Cannot compute the moments: " + reason);
+      return nullptr;
+    }
+    return new MomentsImpl(cv);
+  }
+
+ private:
+  int64_t outer_;
+  int64_t reduce_;
+  int64_t inner_;
+  void* compute_stream_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, moments, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.moments", MomentsImpl::make);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,92 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/sparse_sgd.cc
+ * \brief Row-sparse SGD cuda backend
+ */
+#include "raf/op.h"
+#include "raf/device_api.h"
+#include "../../schema/optimizer.h"
+#include "./kernels/kernel_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+using namespace raf::value;
+using device_api::DeviceAPI;
+
+class SparseSgdImpl : public raf::op::OpEnv {
+ public:
+  explicit SparseSgdImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.sparse_sgd");
+    auto args = cv->args.as<op::schema::SparseSgdArgs>();
+    this->arg_indices = {
+        fschema_index[op]("x"),
+        fschema_index[op]("rows"),
+        fschema_index[op]("values"),
+        fschema_index[op]("v"),
+    };
+    learning_rate_ = args->learning_rate;
+    mu_ = args->mu;
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::SparseSgdArgs>();
+    Execute(std::vector<value::Value>{args->x, args->rows, args->values, args->v}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    DLTensor* x = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* rows = ir::Downcast<TensorValue>(inputs[1]);
+    DLTensor* values = ir::Downcast<TensorValue>(inputs[2]);
+    DLTensor* v = ir::Downcast<TensorValue>(inputs[3]);
+    int num = rows->shape[0];
+    int stride = x->shape[1];
+
+    CHECK(x->dtype.code == kDLFloat);
+    CHECK(values->dtype == x->dtype && v->dtype == x->dtype);
+    switch (x->dtype.bits) {
+      case 32:
+        sparse_sgd_cuda<float>(static_cast<float*>(x->data), static_cast<float*>(v->data),
+                               static_cast<const int64_t*>(rows->data),
+                               static_cast<const float*>(values->data), num, stride,
+                               learning_rate_, mu_, cuda_device_api->GetStream());
+        return;
+      case 16:
+        sparse_sgd_cuda<__half>(static_cast<__half*>(x->data), static_cast<__half*>(v->data),
+                                static_cast<const int64_t*>(rows->data),
+                                static_cast<const __half*>(values->data), num, stride,
+                                learning_rate_, mu_, cuda_device_api->GetStream());
+        return;
+      default:
+        LOG(FATAL) << "Unsupported dtype: " << DType(x->dtype).c_str();
+        throw;
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.sparse_sgd"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new SparseSgdImpl(cv);
+  }
+
+ private:
+  float learning_rate_;
+  float mu_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, sparse_sgd, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.sparse_sgd", SparseSgdImpl::make);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,117 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/transpose.cc
+ * \brief Transpose cuda backend
+ */
+#include <numeric>
+#include "raf/op.h"
+#include "raf/dialect.h"
+#include "raf/device_api.h"
+#include "../../schema/transform.h"
+#include "./kernels/transpose.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+using namespace raf::value;
+using device_api::DeviceAPI;
+
+/*!
+ * \brief The transpose of a tensor by the permutation of its dims, which implements transpose,
+ * transpose_dx and swap_axis.
+ */
+class TransposeImpl : public raf::op::OpEnv {
+ public:
+  explicit TransposeImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    Op op = Downcast<OpValue>(cv->callee)->op;
+    op = IsDialectOp(op) ? GetBaseOp(op) : op;
+    static auto transpose_dx_op = Op::Get("raf.op.transpose_dx");
+    static auto swap_axis_op = Op::Get("raf.op.swap_axis");
+    DLTensor* x;
+    int ndim;
+    if (op.same_as(swap_axis_op)) {
+      auto args = cv->args.as<op::schema::SwapAxisArgs>();
+      x = args->x;
+      ndim = x->ndim;
+      axes_.resize(ndim);
+      std::iota(axes_.begin(), axes_.end(), 0);
+      std::swap(axes_[args->axis1], axes_[args->axis2]);
+    } else {
+      auto args = cv->args.as<op::schema::TransposeArgs>();
+      x = args->x;
+      ndim = x->ndim;
+      axes_.resize(ndim);
+      if (args->axes.empty()) {
+        // Reverse the dims by default, which is the inverse of itself.
+        for (int i = 0; i < ndim; ++i) {
+          axes_[i] = ndim - 1 - i;
+        }
+      } else {
+        CHECK_EQ(args->axes.size(), ndim);
+        for (int i = 0; i < ndim; ++i) {
+          int64_t axis = args->axes[i] >= 0 ? args->axes[i] : args->axes[i] + ndim;
+          if (op.same_as(transpose_dx_op)) {
+            // The gradient permutes dy by the inverse of axes.
+            axes_[axis] = i;
+          } else {
+            axes_[i] = axis;
+          }
+        }
+      }
+    }
+    this->arg_indices = {fschema_index[op]("x")};
+    shape_.assign(x->shape, x->shape + ndim);
+    elem_bytes_ = (x->dtype.bits * x->dtype.lanes + 7) / 8;
+  }
+
+  void Execute(const CallValues& cv) override {
+    Value x;
+    if (auto args = cv->args.as<op::schema::SwapAxisArgs>()) {
+      x = args->x;
+    } else {
+      x = cv->args.as<op::schema::TransposeArgs>()->x;
+    }
+    Execute(std::vector<Value>{x}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    DLTensor* x = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* out = ir::Downcast<TensorValue>(output);
+    HostTranspose(x->data, out->data, shape_, axes_, elem_bytes_, cuda_device_api->GetStream());
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.transpose"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new TransposeImpl(cv);
+  }
+
+ private:
+  /*! \brief The shape of the input. */
+  std::vector<int64_t> shape_;
+  /*! \brief Dim i of the output is dim axes_[i] of the input. */
+  std::vector<int64_t> axes_;
+  /*! \brief The size of an element in bytes. */
+  int elem_bytes_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, transpose, 20);
+RAF_REGISTER_DIALECT_OP(cuda, transpose_dx, 20);
+RAF_REGISTER_DIALECT_OP(cuda, swap_axis, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.transpose", TransposeImpl::make);
+RAF_OP_ENV_MAKER("raf.op.cuda.transpose_dx", TransposeImpl::make);
+RAF_OP_ENV_MAKER("raf.op.cuda.swap_axis", TransposeImpl::make);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
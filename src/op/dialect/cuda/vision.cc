@@ -0,0 +1,354 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/vision.cc
+ * \brief get_valid_counts, non_max_suppression, roi_align and roi_align_dx cuda backend
+ */
+#include <limits>
+#include "raf/op.h"
+#include "raf/device_api.h"
+#include "../../schema/vision.h"
+#include "./kernels/vision.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+using namespace raf::value;
+using device_api::DeviceAPI;
+
+namespace {
+
+/*! \brief Whether the tensor is of the dtype, where the code is kDLFloat or kDLInt. */
+inline bool IsDType(const DLTensor* x, DLDataTypeCode code, int bits) {
+  return x->dtype.code == code && x->dtype.bits == bits && x->dtype.lanes == 1;
+}
+
+inline int64_t NumElements(const DLTensor* x) {
+  int64_t n = 1;
+  for (int i = 0; i < x->ndim; ++i) {
+    n *= x->shape[i];
+  }
+  return n;
+}
+
+/*! \brief Whether the tensor holds a single element of the dtype, which is read on the device. */
+inline bool IsScalar(const DLTensor* x, DLDataTypeCode code, int bits) {
+  return NumElements(x) == 1 && IsDType(x, code, bits);
+}
+
+}  // namespace
+
+class GetValidCountsImpl : public raf::op::OpEnv {
+ public:
+  explicit GetValidCountsImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.get_valid_counts");
+    auto args = cv->args.as<op::schema::GetValidCountsArgs>();
+    this->arg_indices = {fschema_index[op]("data"), fschema_index[op]("score_threshold")};
+    id_index_ = args->id_index;
+    score_index_ = args->score_index;
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    compute_stream_ = cuda_device_api->GetStream();
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::GetValidCountsArgs>();
+    Execute(std::vector<Value>{args->data, args->score_threshold}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    DLTensor* data = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* score_threshold = ir::Downcast<TensorValue>(inputs[1]);
+    TupleValue out_tuple = ir::Downcast<TupleValue>(output);
+    DLTensor* valid_count = ir::Downcast<TensorValue>(out_tuple->fields[0]);
+    DLTensor* out = ir::Downcast<TensorValue>(out_tuple->fields[1]);
+    DLTensor* out_indices = ir::Downcast<TensorValue>(out_tuple->fields[2]);
+    HostGetValidCounts(static_cast<const float*>(data->data),
+                       static_cast<const float*>(score_threshold->data),
+                       static_cast<int*>(valid_count->data), static_cast<float*>(out->data),
+                       static_cast<int*>(out_indices->data), data->shape[0], data->shape[1],
+                       data->shape[2], id_index_, score_index_, compute_stream_);
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.get_valid_counts"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    auto args = cv->args.as<op::schema::GetValidCountsArgs>();
+    const DLTensor* data = args->data;
+    std::string reason;
+    if (!IsDType(data, kDLFloat, 32)) {
+      reason = "unsupported dtype " + std::string(DType(data->dtype).c_str());
+    } else if (!IsScalar(args->score_threshold, kDLFloat, 32)) {
+      reason = "the score threshold is not a float32 scalar";
+    } else if (args->score_index >= data->shape[2] || args->id_index >= data->shape[2]) {
+      reason = "the score or id index is out of the box";
+    } else if (NumElements(data) > std::numeric_limits<int>::max()) {
+      reason = "too many elements";
+    }
+    if (!reason.empty()) {
+      dispatch_error_msgs.push_back("[CUDA] Cannot get the valid counts: " + reason);
+      return nullptr;
+    }
+    return new GetValidCountsImpl(cv);
+  }
+
+ private:
+  int id_index_;
+  int score_index_;
+  void* compute_stream_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, get_valid_counts, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.get_valid_counts", GetValidCountsImpl::make);
+
+/*! \brief The bitmask NMS, which computes the IoU of all pairs of the top-k boxes in parallel. */
+class NonMaxSuppressionImpl : public raf::op::OpEnv {
+ public:
+  explicit NonMaxSuppressionImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.non_max_suppression");
+    auto args = cv->args.as<op::schema::NonMaxSuppressionArgs>();
+    this->arg_indices = {
+        fschema_index[op]("data"),          fschema_index[op]("valid_count"),
+        fschema_index[op]("indices"),       fschema_index[op]("max_output_size"),
+        fschema_index[op]("iou_threshold"),
+    };
+    const DLTensor* data = args->data;
+    params_.batch = data->shape[0];
+    params_.num_anchors = data->shape[1];
+    params_.elem_length = data->shape[2];
+    params_.top_k = args->top_k;
+    params_.coord_start = args->coord_start;
+    params_.score_index = args->score_index;
+    params_.id_index = args->id_index;
+    params_.force_suppress = args->force_suppress;
+    params_.return_indices = args->return_indices;
+    params_.invalid_to_bottom = args->invalid_to_bottom;
+    RequestWorkspace(&workspace_, cv->device,
+                     NmsWorkspaceBytes(params_.batch, params_.num_anchors));
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    compute_stream_ = cuda_device_api->GetStream();
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::NonMaxSuppressionArgs>();
+    Execute(std::vector<Value>{args->data, args->valid_count, args->indices,
+                               args->max_output_size, args->iou_threshold},
+            cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    DLTensor* data = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* valid_count = ir::Downcast<TensorValue>(inputs[1]);
+    DLTensor* indices = ir::Downcast<TensorValue>(inputs[2]);
+    DLTensor* max_output_size = ir::Downcast<TensorValue>(inputs[3]);
+    DLTensor* iou_threshold = ir::Downcast<TensorValue>(inputs[4]);
+    float* out = nullptr;
+    int* box_indices = nullptr;
+    int* valid_box_count = nullptr;
+    if (params_.return_indices) {
+      TupleValue out_tuple = ir::Downcast<TupleValue>(output);
+      box_indices = static_cast<int*>(ir::Downcast<TensorValue>(out_tuple->fields[0])->data);
+      valid_box_count = static_cast<int*>(ir::Downcast<TensorValue>(out_tuple->fields[1])->data);
+    } else {
+      out = static_cast<float*>(ir::Downcast<TensorValue>(output)->data);
+    }
+    HostNonMaxSuppression(static_cast<const float*>(data->data),
+                          static_cast<const int*>(valid_count->data),
+                          static_cast<const int*>(indices->data),
+                          static_cast<const int*>(max_output_size->data),
+                          static_cast<const float*>(iou_threshold->data), params_, out,
+                          box_indices, valid_box_count, workspace_, compute_stream_);
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.non_max_suppression"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    auto args = cv->args.as<op::schema::NonMaxSuppressionArgs>();
+    const DLTensor* data = args->data;
+    int64_t elem_length = data->shape[2];
+    std::string reason;
+    if (!IsDType(data, kDLFloat, 32)) {
+      reason = "unsupported dtype " + std::string(DType(data->dtype).c_str());
+    } else if (!IsDType(args->valid_count, kDLInt, 32) || !IsDType(args->indices, kDLInt, 32)) {
+      reason = "the valid count and the indices are not int32";
+    } else if (!IsScalar(args->max_output_size, kDLInt, 32) ||
+               !IsScalar(args->iou_threshold, kDLFloat, 32)) {
+      reason = "the max output size or the IoU threshold is not an int32 or float32 scalar";
+    } else if (data->shape[1] > kMaxNmsAnchors) {
+      reason = "more than " + std::to_string(kMaxNmsAnchors) + " anchors";
+    } else if (args->coord_start < 0 || args->coord_start + 4 > elem_length ||
+               args->score_index < 0 || args->score_index >= elem_length ||
+               args->id_index >= elem_length) {
+      reason = "the coordinates, score or id index is out of the box";
+    } else if (NumElements(data) > std::numeric_limits<int>::max()) {
+      reason = "too many elements";
+    }
+    if (!reason.empty()) {
+      dispatch_error_msgs.push_back("[CUDA] Cannot compute the NMS: " + reason);
+      return nullptr;
+    }
+    return new NonMaxSuppressionImpl(cv);
+  }
+
+ private:
+  NmsParams params_;
+  void* workspace_;
+  void* compute_stream_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, non_max_suppression, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.non_max_suppression", NonMaxSuppressionImpl::make);
+
+/*! \brief The attributes of roi_align and roi_align_dx, which share the arguments but dy. */
+template <typename TArgs>
+RoiAlignParams GetRoiAlignParams(const TArgs* args) {
+  const DLTensor* data = args->data;
+  RoiAlignParams p;
+  p.nhwc = args->layout == "NHWC";
+  p.num_rois = args->rois->shape[0];
+  p.batch = data->shape[0];
+  p.channels = data->shape[p.nhwc ? 3 : 1];
+  p.height = data->shape[p.nhwc ? 1 : 2];
+  p.width = data->shape[p.nhwc ? 2 : 3];
+  p.pooled_h = args->pooled_size[0];
+  p.pooled_w = args->pooled_size[1];
+  p.spatial_scale = args->spatial_scale;
+  p.sample_ratio = args->sample_ratio;
+  p.avg = args->mode == "avg";
+  return p;
+}
+
+/*! \brief Check whether the kernels support the ROIAlign, and push the reason if not. */
+template <typename TArgs>
+bool IsRoiAlignSupported(const TArgs* args, const DLTensor* out, bool backward) {
+  std::string reason;
+  if (!IsDType(args->data, kDLFloat, 32) || !IsDType(args->rois, kDLFloat, 32)) {
+    reason = "unsupported dtype " + std::string(DType(args->data->dtype).c_str());
+  } else if (args->rois->shape[1] != 5) {
+    reason = "the rois are not [batch_index, x1, y1, x2, y2]";
+  } else if (args->layout != "NCHW" && args->layout != "NHWC") {
+    reason = "unsupported layout " + args->layout;
+  } else if (args->mode != "avg" && (backward || args->mode != "max")) {
+    reason = "unsupported mode " + args->mode;
+  } else if (NumElements(args->data) > std::numeric_limits<int>::max() ||
+             NumElements(out) > std::numeric_limits<int>::max()) {
+    reason = "too many elements";
+  }
+  if (!reason.empty()) {
+    dispatch_error_msgs.push_back(std::string("[CUDA] Cannot compute the ROIAlign") +
+                                  (backward ? " gradient: " : ": ") + reason);
+    return false;
+  }
+  return true;
+}
+
+class RoiAlignImpl : public raf::op::OpEnv {
+ public:
+  explicit RoiAlignImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.roi_align");
+    auto args = cv->args.as<op::schema::RoiAlignArgs>();
+    this->arg_indices = {fschema_index[op]("data"), fschema_index[op]("rois")};
+    params_ = GetRoiAlignParams(args);
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    compute_stream_ = cuda_device_api->GetStream();
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::RoiAlignArgs>();
+    Execute(std::vector<Value>{args->data, args->rois}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    DLTensor* data = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* rois = ir::Downcast<TensorValue>(inputs[1]);
+    DLTensor* out = ir::Downcast<TensorValue>(output);
+    HostRoiAlign(static_cast<const float*>(data->data), static_cast<const float*>(rois->data),
+                 static_cast<float*>(out->data), params_, compute_stream_);
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.roi_align"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    auto args = cv->args.as<op::schema::RoiAlignArgs>();
+    if (!IsRoiAlignSupported(args, ir::Downcast<TensorValue>(cv->out), false)) {
+      return nullptr;
+    }
+    return new RoiAlignImpl(cv);
+  }
+
+ private:
+  RoiAlignParams params_;
+  void* compute_stream_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, roi_align, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.roi_align", RoiAlignImpl::make);
+
+/*!
+ * \brief The backward of the average ROIAlign, which scatters dy by the bilinear weights instead
+ * of the gradient of the forward compute.
+ */
+class RoiAlignDxImpl : public raf::op::OpEnv {
+ public:
+  explicit RoiAlignDxImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.roi_align_dx");
+    auto args = cv->args.as<op::schema::RoiAlignDxArgs>();
+    this->arg_indices = {fschema_index[op]("rois"), fschema_index[op]("dy")};
+    params_ = GetRoiAlignParams(args);
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    compute_stream_ = cuda_device_api->GetStream();
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::RoiAlignDxArgs>();
+    Execute(std::vector<Value>{args->rois, args->dy}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    DLTensor* rois = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* dy = ir::Downcast<TensorValue>(inputs[1]);
+    DLTensor* dx = ir::Downcast<TensorValue>(output);
+    HostRoiAlignDx(static_cast<const float*>(rois->data), static_cast<const float*>(dy->data),
+                   static_cast<float*>(dx->data), params_, compute_stream_);
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.roi_align_dx"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    auto args = cv->args.as<op::schema::RoiAlignDxArgs>();
+    if (!IsRoiAlignSupported(args, args->dy, true)) {
+      return nullptr;
+    }
+    return new RoiAlignDxImpl(cv);
+  }
+
+ private:
+  RoiAlignParams params_;
+  void* compute_stream_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, roi_align_dx, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.roi_align_dx", RoiAlignDxImpl::make);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
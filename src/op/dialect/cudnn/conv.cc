@@ -7,7 +7,9 @@
  * \file src/op/dialect/cudnn/conv.cc
  * \brief CUDNN conv2d operators.
  */
+#include <algorithm>
 #include <queue>
+#include <tuple>
 #include "../../schema/nn.h"
 #include "../3rdparty/tvm/src/runtime/file_utils.h"
 #include "./cudnn_utils.h"
@@ -73,9 +75,31 @@ class CuDNNConvAlgoCacheEntry {
   T algo_perf_;
 };
 
+/*!
+ * \brief Get the maximum workspace size of the algorithms. It is the user limit if specified, or
+ * the free device memory plus the memory reserved but unused by the pool otherwise.
+ */
+size_t GetWorkspaceLimit(const Device& device) {
+  int64_t limit = CUDNNThreadEntry::ThreadLocal()->workspace_limit;
+  if (limit >= 0) {
+    return limit;
+  }
+  size_t free_bytes, total_bytes;
+  CUDA_CALL(cudaMemGetInfo(&free_bytes, &total_bytes));
+  float used_mb, pool_mb;
+  std::tie(used_mb, pool_mb) = Memory::GetPoolSize(device);
+  return free_bytes + static_cast<size_t>(std::max(pool_mb - used_mb, 0.0f) * 1048576.0f);
+}
+
+/*!
+ * \brief Allocate the workspace to benchmark the algorithms, which is the largest one required
+ * by the algorithms within the workspace limit. The workspace is not allocated if every algorithm
+ * requires more than the limit, in which case only the algorithms without workspace are tried.
+ */
 template <class Algo, class F>
-void GetMaxWorkspaceSize(const Algo* algos, int n_algos, F fget_workspace, size_t* max_ws_size,
-                         std::shared_ptr<Memory>* memory, const Device& device) {
+void GetMaxWorkspaceSize(const Algo* algos, int n_algos, F fget_workspace, size_t ws_limit,
+                         size_t* max_ws_size, std::shared_ptr<Memory>* memory,
+                         const Device& device) {
   std::priority_queue<size_t> max_ws_sizes;
   for (int i = 0; i < n_algos; ++i) {
     size_t ws_size = 0;
@@ -84,9 +108,12 @@ void GetMaxWorkspaceSize(const Algo* algos, int n_algos, F fget_workspace, size_
     } catch (const dmlc::Error& e) {
       continue;
     }
-    max_ws_sizes.push(ws_size);
+    if (ws_size <= ws_limit) {
+      max_ws_sizes.push(ws_size);
+    }
   }
-  while (!max_ws_sizes.empty()) {
+  *max_ws_size = 0;
+  while (!max_ws_sizes.empty() && max_ws_sizes.top() > 0) {
     try {
       size_t size = max_ws_sizes.top();
       max_ws_sizes.pop();
@@ -97,17 +124,35 @@ void GetMaxWorkspaceSize(const Algo* algos, int n_algos, F fget_workspace, size_
       continue;
     }
   }
-  CHECK(*memory != nullptr);
+}
+
+/*!
+ * \brief Select the first successful algorithm within the workspace limit, where the results are
+ * sorted by the time when benchmarked, or by the heuristics otherwise.
+ */
+template <class AlgoPerf>
+int SelectAlgoPerf(const AlgoPerf* res, int cnt, size_t ws_limit) {
+  for (int i = 0; i < cnt; ++i) {
+    if (res[i].status == CUDNN_STATUS_SUCCESS && res[i].memory <= ws_limit) {
+      return i;
+    }
+  }
+  LOG(FATAL) << "ValueError: Cannot find a proper algorithm within the workspace limit of "
+             << ws_limit << " bytes: " << (cnt > 0 ? cudnnGetErrorString(res[0].status) : "");
+  throw;
 }
 
 MetaPersistCache<CuDNNConvAlgoCacheEntry<cudnnConvolutionFwdAlgoPerf_t>> CacheCudnnConvFwdAlgoPerf(
-    "cudnn_conv_fwd_algo_perf");
+    "cudnn_conv_fwd_algo_perf", true);
 
 cudnnConvolutionFwdAlgoPerf_t FindcudnnConvolutionFwdAlgoPerf_tExWrapper(
     const std::vector<uint8_t>& key, const cudnnTensorDescriptor_t xDesc, const void* x,
     const cudnnFilterDescriptor_t wDesc, const void* w, const cudnnConvolutionDescriptor_t convDesc,
     const cudnnTensorDescriptor_t yDesc, void* y, const Device& device) {
-  if (auto* val = CacheCudnnConvFwdAlgoPerf.Get(key)) {
+  size_t ws_limit = GetWorkspaceLimit(device);
+  // The cached algorithm is reused only if its workspace is within the current limit.
+  auto* val = CacheCudnnConvFwdAlgoPerf.Get(key);
+  if (val && val->Value().memory <= ws_limit) {
     return val->Value();
   }
   static const cudnnConvolutionFwdAlgo_t algos[] = {
@@ -128,8 +173,8 @@ cudnnConvolutionFwdAlgoPerf_t FindcudnnConvolutionFwdAlgoPerf_tExWrapper(
           CUDNNThreadEntry::ThreadLocal()->handle, xDesc, wDesc, convDesc, yDesc, algo, ws_size));
     };
     GetMaxWorkspaceSize(algos, sizeof(algos) / sizeof(cudnnConvolutionFwdAlgo_t), fget_workspace,
-                        &max_ws_size, &memory, device);
-    void* workspace_temp = memory->data;
+                        ws_limit, &max_ws_size, &memory, device);
+    void* workspace_temp = memory ? memory->data : nullptr;
     CUDNN_CALL(cudnnFindConvolutionForwardAlgorithmEx(
         CUDNNThreadEntry::ThreadLocal()->handle, xDesc, x, wDesc, w, convDesc, yDesc, y, num_algos,
         &cnt, res, workspace_temp, max_ws_size));
@@ -138,15 +183,11 @@ cudnnConvolutionFwdAlgoPerf_t FindcudnnConvolutionFwdAlgoPerf_tExWrapper(
                                                       xDesc, wDesc, convDesc, yDesc, num_algos,
                                                       &cnt, res));
   }
-  if (res[0].status != CUDNN_STATUS_SUCCESS) {
-    LOG(FATAL) << "ValueError: Cannot find a proper algorithm "
-               << cudnnGetErrorString(res[0].status);
-    throw;
-  }
+  int best = SelectAlgoPerf(res, cnt, ws_limit);
   CacheCudnnConvFwdAlgoPerf.Set(key,
-                                CuDNNConvAlgoCacheEntry<cudnnConvolutionFwdAlgoPerf_t>(res[0]));
+                                CuDNNConvAlgoCacheEntry<cudnnConvolutionFwdAlgoPerf_t>(res[best]));
   // debug information
-  auto best_algo = res[0].algo;
+  auto best_algo = res[best].algo;
   DLOG(INFO) << "CUDNN Found " << cnt << " conv2d algorithms, choosing "
              << conv2dFwdAlgoToString(best_algo);
   for (int i = 0; i < cnt; ++i) {
@@ -156,18 +197,21 @@ cudnnConvolutionFwdAlgoPerf_t FindcudnnConvolutionFwdAlgoPerf_tExWrapper(
                << ", math type: " << cudnnMathTypeToString(res[i].mathType)
                << ", status: " << cudnnGetErrorString(res[i].status);
   }
-  return res[0];
+  return res[best];
 }
 
 MetaPersistCache<CuDNNConvAlgoCacheEntry<cudnnConvolutionBwdDataAlgoPerf_t>>
-    CacheCudnnConvBwdDataAlgoPerf("cudnn_conv_bwd_data_algo_perf");
+    CacheCudnnConvBwdDataAlgoPerf("cudnn_conv_bwd_data_algo_perf", true);
 
 cudnnConvolutionBwdDataAlgoPerf_t FindcudnnConvolutionBwdDataAlgoPerf_tExWrapper(
     const std::vector<uint8_t>& key, const cudnnFilterDescriptor_t wDesc, const void* w,
     const cudnnTensorDescriptor_t dyDesc, const void* dy,
     const cudnnConvolutionDescriptor_t convDesc, const cudnnTensorDescriptor_t dxDesc, void* dx,
     const Device& device) {
-  if (auto* val = CacheCudnnConvBwdDataAlgoPerf.Get(key)) {
+  size_t ws_limit = GetWorkspaceLimit(device);
+  // The cached algorithm is reused only if its workspace is within the current limit.
+  auto* val = CacheCudnnConvBwdDataAlgoPerf.Get(key);
+  if (val && val->Value().memory <= ws_limit) {
     return val->Value();
   }
   static const cudnnConvolutionBwdDataAlgo_t algos[] = {
@@ -184,8 +228,8 @@ cudnnConvolutionBwdDataAlgoPerf_t FindcudnnConvolutionBwdDataAlgoPerf_tExWrapper
           CUDNNThreadEntry::ThreadLocal()->handle, wDesc, dyDesc, convDesc, dxDesc, algo, ws_size));
     };
     GetMaxWorkspaceSize(algos, sizeof(algos) / sizeof(cudnnConvolutionBwdDataAlgo_t),
-                        fget_workspace, &max_ws_size, &memory, device);
-    void* workspace_temp = memory->data;
+                        fget_workspace, ws_limit, &max_ws_size, &memory, device);
+    void* workspace_temp = memory ? memory->data : nullptr;
     CUDNN_CALL(cudnnFindConvolutionBackwardDataAlgorithmEx(
         CUDNNThreadEntry::ThreadLocal()->handle, wDesc, w, dyDesc, dy, convDesc, dxDesc, dx,
         num_algos, &cnt, res, workspace_temp, max_ws_size));
@@ -194,14 +238,10 @@ cudnnConvolutionBwdDataAlgoPerf_t FindcudnnConvolutionBwdDataAlgoPerf_tExWrapper
                                                            wDesc, dyDesc, convDesc, dxDesc,
                                                            num_algos, &cnt, res));
   }
-  if (res[0].status != CUDNN_STATUS_SUCCESS) {
-    LOG(FATAL) << "ValueError: Cannot find a proper algorithm "
-               << cudnnGetErrorString(res[0].status);
-    throw;
-  }
-  auto best_algo = res[0].algo;
+  int best = SelectAlgoPerf(res, cnt, ws_limit);
+  auto best_algo = res[best].algo;
   CacheCudnnConvBwdDataAlgoPerf.Set(
-      key, CuDNNConvAlgoCacheEntry<cudnnConvolutionBwdDataAlgoPerf_t>(res[0]));
+      key, CuDNNConvAlgoCacheEntry<cudnnConvolutionBwdDataAlgoPerf_t>(res[best]));
   // debug information
   DLOG(INFO) << "CUDNN Found " << cnt << " conv2d_dx algorithms , choosing "
              << conv2dBwdDataAlgoToString(best_algo);
@@ -212,18 +252,21 @@ cudnnConvolutionBwdDataAlgoPerf_t FindcudnnConvolutionBwdDataAlgoPerf_tExWrapper
                << ", math type: " << cudnnMathTypeToString(res[i].mathType)
                << ", status: " << cudnnGetErrorString(res[i].status);
   }
-  return res[0];
+  return res[best];
 }
 
 MetaPersistCache<CuDNNConvAlgoCacheEntry<cudnnConvolutionBwdFilterAlgoPerf_t>>
-    CacheCudnnConvBwdFilterAlgoPerf("cudnn_conv_bwd_filter_algo_perf");
+    CacheCudnnConvBwdFilterAlgoPerf("cudnn_conv_bwd_filter_algo_perf", true);
 
 cudnnConvolutionBwdFilterAlgoPerf_t FindcudnnConvolutionBwdFilterAlgoPerf_tExWrapper(
     const std::vector<uint8_t>& key, const cudnnTensorDescriptor_t xDesc, const void* x,
     const cudnnTensorDescriptor_t dyDesc, const void* dy,
     const cudnnConvolutionDescriptor_t convDesc, const cudnnFilterDescriptor_t dwDesc, void* dw,
     const Device& device) {
-  if (auto* val = CacheCudnnConvBwdFilterAlgoPerf.Get(key)) {
+  size_t ws_limit = GetWorkspaceLimit(device);
+  // The cached algorithm is reused only if its workspace is within the current limit.
+  auto* val = CacheCudnnConvBwdFilterAlgoPerf.Get(key);
+  if (val && val->Value().memory <= ws_limit) {
     return val->Value();
   }
   static const cudnnConvolutionBwdFilterAlgo_t algos[] = {
@@ -240,8 +283,8 @@ cudnnConvolutionBwdFilterAlgoPerf_t FindcudnnConvolutionBwdFilterAlgoPerf_tExWra
           CUDNNThreadEntry::ThreadLocal()->handle, xDesc, dyDesc, convDesc, dwDesc, algo, ws_size));
     };
     GetMaxWorkspaceSize(algos, sizeof(algos) / sizeof(cudnnConvolutionBwdFilterAlgo_t),
-                        fget_workspace, &max_ws_size, &memory, device);
-    void* workspace_temp = memory->data;
+                        fget_workspace, ws_limit, &max_ws_size, &memory, device);
+    void* workspace_temp = memory ? memory->data : nullptr;
     CUDNN_CALL(cudnnFindConvolutionBackwardFilterAlgorithmEx(
         CUDNNThreadEntry::ThreadLocal()->handle, xDesc, x, dyDesc, dy, convDesc, dwDesc, dw,
         num_algos, &cnt, res, workspace_temp, max_ws_size));
@@ -250,15 +293,11 @@ cudnnConvolutionBwdFilterAlgoPerf_t FindcudnnConvolutionBwdFilterAlgoPerf_tExWra
         CUDNNThreadEntry::ThreadLocal()->handle, xDesc, dyDesc, convDesc, dwDesc, num_algos, &cnt,
         res));
   }
-  if (res[0].status != CUDNN_STATUS_SUCCESS) {
-    LOG(FATAL) << "ValueError: Cannot find a proper algorithm "
-               << cudnnGetErrorString(res[0].status);
-    throw;
-  }
+  int best = SelectAlgoPerf(res, cnt, ws_limit);
   CacheCudnnConvBwdFilterAlgoPerf.Set(
-      key, CuDNNConvAlgoCacheEntry<cudnnConvolutionBwdFilterAlgoPerf_t>(res[0]));
+      key, CuDNNConvAlgoCacheEntry<cudnnConvolutionBwdFilterAlgoPerf_t>(res[best]));
   // debug information
-  auto best_algo = res[0].algo;
+  auto best_algo = res[best].algo;
   DLOG(INFO) << "CUDNN Found " << cnt << " conv2d_dw algorithms , choosing "
              << conv2dBwdFilterAlgoToString(best_algo);
   for (int i = 0; i < cnt; ++i) {
@@ -268,7 +307,7 @@ cudnnConvolutionBwdFilterAlgoPerf_t FindcudnnConvolutionBwdFilterAlgoPerf_tExWra
                << ", math type: " << cudnnMathTypeToString(res[i].mathType)
                << ", status: " << cudnnGetErrorString(res[i].status);
   }
-  return res[0];
+  return res[best];
 }
 
 class Conv2DImplementedByCUDNNConvolutionForward : public raf::op::OpEnv {
@@ -291,11 +330,18 @@ class Conv2DImplementedByCUDNNConvolutionForward : public raf::op::OpEnv {
     DLTensor* w = args->w;
     DLTensor* out = cv->out;
     auto xDesc_tt = SquashTensorShape(x, {});
-    xDesc = NormalizeTensorType(xDesc_tt);
     auto wDesc_tt = SquashTensorShape(args->w, {});
-    wDesc = NormalizeFilter(args->w);
     auto yDesc_tt = SquashTensorShape(out, {});
-    yDesc = NormalizeTensorType(yDesc_tt);
+    bool nhwc = args->layout == "NHWC";
+    if (nhwc) {
+      xDesc = NormalizeNHWCTensor(x);
+      wDesc = NormalizeOHWIFilter(args->w);
+      yDesc = NormalizeNHWCTensor(out);
+    } else {
+      xDesc = NormalizeTensorType(xDesc_tt);
+      wDesc = NormalizeFilter(args->w);
+      yDesc = NormalizeTensorType(yDesc_tt);
+    }
     std::vector<int> stride = CastVector<int, int64_t>(NormalizeScalarToTuple<2>(args->stride));
     std::vector<int> padding = CastVector<int, int64_t>(NormalizeScalarToTuple<2>(args->padding));
     std::vector<int> dilation = CastVector<int, int64_t>(NormalizeScalarToTuple<2>(args->dilation));
@@ -313,7 +359,7 @@ class Conv2DImplementedByCUDNNConvolutionForward : public raf::op::OpEnv {
 
     HashKey algo_hasher;
     algo_hasher << args->stride << args->padding << args->dilation << wDesc_tt << xDesc_tt
-                << yDesc_tt;
+                << yDesc_tt << nhwc;
     const auto& algo_key = algo_hasher.byte_vector;
     algo = FindcudnnConvolutionFwdAlgoPerf_tExWrapper(algo_key, xDesc, x->data, wDesc, w->data,
                                                       convDesc, yDesc, out->data, cv->device);
@@ -364,6 +410,16 @@ class Conv2DImplementedByCUDNNConvolutionForward : public raf::op::OpEnv {
   }
 
   static OpEnv* make(const CallValues& cv) {
+    // Only NCHW and NHWC, the layouts with native cuDNN tensor formats, are supported. The
+    // others fall back to the other dialects.
+    auto args = cv->args.as<raf::op::schema::ConvArgs>();
+    bool nchw =
+        args->layout == "NCHW" && args->kernel_layout == "OIHW" && args->out_layout == "NCHW";
+    bool nhwc =
+        args->layout == "NHWC" && args->kernel_layout == "OHWI" && args->out_layout == "NHWC";
+    if (!nchw && !nhwc) {
+      return nullptr;
+    }
     return new Conv2DImplementedByCUDNNConvolutionForward(cv);
   }
 };
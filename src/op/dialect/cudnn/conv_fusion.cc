@@ -0,0 +1,798 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cudnn/conv_fusion.cc
+ * \brief Dispatch fused conv2d functions to the cuDNN backend (graph) API, which runs the
+ * convolution, the bias and the activation as one operation graph.
+ */
+#include <algorithm>
+#include <limits>
+#include "dmlc/memory_io.h"
+#include "raf/cache.h"
+#include "raf/memory_pool.h"
+#include "raf/op_utils.h"
+#include "raf/value.h"
+#include "../../regs/value2schema.h"
+#include "../3rdparty/tvm/src/runtime/file_utils.h"
+#include "./cudnn_utils.h"
+
+#if CUDNN_VERSION >= 8200
+
+namespace raf {
+namespace op {
+namespace cudnn {
+
+using namespace raf::ir;
+using namespace raf::value;
+using namespace raf::memory_pool;
+using raf::op::regs::value2schema::IntOrTupleInt;
+
+/*! \brief The maximum number of engine configs to be timed when benchmarking is enabled. */
+constexpr int kMaxTunedEngineConfigs = 8;
+
+/*! \brief The unique ids of the tensors in the operation graph. */
+enum ConvFusionTensorUid : int64_t {
+  kUidX = 1,
+  kUidW,
+  kUidBias,
+  kUidY,
+  kUidConvOut,
+  kUidBiasOut,
+};
+
+/*! \brief An owned cuDNN backend descriptor. */
+class BackendDescriptor {
+ public:
+  explicit BackendDescriptor(cudnnBackendDescriptorType_t type) {
+    CUDNN_CALL(cudnnBackendCreateDescriptor(type, &desc_));
+  }
+
+  BackendDescriptor(BackendDescriptor&& other)
+      : desc_(other.desc_), retained_(std::move(other.retained_)) {
+    other.desc_ = nullptr;
+  }
+
+  BackendDescriptor(const BackendDescriptor&) = delete;
+  BackendDescriptor& operator=(const BackendDescriptor&) = delete;
+
+  ~BackendDescriptor() {
+    if (desc_) {
+      CUDNN_CALL(cudnnBackendDestroyDescriptor(desc_));
+    }
+  }
+
+  /*! \brief Keep a descriptor referred to by this one alive as long as this one. */
+  void Retain(BackendDescriptor&& other) {
+    retained_.push_back(std::make_shared<BackendDescriptor>(std::move(other)));
+  }
+
+  BackendDescriptor& Set(cudnnBackendAttributeName_t name, cudnnBackendAttributeType_t type,
+                         int64_t count, const void* values) {
+    CUDNN_CALL(cudnnBackendSetAttribute(desc_, name, type, count, values));
+    return *this;
+  }
+
+  /*! \brief Finalize the descriptor, and return whether it is supported. */
+  bool TryFinalize() {
+    return cudnnBackendFinalize(desc_) == CUDNN_STATUS_SUCCESS;
+  }
+
+  void Finalize() {
+    CUDNN_CALL(cudnnBackendFinalize(desc_));
+  }
+
+  cudnnBackendDescriptor_t get() const {
+    return desc_;
+  }
+
+  /*! \brief The address of the descriptor, to set or get an attribute of descriptor type. */
+  cudnnBackendDescriptor_t* addr() {
+    return &desc_;
+  }
+
+ private:
+  cudnnBackendDescriptor_t desc_{nullptr};
+  /*! \brief The descriptors referred to by this one. */
+  std::vector<std::shared_ptr<BackendDescriptor>> retained_;
+};
+
+/*!
+ * \brief The engine config selected for an operation graph, which is serialized as the global
+ * index of the engine and the knob choices. An execution plan is rebuilt from the engine config
+ * without querying the heuristics or benchmarking again.
+ */
+class CuDNNEngineConfigCacheEntry {
+ public:
+  CuDNNEngineConfigCacheEntry() = default;
+
+  explicit CuDNNEngineConfigCacheEntry(const BackendDescriptor& config) {
+    int64_t count = 0;
+    BackendDescriptor engine(CUDNN_BACKEND_ENGINE_DESCRIPTOR);
+    CUDNN_CALL(cudnnBackendGetAttribute(config.get(), CUDNN_ATTR_ENGINECFG_ENGINE,
+                                        CUDNN_TYPE_BACKEND_DESCRIPTOR, 1, &count, engine.addr()));
+    CUDNN_CALL(cudnnBackendGetAttribute(engine.get(), CUDNN_ATTR_ENGINE_GLOBAL_INDEX,
+                                        CUDNN_TYPE_INT64, 1, &count, &engine_id_));
+    std::vector<BackendDescriptor> choices;
+    std::vector<cudnnBackendDescriptor_t> raw_choices;
+    choices.reserve(CUDNN_KNOB_TYPE_COUNTS);
+    for (int i = 0; i < CUDNN_KNOB_TYPE_COUNTS; ++i) {
+      choices.emplace_back(CUDNN_BACKEND_KNOB_CHOICE_DESCRIPTOR);
+      raw_choices.push_back(choices.back().get());
+    }
+    CUDNN_CALL(cudnnBackendGetAttribute(config.get(), CUDNN_ATTR_ENGINECFG_KNOB_CHOICES,
+                                        CUDNN_TYPE_BACKEND_DESCRIPTOR, CUDNN_KNOB_TYPE_COUNTS,
+                                        &count, raw_choices.data()));
+    for (int64_t i = 0; i < count; ++i) {
+      cudnnBackendKnobType_t type;
+      int64_t value, n;
+      CUDNN_CALL(cudnnBackendGetAttribute(raw_choices[i], CUDNN_ATTR_KNOB_CHOICE_KNOB_TYPE,
+                                          CUDNN_TYPE_KNOB_TYPE, 1, &n, &type));
+      CUDNN_CALL(cudnnBackendGetAttribute(raw_choices[i], CUDNN_ATTR_KNOB_CHOICE_KNOB_VALUE,
+                                          CUDNN_TYPE_INT64, 1, &n, &value));
+      knobs_.push_back(static_cast<int64_t>(type));
+      knobs_.push_back(value);
+    }
+  }
+
+  /*! \brief Rebuild the engine config for the operation graph. */
+  BackendDescriptor Build(BackendDescriptor* graph) const {
+    BackendDescriptor engine(CUDNN_BACKEND_ENGINE_DESCRIPTOR);
+    engine.Set(CUDNN_ATTR_ENGINE_OPERATION_GRAPH, CUDNN_TYPE_BACKEND_DESCRIPTOR, 1, graph->addr())
+        .Set(CUDNN_ATTR_ENGINE_GLOBAL_INDEX, CUDNN_TYPE_INT64, 1, &engine_id_)
+        .Finalize();
+    std::vector<BackendDescriptor> choices;
+    std::vector<cudnnBackendDescriptor_t> raw_choices;
+    choices.reserve(knobs_.size() / 2);
+    for (size_t i = 0; i < knobs_.size(); i += 2) {
+      auto type = static_cast<cudnnBackendKnobType_t>(knobs_[i]);
+      choices.emplace_back(CUDNN_BACKEND_KNOB_CHOICE_DESCRIPTOR);
+      choices.back()
+          .Set(CUDNN_ATTR_KNOB_CHOICE_KNOB_TYPE, CUDNN_TYPE_KNOB_TYPE, 1, &type)
+          .Set(CUDNN_ATTR_KNOB_CHOICE_KNOB_VALUE, CUDNN_TYPE_INT64, 1, &knobs_[i + 1])
+          .Finalize();
+      raw_choices.push_back(choices.back().get());
+    }
+    BackendDescriptor config(CUDNN_BACKEND_ENGINECFG_DESCRIPTOR);
+    config.Set(CUDNN_ATTR_ENGINECFG_ENGINE, CUDNN_TYPE_BACKEND_DESCRIPTOR, 1, engine.addr());
+    if (!raw_choices.empty()) {
+      config.Set(CUDNN_ATTR_ENGINECFG_KNOB_CHOICES, CUDNN_TYPE_BACKEND_DESCRIPTOR,
+                 raw_choices.size(), raw_choices.data());
+    }
+    config.Finalize();
+    config.Retain(std::move(engine));
+    for (auto& choice : choices) {
+      config.Retain(std::move(choice));
+    }
+    return config;
+  }
+
+  static CuDNNEngineConfigCacheEntry Load(const std::string& path) {
+    std::string data;
+    tvm::runtime::LoadBinaryFromFile(path + "/value.bin", &data);
+    dmlc::MemoryStringStream reader(&data);
+    dmlc::Stream* stream = &reader;
+    CuDNNEngineConfigCacheEntry ret;
+    stream->Read(&ret.engine_id_);
+    stream->Read(&ret.knobs_);
+    return ret;
+  }
+
+  bool Save(const std::string& path) {
+    std::string data;
+    dmlc::MemoryStringStream writer(&data);
+    dmlc::Stream* stream = &writer;
+    stream->Write(engine_id_);
+    stream->Write(knobs_);
+    tvm::runtime::SaveBinaryToFile(path + "/value.bin", data);
+    return true;
+  }
+
+ private:
+  /*! \brief The global index of the engine. */
+  int64_t engine_id_{-1};
+  /*! \brief The knob choices, flattened as pairs of the knob type and the value. */
+  std::vector<int64_t> knobs_;
+};
+
+MetaPersistCache<CuDNNEngineConfigCacheEntry> CacheCudnnConvFusionEngineConfig(
+    "cudnn_conv_fusion_engine_config", true);
+
+/*! \brief The dims in the NCHW order and the strides of a 4-D tensor. */
+struct TensorLayout {
+  std::vector<int64_t> dims;
+  std::vector<int64_t> strides;
+};
+
+/*!
+ * \brief Get the dims in the NCHW order and the strides of a compact 4-D tensor in the given
+ * layout, which is one of NCHW, NHWC, OIHW and OHWI. The shape is broadcast to 4-D by prepending
+ * ones when it has fewer dimensions, e.g., a bias in [C, 1, 1].
+ */
+inline TensorLayout GetTensorLayout(const DLTensor* tensor, std::string layout) {
+  std::replace(layout.begin(), layout.end(), 'O', 'N');
+  std::replace(layout.begin(), layout.end(), 'I', 'C');
+  CHECK_LE(tensor->ndim, 4);
+  std::vector<int64_t> shape(4 - tensor->ndim, 1);
+  shape.insert(shape.end(), tensor->shape, tensor->shape + tensor->ndim);
+  std::vector<int64_t> strides(4, 1);
+  for (int i = 2; i >= 0; --i) {
+    strides[i] = strides[i + 1] * shape[i + 1];
+  }
+  TensorLayout ret;
+  for (char axis : std::string("NCHW")) {
+    auto pos = layout.find(axis);
+    CHECK_NE(pos, std::string::npos) << "Unsupported layout: " << layout;
+    ret.dims.push_back(shape[pos]);
+    ret.strides.push_back(strides[pos]);
+  }
+  return ret;
+}
+
+/*! \brief Create a tensor descriptor of the operation graph. */
+inline BackendDescriptor MakeTensor(int64_t uid, cudnnDataType_t dtype, const TensorLayout& layout,
+                                    bool is_virtual) {
+  // RAF allocates the tensors with at least 64-byte alignment.
+  int64_t alignment = 16;
+  BackendDescriptor tensor(CUDNN_BACKEND_TENSOR_DESCRIPTOR);
+  tensor.Set(CUDNN_ATTR_TENSOR_DATA_TYPE, CUDNN_TYPE_DATA_TYPE, 1, &dtype)
+      .Set(CUDNN_ATTR_TENSOR_DIMENSIONS, CUDNN_TYPE_INT64, 4, layout.dims.data())
+      .Set(CUDNN_ATTR_TENSOR_STRIDES, CUDNN_TYPE_INT64, 4, layout.strides.data())
+      .Set(CUDNN_ATTR_TENSOR_UNIQUE_ID, CUDNN_TYPE_INT64, 1, &uid)
+      .Set(CUDNN_ATTR_TENSOR_BYTE_ALIGNMENT, CUDNN_TYPE_INT64, 1, &alignment)
+      .Set(CUDNN_ATTR_TENSOR_IS_VIRTUAL, CUDNN_TYPE_BOOLEAN, 1, &is_virtual)
+      .Finalize();
+  return tensor;
+}
+
+/*! \brief Create a pointwise operation of y = mode(x, b), where b is ignored if it is null. */
+inline BackendDescriptor MakePointwise(cudnnPointwiseMode_t mode, BackendDescriptor* x,
+                                       BackendDescriptor* b, BackendDescriptor* y) {
+  cudnnDataType_t math_prec = CUDNN_DATA_FLOAT;
+  BackendDescriptor pointwise(CUDNN_BACKEND_POINTWISE_DESCRIPTOR);
+  pointwise.Set(CUDNN_ATTR_POINTWISE_MODE, CUDNN_TYPE_POINTWISE_MODE, 1, &mode)
+      .Set(CUDNN_ATTR_POINTWISE_MATH_PREC, CUDNN_TYPE_DATA_TYPE, 1, &math_prec)
+      .Finalize();
+  BackendDescriptor op(CUDNN_BACKEND_OPERATION_POINTWISE_DESCRIPTOR);
+  op.Set(CUDNN_ATTR_OPERATION_POINTWISE_PW_DESCRIPTOR, CUDNN_TYPE_BACKEND_DESCRIPTOR, 1,
+         pointwise.addr())
+      .Set(CUDNN_ATTR_OPERATION_POINTWISE_XDESC, CUDNN_TYPE_BACKEND_DESCRIPTOR, 1, x->addr())
+      .Set(CUDNN_ATTR_OPERATION_POINTWISE_YDESC, CUDNN_TYPE_BACKEND_DESCRIPTOR, 1, y->addr());
+  if (b) {
+    op.Set(CUDNN_ATTR_OPERATION_POINTWISE_BDESC, CUDNN_TYPE_BACKEND_DESCRIPTOR, 1, b->addr());
+  }
+  op.Finalize();
+  op.Retain(std::move(pointwise));
+  return op;
+}
+
+/*! \brief Get the param of the fused function, or an undefined var if it is not a param. */
+inline Var GetParam(const Expr& expr) {
+  return expr->IsInstance<VarNode>() ? Downcast<Var>(expr) : Var();
+}
+
+/*!
+ * \brief The fused conv2d function dispatched to the cuDNN graph API. Patterns supported:
+ *   - conv2d(x, w) + bias
+ *   - relu(conv2d(x, w) + bias)
+ *   - relu(conv2d(x, w))
+ * where the bias is broadcast to the output. The convolution, the bias and the activation are
+ * built as one operation graph, and the engine config is selected by the heuristics and
+ * benchmarking when enabled. If no engine supports the fused graph on the GPU, the convolution
+ * is run by the graph API alone, followed by cudnnAddTensor and cudnnActivationForward.
+ */
+class CuDNNConvFusionOpEnv : public OpEnv {
+ public:
+  explicit CuDNNConvFusionOpEnv(const CallValues& cv) : device_(cv->device) {
+  }
+
+  ~CuDNNConvFusionOpEnv() {
+    if (bias_desc_) {
+      CUDNN_CALL(cudnnDestroyTensorDescriptor(bias_desc_));
+    }
+    if (y_desc_) {
+      CUDNN_CALL(cudnnDestroyTensorDescriptor(y_desc_));
+    }
+    if (act_desc_) {
+      CUDNN_CALL(cudnnDestroyActivationDescriptor(act_desc_));
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cudnn.conv2d_fusion"));
+  }
+
+  /*! \brief Match the body of the fused function, and return whether it is supported. */
+  bool Pattern(const CallValues& cv) {
+    static const Op& conv2d_op = Op::Get("raf.op.cudnn.conv2d");
+    static const Op& add_op = Op::Get("raf.op.cudnn.add");
+    static const Op& relu_op = Op::Get("raf.op.cudnn.relu");
+    Function func = Downcast<ClosureValue>(cv->callee)->func;
+    auto call = func->body.as<CallNode>();
+    if (call && call->op == relu_op) {
+      with_relu_ = true;
+      call = call->args[0].as<CallNode>();
+    }
+    if (call && call->op == add_op) {
+      // The add is commutative, so the conv2d may be either of its arguments.
+      auto lhs = call->args[0].as<CallNode>();
+      bias_ = GetParam(call->args[lhs ? 1 : 0]);
+      call = lhs ? lhs : call->args[1].as<CallNode>();
+      if (!bias_.defined()) {
+        return false;
+      }
+    }
+    if (!call || call->op != conv2d_op || (!with_relu_ && !bias_.defined())) {
+      return false;
+    }
+    conv_args_.clear();
+    for (const auto& arg : call->args) {
+      conv_args_.push_back(GetParam(arg));
+      if (!conv_args_.back().defined()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /*! \brief Check whether the dtypes, the layouts and the bias shape are supported. */
+  bool IsValid(const CallValues& cv) {
+    DLTensor* x = GetArg<TensorValue>(cv, conv_args_[0]);
+    DLTensor* w = GetArg<TensorValue>(cv, conv_args_[1]);
+    DLTensor* out = cv->out;
+    DType dtype(out->dtype);
+    if (dtype.code != DTypeCode::kFloat() || (dtype.bits != 16 && dtype.bits != 32) ||
+        dtype.lanes != 1 || DType(x->dtype) != dtype || DType(w->dtype) != dtype ||
+        x->ndim != 4 || w->ndim != 4 || out->ndim != 4) {
+      return false;
+    }
+    layout_ = GetArg<StringValue>(cv, conv_args_[6])->value;
+    kernel_layout_ = GetArg<StringValue>(cv, conv_args_[7])->value;
+    std::string out_layout = GetArg<StringValue>(cv, conv_args_[8])->value;
+    if (out_layout != layout_ || !((layout_ == "NCHW" && kernel_layout_ == "OIHW") ||
+                                   (layout_ == "NHWC" && kernel_layout_ == "OHWI"))) {
+      return false;
+    }
+    if (bias_.defined()) {
+      DLTensor* bias = GetArg<TensorValue>(cv, bias_);
+      if (DType(bias->dtype) != dtype || bias->ndim > 4) {
+        return false;
+      }
+      // Each dimension of the bias is either broadcast or in the output shape.
+      for (int i = 1; i <= bias->ndim; ++i) {
+        int64_t dim = bias->shape[bias->ndim - i];
+        if (dim != 1 && dim != out->shape[out->ndim - i]) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  void Init(const CallValues& cv) {
+    DLTensor* x = GetArg<TensorValue>(cv, conv_args_[0]);
+    DLTensor* w = GetArg<TensorValue>(cv, conv_args_[1]);
+    DLTensor* out = cv->out;
+    std::vector<int64_t> stride =
+        NormalizeScalarToTuple<2>(IntOrTupleInt(GetArg<Value>(cv, conv_args_[2])));
+    std::vector<int64_t> padding =
+        NormalizeScalarToTuple<2>(IntOrTupleInt(GetArg<Value>(cv, conv_args_[3])));
+    std::vector<int64_t> dilation =
+        NormalizeScalarToTuple<2>(IntOrTupleInt(GetArg<Value>(cv, conv_args_[4])));
+    dtype_ = CUDNNDType(out->dtype);
+    x_layout_ = GetTensorLayout(x, layout_);
+    w_layout_ = GetTensorLayout(w, kernel_layout_);
+    y_layout_ = GetTensorLayout(out, layout_);
+    if (bias_.defined()) {
+      bias_layout_ = GetTensorLayout(GetArg<TensorValue>(cv, bias_), layout_);
+    }
+
+    cudaDeviceProp prop;
+    CUDA_CALL(cudaGetDeviceProperties(&prop, device_.device_id()));
+    HashKey key;
+    key << prop.major * 10 + prop.minor << std::string(DType(out->dtype).c_str())
+        << x_layout_.dims << x_layout_.strides << w_layout_.dims << w_layout_.strides
+        << y_layout_.strides << bias_layout_.dims << stride << padding << dilation << with_relu_;
+
+    // Try the fused graph first, and fall back to the graph of the convolution alone.
+    for (bool fused : {true, false}) {
+      fused_ = fused;
+      BuildGraph(stride, padding, dilation);
+      HashKey graph_key = key;
+      graph_key << fused_;
+      if (FindPlan(cv, graph_key.byte_vector)) {
+        break;
+      }
+      CHECK(fused) << "No cuDNN engine available for the convolution";
+      DLOG(INFO) << "No cuDNN engine available for the fused convolution, fall back to run the "
+                 << "bias and the activation separately";
+    }
+    if (!fused_) {
+      InitUnfusedEpilogue();
+    }
+    if (workspace_size_ > 0) {
+      RequestWorkspace(&workspace_, cv->device, workspace_size_);
+    }
+    std::vector<Var> params = {conv_args_[0], conv_args_[1]};
+    if (bias_.defined()) {
+      params.push_back(bias_);
+    }
+    for (const auto& param : params) {
+      arg_indices.push_back(GetParamIndex(cv, param));
+    }
+  }
+
+  void Execute(const CallValues& cv) override {
+    Array<Value> args = GetListArgs(cv->args);
+    std::vector<Value> inputs;
+    for (const auto& i : arg_indices) {
+      inputs.push_back(args[i]);
+    }
+    Execute(inputs, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    DLTensor* x = Downcast<TensorValue>(inputs[0]);
+    DLTensor* w = Downcast<TensorValue>(inputs[1]);
+    DLTensor* bias = nullptr;
+    if (bias_.defined()) {
+      bias = Downcast<TensorValue>(inputs[2]);
+    }
+    DLTensor* out = Downcast<TensorValue>(output);
+    auto handle = CUDNNThreadEntry::ThreadLocal()->handle;
+    BackendDescriptor variant_pack = MakeVariantPack(x, w, bias, out, workspace_);
+    CUDNN_CALL(cudnnBackendExecute(handle, plan_->get(), variant_pack.get()));
+    if (fused_) {
+      return;
+    }
+    if (bias) {
+      CUDNN_CALL(cudnnAddTensor(handle, CUDNNDType(out->dtype).const_addr<1>(), bias_desc_,
+                                bias->data, CUDNNDType(out->dtype).const_addr<1>(), y_desc_,
+                                out->data));
+    }
+    if (with_relu_) {
+      CUDNN_CALL(cudnnActivationForward(handle, act_desc_, CUDNNDType(out->dtype).const_addr<1>(),
+                                        y_desc_, out->data,
+                                        CUDNNDType(out->dtype).const_addr<0>(), y_desc_,
+                                        out->data));
+    }
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    auto op_env = std::make_unique<CuDNNConvFusionOpEnv>(cv);
+    bool matched = op_env->Pattern(cv);
+    bool valid = matched && op_env->IsValid(cv);
+    if (!valid) {
+      std::stringstream ss;
+      ss << "[cuDNN] Cannot JIT: matched pattern? " << matched << ", valid? " << valid;
+      dispatch_error_msgs.push_back(ss.str());
+      return nullptr;
+    }
+    try {
+      op_env->Init(cv);
+    } catch (const dmlc::Error& e) {
+      std::stringstream ss;
+      ss << "[cuDNN] Failed to JIT: " << e.what();
+      dispatch_error_msgs.push_back(ss.str());
+      return nullptr;
+    }
+    return op_env.release();
+  }
+
+ private:
+  /*! \brief Get the index of the param in the fused function. */
+  int GetParamIndex(const CallValues& cv, const Var& var) {
+    Function func = Downcast<ClosureValue>(cv->callee)->func;
+    for (size_t i = 0; i < func->params.size(); ++i) {
+      if (func->params[i] == var) {
+        return i;
+      }
+    }
+    LOG(FATAL) << "Cannot find the param " << var->name_hint();
+    throw;
+  }
+
+  template <typename T>
+  T GetArg(const CallValues& cv, const Var& var) {
+    Array<Value> args = GetListArgs(cv->args);
+    return Downcast<T>(args[GetParamIndex(cv, var)]);
+  }
+
+  /*!
+   * \brief Build the operation graph. The intermediate tensors are virtual, so they are kept in
+   * the registers or the shared memory of the fused kernel.
+   */
+  void BuildGraph(const std::vector<int64_t>& stride, const std::vector<int64_t>& padding,
+                  const std::vector<int64_t>& dilation) {
+    bool with_epilogue = fused_ && (bias_.defined() || with_relu_);
+    std::vector<BackendDescriptor> tensors;
+    tensors.reserve(6);
+    tensors.push_back(MakeTensor(kUidX, dtype_, x_layout_, false));
+    tensors.push_back(MakeTensor(kUidW, dtype_, w_layout_, false));
+    // The intermediate results are in float32 to keep the precision of the accumulator.
+    tensors.push_back(with_epilogue ? MakeTensor(kUidConvOut, CUDNN_DATA_FLOAT, y_layout_, true)
+                                    : MakeTensor(kUidY, dtype_, y_layout_, false));
+    BackendDescriptor& conv_out = tensors.back();
+
+    cudnnDataType_t comp_type = CUDNN_DATA_FLOAT;
+    cudnnConvolutionMode_t mode = CUDNN_CROSS_CORRELATION;
+    int64_t spatial_dims = 2;
+    BackendDescriptor conv(CUDNN_BACKEND_CONVOLUTION_DESCRIPTOR);
+    conv.Set(CUDNN_ATTR_CONVOLUTION_COMP_TYPE, CUDNN_TYPE_DATA_TYPE, 1, &comp_type)
+        .Set(CUDNN_ATTR_CONVOLUTION_CONV_MODE, CUDNN_TYPE_CONVOLUTION_MODE, 1, &mode)
+        .Set(CUDNN_ATTR_CONVOLUTION_SPATIAL_DIMS, CUDNN_TYPE_INT64, 1, &spatial_dims)
+        .Set(CUDNN_ATTR_CONVOLUTION_DILATIONS, CUDNN_TYPE_INT64, 2, dilation.data())
+        .Set(CUDNN_ATTR_CONVOLUTION_FILTER_STRIDES, CUDNN_TYPE_INT64, 2, stride.data())
+        .Set(CUDNN_ATTR_CONVOLUTION_PRE_PADDINGS, CUDNN_TYPE_INT64, 2, padding.data())
+        .Set(CUDNN_ATTR_CONVOLUTION_POST_PADDINGS, CUDNN_TYPE_INT64, 2, padding.data())
+        .Finalize();
+
+    // The groups are implied by the input channels of x and w.
+    float alpha = 1.0f, beta = 0.0f;
+    std::vector<BackendDescriptor> ops;
+    ops.emplace_back(CUDNN_BACKEND_OPERATION_CONVOLUTION_FORWARD_DESCRIPTOR);
+    ops.back()
+        .Set(CUDNN_ATTR_OPERATION_CONVOLUTION_FORWARD_X, CUDNN_TYPE_BACKEND_DESCRIPTOR, 1,
+             tensors[0].addr())
+        .Set(CUDNN_ATTR_OPERATION_CONVOLUTION_FORWARD_W, CUDNN_TYPE_BACKEND_DESCRIPTOR, 1,
+             tensors[1].addr())
+        .Set(CUDNN_ATTR_OPERATION_CONVOLUTION_FORWARD_Y, CUDNN_TYPE_BACKEND_DESCRIPTOR, 1,
+             conv_out.addr())
+        .Set(CUDNN_ATTR_OPERATION_CONVOLUTION_FORWARD_CONV_DESC, CUDNN_TYPE_BACKEND_DESCRIPTOR, 1,
+             conv.addr())
+        .Set(CUDNN_ATTR_OPERATION_CONVOLUTION_FORWARD_ALPHA, CUDNN_TYPE_FLOAT, 1, &alpha)
+        .Set(CUDNN_ATTR_OPERATION_CONVOLUTION_FORWARD_BETA, CUDNN_TYPE_FLOAT, 1, &beta)
+        .Finalize();
+    if (with_epilogue) {
+      BackendDescriptor y = MakeTensor(kUidY, dtype_, y_layout_, false);
+      if (bias_.defined()) {
+        BackendDescriptor bias = MakeTensor(kUidBias, dtype_, bias_layout_, false);
+        BackendDescriptor bias_out =
+            with_relu_ ? MakeTensor(kUidBiasOut, CUDNN_DATA_FLOAT, y_layout_, true)
+                       : MakeTensor(kUidY, dtype_, y_layout_, false);
+        ops.push_back(MakePointwise(CUDNN_POINTWISE_ADD, &conv_out, &bias, &bias_out));
+        if (with_relu_) {
+          ops.push_back(MakePointwise(CUDNN_POINTWISE_RELU_FWD, &bias_out, nullptr, &y));
+        }
+        tensors.push_back(std::move(bias));
+        tensors.push_back(std::move(bias_out));
+      } else {
+        ops.push_back(MakePointwise(CUDNN_POINTWISE_RELU_FWD, &conv_out, nullptr, &y));
+      }
+      tensors.push_back(std::move(y));
+    }
+
+    std::vector<cudnnBackendDescriptor_t> raw_ops;
+    for (const auto& op : ops) {
+      raw_ops.push_back(op.get());
+    }
+    auto handle = CUDNNThreadEntry::ThreadLocal()->handle;
+    graph_ = std::make_unique<BackendDescriptor>(CUDNN_BACKEND_OPERATIONGRAPH_DESCRIPTOR);
+    graph_->Set(CUDNN_ATTR_OPERATIONGRAPH_OPS, CUDNN_TYPE_BACKEND_DESCRIPTOR, raw_ops.size(),
+                raw_ops.data())
+        .Set(CUDNN_ATTR_OPERATIONGRAPH_HANDLE, CUDNN_TYPE_HANDLE, 1, &handle)
+        .Finalize();
+    graph_->Retain(std::move(conv));
+    for (auto& tensor : tensors) {
+      graph_->Retain(std::move(tensor));
+    }
+    for (auto& op : ops) {
+      graph_->Retain(std::move(op));
+    }
+  }
+
+  /*! \brief Get the engine configs suggested by the heuristics, in the order of preference. */
+  std::vector<BackendDescriptor> GetEngineConfigs(cudnnBackendHeurMode_t mode) {
+    BackendDescriptor heur(CUDNN_BACKEND_ENGINEHEUR_DESCRIPTOR);
+    heur.Set(CUDNN_ATTR_ENGINEHEUR_OPERATION_GRAPH, CUDNN_TYPE_BACKEND_DESCRIPTOR, 1,
+             graph_->addr())
+        .Set(CUDNN_ATTR_ENGINEHEUR_MODE, CUDNN_TYPE_HEUR_MODE, 1, &mode);
+    std::vector<BackendDescriptor> configs;
+    if (!heur.TryFinalize()) {
+      return configs;
+    }
+    int64_t count = 0;
+    CUDNN_CALL(cudnnBackendGetAttribute(heur.get(), CUDNN_ATTR_ENGINEHEUR_RESULTS,
+                                        CUDNN_TYPE_BACKEND_DESCRIPTOR, 0, &count, nullptr));
+    std::vector<cudnnBackendDescriptor_t> raw_configs;
+    configs.reserve(count);
+    for (int64_t i = 0; i < count; ++i) {
+      configs.emplace_back(CUDNN_BACKEND_ENGINECFG_DESCRIPTOR);
+      raw_configs.push_back(configs.back().get());
+    }
+    if (count > 0) {
+      CUDNN_CALL(cudnnBackendGetAttribute(heur.get(), CUDNN_ATTR_ENGINEHEUR_RESULTS,
+                                          CUDNN_TYPE_BACKEND_DESCRIPTOR, count, &count,
+                                          raw_configs.data()));
+    }
+    while (configs.size() > static_cast<size_t>(count)) {
+      configs.pop_back();
+    }
+    return configs;
+  }
+
+  /*! \brief Make an execution plan of the engine config, or nullptr if it is not supported. */
+  std::unique_ptr<BackendDescriptor> MakePlan(BackendDescriptor config) {
+    auto handle = CUDNNThreadEntry::ThreadLocal()->handle;
+    auto plan = std::make_unique<BackendDescriptor>(CUDNN_BACKEND_EXECUTION_PLAN_DESCRIPTOR);
+    plan->Set(CUDNN_ATTR_EXECUTION_PLAN_ENGINE_CONFIG, CUDNN_TYPE_BACKEND_DESCRIPTOR, 1,
+              config.addr())
+        .Set(CUDNN_ATTR_EXECUTION_PLAN_HANDLE, CUDNN_TYPE_HANDLE, 1, &handle);
+    if (!plan->TryFinalize()) {
+      return nullptr;
+    }
+    plan->Retain(std::move(config));
+    return plan;
+  }
+
+  int64_t GetWorkspaceSize(const BackendDescriptor& plan) {
+    int64_t size = 0, count = 0;
+    CUDNN_CALL(cudnnBackendGetAttribute(plan.get(), CUDNN_ATTR_EXECUTION_PLAN_WORKSPACE_SIZE,
+                                        CUDNN_TYPE_INT64, 1, &count, &size));
+    return size;
+  }
+
+  BackendDescriptor MakeVariantPack(DLTensor* x, DLTensor* w, DLTensor* bias, DLTensor* out,
+                                    void* workspace) {
+    std::vector<int64_t> uids = {kUidX, kUidW, kUidY};
+    std::vector<void*> ptrs = {x->data, w->data, out->data};
+    if (fused_ && bias) {
+      uids.push_back(kUidBias);
+      ptrs.push_back(bias->data);
+    }
+    BackendDescriptor variant_pack(CUDNN_BACKEND_VARIANT_PACK_DESCRIPTOR);
+    variant_pack.Set(CUDNN_ATTR_VARIANT_PACK_UNIQUE_IDS, CUDNN_TYPE_INT64, uids.size(), uids.data())
+        .Set(CUDNN_ATTR_VARIANT_PACK_DATA_POINTERS, CUDNN_TYPE_VOID_PTR, ptrs.size(), ptrs.data())
+        .Set(CUDNN_ATTR_VARIANT_PACK_WORKSPACE, CUDNN_TYPE_VOID_PTR, 1, &workspace)
+        .Finalize();
+    return variant_pack;
+  }
+
+  /*! \brief Get the average latency of the plan in milliseconds. */
+  float TimePlan(const CallValues& cv, const BackendDescriptor& plan, void* workspace) {
+    constexpr int kRepeat = 3;
+    auto handle = CUDNNThreadEntry::ThreadLocal()->handle;
+    DLTensor* x = GetArg<TensorValue>(cv, conv_args_[0]);
+    DLTensor* w = GetArg<TensorValue>(cv, conv_args_[1]);
+    DLTensor* bias = nullptr;
+    if (bias_.defined()) {
+      bias = GetArg<TensorValue>(cv, bias_);
+    }
+    BackendDescriptor variant_pack = MakeVariantPack(x, w, bias, cv->out, workspace);
+    cudaStream_t stream;
+    CUDNN_CALL(cudnnGetStream(handle, &stream));
+    // Warm up, which also filters out the plans failing at launch.
+    if (cudnnBackendExecute(handle, plan.get(), variant_pack.get()) != CUDNN_STATUS_SUCCESS) {
+      return std::numeric_limits<float>::infinity();
+    }
+    cudaEvent_t start, stop;
+    CUDA_CALL(cudaEventCreate(&start));
+    CUDA_CALL(cudaEventCreate(&stop));
+    CUDA_CALL(cudaEventRecord(start, stream));
+    for (int i = 0; i < kRepeat; ++i) {
+      CUDNN_CALL(cudnnBackendExecute(handle, plan.get(), variant_pack.get()));
+    }
+    CUDA_CALL(cudaEventRecord(stop, stream));
+    CUDA_CALL(cudaEventSynchronize(stop));
+    float ms = 0.0f;
+    CUDA_CALL(cudaEventElapsedTime(&ms, start, stop));
+    CUDA_CALL(cudaEventDestroy(start));
+    CUDA_CALL(cudaEventDestroy(stop));
+    return ms / kRepeat;
+  }
+
+  /*!
+   * \brief Find the execution plan of the graph, and return false if no engine supports it. The
+   * engine configs suggested by the heuristics are timed when benchmarking is enabled, and the
+   * selected one is cached persistently.
+   */
+  bool FindPlan(const CallValues& cv, const std::vector<uint8_t>& key) {
+    if (auto cached = CacheCudnnConvFusionEngineConfig.Get(key)) {
+      if ((plan_ = MakePlan(cached->Build(graph_.get())))) {
+        workspace_size_ = GetWorkspaceSize(*plan_);
+        return true;
+      }
+    }
+    std::vector<BackendDescriptor> configs = GetEngineConfigs(CUDNN_HEUR_MODE_INSTANT);
+    if (configs.empty()) {
+      configs = GetEngineConfigs(CUDNN_HEUR_MODE_FALLBACK);
+    }
+    bool benchmark = CUDNNThreadEntry::ThreadLocal()->benchmark;
+    float best_ms = std::numeric_limits<float>::infinity();
+    int num_tuned = 0;
+    for (auto& config : configs) {
+      CuDNNEngineConfigCacheEntry entry(config);
+      auto plan = MakePlan(std::move(config));
+      if (!plan) {
+        continue;
+      }
+      int64_t workspace_size = GetWorkspaceSize(*plan);
+      if (!benchmark) {
+        CacheCudnnConvFusionEngineConfig.Set(key, entry);
+        plan_ = std::move(plan);
+        workspace_size_ = workspace_size;
+        return true;
+      }
+      std::shared_ptr<Memory> memory;
+      if (workspace_size > 0) {
+        try {
+          memory = Memory::Alloc(device_, workspace_size);
+        } catch (const dmlc::Error& e) {
+          continue;
+        }
+      }
+      float ms = TimePlan(cv, *plan, memory ? memory->data : nullptr);
+      DLOG(INFO) << "cuDNN conv fusion engine config " << num_tuned << ": " << ms
+                 << " ms, workspace: " << workspace_size;
+      if (ms < best_ms) {
+        best_ms = ms;
+        CacheCudnnConvFusionEngineConfig.Set(key, entry);
+        plan_ = std::move(plan);
+        workspace_size_ = workspace_size;
+      }
+      if (++num_tuned == kMaxTunedEngineConfigs) {
+        break;
+      }
+    }
+    return plan_ != nullptr;
+  }
+
+  /*! \brief Create the legacy descriptors to apply the bias and the activation separately. */
+  void InitUnfusedEpilogue() {
+    auto make_desc = [this](const TensorLayout& layout) {
+      std::vector<int> dims = CastVector<int, int64_t>(layout.dims);
+      std::vector<int> strides = CastVector<int, int64_t>(layout.strides);
+      cudnnTensorDescriptor_t desc;
+      CUDNN_CALL(cudnnCreateTensorDescriptor(&desc));
+      CUDNN_CALL(cudnnSetTensorNdDescriptor(desc, dtype_, 4, dims.data(), strides.data()));
+      return desc;
+    };
+    y_desc_ = make_desc(y_layout_);
+    if (bias_.defined()) {
+      bias_desc_ = make_desc(bias_layout_);
+    }
+    if (with_relu_) {
+      CUDNN_CALL(cudnnCreateActivationDescriptor(&act_desc_));
+      CUDNN_CALL(cudnnSetActivationDescriptor(act_desc_, CUDNN_ACTIVATION_RELU,
+                                              CUDNN_PROPAGATE_NAN, 0.0));
+    }
+  }
+
+  /*! \brief The device to run the convolution. */
+  Device device_;
+  /*! \brief The params of the fused function for the conv2d arguments and the bias. */
+  std::vector<Var> conv_args_;
+  Var bias_;
+  /*! \brief Whether the relu is applied to the output. */
+  bool with_relu_{false};
+  /*! \brief The layouts of the data and the kernel. */
+  std::string layout_, kernel_layout_;
+  /*! \brief The dims and the strides of the tensors. */
+  TensorLayout x_layout_, w_layout_, y_layout_, bias_layout_;
+  /*! \brief The data type of the inputs and the output. */
+  cudnnDataType_t dtype_;
+  /*! \brief Whether the bias and the activation are in the operation graph. */
+  bool fused_{true};
+  /*! \brief The operation graph and the selected execution plan. */
+  std::unique_ptr<BackendDescriptor> graph_;
+  std::unique_ptr<BackendDescriptor> plan_;
+  /*! \brief The workspace of the execution plan. */
+  int64_t workspace_size_{0};
+  void* workspace_{nullptr};
+  /*! \brief The legacy descriptors to run the bias and the activation when not fused. */
+  cudnnTensorDescriptor_t y_desc_{nullptr}, bias_desc_{nullptr};
+  cudnnActivationDescriptor_t act_desc_{nullptr};
+};
+
+// The add is only dispatched to cuDNN as a part of the fused functions, so it is registered with
+// a non-positive plevel that is not taken by the other dialects.
+RAF_REGISTER_DIALECT_OP(cudnn, add, -3);
+RAF_OP_ENV_MAKER("raf.op.cudnn._fused_op", CuDNNConvFusionOpEnv::make);
+
+}  // namespace cudnn
+}  // namespace op
+}  // namespace raf
+
+#endif  // CUDNN_VERSION >= 8200
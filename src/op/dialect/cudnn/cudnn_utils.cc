@@ -15,13 +15,29 @@ namespace op {
 namespace cudnn {
 
 CUDNNThreadEntry::CUDNNThreadEntry() {
+  CUDA_CALL(cudaGetDevice(&device_id));
   CUDNN_CALL(cudnnCreate(&handle));
+  handles[device_id] = handle;
 }
 
 using CUDNNThreadStore = dmlc::ThreadLocalStore<CUDNNThreadEntry>;
 
 CUDNNThreadEntry* CUDNNThreadEntry::ThreadLocal() {
-  return CUDNNThreadStore::Get();
+  CUDNNThreadEntry* entry = CUDNNThreadStore::Get();
+  int device_id = 0;
+  CUDA_CALL(cudaGetDevice(&device_id));
+  if (device_id != entry->device_id) {
+    // Switch to the handle of the current device, e.g., when the ops are placed on multiple GPUs.
+    auto it = entry->handles.find(device_id);
+    if (it == entry->handles.end()) {
+      cudnnHandle_t handle = nullptr;
+      CUDNN_CALL(cudnnCreate(&handle));
+      it = entry->handles.emplace(device_id, handle).first;
+    }
+    entry->handle = it->second;
+    entry->device_id = device_id;
+  }
+  return entry;
 }
 
 bool CudnnConfigGetBenchmark() {
@@ -32,9 +48,21 @@ void CudnnConfigSetBenchmark(bool benchmark) {
   CUDNNThreadEntry::ThreadLocal()->benchmark = benchmark;
 }
 
+int64_t CudnnConfigGetWorkspaceLimit() {
+  return CUDNNThreadEntry::ThreadLocal()->workspace_limit;
+}
+
+void CudnnConfigSetWorkspaceLimit(int64_t workspace_limit) {
+  CUDNNThreadEntry::ThreadLocal()->workspace_limit = workspace_limit;
+}
+
 RAF_REGISTER_DIALECT("cudnn").set_enable(DevType::kCUDA());
 RAF_REGISTER_GLOBAL("raf.backend.cudnn.ConfigGetBenchmark").set_body_typed(CudnnConfigGetBenchmark);
 RAF_REGISTER_GLOBAL("raf.backend.cudnn.ConfigSetBenchmark").set_body_typed(CudnnConfigSetBenchmark);
+RAF_REGISTER_GLOBAL("raf.backend.cudnn.ConfigGetWorkspaceLimit")
+    .set_body_typed(CudnnConfigGetWorkspaceLimit);
+RAF_REGISTER_GLOBAL("raf.backend.cudnn.ConfigSetWorkspaceLimit")
+    .set_body_typed(CudnnConfigSetWorkspaceLimit);
 
 }  // namespace cudnn
 }  // namespace op
@@ -10,6 +10,7 @@
 #pragma once
 #include <cudnn.h>
 #include <map>
+#include <unordered_map>
 #include <string>
 #include <vector>
 #include <functional>
@@ -176,10 +177,19 @@ class CUDNNThreadEntry {
   static CUDNNThreadEntry* ThreadLocal();
 
  public:
-  /*! \brief cudnn handle. */
+  /*! \brief cudnn handle of the current device. */
   cudnnHandle_t handle = nullptr;
+  /*! \brief The device of the handle. */
+  int device_id = -1;
+  /*! \brief The handles of the devices, as a handle is bound to the device it is created on. */
+  std::unordered_map<int, cudnnHandle_t> handles;
   /*! \brief Whether to benchmark the performance when choosing CUDNN algorithms. */
   bool benchmark = true;
+  /*!
+   * \brief The maximum workspace size in bytes of the CUDNN algorithms. A negative value means
+   * the limit is the free device memory plus the memory reserved but unused by the pool.
+   */
+  int64_t workspace_limit = -1;
 };
 
 #if CUDNN_VERSION >= 7100
@@ -329,6 +339,29 @@ inline cudnnFilterDescriptor_t NormalizeFilter(const DLTensor* tv,
   return res;
 }
 
+/*!
+ * \brief Make the descriptor of a 4-D activation in NHWC, or a 4-D filter in OHWI with the
+ * filter descriptor functions below. The dims of cuDNN descriptors are always in NCHW, while
+ * the format determines the strides.
+ */
+inline cudnnTensorDescriptor_t NormalizeNHWCTensor(const DLTensor* tv) {
+  CHECK_EQ(tv->ndim, 4) << "Expected a 4-D tensor in NHWC, but got " << tv->ndim << "-D";
+  cudnnTensorDescriptor_t res;
+  CUDNN_CALL(cudnnCreateTensorDescriptor(&res));
+  CUDNN_CALL(cudnnSetTensor4dDescriptor(res, CUDNN_TENSOR_NHWC, CUDNNDType(tv->dtype),
+                                        tv->shape[0], tv->shape[3], tv->shape[1], tv->shape[2]));
+  return res;
+}
+
+inline cudnnFilterDescriptor_t NormalizeOHWIFilter(const DLTensor* tv) {
+  CHECK_EQ(tv->ndim, 4) << "Expected a 4-D filter in OHWI, but got " << tv->ndim << "-D";
+  cudnnFilterDescriptor_t res;
+  CUDNN_CALL(cudnnCreateFilterDescriptor(&res));
+  CUDNN_CALL(cudnnSetFilter4dDescriptor(res, CUDNNDType(tv->dtype), CUDNN_TENSOR_NHWC,
+                                        tv->shape[0], tv->shape[3], tv->shape[1], tv->shape[2]));
+  return res;
+}
+
 inline std::vector<int64_t> MakeAlgoKey(const std::vector<std::vector<int64_t>>& vs) {
   std::vector<int64_t> res;
   for (auto& v : vs) {
@@ -81,6 +81,10 @@ class AvgPool2DImplementedByCUDNNPoolingForward : public raf::op::OpEnv {
   }
 
   static OpEnv* make(const CallValues& cv) {
+    // The tensor descriptors are in NCHW, so the other layouts fall back to the other dialects.
+    if (cv->args.as<raf::op::schema::PoolArgs>()->layout != "NCHW") {
+      return nullptr;
+    }
     return new AvgPool2DImplementedByCUDNNPoolingForward(cv);
   }
 };
@@ -227,6 +231,10 @@ class MaxPool2DImplementedByCUDNNPoolingForward : public raf::op::OpEnv {
   }
 
   static OpEnv* make(const CallValues& cv) {
+    // The tensor descriptors are in NCHW, so the other layouts fall back to the other dialects.
+    if (cv->args.as<raf::op::schema::PoolArgs>()->layout != "NCHW") {
+      return nullptr;
+    }
     return new MaxPool2DImplementedByCUDNNPoolingForward(cv);
   }
 };
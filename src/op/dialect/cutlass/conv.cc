@@ -8,6 +8,7 @@
  * \brief Implementation of cutlass convolution dispatch
  */
 #include "./conv.h"
+#include "../cuda/kernels/kernel_util.cuh"
 
 namespace raf {
 namespace op {
@@ -23,7 +24,8 @@ using raf::registry::TypedPackedFunc;
 bool CutlassConv2dOpEnv::Pattern(const CallValues& cv) {
   Expr expr = Downcast<ClosureValue>(cv->callee)->func->body;
   const static std::vector<std::string> conv_ops = {"raf.op.cutlass.conv2d"};
-  const static std::vector<std::string> epilogue_ops = {"raf.op.cutlass.relu"};
+  const static std::vector<std::string> epilogue_ops = {"raf.op.cutlass.relu",
+                                                        "raf.op.cutlass.gelu"};
   auto conv2d = IsOps(conv_ops);
   auto epilogue = IsOps(epilogue_ops);
   auto x = IsVar("");
@@ -42,6 +44,9 @@ bool CutlassConv2dOpEnv::Pattern(const CallValues& cv) {
   pat = with_bias || pat;
   DFPattern with_epilogue = epilogue({pat});
   pat = with_epilogue || pat;
+  // The cast is folded into the output dtype of the kernel.
+  DFPattern with_cast = IsOp("raf.op.cutlass.cast")({pat, IsWildcard()});
+  pat = with_cast || pat;
 
   if (!RAFMatchPattern(pat, expr)) {
     return false;
@@ -90,7 +95,8 @@ void CutlassConv2dOpEnv::Init(const CallValues& cv) {
                     GetNumericTypeID(w->dtype), LayoutTypeID::kTensorNHWC, w->data,
                     with_bias_ ? const_addr<1>(cudaDataType_t(DType(out->dtype)))
                                : const_addr<0>(cudaDataType_t(DType(out->dtype))),
-                    GetNumericTypeID(out->dtype), bias->data, out->data, epilogue_op_);
+                    GetNumericTypeID(out->dtype), bias->data, out->data, epilogue_op_,
+                    tunable_.kernel_name);
   arg_indices = GetArgIndices(
       cv, with_bias_ ? std::vector<Var>({x_, w_, bias_}) : std::vector<Var>({x_, w_}));
 }
@@ -128,8 +134,131 @@ void CutlassConv2dOpEnv::Execute(const std::vector<Value>& inputs, Value output)
   CUTLASS_CALL(operation_->run(&arguments_, host_workspace_, workspace_, GetStream()));
 }
 
+/*!
+ * \brief Copy the 4-D tensor of the NCHW shape from NCHW to NHWC, or from NHWC back to NCHW,
+ * which also copies the filters between KCRS and KRSC.
+ */
+void TransposeNCHW(const void* src, void* dst, const std::vector<int64_t>& nchw, bool to_nhwc,
+                   int elem_bytes, cudaStream_t stream) {
+  int64_t c = nchw[1], h = nchw[2], w = nchw[3];
+  std::vector<int64_t> nchw_strides = {c * h * w, h * w, w, 1};
+  std::vector<int64_t> nhwc_strides = {h * w * c, 1, w * c, c};
+  cuda::strided_copy_cuda(src, dst, nchw, to_nhwc ? nchw_strides : nhwc_strides,
+                          to_nhwc ? nhwc_strides : nchw_strides, elem_bytes, stream);
+}
+
+bool CutlassConv2dDxwOpEnv::IsValid(const CallValues& cv) {
+  const auto* args = cv->args.as<ConvDxwArgs>();
+  DLTensor* x_or_w = args->x_or_w;
+  DLTensor* dy = args->dy;
+  DLTensor* out = cv->out;
+  // CUTLASS competes with cuDNN on the float16 tensor cores, and leaves the other dtypes to it.
+  DType dtype(DTypeCode::kFloat(), 16);
+  return args->groups == 1 && x_or_w->ndim == 4 && dy->ndim == 4 && out->ndim == 4 &&
+         DType(x_or_w->dtype) == dtype && DType(dy->dtype) == dtype && DType(out->dtype) == dtype;
+}
+
+void CutlassConv2dDxwOpEnv::Init(const CallValues& cv) {
+  static auto fschema_index = Op::GetAttrMap<FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+  static const Op& op_dx = Op::Get("raf.op.conv2d_dx");
+  static const Op& op_dw = Op::Get("raf.op.conv2d_dw");
+  const auto* args = cv->args.as<ConvDxwArgs>();
+  DLTensor* x_or_w = args->x_or_w;
+  DLTensor* dy = args->dy;
+  DLTensor* out = cv->out;
+  stride_ = Pad<2>(args->stride);
+  padding_ = Pad<2>(args->padding);
+  dilation_ = Pad<2>(args->dilation);
+  x_or_w_shape_.assign(x_or_w->shape, x_or_w->shape + 4);
+  dy_shape_.assign(dy->shape, dy->shape + 4);
+  out_shape_.assign(out->shape, out->shape + 4);
+  // x: [N, C, H, W], w: [K, C, R, S]
+  const std::vector<int64_t>& x = is_dx_ ? out_shape_ : x_or_w_shape_;
+  const std::vector<int64_t>& w = is_dx_ ? x_or_w_shape_ : out_shape_;
+  int N = x[0], C = x[1], H = x[2], W = x[3];
+  int K = w[0], R = w[2], S = w[3];
+
+  // The NHWC copies follow each other in the buffer, each of which is aligned to 16 bytes.
+  auto aligned = [](int64_t nbytes) { return (nbytes + 15) / 16 * 16; };
+  int64_t x_or_w_bytes = aligned(BytesCompactTensor(*x_or_w));
+  int64_t dy_bytes = aligned(BytesCompactTensor(*dy));
+  buffer_mem_ =
+      memory_pool::Memory::Alloc(device_, x_or_w_bytes + dy_bytes + BytesCompactTensor(*out));
+  x_or_w_t_ = buffer_mem_->data;
+  dy_t_ = static_cast<char*>(buffer_mem_->data) + x_or_w_bytes;
+  out_t_ = static_cast<char*>(buffer_mem_->data) + x_or_w_bytes + dy_bytes;
+
+  // dgrad: dx = dy (*) w, wgrad: dw = dy (*) x, where A is always dy.
+  DType accumulation_dtype = GetAccumulationDType(DType(out->dtype));
+  NumericTypeID element = GetNumericTypeID(out->dtype);
+  cudaDataType_t scalar_dtype = cudaDataType_t(accumulation_dtype);
+  InitConvOperation(SplitKMode::kSerial, N, H, W, C, K, R, S, padding_[0], padding_[1], stride_[0],
+                    stride_[1], dilation_[0], dilation_[1], GetNumericTypeID(accumulation_dtype),
+                    GetNumericTypeID(accumulation_dtype), const_addr<1>(scalar_dtype), element,
+                    LayoutTypeID::kTensorNHWC, dy_t_, element, LayoutTypeID::kTensorNHWC,
+                    x_or_w_t_, const_addr<0>(scalar_dtype), element, out_t_, out_t_,
+                    EpilogueKindExt::kLinearCombination, tunable_.kernel_name,
+                    is_dx_ ? ConvKind::kDgrad : ConvKind::kWgrad);
+  const Op& op = is_dx_ ? op_dx : op_dw;
+  arg_indices = {fschema_index[op]("x_or_w"), fschema_index[op]("dy")};
+}
+
+OpEnv* CutlassConv2dDxwOpEnv::make(const CallValues& cv) {
+  std::unique_ptr<CutlassConv2dDxwOpEnv> op_env(std::make_unique<CutlassConv2dDxwOpEnv>(cv));
+  Op op = Downcast<OpValue>(cv->callee)->op;
+  op_env->is_dx_ = (IsDialectOp(op) ? GetBaseOp(op) : op)->name == "raf.op.conv2d_dx";
+  if (!op_env->IsValid(cv)) {
+    dispatch_error_msgs.push_back("[CUTLASS] Cannot JIT: valid? 0");
+    return nullptr;
+  }
+  // Fall back to the dialects of lower plevels, e.g., cuDNN, when no CUTLASS kernel supports it.
+  try {
+    op_env->Init(cv);
+    const auto* args = cv->args.as<ConvDxwArgs>();
+    DLTensor* x_or_w = args->x_or_w;
+    DLTensor* dy = args->dy;
+    DLTensor* out = cv->out;
+    HashKey key;
+    key << (op_env->is_dx_ ? "conv2d_dx" : "conv2d_dw") << op_env->compute_capability()
+        << op_env->stride_ << op_env->padding_ << op_env->dilation_ << *x_or_w << *dy << *out;
+    Tune(key, cv, op_env.get());
+  } catch (const dmlc::Error& e) {
+    std::stringstream ss;
+    ss << "[CUTLASS] Failed to JIT: " << e.what();
+    dispatch_error_msgs.push_back(ss.str());
+    return nullptr;
+  }
+  return op_env.release();
+}
+
+void CutlassConv2dDxwOpEnv::Execute(const CallValues& cv) {
+  const auto* args = cv->args.as<ConvDxwArgs>();
+  Execute({args->x_or_w, args->dy}, cv->out);
+}
+
+void CutlassConv2dDxwOpEnv::Execute(const std::vector<Value>& inputs, Value output) {
+  DLTensor* x_or_w = inputs[0];
+  DLTensor* dy = inputs[1];
+  DLTensor* out = output;
+  cudaStream_t stream = GetStream();
+  int elem_bytes = (out->dtype.bits + 7) / 8;
+  TransposeNCHW(x_or_w->data, x_or_w_t_, x_or_w_shape_, true, elem_bytes, stream);
+  TransposeNCHW(dy->data, dy_t_, dy_shape_, true, elem_bytes, stream);
+  arguments_.A = dy_t_;
+  arguments_.B = x_or_w_t_;
+  arguments_.C = out_t_;
+  arguments_.D = out_t_;
+  CUTLASS_CALL(operation_->run(&arguments_, host_workspace_, workspace_, stream));
+  TransposeNCHW(out_t_, out->data, out_shape_, false, elem_bytes, stream);
+}
+
 // TODO(@hzfan): Using plevel 0 due to lack of OpEnvMaker
 RAF_REGISTER_DIALECT_OP(cutlass, conv2d, 0);
+// The backward convs have OpEnvMakers, which run before cuDNN by the plevels and fall back to it.
+RAF_REGISTER_DIALECT_OP(cutlass, conv2d_dx, 20);
+RAF_OP_ENV_MAKER("raf.op.cutlass.conv2d_dx", CutlassConv2dDxwOpEnv::make);
+RAF_REGISTER_DIALECT_OP(cutlass, conv2d_dw, 20);
+RAF_OP_ENV_MAKER("raf.op.cutlass.conv2d_dw", CutlassConv2dDxwOpEnv::make);
 
 }  // namespace cutlass
 }  // namespace op
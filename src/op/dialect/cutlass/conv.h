@@ -86,6 +86,49 @@ class CutlassConv2dOpEnv : public CutlassConvOpEnv {
   EpilogueKindExt epilogue_op_;
 };
 
+/*! \brief OpEnv for conv2d_dx and conv2d_dw, which run the implicit GEMM of dgrad and wgrad.
+ * The kernels take NHWC tensors and KRSC filters, so the NCHW operands are transposed in the
+ * workspace before the kernel, and so is the result back to NCHW after it.
+ */
+class CutlassConv2dDxwOpEnv : public CutlassConvOpEnv {
+ public:
+  explicit CutlassConv2dDxwOpEnv(const CallValues& cv) : CutlassConvOpEnv(cv) {
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName(is_dx_ ? "raf.op.cutlass.conv2d_dx"
+                                             : "raf.op.cutlass.conv2d_dw"));
+  }
+
+  void Init(const CallValues& cv) override;
+
+  void Execute(const CallValues& cv) override;
+
+  void Execute(const std::vector<Value>& inputs, Value output) override;
+
+  bool IsValid(const CallValues& cv);
+
+  static OpEnv* make(const CallValues& cv);
+
+ private:
+  /*! \brief Whether it is conv2d_dx, i.e., dgrad, otherwise conv2d_dw, i.e., wgrad */
+  bool is_dx_;
+  /*! \brief convolution stride */
+  std::vector<int64_t> stride_;
+  /*! \brief convolution padding */
+  std::vector<int64_t> padding_;
+  /*! \brief convolution dilation */
+  std::vector<int64_t> dilation_;
+  /*! \brief NCHW shapes of x_or_w, dy and the output */
+  std::vector<int64_t> x_or_w_shape_, dy_shape_, out_shape_;
+  /*! \brief NHWC copies of x_or_w, dy and the output in the buffer */
+  void* x_or_w_t_{nullptr};
+  void* dy_t_{nullptr};
+  void* out_t_{nullptr};
+  /*! \brief Buffer of the NHWC copies */
+  std::shared_ptr<memory_pool::Memory> buffer_mem_{nullptr};
+};
+
 }  // namespace cutlass
 }  // namespace op
 }  // namespace raf
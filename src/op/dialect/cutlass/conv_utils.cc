@@ -20,63 +20,96 @@ void CutlassConvOpEnv::InitConvOperation(
     NumericTypeID element_compute, void const* alpha, NumericTypeID element_A,
     LayoutTypeID layout_A, void const* ptr_A, NumericTypeID element_B, LayoutTypeID layout_B,
     void const* ptr_B, void const* beta, NumericTypeID element_C, void const* ptr_C, void* ptr_D,
-    EpilogueKindExt epilogue_math_op, const std::string& preferred_name) {
+    EpilogueKindExt epilogue_math_op, const std::string& preferred_name, ConvKind conv_kind) {
   int P = (H + 2 * pad_h - ((R - 1) * dilation_h + 1)) / stride_h + 1;
 
   int Q = (W + 2 * pad_w - ((S - 1) * dilation_w + 1)) / stride_w + 1;
 
+  // NHWC
+  std::vector<int> nhwc = {C, C * W, C * W * H};
+  // KRSC
+  std::vector<int> krsc = {C, C * S, C * S * R};
+  // NPQK
+  std::vector<int> npqk = {K, K * Q, K * Q * P};
+  std::vector<int> stride_a, stride_b, stride_c;
+  // The implicit GEMM of each convolution kind.
+  switch (conv_kind) {
+    case ConvKind::kFprop:
+      problem_m_ = N * P * Q;
+      problem_n_ = K;
+      problem_k_ = C * R * S;
+      stride_a = nhwc;
+      stride_b = krsc;
+      stride_c = npqk;
+      break;
+    case ConvKind::kDgrad:
+      problem_m_ = N * H * W;
+      problem_n_ = C;
+      problem_k_ = K * R * S;
+      stride_a = npqk;
+      stride_b = krsc;
+      stride_c = nhwc;
+      break;
+    case ConvKind::kWgrad:
+      problem_m_ = K;
+      problem_n_ = C * R * S;
+      problem_k_ = N * P * Q;
+      stride_a = npqk;
+      stride_b = nhwc;
+      stride_c = krsc;
+      break;
+    default:
+      LOG(FATAL) << "Unsupported conv kind: " << to_string(conv_kind);
+  }
+
   functional_key_ = std::make_unique<ConvFunctionalKeyExt>(
-      provider_, ConvKind::kFprop, element_A, layout_A, element_B, layout_B, element_C, layout_A,
+      provider_, conv_kind, element_A, layout_A, element_B, layout_B, element_C, layout_A,
       element_accumulator, element_compute, epilogue_math_op);
 
   auto operators_it = SingletonExt::get().operation_table.conv2d_operations.find(*functional_key_);
 
-  CHECK(operators_it != SingletonExt::get().operation_table.conv2d_operations.end());
+  CHECK(operators_it != SingletonExt::get().operation_table.conv2d_operations.end())
+      << "Cannot find the required " << to_string(conv_kind) << " conv op in CUTLASS";
   CHECK(!operators_it->second.empty());
 
   preference_key_ =
       std::make_unique<ConvPreferenceKey>(compute_capability(), IteratorAlgorithmID::kOptimized);
 
-  Operation const* operation =
-      find_conv2d_operation(operators_it, *preference_key_, preferred_name);
-  CHECK(operation);
-
-  operation_ = operation;
-
   // Configure operation
   conv::Conv2dProblemSize problem_size =
       conv::Conv2dProblemSize(N, H, W, C, K, R, S, P, Q, pad_h, pad_w, stride_h, stride_w,
                               dilation_h, dilation_w, conv::Mode::kCrossCorrelation);
-  // NHWC
-  std::vector<int> stride_a = {C, C * W, C * W * H};
-  // KRSC
-  std::vector<int> stride_b = {C, C * S, C * S * R};
-  // NPQK
-  std::vector<int> stride_c = {K, K * Q, K * Q * P};
-  Conv2dConfiguration configuration{(conv::SplitKMode)mode, problem_size, stride_a, stride_b,
-                                    stride_c};
+  configuration_ = Conv2dConfiguration{(conv::SplitKMode)mode, problem_size, stride_a, stride_b,
+                                       stride_c};
+  arguments_ = ConvArguments{
+      nullptr, nullptr, nullptr, nullptr, alpha, beta, scalar_pointer_mode_,
+  };
+
+  // Some kernels only support parts of the problems, e.g., the dgrad kernels of unit strides.
+  Operation const* operation = find_conv2d_operation(operators_it, *preference_key_,
+                                                     preferred_name, &configuration_, &arguments_);
+  CHECK(operation) << "No conv op in CUTLASS can implement the problem";
+
+  operation_ = operation;
 
   // Query host work space size
-  uint64_t host_workspace_size_needed = operation->get_host_workspace_size(&configuration);
+  uint64_t host_workspace_size_needed = operation->get_host_workspace_size(&configuration_);
   CHECK_GE(uint64_t(kHostWorkspaceSize), host_workspace_size_needed);
 
   // Query device workspace size
-  workspace_size_ = operation->get_device_workspace_size(&configuration);
+  workspace_size_ = operation->get_device_workspace_size(&configuration_);
   if (workspace_size_ > 0) {
     RequestWorkspace(&workspace_, device_, workspace_size_);
   }
 
   // Initialize host and device workspaces
-  CUTLASS_CALL(operation->initialize(&configuration, host_workspace_, workspace_, GetStream()));
-
-  arguments_ = ConvArguments{
-      nullptr, nullptr, nullptr, nullptr, alpha, beta, scalar_pointer_mode_,
-  };
+  CUTLASS_CALL(operation->initialize(&configuration_, host_workspace_, workspace_, GetStream()));
 }
 
 std::vector<std::unique_ptr<TunableConfig>> CutlassConvOpEnv::ListTunableConfigs() {
   // Tunable configuration: kernel_name
   std::vector<std::string> kernel_names;
+  std::vector<::cutlass::gemm::GemmCoord> tiles;
   auto operators_it = SingletonExt::get().operation_table.conv2d_operations.find(*functional_key_);
   CHECK(operators_it != SingletonExt::get().operation_table.conv2d_operations.end());
   auto cc_it = operators_it->second.upper_bound(*preference_key_);
@@ -89,14 +122,20 @@ std::vector<std::unique_ptr<TunableConfig>> CutlassConvOpEnv::ListTunableConfigs
       IteratorAlgorithmID iterator_algorithm = desc.iterator_algorithm;
       if ((min_cc <= preference_key_->compute_capability) &&
           (preference_key_->compute_capability <= max_cc) &&
-          (iterator_algorithm <= preference_key_->iterator_algorithm)) {
+          (iterator_algorithm <= preference_key_->iterator_algorithm) &&
+          op->can_implement(&configuration_, &arguments_) == Status::kSuccess) {
         kernel_names.push_back(desc.name);
+        tiles.push_back(desc.tile_description.threadblock_shape);
       }
     }
   }
+  // Prune the tiles that are much larger than the implicit GEMM problem.
+  std::vector<bool> keep = PruneTiles(tiles, problem_m_, problem_n_);
   std::vector<std::unique_ptr<TunableConfig>> rets;
-  for (const auto& name : kernel_names) {
-    rets.push_back(std::make_unique<ConvTunableConfig>(name));
+  for (size_t i = 0; i < kernel_names.size(); ++i) {
+    if (keep[i]) {
+      rets.push_back(std::make_unique<ConvTunableConfig>(kernel_names[i]));
+    }
   }
   return rets;
 }
@@ -107,7 +146,9 @@ void CutlassConvOpEnv::SetTunableConfig(const std::unique_ptr<TunableConfig>& tu
 
 const Operation* find_conv2d_operation(ConvOperationFunctionalMapExt::const_iterator operators_it,
                                        ConvPreferenceKey const preference_key,
-                                       const std::string& preferred_name) {
+                                       const std::string& preferred_name,
+                                       Conv2dConfiguration const* configuration,
+                                       ConvArguments const* arguments) {
   // It selects kernels based on the compute capability and iterator algorithm.
   // The runtime hardware restricts upper bound of the compute capability.
   // The preference key restricts upper bound of the iterator algorithm.
@@ -118,6 +159,8 @@ const Operation* find_conv2d_operation(ConvOperationFunctionalMapExt::const_iter
   // an arbitrary one is selected.
   //
   // If preferred_name is designated, the operator with the preferred name is selected.
+  //
+  // If configuration is given, the operators that cannot implement it are skipped.
   auto cc_it = operators_it->second.upper_bound(preference_key);
 
   if (cc_it == operators_it->second.begin()) {
@@ -146,7 +189,9 @@ const Operation* find_conv2d_operation(ConvOperationFunctionalMapExt::const_iter
 
       if ((min_cc <= preference_key.compute_capability) &&
           (preference_key.compute_capability <= max_cc) &&
-          (iterator_algorithm <= preference_key.iterator_algorithm)) {
+          (iterator_algorithm <= preference_key.iterator_algorithm) &&
+          (configuration == nullptr ||
+           op->can_implement(configuration, arguments) == Status::kSuccess)) {
         if (operation == nullptr) {
           operation = op;
         } else if (desc.name == preferred_name) {
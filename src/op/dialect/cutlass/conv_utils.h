@@ -70,6 +70,8 @@ class CutlassConvOpEnv : public CutlassOpEnv {
    * \param epilogue_math_op Epilogue operator
    * \param preferred_name Preferred kernel name.
                            See the implementation of find_conv2d_operation for details
+   * \param conv_kind The convolution kind. For dgrad, A is dy and C is dx. For wgrad, A is dy,
+   *                  B is x and C is dw. All the tensors are NHWC (or KRSC for the filter).
    */
   void InitConvOperation(SplitKMode mode, int N, int H, int W, int C, int K, int R, int S,
                          int pad_h, int pad_w, int stride_h, int stride_w, int dilation_h,
@@ -79,11 +81,14 @@ class CutlassConvOpEnv : public CutlassOpEnv {
                          LayoutTypeID layout_B, void const* ptr_B, void const* beta,
                          NumericTypeID element_C, void const* ptr_C, void* ptr_D,
                          EpilogueKindExt epilogue_math_op = EpilogueKindExt::kLinearCombination,
-                         const std::string& preferred_name = "");
+                         const std::string& preferred_name = "",
+                         ConvKind conv_kind = ConvKind::kFprop);
 
  protected:
   /*! \brief Convolution operator arguments */
   ConvArguments arguments_;
+  /*! \brief Convolution problem configuration, which filters the kernels that can implement it */
+  Conv2dConfiguration configuration_;
   /*! \brief Conv functional key */
   std::unique_ptr<ConvFunctionalKeyExt> functional_key_;
   /*! \brief Conv functional key */
@@ -97,10 +102,15 @@ class CutlassConvOpEnv : public CutlassOpEnv {
  * \param operators_it An iterator for all valid operators
  * \param preference_key Describes the preferred operator
  * \param preferred_name Describes the name of the preferred operator
+ * \param configuration The problem configuration. If given, the operators that cannot implement
+ *                      it with the arguments are skipped.
+ * \param arguments The operator arguments, which are required with the configuration
  */
 Operation const* find_conv2d_operation(ConvOperationFunctionalMapExt::const_iterator operators_it,
                                        ConvPreferenceKey const preference_key,
-                                       const std::string& preferred_name = "");
+                                       const std::string& preferred_name = "",
+                                       Conv2dConfiguration const* configuration = nullptr,
+                                       ConvArguments const* arguments = nullptr);
 
 }  // namespace cutlass
 }  // namespace op
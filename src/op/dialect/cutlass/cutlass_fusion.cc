@@ -7,8 +7,12 @@
  * \file ./src/op/dialect/cutlass/cutlass_fusion.cc
  * \brief Implementation of cutlass dispatch for fused functions
  */
+#include <chrono>
+#include <cstdlib>
 #include <limits>
+#include <sstream>
 
+#include "raf/cache.h"
 #include "raf/value.h"
 #include "raf/profiler.h"
 #include "raf/registry.h"
@@ -18,9 +22,11 @@
 #include "raf/pass.h"
 #include "tvm/ir/type_functor.h"
 #include "tvm/relay/dataflow_pattern.h"
+#include "../3rdparty/tvm/src/runtime/file_utils.h"
 #include "./timer.h"
 #include "./gemm.h"
 #include "./conv.h"
+#include "./grouped_gemm.h"
 
 namespace raf {
 namespace op {
@@ -30,26 +36,121 @@ using namespace raf::ir;
 using namespace raf::value;
 using raf::registry::TypedPackedFunc;
 
-OpEnv* Tune(const op::CallValues& call, OpEnv* op_env) {
-  CutlassOpEnv* env = static_cast<CutlassOpEnv*>(op_env);
+/*! \brief The cache entry of the best tunable config of a problem, recorded as its text. */
+class CutlassTuneCacheEntry {
+ public:
+  explicit CutlassTuneCacheEntry(std::string config) : config_(config) {
+  }
+
+  const std::string& Value() const {
+    return config_;
+  }
+
+  static CutlassTuneCacheEntry Load(const std::string& path) {
+    std::string data;
+    tvm::runtime::LoadBinaryFromFile(path + "/config.txt", &data);
+    return CutlassTuneCacheEntry(data);
+  }
+
+  bool Save(const std::string& path) {
+    tvm::runtime::SaveBinaryToFile(path + "/config.txt", config_);
+    return true;
+  }
+
+ private:
+  /*! \brief The text of the best tunable config. */
+  std::string config_;
+};
+
+MetaPersistCache<CutlassTuneCacheEntry> CacheCutlassTune("cutlass_tune", true);
+
+inline std::string ConfigText(const std::unique_ptr<TunableConfig>& config) {
+  std::ostringstream os;
+  os << config;
+  return os.str();
+}
+
+/*!
+ * \brief The key of the tuning cache, which includes the fused function (ops and layouts),
+ * the shapes and dtypes of the inputs and output, and the GPU architecture.
+ */
+HashKey TuneKey(const op::CallValues& call, CutlassOpEnv* env) {
+  HashKey key;
+  Function func = Downcast<ClosureValue>(call->callee)->func;
+  key << AsText(func->body, false) << env->compute_capability();
+  for (const auto& arg : GetListArgs(call->args)) {
+    if (arg->IsInstance<TensorValueObj>()) {
+      const DLTensor* tensor = Downcast<TensorValue>(arg);
+      key << *tensor;
+    } else {
+      key << 0;
+    }
+  }
+  const DLTensor* out = call->out;
+  key << *out;
+  return key;
+}
+
+/*!
+ * \brief The time budget of tuning a kernel in milliseconds, which is set by the environment
+ * variable RAF_CUTLASS_TUNE_BUDGET_MS. Non-positive values mean no budget.
+ */
+double GetTuneBudgetMs() {
+  static double budget = []() {
+    const char* env = getenv("RAF_CUTLASS_TUNE_BUDGET_MS");
+    return env ? std::atof(env) : 2000.0;
+  }();
+  return budget;
+}
+
+void Tune(const HashKey& key, const op::CallValues& call, CutlassOpEnv* env) {
   std::vector<std::unique_ptr<TunableConfig>> tunable = env->ListTunableConfigs();
+  if (auto cached = CacheCutlassTune.Get(key.byte_vector)) {
+    for (auto& i : tunable) {
+      if (ConfigText(i) == cached->Value()) {
+        env->SetTunableConfig(i);
+        env->Init(call);
+        return;
+      }
+    }
+    // The cached config is no longer available (e.g., the CUTLASS library is changed).
+    DLOG(WARNING) << "Cannot find the cached CUTLASS config, retuning:\n" << cached->Value();
+  }
+
+  // Screen each config with a single run, and only measure it with more runs when it is not
+  // much slower than the current best one. Stop after the time budget is used up.
   const int number = 10, repeat = 1, min_repeat_ms = 0;
+  const double kScreenRatio = 1.5;
+  const double budget_ms = GetTuneBudgetMs();
+  auto start = std::chrono::steady_clock::now();
   std::unique_ptr<TunableConfig> best;
   double min_time = std::numeric_limits<double>::max();
+  size_t num_tried = 0;
   for (auto& i : tunable) {
     env->SetTunableConfig(i);
     env->Init(call);
-    Array<FloatValue> result = TimeEvaluator(TypedPackedFunc<void()>([&]() { env->Execute(call); }),
-                                             call->device, number, repeat, min_repeat_ms)();
-    CHECK_EQ(result.size(), 1U);
-    if (result[0]->value < min_time) {
-      min_time = result[0]->value;
-      best = std::move(i);
+    auto run = TypedPackedFunc<void()>([&]() { env->Execute(call); });
+    ++num_tried;
+    Array<FloatValue> screen = TimeEvaluator(run, call->device, 1, repeat, min_repeat_ms)();
+    CHECK_EQ(screen.size(), 1U);
+    if (screen[0]->value <= min_time * kScreenRatio) {
+      Array<FloatValue> result = TimeEvaluator(run, call->device, number, repeat, min_repeat_ms)();
+      CHECK_EQ(result.size(), 1U);
+      if (result[0]->value < min_time) {
+        min_time = result[0]->value;
+        best = std::move(i);
+      }
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    if (budget_ms > 0 && elapsed.count() > budget_ms) {
+      break;
     }
   }
+  DLOG(INFO) << "Tuned " << num_tried << " of " << tunable.size() << " CUTLASS configs";
+  CHECK(best != nullptr) << "No valid CUTLASS config";
+  CacheCutlassTune.Set(key.byte_vector, CutlassTuneCacheEntry(ConfigText(best)));
   env->SetTunableConfig(best);
   env->Init(call);
-  return env;
 }
 
 /*!
@@ -60,9 +161,15 @@ OpEnv* Tune(const op::CallValues& call, OpEnv* op_env) {
  *          - gemm_op(a, b)
  *          - gemm_op(a, b) + bias
  *          - epilogue_op(gemm_op(a, b) + bias)
+ *          - cast(epilogue_op(gemm_op(a, b))), where a and b are float16 and the output is float32
+ *          - grouped_matmul(x, w, group_sizes) and grouped_matmul_dw(x, dy, group_sizes)
+ *          - _contrib_sparse_dense(x, w, meta), where w and meta are the 2:4 sparse weight
  *        where gemm_op = matmul | matmul_nt | matmul_tn | matmul_tt | dense |
- *                        batch_matmul | batch_matmul_nt | batch_matmul_tn | batch_matmul_tt
- *              epilogue_op = relu
+ *                        batch_matmul | batch_matmul_nt | batch_matmul_tn | batch_matmul_tt |
+ *                        conv2d
+ *              epilogue_op = relu | gelu
+ *        The bias can be broadcast or in the full output shape, so a residual add also runs in
+ *        the epilogue. SimplifyExpr reassociates gemm_op(a, b) + bias + residual to this form.
  * \param call the call value to be dispatched
  * \return the CUTLASS OpEnv. nullptr if not supported by CUTLASS
  */
@@ -76,13 +183,18 @@ OpEnv* FusedFuncBuild(const op::CallValues& call) {
   auto fmake_tune = [&env, &call](FMaker maker) {
     env = maker(call);
     if (env) {
-      Tune(call, env);
+      CutlassOpEnv* cutlass_env = static_cast<CutlassOpEnv*>(env);
+      Tune(TuneKey(call, cutlass_env), call, cutlass_env);
     }
   };
   if (!pattern_name.compare(0, 6, "matmul") || !pattern_name.compare(0, 12, "batch_matmul")) {
     fmake_tune(CutlassMatmulOpEnv::make);
   } else if (!pattern_name.compare(0, 4, "conv")) {
     fmake_tune(CutlassConv2dOpEnv::make);
+  } else if (!pattern_name.compare(0, 14, "grouped_matmul")) {
+    fmake_tune(CutlassGroupedMatmulOpEnv::make);
+  } else if (!pattern_name.compare(0, 12, "sparse_dense")) {
+    fmake_tune(CutlassSparseDenseOpEnv::make);
   } else {
     LOG(FATAL) << "Unknown cutlass fusion pattern: " << pattern_name;
   }
@@ -7,6 +7,8 @@
  * \file src/op/dialect/cutlass/cutlass_utils.cc
  * \brief Helper functions for cutlass
  */
+#include <algorithm>
+#include <limits>
 #include <sstream>
 
 #include "cutlass/library/singleton.h"
@@ -22,7 +24,7 @@ namespace cutlass {
 using namespace raf::ir;
 using namespace raf::value;
 
-RAF_REGISTER_DIALECT("cutlass").set_enable(DevType::kCUDA());
+RAF_REGISTER_DIALECT("cutlass").set_enable(DevType::kCUDA()).set_jit();
 
 CutlassOpEnv::CutlassOpEnv(const CallValues& call) : device_(call->device) {
   CUDA_CALL(cudaGetDeviceProperties(&device_prop_, device_.device_id()));
@@ -110,6 +112,25 @@ DType GetAccumulationDType(DType dtype) {
   return DType();
 }
 
+std::vector<bool> PruneTiles(const std::vector<::cutlass::gemm::GemmCoord>& tiles, int M, int N) {
+  // Allow the padded problem to be 25% larger than the one padded to the best tile.
+  const double kMaxWasteRatio = 1.25;
+  auto padded_size = [&](const ::cutlass::gemm::GemmCoord& tile) {
+    double m = (M + tile.m() - 1) / tile.m() * tile.m();
+    double n = (N + tile.n() - 1) / tile.n() * tile.n();
+    return m * n;
+  };
+  double min_size = std::numeric_limits<double>::max();
+  for (const auto& tile : tiles) {
+    min_size = std::min(min_size, padded_size(tile));
+  }
+  std::vector<bool> keep;
+  for (const auto& tile : tiles) {
+    keep.push_back(padded_size(tile) <= min_size * kMaxWasteRatio);
+  }
+  return keep;
+}
+
 // Register auxilary ops
 RAF_REGISTER_DIALECT_OP(cutlass, add, 0);
 RAF_REGISTER_DIALECT_OP(cutlass, subtract, 0);
@@ -117,6 +138,7 @@ RAF_REGISTER_DIALECT_OP(cutlass, multiply, 0);
 RAF_REGISTER_DIALECT_OP(cutlass, divide, 0);
 RAF_REGISTER_DIALECT_OP(cutlass, relu, 0);
 RAF_REGISTER_DIALECT_OP(cutlass, gelu, 0);
+RAF_REGISTER_DIALECT_OP(cutlass, cast, 0);
 
 }  // namespace cutlass
 }  // namespace op
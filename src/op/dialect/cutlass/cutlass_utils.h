@@ -16,6 +16,7 @@
 #include "cutlass_ext/library/operation_table_ext.h"
 #include "cutlass_ext/library/singleton_ext.h"
 
+#include "raf/cache.h"
 #include "raf/ir.h"
 #include "raf/value.h"
 #include "raf/registry.h"
@@ -61,7 +62,15 @@ class CutlassOpEnv : public raf::op::OpEnv {
   /*! \brief Initialize with default configuration */
   virtual void Init(const CallValues& call) = 0;
 
+  /*! \brief Returns the number of streaming multiprocessors of the selected device. */
+  int num_sms() const {
+    return device_prop_.multiProcessorCount;
+  }
+
  protected:
+  /*! \brief The M, N and K of the (implicit) GEMM problem, used to prune the tunable configs */
+  int problem_m_{0}, problem_n_{0}, problem_k_{0};
+
   /*! \brief Host workspace */
   static int const kHostWorkspaceSize = (4 << 10);
 
@@ -121,6 +130,26 @@ std::vector<int> GetArgIndices(const op::CallValues& call, const Array<Var>& par
 
 DType GetAccumulationDType(DType dtype);
 
+/*!
+ * \brief Tune the OpEnv over its tunable configs, and initialize it with the best one, which is
+ * cached with the key across processes.
+ * \param key The key of the problem, e.g., the ops, shapes and dtypes of the call
+ * \param call The call values to be tuned
+ * \param env The OpEnv that has been initialized with the default config
+ */
+void Tune(const HashKey& key, const op::CallValues& call, CutlassOpEnv* env);
+
+/*!
+ * \brief Prune the threadblock tiles that waste too much computation on the padding of the
+ * problem. The problem padded to a tile is compared with the one padded to the best tile, so
+ * at least one tile is kept.
+ * \param tiles The threadblock shape of each kernel
+ * \param M GEMM M dimension
+ * \param N GEMM N dimension
+ * \return Whether to keep each tile
+ */
+std::vector<bool> PruneTiles(const std::vector<::cutlass::gemm::GemmCoord>& tiles, int M, int N);
+
 template <typename T>
 T GetPattern(const ir::Map<ir::DFPattern, ir::Array<ir::Expr>>& vmap, ir::DFPattern x) {
   if (vmap.count(x) == 0) {
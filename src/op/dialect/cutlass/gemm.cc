@@ -20,6 +20,7 @@
 #include "./cutlass_utils.h"
 #include "./pattern_utils.h"
 #include "./gemm_utils.h"
+#include "../cuda/kernels/kernel_util.cuh"
 #include "../../schema/ufunc.h"
 #include "../../schema/nn.h"
 #include "../../../common/shape_utils.h"
@@ -32,6 +33,7 @@ using namespace raf::ir;
 using namespace raf::value;
 using raf::registry::PackedFunc;
 using raf::registry::TypedPackedFunc;
+using common::shape_utils::BytesCompactTensor;
 
 std::tuple<bool, bool> GetTranspose(const Op& op) {
   const static std::vector<Op> transpose_a_ops = {
@@ -85,6 +87,9 @@ bool CutlassMatmulOpEnv::Pattern(const CallValues& cv) {
   pat = with_bias || pat;
   DFPattern with_epilogue = epilogue({pat});
   pat = with_epilogue || pat;
+  // The cast is folded into the output dtype of the kernel.
+  DFPattern with_cast = IsOp("raf.op.cutlass.cast")({pat, IsWildcard()});
+  pat = with_cast || pat;
 
   if (!RAFMatchPattern(pat, expr)) {
     LOG(INFO) << "Failed to match the pattern";
@@ -145,7 +150,8 @@ void CutlassMatmulOpEnv::Init(const CallValues& cv) {
   int m = c->shape[batched + 1];
   int n = c->shape[batched + 0];
   int k = transpose_b_ ? b->shape[batched + 1] : b->shape[batched + 0];
-  CHECK(DType(c->dtype) == DType(bias->dtype));
+  CHECK(DType(c->dtype) == DType(bias->dtype))
+      << "The bias must be in the output dtype " << DType(c->dtype).c_str();
 
   int lda = a->shape[batched + 1];
   int ldb = b->shape[batched + 1];
@@ -217,6 +223,135 @@ void CutlassMatmulOpEnv::Execute(const std::vector<Value>& inputs, Value output)
   CUTLASS_CALL(operation_->run(&arguments_, host_workspace_, workspace_, GetStream()));
 }
 
+bool CutlassSparseDenseOpEnv::Pattern(const CallValues& cv) {
+  static const Op& sparse_dense = Op::Get("raf.op.cutlass._contrib_sparse_dense");
+  Expr expr = Downcast<ClosureValue>(cv->callee)->func->body;
+  const auto* call = expr.as<CallNode>();
+  if (call == nullptr || call->op != sparse_dense || call->args.size() != 3U) {
+    LOG(INFO) << "Failed to match the pattern";
+    return false;
+  }
+  for (const Expr& arg : call->args) {
+    if (!arg->IsInstance<VarNode>()) {
+      return false;
+    }
+  }
+  x_ = Downcast<Var>(call->args[0]);
+  w_ = Downcast<Var>(call->args[1]);
+  meta_ = Downcast<Var>(call->args[2]);
+  return true;
+}
+
+void CutlassSparseDenseOpEnv::Init(const CallValues& cv) {
+  DLTensor* x = GetValue<TensorValue>(cv, x_);
+  DLTensor* w = GetValue<TensorValue>(cv, w_);
+  DLTensor* out = cv->out;
+  CHECK(DType(x->dtype) == DType(DTypeCode::kFloat(), 16))
+      << "The sparse tensor cores only take float16 inputs";
+  // out^T = w * x^T, where the sparse operand w is [m, k] and x^T is the column-major [k, n].
+  int m = w->shape[0];
+  int n = x->shape[0];
+  int k = x->shape[1];
+  CHECK_EQ(m % 16, 0) << "The output features must be a multiple of 16";
+  CHECK_EQ(k % 64, 0) << "The input features must be a multiple of 64";
+  int lda = k / 2;
+  int ldb = k;
+  int ldc = n;
+  int lde = 2 * m;
+  problem_m_ = m;
+  problem_n_ = n;
+  problem_k_ = k;
+
+  DType accumulation_dtype = GetAccumulationDType(DType(out->dtype));
+  DType scalar_dtype = accumulation_dtype;
+  NumericTypeID element = GetNumericTypeID(x->dtype);
+  NumericTypeID element_c = GetNumericTypeID(out->dtype);
+  functional_key_ = std::make_unique<GemmFunctionalKeyExt>(
+      provider_, GemmKind::kSparse, GetNumericTypeID(accumulation_dtype),
+      GetNumericTypeID(scalar_dtype), element, LayoutTypeID::kRowMajor, ComplexTransform::kNone,
+      element, LayoutTypeID::kColumnMajor, ComplexTransform::kNone, element_c,
+      EpilogueKindExt::kLinearCombination);
+  auto operators_it = SingletonExt::get().operation_table.gemm_operations.find(*functional_key_);
+  CHECK(operators_it != SingletonExt::get().operation_table.gemm_operations.end())
+      << "Cannot find the required sparse GEMM op in CUTLASS with the functional key:\n"
+      << *functional_key_;
+  CHECK(!operators_it->second.empty());
+
+  int const kMaximumAlignmentSize = 16;
+  int alignment = gemm_problem_alignment(m, n, k, element, w->data, lda, 0, element, x->data, ldb,
+                                         0, element_c, out->data, ldc, 0, out->data, ldc, 0,
+                                         kMaximumAlignmentSize);
+  preference_key_ = std::make_unique<GemmPreferenceKey>(compute_capability(), alignment);
+  operation_ = find_gemm_operation(operators_it, *preference_key_, tunable_.kernel_name);
+  CHECK(operation_) << "No sparse GEMM op in CUTLASS supports the alignment " << alignment;
+
+  SparseGemmConfiguration configuration{{m, n, k}, 1, lda, ldb, ldc, ldc, lde};
+  uint64_t host_workspace_size_needed = operation_->get_host_workspace_size(&configuration);
+  CHECK_GE(uint64_t(kHostWorkspaceSize), host_workspace_size_needed);
+
+  // The workspace of the kernel is followed by the transposed output.
+  workspace_size_ = operation_->get_device_workspace_size(&configuration);
+  size_t out_offset = (workspace_size_ + kMaximumAlignmentSize - 1) / kMaximumAlignmentSize *
+                      kMaximumAlignmentSize;
+  RequestWorkspace(&workspace_, device_, out_offset + BytesCompactTensor(*out));
+  out_t_ = static_cast<char*>(workspace_) + out_offset;
+  CUTLASS_CALL(operation_->initialize(&configuration, host_workspace_, workspace_, GetStream()));
+
+  sparse_arguments_ = SparseGemmArguments{nullptr,
+                                          nullptr,
+                                          out_t_,
+                                          out_t_,
+                                          nullptr,
+                                          const_addr<1>(cudaDataType_t(scalar_dtype)),
+                                          const_addr<0>(cudaDataType_t(scalar_dtype)),
+                                          scalar_pointer_mode_};
+  arg_indices = GetArgIndices(cv, std::vector<Var>({x_, w_, meta_}));
+}
+
+std::vector<std::unique_ptr<TunableConfig>> CutlassSparseDenseOpEnv::ListTunableConfigs() {
+  // The sparse kernel does not split K, so only the kernels are tuned.
+  std::vector<std::unique_ptr<TunableConfig>> rets;
+  for (auto& config : CutlassGemmOpEnv::ListTunableConfigs()) {
+    if (static_cast<GemmTunableConfig*>(config.get())->split_k_slices == 1) {
+      rets.push_back(std::move(config));
+    }
+  }
+  return rets;
+}
+
+OpEnv* CutlassSparseDenseOpEnv::make(const CallValues& cv) {
+  std::unique_ptr<CutlassSparseDenseOpEnv> op_env(std::make_unique<CutlassSparseDenseOpEnv>(cv));
+  if (!op_env->Pattern(cv)) {
+    dispatch_error_msgs.push_back("[CUTLASS] Cannot JIT: matched pattern? 0");
+    return nullptr;
+  }
+  try {
+    op_env->Init(cv);
+  } catch (const dmlc::Error& e) {
+    std::stringstream ss;
+    ss << "[CUTLASS] Failed to JIT: " << e.what();
+    dispatch_error_msgs.push_back(ss.str());
+    return nullptr;
+  }
+  return op_env.release();
+}
+
+void CutlassSparseDenseOpEnv::Execute(const std::vector<Value>& inputs, Value output) {
+  DLTensor* x = Downcast<TensorValue>(inputs[0]);
+  DLTensor* w = Downcast<TensorValue>(inputs[1]);
+  DLTensor* meta = Downcast<TensorValue>(inputs[2]);
+  DLTensor* out = Downcast<TensorValue>(output);
+  cudaStream_t stream = GetStream();
+  sparse_arguments_.A = w->data;
+  sparse_arguments_.B = x->data;
+  sparse_arguments_.E = meta->data;
+  CUTLASS_CALL(operation_->run(&sparse_arguments_, host_workspace_, workspace_, stream));
+  int64_t m = w->shape[0];
+  int64_t n = x->shape[0];
+  cuda::strided_copy_cuda(out_t_, out->data, {n, m}, {1, n}, {m, 1}, (out->dtype.bits + 7) / 8,
+                          stream);
+}
+
 // TODO(@hzfan): Using plevel 0 due to lack of OpEnvMaker
 RAF_REGISTER_DIALECT_OP(cutlass, matmul, 0);
 RAF_REGISTER_DIALECT_OP(cutlass, matmul_nt, 0);
@@ -227,6 +362,7 @@ RAF_REGISTER_DIALECT_OP(cutlass, batch_matmul, 0);
 RAF_REGISTER_DIALECT_OP(cutlass, batch_matmul_nt, 0);
 RAF_REGISTER_DIALECT_OP(cutlass, batch_matmul_tn, 0);
 RAF_REGISTER_DIALECT_OP(cutlass, batch_matmul_tt, 0);
+RAF_REGISTER_DIALECT_OP(cutlass, _contrib_sparse_dense, 0);
 
 }  // namespace cutlass
 }  // namespace op
@@ -73,6 +73,43 @@ class CutlassMatmulOpEnv : public CutlassGemmOpEnv {
   EpilogueKindExt epilogue_op_;
 };
 
+/*! \brief OpEnv for _contrib_sparse_dense(x, w, meta), i.e., the float16 dense layer whose 2:4
+ * sparse weight is compressed into the values w and the metadata meta, which runs on the sparse
+ * tensor cores. The sparse kernels only write row-major outputs, so the transposed output
+ * w * x^T is computed into the workspace and then transposed.
+ */
+class CutlassSparseDenseOpEnv : public CutlassGemmOpEnv {
+ public:
+  explicit CutlassSparseDenseOpEnv(const CallValues& cv) : CutlassGemmOpEnv(cv) {
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cutlass._contrib_sparse_dense"));
+  }
+
+  bool Pattern(const CallValues& cv);
+
+  void Init(const CallValues& cv) override;
+
+  void Execute(const std::vector<Value>& inputs, Value output);
+
+  std::vector<std::unique_ptr<TunableConfig>> ListTunableConfigs() override;
+
+  static OpEnv* make(const CallValues& cv);
+
+ private:
+  /*! \brief the dense input */
+  Var x_;
+  /*! \brief the non-zero values of the sparse weight */
+  Var w_;
+  /*! \brief the metadata of the sparse weight */
+  Var meta_;
+  /*! \brief the transposed output, which is carved out of the workspace */
+  void* out_t_{nullptr};
+  /*! \brief the arguments of the sparse kernel */
+  SparseGemmArguments sparse_arguments_;
+};
+
 }  // namespace cutlass
 }  // namespace op
 }  // namespace raf
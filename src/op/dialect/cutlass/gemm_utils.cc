@@ -23,6 +23,9 @@ void CutlassGemmOpEnv::InitGemmOperation(
     int ldd, int batch_count, int64_t batch_stride_A, int64_t batch_stride_B,
     int64_t batch_stride_C, int64_t batch_stride_D, EpilogueKindExt epilogue_math_op,
     const std::string& preferred_name) {
+  problem_m_ = M;
+  problem_n_ = N;
+  problem_k_ = K;
   functional_key_ = std::make_unique<GemmFunctionalKeyExt>(
       provider_, GemmKind::kUniversal, element_compute, element_scalar, element_A, layout_A,
       ComplexTransform::kNone, element_B, layout_B, ComplexTransform::kNone, element_C,
@@ -95,6 +98,7 @@ std::vector<std::unique_ptr<TunableConfig>> CutlassGemmOpEnv::ListTunableConfigs
 
   // Tunable configuration: kernel_name
   std::vector<std::string> kernel_names;
+  std::vector<::cutlass::gemm::GemmCoord> tiles;
   auto operators_it = SingletonExt::get().operation_table.gemm_operations.find(*functional_key_);
   CHECK(operators_it != SingletonExt::get().operation_table.gemm_operations.end());
   auto cc_it = operators_it->second.upper_bound(*preference_key_);
@@ -109,14 +113,30 @@ std::vector<std::unique_ptr<TunableConfig>> CutlassGemmOpEnv::ListTunableConfigs
           (preference_key_->compute_capability <= max_cc) &&
           (op_alignment <= preference_key_->alignment)) {
         kernel_names.push_back(desc.name);
+        tiles.push_back(desc.tile_description.threadblock_shape);
       }
     }
   }
+  // Prune the tiles that are much larger than the problem.
+  std::vector<bool> keep = PruneTiles(tiles, problem_m_, problem_n_);
   std::vector<std::unique_ptr<TunableConfig>> rets;
-  for (const auto& name : kernel_names) {
+  for (size_t i = 0; i < kernel_names.size(); ++i) {
+    if (!keep[i]) {
+      continue;
+    }
+    const auto& tile = tiles[i];
+    int num_tiles =
+        ((problem_m_ + tile.m() - 1) / tile.m()) * ((problem_n_ + tile.n() - 1) / tile.n());
     for (const auto& i_split_k_slices : split_k_slices) {
+      // Splitting K only helps when the tiles cannot occupy all SMs, and each slice still has
+      // enough iterations along K.
+      if (i_split_k_slices > 1 &&
+          (num_tiles >= num_sms() || problem_k_ / i_split_k_slices < 2 * tile.k())) {
+        continue;
+      }
       for (const auto& i_split_k_mode : split_k_mode) {
-        rets.push_back(std::make_unique<GemmTunableConfig>(name, i_split_k_mode, i_split_k_slices));
+        rets.push_back(
+            std::make_unique<GemmTunableConfig>(kernel_names[i], i_split_k_mode, i_split_k_slices));
       }
     }
   }
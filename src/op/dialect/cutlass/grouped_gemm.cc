@@ -0,0 +1,229 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file ./src/op/dialect/cutlass/grouped_gemm.cc
+ * \brief Implementation of cutlass grouped gemm dispatch
+ */
+#include "./grouped_gemm.h"
+
+#include <sstream>
+#include "./cutlass_utils.h"
+#include "./gemm_utils.h"
+#include "../../../common/shape_utils.h"
+
+namespace raf {
+namespace op {
+namespace cutlass {
+
+using namespace raf::ir;
+using namespace raf::value;
+using common::shape_utils::BytesCompactTensor;
+
+/*! \brief The alignment in bytes of the per-group arguments in the workspace. */
+constexpr size_t kArgAlignment = 16;
+
+inline size_t AlignArg(size_t nbytes) {
+  return (nbytes + kArgAlignment - 1) / kArgAlignment * kArgAlignment;
+}
+
+bool CutlassGroupedMatmulOpEnv::Pattern(const CallValues& cv) {
+  static const Op& grouped_matmul = Op::Get("raf.op.cutlass.grouped_matmul");
+  static const Op& grouped_matmul_dw = Op::Get("raf.op.cutlass.grouped_matmul_dw");
+  Expr expr = Downcast<ClosureValue>(cv->callee)->func->body;
+  const auto* call = expr.as<CallNode>();
+  if (call == nullptr || (call->op != grouped_matmul && call->op != grouped_matmul_dw) ||
+      call->args.size() != 4U) {
+    LOG(INFO) << "Failed to match the pattern";
+    return false;
+  }
+  for (int i = 0; i < 3; ++i) {
+    if (!call->args[i]->IsInstance<VarNode>()) {
+      return false;
+    }
+  }
+  x_ = Downcast<Var>(call->args[0]);
+  w_ = Downcast<Var>(call->args[1]);
+  group_sizes_ = Downcast<Var>(call->args[2]);
+  dw_ = call->op == grouped_matmul_dw;
+  Value transpose_b;
+  if (const auto* constant = call->args[3].as<ConstantNode>()) {
+    transpose_b = Downcast<Value>(constant->value);
+  } else if (call->args[3]->IsInstance<VarNode>()) {
+    transpose_b = GetValue<Value>(cv, Downcast<Var>(call->args[3]));
+  }
+  if (!transpose_b.defined()) {
+    return false;
+  }
+  transpose_b_ = GetScalarValueData<bool>(transpose_b);
+  return true;
+}
+
+void CutlassGroupedMatmulOpEnv::Init(const CallValues& cv) {
+  DLTensor* x = GetValue<TensorValue>(cv, x_);
+  DLTensor* w = GetValue<TensorValue>(cv, w_);
+  DLTensor* out = cv->out;
+  CHECK(DType(x->dtype) == DType(w->dtype) && DType(x->dtype) == DType(out->dtype))
+      << "The inputs and the output must be in the same dtype";
+  num_groups_ = dw_ ? out->shape[0] : w->shape[0];
+  int64_t rows = x->shape[0];
+  int64_t k = x->shape[1];
+  int64_t n = dw_ ? w->shape[1] : out->shape[1];
+  // The GEMM is column-major, so each group computes the transpose of its row-major output. The
+  // group sizes only give the strided dims of the operands, which do not limit the alignment.
+  LayoutTypeID layout_a = LayoutTypeID::kColumnMajor;
+  LayoutTypeID layout_b = LayoutTypeID::kColumnMajor;
+  if (!dw_) {
+    // y_e^T = w_e^T * x_e^T, where w_e is [k, n], or [n, k] if transposed.
+    dims_[0] = n, dims_[1] = 0, dims_[2] = k;
+    var_dim_ = 1;
+    operands_[0] = {nullptr, k * n, 0, transpose_b_ ? k : n};
+    operands_[1] = {nullptr, 0, k, k};
+    operands_[2] = {nullptr, 0, n, n};
+    sources_[0] = 1, sources_[1] = 0;
+    layout_a = transpose_b_ ? LayoutTypeID::kRowMajor : LayoutTypeID::kColumnMajor;
+  } else if (!transpose_b_) {
+    // dw_e^T = dy_e^T * x_e, where dw_e is [k, n].
+    dims_[0] = n, dims_[1] = k, dims_[2] = 0;
+    var_dim_ = 2;
+    operands_[0] = {nullptr, 0, n, n};
+    operands_[1] = {nullptr, 0, k, k};
+    operands_[2] = {nullptr, k * n, 0, n};
+    sources_[0] = 1, sources_[1] = 0;
+    layout_b = LayoutTypeID::kRowMajor;
+  } else {
+    // dw_e^T = x_e^T * dy_e, where dw_e is [n, k].
+    dims_[0] = k, dims_[1] = n, dims_[2] = 0;
+    var_dim_ = 2;
+    operands_[0] = {nullptr, 0, k, k};
+    operands_[1] = {nullptr, 0, n, n};
+    operands_[2] = {nullptr, k * n, 0, k};
+    sources_[0] = 0, sources_[1] = 1;
+    layout_b = LayoutTypeID::kRowMajor;
+  }
+  // The tiles are pruned by the problem of the average group.
+  int dims[3] = {dims_[0], dims_[1], dims_[2]};
+  dims[var_dim_] = std::max<int64_t>(rows / std::max(num_groups_, 1), 1);
+  problem_m_ = dims[0];
+  problem_n_ = dims[1];
+  problem_k_ = dims[2];
+
+  DType accumulation_dtype = GetAccumulationDType(DType(out->dtype));
+  DType scalar_dtype = accumulation_dtype;
+  NumericTypeID element = GetNumericTypeID(x->dtype);
+  functional_key_ = std::make_unique<GemmFunctionalKeyExt>(
+      provider_, GemmKind::kGrouped, GetNumericTypeID(accumulation_dtype),
+      GetNumericTypeID(scalar_dtype), element, layout_a, ComplexTransform::kNone, element,
+      layout_b, ComplexTransform::kNone, GetNumericTypeID(out->dtype),
+      EpilogueKindExt::kLinearCombination);
+  auto operators_it = SingletonExt::get().operation_table.gemm_operations.find(*functional_key_);
+  CHECK(operators_it != SingletonExt::get().operation_table.gemm_operations.end())
+      << "Cannot find the required grouped GEMM op in CUTLASS with the functional key:\n"
+      << *functional_key_;
+  CHECK(!operators_it->second.empty());
+
+  const void* ptrs[2] = {x->data, w->data};
+  int const kMaximumAlignmentSize = 16;
+  int alignment = gemm_problem_alignment(
+      dims_[0], dims_[1], dims_[2], element, ptrs[sources_[0]], operands_[0].ld, 0, element,
+      ptrs[sources_[1]], operands_[1].ld, 0, GetNumericTypeID(out->dtype), out->data,
+      operands_[2].ld, 0, out->data, operands_[2].ld, 0, kMaximumAlignmentSize);
+  preference_key_ = std::make_unique<GemmPreferenceKey>(compute_capability(), alignment);
+  operation_ = find_gemm_operation(operators_it, *preference_key_, tunable_.kernel_name);
+  CHECK(operation_) << "No grouped GEMM op in CUTLASS supports the alignment " << alignment;
+
+  // The persistent threadblocks iterate over the tiles of all the groups.
+  GemmGroupedConfiguration configuration{num_groups_, num_sms()};
+  uint64_t host_workspace_size_needed = operation_->get_host_workspace_size(&configuration);
+  CHECK_GE(uint64_t(kHostWorkspaceSize), host_workspace_size_needed);
+
+  // The workspace of the kernel is followed by the per-group arguments.
+  workspace_size_ = operation_->get_device_workspace_size(&configuration);
+  size_t problem_offset = AlignArg(workspace_size_);
+  size_t ptrs_offset = problem_offset + AlignArg(3 * num_groups_ * sizeof(int));
+  size_t lds_offset = ptrs_offset + AlignArg(3 * num_groups_ * sizeof(void*));
+  size_t total = lds_offset + 3 * num_groups_ * sizeof(int64_t);
+  RequestWorkspace(&workspace_, device_, total);
+  char* base = static_cast<char*>(workspace_);
+  problem_sizes_ = reinterpret_cast<int*>(base + problem_offset);
+  ptrs_ = reinterpret_cast<void**>(base + ptrs_offset);
+  lds_ = reinterpret_cast<int64_t*>(base + lds_offset);
+  CUTLASS_CALL(operation_->initialize(&configuration, host_workspace_, workspace_, GetStream()));
+
+  // C is not read, since beta is zero.
+  void** d = ptrs_ + 2 * num_groups_;
+  int64_t* ldd = lds_ + 2 * num_groups_;
+  grouped_arguments_ = GemmGroupedArguments{
+      reinterpret_cast<gemm::GemmCoord*>(problem_sizes_),
+      ptrs_,
+      ptrs_ + num_groups_,
+      d,
+      d,
+      lds_,
+      lds_ + num_groups_,
+      ldd,
+      ldd,
+      const_addr<1>(cudaDataType_t(scalar_dtype)),
+      const_addr<0>(cudaDataType_t(scalar_dtype)),
+      scalar_pointer_mode_};
+  arg_indices = GetArgIndices(cv, std::vector<Var>({x_, w_, group_sizes_}));
+}
+
+std::vector<std::unique_ptr<TunableConfig>> CutlassGroupedMatmulOpEnv::ListTunableConfigs() {
+  // The grouped kernel does not split K, so only the kernels are tuned.
+  std::vector<std::unique_ptr<TunableConfig>> rets;
+  for (auto& config : CutlassGemmOpEnv::ListTunableConfigs()) {
+    if (static_cast<GemmTunableConfig*>(config.get())->split_k_slices == 1) {
+      rets.push_back(std::move(config));
+    }
+  }
+  return rets;
+}
+
+OpEnv* CutlassGroupedMatmulOpEnv::make(const CallValues& cv) {
+  std::unique_ptr<CutlassGroupedMatmulOpEnv> op_env(
+      std::make_unique<CutlassGroupedMatmulOpEnv>(cv));
+  if (!op_env->Pattern(cv)) {
+    dispatch_error_msgs.push_back("[CUTLASS] Cannot JIT: matched pattern? 0");
+    return nullptr;
+  }
+  try {
+    op_env->Init(cv);
+  } catch (const dmlc::Error& e) {
+    std::stringstream ss;
+    ss << "[CUTLASS] Failed to JIT: " << e.what();
+    dispatch_error_msgs.push_back(ss.str());
+    return nullptr;
+  }
+  return op_env.release();
+}
+
+void CutlassGroupedMatmulOpEnv::Execute(const std::vector<Value>& inputs, Value output) {
+  DLTensor* x = Downcast<TensorValue>(inputs[0]);
+  DLTensor* w = Downcast<TensorValue>(inputs[1]);
+  DLTensor* group_sizes = Downcast<TensorValue>(inputs[2]);
+  DLTensor* out = Downcast<TensorValue>(output);
+  cudaStream_t stream = GetStream();
+  const void* data[2] = {x->data, w->data};
+  operands_[0].base = data[sources_[0]];
+  operands_[1].base = data[sources_[1]];
+  operands_[2].base = out->data;
+  if (!dw_) {
+    // The rows after all the groups are not written by the kernel.
+    CUDA_CALL(cudaMemsetAsync(out->data, 0, BytesCompactTensor(*out), stream));
+  }
+  cuda::grouped_gemm_args_cuda(static_cast<const int64_t*>(group_sizes->data), num_groups_,
+                               dims_[0], dims_[1], dims_[2], var_dim_, (x->dtype.bits + 7) / 8,
+                               operands_[0], operands_[1], operands_[2], problem_sizes_, ptrs_,
+                               lds_, stream);
+  CUTLASS_CALL(operation_->run(&grouped_arguments_, host_workspace_, workspace_, stream));
+}
+
+RAF_REGISTER_DIALECT_OP(cutlass, grouped_matmul, 0);
+RAF_REGISTER_DIALECT_OP(cutlass, grouped_matmul_dw, 0);
+
+}  // namespace cutlass
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,79 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file ./src/op/dialect/cutlass/grouped_gemm.h
+ * \brief Implementation of cutlass grouped gemm dispatch
+ */
+#include "raf/value.h"
+#include "raf/registry.h"
+#include "raf/op.h"
+#include "raf/ir.h"
+#include "./gemm_utils.h"
+#include "../cuda/kernels/kernel_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cutlass {
+
+using namespace raf::ir;
+using namespace raf::value;
+
+/*! \brief OpEnv for grouped_matmul(x, w, group_sizes, transpose_b) and
+ * grouped_matmul_dw(x, dy, group_sizes, transpose_b), where the GEMMs of all the groups run in a
+ * single launch of the CUTLASS grouped kernel. The group sizes stay on the device, and the
+ * problem of each group is filled by a small kernel on the same stream before the launch.
+ */
+class CutlassGroupedMatmulOpEnv : public CutlassGemmOpEnv {
+ public:
+  explicit CutlassGroupedMatmulOpEnv(const CallValues& cv) : CutlassGemmOpEnv(cv) {
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cutlass.grouped_matmul"));
+  }
+
+  bool Pattern(const CallValues& cv);
+
+  void Init(const CallValues& cv) override;
+
+  void Execute(const std::vector<Value>& inputs, Value output);
+
+  std::vector<std::unique_ptr<TunableConfig>> ListTunableConfigs() override;
+
+  static OpEnv* make(const CallValues& cv);
+
+ private:
+  /*! \brief the rows of all the groups */
+  Var x_;
+  /*! \brief the weights of the groups, or the output gradient for grouped_matmul_dw */
+  Var w_;
+  /*! \brief the number of rows of each group */
+  Var group_sizes_;
+  /*! \brief whether the weight of each group is transposed */
+  bool transpose_b_;
+  /*! \brief whether to compute the gradient of the weights */
+  bool dw_;
+  /*! \brief the number of groups */
+  int num_groups_;
+  /*! \brief the problem of each group, whose dim var_dim_ is the size of the group */
+  int dims_[3];
+  /*! \brief the dim of the problem given by the group sizes */
+  int var_dim_;
+  /*! \brief the operands a, b, and d of the column-major GEMM */
+  cuda::GroupedGemmOperand operands_[3];
+  /*! \brief the inputs of operands a and b, i.e., 0 for x, and 1 for w or dy */
+  int sources_[2];
+  /*! \brief the per-group arguments on the device, which are carved out of the workspace */
+  int* problem_sizes_{nullptr};
+  void** ptrs_{nullptr};
+  int64_t* lds_{nullptr};
+  /*! \brief the arguments of the grouped kernel */
+  GemmGroupedArguments grouped_arguments_;
+};
+
+}  // namespace cutlass
+}  // namespace op
+}  // namespace raf
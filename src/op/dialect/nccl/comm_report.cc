@@ -0,0 +1,144 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/nccl/comm_report.cc
+ * \brief The cluster-wide straggler report of the communication profiler
+ */
+#include <algorithm>
+#include <array>
+#include <map>
+#include <sstream>
+#include "raf/dist_context.h"
+#include "raf/memory_pool.h"
+#include "raf/nccl_communicator.h"
+#include "raf/registry.h"
+#include "../../../common/cuda_utils.h"
+#include "../../../profiler/cuda/comm_profiler.h"
+
+namespace raf {
+namespace op {
+namespace communication {
+namespace nccl {
+
+using namespace distributed;
+using namespace distributed::communicator;
+using profiler::CommProfiler;
+using profiler::CommStat;
+
+/*! \brief Gather the values of all ranks to every rank, ordered by the ranks. */
+std::vector<double> AllGatherHost(const std::vector<double>& values, const Communicator& comm) {
+  ncclComm_t nccl_comm = Downcast<NCCLCommunicator>(comm)->nccl_comm;
+  size_t count = std::max<size_t>(values.size(), 1);
+  size_t nbytes = count * sizeof(double);
+  Device device(DevType::kCUDA(), DistContext::Global()->local_rank);
+  auto send_buf = memory_pool::Memory::Alloc(device, nbytes);
+  auto recv_buf = memory_pool::Memory::Alloc(device, nbytes * comm->size);
+  CUDA_CALL(cudaMemset(send_buf->data, 0, nbytes));
+  if (!values.empty()) {
+    CUDA_CALL(cudaMemcpy(send_buf->data, values.data(), nbytes, cudaMemcpyHostToDevice));
+  }
+  NCCL_CALL(ncclAllGather(send_buf->data, recv_buf->data, count, ncclFloat64, nccl_comm, nullptr));
+  CUDA_CALL(cudaStreamSynchronize(nullptr));
+  std::vector<double> ret(count * comm->size);
+  CUDA_CALL(cudaMemcpy(ret.data(), recv_buf->data, nbytes * comm->size, cudaMemcpyDeviceToHost));
+  return ret;
+}
+
+/*!
+ * \brief Gather the per-iteration communication profile of all ranks and find the stragglers.
+ * Ranks that arrive at a collective early spend the time waiting inside it for the late ones, so
+ * the rank with the shortest communication time in an iteration is the straggler that the others
+ * wait for, and the shortest time is the actual transfer time. When the skew between the ranks
+ * dominates the transfer time, a slow rank holds back the cluster; otherwise the transfer itself
+ * (i.e., the links) is the bottleneck. The wait time on CudaWaitEvent tells how long each rank
+ * waited for its own computation before launching the collectives.
+ * This is a collective call, so it must be called by all ranks.
+ */
+std::string GetCommStragglerReport() {
+  // The local summary of each iteration: the time, the wait time and the bus bytes.
+  constexpr size_t kNumFields = 3;
+  std::map<int64_t, std::array<double, kNumFields>> local;
+  for (const CommStat& stat : CommProfiler::Get()->GetStats()) {
+    auto& summary = local[stat.iteration];
+    summary[0] += stat.time_us;
+    summary[1] += stat.wait_us;
+    summary[2] += stat.bytes * CommProfiler::BusBandwidthFactor(stat.kind, stat.nranks);
+  }
+
+  Communicator comm = Communicator::Get("nccl");
+  int size = comm->size;
+  // Every rank runs the same iterations, so they are aligned from the latest one in case some
+  // ranks have profiled more iterations than the others.
+  auto counts = AllGatherHost({static_cast<double>(local.size())}, comm);
+  size_t num_iters = static_cast<size_t>(*std::min_element(counts.begin(), counts.end()));
+  std::vector<double> values;
+  std::vector<int64_t> iter_ids;
+  size_t skip = local.size() - num_iters;
+  for (const auto& it : local) {
+    if (skip > 0) {
+      skip--;
+      continue;
+    }
+    iter_ids.push_back(it.first);
+    values.insert(values.end(), it.second.begin(), it.second.end());
+  }
+  auto gathered = AllGatherHost(values, comm);
+  size_t stride = gathered.size() / size;
+  auto field = [&](int rank, size_t iter, size_t index) {
+    return gathered[rank * stride + iter * kNumFields + index];
+  };
+
+  std::vector<int64_t> straggler_counts(size, 0);
+  double total_skew = 0.0, total_transfer = 0.0;
+  std::stringstream iters;
+  for (size_t i = 0; i < num_iters; ++i) {
+    int straggler = 0;
+    double max_time = 0.0;
+    for (int r = 0; r < size; ++r) {
+      if (field(r, i, 0) < field(straggler, i, 0)) {
+        straggler = r;
+      }
+      max_time = std::max(max_time, field(r, i, 0));
+    }
+    double transfer = field(straggler, i, 0);
+    double skew = max_time - transfer;
+    straggler_counts[straggler]++;
+    total_skew += skew;
+    total_transfer += transfer;
+    iters << (i > 0 ? ", " : "") << "{\"iteration\": " << iter_ids[i] << ", \"time_us\": [";
+    for (int r = 0; r < size; ++r) {
+      iters << (r > 0 ? ", " : "") << field(r, i, 0);
+    }
+    iters << "], \"wait_us\": [";
+    for (int r = 0; r < size; ++r) {
+      iters << (r > 0 ? ", " : "") << field(r, i, 1);
+    }
+    iters << "], \"straggler\": " << straggler << ", \"skew_us\": " << skew
+          << ", \"transfer_us\": " << transfer << ", \"busbw_gbps\": "
+          << (transfer > 0 ? field(straggler, i, 2) * 1e-3 / transfer : 0.0) << "}";
+  }
+
+  auto max_count = std::max_element(straggler_counts.begin(), straggler_counts.end());
+  int suspect = static_cast<int>(max_count - straggler_counts.begin());
+  std::stringstream ss;
+  ss << "{\"num_ranks\": " << size << ", \"iterations\": [" << iters.str() << "], ";
+  ss << "\"straggler_counts\": [";
+  for (int r = 0; r < size; ++r) {
+    ss << (r > 0 ? ", " : "") << straggler_counts[r];
+  }
+  ss << "], \"skew_us\": " << (num_iters > 0 ? total_skew / num_iters : 0.0)
+     << ", \"transfer_us\": " << (num_iters > 0 ? total_transfer / num_iters : 0.0)
+     << ", \"diagnosis\": \"" << (total_skew > total_transfer ? "slow_rank" : "slow_link")
+     << "\", \"suspect_rank\": " << (num_iters > 0 ? suspect : -1) << "}";
+  return ss.str();
+}
+
+RAF_REGISTER_GLOBAL("raf.profiler.GetCommStragglerReport").set_body_typed(GetCommStragglerReport);
+
+}  // namespace nccl
+}  // namespace communication
+}  // namespace op
+}  // namespace raf
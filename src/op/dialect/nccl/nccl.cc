@@ -7,14 +7,18 @@
  * \file src/op/dialect/cuda/nccl.cc
  * \brief Communication operators implmentated by NCCL
  */
+#include <algorithm>
 #include <vector>
 #include <chrono>
 #include <thread>
 #include "raf/op_utils.h"
 #include "raf/dist_context.h"
 #include "raf/nccl_communicator.h"
+#include "raf/memory_pool.h"
 #include "../../schema/communication.h"
 #include "./communication_utils.h"
+#include "../cuda/kernels/kernel_util.cuh"
+#include "../../../profiler/cuda/comm_profiler.h"
 
 namespace raf {
 namespace op {
@@ -24,17 +28,61 @@ using namespace distributed;
 using namespace distributed::communicator;
 using common::shape_utils::BytesCompactTensor;
 using stream_pool::StreamTagEnum;
+using profiler::CommKind;
+using profiler::CommProfileScope;
 
 RAF_REGISTER_DIALECT("nccl").set_enable(DevType::kCUDA());
 
+/*! \brief The device of this rank, on which the collectives are profiled. */
+inline Device CommDevice() {
+  return Device(DevType::kCUDA(), DistContext::Global()->local_rank);
+}
+
+/*! \brief Get the tensors of a tuple to be packed or unpacked. */
+inline std::vector<DLTensor*> GetDLTensors(const ir::Array<value::Value>& fields) {
+  std::vector<DLTensor*> tensors;
+  for (value::Value field : fields) {
+    DLTensor* x = field;
+    tensors.push_back(x);
+  }
+  return tensors;
+}
+
 class NCCLAllReduce : public raf::op::OpEnv {
   void* stream;
   Communicator communicator;
+  Communicator hier_communicator;
   void* fused_data;
   size_t total_size = 0;
   std::vector<size_t> tuple_sizes;
   DType dtype;
   ncclRedOp_t compute;
+  /*! \brief The compression mode of the gradients, see DistContext::allreduce_compression. */
+  std::string compression = "none";
+  int64_t num_elements = 0;
+  /*! \brief The buffer of the casted gradients. */
+  void* compressed_data;
+  /*! \brief The number of elements selected on each rank with top-k compression. */
+  int topk = 0;
+  /*! \brief The error feedback of top-k compression, which persists across the iterations. */
+  std::shared_ptr<memory_pool::Memory> error_feedback;
+  void* topk_magnitude;
+  void* topk_counter;
+  void* topk_indices;
+  void* topk_values;
+  void* topk_gathered_indices;
+  void* topk_gathered_values;
+  /*! \brief The indices of the tuple fields grouped by dtype, in the order of appearance. */
+  std::vector<std::vector<int>> dtype_groups;
+  /*! \brief The dtype of each group. */
+  std::vector<DType> group_dtypes;
+  /*! \brief Whether float16 and bfloat16 tensors are reduced with float32 accumulation. */
+  bool fp32_accumulate = false;
+  /*! \brief The buffer of the dtype groups, each of which is aligned to kGroupAlignment bytes. */
+  void* group_data;
+
+  /*! \brief The alignment of each dtype group in the buffer. */
+  static constexpr size_t kGroupAlignment = 256;
 
   explicit NCCLAllReduce(const CallValues& cv) {
     auto op = ir::Op::Get("raf.op._allreduce");
@@ -71,10 +119,124 @@ class NCCLAllReduce : public raf::op::OpEnv {
       tuple_sizes.push_back(size);
       total_size += size;
       dtype = x->dtype;
+      auto it = std::find(group_dtypes.begin(), group_dtypes.end(), DType(x->dtype));
+      if (it == group_dtypes.end()) {
+        group_dtypes.push_back(x->dtype);
+        dtype_groups.push_back({i});
+      } else {
+        dtype_groups[it - group_dtypes.begin()].push_back(i);
+      }
+    }
+    // The hierarchical allreduce is either enforced, or chosen by the message size.
+    auto dctx = DistContext::Global();
+    if (!args->rank_list.defined() &&
+        (dctx->enable_hierarchical_allreduce ||
+         (dctx->auto_select_allreduce && PreferHierarchicalAllReduce(total_size))) &&
+        HierarchicalCommunicator::IsApplicable(communicator)) {
+      hier_communicator = Communicator::Get("hierarchical");
     }
-    if (tv.size() > 1) {
+    if (tv.size() > 1 && dtype_groups.size() == 1) {
       RequestWorkspace(&fused_data, cv->device, total_size);
     }
+    InitCompression(cv, args->computation);
+    InitAccumulate(cv, args->computation);
+    if (fp32_accumulate || dtype_groups.size() > 1) {
+      RequestWorkspace(&group_data, cv->device, GroupBufferSize());
+    }
+  }
+
+  /*!
+   * \brief Enable the gradient compression if it is requested by DistContext. Only the sum and
+   * average of float32 tensors are compressed.
+   */
+  void InitCompression(const CallValues& cv, const std::string& computation) {
+    auto dctx = DistContext::Global();
+    bool is_float32 = dtype.code == kDLFloat && dtype.bits == 32 && dtype.lanes == 1;
+    if (dctx->allreduce_compression == "none" || !is_float32 || dtype_groups.size() > 1 ||
+        (computation != "sum" && computation != "avg")) {
+      return;
+    }
+    compression = dctx->allreduce_compression;
+    num_elements = total_size / sizeof(float);
+    if (compression == "fp16" || compression == "bf16") {
+#if NCCL_VERSION_CODE < 21000
+      CHECK(compression == "fp16") << "AllReduce with bf16 is not supported in NCCL < 2.10";
+#endif
+      RequestWorkspace(&compressed_data, cv->device, num_elements * 2);
+    } else {
+      CHECK_EQ(compression, "topk") << "Unknown allreduce compression " << compression;
+      int size = communicator->size;
+      topk = std::max<int64_t>(1, static_cast<int64_t>(num_elements * dctx->allreduce_topk_ratio));
+      topk = std::min<int64_t>(topk, num_elements);
+      error_feedback = memory_pool::Memory::Alloc(cv->device, total_size);
+      // The OpEnv may be created while a CUDA graph is captured, where the legacy default stream
+      // cannot be used, so the error feedback is cleared on a side stream.
+      auto init_stream =
+          stream_pool::Stream::Get(cv->device, StreamTagEnum::MemCpyCpuToCuda(), 0)->data();
+      CUDA_CALL(cudaMemsetAsync(error_feedback->data, 0, total_size, (cudaStream_t)init_stream));
+      CUDA_CALL(cudaStreamSynchronize((cudaStream_t)init_stream));
+      RequestWorkspace(&topk_magnitude, cv->device, total_size);
+      RequestWorkspace(&topk_counter, cv->device, sizeof(int));
+      RequestWorkspace(&topk_indices, cv->device, topk * sizeof(int));
+      RequestWorkspace(&topk_values, cv->device, topk * sizeof(float));
+      RequestWorkspace(&topk_gathered_indices, cv->device, topk * size * sizeof(int));
+      RequestWorkspace(&topk_gathered_values, cv->device, topk * size * sizeof(float));
+    }
+  }
+
+  /*!
+   * \brief Enable the float32 accumulation of the float16 and bfloat16 tensors if it is requested
+   * by DistContext. Only the sum and average are accumulated, and the compression takes precedence.
+   */
+  void InitAccumulate(const CallValues& cv, const std::string& computation) {
+    auto dctx = DistContext::Global();
+    if (!dctx->allreduce_fp32_accumulate || compression != "none" || communicator->size == 1 ||
+        (computation != "sum" && computation != "avg")) {
+      return;
+    }
+    for (const DType& group_dtype : group_dtypes) {
+      fp32_accumulate |= IsHalf(group_dtype);
+    }
+    if (fp32_accumulate) {
+      // The accumulation follows the reduce-scatter on the flat communicator.
+      hier_communicator = Communicator();
+    }
+  }
+
+  /*! \brief Whether the dtype is float16 or bfloat16. */
+  static bool IsHalf(const DLDataType& dtype) {
+    return (dtype.code == kDLFloat || dtype.code == kDLBfloat) && dtype.bits == 16 &&
+           dtype.lanes == 1;
+  }
+
+  /*! \brief The number of elements of each rank to be accumulated in a dtype group. */
+  size_t AccumulateChunk(size_t count) const {
+    return (count + communicator->size - 1) / communicator->size;
+  }
+
+  /*!
+   * \brief The bytes of a dtype group in the buffer. An accumulated group takes the padded input
+   * and the received chunks of all ranks.
+   */
+  size_t GroupBytes(int group_index) const {
+    const DType& group_dtype = group_dtypes[group_index];
+    size_t bytes = 0;
+    for (int i : dtype_groups[group_index]) {
+      bytes += tuple_sizes[i];
+    }
+    if (fp32_accumulate && IsHalf(group_dtype)) {
+      size_t elem_size = GetSizeInBytes(group_dtype);
+      bytes = 2 * AccumulateChunk(bytes / elem_size) * communicator->size * elem_size;
+    }
+    return (bytes + kGroupAlignment - 1) / kGroupAlignment * kGroupAlignment;
+  }
+
+  size_t GroupBufferSize() const {
+    size_t bytes = 0;
+    for (int i = 0; i < dtype_groups.size(); ++i) {
+      bytes += GroupBytes(i);
+    }
+    return bytes;
   }
 
  public:
@@ -91,6 +253,17 @@ class NCCLAllReduce : public raf::op::OpEnv {
     Execute({TupleValue::make(ir::Array<Value>(args->x.begin(), args->x.end()))}, cv->out);
   }
 
+  bool IsGroupable(const std::vector<value::Value>& inputs,
+                   const value::Value& output) const override {
+    // The hierarchical allreduce depends on its own steps, and the unpacking follows the call.
+    if (compression != "none" || fp32_accumulate || dtype_groups.size() > 1 ||
+        hier_communicator.defined()) {
+      return false;
+    }
+    auto tv = Downcast<value::TupleValue>(inputs[0]);
+    return tv->fields.size() == 1 || IsContiguous(Downcast<value::TupleValue>(output)->fields);
+  }
+
   void Execute(const std::vector<value::Value>& inputs, value::Value output) override {
     // We can use sleep to test communication scheduling locally.
     // using namespace std::this_thread;
@@ -101,43 +274,235 @@ class NCCLAllReduce : public raf::op::OpEnv {
     // Fuse Tensor
     auto tv = Downcast<value::TupleValue>(inputs[0]);
     size_t dtype_size = 0;
-    if (tv->fields.size() == 1) {
+    if (compression != "none" || fp32_accumulate || dtype_groups.size() > 1) {
+      std::vector<DLTensor*> outs;
+      if (tv->fields.size() == 1) {
+        DLTensor* out = output;
+        outs.push_back(out);
+      } else {
+        outs = GetDLTensors(Downcast<value::TupleValue>(output)->fields);
+      }
+      if (compression != "none") {
+        ExecuteCompressed(GetDLTensors(tv->fields), outs, nccl_comm);
+      } else {
+        ExecuteGroups(GetDLTensors(tv->fields), outs, nccl_comm);
+      }
+    } else if (tv->fields.size() == 1) {
       DLTensor* x = tv->fields[0];
       DLTensor* out = output;
       dtype_size = GetSizeInBytes(x->dtype);
-      NCCL_CALL(ncclAllReduce(x->data, out->data, total_size / dtype_size, dtype, compute,
-                              nccl_comm, (cudaStream_t)stream));
+      AllReduce(x->data, out->data, total_size / dtype_size, dtype_size, nccl_comm);
 
     } else {
-      size_t offset = 0;
-      for (int i = 0; i < tv->fields.size(); ++i) {
-        DLTensor* x = tv->fields[i];
-        void* buffer_data_at_offset = reinterpret_cast<uint8_t*>(fused_data) + offset;
-        cudaMemcpyAsync(buffer_data_at_offset, x->data, tuple_sizes[i], cudaMemcpyDeviceToDevice,
-                        (cudaStream_t)stream);
-        offset += tuple_sizes[i];
-        CHECK(dtype_size == 0 || dtype_size == GetSizeInBytes(x->dtype))
-            << "AllReduce requires tensors to be the same type.";
-        dtype_size = GetSizeInBytes(x->dtype);
-        dtype = x->dtype;
+      value::TupleValue out = tvm::runtime::Downcast<value::TupleValue>(output);
+      auto& of = out->fields;
+      DLTensor* x0 = tv->fields[0];
+      dtype_size = GetSizeInBytes(x0->dtype);
+      dtype = x0->dtype;
+      // The tensors laid out back-to-back (e.g., by BucketAllReduceLayout) are reduced in place
+      // of the fused buffer, so the corresponding memory copies are skipped.
+      DLTensor* out0 = of[0];
+      void* send_data = IsContiguous(tv->fields) ? x0->data : nullptr;
+      void* recv_data = IsContiguous(of) ? out0->data : nullptr;
+      if (send_data == nullptr) {
+        cuda::multi_tensor_pack_cuda(GetDLTensors(tv->fields), fused_data, stream);
       }
 
       // Allreduce
-      NCCL_CALL(ncclAllReduce(fused_data, fused_data, total_size / dtype_size, dtype, compute,
-                              nccl_comm, (cudaStream_t)stream));
+      send_data = send_data ? send_data : fused_data;
+      void* reduced_data = recv_data ? recv_data : fused_data;
+      AllReduce(send_data, reduced_data, total_size / dtype_size, dtype_size, nccl_comm);
       // UnFuse Tensor
-      value::TupleValue out = tvm::runtime::Downcast<value::TupleValue>(output);
-      auto& of = out->fields;
-      for (int i = of.size() - 1; i >= 0; --i) {
-        DLTensor* x = of[i];
-        offset -= tuple_sizes[i];
-        void* buffer_data_at_offset = reinterpret_cast<uint8_t*>(fused_data) + offset;
-        cudaMemcpyAsync(x->data, buffer_data_at_offset, tuple_sizes[i], cudaMemcpyDeviceToDevice,
-                        (cudaStream_t)stream);
+      if (recv_data == nullptr) {
+        cuda::multi_tensor_unpack_cuda(fused_data, GetDLTensors(of), stream);
+      }
+    }
+  }
+
+ private:
+  /*! \brief Get the pointers of the tensors and the compressed buffer to be casted between. */
+  void GetCastLists(const std::vector<DLTensor*>& tensors, bool compress,
+                    std::vector<void*>* tensor_lists, std::vector<int>* numels) {
+    std::vector<void*> compressed;
+    uint8_t* data = reinterpret_cast<uint8_t*>(compressed_data);
+    for (DLTensor* x : tensors) {
+      numels->push_back(BytesCompactTensor(*x) / sizeof(float));
+      compressed.push_back(data);
+      data += numels->back() * 2;
+    }
+    for (int i = 0; i < 2; ++i) {
+      if ((i == 0) == compress) {
+        for (DLTensor* x : tensors) {
+          tensor_lists->push_back(x->data);
+        }
+      } else {
+        tensor_lists->insert(tensor_lists->end(), compressed.begin(), compressed.end());
+      }
+    }
+  }
+
+  /*!
+   * \brief Allreduce the float32 tensors with compression. With fp16 or bf16, the tensors are
+   * casted during packing, reduced in the low precision, and casted back during unpacking. With
+   * top-k, each rank sends the k largest elements of its gradients plus the error feedback of the
+   * previous iterations, and keeps the rest as the new error feedback.
+   */
+  void ExecuteCompressed(const std::vector<DLTensor*>& tensors, const std::vector<DLTensor*>& outs,
+                         ncclComm_t nccl_comm) {
+    CommProfileScope scope(CommDevice(), stream, "raf.op.nccl._allreduce", CommKind::kAllReduce,
+                           total_size, communicator->size);
+    if (compression != "topk") {
+      DLDataType float32 = tensors[0]->dtype;
+      DLDataType half = float32;
+      half.code = compression == "fp16" ? kDLFloat : kDLBfloat;
+      half.bits = 16;
+      std::vector<void*> tensor_lists;
+      std::vector<int> numels;
+      GetCastLists(tensors, true, &tensor_lists, &numels);
+      cuda::multi_tensor_copy_cuda(tensor_lists, numels, float32, half, 1.0f, stream);
+      NCCL_CALL(ncclAllReduce(compressed_data, compressed_data, num_elements, DType(half), compute,
+                              nccl_comm, (cudaStream_t)stream));
+      tensor_lists.clear();
+      numels.clear();
+      GetCastLists(outs, false, &tensor_lists, &numels);
+      cuda::multi_tensor_copy_cuda(tensor_lists, numels, half, float32, 1.0f, stream);
+      return;
+    }
+    int size = communicator->size;
+    float* grad = static_cast<float*>(tensors[0]->data);
+    if (tensors.size() > 1) {
+      cuda::multi_tensor_pack_cuda(tensors, fused_data, stream);
+      grad = static_cast<float*>(fused_data);
+    }
+    cuda::topk_compress_cuda(grad, static_cast<float*>(error_feedback->data), num_elements, topk,
+                             static_cast<float*>(topk_magnitude), static_cast<int*>(topk_counter),
+                             static_cast<int*>(topk_indices), static_cast<float*>(topk_values),
+                             stream);
+    NCCL_CALL(ncclAllGather(topk_indices, topk_gathered_indices, topk, ncclInt32, nccl_comm,
+                            (cudaStream_t)stream));
+    NCCL_CALL(ncclAllGather(topk_values, topk_gathered_values, topk, ncclFloat32, nccl_comm,
+                            (cudaStream_t)stream));
+    bool average = compute != ncclSum;
+    float* dense = static_cast<float*>(outs.size() == 1 ? outs[0]->data : fused_data);
+    cuda::topk_decompress_cuda(static_cast<int*>(topk_gathered_indices),
+                               static_cast<float*>(topk_gathered_values),
+                               static_cast<int64_t>(topk) * size, average ? 1.0f / size : 1.0f,
+                               dense, num_elements, stream);
+    if (outs.size() > 1) {
+      cuda::multi_tensor_unpack_cuda(fused_data, outs, stream);
+    }
+  }
+
+  /*!
+   * \brief Allreduce the tensors of each dtype group separately. With float32 accumulation, the
+   * float16 and bfloat16 groups are decomposed into a reduce-scatter in 16 bits, i.e., an
+   * all-to-all of the chunks, a local accumulation of the received chunks in float32, and an
+   * allgather of the reduced chunks in 16 bits. It communicates as many bytes as the ring
+   * allreduce in 16 bits, while the partial sums are never rounded to 16 bits.
+   */
+  void ExecuteGroups(const std::vector<DLTensor*>& tensors, const std::vector<DLTensor*>& outs,
+                     ncclComm_t nccl_comm) {
+    uint8_t* buffer = static_cast<uint8_t*>(group_data);
+    for (int g = 0; g < dtype_groups.size(); ++g) {
+      std::vector<DLTensor*> xs, ys;
+      size_t bytes = 0;
+      for (int i : dtype_groups[g]) {
+        xs.push_back(tensors[i]);
+        ys.push_back(outs[i]);
+        bytes += tuple_sizes[i];
+      }
+      dtype = group_dtypes[g];
+      size_t dtype_size = GetSizeInBytes(dtype);
+      cuda::multi_tensor_pack_cuda(xs, buffer, stream);
+      if (fp32_accumulate && IsHalf(dtype)) {
+        size_t chunk = AccumulateChunk(bytes / dtype_size);
+        uint8_t* gathered = buffer + chunk * communicator->size * dtype_size;
+        AccumulatedAllReduce(buffer, gathered, chunk, dtype_size, nccl_comm);
+        cuda::multi_tensor_unpack_cuda(gathered, ys, stream);
+      } else {
+        AllReduce(buffer, buffer, bytes / dtype_size, dtype_size, nccl_comm);
+        cuda::multi_tensor_unpack_cuda(buffer, ys, stream);
+      }
+      buffer += GroupBytes(g);
+    }
+  }
+
+  /*!
+   * \brief Allreduce the padded 16-bit data of chunk elements per rank with float32 accumulation.
+   * The data is overwritten, and the reduced data is gathered to recv_data.
+   */
+  void AccumulatedAllReduce(uint8_t* data, uint8_t* recv_data, size_t chunk, size_t dtype_size,
+                            ncclComm_t nccl_comm) {
+    int size = communicator->size;
+    int rank = communicator->rank;
+    size_t chunk_bytes = chunk * dtype_size;
+    CommProfileScope scope(CommDevice(), stream, "raf.op.nccl._allreduce", CommKind::kAllReduce,
+                           chunk_bytes * size, size);
+    // Each rank receives the chunk of its own from all ranks, which is a reduce-scatter without
+    // the reduction.
+    NCCL_CALL(ncclGroupStart());
+    for (int r = 0; r < size; ++r) {
+      NCCL_CALL(ncclSend(data + r * chunk_bytes, chunk, dtype, r, nccl_comm, (cudaStream_t)stream));
+      NCCL_CALL(ncclRecv(recv_data + r * chunk_bytes, chunk, dtype, r, nccl_comm,
+                         (cudaStream_t)stream));
+    }
+    NCCL_CALL(ncclGroupEnd());
+    uint8_t* reduced = data + rank * chunk_bytes;
+    float scale = compute == ncclSum ? 1.0f : 1.0f / size;
+    cuda::chunk_accumulate_cuda(recv_data, size, chunk, dtype, scale, reduced, stream);
+    NCCL_CALL(ncclAllGather(reduced, recv_data, chunk, dtype, nccl_comm, (cudaStream_t)stream));
+  }
+
+  /*!
+   * \brief Allreduce the data with the flat communicator, or with the hierarchical communicator
+   * if enabled. The elements that cannot be evenly scattered within the node are reduced with the
+   * flat communicator.
+   */
+  void AllReduce(const void* send_data, void* recv_data, size_t count, size_t dtype_size,
+                 ncclComm_t nccl_comm) {
+    CommProfileScope scope(CommDevice(), stream, "raf.op.nccl._allreduce", CommKind::kAllReduce,
+                           count * dtype_size, communicator->size);
+    if (!hier_communicator.defined()) {
+      NCCL_CALL(ncclAllReduce(send_data, recv_data, count, dtype, compute, nccl_comm,
+                              (cudaStream_t)stream));
+      return;
+    }
+    auto hier = Downcast<HierarchicalCommunicator>(hier_communicator);
+    size_t chunk = count / hier->local_size;
+    size_t offset = chunk * hier->local_size * dtype_size;
+    if (chunk > 0) {
+      void* chunk_data =
+          reinterpret_cast<uint8_t*>(recv_data) + hier->local_rank * chunk * dtype_size;
+      NCCL_CALL(ncclReduceScatter(send_data, chunk_data, chunk, dtype, compute,
+                                  hier->local_comm->nccl_comm, (cudaStream_t)stream));
+      NCCL_CALL(ncclAllReduce(chunk_data, chunk_data, chunk, dtype, compute,
+                              hier->cross_comm->nccl_comm, (cudaStream_t)stream));
+      NCCL_CALL(ncclAllGather(chunk_data, recv_data, chunk, dtype, hier->local_comm->nccl_comm,
+                              (cudaStream_t)stream));
+    }
+    if (count > chunk * hier->local_size) {
+      NCCL_CALL(ncclAllReduce(reinterpret_cast<const uint8_t*>(send_data) + offset,
+                              reinterpret_cast<uint8_t*>(recv_data) + offset,
+                              count - chunk * hier->local_size, dtype, compute, nccl_comm,
+                              (cudaStream_t)stream));
+    }
+  }
+
+  /*! \brief Whether the tensors are laid out back-to-back in the same order as the tuple. */
+  bool IsContiguous(const ir::Array<value::Value>& fields) const {
+    const uint8_t* expected = nullptr;
+    for (int i = 0; i < fields.size(); ++i) {
+      DLTensor* x = fields[i];
+      const uint8_t* data = reinterpret_cast<const uint8_t*>(x->data);
+      if (expected != nullptr && data != expected) {
+        return false;
       }
+      expected = data + tuple_sizes[i];
     }
+    return true;
   }
 
+ public:
   static OpEnv* make(const CallValues& cv) {
     return new NCCLAllReduce(cv);
   }
@@ -172,6 +537,11 @@ class NCCLAllGather : public raf::op::OpEnv {
     Execute({args->x}, cv->out);
   }
 
+  bool IsGroupable(const std::vector<value::Value>& inputs,
+                   const value::Value& output) const override {
+    return true;
+  }
+
   void Execute(const std::vector<value::Value>& inputs, value::Value output) {
     ncclComm_t nccl_comm = Downcast<NCCLCommunicator>(communicator)->nccl_comm;
     DLTensor* x = inputs[0];
@@ -180,6 +550,8 @@ class NCCLAllGather : public raf::op::OpEnv {
     for (int i = 0; i < x->ndim; ++i) {
       size *= x->shape[i];
     }
+    CommProfileScope scope(CommDevice(), stream, "raf.op.nccl._allgather", CommKind::kAllGather,
+                           BytesCompactTensor(*out), communicator->size);
     NCCL_CALL(
         ncclAllGather(x->data, out->data, size, DType(x->dtype), nccl_comm, (cudaStream_t)stream));
   }
@@ -244,6 +616,12 @@ class NCCLReduceScatter : public raf::op::OpEnv {
     Execute({TupleValue::make(ir::Array<Value>(args->x.begin(), args->x.end()))}, cv->out);
   }
 
+  bool IsGroupable(const std::vector<value::Value>& inputs,
+                   const value::Value& output) const override {
+    // The packing is launched before the call.
+    return true;
+  }
+
   void Execute(const std::vector<value::Value>& inputs, value::Value output) {
     auto comm_ptr = reinterpret_cast<NCCLCommunicatorObj*>(communicator);
     ncclComm_t nccl_comm = comm_ptr->nccl_comm;
@@ -255,16 +633,22 @@ class NCCLReduceScatter : public raf::op::OpEnv {
     if (tv->fields.size() == 1) {
       DLTensor* x = tv->fields[0];
       dtype = x->dtype;
+      CommProfileScope scope(CommDevice(), stream, "raf.op.nccl._reduce_scatter",
+                             CommKind::kReduceScatter, size_in_bytes * comm_ptr->size,
+                             comm_ptr->size);
       NCCL_CALL(ncclReduceScatter(x->data, out->data, size, dtype, compute, nccl_comm,
                                   (cudaStream_t)stream));
     } else {
-      for (int i = 0; i < tv->fields.size(); ++i) {
-        DLTensor* x = tv->fields[i];
-        void* buffer_data_at_offset = reinterpret_cast<uint8_t*>(in_buffer) + size_in_bytes * i;
-        cudaMemcpyAsync(buffer_data_at_offset, x->data, size_in_bytes, cudaMemcpyDeviceToDevice,
-                        (cudaStream_t)stream);
+      auto tensors = GetDLTensors(tv->fields);
+      for (DLTensor* x : tensors) {
+        CHECK_EQ(BytesCompactTensor(*x), size_in_bytes)
+            << "ReduceScatter requires tensors to be the same size.";
         dtype = x->dtype;
       }
+      cuda::multi_tensor_pack_cuda(tensors, in_buffer, stream);
+      CommProfileScope scope(CommDevice(), stream, "raf.op.nccl._reduce_scatter",
+                             CommKind::kReduceScatter, size_in_bytes * comm_ptr->size,
+                             comm_ptr->size);
       NCCL_CALL(ncclReduceScatter(in_buffer, out->data, size, dtype, compute, nccl_comm,
                                   (cudaStream_t)stream));
     }
@@ -330,36 +714,31 @@ class NCCLBroadcast : public raf::op::OpEnv {
       DLTensor* x = tv->fields[0];
       DLTensor* out = output;
       dtype_size = GetSizeInBytes(x->dtype);
+      CommProfileScope scope(CommDevice(), stream, "raf.op.nccl._broadcast", CommKind::kBroadcast,
+                             total_size, comm_ptr->size);
       NCCL_CALL(ncclBroadcast(x->data, out->data, total_size / dtype_size, dtype, root, nccl_comm,
                               (cudaStream_t)stream));
       return;
     }
 
-    size_t offset = 0;
     for (int i = 0; i < tv->fields.size(); ++i) {
       DLTensor* x = tv->fields[i];
-      void* buffer_data_at_offset = reinterpret_cast<uint8_t*>(fused_data) + offset;
-      cudaMemcpyAsync(buffer_data_at_offset, x->data, tuple_sizes[i], cudaMemcpyDeviceToDevice,
-                      (cudaStream_t)stream);
-      offset += tuple_sizes[i];
       CHECK(dtype_size == 0 || dtype_size == GetSizeInBytes(x->dtype))
           << "Broadcast requires tensors to be the same type.";
       dtype_size = GetSizeInBytes(x->dtype);
     }
+    cuda::multi_tensor_pack_cuda(GetDLTensors(tv->fields), fused_data, stream);
 
-    NCCL_CALL(ncclBroadcast(fused_data, fused_data, total_size / dtype_size, dtype, root, nccl_comm,
-                            (cudaStream_t)stream));
+    {
+      CommProfileScope scope(CommDevice(), stream, "raf.op.nccl._broadcast", CommKind::kBroadcast,
+                             total_size, comm_ptr->size);
+      NCCL_CALL(ncclBroadcast(fused_data, fused_data, total_size / dtype_size, dtype, root,
+                              nccl_comm, (cudaStream_t)stream));
+    }
 
     // UnFuse Tensor
     value::TupleValue out = tvm::runtime::Downcast<value::TupleValue>(output);
-    auto& of = out->fields;
-    for (int i = of.size() - 1; i >= 0; --i) {
-      DLTensor* x = of[i];
-      offset -= tuple_sizes[i];
-      void* buffer_data_at_offset = reinterpret_cast<uint8_t*>(fused_data) + offset;
-      cudaMemcpyAsync(x->data, buffer_data_at_offset, tuple_sizes[i], cudaMemcpyDeviceToDevice,
-                      (cudaStream_t)stream);
-    }
+    cuda::multi_tensor_unpack_cuda(fused_data, GetDLTensors(out->fields), stream);
   }
 
   static OpEnv* make(const CallValues& cv) {
@@ -400,10 +779,17 @@ class NCCLSend : public raf::op::OpEnv {
     Execute({args->x}, cv->out);
   }
 
+  bool IsGroupable(const std::vector<value::Value>& inputs,
+                   const value::Value& output) const override {
+    return true;
+  }
+
   void Execute(const std::vector<value::Value>& inputs, value::Value output) {
     auto comm_ptr = reinterpret_cast<NCCLCommunicatorObj*>(communicator);
     ncclComm_t nccl_comm = comm_ptr->nccl_comm;
     const DLTensor* x = inputs[0];
+    CommProfileScope scope(CommDevice(), stream, "raf.op.nccl._send", CommKind::kSendRecv,
+                           BytesCompactTensor(*x), 2);
     NCCL_CALL(ncclSend(x->data, BytesCompactTensor(*x) / (x->dtype.bits / 8), DType(x->dtype), peer,
                        nccl_comm, (cudaStream_t)stream));
   }
@@ -445,10 +831,17 @@ class NCCLRecv : public raf::op::OpEnv {
     Execute({}, cv->out);
   }
 
+  bool IsGroupable(const std::vector<value::Value>& inputs,
+                   const value::Value& output) const override {
+    return true;
+  }
+
   void Execute(const std::vector<value::Value>& inputs, value::Value output) {
     auto comm_ptr = reinterpret_cast<NCCLCommunicatorObj*>(communicator);
     ncclComm_t nccl_comm = comm_ptr->nccl_comm;
     DLTensor* out = output;
+    CommProfileScope scope(CommDevice(), stream, "raf.op.nccl._recv", CommKind::kSendRecv,
+                           BytesCompactTensor(*out), 2);
     NCCL_CALL(ncclRecv(out->data, BytesCompactTensor(*out) / (out->dtype.bits / 8),
                        DType(out->dtype), peer, nccl_comm, (cudaStream_t)stream));
   }
@@ -534,31 +927,26 @@ class NCCLReduce : public raf::op::OpEnv {
       dtype_size = GetSizeInBytes(x->dtype);
 
       size_t dtype_size = GetSizeInBytes(x->dtype);
+      CommProfileScope scope(CommDevice(), stream, "raf.op.nccl._reduce", CommKind::kReduce,
+                             total_size, comm_ptr->size);
       NCCL_CALL(ncclReduce(x->data, out->data, total_size / dtype_size, dtype, compute, root,
                            nccl_comm, (cudaStream_t)stream));
     } else {
-      size_t offset = 0;
       for (int i = 0; i < input_x->fields.size(); ++i) {
         DLTensor* x = input_x->fields[i];
-        void* buffer_data_at_offset = reinterpret_cast<uint8_t*>(fused_data) + offset;
-        cudaMemcpyAsync(buffer_data_at_offset, x->data, tuple_sizes[i], cudaMemcpyDeviceToDevice,
-                        (cudaStream_t)stream);
-        offset += tuple_sizes[i];
         dtype_size = GetSizeInBytes(x->dtype);
       }
+      cuda::multi_tensor_pack_cuda(GetDLTensors(input_x->fields), fused_data, stream);
 
-      NCCL_CALL(ncclReduce(fused_data, fused_data, total_size / dtype_size, dtype, compute, root,
-                           nccl_comm, (cudaStream_t)stream));
+      {
+        CommProfileScope scope(CommDevice(), stream, "raf.op.nccl._reduce", CommKind::kReduce,
+                               total_size, comm_ptr->size);
+        NCCL_CALL(ncclReduce(fused_data, fused_data, total_size / dtype_size, dtype, compute,
+                             root, nccl_comm, (cudaStream_t)stream));
+      }
       // UnFuse Tensor
       value::TupleValue out = tvm::runtime::Downcast<value::TupleValue>(output);
-      auto& of = out->fields;
-      for (int i = of.size() - 1; i >= 0; --i) {
-        DLTensor* x = of[i];
-        offset -= tuple_sizes[i];
-        void* buffer_data_at_offset = reinterpret_cast<uint8_t*>(fused_data) + offset;
-        cudaMemcpyAsync(x->data, buffer_data_at_offset, tuple_sizes[i], cudaMemcpyDeviceToDevice,
-                        (cudaStream_t)stream);
-      }
+      cuda::multi_tensor_unpack_cuda(fused_data, GetDLTensors(out->fields), stream);
     }
   }
 
@@ -168,6 +168,46 @@ struct Conv2dTransposeDxwAttrs : public tvm::AttrsNode<Conv2dTransposeDxwAttrs>
   }
 };
 
+/*! \brief Attributes used in _contrib_attention and _contrib_attention_dx operators */
+struct AttentionAttrs : public tvm::AttrsNode<AttentionAttrs> {
+  double scale;
+  bool causal;
+  TVM_DECLARE_ATTRS(AttentionAttrs, "relay.attrs.AttentionAttrs") {
+    TVM_ATTR_FIELD(scale).set_default(-1.0).describe(
+        "The scale of the attention scores. Non-positive values mean 1/sqrt(head_dim)");
+    TVM_ATTR_FIELD(causal).set_default(false).describe(
+        "Whether to mask the keys after each query");
+  }
+};
+
+/*! \brief Attributes used in _contrib_quantize and _contrib_dequantize operators */
+struct QuantizeAttrs : public tvm::AttrsNode<QuantizeAttrs> {
+  int axis;
+  TVM_DECLARE_ATTRS(QuantizeAttrs, "relay.attrs.QuantizeAttrs") {
+    TVM_ATTR_FIELD(axis).set_default(-1).describe(
+        "The channel axis of the input, along which the 1-D scale is applied");
+  }
+};
+
+/*! \brief Attributes used in _contrib_quantize_fp8 and _contrib_dequantize_fp8 operators */
+struct Fp8Attrs : public tvm::AttrsNode<Fp8Attrs> {
+  bool e5m2;
+  TVM_DECLARE_ATTRS(Fp8Attrs, "relay.attrs.Fp8Attrs") {
+    TVM_ATTR_FIELD(e5m2).set_default(false).describe(
+        "Whether the FP8 format is E5M2, or E4M3 otherwise");
+  }
+};
+
+/*! \brief Attributes used in _contrib_fp8_dense operator */
+struct Fp8DenseAttrs : public tvm::AttrsNode<Fp8DenseAttrs> {
+  bool x_e5m2;
+  bool w_e5m2;
+  TVM_DECLARE_ATTRS(Fp8DenseAttrs, "relay.attrs.Fp8DenseAttrs") {
+    TVM_ATTR_FIELD(x_e5m2).set_default(false).describe("Whether the input is in E5M2");
+    TVM_ATTR_FIELD(w_e5m2).set_default(false).describe("Whether the weight is in E5M2");
+  }
+};
+
 /*! \brief Attributes used in layer_norm operator */
 struct LayerNormAttrs : public tvm::AttrsNode<LayerNormAttrs> {
   int axis;
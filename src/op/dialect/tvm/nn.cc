@@ -433,6 +433,244 @@ RAF_TVM(_contrib_dropout_dx, DropoutDx, DropoutDxArgs, ContribDropoutDxSchema2Ar
         ContribDropoutDxSchemaArgNames, ContribDropoutDxSchema2Attrs, ContribDropoutDxHasher,
         kOpaque);
 
+std::vector<Value> ContribPhiloxDropoutSchema2Args(const PhiloxDropoutArgs* args) {
+  return {args->x, args->key};
+}
+
+std::vector<std::string> ContribPhiloxDropoutSchemaArgNames(const op::CallValues& call) {
+  return {"x", "key"};
+}
+
+std::vector<Value> ContribPhiloxDropoutDxSchema2Args(const PhiloxDropoutDxArgs* args) {
+  return {args->dy, args->key};
+}
+
+std::vector<std::string> ContribPhiloxDropoutDxSchemaArgNames(const op::CallValues& call) {
+  return {"dy", "key"};
+}
+
+template <typename T>
+Attrs ContribPhiloxDropoutSchema2Attrs(const T* args) {
+  auto attrs = make_object<DropoutAttrs>();
+  attrs->rate = args->p;
+  return Attrs(attrs);
+}
+
+template <typename T>
+HashKey ContribPhiloxDropoutHasher(const std::vector<Type>& param_types, const Type& y_type,
+                                   const T* args) {
+  HashKey key = GenericHasher<nullptr_t>(param_types, y_type, nullptr);
+  key << args->p;
+  return key;
+}
+
+RAF_TVM(_contrib_philox_dropout, ContribPhiloxDropout, PhiloxDropoutArgs,
+        ContribPhiloxDropoutSchema2Args, ContribPhiloxDropoutSchemaArgNames,
+        ContribPhiloxDropoutSchema2Attrs<PhiloxDropoutArgs>,
+        ContribPhiloxDropoutHasher<PhiloxDropoutArgs>, kInjective);
+
+RAF_TVM(_contrib_philox_dropout_dx, ContribPhiloxDropoutDx, PhiloxDropoutDxArgs,
+        ContribPhiloxDropoutDxSchema2Args, ContribPhiloxDropoutDxSchemaArgNames,
+        ContribPhiloxDropoutSchema2Attrs<PhiloxDropoutDxArgs>,
+        ContribPhiloxDropoutHasher<PhiloxDropoutDxArgs>, kInjective);
+
+std::vector<Value> ContribAttentionSchema2Args(const AttentionArgs* args) {
+  std::vector<Value> re = {args->q, args->k, args->v};
+  if (args->valid_len.defined()) {
+    re.push_back(args->valid_len.value());
+  }
+  return re;
+}
+
+std::vector<std::string> ContribAttentionSchemaArgNames(const op::CallValues& call) {
+  const auto* args = call->args.as<AttentionArgs>();
+  std::vector<std::string> ret = {"q", "k", "v"};
+  if (args->valid_len.defined()) {
+    ret.push_back("valid_len");
+  }
+  return ret;
+}
+
+template <typename T>
+Attrs ContribAttentionSchema2Attrs(const T* args) {
+  auto attrs = make_object<AttentionAttrs>();
+  attrs->scale = args->scale;
+  attrs->causal = args->causal;
+  return Attrs(attrs);
+}
+
+template <typename T>
+HashKey ContribAttentionHasher(const std::vector<Type>& param_types, const Type& y_type,
+                               const T* args) {
+  HashKey key = GenericHasher<nullptr_t>(param_types, y_type, nullptr);
+  key << args->scale;
+  key << args->causal;
+  return key;
+}
+
+RAF_TVM(_contrib_attention, ContribAttention, AttentionArgs, ContribAttentionSchema2Args,
+        ContribAttentionSchemaArgNames, ContribAttentionSchema2Attrs<AttentionArgs>,
+        ContribAttentionHasher<AttentionArgs>, kOpaque);
+
+std::vector<Value> ContribAttentionDxSchema2Args(const AttentionDxArgs* args) {
+  return {args->q, args->k, args->v, args->out, args->dy};
+}
+
+std::vector<std::string> ContribAttentionDxSchemaArgNames(const op::CallValues& call) {
+  return {"q", "k", "v", "out", "dy"};
+}
+
+RAF_TVM(_contrib_attention_dx, ContribAttentionDx, AttentionDxArgs,
+        ContribAttentionDxSchema2Args, ContribAttentionDxSchemaArgNames,
+        ContribAttentionSchema2Attrs<AttentionDxArgs>, ContribAttentionHasher<AttentionDxArgs>,
+        kOpaque);
+
+std::vector<Value> ContribKvCacheAppendSchema2Args(const KvCacheAppendArgs* args) {
+  return {args->cache, args->x, args->offset};
+}
+
+std::vector<std::string> ContribKvCacheAppendSchemaArgNames(const op::CallValues& call) {
+  return {"cache", "x", "offset"};
+}
+
+RAF_TVM(_contrib_kv_cache_append, ContribKvCacheAppend, KvCacheAppendArgs,
+        ContribKvCacheAppendSchema2Args, ContribKvCacheAppendSchemaArgNames, GenericAttrs,
+        GenericHasher, kOpaque);
+
+std::vector<Value> ContribQuantizeSchema2Args(const QuantizeArgs* args) {
+  return {args->x, args->scale};
+}
+
+std::vector<std::string> ContribQuantizeSchemaArgNames(const op::CallValues& call) {
+  return {"x", "scale"};
+}
+
+Attrs ContribQuantizeSchema2Attrs(const QuantizeArgs* args) {
+  auto attrs = make_object<QuantizeAttrs>();
+  attrs->axis = args->axis;
+  return Attrs(attrs);
+}
+
+HashKey ContribQuantizeHasher(const std::vector<Type>& param_types, const Type& y_type,
+                              const QuantizeArgs* args) {
+  HashKey key = GenericHasher<nullptr_t>(param_types, y_type, nullptr);
+  key << args->axis;
+  return key;
+}
+
+RAF_TVM(_contrib_quantize, ContribQuantize, QuantizeArgs, ContribQuantizeSchema2Args,
+        ContribQuantizeSchemaArgNames, ContribQuantizeSchema2Attrs, ContribQuantizeHasher,
+        kBroadcast);
+RAF_TVM(_contrib_dequantize, ContribDequantize, QuantizeArgs, ContribQuantizeSchema2Args,
+        ContribQuantizeSchemaArgNames, ContribQuantizeSchema2Attrs, ContribQuantizeHasher,
+        kBroadcast);
+
+std::vector<Value> ContribQuantizedDenseSchema2Args(const QuantizedDenseArgs* args) {
+  return {args->x, args->w, args->x_scale, args->w_scale};
+}
+
+std::vector<std::string> ContribQuantizedDenseSchemaArgNames(const op::CallValues& call) {
+  return {"x", "w", "x_scale", "w_scale"};
+}
+
+RAF_TVM(_contrib_quantized_dense, ContribQuantizedDense, QuantizedDenseArgs,
+        ContribQuantizedDenseSchema2Args, ContribQuantizedDenseSchemaArgNames, GenericAttrs,
+        GenericHasher, kOutEWiseFusable);
+
+std::vector<Value> ContribQuantizeFp8Schema2Args(const QuantizeFp8Args* args) {
+  return {args->x, args->scale};
+}
+
+std::vector<std::string> ContribQuantizeFp8SchemaArgNames(const op::CallValues& call) {
+  return {"x", "scale"};
+}
+
+Attrs ContribQuantizeFp8Schema2Attrs(const QuantizeFp8Args* args) {
+  auto attrs = make_object<Fp8Attrs>();
+  attrs->e5m2 = args->e5m2;
+  return Attrs(attrs);
+}
+
+HashKey ContribQuantizeFp8Hasher(const std::vector<Type>& param_types, const Type& y_type,
+                                 const QuantizeFp8Args* args) {
+  HashKey key = GenericHasher<nullptr_t>(param_types, y_type, nullptr);
+  key << args->e5m2;
+  return key;
+}
+
+RAF_TVM(_contrib_quantize_fp8, ContribQuantizeFp8, QuantizeFp8Args, ContribQuantizeFp8Schema2Args,
+        ContribQuantizeFp8SchemaArgNames, ContribQuantizeFp8Schema2Attrs, ContribQuantizeFp8Hasher,
+        kBroadcast);
+RAF_TVM(_contrib_dequantize_fp8, ContribDequantizeFp8, QuantizeFp8Args,
+        ContribQuantizeFp8Schema2Args, ContribQuantizeFp8SchemaArgNames,
+        ContribQuantizeFp8Schema2Attrs, ContribQuantizeFp8Hasher, kBroadcast);
+
+std::vector<Value> ContribFp8DenseSchema2Args(const Fp8DenseArgs* args) {
+  return {args->x, args->w, args->x_scale, args->w_scale};
+}
+
+std::vector<std::string> ContribFp8DenseSchemaArgNames(const op::CallValues& call) {
+  return {"x", "w", "x_scale", "w_scale"};
+}
+
+Attrs ContribFp8DenseSchema2Attrs(const Fp8DenseArgs* args) {
+  auto attrs = make_object<Fp8DenseAttrs>();
+  attrs->x_e5m2 = args->x_e5m2;
+  attrs->w_e5m2 = args->w_e5m2;
+  return Attrs(attrs);
+}
+
+HashKey ContribFp8DenseHasher(const std::vector<Type>& param_types, const Type& y_type,
+                              const Fp8DenseArgs* args) {
+  // The output dtype is hashed by the output type.
+  HashKey key = GenericHasher<nullptr_t>(param_types, y_type, nullptr);
+  key << args->x_e5m2 << args->w_e5m2;
+  return key;
+}
+
+RAF_TVM(_contrib_fp8_dense, ContribFp8Dense, Fp8DenseArgs, ContribFp8DenseSchema2Args,
+        ContribFp8DenseSchemaArgNames, ContribFp8DenseSchema2Attrs, ContribFp8DenseHasher,
+        kOutEWiseFusable);
+
+std::vector<Value> ContribSparseDenseSchema2Args(const SparseDenseArgs* args) {
+  return {args->x, args->w, args->meta};
+}
+
+std::vector<std::string> ContribSparseDenseSchemaArgNames(const op::CallValues& call) {
+  return {"x", "w", "meta"};
+}
+
+RAF_TVM(_contrib_sparse_dense, ContribSparseDense, SparseDenseArgs, ContribSparseDenseSchema2Args,
+        ContribSparseDenseSchemaArgNames, GenericAttrs, GenericHasher, kOutEWiseFusable);
+
+std::vector<Value> GroupedMatmulSchema2Args(const GroupedMatmulArgs* args) {
+  return {args->x, args->w, args->group_sizes};
+}
+
+std::vector<std::string> GroupedMatmulSchemaArgNames(const op::CallValues& call) {
+  return {"x", "w", "group_sizes"};
+}
+
+Attrs GroupedMatmulSchema2Attrs(const GroupedMatmulArgs* args) {
+  auto attrs = make_object<tvm::relay::BatchMatmulAttrs>();
+  attrs->out_dtype = NullValue<DataType>();
+  attrs->transpose_a = false;
+  attrs->transpose_b = args->transpose_b;
+  return Attrs(attrs);
+}
+
+HashKey GroupedMatmulHasher(const std::vector<Type>& param_types, const Type& y_type,
+                            const GroupedMatmulArgs* args) {
+  HashKey key = GenericHasher<nullptr_t>(param_types, y_type, nullptr);
+  key << args->transpose_b;
+  return key;
+}
+
+RAF_TVM(grouped_matmul, GroupedMatmul, GroupedMatmulArgs, GroupedMatmulSchema2Args,
+        GroupedMatmulSchemaArgNames, GroupedMatmulSchema2Attrs, GroupedMatmulHasher, kOpaque);
+RAF_TVM(grouped_matmul_dw, GroupedMatmulDw, GroupedMatmulArgs, GroupedMatmulSchema2Args,
+        GroupedMatmulSchemaArgNames, GroupedMatmulSchema2Attrs, GroupedMatmulHasher, kOpaque);
+
 template <typename T>
 std::vector<Value> PoolSchema2Args(const T* args) {
   return {args->x};
@@ -850,6 +1088,69 @@ RAF_TVM(batch_norm_train_dxwb, BatchNormTrainDxwb, BatchNormTrainDxwbArgs,
         BatchNormTrainDxwbSchema2Args, BatchNormTrainDxwbSchemaArgNames,
         BatchNormTrainDxwbSchema2Attrs, BatchNormTrainDxwbHasher, kOpaque);
 
+std::vector<Value> BatchNormAddReluSchema2Args(const BatchNormAddReluArgs* args) {
+  std::vector<Value> ret = {args->x, args->running_mean, args->running_var, args->w, args->b};
+  if (args->z.defined()) {
+    ret.push_back(args->z.value());
+  }
+  return ret;
+}
+
+std::vector<std::string> BatchNormAddReluSchemaArgNames(const op::CallValues& call) {
+  const auto* args = call->args.as<BatchNormAddReluArgs>();
+  std::vector<std::string> ret = {"x", "running_mean", "running_var", "w", "b"};
+  if (args->z.defined()) {
+    ret.push_back("z");
+  }
+  return ret;
+}
+
+Attrs BatchNormAddReluSchema2Attrs(const BatchNormAddReluArgs* args) {
+  auto attrs = make_object<BatchNormAttrs>();
+  attrs->momentum = args->momentum;
+  attrs->eps = args->eps;
+  return Attrs(attrs);
+}
+
+HashKey BatchNormAddReluHasher(const std::vector<Type>& param_types, const Type& ret_type,
+                               const BatchNormAddReluArgs* args) {
+  HashKey key = GenericHasher<nullptr_t>(param_types, ret_type, nullptr);
+  key << args->momentum;
+  key << args->eps;
+  return key;
+}
+
+RAF_TVM(_contrib_batch_norm_add_relu_train, ContribBatchNormAddReluTrain, BatchNormAddReluArgs,
+        BatchNormAddReluSchema2Args, BatchNormAddReluSchemaArgNames, BatchNormAddReluSchema2Attrs,
+        BatchNormAddReluHasher, kOpaque);
+
+std::vector<Value> BatchNormAddReluDxwbSchema2Args(const BatchNormAddReluDxwbArgs* args) {
+  return {args->dy, args->x, args->mask, args->w, args->b};
+}
+
+std::vector<std::string> BatchNormAddReluDxwbSchemaArgNames(const op::CallValues& call) {
+  return {"dy", "x", "mask", "w", "b"};
+}
+
+Attrs BatchNormAddReluDxwbSchema2Attrs(const BatchNormAddReluDxwbArgs* args) {
+  auto attrs = make_object<BatchNormAttrs>();
+  attrs->momentum = 0;  // momentum is not used in the gradient
+  attrs->eps = args->eps;
+  return Attrs(attrs);
+}
+
+HashKey BatchNormAddReluDxwbHasher(const std::vector<Type>& param_types, const Type& ret_type,
+                                   const BatchNormAddReluDxwbArgs* args) {
+  HashKey key = GenericHasher<nullptr_t>(param_types, ret_type, nullptr);
+  key << args->eps;
+  return key;
+}
+
+RAF_TVM(_contrib_batch_norm_add_relu_train_dxwb, ContribBatchNormAddReluTrainDxwb,
+        BatchNormAddReluDxwbArgs, BatchNormAddReluDxwbSchema2Args,
+        BatchNormAddReluDxwbSchemaArgNames, BatchNormAddReluDxwbSchema2Attrs,
+        BatchNormAddReluDxwbHasher, kOpaque);
+
 std::vector<Value> ThresholdSchema2Args(const ThresholdArgs* args) {
   return {args->x};
 }
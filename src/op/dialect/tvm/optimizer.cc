@@ -20,11 +20,20 @@ using namespace raf::ir;
 using schema::SgdArgs;
 
 std::vector<Value> SgdSchema2Args(const SgdArgs* args) {
-  return {args->x, args->dx, args->v};
+  std::vector<Value> ret = {args->x, args->dx, args->v};
+  if (args->skip.defined()) {
+    ret.push_back(args->skip.value());
+  }
+  return ret;
 }
 
 std::vector<std::string> SgdSchemaArgNames(const op::CallValues& call) {
-  return {"x", "dx", "v"};
+  const auto* args = call->args.as<SgdArgs>();
+  std::vector<std::string> ret = {"x", "dx", "v"};
+  if (args->skip.defined()) {
+    ret.push_back("skip");
+  }
+  return ret;
 }
 
 Attrs SgdSchema2Attrs(const SgdArgs* args) {
@@ -72,6 +72,7 @@ RAF_TVM_REDUCE(all, All);
 RAF_TVM_REDUCE(any, Any);
 RAF_TVM_REDUCE(mean, Mean);
 RAF_TVM_REDUCE(prod, Prod);
+RAF_TVM_REDUCE(moments, Moments);
 
 Attrs ReduceSchema2ArgReduceAttrs(const ReduceArgs* args) {
   auto attrs = make_object<ArgReduceAttrs>();
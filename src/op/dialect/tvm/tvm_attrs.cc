@@ -31,6 +31,10 @@ RAF_REGISTER_OBJECT_REFLECT(SwapAxisAttrs);
 RAF_REGISTER_OBJECT_REFLECT(Conv2dDxwAttrs);
 RAF_REGISTER_OBJECT_REFLECT(Conv2dTransposeDxwAttrs);
 RAF_REGISTER_OBJECT_REFLECT(LayerNormAttrs);
+RAF_REGISTER_OBJECT_REFLECT(AttentionAttrs);
+RAF_REGISTER_OBJECT_REFLECT(QuantizeAttrs);
+RAF_REGISTER_OBJECT_REFLECT(Fp8Attrs);
+RAF_REGISTER_OBJECT_REFLECT(Fp8DenseAttrs);
 RAF_REGISTER_OBJECT_REFLECT(BatchNormAttrs);
 RAF_REGISTER_OBJECT_REFLECT(PadAttrs);
 RAF_REGISTER_OBJECT_REFLECT(ThresholdAttrs);
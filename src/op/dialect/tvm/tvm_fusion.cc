@@ -260,11 +260,25 @@ OpEnv* FusedFuncBuild(const op::CallValues& call) {
       << "NotImplementedError: target is not supported " << dev.device_type().c_str();
   Meta2TVM meta_to_tvm(call, dev.device_type());
   Function func = Downcast<Function>(meta_to_tvm());
-  // TODO(@hzfan): add cache for raf
+  EnableAutoSchedulerWithTuningLog();
   te_compiler->Clear();
   env->env_name = TruncateName(GetUniqueName(meta_to_tvm.func_name));
+  // The fused functions are cached by the digests of their texts, which include the ops, attrs
+  // and types.
+  auto cache = dev.device_type() == DevType::kCPU() ? &CacheBuildFusedCpu : &CacheBuildFusedCuda;
+  HashKey key;
+  key << raf::ir::AsText(func, false) << target->str() << TuningLogFingerprint();
+  auto f_build = [&]() {
+    auto cache_key = tvm::relay::tec::CCacheKey(func, target);
+    auto cached_func = te_compiler->Lower(cache_key, [](String name) { return name; });
+    auto mod = tvm::build(cached_func->funcs, cache_key->target, Target(nullptr));
+    return TVMModuleCacheEntry(mod, cached_func->prim_fn_var->name_hint);
+  };
   try {
-    env->f = te_compiler->JIT(tvm::relay::tec::CCacheKey(func, target));
+    // Always lower the function when extracting the tuning tasks, which traces the workloads.
+    auto module_cache_entry =
+        AllowJitFailure() ? f_build() : *cache->GetOrCompute(key.Digest(), f_build);
+    env->f = module_cache_entry.GetFunction();
   } catch (const dmlc::Error& e) {
     if (!AllowJitFailure()) {
       LOG(FATAL) << "Failed to build a fused op " << env->env_name << ": " << e.what();
@@ -7,6 +7,9 @@
  * \file ./src/op/dialect/tvm/tvm_utils.cc
  * \brief Implementation of utility methods for TVM dialect.
  */
+#include <sys/stat.h>
+#include <algorithm>
+#include <limits>
 #include "raf/value.h"
 #include "raf/registry.h"
 #include "./tvm_utils.h"
@@ -22,9 +25,26 @@ using namespace raf::registry;
 using common::shape_utils::BytesCompactTensor;
 using common::shape_utils::GetShape;
 
-MetaPersistCache<TVMModuleCacheEntry> CacheBuildCpu("tvm_cpu");
-MetaPersistCache<TVMModuleCacheEntry> CacheBuildCuda("tvm_cuda");
+MetaPersistCache<TVMModuleCacheEntry> CacheBuildCpu("tvm_cpu", true);
+MetaPersistCache<TVMModuleCacheEntry> CacheBuildCuda("tvm_cuda", true);
 MetaPersistCache<RelayFuncCacheEntry> CacheLoweredFunc("tvm_lower");
+MetaPersistCache<TVMModuleCacheEntry> CacheBuildFusedCpu("tvm_fused_cpu", true);
+MetaPersistCache<TVMModuleCacheEntry> CacheBuildFusedCuda("tvm_fused_cuda", true);
+
+std::string TuningLogFingerprint() {
+  const char* log = getenv("RAF_TUNING_LOG");
+  if (log == nullptr || log[0] == '\0') {
+    return "";
+  }
+  struct stat st;
+  if (stat(log, &st) != 0) {
+    LOG(WARNING) << "Cannot find the tuning log " << log << " specified by RAF_TUNING_LOG";
+    return "";
+  }
+  std::ostringstream os;
+  os << log << ":" << st.st_size << ":" << st.st_mtime;
+  return os.str();
+}
 
 void GetDLTensor(const Value& v, std::vector<DLTensor>* tensors) {
   if (v->IsInstance<TensorValueObj>()) {
@@ -54,6 +74,77 @@ Type GetTupleType(const std::vector<DLTensor>& dlts) {
   return TupleType(types);
 }
 
+bool MakeLeadingDimSymbolic(std::vector<Type>* param_types, Type* ret_type, bool* index_int32) {
+  std::vector<TensorType> outs;
+  if (const auto* tuple = ret_type->as<TupleTypeNode>()) {
+    for (const auto& field : tuple->fields) {
+      outs.push_back(Downcast<TensorType>(field));
+    }
+  } else {
+    outs.push_back(Downcast<TensorType>(*ret_type));
+  }
+  size_t ndim = outs[0]->shape.size();
+  const auto* batch = ndim > 0 ? outs[0]->shape[0].as<IntImmNode>() : nullptr;
+  if (batch == nullptr || batch->value <= 1) {
+    return false;
+  }
+  for (const auto& out : outs) {
+    const auto* dim = out->shape.size() == ndim ? out->shape[0].as<IntImmNode>() : nullptr;
+    if (dim == nullptr || dim->value != batch->value) {
+      return false;
+    }
+  }
+  auto fits_int32 = [](const Type& type) {
+    int64_t numel = 1;
+    for (const auto& dim : Downcast<TensorType>(type)->shape) {
+      const auto* imm = dim.as<IntImmNode>();
+      if (imm == nullptr) {
+        return false;
+      }
+      numel *= imm->value;
+    }
+    return numel < std::numeric_limits<int32_t>::max();
+  };
+  // Any is lowered to an int64 var, so all the indices of the kernel are computed in int64. If
+  // the tensors of this call fit, an int32 var is used instead, and a larger call builds another
+  // kernel with Any.
+  *index_int32 = std::all_of(param_types->begin(), param_types->end(), fits_int32) &&
+                 std::all_of(outs.begin(), outs.end(), fits_int32);
+  PrimExpr batch_dim = tvm::tir::Any();
+  if (*index_int32) {
+    batch_dim = tvm::tir::Var("batch", DataType::Int(32));
+  }
+  auto replace = [&batch_dim](const TensorType& type) {
+    Array<PrimExpr> shape = type->shape;
+    shape.Set(0, batch_dim);
+    return TensorType(shape, type->dtype);
+  };
+  std::vector<Type> params;
+  for (const auto& param : *param_types) {
+    auto type = Downcast<TensorType>(param);
+    if (type->shape.size() < ndim) {
+      params.push_back(type);
+      continue;
+    }
+    const auto* dim = type->shape.size() == ndim ? type->shape[0].as<IntImmNode>() : nullptr;
+    if (dim == nullptr || (dim->value != batch->value && dim->value != 1)) {
+      return false;
+    }
+    params.push_back(dim->value == 1 ? type : replace(type));
+  }
+  *param_types = std::move(params);
+  if (ret_type->as<TupleTypeNode>()) {
+    Array<Type> fields;
+    for (const auto& out : outs) {
+      fields.push_back(replace(out));
+    }
+    *ret_type = TupleType(fields);
+  } else {
+    *ret_type = replace(outs[0]);
+  }
+  return true;
+}
+
 Function LowerOp(const Op& op, const Attrs& attrs, const std::vector<Type>& param_types,
                  const Type& ret_type) {
   Function func;
@@ -84,13 +175,45 @@ void SetArgs(std::vector<DLTensor>* i, std::vector<DLTensor>* o, std::vector<TVM
   }
 }
 
-void TVMOpEnv::Execute(const op::CallValues& call) {
-  std::vector<TVMValue> values;
-  std::vector<int> codes;
-  SetArgs(&inputs, &outputs, &values, &codes);
-  TVMArgs targs(values.data(), codes.data(), values.size());
+/*!
+ * \brief Overwrite the tensors from *count with the tensors of the value, and advance *count. The
+ * tensors are only appended after the existing ones are used up.
+ */
+void AssignDLTensor(const Value& v, std::vector<DLTensor>* tensors, size_t* count) {
+  auto assign = [tensors, count](const DLTensor* t) {
+    if (*count < tensors->size()) {
+      (*tensors)[*count] = *t;
+    } else {
+      tensors->emplace_back(*t);
+    }
+    ++*count;
+  };
+  if (v->IsInstance<TensorValueObj>()) {
+    assign(v);
+  } else if (const auto* tv = v.as<TupleValueObj>()) {
+    for (const auto& field : tv->fields) {
+      assign(field);
+    }
+  } else {
+    LOG(FATAL) << "InternalError: TVMOpEnv does not deal with " << v->GetTypeKey();
+    throw;
+  }
+}
+
+void TVMOpEnv::CallPacked() {
+  if (packed_inputs_ != inputs.data() || packed_outputs_ != outputs.data() ||
+      arg_values_.size() != inputs.size() + outputs.size()) {
+    SetArgs(&inputs, &outputs, &arg_values_, &arg_codes_);
+    packed_inputs_ = inputs.data();
+    packed_outputs_ = outputs.data();
+  }
+  TVMArgs targs(arg_values_.data(), arg_codes_.data(), arg_values_.size());
   TVMRetValue rv;
   f.CallPacked(targs, &rv);
+}
+
+void TVMOpEnv::Execute(const op::CallValues& call) {
+  CallPacked();
   if (call->out->IsInstance<TensorValueObj>()) {
     DLTensor* dlt = Downcast<value::TensorValue>(call->out);
     dlt->data = outputs[0].data;
@@ -107,17 +230,15 @@ void TVMOpEnv::Execute(const op::CallValues& call) {
 }
 
 void TVMOpEnv::Execute(const std::vector<Value>& inputs, Value output) {
-  this->inputs.clear();
-  this->outputs.clear();
-  for (auto val : inputs) {
-    GetDLTensor(val, &this->inputs);
-  }
-  GetDLTensor(output, &this->outputs);
-  std::vector<TVMValue> values;
-  std::vector<int> codes;
-  SetArgs(&this->inputs, &this->outputs, &values, &codes);
-  TVMArgs targs(values.data(), codes.data(), values.size());
-  TVMRetValue rv;
+  // The tensors are copied in place, including their shapes, which may change between the calls
+  // of the kernels with a symbolic leading dim.
+  size_t num_inputs = 0, num_outputs = 0;
+  for (const auto& val : inputs) {
+    AssignDLTensor(val, &this->inputs, &num_inputs);
+  }
+  AssignDLTensor(output, &this->outputs, &num_outputs);
+  this->inputs.resize(num_inputs);
+  this->outputs.resize(num_outputs);
 
   // Skip the execution if we are in the task extraction mode since
   // we do not care about the correctness.
@@ -125,7 +246,7 @@ void TVMOpEnv::Execute(const std::vector<Value>& inputs, Value output) {
     return;
   }
 
-  f.CallPacked(targs, &rv);
+  CallPacked();
 }
 
 PackedMetricMap DumpTVMCacheMetric(const std::string& cache_name) {
@@ -133,6 +254,8 @@ PackedMetricMap DumpTVMCacheMetric(const std::string& cache_name) {
       {"tvm_cpu", &CacheBuildCpu},
       {"tvm_cuda", &CacheBuildCuda},
       {"tvm_lower", &CacheLoweredFunc},
+      {"tvm_fused_cpu", &CacheBuildFusedCpu},
+      {"tvm_fused_cuda", &CacheBuildFusedCuda},
   };
 
   PackedMetricMap ret;
@@ -150,8 +273,9 @@ PackedMetricMap DumpTVMCacheMetric(const std::string& cache_name) {
 
 RAF_REGISTER_GLOBAL("raf.cache.DumpTVMCacheMetric").set_body_typed(DumpTVMCacheMetric);
 
-RAF_REGISTER_DIALECT("tvm").set_enable(DevType::kCPU()).set_enable(DevType::kCUDA());
+RAF_REGISTER_DIALECT("tvm").set_enable(DevType::kCPU()).set_enable(DevType::kCUDA()).set_jit();
 TVM_REGISTER_PASS_CONFIG_OPTION("raf.tvm.allow_jit_failure", tvm::Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.tvm.symbolic_batch", tvm::Bool);
 
 }  // namespace tvm_dialect
 }  // namespace op
@@ -37,6 +37,18 @@ ir::Type GetTensorType(const DLTensor& dlt);
 ir::Type GetTupleType(const std::vector<DLTensor>& dlts);
 ir::Function LowerOp(const ir::Op& op, const ir::Attrs& attrs,
                      const std::vector<ir::Type>& param_types, const ir::Type& ret_type);
+/*!
+ * \brief Replace the leading (batch) dimension of the output and the inputs with Any, so that the
+ * kernel is built once for all batch sizes. The inputs that are broadcast along the leading
+ * dimension (i.e., whose rank is lower or whose leading dimension is 1) are kept as they are.
+ * \param index_int32 Whether the leading dimension is an int32 var, so that the kernel indexes in
+ * int32, which is only the case when all the tensors of the call have fewer than 2^31 elements.
+ * Otherwise it is Any, which is lowered to an int64 var.
+ * \return Whether the types are rewritten. They are kept untouched if the outputs do not have a
+ * common leading dimension larger than 1, or an input cannot be matched to it.
+ */
+bool MakeLeadingDimSymbolic(std::vector<ir::Type>* param_types, ir::Type* ret_type,
+                            bool* index_int32);
 float CalcFuncGFLOPS(const op::CallValues& call, const Array<Type>& param_types,
                      const Type& ret_type, const Device& device);
 
@@ -54,6 +66,21 @@ class TVMOpEnv : public op::OpEnv {
   }
   void Execute(const op::CallValues& call) override;
   void Execute(const std::vector<Value>& inputs, Value outputs) override;
+
+ private:
+  /*!
+   * \brief Call f with the packed arguments, which point to the tensors in inputs and outputs.
+   * They are only packed again when the vectors are reallocated, so a launch does not allocate.
+   */
+  void CallPacked();
+
+  /*! \brief The packed arguments of f. */
+  std::vector<TVMValue> arg_values_;
+  /*! \brief The type codes of the packed arguments of f. */
+  std::vector<int> arg_codes_;
+  /*! \brief The buffers of inputs and outputs when the arguments are packed. */
+  const DLTensor* packed_inputs_ = nullptr;
+  const DLTensor* packed_outputs_ = nullptr;
 };
 
 /*! \brief The persist cache entry of TVM modules. */
@@ -179,6 +206,27 @@ inline bool AllowJitFailure() {
       .value();
 }
 
+/*!
+ * \brief Return whether the elementwise and broadcast kernels are built with a symbolic batch
+ * dimension instead of being specialized on every batch size.
+ */
+inline bool UseSymbolicBatch() {
+  return tvm::relay::transform::PassContext::Current()
+      ->GetConfig<tvm::Bool>("raf.tvm.symbolic_batch", tvm::Bool(false))
+      .value();
+}
+
+/*! \brief Whether the two functions are the same one. Functions of different types never are. */
+template <typename F, typename G>
+inline bool IsSameFunc(F, G) {
+  return false;
+}
+
+template <typename F>
+inline bool IsSameFunc(F* f, F* g) {
+  return f == g;
+}
+
 /*!
  * \brief Modify the configs of the current PassContext to enable auto-scheduler for TVM ops.
  */
@@ -187,6 +235,24 @@ inline void ForceEnableAutoScheduler() {
                                                             tvm::Bool(true));
 }
 
+/*!
+ * \brief The fingerprint of the auto-scheduler tuning log specified by environment variable
+ * RAF_TUNING_LOG, which consists of its path, size and modification time. It is empty if no log
+ * is specified. The fingerprint is a part of the keys of built kernels, so that the kernels built
+ * before tuning (or with another log) are not reused from the persistent cache.
+ */
+std::string TuningLogFingerprint();
+
+/*!
+ * \brief Enable auto-scheduler for TVM ops if a tuning log is specified, so that the best records
+ * applied by the dispatch context in Python are used when building the kernels.
+ */
+inline void EnableAutoSchedulerWithTuningLog() {
+  if (!TuningLogFingerprint().empty()) {
+    ForceEnableAutoScheduler();
+  }
+}
+
 using FRAFLower = registry::TypedPackedFunc<ir::Function(const CallValues& call)>;
 using FRAFAttr = registry::TypedPackedFunc<ir::Attrs(const CallValues& call)>;
 using FRAFArgIndices =
@@ -195,6 +261,8 @@ using FRAFArgIndices =
 extern MetaPersistCache<TVMModuleCacheEntry> CacheBuildCpu;
 extern MetaPersistCache<TVMModuleCacheEntry> CacheBuildCuda;
 extern MetaPersistCache<RelayFuncCacheEntry> CacheLoweredFunc;
+extern MetaPersistCache<TVMModuleCacheEntry> CacheBuildFusedCpu;
+extern MetaPersistCache<TVMModuleCacheEntry> CacheBuildFusedCuda;
 
 }  // namespace tvm_dialect
 }  // namespace op
@@ -205,7 +273,8 @@ extern MetaPersistCache<RelayFuncCacheEntry> CacheLoweredFunc;
   template <typename RType>                                                                        \
   inline RType FUNC##CacheCompile(TVMOpEnv* env, const op::CallValues call,                        \
                                   MetaPersistCache<RType>* cache,                                  \
-                                  std::function<RType(const ir::Function&)> f_post_lower) {        \
+                                  std::function<RType(const ir::Function&)> f_post_lower,          \
+                                  bool with_schedule) {                                            \
     raf::op::tvm_dialect::ForceEnableAutoScheduler();                                              \
     static const auto op = Op::Get(RAF_DIALECT_OP_NAME(tvm, OP));                                  \
     const auto* schema = call->args.as<SCHEMA>();                                                  \
@@ -225,17 +294,28 @@ extern MetaPersistCache<RelayFuncCacheEntry> CacheLoweredFunc;
     } else {                                                                                       \
       ret_type = GetTupleType(env->outputs);                                                       \
     }                                                                                              \
-    RType ret;                                                                                     \
+    /* Elementwise and broadcast kernels without attributes are shared by all batch sizes. */     \
+    /* The lowered functions for fusion are always kept static. */                                 \
+    bool index_int32 = false;                                                                      \
+    bool symbolic = with_schedule &&                                                               \
+                    (OP_PATTERN == ::tvm::relay::kElemWise ||                                      \
+                     OP_PATTERN == ::tvm::relay::kBroadcast) &&                                    \
+                    IsSameFunc(SCHEMA2ATTRS, &GenericAttrs<SCHEMA>) &&                             \
+                    IsSameFunc(HASH, &GenericHasher<SCHEMA>) && UseSymbolicBatch() &&              \
+                    MakeLeadingDimSymbolic(&param_types, &ret_type, &index_int32);                 \
     HashKey key;                                                                                   \
     key << #OP << HASH(param_types, ret_type, schema);                                             \
-    if (const auto* compiled = cache->Get(key.byte_vector)) {                                      \
-      ret = *compiled;                                                                             \
-    } else {                                                                                       \
-      auto lowered = LowerOp(op, attrs, param_types, ret_type);                                    \
-      ret = f_post_lower(lowered);                                                                 \
-      cache->Set(key.byte_vector, ret);                                                            \
+    if (symbolic) {                                                                                \
+      key << (index_int32 ? "symbolic_int32" : "symbolic");                                        \
+    }                                                                                              \
+    if (with_schedule) {                                                                           \
+      key << TuningLogFingerprint();                                                               \
     }                                                                                              \
-    return ret;                                                                                    \
+    /* Concurrent misses of the same kernel, e.g., from local ranks, compile it only once. */      \
+    return *cache->GetOrCompute(key.byte_vector, [&]() {                                           \
+      auto lowered = LowerOp(op, attrs, param_types, ret_type);                                    \
+      return f_post_lower(lowered);                                                                \
+    });                                                                                            \
   }                                                                                                \
   OpEnv* FUNC##Build(const op::CallValues call) {                                                  \
     tvm::relay::tec::TECompiler te_compiler;                                                       \
@@ -269,7 +349,7 @@ extern MetaPersistCache<RelayFuncCacheEntry> CacheLoweredFunc;
           return TVMModuleCacheEntry(mod, cached_func->prim_fn_var->name_hint);                    \
         });                                                                                        \
     try {                                                                                          \
-      auto module_cache_entry = FUNC##CacheCompile(env, call, cache, f_post_lower);                \
+      auto module_cache_entry = FUNC##CacheCompile(env, call, cache, f_post_lower, true);          \
       env->f = module_cache_entry.GetFunction();                                                   \
     } catch (const dmlc::Error& e) {                                                               \
       /* Invalid implementation. Return nullptr to let dispatcher select the next one */           \
@@ -306,7 +386,7 @@ extern MetaPersistCache<RelayFuncCacheEntry> CacheLoweredFunc;
     MetaPersistCache<RelayFuncCacheEntry>* cache;                                                  \
     cache = &CacheLoweredFunc;                                                                     \
     auto env = std::make_unique<TVMOpEnv>();                                                       \
-    return FUNC##CacheCompile(env.get(), call, cache, identity).GetFunction();                     \
+    return FUNC##CacheCompile(env.get(), call, cache, identity, false).GetFunction();              \
   }                                                                                                \
   RAF_REGISTER_DIALECT_OP(tvm, OP, PLEVEL)                                                         \
       .set_attr<::raf::op::TOpPattern>("TOpPattern", OP_PATTERN)                                   \
@@ -0,0 +1,43 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/grad/collective_comm.cc
+ * \brief Declaration of gradients
+ */
+#include "./grad_utils.h"
+#include "raf/dist_context.h"
+#include "raf/value.h"
+
+namespace raf {
+namespace op {
+namespace grad {
+
+using namespace raf::ir;
+using namespace raf::value;
+
+Array<Expr> AllGatherGrad(const Expr& orig_call, const Array<Expr> orig_args, const Var& y,
+                          const Expr& dy) {
+  // Each rank contributes one chunk of the gathered tensor, so its gradient is the sum of the
+  // gradients of its chunk over all ranks.
+  static auto split = Op::Get("raf.op.split");
+  static auto reduce_scatter = Op::Get("raf.op._reduce_scatter");
+  const CallNode* call = orig_call.as<CallNode>();
+  CHECK(call != nullptr);
+  CHECK_GE(call->args.size(), 3);
+  const Expr& axis = call->args[1];
+  const auto* rank_list = call->args[2].as<ConstantNode>();
+  CHECK(rank_list != nullptr && !rank_list->value.defined())
+      << "The gradient of allgather with a rank list is not supported";
+  int64_t size = distributed::DistContext::Global()->size;
+  Expr chunks = Call(split, {dy, MakeConstant(ScalarValue::make(size)), axis});
+  return {Call(reduce_scatter, {chunks, MakeConstant(StringValue::make("sum"))})};
+}
+
+RAF_OP_GRAD("raf.op._allgather", AllGatherGrad);
+
+}  // namespace grad
+}  // namespace op
+}  // namespace raf
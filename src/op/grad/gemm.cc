@@ -116,6 +116,28 @@ RAF_OP_GRAD("raf.op.batch_matmul_nt", BatchMatmulGradNT);
 RAF_OP_GRAD("raf.op.batch_matmul_tn", BatchMatmulGradTN);
 RAF_OP_GRAD("raf.op.batch_matmul_tt", BatchMatmulGradTT);
 
+Array<Expr> GroupedMatmulGrad(const Expr& orig_call, const Array<Expr> orig_args, const Var& y,
+                              const Expr& dy) {
+  static auto op_grouped_matmul = Op::Get("raf.op.grouped_matmul");
+  static auto op_grouped_matmul_dw = Op::Get("raf.op.grouped_matmul_dw");
+  const CallNode* call = orig_call.as<CallNode>();
+  const Expr& x = call->args[0];
+  const Expr& w = call->args[1];
+  const Expr& group_sizes = call->args[2];
+  const auto* transpose_b = call->args[3].as<ConstantNode>();
+  CHECK(transpose_b) << "GroupedMatmulGrad expects transpose_b to be a constant";
+  bool trans = GetScalarValueData<bool>(Downcast<Value>(transpose_b->value));
+  // dx takes the weights of the same groups transposed, i.e., dx_e = dy_e * w_e^T.
+  Expr transpose_dx = MakeConstant(BoolValue::make(!trans));
+  return {
+      Call(op_grouped_matmul, {dy, w, group_sizes, transpose_dx}),
+      Call(op_grouped_matmul_dw, {x, dy, group_sizes, call->args[3]}),
+      NullValue<Expr>(),
+  };
+}
+
+RAF_OP_GRAD("raf.op.grouped_matmul", GroupedMatmulGrad);
+
 }  // namespace grad
 }  // namespace op
 }  // namespace raf
@@ -45,6 +45,37 @@ Array<Expr> ContribDropoutGrad(const Expr& orig_call, const Array<Expr> orig_arg
 
 RAF_OP_GRAD("raf.op._contrib_dropout", ContribDropoutGrad);
 
+Array<Expr> ContribPhiloxDropoutGrad(const Expr& orig_call, const Array<Expr> orig_args,
+                                     const Var& y, const Expr& dy) {
+  const static auto dropout_dx = Op::Get("raf.op._contrib_philox_dropout_dx");
+  const Expr& key = orig_args[1];
+  const Expr& p = orig_args[2];
+  // The mask is regenerated from the key, so only the key is kept alive for the backward.
+  return {Call(dropout_dx, {dy, key, p})};
+}
+
+RAF_OP_GRAD("raf.op._contrib_philox_dropout", ContribPhiloxDropoutGrad);
+
+Array<Expr> ContribAttentionGrad(const Expr& orig_call, const Array<Expr> orig_args, const Var& y,
+                                 const Expr& dy) {
+  const static auto attention_dx = Op::Get("raf.op._contrib_attention_dx");
+  const Expr& q = orig_args[0];
+  const Expr& k = orig_args[1];
+  const Expr& v = orig_args[2];
+  const Expr& scale = orig_args[3];
+  const Expr& causal = orig_args[4];
+  if (orig_args.size() > 5) {
+    const auto* valid_len = orig_args[5].as<ConstantNode>();
+    CHECK(valid_len && !valid_len->value.defined())
+        << "The gradient of attention with valid_len is not supported";
+  }
+  // The attention scores are recomputed by the backward op instead of being saved.
+  const Expr& ret = Call(attention_dx, {q, k, v, y, dy, scale, causal});
+  return {TupleGetItem(ret, 0), TupleGetItem(ret, 1), TupleGetItem(ret, 2)};
+}
+
+RAF_OP_GRAD("raf.op._contrib_attention", ContribAttentionGrad);
+
 template <const char* GradOp>
 Array<Expr> PoolGrad(const Expr& orig_call, const Array<Expr> orig_args, const Var& y,
                      const Expr& dy) {
@@ -357,6 +388,35 @@ Array<Expr> BatchNormTrainGrad(const Expr& orig_call, const Var& y, const Expr&
 
 RAF_OP_FUSED_GRAD("raf.op.batch_norm_train", BatchNormTrainGrad);
 
+Array<Expr> BatchNormAddReluTrainGrad(const Expr& orig_call, const Var& y, const Expr& dymv,
+                                      const Array<Expr>& igrads) {
+  // schema for _contrib_batch_norm_add_relu_train is:
+  //    x, running_mean, running_var, w, b, z, momentum, eps
+  // schema for _contrib_batch_norm_add_relu_train_dxwb is:
+  //    dy, x, mask, w, b, eps
+  static auto op_dxwb = Op::Get("raf.op._contrib_batch_norm_add_relu_train_dxwb");
+  const Expr& dy = AsTupleExpr(dymv, 4)[0];
+  const CallNode* call = orig_call.as<CallNode>();
+  const Expr& x = call->args[0];
+  const Expr& w = call->args[3];
+  const Expr& b = call->args[4];
+  const Expr& eps = call->args[7];
+  // Only the ReLU mask of y is kept for the backward, instead of the activation.
+  const Expr& ret = Call(op_dxwb, {dy, x, TupleGetItem(y, 3), w, b, eps});
+  const auto* z = call->args[5].as<ConstantNode>();
+  bool has_z = !(z && !z->value.defined());
+  return {
+      TupleGetItem(ret, 0),
+      NullValue<Expr>(),
+      NullValue<Expr>(),
+      TupleGetItem(ret, 1),
+      TupleGetItem(ret, 2),
+      has_z ? TupleGetItem(ret, 3) : NullValue<Expr>(),
+  };
+}
+
+RAF_OP_FUSED_GRAD("raf.op._contrib_batch_norm_add_relu_train", BatchNormAddReluTrainGrad);
+
 template <const char* GradOp>
 Array<Expr> SoftmaxGradImpl(const Expr& orig_call, const Array<Expr> orig_args, const Var& y,
                             const Expr& dy) {
@@ -18,6 +18,13 @@ using namespace raf::ir;
 RAF_OP_GRAD("raf.op.numel", NoGrads<1>);
 RAF_OP_GRAD("raf.op.shape_as_tensor", NoGrads<1>);
 
+Array<Expr> CheckpointGrad(const Expr& orig_call, const Array<Expr> orig_args, const Var& y,
+                           const Expr& dy) {
+  return {dy};
+}
+
+RAF_OP_GRAD("raf.op.checkpoint", CheckpointGrad);
+
 }  // namespace grad
 }  // namespace op
 }  // namespace raf
@@ -26,6 +26,7 @@ Type CompilerInfer(const CallValues& value) {
 
 RAF_OP_TYPE("raf.op.compiler_begin", "Compiler", CompilerInfer);
 RAF_OP_TYPE("raf.op.compiler_end", "Compiler", CompilerInfer);
+RAF_OP_TYPE("raf.op.checkpoint", "Checkpoint", CompilerInfer);
 
 }  // namespace op
 }  // namespace raf
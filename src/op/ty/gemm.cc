@@ -9,6 +9,7 @@
  */
 #include <tvm/relay/type.h>
 #include "raf/type.h"
+#include "../schema/nn.h"
 #include "../schema/ufunc.h"
 #include "./utils.h"
 
@@ -18,6 +19,7 @@ namespace op {
 using namespace raf::ir;
 using namespace raf::value;
 using schema::BinaryArgs;
+using schema::GroupedMatmulArgs;
 
 template <bool transpose_a, bool transpose_b>
 Type MatmulInfer(const CallValues& value) {
@@ -81,5 +83,41 @@ RAF_OP_TYPE("raf.op.batch_matmul_nt", "BatchMatmulNT", (BatchMatmulInfer<false,
 RAF_OP_TYPE("raf.op.batch_matmul_tn", "BatchMatmulTN", (BatchMatmulInfer<true, false>));
 RAF_OP_TYPE("raf.op.batch_matmul_tt", "BatchMatmulTT", (BatchMatmulInfer<true, true>));
 
+Type GroupedMatmulInfer(const CallValues& value) {
+  const auto* args = value->args.as<GroupedMatmulArgs>();
+  CHECK(args != nullptr);
+  TensorType x = Downcast<TensorType>(GetType(args->x));
+  TensorType w = Downcast<TensorType>(GetType(args->w));
+  TensorType group_sizes = Downcast<TensorType>(GetType(args->group_sizes));
+  CHECK(x->shape.size() == 2 && w->shape.size() == 3 && group_sizes->shape.size() == 1);
+  PrimExpr k = args->transpose_b ? w->shape[2] : w->shape[1];
+  PrimExpr n = args->transpose_b ? w->shape[1] : w->shape[2];
+  CHECK(TypeCheckCompare(x->shape[1], k, std::equal_to<int>()))
+      << "GroupedMatmul: shapes of x and w is inconsistent, "
+      << " x shape=" << x->shape << ", w shape=" << w->shape;
+  CHECK(TypeCheckCompare(group_sizes->shape[0], w->shape[0], std::equal_to<int>()))
+      << "GroupedMatmul: the number of groups mismatches the number of weights";
+  return TensorType({x->shape[0], n}, x->dtype);
+}
+
+Type GroupedMatmulDwInfer(const CallValues& value) {
+  const auto* args = value->args.as<GroupedMatmulArgs>();
+  CHECK(args != nullptr);
+  TensorType x = Downcast<TensorType>(GetType(args->x));
+  TensorType dy = Downcast<TensorType>(GetType(args->w));
+  TensorType group_sizes = Downcast<TensorType>(GetType(args->group_sizes));
+  CHECK(x->shape.size() == 2 && dy->shape.size() == 2 && group_sizes->shape.size() == 1);
+  CHECK(TypeCheckCompare(x->shape[0], dy->shape[0], std::equal_to<int>()))
+      << "GroupedMatmulDw: the rows of x and dy mismatch";
+  PrimExpr e = group_sizes->shape[0];
+  if (args->transpose_b) {
+    return TensorType({e, dy->shape[1], x->shape[1]}, x->dtype);
+  }
+  return TensorType({e, x->shape[1], dy->shape[1]}, x->dtype);
+}
+
+RAF_OP_TYPE("raf.op.grouped_matmul", "GroupedMatmul", GroupedMatmulInfer);
+RAF_OP_TYPE("raf.op.grouped_matmul_dw", "GroupedMatmulDw", GroupedMatmulDwInfer);
+
 }  // namespace op
 }  // namespace raf
@@ -11,6 +11,7 @@
 #include <tvm/relay/type.h>
 #include "raf/type.h"
 #include "../schema/memory.h"
+#include "../schema/ufunc.h"
 #include "./utils.h"
 #include "../../common/shape_utils.h"
 
@@ -64,5 +65,14 @@ Type DefuseTensorInfer(const CallValues& value) {
 
 RAF_OP_TYPE("raf.op.defuse_tensor", "DefuseTensor", DefuseTensorInfer);
 
+Type MemoryHintInfer(const CallValues& value) {
+  const auto* args = value->args.as<UnaryArgs>();
+  CHECK(args != nullptr);
+  return GetType(args->x);
+}
+
+RAF_OP_TYPE("raf.op.memory_prefetch", "MemoryPrefetch", MemoryHintInfer);
+RAF_OP_TYPE("raf.op.memory_evict", "MemoryEvict", MemoryHintInfer);
+
 }  // namespace op
 }  // namespace raf
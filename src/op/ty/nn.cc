@@ -291,6 +291,35 @@ Type BatchNormTrainDxwbInfer(const CallValues& value) {
 
 RAF_OP_TYPE("raf.op.batch_norm_train_dxwb", "BatchNormTrainDxwb", BatchNormTrainDxwbInfer);
 
+Type BatchNormAddReluTrainInfer(const CallValues& value) {
+  const auto* args = value->args.as<BatchNormAddReluArgs>();
+  CHECK(args != nullptr);
+  TensorType x = Downcast<TensorType>(GetType(args->x));
+  TensorType running_mean = Downcast<TensorType>(GetType(args->running_mean));
+  TensorType running_var = Downcast<TensorType>(GetType(args->running_var));
+  PrimExpr size = Integer(1);
+  for (const PrimExpr& dim : x->shape) {
+    size = size * dim;
+  }
+  TensorType mask({tvm::floordiv(size + 31, 32)}, DataType::Int(32));
+  return TupleType({x, running_mean, running_var, mask});
+}
+
+RAF_OP_TYPE("raf.op._contrib_batch_norm_add_relu_train", "ContribBatchNormAddReluTrain",
+            BatchNormAddReluTrainInfer);
+
+Type BatchNormAddReluTrainDxwbInfer(const CallValues& value) {
+  const auto* args = value->args.as<BatchNormAddReluDxwbArgs>();
+  CHECK(args != nullptr);
+  TensorType dx = Downcast<TensorType>(GetType(args->x));
+  TensorType dw = Downcast<TensorType>(GetType(args->w));
+  TensorType db = Downcast<TensorType>(GetType(args->b));
+  return TupleType({dx, dw, db, dx});
+}
+
+RAF_OP_TYPE("raf.op._contrib_batch_norm_add_relu_train_dxwb", "ContribBatchNormAddReluTrainDxwb",
+            BatchNormAddReluTrainDxwbInfer);
+
 Type BiasAddInfer(const CallValues& value) {
   const auto* args = value->args.as<BiasAddArgs>();
   return GetType(args->x);
@@ -340,6 +369,137 @@ Type ContribDropoutDxInfer(const CallValues& value) {
 
 RAF_OP_TYPE("raf.op._contrib_dropout_dx", "ContribDropoutDx", ContribDropoutDxInfer);
 
+Type PhiloxDropoutInfer(const CallValues& value) {
+  const auto* args = value->args.as<PhiloxDropoutArgs>();
+  CHECK(args != nullptr);
+  return GetType(args->x);
+}
+
+RAF_OP_TYPE("raf.op._contrib_philox_dropout", "ContribPhiloxDropout", PhiloxDropoutInfer);
+
+Type PhiloxDropoutDxInfer(const CallValues& value) {
+  const auto* args = value->args.as<PhiloxDropoutDxArgs>();
+  CHECK(args != nullptr);
+  return GetType(args->dy);
+}
+
+RAF_OP_TYPE("raf.op._contrib_philox_dropout_dx", "ContribPhiloxDropoutDx", PhiloxDropoutDxInfer);
+
+Type AttentionInfer(const CallValues& value) {
+  const auto* args = value->args.as<AttentionArgs>();
+  CHECK(args != nullptr);
+  TensorType q = Downcast<TensorType>(GetType(args->q));
+  TensorType k = Downcast<TensorType>(GetType(args->k));
+  TensorType v = Downcast<TensorType>(GetType(args->v));
+  CHECK(q->shape.size() == 3 && k->shape.size() == 3 && v->shape.size() == 3)
+      << "Expected q, k and v in the shape of [batch, seq, dim]";
+  CHECK(TypeCheckCompare(q->shape[2], k->shape[2], std::equal_to<int>()))
+      << "The head dimensions of q and k mismatch";
+  CHECK(TypeCheckCompare(k->shape[1], v->shape[1], std::equal_to<int>()))
+      << "The sequence lengths of k and v mismatch";
+  return TensorType({q->shape[0], q->shape[1], v->shape[2]}, q->dtype);
+}
+
+RAF_OP_TYPE("raf.op._contrib_attention", "ContribAttention", AttentionInfer);
+
+Type AttentionDxInfer(const CallValues& value) {
+  const auto* args = value->args.as<AttentionDxArgs>();
+  CHECK(args != nullptr);
+  return TupleType({GetType(args->q), GetType(args->k), GetType(args->v)});
+}
+
+RAF_OP_TYPE("raf.op._contrib_attention_dx", "ContribAttentionDx", AttentionDxInfer);
+
+Type KvCacheAppendInfer(const CallValues& value) {
+  const auto* args = value->args.as<KvCacheAppendArgs>();
+  CHECK(args != nullptr);
+  TensorType cache = Downcast<TensorType>(GetType(args->cache));
+  TensorType x = Downcast<TensorType>(GetType(args->x));
+  CHECK(cache->shape.size() == 3 && x->shape.size() == 3)
+      << "Expected cache and x in the shape of [batch, seq, dim]";
+  CHECK(TypeCheckCompare(cache->shape[2], x->shape[2], std::equal_to<int>()))
+      << "The dimensions of cache and x mismatch";
+  return cache;
+}
+
+RAF_OP_TYPE("raf.op._contrib_kv_cache_append", "ContribKvCacheAppend", KvCacheAppendInfer);
+
+template <bool dequantize>
+Type QuantizeInfer(const CallValues& value) {
+  const auto* args = value->args.as<QuantizeArgs>();
+  CHECK(args != nullptr);
+  TensorType x = Downcast<TensorType>(GetType(args->x));
+  TensorType scale = Downcast<TensorType>(GetType(args->scale));
+  CHECK_LE(scale->shape.size(), 1U) << "Expected the scale to be a scalar or a 1-D tensor";
+  return TensorType(x->shape, dequantize ? DataType::Float(32) : DataType::Int(8));
+}
+
+RAF_OP_TYPE("raf.op._contrib_quantize", "ContribQuantize", QuantizeInfer<false>);
+RAF_OP_TYPE("raf.op._contrib_dequantize", "ContribDequantize", QuantizeInfer<true>);
+
+Type QuantizedDenseInfer(const CallValues& value) {
+  const auto* args = value->args.as<QuantizedDenseArgs>();
+  CHECK(args != nullptr);
+  TensorType x = Downcast<TensorType>(GetType(args->x));
+  TensorType w = Downcast<TensorType>(GetType(args->w));
+  CHECK(x->shape.size() == 2 && w->shape.size() == 2)
+      << "Expected x and w in the shape of [m, k] and [n, k]";
+  CHECK(TypeCheckCompare(x->shape[1], w->shape[1], std::equal_to<int>()))
+      << "The reduction dimensions of x and w mismatch";
+  return TensorType({x->shape[0], w->shape[0]}, DataType::Float(32));
+}
+
+RAF_OP_TYPE("raf.op._contrib_quantized_dense", "ContribQuantizedDense", QuantizedDenseInfer);
+
+template <bool dequantize>
+Type QuantizeFp8Infer(const CallValues& value) {
+  const auto* args = value->args.as<QuantizeFp8Args>();
+  CHECK(args != nullptr);
+  TensorType x = Downcast<TensorType>(GetType(args->x));
+  return TensorType(x->shape, dequantize ? DataType::Float(32) : DataType::UInt(8));
+}
+
+RAF_OP_TYPE("raf.op._contrib_quantize_fp8", "ContribQuantizeFp8", QuantizeFp8Infer<false>);
+RAF_OP_TYPE("raf.op._contrib_dequantize_fp8", "ContribDequantizeFp8", QuantizeFp8Infer<true>);
+
+Type Fp8DenseInfer(const CallValues& value) {
+  const auto* args = value->args.as<Fp8DenseArgs>();
+  CHECK(args != nullptr);
+  TensorType x = Downcast<TensorType>(GetType(args->x));
+  TensorType w = Downcast<TensorType>(GetType(args->w));
+  CHECK(x->shape.size() == 2 && w->shape.size() == 2)
+      << "Expected x and w in the shape of [m, k] and [n, k]";
+  CHECK(TypeCheckCompare(x->shape[1], w->shape[1], std::equal_to<int>()))
+      << "The reduction dimensions of x and w mismatch";
+  DataType out_dtype(ir::String2DLDataType(args->out_dtype));
+  return TensorType({x->shape[0], w->shape[0]}, out_dtype);
+}
+
+RAF_OP_TYPE("raf.op._contrib_fp8_dense", "ContribFp8Dense", Fp8DenseInfer);
+
+Type UpdateFp8ScaleInfer(const CallValues& value) {
+  const auto* args = value->args.as<UpdateFp8ScaleArgs>();
+  CHECK(args != nullptr);
+  return TupleType({GetType(args->amax_history), GetType(args->scale)});
+}
+
+RAF_OP_TYPE("raf.op._contrib_update_fp8_scale", "ContribUpdateFp8Scale", UpdateFp8ScaleInfer);
+
+Type SparseDenseInfer(const CallValues& value) {
+  const auto* args = value->args.as<SparseDenseArgs>();
+  CHECK(args != nullptr);
+  TensorType x = Downcast<TensorType>(GetType(args->x));
+  TensorType w = Downcast<TensorType>(GetType(args->w));
+  TensorType meta = Downcast<TensorType>(GetType(args->meta));
+  CHECK(x->shape.size() == 2 && w->shape.size() == 2 && meta->shape.size() == 3)
+      << "Expected x, w and meta in the shape of [m, k], [n, k / 2] and [k / 64, n, 2]";
+  CHECK(TypeCheckCompare(x->shape[1], w->shape[1] * 2, std::equal_to<int>()))
+      << "The reduction dimensions of x and w mismatch";
+  return TensorType({x->shape[0], w->shape[0]}, x->dtype);
+}
+
+RAF_OP_TYPE("raf.op._contrib_sparse_dense", "ContribSparseDense", SparseDenseInfer);
+
 RAF_OP_TYPE("raf.op.layer_norm", "LayerNorm", GeneralAxisInfer<LayerNormArgs>);
 
 Type LayerNormDxbInfer(const CallValues& value) {
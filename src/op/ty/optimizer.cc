@@ -39,6 +39,19 @@ Type SgdInfer(const CallValues& value) {
 
 RAF_OP_TYPE("raf.op.sgd", "Sgd", SgdInfer);
 
+Type SparseSgdInfer(const CallValues& value) {
+  const auto* args = value->args.as<SparseSgdArgs>();
+  CHECK(args != nullptr);
+  TensorType x0 = Downcast<TensorType>(GetType(args->x));
+  TensorType v0 = Downcast<TensorType>(GetType(args->v));
+  Array<Type> res;
+  res.push_back(v0);
+  res.push_back(x0);
+  return TupleType(res);
+}
+
+RAF_OP_TYPE("raf.op.sparse_sgd", "SparseSgd", SparseSgdInfer);
+
 Type LansInfer(const CallValues& value) {
   const auto* args = value->args.as<LansArgs>();
   CHECK(args != nullptr);
@@ -53,5 +66,64 @@ Type LansInfer(const CallValues& value) {
 
 RAF_OP_TYPE("raf.op.lans", "Lans", LansInfer);
 
+template <typename TArgs, int kNumGroups>
+Type MultiTensorOptimInfer(const CallValues& value) {
+  const auto* args = value->args.as<TArgs>();
+  CHECK(args != nullptr);
+  CHECK(args->tensor_list.size() % (kNumGroups + args->master_weights) == 0);
+  Array<Type> res;
+  for (int i = 0; i < args->tensor_list.size(); ++i) {
+    res.push_back(Downcast<TensorType>(GetType(args->tensor_list[i])));
+  }
+  return TupleType(res);
+}
+
+RAF_OP_TYPE("raf.op.multi_sgd", "MultiSgd", (MultiTensorOptimInfer<MultiSgdArgs, 3>));
+RAF_OP_TYPE("raf.op.adamw", "Adamw", (MultiTensorOptimInfer<AdamwArgs, 4>));
+RAF_OP_TYPE("raf.op.lamb", "Lamb", (MultiTensorOptimInfer<LambArgs, 4>));
+
+Type MultiTensorL2normInfer(const CallValues& value) {
+  const auto* args = value->args.as<MultiTensorL2normArgs>();
+  CHECK(args != nullptr);
+  int64_t ntensors = args->tensor_list.size();
+  auto dtype = tvm::runtime::DataType::Float(32);
+  return TupleType({TensorType({Integer(ntensors)}, dtype), TensorType({}, dtype)});
+}
+
+RAF_OP_TYPE("raf.op.multi_tensor_l2norm", "MultiTensorL2norm", MultiTensorL2normInfer);
+
+Type MultiTensorClipInfer(const CallValues& value) {
+  const auto* args = value->args.as<MultiTensorClipArgs>();
+  CHECK(args != nullptr);
+  Array<Type> res;
+  for (const auto& t : args->tensor_list) {
+    res.push_back(Downcast<TensorType>(GetType(t)));
+  }
+  return TupleType(res);
+}
+
+RAF_OP_TYPE("raf.op.multi_tensor_clip", "MultiTensorClip", MultiTensorClipInfer);
+
+Type MultiTensorUnscaleInfer(const CallValues& value) {
+  const auto* args = value->args.as<MultiTensorUnscaleArgs>();
+  CHECK(args != nullptr);
+  Array<Type> res;
+  for (const auto& t : args->tensor_list) {
+    res.push_back(Downcast<TensorType>(GetType(t)));
+  }
+  res.push_back(TensorType({}, tvm::runtime::DataType::Float(32)));
+  return TupleType(res);
+}
+
+RAF_OP_TYPE("raf.op.multi_tensor_unscale", "MultiTensorUnscale", MultiTensorUnscaleInfer);
+
+Type UpdateLossScaleInfer(const CallValues& value) {
+  const auto* args = value->args.as<UpdateLossScaleArgs>();
+  CHECK(args != nullptr);
+  return TupleType({GetType(args->loss_scale), GetType(args->growth_tracker)});
+}
+
+RAF_OP_TYPE("raf.op.update_loss_scale", "UpdateLossScale", UpdateLossScaleInfer);
+
 }  // namespace op
 }  // namespace raf
@@ -158,6 +158,14 @@ Type ReduceOutSameDType(const CallValues& value) {
   return TensorType(shape, x->dtype);
 }
 
+Type MomentsInfer(const CallValues& value) {
+  const auto* args = value->args.as<ReduceArgs>();
+  CHECK(args != nullptr);
+  TensorType x = Downcast<TensorType>(GetType(args->x));
+  Array<PrimExpr> shape = GenerateReduceShape(args, x);
+  return TupleType({TensorType(shape, x->dtype), TensorType(shape, x->dtype)});
+}
+
 Type ProdDxDType(const CallValues& value) {
   const auto* args = value->args.as<ProdDxArgs>();
   CHECK(args != nullptr);
@@ -183,6 +191,7 @@ RAF_OP_TYPE("raf.op.prod", "Prod", ReduceOutSameDType);
 RAF_OP_TYPE("raf.op.mean", "Mean", ReduceOutSameDType);
 RAF_OP_TYPE("raf.op.prod_dx", "ProdDx", ProdDxDType);
 RAF_OP_TYPE("raf.op.mean_dx", "MeanDx", MeanDxInfer);
+RAF_OP_TYPE("raf.op.moments", "Moments", MomentsInfer);
 
 Type L2NormDType(const CallValues& value) {
   const auto* args = value->args.as<schema::L2NormArgs>();
@@ -328,6 +328,22 @@ Type EmbeddingDxInfer(const CallValues& value) {
 
 RAF_OP_TYPE("raf.op.embedding_dx", "EmbeddingDx", EmbeddingDxInfer);
 
+Type EmbeddingSparseDxInfer(const CallValues& value) {
+  const auto* args = value->args.as<EmbeddingDxArgs>();
+  CHECK(args != nullptr);
+  TensorType dy = Downcast<TensorType>(GetType(args->dy));
+  TensorType indices = Downcast<TensorType>(GetType(args->indices));
+  PrimExpr n = Integer(1);
+  for (const auto& s : indices->shape) {
+    n = n * s;
+  }
+  TensorType rows = TensorType({n}, DataType::Int(64));
+  TensorType values = TensorType({n, dy->shape[dy->shape.size() - 1]}, dy->dtype);
+  return TupleType({rows, values});
+}
+
+RAF_OP_TYPE("raf.op.embedding_sparse_dx", "EmbeddingSparseDx", EmbeddingSparseDxInfer);
+
 Type ConcatenateInfer(const CallValues& value) {
   const auto* args = value->args.as<ConcatenateArgs>();
   CHECK(args != nullptr);
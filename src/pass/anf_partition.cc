@@ -324,9 +324,8 @@ Pass PartitionANF(int max_num_ops) {
   TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
                                                                              PassContext pc) {
     Var boundary = anf_partition::GetPartitionBoundary(f);
-    auto analyzer = liveness_analysis::LivenessAnalyzer(f);
-    analyzer.Run();
-    anf_partition::Partitioner partitioner(max_num_ops, boundary, analyzer);
+    auto analyzer = liveness_analysis::GetLivenessAnalyzer(f);
+    anf_partition::Partitioner partitioner(max_num_ops, boundary, *analyzer);
     return Downcast<Function>(partitioner(f));
   };
   return CreateRAFFunctionPass(pass_func, 0, "PartitionANF", {});
@@ -9,6 +9,7 @@
  */
 #include <tvm/ir/transform.h>
 
+#include <functional>
 #include <stack>
 #include "raf/op.h"
 #include "raf/cache.h"
@@ -68,6 +69,9 @@ inline Expr GenCastCall(Expr expr, DataType dtype) {
     case DataType::kFloat:
       target_dtype = "float";
       break;
+    case DataType::kBFloat:
+      target_dtype = "bfloat";
+      break;
     case DataType::kUInt:
       target_dtype = "uint";
       break;
@@ -143,20 +147,155 @@ struct CastCacheHash {
 struct CastCacheEqual {
   bool operator()(const std::pair<Expr, TypeHint>& pair1,
                   const std::pair<Expr, TypeHint>& pair2) const {
-    // When two pairs have the same hash key, we simply check if their expr is the same.
-    return ObjectPtrEqual()(pair1.first, pair2.first);
+    // The same expr may be casted to different dtypes, so the type hints have to be compared
+    // as well. They are compared by value because they are different objects.
+    return ObjectPtrEqual()(pair1.first, pair2.first) &&
+           TypeHintHash(pair1.second).byte_vector == TypeHintHash(pair2.second).byte_vector;
   }
 };
 
 using CastCache =
     std::unordered_map<std::pair<Expr, TypeHint>, Expr, CastCacheHash, CastCacheEqual>;
 
+/*! \brief Whether the dtype is a floating point type that AutoCast may change. */
+inline bool IsFloatDType(const DataType& dtype) {
+  return dtype.is_float() || dtype.is_bfloat16();
+}
+
+/*! \brief The cast policy of an op, which overrides its registered FRAFCastRule. */
+enum class CastPolicy {
+  /*! \brief Cast all floating arguments to the AMP dtype. */
+  kAlways,
+  /*! \brief Keep all arguments in their original dtypes. */
+  kNever,
+  /*! \brief Follow the dtype of the majority of floating arguments. */
+  kInfer,
+};
+
+using CastPolicyMap = std::unordered_map<std::string, CastPolicy>;
+
+/*!
+ * \brief Parse the cast policies in the form of "op:policy,op:policy", where op is an op name
+ * with or without the "raf.op." prefix, and policy is one of always, never and infer.
+ */
+CastPolicyMap ParseCastPolicies(const std::string& str) {
+  static const std::unordered_map<std::string, CastPolicy> policies = {
+      {"always", CastPolicy::kAlways},
+      {"never", CastPolicy::kNever},
+      {"infer", CastPolicy::kInfer},
+  };
+  CastPolicyMap ret;
+  std::stringstream ss(str);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    if (item.empty()) {
+      continue;
+    }
+    auto pos = item.find(':');
+    CHECK(pos != std::string::npos)
+        << "Expected op:policy in raf.amp.cast_policy, but got " << item;
+    std::string op_name = item.substr(0, pos);
+    std::string policy = item.substr(pos + 1);
+    CHECK_GT(policies.count(policy), 0)
+        << "Unknown cast policy " << policy << " of " << op_name
+        << ". Expected always, never or infer";
+    if (op_name.find("raf.op.") != 0) {
+      op_name = "raf.op." + op_name;
+    }
+    // Make sure the op exists.
+    Op::Get(op_name);
+    ret[op_name] = policies.at(policy);
+  }
+  return ret;
+}
+
+/*!
+ * \brief Generate the type hint of the given type, which casts floating tensors to the target
+ * dtype and keeps the others. A void target dtype means don't touch.
+ */
+TypeHint GenTypeHintOfType(const Type& type, const DataType& target_dtype) {
+  if (auto tuple_type = type.as<TupleTypeNode>()) {
+    TypeHints fields;
+    for (const auto& field : tuple_type->fields) {
+      fields.push_back(GenTypeHintOfType(field, target_dtype));
+    }
+    return TupleType(fields);
+  }
+  auto ttype = type.as<TensorTypeNode>();
+  CHECK(ttype != nullptr) << "Unsupported argument type: " << type->GetTypeKey();
+  return PrimType(IsFloatDType(ttype->dtype) ? target_dtype : ttype->dtype);
+}
+
+/*! \brief Whether all tensors of the given type are in the given dtype. */
+bool CheckDType(const Type& type, const DataType& dtype) {
+  if (auto tuple_type = type.as<TupleTypeNode>()) {
+    for (const auto& field : tuple_type->fields) {
+      if (!CheckDType(field, dtype)) {
+        return false;
+      }
+    }
+    return true;
+  }
+  auto ttype = type.as<TensorTypeNode>();
+  return ttype != nullptr && ttype->dtype == dtype;
+}
+
+/*!
+ * \brief Whether the argument can be casted by a cast policy. Constant arguments are attributes,
+ * so only the tensors and tuples of tensors bound to vars are castable.
+ */
+bool IsCastableArg(const Expr& arg) {
+  if (!arg->IsInstance<VarNode>()) {
+    return false;
+  }
+  std::function<bool(const Type&)> is_tensor = [&](const Type& type) {
+    if (auto tuple_type = type.as<TupleTypeNode>()) {
+      for (const auto& field : tuple_type->fields) {
+        if (!is_tensor(field)) {
+          return false;
+        }
+      }
+      return true;
+    }
+    return type->IsInstance<TensorTypeNode>();
+  };
+  return is_tensor(arg->checked_type());
+}
+
+/*! \brief Generate the type hints of a call following the given cast policy. */
+TypeHints GenPolicyTypeHints(CastPolicy policy, const Array<Expr>& args, const Type& ret_type,
+                             const DataType& amp_dtype) {
+  DataType target_dtype = DataType::Void();
+  if (policy == CastPolicy::kAlways) {
+    target_dtype = amp_dtype;
+  } else if (policy == CastPolicy::kInfer && !ret_type->IsInstance<TupleTypeNode>()) {
+    int n_amp = 0, n_fp32 = 0;
+    for (const auto& arg : args) {
+      if (IsCastableArg(arg)) {
+        n_amp += CheckDType(arg->checked_type(), amp_dtype);
+        n_fp32 += CheckDType(arg->checked_type(), DataType::Float(32));
+      }
+    }
+    target_dtype = (n_fp32 > n_amp) ? DataType::Float(32) : amp_dtype;
+  }
+  TypeHints type_hints;
+  for (const auto& arg : args) {
+    type_hints.push_back(IsCastableArg(arg) ? GenTypeHintOfType(arg->checked_type(), target_dtype)
+                                            : GetDontTouchTypeHint());
+  }
+  return type_hints;
+}
+
 class AutoCastMutator : public ExprMutator {
  public:
-  AutoCastMutator(const String amp_dtype, const String out_dtype) {
+  AutoCastMutator(const String amp_dtype, const String out_dtype, CastPolicyMap policies,
+                  bool share_injective_cast)
+      : policies_(std::move(policies)), share_injective_cast_(share_injective_cast) {
     scopes_.emplace_back(new LetList);
     amp_dtype_ = DataType(String2DLDataType(amp_dtype));
     out_dtype_ = DataType(String2DLDataType(out_dtype));
+    CHECK(amp_dtype_ == DataType::Float(16) || amp_dtype_ == DataType::BFloat(16))
+        << "Expected float16 or bfloat16 as the AMP dtype, but got " << amp_dtype;
   }
 
   /*!
@@ -217,6 +356,7 @@ class AutoCastMutator : public ExprMutator {
 
       curr_let_->checked_type_ = new_type;
       scope->Push(curr_let_, new_value);
+      var_scopes_[curr_let_] = scopes_.size() - 1;
       let_vars_to_orig_type_.emplace(curr_let_, node->value->checked_type());
       let_vars_.emplace(curr_let_, new_value);
 
@@ -247,8 +387,8 @@ class AutoCastMutator : public ExprMutator {
         if (arg_call && arg_call->op->IsInstance<OpNode>()) {
           auto arg_op = arg_call->op.as<OpNode>();
           if (GetRef<Op>(arg_op) == cast_op) {
-            auto orig_dtype = arg_call->args[0]->checked_type().as<TensorTypeNode>()->dtype.code();
-            if (orig_dtype == DataType::kFloat) {
+            auto orig_dtype = arg_call->args[0]->checked_type().as<TensorTypeNode>()->dtype;
+            if (IsFloatDType(orig_dtype)) {
               uncasted_call_args.push_back(arg_call->args[0]);
               continue;
             }
@@ -292,9 +432,10 @@ class AutoCastMutator : public ExprMutator {
     }
 
     // If the fusion pattern of this op is elementwise or broadcast, we disable the cache
-    // to make sure they their argument cast op will not be reused and can fused together.
+    // to make sure they their argument cast op will not be reused and can fused together,
+    // unless the casts are required to be shared by all consumers.
     // TODO(comaniac): Let the recompute or fusion pass work on this.
-    bool use_cache = pattern > kInjective;
+    bool use_cache = share_injective_cast_ || pattern > kInjective;
 
     Array<Expr> call_args;
     for (size_t i = 0; i < node->args.size(); ++i) {
@@ -344,14 +485,19 @@ class AutoCastMutator : public ExprMutator {
       return GetRef<Expr>(node);
     }
 
+    // The body of the function is in a new scope, where the casts of its parameters and
+    // constants are placed so that they can be shared by all nested scopes.
+    func_scopes_.push_back(scopes_.size());
     Array<Var> params;
     Array<Type> param_types;
     for (const auto& p : node->params) {
       Var param = Downcast<Var>(VisitExpr(p));
       params.push_back(param);
       param_types.push_back(param->checked_type());
+      var_scopes_[param] = func_scopes_.back();
     }
     Expr body = VisitExpr(node->body);
+    func_scopes_.pop_back();
     Type ret_type = body->checked_type();
     Function func(params, body, ret_type, node->type_params, node->attrs);
     func->checked_type_ = FuncType(param_types, ret_type, node->type_params, {});
@@ -425,6 +571,10 @@ class AutoCastMutator : public ExprMutator {
         << "AutoCast does not support closure yet: " << raf::ir::AsText(op_node);
     const Op op = Downcast<Op>(op_node);
 
+    auto it = policies_.find(op->name);
+    if (it != policies_.end()) {
+      return GenPolicyTypeHints(it->second, args, ret_type, target_dtype);
+    }
     if (frule.count(op)) {
       return frule[op](args, ret_type, DLDataType2String(target_dtype));
     } else {
@@ -443,6 +593,24 @@ class AutoCastMutator : public ExprMutator {
     return expr;
   }
 
+  /*!
+   * \brief Get the scope to place the shared cast of the given expr, which is the scope defining
+   * the expr, so that the cast can be reused by all consumers of the expr in the function,
+   * including the ones in nested scopes (e.g., if-branches).
+   */
+  LetList* GetCastScope(const Expr& expr) {
+    size_t idx = scopes_.size() - 1;
+    if (auto var = expr.as<VarNode>()) {
+      auto it = var_scopes_.find(GetRef<Var>(var));
+      if (it != var_scopes_.end()) {
+        idx = std::min(idx, it->second);
+      }
+    } else if (expr->IsInstance<ConstantNode>() && !func_scopes_.empty()) {
+      idx = std::min(idx, func_scopes_.back());
+    }
+    return scopes_[idx].get();
+  }
+
   /*! \brief Generate a tuple of casted tensors. */
   Expr CastTuple(const Expr arg, const TypeHint type_hint, bool use_cache = true) {
     auto scope = scopes_.back().get();
@@ -590,7 +758,8 @@ class AutoCastMutator : public ExprMutator {
     }
 
     auto cast_call = GenCastCall(expr, target_dtype);
-    auto new_var = scope->Push(cast_call);
+    // A cached cast is placed in the scope defining the expr so that it can be shared.
+    auto new_var = (use_cache ? GetCastScope(expr) : scope)->Push(cast_call);
     new_var->checked_type_ = cast_call->checked_type_;
     if (use_cache) {
       // If not using cache, then we make sure this new cast op is only used by one op.
@@ -619,20 +788,37 @@ class AutoCastMutator : public ExprMutator {
   std::unordered_map<Var, Type, ObjectPtrHash, ObjectPtrEqual> let_vars_to_orig_type_;
   /*! \brief Map from ops that the miss casting rule to appearance. */
   std::unordered_map<Op, int, ObjectPtrHash, ObjectPtrEqual> miss_rule_ops_;
+  /*! \brief The index in the scope stack of the scope defining each var. */
+  std::unordered_map<Var, size_t, ObjectPtrHash, ObjectPtrEqual> var_scopes_;
+  /*! \brief The index in the scope stack of the body scope of each visiting function. */
+  std::vector<size_t> func_scopes_;
+  /*! \brief The cast policies overriding the registered cast rules. */
+  CastPolicyMap policies_;
+  /*! \brief Whether the injective ops share the casts of their arguments. */
+  bool share_injective_cast_;
 };
 }  // namespace auto_cast
 
 TVM_REGISTER_PASS_CONFIG_OPTION("raf.amp.dtype", String);
 TVM_REGISTER_PASS_CONFIG_OPTION("raf.amp.out_dtype", String);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.amp.cast_policy", String);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.amp.share_injective_cast", Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.amp.eliminate_cast", Bool);
 
 Pass AutoCast() {
   PassContext pass_ctx = PassContext::Current();
   String amp_dtype = pass_ctx->GetConfig("raf.amp.dtype", String("float16")).value();
-  String out_dtype = pass_ctx->GetConfig("raf.amp.out_dtype", String("float16")).value();
+  // The outputs are in the AMP dtype by default.
+  String out_dtype = pass_ctx->GetConfig("raf.amp.out_dtype", amp_dtype).value();
+  String cast_policy = pass_ctx->GetConfig("raf.amp.cast_policy", String("")).value();
+  bool share_injective_cast =
+      pass_ctx->GetConfig("raf.amp.share_injective_cast", Bool(false)).value();
+  auto policies = auto_cast::ParseCastPolicies(cast_policy);
   DLOG(INFO) << "AMP dtype: " << amp_dtype << ", output dtype: " << out_dtype;
   TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
                                                                              PassContext pc) {
-    auto mutator = auto_cast::AutoCastMutator(amp_dtype, out_dtype);
+    auto mutator =
+        auto_cast::AutoCastMutator(amp_dtype, out_dtype, policies, share_injective_cast);
     auto ret = mutator.Mutate(f);
     std::string miss_rule_op_str = mutator.ListMissRuleOps();
     if (!miss_rule_op_str.empty()) {
@@ -642,7 +828,11 @@ Pass AutoCast() {
     return Downcast<Function>(ret);
   };
   auto insert_cast = CreateRAFFunctionPass(pass_func, 0, "AutoCastFunc", {});
-  return RAFSequential({InferType(), insert_cast, InferType(), DeadCodeElimination()}, "AutoCast");
+  Array<Pass> passes = {InferType(), insert_cast, InferType(), DeadCodeElimination()};
+  if (pass_ctx->GetConfig("raf.amp.eliminate_cast", Bool(true)).value()) {
+    passes.push_back(EliminateCast());
+  }
+  return RAFSequential(passes, "AutoCast");
 }
 
 RAF_REGISTER_GLOBAL("raf.pass_.AutoCast").set_body_typed(AutoCast);
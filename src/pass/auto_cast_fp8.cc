@@ -0,0 +1,142 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file auto_cast_fp8.cc
+ * \brief Cast the inputs of the dense layers to FP8 with the delayed scaling, i.e., each input is
+ * quantized by the scale from the amaxes of the previous steps, and the amax of this step is
+ * pushed into the history on the device, so that no host synchronization is required.
+ */
+#include <string>
+#include <vector>
+#include "raf/op.h"
+#include "raf/op_utils.h"
+#include "raf/ir.h"
+#include "raf/ir_ext.h"
+#include "raf/value.h"
+#include "raf/pass.h"
+#include "./let_list.h"
+
+namespace raf {
+namespace pass {
+namespace auto_cast_fp8 {
+
+using namespace raf::ir;
+using namespace raf::op;
+using namespace raf::value;
+
+inline bool IsFloat(const Expr& expr) {
+  const auto* type = expr->checked_type_.as<TensorTypeNode>();
+  return type != nullptr && type->shape.size() == 2U &&
+         (type->dtype == DataType::Float(16) || type->dtype == DataType::Float(32));
+}
+
+/*! \brief Whether the expr is a dense, i.e., x * w^T, of the float16 or float32 matrices. */
+inline bool IsFp8Castable(const Expr& expr) {
+  static const Op& dense = Op::Get("raf.op.dense");
+  static const Op& matmul_nt = Op::Get("raf.op.matmul_nt");
+  const auto* call = expr.as<CallNode>();
+  return call != nullptr && (call->op == dense || call->op == matmul_nt) &&
+         call->args.size() == 2U && IsFloat(call->args[0]) && IsFloat(call->args[1]);
+}
+
+inline Expr MakeFalse() {
+  return MakeConstant(BoolValue::make(false));
+}
+
+/*! \brief The amax history and the scale of an FP8 input. */
+struct Fp8State {
+  Var amax_history;
+  Var scale;
+};
+
+class FP8Caster {
+ public:
+  FP8Caster(int history_len, int margin) : history_len_(history_len), margin_(margin) {
+    CHECK_GT(history_len, 0) << "The amax history cannot be empty";
+  }
+
+  Function Run(const Function& func) {
+    static const Op& quantize = Op::Get("raf.op._contrib_quantize_fp8");
+    static const Op& fp8_dense = Op::Get("raf.op._contrib_fp8_dense");
+    Array<Var> params = func->params;
+    int index = 0;
+    Expr body = LetList::With([&](LetList* ll) {
+      Expr expr = func->body;
+      while (const auto* let = expr.as<LetNode>()) {
+        expr = let->body;
+        if (!IsFp8Castable(let->value)) {
+          ll->Push(let->var, let->value);
+          continue;
+        }
+        const auto* call = let->value.as<CallNode>();
+        std::string suffix = std::to_string(index++);
+        Fp8State x_state = MakeState("fp8_x_", suffix);
+        Fp8State w_state = MakeState("fp8_w_", suffix);
+        for (const auto& state : {x_state, w_state}) {
+          params.push_back(state.amax_history);
+          params.push_back(state.scale);
+        }
+        const Expr& x = call->args[0];
+        const Expr& w = call->args[1];
+        Var qx = ll->Push(Call(quantize, {x, x_state.scale, MakeFalse()}));
+        Var qw = ll->Push(Call(quantize, {w, w_state.scale, MakeFalse()}));
+        DataType dtype = Downcast<TensorType>(let->value->checked_type())->dtype;
+        Expr out_dtype = MakeConstant(StringValue::make(DLDataType2String(dtype)));
+        ll->Push(let->var, Call(fp8_dense, {qx, qw, x_state.scale, w_state.scale, out_dtype,
+                                            MakeFalse(), MakeFalse()}));
+        // The states are updated after they are read by the dense.
+        PushUpdate(ll, x, x_state);
+        PushUpdate(ll, w, w_state);
+      }
+      return expr;
+    });
+    return Function(params, body, func->ret_type, func->type_params, func->attrs);
+  }
+
+ private:
+  Fp8State MakeState(const std::string& prefix, const std::string& suffix) {
+    Fp8State state;
+    state.amax_history = MakeVar(prefix + "amax_history_" + suffix,
+                                 TensorType({Integer(history_len_)}, DataType::Float(32)));
+    state.scale = MakeVar(prefix + "scale_" + suffix, TensorType({}, DataType::Float(32)));
+    return state;
+  }
+
+  void PushUpdate(LetList* ll, const Expr& x, const Fp8State& state) {
+    static const Op& abs = Op::Get("raf.op.abs");
+    static const Op& max = Op::Get("raf.op.max");
+    static const Op& cast = Op::Get("raf.op.cast");
+    static const Op& update = Op::Get("raf.op._contrib_update_fp8_scale");
+    Var abs_x = ll->Push(Call(abs, {x}));
+    Expr axes = MakeConstant(ArrayToIntTuple(std::vector<int64_t>{}));
+    Var amax = ll->Push(Call(max, {abs_x, axes, MakeFalse(), MakeFalse()}));
+    if (Downcast<TensorType>(x->checked_type())->dtype != DataType::Float(32)) {
+      amax = ll->Push(Call(cast, {amax, MakeConstant(StringValue::make("float32"))}));
+    }
+    Expr margin = MakeConstant(ScalarValue::make(static_cast<int64_t>(margin_)));
+    ll->Push(Call(update, {state.amax_history, state.scale, amax, MakeFalse(), margin}));
+  }
+
+  /*! \brief The length of the amax history. */
+  int history_len_;
+  /*! \brief The scales are multiplied by 2^margin. */
+  int margin_;
+};
+
+}  // namespace auto_cast_fp8
+
+Pass AutoCastFP8(int history_len, int margin) {
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
+                                                                             PassContext pc) {
+    return auto_cast_fp8::FP8Caster(history_len, margin).Run(f);
+  };
+  return CreateRAFFunctionPass(pass_func, 0, "AutoCastFP8", {"InferType"});
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.AutoCastFP8").set_body_typed(AutoCastFP8);
+
+}  // namespace pass
+}  // namespace raf
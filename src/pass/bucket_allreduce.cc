@@ -0,0 +1,662 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file bucket_allreduce.cc
+ * \brief Group the allreduce of gradients and the allgather of ZeRO weight shards into size-based
+ * buckets, and lay out the gradients of each bucket contiguously so that the bucket is reduced
+ * without packing and unpacking.
+ */
+#include <algorithm>
+#include <vector>
+
+#include "raf/op.h"
+#include "raf/op_utils.h"
+#include "raf/ir.h"
+#include "raf/ir_ext.h"
+#include "raf/value.h"
+#include "raf/pass.h"
+#include "./common.h"
+#include "../common/shape_utils.h"
+
+namespace raf {
+namespace pass {
+namespace bucket_allreduce {
+
+using namespace raf::ir;
+using namespace raf::value;
+using common::shape_utils::BytesCompactTensor;
+
+template <typename T>
+using StdMap = std::unordered_map<Var, T, ObjectPtrHash, ObjectPtrEqual>;
+using VSet = std::unordered_set<Var, ObjectPtrHash, ObjectPtrEqual>;
+
+/*! \brief Whether the given expression is an allreduce op, including its dialect ops. */
+inline bool IsAllReduceOp(const Expr& op) {
+  static const op::OpSet allreduce_ops = {Op::Get("raf.op._allreduce")};
+  return op::IsInOpSet(op, allreduce_ops);
+}
+
+/*! \brief Whether the given expression is an allgather op, including its dialect ops. */
+inline bool IsAllGatherOp(const Expr& op) {
+  static const op::OpSet allgather_ops = {Op::Get("raf.op._allgather")};
+  return op::IsInOpSet(op, allgather_ops);
+}
+
+/*! \brief An allreduce or allgather of a single tensor, which can be put into a bucket. */
+struct BucketMember {
+  /*! \brief The binded variable of the collective. */
+  Var out;
+  /*! \brief The original collective call. */
+  Call call;
+  /*! \brief The binded variable of the input tuple of allreduce, or undefined for allgather. */
+  Var in_tuple;
+  /*! \brief The tensor to be reduced. */
+  Var in;
+  /*! \brief The size of the tensor in bytes. */
+  int64_t size;
+};
+
+/*!
+ * \brief A mutator that merges consecutive allreduce ops of single tensors (e.g., the ones inserted
+ * by AutoDataParallel) into allreduce ops of buckets, each of which is up to the given size. The
+ * gradients are bucketed in the ANF order, which is the backward order. Ops that consume the
+ * results of a pending bucket are deferred until the bucket is issued. For example:
+ *
+ *   let %a1 = (%x1,);
+ *   let %g1 = raf.op._allreduce(%a1, "avg", nullptr);
+ *   let %a2 = (%x2,);
+ *   let %g2 = raf.op._allreduce(%a2, "avg", nullptr);
+ *
+ * becomes
+ *
+ *   let %bucket_in = (%x1, %x2);
+ *   let %bucket = raf.op._allreduce(%bucket_in, "avg", nullptr);
+ *   let %g1_out(share: %x1) = %bucket.0;
+ *   let %g1 = %g1_out;
+ *   let %g2_out(share: %x2) = %bucket.1;
+ *   let %g2 = %g2_out;
+ *
+ * A reduced gradient shares the memory with its local gradient if the local gradient is not used
+ * elsewhere, so that the bucket is reduced in place.
+ *
+ * The allgather ops along the first axis (e.g., of the updated weight shards with ZeRO) are
+ * bucketed likewise. The shards of a bucket are flattened and concatenated, so each rank
+ * contributes one row of the gathered bucket, which is then split back into the weights:
+ *
+ *   let %w1 = raf.op._allgather(%s1, 0, nullptr);
+ *   let %w2 = raf.op._allgather(%s2, 0, nullptr);
+ *
+ * becomes
+ *
+ *   let %bucket_in = raf.op.concatenate((reshape(%s1, [-1]), reshape(%s2, [-1])), 0);
+ *   let %bucket = raf.op._allgather(%bucket_in, 0, nullptr);
+ *   let %bucket_rows = raf.op.split(reshape(%bucket, [n, -1]), [size(%s1)], 1);
+ *   let %w1 = reshape(%bucket_rows.0, shape(%w1));
+ *   let %w2 = reshape(%bucket_rows.1, shape(%w2));
+ *
+ * Since the consumers of the weights are deferred only until their bucket is issued, the
+ * allgather of a bucket overlaps with the updates of the following buckets.
+ */
+class Bucketer {
+ public:
+  Bucketer(const Function& func, int64_t bucket_size)
+      : func_(func), ell_(ExplicitLetList::make(func->body)), bucket_size_(bucket_size) {
+  }
+
+  Function Run() {
+    for (size_t i = 0; i < ell_->vars.size(); ++i) {
+      defined_.insert(ell_->vars[i]);
+      if (ell_->exprs[i].as<TupleNode>()) {
+        tuple_defs_[ell_->vars[i]] = Downcast<Tuple>(ell_->exprs[i]);
+      }
+      for (const auto& var : FreeVars(ell_->exprs[i])) {
+        num_uses_[var]++;
+      }
+    }
+    num_uses_[ell_->ret]++;
+
+    for (size_t i = 0; i < ell_->vars.size(); ++i) {
+      const Var& var = ell_->vars[i];
+      const Expr& expr = ell_->exprs[i];
+      BucketMember member;
+      if (GetMember(var, expr, &member)) {
+        if (DependsOnPending(expr)) {
+          Flush();
+        }
+        if (!bucket_.empty() && (!Compatible(bucket_[0], member) ||
+                                 bucket_bytes_ + member.size > bucket_size_)) {
+          Flush();
+        }
+        bucket_.push_back(member);
+        bucket_bytes_ += member.size;
+        pending_.insert(var);
+      } else if (DependsOnPending(expr)) {
+        deferred_.push_back({var, expr});
+        pending_.insert(var);
+      } else {
+        Emit(var, expr);
+      }
+    }
+    Flush();
+
+    ExplicitLetList ell;
+    for (size_t i = 0; i < vars_.size(); ++i) {
+      if (!removed_[i]) {
+        ell.Push(vars_[i], exprs_[i]);
+      }
+    }
+    ell.ret = ell_->ret;
+    return Function(func_->params, ell.AsExpr(), func_->ret_type, func_->type_params,
+                    func_->attrs);
+  }
+
+ private:
+  /*! \brief Check whether a let binding is a collective of a single static-shaped tensor. */
+  bool GetMember(const Var& var, const Expr& expr, BucketMember* member) {
+    const auto* call = expr.as<CallNode>();
+    if (call != nullptr && IsAllGatherOp(call->op)) {
+      return GetAllGatherMember(var, call, member);
+    }
+    if (call == nullptr || !IsAllReduceOp(call->op) || call->args.size() != 3) {
+      return false;
+    }
+    const auto* in_tuple = call->args[0].as<VarNode>();
+    const auto* computation = call->args[1].as<ConstantNode>();
+    const auto* rank_list = call->args[2].as<ConstantNode>();
+    if (in_tuple == nullptr || computation == nullptr || rank_list == nullptr ||
+        rank_list->value.defined()) {
+      // Only the allreduce over all ranks are bucketed.
+      return false;
+    }
+    auto it = tuple_defs_.find(GetRef<Var>(in_tuple));
+    if (it == tuple_defs_.end() || it->second->fields.size() != 1 ||
+        num_uses_[GetRef<Var>(in_tuple)] != 1) {
+      return false;
+    }
+    const auto* in = it->second->fields[0].as<VarNode>();
+    const auto* ttype = in ? in->checked_type_.as<TensorTypeNode>() : nullptr;
+    if (ttype == nullptr) {
+      return false;
+    }
+    for (const auto& dim : ttype->shape) {
+      if (!dim.as<IntImmNode>()) {
+        return false;
+      }
+    }
+    *member = {var, GetRef<Call>(call), GetRef<Var>(in_tuple), GetRef<Var>(in),
+               BytesCompactTensor(ttype)};
+    return true;
+  }
+
+  /*! \brief Check whether a call is an allgather of a static-shaped tensor along the first axis. */
+  bool GetAllGatherMember(const Var& var, const CallNode* call, BucketMember* member) {
+    if (call->args.size() != 3) {
+      return false;
+    }
+    const auto* in = call->args[0].as<VarNode>();
+    const auto* axis = call->args[1].as<ConstantNode>();
+    const auto* rank_list = call->args[2].as<ConstantNode>();
+    if (in == nullptr || axis == nullptr || rank_list == nullptr || rank_list->value.defined() ||
+        !axis->value.as<IntValueObj>() || axis->value.as<IntValueObj>()->value != 0) {
+      return false;
+    }
+    const auto* ttype = in->checked_type_.as<TensorTypeNode>();
+    const auto* out_type = call->checked_type_.as<TensorTypeNode>();
+    if (ttype == nullptr || out_type == nullptr || !IsStatic(ttype) || !IsStatic(out_type) ||
+        ttype->shape[0].as<IntImmNode>()->value == 0) {
+      return false;
+    }
+    *member = {var, GetRef<Call>(call), Var(), GetRef<Var>(in), BytesCompactTensor(ttype)};
+    return true;
+  }
+
+  static bool IsStatic(const TensorTypeNode* ttype) {
+    for (const auto& dim : ttype->shape) {
+      if (!dim.as<IntImmNode>()) {
+        return false;
+      }
+    }
+    return !ttype->shape.empty();
+  }
+
+  /*! \brief Whether two collectives can be put into the same bucket. */
+  bool Compatible(const BucketMember& lhs, const BucketMember& rhs) {
+    if (lhs.call->op != rhs.call->op) {
+      return false;
+    }
+    if (!lhs.in_tuple.defined()) {
+      return lhs.in->checked_type().as<TensorTypeNode>()->dtype ==
+             rhs.in->checked_type().as<TensorTypeNode>()->dtype;
+    }
+    const auto* lhs_comp = lhs.call->args[1].as<ConstantNode>()->value.as<StringValueObj>();
+    const auto* rhs_comp = rhs.call->args[1].as<ConstantNode>()->value.as<StringValueObj>();
+    const auto* lhs_type = lhs.in->checked_type().as<TensorTypeNode>();
+    const auto* rhs_type = rhs.in->checked_type().as<TensorTypeNode>();
+    return lhs.call->op == rhs.call->op && lhs_comp && rhs_comp &&
+           lhs_comp->value == rhs_comp->value && lhs_type->dtype == rhs_type->dtype;
+  }
+
+  /*! \brief Whether an expression uses the results of the pending bucket or the deferred ops. */
+  bool DependsOnPending(const Expr& expr) {
+    for (const auto& var : FreeVars(expr)) {
+      if (pending_.count(var)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void Emit(const Var& var, const Expr& expr) {
+    if (expr.as<TupleNode>()) {
+      tuple_pos_[var] = vars_.size();
+    }
+    vars_.push_back(var);
+    exprs_.push_back(expr);
+    removed_.push_back(false);
+  }
+
+  /*! \brief Issue the pending bucket, followed by the deferred ops. */
+  void Flush() {
+    if (bucket_.size() == 1) {
+      Emit(bucket_[0].out, bucket_[0].call);
+    } else if (bucket_.size() > 1 && !bucket_[0].in_tuple.defined()) {
+      FlushAllGather();
+    } else if (bucket_.size() > 1) {
+      Array<Expr> ins;
+      for (const auto& member : bucket_) {
+        removed_[tuple_pos_.at(member.in_tuple)] = true;
+        ins.push_back(member.in);
+      }
+      Var bucket_in = MakeVar("bucket_in", {});
+      Emit(bucket_in, Tuple(ins));
+      const auto& call = bucket_[0].call;
+      Var bucket = MakeVar("bucket", {});
+      Emit(bucket, Call(call->op, {bucket_in, call->args[1], call->args[2]}));
+      for (size_t i = 0; i < bucket_.size(); ++i) {
+        const auto& member = bucket_[i];
+        // Reduce in place if the local gradient is not used elsewhere.
+        Var share = defined_.count(member.in) && num_uses_[member.in] == 1 ? member.in : Var();
+        Var out = MakeVar(member.out->name_hint() + "_out", {}, share);
+        Emit(out, TupleGetItem(bucket, i));
+        Emit(member.out, out);
+      }
+      DLOG(INFO) << "Bucketed " << bucket_.size() << " allreduce ops of " << bucket_bytes_
+                 << " bytes";
+    }
+    bucket_.clear();
+    bucket_bytes_ = 0;
+    pending_.clear();
+    for (const auto& let : deferred_) {
+      Emit(let.first, let.second);
+    }
+    deferred_.clear();
+  }
+
+  /*! \brief Issue the pending bucket of allgather ops, each of which gathers one row per rank. */
+  void FlushAllGather() {
+    static const Op& reshape_op = Op::Get("raf.op.reshape");
+    static const Op& concatenate_op = Op::Get("raf.op.concatenate");
+    static const Op& split_op = Op::Get("raf.op.split");
+    auto reshape = [](const Expr& x, const std::vector<int64_t>& shape) {
+      return Call(reshape_op, {x, MakeConstant(op::ArrayToIntTuple(shape)),
+                               MakeConstant(BoolValue::make(false))});
+    };
+    Array<Expr> flats;
+    std::vector<int64_t> indices;
+    int64_t numel = 0;
+    for (const auto& member : bucket_) {
+      if (numel > 0) {
+        indices.push_back(numel);
+      }
+      int64_t size = 1;
+      for (const auto& dim : member.in->checked_type().as<TensorTypeNode>()->shape) {
+        size *= dim.as<IntImmNode>()->value;
+      }
+      numel += size;
+      Var flat = MakeVar(member.in->name_hint() + "_flat", {});
+      Emit(flat, reshape(member.in, {size}));
+      flats.push_back(flat);
+    }
+    const auto& call = bucket_[0].call;
+    const auto* in_type = bucket_[0].in->checked_type().as<TensorTypeNode>();
+    const auto* out_type = call->checked_type().as<TensorTypeNode>();
+    int64_t num_ranks = out_type->shape[0].as<IntImmNode>()->value /
+                        in_type->shape[0].as<IntImmNode>()->value;
+    Var flats_tuple = MakeVar("bucket_flats", {});
+    Emit(flats_tuple, Tuple(flats));
+    Var bucket_in = MakeVar("bucket_in", {});
+    Emit(bucket_in, Call(concatenate_op, {flats_tuple, MakeConstant(ScalarValue::make(0))}));
+    Var bucket = MakeVar("bucket", {});
+    Emit(bucket, Call(call->op, {bucket_in, call->args[1], call->args[2]}));
+    Var rows = MakeVar("bucket_rows", {});
+    Emit(rows, reshape(bucket, {num_ranks, numel}));
+    Var parts = MakeVar("bucket_parts", {});
+    Emit(parts, Call(split_op, {rows, MakeConstant(op::ArrayToIntTuple(indices)),
+                                MakeConstant(ScalarValue::make(1))}));
+    for (size_t i = 0; i < bucket_.size(); ++i) {
+      const auto& member = bucket_[i];
+      Var part = MakeVar(member.out->name_hint() + "_part", {});
+      Emit(part, TupleGetItem(parts, i));
+      std::vector<int64_t> shape;
+      for (const auto& dim : member.call->checked_type().as<TensorTypeNode>()->shape) {
+        shape.push_back(dim.as<IntImmNode>()->value);
+      }
+      Emit(member.out, reshape(part, shape));
+    }
+    DLOG(INFO) << "Bucketed " << bucket_.size() << " allgather ops of " << bucket_bytes_
+               << " bytes";
+  }
+
+  /*! \brief The function to be optimized. */
+  const Function& func_;
+  /*! \brief The let list of the function. */
+  std::unique_ptr<ExplicitLetList> ell_;
+  /*! \brief The maximum size of a bucket in bytes. */
+  int64_t bucket_size_;
+  /*! \brief The let-binding variables of the function. */
+  VSet defined_;
+  /*! \brief The number of uses of each variable. */
+  StdMap<int> num_uses_;
+  /*! \brief The tuples binded to variables. */
+  StdMap<Tuple> tuple_defs_;
+  /*! \brief The allreduce ops in the pending bucket. */
+  std::vector<BucketMember> bucket_;
+  /*! \brief The total size of the pending bucket in bytes. */
+  int64_t bucket_bytes_ = 0;
+  /*! \brief The results of the pending bucket and the deferred ops. */
+  VSet pending_;
+  /*! \brief The ops deferred until the pending bucket is issued. */
+  std::vector<std::pair<Var, Expr>> deferred_;
+  /*! \brief The emitted let bindings. */
+  std::vector<Var> vars_;
+  std::vector<Expr> exprs_;
+  /*! \brief Whether an emitted let binding is removed, i.e., the input tuple of a merged op. */
+  std::vector<bool> removed_;
+  /*! \brief The positions of the emitted tuples. */
+  StdMap<size_t> tuple_pos_;
+};
+
+/*! \brief The information of a tensor to be placed in a bucket. */
+struct LayoutMember {
+  /*! \brief The index of the let binding that allocates the storage of the tensor. */
+  int storage_idx;
+  /*! \brief The indices of the let bindings that allocate tensors from the storage. */
+  std::vector<int> tensor_indices;
+  /*! \brief The index of the let binding that frees the storage, or -1 if never freed. */
+  int free_idx;
+  /*! \brief The offset of the tensor in the bucket. */
+  int64_t offset;
+};
+
+/*!
+ * \brief A mutator that lays out the input tensors of each multi-tensor allreduce contiguously in
+ * a single storage after memory planning, so that the producers directly write to the views of the
+ * bucket, and the allreduce kernel reduces the bucket without packing and unpacking. A storage is
+ * placed in the bucket if it has a static size, is allocated in the top-level scope, and is only
+ * used by alloc_tensor without offsets. All tensors allocated from a placed storage are
+ * moved to the bucket, so the bucket lives from the first allocated storage to the last freed one.
+ */
+class BucketLayout {
+ public:
+  explicit BucketLayout(const Function& func) : func_(func) {
+    Expr body = func->body;
+    while (const auto* let = body.as<LetNode>()) {
+      def_[let->var] = vars_.size();
+      vars_.push_back(let->var);
+      exprs_.push_back(let->value);
+      body = let->body;
+    }
+    ret_ = body;
+  }
+
+  Function Run() {
+    static const Op& alloc_storage_op = Op::Get("raf.op.vm.alloc_storage");
+    static const Op& alloc_tensor_op = Op::Get("raf.op.vm.alloc_tensor");
+    static const Op& free_op = Op::Get("raf.op.vm.free");
+    static const Op& invoke_op = Op::Get("raf.op.vm.invoke_op");
+
+    // Collect the storages that are only used by alloc_tensor.
+    StdMap<std::vector<int>> tensors_of_storage;
+    StdMap<int> free_of_storage;
+    VSet invalid;
+    for (int i = 0; i < static_cast<int>(vars_.size()); ++i) {
+      const auto* call = exprs_[i].as<CallNode>();
+      if (call && call->op == alloc_tensor_op) {
+        auto storage = Downcast<Var>(call->args[0]);
+        if (call->args.size() != 5) {
+          invalid.insert(storage);
+        }
+        tensors_of_storage[storage].push_back(i);
+        MarkUses(call->args, 1, &invalid);
+      } else if (call && call->op == free_op) {
+        free_of_storage[Downcast<Var>(call->args[0])] = i;
+      } else {
+        MarkUses(exprs_[i], &invalid);
+      }
+    }
+    MarkUses(ret_, &invalid);
+
+    // Plan the buckets.
+    std::vector<std::vector<LayoutMember>> buckets;
+    std::vector<int64_t> bucket_sizes;
+    VSet placed;
+    for (int i = 0; i < static_cast<int>(vars_.size()); ++i) {
+      const auto* call = exprs_[i].as<CallNode>();
+      if (call == nullptr || call->op != invoke_op || !IsAllReduceOp(Resolve(call->args[0]))) {
+        continue;
+      }
+      const auto* ins = Resolve(call->args[1]).as<TupleNode>();
+      const auto* tensors =
+          ins && !ins->fields.empty() ? Resolve(ins->fields[0]).as<TupleNode>() : nullptr;
+      if (tensors == nullptr || tensors->fields.size() < 2) {
+        continue;
+      }
+      std::vector<LayoutMember> members;
+      VSet storages;
+      int64_t offset = 0;
+      Expr device_type, device_id;
+      for (const auto& field : tensors->fields) {
+        Var storage = GetStorage(field, alloc_tensor_op);
+        const CallNode* alloc = storage.defined() && def_.count(storage)
+                                    ? exprs_[def_[storage]].as<CallNode>()
+                                    : nullptr;
+        if (alloc == nullptr || alloc->op != alloc_storage_op || alloc->args.size() < 5 ||
+            invalid.count(storage) || placed.count(storage) || storages.count(storage) ||
+            !IsIntConstant(alloc->args[0]) ||
+            !IsIntConstant(alloc->args[1]) || !IsIntConstant(alloc->args[2]) ||
+            !IsIntConstant(alloc->args[3]) ||
+            (device_type.defined() && GetInt(device_type) != GetInt(alloc->args[2])) ||
+            (device_id.defined() && GetInt(device_id) != GetInt(alloc->args[3]))) {
+          members.clear();
+          break;
+        }
+        storages.insert(storage);
+        device_type = alloc->args[2];
+        device_id = alloc->args[3];
+        int64_t alignment = GetInt(alloc->args[1]);
+        offset = (offset + alignment - 1) / alignment * alignment;
+        int free_idx = free_of_storage.count(storage) ? free_of_storage[storage] : -1;
+        members.push_back({def_[storage], tensors_of_storage[storage], free_idx, offset});
+        offset += GetInt(alloc->args[0]);
+      }
+      if (members.empty()) {
+        continue;
+      }
+      placed.insert(storages.begin(), storages.end());
+      buckets.push_back(members);
+      bucket_sizes.push_back(offset);
+    }
+    if (buckets.empty()) {
+      return func_;
+    }
+
+    // Rewrite the function.
+    std::unordered_map<int, Expr> rewrites;
+    std::unordered_map<int, std::pair<Var, Expr>> inserts;
+    for (size_t b = 0; b < buckets.size(); ++b) {
+      const auto& members = buckets[b];
+      Var bucket = MakeVar("bucket_storage", {});
+      int first_alloc = members[0].storage_idx;
+      int last_free = -1;
+      bool all_freed = true;
+      int64_t alignment = 0;
+      for (const auto& member : members) {
+        first_alloc = std::min(first_alloc, member.storage_idx);
+        last_free = std::max(last_free, member.free_idx);
+        all_freed = all_freed && member.free_idx != -1;
+        const auto* alloc = exprs_[member.storage_idx].as<CallNode>();
+        alignment = std::max(alignment, GetInt(alloc->args[1]));
+      }
+      const auto* first = exprs_[members[0].storage_idx].as<CallNode>();
+      inserts[first_alloc] = {
+          bucket, Call(alloc_storage_op,
+                       {MakeConstant(ScalarValue::make(bucket_sizes[b])),
+                        MakeConstant(ScalarValue::make(alignment)), first->args[2], first->args[3],
+                        first->args[4]})};
+      for (const auto& member : members) {
+        // Dismiss the storages and frees of the members.
+        rewrites[member.storage_idx] = Expr();
+        if (member.free_idx != -1) {
+          rewrites[member.free_idx] = Expr();
+        }
+        for (int tensor_idx : member.tensor_indices) {
+          const auto* alloc = exprs_[tensor_idx].as<CallNode>();
+          Array<Expr> new_args = alloc->args;
+          new_args.Set(0, bucket);
+          new_args.push_back(MakeConstant(ScalarValue::make(member.offset)));
+          rewrites[tensor_idx] = Call(alloc_tensor_op, new_args);
+        }
+      }
+      if (all_freed) {
+        rewrites[last_free] = Call(free_op, {bucket});
+      }
+      DLOG(INFO) << "Laid out " << members.size() << " tensors of an allreduce bucket in "
+                 << bucket_sizes[b] << " bytes";
+    }
+
+    ExplicitLetList ell;
+    for (int i = 0; i < static_cast<int>(vars_.size()); ++i) {
+      if (inserts.count(i)) {
+        ell.Push(inserts[i].first, inserts[i].second);
+      }
+      auto it = rewrites.find(i);
+      if (it == rewrites.end()) {
+        ell.Push(vars_[i], exprs_[i]);
+      } else if (it->second.defined()) {
+        ell.Push(vars_[i], it->second);
+      }
+    }
+    Expr body = ret_;
+    for (int i = static_cast<int>(ell.vars.size()) - 1; i >= 0; --i) {
+      body = Let(ell.vars[i], ell.exprs[i], body);
+    }
+    return Function(func_->params, body, func_->ret_type, func_->type_params, func_->attrs);
+  }
+
+ private:
+  /*! \brief Resolve the value of an expression through the variable aliases. */
+  Expr Resolve(Expr expr) {
+    while (const auto* var = expr.as<VarNode>()) {
+      auto it = def_.find(GetRef<Var>(var));
+      if (it == def_.end()) {
+        break;
+      }
+      expr = exprs_[it->second];
+    }
+    return expr;
+  }
+
+  /*! \brief Get the storage of a tensor allocated by alloc_tensor, or undefined if not. */
+  Var GetStorage(Expr expr, const Op& alloc_tensor_op) {
+    while (const auto* var = expr.as<VarNode>()) {
+      auto it = def_.find(GetRef<Var>(var));
+      if (it == def_.end()) {
+        return Var();
+      }
+      const auto* call = exprs_[it->second].as<CallNode>();
+      if (call && call->op == alloc_tensor_op) {
+        return Downcast<Var>(call->args[0]);
+      }
+      expr = exprs_[it->second];
+    }
+    return Var();
+  }
+
+  inline int64_t GetInt(const Expr& expr) {
+    return expr.as<ConstantNode>()->value.as<IntValueObj>()->value;
+  }
+
+  inline bool IsIntConstant(const Expr& expr) {
+    const auto* constant = expr.as<ConstantNode>();
+    return constant && constant->value.as<IntValueObj>();
+  }
+
+  /*! \brief Mark the storages used by the given expression as invalid. */
+  void MarkUses(const Expr& expr, VSet* invalid) {
+    for (const auto& var : FreeVars(expr)) {
+      invalid->insert(var);
+    }
+  }
+
+  void MarkUses(const Array<Expr>& args, size_t begin, VSet* invalid) {
+    for (size_t i = begin; i < args.size(); ++i) {
+      MarkUses(args[i], invalid);
+    }
+  }
+
+  /*! \brief The function to be optimized. */
+  const Function& func_;
+  /*! \brief The let-binding variables in the top-level scope. */
+  std::vector<Var> vars_;
+  /*! \brief The let-binding values in the top-level scope. */
+  std::vector<Expr> exprs_;
+  /*! \brief The index of the let binding of each variable. */
+  StdMap<int> def_;
+  /*! \brief The body of the last let-binding. */
+  Expr ret_;
+};
+
+/*! \brief Get the bucket size in bytes, or 0 if bucketing is disabled. */
+int64_t GetBucketSize(const PassContext& pass_ctx) {
+  Integer bucket_size_mb =
+      pass_ctx->GetConfig("raf.bucket_allreduce.bucket_size_mb", Integer(0)).value();
+  return static_cast<int64_t>(bucket_size_mb->value) << 20;
+}
+
+}  // namespace bucket_allreduce
+
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.bucket_allreduce.bucket_size_mb", Integer);
+
+Pass BucketAllReduce() {
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
+                                                                             PassContext pc) {
+    int64_t bucket_size = bucket_allreduce::GetBucketSize(pc);
+    if (bucket_size <= 0) {
+      return f;
+    }
+    return bucket_allreduce::Bucketer(f, bucket_size).Run();
+  };
+  auto func_pass = CreateRAFFunctionPass(pass_func, 0, "BucketAllReduce", {});
+  PassInfo pass_info(0, "BucketAllReduce", {});
+  return RAFSequential({InferType(), func_pass, EraseType()}, pass_info);
+}
+
+Pass BucketAllReduceLayout() {
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
+                                                                             PassContext pc) {
+    if (bucket_allreduce::GetBucketSize(pc) <= 0) {
+      return f;
+    }
+    return bucket_allreduce::BucketLayout(f).Run();
+  };
+  return CreateRAFFunctionPass(pass_func, 2, "BucketAllReduceLayout", {});
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.BucketAllReduce").set_body_typed(BucketAllReduce);
+RAF_REGISTER_GLOBAL("raf.pass_.BucketAllReduceLayout").set_body_typed(BucketAllReduceLayout);
+
+}  // namespace pass
+}  // namespace raf
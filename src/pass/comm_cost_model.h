@@ -0,0 +1,149 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file comm_cost_model.h
+ * \brief The cost model of communication and computation ops in data parallel training.
+ */
+#pragma once
+
+#include <algorithm>
+#include <unordered_map>
+#include "raf/device.h"
+#include "raf/dist_context.h"
+#include "raf/op.h"
+#include "raf/op_profiler.h"
+#include "raf/pass.h"
+#include "./common.h"
+#include "./estimate_flops.h"
+#include "../common/shape_utils.h"
+
+namespace raf {
+namespace pass {
+namespace comm_cost_model {
+
+using raf::distributed::DistContext;
+
+/*!
+ * \brief An analytical cost model of the ops in data parallel training. A collective takes the
+ * latency plus its message size over the bandwidth, where the message size follows the ring
+ * algorithm, e.g., 2(n-1)/n of the tensor for allreduce. A computation op takes its profiled
+ * latency if an op profiler is given, which is reloaded from the persistent cache when the op has
+ * been profiled before. Otherwise, it takes its estimated GFLOPS over the peak throughput plus the
+ * kernel launching overhead.
+ */
+class CommComputeCostModel {
+ public:
+  explicit CommComputeCostModel(const IRModule& mod, op_profiler::OpProfiler* profiler = nullptr)
+      : mod_(mod), profiler_(profiler) {
+    auto ctx = PassContext::Current();
+    compute_tflops_ = ctx->GetConfig("raf.dp_schedule.compute_tflops", Integer(10)).value()->value;
+    comm_bandwidth_ = ctx->GetConfig("raf.dp_schedule.comm_bandwidth", Integer(10)).value()->value;
+    auto default_workers = Integer(DistContext::Global()->size);
+    num_workers_ = ctx->GetConfig("raf.dp_schedule.num_workers", default_workers).value()->value;
+    CHECK_GT(compute_tflops_, 0) << "The compute TFLOPS must be positive";
+    CHECK_GT(comm_bandwidth_, 0) << "The communication bandwidth must be positive";
+    device_ = Device::Current(false);
+    if (device_.device_type() == DevType::kUnknown()) {
+      LOG(WARNING) << "Target device is undefined. Use an uniform latency for computation ops.";
+    }
+  }
+
+  /*! \brief Whether the expr is a collective, which is executed on the communication stream. */
+  static bool IsComm(const Expr& expr) {
+    auto call = expr.as<CallNode>();
+    return call != nullptr && op::IsCollectiveOp(call->op);
+  }
+
+  /*! \brief The estimated latency of the expr in microseconds. */
+  double Latency(const Expr& expr) {
+    static const Op& allgather_op = Op::Get("raf.op._allgather");
+    auto it = latency_.find(expr.get());
+    if (it != latency_.end()) {
+      return it->second;
+    }
+    double latency = 0;
+    if (auto call = expr.as<CallNode>()) {
+      if (op::IsCollectiveOp(call->op)) {
+        double bytes = call->args.empty() ? 0 : TensorBytes(call->args[0]->checked_type());
+        if (call->op.same_as(allgather_op)) {
+          bytes = TensorBytes(call->checked_type()) / std::max(num_workers_, 1);
+        }
+        latency = CommLatency(Downcast<Op>(call->op), bytes);
+      } else if (profiler_ != nullptr &&
+                 (call->op->IsInstance<OpNode>() || call->op->IsInstance<FunctionNode>())) {
+        latency = profiler_->ProfileOp(expr).first[0];
+      } else if (device_.device_type() == DevType::kUnknown()) {
+        latency = kLaunchOverheadUs;
+      } else {
+        double gflops = estimate_flops::FLOPSEstimater().Run(device_, GetRef<Call>(call), mod_);
+        // GFLOPS / TFLOPS = 1e3 us
+        latency = kLaunchOverheadUs + std::max(gflops, 0.0) / compute_tflops_ * 1e3;
+      }
+    }
+    return latency_[expr.get()] = latency;
+  }
+
+  /*!
+   * \brief The estimated latency of a collective in microseconds.
+   * \param op The collective op.
+   * \param bytes The bytes of the input tensors of each rank.
+   */
+  double CommLatency(const Op& op, double bytes) const {
+    static const Op& allreduce_op = Op::Get("raf.op._allreduce");
+    static const Op& reduce_scatter_op = Op::Get("raf.op._reduce_scatter");
+    static const Op& allgather_op = Op::Get("raf.op._allgather");
+    double n = std::max(num_workers_, 1);
+    if (op.same_as(allreduce_op)) {
+      bytes *= 2 * (n - 1) / n;
+    } else if (op.same_as(reduce_scatter_op)) {
+      bytes *= (n - 1) / n;
+    } else if (op.same_as(allgather_op)) {
+      bytes *= n - 1;
+    }
+    // bytes / (GB/s) = 1e-3 us
+    return kCommLatencyUs + bytes / comm_bandwidth_ * 1e-3;
+  }
+
+  /*! \brief The bytes of a tensor or a tuple of tensors. Other types take no bytes. */
+  static double TensorBytes(const Type& type) {
+    if (auto tuple_type = type.as<TupleTypeNode>()) {
+      double bytes = 0;
+      for (const auto& field : tuple_type->fields) {
+        bytes += TensorBytes(field);
+      }
+      return bytes;
+    }
+    if (type->IsInstance<TensorTypeNode>()) {
+      return common::shape_utils::BytesCompactType(type);
+    }
+    return 0;
+  }
+
+ private:
+  /*! \brief The fixed latency of launching a collective in microseconds. */
+  static constexpr double kCommLatencyUs = 10.0;
+  /*! \brief The overhead of launching a computation kernel in microseconds. */
+  static constexpr double kLaunchOverheadUs = 5.0;
+
+  /*! \brief The module that the scheduled function belongs to. */
+  IRModule mod_;
+  /*! \brief The profiler of the computation ops, or nullptr to estimate by GFLOPS. */
+  op_profiler::OpProfiler* profiler_;
+  /*! \brief The target device. */
+  Device device_;
+  /*! \brief The peak compute throughput in TFLOPS. */
+  double compute_tflops_;
+  /*! \brief The communication bandwidth in GB/s. */
+  double comm_bandwidth_;
+  /*! \brief The number of data parallel workers. */
+  int num_workers_;
+  /*! \brief The cached latency of each expr. */
+  std::unordered_map<const ExprNode*, double> latency_;
+};
+
+}  // namespace comm_cost_model
+}  // namespace pass
+}  // namespace raf
@@ -9,10 +9,12 @@
  */
 #pragma once
 
+#include <algorithm>
 #include <vector>
 #include <tvm/ir/type_functor.h>
 #include "raf/ir.h"
 #include "raf/value.h"
+#include "raf/op_utils.h"
 #include "../op/schema/init.h"
 #include "../op/schema/memory.h"
 #include "../op/schema/transform.h"
@@ -342,6 +344,10 @@ inline Device GetOutputDevice(const Call& call) {
   }
 
   Device device = Device::Current();
+  if (op::IsShapeOp(call->op)) {
+    // The shape ops are computed on the host, so their outputs are read without device syncs.
+    return Device(DevType::kCPU(), 0);
+  }
   if (auto op_node = call->op.as<OpNode>()) {
     static auto fschema = Op::GetAttrMap<op::FRAFSchema>("FRAFSchema");
     static auto* str2dev = tvm::runtime::Registry::Get("raf._core.core_utils.str2dev");
@@ -359,5 +365,123 @@ inline Device GetOutputDevice(const Call& call) {
   return device;
 }
 
+/*!
+ * \brief Get the offsets in bytes of the outputs of split or strided_slice in their input, when
+ * every output is a contiguous chunk of the input, e.g., split or slice with stride 1 along the
+ * outermost axis, so the outputs can be views of the input instead of copies. The kernels assume
+ * their arguments are aligned to 64 bytes, so the offsets must be multiples of 64 bytes.
+ * \param call The call, whose shapes must be static and whose slice attributes must be constants.
+ * \return The offsets of the outputs, or an empty vector if the outputs cannot be views.
+ */
+inline std::vector<int64_t> GetViewOffsets(const CallNode* call) {
+  static const Op& split_op = Op::Get("raf.op.split");
+  static const Op& strided_slice_op = Op::Get("raf.op.strided_slice");
+  static auto fschema = Op::GetAttrMap<op::FRAFSchema>("FRAFSchema");
+  constexpr int64_t kAlignment = 64;
+  const auto* op_node = call->op.as<OpNode>();
+  if (op_node == nullptr || call->args.empty() || !call->checked_type_.defined()) {
+    return {};
+  }
+  Op op = op::IsDialectOp(GetRef<Op>(op_node)) ? op::GetBaseOp(GetRef<Op>(op_node))
+                                               : GetRef<Op>(op_node);
+  if (op != split_op && op != strided_slice_op) {
+    return {};
+  }
+  auto get_shape = [](const Type& type, std::vector<int64_t>* shape) {
+    const auto* tensor_type = type.as<TensorTypeNode>();
+    if (tensor_type == nullptr) {
+      return false;
+    }
+    for (const auto& dim : tensor_type->shape) {
+      const auto* imm = dim.as<IntImmNode>();
+      if (imm == nullptr) {
+        return false;
+      }
+      shape->push_back(imm->value);
+    }
+    return true;
+  };
+  std::vector<int64_t> shape;
+  if (!get_shape(call->args[0]->checked_type(), &shape)) {
+    return {};
+  }
+  const DataType& dtype = call->args[0]->checked_type().as<TensorTypeNode>()->dtype;
+  int64_t elem_bytes = (dtype.bits() * dtype.lanes() + 7) / 8;
+  int ndim = shape.size();
+  // The number of elements of the axes after the given one.
+  auto inner_size = [&shape, ndim](int axis) {
+    int64_t size = 1;
+    for (int i = axis + 1; i < ndim; ++i) {
+      size *= shape[i];
+    }
+    return size;
+  };
+  Array<Value> arg_values;
+  for (const auto& arg : call->args) {
+    arg_values.push_back(GetValue(arg));
+  }
+
+  std::vector<int64_t> offsets;
+  if (op == split_op) {
+    const auto* tuple_type = call->checked_type().as<TupleTypeNode>();
+    auto args = fschema[op](arg_values).as<op::schema::SplitArgs>();
+    if (tuple_type == nullptr || ndim == 0) {
+      return {};
+    }
+    int axis = args->axis < 0 ? args->axis + ndim : args->axis;
+    for (int i = 0; i < axis; ++i) {
+      if (shape[i] != 1) {
+        return {};
+      }
+    }
+    int64_t offset = 0;
+    for (const auto& field : tuple_type->fields) {
+      std::vector<int64_t> out_shape;
+      if (!get_shape(field, &out_shape)) {
+        return {};
+      }
+      offsets.push_back(offset * elem_bytes);
+      offset += out_shape[axis] * inner_size(axis);
+    }
+  } else {
+    std::vector<int64_t> out_shape;
+    if (!call->args[1].as<ConstantNode>() || !get_shape(call->checked_type(), &out_shape)) {
+      return {};
+    }
+    auto args = fschema[op](arg_values).as<op::schema::StridedSliceArgs>();
+    if (args->slice_mode != "size") {
+      for (int64_t stride : args->strides) {
+        if (stride != 1) {
+          return {};
+        }
+      }
+    }
+    // The first sliced axis, where the axes before it must be 1 and the axes after it must be
+    // full, so the slice is contiguous.
+    int axis = 0;
+    while (axis < ndim && out_shape[axis] == shape[axis]) {
+      ++axis;
+    }
+    for (int i = 0; i < ndim; ++i) {
+      if ((i < axis && shape[i] != 1) || (i > axis && out_shape[i] != shape[i])) {
+        return {};
+      }
+    }
+    int64_t begin = 0;
+    std::vector<int64_t> begins = op::GetShapeVecFromValue(args->begin);
+    if (axis < ndim && static_cast<size_t>(axis) < begins.size()) {
+      begin = begins[axis] < 0 ? begins[axis] + shape[axis] : begins[axis];
+      begin = std::min(std::max(begin, int64_t(0)), shape[axis]);
+    }
+    offsets.push_back(axis < ndim ? begin * inner_size(axis) * elem_bytes : 0);
+  }
+  for (int64_t offset : offsets) {
+    if (offset % kAlignment != 0) {
+      return {};
+    }
+  }
+  return offsets;
+}
+
 };  // namespace pass
 };  // namespace raf
@@ -0,0 +1,269 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file compress_activation.cc
+ * \brief Given a model after AutoDiff, InlineBackward and GradInputSelect, this pass stores the
+ * activations living across the forward and the backward in compressed forms, which are
+ * decompressed right before their backward uses:
+ *
+ * - "relu": the outputs of ReLU only used by relu_dx are stored as boolean masks.
+ * - "gelu": the inputs of GELU only used by gelu_dx are stored in bfloat16.
+ * - "float16" or "bfloat16": the other float32 activations are stored in the given dtype.
+ *
+ * The policies are selected by raf.compress_activation.policy, e.g., "relu,gelu". The compression
+ * and the decompression are casts, which FuseTVM fuses into the producers in the forward and the
+ * grad ops in the backward, so they do not launch extra kernels in most cases.
+ */
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+#include "raf/op.h"
+#include "raf/ir.h"
+#include "raf/pass.h"
+#include "raf/value.h"
+
+#include "./common.h"
+#include "../common/shape_utils.h"
+
+namespace raf {
+namespace pass {
+namespace compress_activation {
+
+using namespace raf::ir;
+using namespace raf::op;
+using namespace raf::value;
+
+// The tensors smaller than 1MB are not worth the extra casts.
+constexpr int64_t kMinBytes = 1048576;
+
+/*! \brief The compression policies. */
+struct Policy {
+  /*! \brief Store the ReLU outputs used by relu_dx as masks. */
+  bool relu = false;
+  /*! \brief Store the GELU inputs used by gelu_dx in bfloat16. */
+  bool gelu = false;
+  /*! \brief The dtype to store the other float32 activations, or empty if not compressed. */
+  std::string dtype;
+
+  /*! \brief Parse a comma separated list of the policies. */
+  static Policy Parse(const std::string& str) {
+    Policy policy;
+    std::stringstream ss(str);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+      if (item == "relu") {
+        policy.relu = true;
+      } else if (item == "gelu") {
+        policy.gelu = true;
+      } else if (item == "float16" || item == "bfloat16") {
+        policy.dtype = item;
+      } else if (!item.empty()) {
+        LOG(FATAL) << "Unknown activation compression policy: " << item;
+      }
+    }
+    return policy;
+  }
+
+  bool Enabled() const {
+    return relu || gelu || !dtype.empty();
+  }
+};
+
+/*! \brief The compressed form of an activation. */
+struct Compression {
+  /*! \brief The dtype of the compressed activation. */
+  std::string dtype;
+  /*! \brief Whether each backward use decompresses it, rather than the first one. */
+  bool per_use;
+};
+
+class ActivationCompressor {
+ public:
+  ActivationCompressor(const Function& func, const Policy& policy)
+      : func_(func), ell_(ExplicitLetList::make(func->body)), policy_(policy) {
+    int n = ell_->vars.size();
+    for (int i = 0; i < n; ++i) {
+      var_index_[ell_->vars[i].get()] = i;
+    }
+    uses_.resize(n);
+    for (int i = 0; i < n; ++i) {
+      for (const auto& var : FreeVars(ell_->exprs[i])) {
+        auto it = var_index_.find(var.get());
+        if (it != var_index_.end()) {
+          uses_[it->second].push_back(i);
+        }
+      }
+    }
+  }
+
+  Function Run() {
+    static const Op& cast_op = Op::Get("raf.op.cast");
+    int n = ell_->vars.size();
+    int fwd_end = FindForwardEnd();
+    if (fwd_end == -1) {
+      DLOG(INFO) << "Cannot find the end of the forward. Skip compressing activations";
+      return func_;
+    }
+
+    std::unordered_map<int, Compression> compressions;
+    for (int i = 0; i <= fwd_end; ++i) {
+      Compression comp;
+      if (Choose(i, fwd_end, &comp)) {
+        compressions[i] = comp;
+      }
+    }
+    if (compressions.empty()) {
+      return func_;
+    }
+
+    // Rebuild the let list with the casts inserted.
+    std::unordered_map<int, Var> compressed;
+    Map<Var, Expr> decompressed;
+    std::unique_ptr<ExplicitLetList> ell = std::make_unique<ExplicitLetList>();
+    for (int i = 0; i < n; ++i) {
+      auto expr = ell_->exprs[i];
+      if (i > fwd_end) {
+        Map<Var, Expr> subst;
+        for (const auto& var : FreeVars(expr)) {
+          auto it = var_index_.find(var.get());
+          if (it == var_index_.end() || !compressions.count(it->second)) {
+            continue;
+          }
+          // Decompress the activation right before its (first) backward use.
+          if (!decompressed.count(var)) {
+            const auto* type = var->checked_type().as<TensorTypeNode>();
+            auto dtype = MakeConstant(
+                StringValue::make(tvm::runtime::DLDataType2String(type->dtype)));
+            auto dec_var = MakeVar(var->name_hint() + "_decompress", {});
+            ell->Push(dec_var, Call(cast_op, {compressed.at(it->second), dtype}));
+            decompressed.Set(var, dec_var);
+          }
+          subst.Set(var, decompressed[var]);
+          if (compressions[it->second].per_use) {
+            decompressed.erase(var);
+          }
+        }
+        if (!subst.empty()) {
+          expr = Substitute(expr, subst);
+        }
+      }
+      ell->Push(ell_->vars[i], expr);
+      auto it = compressions.find(i);
+      if (it != compressions.end()) {
+        const auto& var = ell_->vars[i];
+        auto dtype = MakeConstant(StringValue::make(it->second.dtype));
+        auto comp_var = MakeVar(var->name_hint() + "_compress", {});
+        ell->Push(comp_var, Call(cast_op, {var, dtype}));
+        compressed[i] = comp_var;
+        DLOG(INFO) << "Compress " << var->name_hint() << " to " << it->second.dtype;
+      }
+    }
+    ell->ret = ell_->ret;
+    return Function(func_->params, ell->AsExpr(), func_->ret_type, {}, func_->attrs);
+  }
+
+ private:
+  /*!
+   * \brief Assume output is a tuple of (forward out, (grads, ...)), so the forward ends at the
+   * binding of the forward output.
+   * \return The let-binding index of the forward output, or -1 if not found.
+   */
+  int FindForwardEnd() {
+    if (ell_->exprs.empty()) {
+      return -1;
+    }
+    if (auto ret = ell_->exprs.back().as<TupleNode>()) {
+      if (ret->fields.size() == 2U && ret->fields[0]->IsInstance<VarNode>()) {
+        auto it = var_index_.find(ret->fields[0].as<VarNode>());
+        if (it != var_index_.end()) {
+          return it->second;
+        }
+      }
+    }
+    return -1;
+  }
+
+  /*! \brief Choose the compression of the activation produced by the given binding. */
+  bool Choose(int idx, int fwd_end, Compression* comp) {
+    static const Op& relu_dx_op = Op::Get("raf.op.relu_dx");
+    static const Op& gelu_dx_op = Op::Get("raf.op.gelu_dx");
+    const auto& uses = uses_[idx];
+    const auto& var = ell_->vars[idx];
+    const auto* type = var->checked_type().as<TensorTypeNode>();
+    // Only compress the float tensors which are produced by ops in the forward, and are used by
+    // the backward but not returned directly.
+    if (!ell_->exprs[idx]->IsInstance<CallNode>() || type == nullptr || !type->dtype.is_float() ||
+        uses.empty() || uses.back() <= fwd_end ||
+        uses.back() == static_cast<int>(ell_->vars.size()) - 1 ||
+        common::shape_utils::BytesCompactType(type) < kMinBytes) {
+      return false;
+    }
+    bool relu_only = true, gelu_only = true;
+    for (int use : uses) {
+      const auto* call = ell_->exprs[use].as<CallNode>();
+      if (use <= fwd_end) {
+        // The activation in a tuple may be used by the backward through the tuple.
+        if (ell_->exprs[use]->IsInstance<TupleNode>()) {
+          return false;
+        }
+        continue;
+      }
+      // relu_dx(null, y, dy) after GradInputSelect, and gelu_dx(x, null, dy).
+      relu_only &= call && call->op.same_as(relu_dx_op) && call->args[1].same_as(var) &&
+                   !call->args[0].same_as(var) && !call->args[2].same_as(var);
+      gelu_only &= call && call->op.same_as(gelu_dx_op) && call->args[0].same_as(var) &&
+                   !call->args[2].same_as(var);
+    }
+    if (policy_.relu && relu_only) {
+      // ReLU outputs are non-negative, so the masks of the positive values are casts to bool.
+      *comp = {"bool", true};
+      return true;
+    }
+    if (policy_.gelu && gelu_only) {
+      *comp = {"bfloat16", true};
+      return true;
+    }
+    if (!policy_.dtype.empty() && type->dtype == DataType::Float(32)) {
+      *comp = {policy_.dtype, false};
+      return true;
+    }
+    return false;
+  }
+
+  /*! \brief The target function. */
+  Function func_;
+  /*! \brief The explicit let list of the target function. */
+  std::unique_ptr<ExplicitLetList> ell_;
+  /*! \brief The compression policies. */
+  Policy policy_;
+  /*! \brief Mapping from a let var to its binding index. */
+  std::unordered_map<const VarNode*, int> var_index_;
+  /*! \brief The sorted let-binding indices using each let var. */
+  std::vector<std::vector<int>> uses_;
+};
+
+}  // namespace compress_activation
+
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.compress_activation.policy", String);
+
+Pass CompressActivation() {
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
+                                                                             PassContext pc) {
+    auto policy = compress_activation::Policy::Parse(
+        pc->GetConfig<String>("raf.compress_activation.policy", String("")).value());
+    if (!policy.Enabled() || !f->body->IsInstance<LetNode>()) {
+      return f;
+    }
+    return compress_activation::ActivationCompressor(f, policy).Run();
+  };
+  auto compress_activation = CreateRAFFunctionPass(pass_func, 0, "CompressActivationFunc", {});
+  return RAFSequential({InferType(), compress_activation, InferType()}, "CompressActivation");
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.CompressActivation").set_body_typed(CompressActivation);
+
+}  // namespace pass
+}  // namespace raf
@@ -23,6 +23,14 @@
  * needed. The context of the input would be propagated from its other
  * consumers or fallback to the default device.
  *
+ * Similarly, the shape ops (e.g., shape, shape_as_tensor and numel) only read
+ * the shapes of their inputs and produce small integer tensors, which are
+ * consumed as shapes (e.g., by HandleInferType and LoadTensorInt in the VM).
+ * They are placed on CPU so that the shape queries do not launch kernels or
+ * copy their results back from the device. Their inputs are left to their
+ * other consumers, and the consumers of their outputs are not unified with
+ * CPU either, as the outputs are read on the host.
+ *
  * Another type of dialect is used fo memory allocation, namely, alloc_storage
  * and alloc_tensor. alloc_storage contains a context field to indicate where
  * the chunk of memory is allocated. Therefore, we unify the context of
@@ -38,6 +46,7 @@
 #include <raf/binding.h>
 #include <raf/ir.h>
 #include <raf/op.h>
+#include <raf/op_utils.h>
 #include <raf/pass.h>
 #include <raf/value.h>
 #include <tvm/relay/attrs/memory.h>
@@ -214,17 +223,16 @@ class ContextAnalyzer : public MixedModeVisitor {
 
   // Unify the device context for a device copy node. Device copy node is
   // the only node that carries bidirectional devices in the input program. The device
-  // attribute of other nodes can be propagated from it.
+  // attribute of other nodes can be propagated from it. The device ids are kept for the copies
+  // between GPUs, which place the subgraphs on different GPUs.
   void UnifyDeviceCopy(const std::vector<Expr>& inps, const std::vector<Expr>& outputs,
-                       DevType src_dev_type, DevType dst_dev_type) {
-    Device src_ctx = Device(src_dev_type, 0);
+                       const Device& src_ctx, const Device& dst_ctx) {
     auto src_domain = DeviceType(src_ctx);
     for (const auto& it : inps) {
       auto lhs = DeviceFor(it);
       Unify(lhs, src_domain);
     }
 
-    Device dst_ctx = Device(dst_dev_type, 0);
     auto dst_domain = DeviceType(dst_ctx);
     for (const auto& it : outputs) {
       auto lhs = DeviceFor(it);
@@ -243,7 +251,9 @@ class ContextAnalyzer : public MixedModeVisitor {
     device = Unify(device, DeviceFor(call_op));
 
     for (const auto& it : inps) {
-      device = Unify(device, DeviceFor(it));
+      if (!host_exprs_.count(it)) {
+        device = Unify(device, DeviceFor(it));
+      }
     }
 
     for (const auto& it : outputs) {
@@ -262,6 +272,8 @@ class ContextAnalyzer : public MixedModeVisitor {
       UnifyAllocStorageCall(cn);
     } else if (call->op == alloc_tensor_op) {
       UnifyAllocTensorCall(cn);
+    } else if (op::IsShapeOp(call->op)) {
+      UnifyShapeCall(cn);
     } else if (call->op == invoke_op) {
       UnifyInvokeOpCall(cn);
     } else if (call->op.as<FunctionNode>()) {
@@ -289,6 +301,14 @@ class ContextAnalyzer : public MixedModeVisitor {
         closures_[let->var] = Downcast<GlobalVar>(gv);
       }
 
+      // The vars of the host shape values are read on the host by their consumers.
+      if (const auto* call = let->value.as<CallNode>()) {
+        if (IsShapeCallee(call->op)) {
+          host_exprs_.insert(let->var);
+        }
+      } else if (let->value.as<OpNode>()) {
+        let_ops_[let->var] = let->value;
+      }
       // Unify let var, value, and body
       Unify(DeviceFor(let->var), DeviceFor(let->value));
       UnifyExpr(let, let->body);
@@ -315,15 +335,15 @@ class ContextAnalyzer : public MixedModeVisitor {
   }
 
   void VisitExpr_(const TupleNode* tn) final {
-    // We only support tuple with the same of device.
+    // We only support tuple with the same of device, except for the host shape values.
     Tuple tup = GetRef<Tuple>(tn);
-    if (tn->fields.size() > 0) {
-      auto device = DeviceFor(tup->fields[0]);
-      for (size_t i = 1; i < tup->fields.size(); i++) {
-        device = Unify(device, DeviceFor(tup->fields[i]));
+    auto device = Bottom();
+    for (const auto& field : tup->fields) {
+      if (!host_exprs_.count(field)) {
+        device = Unify(device, DeviceFor(field));
       }
-      Unify(device, DeviceFor(tup));
     }
+    Unify(device, DeviceFor(tup));
     MixedModeVisitor::VisitExpr_(tn);
   }
 
@@ -402,6 +422,12 @@ class ContextAnalyzer : public MixedModeVisitor {
     return func->GetAttr<Integer>(attr::kClosure, 0) != 0;
   }
 
+  // Check if the callee is a shape op, which is bound to a var when invoked by invoke_op.
+  bool IsShapeCallee(const Expr& callee) {
+    auto it = let_ops_.find(callee);
+    return op::IsShapeOp(it != let_ops_.end() ? it->second : callee);
+  }
+
   // Check if a function is a currying function.
   bool IsCurrying(const Function& func) {
     if (const auto* let = func->body.as<LetNode>()) {
@@ -425,30 +451,25 @@ class ContextAnalyzer : public MixedModeVisitor {
     // The call and its src and dst are allocated with the same device type as
     // the destination.
     std::vector<Expr> outs{GetRef<Call>(call), call->args[1], call->args[2]};
-    DevType src_dev_type, dst_dev_type;
-    const DeviceCopyArgs* attrs = nullptr;
+    const CallNode* copy = call;
     if (const auto* fn = call->op.as<FunctionNode>()) {
       // TODO(zhiics) Check how to handle this
       inps.push_back(fn->params[0]);
       outs.push_back(call->op);
       Expr body = fn->body;
       CHECK(body->IsInstance<CallNode>() && IsDeviceCopy(body));
-      Call call_body = Downcast<Call>(body);
-      attrs = call_body->args.as<DeviceCopyArgs>();
-    } else {
-      const ConstantNode* src_const = call->args[1].as<ConstantNode>();
-      const ConstantNode* dst_const = call->args[2].as<ConstantNode>();
-      CHECK(src_const != nullptr && dst_const != nullptr);
-      auto src_device = ToDevice(src_const->value);
-      auto dst_device = ToDevice(dst_const->value);
-      src_dev_type = src_device->device_type;
-      dst_dev_type = dst_device->device_type;
+      copy = body.as<CallNode>();
     }
+    const ConstantNode* src_const = copy->args[1].as<ConstantNode>();
+    const ConstantNode* dst_const = copy->args[2].as<ConstantNode>();
+    CHECK(src_const != nullptr && dst_const != nullptr);
+    Device src_device = ToDevice(src_const->value);
+    Device dst_device = ToDevice(dst_const->value);
 
     //  Device copy op only has one input which is now annotated with the
     //  same device to the source device type of the device copy op.
     //  The call itself has the same device type to the destination.
-    UnifyDeviceCopy(inps, outs, src_dev_type, dst_dev_type);
+    UnifyDeviceCopy(inps, outs, src_device, dst_device);
     MixedModeVisitor::VisitExpr_(call);
   }
 
@@ -479,12 +500,29 @@ class ContextAnalyzer : public MixedModeVisitor {
     MixedModeVisitor::VisitExpr(shape);
   }
 
+  void UnifyShapeCall(const CallNode* call) {
+    // Only the shapes of the inputs are read, so the inputs could be on any device.
+    Expr expr = GetRef<Call>(call);
+    Unify(DeviceFor(expr), DeviceType(cpu_ctx_));
+    Unify(DeviceFor(call->op), DeviceType(cpu_ctx_));
+    host_exprs_.insert(expr);
+    MixedModeVisitor::VisitExpr_(call);
+  }
+
   void UnifyInvokeOpCall(const CallNode* call) {
     // [op, inputs, outputs]
     CHECK_EQ(call->args.size(), 3U);
     Tuple inps = Downcast<Tuple>(call->args[1]);
     Tuple outputs = Downcast<Tuple>(call->args[2]);
-    UnifyCall(call->args[0], inps->fields, outputs->fields, Bottom());
+    if (IsShapeCallee(call->args[0])) {
+      // The outputs are allocated on CPU by ManifestAlloc, and the inputs are left as above.
+      for (const auto& it : outputs->fields) {
+        Unify(DeviceFor(it), DeviceType(cpu_ctx_));
+        host_exprs_.insert(it);
+      }
+    } else {
+      UnifyCall(call->args[0], inps->fields, outputs->fields, Bottom());
+    }
     MixedModeVisitor::VisitExpr_(call);
   }
 
@@ -618,6 +656,10 @@ class ContextAnalyzer : public MixedModeVisitor {
    * will be invoked lazily.
    */
   std::unordered_map<Expr, GlobalVar, tvm::ObjectHash, tvm::ObjectEqual> closures_;
+  /*! \brief The exprs of the shape values computed on the host, e.g., by shape_as_tensor. */
+  std::unordered_set<Expr, tvm::ObjectHash, tvm::ObjectEqual> host_exprs_;
+  /*! \brief The let vars bound to ops, which are the callees of invoke_op. */
+  std::unordered_map<Expr, Expr, tvm::ObjectHash, tvm::ObjectEqual> let_ops_;
 };
 
 }  // namespace context_analysis
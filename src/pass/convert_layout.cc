@@ -0,0 +1,393 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file convert_layout.cc
+ * \brief Convert the NCHW convolutions to NHWC, which runs on tensor cores with cuDNN and
+ * CUTLASS. The NHWC layout is propagated through the layout-agnostic ops (e.g., elementwise ops
+ * and pooling) after the convolutions, so the transposes are only inserted at the boundaries of
+ * the NHWC regions, and the transposes that cancel each other are removed.
+ */
+#include <algorithm>
+#include "raf/dialect.h"
+#include "raf/op.h"
+#include "raf/ir.h"
+#include "raf/pass.h"
+#include "raf/value.h"
+#include "./common.h"
+
+namespace raf {
+namespace pass {
+namespace convert_layout {
+
+using namespace raf::ir;
+using namespace raf::op;
+using namespace raf::value;
+
+/*! \brief The permutations between NCHW and NHWC, which are also OIHW to OHWI. */
+static const std::vector<int64_t> kToNHWC = {0, 2, 3, 1};
+static const std::vector<int64_t> kToNCHW = {0, 3, 1, 2};
+
+inline std::string GetString(const Expr& expr) {
+  const auto* constant = expr.as<ConstantNode>();
+  if (constant == nullptr || !constant->value.defined()) {
+    return "";
+  }
+  const auto* value = constant->value.as<StringValueObj>();
+  return value != nullptr ? value->value : "";
+}
+
+inline Expr MakeString(const std::string& str) {
+  return MakeConstant(StringValue::make(str));
+}
+
+inline Expr MakeAxes(const std::vector<int64_t>& axes) {
+  Array<Value> fields;
+  for (auto axis : axes) {
+    fields.push_back(ScalarValue::make(axis));
+  }
+  return MakeConstant(TupleValue::make(fields));
+}
+
+/*! \brief Get the constant transpose axes, or an empty vector if they are not constant. */
+inline std::vector<int64_t> GetAxes(const Expr& expr) {
+  std::vector<int64_t> axes;
+  const auto* constant = expr.as<ConstantNode>();
+  if (constant == nullptr || !constant->value.defined()) {
+    return axes;
+  }
+  const auto* tuple = constant->value.as<TupleValueObj>();
+  if (tuple == nullptr) {
+    return axes;
+  }
+  for (const auto& field : tuple->fields) {
+    const auto* int_value = field.as<IntValueObj>();
+    if (int_value == nullptr) {
+      return {};
+    }
+    axes.push_back(int_value->value);
+  }
+  return axes;
+}
+
+inline Array<PrimExpr> Permute(const Array<PrimExpr>& shape, const std::vector<int64_t>& axes) {
+  Array<PrimExpr> ret;
+  for (auto axis : axes) {
+    ret.push_back(shape[axis]);
+  }
+  return ret;
+}
+
+/*! \brief Get the static dim, or -1 if it is dynamic. */
+inline int64_t GetDim(const PrimExpr& dim) {
+  const auto* imm = dim.as<IntImmNode>();
+  return imm != nullptr ? imm->value : -1;
+}
+
+class LayoutConverter {
+ public:
+  LayoutConverter(const Function& func, const std::string& policy)
+      : func_(func), force_(policy == "nhwc") {
+  }
+
+  Function Run() {
+    static const Op& transpose = Op::Get("raf.op.transpose");
+    static const Op& conv2d = Op::Get("raf.op.conv2d");
+    if (!func_->body->IsInstance<LetNode>()) {
+      return func_;
+    }
+    auto ell = ExplicitLetList::make(func_->body);
+    for (size_t i = 0; i < ell->vars.size(); ++i) {
+      const auto& var = ell->vars[i];
+      auto expr = subst_.empty() ? ell->exprs[i] : Substitute(ell->exprs[i], subst_);
+      auto call = expr.as<CallNode>();
+      if (call == nullptr || !var->checked_type_.defined() ||
+          !var->checked_type()->IsInstance<TensorTypeNode>()) {
+        Emit(var, expr);
+        continue;
+      }
+      const auto* ttype = var->type_as<TensorTypeNode>();
+      // The NHWC version of the output, which is defined if the call is converted.
+      Var nhwc;
+      if (call->op == transpose) {
+        auto alias = CancelTranspose(GetRef<Call>(call));
+        if (alias.defined()) {
+          subst_.Set(var, alias);
+          continue;
+        }
+      } else if (call->op == conv2d) {
+        nhwc = ConvertConv2D(GetRef<Call>(call), ttype);
+      } else if (ttype->shape.size() == 4U) {
+        nhwc = Propagate(GetRef<Call>(call), ttype);
+      }
+      if (!nhwc.defined()) {
+        Emit(var, expr);
+        continue;
+      }
+      // The NCHW output is kept for the consumers outside the NHWC region, and it is removed by
+      // DeadCodeElimination if all consumers are converted.
+      nhwc_[var] = nhwc;
+      Emit(var, Call(transpose, {nhwc, MakeAxes(kToNCHW)}));
+    }
+    Var ret = subst_.count(ell->ret) ? Downcast<Var>(subst_[ell->ret]) : ell->ret;
+    ell_.ret = ret;
+    return Function(func_->params, ell_.AsExpr(), func_->ret_type, func_->type_params,
+                    func_->attrs);
+  }
+
+ private:
+  void Emit(const Var& var, const Expr& expr) {
+    ell_.Push(var, expr);
+    if (auto call = expr.as<CallNode>()) {
+      defs_[var] = GetRef<Call>(call);
+    }
+  }
+
+  /*! \brief Emit a binding of the expr to a new var with the given type. */
+  Var EmitNew(const Expr& expr, const Type& type) {
+    auto var = MakeVar("nhwc", {});
+    var->checked_type_ = type;
+    Emit(var, expr);
+    return var;
+  }
+
+  /*! \brief Get the NHWC version of a 4-D NCHW tensor, which transposes it if not available. */
+  Var ToNHWC(const Expr& expr) {
+    if (expr->IsInstance<VarNode>()) {
+      auto var = Downcast<Var>(expr);
+      if (nhwc_.count(var)) {
+        return nhwc_[var];
+      } else if (transposed_.count(var)) {
+        return transposed_[var];
+      }
+    }
+    const auto* ttype = expr->type_as<TensorTypeNode>();
+    auto type = TensorType(Permute(ttype->shape, kToNHWC), ttype->dtype);
+    auto var = EmitNew(Call(Op::Get("raf.op.transpose"), {expr, MakeAxes(kToNHWC)}), type);
+    if (expr->IsInstance<VarNode>()) {
+      transposed_[Downcast<Var>(expr)] = var;
+    }
+    return var;
+  }
+
+  /*!
+   * \brief Whether the convolution is worth running in NHWC. Tensor cores require float16 and
+   * the channels aligned to 8, and the NHWC kernels are provided by cuDNN and CUTLASS on CUDA.
+   */
+  bool ShouldConvert(const CallNode* call) {
+    if (call->args.size() != 9U || GetString(call->args[6]) != "NCHW" ||
+        GetString(call->args[7]) != "OIHW" || GetString(call->args[8]) != "NCHW") {
+      return false;
+    }
+    const auto* x_type = call->args[0]->type_as<TensorTypeNode>();
+    const auto* w_type = call->args[1]->type_as<TensorTypeNode>();
+    if (x_type->shape.size() != 4U || w_type->shape.size() != 4U) {
+      return false;
+    }
+    if (force_) {
+      return true;
+    }
+    int64_t in_channels = GetDim(x_type->shape[1]);
+    int64_t out_channels = GetDim(w_type->shape[0]);
+    return x_type->dtype.is_float16() && w_type->dtype.is_float16() && in_channels > 0 &&
+           out_channels > 0 && in_channels % 8 == 0 && out_channels % 8 == 0;
+  }
+
+  Var ConvertConv2D(const Call& call, const TensorTypeNode* out_type) {
+    if (!ShouldConvert(call.get())) {
+      return Var();
+    }
+    Array<Expr> args = call->args;
+    args.Set(0, ToNHWC(call->args[0]));
+    // OIHW to OHWI is the same permutation, and the weights shared by convolutions are
+    // transposed once. The transposes of constant weights are folded by FoldConstant.
+    args.Set(1, ToNHWC(call->args[1]));
+    args.Set(6, MakeString("NHWC"));
+    args.Set(7, MakeString("OHWI"));
+    args.Set(8, MakeString("NHWC"));
+    auto type = TensorType(Permute(out_type->shape, kToNHWC), out_type->dtype);
+    return EmitNew(Call(call->op, args, call->attrs, call->type_args), type);
+  }
+
+  /*!
+   * \brief Propagate the NHWC layout through a call whose inputs are available in NHWC, and
+   * return the NHWC output, or an undefined var if the call cannot be propagated.
+   */
+  Var Propagate(const Call& call, const TensorTypeNode* out_type) {
+    static const std::unordered_set<std::string> elementwise_ops = {
+        "raf.op.relu",     "raf.op.gelu",     "raf.op.sigmoid",  "raf.op.tanh",
+        "raf.op.negative", "raf.op.abs",      "raf.op.exp",      "raf.op.log",
+        "raf.op.sqrt",     "raf.op.rsqrt",    "raf.op.erf",      "raf.op.cast",
+        "raf.op.copy",     "raf.op.clip",     "raf.op.add",      "raf.op.subtract",
+        "raf.op.multiply", "raf.op.divide",   "raf.op.maximum",  "raf.op.minimum",
+        "raf.op.power",    "raf.op.relu_dx"};
+    // The pooling ops and the index of their layout argument.
+    static const std::unordered_map<std::string, int> pool_ops = {
+        {"raf.op.max_pool2d", 7},
+        {"raf.op.avg_pool2d", 7},
+        {"raf.op.adaptive_max_pool2d", 2},
+        {"raf.op.adaptive_avg_pool2d", 2}};
+    const auto* op = call->op.as<OpNode>();
+    if (op == nullptr) {
+      return Var();
+    }
+    Array<Expr> args = call->args;
+    auto pool_it = pool_ops.find(op->name);
+    if (pool_it != pool_ops.end()) {
+      int layout_index = pool_it->second;
+      if (args.size() <= static_cast<size_t>(layout_index) ||
+          GetString(args[layout_index]) != "NCHW" || !HasNHWC(args[0])) {
+        return Var();
+      }
+      args.Set(0, ToNHWC(args[0]));
+      args.Set(layout_index, MakeString("NHWC"));
+    } else if (elementwise_ops.count(op->name)) {
+      if (!PropagateElementwise(out_type, &args)) {
+        return Var();
+      }
+    } else {
+      return Var();
+    }
+    auto type = TensorType(Permute(out_type->shape, kToNHWC), out_type->dtype);
+    return EmitNew(Call(call->op, args, call->attrs, call->type_args), type);
+  }
+
+  /*!
+   * \brief Rewrite the tensor arguments of an elementwise op to NHWC. The op is converted if an
+   * argument is already in NHWC, and the other arguments are NCHW tensors of the output shape,
+   * scalars, or per-channel tensors of shape [C, 1, 1] or [1, C, 1, 1], which are reshaped to [C]
+   * to be broadcast in NHWC.
+   */
+  bool PropagateElementwise(const TensorTypeNode* out_type, Array<Expr>* args) {
+    static const Op& reshape = Op::Get("raf.op.reshape");
+    bool has_nhwc = false;
+    for (const auto& arg : *args) {
+      has_nhwc = has_nhwc || HasNHWC(arg);
+    }
+    if (!has_nhwc) {
+      return false;
+    }
+    int64_t channels = GetDim(out_type->shape[1]);
+    // The arguments to be transposed and to be reshaped as per-channel tensors.
+    std::vector<size_t> to_transpose, to_reshape;
+    for (size_t i = 0; i < args->size(); ++i) {
+      const auto& arg = (*args)[i];
+      if (!arg->checked_type_.defined() || !arg->checked_type()->IsInstance<TensorTypeNode>()) {
+        // Scalars and null values are layout-agnostic.
+        continue;
+      }
+      const auto* ttype = arg->type_as<TensorTypeNode>();
+      std::vector<int64_t> shape;
+      for (const auto& dim : ttype->shape) {
+        shape.push_back(GetDim(dim));
+      }
+      if (shape.empty() || shape == std::vector<int64_t>{1}) {
+        continue;
+      } else if (shape.size() == 4U && StructuralEqual()(ttype->shape, out_type->shape)) {
+        to_transpose.push_back(i);
+      } else if (channels > 0 && (shape == std::vector<int64_t>{channels, 1, 1} ||
+                                  shape == std::vector<int64_t>{1, channels, 1, 1})) {
+        to_reshape.push_back(i);
+      } else {
+        return false;
+      }
+    }
+    for (auto i : to_transpose) {
+      args->Set(i, ToNHWC((*args)[i]));
+    }
+    for (auto i : to_reshape) {
+      const auto& arg = (*args)[i];
+      auto type = TensorType({Integer(channels)}, arg->type_as<TensorTypeNode>()->dtype);
+      auto shape = MakeConstant(TupleValue::make(Array<Value>{ScalarValue::make(channels)}));
+      args->Set(i, EmitNew(Call(reshape, {arg, shape}), type));
+    }
+    return true;
+  }
+
+  bool HasNHWC(const Expr& expr) {
+    return expr->IsInstance<VarNode>() && nhwc_.count(Downcast<Var>(expr));
+  }
+
+  /*!
+   * \brief Cancel the transposes: transpose(x, NCHW->NHWC) is replaced by the NHWC version of x,
+   * and transpose(transpose(x, p), q) is replaced by x if the permutations cancel each other.
+   * Return the replacement, or an undefined expr if the transpose is kept.
+   */
+  Expr CancelTranspose(const Call& call) {
+    auto axes = GetAxes(call->args[1]);
+    if (axes.empty()) {
+      return Expr();
+    }
+    if (axes == kToNHWC && call->args[0]->IsInstance<VarNode>()) {
+      auto var = Downcast<Var>(call->args[0]);
+      if (nhwc_.count(var)) {
+        return nhwc_[var];
+      } else if (transposed_.count(var)) {
+        return transposed_[var];
+      }
+    }
+    auto it = defs_.find(call->args[0]);
+    if (it == defs_.end() || it->second->op != call->op) {
+      return Expr();
+    }
+    auto inner_axes = GetAxes(it->second->args[1]);
+    if (inner_axes.size() != axes.size()) {
+      return Expr();
+    }
+    for (size_t i = 0; i < axes.size(); ++i) {
+      if (inner_axes[axes[i]] != static_cast<int64_t>(i)) {
+        return Expr();
+      }
+    }
+    return it->second->args[0];
+  }
+
+  /*! \brief The target function. */
+  Function func_;
+  /*! \brief Whether to convert all NCHW convolutions regardless of the dtypes and channels. */
+  bool force_;
+  /*! \brief The rewritten let list. */
+  ExplicitLetList ell_;
+  /*! \brief Mapping from a rewritten let var to its call. */
+  std::unordered_map<Expr, Call, ObjectPtrHash, ObjectPtrEqual> defs_;
+  /*! \brief Mapping from an NCHW var to its NHWC version, for the outputs of converted calls. */
+  std::unordered_map<Var, Var, ObjectPtrHash, ObjectPtrEqual> nhwc_;
+  /*!
+   * \brief Mapping from an NCHW var to its transpose to NHWC, for the inputs of the NHWC regions.
+   * These vars are not propagated to the other consumers, which would add transposes.
+   */
+  std::unordered_map<Var, Var, ObjectPtrHash, ObjectPtrEqual> transposed_;
+  /*! \brief Mapping from an eliminated let var to its replacement. */
+  Map<Var, Expr> subst_;
+};
+
+}  // namespace convert_layout
+
+Pass ConvertLayout() {
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
+                                                                             PassContext pc) {
+    std::string policy = pc->GetConfig("raf.layout.policy", String("auto")).value();
+    CHECK(policy == "auto" || policy == "nhwc" || policy == "none")
+        << "Unknown layout policy: " << policy;
+    auto device = Device::Current(true);
+    if (policy == "none" || device.device_type() != DevType::kCUDA() ||
+        (!Dialect::IsEnabled("cudnn", DevType::kCUDA()) &&
+         !Dialect::IsEnabled("cutlass", DevType::kCUDA()))) {
+      return f;
+    }
+    // The types are only inferred when the pass applies.
+    f = Downcast<Function>(InferTypeWithModule(f, m));
+    auto ret = convert_layout::LayoutConverter(f, policy).Run();
+    // Remove the NCHW outputs that are only consumed in NHWC.
+    return Downcast<Function>(DeadCodeElimination(ret));
+  };
+  return CreateRAFFunctionPass(pass_func, 1, "ConvertLayout", {});
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.ConvertLayout").set_body_typed(ConvertLayout);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.layout.policy", String);
+
+}  // namespace pass
+}  // namespace raf
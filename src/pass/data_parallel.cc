@@ -16,6 +16,7 @@
 #include "raf/profiler.h"
 #include "raf/stream_pool.h"
 #include "./common.h"
+#include "./comm_cost_model.h"
 
 #ifdef RAF_USE_NCCL
 #include "../op/dialect/nccl/communication_utils.h"
@@ -137,6 +138,75 @@ struct DataParallel {
       : func(func), fp_ell(ExplicitLetList::make(func->body)) {
   }
 
+  /*!
+   * \brief Choose the number of gradients in the backward order whose communication is issued
+   * before the computation finishes.
+   * \param latencies The latency of each backward op in order, where the communication ops are
+   * negative and the computation ops are positive.
+   */
+  static int ChooseSchedulingParameter(const std::vector<double>& latencies) {
+    double comp_total_time = 0;
+    int first_comm_op = 0;
+    int bp_order_grad_count = 0;
+
+    // Get the location of the communication op.
+    for (int i = 0; i < latencies.size(); i++) {
+      if (latencies[i] < 0) break;
+      first_comm_op++;
+    }
+
+    // Compute the total execution time of comp ops after the first allreduce.
+    for (int i = first_comm_op + 1; i < latencies.size(); i++)
+      if (latencies[i] >= 0) comp_total_time += latencies[i];
+
+    // Choose the scheduling point, in which computation has finished but communication hasn't.
+    for (int i = first_comm_op; i < latencies.size(); i++) {
+      if (latencies[i] < 0) {
+        comp_total_time += latencies[i];
+        bp_order_grad_count++;
+        if (comp_total_time <= 0) break;
+      }
+    }
+    return bp_order_grad_count;
+  }
+
+  /*!
+   * \brief Compute the dctx->scheduling_param from the cost model instead of profiling the first
+   * iterations, so it takes effect from the first iteration. The computation ops take their
+   * latencies from the op profiler, which are reloaded from the persistent cache if they have been
+   * profiled by any previous job on the same device, and the allreduce ops take the latencies of
+   * the communication cost model.
+   */
+  void EstimateSchedulingParameters(const IRModule& mod) {
+    static const Op& allreduce_op = Op::Get("raf.op._allreduce");
+    using comm_cost_model::CommComputeCostModel;
+    auto device = Device::Current(false);
+    op_profiler::OpProfiler* profiler = nullptr;
+    // The op profiler only profiles on the first device of the process.
+    if ((device.device_type() == DevType::kCUDA() || device.device_type() == DevType::kCPU()) &&
+        device.device_id() == 0) {
+      profiler = op_profiler::OpProfiler::Get(device);
+    }
+    CommComputeCostModel cost_model(mod, profiler);
+    std::vector<double> latencies;
+    for (size_t i = 0; i < bp_ell->vars.size(); ++i) {
+      const auto* call = bp_ell->exprs[i].as<CallNode>();
+      if (call == nullptr) {
+        continue;
+      }
+      if (call->op.same_as(allreduce_op)) {
+        // The inserted allreduce is not typed yet, so its message size is the local gradient.
+        auto grad = Downcast<Tuple>(bp_tuples_.at(Downcast<Var>(call->args[0])))->fields[0];
+        double bytes = CommComputeCostModel::TensorBytes(grad->checked_type());
+        latencies.push_back(-cost_model.CommLatency(allreduce_op, bytes));
+      } else if (call->checked_type_.defined() &&
+                 (call->op->IsInstance<OpNode>() || call->op->IsInstance<FunctionNode>())) {
+        latencies.push_back(cost_model.Latency(bp_ell->exprs[i]));
+      }
+    }
+    DistContext::Global()->scheduling_param = ChooseSchedulingParameter(latencies);
+  }
+
   // Compute the dctx->scheduling_param according to the analysis of op profiling.
   void GetSchedulingParameters() {
     auto dctx = DistContext::Global();
@@ -176,42 +246,26 @@ struct DataParallel {
       Profiler::Get()->set_profile_level(prof_level);  // Enbale user's config
       // Analyse the profiling result of iter2-iter4,
       // and figure out a scheduling strategy.
-      int64_t comp_total_time = 0;
-      int first_comm_op = 0;
-      int bp_order_grad_count = 0;
-
-      // Get the location of the communication op.
-      for (int i = 0; i < op_running_time.size(); i++) {
-        if (op_running_time[i].second < 0) break;
-        first_comm_op++;
-      }
-
-      // Compute the total execution time of comp ops after the first allreduce.
-      for (int i = first_comm_op + 1; i < op_running_time.size(); i++)
-        if (op_running_time[i].second >= 0) comp_total_time += op_running_time[i].second;
-
-      // Choose the scheduling point, in which computation has finished but communication hasn't.
-      for (int i = first_comm_op; i < op_running_time.size(); i++) {
-        if (op_running_time[i].second < 0) {
-          comp_total_time += op_running_time[i].second;
-          bp_order_grad_count++;
-          if (comp_total_time <= 0) break;
-        }
+      std::vector<double> latencies;
+      for (const auto& item : op_running_time) {
+        latencies.push_back(item.second);
       }
       // Currently we only have one scheduling parameter, set it here.
-      dctx->scheduling_param = bp_order_grad_count;
+      dctx->scheduling_param = ChooseSchedulingParameter(latencies);
 
       // clear the cached profiling analysis.
       op_running_time.clear();
     }
   }
 
-  Function Run() {
+  Function Run(const IRModule& mod) {
     auto dctx = DistContext::Global();
+    bool online_profiling =
+        PassContext::Current()->GetConfig("raf.auto_dp.online_profiling", Bool(false)).value();
 
     // If we want to overlap communication and forward pass,
     // we need to analyze the running time of Ops
-    if (dctx->iteration <= dctx->auto_dp_profiling_end_iter + 1) {
+    if (online_profiling && dctx->iteration <= dctx->auto_dp_profiling_end_iter + 1) {
       GetSchedulingParameters();
     }
     size_t fp_n = fp_ell->vars.size();
@@ -275,6 +329,7 @@ struct DataParallel {
 #if defined RAF_USE_NCCL && NCCL_VERSION_CODE >= 21000
         bp_ell->vars[p2 - 1] = input_var;
         bp_ell->exprs[p2 - 1] = Tuple({bp_ell->vars[i]});
+        bp_tuples_[input_var] = bp_ell->exprs[p2 - 1];
         // Here we name the var as 'g'(global gradient), to help us identify it easier.
         bp_ell->vars[p2] = raf::ir::MakeVar("g", {});
         bp_ell->exprs[p2] = Call(op_allreduce, {bp_ell->vars[p2 - 1],
@@ -285,6 +340,7 @@ struct DataParallel {
         static Op op_div = Op::Get("raf.op.divide");
         bp_ell->vars[p2 - 2] = input_var;
         bp_ell->exprs[p2 - 2] = Tuple({bp_ell->vars[i]});
+        bp_tuples_[input_var] = bp_ell->exprs[p2 - 2];
         bp_ell->vars[p2 - 1] = raf::ir::MakeVar("g_sum", {});
         bp_ell->exprs[p2 - 1] =
             Call(op_allreduce,
@@ -326,6 +382,9 @@ struct DataParallel {
       LOG(FATAL) << "Return of backward IR must be Var or tuple of Vars in Data Parallel Pass.";
     }
 
+    if (!online_profiling) {
+      EstimateSchedulingParameters(mod);
+    }
     dctx->iteration++;
 
     bp_n = bp_ell->vars.size();
@@ -349,19 +408,28 @@ struct DataParallel {
   const std::set<std::string> scheduled_communication_ops = {"raf.op._allreduce"};
   // The global gradient set
   std::unordered_set<Var, ObjectPtrHash, ObjectPtrEqual> global_grad;
+  // The input tuples of the inserted allreduce ops.
+  std::unordered_map<Var, Expr, ObjectPtrHash, ObjectPtrEqual> bp_tuples_;
 };
 
 }  // namespace data_parallel
 
 Pass AutoDataParallel() {
+  using raf::distributed::DistContext;
   TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
                                                                              PassContext pc) {
-    return data_parallel::DataParallel(f.operator->()).Run();
+    if (DistContext::Global()->local_sgd_period > 1) {
+      // Local SGD applies the local gradients, and averages the parameters every
+      // local_sgd_period steps instead (see raf.optim.sgd).
+      return f;
+    }
+    return data_parallel::DataParallel(f.operator->()).Run(m);
   };
   return CreateRAFFunctionPass(pass_func, 0, "AutoDataParallel", {"InferType"});
 }
 
 RAF_REGISTER_GLOBAL("raf.pass_.AutoDataParallel").set_body_typed(AutoDataParallel);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.auto_dp.online_profiling", Bool);
 
 }  // namespace pass
 }  // namespace raf
@@ -7,6 +7,8 @@
  * \file data_parallel_schedule.cc
  * \brief Schedules ops during data parallel training.
  */
+#include <algorithm>
+#include <limits>
 #include <queue>
 #include <unordered_set>
 #include <relay/transforms/pass_utils.h>
@@ -18,6 +20,7 @@
 #include "raf/pass.h"
 #include "raf/analysis.h"
 #include "./common.h"
+#include "./comm_cost_model.h"
 #include "let_list.h"
 #include "stream_schedule.h"
 #include "raf/stream_pool.h"
@@ -29,6 +32,7 @@ namespace data_parallel_schedule {
 using namespace raf::ir;
 using raf::distributed::DistContext;
 using namespace raf::analysis;
+using comm_cost_model::CommComputeCostModel;
 using op::IsCollectiveOp;
 using stream_pool::StreamTagEnum;
 using tvm::OpAttrMap;
@@ -37,6 +41,101 @@ using LinkedList = tvm::relay::LinkedList<Node*>;
 using NodeExprMap = std::unordered_map<const Node*, Expr>;
 using stream_schedule::StreamSchedulerBase;
 
+/*!
+ * \brief Limit how far the allgathers of the partitioned parameters (e.g., ZeRO-3 or sharded
+ * inference) run ahead of the computation. Since their inputs are ready at the beginning, a
+ * scheduler would otherwise launch all of them first and keep every gathered parameter alive. The
+ * gathers are ordered by their first consumers in post DFS order, and the gather k+depth is
+ * released once the first consumer of the gather k is scheduled. With depth 1, the gather of the
+ * next layer overlaps the computation of the current layer, so only two gathered parameters are
+ * alive at a time and the memory planner reuses their buffers. Depth 0 releases all gathers at the
+ * beginning.
+ */
+class ParameterPrefetcher {
+ public:
+  ParameterPrefetcher(const std::vector<Node*>& nodes, const NodeExprMap& node_expr) {
+    static const Op& allgather_op = Op::Get("raf.op._allgather");
+    auto ctx = PassContext::Current();
+    depth_ = ctx->GetConfig("raf.dp_schedule.param_prefetch_depth", Integer(1)).value()->value;
+    CHECK_GE(depth_, 0) << "The depth of the parameter prefetch must be non-negative";
+    if (depth_ == 0) {
+      return;
+    }
+    std::unordered_map<const Node*, int> order;
+    for (int i = 0; i < nodes.size(); ++i) {
+      order[nodes[i]] = i;
+    }
+    std::vector<std::pair<int, Node*>> gathers;
+    for (Node* node : nodes) {
+      auto call = node_expr.at(node).as<CallNode>();
+      if (call == nullptr || !call->op.same_as(allgather_op) || node->children.head != nullptr) {
+        continue;
+      }
+      int first_use = nodes.size();
+      for (auto parent = node->parents.head; parent; parent = parent->next) {
+        first_use = std::min(first_use, order.at(parent->value));
+      }
+      gathers.emplace_back(first_use, node);
+    }
+    std::stable_sort(gathers.begin(), gathers.end(),
+                     [](const std::pair<int, Node*>& lhs, const std::pair<int, Node*>& rhs) {
+                       return lhs.first < rhs.first;
+                     });
+    for (int i = 0; i < gathers.size(); ++i) {
+      gathers_.push_back(gathers[i].second);
+      index_[gathers[i].second] = i;
+    }
+    next_ = depth_;
+  }
+
+  /*! \brief Whether a node with no inputs is held back instead of being ready at the beginning. */
+  bool Held(Node* node) const {
+    auto it = index_.find(node);
+    return it != index_.end() && it->second >= depth_;
+  }
+
+  /*!
+   * \brief Release the gathers that become ready after the node is scheduled.
+   * \return The released gathers.
+   */
+  std::vector<Node*> Scheduled(Node* node) {
+    std::vector<Node*> released;
+    for (auto child = node->children.head; child; child = child->next) {
+      auto it = index_.find(child->value);
+      if (it != index_.end() && used_.insert(child->value).second) {
+        ReleaseUntil(it->second + depth_, &released);
+      }
+    }
+    return released;
+  }
+
+  /*!
+   * \brief Release the next held gather, which is used when nothing else is ready.
+   * \return The released gather, or nullptr if no gather is held.
+   */
+  Node* ReleaseNext() {
+    return next_ < gathers_.size() ? gathers_[next_++] : nullptr;
+  }
+
+ private:
+  void ReleaseUntil(int index, std::vector<Node*>* released) {
+    for (; next_ <= index && next_ < gathers_.size(); ++next_) {
+      released->push_back(gathers_[next_]);
+    }
+  }
+
+  /*! \brief The number of gathers that can run ahead of the computation. */
+  int depth_;
+  /*! \brief The parameter gathers in the order of their first consumers. */
+  std::vector<Node*> gathers_;
+  /*! \brief The index of each parameter gather. */
+  std::unordered_map<const Node*, int> index_;
+  /*! \brief The gathers whose first consumer has been scheduled. */
+  std::unordered_set<const Node*> used_;
+  /*! \brief The index of the next held gather. */
+  int next_ = 0;
+};
+
 class FIFOScheduler : public StreamSchedulerBase {
  public:
   /*! This scheduler schedules the execution order of ops so communication ops can better overlap
@@ -140,9 +239,10 @@ class FIFOScheduler : public StreamSchedulerBase {
         out_degree[(*node_it)]++;
       }
     }
-    // push nodes with zero predecessors into the queue
+    // push nodes with zero predecessors into the queue, except the held parameter gathers
+    ParameterPrefetcher prefetcher(nodes, node_expr);
     for (auto& node : nodes) {
-      if (out_degree[node] == 0) {
+      if (out_degree[node] == 0 && !prefetcher.Held(node)) {
         ready_queue.push(node);
       }
     }
@@ -164,11 +264,21 @@ class FIFOScheduler : public StreamSchedulerBase {
             }
           }
         }
+        for (Node* gather : prefetcher.Scheduled(node)) {
+          ready_queue.push(gather);
+        }
         q.pop();
       }
     };
 
-    while (!ready_queue.empty() || !comm_successor_ready_queue.empty()) {
+    while (true) {
+      if (ready_queue.empty() && comm_successor_ready_queue.empty()) {
+        Node* gather = prefetcher.ReleaseNext();
+        if (gather == nullptr) {
+          break;
+        }
+        ready_queue.push(gather);
+      }
       process_queue_element(ready_queue);
       process_queue_element(comm_successor_ready_queue);
     }
@@ -181,18 +291,271 @@ Expr FIFOScheduleTransform(const Expr& e) {
   return FIFOScheduler().Schedule(e);
 }
 
+/*! \brief The expected timeline of an iteration, in microseconds. */
+struct CommOverlap {
+  /*! \brief The busy time of the computation stream. */
+  double compute = 0;
+  /*! \brief The busy time of the communication stream. */
+  double comm = 0;
+  /*! \brief The end-to-end latency of the iteration. */
+  double total = 0;
+
+  /*! \brief The communication time that is not overlapped with computation. */
+  double Exposed() const {
+    return total - compute;
+  }
+};
+
+/*!
+ * \brief Simulate the timeline of one computation stream and one communication stream, where ops
+ * are launched to their streams in order, and an op starts when both its stream and its inputs are
+ * ready. This is also used to report the expected overlap of a scheduled ANF function.
+ */
+class TimelineSimulator {
+ public:
+  explicit TimelineSimulator(CommComputeCostModel* cost_model) : cost_model_(cost_model) {
+  }
+
+  /*!
+   * \brief The earliest time that the given expr can start.
+   * \param expr The expr to be launched.
+   * \param ready The time that all inputs of the expr are ready.
+   */
+  double StartTime(const Expr& expr, double ready) const {
+    return std::max(ready, CommComputeCostModel::IsComm(expr) ? comm_free_ : compute_free_);
+  }
+
+  /*! \brief Launch the given expr and return its finish time. */
+  double Launch(const Expr& expr, double ready) {
+    double start = StartTime(expr, ready);
+    double latency = cost_model_->Latency(expr);
+    double finish = start + latency;
+    if (CommComputeCostModel::IsComm(expr)) {
+      comm_free_ = finish;
+      overlap_.comm += latency;
+    } else {
+      compute_free_ = finish;
+      overlap_.compute += latency;
+    }
+    overlap_.total = std::max(overlap_.total, finish);
+    return finish;
+  }
+
+  const CommOverlap& Overlap() const {
+    return overlap_;
+  }
+
+ private:
+  /*! \brief The cost model. */
+  CommComputeCostModel* cost_model_;
+  /*! \brief The time that the computation stream becomes free. */
+  double compute_free_ = 0;
+  /*! \brief The time that the communication stream becomes free. */
+  double comm_free_ = 0;
+  /*! \brief The expected timeline so far. */
+  CommOverlap overlap_;
+};
+
+class CommAwareScheduler : public StreamSchedulerBase {
+ public:
+  /*!
+   * This scheduler models the latency of both communication and computation ops, and issues ops
+   * with a list scheduling over a simulated timeline of the computation and communication streams.
+   * Compared to FIFOScheduler, which only delays the direct successors of collectives, it
+   *   1. launches a collective as soon as its inputs are scheduled, so the gradient communication
+   *      starts as early as possible;
+   *   2. among the ready computation ops, picks the one with the earliest start time, so an op
+   *      waiting for an unfinished collective is delayed as long as other work is available;
+   *   3. breaks ties by the remaining computation time to reach the next collective, so the ops
+   *      producing gradients (e.g., of the later layers in the backward) run first and their
+   *      communication overlaps with the backward of the earlier layers.
+   * The expected overlap is available in Overlap() after scheduling.
+   */
+  explicit CommAwareScheduler(const IRModule& mod) : cost_model_(mod), timeline_(&cost_model_) {
+  }
+
+  Expr Schedule(Expr e) {
+    Arena arena;
+    DependencyGraph dfg = CreateDependencyGraph(&arena, e, /*prune_atomic_nodes=*/true);
+    NodeExprMap node_expr;
+    for (auto& it : dfg.expr_node) {
+      node_expr[it.second] = it.first;
+    }
+    std::vector<Node*>& nodes = dfg.post_dfs_order;
+    std::unordered_map<const Node*, int> order;
+    for (int i = 0; i < nodes.size(); ++i) {
+      order[nodes[i]] = i;
+    }
+
+    // The remaining computation time from each node to the next collective (exclusive), or
+    // infinity if no collective depends on it. Parents (consumers) come later in post DFS order.
+    constexpr double kInf = std::numeric_limits<double>::infinity();
+    std::unordered_map<const Node*, double> to_comm;
+    for (auto it = nodes.rbegin(); it != nodes.rend(); ++it) {
+      const Expr& expr = node_expr.at(*it);
+      if (CommComputeCostModel::IsComm(expr)) {
+        to_comm[*it] = 0;
+        continue;
+      }
+      double dist = kInf;
+      for (auto parent = (*it)->parents.head; parent; parent = parent->next) {
+        dist = std::min(dist, to_comm.at(parent->value));
+      }
+      to_comm[*it] = dist + cost_model_.Latency(expr);
+    }
+
+    // The number of unscheduled inputs, and the time that all scheduled inputs finish.
+    std::unordered_map<const Node*, int> num_inputs;
+    std::unordered_map<const Node*, double> ready_time;
+    std::vector<Node*> ready;
+    ParameterPrefetcher prefetcher(nodes, node_expr);
+    for (Node* node : nodes) {
+      num_inputs[node] = 0;
+      ready_time[node] = 0;
+      for (auto child = node->children.head; child; child = child->next) {
+        num_inputs[node]++;
+      }
+      if (num_inputs[node] == 0 && !prefetcher.Held(node)) {
+        ready.push_back(node);
+      }
+    }
+
+    Expr ret;
+    while (true) {
+      if (ready.empty()) {
+        Node* gather = prefetcher.ReleaseNext();
+        if (gather == nullptr) {
+          break;
+        }
+        ready.push_back(gather);
+      }
+      // Collectives are launched first, then the computation op that starts the earliest.
+      auto better = [&](Node* lhs, Node* rhs) {
+        bool lhs_comm = CommComputeCostModel::IsComm(node_expr.at(lhs));
+        bool rhs_comm = CommComputeCostModel::IsComm(node_expr.at(rhs));
+        if (lhs_comm != rhs_comm) {
+          return lhs_comm;
+        }
+        double lhs_start = timeline_.StartTime(node_expr.at(lhs), ready_time[lhs]);
+        double rhs_start = timeline_.StartTime(node_expr.at(rhs), ready_time[rhs]);
+        if (lhs_start != rhs_start) {
+          return lhs_start < rhs_start;
+        }
+        if (to_comm[lhs] != to_comm[rhs]) {
+          return to_comm[lhs] < to_comm[rhs];
+        }
+        return order[lhs] < order[rhs];
+      };
+      auto best = std::min_element(ready.begin(), ready.end(), better);
+      Node* node = *best;
+      ready.erase(best);
+
+      ret = VisitExpr(node_expr.at(node));
+      double finish = timeline_.Launch(node_expr.at(node), ready_time[node]);
+      for (auto parent = node->parents.head; parent; parent = parent->next) {
+        ready_time[parent->value] = std::max(ready_time[parent->value], finish);
+        if (--num_inputs[parent->value] == 0) {
+          ready.push_back(parent->value);
+        }
+      }
+      for (Node* gather : prefetcher.Scheduled(node)) {
+        ready.push_back(gather);
+      }
+    }
+    return let_list_.Get(ret);
+  }
+
+  const CommOverlap& Overlap() const {
+    return timeline_.Overlap();
+  }
+
+ private:
+  /*! \brief The cost model of the ops. */
+  CommComputeCostModel cost_model_;
+  /*! \brief The simulated timeline of the scheduled ops. */
+  TimelineSimulator timeline_;
+};
+
+/*! \brief Simulate the expected overlap of the given function in its ANF order. */
+CommOverlap SimulateANF(const Function& func, const IRModule& mod) {
+  CommComputeCostModel cost_model(mod);
+  TimelineSimulator timeline(&cost_model);
+  std::unordered_map<const VarNode*, double> finish;
+  auto ell = ExplicitLetList::make(func->body);
+  for (int i = 0; i < ell->vars.size(); ++i) {
+    double ready = 0;
+    for (const auto& var : FreeVars(ell->exprs[i])) {
+      auto it = finish.find(var.get());
+      if (it != finish.end()) {
+        ready = std::max(ready, it->second);
+      }
+    }
+    finish[ell->vars[i].get()] = timeline.Launch(ell->exprs[i], ready);
+  }
+  return timeline.Overlap();
+}
+
+void LogOverlap(const CommOverlap& overlap) {
+  LOG(INFO) << "Expected iteration latency " << overlap.total << " us: computation "
+            << overlap.compute << " us, communication " << overlap.comm << " us, exposed "
+            << "communication " << overlap.Exposed() << " us";
+}
+
 }  // namespace data_parallel_schedule
 
 Pass DataParallelSchedule() {
+  auto ctx = PassContext::Current();
+  auto policy = ctx->GetConfig<String>("raf.dp_schedule.policy", String("fifo")).value();
+  if (policy == "fifo") {
+    TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func =
+        [=](Function f, IRModule m, PassContext pc) {
+          return Downcast<Function>(
+              tvm::relay::TransformF(data_parallel_schedule::FIFOScheduleTransform, f));
+        };
+    return CreateRAFFunctionPass(pass_func, 0, "DataParallelSchedule", {});
+  }
+  CHECK_EQ(policy, "comm_aware") << "Unknown data parallel schedule policy: " << policy
+                                 << ". Expected fifo or comm_aware.";
+  bool verbose = ctx->GetConfig("raf.dp_schedule.verbose", Bool(false)).value();
   TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
                                                                              PassContext pc) {
-    return Downcast<Function>(
-        tvm::relay::TransformF(data_parallel_schedule::FIFOScheduleTransform, f));
+    auto transform = [&](Expr e) {
+      data_parallel_schedule::CommAwareScheduler scheduler(m);
+      auto ret = scheduler.Schedule(e);
+      if (verbose) {
+        data_parallel_schedule::LogOverlap(scheduler.Overlap());
+      }
+      return ret;
+    };
+    return Downcast<Function>(tvm::relay::TransformF(transform, f));
   };
-  return CreateRAFFunctionPass(pass_func, 0, "DataParallelSchedule", {});
+  // The cost model requires the types to estimate the message sizes and GFLOPS.
+  auto schedule = CreateRAFFunctionPass(pass_func, 0, "DataParallelScheduleFunc", {});
+  return RAFSequential({InferType(), schedule, EraseType()}, "DataParallelSchedule");
+}
+
+/*!
+ * \brief Estimate the timeline of the main function in ANF with the cost model of the comm_aware
+ * data parallel schedule.
+ * \return [end-to-end latency, computation time, communication time, exposed communication] in
+ * microseconds.
+ */
+Array<FloatImm> EstimateCommOverlap(const IRModule& mod) {
+  auto typed_mod = InferType()(mod);
+  auto func = Downcast<Function>(typed_mod->Lookup("main"));
+  auto overlap = data_parallel_schedule::SimulateANF(func, typed_mod);
+  auto f32 = [](double v) { return FloatImm(DataType::Float(32), v); };
+  return {f32(overlap.total), f32(overlap.compute), f32(overlap.comm), f32(overlap.Exposed())};
 }
 
 RAF_REGISTER_GLOBAL("raf.pass_.DataParallelSchedule").set_body_typed(DataParallelSchedule);
+RAF_REGISTER_GLOBAL("raf.pass_.EstimateCommOverlap").set_body_typed(EstimateCommOverlap);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.dp_schedule.policy", String);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.dp_schedule.compute_tflops", IntImm);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.dp_schedule.comm_bandwidth", IntImm);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.dp_schedule.num_workers", IntImm);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.dp_schedule.verbose", Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.dp_schedule.param_prefetch_depth", IntImm);
 
 }  // namespace pass
 }  // namespace raf
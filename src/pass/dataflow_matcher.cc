@@ -7,6 +7,7 @@
  * \file dataflow_matcher.cc
  * \brief The auxiliary data structure for dataflow matcher.
  */
+#include <unordered_set>
 #include <raf/registry.h>
 
 #include "dataflow_matcher_impl.h"
@@ -151,13 +152,24 @@ bool RAFDFPatternMatcher::VisitDFPattern_(const RelayConstantPatternNode* op, co
   return konst != nullptr && tvm::StructuralEqual()(konst->value, node->value);
 }
 
+/*!
+ * \brief Get the type of an expression. The types inferred before matching (e.g., for callbacks
+ * that require types) are reused, so that the sub-graph is not re-inferred at every match.
+ */
+Type GetCheckedType(const Expr& expr) {
+  if (expr->checked_type_.defined()) {
+    return expr->checked_type_;
+  }
+  return InferType(expr).as<ExprNode>()->checked_type();
+}
+
 bool RAFDFPatternMatcher::VisitDFPattern_(const TypePatternNode* op, const Expr& expr) {
-  auto expr_type = InferType(expr).as<ExprNode>()->checked_type();
+  auto expr_type = GetCheckedType(expr);
   return (tvm::StructuralEqual()(op->type, expr_type)) && VisitDFPattern(op->pattern, expr);
 }
 
 bool RAFDFPatternMatcher::VisitDFPattern_(const ShapePatternNode* op, const Expr& expr) {
-  auto expr_type = InferType(expr).as<ExprNode>()->checked_type();
+  auto expr_type = GetCheckedType(expr);
   if (const TensorTypeNode* tensor_type = expr_type.as<TensorTypeNode>()) {
     return (tvm::StructuralEqual()(op->shape, tensor_type->shape)) &&
            VisitDFPattern(op->pattern, expr);
@@ -166,7 +178,7 @@ bool RAFDFPatternMatcher::VisitDFPattern_(const ShapePatternNode* op, const Expr
 }
 
 bool RAFDFPatternMatcher::VisitDFPattern_(const DataTypePatternNode* op, const Expr& expr) {
-  auto expr_type = InferType(expr).as<ExprNode>()->checked_type();
+  auto expr_type = GetCheckedType(expr);
   if (const TensorTypeNode* tensor_type = expr_type.as<TensorTypeNode>()) {
     return (tvm::StructuralEqual()(op->dtype, tensor_type->dtype)) &&
            VisitDFPattern(op->pattern, expr);
@@ -188,10 +200,108 @@ const std::unordered_map<int, RAFPatternGrouper::Group>& RAFPatternGrouper::Grou
   return this->groups_;
 }
 
+// Root Op Index
+inline const OpNode* GetBaseOpNode(const OpNode* op) {
+  auto ref = GetRef<Op>(op);
+  return op::IsDialectOp(ref) ? op::GetBaseOp(ref).get() : op;
+}
+
+/*!
+ * \brief Collect the (base) ops that the root of a pattern may match. Divide and multiply are
+ * matched to each other by the associative matching, so both are collected for either of them.
+ * \return false if the root may match an expression other than a call to an op.
+ */
+bool CollectRootOps(const DFPattern& pattern, std::unordered_set<const OpNode*>* ops) {
+  static const OpNode* multiply = Op::Get("raf.op.multiply").get();
+  static const OpNode* divide = Op::Get("raf.op.divide").get();
+  if (const auto* alt = pattern.as<AltPatternNode>()) {
+    return CollectRootOps(alt->left, ops) && CollectRootOps(alt->right, ops);
+  } else if (const auto* type = pattern.as<TypePatternNode>()) {
+    return CollectRootOps(type->pattern, ops);
+  } else if (const auto* shape = pattern.as<ShapePatternNode>()) {
+    return CollectRootOps(shape->pattern, ops);
+  } else if (const auto* dtype = pattern.as<DataTypePatternNode>()) {
+    return CollectRootOps(dtype->pattern, ops);
+  } else if (const auto* attr = pattern.as<AttrPatternNode>()) {
+    return CollectRootOps(attr->pattern, ops);
+  } else if (const auto* call = pattern.as<CallPatternNode>()) {
+    std::unordered_set<const OpNode*> callees;
+    std::vector<DFPattern> stack{call->op};
+    while (!stack.empty()) {
+      DFPattern callee = stack.back();
+      stack.pop_back();
+      if (const auto* alt = callee.as<AltPatternNode>()) {
+        stack.push_back(alt->left);
+        stack.push_back(alt->right);
+        continue;
+      }
+      const auto* expr = callee.as<ExprPatternNode>();
+      const auto* op = expr != nullptr ? expr->expr.as<OpNode>() : nullptr;
+      if (op == nullptr) {
+        return false;
+      }
+      op = GetBaseOpNode(op);
+      callees.insert(op);
+      if (op == multiply || op == divide) {
+        callees.insert(multiply);
+        callees.insert(divide);
+      }
+    }
+    ops->insert(callees.begin(), callees.end());
+    return true;
+  }
+  return false;
+}
+
+/*! \brief Collect the (base) ops of all calls in an expression, including nested functions. */
+class OpCollector : public MixedModeVisitor {
+ public:
+  using MixedModeVisitor::VisitExpr_;
+
+  void VisitExpr_(const LetNode* op) final {
+    Expr expr = GetRef<Expr>(op);
+    while (const auto* let = expr.as<LetNode>()) {
+      VisitExpr(let->value);
+      expr = let->body;
+    }
+    VisitExpr(expr);
+  }
+
+  void VisitExpr_(const OpNode* op) final {
+    ops_.insert(GetBaseOpNode(op));
+  }
+
+  std::unordered_set<const OpNode*> ops_;
+};
+
 // Pattern Rewriter
 Expr RAFPatternRewriter::Rewrite(const Array<DFPatternCallback>& callbacks, const Expr& pre) {
   auto post = pre;
   auto last = post;
+  // Index the callbacks by the ops of their pattern roots, so that the callbacks whose roots do
+  // not appear in the graph are skipped without type inference and grouping.
+  std::vector<std::unordered_set<const OpNode*>> root_ops(callbacks.size());
+  std::vector<bool> indexed(callbacks.size());
+  for (size_t i = 0; i < callbacks.size(); ++i) {
+    indexed[i] = CollectRootOps(callbacks[i]->pattern, &root_ops[i]);
+  }
+  auto collect_ops = [](const Expr& expr) {
+    OpCollector collector;
+    collector.VisitExpr(expr);
+    return std::move(collector.ops_);
+  };
+  auto graph_ops = collect_ops(post);
+  auto may_match = [&](size_t i) {
+    if (!indexed[i]) {
+      return true;
+    }
+    for (const auto* op : root_ops[i]) {
+      if (graph_ops.count(op)) {
+        return true;
+      }
+    }
+    return false;
+  };
   // rewrite the graph until it stops changing to make sure all rewrites are complete
   int count = 0;
   bool equal = true;
@@ -199,21 +309,35 @@ Expr RAFPatternRewriter::Rewrite(const Array<DFPatternCallback>& callbacks, cons
   ICHECK(structural_equal) << "node.StructuralEqual is not registered.";
   do {
     last = post;
-    for (auto callback : callbacks) {
-      callback_ = callback;
+    bool changed = false;
+    for (size_t i = 0; i < callbacks.size(); ++i) {
+      callback_ = callbacks[i];
+      count++;
+      if (!may_match(i)) {
+        continue;
+      }
       if (callback_->require_type) {
         post = InferTypeWithModule(post, mod_);
       }
       auto grouper = RAFPatternGrouper();
       groups_ = grouper.GroupMatches(callback_->pattern, post);
       gid_assignments_ = grouper.GetGIDAssignments();
+      if (groups_.empty()) {
+        continue;
+      }
       memo_.clear();
-      post = this->VisitExpr(post);
-      count++;
+      Expr rewritten = this->VisitExpr(post);
+      if (!rewritten.same_as(post)) {
+        post = rewritten;
+        graph_ops = collect_ops(post);
+        changed = true;
+      }
     }
-    equal = (*structural_equal)(last, post, false, true);
+    // The mutator keeps the unchanged nodes, so the graph is only compared when it is rewritten.
+    equal = !changed || (*structural_equal)(last, post, false, true);
   } while (!equal && count < 100 && !callback_->rewrite_once);
-  if (count >= 100) {
+  // The callbacks rewritten once are applied in a single round however many they are.
+  if (!equal && !callback_->rewrite_once) {
     LOG(FATAL) << "Observed 100 rewrite passes, possible conflicting passes?";
   }
   return post;
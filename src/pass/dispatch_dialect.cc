@@ -7,13 +7,19 @@
  * \file src/pass/dispatch_dialect.cc
  * \brief Dispatch the base ops to device-specific dialect ops based on predefined plevels. Note
  * that some ops such as VM related ops do not have dialect ops, and they will remain the same after
- * this pass.
+ * this pass. When raf.dispatch_dialect.auto_dispatch is set, the calls that have more than one
+ * candidate dialect are instead dispatched to the fastest dialect profiled on the device.
  */
+#include <algorithm>
+#include <limits>
 #include <vector>
+#include "raf/cache.h"
 #include "raf/device.h"
 #include "raf/op.h"
+#include "raf/op_profiler.h"
 #include "raf/ir.h"
 #include "raf/pass.h"
+#include "../3rdparty/tvm/src/runtime/file_utils.h"
 
 namespace raf {
 namespace pass {
@@ -21,10 +27,104 @@ namespace dispatch_dialect {
 
 using namespace raf::ir;
 using namespace raf::op;
+using namespace raf::value;
+
+/*! \brief The persistent cache entry of the fastest dialect of a call. */
+class DialectChoiceCacheEntry {
+ public:
+  explicit DialectChoiceCacheEntry(const std::string& dialect) : dialect_(dialect) {
+  }
+
+  const std::string& Dialect() const {
+    return dialect_;
+  }
+
+  static DialectChoiceCacheEntry Load(const std::string& path) {
+    std::string data;
+    tvm::runtime::LoadBinaryFromFile(path + "/value.bin", &data);
+    dmlc::MemoryStringStream reader(&data);
+    dmlc::Stream* stream = &reader;
+
+    std::string dialect;
+    CHECK(stream->Read(&dialect)) << "Failed to read the dialect";
+    return DialectChoiceCacheEntry(dialect);
+  }
+
+  bool Save(const std::string& path) {
+    std::string data;
+    dmlc::MemoryStringStream writer(&data);
+    dmlc::Stream* stream = &writer;
+    stream->Write(dialect_);
+    tvm::runtime::SaveBinaryToFile(path + "/value.bin", data);
+    return true;
+  }
+
+ private:
+  /*! \brief The fastest dialect. */
+  std::string dialect_;
+};
+
+MetaPersistCache<DialectChoiceCacheEntry> CacheDialectChoice("dialect_choice", true);
+
+/*!
+ * \brief Profile the candidate dialects of a base op call with dummy inputs, and return the
+ * fastest dialect op. The choice is cached per op, argument and return types, and device, so the
+ * ops are only profiled once across processes.
+ * \param call The type-inferred base op call.
+ * \param device The device to profile on.
+ * \return The fastest dialect op, or an undefined op if there is nothing to choose from.
+ */
+Op ChooseFastestDialect(const Call& call, const Device& device) {
+  auto op = Downcast<Op>(call->op);
+  auto dialect_list = OpDialect::GetDispatchList(op, device.device_type());
+  if (dialect_list.size() < 2) {
+    return Op();
+  }
+  auto profiler = op_profiler::OpProfiler::Get(device);
+  std::string key = profiler->GetPersistKey(call);
+  if (auto entry = CacheDialectChoice.Get(key)) {
+    return OpDialect::Lower(op, entry->Dialect());
+  }
+
+  std::string best_dialect;
+  float best_latency = std::numeric_limits<float>::max();
+  for (const auto& entry : dialect_list) {
+    auto dialect_op = Op::Get(entry.dialect_op);
+    dialect_op->op_type = op->op_type;
+    Call dialect_call = Call(dialect_op, call->args, call->attrs, call->type_args);
+    dialect_call->checked_type_ = call->checked_type();
+    try {
+      // Only profile the dialects that accept the call, because the dispatch of an unaccepted
+      // dialect op falls back to the other dialects.
+      if (OpEnvMaker::Make(dialect_op->name, CreateDummyCallValues(dialect_call, device)) ==
+          nullptr) {
+        continue;
+      }
+      auto latencies = profiler->ProfileOp(dialect_call).first;
+      float latency = 0;
+      for (auto lat : latencies) {
+        latency += lat;
+      }
+      latency /= std::max<size_t>(latencies.size(), 1);
+      if (latency < best_latency) {
+        best_latency = latency;
+        best_dialect = entry.dialect;
+      }
+    } catch (const dmlc::Error& e) {
+      DLOG(INFO) << "Skip dialect " << entry.dialect << " for " << op->name << ": " << e.what();
+    }
+  }
+  if (best_dialect.empty()) {
+    return Op();
+  }
+  CacheDialectChoice.Set(key, DialectChoiceCacheEntry(best_dialect));
+  return OpDialect::Lower(op, best_dialect);
+}
 
 class DispatchMutator : public MixedModeMutator {
  public:
-  DispatchMutator(DevType dev_type) : dev_type_(dev_type) {
+  DispatchMutator(const Device& device, bool auto_dispatch)
+      : device_(device), dev_type_(device.device_type()), auto_dispatch_(auto_dispatch) {
   }
 
   Expr VisitExpr_(const FunctionNode* node) final {
@@ -46,26 +146,55 @@ class DispatchMutator : public MixedModeMutator {
     return op;
   }
 
+  Expr Rewrite_(const CallNode* pre, const Expr& post) final {
+    auto op_node = pre->op.as<OpNode>();
+    if (!auto_dispatch_ || op_node == nullptr || IsDialectOp(GetRef<Op>(op_node))) {
+      return post;
+    }
+    auto dialect_op = ChooseFastestDialect(GetRef<Call>(pre), device_);
+    if (!dialect_op.defined()) {
+      return post;
+    }
+    auto call = Downcast<Call>(post);
+    return Call(dialect_op, call->args, call->attrs, call->type_args, call->span);
+  }
+
  private:
+  /*! \brief The target device. */
+  Device device_;
+  /*! \brief The target device type. */
   DevType dev_type_;
+  /*! \brief Whether to dispatch to the fastest dialect profiled on the device. */
+  bool auto_dispatch_;
 };
 
-Expr Dispatch(const Expr& expr) {
+Expr Dispatch(const Expr& expr, bool auto_dispatch) {
   auto dev = Device::Current(true);
   if (dev->device_type == DevType::kUnknown() || dev->device_id < 0) {
     LOG(WARNING) << "Device is not specified, skip DispatchDialect pass.";
     return expr;
   }
-  DevType dev_type = dev.device_type();
-  return DispatchMutator(dev_type).Mutate(expr);
+  if (auto_dispatch && dev->device_id != 0) {
+    // The op profiler only profiles on the first device of each type.
+    LOG(WARNING) << "Auto dispatch only supports device id 0, fall back to plevels.";
+    auto_dispatch = false;
+  }
+  return DispatchMutator(dev, auto_dispatch).Mutate(expr);
 }
 
 }  // namespace dispatch_dialect
 
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.dispatch_dialect.auto_dispatch", Bool);
+
 Pass DispatchDialect() {
   TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
                                                                              PassContext pc) {
-    return Downcast<Function>(dispatch_dialect::Dispatch(f));
+    bool auto_dispatch = pc->GetConfig("raf.dispatch_dialect.auto_dispatch", Bool(false)).value();
+    if (auto_dispatch) {
+      // Profiling the candidates needs the argument and return types.
+      f = Downcast<Function>(InferType(f));
+    }
+    return Downcast<Function>(dispatch_dialect::Dispatch(f, auto_dispatch));
   };
   return CreateRAFFunctionPass(pass_func, 1, "DispatchDialect", {});
 }
@@ -0,0 +1,228 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file eliminate_cast.cc
+ * \brief Eliminate the cast ops left by AutoCast. The pass removes back-to-back casts that
+ * restore the original dtype, and moves casts across layout-agnostic ops (e.g., reshape and
+ * transpose) so that the layout ops process the narrower dtype, and the casts either meet and
+ * cancel each other, or become adjacent to their producers and consumers to be fused.
+ */
+#include <algorithm>
+#include "raf/op.h"
+#include "raf/ir.h"
+#include "raf/pass.h"
+#include "raf/value.h"
+#include "./common.h"
+
+namespace raf {
+namespace pass {
+namespace eliminate_cast {
+
+using namespace raf::ir;
+using namespace raf::op;
+using namespace raf::value;
+
+/*! \brief Whether the dtype is a floating point type. */
+inline bool IsFloat(const DataType& dtype) {
+  return dtype.is_float() || dtype.is_bfloat16();
+}
+
+/*!
+ * \brief Whether casting from src to dst and then casting back can be removed. Like SimplifyExpr,
+ * casts between floating point types are considered reversible, because the round trips are
+ * generated by AutoCast to switch between the AMP dtype and float32.
+ */
+inline bool IsReversible(const DataType& src, const DataType& dst) {
+  return src == dst || (IsFloat(src) && IsFloat(dst));
+}
+
+class CastEliminator {
+ public:
+  explicit CastEliminator(const Function& func) : func_(func) {
+  }
+
+  Function Run() {
+    if (!func_->body->IsInstance<LetNode>()) {
+      return func_;
+    }
+    auto ell = ExplicitLetList::make(func_->body);
+    for (size_t i = 0; i < ell->vars.size(); ++i) {
+      for (const auto& var : FreeVars(ell->exprs[i])) {
+        num_uses_[var]++;
+      }
+    }
+    num_uses_[ell->ret]++;
+
+    for (size_t i = 0; i < ell->vars.size(); ++i) {
+      const auto& var = ell->vars[i];
+      auto expr = subst_.empty() ? ell->exprs[i] : Substitute(ell->exprs[i], subst_);
+      auto call = expr.as<CallNode>();
+      auto extended_var = var.as<ExtendedVarNode>();
+      if (call == nullptr || (extended_var && extended_var->may_share.defined()) ||
+          !var->checked_type_.defined() || !var->checked_type()->IsInstance<TensorTypeNode>()) {
+        Emit(var, expr);
+        continue;
+      }
+      Expr new_expr;
+      if (IsCast(expr)) {
+        new_expr = RewriteCast(call->args[0], call->args[1], var->checked_type());
+      } else if (IsLayout(expr)) {
+        new_expr = RewriteLayout(GetRef<Call>(call), var->checked_type());
+      }
+      if (!new_expr.defined()) {
+        Emit(var, expr);
+      } else if (new_expr->IsInstance<VarNode>()) {
+        // The binding is eliminated.
+        auto alias = Downcast<Var>(new_expr);
+        subst_.Set(var, alias);
+        num_uses_[alias] += num_uses_[var];
+      } else {
+        Emit(var, new_expr);
+      }
+    }
+    Var ret = subst_.count(ell->ret) ? Downcast<Var>(subst_[ell->ret]) : ell->ret;
+    ell_.ret = ret;
+    return Function(func_->params, ell_.AsExpr(), func_->ret_type, func_->type_params,
+                    func_->attrs);
+  }
+
+ private:
+  /*! \brief The ops that only change the layout of a tensor. */
+  bool IsLayout(const Expr& expr) {
+    static const std::vector<Op> layout_ops = {
+        Op::Get("raf.op.reshape"), Op::Get("raf.op.transpose"), Op::Get("raf.op.expand_dims"),
+        Op::Get("raf.op.squeeze"), Op::Get("raf.op.batch_flatten")};
+    auto call = expr.as<CallNode>();
+    return call && std::find(layout_ops.begin(), layout_ops.end(), call->op) != layout_ops.end();
+  }
+
+  bool IsCast(const Expr& expr) {
+    static const Op& cast_op = Op::Get("raf.op.cast");
+    auto call = expr.as<CallNode>();
+    return call && call->op == cast_op;
+  }
+
+  /*! \brief Get the binding of the given var, or an undefined call if it is not a let var. */
+  Call GetDef(const Expr& expr) {
+    auto it = defs_.find(expr);
+    return it == defs_.end() ? Call() : it->second;
+  }
+
+  /*! \brief Whether the var is only used by one binding, so its binding can be moved. */
+  bool IsSingleUse(const Expr& expr) {
+    return expr->IsInstance<VarNode>() && num_uses_[Downcast<Var>(expr)] == 1;
+  }
+
+  inline DataType DTypeOf(const Expr& expr) {
+    return Downcast<TensorType>(expr->checked_type())->dtype;
+  }
+
+  void Emit(const Var& var, const Expr& expr) {
+    ell_.Push(var, expr);
+    if (auto call = expr.as<CallNode>()) {
+      defs_[var] = GetRef<Call>(call);
+    }
+  }
+
+  /*! \brief Emit a binding of the expr to a new var with the given type. */
+  Var EmitNew(const Expr& expr, const Type& type) {
+    auto var = MakeVar("cast", {});
+    var->checked_type_ = type;
+    num_uses_[var] = 1;
+    Emit(var, expr);
+    return var;
+  }
+
+  /*!
+   * \brief Rewrite cast(data, dtype) with the given output type. Return the var of data if the
+   * cast is eliminated, or an undefined expr if nothing is changed.
+   */
+  Expr RewriteCast(const Expr& data, const Expr& dtype, const Type& out_type) {
+    if (!data->checked_type_.defined() || !data->checked_type()->IsInstance<TensorTypeNode>()) {
+      return Expr();
+    }
+    auto out_dtype = Downcast<TensorType>(out_type)->dtype;
+    if (DTypeOf(data) == out_dtype) {
+      return data;
+    }
+    auto def = GetDef(data);
+    if (def.defined() && IsCast(def)) {
+      // cast(cast(x, d1), d2) => x if d2 is the dtype of x, or cast(x, d2) otherwise.
+      auto x = def->args[0];
+      if (x->checked_type_.defined() && IsReversible(DTypeOf(x), DTypeOf(data))) {
+        return DTypeOf(x) == out_dtype ? x : Call(def->op, {x, dtype});
+      }
+    } else if (def.defined() && IsLayout(def) && IsSingleUse(data) && IsFloat(DTypeOf(data)) &&
+               (out_dtype.bits() < DTypeOf(data).bits() || IsCast(GetDef(def->args[0])))) {
+      // cast(layout(x), d) => layout(cast(x, d)) if d is narrower, so the layout op processes
+      // fewer bytes, or if x is produced by a cast, so the two casts are merged.
+      auto x = def->args[0];
+      auto x_type = Downcast<TensorType>(x->checked_type());
+      auto cast_type = TensorType(x_type->shape, out_dtype);
+      auto new_x = RewriteCast(x, dtype, cast_type);
+      if (!new_x.defined()) {
+        new_x = Call(Op::Get("raf.op.cast"), {x, dtype});
+      }
+      if (!new_x->IsInstance<VarNode>()) {
+        new_x = EmitNew(new_x, cast_type);
+      }
+      Array<Expr> args = def->args;
+      args.Set(0, new_x);
+      return Call(def->op, args, def->attrs, def->type_args);
+    }
+    return Expr();
+  }
+
+  /*!
+   * \brief Rewrite layout(cast(x, d)) to cast(layout(x), d) if d is wider, so that the cast is
+   * moved to the consumer and may meet the cast consuming it.
+   */
+  Expr RewriteLayout(const Call& call, const Type& out_type) {
+    auto data = call->args[0];
+    auto def = GetDef(data);
+    if (!def.defined() || !IsCast(def) || !IsSingleUse(data)) {
+      return Expr();
+    }
+    auto x = def->args[0];
+    if (!x->checked_type_.defined() || !x->checked_type()->IsInstance<TensorTypeNode>() ||
+        !IsFloat(DTypeOf(x)) || DTypeOf(data).bits() <= DTypeOf(x).bits()) {
+      return Expr();
+    }
+    Array<Expr> args = call->args;
+    args.Set(0, x);
+    auto layout_type = TensorType(Downcast<TensorType>(out_type)->shape, DTypeOf(x));
+    auto new_layout = EmitNew(Call(call->op, args, call->attrs, call->type_args), layout_type);
+    return Call(def->op, {new_layout, def->args[1]});
+  }
+
+  /*! \brief The target function. */
+  Function func_;
+  /*! \brief The rewritten let list. */
+  ExplicitLetList ell_;
+  /*! \brief Mapping from a rewritten let var to its call. */
+  std::unordered_map<Expr, Call, ObjectPtrHash, ObjectPtrEqual> defs_;
+  /*! \brief The number of bindings using each var. */
+  std::unordered_map<Var, int, ObjectPtrHash, ObjectPtrEqual> num_uses_;
+  /*! \brief Mapping from an eliminated let var to its replacement. */
+  Map<Var, Expr> subst_;
+};
+
+}  // namespace eliminate_cast
+
+Pass EliminateCast() {
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
+                                                                             PassContext pc) {
+    return eliminate_cast::CastEliminator(f).Run();
+  };
+  auto eliminate_cast = CreateRAFFunctionPass(pass_func, 0, "EliminateCastFunc", {});
+  return RAFSequential({InferType(), eliminate_cast, InferType(), DeadCodeElimination()},
+                       "EliminateCast");
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.EliminateCast").set_body_typed(EliminateCast);
+
+}  // namespace pass
+}  // namespace raf
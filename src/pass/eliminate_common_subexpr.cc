@@ -0,0 +1,268 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file eliminate_common_subexpr.cc
+ * \brief Eliminate the common subexpressions by hash-consing, e.g., the transpose of a weight or
+ * the cast of an input that is computed again in the backward. Two op calls are the same if they
+ * call the same op with the same attributes, vars and constants, after the eliminated vars are
+ * replaced. Unlike Deduplicate, which extracts the repeated subgraphs as closures, this pass
+ * removes the single redundant bindings, so it is cheap enough to run on every model. It works on
+ * both ANF and GNF.
+ *
+ * The calls are kept if their results are not only determined by their arguments, i.e., the ops
+ * with side effects, the random ops with internal states, the in-place updates and the collective
+ * ops.
+ */
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "raf/op.h"
+#include "raf/op_utils.h"
+#include "raf/ir.h"
+#include "raf/pass.h"
+#include "raf/value.h"
+#include "./common.h"
+
+namespace raf {
+namespace pass {
+namespace eliminate_common_subexpr {
+
+using namespace raf::ir;
+using namespace raf::op;
+using namespace raf::value;
+
+inline void HashCombine(size_t* seed, size_t value) {
+  *seed ^= value + 0x9e3779b9 + (*seed << 6) + (*seed >> 2);
+}
+
+/*! \brief Whether the constant value supports the structural hash and comparison. */
+inline bool IsStructural(const ObjectRef& value) {
+  return value->IsInstance<ScalarValueObj>() || value->IsInstance<StringValueObj>() ||
+         value->IsInstance<TupleValueObj>() || value->IsInstance<TensorValueObj>();
+}
+
+/*! \brief Hash a (rewritten) value: the vars by pointer and the constants by structure. */
+struct ValueHash {
+  size_t operator()(const Expr& expr) const {
+    size_t seed = expr->type_index();
+    if (const auto* call = expr.as<CallNode>()) {
+      HashCombine(&seed, ObjectPtrHash()(call->op));
+      HashCombine(&seed, tvm::StructuralHash()(call->attrs));
+      for (const auto& arg : call->args) {
+        HashCombine(&seed, HashArg(arg));
+      }
+    } else if (const auto* tuple = expr.as<TupleNode>()) {
+      for (const auto& field : tuple->fields) {
+        HashCombine(&seed, HashArg(field));
+      }
+    } else if (const auto* item = expr.as<TupleGetItemNode>()) {
+      HashCombine(&seed, HashArg(item->tuple));
+      HashCombine(&seed, std::hash<int>()(item->index));
+    }
+    return seed;
+  }
+
+  static size_t HashArg(const Expr& arg) {
+    if (const auto* constant = arg.as<ConstantNode>()) {
+      if (!constant->value.defined()) {
+        return 0;
+      }
+      return IsStructural(constant->value) ? tvm::StructuralHash()(constant->value)
+                                           : ObjectPtrHash()(constant->value);
+    }
+    return ObjectPtrHash()(arg);
+  }
+};
+
+/*! \brief Compare two (rewritten) values in the same way as ValueHash. */
+struct ValueEqual {
+  bool operator()(const Expr& lhs, const Expr& rhs) const {
+    if (lhs->type_index() != rhs->type_index()) {
+      return false;
+    }
+    if (const auto* a = lhs.as<CallNode>()) {
+      const auto* b = rhs.as<CallNode>();
+      return a->op.same_as(b->op) && tvm::StructuralEqual()(a->attrs, b->attrs) &&
+             ArgsEqual(a->args, b->args);
+    } else if (const auto* a = lhs.as<TupleNode>()) {
+      return ArgsEqual(a->fields, rhs.as<TupleNode>()->fields);
+    } else if (const auto* a = lhs.as<TupleGetItemNode>()) {
+      const auto* b = rhs.as<TupleGetItemNode>();
+      return a->index == b->index && ArgEqual(a->tuple, b->tuple);
+    }
+    return lhs.same_as(rhs);
+  }
+
+  static bool ArgsEqual(const Array<Expr>& lhs, const Array<Expr>& rhs) {
+    if (lhs.size() != rhs.size()) {
+      return false;
+    }
+    for (size_t i = 0; i < lhs.size(); ++i) {
+      if (!ArgEqual(lhs[i], rhs[i])) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  static bool ArgEqual(const Expr& lhs, const Expr& rhs) {
+    const auto* a = lhs.as<ConstantNode>();
+    const auto* b = rhs.as<ConstantNode>();
+    if (a != nullptr && b != nullptr) {
+      if (!a->value.defined() || !b->value.defined()) {
+        return a->value.defined() == b->value.defined();
+      }
+      if (!IsStructural(a->value) || !IsStructural(b->value)) {
+        return a->value.same_as(b->value);
+      }
+      return tvm::StructuralEqual()(a->value, b->value);
+    }
+    return lhs.same_as(rhs);
+  }
+};
+
+/*! \brief Whether the result of the call is only determined by its arguments. */
+bool IsPure(const CallNode* call) {
+  static auto fside_effect = Op::GetAttrMap<TRAFSideEffect>("TRAFSideEffect");
+  static auto finplace = Op::GetAttrMap<TRAFInplaceUpdate>("TRAFInplaceUpdate");
+  static auto fschema_index = Op::GetAttrMap<FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+  // The stateful random ops, whose outputs differ between the calls. The random ops that take
+  // the keys as inputs, e.g., philox dropout, are pure.
+  static OpSet random_ops = {Op::Get("raf.op._contrib_dropout")};
+  const auto* op_node = call->op.as<OpNode>();
+  if (op_node == nullptr) {
+    return false;
+  }
+  Op op = GetRef<Op>(op_node);
+  op = IsDialectOp(op) ? GetBaseOp(op) : op;
+  if (fside_effect.get(op, false) || finplace.count(op) || IsCollectiveOp(op) ||
+      IsInOpSet(op, random_ops) || op->name.compare(0, 10, "raf.op.vm.") == 0) {
+    return false;
+  }
+  // The binary ops update the "out" argument in place if it is given.
+  if (fschema_index.count(op)) {
+    int out_idx = fschema_index[op]("out");
+    if (out_idx >= 0 && out_idx < static_cast<int>(call->args.size())) {
+      const auto* out = call->args[out_idx].as<ConstantNode>();
+      if (out == nullptr || out->value.defined()) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+class CommonSubexprEliminator : public ExprMutator {
+ public:
+  Expr VisitExpr_(const VarNode* node) final {
+    auto it = subst_.find(node);
+    return it != subst_.end() ? it->second : GetRef<Var>(node);
+  }
+
+  Expr VisitExpr_(const LetNode* node) final {
+    std::vector<std::pair<Var, Expr>> bindings;
+    Expr expr = GetRef<Expr>(node);
+    while (const auto* let = expr.as<LetNode>()) {
+      Expr value = let->value;
+      const auto* var = let->var.as<ExtendedVarNode>();
+      bool may_share = var != nullptr && var->may_share.defined();
+      if (const auto* call = value.as<CallNode>()) {
+        value = RewriteCall(call);
+      } else {
+        value = VisitExpr(value);
+      }
+      if (!may_share && IsCandidate(value)) {
+        auto it = table_.find(value);
+        if (it != table_.end() && it->second->IsInstance<VarNode>()) {
+          subst_[let->var.get()] = it->second;
+          expr = let->body;
+          continue;
+        }
+        table_.emplace(value, let->var);
+      }
+      bindings.emplace_back(let->var, value);
+      expr = let->body;
+    }
+    Expr body = VisitExpr(expr);
+    for (auto it = bindings.rbegin(); it != bindings.rend(); ++it) {
+      body = Let(it->first, it->second, body);
+    }
+    return body;
+  }
+
+  Expr VisitExpr_(const CallNode* node) final {
+    // A call in GNF, which is the same expression wherever it is used.
+    Expr call = RewriteCall(node);
+    if (!IsCandidate(call)) {
+      return call;
+    }
+    auto it = table_.find(call);
+    if (it != table_.end()) {
+      return it->second;
+    }
+    table_.emplace(call, call);
+    return call;
+  }
+
+  Expr VisitExpr_(const FunctionNode* node) final {
+    if (node->HasNonzeroAttr(attr::kPrimitive)) {
+      return GetRef<Function>(node);
+    }
+    auto saved = table_;
+    auto ret = ExprMutator::VisitExpr_(node);
+    table_ = std::move(saved);
+    return ret;
+  }
+
+  Expr VisitExpr_(const IfNode* node) final {
+    // The values computed in a branch are not available after the if expression.
+    auto cond = VisitExpr(node->cond);
+    auto saved = table_;
+    auto true_branch = VisitExpr(node->true_branch);
+    table_ = saved;
+    auto false_branch = VisitExpr(node->false_branch);
+    table_ = std::move(saved);
+    return If(cond, true_branch, false_branch, node->span);
+  }
+
+ private:
+  Expr RewriteCall(const CallNode* call) {
+    Array<Expr> args;
+    for (const auto& arg : call->args) {
+      args.push_back(VisitExpr(arg));
+    }
+    return Call(VisitExpr(call->op), args, call->attrs, call->type_args, call->span);
+  }
+
+  bool IsCandidate(const Expr& value) {
+    if (const auto* call = value.as<CallNode>()) {
+      return IsPure(call);
+    }
+    return value->IsInstance<TupleNode>() || value->IsInstance<TupleGetItemNode>();
+  }
+
+  /*! \brief Mapping from the values to the vars (ANF) or the exprs (GNF) that hold them. */
+  std::unordered_map<Expr, Expr, ValueHash, ValueEqual> table_;
+  /*! \brief Mapping from an eliminated let var to its replacement. */
+  std::unordered_map<const VarNode*, Expr> subst_;
+};
+
+}  // namespace eliminate_common_subexpr
+
+Pass EliminateCommonSubexpr() {
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
+                                                                             PassContext pc) {
+    return Downcast<Function>(eliminate_common_subexpr::CommonSubexprEliminator().Mutate(f));
+  };
+  auto eliminate_common_subexpr =
+      CreateRAFFunctionPass(pass_func, 1, "EliminateCommonSubexprFunc", {});
+  return RAFSequential({eliminate_common_subexpr, InferType()}, "EliminateCommonSubexpr");
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.EliminateCommonSubexpr").set_body_typed(EliminateCommonSubexpr);
+
+}  // namespace pass
+}  // namespace raf
@@ -26,6 +26,7 @@ using namespace raf::op;
 using namespace raf::value;
 using raf::distributed::DistContext;
 using namespace raf::analysis;
+using stream_pool::Stream;
 using stream_pool::StreamTagEnum;
 
 using OpSet = std::unordered_set<Op, ObjectPtrHash, ObjectPtrEqual>;
@@ -51,6 +52,8 @@ static int64_t compute_stream_idx = StreamTagEnum::CudaCompute();
 static int64_t communication_stream_idx = StreamTagEnum::CudaCommunicate();
 static int64_t fuse_tensor_stream_idx = StreamTagEnum::MemCudaToCuda1();
 static int64_t defuse_tensor_stream_idx = StreamTagEnum::MemCudaToCuda2();
+static int64_t offload_stream_idx = StreamTagEnum::MemCpyCudaToCpu();
+static int64_t prefetch_stream_idx = StreamTagEnum::MemCpyCpuToCuda();
 static int64_t unknown_stream_idx = StreamTagEnum::Unknown();
 
 static std::unordered_map<int64_t, std::string> stream_name_hint = {
@@ -58,8 +61,28 @@ static std::unordered_map<int64_t, std::string> stream_name_hint = {
     {communication_stream_idx, "comm"},
     {fuse_tensor_stream_idx, "fuse"},
     {defuse_tensor_stream_idx, "defuse"},
+    {offload_stream_idx, "offload"},
+    {prefetch_stream_idx, "prefetch"},
 };
 
+/*! \brief Whether the device_copy call copies from the given device type to the other. */
+bool IsDeviceCopyBetween(const CallNode* call, DevType src, DevType dst) {
+  static const auto* str2dev = tvm::runtime::Registry::Get("raf._core.core_utils.str2dev");
+  auto src_const = call->args[1].as<ConstantNode>();
+  auto dst_const = call->args[2].as<ConstantNode>();
+  if (src_const == nullptr || dst_const == nullptr) {
+    return false;
+  }
+  auto src_str = src_const->value.as<StringValueObj>();
+  auto dst_str = dst_const->value.as<StringValueObj>();
+  if (src_str == nullptr || dst_str == nullptr) {
+    return false;
+  }
+  auto src_device = Device((tvm::Device)(*str2dev)(src_str->value));
+  auto dst_device = Device((tvm::Device)(*str2dev)(dst_str->value));
+  return src_device.device_type() == src && dst_device.device_type() == dst;
+}
+
 int IdentifyStream(const Expr& op) {
   int stream_idx = compute_stream_idx;
   if (op->IsInstance<CallNode>() && IsCollectiveOp(op.as<CallNode>()->op)) {
@@ -70,6 +93,14 @@ int IdentifyStream(const Expr& op) {
     stream_idx = fuse_tensor_stream_idx;
   } else if (op->IsInstance<CallNode>() && IsDefuseTensorOp(op.as<CallNode>()->op)) {
     stream_idx = defuse_tensor_stream_idx;
+  } else if (op->IsInstance<CallNode>() && IsDeviceCopyOp(op.as<CallNode>()->op)) {
+    // Activations offloaded to and prefetched from the pinned host memory.
+    auto call = op.as<CallNode>();
+    if (IsDeviceCopyBetween(call, DevType::kCUDA(), DevType::kCUDAHost())) {
+      stream_idx = offload_stream_idx;
+    } else if (IsDeviceCopyBetween(call, DevType::kCUDAHost(), DevType::kCUDA())) {
+      stream_idx = prefetch_stream_idx;
+    }
   }
   return stream_idx;
 }
@@ -229,114 +260,78 @@ class SyncAnalyzer : ExprVisitor {
         dep_set.insert(std::make_pair(call, stream_and_consumer.second));
       }
     }
-    PruneReduntantDependency_(dep_set);
+    ReduceDependencies_(dep_set);
   }
 
-  void PruneReduntantDependency_(DepSet& dep_set) {
-    if (dep_set.empty()) {
-      return;
-    }
-
-    // In multi-stream dependency analysis, we consider these two kinds of dependencies:
-    // (1) dependencies between ops in different streams
-    // (2) dependencies between ops in the same stream
-    // Before pruning, we add back dependencies of the second kind.
-    std::unordered_map<int, std::vector<int>> stream_id_map;
-    for (int i = 0; i < max_idx_; ++i) {
-      int stream = idx_stream_map[i];
-      if (!stream_id_map.count(stream)) {
-        stream_id_map.emplace(stream, std::vector<int>{});
-      }
-      stream_id_map[stream].push_back(i);
-    }
-    for (auto& stream_and_ids : stream_id_map) {
-      auto& ids = stream_and_ids.second;
-      std::sort(ids.begin(), ids.end());
-      for (int i = 0; i < ids.size() - 1; ++i) {
-        dep_set.insert(std::make_pair(ids[i], ids[i + 1]));
-      }
-    }
-
-    std::unordered_map<int, std::unordered_set<int>> direct_children_map = {};
-    std::unordered_map<int, std::unordered_set<int>> direct_parent_map = {};
-    std::unordered_set<int> roots = {};
-    for (auto& dep_pair : dep_set) {
-      roots.insert(dep_pair.first);
-      direct_children_map[dep_pair.first].insert(dep_pair.second);
-      direct_parent_map[dep_pair.second].insert(dep_pair.first);
-    }
+  /*!
+   * \brief Drop the dependencies implied by the others, i.e., the transitive reduction of the
+   * cross-stream dependency graph, using vector clocks. The ops of each stream run in the ANF
+   * order, so clocks[s][t] is the latest op of stream t known to finish before the current op of
+   * stream s, and snapshots[u] is the clock of stream s once op u finishes, which a wait on the
+   * event after u brings to the waiting stream. A dependency (u, v) is implied if the clock of the
+   * stream of v already covers u when v is reached, e.g., by an earlier wait in the stream, or if
+   * the snapshot of another producer that v waits for covers u.
+   */
+  void ReduceDependencies_(DepSet& dep_set) {
+    using Clock = std::unordered_map<int, int>;
+    auto covers = [this](const Clock& clock, int idx) {
+      auto it = clock.find(idx_stream_map[idx]);
+      return it != clock.end() && it->second >= idx;
+    };
+    std::unordered_map<int, std::vector<int>> producers;
     for (auto& dep_pair : dep_set) {
-      auto it = roots.find(dep_pair.second);
-      if (it != roots.end()) {
-        roots.erase(it);
-      }
-    }
-
-    std::vector<int> post_dfs_order = {};
-    std::unordered_map<int, bool> visited = {};
-    for (auto root : roots) {
-      DFS_(direct_children_map, visited, root, post_dfs_order);
+      producers[dep_pair.second].push_back(dep_pair.first);
     }
-
-    // Prune redundant dependencies. One dependency (u, v) is redundant if and only if
-    // there exists a path from u to v that does not go through the dependency (u, v).
-    // Therefore, if dependency (u, v) is redundant, node v should be both direct and
-    // indirect child of node u. When pruning, we firstly iterate through the dependency
-    // graph in post DFS order to collect direct and indirect children of each node,
-    // and then remove redundant edges from the graph.
-    std::unordered_map<int, std::unordered_set<int>> indirect_children_map = {};
-    for (auto node : post_dfs_order) {
-      for (auto parent : direct_parent_map[node]) {
-        indirect_children_map[parent].insert(direct_children_map[node].begin(),
-                                             direct_children_map[node].end());
-        indirect_children_map[parent].insert(indirect_children_map[node].begin(),
-                                             indirect_children_map[node].end());
+    std::unordered_map<int, Clock> clocks;
+    std::unordered_map<int, Clock> snapshots;
+    DepSet reduced;
+    for (int idx = 0; idx <= max_idx_; ++idx) {
+      if (!idx_stream_map.count(idx)) {
+        continue;
       }
-    }
-    DepSet deps_to_remove = {};
-    for (auto node : post_dfs_order) {
-      for (auto direct_child : direct_children_map[node]) {
-        if (indirect_children_map[node].count(direct_child)) {
-          deps_to_remove.insert(std::make_pair(node, direct_child));
+      int stream = idx_stream_map[idx];
+      Clock& clock = clocks[stream];
+      if (producers.count(idx)) {
+        std::vector<int> needed;
+        for (int producer : producers[idx]) {
+          if (!covers(clock, producer)) {
+            needed.push_back(producer);
+          }
+        }
+        for (int producer : needed) {
+          bool implied = false;
+          for (int other : needed) {
+            implied = implied || (other != producer && covers(snapshots[other], producer));
+          }
+          if (!implied) {
+            reduced.insert(std::make_pair(producer, idx));
+          }
+        }
+        // The snapshots of the implied producers are covered by those of the others.
+        for (int producer : needed) {
+          for (auto& stream_and_idx : snapshots[producer]) {
+            int& latest = clock[stream_and_idx.first];
+            latest = std::max(latest, stream_and_idx.second);
+          }
         }
       }
+      clock[stream] = idx;
+      snapshots[idx] = clock;
     }
-
-    for (auto& dep_to_remove : deps_to_remove) {
-      if (dep_set.count(dep_to_remove)) {
-        dep_set.erase(dep_set.find(dep_to_remove));
-      }
-    }
-
-    // The pruned graph should only contains dependencies of the first kind.
-    // Here we remove dependencies of the second kind.
-    for (auto it = dep_set.begin(); it != dep_set.end();) {
-      if (InSameStream_(it->first, it->second)) {
-        it = dep_set.erase(it);
-      } else {
-        ++it;
-      }
-    }
-  }
-
-  void DFS_(std::unordered_map<int, std::unordered_set<int>>& direct_children_map,
-            std::unordered_map<int, bool>& visited, int node, std::vector<int>& post_dfs_order) {
-    if (!visited[node]) {
-      for (auto child : direct_children_map[node]) {
-        DFS_(direct_children_map, visited, child, post_dfs_order);
-      }
-      post_dfs_order.push_back(node);
-      visited[node] = true;
-    }
-  }
-
-  bool InSameStream_(int i, int j) {
-    return idx_stream_map[i] == idx_stream_map[j];
+    dep_set = std::move(reduced);
   }
 
+  /*!
+   * \brief Create an event after each producer, which is shared by all its consumers. The events
+   * are numbered in the ANF order of the producers.
+   */
   void CreateEventsUsingDepSet_(DepSet& dep_set) {
-    for (auto& dep_pair : dep_set) {
-      add_event_after_op[dep_pair.first].push_back(GetUniqueEventId());
+    std::vector<std::pair<int, int>> deps(dep_set.begin(), dep_set.end());
+    std::sort(deps.begin(), deps.end());
+    for (auto& dep_pair : deps) {
+      if (!add_event_after_op.count(dep_pair.first)) {
+        add_event_after_op[dep_pair.first].push_back(GetUniqueEventId());
+      }
       wait_event_before_op[dep_pair.second].push_back(add_event_after_op[dep_pair.first].back());
     }
   }
@@ -464,6 +459,8 @@ class SyncEnforcer : ExprVisitor {
    *      }
    */
   explicit SyncEnforcer(const FunctionNode* func) : func_(func) {
+    auto pass_ctx = PassContext::Current();
+    prioritize_ = pass_ctx->GetConfig("raf.stream_schedule.stream_priority", Bool(false)).value();
   }
 
   void VisitExpr_(const LetNode* op) {
@@ -499,6 +496,14 @@ class SyncEnforcer : ExprVisitor {
  protected:
   Expr CreateSetStreamOp(int64_t device_id, int64_t stream_id) {
     static Op set_stream_op = Op::Get("raf.op.set_stream");
+    // The stream ids are the stream tags, so the streams take the priorities of their tags.
+    int64_t priority = prioritize_ ? Stream::GetPriority(stream_id) : 0;
+    if (priority != 0) {
+      Array<Expr> args({MakeConstant(value::ScalarValue::make(device_id)),
+                        MakeConstant(value::ScalarValue::make(stream_id)),
+                        MakeConstant(value::ScalarValue::make(priority))});
+      return Call(set_stream_op, args);
+    }
     return CreateSetStreamOrEventOp_(set_stream_op, device_id, stream_id);
   }
 
@@ -552,6 +557,8 @@ class SyncEnforcer : ExprVisitor {
   }
 
   int device_id_ = -1;
+  /*! \brief Whether to set the priorities of the streams. */
+  bool prioritize_ = false;
   const FunctionNode* func_;
   SyncAnalyzer analyzer_;
   std::unique_ptr<ExplicitLetList> ell_;
@@ -41,6 +41,18 @@ class FLOPSEstimater : public ExprVisitor {
     return var_flops_map_;
   }
 
+  /*!
+   * \brief Estimate the GFLOPS of a single call whose arguments are already typed, such as an
+   * operator in a graph normal form function.
+   */
+  float Run(const Device& target, const Call& call, const IRModule& mod) {
+    device_ = target;
+    mod_ = mod;
+    curr_let_ = raf::ir::MakeVar("call", {});
+    this->VisitExpr_(call.get());
+    return var_flops_map_[curr_let_];
+  }
+
   float GetFLOPS(const Var& var) {
     if (var_flops_map_.count(var) == 0) {
       DLOG(WARNING) << "Var " << var->name_hint() << " does not have GFLOPS";
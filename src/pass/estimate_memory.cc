@@ -8,6 +8,7 @@
  * \brief Estimate the memory footprint. Note that this can only be used after ManifestAlloc pass.
  */
 #include "raf/device.h"
+#include "raf/memory_pool.h"
 #include "raf/op.h"
 #include "raf/op_profiler.h"
 #include "raf/pass.h"
@@ -89,8 +90,9 @@ class MemoryTracer : public ExprVisitor {
 
       trace_.push_back({String(name), FloatImm(DataType::Float(32), curr_memoey_mbs_ + ws_size)});
     } else if (GetRef<Op>(op_node) == alloc_storage_op) {
-      // Alloc a new buffer.
-      auto size = call->args[0].as<ConstantNode>()->value.as<IntValueObj>()->value / kMegaBytes;
+      // Alloc a new buffer, which is rounded up by the memory pool (e.g., to pages).
+      auto nbytes = call->args[0].as<ConstantNode>()->value.as<IntValueObj>()->value;
+      auto size = memory_pool::Memory::GetAllocBytes(device_, nbytes) / kMegaBytes;
       curr_memoey_mbs_ += size;
       storage_vars_[curr_let_] = size;
     } else if (GetRef<Op>(op_node) == free_op) {
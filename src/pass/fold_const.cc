@@ -13,6 +13,7 @@
 #include "raf/pass.h"
 #include "raf/executor.h"
 #include "raf/binding.h"
+#include "../common/shape_utils.h"
 
 namespace raf {
 namespace pass {
@@ -53,8 +54,40 @@ class ConstantChecker : private ExprVisitor {
   }
 };
 
+/*! \brief The bytes of a (tuple of) tensor type, or -1 if the type is unknown or dynamic. */
+int64_t BytesOfType(const Type& type) {
+  if (auto tuple_type = type.as<TupleTypeNode>()) {
+    int64_t total_size = 0;
+    for (auto field : tuple_type->fields) {
+      int64_t size = BytesOfType(field);
+      if (size < 0) {
+        return -1;
+      }
+      total_size += size;
+    }
+    return total_size;
+  } else if (auto ttype = type.as<TensorTypeNode>()) {
+    for (auto dim : ttype->shape) {
+      if (!dim.as<IntImmNode>()) {
+        return -1;
+      }
+    }
+    return common::shape_utils::BytesCompactTensor(ttype);
+  }
+  return -1;
+}
+
 class ConstantFolder : public ExprMutator {
  public:
+  /*!
+   * \param device The device to evaluate the constants on, or an unknown device to evaluate them
+   * where they are.
+   * \param max_bytes The maximum bytes of a folded output. Folding a large constant (e.g.,
+   * broadcasting a scalar to a huge tensor) bloats the IR and the memory, so it is kept as a call.
+   */
+  ConstantFolder(const Device& device, int64_t max_bytes) : device_(device), max_bytes_(max_bytes) {
+  }
+
   Expr VisitExpr_(const LetNode* op) final {
     auto pre_visit = [this](const LetNode* op) {
       // Rely on the Memoizer to cache pre-visit values
@@ -114,7 +147,7 @@ class ConstantFolder : public ExprMutator {
         all_const_args = false;
       }
     }
-    if (all_const_args) {
+    if (all_const_args && WithinSizeLimit(res)) {
       return ConstEvaluate(res);
     } else {
       return res;
@@ -138,6 +171,50 @@ class ConstantFolder : public ExprMutator {
  private:
   // Internal constant checker
   ConstantChecker checker_;
+  // The device to evaluate the constants on
+  Device device_;
+  // The maximum bytes of a folded output, or non-positive for no limit
+  int64_t max_bytes_;
+
+  // Check whether the output of a call is small enough to be folded.
+  bool WithinSizeLimit(const Expr& call) {
+    if (max_bytes_ <= 0) {
+      return true;
+    }
+    Type type = call->checked_type_;
+    if (!type.defined()) {
+      type = pass::InferType(call)->checked_type();
+    }
+    int64_t bytes = BytesOfType(type);
+    return bytes >= 0 && bytes <= max_bytes_;
+  }
+
+  // Move the constant arguments to the target device, so the kernels run on it.
+  Expr ToDevice(const Expr& call) {
+    if (device_->device_type == DevType::kUnknown() || device_->device_id < 0) {
+      return call;
+    }
+    const auto* node = call.as<CallNode>();
+    Array<Expr> args;
+    bool changed = false;
+    for (const auto& arg : node->args) {
+      const auto* constant = arg.as<ConstantNode>();
+      if (constant != nullptr && constant->value.defined() &&
+          constant->value->IsInstance<value::BaseTensorValueObj>()) {
+        Value value = CopyTo(Downcast<Value>(constant->value), device_);
+        if (!value.same_as(constant->value)) {
+          args.push_back(MakeConstant(value));
+          changed = true;
+          continue;
+        }
+      }
+      args.push_back(arg);
+    }
+    if (!changed) {
+      return call;
+    }
+    return Call(node->op, args, node->attrs, node->type_args);
+  }
 
   // Convert value to expression.
   Expr ObjectToExpr(const ObjectRef& value) {
@@ -169,7 +246,7 @@ class ConstantFolder : public ExprMutator {
     // TODO(haibin): run fuse_op, infer_type passes before execution
     // when these passes are ready
     auto module = GlobalModule();
-    return ObjectToExpr(executor::interpreter::Interpret(expr, module));
+    return ObjectToExpr(executor::interpreter::Interpret(ToDevice(expr), module));
   }
 };
 
@@ -225,11 +302,16 @@ ir::Expr BindParam(ir::Function func, ir::Array<ir::Expr> args) {
 Pass FoldConstant() {
   TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
                                                                              PassContext pc) {
-    return Downcast<Function>(fold_const::ConstantFolder().Mutate(f));
+    int64_t max_bytes =
+        pc->GetConfig("raf.fold_const.max_bytes", Integer(256 << 20)).value()->value;
+    Device device = Device::Current(true);
+    return Downcast<Function>(fold_const::ConstantFolder(device, max_bytes).Mutate(f));
   };
   return CreateRAFFunctionPass(pass_func, 1, "FoldConstant", {});
 }
 
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.fold_const.max_bytes", Integer);
+
 RAF_REGISTER_GLOBAL("raf.pass_.is_constant").set_body_typed(IsConstant);
 RAF_REGISTER_GLOBAL("raf.pass_.FoldConstant").set_body_typed(FoldConstant);
 RAF_REGISTER_GLOBAL("raf.pass_.BindParam").set_body_typed(BindParam);
@@ -8,6 +8,8 @@
  * \brief Build raf ir from Relay
  */
 #include <map>
+#include <unordered_set>
+#include <vector>
 #include <tvm/relay/transform.h>
 #include <tvm/support/with.h>
 #include <relay/transforms/pattern_utils.h>
@@ -208,6 +210,95 @@ String ValidateRelayParamName(const String var_name) {
   return String(name_str);
 }
 
+/*!
+ * \brief Convert a dataflow function to A-normal form. The nodes are bound in the same order as
+ * ToANormalForm, but the graph is walked with an explicit stack, so the deep graphs imported from
+ * ONNX or PyTorch do not overflow the stack.
+ * \param func The function to be converted.
+ * \return The converted function, or an undefined function if the body has let or control flow
+ * nodes, which are left to ToANormalForm.
+ */
+Function LinearizeDataflow(const Function& func) {
+  std::unordered_map<const Object*, Expr> memo;
+  LetList ll;
+  // Each entry is a node and whether its children have been pushed.
+  std::vector<std::pair<Expr, bool>> stack{{func->body, false}};
+  auto atom = [&memo](const Expr& expr) { return memo.at(expr.get()); };
+  while (!stack.empty()) {
+    Expr expr = stack.back().first;
+    if (memo.count(expr.get())) {
+      stack.pop_back();
+      continue;
+    }
+    if (!stack.back().second) {
+      stack.back().second = true;
+      // The children are pushed in the reverse order, so the arguments of a call are bound before
+      // its op, as ToANormalForm does.
+      if (const auto* call = expr.as<CallNode>()) {
+        stack.emplace_back(call->op, false);
+        for (int i = static_cast<int>(call->args.size()) - 1; i >= 0; --i) {
+          stack.emplace_back(call->args[i], false);
+        }
+      } else if (const auto* tuple = expr.as<TupleNode>()) {
+        for (int i = static_cast<int>(tuple->fields.size()) - 1; i >= 0; --i) {
+          stack.emplace_back(tuple->fields[i], false);
+        }
+      } else if (const auto* item = expr.as<TupleGetItemNode>()) {
+        stack.emplace_back(item->tuple, false);
+      } else if (expr->IsInstance<VarNode>() || expr->IsInstance<OpNode>() ||
+                 expr->IsInstance<GlobalVarNode>()) {
+        memo[expr.get()] = expr;
+        stack.pop_back();
+      } else if (const auto* inner = expr.as<FunctionNode>()) {
+        // The partitioned composite functions are primitive, which are bound as they are.
+        if (!inner->HasNonzeroAttr(attr::kPrimitive)) {
+          return Function();
+        }
+      } else if (!expr->IsInstance<RelayConstantNode>()) {
+        return Function();
+      }
+      continue;
+    }
+    stack.pop_back();
+    Expr value = expr;
+    if (const auto* call = expr.as<CallNode>()) {
+      Array<Expr> args;
+      for (const Expr& arg : call->args) {
+        args.push_back(atom(arg));
+      }
+      value = Call(atom(call->op), args, call->attrs, call->type_args, call->span);
+    } else if (const auto* tuple = expr.as<TupleNode>()) {
+      Array<Expr> fields;
+      for (const Expr& field : tuple->fields) {
+        fields.push_back(atom(field));
+      }
+      value = Tuple(fields, tuple->span);
+    } else if (const auto* item = expr.as<TupleGetItemNode>()) {
+      value = TupleGetItem(atom(item->tuple), item->index, item->span);
+    }
+    memo[expr.get()] = ll.Push(value);
+  }
+  Expr body = ll.Get(atom(func->body));
+  return Function(func->params, body, func->ret_type, func->type_params, func->attrs, func->span);
+}
+
+/*!
+ * \brief The conversion of an op with the given attributes. When none of the arguments is bound to
+ * a constant, the converters only depend on the attributes, so the conversion is reused by the
+ * calls with the structurally equal attributes.
+ */
+struct AttrsConversion {
+  Op op;
+  Attrs attrs;
+  size_t num_args;
+  /*! \brief The converted op. */
+  Expr raf_op;
+  /*! \brief The index of the call argument of each converted argument, or -1 for a constant. */
+  std::vector<int> arg_indices;
+  /*! \brief The value of each constant converted argument, e.g., from the attributes. */
+  std::vector<ObjectRef> values;
+};
+
 struct FromRelayMutator : public ExprMutator {
  public:
   FromRelayMutator() {
@@ -224,9 +315,15 @@ struct FromRelayMutator : public ExprMutator {
     if (node->data->data == fake_tensor->data->data) {
       return GetRef<Expr>(node);
     }
+    // The constants sharing the same array are converted once, and the converted tensors share
+    // the storage of the Relay arrays instead of copying them.
     static const auto& from_tvm = registry::GetPackedFunc("raf.value.FromTVM");
-    auto tv = from_tvm(node->data);
-    return MakeConstant(tv);
+    auto it = const_memo_.find(node->data.get());
+    if (it == const_memo_.end()) {
+      TensorValue tv = from_tvm(node->data);
+      it = const_memo_.emplace(node->data.get(), tv).first;
+    }
+    return MakeConstant(it->second);
   }
 
   Expr VisitExpr_(const LetNode* node) final {
@@ -320,25 +417,32 @@ struct FromRelayMutator : public ExprMutator {
     }
 
     const Op& op = Downcast<Op>(node->op);
-    Call res;
-    try {
-      auto new_expr = fmap[op](node->attrs, node->args, var_value_map_);
-      if (new_expr.as<CallNode>()) {
-        Call new_call = Downcast<Call>(new_expr);
-        tvm::Array<Expr> call_args;
-        for (auto arg : new_call->args) {
-          auto new_arg = this->Mutate(arg);
-          call_args.push_back(new_arg);
+    bool memoizable = IsAttrsMemoizable(node);
+    size_t hash = memoizable ? HashAttrsConversion(op, node) : 0;
+    Call res = memoizable ? LookupAttrsConversion(op, node, hash) : Call();
+    if (!res.defined()) {
+      try {
+        auto new_expr = fmap[op](node->attrs, node->args, var_value_map_);
+        if (new_expr.as<CallNode>()) {
+          Call new_call = Downcast<Call>(new_expr);
+          tvm::Array<Expr> call_args;
+          for (auto arg : new_call->args) {
+            auto new_arg = this->Mutate(arg);
+            call_args.push_back(new_arg);
+          }
+          res = Call(new_call->op, call_args);
+          if (memoizable) {
+            SaveAttrsConversion(op, node, new_call, call_args, hash);
+          }
+        } else {
+          return this->Mutate(new_expr);
         }
-        res = Call(new_call->op, call_args);
-      } else {
-        return this->Mutate(new_expr);
+      } catch (const dmlc::Error& e) {
+        LOG(WARNING) << e.what();
+        // Return the orignial Relay call and make a record for unsupported ops
+        unsupported_ops_[op->name]++;
+        return Call(node->op, node->args, node->attrs);
       }
-    } catch (const dmlc::Error& e) {
-      LOG(WARNING) << e.what();
-      // Return the orignial Relay call and make a record for unsupported ops
-      unsupported_ops_[op->name]++;
-      return Call(node->op, node->args, node->attrs);
     }
     CHECK(res.defined());
     if (fmutation.count(op)) {
@@ -385,6 +489,79 @@ struct FromRelayMutator : public ExprMutator {
     return scope->Push(raf::ir::MakeVar("a" + std::to_string(++num_bound_var_), {}), Tuple(res));
   }
 
+  /*!
+   * \brief Whether the conversion of the call can be memoized, i.e., its arguments are distinct
+   * vars bound to non-constant values, so the converters cannot look up any constant from them.
+   */
+  bool IsAttrsMemoizable(const CallNode* node) {
+    std::unordered_set<const Object*> args;
+    for (const Expr& arg : node->args) {
+      const auto* var = arg.as<VarNode>();
+      if (var == nullptr || !args.insert(var).second) {
+        return false;
+      }
+      auto it = var_value_map_.find(GetRef<Var>(var));
+      if (it == var_value_map_.end() || (*it).second->IsInstance<RelayConstantNode>()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  size_t HashAttrsConversion(const Op& op, const CallNode* node) {
+    size_t hash = ObjectPtrHash()(op);
+    hash = dmlc::HashCombine(hash, node->args.size());
+    if (node->attrs.defined()) {
+      hash = dmlc::HashCombine(hash, tvm::StructuralHash()(node->attrs));
+    }
+    return hash;
+  }
+
+  Call LookupAttrsConversion(const Op& op, const CallNode* node, size_t hash) {
+    auto it = attrs_memo_.find(hash);
+    if (it == attrs_memo_.end()) {
+      return Call();
+    }
+    for (const AttrsConversion& conv : it->second) {
+      if (conv.op != op || conv.num_args != node->args.size() ||
+          !tvm::StructuralEqual()(conv.attrs, node->attrs)) {
+        continue;
+      }
+      Array<Expr> call_args;
+      for (size_t i = 0; i < conv.arg_indices.size(); ++i) {
+        int index = conv.arg_indices[i];
+        call_args.push_back(index >= 0 ? this->Mutate(node->args[index])
+                                       : MakeConstant(conv.values[i]));
+      }
+      return Call(conv.raf_op, call_args);
+    }
+    return Call();
+  }
+
+  void SaveAttrsConversion(const Op& op, const CallNode* node, const Call& new_call,
+                           const Array<Expr>& call_args, size_t hash) {
+    AttrsConversion conv{op, node->attrs, node->args.size(), new_call->op, {}, {}};
+    for (size_t i = 0; i < new_call->args.size(); ++i) {
+      int index = -1;
+      for (size_t j = 0; j < node->args.size() && index < 0; ++j) {
+        if (node->args[j].same_as(new_call->args[i])) {
+          index = static_cast<int>(j);
+        }
+      }
+      if (index >= 0) {
+        conv.arg_indices.push_back(index);
+        conv.values.push_back(ObjectRef());
+      } else if (const auto* konst = call_args[i].as<ConstantNode>()) {
+        conv.arg_indices.push_back(-1);
+        conv.values.push_back(konst->value);
+      } else {
+        // The argument is built by the converter, e.g., a tuple of the arguments.
+        return;
+      }
+    }
+    attrs_memo_[hash].push_back(std::move(conv));
+  }
+
   /*!
    * \brief Concat unsupported ops and their appearance to a string.
    * \return A string of unsupported ops, or empty if none.
@@ -418,6 +595,10 @@ struct FromRelayMutator : public ExprMutator {
   Var curr_let_var_;
   /*! \brief Whether we are currently visiting a composite function body. */
   bool is_in_composite_func_ = false;
+  /*! \brief Map from the Relay arrays to their converted tensors. */
+  std::unordered_map<const Object*, TensorValue> const_memo_;
+  /*! \brief The memoized conversions of the ops indexed by the hash of the op and attributes. */
+  std::unordered_map<size_t, std::vector<AttrsConversion>> attrs_memo_;
 };
 
 }  // namespace from_relay
@@ -465,7 +646,10 @@ Pass FromRelay(Array<String> disabled_pass) {
         auto updated_func = PartitionPatterns(func);
 
         // Transform to ANF and convert Relay ops to RAF ops
-        auto anf_expr = Downcast<Function>(tvm::relay::transform::ToANormalForm(updated_func));
+        auto anf_expr = from_relay::LinearizeDataflow(updated_func);
+        if (!anf_expr.defined()) {
+          anf_expr = Downcast<Function>(tvm::relay::transform::ToANormalForm(updated_func));
+        }
         auto mutator = from_relay::FromRelayMutator();
         updated_func = Downcast<Function>(mutator.Mutate(anf_expr));
 
@@ -0,0 +1,266 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file fuse_batch_norm_relu.cc
+ * \brief Fuse relu(batch_norm_train(...)[0] (+ z)) of the ANF forward graph into the fused
+ * batch_norm + add + relu training op, whose backward keeps the ReLU mask instead of the
+ * activation. The pass runs before AutoDiff, so that the fused op gets its fused gradient.
+ */
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "raf/op.h"
+#include "raf/ir.h"
+#include "raf/ir_ext.h"
+#include "raf/pass.h"
+#include "./let_list.h"
+
+namespace raf {
+namespace pass {
+namespace fuse_batch_norm_relu {
+
+using namespace raf::ir;
+using namespace raf::op;
+
+/*! \brief The vars referenced by the bound value of ANF. */
+std::vector<const VarNode*> RefVars(const Expr& value) {
+  std::vector<const VarNode*> vars;
+  auto add = [&vars](const Expr& e) {
+    if (const auto* var = e.as<VarNode>()) {
+      vars.push_back(var);
+    }
+  };
+  if (const auto* call = value.as<CallNode>()) {
+    add(call->op);
+    for (const Expr& arg : call->args) {
+      add(arg);
+    }
+  } else if (const auto* tuple = value.as<TupleNode>()) {
+    for (const Expr& field : tuple->fields) {
+      add(field);
+    }
+  } else if (const auto* item = value.as<TupleGetItemNode>()) {
+    add(item->tuple);
+  } else if (value->IsInstance<VarNode>()) {
+    add(value);
+  } else if (!value->IsInstance<ConstantNode>() && !value->IsInstance<OpNode>()) {
+    for (const Var& var : FreeVars(value)) {
+      vars.push_back(var.get());
+    }
+  }
+  return vars;
+}
+
+inline bool IsNull(const Expr& expr) {
+  const auto* constant = expr.as<ConstantNode>();
+  return constant != nullptr && !constant->value.defined();
+}
+
+/*! \brief A matched relu(batch_norm_train(...)[0] (+ z)), where z may be undefined. */
+struct Match {
+  int bn;
+  int item;
+  int add = -1;
+  int relu;
+  /*! \brief The fused op is bound right after this binding. */
+  int at;
+  /*! \brief The bindings of the running statistics to be moved after the fused op. */
+  std::vector<int> moved;
+  Expr z;
+};
+
+Function FuseBatchNormReLU(const Function& func) {
+  static const Op& bn_op = Op::Get("raf.op.batch_norm_train");
+  static const Op& add_op = Op::Get("raf.op.add");
+  static const Op& relu_op = Op::Get("raf.op.relu");
+  static const Op& fused_op = Op::Get("raf.op._contrib_batch_norm_add_relu_train");
+  std::vector<Var> vars;
+  std::vector<Expr> values;
+  Expr ret = func->body;
+  while (const auto* let = ret.as<LetNode>()) {
+    vars.push_back(let->var);
+    values.push_back(let->value);
+    ret = let->body;
+  }
+  const int n = vars.size();
+  std::unordered_map<const VarNode*, int> pos;
+  std::unordered_map<const VarNode*, int> num_uses;
+  std::vector<std::vector<const VarNode*>> refs(n);
+  for (int i = 0; i < n; ++i) {
+    pos[vars[i].get()] = i;
+    refs[i] = RefVars(values[i]);
+    for (const VarNode* var : refs[i]) {
+      ++num_uses[var];
+    }
+  }
+  for (const VarNode* var : RefVars(ret)) {
+    ++num_uses[var];
+  }
+  auto bound_call = [&](const Expr& expr, const Op& op) -> const CallNode* {
+    const auto* var = expr.as<VarNode>();
+    if (var == nullptr || pos.count(var) == 0) {
+      return nullptr;
+    }
+    const auto* call = values[pos.at(var)].as<CallNode>();
+    return call != nullptr && call->op == op ? call : nullptr;
+  };
+  // Whether the expr is a var used once, and bound to the field 0 of a batch_norm_train call.
+  auto as_bn_output = [&](const Expr& expr, Match* match) {
+    const auto* var = expr.as<VarNode>();
+    if (var == nullptr || pos.count(var) == 0 || num_uses[var] != 1) {
+      return false;
+    }
+    const auto* item = values[pos.at(var)].as<TupleGetItemNode>();
+    if (item == nullptr || item->index != 0 || bound_call(item->tuple, bn_op) == nullptr) {
+      return false;
+    }
+    match->item = pos.at(var);
+    match->bn = pos.at(item->tuple.as<VarNode>());
+    return bound_call(item->tuple, bn_op)->args.size() == 7U;
+  };
+
+  std::vector<Match> matches;
+  std::unordered_set<int> matched_bn;
+  for (int i = 0; i < n; ++i) {
+    const auto* relu = values[i].as<CallNode>();
+    if (relu == nullptr || relu->op != relu_op || relu->args.size() != 1U) {
+      continue;
+    }
+    Match match;
+    match.relu = i;
+    const Expr& input = relu->args[0];
+    if (!as_bn_output(input, &match)) {
+      const auto* add = bound_call(input, add_op);
+      const auto* sum = input.as<VarNode>();
+      if (add == nullptr || num_uses[sum] != 1 || add->args.size() != 4U ||
+          !IsNull(add->args[2]) || !IsNull(add->args[3])) {
+        continue;
+      }
+      int operand = as_bn_output(add->args[0], &match) ? 0 : 1;
+      if (operand == 1 && !as_bn_output(add->args[1], &match)) {
+        continue;
+      }
+      // The residual must have the shape of the batch norm output, i.e., not be broadcast.
+      const Expr& bn_out = add->args[operand];
+      match.z = add->args[1 - operand];
+      if (!bn_out->checked_type_.defined() || !match.z->checked_type_.defined() ||
+          !tvm::StructuralEqual()(bn_out->checked_type_, match.z->checked_type_)) {
+        continue;
+      }
+      match.add = pos.at(sum);
+    }
+    if (matched_bn.count(match.bn)) {
+      continue;
+    }
+    // Only the running statistics of batch_norm_train may be used besides its output.
+    const VarNode* bn_var = vars[match.bn].get();
+    bool only_stats = true;
+    for (int j = match.bn + 1; j < n && only_stats; ++j) {
+      if (j == match.item) {
+        continue;
+      }
+      for (const VarNode* var : refs[j]) {
+        const auto* item = values[j].as<TupleGetItemNode>();
+        if (var == bn_var && (item == nullptr || item->index == 0)) {
+          only_stats = false;
+        }
+      }
+    }
+    for (const VarNode* var : RefVars(ret)) {
+      only_stats = only_stats && var != bn_var;
+    }
+    if (!only_stats) {
+      continue;
+    }
+    // The fused op is bound where both the batch norm args and the residual are defined, which
+    // is right after the residual if it is defined after the batch norm. The running statistics
+    // taken in between are moved after the fused op, unless they are used before it.
+    const auto* z_var = match.z.as<VarNode>();
+    match.at = match.bn;
+    if (z_var != nullptr && pos.count(z_var) && pos.at(z_var) > match.bn) {
+      int z_pos = pos.at(z_var);
+      std::unordered_set<const VarNode*> moved;
+      bool used = false;
+      for (int j = match.bn + 1; j <= z_pos && !used; ++j) {
+        for (const VarNode* var : refs[j]) {
+          used = used || moved.count(var);
+        }
+        if (j != match.item && refs[j].size() == 1U && refs[j][0] == bn_var) {
+          moved.insert(vars[j].get());
+          match.moved.push_back(j);
+        }
+      }
+      if (used) {
+        continue;
+      }
+      match.at = z_pos;
+    }
+    matched_bn.insert(match.bn);
+    matches.push_back(match);
+  }
+  if (matches.empty()) {
+    return func;
+  }
+
+  std::unordered_set<int> removed;
+  std::unordered_map<int, std::vector<std::pair<Var, Expr>>> insert_after;
+  std::unordered_map<int, Expr> replaced;
+  // The running statistics keep their indices in the outputs of the fused op.
+  std::unordered_map<const VarNode*, Var> fused_vars;
+  for (const Match& match : matches) {
+    const auto* bn = values[match.bn].as<CallNode>();
+    Expr z = match.z.defined() ? match.z : MakeNull();
+    Array<Expr> args = {bn->args[0], bn->args[1], bn->args[2], bn->args[3], bn->args[4],
+                        z,           bn->args[5], bn->args[6]};
+    Var fused_var = MakeVar(vars[match.bn]->name_hint(), {});
+    fused_vars[vars[match.bn].get()] = fused_var;
+    removed.insert(match.bn);
+    removed.insert(match.item);
+    if (match.add >= 0) {
+      removed.insert(match.add);
+    }
+    insert_after[match.at].emplace_back(fused_var, Call(fused_op, args));
+    for (int j : match.moved) {
+      const auto* item = values[j].as<TupleGetItemNode>();
+      insert_after[match.at].emplace_back(vars[j], TupleGetItem(fused_var, item->index));
+      removed.insert(j);
+    }
+    replaced[match.relu] = TupleGetItem(fused_var, 0);
+  }
+  Expr body = LetList::With([&](LetList* ll) {
+    for (int i = 0; i < n; ++i) {
+      const auto* item = values[i].as<TupleGetItemNode>();
+      const auto* tuple = item != nullptr ? item->tuple.as<VarNode>() : nullptr;
+      if (tuple != nullptr && fused_vars.count(tuple)) {
+        replaced[i] = TupleGetItem(fused_vars.at(tuple), item->index);
+      }
+      if (!removed.count(i)) {
+        ll->Push(vars[i], replaced.count(i) ? replaced.at(i) : values[i]);
+      }
+      for (const auto& it : insert_after[i]) {
+        ll->Push(it.first, it.second);
+      }
+    }
+    return ret;
+  });
+  return Function(func->params, body, func->ret_type, func->type_params, func->attrs);
+}
+
+}  // namespace fuse_batch_norm_relu
+
+Pass FuseBatchNormReLU() {
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
+                                                                             PassContext pc) {
+    return fuse_batch_norm_relu::FuseBatchNormReLU(f);
+  };
+  return CreateRAFFunctionPass(pass_func, 0, "FuseBatchNormReLU", {"InferType"});
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.FuseBatchNormReLU").set_body_typed(FuseBatchNormReLU);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.optimize.fuse_batch_norm_relu", Bool);
+
+}  // namespace pass
+}  // namespace raf
@@ -7,6 +7,7 @@
  * \file src/pass/fuse_dialect.cc
  * \brief Fuse the operators using registered dialect fusion patterns.
  */
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -53,7 +54,20 @@ class FuseMutator : public ExprMutator {
         call_set_(call_set),
         pattern_name_(pattern_name),
         func_cache_(cache) {
-    single_call_ = (call_set.size() == 1);
+    single_call_ = (call_set.size() == 1) && HasOpEnvMaker(*call_set.begin());
+  }
+
+  /*!
+   * \brief Whether the dialect op of the call has its own OpEnvMaker. Otherwise, the single call
+   * is still wrapped in a fused function, which is dispatched to the fused op of the dialect.
+   */
+  bool HasOpEnvMaker(const Expr& expr) const {
+    const auto* call = expr.as<CallNode>();
+    if (call == nullptr || !call->op->IsInstance<OpNode>()) {
+      return true;
+    }
+    auto dialect_op = OpDialect::Lower(Downcast<Op>(call->op), dialect_);
+    return !dialect_op.defined() || OpEnvMaker::Get(dialect_op->name) != nullptr;
   }
 
   /*! \brief Rewrite the matched expression to a fused function. */
@@ -187,16 +201,22 @@ Expr FuseDialectPatterns(const Expr& expr, const IRModule& mod) {
     return expr;
   }
   DevType dev_type = dev.device_type();
-  Expr ret = expr;
+  // All patterns are rewritten in one call in the order of their priorities, so that the
+  // patterns whose root ops are absent from the graph are skipped without matching.
+  std::vector<std::unique_ptr<DialectPatternRewrite>> rewrites;
+  Array<DFPatternCallback> callbacks;
   for (auto pat : *DialectFusePattern::Get()) {
     if (!Dialect::IsEnabled(pat.dialect, dev_type)) {
       continue;
     }
     DLOG(INFO) << "Fuse pattern " << pat.name << " for " << pat.dialect;
-    DialectPatternRewrite rewrite(mod, dev_type, pat);
-    ret = RAFRewritePatterns({rewrite.MakeCallback()}, ret, mod);
+    rewrites.emplace_back(std::make_unique<DialectPatternRewrite>(mod, dev_type, pat));
+    callbacks.push_back(rewrites.back()->MakeCallback());
+  }
+  if (callbacks.empty()) {
+    return expr;
   }
-  return ret;
+  return RAFRewritePatterns(callbacks, expr, mod);
 }
 
 }  // namespace fuse_dialect
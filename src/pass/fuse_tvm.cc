@@ -7,6 +7,7 @@
  * \file src/pass/tvm_fuse.cc
  * \brief Fuse the operators using TVM op patterns.
  */
+#include <map>
 #include "raf/op.h"
 #include "raf/ir.h"
 #include "raf/binding.h"
@@ -655,6 +656,241 @@ class FuseMutator : private ExprMutator {
   }
 };
 
+/*!
+ * \brief Horizontally fuse independent ops into a single primitive function with a tuple output.
+ * This runs after the vertical fusion. It groups the calls of elementwise, broadcast, injective,
+ * or reduction ops, as well as the primitive TVM functions composed of them, that produce tensors
+ * of the same type. Since a call only depends on the calls with lower depths (the longest path
+ * from the function inputs), calls of the same depth are independent, and fusing them never
+ * introduces cycles. Each fused call is then replaced with a field of the horizontal call, which
+ * reduces the kernel launches of, e.g., per-head bias adds or parallel layer norms.
+ */
+class HorizontalFuser : private ExprMutator {
+ public:
+  Function Transform(const Function& func) {
+    if (HasControlFlow(func->body)) {
+      // Only graph normal form is supported, where the order of independent calls is free.
+      return func;
+    }
+    // Bucket the candidates by depth and key, in post DFS order for determinism.
+    std::map<std::pair<int, std::string>, std::vector<const CallNode*>> buckets;
+    tvm::relay::PostOrderVisit(func->body, [&](const Expr& expr) {
+      if (auto call = expr.as<CallNode>()) {
+        auto key = HorizontalKey(call);
+        if (!key.empty()) {
+          buckets[{Depth(expr), key}].push_back(call);
+        }
+      }
+    });
+    for (auto& it : buckets) {
+      auto& calls = it.second;
+      for (size_t begin = 0; begin + 1 < calls.size(); begin += kMaxHorizontalOps) {
+        size_t end = std::min(calls.size(), begin + kMaxHorizontalOps);
+        if (end - begin < 2) {
+          break;
+        }
+        groups_.emplace_back();
+        for (size_t i = begin; i < end; ++i) {
+          call_group_[calls[i]] = {groups_.size() - 1, i - begin};
+          groups_.back().calls.push_back(calls[i]);
+        }
+      }
+    }
+    if (groups_.empty()) {
+      return func;
+    }
+    return Downcast<Function>(Mutate(func));
+  }
+
+ private:
+  /*! \brief The maximum number of calls to be fused horizontally. */
+  static constexpr size_t kMaxHorizontalOps = 16;
+
+  /*! \brief The calls to be fused horizontally and the call of the fused function. */
+  struct HorizontalGroup {
+    std::vector<const CallNode*> calls;
+    Expr fused_call;
+  };
+
+  Expr VisitExpr_(const FunctionNode* fn_node) final {
+    if (fn_node->HasNonzeroAttr(attr::kPrimitive)) {
+      return GetRef<Expr>(fn_node);
+    }
+    return ExprMutator::VisitExpr_(fn_node);
+  }
+
+  Expr VisitExpr_(const CallNode* call) final {
+    auto it = call_group_.find(call);
+    if (it == call_group_.end()) {
+      return ExprMutator::VisitExpr_(call);
+    }
+    auto& group = groups_[it->second.first];
+    if (!group.fused_call.defined()) {
+      group.fused_call = MakeFusedCall(group);
+    }
+    return TupleGetItem(group.fused_call, it->second.second);
+  }
+
+  /*! \brief Build the primitive function that computes all calls of the group. */
+  Expr MakeFusedCall(const HorizontalGroup& group) {
+    Array<Var> params;
+    Array<Expr> arguments;
+    auto get_or_alloc_param = [&](const Expr& arg, const Type& type) {
+      for (size_t i = 0; i < arguments.size(); ++i) {
+        if (arg.same_as(arguments[i])) return params[i];
+      }
+      std::ostringstream os;
+      os << "p" << params.size();
+      auto var = MakeVar(os.str(), type);
+      params.push_back(var);
+      arguments.push_back(arg);
+      return var;
+    };
+    Array<Expr> fields;
+    Array<Type> field_types;
+    for (const CallNode* call : group.calls) {
+      Array<Expr> call_params;
+      for (const auto& arg : call->args) {
+        call_params.push_back(get_or_alloc_param(Mutate(arg), arg->checked_type()));
+      }
+      if (auto fn = call->op.as<FunctionNode>()) {
+        // Inline the vertically fused function.
+        Map<Var, Expr> args_map;
+        for (size_t i = 0; i < fn->params.size(); ++i) {
+          args_map.Set(fn->params[i], call_params[i]);
+        }
+        fields.push_back(Substitute(fn->body, args_map));
+      } else {
+        fields.push_back(Call(call->op, call_params, call->attrs, call->type_args));
+      }
+      field_types.push_back(call->checked_type());
+    }
+    auto func = Function(params, Tuple(fields), TupleType(field_types), {});
+    func = Downcast<Function>(DispatchToTVMOps().Mutate(func));
+    func = WithAttr(std::move(func), attr::kPrimitive, Integer(1));
+    func = WithAttr(std::move(func), attr::kDialect, String("tvm"));
+    return Call(func, arguments, Attrs());
+  }
+
+  /*!
+   * \brief The key of a call that is horizontally fusable, or an empty string otherwise. Calls with
+   * the same key and depth can be fused.
+   */
+  static std::string HorizontalKey(const CallNode* call) {
+    if (!call->checked_type_.defined() || !call->checked_type()->IsInstance<TensorTypeNode>()) {
+      return "";
+    }
+    OpPatternKind pattern = kElemWise;
+    if (call->op->IsInstance<OpNode>()) {
+      if (!UpdatePattern(call, &pattern)) {
+        return "";
+      }
+    } else if (auto fn = call->op.as<FunctionNode>()) {
+      auto dialect = fn->GetAttr<String>(attr::kDialect);
+      if (!fn->HasNonzeroAttr(attr::kPrimitive) || !dialect.defined() ||
+          dialect.value() != "tvm") {
+        return "";
+      }
+      bool fusable = true;
+      tvm::relay::PostOrderVisit(fn->body, [&](const Expr& expr) {
+        if (auto inner = expr.as<CallNode>()) {
+          fusable = fusable && UpdatePattern(inner, &pattern);
+        }
+      });
+      if (!fusable) {
+        return "";
+      }
+    } else {
+      return "";
+    }
+    std::string kind = pattern <= kInjective ? "injective:" : "reduce:";
+    return kind + raf::ir::AsText(call->checked_type(), false);
+  }
+
+  /*!
+   * \brief Combine the pattern of an op call into the given pattern.
+   * \return Whether the call is horizontally fusable.
+   */
+  static bool UpdatePattern(const CallNode* call, OpPatternKind* pattern) {
+    static auto fpattern = Op::GetAttrMap<TOpPattern>("TOpPattern");
+    static auto finplace = Op::GetAttrMap<TRAFInplaceUpdate>("TRAFInplaceUpdate");
+    static auto add_op = Op::Get("raf.op.add");
+    static auto subtract_op = Op::Get("raf.op.subtract");
+    auto op_node = call->op.as<OpNode>();
+    if (op_node == nullptr) {
+      return false;
+    }
+    auto op = GetRef<Op>(op_node);
+    Op tvm_op = op;
+    if (IsDialectOp(op)) {
+      // The ops in a vertically fused function have been dispatched to TVM.
+      if (GetDialect(op) != "tvm") {
+        return false;
+      }
+      op = Downcast<Op>(GetBaseOp(op));
+    } else {
+      tvm_op = OpDialect::Lower(op, "tvm");
+      if (!tvm_op.defined()) {
+        return false;
+      }
+    }
+    // Fusing ops that update their inputs in place may change the order of the updates.
+    if (finplace.count(op)) {
+      return false;
+    }
+    if ((op == add_op || op == subtract_op) && call->args.size() > 2) {
+      auto konst = call->args[2].as<ConstantNode>();
+      if (!konst || konst->value.defined()) {
+        return false;
+      }
+    }
+    auto op_pattern = static_cast<OpPatternKind>(fpattern.get(tvm_op, kOpaque));
+    if (op_pattern > kCommReduce) {
+      return false;
+    }
+    *pattern = std::max(*pattern, op_pattern);
+    return true;
+  }
+
+  /*! \brief The longest path from the function inputs to the expr. */
+  int Depth(const Expr& expr) {
+    auto it = depth_.find(expr.get());
+    if (it != depth_.end()) {
+      return it->second;
+    }
+    int depth = 0;
+    auto update = [&](const Expr& input) { depth = std::max(depth, Depth(input) + 1); };
+    if (auto call = expr.as<CallNode>()) {
+      for (const auto& arg : call->args) {
+        update(arg);
+      }
+    } else if (auto tuple = expr.as<TupleNode>()) {
+      for (const auto& field : tuple->fields) {
+        update(field);
+      }
+    } else if (auto tuple_get = expr.as<TupleGetItemNode>()) {
+      update(tuple_get->tuple);
+    }
+    return depth_[expr.get()] = depth;
+  }
+
+  /*! \brief Whether the expr has let bindings or branches. */
+  static bool HasControlFlow(const Expr& expr) {
+    bool found = false;
+    tvm::relay::PostOrderVisit(expr, [&](const Expr& e) {
+      found = found || e->IsInstance<LetNode>() || e->IsInstance<IfNode>();
+    });
+    return found;
+  }
+
+  /*! \brief The depth of each expr. */
+  std::unordered_map<const Object*, int> depth_;
+  /*! \brief The horizontal groups. */
+  std::vector<HorizontalGroup> groups_;
+  /*! \brief Mapping from a fused call to its group index and field index. */
+  std::unordered_map<const CallNode*, std::pair<size_t, size_t>> call_group_;
+};
+
 }  // namespace fuse_tvm
 
 Pass FuseTVM() {
@@ -666,10 +902,19 @@ Pass FuseTVM() {
 
   Pass func_pass = CreateRAFFunctionPass(pass_func, 2, "FuseTVM", {});
   PassInfo pass_info(2, "FuseTVM", {});
-  return RAFSequential({InferType(), func_pass}, pass_info);
+  if (!pass_ctx->GetConfig("raf.fuse_tvm.horizontal", Bool(false)).value()) {
+    return RAFSequential({InferType(), func_pass}, pass_info);
+  }
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> horizontal_func =
+      [=](Function f, IRModule m, PassContext pc) {
+        return fuse_tvm::HorizontalFuser().Transform(f);
+      };
+  Pass horizontal_pass = CreateRAFFunctionPass(horizontal_func, 2, "HorizontalFuseTVM", {});
+  return RAFSequential({InferType(), func_pass, InferType(), horizontal_pass}, pass_info);
 }
 
 RAF_REGISTER_GLOBAL("raf.pass_.FuseTVM").set_body_typed(FuseTVM);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.fuse_tvm.horizontal", Bool);
 
 }  // namespace pass
 }  // namespace raf
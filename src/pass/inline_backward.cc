@@ -7,8 +7,12 @@
  * \file inline_backward.cc
  * \brief inlining backward graph in the forward pass
  */
+#include <algorithm>
+#include <unordered_set>
 #include "raf/op.h"
+#include "raf/op_utils.h"
 #include "raf/ir.h"
+#include "raf/ir_ext.h"
 #include "raf/pass.h"
 #include "raf/binding.h"
 #include "./common.h"
@@ -18,6 +22,101 @@ namespace pass {
 namespace inline_backward {
 
 using namespace raf::ir;
+using namespace raf::op;
+
+/*! \brief Whether the forward binding can be recomputed in the backward with the same result. */
+bool IsRecomputable(const Var& var, const Expr& expr) {
+  static const OpSet random_ops = {Op::Get("raf.op._contrib_dropout"),
+                                   Op::Get("raf.op.threefry_generate"),
+                                   Op::Get("raf.op.threefry_split")};
+  const auto* extended_var = var.as<ExtendedVarNode>();
+  if (extended_var && extended_var->may_share.defined()) {
+    return false;
+  }
+  if (expr->IsInstance<TupleNode>() || expr->IsInstance<TupleGetItemNode>()) {
+    return true;
+  }
+  const auto* call = expr.as<CallNode>();
+  const auto* op_node = call ? call->op.as<OpNode>() : nullptr;
+  if (op_node == nullptr) {
+    return false;
+  }
+  Op op = GetRef<Op>(op_node);
+  return !IsInOpSet(op, random_ops) && !IsCollectiveOp(op) &&
+         !GetOpAttrOrDefault<TRAFSideEffect>(op, "TRAFSideEffect", false) &&
+         GetOpAttrOrDefault<TRAFInplaceUpdate>(op, "TRAFInplaceUpdate", {}).empty();
+}
+
+/*!
+ * \brief Recompute the forward activations of the checkpoint segments in the backward. The
+ * forward is split into segments by the checkpoint annotations, whose outputs are the segment
+ * boundaries. Except for the last segment, of which the activations are used first by the
+ * backward, the activations used by the backward are recomputed from the boundaries right before
+ * their first uses, so only the boundaries are kept alive through the forward.
+ * \param ell The let list of the forward followed by the backward.
+ * \param bwd_begin The index of the first backward binding in the let list.
+ */
+void RecomputeCheckpointSegments(ExplicitLetList* ell, size_t bwd_begin) {
+  static const Op& checkpoint = Op::Get("raf.op.checkpoint");
+  // The segment of each recomputable forward binding, and its index in the let list.
+  std::unordered_map<const VarNode*, std::pair<int, size_t>> fwd;
+  int num_segments = 0;
+  for (size_t i = 0; i < bwd_begin; ++i) {
+    const auto* call = ell->exprs[i].as<CallNode>();
+    if (call && call->op.same_as(checkpoint)) {
+      num_segments++;
+    } else if (IsRecomputable(ell->vars[i], ell->exprs[i])) {
+      fwd[ell->vars[i].get()] = {num_segments, i};
+    }
+  }
+  if (num_segments == 0) {
+    return;
+  }
+
+  ExplicitLetList ret;
+  ret.vars.assign(ell->vars.begin(), ell->vars.begin() + bwd_begin);
+  ret.exprs.assign(ell->exprs.begin(), ell->exprs.begin() + bwd_begin);
+  Map<Var, Expr> subst;
+  // Re-emit the bindings the given forward var depends on within its segment in forward order,
+  // reusing the ones that have been recomputed.
+  auto recompute = [&](const Var& var) {
+    std::vector<size_t> indices;
+    std::vector<Var> stack{var};
+    std::unordered_set<const VarNode*> visited{var.get()};
+    int segment = fwd.at(var.get()).first;
+    while (!stack.empty()) {
+      Var curr = stack.back();
+      stack.pop_back();
+      size_t index = fwd.at(curr.get()).second;
+      indices.push_back(index);
+      for (const auto& arg : FreeVars(ell->exprs[index])) {
+        auto it = fwd.find(arg.get());
+        if (it != fwd.end() && it->second.first == segment && !subst.count(arg) &&
+            visited.insert(arg.get()).second) {
+          stack.push_back(arg);
+        }
+      }
+    }
+    std::sort(indices.begin(), indices.end());
+    for (auto index : indices) {
+      const Var& orig = ell->vars[index];
+      Var new_var = MakeVar(orig->name_hint() + "_recompute", orig->type_annotation);
+      ret.Push(new_var, Substitute(ell->exprs[index], subst));
+      subst.Set(orig, new_var);
+    }
+  };
+  for (size_t i = bwd_begin; i < ell->vars.size(); ++i) {
+    for (const auto& arg : FreeVars(ell->exprs[i])) {
+      auto it = fwd.find(arg.get());
+      if (it != fwd.end() && it->second.first < num_segments && !subst.count(arg)) {
+        recompute(arg);
+      }
+    }
+    ret.Push(ell->vars[i], subst.empty() ? ell->exprs[i] : Substitute(ell->exprs[i], subst));
+  }
+  ell->vars = std::move(ret.vars);
+  ell->exprs = std::move(ret.exprs);
+}
 
 class InlineBackwardFunc : public ExprVisitor {
  public:
@@ -47,6 +146,7 @@ class InlineBackwardFunc : public ExprVisitor {
 
   void VisitExpr_(const FunctionNode* func_node) final {
     closure_params_ = func_node->params;
+    bwd_begin_ = ell_.vars.size();
     in_closure_ = true;
     VisitExpr(func_node->body);
     in_closure_ = false;
@@ -79,6 +179,7 @@ class InlineBackwardFunc : public ExprVisitor {
     // Rename the closure ret var to be gradient
     Var gradient = MakeVar("gradient", {});
     ell_.vars[ell_.vars.size() - 1] = gradient;
+    RecomputeCheckpointSegments(&ell_, bwd_begin_);
     ret_tup.push_back(ell_.vars.back());
     // Add an extra return stmt
     Var ret_var = MakeVar("ret", {});
@@ -99,6 +200,8 @@ class InlineBackwardFunc : public ExprVisitor {
   ExplicitLetList ell_;
   /*! \brief Indicate whether it is in closure */
   bool in_closure_ = false;
+  /*! \brief The index of the first backward binding in the let list */
+  size_t bwd_begin_ = 0;
 };
 }  // namespace inline_backward
 
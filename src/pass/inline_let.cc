@@ -93,7 +93,7 @@ Pass InlineLet() {
                                                                              PassContext pc) {
     return Downcast<Function>(inline_let::LetInliner().VisitExpr(f));
   };
-  return CreateRAFFunctionPass(pass_func, 1, "InlineLet", {});
+  return CreateRAFFunctionPass(pass_func, 1, "InlineLet", {}, /*thread_safe=*/true);
 }
 
 RAF_REGISTER_GLOBAL("raf.pass_.InlineLet").set_body_typed(InlineLet);
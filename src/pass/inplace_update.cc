@@ -518,8 +518,8 @@ Pass InplaceUpdate() {
 Pass ValidateInplaceUpdate(bool enforce_inplace_update) {
   TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
                                                                              PassContext pc) {
-    auto analyzer = liveness_analysis::LivenessAnalyzer(f);
-    analyzer.Run();
+    // Copy the cached analyzer, because the validator unites the tensors sharing memory.
+    auto analyzer = *liveness_analysis::GetLivenessAnalyzer(f);
     auto body =
         inplace_update::InplaceUpdateValidator(f->body, analyzer, enforce_inplace_update).Run();
     return Function(f->params, body, f->ret_type, f->type_params, f->attrs);
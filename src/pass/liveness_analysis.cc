@@ -8,6 +8,10 @@
  * \brief A pass for analyzing tensor liveness.
  */
 #include "liveness_analysis.h"
+#include <cmath>
+#include <deque>
+#include <limits>
+#include <mutex>
 #include <vector>
 #include "raf/op.h"
 #include "raf/ir.h"
@@ -24,6 +28,15 @@ using PackedLiveInMap = Map<Var, Array<Var>>;
 
 namespace liveness_analysis {
 
+/*!
+ * \brief Whether the call creates views of its first argument instead of new tensors, i.e., the
+ * reshape ops, and split and strided_slice whose outputs are contiguous chunks of the input.
+ */
+bool IsViewCall(const CallNode* call) {
+  return call->op->IsInstance<OpNode>() &&
+         (IsReshapeOp(Downcast<Op>(call->op)) || !GetViewOffsets(call).empty());
+}
+
 MapVSet LivenessAnalyzer::Run() {
   Expr body;
   FormCheck(func_->body);
@@ -100,9 +113,289 @@ MapVSet LivenessAnalyzer::Run() {
     }
   }
 
+  if (!failure_ && var_out_.empty()) {
+    InitIncremental();
+  }
   return live_;
 }
 
+void LivenessAnalyzer::InitIncremental() {
+  auto ell = ExplicitLetList::make(func_->body);
+  int n = ell->vars.size();
+  for (int i = 0; i < n; ++i) {
+    const auto& expr = ell->exprs[i];
+    if (!expr->IsInstance<CallNode>() && !expr->IsInstance<TupleNode>() &&
+        !expr->IsInstance<TupleGetItemNode>() && !expr->IsInstance<VarNode>() &&
+        !expr->IsInstance<FunctionNode>()) {
+      // Op and constant bindings use the tensors of the next binding, and if-branches have
+      // nested bindings, so the live ranges are not intervals of the top-level bindings.
+      return;
+    }
+  }
+  for (int i = 0; i < n; ++i) {
+    const auto& var = ell->vars[i];
+    const auto& expr = ell->exprs[i];
+    order_[i] = var;
+    position_[var] = i;
+    exprs_[var] = expr;
+    binding_uses_[var] = GetBindingUses(var, expr);
+    for (const auto& tensor : binding_uses_[var]) {
+      tensor_uses_[tensor].insert(var);
+    }
+    for (const auto& tensor : GetBindingDefs(var, expr)) {
+      tensor_def_[tensor] = var;
+    }
+  }
+  position_[dummy_output_] = std::numeric_limits<double>::infinity();
+  for (const auto& tensor : vset_.at(ell->ret)) {
+    tensor_uses_[tensor].insert(dummy_output_);
+  }
+  incremental_ = true;
+}
+
+VSet LivenessAnalyzer::GetBindingUses(const Var& var, const Expr& expr) {
+  auto call = expr.as<CallNode>();
+  if (call == nullptr || IsViewCall(call)) {
+    // Tuples, tuple items, vars, closures and views use the tensors they refer to.
+    return vset_.at(var);
+  }
+  VSet uses;
+  for (const auto& arg : call->args) {
+    if (auto arg_var = arg.as<VarNode>()) {
+      const auto& arg_tensors = vset_.at(GetRef<Var>(arg_var));
+      uses.insert(arg_tensors.begin(), arg_tensors.end());
+    }
+  }
+  return uses;
+}
+
+VSet LivenessAnalyzer::GetBindingDefs(const Var& var, const Expr& expr) {
+  auto call = expr.as<CallNode>();
+  if (call == nullptr || IsViewCall(call)) {
+    return VSet();
+  }
+  return vset_.at(var);
+}
+
+double LivenessAnalyzer::AssignPosition(const Var& var, const Var& next_var) {
+  auto next_it = order_.end();
+  if (next_var.defined() && !next_var.same_as(dummy_output_)) {
+    CHECK_GT(position_.count(next_var), 0U) << "Cannot find binding " << next_var->name_hint();
+    next_it = order_.find(position_.at(next_var));
+  }
+  double next_pos = (next_it != order_.end()) ? next_it->first
+                    : order_.empty()          ? 0.0
+                                              : order_.rbegin()->first + 2.0;
+  double prev_pos = (next_it != order_.begin()) ? std::prev(next_it)->first : next_pos - 2.0;
+  if (next_pos - prev_pos < 1e-6) {
+    // Renumber the bindings when the positions are too close. The relative order is kept.
+    std::map<double, Var> order;
+    double pos = 0;
+    for (const auto& kv : order_) {
+      order[pos] = kv.second;
+      position_[kv.second] = pos;
+      pos += 1;
+    }
+    order_.swap(order);
+    return AssignPosition(var, next_var);
+  }
+  double pos = (prev_pos + next_pos) / 2;
+  order_[pos] = var;
+  position_[var] = pos;
+  return pos;
+}
+
+double LivenessAnalyzer::DefPosition(const Var& tensor) {
+  auto it = tensor_def_.find(tensor);
+  if (it == tensor_def_.end()) {
+    return -std::numeric_limits<double>::infinity();
+  }
+  return position_.at(it->second);
+}
+
+double LivenessAnalyzer::LastUsePosition(const Var& tensor) {
+  double last = -std::numeric_limits<double>::infinity();
+  auto it = tensor_uses_.find(tensor);
+  if (it != tensor_uses_.end()) {
+    for (const auto& line : it->second) {
+      last = std::max(last, position_.at(line));
+    }
+  }
+  return last;
+}
+
+void LivenessAnalyzer::RefreshLiveRange(const Var& tensor, double lo, double hi) {
+  // A tensor is live from the binding after its definition to its last use.
+  double def = DefPosition(tensor);
+  double last = LastUsePosition(tensor);
+  if (std::isinf(lo)) {
+    // The tensor is never live before its definition.
+    lo = def;
+  }
+  for (auto it = order_.lower_bound(lo); it != order_.end() && it->first <= hi; ++it) {
+    SetLive(it->second, tensor, def < it->first && it->first <= last);
+  }
+}
+
+void LivenessAnalyzer::SetLive(const Var& line, const Var& tensor, bool live) {
+  if (live) {
+    live_[line].insert(tensor);
+    inv_live_[tensor].insert(line);
+  } else {
+    live_[line].erase(tensor);
+    inv_live_[tensor].erase(line);
+  }
+}
+
+void LivenessAnalyzer::InsertBinding(const Var& var, const Expr& expr, const Var& next_var) {
+  CHECK(incremental_) << "The liveness analysis cannot be updated incrementally";
+  CHECK_EQ(position_.count(var), 0U) << "Binding " << var->name_hint() << " already exists";
+  Expr binding = Let(var, expr, var);
+  Forward(binding);
+  auto defs = GetBindingDefs(var, expr);
+  auto uses = GetBindingUses(var, expr);
+  for (const auto& tensor : defs) {
+    tensor_def_[tensor] = var;
+    union_find_forest_[tensor] = tensor;
+    inv_live_[tensor] = {};
+  }
+  std::vector<Var> tensors(uses.begin(), uses.end());
+  tensors.insert(tensors.end(), defs.begin(), defs.end());
+
+  double pos = AssignPosition(var, next_var);
+  std::vector<double> prev_lasts;
+  for (const auto& tensor : tensors) {
+    prev_lasts.push_back(LastUsePosition(tensor));
+  }
+  exprs_[var] = expr;
+  binding_uses_[var] = uses;
+  for (const auto& tensor : uses) {
+    tensor_uses_[tensor].insert(var);
+  }
+
+  // The live-in of the new binding is the one of the next binding except its own tensors,
+  // and the tensors with changed live ranges are refreshed.
+  auto next_it = order_.upper_bound(pos);
+  Var next_line = (next_it != order_.end()) ? next_it->second : dummy_output_;
+  live_[var] = {};
+  for (const auto& tensor : live_.at(next_line)) {
+    if (defs.count(tensor) == 0) {
+      SetLive(var, tensor, true);
+    }
+  }
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    RefreshLiveRange(tensors[i], std::min(pos, prev_lasts[i]), std::max(pos, prev_lasts[i]));
+  }
+}
+
+void LivenessAnalyzer::RemoveBinding(const Var& var) {
+  CHECK(incremental_) << "The liveness analysis cannot be updated incrementally";
+  CHECK_GT(position_.count(var), 0U) << "Cannot find binding " << var->name_hint();
+  auto defs = GetBindingDefs(var, exprs_.at(var));
+  for (const auto& tensor : defs) {
+    CHECK(tensor_uses_[tensor].empty())
+        << "Cannot remove binding " << var->name_hint() << " because its tensors are used";
+  }
+  double pos = position_.at(var);
+  auto uses = binding_uses_.at(var);
+  for (const auto& tensor : uses) {
+    tensor_uses_[tensor].erase(var);
+  }
+  for (const auto& tensor : VSet(live_.at(var))) {
+    SetLive(var, tensor, false);
+  }
+  live_.erase(var);
+  order_.erase(pos);
+  position_.erase(var);
+  exprs_.erase(var);
+  binding_uses_.erase(var);
+  for (const auto& tensor : defs) {
+    tensor_def_.erase(tensor);
+    tensor_uses_.erase(tensor);
+    inv_live_.erase(tensor);
+    union_find_forest_.erase(tensor);
+    vset_.erase(tensor);
+  }
+  vset_.erase(var);
+  vtuple_.erase(var);
+
+  // The tensors used by the removed binding may die earlier.
+  for (const auto& tensor : uses) {
+    double last = LastUsePosition(tensor);
+    if (last < pos) {
+      RefreshLiveRange(tensor, last, pos);
+    }
+  }
+}
+
+void LivenessAnalyzer::MoveBinding(const Var& var, const Var& next_var) {
+  CHECK(incremental_) << "The liveness analysis cannot be updated incrementally";
+  CHECK_GT(position_.count(var), 0U) << "Cannot find binding " << var->name_hint();
+  auto defs = GetBindingDefs(var, exprs_.at(var));
+  std::vector<Var> uses(binding_uses_.at(var).begin(), binding_uses_.at(var).end());
+
+  // Detach the binding from its current position. The neighbor and the last uses are recorded
+  // as bindings, because the positions may be renumbered when assigning the new position.
+  auto old_next_it = order_.upper_bound(position_.at(var));
+  Var old_next = (old_next_it != order_.end()) ? old_next_it->second : dummy_output_;
+  std::vector<Var> prev_last_lines;
+  for (const auto& tensor : uses) {
+    double last = LastUsePosition(tensor);
+    prev_last_lines.push_back(std::isinf(last) ? Var() : order_.at(last));
+  }
+  for (const auto& tensor : VSet(live_.at(var))) {
+    SetLive(var, tensor, false);
+  }
+  order_.erase(position_.at(var));
+  position_.erase(var);
+
+  double pos = AssignPosition(var, next_var);
+  auto next_it = order_.upper_bound(pos);
+  Var next_line = (next_it != order_.end()) ? next_it->second : dummy_output_;
+  for (const auto& tensor : live_.at(next_line)) {
+    if (defs.count(tensor) == 0) {
+      SetLive(var, tensor, true);
+    }
+  }
+
+  // The definitions are moved, so the bindings in between are refreshed. The last uses of the
+  // used tensors may be moved as well.
+  double old_pos = position_.at(old_next);
+  double lo = std::min(pos, old_pos), hi = std::max(pos, old_pos);
+  for (const auto& tensor : defs) {
+    RefreshLiveRange(tensor, lo, hi);
+  }
+  for (size_t i = 0; i < uses.size(); ++i) {
+    double tensor_lo = lo, tensor_hi = hi;
+    double prev_last = prev_last_lines[i].defined() && !prev_last_lines[i].same_as(var)
+                           ? position_.at(prev_last_lines[i])
+                           : pos;
+    for (double last : {prev_last, LastUsePosition(uses[i])}) {
+      if (!std::isinf(last)) {
+        tensor_lo = std::min(tensor_lo, last);
+        tensor_hi = std::max(tensor_hi, last);
+      }
+    }
+    RefreshLiveRange(uses[i], tensor_lo, tensor_hi);
+  }
+}
+
+void LivenessAnalyzer::Rebind(const Function& func) {
+  if (incremental_) {
+    auto ell = ExplicitLetList::make(func->body);
+    CHECK_EQ(ell->vars.size(), order_.size()) << "The number of bindings is mismatched";
+    size_t i = 0;
+    for (const auto& kv : order_) {
+      CHECK(kv.second.same_as(ell->vars[i]))
+          << "Expected binding " << kv.second->name_hint() << ", but got "
+          << ell->vars[i]->name_hint();
+      exprs_[kv.second] = ell->exprs[i];
+      ++i;
+    }
+  }
+  func_ = func;
+}
+
 void LivenessAnalyzer::FormChecker::VisitExpr_(const CallNode* node) {
   const Array<Expr>& args = node->args;
   Array<Var> vargs;
@@ -156,12 +449,17 @@ void LivenessAnalyzer::ForwardAnalyzer::VisitExpr_(const FunctionNode* node) {
 }
 
 void LivenessAnalyzer::ForwardAnalyzer::VisitExpr_(const CallNode* node) {
-  if (node->op->IsInstance<OpNode>() && op::IsReshapeOp(Downcast<Op>(node->op))) {
+  if (IsViewCall(node)) {
     // Reshape ops does not create a new tensor but just a view, so treat them as a direct assign.
     auto var = node->args[0].as<VarNode>();
     CHECK(var != nullptr) << "Expected the first argument of reshape op to be a Var, but got "
                           << node->args[0]->GetTypeKey();
     this->VisitExpr_(var);
+    if (const auto* tuple_type = node->checked_type().as<TupleTypeNode>()) {
+      // The outputs of split are all views of the input.
+      auto tensor = analyzer_->GetTensorVars(GetRef<Var>(var))[0];
+      analyzer_->vtuple_.Set(let_var_, Array<Var>(tuple_type->fields.size(), tensor));
+    }
 
   } else {
     Var dummy = analyzer_->CreateTensorVar(node->checked_type());
@@ -256,7 +554,7 @@ void LivenessAnalyzer::BackwardAnalyzer::VisitExpr_(const FunctionNode* node) {
 
 void LivenessAnalyzer::BackwardAnalyzer::VisitExpr_(const CallNode* node) {
   const Array<Expr>& args = node->args;
-  if (node->op->IsInstance<OpNode>() && op::IsReshapeOp(Downcast<Op>(node->op))) {
+  if (IsViewCall(node)) {
     // Reshape ops does not create a new tensor but just a view, so treat them as a direct assign.
     auto var = args[0].as<VarNode>();
     CHECK(var != nullptr) << "Expected the first argument of reshape op to be a Var, but got "
@@ -411,6 +709,97 @@ void DumpLivenessStat(const MapVSet& live_in) {
   LOG(INFO) << ss.str();
 }
 
+// The number of cached analyzers. The analyzers are usually reused by the next few passes.
+constexpr size_t kLivenessCacheSize = 2;
+
+/*! \brief The cache of liveness analyzers, from the most recently used. */
+static std::deque<std::shared_ptr<LivenessAnalyzer>> liveness_cache;
+static std::mutex liveness_cache_mutex;
+
+/*!
+ * \brief Whether the two functions have the same dataflow for liveness analysis, i.e., the same
+ * parameters, and the same let-bindings referring to the same vars.
+ */
+bool IsSameDataflow(const Function& a, const Function& b) {
+  if (a.same_as(b)) {
+    return true;
+  }
+  if (a->params.size() != b->params.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < a->params.size(); ++i) {
+    if (!a->params[i].same_as(b->params[i])) {
+      return false;
+    }
+  }
+  auto ell_a = ExplicitLetList::make(a->body);
+  auto ell_b = ExplicitLetList::make(b->body);
+  if (ell_a->vars.size() != ell_b->vars.size() || !ell_a->ret.same_as(ell_b->ret)) {
+    return false;
+  }
+  auto same_vars = [](const Array<Expr>& x, const Array<Expr>& y) {
+    if (x.size() != y.size()) {
+      return false;
+    }
+    for (size_t i = 0; i < x.size(); ++i) {
+      if ((x[i]->IsInstance<VarNode>() || y[i]->IsInstance<VarNode>()) && !x[i].same_as(y[i])) {
+        return false;
+      }
+    }
+    return true;
+  };
+  for (size_t i = 0; i < ell_a->vars.size(); ++i) {
+    const auto& expr_a = ell_a->exprs[i];
+    const auto& expr_b = ell_b->exprs[i];
+    if (!ell_a->vars[i].same_as(ell_b->vars[i]) || expr_a->type_index() != expr_b->type_index()) {
+      return false;
+    }
+    if (auto call_a = expr_a.as<CallNode>()) {
+      auto call_b = expr_b.as<CallNode>();
+      if (!call_a->op.same_as(call_b->op) || !same_vars(call_a->args, call_b->args) ||
+          !tvm::StructuralEqual()(call_a->checked_type_, call_b->checked_type_)) {
+        return false;
+      }
+    } else if (auto tuple_a = expr_a.as<TupleNode>()) {
+      if (!same_vars(tuple_a->fields, expr_b.as<TupleNode>()->fields)) {
+        return false;
+      }
+    } else if (auto item_a = expr_a.as<TupleGetItemNode>()) {
+      auto item_b = expr_b.as<TupleGetItemNode>();
+      if (!item_a->tuple.same_as(item_b->tuple) || item_a->index != item_b->index) {
+        return false;
+      }
+    } else if (!expr_a.same_as(expr_b)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::shared_ptr<LivenessAnalyzer> GetLivenessAnalyzer(const Function& func) {
+  {
+    std::lock_guard<std::mutex> lock(liveness_cache_mutex);
+    for (auto analyzer : liveness_cache) {
+      if (IsSameDataflow(analyzer->GetFunction(), func)) {
+        analyzer->Rebind(func);
+        return analyzer;
+      }
+    }
+  }
+  auto analyzer = std::make_shared<LivenessAnalyzer>(func);
+  analyzer->Run();
+  CacheLivenessAnalyzer(analyzer);
+  return analyzer;
+}
+
+void CacheLivenessAnalyzer(std::shared_ptr<LivenessAnalyzer> analyzer) {
+  std::lock_guard<std::mutex> lock(liveness_cache_mutex);
+  liveness_cache.push_front(analyzer);
+  if (liveness_cache.size() > kLivenessCacheSize) {
+    liveness_cache.pop_back();
+  }
+}
+
 }  // namespace liveness_analysis
 
 liveness_analysis::MapVSet LivenessAnalysis(const IRModule& mod) {
@@ -421,10 +810,9 @@ liveness_analysis::MapVSet LivenessAnalysis(const IRModule& mod) {
 }
 
 // Put the live in set to an Array as std::unordered_set is not in the object system.
-PackedLiveInMap LivenessAnalysisPacked(const IRModule& mod) {
+PackedLiveInMap PackLiveIn(const liveness_analysis::MapVSet& live_in) {
   PackedLiveInMap ret;
-  auto res = LivenessAnalysis(mod);
-  for (const auto& it : res) {
+  for (const auto& it : live_in) {
     Array<Var> vars;
     for (const auto& var : it.second) {
       vars.push_back(var);
@@ -434,7 +822,27 @@ PackedLiveInMap LivenessAnalysisPacked(const IRModule& mod) {
   return ret;
 }
 
+PackedLiveInMap LivenessAnalysisPacked(const IRModule& mod) {
+  return PackLiveIn(LivenessAnalysis(mod));
+}
+
+/*!
+ * \brief Move a let-binding before the other one in the main function, and return the live in
+ * sets updated incrementally. This is mainly used to verify the incremental analysis.
+ */
+PackedLiveInMap LivenessAnalysisMoveBinding(const IRModule& mod, const Var& var,
+                                            const Var& next_var) {
+  auto entry = mod->GetGlobalVar("main");
+  auto func = Downcast<Function>(mod->Lookup(entry));
+  auto la = liveness_analysis::LivenessAnalyzer(func);
+  la.Run();
+  la.MoveBinding(var, next_var);
+  return PackLiveIn(la.GetLiveIn());
+}
+
 RAF_REGISTER_GLOBAL("raf.pass_.LivenessAnalysis").set_body_typed(LivenessAnalysisPacked);
+RAF_REGISTER_GLOBAL("raf.pass_.LivenessAnalysisMoveBinding")
+    .set_body_typed(LivenessAnalysisMoveBinding);
 
 }  // namespace pass
 }  // namespace raf
@@ -8,6 +8,8 @@
  * \brief A pass for analyzing tensor liveness.
  */
 #pragma once
+#include <map>
+#include <memory>
 #include <vector>
 #include "raf/op.h"
 #include "raf/op_utils.h"
@@ -78,6 +80,49 @@ class LivenessAnalyzer {
     return !failure_;
   }
 
+  /*! \brief Get the analyzed function. */
+  const Function& GetFunction() const {
+    return func_;
+  }
+
+  /*!
+   * \brief Whether the analysis can be updated incrementally. This requires a successful
+   * analysis of a function with only let-bindings of calls, tuples, tuple items, vars and
+   * closures, so that the live range of every tensor is an interval of bindings.
+   */
+  bool IsIncremental() const {
+    return incremental_;
+  }
+
+  /*!
+   * \brief Insert a let-binding before the given one and update the analysis locally.
+   * \param var The let var of the new binding.
+   * \param expr The expression of the new binding, whose arguments must be defined before.
+   * \param next_var The let var of the binding after the new one. Undefined means the end.
+   */
+  void InsertBinding(const Var& var, const Expr& expr, const Var& next_var = Var());
+
+  /*!
+   * \brief Remove a let-binding whose tensors are not used, and update the analysis locally.
+   * \param var The let var of the binding to be removed.
+   */
+  void RemoveBinding(const Var& var);
+
+  /*!
+   * \brief Move a let-binding before the given one and update the analysis locally. The tensor
+   * vars of the moved binding remain the same.
+   * \param var The let var of the binding to be moved.
+   * \param next_var The let var of the binding after the moved one. Undefined means the end.
+   */
+  void MoveBinding(const Var& var, const Var& next_var = Var());
+
+  /*!
+   * \brief Bind the (updated) analysis to the given function, which must have the same
+   * let-bindings in the same order, e.g., the function generated by the pass which updates
+   * the analysis incrementally.
+   */
+  void Rebind(const Function& func);
+
   /*! \brief Get live in tensors of the given line (var). */
   VSet GetLiveVars(const Var& x) {
     if (live_.count(x) == 0) {
@@ -86,6 +131,11 @@ class LivenessAnalyzer {
     return live_.at(x);
   }
 
+  /*! \brief Get the live in tensors of all lines. */
+  const MapVSet& GetLiveIn() const {
+    return live_;
+  }
+
   /*! \brief Get the dummy tensor variables of the final outputs. */
   VSet GetOutputTensorVars() {
     return GetLiveVars(dummy_output_);
@@ -350,9 +400,33 @@ class LivenessAnalyzer {
   /*! \brief Create a variable of specified type */
   Var CreateTensorVar(const Type& type);
 
+  /*! \brief Build the binding order and the def-use of tensors for incremental updates. */
+  void InitIncremental();
+
+  /*! \brief Get the tensors used by a binding, following the rules of BackwardAnalyzer. */
+  VSet GetBindingUses(const Var& var, const Expr& expr);
+
+  /*! \brief Get the tensors defined by a binding. */
+  VSet GetBindingDefs(const Var& var, const Expr& expr);
+
+  /*! \brief Assign the position of a binding before the given one. */
+  double AssignPosition(const Var& var, const Var& next_var);
+
+  /*! \brief Get the position of the defining binding of a tensor, or -inf for parameters. */
+  double DefPosition(const Var& tensor);
+
+  /*! \brief Get the position of the last binding using a tensor, or -inf if it is unused. */
+  double LastUsePosition(const Var& tensor);
+
+  /*! \brief Re-evaluate whether the tensor is live at each binding positioned in [lo, hi]. */
+  void RefreshLiveRange(const Var& tensor, double lo, double hi);
+
+  /*! \brief Set whether the tensor is live at the binding, including the inverse map. */
+  void SetLive(const Var& line, const Var& tensor, bool live);
+
  private:
   /*! \brief the function to be analyzed */
-  const Function& func_;
+  Function func_;
   /*! \brief whether func_ contains closure invoke */
   bool failure_{false};
   /*! \brief maps a var to the set of real or fake variables which share memory with the key */
@@ -372,8 +446,39 @@ class LivenessAnalyzer {
   /*! \brief the lines where a variable is live.
              Initially it's the inversion of live_: inv_live_[x] = {y | x \in live_[y]} */
   MapVSet inv_live_;
+  /*! \brief whether the analysis can be updated incrementally */
+  bool incremental_{false};
+  /*! \brief the bindings ordered by their positions */
+  std::map<double, Var> order_;
+  /*! \brief the position of each binding. The dummy output is after all bindings */
+  StdMap<double> position_;
+  /*! \brief the expression of each binding */
+  StdMap<Expr> exprs_;
+  /*! \brief the tensor vars used by each binding */
+  MapVSet binding_uses_;
+  /*! \brief the bindings (including the dummy output) using each tensor var */
+  MapVSet tensor_uses_;
+  /*! \brief the binding defining each tensor var. Parameters do not have one */
+  MapVar tensor_def_;
 };
 
+/*!
+ * \brief Get the liveness analyzer of the given function. The analysis is cached, so it is
+ * shared by the following passes (e.g., Rematerialization and MemoryPlan) as long as they work
+ * on a function with the same dataflow, such as the one after InferType. Note that the analyzer
+ * should be copied if it is going to be modified.
+ * \param func The function to be analyzed.
+ * \return The analyzer, which has been run.
+ */
+std::shared_ptr<LivenessAnalyzer> GetLivenessAnalyzer(const Function& func);
+
+/*!
+ * \brief Put an analyzer to the cache, e.g., after it is incrementally updated and rebound to
+ * the function generated by a pass.
+ * \param analyzer The analyzer to be cached.
+ */
+void CacheLivenessAnalyzer(std::shared_ptr<LivenessAnalyzer> analyzer);
+
 class LivenessAnalyzer::FormChecker : public ExprVisitor {
  public:
   FormChecker(const Expr& body, LivenessAnalyzer* analyzer) : body_(body), analyzer_(analyzer) {
@@ -0,0 +1,206 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file managed_memory_hint.cc
+ * \brief Insert the prefetch and eviction hints of the unified memory (see managed_pool) in the
+ * final order of the let-bindings. A large tensor that is not used for a while is evicted to the
+ * host after its use, and is prefetched back to the device a few bindings ahead of its next use.
+ * The parameters, e.g., the weights, are also prefetched ahead of their first uses and evicted
+ * after their last uses, so they leave the device between the steps of a training loop. The
+ * intermediate tensors are released by the VM after their last uses, so they are not evicted.
+ */
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "raf/pass.h"
+#include "raf/device.h"
+
+#include "./common.h"
+#include "../common/shape_utils.h"
+
+namespace raf {
+namespace pass {
+namespace managed_memory_hint {
+
+// The tensors smaller than 1MB are not worth the migration.
+constexpr int64_t kMinBytes = 1048576;
+
+class HintInserter {
+ public:
+  HintInserter(const Function& func, int distance)
+      : func_(func), ell_(ExplicitLetList::make(func->body)), distance_(distance) {
+    int n = ell_->vars.size();
+    for (int i = 0; i < n; ++i) {
+      var_index_[ell_->vars[i].get()] = i;
+    }
+    // A tuple or a tuple item binding only creates an alias, so the tensors it refers to are used
+    // where the alias is used.
+    for (int i = 0; i < n; ++i) {
+      const auto& expr = ell_->exprs[i];
+      std::vector<Var> roots;
+      if (expr->IsInstance<TupleNode>() || expr->IsInstance<TupleGetItemNode>() ||
+          expr->IsInstance<VarNode>()) {
+        for (const auto& var : FreeVars(expr)) {
+          const auto& var_roots = RootsOf(var);
+          roots.insert(roots.end(), var_roots.begin(), var_roots.end());
+        }
+        aliases_.insert(i);
+      } else {
+        roots.push_back(ell_->vars[i]);
+      }
+      roots_[ell_->vars[i].get()] = std::move(roots);
+    }
+    for (int i = 0; i < n; ++i) {
+      if (aliases_.count(i)) {
+        continue;
+      }
+      for (const auto& var : FreeVars(ell_->exprs[i])) {
+        for (const auto& root : RootsOf(var)) {
+          auto& uses = uses_[root.get()];
+          if (uses.empty() || uses.back() != i) {
+            uses.push_back(i);
+          }
+        }
+      }
+    }
+    for (const auto& root : RootsOf(ell_->ret)) {
+      returned_.insert(root.get());
+    }
+  }
+
+  Function Run() {
+    int n = ell_->vars.size();
+    std::vector<Var> candidates(func_->params.begin(), func_->params.end());
+    for (int i = 0; i < n; ++i) {
+      if (!aliases_.count(i)) {
+        candidates.push_back(ell_->vars[i]);
+      }
+    }
+
+    // The hints to insert before (prefetches) and after (evictions) each binding.
+    std::unordered_map<int, std::vector<Var>> prefetches, evictions;
+    for (const auto& var : candidates) {
+      auto it = uses_.find(var.get());
+      if (it == uses_.end() || !IsLargeTensor(var)) {
+        continue;
+      }
+      const auto& uses = it->second;
+      bool is_param = !var_index_.count(var.get());
+      if (is_param) {
+        prefetches[std::max(0, uses.front() - distance_)].push_back(var);
+      }
+      for (size_t k = 0; k + 1 < uses.size(); ++k) {
+        // Only evict the tensor if it can stay off the device for the prefetch distance at least.
+        if (uses[k + 1] - uses[k] > 2 * distance_) {
+          evictions[uses[k]].push_back(var);
+          prefetches[uses[k + 1] - distance_].push_back(var);
+        }
+      }
+      if (is_param && !returned_.count(var.get())) {
+        evictions[uses.back()].push_back(var);
+      }
+    }
+    if (prefetches.empty() && evictions.empty()) {
+      return func_;
+    }
+
+    static const Op& prefetch_op = Op::Get("raf.op.memory_prefetch");
+    static const Op& evict_op = Op::Get("raf.op.memory_evict");
+    std::unique_ptr<ExplicitLetList> ell = std::make_unique<ExplicitLetList>();
+    auto push_hints = [&ell](const std::vector<Var>& vars, const Op& op, const std::string& tag) {
+      for (const auto& var : vars) {
+        // The hint returns the tensor itself, so its output shares the memory of the tensor.
+        Var root = var;
+        while (auto ext = root.as<ExtendedVarNode>()) {
+          if (!ext->may_share.defined()) {
+            break;
+          }
+          root = ext->may_share;
+        }
+        ell->Push(MakeVar(var->name_hint() + tag, {}, root), Call(op, {var}));
+      }
+    };
+    for (int i = 0; i < n; ++i) {
+      push_hints(prefetches[i], prefetch_op, "_prefetch");
+      ell->Push(ell_->vars[i], ell_->exprs[i]);
+      push_hints(evictions[i], evict_op, "_evict");
+    }
+    ell->ret = ell_->ret;
+    return Function(func_->params, ell->AsExpr(), func_->ret_type, func_->type_params,
+                    func_->attrs);
+  }
+
+ private:
+  /*! \brief Get the tensors that the given var refers to. */
+  const std::vector<Var>& RootsOf(const Var& var) {
+    auto it = roots_.find(var.get());
+    if (it == roots_.end()) {
+      // A parameter refers to itself.
+      it = roots_.emplace(var.get(), std::vector<Var>{var}).first;
+    }
+    return it->second;
+  }
+
+  /*! \brief Whether the var is a static tensor of kMinBytes at least. */
+  bool IsLargeTensor(const Var& var) {
+    const auto* type = var->checked_type_.as<TensorTypeNode>();
+    if (type == nullptr) {
+      return false;
+    }
+    for (const auto& dim : type->shape) {
+      if (!dim->IsInstance<IntImmNode>()) {
+        return false;
+      }
+    }
+    return common::shape_utils::BytesCompactType(var->checked_type()) >= kMinBytes;
+  }
+
+  /*! \brief The target function. */
+  Function func_;
+  /*! \brief The explicit let list of the target function. */
+  std::unique_ptr<ExplicitLetList> ell_;
+  /*! \brief The number of bindings to prefetch a tensor ahead of its use. */
+  int distance_;
+  /*! \brief Mapping from a let var to its binding index. */
+  std::unordered_map<const VarNode*, int> var_index_;
+  /*! \brief Mapping from a var to the tensors it refers to. */
+  std::unordered_map<const VarNode*, std::vector<Var>> roots_;
+  /*! \brief The indices of the alias bindings. */
+  std::unordered_set<int> aliases_;
+  /*! \brief The sorted indices of the (non-alias) bindings using each tensor. */
+  std::unordered_map<const VarNode*, std::vector<int>> uses_;
+  /*! \brief The tensors returned by the function. */
+  std::unordered_set<const VarNode*> returned_;
+};
+
+}  // namespace managed_memory_hint
+
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.managed_memory.prefetch_distance", Integer);
+
+Pass ManagedMemoryHint() {
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
+                                                                             PassContext pc) {
+    int distance = pc->GetConfig("raf.managed_memory.prefetch_distance", Integer(0)).value()->value;
+    // The hints are disabled without the prefetch distance. Only the functions in ANF with at
+    // least one binding are supported.
+    if (distance <= 0 || !f->body->IsInstance<LetNode>()) {
+      return f;
+    }
+    if (Device::Current().device_type() != DevType::kCUDA()) {
+      LOG(WARNING) << "The unified memory hints require a CUDA device. Skip the hints.";
+      return f;
+    }
+    return managed_memory_hint::HintInserter(f, distance).Run();
+  };
+  auto managed_memory_hint = CreateRAFFunctionPass(pass_func, 0, "ManagedMemoryHintFunc", {});
+  return RAFSequential({InferType(), managed_memory_hint, EraseType()}, "ManagedMemoryHint");
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.ManagedMemoryHint").set_body_typed(ManagedMemoryHint);
+
+}  // namespace pass
+}  // namespace raf
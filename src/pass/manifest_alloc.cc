@@ -8,6 +8,8 @@
  * \brief Manifest memory allocation in the IR.
  */
 #include <algorithm>
+#include <memory>
+#include <unordered_set>
 #include <vector>
 
 #include "raf/device.h"
@@ -20,6 +22,7 @@
 #include "./common.h"
 #include "./let_list.h"
 #include "../common/shape_utils.h"
+#include "../op/schema/nn.h"
 #include "tvm/relay/attrs/memory.h"
 
 namespace raf {
@@ -69,9 +72,167 @@ class InplaceVisitor : public MixedModeVisitor {
   std::unordered_map<Var, std::vector<Var>, ObjectPtrHash, ObjectPtrEqual> var_share_map;
 };
 
+/*! \brief The output of concatenate or stack, whose inputs are written to its slices in place. */
+struct ConcatPlan {
+  /*! \brief The type of the output. */
+  TensorType type;
+  /*! \brief The offsets in bytes of the inputs in the output. */
+  std::vector<int64_t> offsets;
+};
+
+/*!
+ * \brief Find concatenate and stack whose inputs are contiguous chunks of the output, e.g., along
+ * the outermost axis, and are produced by ops in the function. The output can then be allocated
+ * before the producers, which write to the views of their slices, so the concat copies nothing.
+ * As the views, the offsets must be multiples of 64 bytes.
+ */
+class ConcatPlanner : public MixedModeVisitor {
+ public:
+  explicit ConcatPlanner(const InplaceVisitor& inplace) {
+    for (const auto& kv : inplace.var_share_map) {
+      shared_.insert(kv.first);
+      for (const auto& var : kv.second) {
+        if (var.defined()) {
+          shared_.insert(var);
+        }
+      }
+    }
+  }
+
+  void VisitExpr_(const LetNode* node) override {
+    auto pre_visit = [this](const LetNode* node) {
+      exprs_.emplace(node->var, node->value);
+      if (auto call = node->value.as<CallNode>()) {
+        Plan(node->var, call);
+      }
+    };
+    auto post_visit = [this](const LetNode* node) {
+      VisitExpr(node->value);
+      VisitExpr(node->body);
+    };
+    ExpandANormalForm(node, pre_visit, post_visit);
+  }
+
+  /*! \brief The plans of the concat outputs. */
+  std::unordered_map<Var, ConcatPlan, ObjectPtrHash, ObjectPtrEqual> plans;
+  /*! \brief Mapping from a producer to its concat output and its index in the inputs. */
+  std::unordered_map<Var, std::pair<Var, int>, ObjectPtrHash, ObjectPtrEqual> producers;
+
+ private:
+  static bool GetStaticShape(const Type& type, std::vector<int64_t>* shape) {
+    const auto* tensor_type = type.as<TensorTypeNode>();
+    if (tensor_type == nullptr) {
+      return false;
+    }
+    for (const auto& dim : tensor_type->shape) {
+      const auto* imm = dim.as<IntImmNode>();
+      if (imm == nullptr) {
+        return false;
+      }
+      shape->push_back(imm->value);
+    }
+    return true;
+  }
+
+  /*! \brief Whether the var is the output of an op that allocates a new tensor for it. */
+  bool IsProducer(const Var& var, const DataType& dtype) {
+    static auto upper_bound_map = Op::GetAttrMap<Op>("TRAFUpperBoundOp");
+    auto it = exprs_.find(var);
+    if (it == exprs_.end() || shared_.count(var) || producers.count(var)) {
+      return false;
+    }
+    const auto* call = it->second.as<CallNode>();
+    const auto* type = var->checked_type().as<TensorTypeNode>();
+    if (call == nullptr || type == nullptr || type->dtype != dtype) {
+      return false;
+    }
+    if (const auto* op = call->op.as<OpNode>()) {
+      Op op_ref = GetRef<Op>(op);
+      return !upper_bound_map.count(op_ref) && !op::IsReshapeOp(op_ref) &&
+             GetViewOffsets(call).empty() && op_ref->name.compare(0, 10, "raf.op.vm.") != 0;
+    }
+    const auto* func = call->op.as<FunctionNode>();
+    return func && func->HasNonzeroAttr(attr::kPrimitive);
+  }
+
+  void Plan(const Var& var, const CallNode* call) {
+    static const Op& concatenate_op = Op::Get("raf.op.concatenate");
+    static const Op& stack_op = Op::Get("raf.op.stack");
+    static auto fschema = Op::GetAttrMap<op::FRAFSchema>("FRAFSchema");
+    const auto* op_node = call->op.as<OpNode>();
+    if (op_node == nullptr || call->args.empty() || shared_.count(var)) {
+      return;
+    }
+    Op op = op::IsDialectOp(GetRef<Op>(op_node)) ? op::GetBaseOp(GetRef<Op>(op_node))
+                                                 : GetRef<Op>(op_node);
+    std::vector<int64_t> shape;
+    if ((op != concatenate_op && op != stack_op) || !GetStaticShape(var->checked_type(), &shape)) {
+      return;
+    }
+    Expr tuple = call->args[0];
+    if (auto tuple_var = tuple.as<VarNode>()) {
+      auto it = exprs_.find(GetRef<Var>(tuple_var));
+      tuple = it != exprs_.end() ? it->second : tuple;
+    }
+    const auto* tuple_node = tuple.as<TupleNode>();
+    if (tuple_node == nullptr || tuple_node->fields.size() < 2U) {
+      return;
+    }
+    Array<Value> arg_values;
+    for (const auto& arg : call->args) {
+      arg_values.push_back(GetValue(arg));
+    }
+    auto args = fschema[op](arg_values);
+    int axis = op == concatenate_op ? args.as<op::schema::ConcatenateArgs>()->axis
+                                    : args.as<op::schema::StackArgs>()->axis;
+    // The axis of stack is the new axis of the output.
+    int ndim = shape.size();
+    axis = axis < 0 ? axis + ndim : axis;
+    for (int i = 0; i < axis; ++i) {
+      if (shape[i] != 1) {
+        return;
+      }
+    }
+    const DataType& dtype = var->checked_type().as<TensorTypeNode>()->dtype;
+    int64_t elem_bytes = (dtype.bits() * dtype.lanes() + 7) / 8;
+    std::vector<int64_t> offsets;
+    std::unordered_set<Var, ObjectPtrHash, ObjectPtrEqual> inputs;
+    int64_t offset = 0;
+    for (const auto& field : tuple_node->fields) {
+      const auto* field_var = field.as<VarNode>();
+      std::vector<int64_t> field_shape;
+      if (field_var == nullptr || !inputs.insert(GetRef<Var>(field_var)).second ||
+          !IsProducer(GetRef<Var>(field_var), dtype) ||
+          !GetStaticShape(field_var->checked_type(), &field_shape) || offset % 64 != 0) {
+        return;
+      }
+      offsets.push_back(offset);
+      int64_t numel = 1;
+      for (int64_t dim : field_shape) {
+        numel *= dim;
+      }
+      offset += numel * elem_bytes;
+    }
+    for (size_t i = 0; i < tuple_node->fields.size(); ++i) {
+      producers.emplace(Downcast<Var>(tuple_node->fields[i]), std::make_pair(var, i));
+    }
+    plans.emplace(var, ConcatPlan{Downcast<TensorType>(var->checked_type()), offsets});
+  }
+
+  /*! \brief The values of the let-bound vars. */
+  std::unordered_map<Var, Expr, ObjectPtrHash, ObjectPtrEqual> exprs_;
+  /*! \brief The vars that share the memory with others by the inplace update. */
+  std::unordered_set<Var, ObjectPtrHash, ObjectPtrEqual> shared_;
+};
+
 class ManifestAllocMutator : public ExprMutator {
  public:
-  ManifestAllocMutator() {
+  /*!
+   * \param devices The devices of the exprs found by ContextAnalysis. When it is defined, the
+   * outputs are allocated on the devices of their ops, e.g., on the GPUs that the subgraphs are
+   * copied to by device_copy. Otherwise, they are allocated on the current device.
+   */
+  explicit ManifestAllocMutator(Map<Expr, Device> devices = {}) : devices_(devices) {
     scopes_.emplace_back(new LetList);
   }
 
@@ -151,7 +312,32 @@ class ManifestAllocMutator : public ExprMutator {
       auto ret_type = call->checked_type();
       auto out_types = tvm::relay::FlattenTupleType(ret_type);
       Array<Expr> new_args;
-      if (op::IsReshapeOp(GetRef<Op>(op))) {
+      std::vector<int64_t> view_offsets;
+      if (op && !use_upper_bound && !inplace_.var_share_map.count(bind_var)) {
+        view_offsets = GetViewOffsets(call.operator->());
+      }
+      auto plan_it = concat_->plans.find(bind_var);
+      if (plan_it != concat_->plans.end() &&
+          concat_views_[bind_var] == plan_it->second.offsets.size()) {
+        // all the inputs are written to the slices of the output, so concat is a no-op
+        return concat_buffers_.at(bind_var);
+      } else if (!view_offsets.empty()) {
+        // generate vm.set_shape with the offsets for split and strided_slice, whose outputs are
+        // contiguous chunks of the input, so they are views of the input instead of copies
+        auto data = VisitExpr(call->args[0]);
+        CHECK_EQ(out_types.size(), view_offsets.size());
+        std::vector<Expr> outs;
+        for (size_t i = 0; i < out_types.size(); ++i) {
+          auto shape = MakeConstant(op::ArrayToIntTuple(out_types[i]->shape));
+          auto offset = MakeConstant(ScalarValue::make(view_offsets[i]));
+          Call view = Call(vm_set_shape_op, {data, shape, offset});
+          if (!ret_type.as<TupleTypeNode>()) {
+            return view;
+          }
+          outs.push_back(scope->Push(view));
+        }
+        return tvm::relay::ToTupleType(ret_type, outs);
+      } else if (op::IsReshapeOp(GetRef<Op>(op))) {
         // generate vm.set_shape for reshape ops to avoid unnecessary kernels and allocations
         CHECK_EQ(out_types.size(), 1U);
         // first push the input tensor
@@ -182,9 +368,20 @@ class ManifestAllocMutator : public ExprMutator {
 
         // Determine the device for output tensor allocation.
         auto device = GetOutputDevice(call);
+        if (devices_.count(call) && devices_[call].device_type() == device.device_type()) {
+          device = devices_[call];
+        }
 
         std::vector<Expr> outs;
-        if (tvm::relay::IsDynamic(ret_type)) {
+        auto producer_it = concat_->producers.find(bind_var);
+        if (producer_it != concat_->producers.end() && !use_upper_bound &&
+            !tvm::relay::IsDynamic(ret_type) && out_types.size() == 1U &&
+            !inplace_.var_share_map.count(bind_var)) {
+          // write the output to its slice of the concat output
+          const auto& concat = producer_it->second;
+          outs.push_back(MakeConcatSlice(scope, concat.first, concat.second, out_types[0], device));
+          EmitInvoke(scope, call->op, new_args, outs);
+        } else if (tvm::relay::IsDynamic(ret_type)) {
           outs = DynamicInvoke(scope, bind_var, call->op, new_args, out_types, device);
         } else {
           outs = StaticInvoke(scope, bind_var, call->op, new_args, out_types, device);
@@ -211,6 +408,11 @@ class ManifestAllocMutator : public ExprMutator {
 
   Expr operator()(const Expr& expr) {
     inplace_.VisitExpr(expr);
+    concat_ = std::make_unique<ConcatPlanner>(inplace_);
+    if (devices_.empty()) {
+      // The producers of a concat may be on different devices with multiple devices.
+      concat_->VisitExpr(expr);
+    }
     return Mutate(expr);
   }
 
@@ -336,11 +538,35 @@ class ManifestAllocMutator : public ExprMutator {
         outs.push_back(MakeStaticAllocation(scope, out_types[i].as<TensorTypeNode>(), device));
       }
     }
+    EmitInvoke(scope, op, new_args, outs);
+    return outs;
+  }
+
+  void EmitInvoke(LetList* scope, const Expr& op, const Array<Expr>& new_args,
+                  const std::vector<Expr>& outs) {
     auto invoke = Call(Op::Get("raf.op.vm.invoke_op"),
                        Array<Expr>{scope->Push(op), scope->Push(Tuple(new_args)),
                                    scope->Push(Tuple(Array<Expr>(outs)))});
     scope->Push(invoke);
-    return outs;
+  }
+
+  /*!
+   * \brief Make the view of the slice of a concat output for its index-th input. The concat output
+   * is allocated at the first of its inputs.
+   */
+  Expr MakeConcatSlice(LetList* scope, const Var& concat, int index, const TensorType& type,
+                       const Device& device) {
+    static auto vm_set_shape_op = Op::Get("raf.op.vm.set_shape");
+    const auto& plan = concat_->plans.at(concat);
+    auto it = concat_buffers_.find(concat);
+    if (it == concat_buffers_.end()) {
+      auto buffer = MakeStaticAllocation(scope, plan.type.as<TensorTypeNode>(), device);
+      it = concat_buffers_.emplace(concat, buffer).first;
+    }
+    ++concat_views_[concat];
+    auto shape = MakeConstant(op::ArrayToIntTuple(type->shape));
+    auto offset = MakeConstant(ScalarValue::make(plan.offsets[index]));
+    return scope->Push(Call(vm_set_shape_op, {it->second, shape, offset}));
   }
 
   /*! \brief The scope stack of the let list. */
@@ -349,14 +575,31 @@ class ManifestAllocMutator : public ExprMutator {
   std::unordered_map<Expr, Var, ObjectPtrHash, ObjectPtrEqual> let_binding_;
   /*! \breif Inplace visitor to check the may_share information. */
   InplaceVisitor inplace_;
+  /*! \brief The devices of the exprs, which are empty when the ops use the current device. */
+  Map<Expr, Device> devices_;
+  /*! \brief The concat outputs whose inputs are written to their slices. */
+  std::unique_ptr<ConcatPlanner> concat_;
+  /*! \brief Mapping from a concat output to its buffer, allocated at its first input. */
+  std::unordered_map<Var, Expr, ObjectPtrHash, ObjectPtrEqual> concat_buffers_;
+  /*! \brief Mapping from a concat output to the number of its inputs written to its slices. */
+  std::unordered_map<Var, size_t, ObjectPtrHash, ObjectPtrEqual> concat_views_;
 };
 
 }  // namespace manifest_alloc
 
 Pass ManifestAlloc() {
+  // The context analysis covers the whole module, so it is done once for all functions.
+  auto cache = std::make_shared<std::pair<IRModule, Map<Expr, Device>>>();
   TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
                                                                              PassContext pc) {
-    return Downcast<ir::Function>(manifest_alloc::ManifestAllocMutator()(f));
+    Map<Expr, Device> devices;
+    if (pc->GetConfig("raf.vm.multi_device", Bool(false)).value()) {
+      if (!cache->first.same_as(m)) {
+        *cache = {m, ContextAnalysis(m, Device::Current())};
+      }
+      devices = cache->second;
+    }
+    return Downcast<ir::Function>(manifest_alloc::ManifestAllocMutator(devices)(f));
   };
   return CreateRAFFunctionPass(pass_func, 0, "ManifestAlloc", {});
 }
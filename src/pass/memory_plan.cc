@@ -16,6 +16,7 @@
 #include "raf/ir_ext.h"
 #include "raf/value.h"
 #include "raf/pass.h"
+#include "./common.h"
 #include "./let_list.h"
 #include "./liveness_analysis.h"
 #include "tvm/relay/attrs/memory.h"
@@ -32,6 +33,218 @@ template <typename T>
 using StdMap = std::unordered_map<Var, T, ObjectPtrHash, ObjectPtrEqual>;
 using VSet = std::unordered_set<Var, ObjectPtrHash, ObjectPtrEqual>;
 
+/*! \brief The vector clock of a stream, mapping each stream to the number of its bindings done. */
+using Clock = std::unordered_map<int64_t, int>;
+
+/*!
+ * \brief The happens-before order of the let bindings in the top-level scope of a function, which
+ * may be scheduled on multiple streams by set_stream, add_event, wait_event and stream_barrier.
+ * Each stream keeps a vector clock of the bindings known to be done when the stream reaches a
+ * binding, which is advanced by the events it waits for and the stream barriers. The ANF order is
+ * the execution order only when the function runs on a single stream.
+ */
+class StreamOrder {
+ public:
+  explicit StreamOrder(const Expr& body) {
+    static const Op& alloc_storage_op = Op::Get("raf.op.vm.alloc_storage");
+    static const Op& alloc_tensor_op = Op::Get("raf.op.vm.alloc_tensor");
+    static const Op& set_shape_op = Op::Get("raf.op.vm.set_shape");
+    static const Op& free_op = Op::Get("raf.op.vm.free");
+    static const Op& set_stream_op = Op::Get("raf.op.set_stream");
+    static const Op& add_event_op = Op::Get("raf.op.add_event");
+    static const Op& wait_event_op = Op::Get("raf.op.wait_event");
+    static const Op& barrier_op = Op::Get("raf.op.stream_barrier");
+
+    std::unordered_map<int64_t, Clock> clocks, events;
+    std::unordered_map<int64_t, int> stream_seq;
+    // The clock of all the streams after the last barrier, which a new stream starts with.
+    Clock barrier_clock;
+    StdMap<VSet> aliases;
+    int64_t curr_stream = 0;
+    auto get_clock = [&](int64_t stream, int index) -> Clock& {
+      if (!clocks.count(stream)) {
+        clocks[stream] = barrier_clock;
+        history_[stream].emplace_back(index, barrier_clock);
+      }
+      return clocks[stream];
+    };
+
+    Expr expr = body;
+    for (int i = 0; expr.as<LetNode>(); ++i) {
+      const auto* let = expr.as<LetNode>();
+      index_[let->var] = i;
+      values_[let->var] = let->value;
+      expr = let->body;
+
+      const auto* call = let->value.as<CallNode>();
+      const auto* op_node = call ? call->op.as<OpNode>() : nullptr;
+      Op op = op_node ? GetRef<Op>(op_node) : Op();
+      if (op == set_stream_op) {
+        curr_stream = GetConstInt(call->args[1]);
+      }
+      streams_.push_back(curr_stream);
+      seqs_.push_back(++stream_seq[curr_stream]);
+      Clock& clock = get_clock(curr_stream, i);
+      clock[curr_stream] = seqs_.back();
+
+      if (op == add_event_op || op == wait_event_op) {
+        int64_t event_id = GetConstInt(call->args[0]);
+        int64_t stream = call->args.size() > 1 ? GetConstInt(call->args[1]) : -1;
+        stream = stream == -1 ? curr_stream : stream;
+        Clock& event_clock = get_clock(stream, i);
+        if (op == add_event_op) {
+          events[event_id] = event_clock;
+        } else if (events.count(event_id)) {
+          MergeClock(events[event_id], &event_clock);
+          history_[stream].emplace_back(i, event_clock);
+        }
+      } else if (op == barrier_op) {
+        for (const auto& kv : clocks) {
+          MergeClock(kv.second, &barrier_clock);
+        }
+        for (auto& kv : clocks) {
+          kv.second = barrier_clock;
+          history_[kv.first].emplace_back(i, barrier_clock);
+        }
+      } else if (op == alloc_storage_op) {
+        alloc_index_[let->var] = i;
+      } else if (op == alloc_tensor_op) {
+        if (const auto* storage = call->args[0].as<VarNode>()) {
+          aliases[let->var].insert(GetRef<Var>(storage));
+        }
+      } else if (op != free_op) {
+        // Propagate the storages through tuples and views, and record the uses by the kernels.
+        VSet used;
+        for (const auto& var : FreeVars(let->value)) {
+          auto it = aliases.find(var);
+          if (it != aliases.end()) {
+            used.insert(it->second.begin(), it->second.end());
+          }
+        }
+        bool is_kernel = call && op != set_shape_op;
+        for (const auto& storage : used) {
+          if (is_kernel) {
+            uses_[storage].push_back(i);
+          }
+        }
+        if (!used.empty()) {
+          aliases[let->var] = std::move(used);
+        }
+      }
+    }
+    multi_stream_ = stream_seq.size() > 1;
+  }
+
+  /*! \brief Whether the bindings run on more than one stream. */
+  bool IsMultiStream() const {
+    return multi_stream_;
+  }
+
+  /*! \brief Get the index of a top-level binding, or -1 if it is not in the top-level scope. */
+  int GetIndex(const Var& var) const {
+    auto it = index_.find(var);
+    return it == index_.end() ? -1 : it->second;
+  }
+
+  /*! \brief Get the indices of the bindings that launch kernels on the given storage. */
+  const std::vector<int>& GetUses(const Var& storage) const {
+    static const std::vector<int> empty;
+    auto it = uses_.find(storage);
+    return it == uses_.end() ? empty : it->second;
+  }
+
+  /*! \brief Whether the binding i is known to be done when the stream reaches the binding j. */
+  bool HappensBefore(int i, int64_t stream, int j) const {
+    if (i >= j) {
+      return false;
+    }
+    if (streams_[i] == stream) {
+      return true;
+    }
+    auto hist = history_.find(stream);
+    if (hist == history_.end()) {
+      return false;
+    }
+    // The clock of the stream after the last change before the binding j.
+    const Clock* clock = nullptr;
+    for (const auto& entry : hist->second) {
+      if (entry.first >= j) {
+        break;
+      }
+      clock = &entry.second;
+    }
+    if (clock == nullptr) {
+      return false;
+    }
+    auto it = clock->find(streams_[i]);
+    return it != clock->end() && it->second >= seqs_[i];
+  }
+
+  /*! \brief Whether the binding i is known to be done when the binding j starts. */
+  bool HappensBefore(int i, int j) const {
+    return HappensBefore(i, streams_[j], j);
+  }
+
+  /*!
+   * \brief Whether the storage can be released before the binding pos. A released storage is
+   * considered free on the stream it was allocated on, so that the memory pool may hand it to the
+   * following allocations of the stream without synchronization. Thus all kernels using the
+   * storage on other streams have to be done when the allocating stream reaches pos.
+   */
+  bool CanRelease(const Var& storage, int pos) const {
+    auto it = alloc_index_.find(storage);
+    if (it == alloc_index_.end()) {
+      return true;
+    }
+    int64_t stream = streams_[it->second];
+    for (int use : GetUses(storage)) {
+      if (!HappensBefore(use, stream, pos)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+ private:
+  static void MergeClock(const Clock& src, Clock* dst) {
+    for (const auto& kv : src) {
+      int& seq = (*dst)[kv.first];
+      seq = std::max(seq, kv.second);
+    }
+  }
+
+  /*! \brief Get the value of a constant int argument, which may be bound to a var. */
+  int64_t GetConstInt(const Expr& arg) const {
+    Expr expr = arg;
+    if (const auto* var = arg.as<VarNode>()) {
+      auto it = values_.find(GetRef<Var>(var));
+      CHECK(it != values_.end()) << "Unknown argument " << var->name_hint();
+      expr = it->second;
+    }
+    const auto* constant = expr.as<ConstantNode>();
+    CHECK(constant && constant->value->IsInstance<IntValueObj>())
+        << "Expected a constant int argument of the stream ops";
+    return constant->value.as<IntValueObj>()->value;
+  }
+
+  /*! \brief Whether the bindings run on more than one stream. */
+  bool multi_stream_ = false;
+  /*! \brief The stream of each binding. */
+  std::vector<int64_t> streams_;
+  /*! \brief The sequence number of each binding in its stream, starting from 1. */
+  std::vector<int> seqs_;
+  /*! \brief The changes of the clock of each stream by waits and barriers, with the indices. */
+  std::unordered_map<int64_t, std::vector<std::pair<int, Clock>>> history_;
+  /*! \brief The index of each top-level binding. */
+  StdMap<int> index_;
+  /*! \brief The value of each top-level binding. */
+  StdMap<Expr> values_;
+  /*! \brief The index of the alloc_storage binding of each storage. */
+  StdMap<int> alloc_index_;
+  /*! \brief The bindings that launch kernels on each storage. */
+  StdMap<std::vector<int>> uses_;
+};
+
 /*! \brief A tensor group. The intermediate tensors which liveness dummy tensors in a group
  * can be allocated to the same memory buffer.
  */
@@ -199,12 +412,14 @@ class TensorGroups {
  * 3. Mutate alloc_storage to allocate sufficient memory, which is required by
  *    the largest tensor in the group.
  * 4. Remove alloc_storages that do not be used by any group.
- * 5. Insert free(%x) to free tensor/storage %x at the end of its life-cycle.
+ * 5. Insert free(%x) to free tensor/storage %x at the end of its life-cycle. When the function
+ *    runs on multiple streams, the free is postponed until the kernels using %x on other streams
+ *    are known to be done by the stream allocating %x.
  */
 class MemoryPlanner : public ExprMutator {
  public:
   MemoryPlanner(const Function& func, liveness_analysis::LivenessAnalyzer* analyzer)
-      : func_(func), analyzer_(analyzer), tensor_groups_(Group()) {
+      : func_(func), analyzer_(analyzer), tensor_groups_(Group()), stream_order_(func->body) {
     scopes_.emplace_back(new LetList);
   }
 
@@ -230,6 +445,10 @@ class MemoryPlanner : public ExprMutator {
     Expr body;
     do {
       curr_let_ = node->var;
+      int pos = stream_order_.IsMultiStream() ? stream_order_.GetIndex(curr_let_) : -1;
+      if (pos != -1) {
+        ReleasePendingStorages(pos, scope);
+      }
 
       // Free allocated tensors that will not be used anymore.
       auto live_in_vars = analyzer_->GetLiveVars(curr_let_);
@@ -249,7 +468,13 @@ class MemoryPlanner : public ExprMutator {
             // Free allocated storages that will not be used anymore.
             auto group = tensor_groups_.groups[group_id];
             if (group.members.size() == 0) {
-              scope->Push(MakeFreeMemory(group.storage));
+              if (pos == -1 || stream_order_.CanRelease(group.storage, pos)) {
+                scope->Push(MakeFreeMemory(group.storage));
+              } else {
+                // The storage is still used by kernels on other streams, which the stream
+                // allocating it has not waited for yet.
+                pending_storages_.push_back(group.storage);
+              }
             }
           }
           it = live_tensors_.erase(it);
@@ -351,6 +576,19 @@ class MemoryPlanner : public ExprMutator {
     return Call(op, {memory_var});
   }
 
+  /*! \brief Free the pending storages that can be released before the binding pos. */
+  void ReleasePendingStorages(int pos, LetList* scope) {
+    auto it = pending_storages_.begin();
+    while (it != pending_storages_.end()) {
+      if (stream_order_.CanRelease(*it, pos)) {
+        scope->Push(MakeFreeMemory(*it));
+        it = pending_storages_.erase(it);
+      } else {
+        it++;
+      }
+    }
+  }
+
  private:
   /*! \brief The scope stack of the let list. */
   std::vector<std::unique_ptr<LetList>> scopes_;
@@ -368,6 +606,12 @@ class MemoryPlanner : public ExprMutator {
   VSet used_storages_;
   /*! \brief Current live tensor vars. */
   VSet live_tensors_;
+  /*! \brief The happens-before order of the bindings on multiple streams. */
+  StreamOrder stream_order_;
+  /*! \brief The storages whose lives have ended but cannot be released yet. Storages that are
+   * never released here are held until the function returns.
+   */
+  std::vector<Var> pending_storages_;
 };
 
 /*! \brief A visitor to group tensors generated by alloc_tensor according to
@@ -475,13 +719,256 @@ TensorGroups MemoryPlanner::Group() {
   return TensorGrouper(func_, analyzer_).Run();
 }
 
+/*! \brief A storage that can be placed into the static arena. */
+struct ArenaStorage {
+  /*! \brief The binded variable of the storage. */
+  Var var;
+  /*! \brief The size of the storage in bytes. */
+  int64_t size;
+  /*! \brief The alignment of the storage. */
+  int64_t alignment;
+  /*! \brief The index of the let binding that allocates the storage. */
+  int start;
+  /*! \brief The index of the let binding that frees the storage. */
+  int end;
+  /*! \brief The offset of the storage in the arena. */
+  int64_t offset = 0;
+};
+
+/*! \brief A mutator that places the planned storages of a function into a single arena. A storage
+ * can be placed if:
+ * 1) its size is static,
+ * 2) it is allocated and freed in the top-level scope of the function, and
+ * 3) it is only used by non-output alloc_tensor, so that the arena does not escape.
+ * The offset of each storage is determined by greedily placing the largest storage at the
+ * lowest offset that does not overlap with the storages live at the same time, or not ordered by
+ * the events when the function runs on multiple streams. Then the storages are replaced by
+ * offsets into the arena, which is allocated by one alloc_storage at the beginning of the
+ * function.
+ */
+class ArenaPlanner {
+ public:
+  explicit ArenaPlanner(const Function& func) : func_(func), stream_order_(func->body) {
+    Expr body = func->body;
+    while (const auto* let = body.as<LetNode>()) {
+      vars_.push_back(let->var);
+      exprs_.push_back(let->value);
+      body = let->body;
+    }
+    ret_ = body;
+  }
+
+  Function Run() {
+    static const Op& alloc_storage_op = Op::Get("raf.op.vm.alloc_storage");
+    static const Op& alloc_tensor_op = Op::Get("raf.op.vm.alloc_tensor");
+    static const Op& free_op = Op::Get("raf.op.vm.free");
+
+    // Collect the candidate storages and their life-cycles.
+    StdMap<ArenaStorage> storages;
+    VSet invalid;
+    for (int i = 0; i < static_cast<int>(vars_.size()); ++i) {
+      const auto* call = exprs_[i].as<CallNode>();
+      const auto* op_node = call ? call->op.as<OpNode>() : nullptr;
+      if (op_node && GetRef<Op>(op_node) == alloc_storage_op) {
+        const auto* size = call->args[0].as<ConstantNode>();
+        const auto* device_type = call->args[2].as<ConstantNode>();
+        const auto* device_id = call->args[3].as<ConstantNode>();
+        if (size == nullptr || device_type == nullptr || device_id == nullptr) {
+          continue;
+        }
+        int64_t alignment = call->args[1].as<ConstantNode>()->value.as<IntValueObj>()->value;
+        if (!device_type_.defined()) {
+          device_type_ = call->args[2];
+          device_id_ = call->args[3];
+          dtype_ = call->args[4];
+        } else if (device_type->value.as<IntValueObj>()->value !=
+                       device_type_.as<ConstantNode>()->value.as<IntValueObj>()->value ||
+                   device_id->value.as<IntValueObj>()->value !=
+                       device_id_.as<ConstantNode>()->value.as<IntValueObj>()->value) {
+          // Only the storages on the same device as the first one are placed.
+          continue;
+        }
+        storages[vars_[i]] = {vars_[i], size->value.as<IntValueObj>()->value, alignment, i, -1};
+      } else if (op_node && GetRef<Op>(op_node) == free_op) {
+        const auto* var = call->args[0].as<VarNode>();
+        if (var && storages.count(GetRef<Var>(var))) {
+          storages[GetRef<Var>(var)].end = i;
+        }
+      } else if (op_node && GetRef<Op>(op_node) == alloc_tensor_op) {
+        auto var = Downcast<Var>(call->args[0]);
+        if (storages.count(var)) {
+          const auto* own = call->args.size() > 4 ? call->args[4].as<ConstantNode>() : nullptr;
+          if (own == nullptr || own->value.as<BoolValueObj>()->value) {
+            invalid.insert(var);
+          }
+        }
+        for (size_t j = 1; j < call->args.size(); ++j) {
+          MarkInvalid(call->args[j], storages, &invalid);
+        }
+      } else {
+        MarkInvalid(exprs_[i], storages, &invalid);
+      }
+    }
+    MarkInvalid(ret_, storages, &invalid);
+
+    std::vector<ArenaStorage*> placed;
+    for (auto& kv : storages) {
+      if (kv.second.end != -1 && invalid.count(kv.first) == 0) {
+        placed.push_back(&kv.second);
+      }
+    }
+    if (placed.size() < 2) {
+      return func_;
+    }
+
+    // Greedily place the largest storage first.
+    std::sort(placed.begin(), placed.end(), [](const ArenaStorage* lhs, const ArenaStorage* rhs) {
+      return lhs->size != rhs->size ? lhs->size > rhs->size : lhs->start < rhs->start;
+    });
+    int64_t arena_size = 0;
+    int64_t arena_alignment = 0;
+    for (size_t i = 0; i < placed.size(); ++i) {
+      auto* curr = placed[i];
+      // The placed storages that are live at the same time, ordered by offsets.
+      std::vector<ArenaStorage*> overlaps;
+      for (size_t j = 0; j < i; ++j) {
+        if (IsConflict(placed[j], curr)) {
+          overlaps.push_back(placed[j]);
+        }
+      }
+      std::sort(overlaps.begin(), overlaps.end(),
+                [](const ArenaStorage* lhs, const ArenaStorage* rhs) {
+                  return lhs->offset < rhs->offset;
+                });
+      int64_t offset = 0;
+      for (auto* other : overlaps) {
+        offset = AlignUp(offset, curr->alignment);
+        if (offset + curr->size <= other->offset) {
+          break;
+        }
+        offset = std::max(offset, other->offset + other->size);
+      }
+      curr->offset = AlignUp(offset, curr->alignment);
+      arena_size = std::max(arena_size, curr->offset + curr->size);
+      arena_alignment = std::max(arena_alignment, curr->alignment);
+    }
+    DLOG(INFO) << "Placed " << placed.size() << " storages into an arena of " << arena_size
+               << " bytes";
+
+    // Rewrite the function.
+    StdMap<ArenaStorage*> placed_map;
+    int last_end = 0;
+    for (auto* storage : placed) {
+      placed_map[storage->var] = storage;
+      last_end = std::max(last_end, storage->end);
+    }
+    Var arena = MakeVar("arena", {});
+    ExplicitLetList ell;
+    ell.Push(arena, Call(alloc_storage_op,
+                         {MakeConstant(ScalarValue::make(arena_size)),
+                          MakeConstant(ScalarValue::make(arena_alignment)), device_type_,
+                          device_id_, dtype_}));
+    for (int i = 0; i < static_cast<int>(vars_.size()); ++i) {
+      const auto* call = exprs_[i].as<CallNode>();
+      const auto* op_node = call ? call->op.as<OpNode>() : nullptr;
+      const auto* arg0 = call && !call->args.empty() ? call->args[0].as<VarNode>() : nullptr;
+      if (op_node && GetRef<Op>(op_node) == alloc_storage_op && placed_map.count(vars_[i])) {
+        // Dismiss the placed storages.
+        continue;
+      }
+      if (op_node && GetRef<Op>(op_node) == free_op && arg0 &&
+          placed_map.count(GetRef<Var>(arg0))) {
+        // Free the arena along with the last placed storage. On multiple streams, the arena is
+        // held until the function returns, as its storages are released on different streams.
+        if (i == last_end && !stream_order_.IsMultiStream()) {
+          ell.Push(vars_[i], Call(free_op, {arena}));
+        }
+        continue;
+      }
+      if (op_node && GetRef<Op>(op_node) == alloc_tensor_op && arg0 &&
+          placed_map.count(GetRef<Var>(arg0))) {
+        auto storage = placed_map[GetRef<Var>(arg0)];
+        Array<Expr> new_args = call->args;
+        new_args.Set(0, arena);
+        auto offset = MakeConstant(ScalarValue::make(storage->offset));
+        if (new_args.size() == 5) {
+          new_args.push_back(offset);
+        } else {
+          new_args.Set(5, offset);
+        }
+        ell.Push(vars_[i], Call(alloc_tensor_op, new_args));
+        continue;
+      }
+      ell.Push(vars_[i], exprs_[i]);
+    }
+    Expr body = ret_;
+    for (int i = static_cast<int>(ell.vars.size()) - 1; i >= 0; --i) {
+      body = Let(ell.vars[i], ell.exprs[i], body);
+    }
+    return Function(func_->params, body, func_->ret_type, func_->type_params, func_->attrs);
+  }
+
+ private:
+  inline int64_t AlignUp(int64_t offset, int64_t alignment) {
+    return (offset + alignment - 1) / alignment * alignment;
+  }
+
+  /*!
+   * \brief Whether two storages cannot share the memory of the arena. Besides the overlapped
+   * life-cycles, storages on multiple streams cannot share the memory unless all kernels using the
+   * earlier one happen before the ones using the later one.
+   */
+  bool IsConflict(const ArenaStorage* lhs, const ArenaStorage* rhs) {
+    if (lhs->start <= rhs->end && rhs->start <= lhs->end) {
+      return true;
+    }
+    if (!stream_order_.IsMultiStream()) {
+      return false;
+    }
+    const ArenaStorage* first = lhs->start < rhs->start ? lhs : rhs;
+    const ArenaStorage* second = first == lhs ? rhs : lhs;
+    for (int i : stream_order_.GetUses(first->var)) {
+      for (int j : stream_order_.GetUses(second->var)) {
+        if (!stream_order_.HappensBefore(i, j)) {
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+
+  /*! \brief Mark the candidate storages used by the given expression as invalid. */
+  void MarkInvalid(const Expr& expr, const StdMap<ArenaStorage>& storages, VSet* invalid) {
+    for (const auto& var : FreeVars(expr)) {
+      if (storages.count(var)) {
+        invalid->insert(var);
+      }
+    }
+  }
+
+  /*! \brief The function to be optimized. */
+  const Function& func_;
+  /*! \brief The let-binding variables in the top-level scope. */
+  std::vector<Var> vars_;
+  /*! \brief The let-binding values in the top-level scope. */
+  std::vector<Expr> exprs_;
+  /*! \brief The body of the last let-binding. */
+  Expr ret_;
+  /*! \brief The device type, device id and dtype arguments of the arena. */
+  Expr device_type_, device_id_, dtype_;
+  /*! \brief The happens-before order of the bindings on multiple streams. */
+  StreamOrder stream_order_;
+};
+
 }  // namespace memory_plan
 
 TVM_REGISTER_PASS_CONFIG_OPTION("raf.memory_plan.dump_liveness_stat", Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.memory_plan.static_arena", Bool);
 
 Pass MemoryPlan() {
   PassContext pass_ctx = PassContext::Current();
   Bool dump_stat = pass_ctx->GetConfig("raf.memory_plan.dump_liveness_stat", Bool(false)).value();
+  Bool static_arena = pass_ctx->GetConfig("raf.memory_plan.static_arena", Bool(false)).value();
   TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
                                                                              PassContext pc) {
     auto func = f;
@@ -492,20 +979,24 @@ Pass MemoryPlan() {
       return f;
     }
 
-    auto analyzer = liveness_analysis::LivenessAnalyzer(func);
+    std::shared_ptr<liveness_analysis::LivenessAnalyzer> analyzer;
     try {
-      auto live_in = analyzer.Run();
-      if (!analyzer.IsSuccess()) {
+      analyzer = liveness_analysis::GetLivenessAnalyzer(func);
+      if (!analyzer->IsSuccess()) {
         throw;
       }
       if (dump_stat) {
-        liveness_analysis::DumpLivenessStat(live_in);
+        liveness_analysis::DumpLivenessStat(analyzer->GetLiveIn());
       }
     } catch (const dmlc::Error& e) {
       LOG(WARNING) << "Memory planning is disabled because liveness analysis was failed";
       return func;
     }
-    return Downcast<ir::Function>(memory_plan::MemoryPlanner(func, &analyzer).Run());
+    auto planned = Downcast<ir::Function>(memory_plan::MemoryPlanner(func, analyzer.get()).Run());
+    if (static_arena) {
+      planned = memory_plan::ArenaPlanner(planned).Run();
+    }
+    return planned;
   };
   return CreateRAFFunctionPass(pass_func, 2, "MemoryPlan", {});
 }
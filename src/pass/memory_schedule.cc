@@ -7,6 +7,8 @@
  * \file memory_schedule.cc
  * \brief Schedule ANF IR to reduce memory footprint.
  */
+#include <chrono>
+#include <set>
 #include <tvm/ir/type_functor.h>
 #include "raf/op.h"
 #include "raf/ir.h"
@@ -585,19 +587,334 @@ StdMap<std::pair<VSet, VSet>> ANFScheduler4Memory::BuildDefUseMap(const Function
   return DefUseAnalyzer(func).Run();
 }
 
+/*!
+ * \brief Search for the schedule with the minimal peak memory footprint. The let-bindings are
+ * scheduled one by one in a topological order of their dependencies with a depth-first search,
+ * which is a dynamic programming over the sets of scheduled bindings: the live memory only depends
+ * on which bindings are scheduled, so a set reached again without a lower peak is pruned, as well
+ * as a partial schedule whose peak is no better than the best complete one. The input schedule
+ * (e.g., from the greedy scheduler) is the initial best, and the search stops when it exceeds the
+ * time budget, so the result is never worse than the input.
+ */
+class OptimalScheduler4Memory {
+ public:
+  OptimalScheduler4Memory(const Function& func, int64_t time_budget_ms)
+      : func_(func), ell_(ExplicitLetList::make(func->body)), time_budget_ms_(time_budget_ms) {
+  }
+
+  Expr Run() {
+    int n = ell_->vars.size();
+    if (n == 0 || !Init()) {
+      return func_;
+    }
+
+    // The input schedule is the initial best.
+    std::vector<int> order(n);
+    for (int i = 0; i < n; ++i) {
+      order[i] = i;
+    }
+    float input_peak = CalcPeak(order);
+    best_peak_ = input_peak;
+    best_order_ = order;
+
+    // Search from an empty schedule.
+    start_ = std::chrono::steady_clock::now();
+    std::vector<int> n_pending_deps(n);
+    for (int i = 0; i < n; ++i) {
+      n_pending_deps[i] = deps_[i].size();
+    }
+    std::vector<int> n_pending_users = n_users_;
+    std::vector<bool> scheduled(n, false);
+    std::vector<int> curr_order;
+    bool finished = Search(&n_pending_deps, &n_pending_users, &scheduled, &curr_order, 0, 0);
+    LOG(INFO) << "Peak memory of the input schedule: " << input_peak
+              << " MBs, the optimal schedule: " << best_peak_ << " MBs"
+              << (finished ? "" : " (time budget reached)");
+    if (best_peak_ >= input_peak) {
+      return func_;
+    }
+
+    Expr new_body = LetList::With([&](LetList* ll) {
+      for (int idx : best_order_) {
+        ll->Push(ell_->vars[idx], ell_->exprs[idx]);
+      }
+      return ell_->ret;
+    });
+    return Function(func_->params, new_body, func_->ret_type, func_->type_params, func_->attrs);
+  }
+
+ private:
+  /*! \brief Build the dependencies and the storage of each let-binding. */
+  bool Init() {
+    int n = ell_->vars.size();
+    for (int i = 0; i < n; ++i) {
+      var_index_[ell_->vars[i]] = i;
+    }
+    deps_.resize(n);
+    users_.resize(n);
+    sizes_.resize(n, 0);
+    n_users_.resize(n, 0);
+    storage_users_.resize(n);
+    std::vector<std::vector<int>> storages(n);
+    std::vector<std::vector<int>> reads(n);
+    std::unordered_map<const VarNode*, std::vector<int>> param_reads;
+
+    for (int i = 0; i < n; ++i) {
+      const auto& var = ell_->vars[i];
+      const auto& expr = ell_->exprs[i];
+      std::set<int> dep_set;
+      for (const auto& free_var : FreeVars(expr)) {
+        auto it = var_index_.find(free_var);
+        if (it != var_index_.end()) {
+          dep_set.insert(it->second);
+          reads[i].insert(reads[i].end(), storages[it->second].begin(),
+                          storages[it->second].end());
+        } else {
+          param_reads[free_var.get()].push_back(i);
+        }
+      }
+      deps_[i].assign(dep_set.begin(), dep_set.end());
+
+      // The storage of a binding is either newly allocated or aliased to its arguments.
+      auto may_share = GetMayShare(var);
+      if (expr->IsInstance<CallNode>() && !may_share.defined()) {
+        auto size = BytesCompactType(var->checked_type());
+        if (size == 0) {
+          LOG(WARNING) << "Cannot schedule " << var->name_hint() << " due to dynamic size";
+          return false;
+        }
+        sizes_[i] = size / kMegaBytes;
+        storages[i] = {i};
+      } else if (expr->IsInstance<CallNode>()) {
+        auto it = var_index_.find(may_share);
+        if (it != var_index_.end()) {
+          storages[i] = storages[it->second];
+        }
+      } else {
+        storages[i] = reads[i];
+      }
+    }
+
+    // An in-place update keeps its order with the other reads of the updated tensor.
+    for (int i = 0; i < n; ++i) {
+      auto may_share = GetMayShare(ell_->vars[i]);
+      if (!may_share.defined() || !ell_->exprs[i]->IsInstance<CallNode>()) {
+        continue;
+      }
+      std::vector<int> shared_reads;
+      auto it = var_index_.find(may_share);
+      if (it != var_index_.end()) {
+        for (int j = 0; j < n; ++j) {
+          if (std::find(deps_[j].begin(), deps_[j].end(), it->second) != deps_[j].end()) {
+            shared_reads.push_back(j);
+          }
+        }
+      } else if (param_reads.count(may_share.get())) {
+        shared_reads = param_reads[may_share.get()];
+      }
+      for (int j : shared_reads) {
+        if (j < i) {
+          AddDep(j, i);
+        } else if (j > i) {
+          AddDep(i, j);
+        }
+      }
+    }
+    for (int i = 0; i < n; ++i) {
+      for (int dep : deps_[i]) {
+        users_[dep].push_back(i);
+      }
+    }
+
+    // A storage is freed after all the bindings reading it are scheduled, and the returned one
+    // is never freed.
+    for (int i = 0; i < n; ++i) {
+      std::set<int> read_set(reads[i].begin(), reads[i].end());
+      for (int storage : read_set) {
+        if (storage != i) {
+          storage_users_[i].push_back(storage);
+          n_users_[storage]++;
+        }
+      }
+    }
+    auto it = var_index_.find(ell_->ret);
+    if (it != var_index_.end()) {
+      for (int storage : storages[it->second]) {
+        n_users_[storage]++;
+      }
+    }
+    return true;
+  }
+
+  /*! \brief Add a dependency that the binding "to" has to be scheduled after "from". */
+  void AddDep(int from, int to) {
+    if (std::find(deps_[to].begin(), deps_[to].end(), from) == deps_[to].end()) {
+      deps_[to].push_back(from);
+    }
+  }
+
+  /*! \brief Calculate the peak memory in MBs of the given schedule. */
+  float CalcPeak(const std::vector<int>& order) {
+    std::vector<int> n_pending_users = n_users_;
+    float curr = 0, peak = 0;
+    for (int idx : order) {
+      peak = std::max(peak, curr + sizes_[idx]);
+      curr += Schedule(idx, &n_pending_users);
+    }
+    return peak;
+  }
+
+  /*!
+   * \brief Schedule a binding and update the pending users of the storages it reads. Note that
+   * the output is allocated before the inputs are freed, so the peak of this binding is the
+   * current memory plus its output size.
+   * \return The memory change after the binding. The output of a dead binding is freed as well.
+   */
+  float Schedule(int idx, std::vector<int>* n_pending_users) {
+    float inc = sizes_[idx];
+    for (int storage : storage_users_[idx]) {
+      if (--(*n_pending_users)[storage] == 0) {
+        inc -= sizes_[storage];
+      }
+    }
+    if ((*n_pending_users)[idx] == 0) {
+      inc -= sizes_[idx];
+    }
+    return inc;
+  }
+
+  /*! \brief Revert Schedule. */
+  void Unschedule(int idx, std::vector<int>* n_pending_users) {
+    for (int storage : storage_users_[idx]) {
+      (*n_pending_users)[storage]++;
+    }
+  }
+
+  /*!
+   * \brief Search the schedules following the current partial one.
+   * \return False if the search stops because of the time budget.
+   */
+  bool Search(std::vector<int>* n_pending_deps, std::vector<int>* n_pending_users,
+              std::vector<bool>* scheduled, std::vector<int>* curr_order, float curr_mem,
+              float curr_peak) {
+    int n = ell_->vars.size();
+    if (static_cast<int>(curr_order->size()) == n) {
+      if (curr_peak < best_peak_) {
+        best_peak_ = curr_peak;
+        best_order_ = *curr_order;
+      }
+      return true;
+    }
+    if (++n_visited_ % 1024 == 0) {
+      auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                         std::chrono::steady_clock::now() - start_)
+                         .count();
+      if (elapsed > time_budget_ms_) {
+        return false;
+      }
+    }
+    std::string key(scheduled->begin(), scheduled->end());
+    auto it = visited_.find(key);
+    if (it != visited_.end() && it->second <= curr_peak) {
+      return true;
+    }
+    visited_[key] = curr_peak;
+
+    // Try the ready bindings that increase the least memory first, so that a good schedule is
+    // found early to prune the others.
+    std::vector<std::pair<float, int>> ready;
+    for (int i = 0; i < n; ++i) {
+      if (!(*scheduled)[i] && (*n_pending_deps)[i] == 0) {
+        float inc = Schedule(i, n_pending_users);
+        Unschedule(i, n_pending_users);
+        ready.push_back({inc, i});
+      }
+    }
+    std::sort(ready.begin(), ready.end());
+    for (const auto& kv : ready) {
+      int idx = kv.second;
+      float peak = std::max(curr_peak, curr_mem + sizes_[idx]);
+      if (peak >= best_peak_) {
+        continue;
+      }
+      float inc = Schedule(idx, n_pending_users);
+      (*scheduled)[idx] = true;
+      curr_order->push_back(idx);
+      for (int user : users_[idx]) {
+        (*n_pending_deps)[user]--;
+      }
+      bool finished =
+          Search(n_pending_deps, n_pending_users, scheduled, curr_order, curr_mem + inc, peak);
+      for (int user : users_[idx]) {
+        (*n_pending_deps)[user]++;
+      }
+      curr_order->pop_back();
+      (*scheduled)[idx] = false;
+      Unschedule(idx, n_pending_users);
+      if (!finished) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /*! \brief The function to be scheduled. */
+  const Function& func_;
+  /*! \brief The let list. */
+  std::unique_ptr<ExplicitLetList> ell_{nullptr};
+  /*! \brief The time budget of the search in milliseconds. */
+  int64_t time_budget_ms_;
+  /*! \brief Mapping from a let-binding var to its index. */
+  StdMap<int> var_index_;
+  /*! \brief The bindings that each binding depends on. */
+  std::vector<std::vector<int>> deps_;
+  /*! \brief The bindings that depend on each binding. */
+  std::vector<std::vector<int>> users_;
+  /*! \brief The newly allocated size in MBs of each binding. */
+  std::vector<float> sizes_;
+  /*! \brief The storages (bindings that allocate) read by each binding. */
+  std::vector<std::vector<int>> storage_users_;
+  /*! \brief The number of bindings reading the storage allocated by each binding. */
+  std::vector<int> n_users_;
+  /*! \brief The lowest peak in MBs of each visited set of scheduled bindings. */
+  std::unordered_map<std::string, float> visited_;
+  /*! \brief The best schedule found so far and its peak memory in MBs. */
+  std::vector<int> best_order_;
+  float best_peak_;
+  /*! \brief The number of visited search states. */
+  int64_t n_visited_ = 0;
+  /*! \brief The start time of the search. */
+  std::chrono::steady_clock::time_point start_;
+};
+
 }  // namespace memory_schedule
 
 TVM_REGISTER_PASS_CONFIG_OPTION("raf.memory_schedule", Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.memory_schedule.policy", String);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.memory_schedule.time_budget_ms", IntImm);
 
 Pass MemorySchedule() {
   TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
                                                                              PassContext pc) {
     PassContext pass_ctx = PassContext::Current();
     bool enable = pass_ctx->GetConfig("raf.memory_schedule", Bool(false)).value();
-    if (enable) {
-      return Downcast<Function>(memory_schedule::ANFScheduler4Memory(f).Run());
+    if (!enable) {
+      return f;
+    }
+    auto policy = pass_ctx->GetConfig<String>("raf.memory_schedule.policy", "greedy").value();
+    auto greedy = Downcast<Function>(memory_schedule::ANFScheduler4Memory(f).Run());
+    if (policy == "greedy") {
+      return greedy;
+    } else if (policy == "optimal") {
+      // Search from the greedy schedule, so the result is at least as good as it.
+      Integer time_budget_ms =
+          pass_ctx->GetConfig("raf.memory_schedule.time_budget_ms", Integer(1000)).value();
+      return Downcast<Function>(
+          memory_schedule::OptimalScheduler4Memory(greedy, time_budget_ms->value).Run());
     }
-    return f;
+    LOG(FATAL) << "Cannot recognize memory schedule policy: " << policy
+               << ", candidates are greedy and optimal";
+    throw;
   };
 
   Pass func_pass = CreateRAFFunctionPass(pass_func, 2, "MemoryScheduleHelper", {});
@@ -0,0 +1,275 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file merge_sibling_gemm.cc
+ * \brief Merge the sibling GEMMs of an ANF function, which share an input (e.g., the Q, K and V
+ * projections of attention and the weight gradients of their backward), into one wide GEMM of
+ * the concatenated other inputs followed by a split. The concatenated weights are folded into
+ * constants by FoldConstant for inference.
+ */
+#include <unordered_map>
+#include <vector>
+#include "raf/op.h"
+#include "raf/op_utils.h"
+#include "raf/ir.h"
+#include "raf/ir_ext.h"
+#include "raf/pass.h"
+#include "./let_list.h"
+
+namespace raf {
+namespace pass {
+namespace merge_sibling_gemm {
+
+using namespace raf::ir;
+using namespace raf::op;
+using namespace raf::value;
+
+/*! \brief Whether the GEMM transposes its inputs, i.e., op(a, b) = a' @ b'. */
+struct Transposes {
+  bool a;
+  bool b;
+};
+
+/*! \brief A GEMM that may be merged with its siblings sharing the input of the given side. */
+struct Member {
+  int pos;
+  /*! \brief Whether the shared input is the first argument. */
+  bool shared_a;
+};
+
+/*! \brief Whether the expr is a static 2-D float tensor, whose shape is returned. */
+bool GetStatic2D(const Expr& expr, DataType* dtype, std::vector<int64_t>* shape) {
+  if (!expr->checked_type_.defined()) {
+    return false;
+  }
+  const auto* type = expr->checked_type().as<TensorTypeNode>();
+  if (type == nullptr || type->shape.size() != 2U || !type->dtype.is_float()) {
+    return false;
+  }
+  shape->clear();
+  for (const auto& dim : type->shape) {
+    const auto* imm = dim.as<IntImmNode>();
+    if (imm == nullptr) {
+      return false;
+    }
+    shape->push_back(imm->value);
+  }
+  *dtype = type->dtype;
+  return true;
+}
+
+class SiblingGemmMerger {
+ public:
+  Expr Run(const Expr& body) {
+    static const std::unordered_map<const OpNode*, Transposes> gemm_ops = {
+        {Op::Get("raf.op.matmul").get(), {false, false}},
+        {Op::Get("raf.op.matmul_nt").get(), {false, true}},
+        {Op::Get("raf.op.matmul_tn").get(), {true, false}},
+        {Op::Get("raf.op.matmul_tt").get(), {true, true}},
+        {Op::Get("raf.op.dense").get(), {false, true}},
+    };
+    std::vector<Var> vars;
+    std::vector<Expr> values;
+    Expr ret = body;
+    while (const auto* let = ret.as<LetNode>()) {
+      vars.push_back(let->var);
+      values.push_back(let->value);
+      ret = let->body;
+    }
+    const int n = vars.size();
+    // The backward closures are merged separately.
+    bool changed = false;
+    for (int i = 0; i < n; ++i) {
+      const auto* func = values[i].as<FunctionNode>();
+      if (func != nullptr && !func->HasNonzeroAttr(attr::kPrimitive)) {
+        Expr func_body = SiblingGemmMerger().Run(func->body);
+        if (!func_body.same_as(func->body)) {
+          values[i] = Function(func->params, func_body, func->ret_type, func->type_params,
+                               func->attrs);
+          changed = true;
+        }
+      }
+    }
+
+    // The siblings are keyed by the op and the shared input var, which is the first argument if
+    // it has siblings, or the second argument otherwise.
+    using Key = std::pair<const OpNode*, const VarNode*>;
+    struct KeyHash {
+      size_t operator()(const Key& key) const {
+        return std::hash<const void*>()(key.first) ^ std::hash<const void*>()(key.second);
+      }
+    };
+    std::vector<const CallNode*> gemms(n, nullptr);
+    std::unordered_map<Key, int, KeyHash> num_siblings[2];
+    for (int i = 0; i < n; ++i) {
+      const auto* call = values[i].as<CallNode>();
+      const auto* op = call != nullptr ? call->op.as<OpNode>() : nullptr;
+      if (op == nullptr || gemm_ops.count(op) == 0 || call->args.size() != 2U) {
+        continue;
+      }
+      DataType dtype, a_dtype, b_dtype;
+      std::vector<int64_t> shape;
+      if (!GetStatic2D(values[i], &dtype, &shape) ||
+          !GetStatic2D(call->args[0], &a_dtype, &shape) ||
+          !GetStatic2D(call->args[1], &b_dtype, &shape) || a_dtype != dtype || b_dtype != dtype) {
+        continue;
+      }
+      gemms[i] = call;
+      for (int side = 0; side < 2; ++side) {
+        if (const auto* var = call->args[side].as<VarNode>()) {
+          ++num_siblings[side][{op, var}];
+        }
+      }
+    }
+    auto get_key = [&](const CallNode* call, int side) -> Key {
+      return {call->op.as<OpNode>(), call->args[side].as<VarNode>()};
+    };
+    auto num_of = [&](const CallNode* call, int side) {
+      auto it = num_siblings[side].find(get_key(call, side));
+      return it == num_siblings[side].end() ? 0 : it->second;
+    };
+
+    // A group is closed once an output of its members is used, because the merged GEMM is bound
+    // at the last member and must be computed before the uses.
+    std::vector<std::vector<Member>> groups;
+    std::unordered_map<Key, int, KeyHash> open_groups[2];
+    std::unordered_map<const VarNode*, int> open_outputs;
+    auto close = [&](int group) {
+      auto& open = open_groups[groups[group][0].shared_a ? 0 : 1];
+      open.erase(get_key(gemms[groups[group][0].pos], groups[group][0].shared_a ? 0 : 1));
+      for (const auto& member : groups[group]) {
+        open_outputs.erase(vars[member.pos].get());
+      }
+    };
+    for (int i = 0; i < n; ++i) {
+      for (const Var& var : FreeVars(values[i])) {
+        auto it = open_outputs.find(var.get());
+        if (it != open_outputs.end()) {
+          close(it->second);
+        }
+      }
+      const CallNode* call = gemms[i];
+      if (call == nullptr) {
+        continue;
+      }
+      int side = num_of(call, 0) >= 2 ? 0 : (num_of(call, 1) >= 2 ? 1 : -1);
+      if (side < 0) {
+        continue;
+      }
+      Key key = get_key(call, side);
+      auto it = open_groups[side].find(key);
+      int group;
+      if (it == open_groups[side].end()) {
+        group = groups.size();
+        groups.emplace_back();
+        open_groups[side][key] = group;
+      } else {
+        group = it->second;
+      }
+      groups[group].push_back({i, side == 0});
+      open_outputs[vars[i].get()] = group;
+    }
+
+    std::unordered_map<int, int> merged_at;
+    std::vector<bool> removed(n, false);
+    for (size_t g = 0; g < groups.size(); ++g) {
+      if (groups[g].size() >= 2U) {
+        merged_at[groups[g].back().pos] = g;
+        for (const auto& member : groups[g]) {
+          removed[member.pos] = true;
+        }
+      }
+    }
+    if (merged_at.empty() && !changed) {
+      return body;
+    }
+    return LetList::With([&](LetList* ll) {
+      for (int i = 0; i < n; ++i) {
+        if (!removed[i]) {
+          ll->Push(vars[i], values[i]);
+        }
+        auto it = merged_at.find(i);
+        if (it != merged_at.end()) {
+          Merge(groups[it->second], gemm_ops.at(gemms[i]->op.as<OpNode>()), vars, gemms, ll);
+        }
+      }
+      return ret;
+    });
+  }
+
+ private:
+  /*!
+   * \brief Bind the merged GEMM and rebind the outputs of the members to its splits. When the
+   * first input is shared, the second inputs are concatenated so that the output columns of the
+   * members are concatenated, and the output is split along the columns. Otherwise, the output
+   * rows are concatenated and split, so the splits are views of the output.
+   */
+  static void Merge(const std::vector<Member>& group, const Transposes& transposes,
+                    const std::vector<Var>& vars, const std::vector<const CallNode*>& gemms,
+                    LetList* ll) {
+    static const Op& concatenate_op = Op::Get("raf.op.concatenate");
+    static const Op& split_op = Op::Get("raf.op.split");
+    const bool shared_a = group[0].shared_a;
+    const int merged = shared_a ? 1 : 0;
+    const int concat_axis = shared_a ? (transposes.b ? 0 : 1) : (transposes.a ? 1 : 0);
+    const int split_axis = shared_a ? 1 : 0;
+    const CallNode* first = gemms[group[0].pos];
+    Array<Expr> fields;
+    std::vector<int64_t> indices;
+    int64_t offset = 0;
+    for (const auto& member : group) {
+      const CallNode* call = gemms[member.pos];
+      fields.push_back(call->args[merged]);
+      if (offset > 0) {
+        indices.push_back(offset);
+      }
+      const auto* out_type = call->checked_type().as<TensorTypeNode>();
+      offset += out_type->shape[split_axis].as<IntImmNode>()->value;
+    }
+    std::string name = vars[group[0].pos]->name_hint();
+    // The tuple of constant weights is not bound, so FoldConstant sees a constant argument.
+    bool all_const = true;
+    for (const auto& field : fields) {
+      all_const = all_const && field->IsInstance<ConstantNode>();
+    }
+    Expr tuple = Tuple(fields);
+    if (!all_const) {
+      tuple = ll->Push(MakeVar(name + "_siblings", {}), tuple);
+    }
+    Expr concat_axis_expr = MakeConstant(ScalarValue::make(static_cast<int64_t>(concat_axis)));
+    Expr split_axis_expr = MakeConstant(ScalarValue::make(static_cast<int64_t>(split_axis)));
+    Var concat = ll->Push(MakeVar(name + "_concat", {}),
+                          Call(concatenate_op, {tuple, concat_axis_expr}));
+    Array<Expr> args = {first->args[0], first->args[1]};
+    args.Set(merged, concat);
+    Var out = ll->Push(MakeVar(name + "_merged", {}), Call(first->op, args));
+    Var parts = ll->Push(MakeVar(name + "_split", {}),
+                         Call(split_op, {out, MakeConstant(ArrayToIntTuple(indices)),
+                                         split_axis_expr}));
+    for (size_t i = 0; i < group.size(); ++i) {
+      ll->Push(vars[group[i].pos], TupleGetItem(parts, i));
+    }
+  }
+};
+
+}  // namespace merge_sibling_gemm
+
+Pass MergeSiblingGemm() {
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
+                                                                             PassContext pc) {
+    Expr body = merge_sibling_gemm::SiblingGemmMerger().Run(f->body);
+    if (body.same_as(f->body)) {
+      return f;
+    }
+    return Function(f->params, body, f->ret_type, f->type_params, f->attrs);
+  };
+  return CreateRAFFunctionPass(pass_func, 0, "MergeSiblingGemm", {"InferType"});
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.MergeSiblingGemm").set_body_typed(MergeSiblingGemm);
+
+}  // namespace pass
+}  // namespace raf
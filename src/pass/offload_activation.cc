@@ -0,0 +1,324 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file offload_activation.cc
+ * \brief Given a model after AutoDiff and InlineBackward, this pass offloads the activations
+ * living across the forward and the backward to the pinned host memory, when the memory
+ * consumption at the end of the forward exceeds the memory budget. An offloaded activation is
+ * copied to the host right after its forward producer, and is prefetched back to the device one
+ * binding ahead of its first backward consumer. EnforceSync then schedules the two copies to the
+ * MemCpyCudaToCpu and MemCpyCpuToCuda streams respectively, so that they are overlapped with the
+ * computation and guarded by events.
+ *
+ * Each candidate tensor chooses between offloading and rematerialization: it is offloaded only
+ * if its round-trip transfer time over PCIe is shorter than the latency to recompute it.
+ * Otherwise it is left to the Rematerialization pass, which runs afterwards.
+ */
+#include <algorithm>
+#include <limits>
+#include "raf/pass.h"
+#include "raf/device.h"
+#include "raf/op_profiler.h"
+
+#include "./common.h"
+#include "./estimate_flops.h"
+#include "../common/shape_utils.h"
+
+namespace raf {
+namespace pass {
+namespace offload_activation {
+
+constexpr float kMegaBytes = 1048576;
+
+// The max number of ops to recompute a tensor, which is aligned to the rematerialization.
+constexpr int kMaxRecomputeDepth = 10;
+
+/*! \brief The offloading decision of a tensor. */
+struct Candidate {
+  /*! \brief The let-binding index of the tensor. */
+  int idx;
+  /*! \brief The size of the tensor in bytes. */
+  int64_t size;
+  /*! \brief The estimated round-trip transfer time in microseconds. */
+  float transfer_us;
+  /*! \brief The estimated recompute latency in microseconds. */
+  float recompute_us;
+};
+
+class ActivationOffloader {
+ public:
+  ActivationOffloader(const Function& func, const IRModule& mod, const Device& device,
+                      int64_t budget, float bandwidth_gbps, float compute_tflops,
+                      op_profiler::OpProfiler* profiler)
+      : func_(func),
+        ell_(ExplicitLetList::make(func->body)),
+        device_(device),
+        budget_(budget),
+        bandwidth_gbps_(bandwidth_gbps) {
+    int n = ell_->vars.size();
+    for (int i = 0; i < n; ++i) {
+      var_index_[ell_->vars[i].get()] = i;
+    }
+    uses_.resize(n);
+    for (int i = 0; i < n; ++i) {
+      for (const auto& var : FreeVars(ell_->exprs[i])) {
+        auto it = var_index_.find(var.get());
+        if (it != var_index_.end()) {
+          uses_[it->second].push_back(i);
+        }
+      }
+    }
+
+    // Estimate the latency of each let-binding in microseconds.
+    latencies_.resize(n, 0);
+    estimate_flops::StdMap<float> flops;
+    if (profiler == nullptr) {
+      flops = estimate_flops::FLOPSEstimater().Run(device, func, mod);
+    }
+    for (int i = 0; i < n; ++i) {
+      if (!ell_->exprs[i]->IsInstance<CallNode>()) {
+        continue;
+      }
+      if (profiler != nullptr) {
+        latencies_[i] = profiler->ProfileOp(ell_->exprs[i]).first[0];
+      } else {
+        auto it = flops.find(ell_->vars[i]);
+        float gflops = (it != flops.end()) ? std::max(it->second, 0.0f) : 0.0f;
+        // GFLOPS / TFLOPS is in milliseconds.
+        latencies_[i] = gflops / compute_tflops * 1e3;
+      }
+    }
+  }
+
+  Function Run() {
+    static const Op& device_copy_op = Op::Get("raf.op.device_copy");
+    int n = ell_->vars.size();
+    int fwd_end = FindForwardEnd();
+    if (fwd_end == -1) {
+      DLOG(INFO) << "Cannot find the end of the forward. Skip offloading activations";
+      return func_;
+    }
+
+    // The memory consumption at the end of the forward, where the activations are the most.
+    int64_t deficit = -budget_;
+    for (const auto& param : func_->params) {
+      deficit += BytesOf(param);
+    }
+    for (int i = 0; i <= fwd_end; ++i) {
+      if (!uses_[i].empty() && uses_[i].back() > fwd_end) {
+        deficit += BytesOf(ell_->vars[i]);
+      }
+    }
+    if (deficit <= 0) {
+      return func_;
+    }
+
+    // Choose the tensors that are cheaper to transfer than to recompute, and offload the ones
+    // saving the most time per byte until the deficit is covered.
+    std::vector<Candidate> candidates;
+    for (int i = 0; i < fwd_end; ++i) {
+      auto cand = MakeCandidate(i, fwd_end);
+      if (cand.size > 0 && cand.transfer_us < cand.recompute_us) {
+        candidates.push_back(cand);
+      }
+    }
+    std::stable_sort(candidates.begin(), candidates.end(),
+                     [](const Candidate& a, const Candidate& b) {
+                       return (a.recompute_us - a.transfer_us) / a.size >
+                              (b.recompute_us - b.transfer_us) / b.size;
+                     });
+    std::unordered_map<int, std::vector<int>> offloads, prefetches;
+    for (const auto& cand : candidates) {
+      if (deficit <= 0) {
+        break;
+      }
+      deficit -= cand.size;
+      offloads[cand.idx].push_back(cand.idx);
+      auto first_bwd_use = *std::upper_bound(uses_[cand.idx].begin(), uses_[cand.idx].end(),
+                                             fwd_end);
+      prefetches[std::max(fwd_end + 1, first_bwd_use - 1)].push_back(cand.idx);
+      DLOG(INFO) << "Offload " << ell_->vars[cand.idx]->name_hint() << " ("
+                 << cand.size / kMegaBytes << " MBs): transfer " << cand.transfer_us
+                 << " us, recompute " << cand.recompute_us << " us";
+    }
+    if (offloads.empty()) {
+      return func_;
+    }
+
+    // Rebuild the let list with the memory copies inserted.
+    auto device = MakeConstant(StringValue::make(device_.device_type().c_str()));
+    auto host = MakeConstant(StringValue::make(DevType(DevType::kCUDAHost()).c_str()));
+    std::unordered_map<int, Var> host_vars;
+    Map<Var, Expr> prefetched;
+    std::unique_ptr<ExplicitLetList> ell = std::make_unique<ExplicitLetList>();
+    for (int i = 0; i < n; ++i) {
+      for (int idx : prefetches[i]) {
+        const auto& var = ell_->vars[idx];
+        auto dev_var = MakeVar(var->name_hint() + "_prefetch", {});
+        ell->Push(dev_var, Call(device_copy_op, {host_vars.at(idx), host, device}));
+        prefetched.Set(var, dev_var);
+      }
+      auto expr = ell_->exprs[i];
+      if (i > fwd_end && !prefetched.empty()) {
+        expr = Substitute(expr, prefetched);
+      }
+      ell->Push(ell_->vars[i], expr);
+      for (int idx : offloads[i]) {
+        const auto& var = ell_->vars[idx];
+        auto host_var = MakeVar(var->name_hint() + "_host", {});
+        ell->Push(host_var, Call(device_copy_op, {var, device, host}));
+        host_vars[idx] = host_var;
+      }
+    }
+    ell->ret = ell_->ret;
+    return Function(func_->params, ell->AsExpr(), func_->ret_type, {}, func_->attrs);
+  }
+
+ private:
+  /*!
+   * \brief Assume output is a tuple of (forward out, (grads, ...)), so the forward ends at the
+   * binding of the forward output.
+   * \return The let-binding index of the forward output, or -1 if not found.
+   */
+  int FindForwardEnd() {
+    if (ell_->exprs.empty()) {
+      return -1;
+    }
+    if (auto ret = ell_->exprs.back().as<TupleNode>()) {
+      if (ret->fields.size() == 2U && ret->fields[0]->IsInstance<VarNode>()) {
+        auto it = var_index_.find(ret->fields[0].as<VarNode>());
+        if (it != var_index_.end()) {
+          return it->second;
+        }
+      }
+    }
+    return -1;
+  }
+
+  /*! \brief The size of the given var in bytes, or 0 if it is not a static tensor or tuple. */
+  int64_t BytesOf(const Var& var) {
+    const auto& type = var->checked_type();
+    if (!type->IsInstance<TensorTypeNode>() && !type->IsInstance<TupleTypeNode>()) {
+      return 0;
+    }
+    return common::shape_utils::BytesCompactType(type);
+  }
+
+  /*! \brief Estimate the offloading of the given tensor. The size is 0 if it cannot offload. */
+  Candidate MakeCandidate(int idx, int fwd_end) {
+    static const Op& device_copy_op = Op::Get("raf.op.device_copy");
+    Candidate cand{idx, 0, 0, 0};
+    const auto& uses = uses_[idx];
+    auto call = ell_->exprs[idx].as<CallNode>();
+    // Only offload the tensors which are produced by ops in the forward, and are used by the
+    // backward but not returned directly. Small (< 1MB) tensors are not worth offloading.
+    if (call == nullptr || call->op.same_as(device_copy_op) || uses.empty() ||
+        uses.back() <= fwd_end || uses.back() == static_cast<int>(ell_->vars.size()) - 1 ||
+        !ell_->vars[idx]->checked_type()->IsInstance<TensorTypeNode>()) {
+      return cand;
+    }
+    int64_t size = BytesOf(ell_->vars[idx]);
+    if (size < kMegaBytes) {
+      return cand;
+    }
+    cand.recompute_us = RecomputeLatency(idx, fwd_end, 1);
+    if (cand.recompute_us < 0) {
+      // Cannot be rematerialized, so offloading is always preferred.
+      cand.recompute_us = std::numeric_limits<float>::max();
+    }
+    // GB/s is equivalent to KB/us.
+    cand.transfer_us = 2 * size / (bandwidth_gbps_ * 1e3);
+    cand.size = size;
+    return cand;
+  }
+
+  /*!
+   * \brief Estimate the latency to recompute the given tensor in its backward use. The arguments
+   * which are dead after the forward have to be recomputed as well.
+   * \return The latency in microseconds, or -1 if it requires too many ops to recompute.
+   */
+  float RecomputeLatency(int idx, int fwd_end, int depth) {
+    if (depth == kMaxRecomputeDepth) {
+      return -1;
+    }
+    float latency = latencies_[idx];
+    for (const auto& var : FreeVars(ell_->exprs[idx])) {
+      auto it = var_index_.find(var.get());
+      if (it == var_index_.end()) {
+        // Parameters are always alive.
+        continue;
+      }
+      const auto& arg_uses = uses_[it->second];
+      if (arg_uses.empty() || arg_uses.back() <= fwd_end) {
+        auto arg_latency = RecomputeLatency(it->second, fwd_end, depth + 1);
+        if (arg_latency < 0) {
+          return -1;
+        }
+        latency += arg_latency;
+      }
+    }
+    return latency;
+  }
+
+  /*! \brief The target function. */
+  Function func_;
+  /*! \brief The explicit let list of the target function. */
+  std::unique_ptr<ExplicitLetList> ell_;
+  /*! \brief The target device. */
+  Device device_;
+  /*! \brief The memory budget in bytes. */
+  int64_t budget_;
+  /*! \brief The PCIe bandwidth in GB/s. */
+  float bandwidth_gbps_;
+  /*! \brief Mapping from a let var to its binding index. */
+  std::unordered_map<const VarNode*, int> var_index_;
+  /*! \brief The sorted let-binding indices using each let var. */
+  std::vector<std::vector<int>> uses_;
+  /*! \brief The estimated latency of each let-binding in microseconds. */
+  std::vector<float> latencies_;
+};
+
+}  // namespace offload_activation
+
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.offload.pcie_bandwidth", IntImm);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.offload.compute_tflops", IntImm);
+
+Pass OffloadActivation() {
+  PassContext pass_ctx = PassContext::Current();
+  Integer memory_budget =
+      pass_ctx->GetConfig("raf.memory_budget", Integer(static_cast<int>(0))).value();
+  Integer bandwidth =
+      pass_ctx->GetConfig("raf.offload.pcie_bandwidth", Integer(static_cast<int>(0))).value();
+  Integer tflops =
+      pass_ctx->GetConfig("raf.offload.compute_tflops", Integer(static_cast<int>(10))).value();
+  bool use_profiler = !(pass_ctx->GetConfig("raf.remat.use_gflops_cost", Bool(false)).value());
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
+                                                                             PassContext pc) {
+    // Offloading is disabled without a memory budget or the PCIe bandwidth.
+    if (memory_budget == 0 || bandwidth == 0) {
+      return f;
+    }
+    auto device = Device::Current();
+    if (device.device_type() != DevType::kCUDA()) {
+      LOG(WARNING) << "Activation offloading requires a CUDA device. Skip offloading.";
+      return f;
+    }
+    op_profiler::OpProfiler* profiler = nullptr;
+    if (use_profiler) {
+      profiler = op_profiler::OpProfiler::Get(device);
+    }
+    return offload_activation::ActivationOffloader(f, m, device, memory_budget->value,
+                                                   bandwidth->value, tflops->value, profiler)
+        .Run();
+  };
+  auto offload_activation = CreateRAFFunctionPass(pass_func, 0, "OffloadActivationFunc", {});
+  return RAFSequential({InferType(), offload_activation, EraseType()}, "OffloadActivation");
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.OffloadActivation").set_body_typed(OffloadActivation);
+
+}  // namespace pass
+}  // namespace raf
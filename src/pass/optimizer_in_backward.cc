@@ -0,0 +1,231 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file optimizer_in_backward.cc
+ * \brief Move each optimizer update of the ANF training graph right after its gradient is
+ * produced, so that the gradient buffer is freed during the backward instead of staying live
+ * until all optimizer updates run.
+ */
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "raf/op.h"
+#include "raf/ir.h"
+#include "raf/pass.h"
+#include "./let_list.h"
+
+namespace raf {
+namespace pass {
+namespace optimizer_in_backward {
+
+using namespace raf::op;
+
+using VarSet = std::unordered_set<const VarNode*>;
+
+/*! \brief Whether the op is one of the optimizers, which update their states in place. */
+bool IsOptimizerOp(const Op& op) {
+  static const std::unordered_set<const OpNode*> optimizers = {
+      Op::Get("raf.op.sgd").get(),   Op::Get("raf.op.sparse_sgd").get(),
+      Op::Get("raf.op.lans").get(),  Op::Get("raf.op.multi_sgd").get(),
+      Op::Get("raf.op.adamw").get(), Op::Get("raf.op.lamb").get(),
+  };
+  const Op& base_op = IsDialectOp(op) ? GetBaseOp(op) : op;
+  return optimizers.count(base_op.get()) > 0;
+}
+
+/*!
+ * \brief Get the args that are updated in place by the optimizer call, which may also be a call
+ * of the fused function of an optimizer. Return false if the expr is not an optimizer call.
+ */
+bool GetInplaceArgs(const Expr& expr, std::vector<Expr>* inplace_args) {
+  static auto finplace = Op::GetAttrMap<TRAFInplaceUpdate>("TRAFInplaceUpdate");
+  const auto* call = expr.as<CallNode>();
+  if (call == nullptr) {
+    return false;
+  }
+  if (const auto* op = call->op.as<OpNode>()) {
+    Op base_op = IsDialectOp(GetRef<Op>(op)) ? GetBaseOp(GetRef<Op>(op)) : GetRef<Op>(op);
+    if (!IsOptimizerOp(base_op)) {
+      return false;
+    }
+    for (const auto& it : finplace[base_op]) {
+      inplace_args->push_back(call->args[it.first]);
+    }
+    return true;
+  }
+  const auto* func = call->op.as<FunctionNode>();
+  if (func == nullptr || !func->HasNonzeroAttr(attr::kPrimitive)) {
+    return false;
+  }
+  bool found = false;
+  bool all_args = false;
+  PostOrderVisit(func->body, [&](const Expr& e) {
+    const auto* inner = e.as<CallNode>();
+    if (inner == nullptr || !inner->op->IsInstance<OpNode>() ||
+        !IsOptimizerOp(Downcast<Op>(inner->op))) {
+      return;
+    }
+    found = true;
+    Op inner_op = Downcast<Op>(inner->op);
+    Op base_op = IsDialectOp(inner_op) ? GetBaseOp(inner_op) : inner_op;
+    for (const auto& it : finplace[base_op]) {
+      const Expr& arg = inner->args[it.first];
+      size_t i = 0;
+      while (i < func->params.size() && !func->params[i].same_as(arg)) {
+        ++i;
+      }
+      if (i < func->params.size()) {
+        inplace_args->push_back(call->args[i]);
+      } else {
+        // The updated tensor is computed inside the fused function, so take all args.
+        all_args = true;
+      }
+    }
+  });
+  if (all_args) {
+    inplace_args->assign(call->args.begin(), call->args.end());
+  }
+  return found;
+}
+
+/*! \brief The vars referenced by the bound value of ANF. */
+std::vector<const VarNode*> RefVars(const Expr& value) {
+  std::vector<const VarNode*> vars;
+  auto add = [&vars](const Expr& e) {
+    if (const auto* var = e.as<VarNode>()) {
+      vars.push_back(var);
+    }
+  };
+  if (const auto* call = value.as<CallNode>()) {
+    add(call->op);
+    for (const Expr& arg : call->args) {
+      add(arg);
+    }
+  } else if (const auto* tuple = value.as<TupleNode>()) {
+    for (const Expr& field : tuple->fields) {
+      add(field);
+    }
+  } else if (const auto* item = value.as<TupleGetItemNode>()) {
+    add(item->tuple);
+  } else if (value->IsInstance<VarNode>()) {
+    add(value);
+  } else if (!value->IsInstance<ConstantNode>() && !value->IsInstance<OpNode>()) {
+    for (const Var& var : FreeVars(value)) {
+      vars.push_back(var.get());
+    }
+  }
+  return vars;
+}
+
+Function OptimizerInBackward(const Function& func) {
+  std::vector<Var> vars;
+  std::vector<Expr> values;
+  Expr ret = func->body;
+  while (const auto* let = ret.as<LetNode>()) {
+    vars.push_back(let->var);
+    values.push_back(let->value);
+    ret = let->body;
+  }
+  const int n = vars.size();
+  std::unordered_map<const VarNode*, int> pos;
+  // The tuples and the aliases refer to the tensors of their roots, i.e., the vars bound to calls
+  // or the parameters.
+  std::unordered_map<const VarNode*, VarSet> roots;
+  // The positions of the bindings that read each root.
+  std::unordered_map<const VarNode*, std::vector<int>> readers;
+  std::vector<std::vector<const VarNode*>> refs(n);
+  auto get_roots = [&roots](const VarNode* var) {
+    auto it = roots.find(var);
+    return it != roots.end() ? it->second : VarSet{var};
+  };
+  for (int i = 0; i < n; ++i) {
+    pos[vars[i].get()] = i;
+    refs[i] = RefVars(values[i]);
+    VarSet read;
+    for (const VarNode* var : refs[i]) {
+      for (const VarNode* root : get_roots(var)) {
+        read.insert(root);
+      }
+    }
+    for (const VarNode* root : read) {
+      readers[root].push_back(i);
+    }
+    const Expr& value = values[i];
+    if (value->IsInstance<TupleNode>() || value->IsInstance<TupleGetItemNode>() ||
+        value->IsInstance<VarNode>()) {
+      roots[vars[i].get()] = std::move(read);
+    }
+  }
+
+  // The optimizer binding i is placed right after the binding anchor[i], which is the latest one
+  // that defines its args or reads the tensors it updates in place. -1 means the beginning.
+  std::vector<int> anchor(n);
+  std::vector<bool> moved(n, false);
+  std::vector<std::vector<int>> moved_after(n + 1);
+  for (int i = 0; i < n; ++i) {
+    anchor[i] = i;
+    std::vector<Expr> inplace_args;
+    if (!GetInplaceArgs(values[i], &inplace_args)) {
+      continue;
+    }
+    int target = -1;
+    for (const VarNode* var : refs[i]) {
+      auto it = pos.find(var);
+      if (it != pos.end()) {
+        target = std::max(target, anchor[it->second]);
+      }
+    }
+    for (const Expr& arg : inplace_args) {
+      const auto* var = arg.as<VarNode>();
+      if (var == nullptr) {
+        continue;
+      }
+      for (const VarNode* root : get_roots(var)) {
+        for (int reader : readers[root]) {
+          if (reader < i) {
+            target = std::max(target, anchor[reader]);
+          }
+        }
+      }
+    }
+    if (target + 1 < i) {
+      anchor[i] = target;
+      moved[i] = true;
+      moved_after[target + 1].push_back(i);
+    }
+  }
+
+  Expr body = LetList::With([&](LetList* ll) {
+    for (int i : moved_after[0]) {
+      ll->Push(vars[i], values[i]);
+    }
+    for (int i = 0; i < n; ++i) {
+      if (!moved[i]) {
+        ll->Push(vars[i], values[i]);
+      }
+      for (int j : moved_after[i + 1]) {
+        ll->Push(vars[j], values[j]);
+      }
+    }
+    return ret;
+  });
+  return Function(func->params, body, func->ret_type, func->type_params, func->attrs);
+}
+
+}  // namespace optimizer_in_backward
+
+Pass OptimizerInBackward() {
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
+                                                                             PassContext pc) {
+    return optimizer_in_backward::OptimizerInBackward(f);
+  };
+  return CreateRAFFunctionPass(pass_func, 0, "OptimizerInBackward", {});
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.OptimizerInBackward").set_body_typed(OptimizerInBackward);
+
+}  // namespace pass
+}  // namespace raf
@@ -0,0 +1,179 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file partition_parameter.cc
+ * \brief Given a model after AutoDiff and InlineBackward, this pass performs ZeRO-3:
+ * The selected parameters are replaced with their partitions (the first axis is partitioned
+ * to 1/n with zero-padding), and the complete parameters are all-gathered right before they
+ * are used in the forward and the backward respectively. The all-gather of a parameter is
+ * prefetched one use ahead, so that it can be overlapped with the computation of the previous
+ * layer when collectives are scheduled to the communication stream (e.g., by EnforceSync).
+ * The gathered parameters are dead after their last use in each segment, so they are freed
+ * by the memory planning instead of living through the whole training step.
+ */
+#include <algorithm>
+#include "raf/pass.h"
+
+#include "./common.h"
+
+namespace raf {
+namespace pass {
+namespace partition_parameter {
+
+/*! \brief The uses of a parameter in either the forward or the backward. */
+struct Segment {
+  /*! \brief The index of the parameter in the function. */
+  int param_idx;
+  /*! \brief The let-binding indices which use the parameter. */
+  std::vector<int> uses;
+  /*! \brief The let-binding index to insert the all-gather. */
+  int gather_at;
+};
+
+class ParameterPartitioner {
+ public:
+  ParameterPartitioner(int n_part, const Function& func) : n_part_(n_part), func_(func) {
+  }
+
+  /*! \brief Partition the parameters of the given indices. */
+  Function Partition(const Array<Integer>& param_indices) {
+    if (param_indices.empty() || n_part_ <= 1) {
+      return func_;
+    }
+    auto ell = ExplicitLetList::make(func_->body);
+    if (ell->vars.empty()) {
+      return func_;
+    }
+
+    // Replace the selected parameters with their partitions.
+    Array<Var> new_params{func_->params};
+    std::unordered_map<const VarNode*, int> param_map;
+    for (auto idx : param_indices) {
+      CHECK_LT(idx->value, func_->params.size()) << "Parameter index out of range: " << idx;
+      auto param = func_->params[idx->value];
+      auto ttype = param->checked_type().as<TensorTypeNode>();
+      CHECK(ttype != nullptr) << "Expected a tensor parameter, but got " << param->checked_type();
+      CHECK(!ttype->shape.empty()) << "Cannot partition a scalar parameter " << param;
+      auto dim0 = ttype->shape[0].as<IntImmNode>();
+      CHECK(dim0 != nullptr) << "Do not support dynamic shape yet";
+      Array<PrimExpr> shape{ttype->shape};
+      shape.Set(0, Integer((dim0->value + n_part_ - 1) / n_part_));
+      dim0_lengths_[idx->value] = dim0->value;
+      new_params.Set(idx->value, MakeVar(param->name_hint() + "_part",
+                                         TensorType(shape, ttype->dtype)));
+      param_map[param.get()] = idx->value;
+    }
+
+    // Assume output is a tuple of (forward out, (grads, ...)), so the forward ends at the
+    // binding of the forward output. Otherwise the whole function is treated as forward.
+    int n = ell->vars.size();
+    int fwd_end = n - 1;
+    if (auto ret = ell->exprs.back().as<TupleNode>()) {
+      if (ret->fields.size() == 2U && ret->fields[0]->IsInstance<VarNode>()) {
+        auto it = std::find(ell->vars.begin(), ell->vars.end(), Downcast<Var>(ret->fields[0]));
+        if (it != ell->vars.end()) {
+          fwd_end = it - ell->vars.begin();
+        }
+      }
+    }
+
+    // Collect the forward and backward uses of each parameter.
+    std::map<std::pair<int, bool>, Segment> segment_map;
+    for (int i = 0; i < n; ++i) {
+      for (const auto& var : FreeVars(ell->exprs[i])) {
+        auto it = param_map.find(var.get());
+        if (it != param_map.end()) {
+          auto& seg = segment_map[{it->second, i > fwd_end}];
+          seg.param_idx = it->second;
+          seg.uses.push_back(i);
+        }
+      }
+    }
+    std::vector<Segment> segments;
+    for (auto& kv : segment_map) {
+      segments.push_back(kv.second);
+    }
+    std::stable_sort(segments.begin(), segments.end(), [](const Segment& a, const Segment& b) {
+      return a.uses[0] < b.uses[0];
+    });
+
+    // Prefetch the parameter of each segment right before the first use of the previous one.
+    std::unordered_map<int, std::vector<const Segment*>> gathers;
+    std::unordered_map<int, Map<Var, Expr>> gathered;
+    for (size_t i = 0; i < segments.size(); ++i) {
+      auto& seg = segments[i];
+      seg.gather_at = (i == 0) ? seg.uses[0] : segments[i - 1].uses[0];
+      gathers[seg.gather_at].push_back(&seg);
+    }
+
+    // Rebuild the let list with all-gathers inserted.
+    std::unique_ptr<ExplicitLetList> new_ell = std::make_unique<ExplicitLetList>();
+    for (int i = 0; i < n; ++i) {
+      for (auto seg : gathers[i]) {
+        auto full = GenAllGather(new_ell.get(), seg->param_idx, new_params[seg->param_idx]);
+        for (auto use : seg->uses) {
+          gathered[use].Set(func_->params[seg->param_idx], full);
+        }
+      }
+      auto expr = ell->exprs[i];
+      if (gathered.count(i)) {
+        expr = Substitute(expr, gathered[i]);
+      }
+      new_ell->Push(ell->vars[i], expr);
+    }
+    new_ell->ret = ell->ret;
+    return Function(new_params, new_ell->AsExpr(), func_->ret_type, {}, func_->attrs);
+  }
+
+ private:
+  /*!
+   * \brief Generate the all-gather of a partitioned parameter. The desired IR is:
+   * let %1 = _allgather(%p_part, 0);
+   * let %2 = strided_slice(%1, [0], [dim0], [1]); // Remove the zero-padding if needed.
+   */
+  Var GenAllGather(ExplicitLetList* ell, int param_idx, const Var& part) {
+    static const Op& allgather_op = Op::Get("raf.op._allgather");
+    static const Op& slice_op = Op::Get("raf.op.strided_slice");
+    const auto& param = func_->params[param_idx];
+    auto out = MakeVar(param->name_hint() + "_gather", {});
+    ell->Push(out, Call(allgather_op, {part, MakeConstant(ScalarValue::make(0)),
+                                       MakeConstant(NullValue<Value>())}));
+    int64_t dim0_length = dim0_lengths_[param_idx];
+    if (dim0_length % n_part_ != 0) {
+      auto sliced = MakeVar(param->name_hint() + "_full", {});
+      auto begin = MakeConstant(TupleValue::make({ScalarValue::make(0)}));
+      auto end = MakeConstant(TupleValue::make({ScalarValue::make(dim0_length)}));
+      auto strides = MakeConstant(TupleValue::make({ScalarValue::make(1)}));
+      ell->Push(sliced, Call(slice_op, {out, begin, end, strides,
+                                        MakeConstant(StringValue::make("end"))}));
+      out = sliced;
+    }
+    return out;
+  }
+
+  /*! \brief The expected number of partitions. */
+  int n_part_;
+  /*! \brief The target function. */
+  Function func_;
+  /*! \brief Mapping from the parameter index to the length of its first axis. */
+  std::unordered_map<int, int64_t> dim0_lengths_;
+};
+
+}  // namespace partition_parameter
+
+Pass PartitionParameter(int n_part, Array<Integer> param_indices) {
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
+                                                                             PassContext pc) {
+    return partition_parameter::ParameterPartitioner(n_part, f).Partition(param_indices);
+  };
+  auto partition_parameter = CreateRAFFunctionPass(pass_func, 0, "PartitionParameterFunc", {});
+  return RAFSequential({InferType(), partition_parameter, EraseType()}, "PartitionParameter");
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.PartitionParameter").set_body_typed(PartitionParameter);
+
+}  // namespace pass
+}  // namespace raf
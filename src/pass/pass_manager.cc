@@ -8,11 +8,25 @@
  * \brief Infrastructure for transformation passes.
  */
 
+#include <sys/resource.h>
+#include <unistd.h>
 #include <tvm/ir/transform.h>
 #include <tvm/node/repr_printer.h>
+#include <tvm/relay/expr_functor.h>
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
 
 #include "raf/pass.h"
 #include "raf/pass_manager.h"
+#include "raf/profiler.h"
 #include "raf/registry.h"
 
 namespace raf {
@@ -87,6 +101,165 @@ const RAFSequentialNode* RAFSequential::operator->() const {
   return static_cast<const RAFSequentialNode*>(get());
 }
 
+/*! \brief The compile-time profile of a pass. */
+struct PassProfileEntry {
+  std::string name;
+  /*! \brief The nesting depth of the pass in the sequential passes. */
+  int depth;
+  /*! \brief The start and end time in microseconds. */
+  uint64_t start;
+  uint64_t end;
+  /*! \brief The peak RSS of the process in KBs before and after the pass. */
+  int64_t peak_rss_before;
+  int64_t peak_rss_after;
+  /*! \brief The RSS of the process in KBs after the pass, which excludes the released memory. */
+  int64_t rss_after;
+  /*! \brief The number of IR nodes in the module before and after the pass. */
+  int64_t nodes_before;
+  int64_t nodes_after;
+};
+
+/*! \brief Count the unique expression nodes of all functions in a module. */
+class NodeCounter : public tvm::relay::MixedModeVisitor {
+ public:
+  int64_t Count(const IRModule& mod) {
+    for (const auto& it : mod->functions) {
+      if (it.second.as<FunctionNode>()) {
+        VisitExpr(Downcast<Function>(it.second));
+      }
+    }
+    return num_nodes_;
+  }
+
+  void VisitLeaf(const Expr& expr) final {
+    // The let nodes are counted when their chains are expanded.
+    if (!expr.as<LetNode>()) {
+      num_nodes_++;
+    }
+    MixedModeVisitor::VisitLeaf(expr);
+  }
+
+  void VisitExpr_(const LetNode* op) final {
+    // Visit the let chains iteratively, which may be too long for recursion.
+    auto pre_visit = [this](const LetNode* op) {
+      this->VisitExpr(op->var);
+      this->VisitExpr(op->value);
+    };
+    auto post_visit = [this](const LetNode* op) {
+      this->VisitExpr(op->body);
+      this->visit_counter_[op] += 1;
+      num_nodes_++;
+    };
+    tvm::relay::ExpandANormalForm(op, pre_visit, post_visit);
+  }
+
+ private:
+  int64_t num_nodes_ = 0;
+};
+
+/*!
+ * \brief The compile-time profiler of the passes run by RAFSequential. It records the wall time,
+ * the peak RSS delta and the IR node count before and after every pass. When the runtime
+ * profiler is also enabled, the passes are added to it in the "Pass" category.
+ */
+class PassProfiler {
+ public:
+  static PassProfiler* Get() {
+    static PassProfiler pass_profiler;
+    return &pass_profiler;
+  }
+
+  bool enabled = false;
+
+  IRModule Run(const Pass& pass, IRModule mod, const PassContext& pass_ctx) {
+    if (!enabled) {
+      return pass(std::move(mod), pass_ctx);
+    }
+    PassProfileEntry entry;
+    entry.name = pass->Info()->name;
+    entry.depth = depth_++;
+    entry.nodes_before = NodeCounter().Count(mod);
+    entry.peak_rss_before = PeakRSS();
+    entry.start = profiler::ProfileStat::NowInMicrosec();
+    size_t index = entries_.size();
+    entries_.push_back(entry);
+    mod = pass(std::move(mod), pass_ctx);
+    // Nested passes may have been appended, so the entry is updated by index.
+    auto& e = entries_[index];
+    e.end = profiler::ProfileStat::NowInMicrosec();
+    e.peak_rss_after = PeakRSS();
+    e.rss_after = CurrentRSS();
+    e.nodes_after = NodeCounter().Count(mod);
+    depth_--;
+    if (profiler::Profiler::Get()->IsProfiling(1)) {
+      profiler::Profiler::Get()->AddNewProfileStat(
+          "Pass", e.name, e.start, e.end,
+          {"peak_rss_delta_kb=" + std::to_string(e.peak_rss_after - e.peak_rss_before),
+           "rss_after_kb=" + std::to_string(e.rss_after),
+           "nodes_before=" + std::to_string(e.nodes_before),
+           "nodes_after=" + std::to_string(e.nodes_after)});
+    }
+    return mod;
+  }
+
+  /*! \brief Get the profiles in a table, where nested passes are indented. */
+  std::string GetTable() const {
+    std::ostringstream os;
+    os << std::setw(40) << std::left << "#Pass" << "\t" << std::setw(12) << std::left << "#Time(ms)"
+       << "\t" << std::setw(16) << std::left << "#PeakRSSDelta(MB)" << "\t" << std::setw(12)
+       << std::left << "#RSS(MB)" << "\t" << std::setw(12) << std::left << "#NodesBefore"
+       << "\t#NodesAfter" << std::endl;
+    for (const auto& e : entries_) {
+      os << std::setw(40) << std::left << std::string(2 * e.depth, ' ') + e.name << "\t"
+         << std::setw(12) << std::left << std::fixed << std::setprecision(3)
+         << (e.end - e.start) / 1000.0 << "\t" << std::setw(16) << std::left
+         << (e.peak_rss_after - e.peak_rss_before) / 1024.0 << "\t" << std::setw(12)
+         << std::left << e.rss_after / 1024.0 << "\t" << std::setw(12) << std::left
+         << e.nodes_before << "\t" << e.nodes_after << std::endl;
+    }
+    return os.str();
+  }
+
+  /*! \brief Get the profiles as a list of [name, depth, time_ms, peak_rss_delta_mb,
+   * nodes_before, nodes_after, rss_mb]. */
+  Array<Array<ObjectRef>> GetEntries() const {
+    Array<Array<ObjectRef>> ret;
+    for (const auto& e : entries_) {
+      ret.push_back({String(e.name), Integer(e.depth),
+                     FloatImm(DataType::Float(64), (e.end - e.start) / 1000.0),
+                     FloatImm(DataType::Float(64), (e.peak_rss_after - e.peak_rss_before) / 1024.0),
+                     Integer(e.nodes_before), Integer(e.nodes_after),
+                     FloatImm(DataType::Float(64), e.rss_after / 1024.0)});
+    }
+    return ret;
+  }
+
+  void Reset() {
+    entries_.clear();
+  }
+
+ private:
+  /*! \brief The peak resident set size of the process in KBs. */
+  static int64_t PeakRSS() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+  }
+
+  /*! \brief The current resident set size of the process in KBs, or 0 if unavailable. */
+  static int64_t CurrentRSS() {
+    std::ifstream statm("/proc/self/statm");
+    int64_t size = 0, resident = 0;
+    if (!(statm >> size >> resident)) {
+      return 0;
+    }
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+  }
+
+  std::vector<PassProfileEntry> entries_;
+  int depth_ = 0;
+};
+
 inline Pass GetPass(const String& pass_name) {
   const PackedFunc* f;
   if (pass_name.operator std::string().find("raf.pass_.") != std::string::npos) {
@@ -98,25 +271,43 @@ inline Pass GetPass(const String& pass_name) {
   return (*f)();
 }
 
+/*!
+ * \brief Return the heap memory freed by the previous pass to the OS. The passes create a new
+ * version of the IR and drop the previous one, but the allocator keeps the freed pages, so the
+ * host RSS keeps the peak of every pass in the sequence without trimming.
+ */
+inline void ReleaseFreedMemory() {
+#ifdef __GLIBC__
+  malloc_trim(0);
+#endif
+}
+
 // TODO(zhiics): we currenlty only sequentially execute each pass in
 // a RAFSequential without the consideration of their orders. The phase
 // ordering problem needs to be handled in the future.
 IRModule RAFSequentialNode::operator()(IRModule mod, const PassContext& pass_ctx) const {
+  bool release_memory = pass_ctx->GetConfig<Bool>("raf.pass.release_memory", Bool(false)).value();
   for (const Pass& pass : passes) {
     ICHECK(pass.defined()) << "Found undefined pass for optimization.";
     const PassInfo& pass_info = pass->Info();
     if (!pass_ctx.PassEnabled(pass_info)) continue;
     // resolve dependencies
     for (const auto& it : pass_info->required) {
-      mod = GetPass(it)(std::move(mod), pass_ctx);
+      mod = PassProfiler::Get()->Run(GetPass(it), std::move(mod), pass_ctx);
+    }
+    mod = PassProfiler::Get()->Run(pass, std::move(mod), pass_ctx);
+    if (release_memory) {
+      ReleaseFreedMemory();
     }
-    mod = pass(std::move(mod), pass_ctx);
   }
   return mod;
 }
 
 RAF_REGISTER_OBJECT_REFLECT(RAFSequentialNode);
 
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.pass.release_memory", Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.pass.num_threads", Integer);
+
 class RAFFunctionPass;
 
 /*!
@@ -140,6 +331,9 @@ class RAFFunctionPassNode : public PassNode {
    */
   TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func;
 
+  /*! \brief Whether `pass_func` can transform different functions of a module concurrently. */
+  bool thread_safe = false;
+
   RAFFunctionPassNode() = default;
 
   void VisitAttrs(tvm::AttrVisitor* v) {
@@ -183,18 +377,21 @@ class RAFFunctionPass : public Pass {
    * \brief The constructor
    * \param pass_func The packed function which implements a pass.
    * \param pass_info The pass info.
+   * \param thread_safe Whether the functions can be transformed concurrently.
    */
   RAFFunctionPass(TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func,
-                  PassInfo pass_info);
+                  PassInfo pass_info, bool thread_safe = false);
 
   RAF_OBJECT_REF(RAFFunctionPass, Pass, RAFFunctionPassNode);
 };
 
 RAFFunctionPass::RAFFunctionPass(
-    TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func, PassInfo pass_info) {
+    TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func, PassInfo pass_info,
+    bool thread_safe) {
   auto n = make_object<RAFFunctionPassNode>();
   n->pass_func = std::move(pass_func);
   n->pass_info = std::move(pass_info);
+  n->thread_safe = thread_safe;
   data_ = std::move(n);
 }
 
@@ -210,14 +407,61 @@ IRModule RAFFunctionPassNode::operator()(IRModule mod, const PassContext& pass_c
   // Execute the pass function and return a new module.
   IRModule updated_mod =
       IRModule(mod->functions, mod->type_definitions, mod->Imports(), mod->source_map);
+  // Drop the input module, so that the function map is updated in place instead of copied, and
+  // the previous functions are freed once replaced if the caller does not hold them.
+  mod = IRModule();
 
+  // The updates are collected in the order of the module, so that the result is deterministic
+  // no matter whether the functions are transformed in parallel.
   std::vector<std::pair<GlobalVar, Function>> updates;
+  std::vector<size_t> todo;
   for (const auto& it : updated_mod->functions) {
     // only picks up relay::Function
     if (auto* n = it.second.as<FunctionNode>()) {
       Function func = GetRef<Function>(n);
-      auto updated_func = SkipFunction(func) ? func : pass_func(func, updated_mod, pass_ctx);
-      updates.push_back({it.first, updated_func});
+      if (!SkipFunction(func)) {
+        todo.push_back(updates.size());
+      }
+      updates.push_back({it.first, func});
+    }
+  }
+
+  int num_threads = 1;
+  if (thread_safe && todo.size() > 1) {
+    num_threads = pass_ctx->GetConfig("raf.pass.num_threads", Integer(0)).value()->value;
+    if (num_threads <= 0) {
+      num_threads = std::max(1U, std::thread::hardware_concurrency());
+    }
+    num_threads = std::min<int>(num_threads, todo.size());
+  }
+  if (num_threads > 1) {
+    // The passes read the configs from pass_ctx, because PassContext::Current() is thread-local.
+    std::vector<std::string> errors(todo.size());
+    std::atomic<size_t> next_func{0};
+    auto worker = [&]() {
+      for (size_t i = next_func++; i < todo.size(); i = next_func++) {
+        auto& update = updates[todo[i]];
+        try {
+          update.second = pass_func(update.second, updated_mod, pass_ctx);
+        } catch (const dmlc::Error& e) {
+          errors[i] = e.what();
+        }
+      }
+    };
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_threads; ++i) {
+      threads.emplace_back(worker);
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    for (size_t i = 0; i < todo.size(); ++i) {
+      CHECK(errors[i].empty()) << "Failed to run " << pass_info->name << " on "
+                               << updates[todo[i]].first->name_hint << ": " << errors[i];
+    }
+  } else {
+    for (size_t i : todo) {
+      updates[i].second = pass_func(updates[i].second, updated_mod, pass_ctx);
     }
   }
 
@@ -235,9 +479,9 @@ bool RAFFunctionPassNode::SkipFunction(const Function& func) const {
 
 Pass CreateRAFFunctionPass(
     const TypedPackedFunc<Function(Function, IRModule, PassContext)>& pass_func, int opt_level,
-    String name, tvm::Array<String> required) {
+    String name, tvm::Array<String> required, bool thread_safe) {
   PassInfo pass_info = PassInfo(opt_level, name, required);
-  return RAFFunctionPass(pass_func, pass_info);
+  return RAFFunctionPass(pass_func, pass_info, thread_safe);
 }
 
 RAF_REGISTER_OBJECT_REFLECT(RAFFunctionPassNode);
@@ -263,6 +507,22 @@ RAF_REGISTER_GLOBAL("raf.pass_.RAFSequential").set_body([](TVMArgs args, TVMRetV
   *ret = RAFSequential(passes, pass_info);
 });
 
+RAF_REGISTER_GLOBAL("raf.pass_.EnablePassProfiler").set_body_typed([]() {
+  PassProfiler::Get()->enabled = true;
+});
+RAF_REGISTER_GLOBAL("raf.pass_.DisablePassProfiler").set_body_typed([]() {
+  PassProfiler::Get()->enabled = false;
+});
+RAF_REGISTER_GLOBAL("raf.pass_.ResetPassProfiler").set_body_typed([]() {
+  PassProfiler::Get()->Reset();
+});
+RAF_REGISTER_GLOBAL("raf.pass_.GetPassProfile").set_body_typed([]() {
+  return PassProfiler::Get()->GetTable();
+});
+RAF_REGISTER_GLOBAL("raf.pass_.GetPassProfileEntries").set_body_typed([]() {
+  return PassProfiler::Get()->GetEntries();
+});
+
 TVM_STATIC_IR_FUNCTOR(ReprPrinter, vtable)
     .set_dispatch<RAFSequentialNode>([](const ObjectRef& ref, ReprPrinter* p) {
       auto* node = static_cast<const RAFSequentialNode*>(ref.get());
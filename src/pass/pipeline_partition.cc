@@ -0,0 +1,277 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file pipeline_partition.cc
+ * \brief Partition an ANF function into pipeline stages. The let-bindings are cut into
+ * consecutive stages with balanced estimated GFLOPS, and each rank keeps only the bindings of its
+ * own stage. The tensors crossing a cut are received from the previous stage with _recv, and are
+ * sent to the next stage with _send. A tensor used by a later stage is relayed through the
+ * stages in between, so every rank only communicates with its neighbors.
+ */
+#include <algorithm>
+#include "raf/pass.h"
+#include "raf/device.h"
+
+#include "./common.h"
+#include "./estimate_flops.h"
+#include "../common/shape_utils.h"
+
+namespace raf {
+namespace pass {
+namespace pipeline_partition {
+
+constexpr float kMegaBytes = 1048576;
+
+/*! \brief The plan of the pipeline stages. */
+struct StagePlan {
+  /*! \brief The index of the first let-binding of each stage, followed by the total number. */
+  std::vector<int> begins;
+  /*! \brief The estimated GFLOPS of each stage. */
+  std::vector<float> gflops;
+  /*! \brief The estimated peak memory in MBs of each stage. */
+  std::vector<float> memory_mbs;
+};
+
+class PipelinePartitioner {
+ public:
+  PipelinePartitioner(const Function& func, const IRModule& mod)
+      : func_(func), ell_(ExplicitLetList::make(func->body)) {
+    int n = ell_->vars.size();
+    for (int i = 0; i < n; ++i) {
+      var_index_[ell_->vars[i].get()] = i;
+    }
+    // Record the last use of each let var. The return var is used after all bindings.
+    last_use_.resize(n, -1);
+    for (int i = 0; i < n; ++i) {
+      for (const auto& var : FreeVars(ell_->exprs[i])) {
+        auto it = var_index_.find(var.get());
+        if (it != var_index_.end()) {
+          last_use_[it->second] = i;
+        }
+      }
+    }
+    if (var_index_.count(ell_->ret.get())) {
+      last_use_[var_index_[ell_->ret.get()]] = n;
+    }
+
+    // Estimate the cost of each let-binding. Fall back to an uniform cost of calls if the
+    // target device is undefined.
+    costs_.resize(n, 0);
+    auto device = Device::Current();
+    if (device.device_type() == DevType::kUnknown() && device.device_id() == -1) {
+      LOG(WARNING) << "Target device is undefined. Use the number of ops as the stage cost.";
+      for (int i = 0; i < n; ++i) {
+        costs_[i] = ell_->exprs[i]->IsInstance<CallNode>() ? 1.0f : 0.0f;
+      }
+    } else {
+      auto flops = estimate_flops::FLOPSEstimater().Run(device, func, mod);
+      for (int i = 0; i < n; ++i) {
+        auto it = flops.find(ell_->vars[i]);
+        costs_[i] = (it != flops.end()) ? it->second : 0.0f;
+      }
+    }
+  }
+
+  /*! \brief Cut the let-bindings into the given number of stages with balanced costs. */
+  StagePlan Plan(int num_stages) {
+    int n = ell_->vars.size();
+    CHECK_GE(num_stages, 1) << "Expected at least 1 stage, but got " << num_stages;
+    CHECK_GE(n, num_stages) << "Cannot partition " << n << " bindings to " << num_stages
+                            << " stages";
+    float total = 0;
+    for (auto cost : costs_) {
+      total += cost;
+    }
+
+    StagePlan plan;
+    plan.begins.push_back(0);
+    float acc = 0;
+    for (int i = 0; i < n && static_cast<int>(plan.begins.size()) < num_stages; ++i) {
+      acc += costs_[i];
+      int stage = plan.begins.size();
+      int remain = num_stages - stage;
+      // Cut after the binding once the stage reaches its share, and leave at least one
+      // binding for each remaining stage. Tuples cannot be sent, so cuts require tensors.
+      bool reach = acc >= total * stage / num_stages || n - (i + 1) <= remain;
+      if (reach && i + 1 < n && CanCut(i + 1)) {
+        plan.begins.push_back(i + 1);
+      }
+    }
+    CHECK_EQ(plan.begins.size(), num_stages)
+        << "Cannot find " << num_stages << " valid cuts, because non-tensor values cross them";
+    plan.begins.push_back(n);
+
+    for (int s = 0; s < num_stages; ++s) {
+      float gflops = 0;
+      for (int i = plan.begins[s]; i < plan.begins[s + 1]; ++i) {
+        gflops += costs_[i];
+      }
+      plan.gflops.push_back(gflops);
+      plan.memory_mbs.push_back(EstimateMemory(plan.begins[s], plan.begins[s + 1]));
+    }
+    return plan;
+  }
+
+  /*! \brief Generate the function of the given stage. */
+  Function Partition(int num_stages, int stage) {
+    static const Op& send_op = Op::Get("raf.op._send");
+    static const Op& recv_op = Op::Get("raf.op._recv");
+    CHECK(stage >= 0 && stage < num_stages)
+        << "Stage " << stage << " is out of range [0, " << num_stages << ")";
+    if (num_stages == 1) {
+      return func_;
+    }
+    auto plan = Plan(num_stages);
+    int begin = plan.begins[stage], end = plan.begins[stage + 1];
+
+    std::unique_ptr<ExplicitLetList> ell = std::make_unique<ExplicitLetList>();
+    Expr token = MakeConstant(NullValue<Value>());
+    for (int idx : LiveAt(begin)) {
+      const auto& var = ell_->vars[idx];
+      auto ttype = var->checked_type().as<TensorTypeNode>();
+      Array<Value> shape;
+      for (auto dim : ttype->shape) {
+        shape.push_back(ScalarValue::make(dim.as<IntImmNode>()->value));
+      }
+      auto dtype = MakeConstant(StringValue::make(DLDataType2String(ttype->dtype)));
+      ell->Push(var, Call(recv_op, {MakeConstant(ScalarValue::make(stage - 1)),
+                                    MakeConstant(TupleValue::make(shape)), dtype, token}));
+      token = var;
+    }
+    for (int i = begin; i < end; ++i) {
+      ell->Push(ell_->vars[i], ell_->exprs[i]);
+    }
+    if (stage == num_stages - 1) {
+      ell->ret = ell_->ret;
+    } else {
+      token = MakeConstant(NullValue<Value>());
+      auto live_out = LiveAt(end);
+      CHECK(!live_out.empty()) << "Stage " << stage << " has nothing to send to the next stage";
+      for (int idx : live_out) {
+        auto send_var = MakeVar("send", {});
+        auto peer = MakeConstant(ScalarValue::make(stage + 1));
+        ell->Push(send_var, Call(send_op, {ell_->vars[idx], peer, token}));
+        token = send_var;
+      }
+      ell->ret = Downcast<Var>(token);
+    }
+    return Function(func_->params, ell->AsExpr(), {}, {}, func_->attrs);
+  }
+
+ private:
+  /*! \brief The let vars defined before the given binding and used since the binding. */
+  std::vector<int> LiveAt(int pos) {
+    std::vector<int> live;
+    for (int i = 0; i < pos; ++i) {
+      if (last_use_[i] >= pos) {
+        live.push_back(i);
+      }
+    }
+    return live;
+  }
+
+  /*! \brief Whether all the values crossing the cut before the given binding are tensors. */
+  bool CanCut(int pos) {
+    for (int idx : LiveAt(pos)) {
+      auto ttype = ell_->vars[idx]->checked_type().as<TensorTypeNode>();
+      if (ttype == nullptr) {
+        return false;
+      }
+      for (auto dim : ttype->shape) {
+        if (!dim->IsInstance<IntImmNode>()) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  /*! \brief Estimate the peak memory of the stage, including the used parameters. */
+  float EstimateMemory(int begin, int end) {
+    float param_mbs = 0;
+    std::unordered_set<const VarNode*> params;
+    for (const auto& param : func_->params) {
+      params.insert(param.get());
+    }
+    std::unordered_set<const VarNode*> used_params;
+    for (int i = begin; i < end; ++i) {
+      for (const auto& var : FreeVars(ell_->exprs[i])) {
+        if (params.count(var.get()) && used_params.insert(var.get()).second) {
+          param_mbs += common::shape_utils::BytesCompactType(var->checked_type()) / kMegaBytes;
+        }
+      }
+    }
+
+    // The received tensors live until their last use, and so do the produced tensors.
+    float curr_mbs = 0, peak_mbs = 0;
+    std::vector<std::vector<int>> frees(end - begin + 1);
+    auto alloc = [&](int idx) {
+      curr_mbs += common::shape_utils::BytesCompactType(ell_->vars[idx]->checked_type()) /
+                  kMegaBytes;
+      // A dead binding is freed right after it is produced.
+      frees[std::min(std::max(last_use_[idx], idx), end) - begin].push_back(idx);
+    };
+    for (int idx : LiveAt(begin)) {
+      alloc(idx);
+    }
+    peak_mbs = curr_mbs;
+    for (int i = begin; i < end; ++i) {
+      if (ell_->exprs[i]->IsInstance<CallNode>()) {
+        alloc(i);
+      }
+      peak_mbs = std::max(peak_mbs, curr_mbs);
+      for (int idx : frees[i - begin]) {
+        curr_mbs -= common::shape_utils::BytesCompactType(ell_->vars[idx]->checked_type()) /
+                    kMegaBytes;
+      }
+    }
+    return param_mbs + peak_mbs;
+  }
+
+  /*! \brief The target function. */
+  Function func_;
+  /*! \brief The explicit let list of the target function. */
+  std::unique_ptr<ExplicitLetList> ell_;
+  /*! \brief Mapping from a let var to its binding index. */
+  std::unordered_map<const VarNode*, int> var_index_;
+  /*! \brief The index of the last binding using each let var. */
+  std::vector<int> last_use_;
+  /*! \brief The estimated cost of each let-binding. */
+  std::vector<float> costs_;
+};
+
+}  // namespace pipeline_partition
+
+Pass PipelinePartition(int num_stages, int stage) {
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
+                                                                             PassContext pc) {
+    return pipeline_partition::PipelinePartitioner(f, m).Partition(num_stages, stage);
+  };
+  auto pipeline_partition = CreateRAFFunctionPass(pass_func, 0, "PipelinePartitionFunc", {});
+  return RAFSequential({InferType(), pipeline_partition, EraseType()}, "PipelinePartition");
+}
+
+/*!
+ * \brief Estimate the pipeline stages of the main function.
+ * \return An array of [begin, end, GFLOPS, memory in MBs] of each stage.
+ */
+Array<Array<ObjectRef>> EstimatePipelineStages(const IRModule& mod, int num_stages) {
+  auto func = Downcast<Function>(mod->Lookup("main"));
+  auto plan = pipeline_partition::PipelinePartitioner(func, mod).Plan(num_stages);
+  Array<Array<ObjectRef>> ret;
+  for (int s = 0; s < num_stages; ++s) {
+    ret.push_back({Integer(plan.begins[s]), Integer(plan.begins[s + 1]),
+                   FloatImm(DataType::Float(32), plan.gflops[s]),
+                   FloatImm(DataType::Float(32), plan.memory_mbs[s])});
+  }
+  return ret;
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.PipelinePartition").set_body_typed(PipelinePartition);
+RAF_REGISTER_GLOBAL("raf.pass_.EstimatePipelineStages").set_body_typed(EstimatePipelineStages);
+
+}  // namespace pass
+}  // namespace raf
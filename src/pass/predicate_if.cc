@@ -0,0 +1,182 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/pass/predicate_if.cc
+ * \brief Convert the if expressions whose branches are small and free of side effects into
+ * selects. Both branches are evaluated and the result is picked by raf.op.where on the device, so
+ * the VM does not copy the condition to the host and synchronize the device at the If instruction.
+ */
+#include "raf/op.h"
+#include "raf/ir.h"
+#include "raf/pass.h"
+
+namespace raf {
+namespace pass {
+namespace predicate_if {
+
+using namespace raf::ir;
+using namespace raf::op;
+
+/*!
+ * \brief Count the ops of a branch. A branch can only be predicated if it only calls ops without
+ * side effects, and does not have nested control flow or closures.
+ */
+class BranchChecker : public ExprVisitor {
+ public:
+  /*!
+   * \brief Count the ops of the given branch.
+   * \param expr The branch.
+   * \return The number of ops, or -1 if the branch cannot be predicated.
+   */
+  int Count(const Expr& expr) {
+    num_ops_ = 0;
+    predicable_ = true;
+    VisitExpr(expr);
+    return predicable_ ? num_ops_ : -1;
+  }
+
+  void VisitExpr(const Expr& expr) override {
+    if (!predicable_) return;
+    ExprVisitor::VisitExpr(expr);
+  }
+
+  void VisitExpr_(const LetNode* op) override {
+    auto pre_visit = [](const LetNode* op) {};
+    auto post_visit = [this](const LetNode* op) {
+      VisitExpr(op->value);
+      VisitExpr(op->body);
+      visit_counter_[op] += 1;
+    };
+    ExpandANormalForm(op, pre_visit, post_visit);
+  }
+
+  void VisitExpr_(const CallNode* op) override {
+    static auto fside_effect = Op::GetAttrMap<TRAFSideEffect>("TRAFSideEffect");
+    auto op_node = op->op.as<OpNode>();
+    if (op_node == nullptr || fside_effect.get(GetRef<Op>(op_node), false)) {
+      predicable_ = false;
+      return;
+    }
+    ++num_ops_;
+    ExprVisitor::VisitExpr_(op);
+  }
+
+  void VisitExpr_(const IfNode* op) override {
+    predicable_ = false;
+  }
+
+  void VisitExpr_(const FunctionNode* op) override {
+    predicable_ = false;
+  }
+
+  void VisitExpr_(const RefCreateNode* op) override {
+    predicable_ = false;
+  }
+
+  void VisitExpr_(const RefReadNode* op) override {
+    predicable_ = false;
+  }
+
+  void VisitExpr_(const RefWriteNode* op) override {
+    predicable_ = false;
+  }
+
+ private:
+  /*! \brief The number of ops in the branch. */
+  int num_ops_;
+  /*! \brief Whether the branch can be predicated. */
+  bool predicable_;
+};
+
+/*! \brief Whether the value of the given type can be selected by raf.op.where. */
+bool IsSelectable(const Type& type) {
+  if (type.as<TensorTypeNode>()) {
+    return true;
+  }
+  if (auto tuple_type = type.as<TupleTypeNode>()) {
+    for (const auto& field : tuple_type->fields) {
+      if (!field.as<TensorTypeNode>()) {
+        return false;
+      }
+    }
+    return true;
+  }
+  return false;
+}
+
+class IfPredicator : public MixedModeMutator {
+ public:
+  explicit IfPredicator(int max_ops) : max_ops_(max_ops) {
+  }
+
+  Expr VisitExpr_(const FunctionNode* node) final {
+    if (node->HasNonzeroAttr(attr::kPrimitive)) {
+      return GetRef<Function>(node);
+    }
+    return ExprMutator::VisitExpr_(node);
+  }
+
+  Expr VisitExpr_(const IfNode* node) final {
+    auto cond = VisitExpr(node->cond);
+    auto true_branch = VisitExpr(node->true_branch);
+    auto false_branch = VisitExpr(node->false_branch);
+    if (!CanPredicate(node)) {
+      return If(cond, true_branch, false_branch, node->span);
+    }
+
+    static const Op& where_op = Op::Get("raf.op.where");
+    Var true_var = MakeVar("t", {});
+    Var false_var = MakeVar("f", {});
+    Expr select;
+    if (auto tuple_type = node->checked_type().as<TupleTypeNode>()) {
+      Array<Expr> fields;
+      for (size_t i = 0; i < tuple_type->fields.size(); ++i) {
+        fields.push_back(
+            Call(where_op, {cond, TupleGetItem(true_var, i), TupleGetItem(false_var, i)}));
+      }
+      select = Tuple(fields);
+    } else {
+      select = Call(where_op, {cond, true_var, false_var});
+    }
+    return Let(true_var, true_branch, Let(false_var, false_branch, select));
+  }
+
+ private:
+  /*! \brief Whether the if expression is small enough and its branches are safe to evaluate. */
+  bool CanPredicate(const IfNode* node) {
+    if (!node->checked_type_.defined() || !node->cond->checked_type_.defined()) {
+      return false;
+    }
+    auto cond_type = node->cond->checked_type().as<TensorTypeNode>();
+    if (cond_type == nullptr || !cond_type->shape.empty() || !IsSelectable(node->checked_type())) {
+      return false;
+    }
+    int true_ops = BranchChecker().Count(node->true_branch);
+    int false_ops = BranchChecker().Count(node->false_branch);
+    return true_ops >= 0 && false_ops >= 0 && true_ops + false_ops <= max_ops_;
+  }
+
+  /*! \brief The maximum number of ops of both branches that are evaluated unconditionally. */
+  int max_ops_;
+};
+
+}  // namespace predicate_if
+
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.predicate_if.max_ops", Integer);
+
+Pass PredicateIf() {
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
+                                                                             PassContext pc) {
+    int max_ops = pc->GetConfig("raf.predicate_if.max_ops", Integer(8)).value()->value;
+    return Downcast<Function>(predicate_if::IfPredicator(max_ops).Mutate(f));
+  };
+  return CreateRAFFunctionPass(pass_func, 1, "PredicateIf", {}, /*thread_safe=*/true);
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.PredicateIf").set_body_typed(PredicateIf);
+
+}  // namespace pass
+}  // namespace raf
@@ -0,0 +1,228 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file quantize.cc
+ * \brief The int8 post-training quantization of the dense layers. InstrumentQuantize returns the
+ * ranges of the dense inputs to calibrate them, Quantize inserts the quantize and dequantize ops
+ * with the calibrated scales, and FoldQuantize folds the dequantized dense into the int8 dense.
+ */
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+#include "raf/op.h"
+#include "raf/op_utils.h"
+#include "raf/ir.h"
+#include "raf/value.h"
+#include "raf/pass.h"
+#include "./let_list.h"
+
+namespace raf {
+namespace pass {
+namespace quantize {
+
+using namespace raf::ir;
+using namespace raf::op;
+using namespace raf::value;
+
+/*! \brief The lower bound of the ranges, so that all-zero tensors do not get zero scales. */
+constexpr double kMinRange = 1e-8;
+/*! \brief The maximal absolute value of the symmetric int8 range. */
+constexpr double kInt8Max = 127.0;
+
+inline bool IsFloat32(const Expr& expr) {
+  const auto* type = expr->checked_type_.as<TensorTypeNode>();
+  return type != nullptr && type->dtype == DataType::Float(32);
+}
+
+/*! \brief Whether the expr is a dense, i.e., x * w^T, of float32 matrices. */
+inline bool IsQuantizable(const Expr& expr) {
+  static const Op& dense = Op::Get("raf.op.dense");
+  static const Op& matmul_nt = Op::Get("raf.op.matmul_nt");
+  const auto* call = expr.as<CallNode>();
+  return call != nullptr && (call->op == dense || call->op == matmul_nt) &&
+         call->args.size() == 2U && IsFloat32(call->args[0]) && IsFloat32(call->args[1]);
+}
+
+/*!
+ * \brief Rebuild the let bindings of the function body, where each bound value is replaced by the
+ * result of the rewriter, which may push more bindings before it. Return the rebuilt body, whose
+ * result is also given by the finalizer.
+ */
+template <typename F, typename G>
+Expr RewriteBindings(const Function& func, F rewrite, G finalize) {
+  return LetList::With([&](LetList* ll) {
+    Expr expr = func->body;
+    while (const auto* let = expr.as<LetNode>()) {
+      ll->Push(let->var, rewrite(ll, let->value));
+      expr = let->body;
+    }
+    return finalize(ll, expr);
+  });
+}
+
+inline Expr MakeFalse() {
+  return MakeConstant(BoolValue::make(false));
+}
+
+/*! \brief Make a float32 scalar tensor, which is moved to the target device by AssignDevice. */
+Expr MakeScale(double value) {
+  Device cpu(DevType::kCPU(), 0);
+  auto array = tvm::runtime::NDArray::Empty({}, DataType::Float(32), cpu);
+  *static_cast<float*>(array->data) = static_cast<float>(value);
+  auto tv = TensorValue::Assemble(cpu, DType(DTypeCode::kFloat(), 32), std::vector<int64_t>{});
+  tv->tensor = std::move(array);
+  return MakeConstant(tv);
+}
+
+/*! \brief Return max(abs(x)) over the given axes, or all axes if empty. */
+Var PushAbsMax(LetList* ll, const Expr& x, const std::vector<int64_t>& axes) {
+  static const Op& abs = Op::Get("raf.op.abs");
+  static const Op& max = Op::Get("raf.op.max");
+  Var abs_x = ll->Push(Call(abs, {x}));
+  return ll->Push(
+      Call(max, {abs_x, MakeConstant(ArrayToIntTuple(axes)), MakeFalse(), MakeFalse()}));
+}
+
+Function InstrumentQuantize(const Function& func) {
+  std::vector<Expr> inputs;
+  Expr body = RewriteBindings(
+      func,
+      [&](LetList* ll, const Expr& value) {
+        if (IsQuantizable(value)) {
+          inputs.push_back(value.as<CallNode>()->args[0]);
+        }
+        return value;
+      },
+      [&](LetList* ll, const Expr& ret) {
+        Array<Expr> fields{ret};
+        for (const Expr& x : inputs) {
+          fields.push_back(PushAbsMax(ll, x, {}));
+        }
+        return ll->Push(Tuple(fields));
+      });
+  return Function(func->params, body, {}, func->type_params, func->attrs);
+}
+
+Function Quantize(const Function& func, const Array<FloatImm>& ranges) {
+  static const Op& quantize = Op::Get("raf.op._contrib_quantize");
+  static const Op& dequantize = Op::Get("raf.op._contrib_dequantize");
+  static const Op& maximum = Op::Get("raf.op.maximum");
+  static const Op& multiply = Op::Get("raf.op.multiply");
+  size_t index = 0;
+  auto fake_quantize = [](LetList* ll, const Expr& x, const Expr& scale, int64_t axis) {
+    Expr axis_expr = MakeConstant(ScalarValue::make(axis));
+    Var qx = ll->Push(Call(quantize, {x, scale, axis_expr}));
+    return ll->Push(Call(dequantize, {qx, scale, axis_expr}));
+  };
+  Expr body = RewriteBindings(
+      func,
+      [&](LetList* ll, const Expr& value) -> Expr {
+        if (!IsQuantizable(value)) {
+          return value;
+        }
+        CHECK_LT(index, ranges.size()) << "The ranges are fewer than the dense inputs";
+        const auto* call = value.as<CallNode>();
+        // The input is scaled per tensor by its calibrated range.
+        double range = std::max(ranges[index++]->value, kMinRange);
+        Var x = fake_quantize(ll, call->args[0], MakeScale(range / kInt8Max), -1);
+        // The weight is scaled per output channel by its own range, which is folded with the
+        // constant weights.
+        Var w_range = PushAbsMax(ll, call->args[1], {1});
+        w_range = ll->Push(Call(maximum, {w_range, MakeScale(kMinRange)}));
+        Var w_scale = ll->Push(Call(multiply, {w_range, MakeScale(1.0 / kInt8Max)}));
+        Var w = fake_quantize(ll, call->args[1], w_scale, 0);
+        return Call(call->op, {x, w});
+      },
+      [](LetList* ll, const Expr& ret) { return ret; });
+  CHECK_EQ(index, ranges.size()) << "The ranges are more than the dense inputs";
+  return Function(func->params, body, func->ret_type, func->type_params, func->attrs);
+}
+
+/*! \brief Get the dequantize call bound to the var, or nullptr if it is bound to others. */
+const CallNode* AsDequantize(const Expr& expr,
+                             const std::unordered_map<const VarNode*, Expr>& let_map) {
+  static const Op& dequantize = Op::Get("raf.op._contrib_dequantize");
+  const auto* var = expr.as<VarNode>();
+  if (var == nullptr || let_map.count(var) == 0) {
+    return nullptr;
+  }
+  const auto* call = let_map.at(var).as<CallNode>();
+  return call != nullptr && call->op == dequantize && call->args.size() == 3U ? call : nullptr;
+}
+
+inline int ScaleRank(const Expr& scale) {
+  const auto* type = scale->checked_type_.as<TensorTypeNode>();
+  return type != nullptr ? static_cast<int>(type->shape.size()) : -1;
+}
+
+Function FoldQuantize(const Function& func) {
+  static const Op& quantized_dense = Op::Get("raf.op._contrib_quantized_dense");
+  std::unordered_map<const VarNode*, Expr> let_map;
+  Expr expr = func->body;
+  while (const auto* let = expr.as<LetNode>()) {
+    let_map[let->var.get()] = let->value;
+    expr = let->body;
+  }
+  Expr body = RewriteBindings(
+      func,
+      [&](LetList* ll, const Expr& value) -> Expr {
+        if (!IsQuantizable(value)) {
+          return value;
+        }
+        const auto* call = value.as<CallNode>();
+        const CallNode* x = AsDequantize(call->args[0], let_map);
+        const CallNode* w = AsDequantize(call->args[1], let_map);
+        if (x == nullptr || w == nullptr || ScaleRank(x->args[1]) != 0) {
+          return value;
+        }
+        // The int32 products can only be rescaled per output channel, i.e., the rows of w.
+        int w_rank = ScaleRank(w->args[1]);
+        const auto* w_axis = w->args[2].as<ConstantNode>();
+        if (w_rank == 1 && w_axis != nullptr) {
+          int64_t axis = GetScalarValueData<int64_t>(Downcast<Value>(w_axis->value));
+          w_rank = axis == 0 || axis == -2 ? 0 : -1;
+        }
+        if (w_rank != 0) {
+          return value;
+        }
+        return Call(quantized_dense, {x->args[0], w->args[0], x->args[1], w->args[1]});
+      },
+      [](LetList* ll, const Expr& ret) { return ret; });
+  return Function(func->params, body, func->ret_type, func->type_params, func->attrs);
+}
+
+}  // namespace quantize
+
+Pass InstrumentQuantize() {
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
+                                                                             PassContext pc) {
+    return quantize::InstrumentQuantize(f);
+  };
+  return CreateRAFFunctionPass(pass_func, 0, "InstrumentQuantize", {"InferType"});
+}
+
+Pass Quantize(Array<FloatImm> ranges) {
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
+                                                                             PassContext pc) {
+    return quantize::Quantize(f, ranges);
+  };
+  return CreateRAFFunctionPass(pass_func, 0, "Quantize", {"InferType"});
+}
+
+Pass FoldQuantize() {
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
+                                                                             PassContext pc) {
+    return quantize::FoldQuantize(f);
+  };
+  return CreateRAFFunctionPass(pass_func, 0, "FoldQuantize", {"InferType"});
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.InstrumentQuantize").set_body_typed(InstrumentQuantize);
+RAF_REGISTER_GLOBAL("raf.pass_.Quantize").set_body_typed(Quantize);
+RAF_REGISTER_GLOBAL("raf.pass_.FoldQuantize").set_body_typed(FoldQuantize);
+
+}  // namespace pass
+}  // namespace raf
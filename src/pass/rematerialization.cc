@@ -223,7 +223,7 @@ class TensorInfos {
          << ((tensor_info->tuple_field_idx != -1)
                  ? " (tuple." + std::to_string(tensor_info->tuple_field_idx) + ")"
                  : "")
-         << ", GFLOPS: " << tensor_info->compute_cost
+         << ", Cost: " << tensor_info->compute_cost
          << ", LetVar: " << tensor_info->let_var->name_hint()
          << ", Size(MBs): " << tensor_info->size / 1048576.0
          << ", Workspace Size(MBs): " << tensor_info->workspace_size / 1048576.0
@@ -326,6 +326,44 @@ class Rematerializer : public ExprMutator {
     return os.str();
   }
 
+  /*!
+   * \brief Freeing the candidates with the lowest latency per byte first may pick several
+   * small tensors, while a single larger tensor could cover the required bytes with a lower
+   * total recompute latency. In this case, move that tensor to the end of the candidates
+   * (which are sorted from high to low costs), so it is freed first and alone.
+   * \param candidates The sorted candidates and their costs.
+   * \param latencies The recompute latency of each candidate.
+   * \param required The number of bytes to be freed.
+   */
+  void PreferSingleCandidate(std::vector<std::pair<std::shared_ptr<TensorInfo>, float>>* candidates,
+                             const std::unordered_map<const TensorInfo*, float>& latencies,
+                             int64_t required) {
+    // The total latency of freeing the candidates in order until the required bytes are met.
+    float total_latency = 0;
+    int64_t freed = 0;
+    for (auto it = candidates->rbegin(); it != candidates->rend() && freed < required; ++it) {
+      freed += it->first->size;
+      total_latency += latencies.at(it->first.get());
+    }
+    if (freed < required) {
+      return;
+    }
+
+    auto best = candidates->end();
+    for (auto it = candidates->begin(); it != candidates->end(); ++it) {
+      float latency = latencies.at(it->first.get());
+      if (it->first->size >= required && latency < total_latency) {
+        best = it;
+        total_latency = latency;
+      }
+    }
+    if (best != candidates->end()) {
+      auto cand = *best;
+      candidates->erase(best);
+      candidates->push_back(cand);
+    }
+  }
+
   /*! \brief Run the rematerialization algorithm and return the mutated function. */
   Expr Run() {
     // Initialize memory trace with parameter sizes.
@@ -475,6 +513,7 @@ class Rematerializer : public ExprMutator {
     if (curr_mem_trace_ > budget_) {
       // Find candidates to be rematerialized from the live tensors.
       std::vector<std::pair<std::shared_ptr<TensorInfo>, float>> candidate_n_scores;
+      std::unordered_map<const TensorInfo*, float> candidate_latencies;
       for (const auto tensor_info : tensor_infos_.GetLiveTensorInfos()) {
         // Skip argument and output tensors.
         // Conservatively, we choose not to free tensors that are just rematerialized, because they
@@ -485,10 +524,12 @@ class Rematerializer : public ExprMutator {
           continue;
         }
 
-        auto cost = EstimateRematCost(tensor_info->liveness_var, node);
+        float latency = 0;
+        auto cost = EstimateRematCost(tensor_info->liveness_var, node, 1, &latency);
         // Skip the tensors that cannot be rematerialized.
         if (cost != -1) {
           candidate_n_scores.push_back({tensor_info, cost});
+          candidate_latencies[tensor_info.get()] = latency;
         }
       }
 
@@ -501,6 +542,8 @@ class Rematerializer : public ExprMutator {
                   return (a.second == b.second) ? a.first->index > b.first->index
                                                 : a.second > b.second;
                 });
+      PreferSingleCandidate(&candidate_n_scores, candidate_latencies,
+                            curr_mem_trace_ - budget_);
       VERBOSE_LOG << "| |-Cands: " << DebugDumpCandidates(candidate_n_scores);
       while (curr_mem_trace_ > budget_) {
         // Mark a var (tensor) to be dead and remove its size from memory trace. This tensor
@@ -736,16 +779,17 @@ class Rematerializer : public ExprMutator {
   /*!
    * \brief Estimate the rematerialization cost of the given tensor (let_var). The cost is estimated
    * by the equation `(cost * use_count) / size`, where cost is the latency cost of rematerializing
-   * this tensor, and it might be calculated recursively if we have to rematerialize other tensors
-   * prior to rematerialize this tensor. The idea of this equation is to prioritize a tensor with
+   * this tensor (i.e., the inverse of bytes saved per unit of latency), and it might be accumulated
+   * recursively if we have to rematerialize other tensors prior to rematerialize this tensor. The idea of this equation is to prioritize a tensor with
    * large size, low cost to rematerialize, and less used in the rest of the graph.
    * \param liveness_var The liveness var to be estimated.
    * \param curr_call_node The current processing call node.
    * \param curr_depth The current back trace depth of estimating cost of a tensor.
+   * \param latency The total latency of rematerializing this tensor, if not nullptr.
    * \return The cost (lower the better). Note that -1 means rematerializing this tensor is invalid.
    */
   float EstimateRematCost(const Var& liveness_var, const CallNode* curr_call_node,
-                          size_t curr_depth = 1) {
+                          size_t curr_depth = 1, float* latency = nullptr) {
     if (curr_depth == MAX_REMAT_DEPTH) {
       return std::numeric_limits<float>::max();
     }
@@ -801,18 +845,24 @@ class Rematerializer : public ExprMutator {
           // give up rematerializing the dead tensors.
           return -1;
         }
-        auto arg_cost =
-            EstimateRematCost(tensor_infos[0]->liveness_var, curr_call_node, curr_depth + 1);
+        // The dead argument has to be rematerialized as well, so its latency (rather than its
+        // score) is added to the cost.
+        float arg_latency = 0;
+        auto arg_cost = EstimateRematCost(tensor_infos[0]->liveness_var, curr_call_node,
+                                          curr_depth + 1, &arg_latency);
         if (arg_cost == std::numeric_limits<float>::max()) {
           // Give up to rematerialize this tensor if it needs to rematerialize too many ops.
           return -1;
         } else if (arg_cost != -1) {
-          cost += arg_cost;
+          cost += arg_latency;
         }
       }
     }
 
     cost += 0.1;  // Avoid 0 cost.
+    if (latency != nullptr) {
+      *latency = cost;
+    }
     return (cost * (tensor_info->GetUseCount() + 1)) / (tensor_info->size / kGigaBytes);
   }
 
@@ -980,9 +1030,8 @@ Pass Rematerialization() {
     VERBOSE_LOG << "Memory budget for rematerialization: "
                 << (float)memory_budget / rematerialization::kMegaBytes << " MBs";
 
-    auto analyzer = liveness_analysis::LivenessAnalyzer(f);
-    analyzer.Run();
-    if (!analyzer.IsSuccess()) {
+    auto analyzer = liveness_analysis::GetLivenessAnalyzer(f);
+    if (!analyzer->IsSuccess()) {
       LOG(WARNING) << "Rematerialization is disabled because liveness analysis was failed";
       return f;
     }
@@ -996,7 +1045,7 @@ Pass Rematerialization() {
       LOG(INFO) << "Using GFLOPS-based cost estimation. ";
     }
     return Downcast<Function>(
-        rematerialization::Rematerializer(&analyzer, device, f, m, memory_budget, profiler).Run());
+        rematerialization::Rematerializer(analyzer.get(), device, f, m, memory_budget, profiler).Run());
   };
 
   Pass func_pass = CreateRAFFunctionPass(pass_func, 2, "RematerializationHelper", {});
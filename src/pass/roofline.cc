@@ -0,0 +1,160 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file roofline.cc
+ * \brief Report the roofline position of each kernel. Note that this can only be used after
+ * ManifestAlloc pass.
+ */
+#include <algorithm>
+#include <numeric>
+#include "raf/device.h"
+#include "raf/op.h"
+#include "raf/op_profiler.h"
+#include "raf/pass.h"
+#include "./let_list.h"
+#include "./common.h"
+#include "./estimate_flops.h"
+#include "../common/shape_utils.h"
+
+namespace raf {
+namespace pass {
+namespace roofline {
+
+using namespace raf::op;
+
+using RooflineReport = Array<Map<String, ObjectRef>>;
+
+/*!
+ * \brief The bytes moved by a tensor or a tuple of tensors. Other types (e.g., scalars) are
+ * ignored. It assumes each input and output is accessed once, so it is a lower bound of the
+ * DRAM traffic of a kernel.
+ */
+int64_t BytesMoved(const Type& type) {
+  if (auto tuple_type = type.as<TupleTypeNode>()) {
+    int64_t total_size = 0;
+    for (auto field : tuple_type->fields) {
+      total_size += BytesMoved(field);
+    }
+    return total_size;
+  } else if (auto ttype = type.as<TensorTypeNode>()) {
+    return common::shape_utils::BytesCompactTensor(ttype);
+  }
+  return 0;
+}
+
+/*!
+ * \brief A visitor to visit after ManifestAlloc ANF IR, and join the estimated FLOPs, the
+ * estimated bytes moved and the measured latency of each invoked kernel.
+ */
+class RooflineAnalyzer : public ExprVisitor {
+ public:
+  RooflineAnalyzer(const Device& device, const Function& func, const IRModule& mod,
+                   double peak_tflops, double peak_gbps)
+      : ell_(ExplicitLetList::make(func->body)),
+        mod_(mod),
+        device_(device),
+        peak_tflops_(peak_tflops),
+        peak_gbps_(peak_gbps) {
+    CHECK_GT(peak_tflops, 0) << "Invalid peak TFLOP/s: " << peak_tflops;
+    CHECK_GT(peak_gbps, 0) << "Invalid peak GB/s: " << peak_gbps;
+    profiler_ = op_profiler::OpProfiler::Get(device);
+  }
+
+  RooflineReport Run() {
+    const auto& vars = ell_->vars;
+    const auto& exprs = ell_->exprs;
+    CHECK_EQ(vars.size(), exprs.size());
+    for (size_t i = 0; i < exprs.size(); ++i) {
+      let_map_.Set(vars[i], exprs[i]);
+      ExprVisitor::VisitExpr(exprs[i]);
+    }
+    return report_;
+  }
+
+  void VisitExpr_(const CallNode* call) final {
+    static const Op& invoke_op = Op::Get("raf.op.vm.invoke_op");
+    if (call->op != invoke_op) {
+      return;
+    }
+    auto callee_op = let_map_[Downcast<Var>(call->args[0])];
+    auto args = Downcast<Tuple>(let_map_[Downcast<Var>(call->args[1])])->fields;
+    auto callee = Downcast<Call>(pass::InferType(Call(callee_op, args)));
+
+    double gflops = estimate_flops::FLOPSEstimater().Run(device_, callee, mod_);
+    int64_t bytes = BytesMoved(callee->checked_type());
+    for (const auto& arg : callee->args) {
+      bytes += BytesMoved(arg->checked_type());
+    }
+    auto latencies = profiler_->ProfileOp(callee).first;
+    auto op_env = profiler_->GetOpEnv(callee);
+    std::string name = (op_env != nullptr) ? op_env->name() : "unknown";
+    double latency_us = 0.0;
+    if (!latencies.empty()) {
+      latency_us = std::accumulate(latencies.begin(), latencies.end(), 0.0) / latencies.size();
+    }
+
+    // The FLOPs estimation is negative if it fails.
+    double tflops = latency_us > 0 ? std::max(gflops, 0.0) * 1e3 / latency_us : 0.0;
+    double gbps = latency_us > 0 ? bytes * 1e-3 / latency_us : 0.0;
+    // The kernel is memory-bound if its arithmetic intensity is below the ridge point.
+    double intensity = bytes > 0 ? std::max(gflops, 0.0) * 1e9 / bytes : 0.0;
+    double ridge = peak_tflops_ * 1e3 / peak_gbps_;
+    bool memory_bound = intensity < ridge;
+    double attainable_tflops = memory_bound ? intensity * peak_gbps_ * 1e-3 : peak_tflops_;
+
+    Map<String, ObjectRef> entry;
+    entry.Set("name", String(name));
+    entry.Set("gflops", MakeFloat(gflops));
+    entry.Set("bytes", MakeFloat(bytes));
+    entry.Set("latency_us", MakeFloat(latency_us));
+    entry.Set("tflops", MakeFloat(tflops));
+    entry.Set("gbps", MakeFloat(gbps));
+    entry.Set("intensity", MakeFloat(intensity));
+    entry.Set("bound", String(memory_bound ? "memory" : "compute"));
+    entry.Set("efficiency", MakeFloat(attainable_tflops > 0 ? tflops / attainable_tflops : 0.0));
+    report_.push_back(entry);
+  }
+
+ private:
+  static FloatImm MakeFloat(double value) {
+    return FloatImm(DataType::Float(64), value);
+  }
+
+  /*! \brief Let binding vars to the expression. */
+  Map<Var, Expr> let_map_;
+  /*! \brief the explicit let list of func_ */
+  std::unique_ptr<ExplicitLetList> ell_{nullptr};
+  /*! \brief The profiler to measure the latency of each kernel. */
+  op_profiler::OpProfiler* profiler_;
+  /*! \brief The IR module that the target function belongs to. */
+  IRModule mod_;
+  /*! \brief The target device. */
+  Device device_;
+  /*! \brief The peak compute throughput and memory bandwidth of the target device. */
+  double peak_tflops_;
+  double peak_gbps_;
+  /*! \brief The collected report. */
+  RooflineReport report_;
+};
+
+}  // namespace roofline
+
+/*!
+ * \brief Report the FLOPs, the bytes moved, the measured latency, the achieved throughput and
+ * the bound of each kernel invoked by the main function, relative to the device peaks.
+ */
+roofline::RooflineReport RooflineReport(const IRModule& mod, const Device& device,
+                                        double peak_tflops, double peak_gbps) {
+  auto entry = mod->GetGlobalVar("main");
+  auto func = Downcast<Function>(mod->Lookup(entry));
+  auto analyzer = roofline::RooflineAnalyzer(device, func, mod, peak_tflops, peak_gbps);
+  return analyzer.Run();
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.RooflineReport").set_body_typed(RooflineReport);
+
+}  // namespace pass
+}  // namespace raf
@@ -533,6 +533,76 @@ class SimplifyMatmulReshapeBiasAct : public DFPatternRewrite {
   DFPattern data_pat_, weight_pat_, bias_pat_, matmul_op_, act_op_;
 };
 
+/*!
+ * \brief Reassociate (matmul(x, w) + bias) + residual to matmul(x, w) + (residual + bias), where
+ * bias is broadcast to the shape of residual. The GEMM epilogue only accepts one source tensor,
+ * so the residual, which has the full output shape, becomes the source of the epilogue and the
+ * whole chain runs as one GEMM kernel. The bias add does not depend on the GEMM, and can be fused
+ * with the producer of the residual.
+ */
+class SimplifyMatmulBiasResidual : public DFPatternRewrite {
+ public:
+  SimplifyMatmulBiasResidual() {
+    bias_pat_ = IsWildcard();
+    residual_pat_ = IsWildcard();
+    matmul_pat_ = IsOp("raf.op.dense") || IsOp("raf.op.matmul") || IsOp("raf.op.matmul_nt") ||
+                  IsOp("raf.op.matmul_tn") || IsOp("raf.op.matmul_tt") ||
+                  IsOp("raf.op.batch_matmul") || IsOp("raf.op.batch_matmul_nt") ||
+                  IsOp("raf.op.batch_matmul_tn") || IsOp("raf.op.batch_matmul_tt");
+    matmul_pat_ = matmul_pat_({IsWildcard(), IsWildcard()});
+    // The outputs of the adds must not be shared as in ConcretizeAddSubRewrite.
+    auto null = IsConstant(ObjectRef());
+    bias_add_pat_ = IsOp("raf.op.add")({matmul_pat_, bias_pat_, null, null});
+    pattern_ = IsOp("raf.op.add")({bias_add_pat_, residual_pat_, null, null});
+  }
+
+  Expr Callback(const Expr& pre, const Expr& post,
+                const Map<DFPattern, Array<Expr>>& node_map) const override {
+    static auto add_op = Op::Get("raf.op.add");
+    auto matmul = node_map[matmul_pat_][0];
+    auto bias = node_map[bias_pat_][0];
+    auto residual = node_map[residual_pat_][0];
+    // Skip if the residual is also a matmul, or the rewritten add matches the pattern again.
+    if (RAFMatchPattern(matmul_pat_, residual)) {
+      return post;
+    }
+
+    // The matmul and the residual must be in the output shape and dtype, and the bias must be
+    // broadcast to them, so that the reassociation does not change the output type.
+    auto out_type = pre->checked_type().as<TensorTypeNode>();
+    auto matmul_type = matmul->checked_type().as<TensorTypeNode>();
+    auto bias_type = bias->checked_type().as<TensorTypeNode>();
+    auto residual_type = residual->checked_type().as<TensorTypeNode>();
+    if (out_type == nullptr || matmul_type == nullptr || bias_type == nullptr ||
+        residual_type == nullptr) {
+      return post;
+    }
+    if (!tvm::StructuralEqual()(GetRef<Type>(matmul_type), GetRef<Type>(out_type)) ||
+        !tvm::StructuralEqual()(GetRef<Type>(residual_type), GetRef<Type>(out_type)) ||
+        bias_type->dtype != out_type->dtype ||
+        tvm::StructuralEqual()(bias_type->shape, out_type->shape)) {
+      return post;
+    }
+    try {
+      auto shape = BroadcastShape(GetRef<TensorType>(bias_type), GetRef<TensorType>(out_type));
+      if (!tvm::StructuralEqual()(shape, out_type->shape)) {
+        return post;
+      }
+    } catch (const dmlc::Error& e) {
+      return post;
+    }
+
+    auto bias_add = Downcast<Call>(node_map[bias_add_pat_][0]);
+    auto add = pre.as<CallNode>();
+    auto new_bias = Call(add_op, {residual, bias, bias_add->args[2], bias_add->args[3]});
+    return Call(add_op, {matmul, new_bias, add->args[2], add->args[3]});
+  }
+
+ private:
+  /*! \brief Pattern input. */
+  DFPattern matmul_pat_, bias_pat_, residual_pat_, bias_add_pat_;
+};
+
 class SimplifyReshape : public DFPatternRewrite {
  public:
   SimplifyReshape() {
@@ -604,6 +674,168 @@ class SimplifyReshape : public DFPatternRewrite {
   DFPattern data_pat_;
 };
 
+/*!
+ * \brief Fold the transposes of the last two dims of the batch_matmul inputs into the transpose
+ * modes of batch_matmul, e.g., batch_matmul(transpose(a, (0, 2, 1)), b) to batch_matmul_tn(a, b),
+ * so the GEMM reads the inputs in place instead of materializing the transposed copies.
+ */
+class SimplifyBatchMatmulTranspose : public DFPatternRewrite {
+ public:
+  SimplifyBatchMatmulTranspose() {
+    pattern_ = IsOp("raf.op.batch_matmul") || IsOp("raf.op.batch_matmul_nt") ||
+               IsOp("raf.op.batch_matmul_tn") || IsOp("raf.op.batch_matmul_tt");
+    pattern_ = pattern_({IsWildcard(), IsWildcard()});
+  }
+
+  Expr Callback(const Expr& pre, const Expr& post,
+                const Map<DFPattern, Array<Expr>>& node_map) const override {
+    // Indexed by (transpose_a << 1) | transpose_b.
+    static const Op ops[] = {Op::Get("raf.op.batch_matmul"), Op::Get("raf.op.batch_matmul_nt"),
+                             Op::Get("raf.op.batch_matmul_tn"), Op::Get("raf.op.batch_matmul_tt")};
+    auto call = post.as<CallNode>();
+    int mode = std::find(std::begin(ops), std::end(ops), call->op) - std::begin(ops);
+    CHECK_LT(mode, 4);
+    Expr a = call->args[0], b = call->args[1];
+    if (auto src = GetSwappedInput(a)) {
+      a = src.value();
+      mode ^= 2;
+    }
+    if (auto src = GetSwappedInput(b)) {
+      b = src.value();
+      mode ^= 1;
+    }
+    if (a.same_as(call->args[0]) && b.same_as(call->args[1])) {
+      return post;
+    }
+    return Call(ops[mode], {a, b});
+  }
+
+ private:
+  /*!
+   * \brief Get the input of a transpose or swap_axis that swaps the last two dims of a 3-D
+   * tensor, which is the only rank that batch_matmul accepts.
+   */
+  static Optional<Expr> GetSwappedInput(const Expr& expr) {
+    static auto transpose_op = Op::Get("raf.op.transpose");
+    static auto swap_axis_op = Op::Get("raf.op.swap_axis");
+    auto call = expr.as<CallNode>();
+    if (call == nullptr) {
+      return NullOpt;
+    }
+    std::vector<int64_t> axes;
+    if (call->op.same_as(transpose_op)) {
+      auto axes_node = call->args[1].as<ConstantNode>();
+      if (axes_node == nullptr || !axes_node->value.defined()) {
+        return NullOpt;
+      }
+      axes = GetShapeVecFromValue(Downcast<Value>(axes_node->value));
+      if (axes.size() != 3) {
+        return NullOpt;
+      }
+      for (auto& axis : axes) {
+        axis = axis < 0 ? axis + 3 : axis;
+      }
+      if (axes != std::vector<int64_t>{0, 2, 1}) {
+        return NullOpt;
+      }
+    } else if (call->op.same_as(swap_axis_op)) {
+      auto axis1 = call->args[1].as<ConstantNode>();
+      auto axis2 = call->args[2].as<ConstantNode>();
+      if (axis1 == nullptr || axis2 == nullptr) {
+        return NullOpt;
+      }
+      int64_t lhs = GetScalarValueData<int64_t>(Downcast<Value>(axis1->value));
+      int64_t rhs = GetScalarValueData<int64_t>(Downcast<Value>(axis2->value));
+      if (std::min(lhs, rhs) != 1 || std::max(lhs, rhs) != 2) {
+        return NullOpt;
+      }
+    } else {
+      return NullOpt;
+    }
+    return call->args[0];
+  }
+};
+
+/*!
+ * \brief Fuse the variance mean((x - m) * (x - m)) and its sibling m = mean(x) over the same axes
+ * into one moments(x), which reads x once in a single Welford pass instead of once per mean. Both
+ * means have to keep the reduced dims, so the outputs of the moments replace them as they are.
+ */
+class MomentsFuser : public ExprMutator {
+ public:
+  Expr Fuse(const Expr& expr) {
+    PostOrderVisit(expr, [this](const Expr& e) { Match(e); });
+    return fused_.empty() ? expr : Mutate(expr);
+  }
+
+  Expr VisitExpr_(const CallNode* call) final {
+    auto it = fused_.find(call);
+    if (it == fused_.end()) {
+      return ExprMutator::VisitExpr_(call);
+    }
+    const CallNode* mean = it->second.first;
+    if (moments_.count(mean) == 0) {
+      static auto moments_op = Op::Get("raf.op.moments");
+      moments_[mean] = Call(moments_op, {Mutate(mean->args[0]), mean->args[1], mean->args[2],
+                                         mean->args[3]});
+    }
+    return TupleGetItem(moments_[mean], it->second.second);
+  }
+
+ private:
+  static const CallNode* AsCall(const Expr& expr, const Op& op) {
+    const CallNode* call = expr.as<CallNode>();
+    return call && call->op.same_as(op) ? call : nullptr;
+  }
+
+  static bool IsSameConstant(const Expr& lhs, const Expr& rhs) {
+    const ConstantNode* lc = lhs.as<ConstantNode>();
+    const ConstantNode* rc = rhs.as<ConstantNode>();
+    return lc && rc && tvm::StructuralEqual()(lc->value, rc->value);
+  }
+
+  void Match(const Expr& expr) {
+    static auto mean_op = Op::Get("raf.op.mean");
+    static auto multiply_op = Op::Get("raf.op.multiply");
+    static auto subtract_op = Op::Get("raf.op.subtract");
+    const CallNode* var = AsCall(expr, mean_op);
+    if (var == nullptr || fused_.count(var)) {
+      return;
+    }
+    const ConstantNode* keepdims = var->args[2].as<ConstantNode>();
+    const BoolValueObj* keepdims_value = keepdims ? keepdims->value.as<BoolValueObj>() : nullptr;
+    if (keepdims_value == nullptr || !keepdims_value->value) {
+      return;
+    }
+    const CallNode* square = AsCall(var->args[0], multiply_op);
+    if (square == nullptr || !square->args[0].same_as(square->args[1])) {
+      return;
+    }
+    // Skip the in-place subtract, whose output is bound to another tensor.
+    const CallNode* centered = AsCall(square->args[0], subtract_op);
+    if (centered == nullptr || !centered->args[2]->IsInstance<ConstantNode>() ||
+        !centered->args[3]->IsInstance<ConstantNode>()) {
+      return;
+    }
+    const CallNode* mean = AsCall(centered->args[1], mean_op);
+    if (mean == nullptr || fused_.count(mean) || !mean->args[0].same_as(centered->args[0])) {
+      return;
+    }
+    for (int i : {1, 2, 3}) {
+      if (!IsSameConstant(mean->args[i], var->args[i])) {
+        return;
+      }
+    }
+    fused_[mean] = {mean, 0};
+    fused_[var] = {mean, 1};
+  }
+
+  /*! \brief Maps a fused mean to the first mean of its pair and its output index. */
+  std::unordered_map<const CallNode*, std::pair<const CallNode*, int>> fused_;
+  /*! \brief Maps the first mean of each pair to the moments. */
+  std::unordered_map<const CallNode*, Expr> moments_;
+};
+
 Expr SimplifyExpr(const Expr& expr, const IRModule& mod) {
   // Phase 1: Single-op patterns that only need to be applied once.
   DFPatternRewriteComposer composer;
@@ -618,9 +850,14 @@ Expr SimplifyExpr(const Expr& expr, const IRModule& mod) {
   // Phase 2: Sequence patterns that may need to be applied iteratively.
   composer.Clear();
   composer.AddRewrite<SimplifyMatmulReshapeBiasAct>();
+  composer.AddRewrite<SimplifyMatmulBiasResidual>();
+  composer.AddRewrite<SimplifyBatchMatmulTranspose>();
   composer.AddRewrite<SimplifyCast>();
   composer.AddRewrite<SimplifyReshape>();
-  return raf::ir::RAFRewritePatterns(composer.MakeCallbacks(), ret, mod);
+  ret = raf::ir::RAFRewritePatterns(composer.MakeCallbacks(), ret, mod);
+
+  // Phase 3: Fuse the sibling reductions over the same input.
+  return MomentsFuser().Fuse(ret);
 }
 
 }  // namespace simplify_expr
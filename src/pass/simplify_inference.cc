@@ -0,0 +1,230 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file simplify_inference.cc
+ * \brief Simplify the compute of inference graphs by moving the work on constants (e.g., the
+ * parameters bound by BindParam) into the weights, so that FoldConstant can fold them away.
+ */
+#include "raf/op.h"
+#include "raf/ir.h"
+#include "raf/value.h"
+#include "raf/pass.h"
+#include "./let_list.h"
+
+namespace raf {
+namespace pass {
+namespace simplify_inference {
+
+using namespace raf::ir;
+using namespace raf::op;
+using namespace raf::value;
+
+/*! \brief Count the uses of each let-bound variable in an ANF function. */
+class UseCounter : public ExprVisitor {
+ public:
+  void VisitExpr_(const VarNode* var) final {
+    counts_[var]++;
+  }
+
+  void VisitExpr_(const LetNode* op) final {
+    Expr expr = GetRef<Expr>(op);
+    while (const auto* let = expr.as<LetNode>()) {
+      VisitExpr(let->value);
+      expr = let->body;
+    }
+    VisitExpr(expr);
+  }
+
+  std::unordered_map<const VarNode*, int> counts_;
+};
+
+inline bool IsTensorConstant(const Expr& expr) {
+  const auto* constant = expr.as<ConstantNode>();
+  return constant != nullptr && constant->value.defined() &&
+         constant->value->IsInstance<BaseTensorValueObj>();
+}
+
+inline bool IsStringConstant(const Expr& expr, const std::string& str) {
+  const auto* constant = expr.as<ConstantNode>();
+  if (constant == nullptr || !constant->value.defined()) {
+    return false;
+  }
+  const auto* value = constant->value.as<StringValueObj>();
+  return value != nullptr && value->value == str;
+}
+
+inline Expr MakeInt(int64_t value) {
+  return MakeConstant(ScalarValue::make(value));
+}
+
+inline Expr MakeAxes(const std::vector<int64_t>& axes) {
+  Array<Value> fields;
+  for (auto axis : axes) {
+    fields.push_back(ScalarValue::make(axis));
+  }
+  return MakeConstant(TupleValue::make(fields));
+}
+
+/*!
+ * \brief Rewrite the following patterns, where the weights are constants:
+ * 1. batch_norm_infer(conv2d(x, w), mean, var, gamma, beta) is rewritten to
+ *    add(conv2d(x, w * scale), beta - mean * scale), where scale = gamma / sqrt(var + eps).
+ * 2. matmul_nt(x, w) is rewritten to matmul(x, transpose(w)), and so are the other transposed
+ *    (batch) matmuls, so the transposes of the weights are done once by FoldConstant.
+ * The rewritten weights are not folded here, and the replaced conv2d is left to
+ * DeadCodeElimination.
+ */
+class InferenceSimplifier : public ExprMutator {
+ public:
+  explicit InferenceSimplifier(const Function& func) {
+    UseCounter counter;
+    counter.VisitExpr(func->body);
+    use_counts_ = std::move(counter.counts_);
+  }
+
+  Expr VisitExpr_(const LetNode* op) final {
+    auto pre_visit = [this](const LetNode* op) { let_map_[op->var.get()] = op->value; };
+    auto post_visit = [this](const LetNode* op) {
+      memo_[GetRef<Let>(op)] = ExprMutator::VisitExpr_(op);
+      const auto* call = op->value.as<CallNode>();
+      if (call == nullptr) {
+        return;
+      }
+      Expr value = RewriteBatchNorm(call);
+      if (!value.defined()) {
+        value = RewriteTransposedMatmul(call);
+      }
+      if (!value.defined()) {
+        return;
+      }
+      memo_[GetRef<Let>(op)] = LetList::With([&](LetList* ll) {
+        for (size_t i = 0; i < bindings_.size(); ++i) {
+          ll->Push(bindings_[i].first, bindings_[i].second);
+        }
+        ll->Push(op->var, value);
+        return VisitExpr(op->body);
+      });
+      bindings_.clear();
+    };
+    ExpandANormalForm(op, pre_visit, post_visit);
+    return memo_[GetRef<Expr>(op)];
+  }
+
+ private:
+  /*! \brief Bind an expression to a fresh variable before the rewritten let binding. */
+  Var Push(const Expr& expr) {
+    Var var = MakeVar("simplified", {});
+    bindings_.emplace_back(var, expr);
+    return var;
+  }
+
+  Expr RewriteBatchNorm(const CallNode* call) {
+    static const Op& bn_infer = Op::Get("raf.op.batch_norm_infer");
+    static const Op& conv2d = Op::Get("raf.op.conv2d");
+    static const Op& add = Op::Get("raf.op.add");
+    static const Op& subtract = Op::Get("raf.op.subtract");
+    static const Op& multiply = Op::Get("raf.op.multiply");
+    static const Op& divide = Op::Get("raf.op.divide");
+    static const Op& sqrt = Op::Get("raf.op.sqrt");
+    static const Op& expand_dims = Op::Get("raf.op.expand_dims");
+    if (call->op != bn_infer || call->args.size() != 7U) {
+      return Expr();
+    }
+    // The conv2d is only folded when the batch norm is its only user.
+    const auto* x = call->args[0].as<VarNode>();
+    if (x == nullptr || use_counts_[x] != 1 || let_map_.count(x) == 0) {
+      return Expr();
+    }
+    const auto* conv = let_map_[x].as<CallNode>();
+    if (conv == nullptr || conv->op != conv2d || conv->args.size() != 9U ||
+        !IsTensorConstant(conv->args[1])) {
+      return Expr();
+    }
+    // The scale is applied to the output channels, which are the first axis of the weight.
+    if (!IsStringConstant(conv->args[6], "NCHW") || !IsStringConstant(conv->args[7], "OIHW") ||
+        !IsStringConstant(conv->args[8], "NCHW")) {
+      return Expr();
+    }
+    for (size_t i = 1; i < 5; ++i) {
+      if (!IsTensorConstant(call->args[i])) {
+        return Expr();
+      }
+    }
+    Expr mean = call->args[1];
+    Expr var = call->args[2];
+    Expr gamma = call->args[3];
+    Expr beta = call->args[4];
+    Expr eps = call->args[6];
+
+    Var std = Push(Call(sqrt, {Push(Call(add, {var, eps, MakeNull(), MakeNull()}))}));
+    Var scale = Push(Call(divide, {gamma, std}));
+    Var weight_scale = Push(Call(expand_dims, {scale, MakeInt(1), MakeInt(3)}));
+    Var weight = Push(Call(multiply, {conv->args[1], weight_scale}));
+    Var shift = Push(Call(multiply, {mean, scale}));
+    Var bias = Push(Call(subtract, {beta, shift, MakeNull(), MakeNull()}));
+    Var out_bias = Push(Call(expand_dims, {bias, MakeInt(1), MakeInt(2)}));
+    Array<Expr> conv_args = conv->args;
+    conv_args.Set(0, VisitExpr(conv->args[0]));
+    conv_args.Set(1, weight);
+    Var out = Push(Call(conv2d, conv_args));
+    return Call(add, {out, out_bias, MakeNull(), MakeNull()});
+  }
+
+  Expr RewriteTransposedMatmul(const CallNode* call) {
+    static const Op& matmul = Op::Get("raf.op.matmul");
+    static const Op& batch_matmul = Op::Get("raf.op.batch_matmul");
+    static const Op& transpose = Op::Get("raf.op.transpose");
+    // The transposed ops, and whether the lhs and the rhs are transposed.
+    static const std::unordered_map<const OpNode*, std::pair<bool, bool>> transposed = {
+        {Op::Get("raf.op.matmul_nt").get(), {false, true}},
+        {Op::Get("raf.op.matmul_tn").get(), {true, false}},
+        {Op::Get("raf.op.matmul_tt").get(), {true, true}},
+        {Op::Get("raf.op.batch_matmul_nt").get(), {false, true}},
+        {Op::Get("raf.op.batch_matmul_tn").get(), {true, false}},
+        {Op::Get("raf.op.batch_matmul_tt").get(), {true, true}},
+    };
+    const auto* op = call->op.as<OpNode>();
+    if (op == nullptr || transposed.count(op) == 0 || call->args.size() != 2U) {
+      return Expr();
+    }
+    auto flags = transposed.at(op);
+    bool is_batch = op->name.find("batch_") != std::string::npos;
+    // Only the transposes of constants can be folded, so the others are kept in the op.
+    if ((flags.first && !IsTensorConstant(call->args[0])) ||
+        (flags.second && !IsTensorConstant(call->args[1]))) {
+      return Expr();
+    }
+    Expr axes = is_batch ? MakeAxes({0, 2, 1}) : MakeAxes({1, 0});
+    Array<Expr> args;
+    args.push_back(flags.first ? Push(Call(transpose, {call->args[0], axes}))
+                               : VisitExpr(call->args[0]));
+    args.push_back(flags.second ? Push(Call(transpose, {call->args[1], axes}))
+                                : VisitExpr(call->args[1]));
+    return Call(is_batch ? batch_matmul : matmul, args);
+  }
+
+  /*! \brief The number of uses of each variable. */
+  std::unordered_map<const VarNode*, int> use_counts_;
+  /*! \brief Let binding vars to their original values. */
+  std::unordered_map<const VarNode*, Expr> let_map_;
+  /*! \brief The bindings to be inserted before the rewritten let binding. */
+  std::vector<std::pair<Var, Expr>> bindings_;
+};
+
+}  // namespace simplify_inference
+
+Pass SimplifyInference() {
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
+                                                                             PassContext pc) {
+    return Downcast<Function>(simplify_inference::InferenceSimplifier(f).Mutate(f));
+  };
+  return CreateRAFFunctionPass(pass_func, 1, "SimplifyInference", {});
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.SimplifyInference").set_body_typed(SimplifyInference);
+
+}  // namespace pass
+}  // namespace raf
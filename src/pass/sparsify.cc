@@ -0,0 +1,77 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file sparsify.cc
+ * \brief Replace the dense layers of the pruned weights by the 2:4 sparse dense op, which runs on
+ * the sparse tensor cores with the compressed weights and metadata stored as constants.
+ */
+#include <unordered_set>
+#include <vector>
+#include "raf/op.h"
+#include "raf/ir.h"
+#include "raf/pass.h"
+#include "./let_list.h"
+
+namespace raf {
+namespace pass {
+namespace sparsify {
+
+using namespace raf::ir;
+using namespace raf::op;
+
+Function SparsifyDense(const Function& func, const Map<String, Array<Expr>>& weights) {
+  static const Op& dense = Op::Get("raf.op.dense");
+  static const Op& matmul_nt = Op::Get("raf.op.matmul_nt");
+  static const Op& sparse_dense = Op::Get("raf.op._contrib_sparse_dense");
+  std::unordered_set<const VarNode*> replaced;
+  Expr body = LetList::With([&](LetList* ll) {
+    Expr expr = func->body;
+    while (const auto* let = expr.as<LetNode>()) {
+      Expr value = let->value;
+      const auto* call = value.as<CallNode>();
+      if (call != nullptr && (call->op == dense || call->op == matmul_nt) &&
+          call->args.size() == 2U) {
+        const auto* w = call->args[1].as<VarNode>();
+        if (w != nullptr && weights.count(w->name_hint()) > 0) {
+          Array<Expr> compressed = weights[w->name_hint()];
+          CHECK_EQ(compressed.size(), 2U) << "Expected the compressed weight and the metadata";
+          value = Call(sparse_dense, {call->args[0], compressed[0], compressed[1]});
+          replaced.insert(w);
+        }
+      }
+      ll->Push(let->var, value);
+      expr = let->body;
+    }
+    return expr;
+  });
+  Array<Var> free_vars = FreeVars(body);
+  std::unordered_set<const VarNode*> used;
+  for (const Var& var : free_vars) {
+    used.insert(var.get());
+  }
+  Array<Var> params;
+  for (const Var& param : func->params) {
+    if (replaced.count(param.get()) == 0 || used.count(param.get()) > 0) {
+      params.push_back(param);
+    }
+  }
+  return Function(params, body, func->ret_type, func->type_params, func->attrs);
+}
+
+}  // namespace sparsify
+
+Pass SparsifyDense(Map<String, Array<Expr>> weights) {
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
+                                                                             PassContext pc) {
+    return sparsify::SparsifyDense(f, weights);
+  };
+  return CreateRAFFunctionPass(pass_func, 0, "SparsifyDense", {});
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.SparsifyDense").set_body_typed(SparsifyDense);
+
+}  // namespace pass
+}  // namespace raf
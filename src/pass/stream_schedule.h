@@ -9,7 +9,9 @@
  */
 #pragma once
 #include "raf/ir.h"
+#include "raf/pass.h"
 #include "./let_list.h"
+#include "../common/shape_utils.h"
 
 namespace raf {
 namespace pass {
@@ -22,6 +24,15 @@ namespace stream_schedule {
  */
 class StreamSchedulerBase : public ExprMutator {
  public:
+  StreamSchedulerBase() {
+    auto pass_ctx = PassContext::Current();
+    prioritize_ = pass_ctx->GetConfig("raf.stream_schedule.stream_priority", Bool(false)).value();
+    int64_t budget_mbs =
+        pass_ctx->GetConfig("raf.stream_schedule.memory_budget_mbs", Integer(0)).value()->value;
+    CHECK_GE(budget_mbs, 0) << "The memory budget must be non-negative, but got " << budget_mbs;
+    memory_budget_ = budget_mbs * 1024 * 1024;
+  }
+
   Expr VisitExpr_(const VarNode* var) override {
     return GetRef<Expr>(var);
   }
@@ -65,14 +76,41 @@ class StreamSchedulerBase : public ExprMutator {
   }
 
  protected:
-  Expr AnnotateSetStream(int64_t device_id, int64_t stream_id) {
+  Expr AnnotateSetStream(int64_t device_id, int64_t stream_id, int64_t priority = 0) {
     static Op op = Op::Get("raf.op.set_stream");
     Expr device_id_e = MakeConstant(value::ScalarValue::make(device_id));
     Expr stream_id_e = MakeConstant(value::ScalarValue::make(stream_id));
     Array<Expr> args({device_id_e, stream_id_e});
+    if (priority != 0) {
+      args.push_back(MakeConstant(value::ScalarValue::make(priority)));
+    }
     return let_list_.Push(Call(op, args));
   }
 
+  /*!
+   * \brief Annotate the stream of the j-th group in a stage. When the streams are prioritized, the
+   * critical group of the stage runs on the high priority stream kCriticalStreamId, which takes the
+   * place of the group that would have run on it. Stream 0 is not used for the critical group, as
+   * it may be the default stream, whose priority cannot be changed.
+   * \param j The index of the group in the stage.
+   * \param critical The index of the critical group in the stage.
+   */
+  Expr AnnotateGroupStream(int64_t j, int64_t critical) {
+    int64_t stream_id = GetGroupStream(j, critical);
+    return AnnotateSetStream(0, stream_id, prioritize_ && j == critical ? 1 : 0);
+  }
+
+  /*! \brief The stream that the j-th group in a stage runs on. See AnnotateGroupStream. */
+  int64_t GetGroupStream(int64_t j, int64_t critical) const {
+    if (!prioritize_) {
+      return j;
+    }
+    if (j == critical) {
+      return kCriticalStreamId;
+    }
+    return j == kCriticalStreamId ? critical : j;
+  }
+
   Expr AnnotateAddEvent(int64_t event_id) {
     static Op op = Op::Get("raf.op.add_event");
     Expr event_id_e = MakeConstant(value::ScalarValue::make(event_id));
@@ -92,6 +130,28 @@ class StreamSchedulerBase : public ExprMutator {
     return let_list_.Push(Call(op, {}));
   }
 
+  /*!
+   * \brief Get the bytes of the tensors produced by an expr, which are used to estimate the peak
+   * memory of the stages. Tuples and their items do not allocate memory. Zero is returned if the
+   * expr has not been type inferred.
+   */
+  static int64_t GetOutputBytes(const Expr& expr) {
+    if (!expr->IsInstance<CallNode>() || !expr->checked_type_.defined()) {
+      return 0;
+    }
+    return common::shape_utils::BytesCompactType(expr->checked_type());
+  }
+
+  /*! \brief The stream of the critical groups when the streams are prioritized. */
+  static constexpr int64_t kCriticalStreamId = 1;
+  /*! \brief Whether to run the critical groups on a high priority stream. */
+  bool prioritize_ = false;
+  /*!
+   * \brief The budget of the peak memory in bytes, or 0 if unlimited. The schedulers do not put
+   * groups in the same stage if the tensors live during the stage would exceed the budget, trading
+   * the parallelism for memory.
+   */
+  int64_t memory_budget_ = 0;
   LetList let_list_;
 };
 
@@ -298,6 +298,8 @@ Pass ASAPStreamSchedule() {
 
 RAF_REGISTER_GLOBAL("raf.pass_.ASAPStreamSchedule").set_body_typed(ASAPStreamSchedule);
 TVM_REGISTER_PASS_CONFIG_OPTION("raf.stream_schedule.policy", tvm::String);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.stream_schedule.stream_priority", tvm::Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.stream_schedule.memory_budget_mbs", tvm::Integer);
 
 }  // namespace pass
 }  // namespace raf
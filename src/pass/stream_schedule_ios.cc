@@ -8,7 +8,10 @@
  * \brief IOS (Inter-Operator Scheduler) stream scheduler.
  *  Reference: IOS: Inter Operator Scheduler for CNN Acceleration (MLSys 2021).
  */
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <limits>
 #include <utility>
 #include <thread>
 #include <relay/transforms/pass_utils.h>
@@ -20,6 +23,8 @@
 #include "raf/op_utils.h"
 #include "raf/profiler.h"
 #include "./stream_schedule.h"
+#include "./estimate_flops.h"
+#include "../common/shape_utils.h"
 #include "../requests.h"
 #include "../analysis/dependency_graph.h"
 
@@ -73,6 +78,47 @@ inline int CountOneBits(uint64_t v) {
   return c;
 }
 
+/*! \brief The options of the IOS cost models. */
+struct IOSCostModelConfig {
+  /*! \brief The kind of cost model: "profile", "roofline", or "learned". */
+  std::string kind = "profile";
+  /*! \brief Number of warmups when profiling. */
+  int warmup = 2;
+  /*! \brief The number of executions as a repeat when profiling. */
+  int number = 5;
+  /*! \brief The number of repeat times when profiling. */
+  int repeat = 5;
+  /*! \brief The peak compute throughput of the device in TFLOPS, used by the roofline. */
+  double peak_tflops = 15.0;
+  /*! \brief The peak memory bandwidth of the device in GB/s, used by the roofline. */
+  double bandwidth_gbps = 900.0;
+  /*! \brief The launching overhead of a kernel in microseconds, used by the roofline. */
+  double launch_overhead_us = 5.0;
+  /*! \brief The maximum number of ops profiled to train the learned cost model. */
+  int train_samples = 64;
+};
+
+/*! \brief The interface of the cost model used by IOS scheduler to predict stage latencies. */
+class IOSCostModel {
+ public:
+  virtual ~IOSCostModel() = default;
+
+  /*!
+   * \brief Prepare the cost model with all the operators to be scheduled, before any stage is
+   * measured. This is where a cost model could collect its training data.
+   * \param exprs The operators to be scheduled.
+   */
+  virtual void Prepare(const std::vector<Expr>& exprs) {
+  }
+
+  /*!
+   * \brief Measure the latency of a stage (consists of multiple independent groups).
+   * \param groups The independent groups. The i-th group is executed on the i-th stream.
+   * \return The latency samples of the stage in microseconds.
+   */
+  virtual std::vector<float> StageLatency(const std::vector<std::vector<Expr>>& groups) = 0;
+};
+
 #ifdef RAF_USE_CUDA
 /*!
  * \brief The cost model of IOS scheduler. It profile the latency of IOS proposed stage on device.
@@ -89,33 +135,23 @@ inline int CountOneBits(uint64_t v) {
  * also the most efficient way to profile. This decision is a trade-off between the profiling
  * accuracy and the compilation time.
  */
-class IOSCostModel {
-  using OpEnvCache = MetaCache<std::shared_ptr<OpEnv>>;
-
+class IOSProfileCostModel : public IOSCostModel {
  public:
   /*!
-   * \brief The IOS cost model.
+   * \brief The IOS profiling cost model.
    * \param device The target device. Must be a cuda device.
-   * \param num_stream The maximum number of streams to support.
-   * \param warmup The number of warmups before real execution.
-   * \param number The number of executions as a repeat.
-   * \param repeat The number of repeat times.
+   * \param config The config that provides the number of warmup, number and repeat.
    */
-  IOSCostModel(Device device, int warmup, int number, int repeat) {
+  IOSProfileCostModel(Device device, const IOSCostModelConfig& config) {
     CHECK_EQ(device.device_type(), DevType::kCUDA()) << "IOS cost model only supports CUDA.";
     this->device_ = device;
-    this->warmup_ = warmup;
-    this->number_ = number;
-    this->repeat_ = repeat;
+    this->warmup_ = config.warmup;
+    this->number_ = config.number;
+    this->repeat_ = config.repeat;
     this->profiler_ = op_profiler::OpProfiler::Get(device);
   }
 
-  /*!
-   * \brief Measure the latency of a stage (consists of multiple independent groups).
-   * \param groups The independent groups.
-   * \return The latency of the stage.
-   */
-  std::vector<float> StageLatency(const std::vector<std::vector<Expr>>& groups) {
+  std::vector<float> StageLatency(const std::vector<std::vector<Expr>>& groups) override {
     std::vector<Expr> flat_group;
     std::vector<int> stream_ids;
     for (size_t i = 0; i < groups.size(); i++) {
@@ -144,17 +180,244 @@ class IOSCostModel {
   op_profiler::OpProfiler* profiler_;
 };
 #else
-class IOSCostModel {
+class IOSProfileCostModel : public IOSCostModel {
  public:
-  IOSCostModel(Device device, int warmup, int number, int repeat) {
+  IOSProfileCostModel(Device device, const IOSCostModelConfig& config) {
     LOG(FATAL) << "Please build with CUDA enabled to use IOS schedule.";
   }
-  std::vector<float> StageLatency(const std::vector<std::vector<Expr>>& groups) {
+  std::vector<float> StageLatency(const std::vector<std::vector<Expr>>& groups) override {
     return {};
   }
 };
 #endif
 
+/*!
+ * \brief An analytical cost model of IOS scheduler, which never launches a kernel. Each operator
+ * takes the longer one of its compute time (the GFLOPS from FLOPSEstimater over the peak
+ * throughput) and its memory time (the bytes of its inputs and output over the peak bandwidth),
+ * plus a launching overhead. The operators in a group run sequentially, while all groups of a
+ * stage share the compute units and the memory bandwidth of the device, so the stage latency is
+ * bounded by the slowest group as well as the total compute and memory time of the stage.
+ */
+class IOSRooflineCostModel : public IOSCostModel {
+ public:
+  /*! \brief The roofline features of an operator in microseconds. */
+  struct Feature {
+    /*! \brief The compute time at the peak throughput. */
+    double compute_us;
+    /*! \brief The memory time at the peak bandwidth. */
+    double memory_us;
+  };
+
+  IOSRooflineCostModel(Device device, IRModule mod, const IOSCostModelConfig& config)
+      : device_(device), mod_(std::move(mod)), config_(config) {
+    CHECK_GT(config.peak_tflops, 0) << "The peak TFLOPS must be positive";
+    CHECK_GT(config.bandwidth_gbps, 0) << "The peak bandwidth must be positive";
+  }
+
+  std::vector<float> StageLatency(const std::vector<std::vector<Expr>>& groups) override {
+    double max_group_us = 0, total_compute_us = 0, total_memory_us = 0;
+    for (const auto& group : groups) {
+      double group_us = 0;
+      for (const auto& expr : group) {
+        const auto& feat = GetFeature(expr);
+        group_us += OpLatency(feat);
+        total_compute_us += feat.compute_us;
+        total_memory_us += feat.memory_us;
+      }
+      max_group_us = std::max(max_group_us, group_us);
+    }
+    return {static_cast<float>(std::max({max_group_us, ComputeScale() * total_compute_us,
+                                         MemoryScale() * total_memory_us}))};
+  }
+
+ protected:
+  /*! \brief The predicted latency of an operator running alone. */
+  virtual double OpLatency(const Feature& feat) {
+    return std::max(feat.compute_us, feat.memory_us) + config_.launch_overhead_us;
+  }
+
+  /*! \brief The scale from the total compute time to the latency when sharing the device. */
+  virtual double ComputeScale() {
+    return 1.0;
+  }
+
+  /*! \brief The scale from the total memory time to the latency when sharing the device. */
+  virtual double MemoryScale() {
+    return 1.0;
+  }
+
+  /*! \brief Get the roofline features of an operator, which are cached by the expr. */
+  const Feature& GetFeature(const Expr& expr) {
+    auto it = features_.find(expr.get());
+    if (it != features_.end()) {
+      return it->second;
+    }
+    Feature feat{0, 0};
+    if (auto call = expr.as<CallNode>()) {
+      double gflops = estimate_flops::FLOPSEstimater().Run(device_, GetRef<Call>(call), mod_);
+      feat.compute_us = std::max(gflops, 0.0) / config_.peak_tflops * 1e3;
+      double bytes = TensorBytes(call->checked_type());
+      for (const auto& arg : call->args) {
+        bytes += TensorBytes(arg->checked_type());
+      }
+      feat.memory_us = bytes / config_.bandwidth_gbps * 1e-3;
+    }
+    return features_[expr.get()] = feat;
+  }
+
+  /*! \brief The bytes of a tensor or a tuple of tensors. Other types take no bytes. */
+  static double TensorBytes(const Type& type) {
+    if (auto tuple_type = type.as<TupleTypeNode>()) {
+      double bytes = 0;
+      for (const auto& field : tuple_type->fields) {
+        bytes += TensorBytes(field);
+      }
+      return bytes;
+    }
+    if (type->IsInstance<TensorTypeNode>()) {
+      return common::shape_utils::BytesCompactType(type);
+    }
+    return 0;
+  }
+
+  /*! \brief The target device. */
+  Device device_;
+  /*! \brief The module that the scheduled function belongs to. */
+  IRModule mod_;
+  /*! \brief The config of the cost model. */
+  IOSCostModelConfig config_;
+  /*! \brief The cached features of each operator. */
+  std::unordered_map<const ExprNode*, Feature> features_;
+};
+
+/*!
+ * \brief A learned cost model of IOS scheduler. It fits the per-operator latency as a linear
+ * function of the roofline features, i.e., a * compute_us + b * memory_us + c, with the latencies
+ * of a few operators from OpProfiler. Since OpProfiler caches the results of individual
+ * operators, most samples are free when the same operators have been profiled before (e.g., by
+ * rematerialization). Stages are then predicted with the fitted operator latencies without
+ * running them on device. It falls back to the roofline if the samples cannot decide the fit.
+ */
+class IOSLearnedCostModel : public IOSRooflineCostModel {
+ public:
+  IOSLearnedCostModel(Device device, IRModule mod, const IOSCostModelConfig& config)
+      : IOSRooflineCostModel(device, std::move(mod), config) {
+  }
+
+  void Prepare(const std::vector<Expr>& exprs) override {
+    auto profiler = op_profiler::OpProfiler::Get(device_);
+    // Normal equations of the least squares over features (compute_us, memory_us, 1).
+    double xtx[3][3] = {{0}}, xty[3] = {0};
+    int num_samples = 0;
+    for (const auto& expr : exprs) {
+      if (num_samples >= config_.train_samples) {
+        break;
+      }
+      if (!expr->IsInstance<CallNode>()) {
+        continue;
+      }
+      auto latencies = profiler->ProfileOp(expr, config_.warmup, config_.number, 1).first;
+      if (latencies.empty()) {
+        continue;
+      }
+      const auto& feat = GetFeature(expr);
+      double x[3] = {feat.compute_us, feat.memory_us, 1.0};
+      double y = *std::min_element(latencies.begin(), latencies.end());
+      for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+          xtx[i][j] += x[i] * x[j];
+        }
+        xty[i] += x[i] * y;
+      }
+      num_samples++;
+    }
+    fitted_ = num_samples >= 3 && Solve3x3(xtx, xty, coef_) && coef_[0] >= 0 && coef_[1] >= 0;
+    if (!fitted_) {
+      LOG(WARNING) << "Failed to fit the IOS cost model with " << num_samples
+                   << " samples. Fall back to the roofline cost model.";
+    } else {
+      DLOG(INFO) << "IOS learned cost model: latency = " << coef_[0] << " * compute_us + "
+                 << coef_[1] << " * memory_us + " << coef_[2];
+    }
+  }
+
+ protected:
+  double OpLatency(const Feature& feat) override {
+    if (!fitted_) {
+      return IOSRooflineCostModel::OpLatency(feat);
+    }
+    return std::max(coef_[0] * feat.compute_us + coef_[1] * feat.memory_us + coef_[2], 0.0);
+  }
+
+  double ComputeScale() override {
+    return fitted_ ? coef_[0] : 1.0;
+  }
+
+  double MemoryScale() override {
+    return fitted_ ? coef_[1] : 1.0;
+  }
+
+ private:
+  /*! \brief Solve a x = b with Gaussian elimination. Return false if a is singular. */
+  static bool Solve3x3(double a[3][3], double b[3], double x[3]) {
+    for (int col = 0; col < 3; ++col) {
+      int pivot = col;
+      for (int row = col + 1; row < 3; ++row) {
+        if (std::fabs(a[row][col]) > std::fabs(a[pivot][col])) {
+          pivot = row;
+        }
+      }
+      if (std::fabs(a[pivot][col]) < 1e-12) {
+        return false;
+      }
+      std::swap(a[col], a[pivot]);
+      std::swap(b[col], b[pivot]);
+      for (int row = col + 1; row < 3; ++row) {
+        double ratio = a[row][col] / a[col][col];
+        for (int k = col; k < 3; ++k) {
+          a[row][k] -= ratio * a[col][k];
+        }
+        b[row] -= ratio * b[col];
+      }
+    }
+    for (int row = 2; row >= 0; --row) {
+      x[row] = b[row];
+      for (int k = row + 1; k < 3; ++k) {
+        x[row] -= a[row][k] * x[k];
+      }
+      x[row] /= a[row][row];
+    }
+    return true;
+  }
+
+  /*! \brief Whether the linear model has been fitted. */
+  bool fitted_ = false;
+  /*! \brief The coefficients of compute time, memory time, and the constant. */
+  double coef_[3] = {1.0, 1.0, 0.0};
+};
+
+/*!
+ * \brief Make the IOS cost model of the given kind.
+ * \param device The target device.
+ * \param mod The module that the scheduled function belongs to.
+ * \param config The config of the cost model.
+ * \return The cost model.
+ */
+std::unique_ptr<IOSCostModel> MakeIOSCostModel(Device device, IRModule mod,
+                                               const IOSCostModelConfig& config) {
+  if (config.kind == "profile") {
+    return std::make_unique<IOSProfileCostModel>(device, config);
+  } else if (config.kind == "roofline") {
+    return std::make_unique<IOSRooflineCostModel>(device, std::move(mod), config);
+  } else if (config.kind == "learned") {
+    return std::make_unique<IOSLearnedCostModel>(device, std::move(mod), config);
+  }
+  LOG(FATAL) << "Unknown IOS cost model: " << config.kind
+             << ". Expected one of profile, roofline, and learned.";
+  throw;
+}
+
 class IOSScheduler : public StreamSchedulerBase {
   /*! \brief A group of nodes. */
   using Group = std::vector<Node*>;
@@ -191,16 +454,24 @@ class IOSScheduler : public StreamSchedulerBase {
    * even if they have already satisfied the stream constraint. This may slower the scheduling.
    * \param schedule_units The schedule units. A schedule unit is a sequence of operators. We will
    * schedule the model based on these units. This helps to reduce the search complexity.
-   * \param warmup The number of warmups before real execution.
-   * \param number The number of executions as a repeat.
-   * \param repeat The number of repeat times.
+   * \param cost_model_config The config of the cost model that predicts the stage latencies.
+   * \param calibrate_top_k The number of best candidate stages of each decision to be profiled on
+   * device. Only effective when the cost model does not profile. Zero means no calibration.
+   * \param mod The module that the scheduled expression belongs to.
    * \param verbose Whether print the verbose message during scheduling.
    */
   explicit IOSScheduler(Device device, int max_block_size = 20, int max_stream_num = 5,
                         int max_stage_ops = 10, bool search_group_combination = true,
-                        Array<Array<Op>> schedule_units = {}, int warmup = 2, int number = 5,
-                        int repeat = 5, bool verbose = false)
-      : cost_model_(device, warmup, number, repeat), verbose_(this, verbose) {
+                        Array<Array<Op>> schedule_units = {},
+                        const IOSCostModelConfig& cost_model_config = {}, int calibrate_top_k = 0,
+                        IRModule mod = {}, bool verbose = false)
+      : cost_model_(MakeIOSCostModel(device, mod, cost_model_config)), verbose_(this, verbose) {
+    CHECK_GE(calibrate_top_k, 0) << "The number of calibrated candidates must be non-negative, "
+                                 << "but got " << calibrate_top_k;
+    if (calibrate_top_k > 0 && cost_model_config.kind != "profile") {
+      calibrator_ = std::make_unique<IOSProfileCostModel>(device, cost_model_config);
+    }
+    config_.calibrate_top_k = calibrate_top_k;
     CHECK_GE(max_stream_num, 1) << "Stream number must be greater or equal to 1, but got "
                                 << max_stream_num;
     CHECK_LE(max_block_size, 64) << "Only support maximum block size less or equal to 64, but got "
@@ -235,13 +506,22 @@ class IOSScheduler : public StreamSchedulerBase {
                  blocks_.size(), ss.str().c_str());
     }
 
+    std::vector<Expr> exprs;
+    for (Node* node : graph_.all_nodes) {
+      for (const auto& expr : graph_.node_unit[node]) {
+        exprs.push_back(expr);
+      }
+    }
+    cost_model_->Prepare(exprs);
+
     auto stages = ScheduleBlocks();
 
     for (int i = 0; i < stages.size(); i++) {
       Stage& stage = stages.at(i);
+      int critical = prioritize_ ? CriticalGroup(stage) : 0;
       for (int j = 0; j < stage.size(); j++) {
         Group& group = stage[j];
-        AnnotateSetStream(0, j);
+        AnnotateGroupStream(j, critical);
         for (Node* node : group) {
           for (Expr expr : graph_.node_unit[node]) {
             VisitExpr(expr);
@@ -448,10 +728,32 @@ class IOSScheduler : public StreamSchedulerBase {
     }
 
     blocks_.resize(blocks.size());
+    std::unordered_map<const Node*, int> node_block;
     for (int i = 0; i < blocks.size(); i++) {
       blocks_[i].nodes = std::move(blocks[i]);
       for (int j = 0; j < blocks_[i].nodes.size(); j++) {
-        blocks_[i].node_index[blocks_[i].nodes[j]] = j;
+        Node* node = blocks_[i].nodes[j];
+        blocks_[i].node_index[node] = j;
+        node_block[node] = i;
+        int64_t bytes = 0;
+        for (const auto& expr : graph_.node_unit[node]) {
+          bytes += GetOutputBytes(expr);
+        }
+        blocks_[i].node_bytes.push_back(bytes);
+      }
+    }
+    // A node is live in the blocks up to the one of its last consumer, or all following blocks if
+    // it is an output.
+    for (int i = 0; i < blocks_.size(); i++) {
+      for (int j = 0; j < blocks_[i].nodes.size(); j++) {
+        Node* node = blocks_[i].nodes[j];
+        int last_block = node->parents.head ? i : static_cast<int>(blocks_.size()) - 1;
+        for (auto iit = node->parents.head; iit; iit = iit->next) {
+          last_block = std::max(last_block, node_block[iit->value]);
+        }
+        for (int k = i + 1; k <= last_block; k++) {
+          blocks_[k].base_bytes += blocks_[i].node_bytes[j];
+        }
       }
     }
   }
@@ -564,6 +866,11 @@ class IOSScheduler : public StreamSchedulerBase {
       Decision best_decision = state;
       for (auto decision : GetStateDecisionCandidates(block_id, state)) {
         DCHECK_EQ((decision & state), decision);
+        if (memory_budget_ > 0 && CountOneBits(decision) > 1 &&
+            GetDecisionStageBytes(block_id, state, decision) > memory_budget_) {
+          // Reject the stage exceeding the memory budget. A stage of one operator is always kept.
+          continue;
+        }
         float decision_latency = GetDecisionStageLatency(block_id, decision);
         float total_latency = DP(state - decision) + decision_latency;
         if (best_latency > total_latency) {
@@ -775,7 +1082,8 @@ class IOSScheduler : public StreamSchedulerBase {
     for (auto& pr : group_ops) {
       best_stage.push_back(pr.first);
     }
-    float best_latency = MeasureStageLatency(best_stage);
+    std::vector<std::pair<float, Stage>> candidates;
+    candidates.emplace_back(MeasureStageLatency(cost_model_.get(), best_stage), best_stage);
     if (config_.search_group_combination && group_ops.size() != 1) {
       // tries to merge the least two lightweight groups each time
       do {
@@ -784,24 +1092,95 @@ class IOSScheduler : public StreamSchedulerBase {
         for (auto& pr : group_ops) {
           candidate_stage.push_back(pr.first);
         }
-        float candidate_latency = MeasureStageLatency(candidate_stage);
-        if (best_latency > candidate_latency) {
-          best_latency = candidate_latency;
-          best_stage = candidate_stage;
-        }
+        float candidate_latency = MeasureStageLatency(cost_model_.get(), candidate_stage);
+        candidates.emplace_back(candidate_latency, candidate_stage);
       } while (group_ops.size() > 1);
     }
+    // Keep the first candidate on ties, which uses the most streams.
+    std::stable_sort(candidates.begin(), candidates.end(),
+                     [](const std::pair<float, Stage>& lhs, const std::pair<float, Stage>& rhs) {
+                       return lhs.first < rhs.first;
+                     });
+    float best_latency = candidates[0].first;
+    best_stage = candidates[0].second;
+    if (calibrator_ != nullptr) {
+      // Profile the best candidates predicted by the cost model on device, so that the latencies
+      // of all decisions are comparable measurements.
+      int num = std::min(static_cast<int>(candidates.size()), config_.calibrate_top_k);
+      best_latency = std::numeric_limits<float>::max();
+      for (int i = 0; i < num; ++i) {
+        float latency = MeasureStageLatency(calibrator_.get(), candidates[i].second);
+        if (best_latency > latency) {
+          best_latency = latency;
+          best_stage = candidates[i].second;
+        }
+      }
+    }
     decision_stage[decision] = best_stage;
     decision_latency[decision] = best_latency;
     return decision_latency[decision];
   }
 
+  /*!
+   * \brief Estimate the bytes of the tensors live during the stage of a decision. They include the
+   * tensors produced by the scheduled operators that are still to be consumed, and all tensors
+   * produced by the stage, as its groups run concurrently.
+   * \param block_id The block index.
+   * \param state The operators remaining to be scheduled.
+   * \param decision The decision.
+   * \return The estimated bytes.
+   */
+  int64_t GetDecisionStageBytes(int block_id, State state, Decision decision) {
+    const BlockInfo& block = blocks_[block_id];
+    int64_t bytes = block.base_bytes;
+    for (int u = 0; u < block.nodes.size(); u++) {
+      if ((decision >> u) & 1) {
+        bytes += block.node_bytes[u];
+      } else if (((state >> u) & 1) == 0) {
+        // The operator has been scheduled. Its output is live if it is a final output, or it has
+        // consumers in the remaining operators or following blocks.
+        Node* node = block.nodes[u];
+        bool live = node->parents.head == nullptr;
+        for (auto iit = node->parents.head; iit && !live; iit = iit->next) {
+          auto it = block.node_index.find(iit->value);
+          live = it == block.node_index.end() || ((state >> it->second) & 1);
+        }
+        if (live) {
+          bytes += block.node_bytes[u];
+        }
+      }
+    }
+    return bytes;
+  }
+
+  /*!
+   * Find the critical group of a stage, which is the group with the longest latency.
+   * \param stage The stage.
+   * \return The index of the critical group in the stage.
+   */
+  int CriticalGroup(const Stage& stage) {
+    if (stage.size() <= 1) {
+      return 0;
+    }
+    int critical = 0;
+    float critical_latency = -1.0;
+    for (int j = 0; j < stage.size(); j++) {
+      float latency = MeasureStageLatency(cost_model_.get(), {stage[j]});
+      if (latency > critical_latency) {
+        critical = j;
+        critical_latency = latency;
+      }
+    }
+    return critical;
+  }
+
   /*!
    * Measure the latency of a stage through the IOS cost model.
+   * \param cost_model The cost model to measure with.
    * \param stage The stage to be profiled.
    * \return The latency of the stage.
    */
-  float MeasureStageLatency(const Stage& stage) {
+  float MeasureStageLatency(IOSCostModel* cost_model, const Stage& stage) {
     std::vector<std::vector<Expr>> expr_groups;
     for (const auto& group : stage) {
       expr_groups.emplace_back();
@@ -811,7 +1190,7 @@ class IOSScheduler : public StreamSchedulerBase {
         }
       }
     }
-    std::vector<float> results = cost_model_.StageLatency(expr_groups);
+    std::vector<float> results = cost_model->StageLatency(expr_groups);
     std::sort(results.begin(), results.end());
     float sum = 0.0;
     // We only use the smallest 30% data
@@ -831,6 +1210,8 @@ class IOSScheduler : public StreamSchedulerBase {
     int max_stage_ops;
     /*! \brief Whether to search the group combination in a stage. */
     bool search_group_combination;
+    /*! \brief The number of best candidate stages to be profiled on device for calibration. */
+    int calibrate_top_k;
     /*!
      * \brief The schedule units. IOS can take a sequence of operators as a schedule unit (e.g.,
      * conv2d + bn + relu). IOS considers all such chain as a schedule unit and will not split them
@@ -843,7 +1224,9 @@ class IOSScheduler : public StreamSchedulerBase {
   Config config_;
 
   /*! \brief The cost model that IOS uses to predict the stage performance. */
-  IOSCostModel cost_model_;
+  std::unique_ptr<IOSCostModel> cost_model_;
+  /*! \brief The profiling cost model to calibrate the best candidates, or nullptr if disabled. */
+  std::unique_ptr<IOSCostModel> calibrator_;
 
   struct GraphInfo {
     /*! \brief The arena used to allocate memory for DependencyGraph. */
@@ -861,6 +1244,10 @@ class IOSScheduler : public StreamSchedulerBase {
     std::vector<Node*> nodes;
     /*! \brief The mapping from node to its index. */
     std::unordered_map<const Node*, int> node_index;
+    /*! \brief The bytes of the output tensors of each node. */
+    std::vector<int64_t> node_bytes;
+    /*! \brief The bytes of the tensors produced by previous blocks and live in this block. */
+    int64_t base_bytes = 0;
     /*! \brief The mapping from state to all of its decision candidates. */
     std::unordered_map<State, std::vector<Decision>> state_decision_candidates;
     /*! \brief The mapping from state to its optimal decision. */
@@ -946,10 +1333,11 @@ class IOSScheduler : public StreamSchedulerBase {
 Expr IOSStreamSchedule(const Expr& e, Device device, int block_max_size = 20,
                        int max_stream_num = 5, int max_stage_ops = 10,
                        bool search_group_combination = true, Array<Array<Op>> schedule_units = {},
-                       int warmup = 1, int number = 5, int repeat = 5, bool verbose = false) {
+                       const IOSCostModelConfig& cost_model_config = {}, int calibrate_top_k = 0,
+                       IRModule mod = {}, bool verbose = false) {
   IOSScheduler scheduler(device, block_max_size, max_stream_num, max_stage_ops,
-                         search_group_combination, std::move(schedule_units), warmup, number,
-                         repeat, verbose);
+                         search_group_combination, std::move(schedule_units), cost_model_config,
+                         calibrate_top_k, std::move(mod), verbose);
   return scheduler.Schedule(e);
 }
 
@@ -972,9 +1360,16 @@ Pass IOSStreamSchedule() {
   int max_stream_num = get_int_config("max_stream_num", 5);
   int max_stage_ops = get_int_config("max_stage_ops", 10);
   bool search_group_combination = get_bool_config("search_group_combination", false);
-  int warmup = get_int_config("warmup", 2);
-  int number = get_int_config("number", 1);
-  int repeat = get_int_config("repeat", 8);
+  ios_stream_schedule::IOSCostModelConfig cost_model_config;
+  cost_model_config.kind =
+      ctx->GetConfig<String>("raf.stream_schedule.ios.cost_model", String("profile")).value();
+  cost_model_config.warmup = get_int_config("warmup", 2);
+  cost_model_config.number = get_int_config("number", 1);
+  cost_model_config.repeat = get_int_config("repeat", 8);
+  cost_model_config.peak_tflops = get_int_config("peak_tflops", 15);
+  cost_model_config.bandwidth_gbps = get_int_config("bandwidth_gbps", 900);
+  cost_model_config.train_samples = get_int_config("train_samples", 64);
+  int calibrate_top_k = get_int_config("calibrate_top_k", 0);
   bool verbose = get_bool_config("verbose", true);
   Array<Array<Op>> schedule_units =
       ctx->GetConfig<Array<Array<Op>>>("raf.stream_schedule.ios.schedule_units", Array<Array<Op>>())
@@ -991,7 +1386,8 @@ Pass IOSStreamSchedule() {
         auto transform = [=](Expr e) {
           return ios_stream_schedule::IOSStreamSchedule(
               e, Device(DevType::kCUDA(), 0), block_max_size, max_stream_num, max_stage_ops,
-              search_group_combination, schedule_units, warmup, number, repeat, verbose);
+              search_group_combination, schedule_units, cost_model_config, calibrate_top_k, m,
+              verbose);
         };
         return Downcast<Function>(tvm::relay::TransformF(transform, f));
       };
@@ -1007,6 +1403,11 @@ TVM_REGISTER_PASS_CONFIG_OPTION("raf.stream_schedule.ios.warmup", tvm::Integer);
 TVM_REGISTER_PASS_CONFIG_OPTION("raf.stream_schedule.ios.number", tvm::Integer);
 TVM_REGISTER_PASS_CONFIG_OPTION("raf.stream_schedule.ios.repeat", tvm::Integer);
 TVM_REGISTER_PASS_CONFIG_OPTION("raf.stream_schedule.ios.verbose", tvm::Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.stream_schedule.ios.cost_model", String);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.stream_schedule.ios.peak_tflops", tvm::Integer);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.stream_schedule.ios.bandwidth_gbps", tvm::Integer);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.stream_schedule.ios.train_samples", tvm::Integer);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.stream_schedule.ios.calibrate_top_k", tvm::Integer);
 TVM_REGISTER_PASS_CONFIG_OPTION("raf.stream_schedule.ios.schedule_units", Array<Array<Op>>);
 }  // namespace pass
 }  // namespace raf
@@ -7,6 +7,8 @@
  * \file src/pass/stream_schedule_wavefront.cc
  * \brief Wavefront stream scheduler.
  */
+#include <algorithm>
+#include <set>
 #include <relay/transforms/pass_utils.h>
 #include "raf/pass.h"
 #include "raf/analysis.h"
@@ -21,6 +23,7 @@ using namespace raf::analysis;
 using stream_schedule::StreamSchedulerBase;
 using Node = DependencyGraph::Node;
 using NodeExprMap = std::unordered_map<const Node*, Expr>;
+using analysis::dependency_graph::CompactGraph;
 using analysis::dependency_graph::GetListSize;
 
 /*! Chain, Wave, and Partition are used to describe a wavefront schedule. */
@@ -34,46 +37,39 @@ using Partition = std::vector<Wave>;
  * \return The wavefront partition.
  */
 Partition WavefrontPartition(DependencyGraph* dg) {
-  std::vector<Node*>& nodes = dg->post_dfs_order;
-
-  std::unordered_map<Node*, int> in_degree, out_degree;
-  for (auto& node : nodes) {
-    for (auto child = node->children.head; child; child = child->next) {
-      Node* child_node = child->value;
-      in_degree[child_node]++;
-      out_degree[node]++;
-    }
-  }
+  CompactGraph graph(dg->post_dfs_order);
+  int n = graph.NumNodes();
 
-  std::vector<Node*> free_nodes;
-  for (auto& node : nodes) {
-    if (out_degree[node] == 0) {
-      free_nodes.push_back(node);
+  std::vector<int> out_degree(n);
+  std::vector<int> free_nodes;
+  for (int i = 0; i < n; ++i) {
+    out_degree[i] = static_cast<int>(graph.Children(i).size());
+    if (out_degree[i] == 0) {
+      free_nodes.push_back(i);
     }
   }
 
   Partition partition;
+  std::vector<int> chain_ends;
   while (!free_nodes.empty()) {
     Wave wave;
+    chain_ends.clear();
 
-    for (auto node : free_nodes) {
+    for (int node : free_nodes) {
       // Each free node corresponds to a chain
       // There are three cases of the number of the free node's parents
       // case 1. no parent
       // case 2. one parents
       // case 3. two or more parents
       Chain chain;
-      if (GetListSize(node->parents) != 1) {
-        // case 1 and case 3. There is only the free node in this chain
-        chain.push_back(node);
-      } else {
+      chain.push_back(graph.GetNode(node));
+      if (graph.Parents(node).size() == 1) {
         // case 2. There are more than one nodes in this chain, starting from the free node
-        chain.push_back(node);
-        Node* next_node = node->parents.head->value;
-        while (GetListSize(next_node->parents) == 1 && out_degree[next_node] == 1) {
-          chain.push_back(next_node);
+        int next_node = *graph.Parents(node).begin();
+        while (graph.Parents(next_node).size() == 1 && out_degree[next_node] == 1) {
+          chain.push_back(graph.GetNode(next_node));
           node = next_node;
-          next_node = node->parents.head->value;
+          next_node = *graph.Parents(node).begin();
           CHECK_GE(out_degree[next_node], 1);
         }
         // There are three sub cases to stop growing this chain:
@@ -84,18 +80,19 @@ Partition WavefrontPartition(DependencyGraph* dg) {
         // sub case 3. Both of sub case 1 and sub case 2.
         // For sub case 2, we should also take next_node into this chain.
         if (out_degree[next_node] == 1) {
-          chain.push_back(next_node);
+          chain.push_back(graph.GetNode(next_node));
+          node = next_node;
         }
       }
+      // case 1 and case 3. There is only the free node in this chain
       wave.push_back(chain);
+      chain_ends.push_back(node);
     }
     free_nodes.clear();
-    for (auto& chain : wave) {
-      Node* last_node = chain.back();
-      for (auto parent = last_node->parents.head; parent; parent = parent->next) {
-        Node* parent_node = parent->value;
-        if (--out_degree[parent_node] == 0) {
-          free_nodes.push_back(parent_node);
+    for (int last_node : chain_ends) {
+      for (int parent : graph.Parents(last_node)) {
+        if (--out_degree[parent] == 0) {
+          free_nodes.push_back(parent);
         }
       }
     }
@@ -104,24 +101,52 @@ Partition WavefrontPartition(DependencyGraph* dg) {
   return partition;
 }
 
+/*! \brief The vector clock of a stream, mapping each stream to the number of its chains done. */
+using Clock = std::unordered_map<int64_t, int>;
+
+/*! \brief Merge the clock src into the clock dst. */
+void MergeClock(const Clock& src, Clock* dst) {
+  for (const auto& it : src) {
+    int& seq = (*dst)[it.first];
+    seq = std::max(seq, it.second);
+  }
+}
+
+/*!
+ * \brief The synchronization plan of a wavefront schedule. The chains are numbered in the order of
+ * the waves.
+ */
+struct SyncPlan {
+  /*! \brief The stream of each chain. */
+  std::vector<int64_t> chain_stream;
+  /*! \brief The chains whose events each chain waits for before it starts. */
+  std::vector<std::vector<int>> chain_waits;
+  /*! \brief Whether each wave starts with a stream barrier. */
+  std::vector<bool> wave_barrier;
+};
+
 class WavefrontScheduler : public StreamSchedulerBase {
  public:
   /*!
    * Generate the wavefront stream schedule. The input expr e is a dataflow graph in GNF format and
    * the output is the scheduled e in ANF.
    *
-   * There are two steps in the schedule function:
+   * There are three steps in the schedule function:
    *
    *  step 1. Create a dataflow graph of input expr. We can get the dataflow graph by removing the
    *          nodes in dependency graph whose corresponding expr is atomic. Here atomic
    *          expr is an expr that does not influence the data flow graph structure. After this
    * step, the remaining nodes in the dataflow graph are CallNode, TupleNode, TupleGetItemNode.
    *
-   *  step 2. Use the dataflow graph got in step 1 to issue the operator call in a schedule-specific
-   *          order. Meanwhile, it would inject raf.op.set_stream, raf.op.add_event, and
-   *          raf.op.wait_event operators to manage the synchronization.
+   *  step 2. Partition the dataflow graph into waves of chains, split the waves that exceed the
+   *          memory budget, and plan the synchronization between the waves. See SplitWaves and
+   *          PlanSync.
    *
-   *  When we finish the above two steps, we get the ANF of the scheduled computation graph.
+   *  step 3. Use the partition to issue the operator call in a schedule-specific order.
+   *          Meanwhile, it would inject raf.op.set_stream, raf.op.add_event, raf.op.wait_event and
+   *          raf.op.stream_barrier operators to manage the synchronization.
+   *
+   *  When we finish the above steps, we get the ANF of the scheduled computation graph.
    *
    * \param e The expr that we want to schedule. It should be a pure dataflow graph expr and should
    *          not contains any node that introduces new scope (such as FunctionNode, LetNode, and
@@ -139,23 +164,219 @@ class WavefrontScheduler : public StreamSchedulerBase {
     }
 
     Partition partition = WavefrontPartition(&dg);
+    std::vector<bool> split_waves(partition.size(), false);
+    if (memory_budget_ > 0) {
+      partition = SplitWaves(partition, node_expr, &split_waves);
+    }
+    SyncPlan plan = PlanSync(partition, split_waves);
 
+    std::vector<bool> need_event(plan.chain_stream.size(), false);
+    for (const auto& waits : plan.chain_waits) {
+      for (int producer : waits) {
+        need_event[producer] = true;
+      }
+    }
+    std::vector<int64_t> chain_event(plan.chain_stream.size(), -1);
+    int64_t event_id_clock = 0;
+    int chain_id = 0;
     for (int i = 0; i < partition.size(); i++) {
       Wave& wave = partition.at(i);
-      for (int j = 0; j < wave.size(); j++) {
-        Chain& chain = wave[j];
-        AnnotateSetStream(0, j);
-        for (Node* node : chain) {
+      if (plan.wave_barrier[i]) {
+        AnnotateStreamBarrier();
+      }
+      int critical = GetCriticalChain(wave);
+      for (int j = 0; j < wave.size(); j++, chain_id++) {
+        AnnotateGroupStream(j, critical);
+        for (int producer : plan.chain_waits[chain_id]) {
+          CHECK_GE(chain_event[producer], 0);
+          AnnotateWaitEvent(chain_event[producer]);
+        }
+        for (Node* node : wave[j]) {
           Expr expr = node_expr.at(node);
           VisitExpr(expr);
         }
-      }
-      if (i + 1 < partition.size()) {
-        AnnotateStreamBarrier();
+        if (need_event[chain_id]) {
+          chain_event[chain_id] = event_id_clock++;
+          AnnotateAddEvent(chain_event[chain_id]);
+        }
       }
     }
     return let_list_.Get(VisitExpr(e));
   }
+
+ private:
+  /*! \brief The longest chain is the critical path of the wave. */
+  static int GetCriticalChain(const Wave& wave) {
+    int critical = 0;
+    for (int j = 1; j < wave.size(); j++) {
+      if (wave[j].size() > wave[critical].size()) {
+        critical = j;
+      }
+    }
+    return critical;
+  }
+
+  /*!
+   * \brief Split the waves whose live tensors exceed the memory budget. The chains of a wave are
+   * packed into sub-waves in order, and a chain starts a new sub-wave if the tensors live during
+   * the current one would exceed the budget. A tensor is live from the wave that produces it to
+   * the last wave that consumes it, and all tensors produced by a wave are live together, as its
+   * chains run concurrently. A chain exceeding the budget by itself still gets a sub-wave.
+   * \param partition The wavefront partition.
+   * \param node_expr The expr of each node.
+   * \param split_waves Whether each wave is split from the previous one, which has to be finished
+   * before the wave starts.
+   * \return The wavefront partition within the memory budget.
+   */
+  Partition SplitWaves(const Partition& partition, const NodeExprMap& node_expr,
+                       std::vector<bool>* split_waves) {
+    std::unordered_map<const Node*, int64_t> node_bytes;
+    for (const auto& it : node_expr) {
+      node_bytes[it.first] = GetOutputBytes(it.second);
+    }
+    // The number of the consumers not scheduled yet of each scheduled node, and their live bytes.
+    std::unordered_map<const Node*, int> remaining_consumers;
+    int64_t live_bytes = 0;
+    auto commit = [&](const Wave& wave) {
+      for (const Chain& chain : wave) {
+        for (Node* node : chain) {
+          remaining_consumers[node] = GetListSize(node->parents);
+          live_bytes += node_bytes[node];
+        }
+      }
+      for (const Chain& chain : wave) {
+        for (Node* node : chain) {
+          for (auto child = node->children.head; child; child = child->next) {
+            auto it = remaining_consumers.find(child->value);
+            if (it != remaining_consumers.end() && --it->second == 0) {
+              live_bytes -= node_bytes[child->value];
+            }
+          }
+        }
+      }
+    };
+
+    Partition split;
+    split_waves->clear();
+    for (const Wave& wave : partition) {
+      Wave curr;
+      int64_t curr_bytes = 0;
+      auto flush = [&](bool is_split) {
+        commit(curr);
+        split.push_back(std::move(curr));
+        split_waves->push_back(is_split);
+        curr = Wave();
+        curr_bytes = 0;
+      };
+      bool is_split = false;
+      for (const Chain& chain : wave) {
+        int64_t chain_bytes = 0;
+        for (Node* node : chain) {
+          chain_bytes += node_bytes[node];
+        }
+        if (!curr.empty() && live_bytes + curr_bytes + chain_bytes > memory_budget_) {
+          flush(is_split);
+          is_split = true;
+        }
+        curr.push_back(chain);
+        curr_bytes += chain_bytes;
+      }
+      flush(is_split);
+    }
+    return split;
+  }
+
+  /*!
+   * \brief Plan the synchronization of the waves. A chain waits for the events of the chains on
+   * other streams it depends on, so that a wave only waits for the streams that feed it and may
+   * overlap with the tail of the previous wave. Each stream keeps a vector clock of the chains
+   * known to be done on it, which skips the waits implied by the previous ones. A stream barrier is
+   * only kept where all the streams truly converge, i.e., a wave of a single chain that depends on
+   * all the chains of the previous wave, where one barrier is cheaper than a wait per stream.
+   * \param partition The wavefront partition.
+   * \param split_waves Whether each wave is split from the previous one, see SplitWaves.
+   * \return The synchronization plan.
+   */
+  SyncPlan PlanSync(const Partition& partition, const std::vector<bool>& split_waves) {
+    SyncPlan plan;
+    plan.wave_barrier.resize(partition.size(), false);
+    std::unordered_map<const Node*, int> node_chain;
+    std::vector<int> chain_seq;
+    std::vector<Clock> chain_snapshot;
+    std::unordered_map<int64_t, Clock> stream_clock;
+    std::unordered_map<int64_t, int> stream_seq;
+    // The clock of all the streams after the last barrier, which a new stream starts with.
+    Clock barrier_clock;
+
+    int first_chain = 0;
+    for (int i = 0; i < partition.size(); i++) {
+      const Wave& wave = partition.at(i);
+      int critical = GetCriticalChain(wave);
+      std::vector<std::set<int>> wave_deps(wave.size());
+      for (int j = 0; j < wave.size(); j++) {
+        for (Node* node : wave[j]) {
+          for (auto child = node->children.head; child; child = child->next) {
+            auto it = node_chain.find(child->value);
+            if (it != node_chain.end()) {
+              wave_deps[j].insert(it->second);
+            }
+          }
+        }
+      }
+
+      // A wave split from the previous one for the memory budget has to wait for it entirely.
+      bool converge = i > 0 && split_waves[i];
+      if (i > 0 && wave.size() == 1 && partition[i - 1].size() > 1) {
+        int num_prev = partition[i - 1].size();
+        bool depend_all = true;
+        for (int k = first_chain - num_prev; k < first_chain; k++) {
+          depend_all &= wave_deps[0].count(k) > 0;
+        }
+        converge |= depend_all;
+      }
+      if (converge) {
+        plan.wave_barrier[i] = true;
+        for (const auto& it : stream_clock) {
+          MergeClock(it.second, &barrier_clock);
+        }
+        for (auto& it : stream_clock) {
+          it.second = barrier_clock;
+        }
+      }
+
+      for (int j = 0; j < wave.size(); j++) {
+        int64_t stream = GetGroupStream(j, critical);
+        if (!stream_clock.count(stream)) {
+          stream_clock[stream] = barrier_clock;
+        }
+        Clock& clock = stream_clock[stream];
+        std::vector<int> waits;
+        // Visit the latest producers first, whose clocks are more likely to cover the others.
+        for (auto it = wave_deps[j].rbegin(); it != wave_deps[j].rend(); ++it) {
+          int producer = *it;
+          int64_t producer_stream = plan.chain_stream[producer];
+          auto synced = clock.find(producer_stream);
+          if (synced != clock.end() && synced->second >= chain_seq[producer]) {
+            continue;
+          }
+          waits.push_back(producer);
+          MergeClock(chain_snapshot[producer], &clock);
+        }
+        std::sort(waits.begin(), waits.end());
+        int seq = ++stream_seq[stream];
+        clock[stream] = seq;
+        for (Node* node : wave[j]) {
+          node_chain[node] = plan.chain_stream.size();
+        }
+        plan.chain_stream.push_back(stream);
+        plan.chain_waits.push_back(waits);
+        chain_seq.push_back(seq);
+        chain_snapshot.push_back(clock);
+      }
+      first_chain += wave.size();
+    }
+    return plan;
+  }
 };
 
 Expr WavefrontScheduleTransform(const Expr& e) {
@@ -169,6 +390,10 @@ Pass WavefrontStreamSchedule() {
   tvm::TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func =
       [=](Function f, IRModule m, PassContext pc) {
         auto transform = wavefront_stream_schedule::WavefrontScheduleTransform;
+        if (pc->GetConfig("raf.stream_schedule.memory_budget_mbs", Integer(0)).value()->value > 0) {
+          // The memory budget is checked with the sizes of the tensors.
+          f = Downcast<Function>(pass::InferType(f));
+        }
         return Downcast<Function>(tvm::relay::TransformF(transform, f));
       };
   return CreateRAFFunctionPass(pass_func, 1, "WavefrontStreamSchedule", {});
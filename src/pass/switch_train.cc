@@ -27,6 +27,7 @@ namespace switch_train {
 // Register the op pairs for inference/training variants.
 RAF_OP_TRAIN_VARIANT("raf.op.layer_norm", "raf.op.layer_norm_train");
 RAF_OP_INFER_VARIANT("raf.op.layer_norm_train", "raf.op.layer_norm");
+RAF_OP_INFER_VARIANT("raf.op.batch_norm_train", "raf.op.batch_norm_infer");
 
 class OpReplacer : public ExprMutator {
  public:
@@ -41,6 +42,7 @@ class OpReplacer : public ExprMutator {
   }
 
   Expr VisitExpr_(const LetNode* node) override {
+    static const Op& dropout = Op::Get("raf.op._contrib_dropout");
     auto switch_op_map = Op::GetAttrMap<std::string>((to_train_op_) ? "TrainOp" : "InferOp");
 
     scopes_.emplace_back(new LetList);
@@ -65,9 +67,18 @@ class OpReplacer : public ExprMutator {
             auto new_var = scope->Push(new_call);
             value = TupleGetItem(new_var, 0);
           } else {
-            no_tuple_vars_.insert(curr_var);
+            tuple_fields_[curr_var] = {curr_var};
+            if (op_node->name == "raf.op.batch_norm_train") {
+              // The running mean and variance are not updated in inference.
+              tuple_fields_[curr_var].push_back(node->args[1]);
+              tuple_fields_[curr_var].push_back(node->args[2]);
+            }
             value = new_call;
           }
+        } else if (!to_train_op_ && node->op.same_as(dropout)) {
+          // Dropout is an identity in inference, and its mask and states are not used.
+          tuple_fields_[curr_var] = {curr_var};
+          value = node->args[0];
         } else {
           value = VisitExpr(value);
         }
@@ -86,10 +97,12 @@ class OpReplacer : public ExprMutator {
 
   Expr VisitExpr_(const TupleGetItemNode* node) override {
     auto tuple_var = Downcast<Var>(node->tuple);
-    if (no_tuple_vars_.find(tuple_var) != no_tuple_vars_.end()) {
-      CHECK_EQ(node->index, 0U)
-          << "InternalError: The TupleGetItem for a switable op does not take the first element";
-      return tuple_var;
+    auto it = tuple_fields_.find(tuple_var);
+    if (it != tuple_fields_.end()) {
+      CHECK_LT(static_cast<size_t>(node->index), it->second.size())
+          << "InternalError: The TupleGetItem for a switable op takes the element " << node->index
+          << ", which is not available in the inference op";
+      return it->second[node->index];
     }
     return TupleGetItem(tuple_var, node->index);
   }
@@ -97,8 +110,11 @@ class OpReplacer : public ExprMutator {
  private:
   /*! \brief The scope stack of the let list. */
   std::vector<std::unique_ptr<LetList>> scopes_;
-  /*! \brief The let-binding vars that are no longer tuples after transform. */
-  std::unordered_set<Var, ObjectPtrHash, ObjectPtrEqual> no_tuple_vars_;
+  /*!
+   * \brief The let-binding vars that are no longer tuples after transform, mapping to the
+   * replacements of their tuple fields.
+   */
+  std::unordered_map<Var, std::vector<Expr>, ObjectPtrHash, ObjectPtrEqual> tuple_fields_;
   /*! \brief The target function. */
   Function func_;
   /*! \brief Switch to training or inference op. */
@@ -0,0 +1,322 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file tensor_parallel.cc
+ * \brief Intra-layer model parallelism of GEMMs. The weights of matmul, dense and batch_matmul
+ * are annotated by name to be sharded across ranks in one of the following ways:
+ * "col": The output features are sharded, so each rank computes a slice of the last axis of
+ *        the output. The slices stay local through the following elementwise and broadcast ops
+ *        (e.g., bias add with a "col" bias and activations), and are all-gathered only when a
+ *        complete tensor is required.
+ * "row": The reduction axis is sharded, so each rank computes a partial sum from a slice of
+ *        the last axis of the input, and the partial sums are all-reduced. If the input is
+ *        already sliced by a "col" GEMM, it is used as is, so a "col" layer followed by a "row"
+ *        layer (e.g., the MLP of a transformer layer) only needs one all-reduce.
+ * The annotated parameters are replaced by their local shards, so the local GEMMs are typed
+ * with the sharded shapes. The inserted collectives are later scheduled to the communication
+ * stream and overlapped with the neighbouring computation by EnforceSync.
+ */
+#include "raf/pass.h"
+#include "raf/op_utils.h"
+#include "raf/dialect.h"
+
+#include "./common.h"
+
+namespace raf {
+namespace pass {
+namespace tensor_parallel {
+
+using namespace raf::op;
+
+/*! \brief The axis of the weight to be sharded for the given GEMM and sharding spec. */
+int GetWeightShardAxis(const Op& op, const std::string& spec) {
+  static std::unordered_map<std::string, std::pair<int, int>> col_row_axes = {
+      {"raf.op.matmul", {1, 0}},       {"raf.op.dense", {0, 1}},
+      {"raf.op.matmul_nt", {0, 1}},    {"raf.op.batch_matmul", {2, 1}},
+      {"raf.op.batch_matmul_nt", {1, 2}}};
+  auto it = col_row_axes.find(op->name);
+  if (it == col_row_axes.end()) {
+    return -1;
+  }
+  return spec == "col" ? it->second.first : it->second.second;
+}
+
+class TensorParallelRewriter {
+ public:
+  TensorParallelRewriter(const Function& func, const Map<String, String>& specs, int n_part,
+                         int rank)
+      : func_(func), n_part_(n_part), rank_(rank) {
+    for (const auto& param : func->params) {
+      if (specs.count(param->name_hint())) {
+        std::string spec = specs[param->name_hint()];
+        CHECK(spec == "col" || spec == "row")
+            << "Unknown sharding spec " << spec << " of " << param->name_hint();
+        specs_[param.get()] = spec;
+      }
+    }
+  }
+
+  Function Rewrite() {
+    if (specs_.empty() || n_part_ <= 1) {
+      return func_;
+    }
+    auto ell = ExplicitLetList::make(func_->body);
+    InferShardAxes(ell.get());
+
+    // Replace the sharded parameters with their local shards.
+    Array<Var> new_params;
+    for (const auto& param : func_->params) {
+      if (!shard_axes_.count(param.get())) {
+        new_params.push_back(param);
+        continue;
+      }
+      auto ttype = param->checked_type().as<TensorTypeNode>();
+      int axis = shard_axes_[param.get()];
+      Array<PrimExpr> shape{ttype->shape};
+      shape.Set(axis, Integer(GetDim(ttype, axis) / n_part_));
+      auto local = MakeVar(param->name_hint() + "_local", TensorType(shape, ttype->dtype));
+      new_params.push_back(local);
+      local_[param.get()] = local;
+    }
+
+    ell_ = std::make_unique<ExplicitLetList>();
+    for (size_t i = 0; i < ell->vars.size(); ++i) {
+      const auto& var = ell->vars[i];
+      const auto& expr = ell->exprs[i];
+      auto call = expr.as<CallNode>();
+      if (call && call->op->IsInstance<OpNode>()) {
+        auto op = Downcast<Op>(call->op);
+        auto spec = (call->args.size() > 1) ? WeightSpec(call) : "";
+        if (!spec.empty() && GetWeightShardAxis(op, spec) != -1) {
+          RewriteGemm(var, call);
+          continue;
+        } else if (IsShardedElemwise(call)) {
+          Array<Expr> args;
+          for (const auto& arg : call->args) {
+            args.push_back(GetLocal(arg));
+          }
+          auto local = MakeVar(var->name_hint() + "_local", {});
+          ell_->Push(local, Call(op, args));
+          local_[var.get()] = local;
+          continue;
+        }
+      }
+      // Other bindings use the complete tensors.
+      for (const auto& fv : FreeVars(expr)) {
+        CHECK(!specs_.count(fv.get()))
+            << "The sharded parameter " << fv->name_hint() << " cannot be used by " << expr;
+        Materialize(fv);
+      }
+      ell_->Push(var, expr);
+    }
+    Materialize(ell->ret);
+    ell_->ret = ell->ret;
+    return Function(new_params, ell_->AsExpr(), {}, {}, func_->attrs);
+  }
+
+ private:
+  /*! \brief Decide the shard axis of each annotated parameter from the GEMM that uses it. */
+  void InferShardAxes(ExplicitLetList* ell) {
+    for (const auto& expr : ell->exprs) {
+      auto call = expr.as<CallNode>();
+      if (!call || !call->op->IsInstance<OpNode>()) {
+        continue;
+      }
+      auto op = Downcast<Op>(call->op);
+      for (size_t i = 0; i < call->args.size(); ++i) {
+        auto var = call->args[i].as<VarNode>();
+        if (!var || !specs_.count(var)) {
+          continue;
+        }
+        int axis = (i == 1) ? GetWeightShardAxis(op, specs_[var]) : -1;
+        if (axis == -1) {
+          // A "col" parameter can also be used by elementwise ops such as a bias add, where it
+          // is sharded along its last axis. Other uses are not supported.
+          CHECK(specs_[var] == "col" && IsElemwiseOrBroadcast(op))
+              << "The sharded parameter " << var->name_hint() << " is used by "
+              << op->name << ", which cannot be sharded";
+          axis = var->checked_type().as<TensorTypeNode>()->shape.size() - 1;
+        }
+        CHECK(!shard_axes_.count(var) || shard_axes_[var] == axis)
+            << "The sharded parameter " << var->name_hint() << " is used with different layouts";
+        auto ttype = var->checked_type().as<TensorTypeNode>();
+        CHECK_EQ(GetDim(ttype, axis) % n_part_, 0)
+            << "The axis " << axis << " of " << var->name_hint() << " is not dividable by "
+            << n_part_;
+        shard_axes_[var] = axis;
+      }
+    }
+  }
+
+  /*! \brief Rewrite a GEMM with a sharded weight. */
+  void RewriteGemm(const Var& var, const CallNode* call) {
+    static const Op& allreduce_op = Op::Get("raf.op._allreduce");
+    static const Op& split_op = Op::Get("raf.op.split");
+    auto weight = local_.at(call->args[1].as<VarNode>());
+    Array<Expr> args{call->args};
+    args.Set(1, weight);
+    if (WeightSpec(call) == "col") {
+      // Each rank computes a slice of the output features.
+      args.Set(0, Materialize(call->args[0]));
+      auto local = MakeVar(var->name_hint() + "_local", {});
+      ell_->Push(local, Call(call->op, args));
+      local_[var.get()] = local;
+      return;
+    }
+
+    // Each rank computes a partial sum from a slice of the input.
+    auto x = call->args[0];
+    if (!IsLocal(x)) {
+      auto ndim = x->checked_type().as<TensorTypeNode>()->shape.size();
+      auto split = MakeVar("x_split", {});
+      ell_->Push(split, Call(split_op, {x, MakeConstant(ScalarValue::make(n_part_)),
+                                        MakeConstant(ScalarValue::make(ndim - 1))}));
+      auto x_local = MakeVar("x_local", {});
+      ell_->Push(x_local, TupleGetItem(split, rank_));
+      args.Set(0, x_local);
+    } else {
+      args.Set(0, GetLocal(x));
+    }
+    auto partial = MakeVar(var->name_hint() + "_partial", {});
+    ell_->Push(partial, Call(call->op, args));
+    auto partial_tuple = MakeVar(var->name_hint() + "_partial_tuple", {});
+    ell_->Push(partial_tuple, Tuple({partial}));
+    ell_->Push(var, Call(allreduce_op, {partial_tuple, MakeConstant(StringValue::make("sum")),
+                                        MakeConstant(NullValue<Value>())}));
+  }
+
+  /*!
+   * \brief Get the complete tensor of a var. The slices along the last axis are all-gathered
+   * on demand, and the original var is bound to the gathered tensor. The desired IR is:
+   * let %1 = swap_axis(%x_local, 0, ndim - 1); // Omitted if ndim is 1.
+   * let %2 = _allgather(%1, 0);
+   * let %x = swap_axis(%2, 0, ndim - 1);
+   */
+  Expr Materialize(const Expr& expr) {
+    static const Op& swap_axis_op = Op::Get("raf.op.swap_axis");
+    static const Op& allgather_op = Op::Get("raf.op._allgather");
+    if (!IsLocal(expr) || gathered_.count(expr.as<VarNode>())) {
+      return expr;
+    }
+    auto var = Downcast<Var>(expr);
+    gathered_.insert(var.get());
+    Expr local = local_[var.get()];
+    int last = var->checked_type().as<TensorTypeNode>()->shape.size() - 1;
+    auto swap = [&](const Expr& x) {
+      return Call(swap_axis_op, {x, MakeConstant(ScalarValue::make(0)),
+                                 MakeConstant(ScalarValue::make(last))});
+    };
+    if (last > 0) {
+      auto swapped = MakeVar(var->name_hint() + "_swap", {});
+      ell_->Push(swapped, swap(local));
+      local = swapped;
+    }
+    Expr gather = Call(allgather_op, {local, MakeConstant(ScalarValue::make(0)),
+                                      MakeConstant(NullValue<Value>())});
+    if (last > 0) {
+      auto gathered = MakeVar(var->name_hint() + "_gather", {});
+      ell_->Push(gathered, gather);
+      gather = swap(gathered);
+    }
+    ell_->Push(var, gather);
+    return var;
+  }
+
+  /*! \brief Whether the complete tensor of the var is only available as local slices. */
+  bool IsLocal(const Expr& expr) {
+    auto var = expr.as<VarNode>();
+    return var && local_.count(var) && !specs_.count(var);
+  }
+
+  /*! \brief Get the local slice of a sharded var, or the expression itself otherwise. */
+  Expr GetLocal(const Expr& expr) {
+    auto var = expr.as<VarNode>();
+    return (var && local_.count(var)) ? local_[var] : expr;
+  }
+
+  /*! \brief The sharding spec of the weight of a GEMM call, or empty if not sharded. */
+  std::string WeightSpec(const CallNode* call) {
+    auto var = call->args[1].as<VarNode>();
+    return (var && specs_.count(var)) ? specs_[var] : "";
+  }
+
+  /*!
+   * \brief Whether the call is an elementwise or broadcast op that can be computed on the
+   * local slices, meaning that all its tensor arguments are sliced along the last axis.
+   */
+  bool IsShardedElemwise(const CallNode* call) {
+    if (!IsElemwiseOrBroadcast(Downcast<Op>(call->op))) {
+      return false;
+    }
+    bool has_sliced = false;
+    for (const auto& arg : call->args) {
+      if (auto var = arg.as<VarNode>()) {
+        if (local_.count(var)) {
+          has_sliced |= !specs_.count(var);
+          continue;
+        }
+        auto ttype = var->checked_type().as<TensorTypeNode>();
+        if (ttype && ttype->shape.empty()) {
+          continue;  // Scalars are broadcasted to the slices.
+        }
+        return false;
+      } else if (auto constant = arg.as<ConstantNode>()) {
+        if (constant->value.as<TensorValueObj>()) {
+          return false;
+        }
+      }
+    }
+    return has_sliced;
+  }
+
+  bool IsElemwiseOrBroadcast(const Op& op) {
+    auto tvm_op = OpDialect::Lower(op, "tvm");
+    if (!tvm_op.defined()) {
+      return false;
+    }
+    int pattern = GetOpAttrOrDefault<TOpPattern>(tvm_op, "TOpPattern", kOpaque);
+    return pattern <= kBroadcast;
+  }
+
+  int64_t GetDim(const TensorTypeNode* ttype, int axis) {
+    auto dim = ttype->shape[axis].as<IntImmNode>();
+    CHECK(dim != nullptr) << "Do not support dynamic shape yet";
+    return dim->value;
+  }
+
+  /*! \brief The target function. */
+  Function func_;
+  /*! \brief The number of ranks to shard the weights. */
+  int n_part_;
+  /*! \brief The rank of the current device. */
+  int rank_;
+  /*! \brief Mapping from an annotated parameter to its sharding spec. */
+  std::unordered_map<const VarNode*, std::string> specs_;
+  /*! \brief Mapping from an annotated parameter to the axis to be sharded. */
+  std::unordered_map<const VarNode*, int> shard_axes_;
+  /*! \brief Mapping from a var to its local slice, or a sharded parameter to its shard. */
+  std::unordered_map<const VarNode*, Var> local_;
+  /*! \brief The sliced vars that have been all-gathered. */
+  std::unordered_set<const VarNode*> gathered_;
+  /*! \brief The rewritten let list. */
+  std::unique_ptr<ExplicitLetList> ell_;
+};
+
+}  // namespace tensor_parallel
+
+Pass TensorParallel(Map<String, String> specs, int n_part, int rank) {
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
+                                                                             PassContext pc) {
+    return tensor_parallel::TensorParallelRewriter(f, specs, n_part, rank).Rewrite();
+  };
+  auto tensor_parallel = CreateRAFFunctionPass(pass_func, 0, "TensorParallelFunc", {});
+  return RAFSequential({InferType(), tensor_parallel, EraseType()}, "TensorParallel");
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.TensorParallel").set_body_typed(TensorParallel);
+
+}  // namespace pass
+}  // namespace raf
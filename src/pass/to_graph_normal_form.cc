@@ -107,7 +107,7 @@ Pass ToGraphNormalForm() {
                                                                              PassContext pc) {
     return Downcast<Function>(to_graph_normal_form::GNFConverter().Mutate(f));
   };
-  return CreateRAFFunctionPass(pass_func, 1, "ToGraphNormalForm", {});
+  return CreateRAFFunctionPass(pass_func, 1, "ToGraphNormalForm", {}, /*thread_safe=*/true);
 }
 
 RAF_REGISTER_GLOBAL("raf.pass_.ToGraphNormalForm").set_body_typed(ToGraphNormalForm);
@@ -11,6 +11,9 @@
 #include <tvm/ir/module.h>
 #include <tvm/ir/type_functor.h>
 #include <tvm/tir/op.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
 #include "raf/op.h"
 #include "raf/ir.h"
 #include "raf/pass.h"
@@ -30,6 +33,82 @@ using namespace raf::value;
 
 Type Unify(const Type& src, const Type& dst);
 
+/*!
+ * \brief Whether the value can be a key of the primitive type cache. The tensors are compared by
+ * their addresses, and the closures are not supported.
+ */
+bool IsCacheableValue(const Value& value) {
+  if (!value.defined() || value->IsInstance<ScalarValueObj>() ||
+      value->IsInstance<TensorValueObj>() || value->IsInstance<TensorTypeValueObj>() ||
+      value->IsInstance<StringValueObj>() || value->IsInstance<NoGradValueObj>()) {
+    return true;
+  }
+  if (const auto* tuple = value.as<TupleValueObj>()) {
+    for (const auto& field : tuple->fields) {
+      if (!IsCacheableValue(field)) {
+        return false;
+      }
+    }
+    return true;
+  }
+  return false;
+}
+
+/*! \brief Whether the type is fully inferred. */
+bool IsCompleteType(const Type& type) {
+  if (!type.defined() || type->IsInstance<IncompleteTypeNode>()) {
+    return false;
+  }
+  if (const auto* tuple = type.as<TupleTypeNode>()) {
+    for (const auto& field : tuple->fields) {
+      if (!IsCompleteType(field)) {
+        return false;
+      }
+    }
+  } else if (const auto* func = type.as<FuncTypeNode>()) {
+    for (const auto& arg_type : func->arg_types) {
+      if (!IsCompleteType(arg_type)) {
+        return false;
+      }
+    }
+    return IsCompleteType(func->ret_type);
+  }
+  return true;
+}
+
+/*!
+ * \brief The cache of the inferred types of primitive ops keyed by the op and its argument values,
+ * which are the types of the non-constant arguments. It is shared by all InferType runs, since
+ * the same ops with the same input types are inferred repeatedly across the pass pipeline.
+ */
+class PrimitiveTypeCache {
+ public:
+  static PrimitiveTypeCache* Get() {
+    static PrimitiveTypeCache cache;
+    return &cache;
+  }
+
+  Type Lookup(const Array<ObjectRef>& key) {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto it = cache_.find(key);
+    return it != cache_.end() ? it->second : Type();
+  }
+
+  void Insert(const Array<ObjectRef>& key, const Type& type) {
+    std::lock_guard<std::mutex> lock(mu_);
+    // The entries hold the constant tensors, so the cache is bounded.
+    if (cache_.size() >= kCapacity) {
+      cache_.clear();
+    }
+    cache_.emplace(key, type);
+  }
+
+ private:
+  static constexpr size_t kCapacity = 1 << 16;
+  std::unordered_map<Array<ObjectRef>, Type, tvm::StructuralHash, tvm::StructuralEqual> cache_;
+  std::mutex mu_;
+};
+
 #define RAF_NODE_NOT_IMPL(NodeType)                     \
   Expr VisitExpr_(const NodeType* node) override {      \
     LOG(FATAL) << "NotImplementedError: " << #NodeType; \
@@ -71,8 +150,7 @@ class TypeInferencer : public ExprMutator {
     return std::move(GetRef<GlobalVar>(op));
   }
 
-  CallValues SchemaToValue(Array<Expr> args, const OpNode* op) {
-    CallValues call_values = CallValues::make();
+  Array<Value> ArgValues(const Array<Expr>& args) {
     Array<Value> arg_values;
     for (const auto& arg : args) {
       if (var_value_map_.count(arg.as<VarNode>())) {
@@ -81,6 +159,15 @@ class TypeInferencer : public ExprMutator {
         arg_values.push_back(GetValue(arg));
       }
     }
+    return arg_values;
+  }
+
+  CallValues SchemaToValue(Array<Expr> args, const OpNode* op) {
+    return SchemaToValue(ArgValues(args), op);
+  }
+
+  CallValues SchemaToValue(const Array<Value>& arg_values, const OpNode* op) {
+    CallValues call_values = CallValues::make();
     call_values->args = GetOpAttr<op::FRAFSchema>(GetRef<Op>(op), "FRAFSchema")(arg_values);
     call_values->callee = OpValue::make(GetRef<Op>(op));
     return call_values;
@@ -180,13 +267,31 @@ class TypeInferencer : public ExprMutator {
         return IncompleteType(kType);
       }
     }
-    CallValues call_values = SchemaToValue(call->args, op);
+    Array<Value> arg_values = ArgValues(call->args);
+    bool cacheable = true;
+    for (const auto& value : arg_values) {
+      cacheable = cacheable && IsCacheableValue(value);
+    }
+    Array<ObjectRef> key;
+    if (cacheable) {
+      key.push_back(GetRef<Op>(op));
+      key.push_back(arg_values);
+      Type type = PrimitiveTypeCache::Get()->Lookup(key);
+      if (type.defined()) {
+        return type;
+      }
+    }
+    CallValues call_values = SchemaToValue(arg_values, op);
     // invoke type inference
     auto fty = Downcast<FuncType>(op->checked_type());
     CHECK_EQ(fty->type_constraints.size(), 1);
     TypeInference ti = Downcast<TypeInference>(fty->type_constraints[0]);
     try {
-      return ti->func(call_values);
+      Type type = ti->func(call_values);
+      if (cacheable) {
+        PrimitiveTypeCache::Get()->Insert(key, type);
+      }
+      return type;
     } catch (const dmlc::Error& e) {
       LOG(FATAL) << "Failed to infer type of the following primitive: " << std::endl
                  << raf::ir::AsText(call) << std::endl
@@ -230,12 +335,44 @@ class TypeInferencer : public ExprMutator {
     if (!fn || !fn->HasNonzeroAttr(attr::kPrimitive)) {
       return;
     }
+    if (IsInferredFor(fn, args)) {
+      // The body has been inferred with the same argument types (e.g., in the previous InferType
+      // run of the pipeline), so it is not visited again.
+      fn_var->checked_type_ = fn->checked_type();
+      return;
+    }
     UpdateFuncParamVarMap(fn, args);
     auto new_fn = VisitExpr(GetRef<Function>(fn));
     fn_var->checked_type_ = new_fn->checked_type();
     var_value_map_[fn_var] = new_fn;
   }
 
+  /*!
+   * \brief Whether the primitive function has been fully inferred with the types of the caller
+   * arguments. The arguments bound to constants may change the inferred types (e.g., shapes), so
+   * they always need the re-inference.
+   */
+  bool IsInferredFor(const FunctionNode* fn, const Array<Expr>& args) {
+    const auto* fty = fn->checked_type_.as<FuncTypeNode>();
+    if (!fty || fty->arg_types.size() != args.size() || !IsCompleteType(GetRef<FuncType>(fty))) {
+      return false;
+    }
+    for (size_t i = 0; i < args.size(); ++i) {
+      Expr arg = args[i];
+      if (const auto* v = arg.as<VarNode>()) {
+        auto it = var_value_map_.find(v);
+        if (it != var_value_map_.end() && it->second->IsInstance<ConstantNode>()) {
+          return false;
+        }
+      }
+      if (arg->IsInstance<ConstantNode>() || !arg->checked_type_.defined() ||
+          !tvm::StructuralEqual()(arg->checked_type_, fty->arg_types[i])) {
+        return false;
+      }
+    }
+    return true;
+  }
+
   Expr VisitExpr_(const RelayConstantNode* op) override {
     const ConstantNode* node = static_cast<const ConstantNode*>(op);
     auto const_data = node->value;
@@ -348,7 +485,11 @@ class TypeInferencer : public ExprMutator {
 
   Expr VisitExpr_(const OpNode* node) override {
     auto op = GetRef<Op>(node);
-    op->checked_type_ = GetOpAttr<OpType>(op, "OpType");
+    // The ops are shared by all functions, so they are only written once for the functions that
+    // are inferred in parallel.
+    if (!op->checked_type_.defined()) {
+      op->checked_type_ = GetOpAttr<OpType>(op, "OpType");
+    }
     return op;
   }
 
@@ -536,6 +677,68 @@ Type Unify(const Type& src, const Type& dst) {
   return unifier.Unify(src, dst);
 }
 
+/*!
+ * \brief Find whether a function calls other global functions, and type the ops in it ahead of
+ * the parallel inference, so that the shared op nodes are only read by the worker threads.
+ */
+class GlobalCallFinder : public ExprVisitor {
+ public:
+  bool Run(const Function& func) {
+    VisitExpr(func);
+    return has_global_call_;
+  }
+
+  void VisitExpr_(const GlobalVarNode* op) final {
+    has_global_call_ = true;
+  }
+
+  void VisitExpr_(const OpNode* node) final {
+    auto op = GetRef<Op>(node);
+    if (!op->checked_type_.defined()) {
+      op->checked_type_ = GetOpAttr<OpType>(op, "OpType");
+    }
+  }
+
+ private:
+  bool has_global_call_ = false;
+};
+
+/*!
+ * \brief Infer the types of the global functions that do not call other global functions (e.g.,
+ * the lifted functions) in parallel, each with its own inferencer.
+ */
+Map<GlobalVar, Function> InferLeafFunctionsInParallel(IRModule mod,
+                                                      const std::vector<GlobalVar>& gvars,
+                                                      int num_threads) {
+  std::vector<Function> funcs(gvars.size());
+  std::vector<std::string> errors(gvars.size());
+  std::atomic<size_t> next_func{0};
+  auto worker = [&]() {
+    for (size_t i = next_func++; i < gvars.size(); i = next_func++) {
+      try {
+        funcs[i] = Downcast<Function>(TypeInferencer(mod).VisitExpr(mod->Lookup(gvars[i])));
+      } catch (const dmlc::Error& e) {
+        errors[i] = e.what();
+      }
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads; ++i) {
+    threads.emplace_back(worker);
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  Map<GlobalVar, Function> ret;
+  for (size_t i = 0; i < gvars.size(); ++i) {
+    CHECK(errors[i].empty()) << "Failed to infer the type of " << gvars[i]->name_hint << ": "
+                             << errors[i];
+    ret.Set(gvars[i], funcs[i]);
+  }
+  return ret;
+}
+
 }  // namespace type_infer
 
 void AddGlobalTypes(ir::IRModule mod) {
@@ -559,9 +762,37 @@ Pass InferType() {
         DLOG(INFO) << "pass::InferType";
         ir::IRModule updated_mod = ir::IRModule(mod->functions);
         AddGlobalTypes(updated_mod);
+
+        // The functions that do not call other global functions are independent, so they are
+        // inferred in parallel when there are many of them.
+        int num_threads =
+            pass_ctx->GetConfig("raf.type_infer.num_threads", Integer(0)).value()->value;
+        if (num_threads <= 0) {
+          num_threads = std::max(1U, std::thread::hardware_concurrency());
+        }
+        std::vector<ir::GlobalVar> leaves;
+        if (num_threads > 1 && updated_mod->functions.size() > 1) {
+          for (auto kv : updated_mod->functions) {
+            if (auto func = kv.second.as<ir::FunctionNode>()) {
+              if (!type_infer::GlobalCallFinder().Run(ir::GetRef<ir::Function>(func))) {
+                leaves.push_back(kv.first);
+              }
+            }
+          }
+        }
+        std::unordered_set<ir::GlobalVar, ObjectPtrHash, ObjectPtrEqual> inferred;
+        if (leaves.size() > 1) {
+          num_threads = std::min<int>(num_threads, leaves.size());
+          auto funcs = type_infer::InferLeafFunctionsInParallel(updated_mod, leaves, num_threads);
+          for (auto kv : funcs) {
+            updated_mod->Add(kv.first, kv.second, true);
+            inferred.insert(kv.first);
+          }
+        }
+
         auto ti = type_infer::TypeInferencer(updated_mod);
         for (auto kv : updated_mod->functions) {
-          if (kv.second.as<ir::FunctionNode>()) {
+          if (kv.second.as<ir::FunctionNode>() && inferred.count(kv.first) == 0) {
             auto func = tvm::runtime::Downcast<ir::Function>(ti.VisitExpr(kv.second));
             updated_mod->Add(kv.first, func, true);
           }
@@ -619,5 +850,7 @@ Expr InferTypeWithModule(const Expr& expr, const IRModule& m) {
 
 RAF_REGISTER_GLOBAL("raf.pass_.InferType").set_body_typed([]() { return InferType(); });
 
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.type_infer.num_threads", Integer);
+
 }  // namespace pass
 }  // namespace raf
@@ -7,6 +7,7 @@
  * \file src/profiler/base/profiler.cc
  * \brief RAF profiler, a simple implementation
  */
+#include "raf/ir.h"
 #include "raf/registry.h"
 #include "raf/profiler.h"
 
@@ -139,10 +140,25 @@ std::string GetProfile() {
   return Profiler::Get()->GetProfile();
 }
 
+int64_t NowInMicrosec() {
+  return ProfileStat::NowInMicrosec();
+}
+
+void AddProfileStat(std::string categories, std::string name, int64_t start_time,
+                    int64_t end_time, ir::Array<ir::String> args) {
+  if (!Profiler::Get()->IsProfiling(1)) {
+    return;
+  }
+  std::vector<std::string> str_args(args.begin(), args.end());
+  Profiler::Get()->AddNewProfileStat(categories, name, start_time, end_time, str_args);
+}
+
 RAF_REGISTER_GLOBAL("raf.profiler.EnableProfiler").set_body_typed(EnableProfiler);
 RAF_REGISTER_GLOBAL("raf.profiler.DisableProfiler").set_body_typed(DisableProfiler);
 RAF_REGISTER_GLOBAL("raf.profiler.CollectBaseProfile").set_body_typed(CollectBaseProfile);
 RAF_REGISTER_GLOBAL("raf.profiler.GetProfile").set_body_typed(GetProfile);
+RAF_REGISTER_GLOBAL("raf.profiler.NowInMicrosec").set_body_typed(NowInMicrosec);
+RAF_REGISTER_GLOBAL("raf.profiler.AddProfileStat").set_body_typed(AddProfileStat);
 
 }  // namespace profiler
 }  // namespace raf
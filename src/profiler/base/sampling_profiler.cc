@@ -0,0 +1,259 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/profiler/base/sampling_profiler.cc
+ * \brief A low-overhead sampling profiler that can be left on in production
+ */
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include "raf/registry.h"
+#include "raf/sampling_profiler.h"
+
+namespace raf {
+namespace profiler {
+
+int LatencyHistogram::BucketIndex(uint64_t latency) {
+  if (latency < kNumLinearBuckets) {
+    return static_cast<int>(latency);
+  }
+  int exponent = 63 - __builtin_clzll(latency);
+  int sub_bucket = (latency >> (exponent - kSubBucketBits)) & ((1 << kSubBucketBits) - 1);
+  return kNumLinearBuckets + ((exponent - 4) << kSubBucketBits) + sub_bucket;
+}
+
+uint64_t LatencyHistogram::BucketLowerBound(int index) {
+  if (index < kNumLinearBuckets) {
+    return index;
+  }
+  int exponent = ((index - kNumLinearBuckets) >> kSubBucketBits) + 4;
+  uint64_t sub_bucket = (index - kNumLinearBuckets) & ((1 << kSubBucketBits) - 1);
+  return ((1ULL << kSubBucketBits) + sub_bucket) << (exponent - kSubBucketBits);
+}
+
+void LatencyHistogram::Add(uint64_t latency) {
+  buckets_[BucketIndex(latency)]++;
+  count_++;
+  sum_ += latency;
+  max_ = std::max(max_, latency);
+}
+
+uint64_t LatencyHistogram::Percentile(double percentile) const {
+  if (count_ == 0) {
+    return 0;
+  }
+  uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(percentile / 100.0 * count_ + 0.5));
+  uint64_t seen = 0;
+  for (int i = 0; i < kNumBuckets; ++i) {
+    seen += buckets_[i];
+    if (seen >= rank) {
+      // Report the middle of the bucket, which bounds the relative error by half a bucket.
+      uint64_t lower = BucketLowerBound(i);
+      uint64_t upper = i + 1 < kNumBuckets ? BucketLowerBound(i + 1) : max_ + 1;
+      return std::min(max_, lower + (upper - lower - 1) / 2);
+    }
+  }
+  return max_;
+}
+
+SamplingProfiler::SamplingProfiler() {
+}
+
+SamplingProfiler::~SamplingProfiler() {
+  Disable();
+}
+
+SamplingProfiler* SamplingProfiler::Get() {
+  static SamplingProfiler sampling_profiler;
+  return &sampling_profiler;
+}
+
+void SamplingProfiler::Enable(int64_t sample_every, int64_t capacity, int64_t flush_interval_ms) {
+  CHECK_GT(sample_every, 0) << "Invalid sampling rate: " << sample_every;
+  CHECK_GT(capacity, 0) << "Invalid ring buffer capacity: " << capacity;
+  CHECK_GT(flush_interval_ms, 0) << "Invalid flush interval: " << flush_interval_ms;
+  Disable();
+  uint64_t size = 1;
+  while (size < static_cast<uint64_t>(capacity)) {
+    size <<= 1;
+  }
+  {
+    std::lock_guard<std::mutex> lock(flush_mu_);
+    // The ring buffer is only reallocated when it is resized, because the iterations that have
+    // been sampled before Disable may still be writing to it.
+    if (size != mask_ + 1 || !slots_) {
+      slots_.reset(new Slot[size]);
+      mask_ = size - 1;
+      head_ = 0;
+      tail_ = 0;
+    }
+  }
+  sample_every_ = sample_every;
+  flush_interval_ms_ = flush_interval_ms;
+  stop_flush_ = false;
+  flush_thread_ = std::thread(&SamplingProfiler::FlushLoop, this);
+  enabled_ = true;
+}
+
+void SamplingProfiler::Disable() {
+  enabled_ = false;
+  if (flush_thread_.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(stop_mu_);
+      stop_flush_ = true;
+    }
+    stop_cv_.notify_all();
+    flush_thread_.join();
+  }
+  Flush();
+}
+
+void SamplingProfiler::NextIteration() {
+  if (!enabled_.load(std::memory_order_relaxed)) {
+    SampledIteration() = false;
+    return;
+  }
+  uint64_t iteration = iteration_.fetch_add(1, std::memory_order_relaxed);
+  SampledIteration() = iteration % sample_every_.load(std::memory_order_relaxed) == 0;
+}
+
+uint64_t SamplingProfiler::Start(const Device& device) {
+  if (device.device_type() != DevType::kCPU()) {
+    device_api::DeviceAPI::Get(device.device_type())->WaitDevice(device);
+  }
+  return ProfileStat::NowInMicrosec();
+}
+
+void SamplingProfiler::Stop(const Device& device, const std::string& name, uint64_t start) {
+  if (device.device_type() != DevType::kCPU()) {
+    device_api::DeviceAPI::Get(device.device_type())->WaitDevice(device);
+  }
+  uint64_t end = ProfileStat::NowInMicrosec();
+  Push(SampledEvent{Intern(name), start, end});
+}
+
+uint32_t SamplingProfiler::Intern(const std::string& name) {
+  std::lock_guard<std::mutex> lock(name_mu_);
+  auto it = name_ids_.find(name);
+  if (it != name_ids_.end()) {
+    return it->second;
+  }
+  uint32_t name_id = names_.size();
+  names_.push_back(name);
+  name_ids_.emplace(name, name_id);
+  return name_id;
+}
+
+void SamplingProfiler::Push(const SampledEvent& event) {
+  uint64_t index = head_.fetch_add(1, std::memory_order_relaxed);
+  Slot& slot = slots_[index & mask_];
+  // The sequence number is cleared while the slot is written, so a concurrent read of an
+  // overwritten slot is detected and discarded.
+  slot.seq.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.event = event;
+  slot.seq.store(index + 1, std::memory_order_release);
+}
+
+void SamplingProfiler::Flush() {
+  std::lock_guard<std::mutex> lock(flush_mu_);
+  if (!slots_) {
+    return;
+  }
+  uint64_t head = head_.load(std::memory_order_acquire);
+  uint64_t capacity = mask_ + 1;
+  if (head - tail_ > capacity) {
+    num_dropped_ += head - tail_ - capacity;
+    tail_ = head - capacity;
+  }
+  for (; tail_ < head; ++tail_) {
+    Slot& slot = slots_[tail_ & mask_];
+    uint64_t seq = slot.seq.load(std::memory_order_acquire);
+    SampledEvent event = slot.event;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (seq != tail_ + 1 || slot.seq.load(std::memory_order_relaxed) != seq) {
+      // The slot is being written, or has been overwritten by a newer event.
+      num_dropped_++;
+      continue;
+    }
+    if (event.name_id >= histograms_.size()) {
+      histograms_.resize(event.name_id + 1);
+    }
+    histograms_[event.name_id].Add(event.end - event.start);
+  }
+}
+
+void SamplingProfiler::FlushLoop() {
+  std::unique_lock<std::mutex> lock(stop_mu_);
+  while (!stop_flush_) {
+    stop_cv_.wait_for(lock, std::chrono::milliseconds(flush_interval_ms_),
+                      [this] { return stop_flush_; });
+    Flush();
+  }
+}
+
+std::string SamplingProfiler::GetStats() {
+  Flush();
+  std::vector<std::string> names;
+  {
+    std::lock_guard<std::mutex> lock(name_mu_);
+    names = names_;
+  }
+  std::lock_guard<std::mutex> lock(flush_mu_);
+  std::stringstream ss;
+  ss << "{\"num_dropped\": " << num_dropped_ << ", \"ops\": {";
+  bool first = true;
+  for (size_t i = 0; i < histograms_.size(); ++i) {
+    const LatencyHistogram& histogram = histograms_[i];
+    if (histogram.count() == 0) {
+      continue;
+    }
+    if (!first) {
+      ss << ", ";
+    }
+    first = false;
+    ss << "\"" << names[i] << "\": {"
+       << "\"count\": " << histogram.count() << ", "
+       << "\"mean_us\": " << static_cast<double>(histogram.sum()) / histogram.count() << ", "
+       << "\"p50_us\": " << histogram.Percentile(50) << ", "
+       << "\"p99_us\": " << histogram.Percentile(99) << ", "
+       << "\"max_us\": " << histogram.max() << "}";
+  }
+  ss << "}}";
+  return ss.str();
+}
+
+void SamplingProfiler::Reset() {
+  Flush();
+  std::lock_guard<std::mutex> lock(flush_mu_);
+  histograms_.clear();
+  num_dropped_ = 0;
+}
+
+void EnableSamplingProfiler(int64_t sample_every, int64_t capacity, int64_t flush_interval_ms) {
+  SamplingProfiler::Get()->Enable(sample_every, capacity, flush_interval_ms);
+}
+
+void DisableSamplingProfiler() {
+  SamplingProfiler::Get()->Disable();
+}
+
+std::string GetSampledStats() {
+  return SamplingProfiler::Get()->GetStats();
+}
+
+void ResetSampledStats() {
+  SamplingProfiler::Get()->Reset();
+}
+
+RAF_REGISTER_GLOBAL("raf.profiler.EnableSamplingProfiler").set_body_typed(EnableSamplingProfiler);
+RAF_REGISTER_GLOBAL("raf.profiler.DisableSamplingProfiler")
+    .set_body_typed(DisableSamplingProfiler);
+RAF_REGISTER_GLOBAL("raf.profiler.GetSampledStats").set_body_typed(GetSampledStats);
+RAF_REGISTER_GLOBAL("raf.profiler.ResetSampledStats").set_body_typed(ResetSampledStats);
+
+}  // namespace profiler
+}  // namespace raf
@@ -0,0 +1,189 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/profiler/cuda/comm_profiler.cc
+ * \brief Profiler for collective communications with bandwidth accounting
+ */
+#include <map>
+#include <sstream>
+#include "raf/dist_context.h"
+#include "raf/registry.h"
+#include "./comm_profiler.h"
+
+namespace raf {
+namespace profiler {
+
+double CommStat::BusBandwidth() const {
+  return AlgBandwidth() * CommProfiler::BusBandwidthFactor(kind, nranks);
+}
+
+CommProfiler* CommProfiler::Get() {
+  static CommProfiler comm_profiler;
+  return &comm_profiler;
+}
+
+double CommProfiler::BusBandwidthFactor(CommKind kind, int nranks) {
+  if (nranks <= 1) {
+    return 1.0;
+  }
+  // Following nccl-tests, so that the bus bandwidth of every collective is comparable to the
+  // peak bandwidth of the links.
+  switch (kind) {
+    case CommKind::kAllReduce:
+      return 2.0 * (nranks - 1) / nranks;
+    case CommKind::kAllGather:
+    case CommKind::kReduceScatter:
+      return static_cast<double>(nranks - 1) / nranks;
+    default:
+      return 1.0;
+  }
+}
+
+const char* CommProfiler::KindName(CommKind kind) {
+  static const char* names[] = {"allreduce", "allgather", "reduce_scatter",
+                                "broadcast", "reduce",    "send_recv"};
+  return names[static_cast<int>(kind)];
+}
+
+void CommProfiler::Enable() {
+  enabled_ = true;
+}
+
+void CommProfiler::Disable() {
+  enabled_ = false;
+}
+
+void CommProfiler::NextIteration() {
+  std::lock_guard<std::mutex> lock(mu_);
+  iteration_++;
+  // The waits that are not followed by a collective in the last iteration are dropped.
+  waits_.clear();
+}
+
+void CommProfiler::MarkWait(const Device& device, void* stream) {
+  std::lock_guard<std::mutex> lock(mu_);
+  // Only the first wait before a collective is kept, so the wait time covers all of them.
+  if (waits_.count(stream) == 0) {
+    auto event = event_pool::EventPool::Get(device)->GetEvent();
+    device_api::DeviceAPI::Get(DevType::kCUDA())->EventRecordOnStream(event->data(), stream);
+    waits_[stream] = event;
+  }
+}
+
+void CommProfiler::Begin(const Device& device, void* stream) {
+  auto event = event_pool::EventPool::Get(device)->GetEvent();
+  device_api::DeviceAPI::Get(DevType::kCUDA())->EventRecordOnStream(event->data(), stream);
+  std::lock_guard<std::mutex> lock(mu_);
+  std::shared_ptr<Event> wait;
+  auto it = waits_.find(stream);
+  if (it != waits_.end()) {
+    wait = it->second;
+    waits_.erase(it);
+  }
+  starts_[stream] = std::make_pair(wait, event);
+}
+
+void CommProfiler::End(const Device& device, void* stream, const std::string& name,
+                       CommKind kind, int64_t bytes, int nranks) {
+  auto event = event_pool::EventPool::Get(device)->GetEvent();
+  device_api::DeviceAPI::Get(DevType::kCUDA())->EventRecordOnStream(event->data(), stream);
+  std::lock_guard<std::mutex> lock(mu_);
+  auto it = starts_.find(stream);
+  CHECK(it != starts_.end()) << "The collective " << name << " is not started";
+  PendingComm comm;
+  comm.stat = CommStat{name, kind, bytes, nranks, iteration_, 0.0, 0.0};
+  comm.wait = it->second.first;
+  comm.start = it->second.second;
+  comm.end = event;
+  pending_.push_back(std::move(comm));
+  starts_.erase(it);
+}
+
+void CommProfiler::Flush() {
+  auto api = device_api::DeviceAPI::Get(DevType::kCUDA());
+  for (auto& comm : pending_) {
+    api->WaitEvent(comm.end->data());
+    comm.stat.time_us =
+        api->EventElapsedTimeInMilliSeconds(comm.start->data(), comm.end->data()) * 1000.0;
+    if (comm.wait != nullptr) {
+      comm.stat.wait_us =
+          api->EventElapsedTimeInMilliSeconds(comm.wait->data(), comm.start->data()) * 1000.0;
+    }
+    stats_.push_back(comm.stat);
+  }
+  pending_.clear();
+}
+
+std::vector<CommStat> CommProfiler::GetStats() {
+  std::lock_guard<std::mutex> lock(mu_);
+  Flush();
+  return stats_;
+}
+
+std::string CommProfiler::GetReport() {
+  std::map<int64_t, std::vector<CommStat>> iterations;
+  for (const auto& stat : GetStats()) {
+    iterations[stat.iteration].push_back(stat);
+  }
+  std::stringstream ss;
+  ss << "{\"rank\": " << distributed::DistContext::Global()->rank << ", \"iterations\": [";
+  bool first_iter = true;
+  for (const auto& it : iterations) {
+    int64_t bytes = 0;
+    double time_us = 0.0, wait_us = 0.0, bus_bytes = 0.0;
+    std::stringstream collectives;
+    for (size_t i = 0; i < it.second.size(); ++i) {
+      const auto& stat = it.second[i];
+      bytes += stat.bytes;
+      time_us += stat.time_us;
+      wait_us += stat.wait_us;
+      bus_bytes += stat.bytes * BusBandwidthFactor(stat.kind, stat.nranks);
+      collectives << (i > 0 ? ", " : "") << "{\"name\": \"" << stat.name << "\", "
+                  << "\"kind\": \"" << KindName(stat.kind) << "\", "
+                  << "\"bytes\": " << stat.bytes << ", "
+                  << "\"nranks\": " << stat.nranks << ", "
+                  << "\"time_us\": " << stat.time_us << ", "
+                  << "\"wait_us\": " << stat.wait_us << ", "
+                  << "\"algbw_gbps\": " << stat.AlgBandwidth() << ", "
+                  << "\"busbw_gbps\": " << stat.BusBandwidth() << "}";
+    }
+    ss << (first_iter ? "" : ", ") << "{\"iteration\": " << it.first << ", "
+       << "\"num_collectives\": " << it.second.size() << ", "
+       << "\"bytes\": " << bytes << ", "
+       << "\"time_us\": " << time_us << ", "
+       << "\"wait_us\": " << wait_us << ", "
+       << "\"algbw_gbps\": " << (time_us > 0 ? bytes * 1e-3 / time_us : 0.0) << ", "
+       << "\"busbw_gbps\": " << (time_us > 0 ? bus_bytes * 1e-3 / time_us : 0.0) << ", "
+       << "\"collectives\": [" << collectives.str() << "]}";
+    first_iter = false;
+  }
+  ss << "]}";
+  return ss.str();
+}
+
+void CommProfiler::Reset() {
+  std::lock_guard<std::mutex> lock(mu_);
+  Flush();
+  stats_.clear();
+  waits_.clear();
+  iteration_ = 0;
+}
+
+RAF_REGISTER_GLOBAL("raf.profiler.EnableCommProfiler").set_body_typed([]() {
+  CommProfiler::Get()->Enable();
+});
+RAF_REGISTER_GLOBAL("raf.profiler.DisableCommProfiler").set_body_typed([]() {
+  CommProfiler::Get()->Disable();
+});
+RAF_REGISTER_GLOBAL("raf.profiler.ResetCommProfiler").set_body_typed([]() {
+  CommProfiler::Get()->Reset();
+});
+RAF_REGISTER_GLOBAL("raf.profiler.GetCommProfile").set_body_typed([]() {
+  return CommProfiler::Get()->GetReport();
+});
+
+}  // namespace profiler
+}  // namespace raf
@@ -0,0 +1,160 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/profiler/cuda/comm_profiler.h
+ * \brief Profiler for collective communications with bandwidth accounting
+ */
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "raf/device_api.h"
+#include "raf/event_pool.h"
+
+namespace raf {
+namespace profiler {
+
+using raf::event_pool::Event;
+
+/*! \brief The kinds of collectives, which determine the bus bandwidth factors. */
+enum class CommKind : int {
+  kAllReduce = 0,
+  kAllGather = 1,
+  kReduceScatter = 2,
+  kBroadcast = 3,
+  kReduce = 4,
+  kSendRecv = 5,
+};
+
+/*! \brief The profiled statistics of a collective. */
+struct CommStat {
+  std::string name;
+  CommKind kind;
+  /*!
+   * \brief The bytes of the collective, which are the bytes of the input for allreduce, broadcast
+   * and reduce, the bytes of the gathered output for allgather, and the bytes of the scattered
+   * input for reduce-scatter, following the convention of nccl-tests.
+   */
+  int64_t bytes;
+  int nranks;
+  int64_t iteration;
+  /*! \brief The time of the collective on the device in microseconds. */
+  double time_us;
+  /*!
+   * \brief The time that the stream waited on CudaWaitEvent before the collective could start,
+   * in microseconds.
+   */
+  double wait_us;
+
+  /*! \brief The algorithm bandwidth in GB/s. */
+  double AlgBandwidth() const {
+    return time_us > 0 ? bytes * 1e-3 / time_us : 0.0;
+  }
+  /*! \brief The bus bandwidth in GB/s, which is comparable to the peak link bandwidth. */
+  double BusBandwidth() const;
+};
+
+/*!
+ * \brief The communication profiler records the device time of each collective with events on its
+ * stream, along with the time its stream waited on the preceding CudaWaitEvent. The events are
+ * resolved lazily, so the collectives are not synchronized when they are launched.
+ */
+class CommProfiler {
+ public:
+  static CommProfiler* Get();
+
+  void Enable();
+  void Disable();
+  bool IsEnabled() const {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+
+  /*! \brief Start a new iteration (i.e., a VM run). */
+  void NextIteration();
+  /*! \brief Mark that the stream is going to wait for an event. */
+  void MarkWait(const Device& device, void* stream);
+  /*! \brief Record the start of a collective on the stream. */
+  void Begin(const Device& device, void* stream);
+  /*! \brief Record the end of the collective started on the stream. */
+  void End(const Device& device, void* stream, const std::string& name, CommKind kind,
+           int64_t bytes, int nranks);
+
+  /*! \brief Get the profiled collectives, which synchronizes the pending ones. */
+  std::vector<CommStat> GetStats();
+  /*! \brief Get the per-iteration profile of this rank in JSON. */
+  std::string GetReport();
+  /*! \brief Clear the profiled collectives. */
+  void Reset();
+
+  /*! \brief The ratio of the bus bandwidth to the algorithm bandwidth of a collective. */
+  static double BusBandwidthFactor(CommKind kind, int nranks);
+  static const char* KindName(CommKind kind);
+
+ private:
+  CommProfiler() = default;
+
+  /*! \brief A collective whose events have not been resolved. */
+  struct PendingComm {
+    CommStat stat;
+    std::shared_ptr<Event> wait;
+    std::shared_ptr<Event> start;
+    std::shared_ptr<Event> end;
+  };
+
+  /*! \brief Resolve the pending collectives. The caller must hold mu_. */
+  void Flush();
+
+  std::atomic<bool> enabled_{false};
+  int64_t iteration_ = 0;
+  /*! \brief The wait and start events of each stream that are not consumed yet. */
+  std::unordered_map<void*, std::shared_ptr<Event>> waits_;
+  std::unordered_map<void*, std::pair<std::shared_ptr<Event>, std::shared_ptr<Event>>> starts_;
+  std::vector<PendingComm> pending_;
+  std::vector<CommStat> stats_;
+  std::mutex mu_;
+};
+
+/*!
+ * \brief A scope that profiles a collective on a stream when the communication profiler is enabled.
+ */
+class CommProfileScope {
+ public:
+  CommProfileScope(const Device& device, void* stream, std::string name, CommKind kind,
+                   int64_t bytes, int nranks)
+      : device_(device),
+        stream_(stream),
+        name_(std::move(name)),
+        kind_(kind),
+        bytes_(bytes),
+        nranks_(nranks) {
+    enabled_ = CommProfiler::Get()->IsEnabled();
+    if (enabled_) {
+      CommProfiler::Get()->Begin(device, stream);
+    }
+  }
+
+  ~CommProfileScope() {
+    if (enabled_) {
+      CommProfiler::Get()->End(device_, stream_, name_, kind_, bytes_, nranks_);
+    }
+  }
+
+ private:
+  bool enabled_;
+  Device device_;
+  void* stream_;
+  std::string name_;
+  CommKind kind_;
+  int64_t bytes_;
+  int nranks_;
+};
+
+}  // namespace profiler
+}  // namespace raf
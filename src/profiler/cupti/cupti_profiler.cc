@@ -0,0 +1,219 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/profiler/cupti/cupti_profiler.cc
+ * \brief GPU activity profiler based on CUPTI
+ */
+#include <cupti.h>
+#include <cxxabi.h>
+#include <cstdlib>
+#include "./cupti_profiler.h"
+
+#define CUPTI_CALL(func)                                    \
+  do {                                                      \
+    CUptiResult e = (func);                                 \
+    if (e != CUPTI_SUCCESS) {                               \
+      const char* err_str;                                  \
+      cuptiGetResultString(e, &err_str);                    \
+      LOG(FATAL) << "CUPTI error " << e << ": " << err_str; \
+    }                                                       \
+  } while (false)
+
+namespace raf {
+namespace profiler {
+
+namespace {
+
+constexpr size_t kBufferSize = 8 * 1024 * 1024;
+constexpr size_t kBufferAlignment = 8;
+
+void CUPTIAPI BufferRequested(uint8_t** buffer, size_t* size, size_t* max_num_records) {
+  void* ptr = nullptr;
+  CHECK_EQ(posix_memalign(&ptr, kBufferAlignment, kBufferSize), 0)
+      << "Failed to allocate the CUPTI activity buffer";
+  *buffer = static_cast<uint8_t*>(ptr);
+  *size = kBufferSize;
+  *max_num_records = 0;
+}
+
+void CUPTIAPI BufferCompleted(CUcontext ctx, uint32_t stream_id, uint8_t* buffer, size_t size,
+                              size_t valid_size) {
+  CuptiProfiler::Get()->AddRecords(buffer, valid_size);
+  free(buffer);
+}
+
+std::string Demangle(const char* name) {
+  int status = 0;
+  char* demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+  if (status != 0 || demangled == nullptr) {
+    return name;
+  }
+  std::string ret(demangled);
+  free(demangled);
+  return ret;
+}
+
+const char* MemcpyKindName(uint8_t copy_kind) {
+  switch (copy_kind) {
+    case CUPTI_ACTIVITY_MEMCPY_KIND_HTOD:
+      return "Memcpy HtoD";
+    case CUPTI_ACTIVITY_MEMCPY_KIND_DTOH:
+      return "Memcpy DtoH";
+    case CUPTI_ACTIVITY_MEMCPY_KIND_DTOD:
+      return "Memcpy DtoD";
+    case CUPTI_ACTIVITY_MEMCPY_KIND_HTOH:
+      return "Memcpy HtoH";
+    case CUPTI_ACTIVITY_MEMCPY_KIND_PTOP:
+      return "Memcpy PtoP";
+    default:
+      return "Memcpy";
+  }
+}
+
+/*! \brief NCCL collectives are launched as kernels named ncclKernel_* or ncclDevKernel_*. */
+bool IsNCCLKernel(const std::string& name) {
+  return name.compare(0, 4, "nccl") == 0;
+}
+
+}  // namespace
+
+CuptiProfiler::CuptiProfiler() {
+  CUPTI_CALL(cuptiActivityRegisterCallbacks(BufferRequested, BufferCompleted));
+}
+
+CuptiProfiler::~CuptiProfiler() {
+}
+
+CuptiProfiler* CuptiProfiler::Get() {
+  static CuptiProfiler cupti_profiler;
+  return &cupti_profiler;
+}
+
+void CuptiProfiler::start() {
+  if (started_) {
+    return;
+  }
+  CUPTI_CALL(cuptiActivityEnable(CUPTI_ACTIVITY_KIND_CONCURRENT_KERNEL));
+  CUPTI_CALL(cuptiActivityEnable(CUPTI_ACTIVITY_KIND_MEMCPY));
+  CUPTI_CALL(cuptiActivityEnable(CUPTI_ACTIVITY_KIND_MEMSET));
+  CUPTI_CALL(cuptiActivityEnable(CUPTI_ACTIVITY_KIND_EXTERNAL_CORRELATION));
+  uint64_t gpu_timestamp;
+  CUPTI_CALL(cuptiGetTimestamp(&gpu_timestamp));
+  int64_t host_timestamp = static_cast<int64_t>(ProfileStat::NowInMicrosec()) * 1000;
+  clock_offset_ = host_timestamp - static_cast<int64_t>(gpu_timestamp);
+  started_ = true;
+}
+
+void CuptiProfiler::stop() {
+  if (!started_) {
+    return;
+  }
+  CUPTI_CALL(cuptiActivityFlushAll(0));
+  CUPTI_CALL(cuptiActivityDisable(CUPTI_ACTIVITY_KIND_CONCURRENT_KERNEL));
+  CUPTI_CALL(cuptiActivityDisable(CUPTI_ACTIVITY_KIND_MEMCPY));
+  CUPTI_CALL(cuptiActivityDisable(CUPTI_ACTIVITY_KIND_MEMSET));
+  CUPTI_CALL(cuptiActivityDisable(CUPTI_ACTIVITY_KIND_EXTERNAL_CORRELATION));
+  started_ = false;
+}
+
+void CuptiProfiler::PushCorrelation(int64_t func_index, int64_t pc, const std::string& name) {
+  uint64_t external_id;
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    correlations_.push_back(CuptiCorrelation{func_index, pc, name});
+    external_id = correlations_.size();
+  }
+  CUPTI_CALL(
+      cuptiActivityPushExternalCorrelationId(CUPTI_EXTERNAL_CORRELATION_KIND_CUSTOM0, external_id));
+}
+
+void CuptiProfiler::PopCorrelation() {
+  uint64_t external_id;
+  CUPTI_CALL(
+      cuptiActivityPopExternalCorrelationId(CUPTI_EXTERNAL_CORRELATION_KIND_CUSTOM0, &external_id));
+}
+
+void CuptiProfiler::AddRecords(uint8_t* buffer, size_t valid_size) {
+  std::lock_guard<std::mutex> lock(mu_);
+  CUpti_Activity* record = nullptr;
+  while (cuptiActivityGetNextRecord(buffer, valid_size, &record) == CUPTI_SUCCESS) {
+    // The newer versions of the records keep the fields of the older versions at the same
+    // offsets, so the records are read as their oldest versions with the needed fields.
+    switch (record->kind) {
+      case CUPTI_ACTIVITY_KIND_KERNEL:
+      case CUPTI_ACTIVITY_KIND_CONCURRENT_KERNEL: {
+        auto kernel = reinterpret_cast<CUpti_ActivityKernel4*>(record);
+        activities_.push_back(CuptiActivity{CuptiActivity::kKernel, Demangle(kernel->name),
+                                            kernel->deviceId, kernel->streamId,
+                                            kernel->correlationId, kernel->start, kernel->end});
+        break;
+      }
+      case CUPTI_ACTIVITY_KIND_MEMCPY: {
+        auto copy = reinterpret_cast<CUpti_ActivityMemcpy*>(record);
+        activities_.push_back(CuptiActivity{CuptiActivity::kMemcpy, MemcpyKindName(copy->copyKind),
+                                            copy->deviceId, copy->streamId, copy->correlationId,
+                                            copy->start, copy->end});
+        break;
+      }
+      case CUPTI_ACTIVITY_KIND_MEMSET: {
+        auto set = reinterpret_cast<CUpti_ActivityMemset*>(record);
+        activities_.push_back(CuptiActivity{CuptiActivity::kMemset, "Memset", set->deviceId,
+                                            set->streamId, set->correlationId, set->start,
+                                            set->end});
+        break;
+      }
+      case CUPTI_ACTIVITY_KIND_EXTERNAL_CORRELATION: {
+        auto correlation = reinterpret_cast<CUpti_ActivityExternalCorrelation*>(record);
+        if (correlation->externalKind == CUPTI_EXTERNAL_CORRELATION_KIND_CUSTOM0) {
+          external_ids_[correlation->correlationId] = correlation->externalId;
+        }
+        break;
+      }
+      default:
+        break;
+    }
+  }
+  size_t dropped = 0;
+  cuptiActivityGetNumDroppedRecords(nullptr, 0, &dropped);
+  if (dropped > 0) {
+    LOG(WARNING) << "CUPTI dropped " << dropped << " activity records";
+  }
+}
+
+void CuptiProfiler::CollectCuptiStat() {
+  stop();
+  std::lock_guard<std::mutex> lock(mu_);
+  static const char* kind_names[] = {"kernel", "memcpy", "memset"};
+  for (const auto& activity : activities_) {
+    bool nccl = activity.kind == CuptiActivity::kKernel && IsNCCLKernel(activity.name);
+    std::vector<std::string> args = {std::string("kind=") +
+                                     (nccl ? "nccl" : kind_names[activity.kind])};
+    auto it = external_ids_.find(activity.correlation_id);
+    if (it != external_ids_.end() && it->second > 0 && it->second <= correlations_.size()) {
+      const auto& correlation = correlations_[it->second - 1];
+      args.push_back("func=" + std::to_string(correlation.func_index));
+      args.push_back("pc=" + std::to_string(correlation.pc));
+      args.push_back("op=" + correlation.name);
+    }
+    // Each stream of each device is a row of the trace.
+    std::string category = "GPU " + std::to_string(activity.device_id) + " Stream " +
+                           std::to_string(activity.stream_id);
+    Profiler::Get()->AddNewProfileStat(category, activity.name, ToHostMicrosec(activity.start),
+                                       ToHostMicrosec(activity.end), args);
+  }
+  activities_.clear();
+  external_ids_.clear();
+  correlations_.clear();
+}
+
+void CollectCuptiProfile() {
+  CuptiProfiler::Get()->CollectCuptiStat();
+}
+
+RAF_REGISTER_GLOBAL("raf.profiler.CollectCuptiProfile").set_body_typed(CollectCuptiProfile);
+
+}  // namespace profiler
+}  // namespace raf
@@ -0,0 +1,125 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/profiler/cupti/cupti_profiler.h
+ * \brief GPU activity profiler based on CUPTI
+ */
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "raf/registry.h"
+#include "raf/profiler.h"
+
+#ifdef RAF_USE_CUPTI
+
+/*!
+ * \brief Correlate the GPU activities launched by CODE_SNIPPET with the VM function, the pc and
+ * the name of the launching instruction.
+ */
+#define WITH_CUPTI_CORRELATION(FUNC_INDEX, PC, NAME, CODE_SNIPPET) \
+  {                                                                \
+    auto _cupti_profiler = raf::profiler::CuptiProfiler::Get();    \
+    if (_cupti_profiler->started()) {                              \
+      _cupti_profiler->PushCorrelation(FUNC_INDEX, PC, NAME);      \
+      CODE_SNIPPET                                                 \
+      _cupti_profiler->PopCorrelation();                           \
+    } else {                                                       \
+      CODE_SNIPPET                                                 \
+    }                                                              \
+  }
+
+#else
+
+#define WITH_CUPTI_CORRELATION(FUNC_INDEX, PC, NAME, CODE_SNIPPET) \
+  { CODE_SNIPPET }
+
+#endif
+
+namespace raf {
+namespace profiler {
+
+#ifdef RAF_USE_CUPTI
+
+/*! \brief A GPU activity reported by CUPTI. */
+struct CuptiActivity {
+  enum Kind { kKernel, kMemcpy, kMemset };
+  Kind kind;
+  /*! \brief The kernel name, or the description of the memory operation. */
+  std::string name;
+  uint32_t device_id;
+  uint32_t stream_id;
+  /*! \brief The correlation id of the CUDA API call that launched the activity. */
+  uint32_t correlation_id;
+  /*! \brief The GPU timestamps in nanoseconds. */
+  uint64_t start;
+  uint64_t end;
+};
+
+/*! \brief The VM instruction that launched the GPU activities of a correlation. */
+struct CuptiCorrelation {
+  int64_t func_index;
+  int64_t pc;
+  std::string name;
+};
+
+/*!
+ * \brief The CUPTI profiler records the kernels, memory copies and memory sets executed on the
+ * GPU with their GPU timestamps, which are unaffected by the asynchronous launches. Every
+ * activity is correlated with the VM instruction that launched it through the CUPTI external
+ * correlation id. The activities are added to the Profiler on the streams and the devices they
+ * run on, so the idle gaps and the stream overlap are visible in the trace.
+ */
+class CuptiProfiler {
+ public:
+  ~CuptiProfiler();
+  static CuptiProfiler* Get();
+  /*! \brief Enable the activity recording if the CUPTI profiler has not started yet. */
+  void start();
+  /*! \brief Flush the pending activities and disable the activity recording. */
+  void stop();
+  /*! \brief Correlate the following CUDA API calls of this thread with the VM instruction. */
+  void PushCorrelation(int64_t func_index, int64_t pc, const std::string& name);
+  /*! \brief Stop correlating the CUDA API calls of this thread. */
+  void PopCorrelation();
+  /*! \brief Stop the CUPTI profiler and add the recorded activities to the Profiler. */
+  void CollectCuptiStat();
+  /*! \brief Parse a buffer of activity records completed by CUPTI. */
+  void AddRecords(uint8_t* buffer, size_t valid_size);
+
+  inline bool started() const {
+    return started_;
+  }
+
+ private:
+  CuptiProfiler();
+
+  /*! \brief Convert a GPU timestamp to the host clock of ProfileStat in microseconds. */
+  uint64_t ToHostMicrosec(uint64_t gpu_timestamp) const {
+    return static_cast<uint64_t>(static_cast<int64_t>(gpu_timestamp) + clock_offset_) / 1000;
+  }
+
+  /*! \brief The activities reported by CUPTI. */
+  std::vector<CuptiActivity> activities_;
+  /*! \brief Map from the correlation id of a CUDA API call to the external correlation id. */
+  std::unordered_map<uint32_t, uint64_t> external_ids_;
+  /*! \brief The correlations indexed by the external correlation id minus one. */
+  std::vector<CuptiCorrelation> correlations_;
+  /*! \brief The host clock minus the GPU clock in nanoseconds. */
+  int64_t clock_offset_ = 0;
+  /*! \brief Indicate whether the CUPTI profiler starts. */
+  bool started_ = false;
+  /*! \brief Mutex for the records, which are reported by a CUPTI thread. */
+  std::mutex mu_;
+};
+
+#endif
+
+}  // namespace profiler
+}  // namespace raf
@@ -7,13 +7,30 @@
  * \file src/profiler/memory_profiler.cc
  * \brief Memory profiler implementation
  */
+#include <algorithm>
+#include <map>
 #include "raf/registry.h"
 #include "raf/memory_profiler.h"
 #include "raf/memory_pool.h"
+#include "raf/profiler.h"
 
 namespace raf {
 namespace memory_profiler {
 
+AllocationScope::AllocationScope(std::string tag, int64_t func_index, int64_t pc, void* stream)
+    : tag(std::move(tag)), func_index(func_index), pc(pc), stream(stream), prev_(Current()) {
+  Current() = this;
+}
+
+AllocationScope::~AllocationScope() {
+  Current() = prev_;
+}
+
+const AllocationScope*& AllocationScope::Current() {
+  static thread_local const AllocationScope* current = nullptr;
+  return current;
+}
+
 MemoryProfiler::~MemoryProfiler() {
 }
 
@@ -37,6 +54,141 @@ void MemoryProfiler::Record(const Device& device, const std::string& tag) {
 
 void MemoryProfiler::Reset() {
   memory_stats_.clear();
+  std::lock_guard<std::mutex> lock(mu_);
+  allocations_.clear();
+  num_events_.clear();
+  generation_++;
+}
+
+std::shared_ptr<memory_pool::Memory> MemoryProfiler::TraceAllocation(
+    std::shared_ptr<memory_pool::Memory> memory, int64_t nbytes) {
+  using memory_pool::Memory;
+  const AllocationScope* scope = AllocationScope::Current();
+  AllocationTrace trace;
+  trace.nbytes = nbytes;
+  trace.address = reinterpret_cast<uintptr_t>(memory->data);
+  trace.tag = scope ? scope->tag : "untracked";
+  trace.func_index = scope ? scope->func_index : -1;
+  trace.pc = scope ? scope->pc : -1;
+  trace.stream = scope ? scope->stream : nullptr;
+  trace.alloc_time = profiler::ProfileStat::NowInMicrosec();
+  std::string device_str = memory->device.c_str();
+  size_t index;
+  uint64_t generation;
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    trace.alloc_seq = num_events_[device_str]++;
+    auto& allocations = allocations_[device_str];
+    index = allocations.size();
+    allocations.push_back(std::move(trace));
+    generation = generation_;
+  }
+  // The returned memory aliases the given one, which is released after the free is traced.
+  Memory* ptr = memory.get();
+  return std::shared_ptr<Memory>(ptr, [memory, device_str, index, generation](Memory*) {
+    MemoryProfiler::Get()->TraceFree(device_str, index, generation);
+  });
+}
+
+void MemoryProfiler::TraceFree(const std::string& device_str, size_t index, uint64_t generation) {
+  std::lock_guard<std::mutex> lock(mu_);
+  if (generation != generation_) {
+    return;
+  }
+  AllocationTrace& trace = allocations_[device_str][index];
+  trace.free_time = profiler::ProfileStat::NowInMicrosec();
+  trace.free_seq = num_events_[device_str]++;
+  trace.alive = false;
+}
+
+std::pair<uint64_t, int64_t> MemoryProfiler::FindPeak(
+    const std::vector<AllocationTrace>& allocations) {
+  // Replay the allocations and the frees in order. A positive size is an allocation.
+  std::vector<std::pair<uint64_t, int64_t>> events;
+  for (const auto& trace : allocations) {
+    events.emplace_back(trace.alloc_seq, trace.nbytes);
+    if (!trace.alive) {
+      events.emplace_back(trace.free_seq, -trace.nbytes);
+    }
+  }
+  std::sort(events.begin(), events.end());
+  int64_t curr = 0;
+  std::pair<uint64_t, int64_t> peak{0, 0};
+  for (const auto& event : events) {
+    curr += event.second;
+    if (curr > peak.second) {
+      peak = {event.first, curr};
+    }
+  }
+  return peak;
+}
+
+std::string MemoryProfiler::GetPeakBreakdown(const Device& device) {
+  std::lock_guard<std::mutex> lock(mu_);
+  auto device_str = std::string(device.c_str());
+  if (allocations_.count(device_str) == 0) {
+    return "";
+  }
+  const auto& allocations = allocations_[device_str];
+  uint64_t peak_seq = FindPeak(allocations).first;
+  // The allocations alive at the peak, grouped by the tag and the pc.
+  std::map<std::string, int64_t> folded;
+  for (const auto& trace : allocations) {
+    if (trace.alloc_seq <= peak_seq && (trace.alive || trace.free_seq > peak_seq)) {
+      std::string frame =
+          trace.tag + ";" + std::to_string(trace.func_index) + ":" + std::to_string(trace.pc);
+      folded[frame] += trace.nbytes;
+    }
+  }
+  std::ostringstream os;
+  for (const auto& kv : folded) {
+    os << device_str << ";" << kv.first << " " << kv.second << std::endl;
+  }
+  return os.str();
+}
+
+std::string MemoryProfiler::GetLiveAllocations(const Device& device) {
+  std::lock_guard<std::mutex> lock(mu_);
+  auto device_str = std::string(device.c_str());
+  if (allocations_.count(device_str) == 0) {
+    return "";
+  }
+  std::ostringstream os;
+  os << std::setw(20) << std::left << "#Address"
+     << "\t" << std::setw(15) << std::left << "#Bytes"
+     << "\t" << std::setw(12) << std::left << "#Func:PC"
+     << "\t" << std::setw(20) << std::left << "#Stream"
+     << "\t" << std::setw(20) << std::left << "#AllocTime(us)"
+     << "\t#Tag" << std::endl;
+  for (const auto& trace : allocations_[device_str]) {
+    if (!trace.alive) {
+      continue;
+    }
+    std::ostringstream address, stream;
+    address << reinterpret_cast<void*>(trace.address);
+    stream << trace.stream;
+    os << std::setw(20) << std::left << address.str() << "\t" << std::setw(15) << std::left
+       << trace.nbytes << "\t" << std::setw(12) << std::left
+       << std::to_string(trace.func_index) + ":" + std::to_string(trace.pc) << "\t"
+       << std::setw(20) << std::left << stream.str() << "\t" << std::setw(20) << std::left
+       << trace.alloc_time << "\t" << trace.tag << std::endl;
+  }
+  return os.str();
+}
+
+Map<String, FloatImm> MemoryProfiler::GetAllocationInfo(const Device& device) {
+  std::lock_guard<std::mutex> lock(mu_);
+  auto device_str = std::string(device.c_str());
+  const auto& allocations = allocations_[device_str];
+  int64_t live = 0;
+  for (const auto& trace : allocations) {
+    live += trace.alive ? trace.nbytes : 0;
+  }
+  Map<String, FloatImm> ret;
+  ret.Set("peak", FloatImm(DataType::Float(32), FindPeak(allocations).second / 1048576.0));
+  ret.Set("live", FloatImm(DataType::Float(32), live / 1048576.0));
+  ret.Set("num_allocations", FloatImm(DataType::Float(32), allocations.size()));
+  return ret;
 }
 
 Map<String, FloatImm> MemoryProfiler::GetMaxMemoryInfo(const Device& device) {
@@ -96,6 +248,14 @@ void DisableMemoryProfiler() {
   MemoryProfiler::Get()->SetProfile(false);
 }
 
+void EnableAllocationTrace() {
+  MemoryProfiler::Get()->SetTraceAllocation(true);
+}
+
+void DisableAllocationTrace() {
+  MemoryProfiler::Get()->SetTraceAllocation(false);
+}
+
 void ResetMemoryProfiler() {
   MemoryProfiler::Get()->Reset();
 }
@@ -112,6 +272,19 @@ RAF_REGISTER_GLOBAL("raf.memory_profiler.EnableMemoryProfiler")
     .set_body_typed(EnableMemoryProfiler);
 RAF_REGISTER_GLOBAL("raf.memory_profiler.DisableMemoryeProfiler")
     .set_body_typed(DisableMemoryProfiler);
+RAF_REGISTER_GLOBAL("raf.memory_profiler.EnableAllocationTrace")
+    .set_body_typed(EnableAllocationTrace);
+RAF_REGISTER_GLOBAL("raf.memory_profiler.DisableAllocationTrace")
+    .set_body_typed(DisableAllocationTrace);
+RAF_REGISTER_GLOBAL("raf.memory_profiler.GetPeakBreakdown").set_body_typed([](const Device& dev) {
+  return MemoryProfiler::Get()->GetPeakBreakdown(dev);
+});
+RAF_REGISTER_GLOBAL("raf.memory_profiler.GetLiveAllocations").set_body_typed([](const Device& dev) {
+  return MemoryProfiler::Get()->GetLiveAllocations(dev);
+});
+RAF_REGISTER_GLOBAL("raf.memory_profiler.GetAllocationInfo").set_body_typed([](const Device& dev) {
+  return MemoryProfiler::Get()->GetAllocationInfo(dev);
+});
 RAF_REGISTER_GLOBAL("raf.memory_profiler.ResetMemoryProfiler").set_body_typed(ResetMemoryProfiler);
 RAF_REGISTER_GLOBAL("raf.memory_profiler.GetMaxMemoryInfo").set_body_typed(GetMaxMemoryInfo);
 RAF_REGISTER_GLOBAL("raf.memory_profiler.GetMemoryTrace").set_body_typed(GetMemoryTrace);
@@ -10,9 +10,15 @@
 
 #include "raf/op_profiler.h"
 #include "raf/ir.h"
+#include "../3rdparty/tvm/src/runtime/file_utils.h"
 #include "../op/dialect/tvm/tvm_utils.h"
 #include "../requests.h"
 #include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <sstream>
 
 namespace raf {
 namespace op_profiler {
@@ -20,15 +26,84 @@ namespace op_profiler {
 using namespace raf::op;
 using namespace raf::value;
 
+/*! \brief The persistent cache entry of the profiled latency and workspace size of an op. */
+class OpLatencyCacheEntry {
+ public:
+  OpLatencyCacheEntry(const LatencyAndWorkspaceT& val, int64_t timestamp)
+      : val_(val), timestamp_(timestamp) {
+  }
+
+  const LatencyAndWorkspaceT& Value() const {
+    return val_;
+  }
+
+  /*! \brief The time when the op was profiled in seconds since epoch. */
+  int64_t Timestamp() const {
+    return timestamp_;
+  }
+
+  static OpLatencyCacheEntry Load(const std::string& path) {
+    std::string data;
+    tvm::runtime::LoadBinaryFromFile(path + "/value.bin", &data);
+    dmlc::MemoryStringStream reader(&data);
+    dmlc::Stream* stream = &reader;
+
+    LatencyAndWorkspaceT val;
+    int64_t timestamp;
+    CHECK(stream->Read(&val.first)) << "Failed to read the latency";
+    CHECK(stream->Read(&val.second)) << "Failed to read the workspace size";
+    CHECK(stream->Read(&timestamp)) << "Failed to read the timestamp";
+    return OpLatencyCacheEntry(val, timestamp);
+  }
+
+  bool Save(const std::string& path) {
+    std::string data;
+    dmlc::MemoryStringStream writer(&data);
+    dmlc::Stream* stream = &writer;
+    stream->Write(val_.first);
+    stream->Write(val_.second);
+    stream->Write(timestamp_);
+    tvm::runtime::SaveBinaryToFile(path + "/value.bin", data);
+    return true;
+  }
+
+ private:
+  LatencyAndWorkspaceT val_;
+  int64_t timestamp_;
+};
+
+MetaPersistCache<OpLatencyCacheEntry> CacheOpLatency("op_profiler_latency");
+
+/*!
+ * \brief The staleness window in seconds, within which the persisted latencies are trusted. It is
+ * one week by default, and can be set by RAF_OP_PROFILER_CACHE_TTL. Non-positive means the
+ * persisted latencies never expire.
+ */
+int64_t PersistTTL() {
+  static int64_t ttl = []() {
+    const char* ttl_str = getenv("RAF_OP_PROFILER_CACHE_TTL");
+    return ttl_str != nullptr ? std::atoll(ttl_str) : int64_t(7 * 24 * 3600);
+  }();
+  return ttl;
+}
+
 OpProfiler* OpProfiler::Get(const Device& device) {
-  CHECK_EQ(device.device_id(), 0) << "Multi-device profiling is not supported yet";
   if (device.device_type() == DevType::kCPU()) {
+    CHECK_EQ(device.device_id(), 0) << "Multi-device profiling is not supported on CPU";
     static CPUOpProfiler profiler = CPUOpProfiler(device);
     return &profiler;
   } else if (device.device_type() == DevType::kCUDA()) {
 #ifdef RAF_USE_CUDA
-    static CUDAOpProfiler profiler = CUDAOpProfiler(device);
-    return &profiler;
+    // Each GPU has its own profiler, which is created on the first use by the thread that profiles
+    // on this GPU, since the profiler binds its events to the current device of the thread.
+    static std::mutex mu;
+    static std::unordered_map<int, std::unique_ptr<CUDAOpProfiler>> profilers;
+    std::lock_guard<std::mutex> lock(mu);
+    auto& profiler = profilers[device.device_id()];
+    if (profiler == nullptr) {
+      profiler = std::make_unique<CUDAOpProfiler>(device);
+    }
+    return profiler.get();
 #else
     LOG(FATAL) << "CUDA is not enabled";
 #endif
@@ -94,6 +169,32 @@ OpWithData::~OpWithData() {
   inputs.clear();
 }
 
+std::string OpProfiler::PersistKey(const HashKey& key) {
+  if (fingerprint_.empty()) {
+    fingerprint_ = DeviceFingerprint();
+  }
+  HashKey persist_key;
+  persist_key << fingerprint_ << HashKeyToStr(key);
+  return HashKeyToStr(persist_key);
+}
+
+bool OpProfiler::LoadPersisted(const std::string& key, LatencyAndWorkspaceT* ret) {
+  auto* entry = CacheOpLatency.Get(key);
+  if (entry == nullptr) {
+    return false;
+  }
+  int64_t ttl = PersistTTL();
+  if (ttl > 0 && std::time(nullptr) - entry->Timestamp() > ttl) {
+    return false;
+  }
+  *ret = entry->Value();
+  return true;
+}
+
+void OpProfiler::SavePersisted(const std::string& key, const LatencyAndWorkspaceT& val) {
+  CacheOpLatency.Set(key, OpLatencyCacheEntry(val, std::time(nullptr)));
+}
+
 OpEnvPtr OpProfiler::GetOpEnv(const Expr& op) {
   if (auto call_node = op.as<CallNode>()) {
     auto call = GetRef<Call>(call_node);
@@ -117,6 +218,15 @@ std::pair<std::vector<float>, float> OpProfiler::ProfileOpGroup(const std::vecto
     return latency_and_workspace_size_cache_[key];
   }
 
+  // Reuse the latency profiled by a previous process if it is fresh.
+  auto persist_key =
+      PersistKey(HashGroup(ops, stream_ids, true) << warmup << exec_number << repeat);
+  LatencyAndWorkspaceT persisted;
+  if (LoadPersisted(persist_key, &persisted)) {
+    latency_and_workspace_size_cache_[key] = std::move(persisted);
+    return latency_and_workspace_size_cache_[key];
+  }
+
   // Prepare ops for profiling.
   std::vector<OpWithDataPtr> ops_with_data;
   int64_t total_workspace_size = 0;
@@ -136,6 +246,7 @@ std::pair<std::vector<float>, float> OpProfiler::ProfileOpGroup(const std::vecto
   // Add the result to the cache.
   latency_and_workspace_size_cache_[key] =
       std::move(std::make_pair(std::move(cost), total_workspace_size));
+  SavePersisted(persist_key, latency_and_workspace_size_cache_[key]);
   return latency_and_workspace_size_cache_[key];
 }
 
@@ -153,6 +264,20 @@ std::pair<std::vector<float>, float> OpProfiler::ProfileOp(const Expr& op, int32
       return latency_and_workspace_size_cache_[key];
     }
 
+    // Reuse the latency profiled by a previous process if it is fresh. The ops that are only
+    // built but not executed (e.g., to query the workspace size) are not persisted, because
+    // their OpEnvs are needed.
+    bool persist = exec_number > 0 && repeat > 0;
+    std::string persist_key;
+    if (persist) {
+      persist_key = PersistKey(HashCall(call, true) << warmup << exec_number << repeat);
+      LatencyAndWorkspaceT persisted;
+      if (LoadPersisted(persist_key, &persisted)) {
+        latency_and_workspace_size_cache_[key] = std::move(persisted);
+        return latency_and_workspace_size_cache_[key];
+      }
+    }
+
     // Build the op and generate dummy input data for profiling.
     OpWithDataPtr op_with_data = std::make_shared<OpWithData>(device_, op);
 
@@ -167,6 +292,9 @@ std::pair<std::vector<float>, float> OpProfiler::ProfileOp(const Expr& op, int32
     // Add the profiled cost to the cache.
     latency_and_workspace_size_cache_[key] =
         std::move(std::make_pair(std::move(cost), workspace_size));
+    if (persist) {
+      SavePersisted(persist_key, latency_and_workspace_size_cache_[key]);
+    }
     return latency_and_workspace_size_cache_[key];
   }
 
@@ -235,6 +363,18 @@ std::vector<float> CPUOpProfiler::RunOpGroup(const std::vector<OpWithDataPtr>& o
 }
 
 #ifdef RAF_USE_CUDA
+std::string CUDAOpProfiler::DeviceFingerprint() {
+  cudaDeviceProp prop;
+  CUDA_CALL(cudaGetDeviceProperties(&prop, device_.device_id()));
+  int driver_version = 0, runtime_version = 0;
+  CUDA_CALL(cudaDriverGetVersion(&driver_version));
+  CUDA_CALL(cudaRuntimeGetVersion(&runtime_version));
+  std::ostringstream os;
+  os << prop.name << ":sm_" << prop.major << prop.minor << ":driver_" << driver_version
+     << ":runtime_" << runtime_version;
+  return os.str();
+}
+
 // Run the op on the CUDA device, return the profiled execution time in microseconds
 std::vector<float> CUDAOpProfiler::RunOp(const OpWithDataPtr& op_with_data, int32_t warmup,
                                          int32_t exec_number, int32_t repeat) {
@@ -0,0 +1,198 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/profiler/tune_queue.cc
+ * \brief Tune the kernels of a module across the local devices and the ranks. The unique calls
+ * are partitioned across the ranks, and the calls of a rank are queued to one worker per local
+ * device. Each worker builds (i.e., tunes) and profiles the kernels on its own device with the op
+ * profiler, and the results are merged into the caches shared by the devices, which are also
+ * shared by the ranks when the persistent cache is enabled.
+ */
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <thread>
+#include "raf/device_api.h"
+#include "raf/op_profiler.h"
+#include "raf/pass.h"
+#include "../pass/common.h"
+
+namespace raf {
+namespace op_profiler {
+namespace tune_queue {
+
+using namespace raf::ir;
+using namespace raf::op;
+using raf::pass::ExplicitLetList;
+
+/*! \brief A tuning job, which is a unique call in the module. */
+struct TuneJob {
+  /*! \brief The call to be tuned. */
+  Call call;
+  /*! \brief The name of the tuned kernel. */
+  std::string name;
+  /*! \brief The device that tuned the call, or -1 if it is not tuned. */
+  int device_id = -1;
+  /*! \brief The profiled latency in microseconds. */
+  float latency_us = 0.0f;
+  /*! \brief The error message if the call failed to be tuned. */
+  std::string error;
+};
+
+/*!
+ * \brief Collect the calls of ops and primitive functions from the main function, which is either
+ * before or after ManifestAlloc. The calls after ManifestAlloc are those invoked by invoke_op.
+ */
+class CallCollector {
+ public:
+  explicit CallCollector(const Function& func) : ell_(ExplicitLetList::make(func->body)) {
+  }
+
+  std::vector<Call> Run() {
+    static const Op& invoke_op = Op::Get("raf.op.vm.invoke_op");
+    std::unordered_map<const VarNode*, Expr> let_map;
+    std::vector<Call> calls;
+    for (size_t i = 0; i < ell_->vars.size(); ++i) {
+      let_map[ell_->vars[i].get()] = ell_->exprs[i];
+      const auto* call = ell_->exprs[i].as<CallNode>();
+      if (call == nullptr) {
+        continue;
+      }
+      if (call->op == invoke_op) {
+        auto callee = let_map.at(call->args[0].as<VarNode>());
+        auto args = Downcast<Tuple>(let_map.at(call->args[1].as<VarNode>()))->fields;
+        calls.push_back(Downcast<Call>(pass::InferType(Call(callee, args))));
+      } else if (IsKernel(call->op)) {
+        calls.push_back(GetRef<Call>(call));
+      }
+    }
+    return calls;
+  }
+
+ private:
+  /*! \brief Whether the callee is a kernel, which excludes the VM ops and the closures. */
+  static bool IsKernel(const Expr& callee) {
+    if (const auto* op = callee.as<OpNode>()) {
+      return op->name.compare(0, 10, "raf.op.vm.") != 0;
+    }
+    const auto* func = callee.as<FunctionNode>();
+    return func != nullptr && func->HasNonzeroAttr(attr::kPrimitive);
+  }
+
+  /*! \brief The explicit let list of the main function. */
+  std::unique_ptr<ExplicitLetList> ell_;
+};
+
+/*! \brief Tune the jobs by one worker per device, which takes the next job from the queue. */
+void RunQueue(std::vector<TuneJob>* jobs, const std::vector<Device>& devices, int warmup,
+              int exec_number, int repeat) {
+  std::atomic<size_t> next{0};
+  auto worker = [&](const Device& device) {
+    // The kernels are built and launched on the current device of the thread.
+    auto api = device_api::DeviceAPI::Get(device.device_type());
+    api->SetDevice(device.device_id());
+    auto profiler = OpProfiler::Get(device);
+    for (size_t i = next++; i < jobs->size(); i = next++) {
+      TuneJob& job = (*jobs)[i];
+      try {
+        auto latencies = profiler->ProfileOp(job.call, warmup, exec_number, repeat).first;
+        if (!latencies.empty()) {
+          job.latency_us = *std::min_element(latencies.begin(), latencies.end());
+        }
+        // The OpEnv is not built if the latency is reloaded from the persistent cache.
+        auto op_env = profiler->GetOpEnv(job.call);
+        if (op_env != nullptr) {
+          job.name = op_env->name();
+        }
+        job.device_id = device.device_id();
+      } catch (const dmlc::Error& e) {
+        job.error = e.what();
+        LOG(WARNING) << "Failed to tune " << job.call->op << " on " << device.c_str() << ": "
+                     << e.what();
+      }
+    }
+  };
+  // The profilers bind to the current device of their threads, so the calling thread only waits.
+  std::vector<std::thread> threads;
+  for (const auto& device : devices) {
+    threads.emplace_back(worker, device);
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+/*! \brief The name of the callee, which is used if the OpEnv is not built. */
+std::string CalleeName(const Call& call) {
+  if (const auto* op = call->op.as<OpNode>()) {
+    return op->name;
+  }
+  return "fused_function";
+}
+
+}  // namespace tune_queue
+
+/*!
+ * \brief Tune the kernels of the main function across the local devices and the ranks.
+ * \param mod The module, whose main function is either before or after ManifestAlloc.
+ * \param devices The local devices of this rank to tune on, which must be of the same type.
+ * \param rank The rank of this process.
+ * \param num_ranks The number of ranks, which share the jobs in the order of their keys.
+ * \param warmup The number of warmup iterations of profiling each kernel.
+ * \param exec_number The number of execution iterations of profiling each kernel.
+ * \param repeat The number of repeat iterations of profiling each kernel.
+ * \return An array of [kernel name, device ID, latency in microseconds, error] of the jobs of
+ * this rank, where the device ID is -1 if the job failed.
+ */
+Array<Array<ObjectRef>> TuneKernels(const IRModule& mod, const Array<Device>& devices, int rank,
+                                    int num_ranks, int warmup, int exec_number, int repeat) {
+  CHECK(!devices.empty()) << "No device to tune on";
+  CHECK(rank >= 0 && rank < num_ranks) << "Rank " << rank << " is out of range [0, " << num_ranks
+                                       << ")";
+  for (const auto& device : devices) {
+    CHECK(device.device_type() == devices[0].device_type())
+        << "The devices to tune on must be of the same type";
+  }
+  auto func = Downcast<Function>(mod->Lookup("main"));
+  auto calls = tune_queue::CallCollector(func).Run();
+
+  // Deduplicate the calls by their persistent keys, which are sorted so that all ranks partition
+  // the same list of jobs. The keys are made in a worker thread for the same reason as tuning.
+  std::map<std::string, Call> unique_calls;
+  std::thread([&]() {
+    device_api::DeviceAPI::Get(devices[0].device_type())->SetDevice(devices[0].device_id());
+    auto profiler = OpProfiler::Get(devices[0]);
+    for (const auto& call : calls) {
+      unique_calls.emplace(profiler->GetPersistKey(call), call);
+    }
+  }).join();
+  std::vector<tune_queue::TuneJob> jobs;
+  int index = 0;
+  for (const auto& kv : unique_calls) {
+    if (index++ % num_ranks == rank) {
+      tune_queue::TuneJob job;
+      job.call = kv.second;
+      job.name = tune_queue::CalleeName(kv.second);
+      jobs.push_back(job);
+    }
+  }
+  DLOG(INFO) << "Tuning " << jobs.size() << " of " << unique_calls.size() << " kernels on "
+             << devices.size() << " devices of rank " << rank;
+  tune_queue::RunQueue(&jobs, std::vector<Device>(devices.begin(), devices.end()), warmup,
+                       exec_number, repeat);
+
+  Array<Array<ObjectRef>> ret;
+  for (const auto& job : jobs) {
+    ret.push_back({String(job.name), Integer(job.device_id),
+                   FloatImm(DataType::Float(32), job.latency_us), String(job.error)});
+  }
+  return ret;
+}
+
+RAF_REGISTER_GLOBAL("raf.op_profiler.TuneKernels").set_body_typed(TuneKernels);
+
+}  // namespace op_profiler
+}  // namespace raf
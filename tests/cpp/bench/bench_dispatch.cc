@@ -0,0 +1,88 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <raf/cache.h>
+#include <raf/device.h>
+#include <raf/dialect.h>
+#include <raf/op.h>
+#include <raf/value.h>
+
+using raf::Device;
+using raf::DevType;
+using raf::HashKey;
+using raf::ir::Array;
+using raf::ir::Op;
+using raf::op::CallValues;
+using raf::op::Dispatch;
+using raf::op::MakeListArgs;
+using raf::op::OpDialect;
+using raf::op::OpEnv;
+using raf::value::OpValue;
+using raf::value::Value;
+
+RAF_REGISTER_OP("raf.op.bench.noop");
+
+// An OpEnv that does nothing, so the benchmarks only measure the dispatch.
+class NoopOpEnv : public OpEnv {
+ public:
+  std::string name() const override {
+    return "bench.noop";
+  }
+  void Execute(const CallValues& call) override final {
+  }
+  void Execute(const std::vector<Value>& inputs, Value output) override final {
+  }
+  static OpEnv* make(const CallValues& call) {
+    return new NoopOpEnv();
+  }
+};
+RAF_REGISTER_DIALECT("benchLow").set_enable(DevType::kCPU());
+RAF_REGISTER_DIALECT_OP(benchLow, bench.noop, 10);
+RAF_OP_ENV_MAKER("raf.op.benchLow.bench.noop", NoopOpEnv::make);
+RAF_REGISTER_DIALECT("benchHigh").set_enable(DevType::kCPU());
+RAF_REGISTER_DIALECT_OP(benchHigh, bench.noop, 20);
+RAF_OP_ENV_MAKER("raf.op.benchHigh.bench.noop", NoopOpEnv::make);
+
+static void BM_GetDispatchList(benchmark::State& state) {
+  Op op = Op::Get("raf.op.bench.noop");
+  for (auto _ : state) {
+    auto dispatch_list = OpDialect::GetDispatchList(op, DevType::kCPU());
+    benchmark::DoNotOptimize(dispatch_list.data());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GetDispatchList);
+
+static void BM_Dispatch(benchmark::State& state) {
+  CallValues call = CallValues::make();
+  call->callee = OpValue::make(Op::Get("raf.op.bench.noop"));
+  call->args = MakeListArgs({});
+  call->device = Device(DevType::kCPU(), 0);
+  for (auto _ : state) {
+    auto op_env = Dispatch(call);
+    benchmark::DoNotOptimize(op_env.get());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Dispatch);
+
+// Hash a key made of the given number of int64 shapes and a string, which is the typical
+// content of the OpEnv cache keys.
+static void BM_HashKey(benchmark::State& state) {
+  std::vector<int64_t> shape = {32, 3, 224, 224};
+  int64_t num_tensors = state.range(0);
+  for (auto _ : state) {
+    HashKey key;
+    key << std::string("raf.op.conv2d");
+    for (int64_t i = 0; i < num_tensors; ++i) {
+      key << shape;
+    }
+    benchmark::DoNotOptimize(key.byte_vector.data());
+  }
+  state.SetItemsProcessed(state.iterations() * num_tensors);
+}
+BENCHMARK(BM_HashKey)->ArgNames({"tensors"})->Arg(1)->Arg(4)->Arg(16);
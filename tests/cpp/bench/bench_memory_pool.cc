@@ -0,0 +1,67 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <raf/device.h>
+#include <raf/memory_pool.h>
+
+using raf::Device;
+using raf::DevType;
+using raf::memory_pool::Memory;
+
+static void InitPool(const benchmark::State& state, const Device& dev) {
+  static const char* pool_names[] = {"no_pool", "page_unit_pool"};
+  Memory::InitPool(dev, pool_names[state.range(0)]);
+}
+
+// Allocate and free a chunk of the given size in a loop.
+static void BM_MemoryAllocFree(benchmark::State& state) {
+  Device dev{DevType::kCPU(), 0};
+  InitPool(state, dev);
+  int64_t nbytes = state.range(1);
+  for (auto _ : state) {
+    auto memory = Memory::Alloc(dev, nbytes);
+    benchmark::DoNotOptimize(memory->data);
+  }
+  state.SetItemsProcessed(state.iterations());
+  Memory::RemovePool(dev);
+}
+BENCHMARK(BM_MemoryAllocFree)
+    ->ArgNames({"pool", "nbytes"})
+    ->ArgsProduct({{0, 1}, {64, 4096, 1 << 20}});
+
+// Keep a window of live chunks of mixed sizes and replace the oldest one in each iteration,
+// which mimics the allocation churn of a training step.
+static void BM_MemoryChurn(benchmark::State& state) {
+  Device dev{DevType::kCPU(), 0};
+  InitPool(state, dev);
+  constexpr int kWindow = 64;
+  static const int64_t sizes[] = {256, 4096, 65536, 1 << 20};
+  std::vector<std::shared_ptr<Memory>> live(kWindow);
+  int64_t i = 0;
+  for (auto _ : state) {
+    live[i % kWindow] = Memory::Alloc(dev, sizes[i % 4]);
+    ++i;
+  }
+  live.clear();
+  state.SetItemsProcessed(state.iterations());
+  Memory::RemovePool(dev);
+}
+BENCHMARK(BM_MemoryChurn)->ArgNames({"pool"})->Arg(0)->Arg(1);
+
+// Allocate a batch of chunks at once.
+static void BM_MemoryAllocBatch(benchmark::State& state) {
+  Device dev{DevType::kCPU(), 0};
+  InitPool(state, dev);
+  std::vector<int64_t> nbytes(state.range(1), 4096);
+  for (auto _ : state) {
+    auto memories = Memory::AllocBatch(dev, nbytes);
+    benchmark::DoNotOptimize(memories.data());
+  }
+  state.SetItemsProcessed(state.iterations() * nbytes.size());
+  Memory::RemovePool(dev);
+}
+BENCHMARK(BM_MemoryAllocBatch)->ArgNames({"pool", "batch"})->ArgsProduct({{0, 1}, {8, 64}});
@@ -0,0 +1,66 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+#include <dmlc/memory_io.h>
+
+#include <raf/device.h>
+#include <raf/memory_pool.h>
+#include <raf/serialization.h>
+#include <raf/value.h>
+
+using raf::Device;
+using raf::DevType;
+using raf::DType;
+using raf::DTypeCode;
+using raf::ir::Array;
+using raf::memory_pool::Memory;
+using raf::serialization::SerializeValue;
+using raf::value::TensorValue;
+using raf::value::TupleValue;
+using raf::value::Value;
+
+static TensorValue MakeTensor(const std::vector<int64_t>& shape) {
+  Device dev{DevType::kCPU(), 0};
+  int64_t nbytes = 4;
+  for (int64_t dim : shape) {
+    nbytes *= dim;
+  }
+  auto memory = Memory::Alloc(dev, nbytes);
+  return TensorValue::Assemble(dev, DType(DTypeCode::kFloat(), 32), shape, {}, memory->data,
+                               memory);
+}
+
+// Serialize a tensor of the given number of floats.
+static void BM_SerializeTensor(benchmark::State& state) {
+  Value value = MakeTensor({state.range(0)});
+  std::string buffer;
+  for (auto _ : state) {
+    buffer.clear();
+    dmlc::MemoryStringStream strm(&buffer);
+    SerializeValue(&strm, value);
+    benchmark::DoNotOptimize(buffer.data());
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0) * 4);
+}
+BENCHMARK(BM_SerializeTensor)->ArgNames({"floats"})->Arg(1 << 10)->Arg(1 << 20)->Arg(1 << 24);
+
+// Serialize a tuple of many small tensors, which is dominated by the per-value overhead.
+static void BM_SerializeTuple(benchmark::State& state) {
+  Array<Value> fields;
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    fields.push_back(MakeTensor({16}));
+  }
+  Value value = TupleValue::make(fields);
+  std::string buffer;
+  for (auto _ : state) {
+    buffer.clear();
+    dmlc::MemoryStringStream strm(&buffer);
+    SerializeValue(&strm, value);
+    benchmark::DoNotOptimize(buffer.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SerializeTuple)->ArgNames({"fields"})->Arg(16)->Arg(256);
@@ -0,0 +1,85 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <raf/device.h>
+#include <raf/memory_pool.h>
+#include <raf/value.h>
+#include <raf/vm/executable.h>
+#include <raf/vm/vm.h>
+
+using raf::Device;
+using raf::DevType;
+using raf::DType;
+using raf::DTypeCode;
+using raf::executor::vm::Executable;
+using raf::executor::vm::Index;
+using raf::executor::vm::Instruction;
+using raf::executor::vm::VirtualMachine;
+using raf::executor::vm::VMContext;
+using raf::executor::vm::VMFunction;
+using raf::ir::make_object;
+using raf::ir::Op;
+using raf::memory_pool::Memory;
+using raf::value::OpValue;
+using raf::value::TensorValue;
+using raf::value::Value;
+
+static TensorValue MakeTensor(const std::vector<int64_t>& shape) {
+  Device dev{DevType::kCPU(), 0};
+  int64_t nbytes = 4;
+  for (int64_t dim : shape) {
+    nbytes *= dim;
+  }
+  auto memory = Memory::Alloc(dev, nbytes);
+  return TensorValue::Assemble(dev, DType(DTypeCode::kFloat(), 32), shape, {}, memory->data,
+                               memory);
+}
+
+/*! \brief Run the "main" function of a synthetic executable in a loop. */
+static void RunMain(benchmark::State& state, const std::vector<Instruction>& instructions,
+                    std::vector<std::string> params, Index register_file_size,
+                    std::vector<Value> constants, const std::vector<Value>& inputs) {
+  auto exec = make_object<Executable>();
+  exec->constants = std::move(constants);
+  exec->global_map["main"] = 0;
+  exec->functions.emplace_back("main", std::move(params), instructions, register_file_size);
+  auto vm = make_object<VirtualMachine>(false, false);
+  vm->LoadExecutable(exec.get());
+  vm->SetDevices({Device(DevType::kCPU(), 0)});
+  VMContext ctx = vm->PrepareVMContext("main", inputs);
+  // Warm up the OpEnv cache.
+  vm->Run(ctx);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(vm->Run(ctx));
+  }
+  state.SetItemsProcessed(state.iterations() * instructions.size());
+}
+
+// The per-instruction overhead of the dispatch loop on a long bytecode of register moves.
+static void BM_RunLoopMove(benchmark::State& state) {
+  constexpr Index kNumRegs = 8;
+  std::vector<Instruction> instructions;
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    instructions.push_back(Instruction::Move(i % kNumRegs, (i + 1) % kNumRegs));
+  }
+  instructions.push_back(Instruction::Ret(0));
+  RunMain(state, instructions, {"x"}, kNumRegs, {}, {MakeTensor({1})});
+}
+BENCHMARK(BM_RunLoopMove)->ArgNames({"instructions"})->Arg(1 << 10)->Arg(1 << 16);
+
+// The cost of an InvokeJit whose OpEnv is found in the cache, which includes PrepareOpEnv and a
+// relu on a single element.
+static void BM_InvokeJitCacheHit(benchmark::State& state) {
+  std::vector<Instruction> instructions = {Instruction::LoadConst(0, 2)};
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    instructions.push_back(Instruction::InvokeJit(2, 2, 1, {0, 1}));
+  }
+  instructions.push_back(Instruction::Ret(1));
+  RunMain(state, instructions, {"x", "out"}, 3, {OpValue::make(Op::Get("raf.op.relu"))},
+          {MakeTensor({1}), MakeTensor({1})});
+}
+BENCHMARK(BM_InvokeJitCacheHit)->ArgNames({"instructions"})->Arg(1 << 10);
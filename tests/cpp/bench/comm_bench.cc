@@ -0,0 +1,414 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file tests/cpp/bench/comm_bench.cc
+ * \brief The collective communication benchmark, which times each collective through the RAF op
+ * path (an InvokeJit of the VM dispatched to the NCCL dialect) against the raw NCCL call on the
+ * same communicator, so that the RAF overhead is separated from the NCCL performance. It runs on
+ * all ranks under MPI, e.g., on two nodes of 8 GPUs:
+ *   mpirun -np 16 -npernode 8 bin/raf_comm_bench --min-bytes 1024 --max-bytes 268435456
+ * Rank 0 prints one row per collective, size and tuple count with the latency of both paths, the
+ * algorithm and bus bandwidths of the RAF path following the conventions of nccl-tests, and the
+ * pack/unpack time of the tuple fusion, i.e., the copies between the tuple fields and the fused
+ * buffer that the NCCL dialect launches for a tuple of more than one tensor.
+ */
+#include <cuda_runtime.h>
+#include <mpi.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <raf/device.h>
+#include <raf/dist_context.h>
+#include <raf/memory_pool.h>
+#include <raf/nccl_communicator.h>
+#include <raf/value.h>
+#include <raf/vm/executable.h>
+#include <raf/vm/vm.h>
+
+using raf::Device;
+using raf::DevType;
+using raf::DType;
+using raf::DTypeCode;
+using raf::distributed::DistContext;
+using raf::distributed::communicator::Communicator;
+using raf::distributed::communicator::NCCLCommunicator;
+using raf::executor::vm::Executable;
+using raf::executor::vm::Index;
+using raf::executor::vm::Instruction;
+using raf::executor::vm::VirtualMachine;
+using raf::executor::vm::VMContext;
+using raf::ir::Array;
+using raf::ir::Downcast;
+using raf::ir::make_object;
+using raf::ir::Op;
+using raf::memory_pool::Memory;
+using raf::value::OpValue;
+using raf::value::ScalarValue;
+using raf::value::StringValue;
+using raf::value::TensorValue;
+using raf::value::TupleValue;
+using raf::value::Value;
+
+#define CUDA_CHECK(cmd)                                                                \
+  do {                                                                                 \
+    cudaError_t e = cmd;                                                               \
+    CHECK_EQ(e, cudaSuccess) << "CUDA error " << __FILE__ << ":" << __LINE__ << ": "   \
+                             << cudaGetErrorString(e);                                 \
+  } while (0)
+
+namespace {
+
+/*! \brief The options of the benchmark. */
+struct Options {
+  int64_t min_bytes = 1 << 10;
+  int64_t max_bytes = 1 << 28;
+  int64_t step_factor = 4;
+  std::vector<int> tuple_sizes = {1, 4, 16};
+  int warmup = 5;
+  int iters = 20;
+  std::vector<std::string> ops = {"allreduce", "allgather", "reduce_scatter", "broadcast",
+                                  "sendrecv"};
+};
+
+/*! \brief The buffers and the program of a collective, which is run by both paths. */
+struct Case {
+  /*! \brief The inputs of the main function of the VM, i.e., the input and the output fields. */
+  std::vector<Value> vm_inputs;
+  /*! \brief The bytecode of the main function of the VM. */
+  std::vector<Instruction> instructions;
+  std::vector<Value> constants;
+  Index num_regs = 0;
+  /*! \brief Launch the raw NCCL call on the stream. */
+  std::function<void(cudaStream_t)> raw;
+  /*! \brief The input fields packed into the fused buffer by the tuple fusion. */
+  std::vector<TensorValue> pack_fields;
+  /*! \brief The output fields unpacked from the fused buffer by the tuple fusion. */
+  std::vector<TensorValue> unpack_fields;
+  /*! \brief The bytes of the collective, whose bandwidths are computed as in nccl-tests. */
+  int64_t bytes = 0;
+  /*! \brief The ratio of the bus bandwidth to the algorithm bandwidth. */
+  double bus_factor = 1.0;
+  /*! \brief Whether this rank takes part in the collective. */
+  bool active = true;
+};
+
+/*! \brief The buffers allocated for the benchmark, which are kept alive across the cases. */
+std::vector<std::shared_ptr<Memory>> buffers;
+
+TensorValue MakeTensor(const Device& dev, int64_t numel) {
+  auto memory = Memory::Alloc(dev, std::max<int64_t>(numel, 1) * sizeof(float));
+  CUDA_CHECK(cudaMemset(memory->data, 0, std::max<int64_t>(numel, 1) * sizeof(float)));
+  buffers.push_back(memory);
+  std::vector<int64_t> shape;
+  if (numel > 0) {
+    shape.push_back(numel);
+  }
+  return TensorValue::Assemble(dev, DType(DTypeCode::kFloat(), 32), shape, {}, memory->data,
+                               memory);
+}
+
+void* Data(const TensorValue& tensor) {
+  return tensor->tensor->data;
+}
+
+int64_t NumBytes(const TensorValue& tensor) {
+  int64_t nbytes = sizeof(float);
+  for (int i = 0; i < tensor->tensor->ndim; ++i) {
+    nbytes *= tensor->tensor->shape[i];
+  }
+  return nbytes;
+}
+
+TupleValue MakeTuple(const std::vector<TensorValue>& fields) {
+  return TupleValue::make(Array<Value>(fields.begin(), fields.end()));
+}
+
+/*!
+ * \brief Build the bytecode of main(inputs..., outputs...) that invokes the op once. The first
+ * input register holds the input (a tuple for the tuple ops), followed by the output registers,
+ * the registers of the other arguments loaded from the constants, and the op.
+ */
+void BuildProgram(Case* c, const std::string& op_name, int num_inputs, int num_outputs,
+                  const std::vector<Value>& attrs) {
+  Index num_params = num_inputs + num_outputs;
+  std::vector<Index> arg_regs;
+  for (Index i = 0; i < num_inputs; ++i) {
+    arg_regs.push_back(i);
+  }
+  Index reg = num_params;
+  for (const auto& attr : attrs) {
+    c->constants.push_back(attr);
+    c->instructions.push_back(Instruction::LoadConst(c->constants.size() - 1, reg));
+    arg_regs.push_back(reg++);
+  }
+  for (Index i = 0; i < num_outputs; ++i) {
+    arg_regs.push_back(num_inputs + i);
+  }
+  c->constants.push_back(OpValue::make(Op::Get(op_name)));
+  c->instructions.push_back(Instruction::LoadConst(c->constants.size() - 1, reg));
+  c->instructions.push_back(Instruction::InvokeJit(reg, arg_regs.size(), num_outputs, arg_regs));
+  c->instructions.push_back(Instruction::Ret(num_inputs));
+  c->num_regs = reg + 1;
+}
+
+Case MakeCase(const std::string& op, int64_t bytes, int tuple_size, const Device& dev,
+              ncclComm_t comm, int rank, int size) {
+  Case c;
+  const int64_t numel = bytes / sizeof(float);
+  c.bytes = numel * sizeof(float);
+  if (op == "allreduce" || op == "broadcast") {
+    // The tuple is fused into one buffer of the total size.
+    const int64_t field_numel = numel / tuple_size;
+    std::vector<TensorValue> inputs, outputs;
+    for (int i = 0; i < tuple_size; ++i) {
+      inputs.push_back(MakeTensor(dev, field_numel));
+      outputs.push_back(MakeTensor(dev, field_numel));
+    }
+    c.vm_inputs.push_back(MakeTuple(inputs));
+    c.vm_inputs.insert(c.vm_inputs.end(), outputs.begin(), outputs.end());
+    c.bytes = field_numel * tuple_size * sizeof(float);
+    TensorValue fused_in = MakeTensor(dev, field_numel * tuple_size);
+    TensorValue fused_out = MakeTensor(dev, field_numel * tuple_size);
+    const size_t count = field_numel * tuple_size;
+    if (op == "allreduce") {
+      BuildProgram(&c, "raf.op._allreduce", 1, tuple_size, {StringValue::make("sum")});
+      c.bus_factor = 2.0 * (size - 1) / size;
+      c.raw = [=](cudaStream_t stream) {
+        NCCL_CALL(ncclAllReduce(Data(fused_in), Data(fused_out), count, ncclFloat32, ncclSum,
+                                comm, stream));
+      };
+    } else {
+      BuildProgram(&c, "raf.op._broadcast", 1, tuple_size, {ScalarValue::make(0)});
+      c.raw = [=](cudaStream_t stream) {
+        NCCL_CALL(ncclBroadcast(Data(fused_in), Data(fused_out), count, ncclFloat32, 0, comm,
+                                stream));
+      };
+    }
+    if (tuple_size > 1) {
+      c.pack_fields = inputs;
+      c.unpack_fields = outputs;
+    }
+  } else if (op == "allgather") {
+    // The bytes are of the gathered output, and each rank sends 1/size of them.
+    const int64_t send_numel = numel / size;
+    TensorValue x = MakeTensor(dev, send_numel);
+    TensorValue out = MakeTensor(dev, send_numel * size);
+    c.vm_inputs = {x, out};
+    c.bytes = send_numel * size * sizeof(float);
+    c.bus_factor = 1.0 * (size - 1) / size;
+    BuildProgram(&c, "raf.op._allgather", 1, 1, {ScalarValue::make(0)});
+    c.raw = [=](cudaStream_t stream) {
+      NCCL_CALL(ncclAllGather(Data(x), Data(out), send_numel, ncclFloat32, comm, stream));
+    };
+  } else if (op == "reduce_scatter") {
+    // The bytes are of the input, which is a tuple of one field per rank packed into a buffer.
+    const int64_t recv_numel = numel / size;
+    std::vector<TensorValue> inputs;
+    for (int i = 0; i < size; ++i) {
+      inputs.push_back(MakeTensor(dev, recv_numel));
+    }
+    TensorValue out = MakeTensor(dev, recv_numel);
+    TensorValue fused_in = MakeTensor(dev, recv_numel * size);
+    c.vm_inputs = {MakeTuple(inputs), out};
+    c.bytes = recv_numel * size * sizeof(float);
+    c.bus_factor = 1.0 * (size - 1) / size;
+    BuildProgram(&c, "raf.op._reduce_scatter", 1, 1, {StringValue::make("sum")});
+    c.raw = [=](cudaStream_t stream) {
+      NCCL_CALL(ncclReduceScatter(Data(fused_in), Data(out), recv_numel, ncclFloat32, ncclSum,
+                                  comm, stream));
+    };
+    if (size > 1) {
+      c.pack_fields = inputs;
+    }
+  } else if (op == "sendrecv") {
+    // The even ranks send to the next odd ranks, and the last rank idles if the size is odd.
+    int peer = rank % 2 == 0 ? rank + 1 : rank - 1;
+    c.active = peer < size;
+    TensorValue x = MakeTensor(dev, numel);
+    if (rank % 2 == 0) {
+      c.vm_inputs = {x, MakeTensor(dev, 0)};
+      BuildProgram(&c, "raf.op._send", 1, 1, {ScalarValue::make(peer)});
+      c.raw = [=](cudaStream_t stream) {
+        NCCL_CALL(ncclSend(Data(x), numel, ncclFloat32, peer, comm, stream));
+      };
+    } else {
+      Array<Value> shape = {ScalarValue::make(numel)};
+      c.vm_inputs = {x};
+      BuildProgram(&c, "raf.op._recv", 0, 1,
+                   {ScalarValue::make(peer), TupleValue::make(shape),
+                    StringValue::make("float32")});
+      c.raw = [=](cudaStream_t stream) {
+        NCCL_CALL(ncclRecv(Data(x), numel, ncclFloat32, peer, comm, stream));
+      };
+    }
+  } else {
+    LOG(FATAL) << "Unknown collective " << op;
+  }
+  return c;
+}
+
+/*! \brief The average time of a run in microseconds, which is the max over the ranks. */
+double TimeUs(const std::function<void()>& run, int warmup, int iters) {
+  for (int i = 0; i < warmup; ++i) {
+    run();
+  }
+  CUDA_CHECK(cudaDeviceSynchronize());
+  MPI_CALL(MPI_Barrier(MPI_COMM_WORLD));
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iters; ++i) {
+    run();
+  }
+  CUDA_CHECK(cudaDeviceSynchronize());
+  double us =
+      std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() /
+      iters;
+  // A collective is as slow as its slowest rank.
+  MPI_CALL(MPI_Allreduce(MPI_IN_PLACE, &us, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD));
+  return us;
+}
+
+std::vector<std::string> SplitList(const std::string& str) {
+  std::vector<std::string> ret;
+  size_t begin = 0;
+  while (begin <= str.size()) {
+    size_t end = str.find(',', begin);
+    if (end == std::string::npos) {
+      end = str.size();
+    }
+    if (end > begin) {
+      ret.push_back(str.substr(begin, end - begin));
+    }
+    begin = end + 1;
+  }
+  return ret;
+}
+
+Options ParseOptions(int argc, char** argv) {
+  Options options;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::string key = argv[i];
+    std::string value = argv[i + 1];
+    if (key == "--min-bytes") {
+      options.min_bytes = std::stoll(value);
+    } else if (key == "--max-bytes") {
+      options.max_bytes = std::stoll(value);
+    } else if (key == "--step-factor") {
+      options.step_factor = std::stoll(value);
+    } else if (key == "--tuples") {
+      options.tuple_sizes.clear();
+      for (const auto& s : SplitList(value)) {
+        options.tuple_sizes.push_back(std::stoi(s));
+      }
+    } else if (key == "--ops") {
+      options.ops = SplitList(value);
+    } else if (key == "--warmup") {
+      options.warmup = std::stoi(value);
+    } else if (key == "--iters") {
+      options.iters = std::stoi(value);
+    } else {
+      LOG(FATAL) << "Unknown option " << key << ", candidates are --min-bytes, --max-bytes, "
+                 << "--step-factor, --tuples, --ops, --warmup and --iters";
+    }
+  }
+  CHECK_GT(options.step_factor, 1) << "--step-factor must be greater than 1";
+  return options;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options options = ParseOptions(argc, argv);
+  // The NCCL communicator initializes MPI, and its ranks are the ranks of MPI_COMM_WORLD.
+  Communicator comm = Communicator::Get("nccl");
+  ncclComm_t nccl_comm = Downcast<NCCLCommunicator>(comm)->nccl_comm;
+  const int rank = comm->rank;
+  const int size = comm->size;
+  Device dev(DevType::kCUDA(), DistContext::Global()->local_rank);
+  CUDA_CHECK(cudaSetDevice(dev.device_id()));
+  cudaStream_t stream;
+  CUDA_CHECK(cudaStreamCreateWithFlags(&stream, cudaStreamNonBlocking));
+
+  if (rank == 0) {
+    std::printf("# %d ranks, %d warmup and %d timed iterations, times in us, bandwidths in GB/s\n",
+                size, options.warmup, options.iters);
+    std::printf("%-15s %12s %6s %10s %10s %10s %8s %8s %10s\n", "collective", "bytes", "tuple",
+                "raf_us", "nccl_us", "overhead", "algbw", "busbw", "pack_us");
+  }
+  for (const auto& op : options.ops) {
+    // Only the collectives that fuse the tuples into a buffer are swept over the tuple sizes.
+    std::vector<int> tuple_sizes = {1};
+    if (op == "allreduce" || op == "broadcast") {
+      tuple_sizes = options.tuple_sizes;
+    } else if (op == "reduce_scatter") {
+      tuple_sizes = {size};
+    }
+    for (int tuple_size : tuple_sizes) {
+      for (int64_t bytes = options.min_bytes; bytes <= options.max_bytes;
+           bytes *= options.step_factor) {
+        Case c = MakeCase(op, bytes, tuple_size, dev, nccl_comm, rank, size);
+        auto exec = make_object<Executable>();
+        exec->constants = c.constants;
+        exec->global_map["main"] = 0;
+        std::vector<std::string> params;
+        for (size_t i = 0; i < c.vm_inputs.size(); ++i) {
+          params.push_back("p" + std::to_string(i));
+        }
+        exec->functions.emplace_back("main", params, c.instructions, c.num_regs);
+        auto vm = make_object<VirtualMachine>(false, false);
+        vm->LoadExecutable(exec.get());
+        vm->SetDevices({dev});
+        VMContext ctx = vm->PrepareVMContext("main", c.vm_inputs);
+
+        double raf_us = TimeUs([&]() {
+          if (c.active) {
+            vm->Run(ctx);
+          }
+        }, options.warmup, options.iters);
+        double nccl_us = TimeUs([&]() {
+          if (c.active) {
+            c.raw(stream);
+          }
+        }, options.warmup, options.iters);
+        // The same copies as the packing of the inputs and the unpacking of the outputs.
+        double pack_us = 0;
+        if (!c.pack_fields.empty()) {
+          char* fused = static_cast<char*>(Data(MakeTensor(dev, c.bytes / sizeof(float))));
+          pack_us = TimeUs([&]() {
+            int64_t offset = 0;
+            for (const auto& field : c.pack_fields) {
+              CUDA_CHECK(cudaMemcpyAsync(fused + offset, Data(field), NumBytes(field),
+                                         cudaMemcpyDeviceToDevice, stream));
+              offset += NumBytes(field);
+            }
+            offset = 0;
+            for (const auto& field : c.unpack_fields) {
+              CUDA_CHECK(cudaMemcpyAsync(Data(field), fused + offset, NumBytes(field),
+                                         cudaMemcpyDeviceToDevice, stream));
+              offset += NumBytes(field);
+            }
+          }, options.warmup, options.iters);
+        }
+        if (rank == 0) {
+          double algbw = c.bytes / raf_us / 1e3;
+          std::printf("%-15s %12ld %6d %10.2f %10.2f %10.2f %8.2f %8.2f %10.2f\n", op.c_str(),
+                      static_cast<long>(c.bytes), tuple_size, raf_us, nccl_us, raf_us - nccl_us,
+                      algbw, algbw * c.bus_factor, pack_us);
+          std::fflush(stdout);
+        }
+        buffers.clear();
+      }
+    }
+  }
+  CUDA_CHECK(cudaStreamDestroy(stream));
+  return 0;
+}
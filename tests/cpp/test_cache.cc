@@ -0,0 +1,185 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <raf/cache.h>
+
+using raf::op::HashKey;
+using raf::op::MetaCache;
+using raf::op::MetaPersistCache;
+using raf::op::PersistStore;
+
+TEST(MetaCache, Basic) {
+  MetaCache<int> cache;
+  ASSERT_FALSE(cache.Has("a"));
+  ASSERT_EQ(cache.Get("a"), nullptr);
+  cache.Set("a", 1);
+  cache.Set(std::vector<uint8_t>{'b'}, 2);
+  ASSERT_TRUE(cache.Has("a"));
+  ASSERT_EQ(*cache.Get("a"), 1);
+  ASSERT_EQ(*cache.Get("b"), 2);
+  // The pointer remains valid while other entries are added.
+  const int* a = cache.Get("a");
+  for (int i = 0; i < 100; ++i) {
+    cache.Set("key" + std::to_string(i), i);
+  }
+  ASSERT_EQ(cache.Get("a"), a);
+
+  size_t hits = 0, misses = 0;
+  auto metric = cache.GetShardMetric();
+  for (size_t i = 0; i < MetaCache<int>::kNumShards; ++i) {
+    hits += metric["Shard" + std::to_string(i) + "Hit"];
+    misses += metric["Shard" + std::to_string(i) + "Miss"];
+  }
+  ASSERT_EQ(hits, 4);
+  ASSERT_EQ(misses, 1);
+}
+
+TEST(MetaCache, Concurrent) {
+  MetaCache<int> cache;
+  constexpr int kNumThreads = 8;
+  constexpr int kNumKeys = 256;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&cache, t]() {
+      // Each thread inserts its own keys and reads the keys of all threads.
+      for (int i = 0; i < kNumKeys; ++i) {
+        cache.Set(std::to_string(t) + "_" + std::to_string(i), i);
+        for (int other = 0; other < kNumThreads; ++other) {
+          if (auto val = cache.Get(std::to_string(other) + "_" + std::to_string(i))) {
+            ASSERT_EQ(*val, i);
+          }
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (int t = 0; t < kNumThreads; ++t) {
+    for (int i = 0; i < kNumKeys; ++i) {
+      ASSERT_EQ(*cache.Get(std::to_string(t) + "_" + std::to_string(i)), i);
+    }
+  }
+}
+
+/*! \brief Save an entry of a single file with the given content. */
+bool SaveEntry(PersistStore* store, const std::string& key, const std::string& content) {
+  return store->Save(key, [&content](const std::string& dir) {
+    std::ofstream ofs(dir + "/value.txt");
+    ofs << content;
+    return true;
+  });
+}
+
+/*! \brief Load an entry of a single file, or return an empty string if not found. */
+std::string LoadEntry(PersistStore* store, const std::string& key) {
+  std::string content;
+  store->Load(key, [&content](const std::string& dir) {
+    std::ifstream ifs(dir + "/value.txt");
+    ifs >> content;
+  });
+  return content;
+}
+
+TEST(PersistStore, SaveAndLoad) {
+  char path[] = "/tmp/raf_test_cache.XXXXXX";
+  ASSERT_NE(mkdtemp(path), nullptr);
+  {
+    PersistStore store(path, 0);
+    ASSERT_EQ(LoadEntry(&store, "a"), "");
+    ASSERT_TRUE(SaveEntry(&store, "a", "value_a"));
+    ASSERT_TRUE(SaveEntry(&store, "b", "value_b"));
+    ASSERT_EQ(LoadEntry(&store, "a"), "value_a");
+  }
+  {
+    // Reopen the store from the index.
+    PersistStore store(path, 0);
+    store.Prefetch();
+    ASSERT_EQ(LoadEntry(&store, "a"), "value_a");
+    ASSERT_EQ(LoadEntry(&store, "b"), "value_b");
+  }
+  {
+    // Only the most recently used record fits in the capacity.
+    PersistStore store(path, 100);
+    ASSERT_TRUE(SaveEntry(&store, "c", "value_c"));
+    ASSERT_EQ(LoadEntry(&store, "a"), "");
+    ASSERT_EQ(LoadEntry(&store, "b"), "");
+    ASSERT_EQ(LoadEntry(&store, "c"), "value_c");
+  }
+  std::system((std::string("rm -rf ") + path).c_str());
+}
+
+/*! \brief A cache entry persisted as a single file. */
+struct TextEntry {
+  std::string value;
+
+  static TextEntry Load(const std::string& path) {
+    TextEntry entry;
+    std::ifstream ifs(path + "/value.txt");
+    ifs >> entry.value;
+    return entry;
+  }
+
+  bool Save(const std::string& path) {
+    std::ofstream ofs(path + "/value.txt");
+    ofs << value;
+    return true;
+  }
+};
+
+TEST(MetaPersistCache, GetOrCompute) {
+  MetaPersistCache<TextEntry> cache("test_get_or_compute");
+  std::atomic<int> num_computed{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([&cache, &num_computed]() {
+      const TextEntry* entry = cache.GetOrCompute("key", [&num_computed]() {
+        num_computed++;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        return TextEntry{"value"};
+      });
+      ASSERT_EQ(entry->value, "value");
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(num_computed, 1);
+}
+
+TEST(HashKey, Digest) {
+  // The digests are 16 bytes, which differ for the keys of all lengths around the block size.
+  std::vector<std::string> digests;
+  for (int len = 0; len < 40; ++len) {
+    HashKey key;
+    key << std::string(len, 'x');
+    std::string digest = key.Digest();
+    ASSERT_EQ(digest.size(), 16U);
+    ASSERT_EQ(digest, key.Digest());
+    for (const auto& other : digests) {
+      ASSERT_NE(digest, other);
+    }
+    digests.push_back(digest);
+  }
+  HashKey a, b;
+  a << int64_t(1) << int64_t(2);
+  b << int64_t(2) << int64_t(1);
+  ASSERT_NE(a.Digest(), b.Digest());
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
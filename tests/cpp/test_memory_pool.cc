@@ -5,6 +5,8 @@
 
 #include <gtest/gtest.h>
 
+#include <cstring>
+
 #include <raf/device.h>
 #include <raf/memory_pool.h>
 
@@ -13,6 +15,7 @@ using raf::DevType;
 using raf::kDefaultMemoryAlignment;
 using raf::memory_pool::Memory;
 using raf::memory_pool::MemoryPool;
+using raf::memory_pool::MemoryQuota;
 
 TEST(NoPool, CPU) {
   Device dev{DevType::kCPU(), 0};
@@ -44,7 +47,7 @@ TEST(PageUnitPool, CPU) {
   for (int memory : {11, 19, 2019, 1024124}) {
     for (int align : {16, (int)kDefaultMemoryAlignment, 512, 1024, 4096}) {
       std::shared_ptr<Memory> result = Memory::Alloc(dev, memory, align);
-      ASSERT_EQ(result.use_count(), 2);
+      ASSERT_EQ(result.use_count(), 1);
       int64_t address = (int64_t)result->data;
       ASSERT_EQ(address % align, 0);
     }
@@ -57,9 +60,177 @@ TEST(PageUnitPool, CPU) {
   auto used_size = pool_size.first * 1048576.0;
   auto abs_diff = (used_size > 4096) ? used_size - 4096 : 4096 - used_size;
   ASSERT_LE(abs_diff, 1);
+  void* data = result->data;
   result.reset();
   pool_size = Memory::GetPoolSize(dev);
   ASSERT_EQ(pool_size.first, 0);
+
+  // The released chunk is reused by the next request with the same size.
+  result = Memory::Alloc(dev, 4000, 64);
+  ASSERT_EQ(result->data, data);
+  result.reset();
+  Memory::RemovePool(dev);
+}
+
+TEST(BestFitPool, CPU) {
+  Device dev{DevType::kCPU(), 0};
+  Memory::InitPool(dev, "best_fit_pool");
+  {
+    std::shared_ptr<Memory> result = Memory::Alloc(dev, 0);
+    ASSERT_EQ(result.use_count(), 1);
+    ASSERT_EQ(result->data, nullptr);
+  }
+  for (int memory : {11, 19, 2019, 1024124, 4194304}) {
+    for (int align : {16, (int)kDefaultMemoryAlignment, 512, 1024, 4096}) {
+      std::shared_ptr<Memory> result = Memory::Alloc(dev, memory, align);
+      ASSERT_EQ(result.use_count(), 1);
+      int64_t address = (int64_t)result->data;
+      ASSERT_EQ(address % align, 0);
+    }
+  }
+  auto pool_size = Memory::GetPoolSize(dev);
+  ASSERT_EQ(pool_size.first, 0);  // No chunk is used.
+
+  // Freed blocks are coalesced, so a larger request reuses the same segment.
+  std::shared_ptr<Memory> a = Memory::Alloc(dev, 4096, 64);
+  std::shared_ptr<Memory> b = Memory::Alloc(dev, 4096, 64);
+  ASSERT_EQ((int64_t)b->data - (int64_t)a->data, 4096);
+  pool_size = Memory::GetPoolSize(dev);
+  auto used_size = pool_size.first * 1048576.0;
+  auto abs_diff = (used_size > 8192) ? used_size - 8192 : 8192 - used_size;
+  ASSERT_LE(abs_diff, 1);
+  void* a_data = a->data;
+  auto reserved = pool_size.second;
+  a.reset();
+  b.reset();
+  std::shared_ptr<Memory> c = Memory::Alloc(dev, 8192, 64);
+  ASSERT_EQ(c->data, a_data);
+  ASSERT_EQ(Memory::GetPoolSize(dev).second, reserved);
+  c.reset();
+  ASSERT_EQ(Memory::GetPoolSize(dev).first, 0);
+  Memory::RemovePool(dev);
+}
+
+TEST(BestFitPool, Compact) {
+  Device dev{DevType::kCPU(), 0};
+  Memory::InitPool(dev, "best_fit_pool");
+  // The freed segment is too small for the next step, so the pool grows beyond the peak usage.
+  Memory::Alloc(dev, 3 << 20).reset();
+  ASSERT_FALSE(Memory::StepBoundary(dev, 1.5, 2));
+  Memory::Alloc(dev, 5 << 20).reset();
+  ASSERT_EQ(Memory::GetPoolSize(dev).second, 10);
+  // The pool is compacted into one segment for the high-water mark.
+  ASSERT_TRUE(Memory::StepBoundary(dev, 1.5, 2));
+  ASSERT_EQ(Memory::GetPoolSize(dev).second, 6);
+  Memory::Alloc(dev, 5 << 20).reset();
+  Memory::Alloc(dev, 3 << 20).reset();
+  ASSERT_EQ(Memory::GetPoolSize(dev).second, 6);
+  ASSERT_FALSE(Memory::StepBoundary(dev, 1.5, 2));
+  Memory::RemovePool(dev);
+}
+
+TEST(MemoryQuota, CPU) {
+  Device dev{DevType::kCPU(), 0};
+  Memory::InitPool(dev, "page_unit_pool");
+  auto fa = MemoryQuota::Get(dev, "model_a");
+  auto fb = MemoryQuota::Get(dev, "model_b");
+  ASSERT_EQ(MemoryQuota::Get(dev, "model_a"), fa);
+  fa->SetLimit(8192);
+  fb->SetLimit(8192);
+  MemoryQuota::SetSharedReserve(dev, 4096);
+  auto alloc = [&](int64_t nbytes) { return [=]() { return Memory::Alloc(dev, nbytes); }; };
+  // A tenant borrows the reserve beyond its quota, which is then unavailable to the others.
+  auto a1 = fa->Alloc(8192, alloc(8192));
+  auto a2 = fa->Alloc(4096, alloc(4096));
+  ASSERT_EQ(fa->GetUsage(), std::pair<int64_t, int64_t>(12288, 4096));
+  auto b1 = fb->Alloc(8192, alloc(8192));
+  ASSERT_THROW(fb->Alloc(4096, alloc(4096)), dmlc::Error);
+  ASSERT_EQ(fb->GetUsage(), std::pair<int64_t, int64_t>(8192, 0));
+  // The borrowed memory is returned first.
+  a1.reset();
+  ASSERT_EQ(fa->GetUsage(), std::pair<int64_t, int64_t>(4096, 0));
+  auto b2 = fb->Alloc(4096, alloc(4096));
+  ASSERT_EQ(fb->GetUsage(), std::pair<int64_t, int64_t>(12288, 4096));
+  a2.reset();
+  b1.reset();
+  b2.reset();
+  ASSERT_EQ(fb->GetUsage(), std::pair<int64_t, int64_t>(0, 0));
+  MemoryQuota::SetSharedReserve(dev, 0);
+  Memory::RemovePool(dev);
+}
+
+TEST(StreamCachingPool, CPU) {
+  Device dev{DevType::kCPU(), 0};
+  Memory::InitPool(dev, "stream_caching_pool");
+  ASSERT_TRUE(Memory::GetPool(dev)->IsStreamOrdered());
+  {
+    std::shared_ptr<Memory> result = Memory::Alloc(dev, 0);
+    ASSERT_EQ(result.use_count(), 1);
+    ASSERT_EQ(result->data, nullptr);
+  }
+  for (int memory : {11, 19, 2019, 1024124}) {
+    for (int align : {16, (int)kDefaultMemoryAlignment, 512}) {
+      std::shared_ptr<Memory> result = Memory::Alloc(dev, memory, align);
+      ASSERT_EQ(result.use_count(), 1);
+      int64_t address = (int64_t)result->data;
+      ASSERT_EQ(address % align, 0);
+    }
+  }
+  auto pool_size = Memory::GetPoolSize(dev);
+  ASSERT_EQ(pool_size.first, 0);  // No chunk is used.
+
+  // A freed block is reused by a smaller request on the same stream.
+  std::shared_ptr<Memory> result = Memory::Alloc(dev, 4096, 64);
+  void* data = result->data;
+  result.reset();
+  result = Memory::Alloc(dev, 3000, 64);
+  ASSERT_EQ(result->data, data);
+  pool_size = Memory::GetPoolSize(dev);
+  auto used_size = pool_size.first * 1048576.0;
+  auto abs_diff = (used_size > 4096) ? used_size - 4096 : 4096 - used_size;
+  ASSERT_LE(abs_diff, 1);
+  result.reset();
+  ASSERT_EQ(Memory::GetPoolSize(dev).first, 0);
+  Memory::RemovePool(dev);
+}
+
+TEST(HugePagePool, CPU) {
+  Device dev{DevType::kCPU(), 0};
+  Memory::InitPool(dev, "huge_page_pool");
+  {
+    std::shared_ptr<Memory> result = Memory::Alloc(dev, 0);
+    ASSERT_EQ(result.use_count(), 1);
+    ASSERT_EQ(result->data, nullptr);
+  }
+  // The small allocations are served by the page unit pool, and the large ones by huge pages.
+  for (int memory : {11, 2019, 1024124, 2097152, 5000000}) {
+    for (int align : {16, (int)kDefaultMemoryAlignment, 4096}) {
+      std::shared_ptr<Memory> result = Memory::Alloc(dev, memory, align);
+      ASSERT_EQ(result.use_count(), 1);
+      int64_t address = (int64_t)result->data;
+      ASSERT_EQ(address % align, 0);
+    }
+  }
+  auto pool_size = Memory::GetPoolSize(dev);
+  ASSERT_EQ(pool_size.first, 0);  // No chunk is used.
+
+  // The huge page regions are aligned to 2MB and reused by the requests of the same size.
+  int64_t huge_page = 2 << 20;
+  ASSERT_EQ(Memory::GetAllocBytes(dev, 3000000), 2 * huge_page);
+  std::shared_ptr<Memory> result = Memory::Alloc(dev, 3000000, 64);
+  ASSERT_EQ((int64_t)result->data % huge_page, 0);
+  memset(result->data, 0, 3000000);
+  ASSERT_EQ(Memory::GetPoolSize(dev).first, 4);
+  void* data = result->data;
+  result.reset();
+  result = Memory::Alloc(dev, 2 * huge_page, 64);
+  ASSERT_EQ(result->data, data);
+  result.reset();
+  ASSERT_EQ(Memory::GetPoolSize(dev).first, 0);
+
+  // The cached regions are returned to the system.
+  ASSERT_GE(Memory::GetPool(dev)->FreeUnused(), 2 * huge_page);
+  ASSERT_EQ(Memory::GetPoolSize(dev).second, 0);
   Memory::RemovePool(dev);
 }
 
@@ -0,0 +1,82 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <raf/rendezvous.h>
+
+using raf::distributed::communicator::FileStore;
+using raf::distributed::communicator::Store;
+using raf::distributed::communicator::TCPStore;
+
+constexpr std::chrono::milliseconds kTimeout(std::chrono::seconds(10));
+constexpr int kPort = 29517;
+
+/*!
+ * \brief Each rank makes its own store, and all ranks gather their ranks. The stores are kept
+ * until all ranks finish, as the server of TCPStore lives in the store of rank 0.
+ */
+template <typename FMake>
+void TestAllGather(FMake make_store, int size) {
+  std::vector<std::shared_ptr<Store>> stores(size);
+  std::vector<std::vector<std::string>> results(size);
+  std::vector<std::thread> threads;
+  for (int rank = 0; rank < size; ++rank) {
+    threads.emplace_back([&, rank]() {
+      stores[rank] = make_store(rank);
+      results[rank] = stores[rank]->AllGather("test", rank, size, std::to_string(rank));
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (int rank = 0; rank < size; ++rank) {
+    ASSERT_EQ(results[rank].size(), size);
+    for (int i = 0; i < size; ++i) {
+      ASSERT_EQ(results[rank][i], std::to_string(i));
+    }
+  }
+}
+
+TEST(FileStore, Basic) {
+  char path[] = "/tmp/raf_test_rendezvous.XXXXXX";
+  ASSERT_NE(mkdtemp(path), nullptr);
+  FileStore store(path, kTimeout);
+  store.Set("a/b", std::string("x\0y", 3));
+  ASSERT_EQ(store.Get("a/b"), std::string("x\0y", 3));
+
+  TestAllGather([&path](int rank) { return std::make_shared<FileStore>(path, kTimeout); }, 8);
+}
+
+TEST(TCPStore, Basic) {
+  TestAllGather(
+      [](int rank) { return std::make_shared<TCPStore>("127.0.0.1", kPort, rank == 0, kTimeout); },
+      8);
+}
+
+TEST(TCPStore, BlockingGet) {
+  auto server = std::make_shared<TCPStore>("127.0.0.1", kPort + 1, true, kTimeout);
+  std::string value;
+  std::thread getter([&value]() {
+    TCPStore client("127.0.0.1", kPort + 1, false, kTimeout);
+    value = client.Get("key");
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  server->Set("key", "value");
+  getter.join();
+  ASSERT_EQ(value, "value");
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
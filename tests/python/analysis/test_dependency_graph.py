@@ -92,5 +92,43 @@ def test_prune_redundant_edges():
     assert pruned_num_edges == 3
 
 
+def test_prune_redundant_edges_long_paths():
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            y = raf.atan(x)  # atan 0
+            z = raf.atan(y)  # atan 1
+            w = raf.atan(z)  # atan 2
+            p = raf.atan(x)  # atan 3
+            tup = [y, z, p, w]  # tup
+            return raf.concatenate(tup)  # concat
+
+    model = Model()
+    input_shape = [2, 2]
+    x, _ = randn(input_shape)
+    mod = model._internal(x).mod
+
+    mod = ToGraphNormalForm()(mod)
+
+    expr = mod["main"].body
+    graph = GetDependencyGraphNodesEdges(expr, True, False)
+    assert len(graph["edges"]) == 7
+
+    pruned_graph = GetDependencyGraphNodesEdges(expr, True, True)
+    # Edges:
+    # atan 0 -> atan 1
+    # atan 1 -> atan 2
+    # atan 2 -> tup
+    # atan 3 -> tup
+    # tup -> concat
+    # Pruned edges, which are implied by the chain of atan 0, 1 and 2:
+    # atan 0 -> tup
+    # atan 1 -> tup
+    assert len(pruned_graph["edges"]) == 5
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
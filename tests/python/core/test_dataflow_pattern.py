@@ -4,6 +4,12 @@
 # pylint: disable=invalid-name, protected-access
 import pytest
 import raf
+from raf._core.ir_ext import extended_var
+from raf.ir import dataflow_pattern as dfp
+
+import tvm
+from tvm import relay
+from tvm.relay.dataflow_pattern import _DFPatternCallback
 
 
 def test_match_constant():
@@ -20,5 +26,31 @@ def test_no_match_constant():
     assert not raf.ir.dataflow_pattern.match(pat, c)
 
 
+def test_rewrite_multiple_callbacks():
+    add_op = raf._ffi.op.GetOp("raf.op.add")
+    relu_op = raf._ffi.op.GetOp("raf.op.relu")
+    null = raf.ir.const(None)
+    x = extended_var("x", shape=(2, 3), dtype="float32")
+    y = extended_var("y", shape=(2, 3), dtype="float32")
+    expr = relay.Call(relu_op, [relay.Call(add_op, [x, y, null, null])])
+
+    def to_relu(pre, post, node_map):  # pylint: disable=unused-argument
+        return relay.Call(relu_op, [post.args[0]])
+
+    def drop_add(pre, post, node_map):  # pylint: disable=unused-argument
+        return post.args[0]
+
+    a, b = dfp.wildcard(), dfp.wildcard()
+    callbacks = [
+        # The root op of this pattern is absent, so it is skipped without matching.
+        _DFPatternCallback(dfp.is_op("raf.op.multiply")(a, b), to_relu, False, False),
+        _DFPatternCallback(
+            dfp.is_op("raf.op.add")(a, b, dfp.wildcard(), dfp.wildcard()), drop_add, False, False
+        ),
+    ]
+    ret = dfp.rewrite(callbacks, expr, tvm.IRModule())
+    assert tvm.ir.structural_equal(ret, relay.Call(relu_op, [x])), raf.ir.AsText(ret)
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
@@ -0,0 +1,40 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+import numpy as np
+import pytest
+
+import raf
+from raf.testing import check, get_testable_devices
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_cached_op_env(device):
+    # The OpEnvs are reused by the calls of the same op and signature, which must not be shared
+    # by the calls of different shapes or attributes.
+    for shape in [(3, 4), (3, 4), (5, 2)]:
+        n_x = np.random.randn(*shape).astype("float32")
+        n_y = np.random.randn(*shape).astype("float32")
+        m_x = raf.array(n_x, device=device)
+        m_y = raf.array(n_y, device=device)
+        for _ in range(3):
+            check(raf.add(m_x, m_y), n_x + n_y)
+        for axis in [0, 1, 0]:
+            check(raf.sum(m_x, axis=axis), np.sum(n_x, axis=axis), rtol=1e-5, atol=1e-5)
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_async_chain(device):
+    # The ops are launched without synchronization, so the results are only read at the end.
+    n_x = (np.random.randn(64, 64) * 0.1).astype("float32")
+    m_x = raf.array(n_x, device=device)
+    m_y = m_x
+    n_y = n_x
+    for _ in range(10):
+        m_y = raf.tanh(raf.matmul(m_y, m_x))
+        n_y = np.tanh(np.matmul(n_y, n_x))
+    check(m_y, n_y, rtol=1e-4, atol=1e-4)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
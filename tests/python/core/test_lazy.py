@@ -0,0 +1,52 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+import numpy as np
+import pytest
+
+import raf
+from raf._ffi.binding import IsLazyPending
+from raf.testing import check, get_testable_devices, randn
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_lazy_chain(device):
+    m_x, n_x = randn((4, 8), device=device)
+    m_y, n_y = randn((4, 8), device=device)
+    # The same segment runs in each iteration, which is compiled once.
+    for _ in range(3):
+        with raf.lazy():
+            m_z = raf.multiply(raf.relu(raf.add(m_x, m_y)), m_x)
+            assert IsLazyPending(m_z._ndarray__handle)  # pylint: disable=protected-access
+            check(m_z, np.maximum(n_x + n_y, 0) * n_x)
+            assert not IsLazyPending(m_z._ndarray__handle)  # pylint: disable=protected-access
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_lazy_tuple(device):
+    m_x, n_x = randn((4, 6), device=device)
+    with raf.lazy():
+        m_a, m_b = raf.split(raf.tanh(m_x), 2, axis=1)
+        m_c = raf.add(m_a, m_b)
+    n_a, n_b = np.split(np.tanh(n_x), 2, axis=1)
+    check(m_c, n_a + n_b, rtol=1e-5, atol=1e-5)
+    check(m_a, n_a, rtol=1e-5, atol=1e-5)
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_lazy_requires_grad(device):
+    # The ops that require gradients run eagerly, after the pending inputs are computed.
+    m_x, n_x = randn((3, 3), device=device)
+    m_w, n_w = randn((3, 3), device=device, requires_grad=True)
+    with raf.lazy():
+        m_y = raf.relu(m_x)
+        m_z = raf.matmul(m_y, m_w)
+        assert not IsLazyPending(m_y._ndarray__handle)  # pylint: disable=protected-access
+        m_z.backward(raf.array(np.ones((3, 3), dtype="float32"), device=device))
+    n_y = np.maximum(n_x, 0)
+    check(m_z, np.matmul(n_y, n_w), rtol=1e-5, atol=1e-5)
+    check(m_w.grad, np.matmul(n_y.T, np.ones((3, 3))), rtol=1e-5, atol=1e-5)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -2,7 +2,10 @@
 # SPDX-License-Identifier: Apache-2.0
 
 import numpy as np
+import pytest
 
+import raf
+from raf.testing import get_testable_devices
 from raf._core.value import BoolValue, FloatValue, IntValue, StringValue, TensorValue, TupleValue
 
 
@@ -114,16 +117,38 @@ def test_from_numpy():
     assert str(a.dtype) == str(b.dtype)
 
 
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_dlpack(device):
+    import torch  # pylint: disable=import-outside-toplevel
+
+    a = np.random.randn(3, 4).astype("float32")
+    b = raf.array(a, device=device)
+    if device == "cuda":
+        # The consumer stream waits for the tensor instead of synchronizing the device.
+        with torch.cuda.stream(torch.cuda.Stream()):
+            c = torch.utils.dlpack.from_dlpack(b) * 2
+        torch.cuda.synchronize()
+    else:
+        c = torch.utils.dlpack.from_dlpack(b) * 2
+    assert c.device.type == device
+    np.testing.assert_allclose(c.cpu().numpy(), a * 2)
+    # The export is zero-copy.
+    value = TensorValue.from_numpy(a)
+    d = torch.utils.dlpack.from_dlpack(value)
+    assert d.data_ptr() == value.data
+    np.testing.assert_allclose(d.numpy(), a)
+
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_numpy_async(device):
+    a = np.random.randn(3, 4).astype("float32")
+    b = raf.array(a, device=device)
+    lazy = raf.multiply(b, b).numpy_async()
+    np.testing.assert_allclose(lazy.numpy(), a * a, rtol=1e-5)
+    assert lazy.ready()
+    loss = raf.array(np.array(1.5, dtype="float32"), device=device).numpy_async()
+    assert float(loss) == 1.5
+
 if __name__ == "__main__":
-    test_int_value()
-    test_float_value()
-    test_bool_value()
-    test_string_value()
-    test_nested()
-    test_assemble_0d()
-    test_assemble_1d()
-    test_assemble_2d()
-    test_assemble_3d()
-    test_assemble_null_1d()
-    test_assemble_null_3d()
-    test_from_numpy()
+    pytest.main([__file__])
@@ -1,10 +1,12 @@
 # Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
 # SPDX-License-Identifier: Apache-2.0
 
+import threading
+
 import pytest
 import numpy as np
 import raf
-from raf._core.executor import VMExecutor
+from raf._core.executor import BatchingServer, BucketedVMExecutor, VMExecutor
 from raf.testing import check, compile_vm_model, run_vm_model, get_arr_addr, randn
 from raf.testing import get_testable_devices
 
@@ -42,6 +44,520 @@ def test_vm(device, shape):
     np.testing.assert_allclose(m_z, ref_z, rtol=1e-5, atol=1e-5)
 
 
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_concurrent(device):
+    # pylint: disable=protected-access
+    class Model(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):  # pylint: disable=no-self-use
+            y = raf.add(x, x)
+            z = raf.add(x, y)
+            return z
+
+    model = Model()
+    model.infer_mode()
+    shape = [4, 4]
+    m_x, _ = randn(shape, device=device)
+    mod = model._internal(m_x).mod
+    executable = VMExecutor(mod, device).executable
+    vm = raf._core.vm.VirtualMachine(executable, raf.Device(device), concurrent=True)
+
+    inputs = [randn(shape, device=device)[0] for _ in range(8)]
+    outputs = [None] * len(inputs)
+
+    def run(idx):
+        for _ in range(10):
+            outputs[idx] = vm.run(inputs[idx]).numpy()
+
+    threads = [threading.Thread(target=run, args=(i,)) for i in range(len(inputs))]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    for m_x, m_z in zip(inputs, outputs):
+        np.testing.assert_allclose(m_z, model(m_x).numpy(), rtol=1e-5, atol=1e-5)
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+@pytest.mark.parametrize("concurrent", [False, True])
+def test_run_async(device, concurrent):
+    # pylint: disable=protected-access
+    class Model(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):  # pylint: disable=no-self-use
+            y = raf.add(x, x)
+            return raf.multiply(x, y)
+
+    model = Model()
+    model.infer_mode()
+    shape = [4, 4]
+    m_x, _ = randn(shape, device=device)
+    mod = model._internal(m_x).mod
+    executable = VMExecutor(mod, device).executable
+    vm = raf._core.vm.VirtualMachine(executable, raf.Device(device), concurrent=concurrent)
+
+    # A single thread keeps all the runs in flight.
+    inputs = [randn(shape, device=device)[0] for _ in range(4)]
+    futures = [vm.run_async(m_x) for m_x in inputs]
+    for m_x, future in zip(inputs, futures):
+        m_z = future.result().numpy()
+        assert future.ready()
+        np.testing.assert_allclose(m_z, model(m_x).numpy(), rtol=1e-5, atol=1e-5)
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_prewarm(device):
+    # pylint: disable=protected-access
+    class Model(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):  # pylint: disable=no-self-use
+            y = raf.relu(x)
+            z = raf.add(x, y)
+            return raf.matmul(z, y)
+
+    model = Model()
+    model.infer_mode()
+    shape = [4, 4]
+    m_x, _ = randn(shape, device=device)
+    mod = model._internal(m_x).mod
+    executable = VMExecutor(mod, device).executable
+    vm = raf._core.vm.VirtualMachine(executable, raf.Device(device))
+    vm.prewarm(m_x, num_threads=2)
+    m_z = vm.run(m_x).numpy()
+    np.testing.assert_allclose(m_z, model(m_x).numpy(), rtol=1e-5, atol=1e-5)
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_background_jit(device):
+    # pylint: disable=protected-access
+    class Model(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):  # pylint: disable=no-self-use
+            y = raf.relu(x)
+            z = raf.add(x, y)
+            return raf.matmul(z, y)
+
+    model = Model()
+    model.infer_mode()
+    m_x, _ = randn([4, 4], device=device)
+    ref = model(m_x).numpy()
+    mod = model._internal(m_x).mod
+    executable = VMExecutor(mod, device).executable
+    vm = raf._core.vm.VirtualMachine(executable, raf.Device(device), background_jit=2)
+    # The first run is served by the fallback kernels if there are any.
+    m_z = vm.run(m_x).numpy()
+    np.testing.assert_allclose(m_z, ref, rtol=1e-5, atol=1e-5)
+    vm.sync_background_jit()
+    # The JIT compiled kernels are swapped in by the next run.
+    m_z = vm.run(m_x).numpy()
+    np.testing.assert_allclose(m_z, ref, rtol=1e-5, atol=1e-5)
+    stats = vm.get_stats()
+    assert stats["num_background_jits"] <= stats["num_fallback_op_envs"]
+    assert stats["op_env_cache_misses"] + stats["op_env_cache_hits"] > 0
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_priority(device):
+    # pylint: disable=protected-access
+    class Model(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):  # pylint: disable=no-self-use
+            y = raf.relu(x)
+            return raf.matmul(x, y)
+
+    model = Model()
+    model.infer_mode()
+    m_x, _ = randn([16, 16], device=device)
+    ref = model(m_x).numpy()
+    mod = model._internal(m_x).mod
+    executable = VMExecutor(mod, device).executable
+    vms = {
+        priority: raf._core.vm.VirtualMachine(
+            executable, raf.Device(device), concurrent=True, priority=priority
+        )
+        for priority in ["high", "low"]
+    }
+    with pytest.raises(ValueError):
+        vms["low"].set_priority("urgent")
+
+    def worker(priority, results):
+        vm = vms[priority]
+        for _ in range(10):
+            results.append(vm.run(m_x).numpy())
+
+    results = {"high": [], "low": []}
+    threads = [threading.Thread(target=worker, args=(p, results[p])) for p in results]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    for outs in results.values():
+        assert len(outs) == 10
+        for out in outs:
+            np.testing.assert_allclose(out, ref, rtol=1e-5, atol=1e-5)
+    # Only the low-priority runs yield.
+    assert vms["high"].get_stats()["num_priority_yields"] == 0
+    assert vms["low"].get_stats()["num_runs"] == 10
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_stats(device):
+    # pylint: disable=protected-access
+    class Model(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):  # pylint: disable=no-self-use
+            y = raf.relu(x)
+            return raf.matmul(x, y)
+
+    model = Model()
+    model.infer_mode()
+    m_x, _ = randn([4, 4], device=device)
+    mod = model._internal(m_x).mod
+    executable = VMExecutor(mod, device).executable
+    vm = raf._core.vm.VirtualMachine(executable, raf.Device(device))
+    vm.run(m_x)
+    stats = vm.get_stats()
+    assert stats["num_runs"] == 1
+    assert stats["op_env_cache_hits"] == 0 and stats["op_env_cache_misses"] > 0
+    assert stats["instructions"]["InvokeJit"] == stats["op_env_cache_misses"]
+    assert stats["instructions"]["Ret"] >= 1
+    assert stats["num_allocs"] > 0 and stats["alloc_bytes"] > 0
+
+    # The OpEnvs are cached, so the second run only hits the cache.
+    vm.run(m_x)
+    new_stats = vm.get_stats()
+    assert new_stats["num_runs"] == 2
+    assert new_stats["op_env_cache_hits"] == stats["op_env_cache_misses"]
+    assert new_stats["op_env_cache_misses"] == stats["op_env_cache_misses"]
+    assert new_stats["instructions"]["InvokeJit"] == 2 * stats["instructions"]["InvokeJit"]
+
+    vm.reset_stats()
+    stats = vm.get_stats()
+    assert stats["num_runs"] == 0 and not stats["instructions"]
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_deduplicate_layers(device):
+    # pylint: disable=protected-access
+    class Model(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):  # pylint: disable=no-self-use
+            for _ in range(4):
+                x = raf.tanh(raf.add(raf.relu(x), x))
+            return x
+
+    model = Model()
+    model.infer_mode()
+    m_x, _ = randn([4, 4], device=device)
+    ref = run_vm_model(model, device, [m_x]).numpy()
+
+    mod = model._internal(m_x).mod
+    config = {"raf.vm.optimize.deduplicate": True}
+    with raf.ir.PassContext(opt_level=3, config=config):
+        opt_mod, _ = raf._core.vm.VMCompiler().optimize(mod, device)
+        executable = VMExecutor(mod, device).executable
+    # The identical layers are lifted to the same global function.
+    assert 1 < len(opt_mod.functions) < 5
+    vm = raf._core.vm.VirtualMachine(executable, raf.Device(device))
+    check(vm.run(m_x), ref, rtol=1e-5, atol=1e-5)
+
+    # The OpEnvs of the shared layer are created once and reused by the other call sites.
+    stats = vm.get_stats()
+    assert stats["op_env_cache_hits"] > 0
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_cache_shape_free_prefix(device):
+    # pylint: disable=protected-access
+    class Model(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):  # pylint: disable=no-self-use
+            return raf.tanh(raf.add(raf.relu(x), x))
+
+    model = Model()
+    model.infer_mode()
+    config = {"raf.vm.optimize.cache_shape_free_prefix": True}
+    # The second and third shapes reuse the output of the shape-independent passes of the first.
+    for shape in [[4, 4], [8, 3], [4, 4]]:
+        m_x, _ = randn(shape, device=device)
+        ref = run_vm_model(model, device, [m_x]).numpy()
+        with raf.ir.PassContext(config=config):
+            executor = VMExecutor(model._internal(m_x).mod, device)
+        out = executor.vm.run(m_x).numpy()
+        assert out.shape == tuple(shape)
+        check(out, ref, rtol=1e-5, atol=1e-5)
+
+
+
+def test_tail_call_loop(device, inline_calls):
+    # pylint: disable=import-outside-toplevel, too-many-locals
+    import tvm
+    from tvm import relay
+    from raf._ffi.pass_ import FromRelay
+    from raf.ir import ScopeBuilder
+
+    shape = (1, 16)
+    ti32 = relay.scalar_type("int32")
+    loop = relay.var("loop")
+    y = relay.var("y", shape=shape, dtype="float32")
+    counter = relay.var("counter", ti32)
+    x = relay.var("x", shape=shape, dtype="float32")
+    sb = ScopeBuilder()
+    with sb.if_scope(relay.equal(counter, relay.const(5, ti32))):
+        sb.ret(x)
+    with sb.else_scope():
+        # The recursion is a tail call, which jumps back to the entry of the loop.
+        out = relay.add(relay.tanh(x), relay.tanh(y))
+        sb.ret(loop(relay.add(counter, relay.const(1, ti32)), out))
+    func = relay.Function([counter, x], sb.get())
+    body = relay.Call(relay.Let(loop, func, loop), [relay.const(0, ti32), y])
+    tvm_mod = tvm.IRModule()
+    tvm_mod["main"] = relay.Function([y], body)
+    mod = FromRelay()(relay.transform.InferType()(tvm_mod))
+
+    m_y, n_y = randn(shape, device=device)
+    n_x = n_y
+    for _ in range(5):
+        n_x = np.tanh(n_x) + np.tanh(n_y)
+    with raf.ir.PassContext(config={"raf.vm.optimize.inline_calls": inline_calls}):
+        executor = VMExecutor(mod, device)
+    check(executor.vm.run(m_y), n_x, rtol=1e-5, atol=1e-5)
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+@pytest.mark.parametrize("predicate_if", [False, True])
+def test_predicate_if(device, predicate_if):
+    # pylint: disable=import-outside-toplevel
+    import tvm
+    from tvm import relay
+    from raf._ffi.pass_ import FromRelay
+    from raf.ir import ScopeBuilder
+
+    shape = (1, 16)
+    x = relay.var("x", shape=shape, dtype="float32")
+    y = relay.var("y", shape=shape, dtype="float32")
+    sb = ScopeBuilder()
+    cond = relay.greater(relay.sum(x), relay.sum(y))
+    with sb.if_scope(cond):
+        sb.ret(relay.tanh(x))
+    with sb.else_scope():
+        sb.ret(relay.sigmoid(y))
+    tvm_mod = tvm.IRModule()
+    tvm_mod["main"] = relay.Function([x, y], sb.get())
+    mod = FromRelay()(relay.transform.InferType()(tvm_mod))
+
+    with raf.ir.PassContext(config={"raf.vm.optimize.predicate_if": predicate_if}):
+        executor = VMExecutor(mod, device)
+    m_x, n_x = randn(shape, device=device)
+    m_y, n_y = randn(shape, device=device)
+    for a, b, n_a, n_b in [(m_x, m_y, n_x, n_y), (m_y, m_x, n_y, n_x)]:
+        expected = np.tanh(n_a) if n_a.sum() > n_b.sum() else 1 / (1 + np.exp(-n_b))
+        check(executor.vm.run(a, b), expected, rtol=1e-5, atol=1e-5)
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_release_cached_memory(device):
+    # pylint: disable=protected-access
+    class Model(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):  # pylint: disable=no-self-use
+            return raf.relu(raf.add(x, x))
+
+    model = Model()
+    m_x, _ = randn((32, 32), device=device)
+    with raf.ir.PassContext(config={"raf.memory_budget": 1 << 30}):
+        executor = VMExecutor(model._internal(m_x).mod, device)
+    ref_y = model(m_x).numpy()
+    check(executor.run_with_memory_fallback(m_x), ref_y)
+
+    # The spare pools of the finished runs are released, and the next run allocates again.
+    dev = raf.Device(device)
+    assert raf._ffi.memory_pool.ReleaseCachedMemory(dev) >= 0
+    _, allocated = raf._ffi.memory_pool.GetPoolSize(dev)
+    assert allocated.value >= 0
+    check(executor.run_with_memory_fallback(m_x), ref_y)
+
+    # The recompilation tightens the budget and keeps the results.
+    executor._recompile_with_budget(0.5)
+    assert int(executor._pass_ctx.config["raf.memory_budget"]) == 1 << 29
+    check(executor.vm.run(m_x), ref_y)
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_allocate_registers(device):
+    # pylint: disable=protected-access
+    class Model(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):  # pylint: disable=no-self-use
+            for _ in range(8):
+                x = raf.matmul(raf.tanh(x), x)
+            return x
+
+    def get_reg_file_size(bytecode):
+        line = [line for line in bytecode.splitlines() if "reg file size" in line][0]
+        return int(line.split("=")[1])
+
+    model = Model()
+    model.infer_mode()
+    m_x, _ = randn([4, 4], device=device)
+    ref = model(m_x)
+    mod = model._internal(m_x).mod
+    sizes = []
+    for allocate in [False, True]:
+        with raf.ir.PassContext(config={"raf.vm.optimize.allocate_registers": allocate}):
+            executor = VMExecutor(mod, device)
+        sizes.append(get_reg_file_size(executor.executable.bytecode))
+        check(executor.vm.run(m_x), ref, rtol=1e-4, atol=1e-4)
+    # The registers of the dead intermediate tensors are reused.
+    assert sizes[1] < sizes[0]
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_fuse_instructions(device):
+    # pylint: disable=protected-access
+    class Model(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):  # pylint: disable=no-self-use
+            y = raf.relu(x)
+            return raf.matmul(x, y)
+
+    model = Model()
+    model.infer_mode()
+    m_x, _ = randn([4, 4], device=device)
+    mod = model._internal(m_x).mod
+    stats = []
+    for fuse in [False, True]:
+        with raf.ir.PassContext(config={"raf.vm.optimize.fuse_instructions": fuse}):
+            executable = VMExecutor(mod, device).executable
+        vm = raf._core.vm.VirtualMachine(executable, raf.Device(device))
+        check(vm.run(m_x), model(m_x), rtol=1e-5, atol=1e-5)
+        stats.append(vm.get_stats()["instructions"])
+    assert "AllocOwnedTensor" not in stats[0]
+    if "AllocOwnedTensor" in stats[1]:
+        # Each fused allocation replaces a LoadConst, an AllocStorage and an AllocTensor.
+        num_fused = int(stats[1]["AllocOwnedTensor"])
+        num_instrs = [sum(int(count) for count in stat.values()) for stat in stats]
+        assert num_instrs[1] == num_instrs[0] - 2 * num_fused
+
+
+@pytest.mark.parametrize("policy", ["wavefront", "asap"])
+def test_cpu_inter_op_parallel(policy):
+    class Model(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):  # pylint: disable=no-self-use
+            # Independent branches that are scheduled to different streams.
+            a = raf.matmul(raf.relu(x), x)
+            b = raf.matmul(raf.tanh(x), x)
+            c = raf.matmul(raf.sigmoid(x), x)
+            return raf.add(raf.add(a, b), c)
+
+    model = Model()
+    model.infer_mode()
+    m_x, _ = randn([64, 64], device="cpu")
+    ref = run_vm_model(model, "cpu", [m_x], stream_schedule_policy="sequential")
+    for _ in range(3):
+        out = run_vm_model(model, "cpu", [m_x], stream_schedule_policy=policy)
+        check(out, ref, rtol=1e-4, atol=1e-4)
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_bucketed_executor(device):
+    class Model(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, mask):  # pylint: disable=no-self-use
+            return raf.multiply(raf.tanh(x), raf.expand_dims(mask, axis=-1))
+
+    model = Model()
+    model.infer_mode()
+    sample = np.random.randn(2, 1, 4).astype("float32")
+    executor = BucketedVMExecutor(
+        model, device, [8, 4], [sample], axis=1, with_mask=True, out_axis=1
+    )
+    assert executor.buckets == [4, 8]
+    for length in [1, 3, 4, 7]:
+        n_x = np.random.randn(2, length, 4).astype("float32")
+        check(executor(n_x), np.tanh(n_x), rtol=1e-5, atol=1e-5)
+    with pytest.raises(ValueError):
+        executor(np.random.randn(2, 9, 4).astype("float32"))
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_batching_server(device):
+    class Model(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            self.w, _ = randn([4, 3], device=device)
+
+        @raf.model.trace
+        def forward(self, x):
+            return raf.matmul(raf.tanh(x), self.w)
+
+    model = Model()
+    model.infer_mode()
+    sample = np.random.randn(1, 4).astype("float32")
+    server = BatchingServer(model, device, [2, 4], [sample], timeout_us=2000)
+    requests = [np.random.randn(rows, 4).astype("float32") for rows in [1, 2, 1, 3, 1]]
+    futures = [server.submit(n_x) for n_x in requests]
+    n_w = model.w.numpy()
+    for n_x, future in zip(requests, futures):
+        n_y = future.result().numpy()
+        check(n_y, np.matmul(np.tanh(n_x), n_w), rtol=1e-5, atol=1e-5)
+    with pytest.raises(Exception):
+        server.submit(np.random.randn(5, 4).astype("float32"))
+
+
 @pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
 @pytest.mark.parametrize("shape", [[3, 3], [4, 4]])
 def test_cuda_graph(shape):
@@ -77,6 +593,124 @@ def test_cuda_graph(shape):
     assert executable.globals[0] == "main"
 
 
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+def test_prefetch():
+    # pylint: disable=protected-access
+    class Model(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):  # pylint: disable=no-self-use
+            return raf.add(raf.relu(x), x)
+
+    model = Model()
+    model.infer_mode()
+    batches = [randn((16, 16), device="cpu")[0] for _ in range(4)]
+    mod = model._internal(batches[0]).mod
+    vm = VMExecutor(mod, "cuda").vm
+    # Copy the next batch while the current one is running.
+    vm.prefetch(batches[0])
+    for i, m_x in enumerate(batches):
+        if i + 1 < len(batches):
+            vm.prefetch(batches[i + 1])
+        m_y = vm.run(m_x)
+        check(m_y, model(m_x), rtol=1e-5, atol=1e-5)
+    # The inputs that are not prefetched are copied as usual.
+    m_y = vm.run(batches[0])
+    check(m_y, model(batches[0]), rtol=1e-5, atol=1e-5)
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_bind_params(device):
+    # pylint: disable=protected-access
+    class Model(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, w, b):  # pylint: disable=no-self-use
+            return raf.add(raf.matmul(x, w), b)
+
+    model = Model()
+    model.infer_mode()
+    shape = (4, 4)
+    m_w, _ = randn(shape, device="cpu")
+    m_b, _ = randn(shape, device="cpu")
+    batches = [randn(shape, device=device)[0] for _ in range(3)]
+    mod = model._internal(batches[0], m_w, m_b).mod
+    executor = VMExecutor(mod, device)
+    vm = executor.vm
+    x_name, w_name, b_name = executor.executable.get_function_params("main")
+    vm.bind_params({w_name: m_w, b_name: m_b})
+    for m_x in batches:
+        check(vm.run(m_x), model(m_x, m_w, m_b), rtol=1e-5, atol=1e-5)
+        check(vm.run(**{x_name: m_x}), model(m_x, m_w, m_b), rtol=1e-5, atol=1e-5)
+    # Unbind the parameters, which are passed as usual again.
+    vm.bind_params({})
+    m_x = batches[0]
+    check(vm.run(m_x, m_w, m_b), model(m_x, m_w, m_b), rtol=1e-5, atol=1e-5)
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_evict_function(device):
+    # pylint: disable=protected-access
+    class Model(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):  # pylint: disable=no-self-use
+            return raf.tanh(raf.add(raf.relu(x), x))
+
+    model = Model()
+    model.infer_mode()
+    m_x, _ = randn((4, 4), device=device)
+    vm = VMExecutor(model._internal(m_x).mod, device).vm
+    check(vm.run(m_x), model(m_x), rtol=1e-5, atol=1e-5)
+    check(vm.run(m_x), model(m_x), rtol=1e-5, atol=1e-5)
+    misses = vm.get_stats()["op_env_cache_misses"]
+    assert misses > 0
+
+    # The OpEnvs are dispatched again after the function is evicted.
+    vm.evict_function("main")
+    check(vm.run(m_x), model(m_x), rtol=1e-5, atol=1e-5)
+    assert vm.get_stats()["op_env_cache_misses"] == 2 * misses
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+@pytest.mark.parametrize(
+    "index",
+    [
+        (slice(None), slice(1, 6, 2), slice(None, 3)),  # Rows of contiguous elements
+        (slice(None), slice(None), slice(None, None, 2)),  # Arbitrary strides
+    ],
+)
+def test_strided_input(device, index):
+    # pylint: disable=protected-access
+    class Model(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):  # pylint: disable=no-self-use
+            return raf.add(x, x)
+
+    model = Model()
+    model.infer_mode()
+    n_x = np.random.randn(4, 8, 6).astype("float32")[index]
+    assert not n_x.flags["C_CONTIGUOUS"]
+    # The array is wrapped without being copied, so the input is a strided view.
+    m_x = raf.ndarray(n_x, device=None)
+    mod = model._internal(m_x).mod
+    m_y = VMExecutor(mod, device).make_executor()(m_x)
+    check(m_y, n_x + n_x)
+
+
 @pytest.mark.parametrize("device", get_testable_devices())
 @pytest.mark.parametrize("shape", [[3, 3], [4, 4]])
 def test_tuple(device, shape):
@@ -109,6 +743,39 @@ def test_tuple(device, shape):
     assert executable.globals[0] == "main"
 
 
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_tuple_reuse(device):
+    # pylint: disable=protected-access
+    class Model(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):  # pylint: disable=no-self-use
+            y = raf.add(x, x)
+            return y, raf.multiply(y, x)
+
+    model = Model()
+    model.infer_mode()
+    m_x1, n_x1 = randn((4, 4), device=device)
+    m_x2, n_x2 = randn((4, 4), device=device)
+    mod = model._internal(m_x1).mod
+    vm = VMExecutor(mod, device).vm
+    # The returned tuple is in use, so the next run does not update it in place.
+    out1 = vm.run(m_x1)
+    out2 = vm.run(m_x2)
+    for out, n_x in [(out1, n_x1), (out2, n_x2)]:
+        check(out[0], n_x + n_x)
+        check(out[1], (n_x + n_x) * n_x)
+    # The released tuples are reused by the following runs.
+    del out1, out2
+    for _ in range(3):
+        out = vm.run(m_x1)
+        check(out[0], n_x1 + n_x1)
+        check(out[1], (n_x1 + n_x1) * n_x1)
+
+
 @pytest.mark.parametrize("device", get_testable_devices())
 @pytest.mark.parametrize("shape", [[3, 3], [4, 4]])
 def test_memory(device, shape):
@@ -1,6 +1,7 @@
 # Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
 # SPDX-License-Identifier: Apache-2.0
 
+import numpy as np
 import pytest
 import raf
 import tvm
@@ -9,6 +10,7 @@ from raf._core.device import Device
 from raf._core.executor import VMExecutor
 from raf._core.vm_debug import VMDebugExecutor
 from raf._ffi.memory_pool import InitPool
+from raf.model.model import trace_memory
 from raf.testing import get_testable_devices, randn, with_seed
 
 
@@ -51,6 +53,47 @@ def test_vm_debugger(device, shape):
     check(outs[1], ref_z)
 
 
+@pytest.mark.parametrize("device", get_testable_devices())
+@with_seed(0)
+def test_vm_debugger_lightweight(device):
+    # pylint: disable=protected-access
+    class Model(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):  # pylint: disable=no-self-use
+            y = raf.add(x, x)
+            z = raf.add(x, y)
+            return z
+
+    model = Model()
+    model.infer_mode()
+    _, n_x = randn((64, 64), device=device)
+    n_x[0, 0] = np.nan
+    m_x = raf.array(n_x, device=device)
+    mod = model._internal(m_x).mod
+    with raf.ir.PassContext(opt_level=1):
+        executor = VMDebugExecutor(mod, device, lightweight=True)
+    executor.make_executor()(m_x)
+
+    summaries = executor.get_op_summaries()
+    assert len(summaries["names"]) == 2
+    assert all(latency >= 0 for latency in summaries["latency"])
+    for i, ref in enumerate([n_x + n_x, n_x * 3]):
+        valid = ref[~np.isnan(ref)]
+        check(summaries["min"][i], valid.min(), rtol=1e-5, atol=1e-5)
+        check(summaries["max"][i], valid.max(), rtol=1e-5, atol=1e-5)
+        assert summaries["nan_count"][i] == 1
+        check(summaries["l2"][i], np.linalg.norm(valid), rtol=1e-4, atol=1e-4)
+
+    # The records are cleared, and the buffers are reused by the next run.
+    executor.reset()
+    executor.make_executor()(m_x)
+    assert len(executor.get_op_summaries()["names"]) == 2
+
+
 @pytest.mark.parametrize("device", get_testable_devices())
 @pytest.mark.parametrize("pool_name", ["no_pool", "page_unit_pool"])
 def test_vm_memory_profiler(device, pool_name):
@@ -113,5 +156,57 @@ def test_vm_memory_profiler(device, pool_name):
             assert peak_memory == 0
 
 
+@pytest.mark.parametrize("pool_name", ["no_pool", "page_unit_pool"])
+def test_vm_allocation_trace(pool_name):
+    # pylint: disable=protected-access
+    class Model(raf.Model):
+        # pylint: disable=attribute-defined-outside-init,no-self-use
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, w):
+            y = raf.conv2d(x, w, stride=1, padding=1, dilation=1, groups=1)
+            y = raf.conv2d(y, w, stride=1, padding=1, dilation=1, groups=1)
+            y = raf.conv2d(y, w, stride=1, padding=1, dilation=1, groups=1)
+            return y
+
+    device = "cpu"
+    InitPool(Device(device), pool_name)
+    model = Model()
+    model.infer_mode()
+    m_x, _ = randn((32, 3, 224, 224), device=device)
+    m_w, _ = randn((3, 3, 3, 3), device=device)
+
+    mod = model._internal(m_x, m_w).mod
+    with tvm.transform.PassContext(opt_level=3):
+        raf.utils.memory_profiler.reset()
+        raf.utils.memory_profiler.start_allocation_trace()
+        out = VMExecutor(mod, device).make_executor()(m_x, m_w)
+        raf.utils.memory_profiler.stop_allocation_trace()
+
+    buffer_size = (32 * 3 * 224 * 224) * 4 / 1048576
+    info = raf.utils.memory_profiler.get_allocation_info(Device(device))
+    # Two conv2d outputs are alive at the peak, and only the model output is alive at the end.
+    check(info["peak"].value, 2 * buffer_size, rtol=1e-1, atol=1e-1)
+    check(info["live"].value, buffer_size, rtol=1e-1, atol=1e-1)
+
+    breakdown = raf.utils.memory_profiler.get_peak_breakdown(Device(device))
+    lines = breakdown.strip().split("\n")
+    assert all(line.startswith("cpu") and "AllocStorage" in line for line in lines), breakdown
+    assert sum(int(line.split()[-1]) for line in lines) / 1048576 == pytest.approx(
+        info["peak"].value, rel=1e-3
+    )
+    live = raf.utils.memory_profiler.get_live_allocations(Device(device))
+    assert len(live.strip().split("\n")) == 2, live
+
+    traced, estimated = raf.utils.memory_profiler.cross_check_estimate(
+        Device(device), trace_memory(model, device, [m_x, m_w], include_param=False)
+    )
+    check(traced, estimated, rtol=1e-1, atol=1e-1)
+    del out
+    raf.utils.memory_profiler.reset()
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
@@ -2,6 +2,10 @@
 # SPDX-License-Identifier: Apache-2.0
 
 # pylint: disable=invalid-name,protected-access,attribute-defined-outside-init
+import os
+import subprocess
+import sys
+
 import pytest
 import numpy as np
 import raf
@@ -35,6 +39,19 @@ def serialize_and_load(exe):
     return Executable.load_exec(loaded_code, loaded_lib)
 
 
+def save_and_map(exe):
+    lib = exe.lib
+    tmp = tvm.contrib.utils.tempdir()
+    if lib is not None:
+        lib_path = tmp.relpath("lib.so")
+        lib.export_library(lib_path)
+    code_path = tmp.relpath("code.ro")
+    exe.save_to_file(code_path)
+
+    loaded_lib = None if lib is None else tvm.runtime.load_module(lib_path)
+    return Executable.load_exec_from_file(code_path, loaded_lib)
+
+
 @pytest.mark.parametrize("fuse", [True, False])
 def test_simple(fuse):
     # pylint: disable=protected-access
@@ -86,6 +103,31 @@ def test_constant(fuse):
     m_y = run_exec(loaded_exe, [m_x])
     check(m_y, ref_y)
 
+    mapped_exe = save_and_map(executor.executable)
+    m_y = run_exec(mapped_exe, [m_x])
+    check(m_y, ref_y)
+
+
+def test_many_constants():
+    # The constants are encoded in parallel by chunks, which must be loaded back in order.
+    shape = (3, 5)
+    x = raf.ir.var("x", shape=shape)
+    y = x
+    for i in range(100):
+        y = raf.ir.op.add(y, raf.ir.const(np.full((1, 5), i, dtype="float32")))
+    mod = raf.ir.IRModule()
+    mod["main"] = relay.Function([x], y)
+    mod = raf._ffi.pass_.ToANormalForm()(mod)
+
+    with raf.ir.PassContext(opt_level=1):
+        executor = VMExecutor(mod, "cpu")
+    m_x, n_x = randn(shape)
+    ref_y = executor.make_executor()(m_x)
+    check(ref_y, n_x + sum(range(100)))
+
+    loaded_exe = serialize_and_load(executor.executable)
+    check(run_exec(loaded_exe, [m_x]), ref_y)
+
 
 @pytest.mark.parametrize("fuse", [True, False])
 def test_tuple(fuse):
@@ -115,5 +157,92 @@ def test_tuple(fuse):
         check(t, ref_t)
 
 
+PERSIST_SCRIPT = """
+import os
+import numpy as np
+import raf
+from raf._core.executor import VMExecutor
+
+
+class Model(raf.Model):
+    def build(self):
+        pass
+
+    @raf.model.trace
+    def forward(self, x):
+        return raf.relu(raf.add(x, x))
+
+
+m_x = raf.array(np.arange(6, dtype="float32").reshape((2, 3)) - 3)
+mod = Model()._internal(m_x).mod
+out = VMExecutor(mod, "cpu").make_executor()(m_x)
+print(os.listdir(os.path.join(os.environ["RAF_PERSIST_CACHE_PATH"], "vm_executable")))
+print(out.numpy().tolist())
+"""
+
+
+def test_persist_executable(tmp_path):
+    env = dict(os.environ)
+    env.update({"RAF_PERSIST_CACHE": "1", "RAF_PERSIST_CACHE_PATH": str(tmp_path)})
+
+    def run():
+        cmd = [sys.executable, "-c", PERSIST_SCRIPT]
+        return subprocess.check_output(cmd, env=env).decode().strip().splitlines()[-2:]
+
+    # The second process loads the executable compiled by the first one.
+    first, second = run(), run()
+    assert first[0] != "[]"
+    assert first == second
+    assert second[1] == str([[0.0, 0.0, 0.0], [0.0, 2.0, 4.0]])
+
+
+BUNDLE_SCRIPT = """
+import sys
+import numpy as np
+import raf
+from raf._core.device import Device
+from raf._core.executor import VMExecutor
+from raf._core.vm import Executable, VirtualMachine
+
+
+class Model(raf.Model):
+    def build(self):
+        pass
+
+    @raf.model.trace
+    def forward(self, x):
+        return raf.relu(raf.add(x, x))
+
+
+m_x = raf.array(np.arange(6, dtype="float32").reshape((2, 3)) - 3)
+path = sys.argv[1]
+if sys.argv[2] == "save":
+    mod = Model()._internal(m_x).mod
+    with raf.ir.PassContext(opt_level=3):
+        executor = VMExecutor(mod, "cpu")
+    out = executor.make_executor()(m_x)
+    executor.executable.save_to_file(path, bundle_kernels=True)
+else:
+    exe = Executable.load_exec_from_file(path, None)
+    out = VirtualMachine(exe, Device("cpu")).run(m_x)
+print(raf._ffi.cache.DumpTVMCacheMetric("tvm_fused_cpu")["CacheSet"])
+print(out.numpy().tolist())
+"""
+
+
+def test_bundle_kernels(tmp_path):
+    path = str(tmp_path / "code.ro")
+
+    def run(mode):
+        cmd = [sys.executable, "-c", BUNDLE_SCRIPT, path, mode]
+        return subprocess.check_output(cmd).decode().strip().splitlines()[-2:]
+
+    saved, loaded = run("save"), run("load")
+    # The kernels are built before saving, and are loaded from the executable without JIT.
+    assert saved[0] != "0"
+    assert loaded[0] == "0"
+    assert saved[1] == loaded[1] == str([[0.0, 0.0, 0.0], [0.0, 2.0, 4.0]])
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
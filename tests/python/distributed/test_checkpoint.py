@@ -0,0 +1,58 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=attribute-defined-outside-init
+import numpy as np
+import pytest
+
+import raf
+from raf.distributed.checkpoint import save_checkpoint, load_checkpoint
+from raf.optim.utils import split_ndarray_with_padding
+from raf.testing import check
+
+
+class Model(raf.Model):
+    def build(self, w, b, w_v):
+        self.w = raf.array(w)
+        self.b = raf.array(b)
+        # The partitioned optimizer state of w.
+        self.w_v = raf.array(w_v)
+
+    @raf.model.trace
+    def forward(self, x):
+        return raf.add(raf.matmul(x, self.w), self.b)
+
+
+@pytest.mark.parametrize("load_size", [1, 2, 3])
+def test_reshard(tmp_path, load_size):
+    w = np.random.randn(5, 4).astype("float32")
+    b = np.random.randn(4).astype("float32")
+    v = np.random.randn(5, 4).astype("float32")
+    sharded = {"w_v": 5}
+
+    save_size = 2
+    handles = [
+        save_checkpoint(Model(w, b, part), str(tmp_path), sharded, rank, save_size)
+        for rank, part in enumerate(split_ndarray_with_padding(v, save_size))
+    ]
+    for handle in handles:
+        handle.wait()
+        assert handle.done()
+
+    parts = split_ndarray_with_padding(v, load_size)
+    for rank in range(load_size):
+        zeros = np.zeros_like
+        model = Model(zeros(w), zeros(b), zeros(parts[rank]))
+        load_checkpoint(model, str(tmp_path), sharded, rank, load_size)
+        check(model.w, w)
+        check(model.b, b)
+        check(model.w_v, parts[rank])
+
+    # A partitioned state can be loaded as a whole.
+    model = Model(w, b, np.zeros_like(v))
+    load_checkpoint(model, str(tmp_path), {}, 0, 1)
+    check(model.w_v, v)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
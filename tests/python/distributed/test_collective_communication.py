@@ -140,6 +140,147 @@ def test_allreduce_with_tensor_list(computation):
         check(vy, target_y)
 
 
+@pytest.mark.skipif(skip_dist_test(min_rank_num=2), reason=SKIP_REASON)
+@pytest.mark.parametrize("shape", [(4, 4), (3, 5)])
+def test_hierarchical_allreduce(shape):
+    """Testing allreduce with the hierarchical communicator. It falls back to the flat
+    communicator if the ranks are not on multiple nodes with multiple ranks each."""
+
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x1, x2):
+            return raf.allreduce([x1, x2], computation="sum")
+
+    dctx.enable_hierarchical_allreduce = True
+    model = TestModel()
+    total_rank, rank, local_rank = get_dist_info(verbose=True)
+    device = f"cuda({local_rank})"
+    x1 = raf.array(np.ones(shape=shape, dtype="float32") * (rank + 1), device=device)
+    x2 = raf.array(np.ones(shape=shape, dtype="float32") * (-rank - 1), device=device)
+    model.to(device=device)
+    y = run_model(model, [x1, x2], device)
+    dctx.enable_hierarchical_allreduce = False
+    ones = np.ones(shape=shape, dtype="float32")
+    check(y[0], ones * sum(range(1, total_rank + 1)))
+    check(y[1], ones * -sum(range(1, total_rank + 1)))
+
+
+@pytest.mark.skipif(skip_dist_test(min_rank_num=2), reason=SKIP_REASON)
+@pytest.mark.parametrize("compression", ["fp16", "bf16", "topk"])
+def test_compressed_allreduce(compression):
+    """Testing allreduce with gradient compression. The values are exact in low precisions,
+    and top-k sends all elements with ratio 1."""
+
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x1, x2):
+            return raf.allreduce([x1, x2], computation="sum")
+
+    if compression == "bf16" and raf.build.with_nccl() < 21000:
+        pytest.skip("bf16 is not supported in NCCL < 2.10")
+    dctx.allreduce_compression = compression
+    dctx.allreduce_topk_ratio = 1.0
+    model = TestModel()
+    total_rank, rank, local_rank = get_dist_info(verbose=True)
+    device = f"cuda({local_rank})"
+    x1 = raf.array(np.ones(shape=(4, 4), dtype="float32") * (rank + 1), device=device)
+    x2 = raf.array(np.ones(shape=(3, 5), dtype="float32") * (-rank - 1), device=device)
+    model.to(device=device)
+    y = run_model(model, [x1, x2], device)
+    dctx.allreduce_compression = "none"
+    dctx.allreduce_topk_ratio = 0.01
+    check(y[0], np.ones(shape=(4, 4), dtype="float32") * sum(range(1, total_rank + 1)))
+    check(y[1], np.ones(shape=(3, 5), dtype="float32") * -sum(range(1, total_rank + 1)))
+
+
+@pytest.mark.skipif(skip_dist_test(min_rank_num=2), reason=SKIP_REASON)
+@pytest.mark.parametrize("computation", ["sum", "avg"])
+def test_fp32_accumulated_allreduce(computation):
+    """Testing allreduce of a tuple of mixed dtypes, whose float16 tensors are accumulated in
+    float32, and whose float32 tensor is reduced in its own group."""
+
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x1, x2, x3):
+            return raf.allreduce([x1, x2, x3], computation=computation)
+
+    if computation == "avg" and raf.build.with_nccl() < 21000:
+        pytest.skip("avg is not supported in NCCL < 2.10")
+    dctx.allreduce_fp32_accumulate = True
+    model = TestModel()
+    total_rank, rank, local_rank = get_dist_info(verbose=True)
+    device = f"cuda({local_rank})"
+    shapes = [(3, 5), (4, 4), (7,)]
+    dtypes = ["float16", "float32", "float16"]
+    xs = [
+        raf.array(np.ones(shape=shape, dtype=dtype) * (rank + 1 + i), device=device)
+        for i, (shape, dtype) in enumerate(zip(shapes, dtypes))
+    ]
+    model.to(device=device)
+    y = run_model(model, xs, device)
+    dctx.allreduce_fp32_accumulate = False
+    for i, (shape, dtype) in enumerate(zip(shapes, dtypes)):
+        target = sum(r + 1 + i for r in range(total_rank))
+        if computation == "avg":
+            target = target / total_rank
+        check(y[i], np.ones(shape=shape, dtype=dtype) * target)
+
+
+@pytest.mark.skipif(skip_dist_test(min_rank_num=2), reason=SKIP_REASON)
+def test_comm_profiler():
+    """Testing the bandwidth accounting of the communication profiler and the straggler report."""
+    # pylint: disable=import-outside-toplevel
+    from raf.utils import profiler
+
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            return raf.allreduce(x, computation="sum")
+
+    model = TestModel()
+    total_rank, rank, local_rank = get_dist_info(verbose=True)
+    device = f"cuda({local_rank})"
+    x = raf.array(np.ones(shape=(64, 64), dtype="float32"), device=device)
+    model.to(device=device)
+    profiler.reset_comm_profiler()
+    profiler.start_comm_profiler()
+    for _ in range(2):
+        run_vm_model(model, device, [x])
+    profiler.stop_comm_profiler()
+
+    profile = profiler.get_comm_profile()
+    assert profile["rank"] == rank
+    assert len(profile["iterations"]) == 2
+    for iteration in profile["iterations"]:
+        assert iteration["num_collectives"] == 1
+        comm = iteration["collectives"][0]
+        assert comm["kind"] == "allreduce"
+        assert comm["bytes"] == 64 * 64 * 4
+        assert comm["nranks"] == total_rank
+        assert comm["time_us"] > 0
+        factor = 2.0 * (total_rank - 1) / total_rank
+        np.testing.assert_allclose(comm["busbw_gbps"], comm["algbw_gbps"] * factor, rtol=1e-5)
+
+    report = profiler.get_comm_straggler_report()
+    assert report["num_ranks"] == total_rank
+    assert len(report["iterations"]) == 2
+    assert sum(report["straggler_counts"]) == 2
+    assert report["diagnosis"] in ["slow_rank", "slow_link"]
+    profiler.reset_comm_profiler()
+
+
 @pytest.mark.skipif(skip_dist_test(min_rank_num=4), reason=SKIP_REASON)
 @pytest.mark.parametrize("dtype", ["float32", "float16"])
 @pytest.mark.parametrize("rank_list", [[[0, 1], [2, 3]], [[1, 2, 3]]])
@@ -178,6 +319,31 @@ def test_allreduce_with_subcomm(dtype, rank_list):
             check(y, target_y)
 
 
+@pytest.mark.skipif(skip_dist_test(min_rank_num=4), reason=SKIP_REASON)
+def test_allreduce_with_multiple_subcomms():
+    """Testing the sub-communicators of a module, which are created together by the VM."""
+
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            x = raf.allreduce(x, "sum", [[0, 1], [2, 3]])
+            x = raf.allreduce(x, "sum", [[0, 2], [1, 3]])
+            return x
+
+    model = TestModel()
+    _, rank, local_rank = get_dist_info(verbose=True)
+    device = f"cuda({local_rank})"
+    x = np.ones(shape=(4, 4), dtype="float32") * (rank + 1)
+    x = raf.array(x, device=device)
+    model.to(device=device)
+    y = run_vm_model(model, device, [x])
+    if rank < 4:
+        check(y, np.ones(shape=(4, 4), dtype="float32") * 10)
+
+
 @pytest.mark.skipif(skip_dist_test(min_rank_num=2), reason=SKIP_REASON)
 @pytest.mark.parametrize("axis", [0, 1])
 def test_allgather(axis):
@@ -378,6 +544,34 @@ def test_send_recv():
     check(out1[0], n_out)
 
 
+@pytest.mark.skipif(skip_dist_test(min_rank_num=2, require_exact_rank=True), reason=SKIP_REASON)
+def test_send_recv_grouped():
+    """Both ranks send before they receive, which only completes when the VM launches the send
+    and the recv in one NCCL group."""
+    shape = [1024, 1024]
+    dtype = "float32"
+
+    class TestModel(raf.Model):
+        def build(self, peer):
+            self.peer = peer
+
+        @raf.model.trace
+        def forward(self, x):
+            t = raf.send(x, peer=self.peer)
+            y = raf.recv(peer=self.peer, shape=shape, dtype=dtype, token=t)
+            out = raf.add(x, y)
+            return Symbol.make_tuple([out, t])
+
+    _, rank, local_rank = get_dist_info(verbose=True)
+    device = f"cuda({local_rank})"
+    model = TestModel(1 - rank)
+    n_ones = np.ones(shape=shape, dtype=dtype)
+    m_x = raf.array(n_ones * (rank + 1), device=device)
+    model.to(device=device)
+    out = run_vm_model(model, device, [m_x])
+    check(out[0], n_ones * 3)
+
+
 @pytest.mark.skipif(skip_dist_test(min_rank_num=2), reason=SKIP_REASON)
 @pytest.mark.parametrize("computation", ["sum", "prod", "min", "max", "avg"])
 def test_reduce(computation):
@@ -522,6 +716,51 @@ def test_broadcast():
     check(y, target_y)
 
 
+@pytest.mark.skipif(skip_dist_test(min_rank_num=2), reason=SKIP_REASON)
+def test_sequence_parallel_attention():
+    """Each rank attends its local queries over the keys and values gathered from all ranks."""
+    from raf.distributed import sequence_parallel as sp
+
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, q, k, v):
+            return sp.attention(q, k, v, 0.125)
+
+    total_rank, rank, local_rank = get_dist_info(verbose=True)
+    device = f"cuda({local_rank})"
+    # All ranks generate the same whole sequence.
+    rng = np.random.RandomState(0)
+    q, k, v = [rng.randn(2, 4 * total_rank, 8).astype("float32") for _ in range(3)]
+    score = np.matmul(q, k.transpose(0, 2, 1)) * 0.125
+    prob = np.exp(score - score.max(axis=-1, keepdims=True))
+    prob /= prob.sum(axis=-1, keepdims=True)
+    target_y = sp.shard_sequence(np.matmul(prob, v), axis=1)
+
+    model = TestModel()
+    model.to(device=device)
+    args = [raf.array(sp.shard_sequence(x, axis=1), device=device) for x in [q, k, v]]
+    y = run_vm_model(model, device, args)
+    check(y, target_y, rtol=1e-4, atol=1e-4)
+
+
+@pytest.mark.skipif(skip_dist_test(min_rank_num=2), reason=SKIP_REASON)
+def test_probe_topology():
+    assert dctx.num_nodes * dctx.local_size == dctx.size
+    assert dctx.intra_node_link in ["nvlink", "pcie", "none"]
+    bandwidth = [float(bw) for bw in dctx.peer_bandwidth]
+    if bandwidth:
+        assert len(bandwidth) == dctx.local_size
+        assert bandwidth[dctx.local_rank] == 0
+    if dctx.intra_node_link != "none":
+        assert all(bw > 0 for i, bw in enumerate(bandwidth) if i != dctx.local_rank)
+    # A single node never prefers the hierarchical allreduce.
+    if dctx.num_nodes == 1:
+        assert not raf._ffi.distributed.PreferHierarchicalAllReduce(1 << 30)
+
+
 if __name__ == "__main__":
     exit_code = pytest.main([__file__])
     dist.RemoveCommunicator()
@@ -0,0 +1,63 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+import pytest
+
+from raf.distributed.pipeline import schedule_1f1b, bubble_ratio, run_schedule
+
+
+@pytest.mark.parametrize("num_stages", [1, 2, 4])
+@pytest.mark.parametrize("num_micro_batches", [1, 4, 8])
+def test_schedule_1f1b(num_stages, num_micro_batches):
+    for stage in range(num_stages):
+        schedule = schedule_1f1b(num_stages, stage, num_micro_batches)
+        forwards = [idx for kind, idx in schedule if kind == "forward"]
+        backwards = [idx for kind, idx in schedule if kind == "backward"]
+        assert forwards == list(range(num_micro_batches))
+        assert backwards == list(range(num_micro_batches))
+
+        # The backward of a micro-batch runs after its forward, and the number of in-flight
+        # micro-batches is bounded by the number of the remaining stages.
+        in_flight = 0
+        for kind, idx in schedule:
+            if kind == "forward":
+                in_flight += 1
+                assert in_flight <= num_stages - stage
+            else:
+                assert schedule.index(("forward", idx)) < schedule.index(("backward", idx))
+                in_flight -= 1
+
+    # The last stage alternates forward and backward.
+    assert schedule_1f1b(num_stages, num_stages - 1, 2) == [
+        ("forward", 0),
+        ("backward", 0),
+        ("forward", 1),
+        ("backward", 1),
+    ]
+    assert bubble_ratio(num_stages, num_micro_batches) == pytest.approx(
+        (num_stages - 1) / (num_micro_batches + num_stages - 1)
+    )
+
+
+def test_run_schedule():
+    schedule = schedule_1f1b(2, 0, 4)
+    steps = []
+
+    def forward(idx):
+        steps.append(("forward", idx))
+        return idx * 2
+
+    def backward(idx):
+        steps.append(("backward", idx))
+
+    outs = run_schedule(schedule, forward, backward)
+    assert steps == schedule
+    assert outs == [0, 2, 4, 6]
+
+    # Inference only runs the forward steps.
+    outs = run_schedule(schedule, lambda i: i)
+    assert outs == [0, 1, 2, 3]
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -0,0 +1,39 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access
+from raf import hybrid
+from raf._core import module
+from raf.hybrid.to_relay import _CallCollector
+
+
+@hybrid
+def sum_to(n):
+    s = 0
+    i = 0
+    while i < n:
+        s = s + i
+        i = i + 1
+    s = s * 2
+    return s
+
+
+def get_block_funcs(name):
+    funcs = module.get_global().functions.items()
+    return {gv.name_hint: func for gv, func in funcs if gv.name_hint.startswith(name + "$")}
+
+
+def test_loop_is_self_recursive():
+    assert sum_to(10) == 90
+    assert sum_to(100) == 9900
+    # Only the loop header is left, whose back edge is a call to itself.
+    funcs = get_block_funcs("sum_to")
+    assert len(funcs) == 1, funcs
+    ((name, func),) = funcs.items()
+    collector = _CallCollector()
+    collector.visit(func.body)
+    assert [callee.name_hint for callee in collector.callees] == [name]
+
+
+if __name__ == "__main__":
+    test_loop_is_self_recursive()
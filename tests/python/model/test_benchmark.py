@@ -0,0 +1,55 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+import copy
+import json
+
+import pytest
+
+from raf.testing import benchmark
+
+
+@pytest.mark.parametrize("train", [False, True])
+def test_benchmark_mlp(train):
+    report = benchmark.run_benchmarks(["mlp"], [1, 4], "cpu", train, warmup=1, repeat=3)
+    # The report must be serializable.
+    report = json.loads(json.dumps(report))
+    assert report["schema_version"] == benchmark.SCHEMA_VERSION
+    assert report["options"]["mode"] == ("train" if train else "infer")
+    assert [r["batch_size"] for r in report["results"]] == [1, 4]
+    for result in report["results"]:
+        assert result["model"] == "mlp"
+        assert result["compile_time_s"] > 0
+        assert 0 < result["latency_p50_ms"] <= result["latency_p99_ms"]
+        assert result["samples_per_sec"] > 0
+        assert result["peak_memory_mb"] >= 0
+    assert not benchmark.compare_results(report, report)
+
+
+def test_compare_results():
+    baseline = {
+        "schema_version": benchmark.SCHEMA_VERSION,
+        "options": {"mode": "train"},
+        "results": [
+            {
+                "model": "mlp",
+                "batch_size": 8,
+                "peak_memory_mb": 100.0,
+                "compile_time_s": 10.0,
+                "samples_per_sec": 1000.0,
+            }
+        ],
+    }
+    current = copy.deepcopy(baseline)
+    current["results"][0]["samples_per_sec"] = 970.0
+    assert not benchmark.compare_results(baseline, current)
+    current["results"][0]["samples_per_sec"] = 900.0
+    current["results"][0]["peak_memory_mb"] = 120.0
+    regressions = benchmark.compare_results(baseline, current)
+    assert len(regressions) == 2
+    assert any("samples_per_sec" in r for r in regressions)
+    assert any("peak_memory_mb" in r for r in regressions)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -6,7 +6,7 @@ import numpy as np
 
 import raf
 from raf._core.ndarray import ndarray
-from raf.model.model import calc_model_gflops, get_param_size
+from raf.model.model import calc_model_gflops, get_param_size, plan_batch_size, roofline_report
 from raf.testing import check, randn
 
 
@@ -58,5 +58,67 @@ def test_calc_gflops():
     check(gflops, 1056 / 1e9, rtol=1e-1, atol=1e-1)
 
 
+def test_roofline_report():
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, data, weight):
+            a_1 = raf.matmul(data, weight)
+            a_2 = raf.add(a_1, a_1)
+            return a_2
+
+    m_x, _ = randn((64, 128), device="cpu")
+    m_w, _ = randn((128, 32), device="cpu")
+    report = roofline_report(Model(), "cpu", [m_x, m_w], peak_tflops=1.0, peak_gbps=100.0)
+    assert report
+    for entry in report:
+        assert entry["bound"] in ["compute", "memory"]
+        assert entry["bytes"] > 0 and entry["latency_us"] > 0
+        if entry["gflops"] > 0:
+            intensity = entry["gflops"] * 1e9 / entry["bytes"]
+            check(entry["intensity"], intensity, rtol=1e-5, atol=1e-5)
+            assert entry["bound"] == ("memory" if intensity < 10 else "compute")
+    # Bytes moved by the matmul kernel at least include its inputs and output.
+    assert max(entry["bytes"] for entry in report) >= (64 * 128 + 128 * 32 + 64 * 32) * 4
+
+
+def test_plan_batch_size():
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, data, weight):
+            a_1 = raf.matmul(data, weight)
+            a_2 = raf.relu(a_1)
+            return raf.add(a_2, a_1)
+
+    def get_model_and_args(batch_size):
+        m_x, _ = randn((batch_size, 256), device="cpu")
+        m_w, _ = randn((256, 1024), device="cpu")
+        return Model(), [m_x, m_w]
+
+    plans = plan_batch_size(get_model_and_args, "cpu", batch_sizes=[64, 128])
+    assert [plan["batch_size"] for plan in plans] == [64, 128]
+    for plan in plans:
+        assert plan["fits"] and plan["samples_per_sec"] > 0
+        assert plan["gflops"] > 0 and plan["step_time_ms"] > 0
+        assert "remat_peak_memory_mb" not in plan
+    # Each of the (batch, 1024) tensors takes batch / 256 MBs.
+    assert plans[0]["peak_memory_mb"] < plans[1]["peak_memory_mb"]
+
+    # The search ends at the largest fitting batch, whose next batch does not fit.
+    plans = plan_batch_size(get_model_and_args, "cpu", max_batch_size=4096, memory_budget=10)
+    fits = {plan["batch_size"]: plan["fits"] for plan in plans}
+    largest = max(batch_size for batch_size, fit in fits.items() if fit)
+    assert all(not fit for batch_size, fit in fits.items() if batch_size > largest)
+    assert largest == 4096 or not fits[largest + 1]
+    for plan in plans:
+        assert "remat_peak_memory_mb" in plan
+        assert plan["fits"] == (min(plan["peak_memory_mb"], plan["remat_peak_memory_mb"]) <= 10)
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
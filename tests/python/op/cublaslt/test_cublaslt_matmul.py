@@ -0,0 +1,68 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=too-many-locals,too-many-arguments,protected-access,no-member
+# pylint: disable=attribute-defined-outside-init
+import pytest
+import torch
+
+import raf
+from raf.testing import randn_torch, run_vm_model, check, DialectChecker
+
+
+def verify_ir(mod):
+    with raf.device("cuda"):
+        mod = raf._ffi.pass_.ToGraphNormalForm()(mod)
+        mod = raf._ffi.pass_.ToBasicBlockNormalForm()(mod)
+        mod = raf._ffi.pass_.FuseDialect()(mod)
+        DialectChecker("cublaslt").visit(mod["main"])
+
+
+# The fused matmul patterns are dispatched to CUTLASS with a higher priority when it is built.
+@pytest.mark.skipif(
+    not raf.build.with_cublas() or raf.build.with_cutlass(),
+    reason="cuBLAS is not enabled or CUTLASS is enabled",
+)
+@pytest.mark.parametrize("m", [1, 15])
+@pytest.mark.parametrize("n", [16, 32])
+@pytest.mark.parametrize("k", [16, 32])
+@pytest.mark.parametrize("transpose_b", [False, True])
+@pytest.mark.parametrize(
+    "epilogue",
+    [
+        [None, None],
+        [raf._op.sym.relu, torch.nn.functional.relu],
+        [raf._op.sym.gelu, torch.nn.GELU(approximate="tanh")],
+    ],
+)
+@pytest.mark.parametrize("full_bias", [False, True])
+def test_matmul_add_epilogue(m, n, k, transpose_b, epilogue, full_bias):
+    m_epilogue, t_epilogue = epilogue
+
+    class TestModel(raf.Model):
+        def build(self):
+            self.epilogue = m_epilogue
+
+        @raf.model.trace
+        def forward(self, x, w, bias):  # pylint: disable=no-self-use
+            x = raf.matmul_nt(x, w) if transpose_b else raf.matmul(x, w)
+            x = raf.add(x, bias)
+            x = self.epilogue(x) if self.epilogue else x
+            return x
+
+    device = "cuda"
+    m_x, t_x = randn_torch([m, k], device=device)
+    m_w, t_w = randn_torch([n, k] if transpose_b else [k, n], device=device)
+    m_bias, t_bias = randn_torch([m, n] if full_bias else [n], device=device)
+    model = TestModel()
+    model.to(device=device)
+    mod = model._internal(m_x, m_w, m_bias).mod
+    verify_ir(mod)
+    m_y = run_vm_model(model, device, [m_x, m_w, m_bias])
+    t_y = torch.matmul(t_x, t_w.T if transpose_b else t_w) + t_bias
+    t_y = t_epilogue(t_y) if t_epilogue else t_y
+    check(m_y, t_y, rtol=1e-4, atol=1e-4)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
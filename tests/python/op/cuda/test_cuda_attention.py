@@ -0,0 +1,143 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=too-many-locals,too-many-arguments,protected-access,no-self-use
+import numpy as np
+import pytest
+import torch
+
+import raf
+from raf.testing import randn_torch, run_vm_model, check, with_dialect, DialectChecker
+
+
+def torch_attention(t_q, t_k, t_v, scale, causal):
+    t_score = torch.matmul(t_q, t_k.transpose(1, 2)) * scale
+    if causal:
+        mask = torch.ones(t_score.shape[1:], dtype=torch.bool, device=t_q.device).triu(1)
+        t_score = t_score.masked_fill(mask, float("-inf"))
+    return torch.matmul(torch.softmax(t_score.float(), dim=-1).to(t_q.dtype), t_v)
+
+
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("shapes", [(4, 7, 7, 64, 64), (2, 100, 37, 32, 80), (1, 33, 65, 128, 16)])
+@pytest.mark.parametrize("causal", [False, True])
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+def test_attention(shapes, causal, dtype):
+    batch, seq_q, seq_k, dim, vdim = shapes
+    device = "cuda"
+
+    class Attention(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, q, k, v):
+            return raf._contrib_attention(q, k, v, causal=causal)
+
+    m_model = Attention()
+    m_model.to(device=device)
+    m_q, t_q = randn_torch((batch, seq_q, dim), device=device, dtype=dtype, requires_grad=True)
+    m_k, t_k = randn_torch((batch, seq_k, dim), device=device, dtype=dtype, requires_grad=True)
+    m_v, t_v = randn_torch((batch, seq_k, vdim), device=device, dtype=dtype, requires_grad=True)
+    m_y = m_model(m_q, m_k, m_v)
+    t_y = torch_attention(t_q, t_k, t_v, dim**-0.5, causal)
+    tol = 1e-4 if dtype == "float32" else 1e-2
+    check(m_y, t_y, rtol=tol, atol=tol)
+
+    m_dy, t_dy = randn_torch(m_y.shape, device=device, dtype=dtype)
+    m_y.backward(m_dy)
+    t_y.backward(t_dy)
+    check(m_q.grad, t_q.grad, rtol=tol, atol=tol)
+    check(m_k.grad, t_k.grad, rtol=tol, atol=tol)
+    check(m_v.grad, t_v.grad, rtol=tol, atol=tol)
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("scale_op", [None, "multiply", "divide"])
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+def test_attention_fusion(scale_op, dtype):
+    batch, seq, dim = 8, 64, 64
+    device = "cuda"
+
+    class Attention(raf.Model):
+        def build(self, scale):
+            self.scale = scale
+
+        @raf.model.trace
+        def forward(self, q, k, v):
+            score = raf.batch_matmul_nt(q, k)
+            if scale_op == "multiply":
+                score = raf.multiply(score, self.scale)
+            elif scale_op == "divide":
+                score = raf.divide(score, self.scale)
+            return raf.batch_matmul(raf.softmax(score), v)
+
+    scale = dim**0.5 if scale_op == "divide" else dim**-0.5
+    m_model = Attention(raf.array([scale], dtype=dtype))
+    m_model.to(device=device)
+    m_q, t_q = randn_torch((batch, seq, dim), device=device, dtype=dtype)
+    m_k, t_k = randn_torch((batch, seq, dim), device=device, dtype=dtype)
+    m_v, t_v = randn_torch((batch, seq, dim), device=device, dtype=dtype)
+    mod = m_model._internal(m_q, m_k, m_v).mod
+    with raf.device(device):
+        mod = raf._ffi.pass_.ToGraphNormalForm()(mod)
+        mod = raf._ffi.pass_.ToBasicBlockNormalForm()(mod)
+        mod = raf._ffi.pass_.FuseDialect()(mod)
+    DialectChecker("cuda").visit(mod["main"])
+
+    m_y = run_vm_model(m_model, device, [m_q, m_k, m_v])
+    t_y = torch_attention(t_q, t_k, t_v, 1.0 if scale_op is None else dim**-0.5, False)
+    tol = 1e-4 if dtype == "float32" else 1e-2
+    check(m_y, t_y, rtol=tol, atol=tol)
+
+
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+def test_kv_cache_decode(dtype):
+    batch, max_seq, dim, prompt, steps = 2, 64, 32, 5, 3
+    device = "cuda"
+
+    class Decoder(raf.Model):
+        def build(self, causal):
+            self.causal = causal
+
+        @raf.model.trace
+        def forward(self, q, k, v, k_cache, v_cache, offset, valid_len):
+            k_cache = raf._contrib_kv_cache_append(k_cache, k, offset)
+            v_cache = raf._contrib_kv_cache_append(v_cache, v, offset)
+            return raf._contrib_attention(
+                q, k_cache, v_cache, causal=self.causal, valid_len=valid_len
+            )
+
+    m_k_cache = raf.array(np.zeros((batch, max_seq, dim), dtype=dtype), device=device)
+    m_v_cache = raf.array(np.zeros((batch, max_seq, dim), dtype=dtype), device=device)
+    t_keys, t_values = [], []
+    tol = 1e-4 if dtype == "float32" else 1e-2
+    offset = 0
+    for step in range(steps + 1):
+        # The prompt is prefilled with the causal mask, and then one token is decoded per step.
+        seq = prompt if step == 0 else 1
+        m_model = Decoder(step == 0)
+        m_model.to(device=device)
+        m_q, t_q = randn_torch((batch, seq, dim), device=device, dtype=dtype)
+        m_k, t_k = randn_torch((batch, seq, dim), device=device, dtype=dtype)
+        m_v, t_v = randn_torch((batch, seq, dim), device=device, dtype=dtype)
+        m_offset = raf.array(np.array(offset, dtype="int64"), device=device)
+        m_valid_len = raf.array(np.array(offset + seq, dtype="int64"), device=device)
+        m_y = m_model(m_q, m_k, m_v, m_k_cache, m_v_cache, m_offset, m_valid_len)
+        t_keys.append(t_k)
+        t_values.append(t_v)
+        t_y = torch_attention(
+            t_q, torch.cat(t_keys, dim=1), torch.cat(t_values, dim=1), dim**-0.5, step == 0
+        )
+        check(m_y, t_y, rtol=tol, atol=tol)
+        offset += seq
+    # The caches are updated in place and persist across the calls.
+    check(m_k_cache.numpy()[:, :offset], torch.cat(t_keys, dim=1), rtol=tol, atol=tol)
+    check(m_v_cache.numpy()[:, offset:], np.zeros((batch, max_seq - offset, dim), dtype=dtype))
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
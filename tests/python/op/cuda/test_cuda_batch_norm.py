@@ -0,0 +1,79 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=too-many-locals,protected-access,too-many-arguments
+import numpy as np
+import pytest
+import torch.nn.functional as F
+
+import raf
+from raf.testing import randn_torch, run_vm_model, check, with_dialect, with_seed
+
+
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("shape", [(8, 16, 7, 7), (3, 64, 33), (256, 4, 5, 5)])
+@pytest.mark.parametrize("residual", [False, True])
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+@with_seed(0)
+def test_batch_norm_add_relu_train(shape, residual, dtype):
+    device = "cuda"
+    momentum, eps = 0.1, 1e-5
+    stats_shape = shape[1:2]
+
+    class BatchNormAddRelu(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, z, running_mean, running_var, w, b):
+            return raf._contrib_batch_norm_add_relu_train(
+                x, running_mean, running_var, w, b, z if residual else None, momentum, eps
+            )
+
+    class BatchNormAddReluDxwb(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, dy, x, mask, w, b):
+            return raf._contrib_batch_norm_add_relu_train_dxwb(dy, x, mask, w, b, eps)
+
+    m_x, t_x = randn_torch(shape, device=device, dtype=dtype)
+    m_z, t_z = randn_torch(shape, device=device, dtype=dtype)
+    m_m, t_m = randn_torch(stats_shape, device=device)
+    m_v, t_v = randn_torch(stats_shape, device=device, positive=True)
+    m_w, t_w = randn_torch(stats_shape, device=device)
+    m_b, t_b = randn_torch(stats_shape, device=device)
+    m_dy, t_dy = randn_torch(shape, device=device, dtype=dtype)
+
+    m_y, _, _, m_mask = run_vm_model(BatchNormAddRelu(), device, [m_x, m_z, m_m, m_v, m_w, m_b])
+    m_dx, m_dw, m_db, m_dz = run_vm_model(
+        BatchNormAddReluDxwb(), device, [m_dy, m_x, m_mask, m_w, m_b]
+    )
+
+    t_x = t_x.float().requires_grad_()
+    t_z = t_z.float().requires_grad_()
+    t_w.requires_grad_()
+    t_b.requires_grad_()
+    t_y = F.batch_norm(t_x, t_m, t_v, t_w, t_b, True, momentum, eps)
+    t_y = F.relu(t_y + t_z if residual else t_y)
+    t_y.backward(t_dy.float())
+    tol = 1e-2 if dtype == "float16" else 1e-4
+    check(m_y, t_y, rtol=tol, atol=tol)
+    check(m_m, t_m, rtol=1e-4, atol=1e-4)
+    check(m_v, t_v, rtol=1e-4, atol=1e-4)
+    # The bit i of the mask is set if the element i of y is positive.
+    n_mask = m_mask.numpy().view(np.uint32)
+    n_bits = (n_mask[:, None] >> np.arange(32, dtype=np.uint32)) & 1
+    n_bits = n_bits.reshape(-1)[: m_y.numpy().size].reshape(shape)
+    np.testing.assert_equal(n_bits, (m_y.numpy() > 0).astype(np.uint32))
+    check(m_dx, t_x.grad, rtol=tol * 10, atol=tol * 10)
+    check(m_dw, t_w.grad, rtol=tol * 10, atol=tol * 10)
+    check(m_db, t_b.grad, rtol=tol * 10, atol=tol * 10)
+    if residual:
+        check(m_dz, t_z.grad, rtol=tol, atol=tol)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -0,0 +1,69 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=too-many-locals,protected-access,no-self-use
+import pytest
+import torch
+import torch.nn.functional as F
+
+import raf
+from raf.testing import randn_torch, randint, check, with_dialect, DialectChecker
+
+
+def run_loss(model, n, c, dtype, target_dtype):
+    device = "cuda"
+    model.to(device=device)
+    m_pred, t_pred = randn_torch((n, c), device=device, dtype=dtype, requires_grad=True)
+    m_true, np_true = randint((n,), low=0, high=c, device=device, dtype=target_dtype)
+    t_true = torch.tensor(np_true, device=device, dtype=torch.int64)
+    m_loss = model(m_true, m_pred)
+    t_loss = F.cross_entropy(t_pred.float(), t_true)
+    tol = 1e-4 if dtype == "float32" else 1e-2
+    check(m_loss, t_loss.to(t_pred.dtype), rtol=tol, atol=tol)
+
+    m_dy, t_dy = randn_torch((), device=device, dtype=dtype)
+    m_loss.backward(m_dy)
+    t_loss.backward(t_dy.float())
+    check(m_pred.grad, t_pred.grad, rtol=tol, atol=tol)
+    return model, m_true, m_pred
+
+
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("shape", [(7, 3), (33, 1000), (4, 32001)])
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+@pytest.mark.parametrize("target_dtype", ["int32", "int64"])
+def test_cross_entropy(shape, dtype, target_dtype):
+    class CrossEntropy(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, y_true, y_pred):
+            return raf.cross_entropy(y_true=y_true, y_pred=y_pred)
+
+    run_loss(CrossEntropy(), *shape, dtype, target_dtype)
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+def test_log_softmax_nll_loss_fusion(dtype):
+    class LogSoftmaxNLLLoss(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, y_true, y_pred):
+            return raf.nll_loss(y_true=y_true, y_pred=raf.log_softmax(y_pred))
+
+    model, m_true, m_pred = run_loss(LogSoftmaxNLLLoss(), 16, 1000, dtype, "int64")
+    mod = model._internal(m_true, m_pred).mod
+    with raf.device("cuda"):
+        mod = raf._ffi.pass_.ToGraphNormalForm()(mod)
+        mod = raf._ffi.pass_.ToBasicBlockNormalForm()(mod)
+        mod = raf._ffi.pass_.FuseDialect()(mod)
+    DialectChecker("cuda").visit(mod["main"])
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
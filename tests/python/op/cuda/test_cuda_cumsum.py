@@ -0,0 +1,61 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+import numpy as np
+import pytest
+
+import raf
+from raf.testing import randn, check, with_dialect, with_seed
+
+
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize(
+    "shape_axis",
+    [
+        # A single long scan by CUB.
+        [(100000,), 0],
+        [(1, 3000, 1), 1],
+        # Scans of the rows, which are longer and shorter than a tile.
+        [(16, 5000), 1],
+        [(64, 100), -1],
+        # Scans of the columns.
+        [(300, 7), 0],
+        [(4, 50, 33), 1],
+    ],
+)
+@pytest.mark.parametrize("dtype", ["float32", "float16", "int64"])
+@pytest.mark.parametrize("exclusive", [False, True])
+@with_seed(0)
+def test_cumsum(shape_axis, dtype, exclusive):
+    device = "cuda"
+    shape, axis = shape_axis
+
+    class Cumsum(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            return raf.cumsum(x, axis, dtype, exclusive)
+
+    if dtype == "int64":
+        n_x = np.random.randint(-100, 100, size=shape).astype(dtype)
+        m_x = raf.array(n_x, device=device)
+    else:
+        m_x, n_x = randn(shape, device=device, dtype=dtype)
+    m_y = Cumsum()(m_x)
+    n_y = np.cumsum(n_x.astype("float64"), axis=axis)
+    if exclusive:
+        n_y -= n_x
+    if dtype == "int64":
+        check(m_y, n_y.astype(dtype), rtol=0, atol=0)
+    else:
+        # The half precision is accumulated in float, so only the final rounding differs.
+        tol = 1e-2 if dtype == "float16" else 1e-4
+        length = shape[axis]
+        check(m_y, n_y, rtol=tol, atol=tol * np.sqrt(length))
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -0,0 +1,65 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=too-many-locals,too-many-arguments
+import pytest
+import torch.nn.functional as F
+
+import raf
+from raf.testing import randn_torch, run_vm_model, check, with_dialect, with_seed
+
+
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize(
+    "shape_kernel",
+    [
+        [(2, 32, 28, 28), 3],
+        [(4, 16, 15, 17), 5],
+        [(1, 8, 9, 9), 7],
+    ],
+)
+@pytest.mark.parametrize("multiplier", [1, 2])
+@pytest.mark.parametrize("stride_padding_dilation", [(1, 1, 1), (2, 1, 1), (1, 2, 2), (2, 0, 1)])
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+@with_seed(0)
+def test_depthwise_conv2d(shape_kernel, multiplier, stride_padding_dilation, dtype):
+    device = "cuda"
+    shape, kernel = shape_kernel
+    stride, padding, dilation = stride_padding_dilation
+    channels = shape[1]
+
+    class DepthwiseConv(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, w):
+            return raf.conv2d(
+                x, w, stride=stride, padding=padding, dilation=dilation, groups=channels
+            )
+
+    m_x, t_x = randn_torch(shape, device=device, dtype=dtype, requires_grad=True)
+    w_shape = (channels * multiplier, 1, kernel, kernel)
+    m_w, t_w = randn_torch(w_shape, device=device, dtype=dtype, requires_grad=True)
+    model = DepthwiseConv()
+    model.to(device=device)
+    m_y = model(m_x, m_w)
+    v_y = run_vm_model(model, device, [m_x, m_w])
+    t_y = F.conv2d(
+        t_x.float(), t_w.float(), stride=stride, padding=padding, dilation=dilation, groups=channels
+    )
+    tol = 1e-2 if dtype == "float16" else 1e-4
+    check(m_y, t_y, rtol=tol, atol=tol)
+    check(v_y, t_y, rtol=tol, atol=tol)
+
+    m_dy, t_dy = randn_torch(m_y.shape, device=device, dtype=dtype)
+    m_y.backward(m_dy)
+    t_y.backward(t_dy.float())
+    # The weight gradients reduce over the batch and the pixels, which accumulate more error.
+    check(m_x.grad, t_x.grad, rtol=tol, atol=tol)
+    check(m_w.grad, t_w.grad, rtol=tol * 10, atol=tol * 10)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -0,0 +1,75 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=too-many-locals,protected-access,no-self-use
+import numpy as np
+import pytest
+
+import raf
+from raf.testing import randn, randint, run_vm_model, check, with_dialect
+
+
+def np_embedding_dx(n_dy, n_ind, num_weight):
+    n_dx = np.zeros((num_weight, n_dy.shape[-1]), dtype="float32")
+    np.add.at(n_dx, n_ind.reshape(-1), n_dy.reshape(-1, n_dy.shape[-1]).astype("float32"))
+    return n_dx
+
+
+@with_dialect(["cuda"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("num_weight", [7, 1000])
+@pytest.mark.parametrize("hidden", [20, 512])
+@pytest.mark.parametrize("ind_shape", [(4, 64)])
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+def test_embedding_dx(num_weight, hidden, ind_shape, dtype):
+    device = "cuda"
+
+    class EmbeddingDx(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, dy, ind):
+            return raf.embedding_dx(dy, ind, (num_weight, hidden))
+
+    model = EmbeddingDx()
+    m_ind, n_ind = randint(ind_shape, low=0, high=num_weight, device=device)
+    m_dy, n_dy = randn(ind_shape + (hidden,), device=device, dtype=dtype)
+    m_dx = run_vm_model(model, device, [m_dy, m_ind])
+    tol = 1e-4 if dtype == "float32" else 1e-2
+    check(m_dx, np_embedding_dx(n_dy, n_ind, num_weight).astype(dtype), rtol=tol, atol=tol)
+    # The sorted reduction is deterministic.
+    check(run_vm_model(model, device, [m_dy, m_ind]), m_dx, rtol=0, atol=0)
+
+
+@with_dialect(["cuda"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("num_weight", [7, 1000])
+@pytest.mark.parametrize("hidden", [20])
+@pytest.mark.parametrize("ind_shape", [(3, 16)])
+def test_embedding_sparse_dx_sgd(num_weight, hidden, ind_shape):
+    device = "cuda"
+    learning_rate, mu = 0.1, 0.9
+    m_ind, n_ind = randint(ind_shape, low=0, high=num_weight, device=device)
+    m_dy, n_dy = randn(ind_shape + (hidden,), device=device)
+    m_rows, m_values = raf.embedding_sparse_dx(m_dy, m_ind, (num_weight, hidden))
+
+    n_dx = np_embedding_dx(n_dy, n_ind, num_weight)
+    n_rows = np.unique(n_ind)
+    n_pad = m_rows.shape[0] - n_rows.shape[0]
+    check(m_rows, np.concatenate([n_rows, np.full((n_pad,), -1, dtype="int64")]))
+    n_values = np.concatenate([n_dx[n_rows], np.zeros((n_pad, hidden), dtype="float32")])
+    check(m_values, n_values, rtol=1e-4, atol=1e-4)
+
+    # Only the rows in the gradient are updated.
+    m_x, n_x = randn((num_weight, hidden), device=device)
+    m_v, n_v = randn((num_weight, hidden), device=device)
+    raf.sparse_sgd(m_x, m_rows, m_values, m_v, learning_rate, mu)
+    n_v[n_rows] = mu * n_v[n_rows] + n_dx[n_rows]
+    n_x[n_rows] = n_x[n_rows] - learning_rate * n_v[n_rows]
+    check(m_v, n_v, rtol=1e-4, atol=1e-4)
+    check(m_x, n_x, rtol=1e-4, atol=1e-4)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
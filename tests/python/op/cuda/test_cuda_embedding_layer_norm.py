@@ -0,0 +1,73 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=too-many-locals,protected-access,no-self-use
+import numpy as np
+import pytest
+import torch
+
+import raf
+from raf.testing import randn_torch, randint, check, DialectChecker
+
+
+class BertEmbeddings(raf.Model):
+    def build(self, eps):
+        self.eps = eps
+
+    @raf.model.trace
+    def forward(self, tokens, positions, types, w_token, w_pos, w_type, scale, bias):
+        x = raf.add(raf.embedding(w_token, tokens), raf.embedding(w_pos, positions))
+        x = raf.add(x, raf.embedding(w_type, types))
+        return raf.layer_norm(x, scale, bias, axis=-1, eps=self.eps)
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("hidden", [64, 768, 2048])
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+def test_embedding_layer_norm_fusion(hidden, dtype):
+    device = "cuda"
+    batch, seq, vocab = 2, 7, 100
+    eps = 1e-12
+    model = BertEmbeddings(eps)
+    model.to(device=device)
+    m_tokens, n_tokens = randint((batch, seq), low=0, high=vocab, device=device, dtype="int64")
+    # The positions are broadcast along the batch.
+    n_positions = np.arange(seq, dtype="int64").reshape((1, seq))
+    m_positions = raf.array(n_positions, device=device)
+    m_types, n_types = randint((batch, seq), low=0, high=2, device=device, dtype="int64")
+    weights = [
+        randn_torch(shape, device=device, dtype=dtype, requires_grad=True)
+        for shape in [(vocab, hidden), (seq, hidden), (2, hidden), (hidden,), (hidden,)]
+    ]
+    m_weights = [w[0] for w in weights]
+    t_weights = [w[1] for w in weights]
+    args = [m_tokens, m_positions, m_types, *m_weights]
+    m_y = model(*args)
+
+    t_w_token, t_w_pos, t_w_type, t_scale, t_bias = [w.float() for w in t_weights]
+    t_x = (
+        t_w_token[torch.tensor(n_tokens, device=device)]
+        + t_w_pos[torch.tensor(n_positions, device=device)]
+        + t_w_type[torch.tensor(n_types, device=device)]
+    )
+    t_y = torch.nn.functional.layer_norm(t_x, (hidden,), t_scale, t_bias, eps=eps)
+    tol = 1e-4 if dtype == "float32" else 1e-2
+    check(m_y, t_y.to(t_weights[0].dtype), rtol=tol, atol=tol)
+
+    m_dy, t_dy = randn_torch(m_y.shape, device=device, dtype=dtype)
+    m_y.backward(m_dy)
+    t_y.backward(t_dy.float())
+    for m_w, t_w in zip(m_weights, t_weights):
+        check(m_w.grad, t_w.grad, rtol=tol * 10, atol=tol * 10)
+
+    mod = model._internal(*args).mod
+    with raf.device("cuda"):
+        mod = raf._ffi.pass_.ToGraphNormalForm()(mod)
+        mod = raf._ffi.pass_.ToBasicBlockNormalForm()(mod)
+        mod = raf._ffi.pass_.FuseDialect()(mod)
+    DialectChecker("cuda").visit(mod["main"])
+    assert "embedding_layer_norm" in raf.ir.AsText(mod["main"])
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -0,0 +1,97 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+import numpy as np
+import pytest
+
+import raf
+from raf.testing import check, randn, with_dialect
+
+
+def make_indices(shape, high, unique, dtype):
+    # Unique indices take the vectorized copy, and duplicated ones the sorted reduction.
+    num = int(np.prod(shape))
+    if unique:
+        assert num <= high
+        return np.random.permutation(high)[:num].reshape(shape).astype(dtype)
+    return np.random.randint(0, high, size=shape).astype(dtype)
+
+
+@with_dialect(["cuda"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("shape", [[(4, 50, 16), (3, 10)], [(200, 7), (40,)]])
+@pytest.mark.parametrize("axis", [0, 1])
+@pytest.mark.parametrize("unique", [True, False])
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+def test_take_dx(shape, axis, unique, dtype):
+    x_shape, i_shape = shape
+    m_x, n_x = randn(x_shape, device="cuda", dtype=dtype)
+    n_i = make_indices(i_shape, x_shape[axis], unique, "int64")
+    y_shape = x_shape[:axis] + i_shape + x_shape[axis + 1 :]
+    m_dy, n_dy = randn(y_shape, device="cuda", dtype=dtype)
+    m_i = raf.array(n_i, device="cuda")
+    m_dx = raf.take_dx(m_x, m_dy, m_i, axis=axis, mode="clip")
+    n_dx = np.zeros(x_shape, dtype="float32")
+    index = (slice(None),) * axis + (n_i,)
+    np.add.at(n_dx, index, n_dy.astype("float32"))
+    check(m_dx, n_dx, rtol=1e-2 if dtype == "float16" else 1e-5, atol=1e-2)
+
+
+@with_dialect(["cuda"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("axis", [0, 1, 2])
+@pytest.mark.parametrize("itype", ["int32", "int64"])
+def test_gather_dx(axis, itype):
+    x_shape = (6, 7, 8)
+    i_shape = (6, 7, 8)
+    m_x, _ = randn(x_shape, device="cuda")
+    n_i = make_indices(i_shape, x_shape[axis], False, itype)
+    m_dy, n_dy = randn(i_shape, device="cuda")
+    m_i = raf.array(n_i, device="cuda")
+    m_dx = raf.gather_dx(m_x, axis, m_i, m_dy)
+    n_dx = np.zeros(x_shape, dtype="float32")
+    index = list(np.indices(i_shape))
+    index[axis] = n_i
+    np.add.at(n_dx, tuple(index), n_dy)
+    check(m_dx, n_dx, rtol=1e-5, atol=1e-5)
+
+
+@with_dialect(["cuda"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("unique", [True, False])
+def test_gather_nd_dx(unique):
+    x_shape = (10, 9, 32)
+    m_x, _ = randn(x_shape, device="cuda")
+    flat = make_indices((20,), 90, unique, "int64")
+    n_i = np.stack([flat // 9, flat % 9])
+    m_dy, n_dy = randn((20, 32), device="cuda")
+    m_i = raf.array(n_i, device="cuda")
+    m_dx = raf.gather_nd_dx(m_x, m_i, m_dy)
+    n_dx = np.zeros(x_shape, dtype="float32")
+    np.add.at(n_dx, (n_i[0], n_i[1]), n_dy)
+    check(m_dx, n_dx, rtol=1e-5, atol=1e-5)
+
+
+@with_dialect(["cuda"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("unique", [True, False])
+def test_adv_index_dx(unique):
+    # The index tensors of shapes (5, 1) and (3,) are broadcast to (5, 3).
+    x_shape = (8, 6, 4)
+    m_x, _ = randn(x_shape, device="cuda")
+    if unique:
+        n_i0 = np.random.permutation(8)[:5].reshape(5, 1).astype("int64")
+        n_i1 = np.random.permutation(6)[:3].astype("int64")
+    else:
+        n_i0 = np.random.randint(0, 8, size=(5, 1)).astype("int64")
+        n_i1 = np.random.randint(0, 6, size=(3,)).astype("int64")
+    m_dy, n_dy = randn((5, 3, 4), device="cuda")
+    m_inputs = [m_x, raf.array(n_i0, device="cuda"), raf.array(n_i1, device="cuda")]
+    m_dx = raf.adv_index_dx(m_dy, m_inputs)[0]
+    n_dx = np.zeros(x_shape, dtype="float32")
+    np.add.at(n_dx, (n_i0, n_i1), n_dy)
+    check(m_dx, n_dx, rtol=1e-5, atol=1e-5)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -0,0 +1,48 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=too-many-locals,protected-access,no-self-use
+import pytest
+import torch
+
+import raf
+from raf.testing import randn_torch, run_vm_model, check, with_dialect
+
+
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("shape", [(3, 5, 36), (1000, 64), (64, 776), (17, 1024), (8, 2048)])
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+def test_layer_norm_train(shape, dtype):
+    device = "cuda"
+    eps = 1e-5
+
+    class LayerNorm(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, scale, bias):
+            return raf.layer_norm_train(x, scale, bias, axis=-1, eps=eps)
+
+    m_model = LayerNorm()
+    m_model.to(device=device)
+    m_x, t_x = randn_torch(shape, device=device, dtype=dtype)
+    m_scale, t_scale = randn_torch(shape[-1:], device=device, dtype=dtype)
+    m_bias, t_bias = randn_torch(shape[-1:], device=device, dtype=dtype)
+    m_out, m_mean, m_invvar = run_vm_model(m_model, device, [m_x, m_scale, m_bias])
+
+    t_x32 = t_x.float()
+    t_mean = t_x32.mean(dim=-1)
+    t_var = t_x32.var(dim=-1, unbiased=False)
+    t_out = torch.nn.functional.layer_norm(
+        t_x32, shape[-1:], t_scale.float(), t_bias.float(), eps=eps
+    )
+    tol = 1e-4 if dtype == "float32" else 1e-2
+    check(m_out, t_out.to(t_x.dtype), rtol=tol, atol=tol)
+    check(m_mean, t_mean.reshape(m_mean.shape), rtol=1e-4, atol=1e-4)
+    check(m_invvar, torch.rsqrt(t_var + eps).reshape(m_invvar.shape), rtol=1e-3, atol=1e-3)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -0,0 +1,90 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=too-many-locals,protected-access,no-self-use
+import numpy as np
+import pytest
+import torch
+
+import raf
+from raf.testing import randn_torch, check, with_dialect, DialectChecker
+
+
+class MaskedSoftmax(raf.Model):
+    def build(self):
+        pass
+
+    @raf.model.trace
+    def forward(self, x, scale, mask):
+        return raf.softmax(raf.add(raf.multiply(x, scale), mask), axis=-1)
+
+
+def make_mask(kind, shape, dtype):
+    if kind == "causal":
+        # Mask out the future keys of each query in [1, 1, s, s].
+        return np.triu(np.full((1, 1, shape[-2], shape[-1]), -10000.0, dtype=dtype), 1)
+    # Mask out about a quarter of the keys, while keeping at least one key of each row.
+    mask_shape = (shape[0], 1, 1, shape[-1]) if kind == "padding" else shape
+    mask = np.where(np.random.rand(*mask_shape) < 0.25, -10000.0, 0.0)
+    mask[..., 0] = 0
+    return mask.astype(dtype)
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize(
+    "shape,mask_kind",
+    [
+        [(2, 3, 7, 7), "padding"],
+        [(2, 3, 33, 33), "causal"],
+        [(2, 2, 4, 511), "full"],
+        [(1, 2, 3, 5000), "padding"],  # longer than a warp holds
+    ],
+)
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+def test_masked_softmax_fusion(shape, mask_kind, dtype):
+    device = "cuda"
+    model = MaskedSoftmax()
+    model.to(device=device)
+    m_x, t_x = randn_torch(shape, device=device, dtype=dtype, requires_grad=True)
+    np_scale = np.array(0.125, dtype=dtype)
+    np_mask = make_mask(mask_kind, shape, dtype)
+    m_scale = raf.array(np_scale, device=device)
+    m_mask = raf.array(np_mask, device=device)
+    t_mask = torch.tensor(np_mask, device=device)
+
+    m_y = model(m_x, m_scale, m_mask)
+    t_y = torch.softmax(t_x.float() * 0.125 + t_mask.float(), dim=-1)
+    tol = 1e-5 if dtype == "float32" else 1e-2
+    check(m_y, t_y.to(t_x.dtype), rtol=tol, atol=tol)
+
+    m_dy, t_dy = randn_torch(shape, device=device, dtype=dtype)
+    m_y.backward(m_dy)
+    t_y.backward(t_dy.float())
+    check(m_x.grad, t_x.grad, rtol=tol, atol=tol)
+
+    mod = model._internal(m_x, m_scale, m_mask).mod
+    with raf.device("cuda"):
+        mod = raf._ffi.pass_.ToGraphNormalForm()(mod)
+        mod = raf._ffi.pass_.ToBasicBlockNormalForm()(mod)
+        mod = raf._ffi.pass_.FuseDialect()(mod)
+    DialectChecker("cuda").visit(mod["main"])
+    assert "masked_softmax" in raf.ir.AsText(mod["main"])
+
+
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+def test_fully_masked_rows():
+    device = "cuda"
+    model = MaskedSoftmax()
+    model.to(device=device)
+    x = raf.array(np.random.randn(2, 4, 8).astype("float32"), device=device)
+    scale = raf.array(np.array(1.0, dtype="float32"), device=device)
+    mask = np.zeros((2, 4, 8), dtype="float32")
+    mask[:, 0, :] = -np.inf
+    y = model(x, scale, raf.array(mask, device=device)).numpy()
+    check(y[:, 0, :], np.zeros((2, 8), dtype="float32"))
+    check(y[:, 1:, :].sum(axis=-1), np.ones((2, 3), dtype="float32"), rtol=1e-5, atol=1e-5)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
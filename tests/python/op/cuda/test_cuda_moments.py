@@ -0,0 +1,52 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+import numpy as np
+import pytest
+
+import raf
+from raf.testing import check, randn, with_dialect
+
+
+@with_dialect(["cuda"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize(
+    "shape_axis",
+    [
+        # The reduce axis is the innermost, so each row is reduced by a block.
+        ((64, 1000), -1),
+        ((3, 5, 2049), 2),
+        # The reduce axis has an inner axis, so the columns are reduced by the threads.
+        ((4, 1000, 33), 1),
+        ((70000, 3), 0),
+        ((2, 3, 4, 5), (1, 2)),
+        ((17, 300), None),
+    ],
+)
+@pytest.mark.parametrize("keepdims", [True, False])
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+def test_moments(shape_axis, keepdims, dtype):
+    shape, axis = shape_axis
+    # Shift the input, which the single-pass sum of squares would lose the variance to.
+    n_x = (np.random.randn(*shape) + 100).astype(dtype)
+    m_x = raf.array(n_x, device="cuda")
+    n_axis = axis if axis is not None else tuple(range(len(shape)))
+    m_mean, m_var = raf.moments(m_x, axis=n_axis, keepdims=keepdims)
+    n_x = n_x.astype("float64")
+    tol = 1e-2 if dtype == "float16" else 1e-4
+    check(m_mean, np.mean(n_x, axis=n_axis, keepdims=keepdims), rtol=tol, atol=tol)
+    check(m_var, np.var(n_x, axis=n_axis, keepdims=keepdims), rtol=tol * 10, atol=tol * 10)
+
+
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+def test_moments_fallback():
+    # The reduced axes are not consecutive, so the op falls back to TVM.
+    m_x, n_x = randn((4, 5, 6), device="cuda")
+    m_mean, m_var = raf.moments(m_x, axis=(0, 2))
+    check(m_mean, np.mean(n_x, axis=(0, 2)), rtol=1e-4, atol=1e-4)
+    check(m_var, np.var(n_x, axis=(0, 2)), rtol=1e-4, atol=1e-4)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -0,0 +1,68 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access,no-self-use
+import numpy as np
+import pytest
+
+import raf
+from raf.testing import randn, check, with_dialect, DialectChecker
+
+
+class BiasDropoutResidual(raf.Model):
+    def build(self, p):
+        self.p = p
+
+    @raf.model.trace
+    def forward(self, x, bias, residual, key):
+        return raf.add(raf._contrib_philox_dropout(raf.add(x, bias), key, self.p), residual)
+
+
+def run_model(device, x, bias, residual, key, p):
+    model = BiasDropoutResidual(p)
+    model.to(device=device)
+    args = [raf.array(a.numpy(), device=device) for a in [x, bias, residual, key]]
+    args[0].requires_grad = True
+    y = model(*args)
+    dy = raf.array(np.ones(y.shape, dtype=y.dtype), device=device)
+    y.backward(dy)
+    return model, args, y.numpy(), args[0].grad.numpy()
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("shape", [(4, 7, 33), (16, 1024)])
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+def test_philox_dropout_fusion(shape, dtype):
+    p = 0.1
+    x, _ = randn(shape, dtype=dtype)
+    bias, _ = randn(shape[-1:], dtype=dtype)
+    residual, _ = randn(shape, dtype=dtype)
+    key = raf.array(np.array([2022, 3], dtype="uint64"))
+    # The mask is generated by the same Philox RNG on the host and on the GPU.
+    _, _, y_cpu, dx_cpu = run_model("cpu", x, bias, residual, key, p)
+    model, args, y_gpu, dx_gpu = run_model("cuda", x, bias, residual, key, p)
+    tol = 1e-5 if dtype == "float32" else 1e-2
+    check(y_gpu, y_cpu, rtol=tol, atol=tol)
+    check(dx_gpu, dx_cpu, rtol=tol, atol=tol)
+
+    mod = model._internal(*args).mod
+    with raf.device("cuda"):
+        mod = raf._ffi.pass_.ToGraphNormalForm()(mod)
+        mod = raf._ffi.pass_.ToBasicBlockNormalForm()(mod)
+        mod = raf._ffi.pass_.FuseDialect()(mod)
+    DialectChecker("cuda").visit(mod["main"])
+
+
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+def test_philox_dropout_rate():
+    p = 0.25
+    x = raf.array(np.ones((1000, 1000), dtype="float32"), device="cuda")
+    key = raf.array(np.array([0, 0], dtype="uint64"), device="cuda")
+    y = raf._contrib_philox_dropout(x, key, p).numpy()
+    assert abs(np.mean(y == 0) - p) < 0.01
+    check(y[y != 0], 1 / (1 - p))
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -0,0 +1,107 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=too-many-arguments
+import pytest
+import torch
+
+import raf
+from raf.testing import randn_torch, run_vm_model, check, with_dialect, with_seed
+
+
+POOL_FUNCS = [
+    [raf._op.sym.max_pool2d, torch.nn.functional.max_pool2d],
+    [raf._op.sym.avg_pool2d, torch.nn.functional.avg_pool2d],
+]
+ADAPTIVE_POOL_FUNCS = [
+    [raf._op.sym.adaptive_max_pool2d, torch.nn.functional.adaptive_max_pool2d],
+    [raf._op.sym.adaptive_avg_pool2d, torch.nn.functional.adaptive_avg_pool2d],
+]
+
+
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("shape", [(4, 64, 7, 7), (3, 5, 9, 11), (2, 8, 4, 4)])
+@pytest.mark.parametrize("layout", ["NCHW", "NHWC"])
+@pytest.mark.parametrize("adaptive", [False, True])
+@pytest.mark.parametrize("is_max", [False, True])
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+@with_seed(0)
+def test_global_pool2d(shape, layout, adaptive, is_max, dtype):
+    raf_fwd, torch_fwd = (ADAPTIVE_POOL_FUNCS if adaptive else POOL_FUNCS)[int(not is_max)]
+    kernel = shape[2:]
+
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            if adaptive:
+                return raf_fwd(x, (1, 1), layout=layout)
+            return raf_fwd(x, kernel=kernel, stride=kernel, padding=0, layout=layout)
+
+    m_x, t_x = randn_torch(shape, device="cuda", dtype=dtype)
+    if layout == "NHWC":
+        m_x = raf.array(t_x.permute(0, 2, 3, 1).contiguous().cpu().numpy(), device="cuda")
+    m_y = run_vm_model(TestModel(), "cuda", [m_x], disable_fusion=True)
+    t_y = torch_fwd(t_x.float(), (1, 1)) if adaptive else torch_fwd(t_x.float(), kernel)
+    if layout == "NHWC":
+        t_y = t_y.permute(0, 2, 3, 1)
+    tol = 1e-2 if dtype == "float16" else 1e-5
+    check(m_y, t_y, rtol=tol, atol=tol)
+
+
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("shape", [(2, 16, 14, 14), (3, 3, 9, 8)])
+@pytest.mark.parametrize("kernel_stride_padding", [(3, 2, 1), (2, 2, 0), (3, 1, 1)])
+@pytest.mark.parametrize("is_max", [False, True])
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+@with_seed(0)
+def test_pool2d_nhwc(shape, kernel_stride_padding, is_max, dtype):
+    kernel, stride, padding = kernel_stride_padding
+    raf_fwd, torch_fwd = POOL_FUNCS[int(not is_max)]
+
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            return raf_fwd(x, kernel=kernel, stride=stride, padding=padding, layout="NHWC")
+
+    _, t_x = randn_torch(shape, device="cuda", dtype=dtype)
+    m_x = raf.array(t_x.permute(0, 2, 3, 1).contiguous().cpu().numpy(), device="cuda")
+    m_y = run_vm_model(TestModel(), "cuda", [m_x], disable_fusion=True)
+    t_y = torch_fwd(t_x.float(), kernel_size=kernel, stride=stride, padding=padding)
+    tol = 1e-2 if dtype == "float16" else 1e-5
+    check(m_y, t_y.permute(0, 2, 3, 1), rtol=tol, atol=tol)
+
+
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("shape", [(2, 16, 14, 14), (3, 3, 9, 8)])
+@pytest.mark.parametrize("out_shape", [(2, 2), (4, 3)])
+@pytest.mark.parametrize("is_max", [False, True])
+@with_seed(0)
+def test_adaptive_pool2d_nhwc(shape, out_shape, is_max):
+    raf_fwd, torch_fwd = ADAPTIVE_POOL_FUNCS[int(not is_max)]
+
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            return raf_fwd(x, out_shape, layout="NHWC")
+
+    _, t_x = randn_torch(shape, device="cuda")
+    m_x = raf.array(t_x.permute(0, 2, 3, 1).contiguous().cpu().numpy(), device="cuda")
+    m_y = run_vm_model(TestModel(), "cuda", [m_x], disable_fusion=True)
+    t_y = torch_fwd(t_x, out_shape)
+    check(m_y, t_y.permute(0, 2, 3, 1), rtol=1e-5, atol=1e-5)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
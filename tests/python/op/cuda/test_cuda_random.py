@@ -0,0 +1,61 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+import numpy as np
+import pytest
+from tvm import relay
+
+import raf
+from raf._op.dialect import DialectPreference
+from raf.testing import check
+
+
+def make_key(seed, counter=None, path=None):
+    key = relay.random.threefry_key(seed).data.numpy()
+    if counter is not None:
+        key[7] = counter
+    if path is not None:
+        key[8], key[9] = path
+    return raf.array(key, dtype="uint64", device="cuda")
+
+
+def run_with_dialect(dialect, func, *args):
+    with DialectPreference([dialect]):
+        return [out.numpy() for out in func(*args)]
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("shape", [(4, 4), (100,), (3, 5, 7), (1 << 16,)])
+@pytest.mark.parametrize(
+    "counter_path",
+    [
+        (None, None),
+        # The counter overflows, so the path is extended.
+        ((1 << 64) - 8, (1 << 63, 0)),
+        ((1 << 64) - 8, (1, 0)),
+        # The counter overflows and the path is full, so the key is rehashed.
+        ((1 << 64) - 8, (0, 0)),
+    ],
+)
+def test_threefry_generate(shape, counter_path):
+    key = make_key(23, *counter_path)
+    ref = run_with_dialect("tvm", raf.threefry_generate, key, shape)
+    out = run_with_dialect("cuda", raf.threefry_generate, key, shape)
+    for ref_field, out_field in zip(ref, out):
+        check(out_field, ref_field, rtol=0, atol=0)
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("path", [None, (1 << 63, 0), (1, 0), (0, 1 << 5), (0, 0)])
+def test_threefry_split(path):
+    key = make_key(7, path=path)
+    ref = run_with_dialect("tvm", raf.threefry_split, key)
+    out = run_with_dialect("cuda", raf.threefry_split, key)
+    for ref_field, out_field in zip(ref, out):
+        check(out_field, ref_field, rtol=0, atol=0)
+    # The two halves must differ.
+    assert not np.array_equal(out[0], out[1])
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
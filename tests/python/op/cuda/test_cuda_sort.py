@@ -0,0 +1,66 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=too-many-arguments
+import numpy as np
+import pytest
+
+import raf
+from raf.testing import check, with_dialect
+
+
+def distinct(shape, dtype):
+    # The values of each row are distinct, so the order is unique regardless of the tie-breaking.
+    if dtype == "float16" and shape[-1] > 2048:
+        pytest.skip("float16 cannot represent more than 2048 distinct integers exactly")
+    rows = int(np.prod(shape[:-1]))
+    x = np.stack([np.random.permutation(shape[-1]) for _ in range(rows)])
+    return x.reshape(shape).astype(dtype)
+
+
+@with_dialect(["cuda"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("shape", [(3000,), (64, 257), (4, 8, 1000)])
+@pytest.mark.parametrize("dtype", ["float32", "float16", "int32", "int64"])
+@pytest.mark.parametrize("is_ascend", [True, False])
+def test_sort(shape, dtype, is_ascend):
+    n_x = distinct(shape, dtype)
+    m_x = raf.array(n_x, device="cuda")
+    n_idx = np.argsort(n_x, axis=-1, kind="stable")
+    if not is_ascend:
+        n_idx = np.flip(n_idx, axis=-1)
+    m_idx = raf.argsort(m_x, is_ascend=is_ascend, dtype="int64")
+    check(m_idx, n_idx)
+    check(raf.sort(m_x, is_ascend=is_ascend), np.take_along_axis(n_x, n_idx, axis=-1))
+
+
+@with_dialect(["cuda"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("shape", [(5000,), (40, 3001), (2, 3, 17)])
+@pytest.mark.parametrize("k", [1, 5, 17, 600])
+@pytest.mark.parametrize("dtype", ["float32", "float16", "int64"])
+@pytest.mark.parametrize("is_ascend", [True, False])
+def test_topk(shape, k, dtype, is_ascend):
+    k = min(k, shape[-1])
+    n_x = distinct(shape, dtype)
+    m_x = raf.array(n_x, device="cuda")
+    n_idx = np.argsort(n_x if is_ascend else -n_x.astype("float64"), axis=-1)[..., :k]
+    m_values, m_idx = raf.topk(m_x, k, ret_type="both", is_ascend=is_ascend, dtype="int32")
+    check(m_idx, n_idx)
+    check(m_values, np.take_along_axis(n_x, n_idx, axis=-1))
+    check(raf.topk(m_x, k, ret_type="indices", is_ascend=is_ascend), n_idx)
+
+
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+def test_sort_fallback():
+    # The sort along a non-trailing axis and the top-k of a large k fall back to TVM.
+    n_x = distinct((6, 2000), "float32")
+    m_x = raf.array(n_x, device="cuda")
+    check(raf.argsort(m_x, axis=0), np.argsort(n_x, axis=0))
+    n_idx = np.argsort(-n_x, axis=-1)[..., :1500]
+    check(raf.topk(m_x, 1500, ret_type="indices"), n_idx)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -0,0 +1,77 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+import numpy as np
+import pytest
+
+import raf
+from raf.testing import randn, check, with_dialect, with_seed
+
+
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize(
+    "shape_axes",
+    [
+        [(64, 48), (1, 0)],
+        [(2, 33, 4, 17), (0, 2, 1, 3)],
+        [(2, 33, 4, 17), (0, 2, 3, 1)],
+        [(3, 1, 5, 7, 2), (4, 2, 1, 0, 3)],
+        [(8, 1, 31), (2, 1, 0)],
+        [(4, 1, 6), (1, 0, 2)],
+        [(5, 6, 7), None],
+    ],
+)
+@pytest.mark.parametrize("dtype", ["float32", "float16", "int64"])
+@with_seed(0)
+def test_transpose(shape_axes, dtype):
+    device = "cuda"
+    shape, axes = shape_axes
+
+    class Transpose(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            return raf.transpose(x, axes)
+
+    m_x, n_x = randn(shape, device=device, dtype=dtype, requires_grad=dtype != "int64")
+    model = Transpose()
+    m_y = model(m_x)
+    check(m_y, np.transpose(n_x, axes), rtol=0, atol=0)
+    if dtype == "int64":
+        return
+    m_dy, n_dy = randn(m_y.shape, device=device, dtype=dtype)
+    m_y.backward(m_dy)
+    inverse = None if axes is None else np.argsort(axes)
+    check(m_x.grad, np.transpose(n_dy, inverse), rtol=0, atol=0)
+
+
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("shape_axes", [[(2, 16, 8, 64), (1, 2)], [(3, 4, 5), (0, 2)]])
+@with_seed(0)
+def test_swap_axis(shape_axes):
+    device = "cuda"
+    shape, (axis1, axis2) = shape_axes
+
+    class SwapAxis(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            return raf.swap_axis(x, axis1, axis2)
+
+    m_x, n_x = randn(shape, device=device, requires_grad=True)
+    model = SwapAxis()
+    m_y = model(m_x)
+    check(m_y, np.swapaxes(n_x, axis1, axis2), rtol=0, atol=0)
+    m_dy, n_dy = randn(m_y.shape, device=device)
+    m_y.backward(m_dy)
+    check(m_x.grad, np.swapaxes(n_dy, axis1, axis2), rtol=0, atol=0)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
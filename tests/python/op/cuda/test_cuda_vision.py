@@ -0,0 +1,202 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=too-many-locals,too-many-arguments
+import numpy as np
+import pytest
+import torch
+import torchvision
+
+import raf
+from raf.testing import check, with_dialect
+
+import tvm.topi.testing
+
+
+def np_get_valid_counts(data, score_threshold, id_index, score_index):
+    batch_size, num_anchors, _ = data.shape
+    valid_count = np.zeros((batch_size,), dtype="int32")
+    out = np.full(data.shape, -1, dtype=data.dtype)
+    out_indices = np.full((batch_size, num_anchors), -1, dtype="int32")
+    for i in range(batch_size):
+        for j in range(num_anchors):
+            box = data[i, j]
+            if box[score_index] > score_threshold and (id_index < 0 or box[id_index] >= 0):
+                out[i, valid_count[i]] = box
+                out_indices[i, valid_count[i]] = j
+                valid_count[i] += 1
+    return valid_count, out, out_indices
+
+
+def np_iou(box_a, box_b):
+    a_l, a_r = sorted([box_a[0], box_a[2]])
+    a_t, a_b = sorted([box_a[1], box_a[3]])
+    b_l, b_r = sorted([box_b[0], box_b[2]])
+    b_t, b_b = sorted([box_b[1], box_b[3]])
+    w = max(0.0, min(a_r, b_r) - max(a_l, b_l))
+    h = max(0.0, min(a_b, b_b) - max(a_t, b_t))
+    inter = w * h
+    union = (a_r - a_l) * (a_b - a_t) + (b_r - b_l) * (b_b - b_t) - inter
+    return 0.0 if union <= 0 else inter / union
+
+
+def np_nms(data, valid_count, indices, max_output_size, iou_threshold, force_suppress, top_k):
+    """The greedy NMS, which returns the selected sorted positions of each batch."""
+    selected = []
+    for i in range(data.shape[0]):
+        scores = data[i, : valid_count[i], 1]
+        order = np.argsort(-scores, kind="stable")
+        if top_k > 0:
+            order = order[:top_k]
+        kept = []
+        for j, pos in enumerate(order):
+            if 0 < max_output_size <= len(kept):
+                break
+            box = data[i, pos]
+            if box[1] <= 0 or box[0] < 0:
+                continue
+            suppressed = any(
+                (force_suppress or data[i, order[k], 0] == box[0])
+                and np_iou(data[i, order[k], 2:6], box[2:6]) >= iou_threshold
+                for k in kept
+            )
+            if not suppressed:
+                kept.append(j)
+        selected.append((order, kept))
+    return selected
+
+
+@with_dialect(["cuda"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("shape", [(1, 2500, 6), (16, 500, 5), (3, 1000, 6)])
+@pytest.mark.parametrize("id_index", [0, -1])
+def test_get_valid_counts(shape, id_index):
+    np_data = np.random.uniform(-0.5, 1, size=shape).astype("float32")
+    m_data = raf.array(np_data, device="cuda")
+    m_thr = raf.array(np.array(0.5, dtype="float32"), device="cuda")
+    m_count, m_out, m_indices = raf.get_valid_counts(m_data, m_thr, id_index, 1)
+    n_count, n_out, n_indices = np_get_valid_counts(np_data, 0.5, id_index, 1)
+    check(m_count, n_count)
+    check(m_out, n_out)
+    check(m_indices, n_indices)
+
+
+@with_dialect(["cuda"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("shape", [(1, 5, 6), (2, 100, 6), (4, 1000, 6)])
+@pytest.mark.parametrize(
+    "attrs",
+    [
+        # force_suppress, top_k, max_output_size
+        (False, -1, -1),
+        (True, -1, -1),
+        (False, 50, 10),
+    ],
+)
+@pytest.mark.parametrize("return_indices", [True, False])
+def test_nms(shape, attrs, return_indices):
+    force_suppress, top_k, max_output_size = attrs
+    batch_size, num_anchors, _ = shape
+    np_data = np.zeros(shape, dtype="float32")
+    np_data[:, :, 0] = np.random.randint(-1, 3, size=shape[:2])
+    np_data[:, :, 1] = np.random.uniform(-0.2, 1, size=shape[:2])
+    corners = np.random.uniform(0, 100, size=shape[:2] + (2,))
+    sizes = np.random.uniform(5, 30, size=shape[:2] + (2,))
+    np_data[:, :, 2:4] = corners
+    np_data[:, :, 4:6] = corners + sizes
+    np_valid_count = np.random.randint(0, num_anchors + 1, size=(batch_size,)).astype("int32")
+    np_indices = np.stack(
+        [np.random.permutation(num_anchors) for _ in range(batch_size)]
+    ).astype("int32")
+    m_args = [
+        raf.array(np_data, device="cuda"),
+        raf.array(np_valid_count, device="cuda"),
+        raf.array(np_indices, device="cuda"),
+        raf.array(np.array(max_output_size, dtype="int32"), device="cuda"),
+        raf.array(np.array(0.5, dtype="float32"), device="cuda"),
+    ]
+    m_out = raf.non_max_suppression(
+        *m_args, force_suppress=force_suppress, top_k=top_k, return_indices=return_indices
+    )
+    selected = np_nms(
+        np_data, np_valid_count, np_indices, max_output_size, 0.5, force_suppress, top_k
+    )
+    if return_indices:
+        n_indices = np.full((batch_size, num_anchors), -1, dtype="int32")
+        n_count = np.zeros((batch_size, 1), dtype="int32")
+        for i, (order, kept) in enumerate(selected):
+            n_indices[i, : len(kept)] = np_indices[i, order[kept]]
+            n_count[i] = len(kept)
+        check(m_out[0], n_indices)
+        check(m_out[1], n_count)
+    else:
+        # The selected boxes stay at their sorted positions.
+        n_out = np.full(shape, -1, dtype="float32")
+        for i, (order, kept) in enumerate(selected):
+            n_out[i, kept] = np_data[i, order[kept]]
+        check(m_out, n_out)
+
+
+@with_dialect(["cuda"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize(
+    "config",
+    [
+        ((1, 4, 16, 16), (32, 5), (7, 7), 1.0, -1),
+        ((4, 70, 16, 16), (32, 5), (7, 7), 0.5, 2),
+        # The samples of a ROI exceed the shared memory tables, so they are computed on the fly.
+        ((2, 3, 300, 300), (4, 5), (100, 100), 1.0, 8),
+    ],
+)
+@pytest.mark.parametrize("mode", ["avg", "max"])
+@pytest.mark.parametrize("layout", ["NCHW", "NHWC"])
+def test_roi_align(config, mode, layout):
+    data_shape, rois_shape, pooled_size, spatial_scale, sample_ratio = config
+    if layout == "NHWC":
+        data_shape = (data_shape[0], data_shape[2], data_shape[3], data_shape[1])
+        ref_func = tvm.topi.testing.roi_align_nhwc_python
+    else:
+        ref_func = tvm.topi.testing.roi_align_nchw_python
+    in_size = data_shape[2]
+    np_data = np.random.uniform(size=data_shape).astype("float32")
+    np_rois = np.random.uniform(size=rois_shape).astype("float32") * in_size
+    np_rois[:, 0] = np.random.randint(low=0, high=data_shape[0], size=rois_shape[0])
+    np_res = ref_func(
+        np_data,
+        np_rois,
+        pooled_size=pooled_size,
+        spatial_scale=spatial_scale,
+        sample_ratio=sample_ratio,
+        mode=mode,
+    )
+    m_data = raf.array(np_data, device="cuda")
+    m_rois = raf.array(np_rois, device="cuda")
+    m_out = raf.roi_align(m_data, m_rois, pooled_size, spatial_scale, sample_ratio, layout, mode)
+    check(m_out, np_res, rtol=1e-5, atol=1e-5)
+    if mode != "avg":
+        return
+
+    np_dy = np.random.randn(*m_out.shape).astype("float32")
+    m_dx = raf.roi_align_dx(
+        m_data,
+        m_rois,
+        raf.array(np_dy, device="cuda"),
+        pooled_size,
+        spatial_scale,
+        sample_ratio,
+        layout,
+        mode,
+    )
+    t_data = torch.tensor(np_data if layout == "NCHW" else np_data.transpose(0, 3, 1, 2))
+    t_data.requires_grad = True
+    t_y = torchvision.ops.roi_align(
+        t_data, torch.tensor(np_rois), pooled_size, spatial_scale, sample_ratio
+    )
+    t_dy = torch.tensor(np_dy if layout == "NCHW" else np_dy.transpose(0, 3, 1, 2))
+    t_y.backward(t_dy)
+    t_dx = t_data.grad.numpy()
+    check(m_dx, t_dx if layout == "NCHW" else t_dx.transpose(0, 2, 3, 1), rtol=1e-4, atol=1e-4)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
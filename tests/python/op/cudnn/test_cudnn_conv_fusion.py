@@ -0,0 +1,63 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=too-many-locals,too-many-arguments,protected-access,no-member
+# pylint: disable=attribute-defined-outside-init
+import pytest
+import torch.nn.functional as F
+
+import raf
+from raf._op.dialect_pattern import _with_cudnn_graph_api
+from raf.testing import randn_torch, run_vm_model, check, DialectChecker
+
+
+def verify_ir(mod):
+    with raf.device("cuda"):
+        mod = raf._ffi.pass_.ToGraphNormalForm()(mod)
+        mod = raf._ffi.pass_.ToBasicBlockNormalForm()(mod)
+        mod = raf._ffi.pass_.FuseDialect()(mod)
+        DialectChecker("cudnn").visit(mod["main"])
+
+
+@pytest.mark.skipif(not _with_cudnn_graph_api(), reason="cuDNN graph API is not available")
+@pytest.mark.parametrize("xshape", [(4, 16, 14, 14)])
+@pytest.mark.parametrize("wshape", [(32, 16, 3, 3), (32, 4, 1, 1)])
+@pytest.mark.parametrize("stride", [1, 2])
+@pytest.mark.parametrize("with_bias", [False, True])
+@pytest.mark.parametrize("with_relu", [False, True])
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+def test_conv2d_bias_relu(xshape, wshape, stride, with_bias, with_relu, dtype):
+    if not with_bias and not with_relu:
+        pytest.skip("A single conv2d is not fused")
+    groups = xshape[1] // wshape[1]
+    padding = wshape[2] // 2
+
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, w, bias):  # pylint: disable=no-self-use
+            x = raf.conv2d(x, w, stride=stride, padding=padding, groups=groups)
+            x = raf.add(x, bias) if with_bias else x
+            x = raf.relu(x) if with_relu else x
+            return x
+
+    device = "cuda"
+    m_x, t_x = randn_torch(xshape, device=device, dtype=dtype)
+    m_w, t_w = randn_torch(wshape, device=device, std=0.1, dtype=dtype)
+    m_bias, t_bias = randn_torch((wshape[0], 1, 1), device=device, dtype=dtype)
+    model = TestModel()
+    model.to(device=device)
+    mod = model._internal(m_x, m_w, m_bias).mod
+    verify_ir(mod)
+    m_y = run_vm_model(model, device, [m_x, m_w, m_bias])
+    t_y = F.conv2d(t_x, t_w, stride=stride, padding=padding, groups=groups)
+    t_y = t_y + t_bias if with_bias else t_y
+    t_y = F.relu(t_y) if with_relu else t_y
+    tol = 1e-4 if dtype == "float32" else 1e-2
+    check(m_y, t_y, rtol=tol, atol=tol)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
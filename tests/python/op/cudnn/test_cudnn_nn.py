@@ -52,6 +52,37 @@ def test_raf_conv2d(xshape, wshape, stride, dilation, padding, dtype):
     check(m_w.grad, t_w.grad, rtol=rtol, atol=atol)
 
 
+@with_dialect(["cudnn", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("workspace_limit", [0, 1 << 20])
+def test_raf_conv2d_workspace_limit(workspace_limit):
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, w):
+            return raf.conv2d(x, w, stride=1, padding=1, dilation=1, groups=1)
+
+    model = TestModel()
+    m_x, t_x = randn_torch((8, 32, 28, 28), device="cuda", std=0.01, requires_grad=True)
+    m_w, t_w = randn_torch((64, 32, 3, 3), device="cuda", std=0.01, requires_grad=True)
+    cudnn_config = raf._core.backends.cudnn
+    old_limit = cudnn_config.workspace_limit
+    cudnn_config.workspace_limit = workspace_limit
+    try:
+        m_y = model(m_x, m_w)
+        t_y = F.conv2d(t_x, t_w, stride=1, padding=1)
+        check(m_y, t_y, rtol=1e-4, atol=1e-4)
+        m_dy, t_dy = randn_torch(t_y.shape, device="cuda")
+        m_y.backward(m_dy)
+        t_y.backward(t_dy)
+        check(m_x.grad, t_x.grad, rtol=1e-4, atol=1e-4)
+        check(m_w.grad, t_w.grad, rtol=1e-4, atol=1e-4)
+    finally:
+        cudnn_config.workspace_limit = old_limit
+
+
 @with_dialect(["cudnn", "tvm"])
 @pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
 @pytest.mark.parametrize(
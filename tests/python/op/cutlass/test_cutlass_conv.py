@@ -81,5 +81,44 @@ def test_conv2d_relu(shapes, stride, dilation, padding):
     check(m_y, t_y, rtol=1e-4, atol=1e-4)
 
 
+@pytest.mark.skipif(not raf.build.with_cutlass(), reason="CUTLASS is not enabled")
+@pytest.mark.parametrize(
+    "shapes",
+    [
+        ((4, 64, 16, 16), (64, 64, 3, 3)),
+        ((8, 32, 14, 14), (128, 32, 1, 1)),
+    ],
+)
+@pytest.mark.parametrize("stride", [1, 2])
+@pytest.mark.parametrize("padding", [0, 1])
+def test_conv2d_dxw(shapes, stride, padding):
+    device, dtype = "cuda", "float16"
+    xshape, wshape = shapes
+
+    class Conv2DDxw(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, w, y, dy):
+            dx = raf.conv2d_dx(w, y, dy, xshape, stride, padding, 1, 1)
+            dw = raf.conv2d_dw(x, y, dy, wshape, stride, padding, 1, 1)
+            return dx, dw
+
+    m_x, t_x = randn_torch(xshape, device=device, dtype=dtype)
+    m_w, t_w = randn_torch(wshape, device=device, dtype=dtype)
+    t_y = F.conv2d(t_x, t_w, stride=stride, padding=padding)
+    m_y, _ = randn_torch(t_y.shape, device=device, dtype=dtype)
+    m_dy, t_dy = randn_torch(t_y.shape, device=device, dtype=dtype)
+    model = Conv2DDxw()
+    mod = model._internal(m_x, m_w, m_y, m_dy).mod
+    verify_ir(mod)
+    m_dx, m_dw = run_vm_model(model, device, [m_x, m_w, m_y, m_dy])
+    t_dx = torch.nn.grad.conv2d_input(xshape, t_w, t_dy, stride=stride, padding=padding)
+    t_dw = torch.nn.grad.conv2d_weight(t_x, wshape, t_dy, stride=stride, padding=padding)
+    check(m_dx, t_dx, rtol=1e-2, atol=1e-2)
+    check(m_dw, t_dw, rtol=1e-2, atol=1e-1)
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
@@ -4,6 +4,7 @@
 # pylint: disable=attribute-defined-outside-init,no-member,protected-access
 import pytest
 import numpy as np
+import tvm
 
 import raf
 from raf.testing import check, run_vm_model, randn, get_testable_devices
@@ -54,12 +55,11 @@ def test_numel(shape, device):
     n_y = np.array(n_x.size, dtype="int32")
     assert m_y.shape == n_y.shape
     assert (m_y.numpy() == n_y).all()
-    # traced
-    if device != "cuda":  # TODO: vm not support heterogeneous now
-        model = Model()
-        v_y = run_vm_model(model, device, [m_x], opt_level=1)
-        assert v_y.shape == n_y.shape
-        assert (v_y.numpy() == n_y).all()
+    # traced, where the output is computed on the host even if the input is on the device
+    model = Model()
+    v_y = run_vm_model(model, device, [m_x], opt_level=1)
+    assert v_y.shape == n_y.shape
+    assert (v_y.numpy() == n_y).all()
 
 
 @pytest.mark.parametrize("shape", [[5, 3], [5, 3, 2], [5, 2, 2, 2]])
@@ -80,12 +80,11 @@ def test_shape_as_tensor(shape, device):
     n_y = np.array(n_x.shape, dtype="int32")
     assert m_y.shape == n_y.shape
     assert (m_y.numpy() == n_y).all()
-    # traced
-    if device != "cuda":  # TODO: vm not support heterogeneous now
-        model = Model()
-        v_y = run_vm_model(model, device, [m_x], opt_level=1)
-        assert v_y.shape == n_y.shape
-        assert (v_y.numpy() == n_y).all()
+    # traced, where the output is computed on the host even if the input is on the device
+    model = Model()
+    v_y = run_vm_model(model, device, [m_x], opt_level=1)
+    assert v_y.shape == n_y.shape
+    assert (v_y.numpy() == n_y).all()
 
 
 @pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
@@ -151,5 +150,33 @@ def test_async_device_copy():
     check(out, ref_out)
 
 
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.skipif(not tvm.cuda(1).exist, reason="Peer copies need two GPUs")
+def test_peer_device_copy():
+    shape = (4, 4)
+
+    class Model(raf.model.Model):
+        # pylint: disable=no-self-use
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, data):
+            a_1 = raf.exp(data)
+            a_2 = raf.device_copy(a_1, "cuda(0)", "cuda(1)")
+            a_3 = raf.exp(a_2)
+            a_4 = raf.device_copy(a_3, "cuda(1)", "cuda(0)")
+            return raf.add(a_4, a_1)
+
+    data, data_np = randn(shape, device="cuda", positive=True)
+
+    model = Model()
+    # The exp between the copies runs on the second GPU.
+    out = run_vm_model(model, "cuda", [data], multi_device=True)
+    ref_out = np.exp(np.exp(data_np)) + np.exp(data_np)
+    check(out, ref_out)
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
@@ -157,5 +157,52 @@ def test_logic_ops(ops, shape, dtype, device):
     verify_op(m_op, [m_x1, m_x2], device, t_y)
 
 
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_symbolic_batch(device):
+    model = BinaryModel(raf._op.sym.add)
+    cache = "tvm_cpu" if device == "cpu" else "tvm_cuda"
+
+    def num_misses():
+        return raf._ffi.cache.DumpTVMCacheMetric(cache)["CacheMiss"]
+
+    with raf.ir.PassContext(config={"raf.tvm.symbolic_batch": True}):
+        misses = num_misses()
+        for batch in [2, 4, 8]:
+            m_x1, t_x1 = randn_torch((batch, 7, 5), device=device)
+            m_x2, t_x2 = randn_torch((7, 5), device=device)
+            check(model(m_x1, m_x2), t_x1 + t_x2)
+        # The kernel is built once and shared by all batch sizes.
+        assert num_misses() - misses <= 1
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+@pytest.mark.parametrize(
+    "shapes",
+    [
+        # The innermost axis is vectorized, with the other input broadcast along the outer axes.
+        ((8, 64), (64,)),
+        ((2, 3, 32), (2, 1, 32)),
+        # Broadcast along the innermost axis, whose vector loads become scalar broadcasts.
+        ((4, 16), (4, 1)),
+        # The innermost axis is not divisible by the vector width.
+        ((5, 6), (6,)),
+    ],
+)
+@pytest.mark.parametrize("ops", [(torch.add, raf._op.sym.add), (torch.mul, raf._op.sym.multiply)])
+@pytest.mark.parametrize("dtype", ["float16", "float32"])
+@pytest.mark.parametrize("symbolic", [False, True])
+def test_broadcast_vectorize(device, shapes, ops, dtype, symbolic):
+    if dtype == "float16" and device == "cpu":
+        return
+    t_op, m_op = ops
+    model = BinaryModel(m_op)
+    m_x1, t_x1 = randn_torch(shapes[0], dtype=dtype, device=device)
+    m_x2, t_x2 = randn_torch(shapes[1], dtype=dtype, device=device)
+    with raf.ir.PassContext(config={"raf.tvm.symbolic_batch": symbolic}):
+        m_y = model(m_x1, m_x2)
+    tol = 1e-5 if dtype == "float32" else 1e-3
+    check(m_y, t_op(t_x1, t_x2), rtol=tol, atol=tol)
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
@@ -160,6 +160,9 @@ def test_sgd(shape):
 
     np.testing.assert_allclose(m_v1.numpy(), n_v1, 1e-4, 1e-4)
     np.testing.assert_allclose(m_x1.numpy(), n_x1, 1e-4, 1e-4)
+    # The weight and the momentum are updated in place.
+    np.testing.assert_allclose(v0.numpy(), n_v1, 1e-4, 1e-4)
+    np.testing.assert_allclose(x0.numpy(), n_x1, 1e-4, 1e-4)
 
 
 if __name__ == "__main__":
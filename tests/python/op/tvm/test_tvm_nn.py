@@ -708,6 +708,52 @@ def test_raf_batch_norm_train(shape, momentum, eps, device):
     check(m_b.grad, t_b.grad, rtol=1e-4, atol=1e-4)
 
 
+@with_dialect("tvm")
+@pytest.mark.parametrize("device", get_testable_devices())
+@pytest.mark.parametrize("shape", [[8, 8, 8, 8], [4, 6, 5]])
+@pytest.mark.parametrize("residual", [False, True])
+@with_seed(0)
+def test_raf_batch_norm_add_relu_train(shape, residual, device):
+    momentum, eps = 0.1, 1e-5
+    stats_shape = [shape[1]]
+    m_x, t_x = randn_torch(shape, device=device, requires_grad=True)
+    m_z, t_z = randn_torch(shape, device=device, requires_grad=True)
+    m_m, t_m = randn_torch(stats_shape, device=device)
+    m_v, t_v = randn_torch(stats_shape, device=device, positive=True)
+    m_w, t_w = randn_torch(stats_shape, device=device, requires_grad=True)
+    m_b, t_b = randn_torch(stats_shape, device=device, requires_grad=True)
+
+    class TestModel(raf.Model):
+        def build(self, m_m, m_v):
+            self.m_m = m_m
+            self.m_v = m_v
+
+        @raf.model.trace
+        def forward(self, m_x, m_w, m_b, m_z):  # pylint: disable=too-many-arguments
+            result = raf._contrib_batch_norm_add_relu_train(
+                m_x, self.m_m, self.m_v, m_w, m_b, m_z if residual else None, momentum, eps
+            )
+            trace_mutate_attr(self, "m_m", result[1])
+            trace_mutate_attr(self, "m_v", result[2])
+            return result[0]
+
+    model = TestModel(m_m, m_v)
+    m_y = model(m_x, m_w, m_b, m_z)
+    t_y = F.batch_norm(t_x, t_m, t_v, t_w, t_b, True, momentum, eps)
+    t_y = F.relu(t_y + t_z if residual else t_y)
+    check(m_y, t_y, rtol=1e-4, atol=1e-4)
+    check(m_m, t_m, rtol=1e-4, atol=1e-4)
+    check(m_v, t_v, rtol=1e-4, atol=1e-4)
+    m_dy, t_dy = randn_torch(shape, device=device)
+    m_y.backward(m_dy)
+    t_y.backward(t_dy)
+    check(m_x.grad, t_x.grad, rtol=1e-4, atol=1e-4)
+    check(m_w.grad, t_w.grad, rtol=1e-4, atol=1e-4)
+    check(m_b.grad, t_b.grad, rtol=1e-4, atol=1e-4)
+    if residual:
+        check(m_z.grad, t_z.grad, rtol=1e-4, atol=1e-4)
+
+
 @with_dialect("tvm")
 @pytest.mark.parametrize("device", get_testable_devices())
 @pytest.mark.parametrize("dtype", ["float32"])
@@ -820,6 +866,39 @@ def test_raf_dropout(dropout, device):
     check_dropout(x, m_y, x.grad, dy)
 
 
+@with_dialect("tvm")
+@pytest.mark.parametrize("device", get_testable_devices())
+@pytest.mark.parametrize("dropout", [0.3])
+def test_raf_philox_dropout(dropout, device):
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, key):
+            return raf._contrib_philox_dropout(x, key, dropout)
+
+    shape, dtype = [64, 130], "float32"
+    x, _ = randint(shape, low=10, high=20, dtype=dtype, device=device)
+    x.requires_grad = True
+    key = raf.array(np.array([42, 7], dtype="uint64"), device=device)
+    model = TestModel()
+
+    m_y = model(x, key)
+    y = m_y.numpy()
+    mask = y != 0
+    check(y, mask * x.numpy() / (1 - dropout), rtol=1e-5, atol=1e-5)
+    assert dropout - 0.05 < 1 - np.mean(mask) < dropout + 0.05
+    # The mask only depends on the key.
+    check(run_vm_model(model, device, [x, key]), y)
+    other_key = raf.array(np.array([42, 8], dtype="uint64"), device=device)
+    assert not np.array_equal(model(x, other_key).numpy(), y)
+    # The backward regenerates the mask from the key.
+    dy, _ = randn_torch(shape, dtype=dtype, device=device)
+    m_y.backward(dy)
+    check(x.grad, mask / (1 - dropout) * dy.numpy(), rtol=1e-5, atol=1e-5)
+
+
 @with_seed(0)
 @pytest.mark.parametrize("shape", [(1, 2, 4)])
 @pytest.mark.parametrize("device", get_testable_devices())
@@ -872,5 +951,252 @@ def test_layer_norm_train(shape, device, dtype):
     check(m_db, t_model.layer_norm.bias.grad, rtol=1e-4, atol=1e-4)
 
 
+
+@with_dialect("tvm")
+@pytest.mark.parametrize("device", get_testable_devices())
+@pytest.mark.parametrize("shapes", [(2, 7, 7, 8, 8), (3, 5, 9, 16, 4)])
+@pytest.mark.parametrize("scale", [-1.0, 0.5])
+@pytest.mark.parametrize("causal", [False, True])
+def test_attention(device, shapes, scale, causal):
+    batch, seq_q, seq_k, dim, vdim = shapes
+
+    class Attention(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, q, k, v):
+            return raf._contrib_attention(q, k, v, scale=scale, causal=causal)
+
+    m_model = Attention()
+    m_model.to(device=device)
+    m_q, t_q = randn_torch((batch, seq_q, dim), device=device, requires_grad=True)
+    m_k, t_k = randn_torch((batch, seq_k, dim), device=device, requires_grad=True)
+    m_v, t_v = randn_torch((batch, seq_k, vdim), device=device, requires_grad=True)
+    m_y = m_model(m_q, m_k, m_v)
+    v_y = run_vm_model(m_model, device, [m_q, m_k, m_v])
+
+    t_score = torch.matmul(t_q, t_k.transpose(1, 2)) * (scale if scale > 0 else dim**-0.5)
+    if causal:
+        mask = torch.ones(seq_q, seq_k, dtype=torch.bool, device=t_q.device).triu(1)
+        t_score = t_score.masked_fill(mask, float("-inf"))
+    t_y = torch.matmul(torch.softmax(t_score, dim=-1), t_v)
+    check(m_y, t_y, rtol=1e-4, atol=1e-4)
+    check(v_y, t_y, rtol=1e-4, atol=1e-4)
+
+    m_dy, t_dy = randn_torch(m_y.shape, device=device)
+    m_y.backward(m_dy)
+    t_y.backward(t_dy)
+    check(m_q.grad, t_q.grad, rtol=1e-4, atol=1e-4)
+    check(m_k.grad, t_k.grad, rtol=1e-4, atol=1e-4)
+    check(m_v.grad, t_v.grad, rtol=1e-4, atol=1e-4)
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+@pytest.mark.parametrize("offset", [0, 3])
+def test_kv_cache_attention(device, offset):
+    batch, max_seq, seq, dim = 2, 8, 2, 4
+
+    class Decoder(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, q, x, cache, offset, valid_len):
+            cache = raf._contrib_kv_cache_append(cache, x, offset)
+            return raf._contrib_attention(q, cache, cache, valid_len=valid_len)
+
+    m_model = Decoder()
+    m_model.to(device=device)
+    m_q, n_q = randn((batch, 1, dim), device=device)
+    m_x, n_x = randn((batch, seq, dim), device=device)
+    m_cache, n_cache = randn((batch, max_seq, dim), device=device)
+    m_offset = raf.array(np.array(offset, dtype="int64"), device=device)
+    m_valid_len = raf.array(np.array(offset + seq, dtype="int64"), device=device)
+    m_y = m_model(m_q, m_x, m_cache, m_offset, m_valid_len)
+
+    n_cache[:, offset : offset + seq] = n_x
+    n_kv = n_cache[:, : offset + seq]
+    n_score = np.matmul(n_q, n_kv.transpose(0, 2, 1)) * dim**-0.5
+    n_prob = np.exp(n_score - n_score.max(axis=-1, keepdims=True))
+    n_y = np.matmul(n_prob / n_prob.sum(axis=-1, keepdims=True), n_kv)
+    check(m_y, n_y, rtol=1e-4, atol=1e-4)
+    # The cache is updated in place.
+    check(m_cache, n_cache)
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+@pytest.mark.parametrize("per_channel", [False, True])
+def test_quantized_dense(device, per_channel):
+    m, n, k = 4, 6, 8
+
+    class QuantizedDense(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, w, x_scale, w_scale):
+            q_x = raf._contrib_quantize(x, x_scale)
+            q_w = raf._contrib_quantize(w, w_scale, axis=0)
+            y = raf._contrib_quantized_dense(q_x, q_w, x_scale, w_scale)
+            return y, raf._contrib_dequantize(q_x, x_scale)
+
+    model = QuantizedDense()
+    model.to(device=device)
+    m_x, n_x = randn((m, k), device=device)
+    m_w, n_w = randn((n, k), device=device)
+    n_x_scale = np.array(np.abs(n_x).max() / 127, dtype="float32")
+    n_w_scale = np.array(np.abs(n_w).max(axis=1 if per_channel else None) / 127, dtype="float32")
+    m_x_scale = raf.array(n_x_scale, device=device)
+    m_w_scale = raf.array(n_w_scale, device=device)
+    m_y, m_dx = run_vm_model(model, device, [m_x, m_w, m_x_scale, m_w_scale])
+
+    n_qx = np.clip(np.round(n_x / n_x_scale), -127, 127).astype("int32")
+    n_w_axis_scale = n_w_scale.reshape(-1, 1) if per_channel else n_w_scale
+    n_qw = np.clip(np.round(n_w / n_w_axis_scale), -127, 127).astype("int32")
+    n_y = np.matmul(n_qx, n_qw.T) * n_x_scale * n_w_scale
+    check(m_y, n_y, rtol=1e-5, atol=1e-5)
+    check(m_dx, n_qx * n_x_scale, rtol=1e-5, atol=1e-5)
+
+
+@with_dialect("tvm")
+@pytest.mark.parametrize("device", get_testable_devices())
+@pytest.mark.parametrize(
+    "e5m2,bits,values",
+    [
+        # The halfway 1.0625 is rounded to even, and 1000 is saturated to the largest E4M3.
+        (False, [48, 254, 126, 1, 56, 0], [0.5, -448.0, 448.0, 2.0**-9, 1.0, 0.0]),
+        (True, [56, 223, 100, 24, 60, 0], [0.5, -448.0, 1024.0, 2.0**-9, 1.0, 0.0]),
+    ],
+)
+def test_fp8_quantize(device, e5m2, bits, values):
+    class QuantizeFP8(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, scale):
+            q_x = raf._contrib_quantize_fp8(x, scale, e5m2=e5m2)
+            return q_x, raf._contrib_dequantize_fp8(q_x, scale, e5m2=e5m2)
+
+    model = QuantizeFP8()
+    model.to(device=device)
+    n_x = np.array([0.5, -448.0, 1000.0, 2.0**-9, 1.0625, 0.0], dtype="float32")
+    m_x = raf.array(n_x, device=device)
+    m_one = raf.array(np.array(1.0, dtype="float32"), device=device)
+    m_qx, m_dx = run_vm_model(model, device, [m_x, m_one])
+    check(m_qx, np.array(bits, dtype="uint8"))
+    check(m_dx, np.array(values, dtype="float32"))
+    # The relative error is bounded by the mantissa bits of the format.
+    n_x = np.random.uniform(-10, 10, size=(64,)).astype("float32")
+    m_scale = raf.array(np.array(2.0, dtype="float32"), device=device)
+    m_qx, m_dx = run_vm_model(model, device, [raf.array(n_x, device=device), m_scale])
+    tol = 2.0**-3 if e5m2 else 2.0**-4
+    check(m_dx, n_x, rtol=tol, atol=1e-2)
+
+
+@with_dialect("tvm")
+@pytest.mark.parametrize("device", get_testable_devices())
+@pytest.mark.parametrize("out_dtype", ["float32", "float16"])
+def test_fp8_dense(device, out_dtype):
+    m, n, k = 4, 16, 32
+
+    class FP8Dense(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, w, x_scale, w_scale):
+            q_x = raf._contrib_quantize_fp8(x, x_scale)
+            q_w = raf._contrib_quantize_fp8(w, w_scale)
+            y = raf._contrib_fp8_dense(q_x, q_w, x_scale, w_scale, out_dtype=out_dtype)
+            dx = raf._contrib_dequantize_fp8(q_x, x_scale)
+            dw = raf._contrib_dequantize_fp8(q_w, w_scale)
+            return y, dx, dw
+
+    model = FP8Dense()
+    model.to(device=device)
+    m_x, n_x = randn((m, k), device=device)
+    m_w, n_w = randn((n, k), device=device)
+    m_x_scale = raf.array(np.array(np.abs(n_x).max() / 448, dtype="float32"), device=device)
+    m_w_scale = raf.array(np.array(np.abs(n_w).max() / 448, dtype="float32"), device=device)
+    m_y, m_dx, m_dw = run_vm_model(model, device, [m_x, m_w, m_x_scale, m_w_scale])
+    assert m_y.dtype == out_dtype
+    # The FP8 products are exact in float32, so the dense matches the dequantized one.
+    n_y = np.matmul(m_dx.numpy(), m_dw.numpy().T)
+    tol = 1e-5 if out_dtype == "float32" else 1e-2
+    check(m_y, n_y, rtol=tol, atol=tol)
+    check(m_dx, n_x, rtol=0.1, atol=0.1)
+
+@with_dialect("tvm")
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_sparse_dense(device):
+    m, n, k = 4, 32, 128
+
+    class SparseDense(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, w, meta):
+            return raf._contrib_sparse_dense(x, w, meta)
+
+    model = SparseDense()
+    model.to(device=device)
+    m_x, n_x = randn((m, k), device=device)
+    n_w = raf.sparsity.prune_2_4(np.random.randn(n, k).astype("float32"))
+    assert np.all(np.count_nonzero(n_w.reshape(n, -1, 4), axis=-1) <= 2)
+    n_values, n_meta = raf.sparsity.compress_2_4(n_w)
+    assert n_values.shape == (n, k // 2) and n_meta.shape == (k // 64, n, 2)
+    m_w = raf.array(n_values, device=device)
+    m_meta = raf.array(n_meta, device=device)
+    m_y = run_vm_model(model, device, [m_x, m_w, m_meta])
+    check(m_y, np.matmul(n_x, n_w.T), rtol=1e-5, atol=1e-5)
+
+
+@with_dialect("tvm")
+@pytest.mark.parametrize("device", get_testable_devices())
+@pytest.mark.parametrize("transpose_b", [False, True])
+def test_grouped_matmul(device, transpose_b):
+    k, n = 8, 6
+    # The last row is not in any group, and the third group is empty.
+    n_group_sizes = np.array([3, 5, 0, 2], dtype="int64")
+    num_rows = int(n_group_sizes.sum()) + 1
+
+    class GroupedMatmul(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, w, group_sizes):
+            return raf.grouped_matmul(x, w, group_sizes, transpose_b=transpose_b)
+
+    model = GroupedMatmul()
+    model.to(device=device)
+    w_shape = (len(n_group_sizes), n, k) if transpose_b else (len(n_group_sizes), k, n)
+    m_x, t_x = randn_torch((num_rows, k), device=device, requires_grad=True)
+    m_w, t_w = randn_torch(w_shape, device=device, requires_grad=True)
+    m_group_sizes = raf.array(n_group_sizes, device=device)
+    m_y = model(m_x, m_w, m_group_sizes)
+    v_y = run_vm_model(model, device, [m_x, m_w, m_group_sizes])
+
+    t_ys = []
+    begin = 0
+    for e, size in enumerate(n_group_sizes):
+        t_we = t_w[e].T if transpose_b else t_w[e]
+        t_ys.append(torch.matmul(t_x[begin : begin + size], t_we))
+        begin += size
+    t_ys.append(torch.zeros((num_rows - begin, n), device=t_x.device))
+    t_y = torch.cat(t_ys)
+    check(m_y, t_y, rtol=1e-4, atol=1e-4)
+    check(v_y, t_y, rtol=1e-4, atol=1e-4)
+    # backward
+    m_dy, t_dy = randn_torch(m_y.shape, device=device)
+    m_y.backward(m_dy)
+    t_y.backward(t_dy)
+    check(m_x.grad, t_x.grad, rtol=1e-4, atol=1e-4)
+    check(m_w.grad, t_w.grad, rtol=1e-4, atol=1e-4)
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
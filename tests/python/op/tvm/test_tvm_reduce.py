@@ -204,5 +204,28 @@ def test_l2norm(device):
     check(v_output, t_output)
 
 
+
+@pytest.mark.parametrize("device", get_testable_devices())
+@pytest.mark.parametrize("shape", [(2, 3), (1, 2, 3, 4)])
+@pytest.mark.parametrize("axis", [1, (0, 1), None])
+@pytest.mark.parametrize("keepdims", [True, False])
+@pytest.mark.parametrize("exclude", [True, False])
+def test_moments(shape, axis, keepdims, exclude, device):
+    if axis is None and exclude:
+        pytest.skip("nothing to reduce")
+    model = ReduceModel(raf._op.sym.moments, axis=axis, keepdims=keepdims, exclude=exclude)
+    m_x, n_x = randn(shape, device=device)
+    n_axis = tuple(range(len(shape))) if axis is None else axis
+    if exclude:
+        n_axis = tuple(axis_exclude(n_axis, shape))
+    n_mean = np.mean(n_x, axis=n_axis, keepdims=keepdims)
+    n_var = np.var(n_x, axis=n_axis, keepdims=keepdims)
+    m_mean, m_var = model(m_x)
+    check(m_mean, n_mean)
+    check(m_var, n_var)
+    v_mean, v_var = run_vm_model(model, device, [m_x])
+    check(v_mean, n_mean)
+    check(v_var, n_var)
+
 if __name__ == "__main__":
     pytest.main([__file__])
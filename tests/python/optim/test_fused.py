@@ -0,0 +1,184 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=too-many-locals, too-many-arguments
+import numpy as np
+import pytest
+import torch
+
+import raf
+from raf.testing import check, randn_torch, with_seed
+
+SHAPES = [(3, 5), (70000,), (4, 1, 7)]
+
+
+def run_step(dtype, make_raf_optim, make_torch_optim, num_steps=3):
+    """Run num_steps of the fused optimizer and the torch optimizer on y = x * c."""
+    device = "cuda"
+    m_params, t_params, m_cs, t_cs = [], [], [], []
+    for shape in SHAPES:
+        m_x, t_x = randn_torch(shape, device=device, dtype=dtype, requires_grad=True)
+        m_c, t_c = randn_torch(shape, device=device, dtype=dtype)
+        m_params.append(m_x)
+        m_cs.append(m_c)
+        # The torch reference keeps the float32 master weights.
+        t_params.append(t_x.detach().float().requires_grad_())
+        t_cs.append(t_c.float())
+    m_optim = make_raf_optim(m_params)
+    t_optim = make_torch_optim(t_params)
+    for _ in range(num_steps):
+        for m_x, m_c, t_x, t_c in zip(m_params, m_cs, t_params, t_cs):
+            m_dy, t_dy = randn_torch(m_x.shape, device=device, dtype=dtype)
+            m_y = raf.multiply(m_x, m_c)
+            m_y.backward(m_dy)
+            t_x.grad = t_c * t_dy.float()
+        m_optim.step()
+        t_optim.step()
+    tol = 1e-4 if dtype == "float32" else 1e-2
+    for m_x, t_x in zip(m_params, t_params):
+        check(m_x, t_x.to(getattr(torch, dtype)), rtol=tol, atol=tol)
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+@with_seed(0)
+def test_fused_sgd(dtype):
+    lr, momentum = 0.1, 0.9
+    run_step(
+        dtype,
+        lambda params: raf.optim.FusedSGD(params, lr, momentum),
+        lambda params: torch.optim.SGD(params, lr, momentum=momentum),
+    )
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+@with_seed(0)
+def test_adamw(dtype):
+    kwargs = {"lr": 0.01, "betas": (0.9, 0.99), "eps": 1e-6, "weight_decay": 0.1}
+    run_step(
+        dtype,
+        lambda params: raf.optim.AdamW(params, **kwargs),
+        lambda params: torch.optim.AdamW(params, **kwargs),
+    )
+
+
+class NumpyLAMB:
+    """The reference LAMB with the decoupled weight decay and the bias correction."""
+
+    def __init__(self, params, lr, betas, eps, weight_decay):
+        self.params = params
+        self.lr, self.betas, self.eps, self.weight_decay = lr, betas, eps, weight_decay
+        self.states = [(torch.zeros_like(x), torch.zeros_like(x)) for x in params]
+        self.num_steps = 0
+
+    def step(self):
+        self.num_steps += 1
+        beta1, beta2 = self.betas
+        with torch.no_grad():
+            for x, (m, v) in zip(self.params, self.states):
+                m.mul_(beta1).add_((1 - beta1) * x.grad)
+                v.mul_(beta2).add_((1 - beta2) * x.grad * x.grad)
+                m_hat = m / (1 - beta1**self.num_steps)
+                v_hat = v / (1 - beta2**self.num_steps)
+                update = m_hat / (v_hat.sqrt() + self.eps) + self.weight_decay * x
+                w_norm, u_norm = np.linalg.norm(x.cpu()), np.linalg.norm(update.cpu())
+                ratio = w_norm / u_norm if w_norm > 0 and u_norm > 0 else 1.0
+                x.sub_(self.lr * ratio * update)
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+@with_seed(0)
+def test_lamb(dtype):
+    kwargs = {"lr": 0.01, "betas": (0.9, 0.99), "eps": 1e-6, "weight_decay": 0.1}
+    run_step(
+        dtype,
+        lambda params: raf.optim.LAMB(params, **kwargs),
+        lambda params: NumpyLAMB(params, **kwargs),
+    )
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+@with_seed(0)
+def test_multi_tensor_l2norm(dtype):
+    # More tensors than a single launch of the multi-tensor kernel holds.
+    shapes = SHAPES * 50
+    m_xs, t_xs = zip(*[randn_torch(shape, device="cuda", dtype=dtype) for shape in shapes])
+    m_norms, m_norm = raf._op.imp.multi_tensor_l2norm(list(m_xs))
+    t_norms = torch.stack([torch.norm(t_x.float()) for t_x in t_xs])
+    check(m_norms, t_norms, rtol=1e-4, atol=1e-4)
+    check(m_norm, torch.norm(t_norms), rtol=1e-4, atol=1e-4)
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("max_norm", [1.0, 1e4])
+@with_seed(0)
+def test_clip_grad_norm(max_norm):
+    # The float32 and float16 gradients are clipped by their global norm.
+    m_params, t_grads = [], []
+    for i, shape in enumerate(SHAPES * 2):
+        dtype = "float32" if i % 2 == 0 else "float16"
+        m_x, t_x = randn_torch(shape, device="cuda", dtype=dtype, requires_grad=True)
+        m_dy, t_dy = randn_torch(shape, device="cuda", dtype=dtype)
+        raf.multiply(m_x, m_x).backward(m_dy)
+        m_params.append(m_x)
+        t_grads.append(2 * t_x.detach() * t_dy)
+    m_norm = raf.optim.clip_grad_norm(m_params, max_norm)
+    t_norm = torch.norm(torch.stack([torch.norm(t_grad.float()) for t_grad in t_grads]))
+    check(m_norm, t_norm, rtol=1e-3, atol=1e-3)
+    coef = min(1.0, max_norm / (t_norm.item() + 1e-6))
+    for m_x, t_grad in zip(m_params, t_grads):
+        check(m_x.grad, t_grad * coef, rtol=1e-2, atol=1e-2)
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+@with_seed(0)
+def test_dynamic_loss_scaler(dtype):
+    lr, init_scale = 0.1, 1024.0
+    scaler = raf.amp.DynamicLossScaler(init_scale, growth_interval=2, device="cuda")
+    m_params, t_params = [], []
+    for shape in SHAPES:
+        m_x, t_x = randn_torch(shape, device="cuda", dtype=dtype, requires_grad=True)
+        m_params.append(m_x)
+        t_params.append(t_x.detach().float())
+    optim = raf.optim.FusedSGD(m_params, lr)
+
+    def backward(overflow):
+        t_grads = []
+        for m_x in m_params:
+            t_grad = np.random.randn(*m_x.shape).astype("float32")
+            t_grads.append(t_grad)
+            m_dy = t_grad * init_scale
+            if overflow:
+                m_dy.flat[0] = np.inf
+            raf.multiply(m_x, raf.array(np.ones(m_x.shape), dtype=dtype, device="cuda")).backward(
+                raf.array(m_dy, dtype=dtype, device="cuda")
+            )
+        return t_grads
+
+    # The overflowed step skips the update and backs off the scale.
+    backward(overflow=True)
+    scaler.step(optim, m_params)
+    check(scaler.scale, init_scale * 0.5)
+    for m_x, t_x in zip(m_params, t_params):
+        check(m_x, t_x.to(getattr(torch, dtype)))
+    # The finite steps update the parameters by the unscaled gradients, and the scale grows back
+    # after growth_interval of them.
+    init_scale *= 0.5
+    tol = 1e-4 if dtype == "float32" else 1e-2
+    for _ in range(2):
+        t_grads = backward(overflow=False)
+        scaler.step(optim, m_params)
+        for t_x, t_grad in zip(t_params, t_grads):
+            t_x -= lr * torch.tensor(t_grad, device="cuda")
+        for m_x, t_x in zip(m_params, t_params):
+            check(m_x, t_x.to(getattr(torch, dtype)), rtol=tol, atol=tol)
+    check(scaler.scale, init_scale * 2)
+    check(scaler.growth_tracker, 0.0)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -0,0 +1,97 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=attribute-defined-outside-init, protected-access
+import os
+
+import numpy as np
+import pytest
+
+import raf
+from raf.optim.offload import StateOffloader
+from raf.testing import check, get_testable_devices, randn, with_seed
+
+
+class Model(raf.Model):
+    def build(self, shapes, device):
+        self.x0 = raf.array(np.random.randn(*shapes[0]).astype("float32"), device=device)
+        self.x1 = raf.array(np.random.randn(*shapes[1]).astype("float32"), device=device)
+        self.x2 = raf.array(np.random.randn(*shapes[2]).astype("float32"), device=device)
+
+    @raf.model.trace
+    def forward(self):
+        y = raf.add(raf.sum(raf.relu(self.x0)), raf.sum(raf.tanh(self.x1)))
+        return raf.add(y, raf.sum(raf.multiply(self.x2, self.x2)))
+
+
+def test_state_offloader(tmp_path):
+    specs = [[((3, 5), "float32")], [((1000,), "float32"), ((7,), "int64")]]
+    offloader = StateOffloader(str(tmp_path), specs)
+    for states in [offloader.read(0), offloader.read(1)]:
+        for state in states:
+            assert not state.any()
+    new_states = [np.arange(1000, dtype="float32"), np.arange(7, dtype="int64")]
+    offloader.update([1], "cpu", lambda index, states: [raf.array(x) for x in new_states])
+    for state, expected in zip(offloader.read(1), new_states):
+        np.testing.assert_equal(state, expected)
+    path = offloader.store.path
+    assert os.path.exists(path)
+    offloader.close()
+    assert not os.path.exists(path)
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+@with_seed(0)
+def test_offloaded_sgd(device, tmp_path):
+    shapes = [(4, 4), (1025,), (3, 7, 9)]
+    ref_model = Model(shapes, device)
+    model = Model(shapes, device)
+    for name in ["x0", "x1", "x2"]:
+        setattr(model, name, raf.array(getattr(ref_model, name).numpy(), device=device))
+    for m in [ref_model, model]:
+        m.train_mode()
+        for param in m.state().values():
+            param.requires_grad = True
+    ref_optimizer = raf.optim.SGD(ref_model.state().values(), 0.1, 0.9)
+    optimizer = raf.optim.SGD(model.state().values(), 0.1, 0.9, offload_dir=str(tmp_path))
+    for _ in range(3):
+        dy, _ = randn((), device=device)
+        for m, opt in [(ref_model, ref_optimizer), (model, optimizer)]:
+            loss = m()
+            loss.backward(dy)
+            opt.step()
+    for name in ["x0", "x1", "x2"]:
+        check(getattr(model, name), getattr(ref_model, name), rtol=1e-5, atol=1e-5)
+    # The momentum stays in the storage.
+    assert all(v is None for _, v in optimizer.params)
+    for i, (_, v) in enumerate(ref_optimizer.params):
+        check(optimizer._offloader.read(i)[0], v, rtol=1e-5, atol=1e-5)
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@with_seed(0)
+def test_offloaded_lans(tmp_path):
+    device = "cuda"
+    shapes = [(4, 4), (1025,), (3, 7, 9)]
+    ref_model = Model(shapes, device)
+    model = Model(shapes, device)
+    for name in ["x0", "x1", "x2"]:
+        setattr(model, name, raf.array(getattr(ref_model, name).numpy(), device=device))
+    for m in [ref_model, model]:
+        m.train_mode()
+        for param in m.state().values():
+            param.requires_grad = True
+    ref_optimizer = raf.optim.LANS(ref_model.state().values())
+    optimizer = raf.optim.LANS(model.state().values(), offload_dir=str(tmp_path))
+    for _ in range(3):
+        dy, _ = randn((), device=device)
+        for m, opt in [(ref_model, ref_optimizer), (model, optimizer)]:
+            loss = m()
+            loss.backward(dy)
+            opt.step()
+    for name in ["x0", "x1", "x2"]:
+        check(getattr(model, name), getattr(ref_model, name), rtol=1e-5, atol=1e-5)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
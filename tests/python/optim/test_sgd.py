@@ -21,6 +21,8 @@ from raf.testing import (
     get_testable_devices,
     check,
     run_vm_model,
+    get_vm_executor,
+    run_vm_executor,
     one_hot_torch,
     randn_torch,
     t2m_param,
@@ -171,6 +173,56 @@ def test_traced_sgd_simple(device):
         check(m_model.x, t_model.x, rtol=1e-4, atol=1e-4)
 
 
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+def test_traced_sgd_cuda_graph():
+    # pylint: disable=protected-access
+    shape = (2, 2)
+    device = "cuda"
+    t_model = TorchSimpleTest(shape)
+    t_model.to(device)
+    m_model = RAFSimpleTest(shape)
+    m_model.x = t2m_param(t_model.x, device=device)
+    m_model.train_mode()
+    t_model.train()
+    m_optimizer = raf.optim.sgd.with_sgd(learning_rate=0.1, momentum=0.01)(m_model)
+    t_optimizer = torch.optim.SGD(t_model.parameters(), lr=0.1, momentum=0.01)
+    m_dy, _ = randn_torch(shape, device=device, requires_grad=False)
+    record = m_optimizer._internal(m_dy)
+    # The whole step, including the update of the weights in place, is captured once and replayed.
+    executor = get_vm_executor(record.mod, device, enable_cuda_graph=True)
+    for _ in range(4):
+        m_dy, t_dy = randn_torch(shape, device=device, requires_grad=False)
+        run_vm_executor(executor, record, [m_dy], device)
+        t_optimizer.zero_grad()
+        t_model().backward(t_dy)
+        t_optimizer.step()
+        check(m_model.x, t_model.x, rtol=1e-4, atol=1e-4)
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_traced_sgd_grad_accumulation(device):
+    shape = (2, 2)
+    accum_steps = 3
+    t_model = TorchSimpleTest(shape)
+    t_model.to(device)
+    m_model = RAFSimpleTest(shape)
+    m_model.x = t2m_param(t_model.x, device=device)
+    m_model.train_mode()
+    t_model.train()
+    m_optimizer = raf.optim.sgd.with_sgd(0.1, 0.01, accum_steps=accum_steps)(m_model)
+    t_optimizer = torch.optim.SGD(t_model.parameters(), lr=0.1, momentum=0.01)
+    t_optimizer.zero_grad()
+    for i in range(2 * accum_steps):
+        m_dy, t_dy = randn_torch(shape, device=device, requires_grad=False)
+        run_vm_model(m_optimizer.get_step_model(i), device, [m_dy])
+        t_model().backward(t_dy)
+        if (i + 1) % accum_steps == 0:
+            t_optimizer.step()
+            t_optimizer.zero_grad()
+        # The weights are only updated at the last micro-batch of each step.
+        check(m_model.x, t_model.x, rtol=1e-4, atol=1e-4)
+
+
 @pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
 @pytest.mark.parametrize("config", [(10, 32, 10)])
 def test_traced_sgd(config):
@@ -254,6 +306,7 @@ def test_state_partition(mock_get_context):
             self.zero_opt_level = 2
             self.size = 4
             self.rank = 3
+            self.local_sgd_period = 1
 
     mock_get_context.return_value = MockContext()
 
@@ -294,5 +347,39 @@ def test_state_partition(mock_get_context):
     assert text.count("raf.op.strided_slice") == 8, text
 
 
+@patch("raf.distributed.get_context")
+def test_local_sgd(mock_get_context):
+    """Note that this test only verifies the IR of local SGD without running it."""
+    # pylint: disable=protected-access
+    class MockContext:
+        def __init__(self):
+            self.enable_data_parallel = True
+            self.zero_opt_level = 0
+            self.size = 4
+            self.rank = 0
+            self.local_sgd_period = 3
+            self.local_sgd_average_momentum = True
+
+    mock_get_context.return_value = MockContext()
+
+    shape = (2, 2)
+    m_model = RAFSimpleTest(shape)
+    m_model.train_mode()
+    m_optimizer = raf.optim.sgd.with_sgd(learning_rate=0.1, momentum=0.01)(m_model)
+    m_dy, _ = randn_torch(shape, requires_grad=False)
+
+    # The local steps apply the gradients without communication.
+    text = raf.ir.AsText(m_optimizer._internal(m_dy).mod)
+    assert "raf.op._allreduce" not in text, text
+
+    # The weights are averaged after every 3 steps.
+    syncs = [m_optimizer.get_sync_model(i) is not None for i in range(6)]
+    assert syncs == [False, False, True, False, False, True]
+    text = raf.ir.AsText(m_optimizer.get_sync_model(2)._internal().mod)
+    # The weight and its momentum are averaged by a single allreduce.
+    assert text.count("raf.op._allreduce") == 1, text
+    assert text.count("raf.op.multiply") == 2, text
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
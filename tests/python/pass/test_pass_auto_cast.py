@@ -413,6 +413,41 @@ def test_where():
         # matmul is executed with fp16, so skip checking the correctness but just the execution.
         verify_correctness(model, "cpu", args, tol=1)
 
+@pytest.mark.parametrize("dtype", ["float16", "bfloat16"])
+@pytest.mark.parametrize(
+    "params",
+    [
+        # Cast x and w to the AMP dtype for matmul, and cast back for softmax.
+        (None, 3),
+        # Cast x and w to the AMP dtype for matmul, and keep softmax in the AMP dtype.
+        ({"softmax": "always"}, 2),
+        # Keep everything in float32.
+        ({"raf.op.matmul": "never"}, 0),
+    ],
+)
+def test_cast_policy(dtype, params):
+    shape = (16, 16)
+    cast_policy, expected = params
+
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, w):
+            out = raf.matmul(x, w)
+            return raf.softmax(out)
+
+    model = Model()
+    m_x, _ = randn(shape, dtype="float32")
+    m_w, _ = randn(shape, dtype="float32")
+    amp_model = raf.amp.autocast(model, [m_x, m_w], dtype=dtype, cast_policy=cast_policy)
+    text = AsText(amp_model._internal(m_x, m_w).mod["main"])
+    casts = [line for line in text.split("\n") if "raf.op.cast" in line]
+    assert len(casts) == expected, text
+    if expected > 0:
+        assert '"%s"' % dtype in casts[0], text
+
 
 if __name__ == "__main__":
     pytest.main([__file__])
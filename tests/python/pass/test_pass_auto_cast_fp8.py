@@ -0,0 +1,62 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access, no-self-use, attribute-defined-outside-init
+import numpy as np
+import pytest
+
+import raf
+from raf.ir import AsText
+from raf.testing import randn, run_vm_model, check
+
+
+class MLP(raf.Model):
+    def build(self, w1, w2):
+        self.w1 = w1
+        self.w2 = w2
+
+    @raf.model.trace
+    def forward(self, x):
+        y = raf.relu(raf.dense(x, self.w1))
+        return raf.matmul_nt(y, self.w2)
+
+
+def count_ops(model, args, op_name):
+    mod = model._internal(*args).mod
+    text = AsText(raf._ffi.pass_.InferType()(mod)["main"])
+    return sum(line.find(op_name + "(") != -1 for line in text.split("\n"))
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+def test_autocast_fp8_mlp():
+    device, history_len = "cuda", 4
+    m_w1, n_w1 = randn((32, 16), device=device)
+    m_w2, n_w2 = randn((16, 32), device=device)
+    model = MLP(m_w1, m_w2)
+    model.infer_mode()
+    model.to(device=device)
+    m_x, n_x = randn((8, 16), device=device)
+
+    f_model = raf.amp.autocast_fp8(model, [m_x], history_len=history_len, device=device)
+    assert count_ops(f_model, [m_x], "raf.op._contrib_fp8_dense") == 2
+    assert count_ops(f_model, [m_x], "raf.op._contrib_update_fp8_scale") == 4
+    state = f_model.state()
+    assert state["fp8_x_amax_history_0"].shape == (history_len,)
+
+    # The first step quantizes by the initial scales, and the scales are updated by the amaxes.
+    run_vm_model(f_model, device, [m_x])
+    check(state["fp8_x_scale_0"], np.abs(n_x).max() / raf.amp.fp8.E4M3_MAX, rtol=1e-5)
+    check(state["fp8_w_scale_1"], np.abs(n_w2).max() / raf.amp.fp8.E4M3_MAX, rtol=1e-5)
+    history = state["fp8_x_amax_history_0"].numpy()
+    check(history, [np.abs(n_x).max()] + [0] * (history_len - 1), rtol=1e-5)
+
+    # The following steps are scaled by the amax history.
+    n_y = np.matmul(np.maximum(np.matmul(n_x, n_w1.T), 0), n_w2.T)
+    m_y = run_vm_model(f_model, device, [m_x])
+    check(m_y, n_y, rtol=0.1, atol=0.5)
+    history = state["fp8_x_amax_history_0"].numpy()
+    check(history[:2], [np.abs(n_x).max()] * 2, rtol=1e-5)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -0,0 +1,81 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=attribute-defined-outside-init,invalid-name,protected-access,too-many-locals,too-many-statements,no-self-use,too-many-arguments
+import pytest
+import tvm
+
+import raf
+from raf.ir import PassContext
+from raf._ffi.pass_ import BucketAllReduce
+from raf._core.ir_ext import extended_var
+from raf.ir import ANFBuilder
+
+
+def construct_model_func(shape, n):
+    """Compute n local gradients and allreduce each of them, followed by a consumer."""
+    builder = ANFBuilder()
+    xs = [extended_var("x%d" % i, shape=shape, dtype="float32") for i in range(n)]
+    outs = []
+    for x in xs:
+        grad = builder.call("relu", [x])
+        grad_in = builder.make_tuple([grad])
+        outs.append(builder.call("_allreduce", [grad_in, raf.ir.const("avg"), raf.ir.const(None)]))
+        # The consumer of the reduced gradient must be deferred after the bucket.
+        outs[-1] = builder.call("relu", [outs[-1]])
+    ret = builder.make_tuple(outs)
+    return tvm.relay.Function(xs, builder.ret(ret))
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize(
+    "shape,bucket_size_mb,num_buckets",
+    [
+        [[128, 128], 0, 4],  # Disabled.
+        [[128, 128], 1, 1],  # 64KB per gradient.
+        [[512, 256], 1, 2],  # 512KB per gradient.
+        [[512, 512], 1, 4],  # 1MB per gradient.
+    ],
+)
+def test_bucket_allreduce(shape, bucket_size_mb, num_buckets):
+    mod = tvm.IRModule()
+    mod["main"] = construct_model_func(shape, 4)
+    with PassContext(config={"raf.bucket_allreduce.bucket_size_mb": bucket_size_mb}):
+        mod = BucketAllReduce()(mod)
+    text = raf.ir.AsText(mod["main"])
+    assert text.count("raf.op._allreduce(") == num_buckets, text
+    # The bucketed function is still well-typed.
+    mod = raf._ffi.pass_.InferType()(mod)
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize(
+    "shape,bucket_size_mb,num_buckets",
+    [
+        [[128, 128], 0, 4],  # Disabled.
+        [[128, 128], 1, 1],  # 64KB per shard.
+        [[512, 512], 1, 4],  # 1MB per shard.
+    ],
+)
+def test_bucket_allgather(shape, bucket_size_mb, num_buckets):
+    """The allgather ops of the updated weight shards with ZeRO."""
+    builder = ANFBuilder()
+    xs = [extended_var("x%d" % i, shape=shape, dtype="float32") for i in range(4)]
+    outs = []
+    for x in xs:
+        shard = builder.call("relu", [x])
+        out = builder.call("_allgather", [shard, raf.ir.const(0), raf.ir.const(None)])
+        outs.append(builder.call("relu", [out]))
+    mod = tvm.IRModule()
+    mod["main"] = tvm.relay.Function(xs, builder.ret(builder.make_tuple(outs)))
+    with PassContext(config={"raf.bucket_allreduce.bucket_size_mb": bucket_size_mb}):
+        mod = BucketAllReduce()(mod)
+    text = raf.ir.AsText(mod["main"])
+    assert text.count("raf.op._allgather(") == num_buckets, text
+    mod = raf._ffi.pass_.InferType()(mod)
+    for out in mod["main"].ret_type.fields:
+        assert list(out.shape)[1:] == shape[1:]
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
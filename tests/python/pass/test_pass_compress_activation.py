@@ -0,0 +1,71 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=invalid-name,protected-access,too-many-locals
+import pytest
+import tvm
+
+import raf
+from raf._ffi.pass_ import CompressActivation, InferType
+from raf._core.ir_ext import extended_var
+from raf.ir import ANFBuilder
+
+
+def construct_train_func(shape):
+    """A forward followed by its backward after GradInputSelect."""
+    builder = ANFBuilder()
+    x = extended_var("x", shape=shape, dtype="float32")
+    w = extended_var("w", shape=shape, dtype="float32")
+    dy = extended_var("dy", shape=shape, dtype="float32")
+    null = raf.ir.const(None)
+    r = builder.call("relu", [x])
+    a = builder.call("matmul", [r, w])
+    out = builder.call("gelu", [a])
+    d_a = builder.call("gelu_dx", [a, null, dy])
+    d_r = builder.call("matmul_nt", [d_a, w])
+    d_x = builder.call("relu_dx", [null, r, d_r])
+    grads = builder.make_tuple([d_x])
+    ret = builder.make_tuple([out, grads])
+    return tvm.relay.Function([x, w, dy], builder.ret(ret))
+
+
+@pytest.mark.parametrize(
+    "policy,dtypes",
+    [
+        ["", []],
+        ["relu", ["bool"]],
+        ["relu,gelu", ["bool", "bfloat16"]],
+        # Both the ReLU output and the GELU input are stored in float16.
+        ["float16", ["float16", "float16"]],
+    ],
+)
+def test_compress_activation(policy, dtypes):
+    # Each tensor is 4 MBs.
+    shape = [1024, 1024]
+    mod = tvm.IRModule()
+    mod["main"] = construct_train_func(shape)
+    with raf.ir.PassContext(config={"raf.compress_activation.policy": policy}):
+        mod = InferType()(mod)
+        mod = CompressActivation()(mod)
+    text = raf.ir.AsText(mod["main"])
+    # Each compressed activation is cast once in the forward and once in the backward.
+    assert text.count("raf.op.cast(") == 2 * len(dtypes), text
+    for dtype in dtypes:
+        assert '"%s"' % dtype in text, text
+    if "relu" in policy:
+        # The relu_dx takes the decompressed mask in place of the ReLU output.
+        line = next(line for line in text.split("\n") if "raf.op.relu_dx(" in line)
+        assert "_decompress" in line, text
+
+
+def test_skip_small_tensors():
+    mod = tvm.IRModule()
+    mod["main"] = construct_train_func([16, 16])
+    with raf.ir.PassContext(config={"raf.compress_activation.policy": "relu,gelu"}):
+        mod = InferType()(mod)
+        mod = CompressActivation()(mod)
+    assert "raf.op.cast(" not in raf.ir.AsText(mod["main"])
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -77,6 +77,40 @@ def test_device_copy():
             assert dev.device_type == gpu_dev
 
 
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+def test_shape_ops():
+    # pylint: disable=protected-access
+    class Model(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):  # pylint: disable=no-self-use
+            y = raf.add(x, x)
+            return y, raf.numel(y), raf.shape_as_tensor(x)
+
+    model = Model()
+    m_x, _ = randn((3, 4), device="cuda")
+    mod = InferType()(model._internal(m_x).mod)
+    ca = ContextAnalysis(mod, Device("cuda"))
+
+    # The shape ops are on CPU, while their inputs are left on the default device.
+    cpu_dev = tvm.cpu().device_type
+    gpu_dev = tvm.cuda().device_type
+    num_shape_ops = 0
+    for expr, dev in ca.items():
+        if isinstance(expr, relay.Call):
+            if expr.op.name in ["raf.op.numel", "raf.op.shape_as_tensor"]:
+                assert dev.device_type == cpu_dev
+                num_shape_ops += 1
+            else:
+                assert dev.device_type == gpu_dev
+        elif isinstance(expr, relay.Var) and expr.name_hint == "x":
+            assert dev.device_type == gpu_dev
+    assert num_shape_ops == 2
+
+
 @pytest.mark.skip(reason="Enable the test when vm dialects have type inference.")
 @pytest.mark.parametrize(
     "shape",
@@ -0,0 +1,79 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=invalid-name,protected-access,attribute-defined-outside-init,no-self-use
+import pytest
+
+import raf
+from raf._core.device import Device
+from raf._ffi.pass_ import ConvertLayout, InferType
+from raf.testing import randn, check, run_vm_model
+
+
+class ConvBlock(raf.Model):
+    def build(self, dtype):
+        self.w1, _ = randn((16, 8, 3, 3), device="cuda", dtype=dtype)
+        self.w2, _ = randn((16, 16, 3, 3), device="cuda", dtype=dtype)
+        self.bias, _ = randn((16, 1, 1), device="cuda", dtype=dtype)
+
+    @raf.model.trace
+    def forward(self, x):
+        y = raf.conv2d(x, self.w1, padding=1)
+        y = raf.relu(raf.add(y, self.bias))
+        y = raf.max_pool2d(y, kernel=2, stride=2)
+        y = raf.conv2d(y, self.w2, padding=1)
+        return raf.relu(raf.add(y, y))
+
+
+def convert(mod, policy):
+    with raf.ir.PassContext(config={"raf.layout.policy": policy}):
+        with Device("cuda"):
+            mod = InferType()(mod)
+            return ConvertLayout()(mod)
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("policy", ["auto", "nhwc", "none"])
+def test_convert_region(policy):
+    dtype = "float16" if policy == "auto" else "float32"
+    model = ConvBlock(dtype)
+    m_x, _ = randn((2, 8, 16, 16), device="cuda", dtype=dtype)
+    mod = convert(model._internal(m_x).mod, policy)
+    text = raf.ir.AsText(mod["main"])
+    if policy == "none":
+        assert "NHWC" not in text, text
+        return
+    assert text.count("raf.op.conv2d") == 2, text
+    # The input and the weights are transposed to NHWC, and only the output is transposed back,
+    # as the bias add, the relu and the pooling are converted as well.
+    assert text.count("raf.op.transpose") == 4, text
+    assert text.count("raf.op.reshape") == 1, text
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+def test_keep_unaligned_channels():
+    class Model(raf.Model):
+        def build(self):
+            self.w, _ = randn((6, 3, 3, 3), device="cuda", dtype="float16")
+
+        @raf.model.trace
+        def forward(self, x):
+            return raf.conv2d(x, self.w)
+
+    model = Model()
+    m_x, _ = randn((1, 3, 8, 8), device="cuda", dtype="float16")
+    text = raf.ir.AsText(convert(model._internal(m_x).mod, "auto")["main"])
+    assert "NHWC" not in text, text
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+def test_correctness():
+    model = ConvBlock("float32")
+    m_x, _ = randn((2, 8, 16, 16), device="cuda")
+    ref = model(m_x)
+    out = run_vm_model(model, "cuda", [m_x], layout_policy="nhwc")
+    check(out, ref, rtol=1e-4, atol=1e-4)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
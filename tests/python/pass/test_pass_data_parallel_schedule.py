@@ -8,7 +8,8 @@ import tvm
 
 import raf
 from raf.ir.pass_manager import RAFSequential
-from raf._ffi.pass_ import DataParallelSchedule, ToGraphNormalForm
+from raf._ffi.pass_ import DataParallelSchedule, ToGraphNormalForm, EstimateCommOverlap
+from raf._core.device import Device
 from raf.testing import randn
 from raf._core.ir_ext import extended_var
 from raf.ir import ScopeBuilder
@@ -599,5 +600,77 @@ def test_fifo_schedule(model_class, shape):
     assert equal_to_any, "\n".join(err_msgs)
 
 
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize(
+    "model_class,shape",
+    [
+        (TwoBranchModel, (64, 128)),
+        (UnbalancedModel, (64, 128)),
+        (ExampleModel, (64, 128)),
+        (DelayedSuccessorModel, (64, 128)),
+        (CascadingCollectiveModel, (512, 1024)),
+    ],
+)
+def test_comm_aware_schedule(model_class, shape):
+    model = model_class(shape)
+    x, _ = randn(shape)
+    mod = model._internal(x).mod
+
+    config = {"raf.dp_schedule.num_workers": 8, "raf.dp_schedule.comm_bandwidth": 1}
+    with Device("cuda"):
+        with raf.ir.PassContext(config=config):
+            fifo_mod = RAFSequential([ToGraphNormalForm(), DataParallelSchedule()])(mod)
+            fifo_overlap = [v.value for v in EstimateCommOverlap(fifo_mod)]
+        config["raf.dp_schedule.policy"] = "comm_aware"
+        with raf.ir.PassContext(config=config):
+            comm_mod = RAFSequential([ToGraphNormalForm(), DataParallelSchedule()])(mod)
+            comm_overlap = [v.value for v in EstimateCommOverlap(comm_mod)]
+
+    text = raf.ir.AsText(comm_mod["main"])
+    assert text.count("let ") == raf.ir.AsText(fifo_mod["main"]).count("let "), text
+    # The comm-aware schedule does not expose more communication than the FIFO schedule.
+    total, compute, comm, exposed = comm_overlap
+    assert total == pytest.approx(compute + exposed)
+    assert 0 <= exposed <= comm
+    assert exposed <= fifo_overlap[3] + 1e-3, text
+
+
+@pytest.mark.parametrize("policy", ["fifo", "comm_aware"])
+@pytest.mark.parametrize("depth", [0, 1, 2])
+def test_param_prefetch(policy, depth):
+    shape, num_layers = (8, 8), 4
+    builder = ANFBuilder()
+    x = extended_var("x", shape=shape)
+    parts = [extended_var(f"w{i}", shape=shape) for i in range(num_layers)]
+    out = x
+    for part in parts:
+        weight = builder.call("_allgather", [part, builder.const(0), builder.const(None)])
+        out = builder.call("matmul", [out, weight])
+    func = tvm.relay.Function([x] + parts, builder.ret(out))
+    mod = tvm.IRModule.from_expr(func)
+
+    config = {"raf.dp_schedule.policy": policy, "raf.dp_schedule.param_prefetch_depth": depth}
+    with raf.ir.PassContext(config=config):
+        mod = RAFSequential([ToGraphNormalForm(), DataParallelSchedule()])(mod)
+
+    ops = []
+    body = mod["main"].body
+    while isinstance(body, tvm.relay.Let):
+        ops.append(body.value.op.name)
+        body = body.body
+    gathers = [i for i, op in enumerate(ops) if op == "raf.op._allgather"]
+    matmuls = [i for i, op in enumerate(ops) if op == "raf.op.matmul"]
+    assert len(gathers) == len(matmuls) == num_layers, ops
+    if depth == 0:
+        # All gathers run ahead of the computation.
+        assert max(gathers) < min(matmuls), ops
+        return
+    for i in range(depth, num_layers):
+        # The gather of layer i is issued after the computation of layer i - depth starts.
+        assert gathers[i] > matmuls[i - depth], ops
+    for i in range(min(depth, num_layers)):
+        assert gathers[i] < matmuls[0], ops
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
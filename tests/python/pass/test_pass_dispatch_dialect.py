@@ -134,5 +134,39 @@ def test_dialect_pref():
     assert tvm.ir.structural_equal(mod["main"], func_expected)
 
 
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+def test_auto_dispatch():
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, w):
+            y = raf.matmul(x, w)
+            y = raf.relu(y)
+            return y
+
+    model = Model()
+    m_x, _ = randn((64, 128), device="cpu")
+    m_w, _ = randn((128, 32), device="cpu")
+    mod = model._internal(m_x, m_w).mod
+    with tvm.transform.PassContext(config={"raf.dispatch_dialect.auto_dispatch": True}):
+        mod = optimize(mod)
+
+    ops = []
+
+    def collect(node):
+        if isinstance(node, relay.Call) and isinstance(node.op, tvm.ir.Op):
+            ops.append(node.op.name)
+
+    relay.analysis.post_order_visit(mod["main"], collect)
+    # Every call is dispatched to one of the dialects of its base op.
+    assert len(ops) == 2
+    assert ops[0].startswith("raf.op.") and ops[0].endswith(".matmul")
+    assert ops[0] != "raf.op.matmul"
+    assert ops[1].startswith("raf.op.") and ops[1].endswith(".relu")
+    assert ops[1] != "raf.op.relu"
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
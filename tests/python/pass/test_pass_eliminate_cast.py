@@ -0,0 +1,66 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=invalid-name,protected-access
+import pytest
+import tvm
+
+import raf
+from raf._ffi.pass_ import EliminateCast, InferType
+from raf._core.ir_ext import extended_var
+from raf.ir import ANFBuilder
+
+
+def run_eliminate_cast(func):
+    mod = tvm.IRModule()
+    mod["main"] = func
+    mod = InferType()(mod)
+    mod = EliminateCast()(mod)
+    return raf.ir.AsText(mod["main"])
+
+
+def test_back_to_back_through_layout():
+    # cast(reshape(cast(x, fp16)), fp32) is reshape(x).
+    builder = ANFBuilder()
+    x = extended_var("x", shape=(4, 6), dtype="float32")
+    a = builder.call("cast", [x, builder.const("float16")])
+    b = builder.call("reshape", [a, builder.const((6, 4)), builder.const(False)])
+    c = builder.call("cast", [b, builder.const("float32")])
+    out = builder.call("softmax", [c, builder.const(-1)])
+    func = tvm.relay.Function([x], builder.ret(out))
+    text = run_eliminate_cast(func)
+    assert "raf.op.cast" not in text, text
+    assert "raf.op.reshape(%x" in text, text
+
+
+def test_sink_widening_cast():
+    # transpose(cast(x, fp32)) becomes cast(transpose(x), fp32), so transpose runs in fp16.
+    builder = ANFBuilder()
+    x = extended_var("x", shape=(4, 6), dtype="float16")
+    a = builder.call("cast", [x, builder.const("float32")])
+    b = builder.call("transpose", [a, builder.const((1, 0))])
+    out = builder.call("softmax", [b, builder.const(-1)])
+    func = tvm.relay.Function([x], builder.ret(out))
+    text = run_eliminate_cast(func)
+    lines = [line for line in text.split("\n") if "let " in line]
+    assert len(lines) == 3, text
+    assert "raf.op.transpose(%x" in lines[0], text
+    assert "raf.op.cast" in lines[1], text
+
+
+def test_keep_shared_cast():
+    # The cast is used by two ops, so it is not moved.
+    builder = ANFBuilder()
+    x = extended_var("x", shape=(4, 6), dtype="float16")
+    a = builder.call("cast", [x, builder.const("float32")])
+    b = builder.call("transpose", [a, builder.const((1, 0))])
+    c = builder.call("softmax", [a, builder.const(-1)])
+    out = builder.make_tuple([b, c])
+    func = tvm.relay.Function([x], builder.ret(out))
+    text = run_eliminate_cast(func)
+    assert text.count("raf.op.cast") == 1, text
+    assert "raf.op.transpose(%x" not in text, text
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
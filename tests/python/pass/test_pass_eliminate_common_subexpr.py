@@ -0,0 +1,75 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=invalid-name,protected-access
+import pytest
+import tvm
+
+import raf
+from raf._ffi.pass_ import EliminateCommonSubexpr, InferType, ToGraphNormalForm
+from raf._core.ir_ext import extended_var
+from raf.ir import ANFBuilder
+
+
+def run_cse(func, gnf=False):
+    mod = tvm.IRModule()
+    mod["main"] = func
+    mod = InferType()(mod)
+    if gnf:
+        mod = ToGraphNormalForm()(mod)
+    mod = EliminateCommonSubexpr()(mod)
+    return raf.ir.AsText(mod["main"])
+
+
+def construct_transpose_func():
+    # The backward computes transpose(w) again for each branch.
+    builder = ANFBuilder()
+    x = extended_var("x", shape=(4, 6), dtype="float32")
+    w = extended_var("w", shape=(8, 6), dtype="float32")
+    t1 = builder.call("transpose", [w, builder.const((1, 0))])
+    a = builder.call("matmul", [x, t1])
+    t2 = builder.call("transpose", [w, builder.const((1, 0))])
+    b = builder.call("matmul", [x, t2])
+    out = builder.call("add", [a, b, raf.ir.const(None), raf.ir.const(None)])
+    return tvm.relay.Function([x, w], builder.ret(out))
+
+
+@pytest.mark.parametrize("gnf", [False, True])
+def test_redundant_op(gnf):
+    text = run_cse(construct_transpose_func(), gnf)
+    assert text.count("raf.op.transpose(") == 1, text
+    # The second matmul is the same as the first one after the transpose is replaced.
+    assert text.count("raf.op.matmul(") == 1, text
+
+
+def test_different_attrs():
+    builder = ANFBuilder()
+    x = extended_var("x", shape=(4, 6), dtype="float32")
+    a = builder.call("cast", [x, builder.const("float16")])
+    b = builder.call("cast", [x, builder.const("bfloat16")])
+    c = builder.call("cast", [x, builder.const("float16")])
+    out = builder.make_tuple([a, b, c])
+    func = tvm.relay.Function([x], builder.ret(out))
+    text = run_cse(func)
+    assert text.count("raf.op.cast(") == 2, text
+
+
+def test_keep_stateful_ops():
+    builder = ANFBuilder()
+    x = extended_var("x", shape=(4, 6), dtype="float32")
+    y = extended_var("y", shape=(4, 6), dtype="float32")
+    # The dropouts draw different masks.
+    d1 = builder.call("_contrib_dropout", [x, builder.const(0.5)])
+    d2 = builder.call("_contrib_dropout", [x, builder.const(0.5)])
+    # The adds update y in place.
+    a1 = builder.call("add", [x, x, y, raf.ir.const(None)])
+    a2 = builder.call("add", [x, x, y, raf.ir.const(None)])
+    out = builder.make_tuple([d1, d2, a1, a2])
+    func = tvm.relay.Function([x, y], builder.ret(out))
+    text = run_cse(func)
+    assert text.count("raf.op._contrib_dropout(") == 2, text
+    assert text.count("raf.op.add(") == 2, text
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -468,6 +468,57 @@ def test_multi_user_allreduce(shape, comp_stream, comm_stream):
     dctx.enable_data_parallel = False
 
 
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("shape,comp_stream,comm_stream,fuse_tensor_stream", [[(64, 128), 1, 4, 5]])
+def test_shared_event(shape, comp_stream, comm_stream, fuse_tensor_stream):
+    dctx = dist.get_context()
+    dctx.enable_data_parallel = True
+
+    with Device("cuda(0)"):
+
+        def construct_model_func():
+            # The tuple is consumed in both the communication and the fuse tensor streams, which
+            # wait for the single event after it.
+            # atan (0) -> tuple (1) -> allreduce (2) ---> tuple (4)
+            #                      \-> fuse_tensor (3) -/
+            builder = ANFBuilder()
+            x = extended_var("x", shape=shape)
+            x_1 = builder.call("atan", [x])
+            x_2i = builder.make_tuple([x_1])
+            x_2 = builder.call("_allreduce", [x_2i, raf.ir.const("sum"), raf.ir.const(None)])
+            x_3 = builder.call("fuse_tensor", [x_2i])
+            x_4 = builder.make_tuple([x_2, x_3])
+            return tvm.relay.Function([x], builder.ret(x_4))
+
+        def expected():
+            builder = ANFBuilder()
+            x = extended_var("x", shape=shape)
+            builder.set_stream(0, comp_stream)
+            x_1 = builder.call("atan", [x])
+            x_2i = builder.make_tuple([x_1])
+            builder.add_event(1, comp_stream)
+            builder.set_stream(0, comm_stream)
+            builder.wait_event(1, comm_stream)
+            x_2 = builder.call("_allreduce", [x_2i, raf.ir.const("sum"), raf.ir.const(None)])
+            builder.add_event(2, comm_stream)
+            builder.set_stream(0, fuse_tensor_stream)
+            builder.wait_event(1, fuse_tensor_stream)
+            x_3 = builder.call("fuse_tensor", [x_2i])
+            builder.add_event(3, fuse_tensor_stream)
+            builder.set_stream(0, comp_stream)
+            builder.wait_event(2, comp_stream)
+            builder.wait_event(3, comp_stream)
+            x_4 = builder.make_tuple([x_2, x_3])
+            return tvm.relay.Function([x], builder.ret(x_4))
+
+        mod = tvm.IRModule()
+        mod["main"] = construct_model_func()
+        mod = RAFSequential([EnforceSync()])(mod)
+
+    assert tvm.ir.structural_equal(mod["main"], expected())
+    dctx.enable_data_parallel = False
+
+
 @pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
 @pytest.mark.parametrize(
     "shape,comp_stream,fuse_tensor_stream,defuse_tensor_stream", [[(64, 128), 1, 5, 6]]
@@ -2,8 +2,11 @@
 # SPDX-License-Identifier: Apache-2.0
 
 import pytest
+import torch
 import raf
-from raf.testing import get_testable_devices, randn, check
+from raf._core.device import Device
+from raf.model.trace import _get_func_inputs
+from raf.testing import get_testable_devices, randn, randn_torch, check
 import tvm
 
 
@@ -83,5 +86,51 @@ def test_fold_const_ir(device, shape):
     assert tvm.ir.structural_equal(func_folded, func_expected)
 
 
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_simplify_inference(device):
+    # pylint: disable=protected-access, attribute-defined-outside-init, no-self-use
+    class ConvBN(raf.Model):
+        def build(self):
+            self.w, self.t_w = randn_torch((4, 3, 3, 3), device=device)
+            self.mean, self.t_mean = randn_torch((4,), device=device)
+            self.var, self.t_var = randn_torch((4,), device=device, positive=True)
+            self.gamma, self.t_gamma = randn_torch((4,), device=device)
+            self.beta, self.t_beta = randn_torch((4,), device=device)
+            self.dense, self.t_dense = randn_torch((16, 256), device=device)
+
+        @raf.model.trace
+        def forward(self, x):
+            y = raf.conv2d(x, self.w, padding=1)
+            y = raf.batch_norm_infer(y, self.mean, self.var, self.gamma, self.beta, 0.1, 1e-5)
+            return raf.matmul_nt(raf.reshape(y, (2, 256)), self.dense)
+
+    model = ConvBN()
+    model.infer_mode()
+    m_x, t_x = randn_torch((2, 3, 8, 8), device=device)
+
+    record = model._internal(m_x)
+    args = _get_func_inputs(record, [m_x], {})
+    func = raf._ffi.pass_.BindParam(record.mod["main"], args)
+    mod = raf._core.module.IRModule.from_expr(func)
+    seq = raf.ir.RAFSequential(
+        [
+            raf._ffi.pass_.SimplifyInference(),
+            raf._ffi.pass_.FoldConstant(),
+            raf._ffi.pass_.DeadCodeElimination(),
+        ]
+    )
+    with Device(device):
+        text = raf.ir.AsText(seq(mod))
+    assert "batch_norm_infer" not in text
+    assert "matmul_nt" not in text
+    assert "sqrt" not in text
+
+    t_y = torch.nn.functional.conv2d(t_x, model.t_w, padding=1)
+    t_y = torch.nn.functional.batch_norm(
+        t_y, model.t_mean, model.t_var, model.t_gamma, model.t_beta, False, 0.1, 1e-5
+    )
+    t_y = torch.matmul(t_y.reshape(2, 256), model.t_dense.t())
+    check(model(m_x), t_y, rtol=1e-4, atol=1e-4)
+
 if __name__ == "__main__":
     pytest.main([__file__])
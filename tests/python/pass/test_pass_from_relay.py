@@ -1375,5 +1375,28 @@ def test_cumsum(shape, axis, exclusive):
     check_from_relay(m_model, r_func, [m_x])
 
 
+def test_deep_graph():
+    # The deep graph in the graph normal form is converted without recursion, and the softmax ops
+    # with the equal attributes reuse the converted attributes.
+    depth = 2000
+    shape = (2, 4)
+    r_x = _relay.var("x", shape=shape)
+    r_out = r_x
+    for _ in range(depth):
+        r_out = _relay.tanh(_relay.nn.softmax(r_out, axis=1))
+    r_mod = _tvm.IRModule.from_expr(_relay.Function([r_x], r_out))
+    m_mod = FromRelay()(r_mod)
+    assert InferType()(m_mod), "Type error of the model from Relay"
+
+    m_x, n_x = randn(shape)
+    n_out = n_x
+    for _ in range(depth):
+        n_exp = np.exp(n_out - n_out.max(axis=1, keepdims=True))
+        n_out = np.tanh(n_exp / n_exp.sum(axis=1, keepdims=True))
+    model = FrameworkModel(m_mod, m_mod, {}, {})
+    model.infer_mode()
+    check(model(m_x), n_out)
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
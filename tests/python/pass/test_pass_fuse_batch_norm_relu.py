@@ -0,0 +1,78 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access, attribute-defined-outside-init
+import numpy as np
+import pytest
+
+import raf
+from raf._ffi.pass_ import FuseBatchNormReLU, InferType
+from raf.ir import AsText
+from raf.model import BatchNorm, Conv2d
+from raf.testing import check, get_testable_devices, randn, run_vm_model, with_seed
+
+
+class Block(raf.Model):
+    def build(self, channels, downsample):
+        self.downsample = downsample
+        self.conv1 = Conv2d(channels, channels, 3, padding=1, bias=False)
+        self.bn1 = BatchNorm(channels)
+        self.conv2 = Conv2d(channels, channels, 3, padding=1, bias=False)
+        self.bn2 = BatchNorm(channels)
+        if downsample:
+            self.conv3 = Conv2d(channels, channels, 1, bias=False)
+            self.bn3 = BatchNorm(channels)
+
+    @raf.model.trace
+    def forward(self, x):
+        out = raf.relu(self.bn1(self.conv1(x)))
+        out = self.bn2(self.conv2(out))
+        # The residual of the downsample is computed after the batch norm it is added to.
+        identity = self.bn3(self.conv3(x)) if self.downsample else x
+        return raf.relu(raf.add(out, identity))
+
+
+def count_ops(mod, op_name):
+    text = AsText(InferType()(mod)["main"])
+    return sum(line.find(op_name + "(") != -1 for line in text.split("\n"))
+
+
+@pytest.mark.parametrize("downsample", [False, True])
+def test_fuse_block(downsample):
+    model = Block(4, downsample)
+    model.train_mode()
+    m_x, _ = randn((2, 4, 6, 6))
+    mod = InferType()(model._internal(m_x).mod)
+    mod = FuseBatchNormReLU()(mod)
+    num_bn = 3 if downsample else 2
+    assert count_ops(mod, "raf.op._contrib_batch_norm_add_relu_train") == 2
+    assert count_ops(mod, "raf.op.batch_norm_train") == num_bn - 2
+    assert count_ops(mod, "raf.op.relu") == 0
+    assert count_ops(mod, "raf.op.add") == 0
+
+
+@with_seed(0)
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_traced_sgd(device):
+    results = []
+    for enabled in [False, True]:
+        np.random.seed(0)
+        model = Block(4, True)
+        model.to(device=device)
+        model.train_mode()
+        optimizer = raf.optim.sgd.with_sgd(learning_rate=0.1, momentum=0.01)(model)
+        m_x, _ = randn((2, 4, 6, 6), device=device)
+        m_dy, _ = randn((2, 4, 6, 6), device=device)
+        config = {"raf.optimize.fuse_batch_norm_relu": enabled}
+        with raf.ir.PassContext(config=config):
+            for _ in range(2):
+                run_vm_model(optimizer, device, [m_dy, m_x])
+        results.append(
+            [model.conv1.w, model.bn1.w, model.bn2.b, model.bn3.w, model.bn2.running_mean]
+        )
+    for ref, out in zip(*results):
+        check(out, ref, rtol=1e-4, atol=1e-4)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -714,5 +714,41 @@ def test_deduplicate():
     assert tvm.ir.structural_equal(mod_after["main"], func_expected)
 
 
+@pytest.mark.parametrize("horizontal", [False, True])
+def test_horizontal_fuse(horizontal):
+    shape = (4, 8)
+    b_1, _ = randn(shape, device="cpu")
+    b_2, _ = randn(shape, device="cpu")
+
+    class Model(raf.Model):
+        def build(self):
+            self.b_1 = b_1
+            self.b_2 = b_2
+
+        @raf.model.trace
+        def forward(self, x):
+            # Independent ops with the same output type that cannot be fused vertically.
+            y_1 = raf.add(x, self.b_1)
+            y_2 = raf.add(x, self.b_2)
+            y_3 = raf.tanh(x)
+            # A reduction is not fused with the elementwise ops.
+            y_4 = raf.sum(x, axis=1)
+            return y_1, y_2, y_3, y_4
+
+    model = Model()
+    m_x, _ = randn(shape, device="cpu")
+    mod = model._internal(m_x).mod
+    with raf.ir.PassContext(config={"raf.fuse_tvm.horizontal": horizontal}):
+        mod = fuse_module(mod)
+    text = raf.ir.AsText(mod["main"])
+    if horizontal:
+        assert text.count("Primitive=1") == 1, text
+        assert text.count("raf.op.tvm.add(") == 2, text
+        assert text.count("raf.op.tvm.tanh(") == 1, text
+        assert "raf.op.sum(" in text, text
+    else:
+        assert "Primitive=1" not in text, text
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
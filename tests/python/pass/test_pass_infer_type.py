@@ -51,6 +51,33 @@ def test_raf_module():
     assert mod[main].checked_type == expected_ty
 
 
+@pytest.mark.parametrize("num_threads", [1, 4])
+def test_parallel_functions(num_threads):
+    shapes = [(1, 100), (2, 50), (4, 25), (5, 20)]
+    funcs = [relay.GlobalVar("f%d" % i) for i in range(len(shapes))]
+    main = relay.GlobalVar("main")
+
+    tvm_mod = tvm.IRModule()
+    for func, shape in zip(funcs, shapes):
+        x = relay.var("x", shape=shape)
+        tvm_mod[func] = relay.Function([x], relay.tanh(relay.add(x, x)))
+    tvm_mod = relay.transform.InferType()(tvm_mod)
+    y = relay.var("y", shape=shapes[0])
+    tvm_mod[main] = relay.Function([y], funcs[0](y))
+    tvm_mod = relay.transform.InferType()(tvm_mod)
+
+    mod = FromRelay()(tvm_mod)
+    with raf.ir.PassContext(config={"raf.type_infer.num_threads": num_threads}):
+        mod = InferType()(mod)
+        # The re-inference reuses the cached types of the primitives and gets the same types.
+        mod = InferType()(mod)
+    for func, shape in zip(funcs, shapes):
+        t_x = relay.TensorType(shape)
+        assert mod[func].checked_type == relay.FuncType([t_x], t_x)
+    t_y = relay.TensorType(shapes[0])
+    assert mod[main].checked_type == relay.FuncType([t_y], t_y)
+
+
 def test_raf_recursive_function():
     f1 = relay.GlobalVar("f1")
     main = relay.GlobalVar("main")
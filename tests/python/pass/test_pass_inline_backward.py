@@ -7,7 +7,8 @@ import tvm
 from tvm import relay
 import raf
 from raf.ir import RAFSequential
-from raf.testing import randn
+from raf.optim.optim import with_autodiff
+from raf.testing import randn, check, run_vm_model
 
 
 def test_basic():
@@ -94,5 +95,57 @@ def test_no_backward():
     assert tvm.ir.structural_equal(inlined_func, func)
 
 
+@pytest.mark.parametrize("use_checkpoint", [True, False])
+def test_checkpoint(use_checkpoint):
+    class Model(raf.Model):
+        def build(self, checkpoint):
+            self.checkpoint = checkpoint
+            self.w1, _ = randn((8, 8))
+            self.w2, _ = randn((8, 8))
+            self.w3, _ = randn((8, 8))
+
+        @raf.model.trace
+        def forward(self, x):
+            y = raf.tanh(raf.matmul(x, self.w1))
+            if self.checkpoint:
+                y = raf.checkpoint(y)
+            y = raf.tanh(raf.matmul(y, self.w2))
+            if self.checkpoint:
+                y = raf.checkpoint(y)
+            return raf.tanh(raf.matmul(y, self.w3))
+
+    def run(model, m_x, m_dy):
+        model.train_mode()
+        return run_vm_model(with_autodiff(model), "cpu", [m_dy, m_x])
+
+    m_x, _ = randn((4, 8), requires_grad=True)
+    m_dy, _ = randn((4, 8))
+    model = Model(use_checkpoint)
+    ref_model = Model(False)
+    for name in ["w1", "w2", "w3"]:
+        setattr(ref_model, name, getattr(model, name))
+
+    model.train_mode()
+    record = model._internal(m_x)
+    seq = RAFSequential(
+        [
+            raf._ffi.pass_.InferType(),
+            raf._ffi.pass_.AutoDiff(record.requires_grads),
+            raf._ffi.pass_.InlineBackward(),
+        ]
+    )
+    text = raf.ir.AsText(seq(record.mod)["main"])
+    # The activations of the first two segments are recomputed in the backward, while the last
+    # segment keeps its activations.
+    num_recomputed = 4 if use_checkpoint else 0
+    assert text.count("_recompute = raf.op.") == num_recomputed, text
+
+    out = run(model, m_x, m_dy)
+    ref = run(ref_model, m_x, m_dy)
+    check(out[0], ref[0])
+    for grad, ref_grad in zip(out[1], ref[1]):
+        check(grad, ref_grad, rtol=1e-5, atol=1e-5)
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
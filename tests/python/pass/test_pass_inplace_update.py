@@ -336,6 +336,28 @@ def test_allreduce_with_list():
     assert bytecode.count("alloc_tensor") == 2
 
 
+def test_sgd():
+    shape = (4, 4)
+    device = "cpu"
+
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, dx, v):
+            out = raf.sgd(x, dx, v, 0.1, 0.01)
+            return out[0], out[1]
+
+    model = Model()
+    x, _ = randn(shape, device=device)
+    dx, _ = randn(shape, device=device)
+    v, _ = randn(shape, device=device)
+    # The weight and the momentum are updated in place without allocating new buffers.
+    bytecode = compile_vm_model(model, device, [x, dx, v])
+    assert bytecode.count("alloc_tensor") == 0
+
+
 def test_simplify():
     def get_mod():
         add_op = raf._ffi.op.GetOp("raf.op.add")
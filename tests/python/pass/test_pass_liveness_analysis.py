@@ -7,15 +7,24 @@ import pytest
 import raf
 from raf._lib import tvm, relay
 from raf.ir import ScopeBuilder
-from raf._ffi.pass_ import InferType, LivenessAnalysis, ManifestAlloc
+from raf._ffi.pass_ import InferType, LivenessAnalysis, LivenessAnalysisMoveBinding, ManifestAlloc
 from raf.testing import randn
 
 
-def verify_live_in_set(mod, expected):
+def verify_live_in_set(mod, expected, move=None):
     mod = InferType()(mod)
 
     # Check liveness analysis result.
-    ret = LivenessAnalysis(mod)
+    if move is None:
+        ret = LivenessAnalysis(mod)
+    else:
+        # Move the binding before the other one and update the analysis incrementally.
+        let_vars = {}
+        body = mod["main"].body
+        while isinstance(body, relay.Let):
+            let_vars[body.var.name_hint] = body.var
+            body = body.body
+        ret = LivenessAnalysisMoveBinding(mod, let_vars[move[0]], let_vars[move[1]])
     ret = {key.name_hint: {v.name_hint for v in var_list} for key, var_list in ret.items()}
 
     missed = {}
@@ -213,6 +222,28 @@ def test_direct_assign():
     verify_live_in_set(mod, expected)
 
 
+@pytest.mark.parametrize("move", [["a2", "a1"], ["a1", "a3"]])
+def test_incremental_move(move):
+    sb = ScopeBuilder()
+    p0 = raf.ir.var("p0", shape=(10, 10))
+    p1 = raf.ir.var("p1", shape=(10, 10))
+    a_1 = sb.let("a1", raf.ir.op.relu(p0))
+    a_2 = sb.let("a2", raf.ir.op.relu(p1))
+    a_3 = sb.let("a3", raf.ir.op.add(a_1, a_2))
+    sb.ret(a_3)
+    mod = tvm.IRModule.from_expr(relay.Function([p0, p1], sb.get()))
+
+    # Both moves result in the order of a2, a1, a3.
+    expected = {
+        "n_0": {},
+        "a2": {"param_0", "param_1"},
+        "a1": {"param_0", "t_1"},
+        "a3": {"t_0", "t_1"},
+        "n_1": {"t_2"},
+    }
+    verify_live_in_set(mod, expected, move)
+
+
 def test_reshape():
     shape = (10, 10)
 
@@ -0,0 +1,66 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=invalid-name,protected-access,too-many-locals
+import pytest
+import tvm
+
+import raf
+from raf._core.device import Device
+from raf._ffi.pass_ import ManagedMemoryHint, InferType
+from raf._core.ir_ext import extended_var
+from raf.ir import ANFBuilder
+
+
+def construct_model_func(shape):
+    """A model whose first activation is used again after a few ops."""
+    builder = ANFBuilder()
+    x = extended_var("x", shape=shape, dtype="float32")
+    w = extended_var("w", shape=shape, dtype="float32")
+    a1 = builder.call("matmul", [x, w])
+    a2 = builder.call("relu", [a1])
+    a3 = builder.call("relu", [a2])
+    a4 = builder.call("relu", [a3])
+    a5 = builder.call("relu", [a4])
+    out = builder.call("add", [a5, a1, raf.ir.const(None), raf.ir.const(None)])
+    return tvm.relay.Function([x, w], builder.ret(out))
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize(
+    "distance,n_hint",
+    [
+        [0, 0],  # Disabled.
+        [1, 3],  # Hint the parameters and the first activation.
+        [3, 2],  # The first activation is used again too soon to evict.
+    ],
+)
+def test_managed_memory_hint(distance, n_hint):
+    # Each tensor is 4 MBs.
+    shape = [1024, 1024]
+    mod = tvm.IRModule()
+    mod["main"] = construct_model_func(shape)
+    with Device("cuda"):
+        with raf.ir.PassContext(config={"raf.managed_memory.prefetch_distance": distance}):
+            mod = InferType()(mod)
+            mod = ManagedMemoryHint()(mod)
+    text = raf.ir.AsText(mod["main"])
+    assert text.count("raf.op.memory_prefetch(") == n_hint, text
+    assert text.count("raf.op.memory_evict(") == n_hint, text
+    if n_hint == 0:
+        return
+    lines = [line for line in text.split("\n") if "let " in line]
+    ops = [line for line in lines if "memory_" not in line]
+    # The parameters are prefetched before the first op, and evicted after it.
+    matmul = next(i for i, line in enumerate(lines) if "raf.op.matmul(" in line)
+    assert all("memory_prefetch" in line for line in lines[:matmul]), text
+    assert all("memory_evict" in line for line in lines[matmul + 1 : matmul + n_hint]), text
+    if n_hint == 3:
+        # The first activation is prefetched one op ahead of the add.
+        add = next(i for i, line in enumerate(lines) if "raf.op.add(" in line)
+        assert "memory_prefetch" in lines[add - 2] and "raf.op.relu(" in lines[add - 1], text
+        assert len(ops) == 6, text
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
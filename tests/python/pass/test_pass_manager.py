@@ -156,5 +156,27 @@ def test_sequential_pass():
     assert isinstance(ret_mod["mySub"].body.checked_type, tvm.ir.TensorType)
 
 
+@pytest.mark.parametrize("num_threads", [1, 4])
+def test_parallel_function_pass(num_threads):
+    tp = relay.TensorType((10,), "float32")
+    funcs = {}
+    for i in range(8):
+        x = relay.var("x", tp)
+        funcs[relay.GlobalVar("func%d" % i)] = relay.Function([x], relay.log(relay.abs(x)))
+    tvm_mod = FromRelay()(tvm.IRModule(funcs))
+
+    passes = [pass_.ToANormalForm(), pass_.InlineLet(), pass_.DeadCodeElimination()]
+    with PassContext(config={"raf.pass.num_threads": 1}):
+        expected = RAFSequential(passes=passes, opt_level=1, name="seq")(tvm_mod)
+    with PassContext(config={"raf.pass.num_threads": num_threads}):
+        ret_mod = RAFSequential(passes=passes, opt_level=1, name="seq")(tvm_mod)
+    assert [gv.name_hint for gv in ret_mod.get_global_vars()] == [
+        gv.name_hint for gv in expected.get_global_vars()
+    ]
+    for i in range(8):
+        name = "func%d" % i
+        assert tvm.ir.structural_equal(ret_mod[name], expected[name])
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
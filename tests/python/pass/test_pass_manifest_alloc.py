@@ -2,12 +2,13 @@
 # SPDX-License-Identifier: Apache-2.0
 
 # pylint: disable=no-self-use, protected-access, attribute-defined-outside-init
+import numpy as np
 import pytest
 import raf
 from raf._lib import tvm
 from raf._core.module import IRModule
 from raf._core.device import Device
-from raf.testing import get_testable_devices, randn
+from raf.testing import check, get_testable_devices, randn, run_vm_model
 
 
 @pytest.mark.parametrize("device", get_testable_devices())
@@ -149,6 +150,85 @@ def test_reshape():
     assert "squeeze" not in text
 
 
+class ViewModel(raf.Model):
+    def build(self):
+        pass
+
+    @raf.model.trace
+    def forward(self, x):
+        a = raf.split(x, 2, axis=0)
+        # Contiguous along the outermost axis, with an offset of 64 bytes.
+        b = raf.strided_slice(x, (1,), (3,), (1,), "end")
+        # Not contiguous, so it is still a kernel.
+        c = raf.strided_slice(x, (0, 0), (4, 8), (1, 1), "end")
+        return raf.add(a[0], b), raf.add(a[1], a[0]), c
+
+
+def test_view():
+    m_x, _ = randn([4, 16], device="cpu")
+    func = ViewModel()._internal(m_x).mod["main"]
+    mod = IRModule.from_expr(func)
+    mod = raf._ffi.pass_.ToANormalForm()(mod)
+    mod = raf._ffi.pass_.InferType()(mod)
+    with Device("cpu"):
+        mod = raf._ffi.pass_.ManifestAlloc()(mod)
+    text = mod["main"].astext()
+    assert text.count("vm.set_shape") == 3
+    assert "split" not in text
+    assert text.count("strided_slice") == 1
+    assert "int64(128)" in text
+    assert "int64(64))" in text
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_view_vm(device):
+    m_x, n_x = randn([4, 16], device=device)
+    outs = run_vm_model(ViewModel(), device, [m_x], disable_fusion=True)
+    check(outs[0], n_x[:2] + n_x[1:3])
+    check(outs[1], n_x[2:] + n_x[:2])
+    check(outs[2], n_x[:, :8])
+
+
+class ConcatModel(raf.Model):
+    def build(self):
+        pass
+
+    @raf.model.trace
+    def forward(self, x, y):
+        a = raf.relu(x)
+        b = raf.tanh(y)
+        # The inputs are written to the slices of the output, so concatenate copies nothing.
+        c = raf.concatenate([a, b], axis=0)
+        # The second input is not produced in the function, so it is still a kernel.
+        d = raf.concatenate([raf.relu(c), y], axis=0)
+        return c, d
+
+
+def test_concat():
+    m_x, _ = randn([2, 16], device="cpu")
+    m_y, _ = randn([2, 16], device="cpu")
+    func = ConcatModel()._internal(m_x, m_y).mod["main"]
+    mod = IRModule.from_expr(func)
+    mod = raf._ffi.pass_.ToANormalForm()(mod)
+    mod = raf._ffi.pass_.InferType()(mod)
+    with Device("cpu"):
+        mod = raf._ffi.pass_.ManifestAlloc()(mod)
+    text = mod["main"].astext()
+    assert text.count("vm.set_shape") == 2
+    assert text.count("concatenate") == 1
+    assert "int64(128))" in text
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_concat_vm(device):
+    m_x, n_x = randn([2, 16], device=device)
+    m_y, n_y = randn([2, 16], device=device)
+    outs = run_vm_model(ConcatModel(), device, [m_x, m_y], disable_fusion=True)
+    n_c = np.concatenate([np.maximum(n_x, 0), np.tanh(n_y)], axis=0)
+    check(outs[0], n_c)
+    check(outs[1], np.concatenate([np.maximum(n_c, 0), n_y], axis=0))
+
+
 def test_device():
     shape = [5, 5]
 
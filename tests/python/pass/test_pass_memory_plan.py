@@ -6,6 +6,8 @@
 import pytest
 import raf
 from raf._lib import tvm
+from raf._core.executor import VMExecutor
+from raf.model.trace import _get_func_inputs
 from raf.testing import get_testable_devices, randn, check, run_vm_model
 
 
@@ -167,5 +169,95 @@ def test_set_shape():
     verify_correctness(model, "cpu", args, fusion=False)
 
 
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_static_arena(device):
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, a, b, c, d):
+            t0 = raf.add(a, a)
+            t1 = raf.add(t0, b)
+            t2 = raf.add(t1, c)
+            t3 = raf.add(t2, t0)
+            t4 = raf.add(t3, d)
+            return t4
+
+    shape = (5, 5)
+    model = Model()
+    model.infer_mode()
+    args = [randn(shape, device=device)[0] for _ in range(4)]
+    record = model._internal(*args)
+    mod = record.mod
+
+    device_name = device if device != "cpu" else "llvm"
+    with tvm.transform.PassContext(
+        opt_level=3,
+        disabled_pass=["FuseDialect", "FuseTVM"],
+        config={"raf.memory_plan.static_arena": True},
+    ):
+        opt_mod, _ = raf._core.vm.VMCompiler().optimize(mod, device=device_name, params={})
+        # All intermediate tensors are placed in one arena, which is freed once.
+        text = raf.ir.AsText(opt_mod["main"])
+        assert text.count("raf.op.vm.alloc_storage") == 2
+        assert text.count("raf.op.vm.alloc_tensor") == 5
+        assert text.count("raf.op.vm.free") == 1
+        vm_inputs = _get_func_inputs(record, args, {}, get_handle=False)
+        outs = VMExecutor(mod, device).make_executor()(*vm_inputs)
+
+    check(model(*args), outs)
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+@pytest.mark.parametrize("static_arena", [False, True])
+def test_multi_stream(device, static_arena):
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            # p_1 is allocated on stream 1 but also used by p_1a on stream 0, so its storage
+            # cannot be released until stream 1 is synchronized with stream 0.
+            p_0 = raf.atan(x)
+            p_1 = raf.atan(x)
+            p_1 = raf.atan(p_1)
+            p_1a = raf.atan(p_1)
+            p_1b = raf.atan(p_1)
+            p_1 = raf.concatenate([p_1a, p_1b])
+            p_2 = raf.atan(x)
+            p_2 = raf.atan(p_2)
+            p_2 = raf.atan(p_2)
+            return raf.concatenate([p_0, p_1, p_2])
+
+    model = Model()
+    model.infer_mode()
+    m_x, _ = randn((64, 64), device=device)
+    record = model._internal(m_x)
+    mod = record.mod
+
+    device_name = device if device != "cpu" else "llvm"
+    config = {
+        "raf.stream_schedule.policy": "wavefront",
+        "raf.memory_plan.static_arena": static_arena,
+    }
+    with tvm.transform.PassContext(
+        opt_level=3, disabled_pass=["FuseDialect", "FuseTVM"], config=config
+    ):
+        opt_mod, _ = raf._core.vm.VMCompiler().optimize(mod, device=device_name, params={})
+        text = raf.ir.AsText(opt_mod["main"])
+        # Stream 0 waits for p_1 before p_1a, but the storage of p_1 is not released after p_1b,
+        # which is its last use in the ANF order, until the stream barrier.
+        last_wait = text.rfind("raf.op.wait_event")
+        last_barrier = text.rfind("raf.op.stream_barrier")
+        assert 0 <= last_wait < last_barrier
+        assert text.count("raf.op.vm.free", last_wait, last_barrier) == 0
+        vm_inputs = _get_func_inputs(record, [m_x], {}, get_handle=False)
+        outs = VMExecutor(mod, device).make_executor()(*vm_inputs)
+
+    check(model(m_x), outs)
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
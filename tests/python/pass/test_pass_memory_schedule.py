@@ -10,8 +10,9 @@ from raf._ffi.pass_ import InferType, InplaceUpdate, MemorySchedule
 from raf.ir import ScopeBuilder
 
 
-def check_ir(mod, expected):
-    with raf.ir.PassContext(config={"raf.memory_schedule": True}):
+def check_ir(mod, expected, policy="greedy"):
+    config = {"raf.memory_schedule": True, "raf.memory_schedule.policy": policy}
+    with raf.ir.PassContext(config=config):
         mod = InplaceUpdate()(mod)
         mod = InferType()(mod)
         mod = MemorySchedule()(mod)
@@ -112,5 +113,36 @@ def test_no_let():
     check_ir(*get_mod_n_expected())
 
 
+def test_optimal():
+    shape = (1024, 1024)
+
+    def get_mod_n_expected():
+        relu_op = raf._ffi.op.GetOp("raf.op.relu")
+        sum_op = raf._ffi.op.GetOp("raf.op.sum")
+        add_op = raf._ffi.op.GetOp("raf.op.add")
+        null = raf.ir.const(None)
+
+        def build(reduce_first):
+            sb = ScopeBuilder()
+            param0 = raf.ir.var("param0", shape=shape)
+            param1 = raf.ir.var("param1", shape=shape)
+            a_1 = sb.let("a1", relay.Call(relu_op, [param0]))
+            if reduce_first:
+                a_3 = sb.let("a3", relay.Call(sum_op, [a_1, raf.ir.const(0)]))
+            a_2 = sb.let("a2", relay.Call(relu_op, [param1]))
+            if not reduce_first:
+                a_3 = sb.let("a3", relay.Call(sum_op, [a_1, raf.ir.const(0)]))
+            a_4 = sb.let("a4", relay.Call(sum_op, [a_2, raf.ir.const(0)]))
+            a_5 = sb.let("a5", relay.Call(add_op, [a_3, a_4, null, null]))
+            sb.ret(a_5)
+            func = relay.Function([param0, param1], sb.get())
+            return tvm.IRModule.from_expr(func)
+
+        # Reducing a1 before computing a2 avoids keeping both of them alive.
+        return InferType()(build(False)), InferType()(build(True))
+
+    check_ir(*get_mod_n_expected(), policy="optimal")
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
@@ -0,0 +1,109 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access, attribute-defined-outside-init
+import numpy as np
+import pytest
+
+import raf
+from raf._ffi.pass_ import MergeSiblingGemm, InferType
+from raf.ir import AsText
+from raf.testing import check, get_testable_devices, randn, run_vm_model, with_seed
+
+
+class QKV(raf.Model):
+    def build(self, hidden):
+        self.w_q, _ = randn((hidden, hidden), requires_grad=True)
+        self.w_k, _ = randn((hidden, hidden), requires_grad=True)
+        self.w_v, _ = randn((hidden // 2, hidden), requires_grad=True)
+
+    @raf.model.trace
+    def forward(self, x):
+        q = raf.dense(x, self.w_q)
+        k = raf.dense(x, self.w_k)
+        v = raf.dense(x, self.w_v)
+        return raf.matmul(raf.matmul_nt(q, k), v)
+
+
+def count_ops(mod, op_name):
+    text = AsText(InferType()(mod)["main"])
+    return sum(line.find(op_name + "(") != -1 for line in text.split("\n"))
+
+
+def test_merge_qkv():
+    model = QKV(8)
+    model.infer_mode()
+    m_x, _ = randn((4, 8))
+    mod = InferType()(model._internal(m_x).mod)
+    mod = MergeSiblingGemm()(mod)
+    assert count_ops(mod, "raf.op.dense") == 1
+    assert count_ops(mod, "raf.op.concatenate") == 1
+    assert count_ops(mod, "raf.op.split") == 1
+    # The GEMMs that do not share an input are kept.
+    assert count_ops(mod, "raf.op.matmul_nt") == 1
+    assert count_ops(mod, "raf.op.matmul") == 1
+
+
+def test_keep_used_sibling():
+    class Model(raf.Model):
+        def build(self, hidden):
+            self.w_q, _ = randn((hidden, hidden))
+            self.w_k, _ = randn((hidden, hidden))
+
+        @raf.model.trace
+        def forward(self, x):
+            q = raf.dense(x, self.w_q)
+            # The weight of the sibling depends on the output of the first one.
+            k = raf.dense(x, raf.add(self.w_k, q))
+            return raf.add(q, k)
+
+    model = Model(4)
+    model.infer_mode()
+    m_x, _ = randn((4, 4))
+    mod = InferType()(model._internal(m_x).mod)
+    mod = MergeSiblingGemm()(mod)
+    assert count_ops(mod, "raf.op.dense") == 2
+    assert count_ops(mod, "raf.op.concatenate") == 0
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+@pytest.mark.parametrize("inference", [False, True])
+def test_merged_vm(device, inference):
+    model = QKV(8)
+    model.to(device=device)
+    model.infer_mode()
+    m_x, _ = randn((4, 8), device=device)
+    ref = run_vm_model(model, device, [m_x]).numpy()
+    config = {
+        "raf.vm.optimize.merge_sibling_gemm": True,
+        "raf.vm.optimize.inference": inference,
+    }
+    with raf.ir.PassContext(config=config):
+        out = run_vm_model(model, device, [m_x])
+    check(out, ref, rtol=1e-4, atol=1e-4)
+
+
+@with_seed(0)
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_traced_sgd(device):
+    results = []
+    for enabled in [False, True]:
+        np.random.seed(0)
+        model = QKV(8)
+        model.to(device=device)
+        model.train_mode()
+        optimizer = raf.optim.sgd.with_sgd(learning_rate=0.1, momentum=0.01)(model)
+        m_x, _ = randn((4, 8), device=device)
+        m_dy, _ = randn((4, 4), device=device)
+        # The weight gradients matmul_tn(dy, x) share x, which are merged along the rows.
+        config = {"raf.vm.optimize.merge_sibling_gemm": enabled}
+        with raf.ir.PassContext(config=config):
+            for _ in range(2):
+                run_vm_model(optimizer, device, [m_dy, m_x])
+        results.append([model.w_q, model.w_k, model.w_v])
+    for ref, out in zip(*results):
+        check(out, ref, rtol=1e-4, atol=1e-4)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -0,0 +1,71 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=invalid-name,protected-access,too-many-locals
+import pytest
+import tvm
+
+import raf
+from raf._core.device import Device
+from raf._ffi.pass_ import OffloadActivation, InferType
+from raf._core.ir_ext import extended_var
+from raf.ir import ANFBuilder
+
+
+def construct_model_func(shape):
+    """A two-layer model with its forward output and gradients, where both activations of the
+    forward are used in the backward."""
+    builder = ANFBuilder()
+    x = extended_var("x", shape=shape, dtype="float32")
+    w1 = extended_var("w1", shape=shape, dtype="float32")
+    w2 = extended_var("w2", shape=shape, dtype="float32")
+    a1 = builder.call("matmul", [x, w1])
+    a2 = builder.call("matmul", [a1, w2])
+    out = builder.call("relu", [a2])
+    g1 = builder.call("matmul", [out, w2])
+    g2 = builder.call("matmul", [g1, a1])
+    g0 = builder.call("matmul", [a2, w1])
+    grads = builder.make_tuple([g2, g0])
+    ret = builder.make_tuple([out, grads])
+    return tvm.relay.Function([x, w1, w2], builder.ret(ret))
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize(
+    "budget_mbs,bandwidth,n_copy",
+    [
+        [100, 1000, 0],  # Fit into the budget.
+        [20, 1000, 2],  # Offload one activation because it is cheaper than recomputing.
+        [20, 1, 0],  # Leave it to rematerialization because the transfer is too slow.
+    ],
+)
+def test_offload_activation(budget_mbs, bandwidth, n_copy):
+    # Each tensor is 4 MBs.
+    shape = [1024, 1024]
+    mod = tvm.IRModule()
+    mod["main"] = construct_model_func(shape)
+    with Device("cuda"):
+        with raf.ir.PassContext(
+            config={
+                "raf.memory_budget": budget_mbs * 1048576,
+                "raf.offload.pcie_bandwidth": bandwidth,
+                "raf.offload.compute_tflops": 1,
+                "raf.remat.use_gflops_cost": True,
+            }
+        ):
+            mod = InferType()(mod)
+            mod = OffloadActivation()(mod)
+    text = raf.ir.AsText(mod["main"])
+    assert text.count("raf.op.device_copy(") == n_copy, text
+    if n_copy > 0:
+        # The first activation is offloaded after its producer and prefetched before the first
+        # backward op.
+        lines = [line for line in text.split("\n") if "let " in line]
+        offload = next(i for i, line in enumerate(lines) if "cuda_host" in line)
+        assert "raf.op.matmul(" in lines[offload - 1], text
+        prefetch = next(i for i, line in enumerate(lines) if "_prefetch" in line)
+        assert "raf.op.relu(" in lines[prefetch - 1], text
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
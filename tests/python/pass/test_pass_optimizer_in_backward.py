@@ -0,0 +1,89 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access, too-many-locals, attribute-defined-outside-init
+import numpy as np
+import pytest
+import tvm
+from tvm import relay
+
+import raf
+from raf._ffi.pass_ import OptimizerInBackward
+from raf.ir import ScopeBuilder
+from raf.model import Linear
+from raf.testing import check, get_testable_devices, randn, run_vm_model, with_seed
+
+
+def test_hoist_sgd():
+    shape = (4, 4)
+    matmul_op = raf._ffi.op.GetOp("raf.op.matmul")
+    matmul_tn_op = raf._ffi.op.GetOp("raf.op.matmul_tn")
+    matmul_nt_op = raf._ffi.op.GetOp("raf.op.matmul_nt")
+    sgd_op = raf._ffi.op.GetOp("raf.op.sgd")
+
+    def sgd(w, g, v):
+        consts = [raf.ir.const(0.1), raf.ir.const(0.9), raf.ir.const(None)]
+        return relay.Call(sgd_op, [w, g, v, *consts])
+
+    def get_func(hoisted):
+        sb = ScopeBuilder()
+        x = raf.ir.var("x", shape=shape)
+        dy = raf.ir.var("dy", shape=shape)
+        w1 = raf.ir.var("w1", shape=shape)
+        w2 = raf.ir.var("w2", shape=shape)
+        v1 = raf.ir.var("v1", shape=shape)
+        v2 = raf.ir.var("v2", shape=shape)
+        a1 = sb.let("a1", relay.Call(matmul_op, [x, w1]))
+        a2 = sb.let("a2", relay.Call(matmul_op, [a1, w2]))
+        # The gradient of a1 reads w2, so the update of w2 waits for it.
+        da1 = sb.let("da1", relay.Call(matmul_nt_op, [dy, w2]))
+        g2 = sb.let("g2", relay.Call(matmul_tn_op, [a1, dy]))
+        if hoisted:
+            s2 = sb.let("s2", sgd(w2, g2, v2))
+        g1 = sb.let("g1", relay.Call(matmul_tn_op, [x, da1]))
+        if not hoisted:
+            s2 = sb.let("s2", sgd(w2, g2, v2))
+        s1 = sb.let("s1", sgd(w1, g1, v1))
+        out = sb.let("out", relay.Tuple([a2, s1, s2]))
+        sb.ret(out)
+        return relay.Function([x, dy, w1, w2, v1, v2], sb.get())
+
+    mod = tvm.IRModule.from_expr(get_func(False))
+    mod = OptimizerInBackward()(mod)
+    assert tvm.ir.structural_equal(mod["main"], get_func(True)), "IR mismatch"
+
+
+class Model(raf.Model):
+    def build(self, units):
+        self.linear1 = Linear(units, units)
+        self.linear2 = Linear(units, units)
+
+    @raf.model.trace
+    def forward(self, x):
+        return raf.sum(self.linear2(raf.relu(self.linear1(x))))
+
+
+@with_seed(0)
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_traced_sgd(device):
+    units = 16
+    results = []
+    for enabled in [False, True]:
+        np.random.seed(0)
+        model = Model(units)
+        model.to(device=device)
+        model.train_mode()
+        optimizer = raf.optim.sgd.with_sgd(learning_rate=0.1, momentum=0.01)(model)
+        m_x, _ = randn((8, units), device=device)
+        m_dy = raf.array(np.array(1.0, dtype="float32"), device=device)
+        config = {"raf.vm.optimize.optimizer_in_backward": enabled}
+        with raf.ir.PassContext(config=config):
+            for _ in range(3):
+                run_vm_model(optimizer, device, [m_dy, m_x])
+        results.append([model.linear1.w, model.linear1.b, model.linear2.w, model.linear2.b])
+    for ref, out in zip(*results):
+        check(out, ref, rtol=1e-5, atol=1e-5)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -0,0 +1,58 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=invalid-name,protected-access,too-many-locals
+import pytest
+import tvm
+
+import raf
+from raf._ffi.pass_ import PartitionParameter
+from raf._core.ir_ext import extended_var
+from raf.ir import ANFBuilder
+
+
+def construct_model_func(shape):
+    """A two-layer model with its forward output and gradients, where both weights are used
+    in the forward and the backward."""
+    builder = ANFBuilder()
+    x = extended_var("x", shape=shape, dtype="float32")
+    w1 = extended_var("w1", shape=[shape[1], shape[1]], dtype="float32")
+    w2 = extended_var("w2", shape=[shape[1], shape[1]], dtype="float32")
+    a1 = builder.call("matmul", [x, w1])
+    a2 = builder.call("matmul", [a1, w2])
+    out = builder.call("relu", [a2])
+    g1 = builder.call("matmul", [a2, w2])
+    g0 = builder.call("matmul", [g1, w1])
+    grads = builder.make_tuple([g0, g1])
+    ret = builder.make_tuple([out, grads])
+    return tvm.relay.Function([x, w1, w2], builder.ret(ret))
+
+
+@pytest.mark.parametrize("n_part,n_slice", [[4, 0], [3, 4]])
+def test_partition_parameter(n_part, n_slice):
+    shape = [4, 8]
+    mod = tvm.IRModule()
+    mod["main"] = construct_model_func(shape)
+    mod = PartitionParameter(n_part, [1, 2])(mod)
+    func = mod["main"]
+
+    # The weights are replaced by their partitions.
+    part_dim0 = (shape[1] + n_part - 1) // n_part
+    for param in func.params[1:]:
+        assert param.type_annotation.concrete_shape == (part_dim0, shape[1])
+
+    # Each weight is gathered once for the forward and once for the backward, and the
+    # zero-padding is sliced if the first axis is not dividable.
+    text = raf.ir.AsText(func)
+    assert text.count("raf.op._allgather(") == 4, text
+    assert text.count("raf.op.strided_slice(") == n_slice, text
+
+    # The all-gather of the second weight is prefetched before the first layer.
+    lines = [line for line in text.split("\n") if "let " in line]
+    first_matmul = next(i for i, line in enumerate(lines) if "raf.op.matmul(" in line)
+    n_gather = sum(1 for line in lines[:first_matmul] if "raf.op._allgather(" in line)
+    assert n_gather == 2, text
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -0,0 +1,46 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=invalid-name,protected-access
+import pytest
+import tvm
+
+import raf
+from raf._ffi.pass_ import PipelinePartition, EstimatePipelineStages, InferType
+from raf._core.ir_ext import extended_var
+from raf.ir import ANFBuilder
+
+
+def construct_model_func(shape, n):
+    """A chain of n ops with a residual connection from the first op to the last one."""
+    builder = ANFBuilder()
+    x = extended_var("x", shape=shape, dtype="float32")
+    first = out = builder.call("relu", [x])
+    for _ in range(n - 2):
+        out = builder.call("relu", [out])
+    out = builder.call("add", [out, first, raf.ir.const(None), raf.ir.const(None)])
+    return tvm.relay.Function([x], builder.ret(out))
+
+
+@pytest.mark.parametrize("num_stages", [2, 4])
+def test_pipeline_partition(num_stages):
+    shape = [4, 8]
+    mod = tvm.IRModule()
+    mod["main"] = construct_model_func(shape, 8)
+
+    # The ops have the same cost without a target device, so the stages are even.
+    stages = EstimatePipelineStages(InferType()(mod), num_stages)
+    assert [(s[0].value, s[1].value) for s in stages] == [
+        (i * 8 // num_stages, (i + 1) * 8 // num_stages) for i in range(num_stages)
+    ]
+
+    for stage in range(num_stages):
+        text = raf.ir.AsText(PipelinePartition(num_stages, stage)(mod)["main"])
+        # Each stage receives the output of the previous stage and the relayed residual.
+        assert text.count("raf.op._recv(") == (0 if stage == 0 else 2), text
+        assert text.count("raf.op._send(") == (0 if stage == num_stages - 1 else 2), text
+        assert text.count("raf.op.relu(") + text.count("raf.op.add(") == 8 // num_stages, text
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -0,0 +1,79 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=invalid-name
+import pytest
+import tvm
+from raf._ffi.pass_ import FromRelay, InferType, PredicateIf
+from raf.ir import ScopeBuilder
+from tvm import relay
+
+
+def count_nodes(func):
+    counts = {"if": 0, "where": 0}
+
+    def visit(node):
+        if isinstance(node, relay.If):
+            counts["if"] += 1
+        elif isinstance(node, relay.Call) and isinstance(node.op, tvm.ir.Op):
+            if node.op.name == "raf.op.where":
+                counts["where"] += 1
+
+    relay.analysis.post_order_visit(func, visit)
+    return counts
+
+
+def get_if_mod(num_ops=1):
+    sb = ScopeBuilder()
+    ti32 = relay.scalar_type("int32")
+    n = relay.var("n", ti32)
+    x = relay.var("x", shape=(1, 100), dtype="float32")
+    with sb.if_scope(relay.equal(n, relay.const(0, ti32))):
+        y = x
+        for _ in range(num_ops):
+            y = relay.tanh(y)
+        sb.ret(y)
+    with sb.else_scope():
+        sb.ret(relay.sigmoid(x))
+    tvm_mod = tvm.IRModule()
+    tvm_mod["main"] = relay.Function([n, x], sb.get())
+    return InferType()(FromRelay()(relay.transform.InferType()(tvm_mod)))
+
+
+def test_predicate_if():
+    mod = InferType()(PredicateIf()(get_if_mod()))
+    assert count_nodes(mod["main"]) == {"if": 0, "where": 1}
+    assert mod["main"].checked_type.ret_type == relay.TensorType((1, 100))
+
+
+def test_max_ops():
+    mod = get_if_mod(num_ops=8)
+    mod = PredicateIf()(mod)
+    assert count_nodes(mod["main"]) == {"if": 1, "where": 0}
+
+    with tvm.transform.PassContext(config={"raf.predicate_if.max_ops": 16}):
+        mod = PredicateIf()(mod)
+    assert count_nodes(mod["main"]) == {"if": 0, "where": 1}
+
+
+def test_function_call_branch():
+    f1 = relay.GlobalVar("f1")
+    sb = ScopeBuilder()
+    ti32 = relay.scalar_type("int32")
+    n = relay.var("n", ti32)
+    x = relay.var("x", shape=(1, 100), dtype="float32")
+    with sb.if_scope(relay.equal(n, relay.const(0, ti32))):
+        sb.ret(x)
+    with sb.else_scope():
+        sb.ret(f1(relay.subtract(n, relay.const(1, ti32)), relay.tanh(x)))
+    tvm_mod = tvm.IRModule()
+    tvm_mod[f1] = relay.Function([n, x], sb.get())
+    mod = InferType()(FromRelay()(relay.transform.InferType()(tvm_mod)))
+
+    # The recursive call cannot be evaluated unconditionally.
+    mod = PredicateIf()(mod)
+    assert count_nodes(mod["f1"]) == {"if": 1, "where": 0}
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -0,0 +1,61 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access, no-self-use, attribute-defined-outside-init
+import numpy as np
+import pytest
+
+import raf
+from raf.ir import AsText
+from raf.testing import randn, run_vm_model, check, get_testable_devices
+
+
+class MLP(raf.Model):
+    def build(self, w1, w2):
+        self.w1 = w1
+        self.w2 = w2
+
+    @raf.model.trace
+    def forward(self, x):
+        y = raf.relu(raf.dense(x, self.w1))
+        return raf.matmul_nt(y, self.w2)
+
+
+def count_ops(model, args, op_name):
+    mod = model._internal(*args).mod
+    text = AsText(raf._ffi.pass_.InferType()(mod)["main"])
+    return sum(line.find(op_name + "(") != -1 for line in text.split("\n"))
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+@pytest.mark.parametrize("fold", [False, True])
+def test_quantize_mlp(device, fold):
+    m_w1, n_w1 = randn((16, 8), device=device)
+    m_w2, n_w2 = randn((4, 16), device=device)
+    model = MLP(m_w1, m_w2)
+    model.infer_mode()
+    model.to(device=device)
+    calib_data = [[randn((6, 8), device=device)[0]] for _ in range(3)]
+
+    ranges = raf.quantize.calibrate(model, calib_data, device)
+    n_y = np.maximum(np.matmul(calib_data[0][0].numpy(), n_w1.T), 0)
+    assert len(ranges) == 2
+    assert ranges[0] >= np.abs(calib_data[0][0].numpy()).max()
+    assert ranges[1] >= np.abs(n_y).max()
+
+    q_model = raf.quantize.quantize(model, calib_data, device, fold=fold)
+    q_model.to(device=device)
+    args = calib_data[0]
+    assert count_ops(q_model, args, "raf.op._contrib_quantize") == 4
+    assert count_ops(q_model, args, "raf.op._contrib_quantized_dense") == (2 if fold else 0)
+
+    m_x = args[0]
+    n_x = m_x.numpy()
+    n_y = np.matmul(np.maximum(np.matmul(n_x, n_w1.T), 0), n_w2.T)
+    m_y = run_vm_model(q_model, device, args)
+    # The int8 error is bounded by the scales, which are 1/127 of the ranges.
+    check(m_y, n_y, rtol=0.1, atol=0.1)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -2,13 +2,14 @@
 # SPDX-License-Identifier: Apache-2.0
 
 # pylint: disable=protected-access, no-self-use, too-many-locals
+import numpy as np
 import pytest
 import raf
 from raf._core.ir_ext import extended_var
 from raf._core.ndarray import array
 from raf._ffi.pass_ import SimplifyExpr, ToGraphNormalForm, ToBasicBlockNormalForm, InferType
 from raf.ir import RAFSequential, ScopeBuilder
-from raf.testing import randn
+from raf.testing import check, randn, run_vm_model
 
 import tvm
 from tvm import relay
@@ -198,6 +199,98 @@ def test_matmul_reshape_bias(ndim, act, shape_compatible):
     assert tvm.ir.structural_equal(mod["main"], expected()), raf.ir.AsText(mod["main"])
 
 
+@pytest.mark.parametrize("bshape", [(10,), (4, 10)])
+def test_matmul_bias_residual(bshape):
+    device = "cpu"
+    xshape = (4, 8)
+    wshape = (10, 8)
+
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, w, b, r):
+            y = raf.dense(x, w)
+            y = raf.add(y, b)
+            y = raf.add(y, r)
+            return y
+
+    model = Model()
+    m_x, _ = randn(xshape, device=device, dtype="float32")
+    m_w, _ = randn(wshape, device=device, dtype="float32")
+    m_b, _ = randn(bshape, device=device, dtype="float32")
+    m_r, _ = randn((4, 10), device=device, dtype="float32")
+    mod = model._internal(m_x, m_w, m_b, m_r).mod
+    mod = simplify(mod, device)
+
+    def expected():
+        dense_op = raf._ffi.op.GetOp("raf.op.dense")
+        add_op = raf._ffi.op.GetOp("raf.op.add")
+        null = raf.ir.const(None)
+
+        x = extended_var("x", shape=xshape, dtype="float32")
+        w = extended_var("w", shape=wshape, dtype="float32")
+        b = extended_var("b", shape=bshape, dtype="float32")
+        r = extended_var("r", shape=(4, 10), dtype="float32")
+        y = relay.Call(dense_op, [x, w])
+        if len(bshape) == 1:
+            # The broadcast bias is added to the residual, which is fused into the GEMM.
+            y = relay.Call(add_op, [y, relay.Call(add_op, [r, b, null, null]), null, null])
+        else:
+            y = relay.Call(add_op, [relay.Call(add_op, [y, b, null, null]), r, null, null])
+        mod = tvm.IRModule.from_expr(relay.Function([x, w, b, r], y))
+        return InferType()(mod)["main"]
+
+    assert tvm.ir.structural_equal(mod["main"], expected()), raf.ir.AsText(mod["main"])
+
+
+@pytest.mark.parametrize("op_name", ["batch_matmul", "batch_matmul_nt", "batch_matmul_tt"])
+@pytest.mark.parametrize("swap", ["transpose", "swap_axis"])
+def test_batch_matmul_transpose(op_name, swap):
+    device = "cpu"
+    ashape = (4, 8, 6) if op_name in ("batch_matmul", "batch_matmul_nt") else (4, 6, 8)
+    bshape = (4, 10, 6) if op_name in ("batch_matmul", "batch_matmul_tn") else (4, 6, 10)
+    expected_op_name = {
+        "batch_matmul": "batch_matmul_tn",
+        "batch_matmul_nt": "batch_matmul_tt",
+        "batch_matmul_tt": "batch_matmul_nt",
+    }[op_name]
+
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, a, b):
+            if swap == "transpose":
+                a = raf.transpose(a, (0, 2, 1))
+            else:
+                a = raf.swap_axis(a, 2, 1)
+            # The transpose of b does not swap the last two dims, so it is kept.
+            b = raf.transpose(b, (0, 1, 2))
+            return getattr(raf, op_name)(a, b)
+
+    model = Model()
+    m_a, _ = randn(ashape, device=device, dtype="float32")
+    m_b, _ = randn(bshape, device=device, dtype="float32")
+    mod = model._internal(m_a, m_b).mod
+    mod = simplify(mod, device)
+
+    def expected():
+        transpose_op = raf._ffi.op.GetOp("raf.op.transpose")
+        matmul_op = raf._ffi.op.GetOp("raf.op.%s" % expected_op_name)
+
+        a = extended_var("a", shape=ashape, dtype="float32")
+        b = extended_var("b", shape=bshape, dtype="float32")
+        b_t = relay.Call(transpose_op, [b, raf.ir.const((0, 1, 2))])
+        y = relay.Call(matmul_op, [a, b_t])
+        mod = tvm.IRModule.from_expr(relay.Function([a, b], y))
+        return InferType()(mod)["main"]
+
+    assert tvm.ir.structural_equal(mod["main"], expected()), raf.ir.AsText(mod["main"])
+
+
 def test_multiply():
     device = "cpu"
     shape = (10, 5)
@@ -260,5 +353,34 @@ def test_add_sub():
     assert tvm.ir.structural_equal(mod["main"], expected()), raf.ir.AsText(mod["main"])
 
 
+
+@pytest.mark.parametrize("keepdims", [True, False])
+def test_fuse_moments(keepdims):
+    device = "cpu"
+    shape = (4, 6)
+
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            mean = raf.mean(x, axis=1, keepdims=True)
+            centered = raf.subtract(x, mean)
+            var = raf.mean(raf.multiply(centered, centered), axis=1, keepdims=keepdims)
+            return raf.add(mean, var)
+
+    model = Model()
+    m_x, n_x = randn(shape, device=device)
+    mod = model._internal(m_x).mod
+    text = raf.ir.AsText(simplify(mod, device)["main"])
+    # The variance keeps the reduced dims only when keepdims, so only then it can be fused.
+    assert ("raf.op.moments" in text) == keepdims, text
+    assert ("raf.op.mean" in text) != keepdims, text
+
+    n_mean = np.mean(n_x, axis=1, keepdims=True)
+    n_var = np.var(n_x, axis=1, keepdims=keepdims)
+    check(run_vm_model(model, device, [m_x]), n_mean + n_var, rtol=1e-5, atol=1e-5)
+
 if __name__ == "__main__":
     pytest.main([__file__])
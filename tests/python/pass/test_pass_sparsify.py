@@ -0,0 +1,56 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access, no-self-use, attribute-defined-outside-init
+import numpy as np
+import pytest
+
+import raf
+from raf.ir import AsText
+from raf.testing import randn, run_vm_model, check, get_testable_devices
+
+
+class MLP(raf.Model):
+    def build(self, w1, w2, w3):
+        self.w1 = w1
+        self.w2 = w2
+        self.w3 = w3
+
+    @raf.model.trace
+    def forward(self, x):
+        y = raf.relu(raf.dense(x, self.w1))
+        y = raf.relu(raf.matmul_nt(y, self.w2))
+        # The weight of [8, 16] is not in the shape of the sparse tensor cores.
+        return raf.dense(y, self.w3)
+
+
+def count_ops(model, args, op_name):
+    mod = model._internal(*args).mod
+    text = AsText(raf._ffi.pass_.InferType()(mod)["main"])
+    return sum(line.find(op_name + "(") != -1 for line in text.split("\n"))
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_sparsify_mlp(device):
+    m_w1, n_w1 = randn((64, 64), device=device)
+    m_w2, n_w2 = randn((16, 64), device=device)
+    m_w3, n_w3 = randn((8, 16), device=device)
+    model = MLP(m_w1, m_w2, m_w3)
+    model.infer_mode()
+    model.to(device=device)
+    m_x, n_x = randn((4, 64), device=device)
+
+    s_model = raf.sparsity.sparsify(model, [m_x])
+    s_model.to(device=device)
+    assert count_ops(s_model, [m_x], "raf.op._contrib_sparse_dense") == 2
+    assert count_ops(s_model, [m_x], "raf.op.dense") == 1
+
+    n_y = np.maximum(np.matmul(n_x, raf.sparsity.prune_2_4(n_w1).T), 0)
+    n_y = np.maximum(np.matmul(n_y, raf.sparsity.prune_2_4(n_w2).T), 0)
+    n_y = np.matmul(n_y, n_w3.T)
+    m_y = run_vm_model(s_model, device, [m_x])
+    check(m_y, n_y, rtol=1e-4, atol=1e-4)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
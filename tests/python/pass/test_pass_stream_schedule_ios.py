@@ -9,7 +9,10 @@ from raf.testing.schedule_verifier import verify_schedule
 
 
 @pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
-def test_ios_schedule_simple_branches():
+@pytest.mark.parametrize(
+    "cost_model,calibrate_top_k", [["profile", 0], ["roofline", 0], ["roofline", 1], ["learned", 0]]
+)
+def test_ios_schedule_simple_branches(cost_model, calibrate_top_k):
     class Model(raf.Model):
         """
          ┌───────x──────┐
@@ -57,6 +60,8 @@ def test_ios_schedule_simple_branches():
             "raf.stream_schedule.ios.number": 6,
             "raf.stream_schedule.ios.repeat": 6,
             "raf.stream_schedule.ios.verbose": True,
+            "raf.stream_schedule.ios.cost_model": cost_model,
+            "raf.stream_schedule.ios.calibrate_top_k": calibrate_top_k,
         }
     ):
         mod = raf._ffi.pass_.ToGraphNormalForm()(mod)
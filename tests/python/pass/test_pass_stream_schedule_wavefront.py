@@ -30,8 +30,11 @@ class ANFBuilder:
     def call(self, op_name: str, args: List[tvm.relay.Expr]) -> tvm.relay.Var:
         return self.scope_builder.let("", tvm.relay.Call(self.get_operator(op_name), args))
 
-    def set_stream(self, device_id: int, stream_id: int) -> tvm.relay.Var:
-        return self.call("set_stream", [raf.ir.const(device_id), raf.ir.const(stream_id)])
+    def set_stream(self, device_id: int, stream_id: int, priority: int = 0) -> tvm.relay.Var:
+        args = [raf.ir.const(device_id), raf.ir.const(stream_id)]
+        if priority != 0:
+            args.append(raf.ir.const(priority))
+        return self.call("set_stream", args)
 
     def add_event(self, event_id: int) -> tvm.relay.Var:
         return self.call("add_event", [raf.ir.const(event_id)])
@@ -175,24 +178,27 @@ def test_wavefront_schedule_branch_in_branch():
           let %x_2 = raf.op.set_stream(int64(0), int64(1));
           let %x_3 = raf.op.atan(%x);
           let %x_4 = raf.op.atan(%x_3);
-          let %x_5 = raf.op.set_stream(int64(0), int64(2));
-          let %x_6 = raf.op.atan(%x);
-          let %x_7 = raf.op.atan(%x_6);
+          let %x_5 = raf.op.add_event(int64(0));
+          let %x_6 = raf.op.set_stream(int64(0), int64(2));
+          let %x_7 = raf.op.atan(%x);
           let %x_8 = raf.op.atan(%x_7);
-          let %x_9 = raf.op.stream_barrier();
+          let %x_9 = raf.op.atan(%x_8);
           let %x_10 = raf.op.set_stream(int64(0), int64(0));
-          let %x_11 = raf.op.atan(%x_4);
-          let %x_12 = raf.op.set_stream(int64(0), int64(1));
-          let %x_13 = raf.op.atan(%x_4);
-          let %x_14 = raf.op.stream_barrier();
-          let %x_15 = raf.op.set_stream(int64(0), int64(0));
-          let %x_16 = (%x_11, %x_13);
-          let %x_17 = raf.op.concatenate(%x_16, int64(0));
-          let %x_18 = (%x_1, %x_17, %x_8);
-          let %x_19 = raf.op.concatenate(%x_18, int64(0));
-          %x_19
+          let %x_11 = raf.op.wait_event(int64(0));
+          let %x_12 = raf.op.atan(%x_4);
+          let %x_13 = raf.op.set_stream(int64(0), int64(1));
+          let %x_14 = raf.op.atan(%x_4);
+          let %x_15 = raf.op.stream_barrier();
+          let %x_16 = raf.op.set_stream(int64(0), int64(0));
+          let %x_17 = (%x_12, %x_14);
+          let %x_18 = raf.op.concatenate(%x_17, int64(0));
+          let %x_19 = (%x_1, %x_18, %x_9);
+          let %x_20 = raf.op.concatenate(%x_19, int64(0));
+          %x_20
         }
         """
+        # Wave 2 only depends on stream 1, so stream 0 waits for its event instead of a barrier,
+        # and stream 2 may still run while wave 2 starts.
         sb = ANFBuilder()
         x = extended_var("x", shape=input_shape)
         x_0 = sb.set_stream(0, 0)
@@ -200,22 +206,23 @@ def test_wavefront_schedule_branch_in_branch():
         x_2 = sb.set_stream(0, 1)
         x_3 = sb.atan(x)
         x_4 = sb.atan(x_3)
-        x_5 = sb.set_stream(0, 2)
-        x_6 = sb.atan(x)
-        x_7 = sb.atan(x_6)
+        x_5 = sb.add_event(0)
+        x_6 = sb.set_stream(0, 2)
+        x_7 = sb.atan(x)
         x_8 = sb.atan(x_7)
-        x_9 = sb.stream_barrier()
+        x_9 = sb.atan(x_8)
         x_10 = sb.set_stream(0, 0)
-        x_11 = sb.atan(x_4)
-        x_12 = sb.set_stream(0, 1)
-        x_13 = sb.atan(x_4)
-        x_14 = sb.stream_barrier()
-        x_15 = sb.set_stream(0, 0)
-        x_16 = sb.make_tuple([x_11, x_13])
-        x_17 = sb.concatenate(x_16, 0)
-        x_18 = sb.make_tuple([x_1, x_17, x_8])
-        x_19 = sb.concatenate(x_18, 0)
-        return tvm.relay.Function([x], sb.ret(x_19))
+        x_11 = sb.wait_event(0)
+        x_12 = sb.atan(x_4)
+        x_13 = sb.set_stream(0, 1)
+        x_14 = sb.atan(x_4)
+        x_15 = sb.stream_barrier()
+        x_16 = sb.set_stream(0, 0)
+        x_17 = sb.make_tuple([x_12, x_14])
+        x_18 = sb.concatenate(x_17, 0)
+        x_19 = sb.make_tuple([x_1, x_18, x_9])
+        x_20 = sb.concatenate(x_19, 0)
+        return tvm.relay.Function([x], sb.ret(x_20))
 
     assert tvm.ir.structural_equal(mod["main"], expected())
 
@@ -274,19 +281,21 @@ def test_wavefront_schedule_stacked_blocks():
           let %x_8 = raf.op.set_stream(int64(0), int64(0));
           let %x_9 = (%x_1, %x_3, %x_6);
           let %x_10 = raf.op.concatenate(%x_9, int64(0));
-          let %x_11 = raf.op.stream_barrier();
+          let %x_11 = raf.op.add_event(int64(0));
           let %x_12 = raf.op.set_stream(int64(0), int64(0));
           let %x_13 = raf.op.atan(%x_10);
           let %x_14 = raf.op.set_stream(int64(0), int64(1));
-          let %x_15 = raf.op.atan(%x_10);
-          let %x_16 = raf.op.set_stream(int64(0), int64(2));
-          let %x_17 = raf.op.atan(%x_10);
-          let %x_18 = raf.op.atan(%x_17);
-          let %x_19 = raf.op.stream_barrier();
-          let %x_20 = raf.op.set_stream(int64(0), int64(0));
-          let %x_21 = (%x_13, %x_15, %x_18);
-          let %x_22 = raf.op.concatenate(%x_21, int64(0));
-          %x_22
+          let %x_15 = raf.op.wait_event(int64(0));
+          let %x_16 = raf.op.atan(%x_10);
+          let %x_17 = raf.op.set_stream(int64(0), int64(2));
+          let %x_18 = raf.op.wait_event(int64(0));
+          let %x_19 = raf.op.atan(%x_10);
+          let %x_20 = raf.op.atan(%x_19);
+          let %x_21 = raf.op.stream_barrier();
+          let %x_22 = raf.op.set_stream(int64(0), int64(0));
+          let %x_23 = (%x_13, %x_16, %x_20);
+          let %x_24 = raf.op.concatenate(%x_23, int64(0));
+          %x_24
         }
         """
         sb = ANFBuilder()
@@ -302,19 +311,128 @@ def test_wavefront_schedule_stacked_blocks():
         x_8 = sb.set_stream(0, 0)
         x_9 = sb.make_tuple([x_1, x_3, x_6])
         x_10 = sb.concatenate(x_9, 0)
-        x_11 = sb.stream_barrier()
+        x_11 = sb.add_event(0)
         x_12 = sb.set_stream(0, 0)
         x_13 = sb.atan(x_10)
         x_14 = sb.set_stream(0, 1)
-        x_15 = sb.atan(x_10)
-        x_16 = sb.set_stream(0, 2)
-        x_17 = sb.atan(x_10)
-        x_18 = sb.atan(x_17)
-        x_19 = sb.stream_barrier()
-        x_20 = sb.set_stream(0, 0)
-        x_21 = sb.make_tuple([x_13, x_15, x_18])
-        x_22 = sb.concatenate(x_21, 0)
-        return tvm.relay.Function([x], sb.ret(x_22))
+        x_15 = sb.wait_event(0)
+        x_16 = sb.atan(x_10)
+        x_17 = sb.set_stream(0, 2)
+        x_18 = sb.wait_event(0)
+        x_19 = sb.atan(x_10)
+        x_20 = sb.atan(x_19)
+        x_21 = sb.stream_barrier()
+        x_22 = sb.set_stream(0, 0)
+        x_23 = sb.make_tuple([x_13, x_16, x_20])
+        x_24 = sb.concatenate(x_23, 0)
+        return tvm.relay.Function([x], sb.ret(x_24))
+
+    assert tvm.ir.structural_equal(mod["main"], expected())
+
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+def test_wavefront_schedule_stream_priority():
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            p_0 = raf.atan(x)
+
+            p_1 = raf.atan(x)
+            p_1 = raf.atan(p_1)
+
+            p_2 = raf.atan(x)
+            p_2 = raf.atan(p_2)
+            p_2 = raf.atan(p_2)
+            return raf.concatenate([p_0, p_1, p_2])
+
+    model = Model()
+    input_shape = [2, 2]
+    x, _ = randn(input_shape)
+    mod = model._internal(x).mod
+
+    config = {
+        "raf.stream_schedule.policy": "wavefront",
+        "raf.stream_schedule.stream_priority": True,
+    }
+    with raf.ir.PassContext(opt_level=2, config=config):
+        mod = RAFSequential([ToGraphNormalForm(), WavefrontStreamSchedule()])(mod)
+
+    def expected():
+        # The longest chain of each wave runs on the high priority stream 1.
+        sb = ANFBuilder()
+        x = extended_var("x", shape=input_shape)
+        x_0 = sb.set_stream(0, 0)
+        x_1 = sb.atan(x)
+        x_2 = sb.set_stream(0, 2)
+        x_3 = sb.atan(x)
+        x_4 = sb.atan(x_3)
+        x_5 = sb.set_stream(0, 1, 1)
+        x_6 = sb.atan(x)
+        x_7 = sb.atan(x_6)
+        x_8 = sb.atan(x_7)
+        x_9 = sb.stream_barrier()
+        x_10 = sb.set_stream(0, 1, 1)
+        x_11 = sb.make_tuple([x_1, x_4, x_8])
+        x_12 = sb.concatenate(x_11, 0)
+        return tvm.relay.Function([x], sb.ret(x_12))
+
+    assert tvm.ir.structural_equal(mod["main"], expected())
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+def test_wavefront_schedule_memory_budget():
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            p_0 = raf.atan(x)
+
+            p_1 = raf.atan(x)
+            p_1 = raf.atan(p_1)
+
+            p_2 = raf.atan(x)
+            p_2 = raf.atan(p_2)
+            p_2 = raf.atan(p_2)
+            return raf.concatenate([p_0, p_1, p_2])
+
+    model = Model()
+    # Each tensor takes 0.25 MB.
+    input_shape = [256, 256]
+    x, _ = randn(input_shape)
+    mod = model._internal(x).mod
+
+    config = {
+        "raf.stream_schedule.policy": "wavefront",
+        "raf.stream_schedule.memory_budget_mbs": 1,
+    }
+    with raf.ir.PassContext(opt_level=2, config=config):
+        mod = RAFSequential([ToGraphNormalForm(), WavefrontStreamSchedule()])(mod)
+
+    def expected():
+        # The first wave would take 1.5 MB, so the third chain is split into another wave, which
+        # starts after a stream barrier.
+        sb = ANFBuilder()
+        x = extended_var("x", shape=input_shape)
+        x_0 = sb.set_stream(0, 0)
+        x_1 = sb.atan(x)
+        x_2 = sb.set_stream(0, 1)
+        x_3 = sb.atan(x)
+        x_4 = sb.atan(x_3)
+        x_5 = sb.stream_barrier()
+        x_6 = sb.set_stream(0, 0)
+        x_7 = sb.atan(x)
+        x_8 = sb.atan(x_7)
+        x_9 = sb.atan(x_8)
+        x_10 = sb.set_stream(0, 0)
+        x_11 = sb.make_tuple([x_1, x_4, x_9])
+        x_12 = sb.concatenate(x_11, 0)
+        return tvm.relay.Function([x], sb.ret(x_12))
 
     assert tvm.ir.structural_equal(mod["main"], expected())
 
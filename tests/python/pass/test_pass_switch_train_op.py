@@ -5,7 +5,8 @@
 import pytest
 import raf
 from raf._ffi.pass_ import InferType, SwitchTrainOp
-from raf.testing import randn_torch, check, run_vm_model, get_testable_devices
+from raf.model.trace import _get_func_inputs
+from raf.testing import randn_torch, check, run_vm_model, get_testable_devices, freeze_params
 
 
 @pytest.mark.parametrize("device", get_testable_devices())
@@ -51,5 +52,47 @@ def test_layer_norm(device):
     check(out_ref, out_switch)
 
 
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_inference_compile(device):
+    class Model(raf.Model):
+        def build(self):
+            self.bn = raf.model.BatchNorm(4)
+            self.w, _ = randn_torch((4, 4, 3, 3), device=device)
+
+        @raf.model.trace
+        def forward(self, x):
+            out = raf.conv2d(x, self.w, padding=1)
+            out = self.bn(out)
+            out = raf._contrib_dropout(out, 0.5)[0]
+            return raf.relu(out)
+
+        @raf.model.trace
+        def forward_infer(self, x):
+            out = raf.conv2d(x, self.w, padding=1)
+            return raf.relu(self.bn(out))
+
+    model = Model()
+    model.to(device=device)
+    m_x, _ = randn_torch((2, 4, 8, 8), device=device)
+
+    model.infer_mode()
+    out_ref = model(m_x)
+
+    # The model is traced in training mode, but compiled for inference.
+    model.train_mode()
+    record = model._internal(m_x)
+    inputs = _get_func_inputs(record, [m_x], {}, get_handle=False)
+    mod, _ = freeze_params(record, inputs)
+    with raf.ir.PassContext(config={"raf.vm.optimize.inference": True}):
+        mod = InferType()(mod)
+        opt_mod, _ = raf._core.vm.VMCompiler().optimize(mod, device=device, params={})
+    text = raf.ir.AsText(opt_mod)
+    assert "batch_norm_train" not in text
+    assert "dropout" not in text
+
+    out = run_vm_model(model, device, [m_x], inference=True)
+    check(out_ref, out[0], rtol=1e-4, atol=1e-4)
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
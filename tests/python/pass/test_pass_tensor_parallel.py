@@ -0,0 +1,72 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=invalid-name,protected-access
+import pytest
+import tvm
+
+import raf
+from raf._ffi.pass_ import TensorParallel
+from raf._core.ir_ext import extended_var
+from raf.ir import ANFBuilder
+
+
+def construct_mlp_func(with_row_layer):
+    """dense(relu(dense(x, w1) + b1), w2), where the second layer is optional."""
+    builder = ANFBuilder()
+    x = extended_var("x", shape=[4, 8], dtype="float32")
+    w1 = extended_var("w1", shape=[16, 8], dtype="float32")
+    b1 = extended_var("b1", shape=[16], dtype="float32")
+    w2 = extended_var("w2", shape=[8, 16], dtype="float32")
+    out = builder.call("dense", [x, w1])
+    out = builder.call("add", [out, b1, raf.ir.const(None), raf.ir.const(None)])
+    out = builder.call("relu", [out])
+    if with_row_layer:
+        out = builder.call("dense", [out, w2])
+    return tvm.relay.Function([x, w1, b1, w2], builder.ret(out))
+
+
+@pytest.mark.parametrize("with_row_layer", [True, False])
+def test_tensor_parallel(with_row_layer):
+    mod = tvm.IRModule()
+    mod["main"] = construct_mlp_func(with_row_layer)
+    specs = {"w1": "col", "b1": "col"}
+    if with_row_layer:
+        specs["w2"] = "row"
+    mod = TensorParallel(specs, 4, 1)(mod)
+    func = mod["main"]
+
+    # The annotated weights are replaced by their shards.
+    shapes = [tuple(p.type_annotation.concrete_shape) for p in func.params]
+    assert shapes == [(4, 8), (4, 8), (4,), (8, 4) if with_row_layer else (8, 16)]
+
+    text = raf.ir.AsText(func)
+    if with_row_layer:
+        # The column-parallel layer feeds the row-parallel layer without an all-gather.
+        assert text.count("raf.op._allgather(") == 0, text
+        assert text.count("raf.op._allreduce(") == 1, text
+        assert text.count("raf.op.split(") == 0, text
+    else:
+        # The sliced output is all-gathered along the last axis.
+        assert text.count("raf.op._allgather(") == 1, text
+        assert text.count("raf.op.swap_axis(") == 2, text
+        assert text.count("raf.op._allreduce(") == 0, text
+
+
+def test_row_parallel_input_split():
+    builder = ANFBuilder()
+    x = extended_var("x", shape=[4, 8], dtype="float32")
+    w = extended_var("w", shape=[8, 6], dtype="float32")
+    out = builder.call("matmul", [x, w])
+    mod = tvm.IRModule()
+    mod["main"] = tvm.relay.Function([x, w], builder.ret(out))
+    mod = TensorParallel({"w": "row"}, 2, 0)(mod)
+    func = mod["main"]
+    assert tuple(func.params[1].type_annotation.concrete_shape) == (4, 6)
+    text = raf.ir.AsText(func)
+    assert text.count("raf.op.split(") == 1, text
+    assert text.count("raf.op._allreduce(") == 1, text
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
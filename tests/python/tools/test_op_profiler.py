@@ -2,11 +2,16 @@
 # SPDX-License-Identifier: Apache-2.0
 
 # pylint: disable=no-self-use,protected-access
+import os
+import subprocess
+import sys
+
 import pytest
 
 import raf
 from raf._ffi.op_profiler import Profile, ProfileGroup, ResetCache, GetCacheSize
 from raf.testing import get_testable_devices, run_infer_type, randn
+from raf.utils.tuner import tune_kernels
 
 
 @pytest.mark.parametrize("device_str", get_testable_devices())
@@ -152,5 +157,61 @@ def test_default_stream():
     assert GetCacheSize(device) == 1
 
 
+PERSIST_SCRIPT = """
+import raf
+from raf._ffi.op_profiler import Profile
+from raf.testing import run_infer_type
+
+data = raf.ir.var("x", shape=(16, 16))
+expr = run_infer_type(raf.ir.op.softmax(data)).body
+print(Profile(expr, raf.Device("cpu"), 1, 1, 3)["latency"])
+"""
+
+
+def test_persist(tmp_path):
+    env = dict(os.environ)
+    env.update({"RAF_PERSIST_CACHE": "1", "RAF_PERSIST_CACHE_PATH": str(tmp_path)})
+
+    def run():
+        cmd = [sys.executable, "-c", PERSIST_SCRIPT]
+        return subprocess.check_output(cmd, env=env).decode().strip().splitlines()[-1]
+
+    # The second process reuses the latencies profiled by the first one, so they are exactly the
+    # same.
+    first, second = run(), run()
+    assert first == second
+    assert os.path.isdir(os.path.join(str(tmp_path), "op_profiler_latency"))
+
+
+@pytest.mark.parametrize("device_str", get_testable_devices())
+def test_tune_kernels(device_str):
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, y):
+            out = raf.matmul(x, y)
+            out = raf.softmax(out)
+            return raf.matmul(out, y)
+
+    model = Model()
+    m_x, _ = randn((16, 16), device=device_str)
+    m_y, _ = randn((16, 16), device=device_str)
+    ResetCache(raf.Device(device_str))
+    jobs = tune_kernels(model, device_str, [m_x, m_y], rank=0, num_ranks=1)
+    # The two matmuls are the same kernel, which is tuned once.
+    assert 0 < len(jobs) <= 2
+    for job in jobs:
+        assert job["device_id"] >= 0 and not job["error"]
+
+    # The ranks share the kernels without overlapping.
+    rank_jobs = [
+        tune_kernels(model, device_str, [m_x, m_y], rank=rank, num_ranks=2) for rank in range(2)
+    ]
+    assert len(rank_jobs[0]) + len(rank_jobs[1]) == len(jobs)
+    assert len(rank_jobs[0]) >= len(rank_jobs[1])
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
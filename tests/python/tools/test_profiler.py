@@ -7,7 +7,7 @@ import numpy as np
 import raf
 from raf._op import sym
 from raf.utils import profiler
-from raf.testing import randn
+from raf.testing import randn, run_vm_model
 
 
 class TestNet(raf.Model):
@@ -68,6 +68,28 @@ def test_profiler_with_cuda(i):
     assert op_count > 0
 
 
+@pytest.mark.skipif(not raf.build.with_cupti(), reason="CUPTI is not enabled")
+def test_profiler_with_cupti():
+    device = "cuda"
+    m_x, _ = randn((64, 128), device=device)
+    m_y, _ = randn((128, 64), device=device)
+    model = TestCuda()
+    model.to(device=device)
+    profiler.start()
+    run_vm_model(model, device, [m_x, m_y])
+    profiler.stop()
+    data = profiler.get()
+    gpu_events = [e for e in data["traceEvents"] if e["cat"].startswith("GPU ")]
+    assert gpu_events
+    # Every kernel launched by an InvokeJit is correlated with its pc and OpEnv.
+    kernels = [e for e in gpu_events if "kind=kernel" in e["args"]["args_string"]]
+    assert kernels
+    assert all("pc=" in e["args"]["args_string"] for e in kernels)
+    assert any("matmul" in e["args"]["args_string"] for e in kernels)
+    for begin, end in zip(gpu_events[::2], gpu_events[1::2]):
+        assert begin["ph"] == "B" and end["ph"] == "E" and begin["ts"] <= end["ts"]
+
+
 @pytest.mark.parametrize("i", [0])
 def test_profiler_without_cuda(i):
     profiler.start()
@@ -95,5 +117,54 @@ def test_profiler_without_cuda(i):
     assert op_count > 0
 
 
+def test_sampling_profiler():
+    device = "cpu"
+    m_x, _ = randn((16, 32), device=device)
+    m_y, _ = randn((32, 16), device=device)
+    model = TestCuda()
+    profiler.reset_sampled_stats()
+    profiler.start_sampling(sample_every=2, capacity=4, flush_interval_ms=10)
+    for _ in range(10):
+        run_vm_model(model, device, [m_x, m_y])
+    profiler.stop_sampling()
+    stats = profiler.get_sampled_stats()
+    ops = [op for op in stats["ops"] if "matmul" in op]
+    assert ops
+    count = sum(stats["ops"][op]["count"] for op in ops)
+    # 1 in 2 runs is sampled, so not every run is profiled.
+    assert 0 < count < 10
+    for op in ops:
+        op_stats = stats["ops"][op]
+        assert op_stats["p50_us"] <= op_stats["p99_us"] <= op_stats["max_us"]
+    profiler.reset_sampled_stats()
+    assert not profiler.get_sampled_stats()["ops"]
+
+
+def test_pass_profiler():
+    # pylint: disable=import-outside-toplevel
+    from raf._core.vm import VMCompiler
+
+    device = "cpu"
+    m_x, _ = randn((16, 32), device=device)
+    m_y, _ = randn((32, 16), device=device)
+    model = TestCuda()
+    mod = model._internal(m_x, m_y).mod  # pylint: disable=protected-access
+    profiler.reset_pass_profiler()
+    profiler.start_pass_profiler()
+    with raf.ir.PassContext(config={"raf.pass.release_memory": True}):
+        VMCompiler().optimize(mod, device)
+    profiler.stop_pass_profiler()
+    entries = profiler.get_pass_profile()
+    names = [entry["name"] for entry in entries]
+    assert "ManifestAlloc" in names
+    for entry in entries:
+        assert entry["time_ms"] >= 0
+        assert entry["nodes_before"] > 0 and entry["nodes_after"] > 0
+        assert entry["rss_mb"] >= 0
+    assert "ManifestAlloc" in profiler.get_pass_profile(as_table=True)
+    profiler.reset_pass_profiler()
+    assert not profiler.get_pass_profile()
+
+
 if __name__ == "__main__":
     pytest.main([__file__])